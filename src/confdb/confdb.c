@@ -26,6 +26,7 @@
 #include "confdb/confdb.h"
 #include "confdb/confdb_private.h"
 #include "util/strtonum.h"
+#include "util/sss_ptr_hash.h"
 #include "db/sysdb.h"
 
 #define CONFDB_ZERO_CHECK_OR_JUMP(var, ret, err, label) do { \
@@ -52,6 +53,27 @@ static int confdb_get_domain_enabled(struct confdb_ctx *cdb,
                                      const char *domain, bool *_enabled);
 
 
+/* Returns false if there is no snapshot, otherwise _msg is the section with
+ * the given DN or NULL if it does not exist */
+static bool confdb_snapshot_get(struct confdb_ctx *cdb,
+                                struct ldb_dn *dn,
+                                struct ldb_message **_msg)
+{
+    const char *key;
+
+    if (cdb->snapshot == NULL) {
+        return false;
+    }
+
+    key = ldb_dn_get_casefold(dn);
+    if (key == NULL) {
+        return false;
+    }
+
+    *_msg = sss_ptr_hash_lookup(cdb->snapshot, key, struct ldb_message);
+    return true;
+}
+
 static char *prepend_cn(char *str, int *slen, const char *comp, int clen)
 {
     char *ret;
@@ -133,6 +155,8 @@ int confdb_add_param(struct confdb_ctx *cdb,
     const char *rdn_name;
     int ret, i;
 
+    confdb_snapshot_drop(cdb);
+
     tmp_ctx = talloc_new(NULL);
     if (!tmp_ctx) {
         ret = ENOMEM;
@@ -241,6 +265,7 @@ int confdb_get_param(struct confdb_ctx *cdb,
 {
     TALLOC_CTX *tmp_ctx;
     struct ldb_result *res;
+    struct ldb_message *msg = NULL;
     struct ldb_dn *dn;
     char *secdn;
     const char *attrs[] = { attribute, NULL };
@@ -263,22 +288,27 @@ int confdb_get_param(struct confdb_ctx *cdb,
         goto done;
     }
 
-    ret = ldb_search(cdb->ldb, tmp_ctx, &res,
-                     dn, LDB_SCOPE_BASE, attrs, NULL);
-    if (ret != LDB_SUCCESS) {
-        ret = EIO;
-        goto done;
-    }
-    if (res->count > 1) {
-        ret = EIO;
-        goto done;
+    if (!confdb_snapshot_get(cdb, dn, &msg)) {
+        ret = ldb_search(cdb->ldb, tmp_ctx, &res,
+                         dn, LDB_SCOPE_BASE, attrs, NULL);
+        if (ret != LDB_SUCCESS) {
+            ret = EIO;
+            goto done;
+        }
+        if (res->count > 1) {
+            ret = EIO;
+            goto done;
+        }
+        if (res->count > 0) {
+            msg = res->msgs[0];
+        }
     }
 
     vals = talloc_zero(mem_ctx, char *);
     ret = EOK;
 
-    if (res->count > 0) {
-        el = ldb_msg_find_element(res->msgs[0], attribute);
+    if (msg != NULL) {
+        el = ldb_msg_find_element(msg, attribute);
         if (el && el->num_values > 0) {
             vals = talloc_realloc(mem_ctx, vals, char *, el->num_values +1);
             if (!vals) {
@@ -321,6 +351,8 @@ int confdb_set_string(struct confdb_ctx *cdb,
     struct ldb_message *msg;
     int ret, lret;
 
+    confdb_snapshot_drop(cdb);
+
     tmp_ctx = talloc_new(NULL);
     if (!tmp_ctx) {
         return ENOMEM;
@@ -688,6 +720,69 @@ int confdb_init(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+int confdb_snapshot_load(struct confdb_ctx *cdb)
+{
+    TALLOC_CTX *tmp_ctx;
+    hash_table_t *snapshot;
+    struct ldb_result *res;
+    struct ldb_message *msg;
+    const char *key;
+    unsigned int i;
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    snapshot = sss_ptr_hash_create(tmp_ctx, NULL, NULL);
+    if (snapshot == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_search(cdb->ldb, tmp_ctx, &res, NULL,
+                     LDB_SCOPE_SUBTREE, NULL, NULL);
+    if (ret != LDB_SUCCESS) {
+        ret = EIO;
+        goto done;
+    }
+
+    for (i = 0; i < res->count; i++) {
+        msg = talloc_steal(snapshot, res->msgs[i]);
+
+        key = ldb_dn_get_casefold(msg->dn);
+        if (key == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = sss_ptr_hash_add(snapshot, key, msg, struct ldb_message);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    talloc_free(cdb->snapshot);
+    cdb->snapshot = talloc_steal(cdb, snapshot);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Loaded %u confdb sections into memory\n",
+          res->count);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+void confdb_snapshot_drop(struct confdb_ctx *cdb)
+{
+    if (cdb != NULL && cdb->snapshot != NULL) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Dropping the confdb snapshot\n");
+        talloc_zfree(cdb->snapshot);
+    }
+}
+
 static errno_t get_entry_as_uint32(struct ldb_message *msg,
                                    uint32_t *return_value,
                                    const char *entry,
@@ -836,6 +931,7 @@ static int confdb_get_domain_section(TALLOC_CTX *mem_ctx,
     TALLOC_CTX *tmp_ctx;
     int ret;
     struct ldb_result *res;
+    struct ldb_message *msg;
     struct ldb_dn *dn;
 
     tmp_ctx = talloc_new(NULL);
@@ -849,6 +945,36 @@ static int confdb_get_domain_section(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    if (confdb_snapshot_get(cdb, dn, &msg)) {
+        if (msg == NULL) {
+            ret = ENOENT;
+            goto done;
+        }
+
+        /* the caller owns the result, do not hand out the snapshot */
+        res = talloc_zero(tmp_ctx, struct ldb_result);
+        if (res == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        res->msgs = talloc_array(res, struct ldb_message *, 2);
+        if (res->msgs == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        res->msgs[0] = ldb_msg_copy(res->msgs, msg);
+        if (res->msgs[0] == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        res->msgs[1] = NULL;
+        res->count = 1;
+
+        *_res = talloc_steal(mem_ctx, res);
+        ret = EOK;
+        goto done;
+    }
+
     ret = ldb_search(cdb->ldb, tmp_ctx, &res, dn,
                      LDB_SCOPE_BASE, NULL, NULL);
     if (ret != LDB_SUCCESS) {
@@ -1147,6 +1273,27 @@ static int confdb_get_domain_internal(struct confdb_ctx *cdb,
         goto done;
     }
 
+    tmp = ldb_msg_find_attr_as_string(res->msgs[0],
+                                      CONFDB_DOMAIN_CACHE_BACKEND, "tdb");
+    if (strcasecmp(tmp, "tdb") == 0) {
+        domain->cache_backend = SSS_CACHE_BACKEND_TDB;
+    } else if (strcasecmp(tmp, "lmdb") == 0) {
+        domain->cache_backend = SSS_CACHE_BACKEND_LMDB;
+    } else {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Invalid value for %s\n", CONFDB_DOMAIN_CACHE_BACKEND);
+        ret = EINVAL;
+        goto done;
+    }
+
+    ret = get_entry_as_bool(res->msgs[0], &domain->cache_nosync,
+                            CONFDB_DOMAIN_CACHE_NOSYNC, 0);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Invalid value for %s\n", CONFDB_DOMAIN_CACHE_NOSYNC);
+        goto done;
+    }
+
     ret = get_entry_as_uint32(res->msgs[0], &domain->id_min,
                               CONFDB_DOMAIN_MINID,
                               confdb_get_min_id(domain));
@@ -1324,6 +1471,16 @@ static int confdb_get_domain_internal(struct confdb_ctx *cdb,
         goto done;
     }
 
+    ret = get_entry_as_uint32(res->msgs[0], &domain->refresh_expired_max_idle,
+                              CONFDB_DOMAIN_REFRESH_EXPIRED_MAX_IDLE,
+                              0);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Invalid value for [%s]\n",
+               CONFDB_DOMAIN_REFRESH_EXPIRED_MAX_IDLE);
+        goto done;
+    }
+
     /* detect and fix misconfiguration */
     if (domain->refresh_expired_interval > entry_cache_timeout) {
         DEBUG(SSSDBG_CONF_SETTINGS,
@@ -1679,6 +1836,7 @@ int confdb_get_domains(struct confdb_ctx *cdb,
     }
 
     *domains = cdb->doms;
+    sss_domain_index_invalidate();
     ret = EOK;
 
 done:
@@ -2289,6 +2447,9 @@ int confdb_expand_app_domains(struct confdb_ctx *cdb)
     TALLOC_CTX *tmp_ctx;
     struct ldb_result *app_domain = NULL;
 
+    /* the app domains are written to the confdb below */
+    confdb_snapshot_drop(cdb);
+
     tmp_ctx = talloc_new(NULL);
     if (tmp_ctx == NULL) {
         return ENOMEM;
@@ -64,6 +64,7 @@
 #define CONFDB_SERVICE_DEBUG_TO_FILES "debug_to_files"
 #define CONFDB_SERVICE_RECON_RETRIES "reconnection_retries"
 #define CONFDB_SERVICE_FD_LIMIT "fd_limit"
+#define CONFDB_SERVICE_CPU_AFFINITY "cpu_affinity"
 #define CONFDB_SERVICE_ALLOWED_UIDS "allowed_uids"
 
 /* Monitor */
@@ -81,6 +82,8 @@
 #define CONFDB_MONITOR_DISABLE_NETLINK "disable_netlink"
 #define CONFDB_MONITOR_ENABLE_FILES_DOM "enable_files_domain"
 #define CONFDB_MONITOR_DOMAIN_RESOLUTION_ORDER "domain_resolution_order"
+#define CONFDB_MONITOR_PARALLEL_STARTUP "parallel_startup"
+#define CONFDB_MONITOR_PARALLEL_STARTUP_DEFAULT false
 
 /* Both monitor and domains */
 #define CONFDB_NAME_REGEX   "re_expression"
@@ -97,12 +100,32 @@
 #define CONFDB_RESPONDER_IDLE_TIMEOUT "responder_idle_timeout"
 #define CONFDB_RESPONDER_IDLE_DEFAULT_TIMEOUT 300
 #define CONFDB_RESPONDER_CACHE_FIRST "cache_first"
+#define CONFDB_RESPONDER_PARALLEL_DOMAIN_LOOKUP "parallel_domain_lookup"
+#define CONFDB_RESPONDER_OBJECT_CACHE_SIZE "object_cache_size"
+#define CONFDB_RESPONDER_OBJECT_CACHE_SIZE_DEFAULT 1024
+#define CONFDB_RESPONDER_OBJECT_CACHE_TIMEOUT "object_cache_timeout"
+#define CONFDB_RESPONDER_OBJECT_CACHE_TIMEOUT_DEFAULT 0
+#define CONFDB_RESPONDER_OBJECT_CACHE_SHARED "object_cache_shared"
+#define CONFDB_RESPONDER_OBJECT_CACHE_SHARED_DEFAULT false
+#define CONFDB_RESPONDER_PREFILTER_INTERVAL "prefilter_refresh_interval"
+#define CONFDB_RESPONDER_PREFILTER_INTERVAL_DEFAULT 0
+#define CONFDB_RESPONDER_PREFETCH_MIN_LOOKUPS "prefetch_min_lookups"
+#define CONFDB_RESPONDER_PREFETCH_MIN_LOOKUPS_DEFAULT 0
+#define CONFDB_RESPONDER_CLIENT_RATE_LIMIT "client_rate_limit"
+#define CONFDB_RESPONDER_CLIENT_RATE_LIMIT_DEFAULT 0
+#define CONFDB_RESPONDER_REQUEST_TRACE_SAMPLING "request_trace_sampling"
+#define CONFDB_RESPONDER_REQUEST_TRACE_SAMPLING_DEFAULT 0
+#define CONFDB_RESPONDER_REQUEST_POOL_SIZE "request_pool_size"
+#define CONFDB_RESPONDER_REQUEST_POOL_SIZE_DEFAULT 0
+#define CONFDB_RESPONDER_MEMORY_SOFT_LIMIT "memory_soft_limit"
+#define CONFDB_RESPONDER_MEMORY_SOFT_LIMIT_DEFAULT 0
 
 /* NSS */
 #define CONFDB_NSS_CONF_ENTRY "config/nss"
 #define CONFDB_NSS_ENUM_CACHE_TIMEOUT "enum_cache_timeout"
 #define CONFDB_NSS_ENTRY_CACHE_NOWAIT_PERCENTAGE "entry_cache_nowait_percentage"
 #define CONFDB_NSS_ENTRY_NEG_TIMEOUT "entry_negative_timeout"
+#define CONFDB_NSS_RESOLVER_NEG_TIMEOUT "resolver_negative_timeout"
 #define CONFDB_NSS_FILTER_USERS_IN_GROUPS "filter_users_in_groups"
 #define CONFDB_NSS_FILTER_USERS "filter_users"
 #define CONFDB_NSS_FILTER_GROUPS "filter_groups"
@@ -118,6 +141,14 @@
 #define CONFDB_NSS_MEMCACHE_SIZE_PASSWD "memcache_size_passwd"
 #define CONFDB_NSS_MEMCACHE_SIZE_GROUP "memcache_size_group"
 #define CONFDB_NSS_MEMCACHE_SIZE_INITGROUPS "memcache_size_initgroups"
+#define CONFDB_NSS_MEMCACHE_SIZE_SID "memcache_size_sid"
+#define CONFDB_NSS_MEMCACHE_SIZE_SERVICES "memcache_size_services"
+#define CONFDB_NSS_MEMCACHE_SIZE_HOSTS "memcache_size_hosts"
+#define CONFDB_NSS_MEMCACHE_SIZE_NETGROUPS "memcache_size_netgroups"
+#define CONFDB_NSS_MEMCACHE_WARMUP "memcache_warmup_entries"
+#define CONFDB_NSS_MEMCACHE_HASH "memcache_hash"
+#define CONFDB_NSS_MEMCACHE_MAX_TIMEOUT "memcache_max_timeout"
+#define CONFDB_NSS_WORKERS "workers"
 #define CONFDB_NSS_HOMEDIR_SUBSTRING "homedir_substring"
 #define CONFDB_DEFAULT_HOMEDIR_SUBSTRING "/home"
 
@@ -139,6 +170,7 @@
 #define CONFDB_PAM_CERT_AUTH "pam_cert_auth"
 #define CONFDB_PAM_CERT_DB_PATH "pam_cert_db_path"
 #define CONFDB_PAM_P11_CHILD_TIMEOUT "p11_child_timeout"
+#define CONFDB_PAM_P11_CHILD_SERVICE "p11_child_service"
 #define CONFDB_PAM_WAIT_FOR_CARD_TIMEOUT "p11_wait_for_card_timeout"
 #define CONFDB_PAM_APP_SERVICES "pam_app_services"
 #define CONFDB_PAM_P11_ALLOWED_SERVICES "pam_p11_allowed_services"
@@ -157,6 +189,8 @@
 #define CONFDB_DEFAULT_SUDO_INVERSE_ORDER false
 #define CONFDB_SUDO_THRESHOLD "sudo_threshold"
 #define CONFDB_DEFAULT_SUDO_THRESHOLD 50
+#define CONFDB_SUDO_RULES_CACHE_TIMEOUT "sudo_rules_cache_timeout"
+#define CONFDB_DEFAULT_SUDO_RULES_CACHE_TIMEOUT 5
 
 /* autofs */
 #define CONFDB_AUTOFS_CONF_ENTRY "config/autofs"
@@ -173,10 +207,13 @@
 #define CONFDB_SSH_USE_CERT_KEYS "ssh_use_certificate_keys"
 #define CONFDB_DEFAULT_SSH_USE_CERT_KEYS true
 #define CONFDB_SSH_USE_CERT_RULES "ssh_use_certificate_matching_rules"
+#define CONFDB_SSH_CERT_KEYS_CACHE_TIMEOUT "ssh_certificate_keys_cache_timeout"
+#define CONFDB_DEFAULT_SSH_CERT_KEYS_CACHE_TIMEOUT 60
 
 /* PAC */
 #define CONFDB_PAC_CONF_ENTRY "config/pac"
 #define CONFDB_PAC_LIFETIME "pac_lifetime"
+#define CONFDB_PAC_CACHE_TIMEOUT "pac_cache_timeout"
 
 /* InfoPipe */
 #define CONFDB_IFP_CONF_ENTRY "config/ifp"
@@ -208,6 +245,7 @@
 #define CONFDB_DOMAIN_SESSION_PROVIDER "session_provider"
 #define CONFDB_DOMAIN_RESOLVER_PROVIDER "resolver_provider"
 #define CONFDB_DOMAIN_COMMAND "command"
+#define CONFDB_DOMAIN_CPU_AFFINITY "cpu_affinity"
 #define CONFDB_DOMAIN_TIMEOUT "timeout"
 #define CONFDB_DOMAIN_ATTR "cn"
 #define CONFDB_DOMAIN_ENUMERATE "enumerate"
@@ -228,6 +266,8 @@
 #define CONFDB_DOMAIN_SUBDOMAIN_HOMEDIR "subdomain_homedir"
 #define CONFDB_DOMAIN_DEFAULT_SUBDOMAIN_HOMEDIR "/home/%d/%u"
 #define CONFDB_DOMAIN_IGNORE_GROUP_MEMBERS "ignore_group_members"
+#define CONFDB_DOMAIN_CACHE_BACKEND "cache_backend"
+#define CONFDB_DOMAIN_CACHE_NOSYNC "cache_nosync"
 #define CONFDB_DOMAIN_SUBDOMAIN_REFRESH "subdomain_refresh_interval"
 #define CONFDB_DOMAIN_SUBDOMAIN_REFRESH_DEFAULT_VALUE 14400
 
@@ -242,8 +282,11 @@
 #define CONFDB_DOMAIN_RESOLVER_CACHE_TIMEOUT "entry_cache_resolver_timeout"
 #define CONFDB_DOMAIN_PWD_EXPIRATION_WARNING "pwd_expiration_warning"
 #define CONFDB_DOMAIN_REFRESH_EXPIRED_INTERVAL "refresh_expired_interval"
+#define CONFDB_DOMAIN_REFRESH_EXPIRED_MAX_IDLE "refresh_expired_max_idle"
+#define CONFDB_DOMAIN_REFRESH_DEDUP_TIMEOUT "refresh_dedup_timeout"
 #define CONFDB_DOMAIN_OFFLINE_TIMEOUT "offline_timeout"
 #define CONFDB_DOMAIN_OFFLINE_TIMEOUT_MAX "offline_timeout_max"
+#define CONFDB_DOMAIN_FAILOVER_PREFER_FASTEST "failover_prefer_fastest"
 #define CONFDB_DOMAIN_SUBDOMAIN_INHERIT "subdomain_inherit"
 #define CONFDB_DOMAIN_CACHED_AUTH_TIMEOUT "cached_auth_timeout"
 #define CONFDB_DOMAIN_TYPE "domain_type"
@@ -267,6 +310,7 @@
 #define CONFDB_PROXY_PAM_TARGET "proxy_pam_target"
 #define CONFDB_PROXY_FAST_ALIAS "proxy_fast_alias"
 #define CONFDB_PROXY_MAX_CHILDREN "proxy_max_children"
+#define CONFDB_PROXY_ID_WORKERS "proxy_id_workers"
 
 /* Files Provider */
 #define CONFDB_FILES_PASSWD "passwd_files"
@@ -345,6 +389,11 @@ enum sss_domain_mpg_mode {
     MPG_HYBRID,
 };
 
+enum sss_domain_cache_backend {
+    SSS_CACHE_BACKEND_TDB,
+    SSS_CACHE_BACKEND_LMDB,
+};
+
 /**
  * Data structure storing all of the basic features
  * of a domain.
@@ -367,6 +416,8 @@ struct sss_domain_info {
 
     bool cache_credentials;
     uint32_t cache_credentials_min_ff_length;
+    enum sss_domain_cache_backend cache_backend;
+    bool cache_nosync;
     bool case_sensitive;
     bool case_preserve;
 
@@ -389,6 +440,7 @@ struct sss_domain_info {
     uint32_t resolver_timeout;
 
     uint32_t refresh_expired_interval;
+    uint32_t refresh_expired_max_idle;
     uint32_t subdomain_refresh_interval;
     uint32_t cached_auth_timeout;
 
@@ -412,6 +464,10 @@ struct sss_domain_info {
     struct sss_domain_info *next;
 
     enum sss_domain_state state;
+    /* Set by the backend while its servers fail or answer slowly, expired
+     * entries are then returned from the cache and refreshed in the
+     * background instead of waiting for the backend. */
+    bool degraded;
     char **sd_inherit;
 
     /* Do not use the forest pointer directly in new code, but rather the
@@ -437,6 +493,19 @@ struct sss_domain_info {
     /* List of PAM services that are allowed to authenticate with GSSAPI. */
     char **gssapi_services;
     char *gssapi_check_upn; /* true | false | NULL */
+
+    /* Output names formatted by the responders, see sized_output_name() */
+    struct sss_output_name_cache *output_names;
+
+    /* When all users and groups were invalidated and when these times
+     * were read, see sysdb_invalidate_type() */
+    time_t users_invalidated;
+    time_t groups_invalidated;
+    time_t invalidated_read;
+
+    /* Lookup tables of the domains following this one, see
+     * find_domain_by_name() */
+    struct sss_domain_index *index;
 };
 
 /**
@@ -455,6 +524,29 @@ int confdb_init(TALLOC_CTX *mem_ctx,
                 struct confdb_ctx **cdb_ctx,
                 const char *confdb_location);
 
+/**
+ * Read all sections of the ConfDB into memory
+ *
+ * A process reads hundreds of options while it starts, each of them with
+ * an ldb search of its own. After this call options are read from the
+ * in-memory copy until confdb_snapshot_drop() is called or the ConfDB is
+ * modified through this connection.
+ *
+ * @param[in] cdb The connection object to the confdb
+ *
+ * @return 0 - The snapshot was loaded
+ * @return ENOMEM - There was insufficient memory to complete the operation
+ * @return EIO - There was an I/O error communicating with the ConfDB file
+ */
+int confdb_snapshot_load(struct confdb_ctx *cdb);
+
+/**
+ * Read the options from the ConfDB again
+ *
+ * @param[in] cdb The connection object to the confdb
+ */
+void confdb_snapshot_drop(struct confdb_ctx *cdb);
+
 /**
  * Get a domain object for the named domain
  *
@@ -22,11 +22,16 @@
 #ifndef CONFDB_PRIVATE_H_
 #define CONFDB_PRIVATE_H_
 
+#include <dhash.h>
+
 struct confdb_ctx {
     struct tevent_context *pev;
     struct ldb_context *ldb;
 
     struct sss_domain_info *doms;
+
+    /* sections by their casefolded DN, see confdb_snapshot_load() */
+    hash_table_t *snapshot;
 };
 
 int parse_section(TALLOC_CTX *mem_ctx, const char *section,
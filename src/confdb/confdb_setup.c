@@ -307,6 +307,8 @@ static int confdb_init_db(const char *config_file,
 
     DEBUG(SSSDBG_CONF_SETTINGS, "LDIF file to import: \n%s\n", config_ldif);
 
+    confdb_snapshot_drop(cdb);
+
     /* Set up a transaction to replace the configuration */
     ret = ldb_transaction_start(cdb->ldb);
     if (ret != LDB_SUCCESS) {
@@ -26,9 +26,20 @@ class SSSDOptions(object):
         'command': _('Command to start service'),
         'reconnection_retries': _('Number of times to attempt connection to Data Providers'),
         'fd_limit': _('The number of file descriptors that may be opened by this responder'),
+        'cpu_affinity': _('The CPUs the process is bound to'),
         'client_idle_timeout': _('Idle time before automatic disconnection of a client'),
         'responder_idle_timeout': _('Idle time before automatic shutdown of the responder'),
         'cache_first': _('Always query all the caches before querying the Data Providers'),
+        'parallel_domain_lookup': _('Send the Data Provider lookups of all domains at the same time'),
+        'object_cache_size': _('Maximum size of the in-memory object cache in kilobytes'),
+        'object_cache_timeout': _('How long objects are kept in the in-memory object cache'),
+        'object_cache_shared': _('Share the object cache with the other responders'),
+        'prefilter_refresh_interval': _('How often the filters of the names cached in each domain are rebuilt'),
+        'prefetch_min_lookups': _('Number of lookups after which an object is refreshed before it expires'),
+        'client_rate_limit': _('Number of requests per second served to the clients of each user'),
+        'request_trace_sampling': _('One of how many client requests logs the time spent in each stage'),
+        'request_pool_size': _('Size of the memory pool of each client request'),
+        'memory_soft_limit': _('Memory in MiB above which the responder drops its caches'),
         'offline_timeout': _('When SSSD switches to offline mode the amount of time before it tries to go back online '
                              'will increase based upon the time spent disconnected. This value is in seconds and '
                              'calculated by the following: offline_timeout + random_offset.'),
@@ -54,12 +65,14 @@ class SSSDOptions(object):
         'try_inotify': _('SSSD monitors the state of resolv.conf to identify when it needs to update its internal DNS '
                          'resolver. By default, we will attempt to use inotify for this, and will fall back to '
                          'polling resolv.conf every five seconds if inotify cannot be used.'),
+        'parallel_startup': _('Start the responders without waiting for the providers'),
 
         # [nss]
         'enum_cache_timeout': _('Enumeration cache timeout length (seconds)'),
         'entry_cache_no_wait_timeout': _('Entry cache background update timeout length (seconds)'),
         'entry_negative_timeout': _('Negative cache timeout length (seconds)'),
         'local_negative_timeout': _('Files negative cache timeout length (seconds)'),
+        'resolver_negative_timeout': _('Hosts and networks negative cache timeout length (seconds)'),
         'filter_users': _('Users that SSSD should explicitly ignore'),
         'filter_groups': _('Groups that SSSD should explicitly ignore'),
         'filter_users_in_groups': _('Should filtered users appear in groups'),
@@ -72,9 +85,17 @@ class SSSDOptions(object):
         'shell_fallback': _('If a shell stored in central directory is allowed but not available, use this fallback'),
         'default_shell': _('Shell to use if the provider does not list one'),
         'memcache_timeout': _('How long will be in-memory cache records valid'),
+        'memcache_max_timeout': _('How long the in-memory cache records of objects which do not expire in the cache are valid'),
         'memcache_size_passwd': _('Size (in megabytes) of the data table allocated inside fast in-memory cache for passwd requests'),
         'memcache_size_group': _('Size (in megabytes) of the data table allocated inside fast in-memory cache for group requests'),
         'memcache_size_initgroups': _('Size (in megabytes) of the data table allocated inside fast in-memory cache for initgroups requests'),
+        'memcache_size_sid': _('Size (in megabytes) of the data table allocated inside fast in-memory cache for SID and name-to-SID requests'),
+        'memcache_size_services': _('Size (in megabytes) of the data table allocated inside fast in-memory cache for services requests'),
+        'memcache_size_hosts': _('Size (in megabytes) of the data table allocated inside fast in-memory cache for hosts requests'),
+        'memcache_size_netgroups': _('Size (in megabytes) of the data table allocated inside fast in-memory cache for netgroup requests'),
+        'memcache_warmup_entries': _('Number of cached users and groups loaded into the fast in-memory cache at startup'),
+        'memcache_hash': _('Hash function of the keys of the fast in-memory cache'),
+        'workers': _('Number of processes that serve NSS requests'),
         'homedir_substring': _('The value of this option will be used in the expansion of the override_homedir option '
                                'if the template contains the format string %H.'),
         'get_domains_timeout': _('Specifies time in seconds for which the list of subdomains will be considered '
@@ -99,6 +120,7 @@ class SSSDOptions(object):
         'pam_cert_auth': _('Allow certificate based/Smartcard authentication.'),
         'pam_cert_db_path': _('Path to certificate database with PKCS#11 modules.'),
         'p11_child_timeout': _('How many seconds will pam_sss wait for p11_child to finish'),
+        'p11_child_service': _('Keep a single p11_child running for all Smartcard and certificate checks'),
         'pam_app_services': _('Which PAM services are permitted to contact application domains'),
         'pam_p11_allowed_services': _('Allowed services for using smartcards'),
         'p11_wait_for_card_timeout': _('Additional timeout to wait for a card if requested'),
@@ -112,6 +134,7 @@ class SSSDOptions(object):
         'sudo_inverse_order': _('If true, SSSD will switch back to lower-wins ordering logic'),
         'sudo_threshold': _('Maximum number of rules that can be refreshed at once. If this is exceeded, full refresh '
                             'is performed.'),
+        'sudo_rules_cache_timeout': _('How long the sudo responder keeps the rules of a user in memory'),
 
         # [autofs]
         'autofs_negative_timeout': _('Negative cache timeout length (seconds)'),
@@ -124,10 +147,12 @@ class SSSDOptions(object):
         'ssh_use_certificate_keys': _('Allow to generate ssh-keys from certificates'),
         'ssh_use_certificate_matching_rules': _('Use the following matching rules to filter the certificates for '
                                                 'ssh-key generation'),
+        'ssh_certificate_keys_cache_timeout': _('How many seconds to reuse ssh keys derived from a certificate'),
 
         # [pac]
         'allowed_uids': _('List of UIDs or user names allowed to access the PAC responder'),
         'pac_lifetime': _('How long the PAC data is considered valid'),
+        'pac_cache_timeout': _('How long a stored PAC is not stored again'),
 
         # [ifp]
         'user_attributes': _('List of user attributes the InfoPipe is allowed to publish'),
@@ -189,6 +214,8 @@ class SSSDOptions(object):
         'cache_credentials': _('Cache credentials for offline login'),
         'use_fully_qualified_names': _('Display users/groups in fully-qualified form'),
         'ignore_group_members': _('Don\'t include group members in group lookups'),
+        'cache_backend': _('Database backend of the cache'),
+        'cache_nosync': _('Do not wait for the cache to be written to disk'),
         'entry_cache_timeout': _('Entry cache timeout length (seconds)'),
         'lookup_family_order': _('Restrict or prefer a specific address family when performing DNS lookups'),
         'account_cache_expiration': _('How long to keep cached entries after last successful login (days)'),
@@ -196,6 +223,7 @@ class SSSDOptions(object):
                                          'miliseconds)'),
         'dns_resolver_op_timeout': _('How long should keep trying to resolve single DNS query (seconds)'),
         'dns_resolver_timeout': _('How long to wait for replies from DNS when resolving servers (seconds)'),
+        'dns_resolver_cache_size': _('How many host name lookups to cache, 0 disables the cache'),
         'dns_discovery_domain': _('The domain part of service discovery DNS query'),
         'override_gid': _('Override GID value from the identity provider with this value'),
         'case_sensitive': _('Treat usernames as case sensitive'),
@@ -207,6 +235,9 @@ class SSSDOptions(object):
         'entry_cache_sudo_timeout': _('Entry cache timeout length (seconds)'),
         'entry_cache_resolver_timeout' : _('Entry cache timeout length (seconds)'),
         'refresh_expired_interval': _('How often should expired entries be refreshed in background'),
+        'failover_prefer_fastest': _('Prefer the working server with the lowest latency among servers of the same priority'),
+        'refresh_expired_max_idle': _('How many refresh periods an entry may go unused and still be refreshed in background'),
+        'refresh_dedup_timeout': _('How long a successful lookup answers the refreshes of the same entry (seconds)'),
         'dyndns_update': _("Whether to automatically update the client's DNS entry"),
         'dyndns_ttl': _("The TTL to apply to the client's DNS entry after updating it"),
         'dyndns_iface': _("The interface whose IP should be used for dynamic DNS updates"),
@@ -325,6 +356,9 @@ class SSSDOptions(object):
                                                       'database'),
         'ad_use_ldaps': _('Use LDAPS port for LDAP and Global Catalog requests'),
         'ad_allow_remote_domain_local_groups' : _('Do not filter domain local groups from other domains'),
+        'ad_discovery_cache_timeout': _('How long the discovered site and servers are kept on disk'),
+        'ad_pac_reconcile_initgroups': _('Verify the group memberships from the PAC with LDAP in the background'),
+        'ad_parallel_gc_lookup': _('Search the Global Catalog and the domain LDAP server at the same time'),
 
         # [provider/krb5]
         'krb5_kdcip': _('Kerberos server address'),
@@ -349,6 +383,9 @@ class SSSDOptions(object):
         'krb5_canonicalize': _("Enables principal canonicalization"),
         'krb5_use_enterprise_principal': _("Enables enterprise principals"),
         'krb5_map_user': _('A mapping from user names to Kerberos principal names'),
+        'krb5_child_pool_size': _('Number of long-lived krb5_child worker processes'),
+        'krb5_child_pool_max_requests': _('Number of requests a krb5_child worker serves before it is replaced'),
+        'krb5_child_max_concurrent': _('Maximum number of krb5_child requests running at the same time'),
 
         # [provider/krb5/chpass]
         'krb5_kpasswd': _('Server where the change password service is running if not on the KDC'),
@@ -491,6 +528,16 @@ class SSSDOptions(object):
         'ldap_pwdlockout_dn': _('DN for ppolicy queries'),
         'wildcard_limit': _('How many maximum entries to fetch during a wildcard request'),
         'ldap_library_debug_level': _('Set libldap debug level'),
+        'ldap_connection_pool_size': _('Maximum number of connections used for identity lookups'),
+        'ldap_group_member_batch_size': _('Maximum number of group members looked up with one search'),
+        'ldap_sync_mode': _('Mode used to receive change notifications from the server'),
+        'ldap_page_size_min': _('Smallest page size the paged searches may shrink to'),
+        'ldap_page_size_max': _('Largest page size the paged searches may grow to'),
+        'ldap_connection_race_servers': _('Number of servers connected to at the same time when going online'),
+        'ldap_connection_race_delay': _('Milliseconds to wait for a connection before trying the next server as well'),
+        'ldap_auth_connection_pool_size': _('Maximum number of idle connections kept for user authentication'),
+        'ldap_nested_group_parallel': _('Number of nested groups resolved at the same time'),
+        'ldap_save_chunk_size': _('Number of users or groups of a large search result stored in one transaction'),
 
         # [provider/ldap/auth]
         'ldap_pwd_policy': _('Policy to evaluate the password expiration'),
@@ -499,6 +546,7 @@ class SSSDOptions(object):
         'ldap_access_filter': _('LDAP filter to determine access privileges'),
         'ldap_account_expire_policy': _('Which attributes shall be used to evaluate if an account is expired'),
         'ldap_access_order': _('Which rules should be used to evaluate access control'),
+        'ldap_access_cache_timeout': _('How many seconds an access filter decision is reused for'),
 
         # [provider/ldap/chpass]
         'ldap_chpass_uri': _('URI of an LDAP server where password changes are allowed'),
@@ -558,6 +606,7 @@ class SSSDOptions(object):
                                  'groups within this SSSD domain. Local groups are not evaluated.'),
         'simple_deny_groups': _('Comma separated list of groups that are explicitly denied access. This applies only '
                                 'to groups within this SSSD domain. Local groups are not evaluated.'),
+        'simple_access_cache_timeout': _('How many seconds an access decision is reused for'),
 
         # [provider/local/id]
         'base_directory': _('Base for home directories'),
@@ -575,6 +624,7 @@ class SSSDOptions(object):
         'proxy_lib_name': _('The name of the NSS library to use'),
         'proxy_resolver_lib_name' : _('The name of the NSS library to use for hosts and networks lookups'),
         'proxy_fast_alias': _('Whether to look up canonical group name from cache if possible'),
+        'proxy_id_workers': _('The number of processes running the NSS calls of the proxy provider'),
 
         # [provider/proxy/auth]
         'proxy_pam_target': _('PAM stack to use'),
@@ -385,9 +385,19 @@ class SSSDConfigTestSSSDService(unittest.TestCase):
             'command',
             'reconnection_retries',
             'fd_limit',
+            'cpu_affinity',
             'client_idle_timeout',
             'responder_idle_timeout',
             'cache_first',
+            'parallel_domain_lookup',
+            'object_cache_size',
+            'object_cache_timeout',
+            'prefilter_refresh_interval',
+            'prefetch_min_lookups',
+            'client_rate_limit',
+            'request_trace_sampling',
+            'request_pool_size',
+            'memory_soft_limit',
             'description',
             'certificate_verification',
             'override_space',
@@ -396,6 +406,7 @@ class SSSDConfigTestSSSDService(unittest.TestCase):
             'domain_resolution_order',
             'try_inotify',
             'monitor_resolv_conf',
+            'parallel_startup',
         ]
 
         self.assertTrue(type(options) == dict,
@@ -594,12 +605,16 @@ class SSSDConfigTestSSSDDomain(unittest.TestCase):
             'timeout',
             'offline_timeout',
             'offline_timeout_max',
+            'failover_prefer_fastest',
             'command',
+            'cpu_affinity',
             'enumerate',
             'cache_credentials',
             'cache_credentials_minimal_first_factor_length',
             'use_fully_qualified_names',
             'ignore_group_members',
+            'cache_backend',
+            'cache_nosync',
             'filter_users',
             'filter_groups',
             'entry_cache_timeout',
@@ -612,11 +627,13 @@ class SSSDConfigTestSSSDDomain(unittest.TestCase):
             'entry_cache_ssh_host_timeout',
             'entry_cache_resolver_timeout',
             'refresh_expired_interval',
+            'refresh_expired_max_idle',
             'lookup_family_order',
             'account_cache_expiration',
             'dns_resolver_server_timeout',
             'dns_resolver_op_timeout',
             'dns_resolver_timeout',
+            'dns_resolver_cache_size',
             'dns_discovery_domain',
             'dyndns_update',
             'dyndns_ttl',
@@ -739,7 +756,10 @@ class SSSDConfigTestSSSDDomain(unittest.TestCase):
              'krb5_canonicalize',
              'krb5_use_enterprise_principal',
              'krb5_use_kdcinfo',
-             'krb5_map_user'])
+             'krb5_map_user',
+             'krb5_child_pool_size',
+             'krb5_child_pool_max_requests',
+             'krb5_child_max_concurrent'])
 
         options = domain.list_options()
 
@@ -902,7 +922,10 @@ class SSSDConfigTestSSSDDomain(unittest.TestCase):
             'krb5_canonicalize',
             'krb5_use_enterprise_principal',
             'krb5_use_kdcinfo',
-            'krb5_map_user']
+            'krb5_map_user',
+            'krb5_child_pool_size',
+            'krb5_child_pool_max_requests',
+            'krb5_child_max_concurrent']
 
         self.assertTrue(type(options) == dict,
                         "Options should be a dictionary")
@@ -973,12 +996,16 @@ class SSSDConfigTestSSSDDomain(unittest.TestCase):
             'timeout',
             'offline_timeout',
             'offline_timeout_max',
+            'failover_prefer_fastest',
             'command',
+            'cpu_affinity',
             'enumerate',
             'cache_credentials',
             'cache_credentials_minimal_first_factor_length',
             'use_fully_qualified_names',
             'ignore_group_members',
+            'cache_backend',
+            'cache_nosync',
             'filter_users',
             'filter_groups',
             'entry_cache_timeout',
@@ -991,11 +1018,13 @@ class SSSDConfigTestSSSDDomain(unittest.TestCase):
             'entry_cache_ssh_host_timeout',
             'entry_cache_resolver_timeout',
             'refresh_expired_interval',
+            'refresh_expired_max_idle',
             'account_cache_expiration',
             'lookup_family_order',
             'dns_resolver_server_timeout',
             'dns_resolver_op_timeout',
             'dns_resolver_timeout',
+            'dns_resolver_cache_size',
             'dns_discovery_domain',
             'dyndns_update',
             'dyndns_ttl',
@@ -1119,7 +1148,10 @@ class SSSDConfigTestSSSDDomain(unittest.TestCase):
              'krb5_canonicalize',
              'krb5_use_enterprise_principal',
              'krb5_use_kdcinfo',
-             'krb5_map_user'])
+             'krb5_map_user',
+             'krb5_child_pool_size',
+             'krb5_child_pool_max_requests',
+             'krb5_child_max_concurrent'])
 
         options = domain.list_options()
 
@@ -21,6 +21,7 @@
 */
 
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
 #include "util/strtonum.h"
 #include "util/sss_utf8.h"
 #include "util/crypto/sss_crypto.h"
@@ -116,34 +117,61 @@ done:
     return dn;
 }
 
-struct ldb_dn *sysdb_user_dn(TALLOC_CTX *mem_ctx, struct sss_domain_info *dom,
-                             const char *name)
+/* Every search of a user or group starts by building the base DN of its
+ * domain, which ldb parses and casefolds again for each search. The parsed
+ * DNs are kept per sysdb, each caller gets a copy of one. There are only a
+ * few of them for each domain and they never change, so they are kept as
+ * long as the sysdb. */
+static struct ldb_dn *sysdb_cached_base_dn(TALLOC_CTX *mem_ctx,
+                                           struct sss_domain_info *dom,
+                                           const char *tmpl)
 {
-    errno_t ret;
-    char *clean_name;
+    struct sysdb_ctx *sysdb = dom->sysdb;
+    struct ldb_dn *cached;
     struct ldb_dn *dn;
+    char *key;
+    errno_t ret;
 
-    ret = sysdb_dn_sanitize(NULL, name, &clean_name);
-    if (ret != EOK) {
+    key = talloc_asprintf(NULL, tmpl, dom->name);
+    if (key == NULL) {
         return NULL;
     }
 
-    dn = ldb_dn_new_fmt(mem_ctx, dom->sysdb->ldb, SYSDB_TMPL_USER,
-                        clean_name, dom->name);
-    talloc_free(clean_name);
+    if (sysdb->base_dns == NULL) {
+        sysdb->base_dns = sss_ptr_hash_create(sysdb, NULL, NULL);
+        if (sysdb->base_dns == NULL) {
+            goto uncached;
+        }
+    }
 
-    return dn;
-}
+    cached = sss_ptr_hash_lookup(sysdb->base_dns, key, struct ldb_dn);
+    if (cached == NULL) {
+        cached = ldb_dn_new(sysdb->base_dns, sysdb->ldb, key);
+        if (cached == NULL || ldb_dn_get_casefold(cached) == NULL) {
+            talloc_free(cached);
+            goto uncached;
+        }
 
-struct ldb_dn *sysdb_user_base_dn(TALLOC_CTX *mem_ctx,
-                                  struct sss_domain_info *dom)
-{
-    return ldb_dn_new_fmt(mem_ctx, dom->sysdb->ldb,
-                          SYSDB_TMPL_USER_BASE, dom->name);
+        ret = sss_ptr_hash_add(sysdb->base_dns, key, cached, struct ldb_dn);
+        if (ret != EOK) {
+            talloc_free(cached);
+            goto uncached;
+        }
+    }
+
+    talloc_free(key);
+    return ldb_dn_copy(mem_ctx, cached);
+
+uncached:
+    dn = ldb_dn_new(mem_ctx, sysdb->ldb, key);
+    talloc_free(key);
+    return dn;
 }
 
-struct ldb_dn *sysdb_group_dn(TALLOC_CTX *mem_ctx,
-                              struct sss_domain_info *dom, const char *name)
+static struct ldb_dn *sysdb_cached_object_dn(TALLOC_CTX *mem_ctx,
+                                             struct sss_domain_info *dom,
+                                             const char *base_tmpl,
+                                             const char *name)
 {
     errno_t ret;
     char *clean_name;
@@ -154,18 +182,39 @@ struct ldb_dn *sysdb_group_dn(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    dn = ldb_dn_new_fmt(mem_ctx, dom->sysdb->ldb, SYSDB_TMPL_GROUP,
-                        clean_name, dom->name);
+    /* only the RDN of the object is parsed */
+    dn = sysdb_cached_base_dn(mem_ctx, dom, base_tmpl);
+    if (dn != NULL && !ldb_dn_add_child_fmt(dn, SYSDB_NAME"=%s",
+                                            clean_name)) {
+        talloc_zfree(dn);
+    }
     talloc_free(clean_name);
 
     return dn;
 }
 
+struct ldb_dn *sysdb_user_dn(TALLOC_CTX *mem_ctx, struct sss_domain_info *dom,
+                             const char *name)
+{
+    return sysdb_cached_object_dn(mem_ctx, dom, SYSDB_TMPL_USER_BASE, name);
+}
+
+struct ldb_dn *sysdb_user_base_dn(TALLOC_CTX *mem_ctx,
+                                  struct sss_domain_info *dom)
+{
+    return sysdb_cached_base_dn(mem_ctx, dom, SYSDB_TMPL_USER_BASE);
+}
+
+struct ldb_dn *sysdb_group_dn(TALLOC_CTX *mem_ctx,
+                              struct sss_domain_info *dom, const char *name)
+{
+    return sysdb_cached_object_dn(mem_ctx, dom, SYSDB_TMPL_GROUP_BASE, name);
+}
+
 struct ldb_dn *sysdb_group_base_dn(TALLOC_CTX *mem_ctx,
                                    struct sss_domain_info *dom)
 {
-    return ldb_dn_new_fmt(mem_ctx, dom->sysdb->ldb,
-                          SYSDB_TMPL_GROUP_BASE, dom->name);
+    return sysdb_cached_base_dn(mem_ctx, dom, SYSDB_TMPL_GROUP_BASE);
 }
 
 
@@ -262,7 +311,157 @@ errno_t sysdb_group_dn_name(struct sysdb_ctx *sysdb, TALLOC_CTX *mem_ctx,
 struct ldb_dn *sysdb_domain_dn(TALLOC_CTX *mem_ctx,
                                struct sss_domain_info *dom)
 {
-    return ldb_dn_new_fmt(mem_ctx, dom->sysdb->ldb, SYSDB_DOM_BASE, dom->name);
+    return sysdb_cached_base_dn(mem_ctx, dom, SYSDB_DOM_BASE);
+}
+
+static struct ldb_parse_tree *sysdb_parse_name_filter(struct sysdb_ctx *sysdb,
+                                                      const char *tmpl)
+{
+    struct ldb_parse_tree *tree;
+    struct ldb_parse_tree *names;
+    char *filter;
+    unsigned int i;
+
+    filter = talloc_asprintf(NULL, tmpl, "x", "x", "x");
+    if (filter == NULL) {
+        return NULL;
+    }
+
+    tree = ldb_parse_tree(sysdb, filter);
+    talloc_free(filter);
+    if (tree == NULL) {
+        return NULL;
+    }
+
+    /* (&(objectCategory=...)(|(nameAlias=x)(nameAlias=x)(name=x))) */
+    if (tree->operation != LDB_OP_AND || tree->u.list.num_elements != 2) {
+        goto fail;
+    }
+
+    names = tree->u.list.elements[1];
+    if (names->operation != LDB_OP_OR || names->u.list.num_elements != 3) {
+        goto fail;
+    }
+
+    for (i = 0; i < names->u.list.num_elements; i++) {
+        if (names->u.list.elements[i]->operation != LDB_OP_EQUALITY) {
+            goto fail;
+        }
+    }
+
+    return tree;
+
+fail:
+    DEBUG(SSSDBG_CRIT_FAILURE, "Unexpected structure of filter [%s]\n", tmpl);
+    talloc_free(tree);
+    return NULL;
+}
+
+static void sysdb_set_filter_value(struct ldb_parse_tree *equality,
+                                   const char *value)
+{
+    equality->u.equality.value.data = discard_const(value);
+    equality->u.equality.value.length = strlen(value);
+}
+
+errno_t sysdb_name_filter_tree(TALLOC_CTX *mem_ctx,
+                               struct sss_domain_info *dom,
+                               enum sysdb_obj_type type,
+                               const char *name,
+                               struct ldb_parse_tree **_tree)
+{
+    struct sysdb_ctx *sysdb = dom->sysdb;
+    struct ldb_parse_tree **cached;
+    struct ldb_parse_tree *names;
+    struct ldb_parse_tree *tree;
+    const char *tmpl;
+    char *lc_name;
+
+    switch (type) {
+    case SYSDB_USER:
+        cached = &sysdb->pwnam_tree;
+        tmpl = SYSDB_PWNAM_FILTER;
+        break;
+    case SYSDB_GROUP:
+        cached = &sysdb->grnam_tree;
+        tmpl = SYSDB_GRNAM_FILTER;
+        break;
+    default:
+        return EINVAL;
+    }
+
+    if (*cached == NULL) {
+        *cached = sysdb_parse_name_filter(sysdb, tmpl);
+        if (*cached == NULL) {
+            return ERR_INTERNAL;
+        }
+    }
+
+    tree = ldb_parse_tree_copy_shallow(mem_ctx, *cached);
+    if (tree == NULL) {
+        return ENOMEM;
+    }
+
+    if (dom->case_sensitive) {
+        lc_name = talloc_strdup(tree, name);
+    } else {
+        lc_name = sss_tc_utf8_str_tolower(tree, name);
+    }
+    if (lc_name == NULL) {
+        talloc_free(tree);
+        return ENOMEM;
+    }
+
+    /* The values of the parsed filter are not escaped, so the name is used
+     * as it is. The copy shares the values of the cached tree, they are
+     * replaced instead of modified. */
+    names = tree->u.list.elements[1];
+    sysdb_set_filter_value(names->u.list.elements[0], lc_name);
+    sysdb_set_filter_value(names->u.list.elements[1], name);
+    sysdb_set_filter_value(names->u.list.elements[2], name);
+
+    *_tree = tree;
+    return EOK;
+}
+
+int sysdb_search_tree(TALLOC_CTX *mem_ctx,
+                      struct ldb_context *ldb,
+                      struct ldb_dn *base_dn,
+                      enum ldb_scope scope,
+                      struct ldb_parse_tree *tree,
+                      const char **attrs,
+                      struct ldb_result **_res)
+{
+    struct ldb_request *req;
+    struct ldb_result *res;
+    int ret;
+
+    res = talloc_zero(mem_ctx, struct ldb_result);
+    if (res == NULL) {
+        return LDB_ERR_OPERATIONS_ERROR;
+    }
+
+    ret = ldb_build_search_req_ex(&req, ldb, res, base_dn, scope, tree,
+                                  attrs, NULL, res,
+                                  ldb_search_default_callback, NULL);
+    if (ret != LDB_SUCCESS) {
+        talloc_free(res);
+        return ret;
+    }
+
+    ret = ldb_request(ldb, req);
+    if (ret == LDB_SUCCESS) {
+        ret = ldb_wait(req->handle, LDB_WAIT_ALL);
+    }
+    talloc_free(req);
+
+    if (ret != LDB_SUCCESS) {
+        talloc_free(res);
+        return ret;
+    }
+
+    *_res = res;
+    return LDB_SUCCESS;
 }
 
 struct ldb_dn *sysdb_base_dn(struct sysdb_ctx *sysdb, TALLOC_CTX *mem_ctx)
@@ -532,6 +731,41 @@ int sysdb_attrs_add_val(struct sysdb_attrs *attrs,
     return sysdb_attrs_add_val_int(attrs, name, false, val);
 }
 
+int sysdb_attrs_add_vals(struct sysdb_attrs *attrs, const char *name,
+                         const struct ldb_val *vals, size_t num_vals)
+{
+    struct ldb_message_element *el = NULL;
+    struct ldb_val *new_vals;
+    size_t c;
+    int ret;
+
+    if (num_vals == 0) {
+        return EOK;
+    }
+
+    ret = sysdb_attrs_get_el(attrs, name, &el);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    new_vals = talloc_realloc(attrs->a, el->values,
+                              struct ldb_val, el->num_values + num_vals);
+    if (new_vals == NULL) {
+        return ENOMEM;
+    }
+    el->values = new_vals;
+
+    for (c = 0; c < num_vals; c++) {
+        new_vals[el->num_values] = ldb_val_dup(new_vals, &vals[c]);
+        if (new_vals[el->num_values].data == NULL && vals[c].length != 0) {
+            return ENOMEM;
+        }
+        el->num_values++;
+    }
+
+    return EOK;
+}
+
 /* Check if the same value already exists. */
 int sysdb_attrs_add_val_safe(struct sysdb_attrs *attrs,
                              const char *name, const struct ldb_val *val)
@@ -873,6 +1107,33 @@ char *sysdb_group_strdn(TALLOC_CTX *mem_ctx,
 
 /* =Transactions========================================================== */
 
+static void sysdb_transaction_finished(struct sysdb_ctx *sysdb)
+{
+    struct timeval now;
+    uint64_t usecs;
+
+    if (sysdb->transaction_nesting != 0) {
+        return;
+    }
+
+    now = tevent_timeval_current();
+    usecs = (now.tv_sec - sysdb->transaction_start.tv_sec) * UINT64_C(1000000)
+            + now.tv_usec - sysdb->transaction_start.tv_usec;
+    sysdb->num_transactions++;
+    sysdb->transaction_usecs += usecs;
+
+    SSS_PROF_POP("sysdb_transaction");
+    sss_prof_record("sysdb_transaction", usecs);
+}
+
+void sysdb_get_transaction_stats(struct sysdb_ctx *sysdb,
+                                 uint64_t *_count,
+                                 uint64_t *_usecs)
+{
+    *_count = sysdb->num_transactions;
+    *_usecs = sysdb->transaction_usecs;
+}
+
 int sysdb_transaction_start(struct sysdb_ctx *sysdb)
 {
     int ret;
@@ -880,6 +1141,10 @@ int sysdb_transaction_start(struct sysdb_ctx *sysdb)
     ret = ldb_transaction_start(sysdb->ldb);
     if (ret == LDB_SUCCESS) {
         PROBE(SYSDB_TRANSACTION_START, sysdb->transaction_nesting);
+        if (sysdb->transaction_nesting == 0) {
+            sysdb->transaction_start = tevent_timeval_current();
+            SSS_PROF_PUSH("sysdb_transaction");
+        }
         sysdb->transaction_nesting++;
     } else {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -900,6 +1165,7 @@ int sysdb_transaction_commit(struct sysdb_ctx *sysdb)
     if (ret == LDB_SUCCESS) {
         sysdb->transaction_nesting--;
         PROBE(SYSDB_TRANSACTION_COMMIT_AFTER, sysdb->transaction_nesting);
+        sysdb_transaction_finished(sysdb);
     } else {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Failed to commit ldb transaction! (%d)\n", ret);
@@ -915,6 +1181,7 @@ int sysdb_transaction_cancel(struct sysdb_ctx *sysdb)
     if (ret == LDB_SUCCESS) {
         sysdb->transaction_nesting--;
         PROBE(SYSDB_TRANSACTION_CANCEL, sysdb->transaction_nesting);
+        sysdb_transaction_finished(sysdb);
     } else {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Failed to cancel ldb transaction! (%d)\n", ret);
@@ -1915,31 +2182,31 @@ int sysdb_delete_ulong(struct ldb_message *msg,
 
 bool is_ts_ldb_dn(struct ldb_dn *dn)
 {
+    static const char *ts_containers[] = { "users", "groups", "Netgroups",
+                                           "services", "hosts", "sudorules",
+                                           NULL };
     const char *sysdb_comp_name = NULL;
     const struct ldb_val *sysdb_comp_val = NULL;
+    size_t i;
 
     if (dn == NULL) {
         return false;
     }
 
     sysdb_comp_name = ldb_dn_get_component_name(dn, 1);
-    if (strcasecmp("cn", sysdb_comp_name) != 0) {
+    if (sysdb_comp_name == NULL || strcasecmp("cn", sysdb_comp_name) != 0) {
         /* The second component name is not "cn" */
         return false;
     }
 
     sysdb_comp_val = ldb_dn_get_component_val(dn, 1);
-    if (strncasecmp("users",
-                    (const char *) sysdb_comp_val->data,
-                    sysdb_comp_val->length) == 0) {
-        return true;
-    }
-
-    sysdb_comp_val = ldb_dn_get_component_val(dn, 1);
-    if (strncasecmp("groups",
-                    (const char *) sysdb_comp_val->data,
-                    sysdb_comp_val->length) == 0) {
-        return true;
+    for (i = 0; ts_containers[i] != NULL; i++) {
+        if (strlen(ts_containers[i]) == sysdb_comp_val->length
+                && strncasecmp(ts_containers[i],
+                               (const char *) sysdb_comp_val->data,
+                               sysdb_comp_val->length) == 0) {
+            return true;
+        }
     }
 
     return false;
@@ -98,6 +98,9 @@
 #define SYSDB_LAST_UPDATE "lastUpdate"
 #define SYSDB_CACHE_EXPIRE "dataExpireTimestamp"
 #define SYSDB_INITGR_EXPIRE "initgrExpireTimestamp"
+#define SYSDB_LAST_ACCESS "lastAccess"
+#define SYSDB_USERS_INVALIDATED "usersInvalidated"
+#define SYSDB_GROUPS_INVALIDATED "groupsInvalidated"
 #define SYSDB_ENUM_EXPIRE "enumerationExpireTimestamp"
 #define SYSDB_IFP_CACHED "ifpCached"
 
@@ -146,6 +149,7 @@
 #define SYSDB_AUTH_TYPE "authType"
 #define SYSDB_USER_CERT "userCertificate"
 #define SYSDB_USER_MAPPED_CERT "userMappedCertificate"
+#define SYSDB_USER_MAPPED_CERT_HASH "userMappedCertificateHash"
 #define SYSDB_USER_EMAIL "mail"
 
 #define SYSDB_SUBDOMAIN_REALM "realmName"
@@ -189,6 +193,9 @@
 #define SYSDB_OVERRIDE_GROUP_CLASS "groupOverride"
 #define SYSDB_OVERRIDE_DN "overrideDN"
 #define SYSDB_OVERRIDE_OBJECT_DN "overrideObjectDN"
+/* The override DN the override values stored with an original object were
+ * copied from, see sysdb_store_override() */
+#define SYSDB_MERGED_OVERRIDE_DN "mergedOverrideDN"
 #define SYSDB_USE_DOMAIN_RESOLUTION_ORDER "useDomainResolutionOrder"
 #define SYSDB_DOMAIN_RESOLUTION_ORDER "domainResolutionOrder"
 #define SYSDB_SESSION_RECORDING "sessionRecording"
@@ -226,6 +233,7 @@
 #define SYSDB_NAME_FILTER "(&(|("SYSDB_UC")("SYSDB_GC"))(|("SYSDB_NAME_ALIAS"=%s)("SYSDB_NAME"=%s)))"
 #define SYSDB_ID_FILTER "(|(&("SYSDB_UC")("SYSDB_UIDNUM"=%u))(&("SYSDB_GC")("SYSDB_GIDNUM"=%u)))"
 #define SYSDB_USER_CERT_FILTER "(&("SYSDB_UC")%s)"
+#define SYSDB_USER_CERT_HASH_FILTER "(&("SYSDB_UC")("SYSDB_USER_MAPPED_CERT_HASH"=%s))"
 
 #define SYSDB_HAS_ENUMERATED "has_enumerated"
 #define SYSDB_HAS_ENUMERATED_ID       0x00000001
@@ -234,9 +242,20 @@
 #define SYSDB_DEFAULT_ATTRS SYSDB_LAST_UPDATE, \
                             SYSDB_CACHE_EXPIRE, \
                             SYSDB_INITGR_EXPIRE, \
+                            SYSDB_LAST_ACCESS, \
                             SYSDB_OBJECTCLASS, \
                             SYSDB_OBJECTCATEGORY
 
+#define SYSDB_MERGED_OVERRIDE_ATTRS SYSDB_MERGED_OVERRIDE_DN, \
+                                    OVERRIDE_PREFIX SYSDB_UIDNUM, \
+                                    OVERRIDE_PREFIX SYSDB_GIDNUM, \
+                                    OVERRIDE_PREFIX SYSDB_GECOS, \
+                                    OVERRIDE_PREFIX SYSDB_HOMEDIR, \
+                                    OVERRIDE_PREFIX SYSDB_SHELL, \
+                                    OVERRIDE_PREFIX SYSDB_NAME, \
+                                    OVERRIDE_PREFIX SYSDB_SSH_PUBKEY, \
+                                    OVERRIDE_PREFIX SYSDB_USER_CERT
+
 #define SYSDB_PW_ATTRS {SYSDB_NAME, SYSDB_UIDNUM, \
                         SYSDB_GIDNUM, SYSDB_GECOS, \
                         SYSDB_HOMEDIR, SYSDB_SHELL, \
@@ -248,20 +267,24 @@
                         SYSDB_USER_EMAIL, \
                         SYSDB_OVERRIDE_DN, \
                         SYSDB_OVERRIDE_OBJECT_DN, \
+                        SYSDB_MERGED_OVERRIDE_ATTRS, \
                         SYSDB_DEFAULT_OVERRIDE_NAME, \
                         SYSDB_SESSION_RECORDING, \
                         SYSDB_UUID, \
                         SYSDB_ORIG_DN, \
                         NULL}
 
+/* The member DNs are left out on purpose, the group lookups only need the
+ * member names and the DN list of a large group is expensive to unpack.
+ * Members are looked up by their memberOf attribute when needed. */
 #define SYSDB_GRSRC_ATTRS {SYSDB_NAME, SYSDB_GIDNUM, \
                            SYSDB_MEMBERUID, \
-                           SYSDB_MEMBER, \
                            SYSDB_GHOST, \
                            SYSDB_DEFAULT_ATTRS, \
                            SYSDB_SID_STR, \
                            SYSDB_OVERRIDE_DN, \
                            SYSDB_OVERRIDE_OBJECT_DN, \
+                           SYSDB_MERGED_OVERRIDE_ATTRS, \
                            SYSDB_DEFAULT_OVERRIDE_NAME, \
                            SYSDB_UUID, \
                            ORIGINALAD_PREFIX SYSDB_NAME, \
@@ -280,6 +303,7 @@
                             SYSDB_SID_STR, \
                             SYSDB_NAME, \
                             SYSDB_OVERRIDE_DN, \
+                            SYSDB_MERGED_OVERRIDE_ATTRS, \
                             NULL}
 
 #define SYSDB_TMPL_USER SYSDB_NAME"=%s,"SYSDB_TMPL_USER_BASE
@@ -371,6 +395,10 @@ int sysdb_attrs_add_val(struct sysdb_attrs *attrs,
                         const char *name, const struct ldb_val *val);
 int sysdb_attrs_add_val_safe(struct sysdb_attrs *attrs,
                              const char *name, const struct ldb_val *val);
+/* like sysdb_attrs_add_val() for num_vals values at once, the value array
+ * is only reallocated once */
+int sysdb_attrs_add_vals(struct sysdb_attrs *attrs, const char *name,
+                         const struct ldb_val *vals, size_t num_vals);
 int sysdb_attrs_add_string_safe(struct sysdb_attrs *attrs,
                                 const char *name, const char *str);
 int sysdb_attrs_add_string(struct sysdb_attrs *attrs,
@@ -505,6 +533,38 @@ int sysdb_transaction_start(struct sysdb_ctx *sysdb);
 int sysdb_transaction_commit(struct sysdb_ctx *sysdb);
 int sysdb_transaction_cancel(struct sysdb_ctx *sysdb);
 
+/* Number of outermost transactions finished so far and the total time they
+ * were open, in microseconds */
+void sysdb_get_transaction_stats(struct sysdb_ctx *sysdb,
+                                 uint64_t *_count,
+                                 uint64_t *_usecs);
+
+/* Keeps the timestamp updates of entries that did not change otherwise in
+ * memory and writes them to the timestamp cache in a single transaction
+ * once max_entries of them are waiting or the oldest one is max_delay
+ * seconds old. Lookups in this process see the buffered values. Setting
+ * max_entries to 0 writes the timestamps right away again. */
+errno_t sysdb_ts_buffer_enable(struct sysdb_ctx *sysdb,
+                               unsigned int max_entries,
+                               time_t max_delay);
+
+/* Writes the buffered timestamp updates to the timestamp cache */
+errno_t sysdb_ts_buffer_flush(struct sysdb_ctx *sysdb);
+
+/* Called with each user or group whose entry in the persistent cache was
+ * written or removed, but not for updates of only its timestamps. The name
+ * is the internal fully qualified one. The callback runs inside the
+ * transaction of the write, which may still be cancelled, so it must not
+ * write to the cache. */
+typedef void (*sysdb_change_fn)(const char *domain,
+                                enum sysdb_member_type type,
+                                const char *name,
+                                void *pvt);
+
+void sysdb_set_change_cb(struct sysdb_ctx *sysdb,
+                         sysdb_change_fn fn,
+                         void *pvt);
+
 /* functions related to subdomains */
 errno_t sysdb_domain_create(struct sysdb_ctx *sysdb, const char *domain_name);
 
@@ -684,6 +744,20 @@ errno_t sysdb_search_group_override_by_gid(TALLOC_CTX *mem_ctx,
                                             struct ldb_result **override_obj,
                                             struct ldb_result **orig_obj);
 
+errno_t sysdb_search_user_override_attrs_by_uid(TALLOC_CTX *mem_ctx,
+                                            struct sss_domain_info *domain,
+                                            uid_t uid,
+                                            const char **attrs,
+                                            struct ldb_result **override_obj,
+                                            struct ldb_result **orig_obj);
+
+errno_t sysdb_search_group_override_attrs_by_gid(TALLOC_CTX *mem_ctx,
+                                            struct sss_domain_info *domain,
+                                            gid_t gid,
+                                            const char **attrs,
+                                            struct ldb_result **override_obj,
+                                            struct ldb_result **orig_obj);
+
 errno_t sysdb_search_override_by_cert(TALLOC_CTX *mem_ctx,
                                       struct sss_domain_info *domain,
                                       const char *cert,
@@ -767,6 +841,12 @@ int sysdb_init_ext(TALLOC_CTX *mem_ctx,
                    bool chown_dbfile,
                    uid_t uid, gid_t gid);
 
+/* Flushes the caches of the domains opened without syncing to disk and
+ * removes their markers, so they are not validated on the next start.
+ * Must only be called when no other process writes to the caches. */
+errno_t sysdb_mark_clean_shutdown(struct sss_domain_info *domains,
+                                  const char *db_path);
+
 /* used to initialize only one domain database.
  * Do NOT use if sysdb_init has already been called */
 int sysdb_domain_init(TALLOC_CTX *mem_ctx,
@@ -774,6 +854,32 @@ int sysdb_domain_init(TALLOC_CTX *mem_ctx,
                       const char *db_path,
                       struct sysdb_ctx **_ctx);
 
+/* Paths of the cache and timestamp cache files of a domain in db_path.
+ * The timestamp cache file is NULL if the domain has none. */
+errno_t sysdb_cache_files(TALLOC_CTX *mem_ctx,
+                          struct sss_domain_info *domain,
+                          const char *db_path,
+                          char **_ldb_file,
+                          char **_ts_file);
+
+typedef errno_t (*sysdb_cache_files_fn)(const char *ldb_file,
+                                        const char *ts_file,
+                                        void *pvt);
+
+/* Calls fn with the paths of the open cache files while no other process
+ * can write to them, so they can be copied consistently. ts_file is NULL
+ * if there is no timestamp cache. */
+errno_t sysdb_cache_files_locked(struct sysdb_ctx *sysdb,
+                                 sysdb_cache_files_fn fn,
+                                 void *pvt);
+
+/* Prepares a cache copied from another host: shifts the expiration
+ * timestamps by delta seconds and removes cached credentials and the
+ * login state of the users. */
+errno_t sysdb_cache_import_fixup(struct sysdb_ctx *sysdb,
+                                 struct sss_domain_info *domain,
+                                 time_t delta);
+
 /* functions to retrieve information from sysdb
  * These functions automatically starts an operation
  * therefore they cannot be called within a transaction */
@@ -849,6 +955,24 @@ int sysdb_enumgrent_filter_with_views(TALLOC_CTX *mem_ctx,
                                       const char *addtl_filter,
                                       struct ldb_result **res);
 
+/* Enumeration in batches. The keys functions return only the DN and the
+ * name of each user or group, the entries are then read one at a time
+ * with sysdb_enum_entry_with_views(), which returns ENOENT if the entry
+ * was removed in the meantime. */
+int sysdb_enumpwent_keys(TALLOC_CTX *mem_ctx,
+                         struct sss_domain_info *domain,
+                         struct ldb_result **res);
+
+int sysdb_enumgrent_keys(TALLOC_CTX *mem_ctx,
+                         struct sss_domain_info *domain,
+                         struct ldb_result **res);
+
+int sysdb_enum_entry_with_views(TALLOC_CTX *mem_ctx,
+                                struct sss_domain_info *domain,
+                                bool group,
+                                struct ldb_dn *dn,
+                                struct ldb_message **_msg);
+
 struct sysdb_netgroup_ctx {
     enum {SYSDB_NETGROUP_TRIPLE_VAL, SYSDB_NETGROUP_GROUP_VAL} type;
     union {
@@ -893,6 +1017,20 @@ int sysdb_get_user_attr_with_views(TALLOC_CTX *mem_ctx,
                                    const char **attributes,
                                    struct ldb_result **res);
 
+/* Like sysdb_getpwuid_with_views() and sysdb_getgrgid_with_views() but only
+ * the given attributes are returned */
+int sysdb_get_user_attr_by_uid_with_views(TALLOC_CTX *mem_ctx,
+                                          struct sss_domain_info *domain,
+                                          uid_t uid,
+                                          const char **attributes,
+                                          struct ldb_result **res);
+
+int sysdb_get_group_attr_by_gid_with_views(TALLOC_CTX *mem_ctx,
+                                           struct sss_domain_info *domain,
+                                           gid_t gid,
+                                           const char **attributes,
+                                           struct ldb_result **res);
+
 int sysdb_search_user_by_cert_with_views(TALLOC_CTX *mem_ctx,
                                          struct sss_domain_info *domain,
                                          const char *cert,
@@ -1034,6 +1172,18 @@ int sysdb_invalidate_cache_entry(struct sss_domain_info *domain,
                                  const char *name,
                                  bool is_user);
 
+/* Invalidates all users (SYSDB_MEMBER_USER) or all groups
+ * (SYSDB_MEMBER_GROUP) of the domain at once by storing the time of the
+ * invalidation in the domain entry. The entries are not modified, those
+ * last updated before are reported by sysdb_entry_invalidated(). */
+errno_t sysdb_invalidate_type(struct sss_domain_info *domain,
+                              enum sysdb_member_type type);
+
+/* True if the user or group was invalidated by sysdb_invalidate_type().
+ * The times of the invalidation are read at most once per second. */
+bool sysdb_entry_invalidated(struct sss_domain_info *domain,
+                             struct ldb_message *msg);
+
 /* Replace user attrs */
 int sysdb_set_user_attr(struct sss_domain_info *domain,
                         const char *name,
@@ -1127,6 +1277,37 @@ int sysdb_store_user(struct sss_domain_info *domain,
                      uint64_t cache_timeout,
                      time_t now);
 
+/* A user stored by sysdb_store_users(), the fields have the same meaning as
+ * the parameters of sysdb_store_user() */
+struct sysdb_store_user_entry {
+    struct sss_domain_info *domain;
+    const char *name;
+    const char *pwd;
+    uid_t uid;
+    gid_t gid;
+    const char *gecos;
+    const char *homedir;
+    const char *shell;
+    const char *orig_dn;
+    struct sysdb_attrs *attrs;
+    char **remove_attrs;
+    uint64_t cache_timeout;
+
+    /* Result of storing this user */
+    errno_t ret;
+};
+
+/* Stores a batch of users in a single transaction. The users that are
+ * already cached are looked up with one search per chunk of names instead
+ * of one search per user and the timestamp cache is written in one
+ * transaction as well. Failing to store a user does not stop the others,
+ * the result of each user is set in its entry. The return value is only
+ * an error if the transaction itself failed. */
+errno_t sysdb_store_users(struct sysdb_ctx *sysdb,
+                          struct sysdb_store_user_entry *users,
+                          size_t num_users,
+                          time_t now);
+
 int sysdb_store_group(struct sss_domain_info *domain,
                       const char *name,
                       gid_t gid,
@@ -1163,6 +1344,11 @@ errno_t sysdb_store_override(struct sss_domain_info *domain,
                              enum sysdb_member_type type,
                              struct sysdb_attrs *attrs, struct ldb_dn *obj_dn);
 
+/* Adds the modifications removing the override values which
+ * sysdb_store_override() keeps with the original object to msg. Must be used
+ * when an override is removed without sysdb_store_override(). */
+errno_t sysdb_clear_merged_override(struct ldb_message *msg);
+
 /*
  * Cache the time of last initgroups invocation. Typically this is not done when
  * the provider-specific request itself finishes, because currently the request
@@ -1174,6 +1360,13 @@ errno_t sysdb_store_override(struct sss_domain_info *domain,
 errno_t sysdb_set_initgr_expire_timestamp(struct sss_domain_info *domain,
                                           const char *name_or_upn_or_sid);
 
+/* Record that the entry was returned to a client. The time is kept in the
+ * timestamp cache only, it is used to order and skip background refreshes.
+ * Entries that have no timestamp cache record are left untouched. */
+errno_t sysdb_set_entry_access(struct sss_domain_info *domain,
+                               struct ldb_dn *entry_dn,
+                               time_t access_time);
+
 /* Password caching function.
  * If you are in a transaction ignore sysdb and pass in the handle.
  * If you are not in a transaction pass NULL in handle and provide sysdb,
@@ -1275,6 +1468,38 @@ int sysdb_search_groups(TALLOC_CTX *mem_ctx,
                         size_t *msgs_count,
                         struct ldb_message ***msgs);
 
+/* Called for each entry found by the streaming searches. The message is
+ * freed when the callback returns unless it is stolen. Any return value
+ * other than EOK stops the search and is returned by it. The cache is
+ * locked during the search so the callback must not write to it; collect
+ * what has to be changed and change it after the search instead. */
+typedef errno_t (*sysdb_stream_fn)(struct ldb_message *msg, void *pvt);
+
+/* Like sysdb_search_entry with the timestamps merged in, but the entries
+ * are passed to the callback one at a time instead of being returned in an
+ * array, so searching the whole cache does not keep all of it in memory.
+ * Returns ENOENT if nothing was found. */
+errno_t sysdb_search_entry_stream(struct sysdb_ctx *sysdb,
+                                  struct ldb_dn *base_dn,
+                                  enum ldb_scope scope,
+                                  const char *filter,
+                                  const char **attrs,
+                                  sysdb_stream_fn fn,
+                                  void *pvt);
+
+/* Streaming variants of sysdb_search_users and sysdb_search_groups */
+errno_t sysdb_search_users_stream(struct sss_domain_info *domain,
+                                  const char *sub_filter,
+                                  const char **attrs,
+                                  sysdb_stream_fn fn,
+                                  void *pvt);
+
+errno_t sysdb_search_groups_stream(struct sss_domain_info *domain,
+                                   const char *sub_filter,
+                                   const char **attrs,
+                                   sysdb_stream_fn fn,
+                                   void *pvt);
+
 int sysdb_search_groups_by_timestamp(TALLOC_CTX *mem_ctx,
                                      struct sss_domain_info *domain,
                                      const char *sub_filter,
@@ -1526,6 +1751,13 @@ errno_t sysdb_cert_derb64_to_ldap_filter(TALLOC_CTX *mem_ctx,
                                          const char *attr_name,
                                          char **ldap_filter);
 
+/* Returns the hex encoded, truncated SHA-256 hash of the DER certificate
+ * under which it is indexed in SYSDB_USER_MAPPED_CERT_HASH */
+errno_t sysdb_cert_hash(TALLOC_CTX *mem_ctx,
+                        const uint8_t *der,
+                        size_t der_size,
+                        char **_hash);
+
 /* define old name for backward compatibility */
 #define sysdb_error_to_errno(ldberr) sss_ldb_error_to_errno(ldberr)
 
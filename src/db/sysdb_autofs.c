@@ -406,7 +406,9 @@ sysdb_get_autofsentry(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, mapdn, LDB_SCOPE_SUBTREE,
+    /* The entries are direct children of their map and automountKey is
+     * indexed, so this is a single index lookup. */
+    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, mapdn, LDB_SCOPE_ONELEVEL,
                              filter, attrs, &count, &msgs);
     if (ret == ENOENT) {
         goto done;
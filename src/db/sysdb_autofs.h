@@ -87,6 +87,14 @@ sysdb_autofs_entries_by_map(TALLOC_CTX *mem_ctx,
                             size_t *_count,
                             struct ldb_message ***_entries);
 
+errno_t
+sysdb_set_autofsentry_attr(struct sss_domain_info *domain,
+                           const char *mapname,
+                           const char *key,
+                           const char *value,
+                           struct sysdb_attrs *attrs,
+                           int mod_op);
+
 errno_t
 sysdb_set_autofsmap_attr(struct sss_domain_info *domain,
                          const char *name,
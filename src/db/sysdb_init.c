@@ -23,10 +23,12 @@
 #include "util/util.h"
 #include "util/strtonum.h"
 #include "util/sss_utf8.h"
+#include "util/atomic_io.h"
 #include "db/sysdb_private.h"
 #include "confdb/confdb.h"
 #include "util/probes.h"
 #include <time.h>
+#include <fcntl.h>
 
 #define LDB_MODULES_PATH "LDB_MODULES_PATH"
 
@@ -42,6 +44,7 @@ const char *sysdb_ts_cache_attrs[] = {
     SYSDB_ORIG_MODSTAMP,
     SYSDB_INITGR_EXPIRE,
     SYSDB_USN,
+    SYSDB_LAST_ACCESS,
 
     NULL,
 };
@@ -85,6 +88,332 @@ errno_t sysdb_ldb_connect(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+/* Returns the microseconds since start and restarts the measurement */
+static uint64_t sysdb_phase_usecs(struct timespec *start)
+{
+    struct timespec now;
+    uint64_t usecs;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    usecs = (now.tv_sec - start->tv_sec) * 1000000
+            + (now.tv_nsec - start->tv_nsec) / 1000;
+    *start = now;
+
+    return usecs;
+}
+
+/* Returns the URL that opens the file with the configured backend */
+static const char *sysdb_ldb_url(TALLOC_CTX *mem_ctx,
+                                 struct sysdb_ctx *sysdb,
+                                 const char *ldb_file)
+{
+    if (sysdb->lmdb) {
+        return talloc_asprintf(mem_ctx, "mdb://%s", ldb_file);
+    }
+
+    return talloc_strdup(mem_ctx, ldb_file);
+}
+
+/* Removes the database file and the lock file of LMDB */
+errno_t sysdb_remove_db_file(const char *ldb_file)
+{
+    char *lock_file;
+    errno_t ret;
+
+    ret = unlink(ldb_file);
+    if (ret != EOK && errno != ENOENT) {
+        return errno;
+    }
+
+    lock_file = talloc_asprintf(NULL, "%s-lock", ldb_file);
+    if (lock_file == NULL) {
+        return ENOMEM;
+    }
+
+    ret = unlink(lock_file);
+    if (ret != EOK && errno != ENOENT) {
+        ret = errno;
+    } else {
+        ret = EOK;
+    }
+
+    talloc_free(lock_file);
+    return ret;
+}
+
+/* Tells whether the existing database file is a TDB file. Returns ENOENT
+ * if there is no database yet. */
+static errno_t sysdb_db_file_is_tdb(const char *ldb_file, bool *_is_tdb)
+{
+    /* The beginning of TDB_MAGIC_FOOD */
+    static const char tdb_magic[] = "TDB file";
+    char buf[sizeof(tdb_magic) - 1];
+    ssize_t len;
+    errno_t ret;
+    int fd;
+
+    fd = open(ldb_file, O_RDONLY);
+    if (fd == -1) {
+        return errno;
+    }
+
+    len = sss_atomic_read_s(fd, buf, sizeof(buf));
+    if (len == -1) {
+        ret = errno;
+        close(fd);
+        return ret;
+    }
+    close(fd);
+
+    if (len == 0) {
+        return ENOENT;
+    }
+
+    *_is_tdb = (len == sizeof(buf) && memcmp(buf, tdb_magic, len) == 0);
+    return EOK;
+}
+
+/* Converts the databases if they were created with the other backend. The
+ * timestamp cache is only removed, it is populated again as the entries
+ * are refreshed. */
+static errno_t sysdb_check_backend(struct sysdb_ctx *sysdb)
+{
+    bool is_tdb;
+    errno_t ret;
+
+    ret = sysdb_db_file_is_tdb(sysdb->ldb_file, &is_tdb);
+    if (ret == ENOENT) {
+        return EOK;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to read %s [%d]: %s\n",
+              sysdb->ldb_file, ret, sss_strerror(ret));
+        return ret;
+    }
+
+    if (is_tdb != sysdb->lmdb) {
+        return EOK;
+    }
+
+    DEBUG(SSSDBG_IMPORTANT_INFO, "The cache %s was not created with the "
+          "configured backend, converting it\n", sysdb->ldb_file);
+
+    ret = sysdb_upgrade_backend(sysdb->ldb_file, sysdb->lmdb);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (sysdb->ldb_ts_file != NULL) {
+        ret = sysdb_remove_db_file(sysdb->ldb_ts_file);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Could not delete the timestamp ldb file (%d) (%s)\n",
+                  ret, sss_strerror(ret));
+        }
+    }
+
+    return EOK;
+}
+
+/* Flags the cache ldb is opened with, the timestamp cache is never synced */
+static int sysdb_cache_flags(struct sysdb_ctx *sysdb)
+{
+    return sysdb->nosync ? LDB_FLG_NOSYNC : 0;
+}
+
+/* A cache opened without syncing can be left inconsistent when the machine
+ * crashes. The marker is created next to the cache when SSSD starts and
+ * removed only after a clean shutdown flushed the files to disk, a marker
+ * found on the next start means the cache has to be checked. */
+static char *sysdb_unclean_marker(TALLOC_CTX *mem_ctx, const char *ldb_file)
+{
+    return talloc_asprintf(mem_ctx, "%s"SYSDB_UNCLEAN_MARKER_SUFFIX, ldb_file);
+}
+
+/* Reads all entries of the cache, a damaged file fails to open or to be
+ * traversed */
+static errno_t sysdb_validate_cache(struct sysdb_ctx *sysdb)
+{
+    static const char *attrs[] = { SYSDB_OBJECTCLASS, NULL };
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_context *ldb;
+    struct ldb_result *res;
+    const char *url;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    url = sysdb_ldb_url(tmp_ctx, sysdb, sysdb->ldb_file);
+    if (url == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_ldb_connect(tmp_ctx, url, 0, &ldb);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = ldb_search(ldb, tmp_ctx, &res, NULL, LDB_SCOPE_SUBTREE, attrs,
+                     NULL);
+    if (ret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to read %s: %s\n",
+              sysdb->ldb_file, ldb_errstring(ldb));
+        ret = EIO;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "%u entries of %s are readable\n",
+          res->count, sysdb->ldb_file);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Validates the cache if the previous instance of SSSD did not shut down
+ * cleanly and removes it if it is damaged, then creates the marker again if
+ * the cache is not synced */
+static errno_t sysdb_check_unclean_shutdown(struct sysdb_ctx *sysdb)
+{
+    char *marker;
+    errno_t ret;
+    int fd;
+
+    marker = sysdb_unclean_marker(NULL, sysdb->ldb_file);
+    if (marker == NULL) {
+        return ENOMEM;
+    }
+
+    if (access(marker, F_OK) == 0
+            && access(sysdb->ldb_file, F_OK) == 0) {
+        DEBUG(SSSDBG_IMPORTANT_INFO, "SSSD was not shut down cleanly, "
+              "validating the cache %s\n", sysdb->ldb_file);
+
+        ret = sysdb_validate_cache(sysdb);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_FATAL_FAILURE, "The cache %s is damaged, "
+                  "removing it\n", sysdb->ldb_file);
+
+            ret = sysdb_remove_db_file(sysdb->ldb_file);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_CRIT_FAILURE, "Unable to remove %s [%d]: %s\n",
+                      sysdb->ldb_file, ret, sss_strerror(ret));
+                goto done;
+            }
+
+            if (sysdb->ldb_ts_file != NULL) {
+                ret = sysdb_remove_db_file(sysdb->ldb_ts_file);
+                if (ret != EOK) {
+                    DEBUG(SSSDBG_MINOR_FAILURE,
+                          "Could not delete the timestamp ldb file (%d) (%s)\n",
+                          ret, sss_strerror(ret));
+                }
+            }
+        }
+    }
+
+    if (!sysdb->nosync) {
+        ret = unlink(marker);
+        if (ret != 0 && errno != ENOENT) {
+            ret = errno;
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to remove %s [%d]: %s\n",
+                  marker, ret, sss_strerror(ret));
+        }
+        ret = EOK;
+        goto done;
+    }
+
+    fd = open(marker, O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create %s [%d]: %s\n",
+              marker, ret, sss_strerror(ret));
+        goto done;
+    }
+    close(fd);
+
+    ret = EOK;
+
+done:
+    talloc_free(marker);
+    return ret;
+}
+
+static errno_t sysdb_fsync_file(const char *path)
+{
+    errno_t ret;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        ret = errno;
+        return ret == ENOENT ? EOK : ret;
+    }
+
+    ret = fsync(fd);
+    if (ret != 0) {
+        ret = errno;
+    }
+    close(fd);
+
+    return ret;
+}
+
+errno_t sysdb_mark_clean_shutdown(struct sss_domain_info *domains,
+                                  const char *db_path)
+{
+    struct sss_domain_info *dom;
+    char *ldb_file;
+    char *ts_file;
+    char *marker;
+    errno_t ret;
+
+    for (dom = domains; dom != NULL; dom = dom->next) {
+        if (!dom->cache_nosync) {
+            continue;
+        }
+
+        ret = sysdb_get_db_file(NULL, dom->provider, dom->name, db_path,
+                                &ldb_file, &ts_file);
+        if (ret != EOK) {
+            return ret;
+        }
+        talloc_steal(ldb_file, ts_file);
+
+        /* the marker must not disappear before the data is on disk */
+        ret = sysdb_fsync_file(ldb_file);
+        if (ret == EOK && ts_file != NULL) {
+            ret = sysdb_fsync_file(ts_file);
+        }
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to flush the cache of %s "
+                  "[%d]: %s\n", dom->name, ret, sss_strerror(ret));
+            talloc_free(ldb_file);
+            continue;
+        }
+
+        marker = sysdb_unclean_marker(ldb_file, ldb_file);
+        if (marker == NULL) {
+            talloc_free(ldb_file);
+            return ENOMEM;
+        }
+
+        ret = unlink(marker);
+        if (ret != 0 && errno != ENOENT) {
+            ret = errno;
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to remove %s [%d]: %s\n",
+                  marker, ret, sss_strerror(ret));
+        }
+        talloc_free(ldb_file);
+    }
+
+    return EOK;
+}
+
 static errno_t sysdb_ldb_reconnect(TALLOC_CTX *mem_ctx,
                                    const char *ldb_file,
                                    int flags,
@@ -101,6 +430,31 @@ static errno_t sysdb_ldb_reconnect(TALLOC_CTX *mem_ctx,
     return ret;
 }
 
+static errno_t sysdb_chown_lock_file(const char *ldb_file,
+                                     uid_t uid, gid_t gid)
+{
+    char *lock_file;
+    errno_t ret;
+
+    lock_file = talloc_asprintf(NULL, "%s-lock", ldb_file);
+    if (lock_file == NULL) {
+        return ENOMEM;
+    }
+
+    ret = chown(lock_file, uid, gid);
+    if (ret != 0 && errno != ENOENT) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Cannot set sysdb ownership of %s to %"SPRIuid":%"SPRIgid"\n",
+              lock_file, uid, gid);
+    } else {
+        ret = EOK;
+    }
+
+    talloc_free(lock_file);
+    return ret;
+}
+
 static errno_t sysdb_chown_db_files(struct sysdb_ctx *sysdb,
                                     uid_t uid, gid_t gid)
 {
@@ -126,6 +480,20 @@ static errno_t sysdb_chown_db_files(struct sysdb_ctx *sysdb,
         }
     }
 
+    if (sysdb->lmdb) {
+        ret = sysdb_chown_lock_file(sysdb->ldb_file, uid, gid);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        if (sysdb->ldb_ts_file != NULL) {
+            ret = sysdb_chown_lock_file(sysdb->ldb_ts_file, uid, gid);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
+    }
+
     return EOK;
 }
 
@@ -573,6 +941,27 @@ static errno_t sysdb_domain_cache_upgrade(TALLOC_CTX *mem_ctx,
         }
     }
 
+    if (strcmp(version, SYSDB_VERSION_0_22) == 0) {
+        ret = sysdb_upgrade_22(sysdb, &version);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    if (strcmp(version, SYSDB_VERSION_0_23) == 0) {
+        ret = sysdb_upgrade_23(sysdb, &version);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    if (strcmp(version, SYSDB_VERSION_0_24) == 0) {
+        ret = sysdb_upgrade_24(sysdb, &version);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
     ret = EOK;
 done:
     sysdb->ldb = save_ldb;
@@ -583,18 +972,11 @@ done:
 
 static errno_t remove_ts_cache(struct sysdb_ctx *sysdb)
 {
-    errno_t ret;
-
     if (sysdb->ldb_ts_file == NULL) {
         return EOK;
     }
 
-    ret = unlink(sysdb->ldb_ts_file);
-    if (ret != EOK && errno != ENOENT) {
-        return errno;
-    }
-
-    return EOK;
+    return sysdb_remove_db_file(sysdb->ldb_ts_file);
 }
 
 static errno_t sysdb_cache_connect_helper(TALLOC_CTX *mem_ctx,
@@ -607,6 +989,7 @@ static errno_t sysdb_cache_connect_helper(TALLOC_CTX *mem_ctx,
                                           struct ldb_context **_ldb,
                                           const char **_version)
 {
+    static const char *attrs[] = { "version", NULL };
     TALLOC_CTX *tmp_ctx = NULL;
     struct ldb_message_element *el;
     struct ldb_result *res;
@@ -636,7 +1019,7 @@ static errno_t sysdb_cache_connect_helper(TALLOC_CTX *mem_ctx,
 
     ret = ldb_search(ldb, tmp_ctx, &res,
                      verdn, LDB_SCOPE_BASE,
-                     NULL, NULL);
+                     attrs, NULL);
     if (ret != LDB_SUCCESS) {
         ret = EIO;
         goto done;
@@ -719,12 +1102,19 @@ static errno_t sysdb_cache_connect(TALLOC_CTX *mem_ctx,
 {
     bool newly_created;
     bool ldb_file_exists;
+    const char *url;
     errno_t ret;
 
     ldb_file_exists = !(access(sysdb->ldb_file, F_OK) == -1 && errno == ENOENT);
 
-    ret = sysdb_cache_connect_helper(mem_ctx, domain, sysdb->ldb_file,
-                                      0, SYSDB_VERSION, SYSDB_BASE_LDIF,
+    url = sysdb_ldb_url(mem_ctx, sysdb, sysdb->ldb_file);
+    if (url == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_cache_connect_helper(mem_ctx, domain, url,
+                                      sysdb_cache_flags(sysdb),
+                                      SYSDB_VERSION, SYSDB_BASE_LDIF,
                                       &newly_created, ldb, version);
 
     /* The cache has been newly created. */
@@ -746,7 +1136,14 @@ static errno_t sysdb_ts_cache_connect(TALLOC_CTX *mem_ctx,
                                       struct ldb_context **ldb,
                                       const char **version)
 {
-    return sysdb_cache_connect_helper(mem_ctx, domain, sysdb->ldb_ts_file,
+    const char *url;
+
+    url = sysdb_ldb_url(mem_ctx, sysdb, sysdb->ldb_ts_file);
+    if (url == NULL) {
+        return ENOMEM;
+    }
+
+    return sysdb_cache_connect_helper(mem_ctx, domain, url,
                                       LDB_FLG_NOSYNC, SYSDB_TS_VERSION,
                                       SYSDB_TS_BASE_LDIF, NULL,
                                       ldb, version);
@@ -806,7 +1203,10 @@ static int sysdb_domain_cache_connect(struct sysdb_ctx *sysdb,
              * We need to reopen the LDB to ensure that
              * any changes made above take effect.
              */
-            ret = sysdb_ldb_reconnect(tmp_ctx, sysdb->ldb_file, 0, &ldb);
+            ret = sysdb_ldb_reconnect(tmp_ctx,
+                                      sysdb_ldb_url(tmp_ctx, sysdb,
+                                                    sysdb->ldb_file),
+                                      sysdb_cache_flags(sysdb), &ldb);
             goto done;
         }
         break;
@@ -878,7 +1278,8 @@ static int sysdb_timestamp_cache_connect(struct sysdb_ctx *sysdb,
              * any changes made above take effect.
              */
             ret = sysdb_ldb_reconnect(tmp_ctx,
-                                      sysdb->ldb_ts_file,
+                                      sysdb_ldb_url(tmp_ctx, sysdb,
+                                                    sysdb->ldb_ts_file),
                                       LDB_FLG_NOSYNC,
                                       &ldb);
             if (ret != EOK) {
@@ -936,6 +1337,10 @@ int sysdb_domain_init_internal(TALLOC_CTX *mem_ctx,
 {
     TALLOC_CTX *tmp_ctx = NULL;
     struct sysdb_ctx *sysdb;
+    struct timespec start;
+    uint64_t backend_usecs;
+    uint64_t cache_usecs;
+    uint64_t ts_usecs;
     int ret;
 
     tmp_ctx = talloc_new(NULL);
@@ -943,6 +1348,8 @@ int sysdb_domain_init_internal(TALLOC_CTX *mem_ctx,
         return ENOMEM;
     }
 
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
     sysdb = talloc_zero(mem_ctx, struct sysdb_ctx);
     if (!sysdb) {
         ret = ENOMEM;
@@ -961,6 +1368,26 @@ int sysdb_domain_init_internal(TALLOC_CTX *mem_ctx,
              "Timestamp file for %s: %s\n", domain->name, sysdb->ldb_ts_file);
     }
 
+    sysdb->lmdb = (domain->cache_backend == SSS_CACHE_BACKEND_LMDB);
+    sysdb->nosync = domain->cache_nosync;
+
+    if (upgrade_ctx != NULL) {
+        /* only the process which opens the caches before all others */
+        ret = sysdb_check_unclean_shutdown(sysdb);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = sysdb_check_backend(sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Could not convert the sysdb cache [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+    backend_usecs = sysdb_phase_usecs(&start);
+
     ret = sysdb_domain_cache_connect(sysdb, domain, upgrade_ctx);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -968,6 +1395,7 @@ int sysdb_domain_init_internal(TALLOC_CTX *mem_ctx,
               ret, sss_strerror(ret));
         goto done;
     }
+    cache_usecs = sysdb_phase_usecs(&start);
 
     ret = sysdb_timestamp_cache_connect(sysdb, domain, upgrade_ctx);
     if (ret != EOK) {
@@ -976,6 +1404,11 @@ int sysdb_domain_init_internal(TALLOC_CTX *mem_ctx,
               ret, sss_strerror(ret));
         goto done;
     }
+    ts_usecs = sysdb_phase_usecs(&start);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Opened the cache of %s: backend check "
+          "%"PRIu64" us, cache %"PRIu64" us, timestamp cache %"PRIu64" us\n",
+          domain->name, backend_usecs, cache_usecs, ts_usecs);
 
 done:
     if (ret == EOK) {
@@ -1003,6 +1436,11 @@ int sysdb_init_ext(TALLOC_CTX *mem_ctx,
     int ret;
     TALLOC_CTX *tmp_ctx;
     struct sysdb_dom_upgrade_ctx *dom_upgrade_ctx;
+    struct timespec start;
+    uint64_t upgrade_usecs = 0;
+    int num_domains = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
     if (upgrade_ctx != NULL) {
         /* check if we have an old sssd.ldb to upgrade */
@@ -1010,6 +1448,7 @@ int sysdb_init_ext(TALLOC_CTX *mem_ctx,
         if (ret != EOK) {
             return ret;
         }
+        upgrade_usecs = sysdb_phase_usecs(&start);
     }
 
     tmp_ctx = talloc_new(mem_ctx);
@@ -1054,8 +1493,13 @@ int sysdb_init_ext(TALLOC_CTX *mem_ctx,
         }
 
         dom->sysdb = talloc_move(dom, &sysdb);
+        num_domains++;
     }
 
+    DEBUG(SSSDBG_CONF_SETTINGS, "Opened the caches of %d domains in "
+          "%"PRIu64" us (%"PRIu64" us checking the old cache)\n",
+          num_domains, sysdb_phase_usecs(&start), upgrade_usecs);
+
     ret = EOK;
 done:
     talloc_free(tmp_ctx);
@@ -1070,3 +1514,53 @@ int sysdb_domain_init(TALLOC_CTX *mem_ctx,
     return sysdb_domain_init_internal(mem_ctx, domain,
                                       db_path, false, _ctx);
 }
+
+errno_t sysdb_cache_files(TALLOC_CTX *mem_ctx,
+                          struct sss_domain_info *domain,
+                          const char *db_path,
+                          char **_ldb_file,
+                          char **_ts_file)
+{
+    return sysdb_get_db_file(mem_ctx, domain->provider, domain->name,
+                             db_path, _ldb_file, _ts_file);
+}
+
+errno_t sysdb_cache_files_locked(struct sysdb_ctx *sysdb,
+                                 sysdb_cache_files_fn fn,
+                                 void *pvt)
+{
+    bool in_ts_transaction = false;
+    errno_t ret;
+    int lret;
+
+    /* An open transaction blocks all writers, so the files do not change
+     * while fn reads them. Nothing is written, both are cancelled. */
+    lret = ldb_transaction_start(sysdb->ldb);
+    if (lret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to lock %s: %s\n",
+              sysdb->ldb_file, ldb_errstring(sysdb->ldb));
+        return sysdb_error_to_errno(lret);
+    }
+
+    if (sysdb->ldb_ts != NULL) {
+        lret = ldb_transaction_start(sysdb->ldb_ts);
+        if (lret != LDB_SUCCESS) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to lock %s: %s\n",
+                  sysdb->ldb_ts_file, ldb_errstring(sysdb->ldb_ts));
+            ret = sysdb_error_to_errno(lret);
+            goto done;
+        }
+        in_ts_transaction = true;
+    }
+
+    ret = fn(sysdb->ldb_file,
+             sysdb->ldb_ts != NULL ? sysdb->ldb_ts_file : NULL,
+             pvt);
+
+done:
+    if (in_ts_transaction) {
+        ldb_transaction_cancel(sysdb->ldb_ts);
+    }
+    ldb_transaction_cancel(sysdb->ldb);
+    return ret;
+}
@@ -109,6 +109,7 @@ errno_t sysdb_gethostbyaddr(TALLOC_CTX *mem_ctx,
         SYSDB_NAME,
         SYSDB_NAME_ALIAS,
         SYSDB_IP_HOST_ATTR_ADDRESS,
+        SYSDB_DEFAULT_ATTRS,
         NULL,
     };
     char *sanitized_address;
@@ -844,6 +845,7 @@ sysdb_enumhostent(TALLOC_CTX *mem_ctx,
         SYSDB_NAME,
         SYSDB_NAME_ALIAS,
         SYSDB_IP_HOST_ATTR_ADDRESS,
+        SYSDB_DEFAULT_ATTRS,
         NULL,
     };
     struct ldb_result *res = NULL;
@@ -19,6 +19,8 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <ldb_module.h>
+
 #include "util/util.h"
 #include "db/sysdb_private.h"
 #include "db/sysdb_services.h"
@@ -27,6 +29,7 @@
 #include "db/sysdb_ipnetworks.h"
 #include "util/crypto/sss_crypto.h"
 #include "util/cert.h"
+#include "util/sss_ptr_hash.h"
 #include <time.h>
 
 #define SSS_SYSDB_NO_CACHE 0x0
@@ -34,6 +37,17 @@
 #define SSS_SYSDB_TS_CACHE 0x2
 #define SSS_SYSDB_BOTH_CACHE (SSS_SYSDB_CACHE | SSS_SYSDB_TS_CACHE)
 
+static errno_t sysdb_ts_buffer_add(struct sysdb_ctx *sysdb,
+                                   struct ldb_dn *dn,
+                                   struct sysdb_attrs *attrs);
+static void sysdb_ts_buffer_flush_dn(struct sysdb_ctx *sysdb,
+                                     struct ldb_dn *dn);
+static void sysdb_ts_buffer_merge(struct sysdb_ctx *sysdb,
+                                  struct ldb_message *msg,
+                                  const char **attrs);
+static bool sysdb_ts_buffer_allowed(struct sss_domain_info *domain,
+                                    time_t now);
+
 static uint32_t get_attr_as_uint32(struct ldb_message *msg, const char *attr)
 {
     const struct ldb_val *v = ldb_msg_find_ldb_val(msg, attr);
@@ -170,9 +184,66 @@ static int sysdb_delete_ts_entry(struct sysdb_ctx *sysdb,
         return EOK;
     }
 
+    sysdb_ts_buffer_forget(sysdb, dn);
+
     return sysdb_delete_cache_entry(sysdb->ldb_ts, dn, true);
 }
 
+void sysdb_set_change_cb(struct sysdb_ctx *sysdb,
+                         sysdb_change_fn fn,
+                         void *pvt)
+{
+    sysdb->change_fn = fn;
+    sysdb->change_pvt = pvt;
+}
+
+static bool sysdb_dn_val_is(const struct ldb_val *val, const char *str)
+{
+    return val != NULL && val->length == strlen(str)
+           && strncasecmp((const char *)val->data, str, val->length) == 0;
+}
+
+/* Calls the change callback if dn is name=<name>,cn=<users|groups>,
+ * cn=<domain>,cn=sysdb */
+static void sysdb_notify_change(struct sysdb_ctx *sysdb, struct ldb_dn *dn)
+{
+    const struct ldb_val *container;
+    const struct ldb_val *domain;
+    const struct ldb_val *name;
+    enum sysdb_member_type type;
+    char *domain_str;
+    char *name_str;
+
+    if (sysdb->change_fn == NULL || ldb_dn_get_comp_num(dn) != 4) {
+        return;
+    }
+
+    container = ldb_dn_get_component_val(dn, 1);
+    if (sysdb_dn_val_is(container, "users")) {
+        type = SYSDB_MEMBER_USER;
+    } else if (sysdb_dn_val_is(container, "groups")) {
+        type = SYSDB_MEMBER_GROUP;
+    } else {
+        return;
+    }
+
+    name = ldb_dn_get_component_val(dn, 0);
+    domain = ldb_dn_get_component_val(dn, 2);
+    if (name == NULL || domain == NULL) {
+        return;
+    }
+
+    domain_str = talloc_strndup(NULL, (const char *)domain->data,
+                                domain->length);
+    name_str = talloc_strndup(domain_str, (const char *)name->data,
+                              name->length);
+    if (domain_str != NULL && name_str != NULL) {
+        sysdb->change_fn(domain_str, type, name_str, sysdb->change_pvt);
+    }
+
+    talloc_free(domain_str);
+}
+
 int sysdb_delete_entry(struct sysdb_ctx *sysdb,
                        struct ldb_dn *dn,
                        bool ignore_not_found)
@@ -182,6 +253,7 @@ int sysdb_delete_entry(struct sysdb_ctx *sysdb,
 
     ret = sysdb_delete_cache_entry(sysdb->ldb, dn, ignore_not_found);
     if (ret == EOK) {
+        sysdb_notify_change(sysdb, dn);
         tret = sysdb_delete_ts_entry(sysdb, dn);
         if (tret != EOK) {
             DEBUG(SSSDBG_MINOR_FAILURE,
@@ -342,6 +414,8 @@ int sysdb_search_ts_entry(TALLOC_CTX *mem_ctx,
                           size_t *_msgs_count,
                           struct ldb_message ***_msgs)
 {
+    errno_t ret;
+
     if (sysdb->ldb_ts == NULL) {
         if (_msgs_count != NULL) {
             *_msgs_count = 0;
@@ -353,8 +427,22 @@ int sysdb_search_ts_entry(TALLOC_CTX *mem_ctx,
         return EOK;
     }
 
-    return sysdb_cache_search_entry(mem_ctx, sysdb->ldb_ts, base_dn, scope,
-                                    filter, attrs, _msgs_count, _msgs);
+    if (scope != LDB_SCOPE_BASE || filter != NULL) {
+        /* Searches by value have to find the buffered timestamps */
+        ret = sysdb_ts_buffer_flush(sysdb);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write buffered timestamps "
+                  "[%d]: %s\n", ret, sss_strerror(ret));
+        }
+    }
+
+    ret = sysdb_cache_search_entry(mem_ctx, sysdb->ldb_ts, base_dn, scope,
+                                   filter, attrs, _msgs_count, _msgs);
+    if (ret == EOK && scope == LDB_SCOPE_BASE && filter == NULL) {
+        sysdb_ts_buffer_merge(sysdb, (*_msgs)[0], attrs);
+    }
+
+    return ret;
 }
 
 /* =Search-Entry-by-SID-string============================================ */
@@ -416,12 +504,6 @@ done:
 
 /* =Search-User-by-[UID/SID/NAME]============================================= */
 
-enum sysdb_obj_type {
-    SYSDB_UNKNOWN = 0,
-    SYSDB_USER,
-    SYSDB_GROUP
-};
-
 static errno_t cleanup_dn_filter(TALLOC_CTX *mem_ctx,
                                 struct ldb_result *ts_res,
                                 const char *object_class,
@@ -495,6 +577,8 @@ static int sysdb_search_by_name(TALLOC_CTX *mem_ctx,
     const char *def_attrs[] = { SYSDB_NAME, NULL, NULL };
     const char *filter_tmpl = NULL;
     struct ldb_message **msgs = NULL;
+    struct ldb_parse_tree *tree;
+    struct ldb_result *res;
     struct ldb_dn *basedn;
     size_t msgs_count = 0;
     char *sanitized_name;
@@ -539,24 +623,50 @@ static int sysdb_search_by_name(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = sss_filter_sanitize_for_dom(tmp_ctx, name, domain, &sanitized_name,
-                                      &lc_sanitized_name);
-    if (ret != EOK) {
-        goto done;
-    }
+    if (filter_tmpl != SYSDB_GRNAM_MPG_FILTER) {
+        /* the common lookups use a filter which is not parsed again */
+        ret = sysdb_name_filter_tree(tmp_ctx, domain, type, name, &tree);
+        if (ret != EOK) {
+            goto done;
+        }
 
-    filter = talloc_asprintf(tmp_ctx, filter_tmpl, lc_sanitized_name,
-                             sanitized_name, sanitized_name);
-    if (!filter) {
-        ret = ENOMEM;
-        goto done;
-    }
+        ret = sysdb_search_tree(tmp_ctx, domain->sysdb->ldb, basedn,
+                                LDB_SCOPE_SUBTREE, tree,
+                                attrs?attrs:def_attrs, &res);
+        if (ret != LDB_SUCCESS) {
+            ret = sysdb_error_to_errno(ret);
+            goto done;
+        }
 
-    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, basedn, LDB_SCOPE_SUBTREE,
-                             filter, attrs?attrs:def_attrs,
-                             &msgs_count, &msgs);
-    if (ret) {
-        goto done;
+        if (res->count == 0) {
+            ret = ENOENT;
+            goto done;
+        }
+
+        msgs_count = res->count;
+        msgs = res->msgs;
+    } else {
+        ret = sss_filter_sanitize_for_dom(tmp_ctx, name, domain,
+                                          &sanitized_name,
+                                          &lc_sanitized_name);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        filter = talloc_asprintf(tmp_ctx, filter_tmpl, lc_sanitized_name,
+                                 sanitized_name, sanitized_name);
+        if (!filter) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = sysdb_cache_search_entry(tmp_ctx, domain->sysdb->ldb, basedn,
+                                       LDB_SCOPE_SUBTREE, filter,
+                                       attrs?attrs:def_attrs,
+                                       &msgs_count, &msgs);
+        if (ret) {
+            goto done;
+        }
     }
 
     ret = sysdb_merge_msg_list_ts_attrs(domain->sysdb, msgs_count, msgs, attrs);
@@ -1009,6 +1119,8 @@ static errno_t sysdb_create_ts_entry(struct sysdb_ctx *sysdb,
         goto done;
     }
 
+    sysdb_ts_buffer_forget(sysdb, entry_dn);
+
     lret = ldb_add(sysdb->ldb_ts, msg);
     if (lret != LDB_SUCCESS) {
         DEBUG(SSSDBG_OP_FAILURE,
@@ -1119,8 +1231,15 @@ static errno_t sysdb_update_ts_cache(struct sss_domain_info *domain,
         }
     }
 
-    ret = sysdb_set_ts_entry_attr(domain->sysdb, entry_dn,
-                                  ts_attrs, mod_op);
+    ret = ERR_NO_TS;
+    if (mod_op == SYSDB_MOD_REP && sysdb_ts_buffer_allowed(domain, now)) {
+        /* The entry itself did not change */
+        ret = sysdb_ts_buffer_add(domain->sysdb, entry_dn, ts_attrs);
+    }
+    if (ret != EOK) {
+        ret = sysdb_set_ts_entry_attr(domain->sysdb, entry_dn,
+                                      ts_attrs, mod_op);
+    }
     if (ret != EOK) {
         DEBUG(SSSDBG_MINOR_FAILURE,
               "Cannot set ts attrs for group %s\n",
@@ -1325,6 +1444,11 @@ static int sysdb_set_cache_entry_attr(struct ldb_context *ldb,
         goto done;
     }
 
+    ret = sysdb_msg_add_cert_hashes(msg);
+    if (ret != EOK) {
+        goto done;
+    }
+
     lret = ldb_modify(ldb, msg);
     if (lret != LDB_SUCCESS) {
         DEBUG(SSSDBG_MINOR_FAILURE,
@@ -1379,11 +1503,19 @@ int sysdb_set_entry_attr(struct sysdb_ctx *sysdb,
                   ldb_dn_get_linearized(entry_dn), ret, sss_strerror(ret));
         } else {
             state_mask |= SSS_SYSDB_CACHE;
+            sysdb_notify_change(sysdb, entry_dn);
         }
     }
 
     if (ret == EOK && is_ts_ldb_dn(entry_dn)) {
-        tret = sysdb_set_ts_entry_attr(sysdb, entry_dn, attrs, mod_op);
+        tret = ERR_NO_TS;
+        if (sysdb_write == false && mod_op == SYSDB_MOD_REP) {
+            /* Only the timestamps changed, they can be written later */
+            tret = sysdb_ts_buffer_add(sysdb, entry_dn, attrs);
+        }
+        if (tret != EOK) {
+            tret = sysdb_set_ts_entry_attr(sysdb, entry_dn, attrs, mod_op);
+        }
         if (tret == ENOENT && mod_op == SYSDB_MOD_REP) {
             /* Update failed because TS does non exist. Create missing TS */
             tret = sysdb_set_ts_entry_attr(sysdb, entry_dn, attrs,
@@ -1419,6 +1551,8 @@ static int sysdb_rep_ts_entry_attr(struct sysdb_ctx *sysdb,
         return EOK;
     }
 
+    sysdb_ts_buffer_flush_dn(sysdb, entry_dn);
+
     return sysdb_set_cache_entry_attr(sysdb->ldb_ts, entry_dn,
                                       attrs, SYSDB_MOD_REP);
 }
@@ -1464,183 +1598,618 @@ done:
     return ret;
 }
 
-/* =Replace-Attributes-On-User============================================ */
+/* =Buffered-Timestamp-Updates============================================ */
+
+/* Refreshing an entry that did not change only bumps its timestamps. These
+ * updates are kept in memory and written to the timestamp cache in one
+ * transaction instead of one transaction per entry. The expiration found in
+ * the timestamp cache when an update is buffered is remembered. If it has
+ * changed by the time the update is read or written, for example because
+ * sss_cache invalidated the entry, the buffered update is dropped. */
+
+struct sysdb_ts_buffer {
+    /* struct sysdb_ts_buffer_entry by the casefolded DN */
+    hash_table_t *entries;
+    unsigned int max_entries;
+    time_t max_delay;
+    /* When the oldest update was buffered */
+    time_t oldest;
+};
 
-int sysdb_set_user_attr(struct sss_domain_info *domain,
-                        const char *name,
-                        struct sysdb_attrs *attrs,
-                        int mod_op)
-{
+struct sysdb_ts_buffer_entry {
     struct ldb_dn *dn;
-    TALLOC_CTX *tmp_ctx;
-    errno_t ret;
+    struct sysdb_attrs *attrs;
+    uint64_t disk_expire;
+};
 
-    tmp_ctx = talloc_new(NULL);
-    if (!tmp_ctx) {
-        return ENOMEM;
-    }
+static void sysdb_invalidated_refresh(struct sss_domain_info *domain,
+                                      time_t now);
 
-    dn = sysdb_user_dn(tmp_ctx, domain, name);
-    if (!dn) {
-        ret = ENOMEM;
-        goto done;
-    }
+/* Shortly after sysdb_invalidate_type() the refreshed entries must reach
+ * the disk at once, otherwise the responders keep asking the back end
+ * until the buffer is written. */
+static bool sysdb_ts_buffer_allowed(struct sss_domain_info *domain,
+                                    time_t now)
+{
+    struct sysdb_ts_buffer *buf = domain->sysdb->ts_buffer;
 
-    ret = sysdb_set_entry_attr(domain->sysdb, dn, attrs, mod_op);
-    if (ret != EOK) {
-        goto done;
+    if (buf == NULL) {
+        return false;
     }
 
-    ret = EOK;
-done:
-    talloc_zfree(tmp_ctx);
-    return ret;
+    sysdb_invalidated_refresh(domain, now);
+
+    return MAX(domain->users_invalidated, domain->groups_invalidated)
+           + buf->max_delay < now;
 }
 
-/* =Replace-Attributes-On-Group=========================================== */
+static int sysdb_ts_buffer_destructor(struct sysdb_ctx *sysdb)
+{
+    /* Do not lose the updates on shutdown */
+    sysdb_ts_buffer_flush(sysdb);
+    return 0;
+}
 
-int sysdb_set_group_attr(struct sss_domain_info *domain,
-                         const char *name,
-                         struct sysdb_attrs *attrs,
-                         int mod_op)
+errno_t sysdb_ts_buffer_enable(struct sysdb_ctx *sysdb,
+                               unsigned int max_entries,
+                               time_t max_delay)
 {
-    struct ldb_dn *dn;
-    TALLOC_CTX *tmp_ctx;
-    errno_t ret;
+    struct sysdb_ts_buffer *buf;
 
-    tmp_ctx = talloc_new(NULL);
-    if (!tmp_ctx) {
-        ret = ENOMEM;
-        goto done;
+    if (sysdb->ts_buffer != NULL) {
+        sysdb_ts_buffer_flush(sysdb);
+        talloc_set_destructor(sysdb, NULL);
+        talloc_zfree(sysdb->ts_buffer);
     }
 
-    dn = sysdb_group_dn(tmp_ctx, domain, name);
-    if (!dn) {
-        ret = ENOMEM;
-        goto done;
+    if (sysdb->ldb_ts == NULL || max_entries == 0) {
+        return EOK;
     }
 
-    ret = sysdb_set_entry_attr(domain->sysdb, dn, attrs, mod_op);
-    if (ret) {
-        goto done;
+    buf = talloc_zero(sysdb, struct sysdb_ts_buffer);
+    if (buf == NULL) {
+        return ENOMEM;
     }
 
-    ret = EOK;
-done:
-    talloc_free(tmp_ctx);
-    return ret;
-}
+    buf->entries = sss_ptr_hash_create(buf, NULL, NULL);
+    if (buf->entries == NULL) {
+        talloc_free(buf);
+        return ENOMEM;
+    }
 
-/* =Replace-Attributes-On-Netgroup=========================================== */
+    buf->max_entries = max_entries;
+    buf->max_delay = max_delay;
+    sysdb->ts_buffer = buf;
+    talloc_set_destructor(sysdb, sysdb_ts_buffer_destructor);
 
-int sysdb_set_netgroup_attr(struct sss_domain_info *domain,
-                            const char *name,
-                            struct sysdb_attrs *attrs,
-                            int mod_op)
+    DEBUG(SSSDBG_CONF_SETTINGS, "Up to %u timestamp updates are written "
+          "at most %ld seconds later\n", max_entries, (long)max_delay);
+
+    return EOK;
+}
+
+static struct sysdb_ts_buffer_entry *
+sysdb_ts_buffer_lookup(struct sysdb_ctx *sysdb, struct ldb_dn *dn)
 {
-    errno_t ret;
-    struct ldb_dn *dn;
-    TALLOC_CTX *tmp_ctx;
+    const char *key;
 
-    tmp_ctx = talloc_new(NULL);
-    if (!tmp_ctx) {
-        return ENOMEM;
+    if (sysdb->ts_buffer == NULL
+            || hash_count(sysdb->ts_buffer->entries) == 0
+            || dn == NULL) {
+        return NULL;
     }
 
-    dn = sysdb_netgroup_dn(tmp_ctx, domain, name);
-    if (!dn) {
-        ret = ENOMEM;
-        goto done;
+    key = ldb_dn_get_casefold(dn);
+    if (key == NULL) {
+        return NULL;
     }
 
-    ret = sysdb_set_entry_attr(domain->sysdb, dn, attrs, mod_op);
-
-done:
-    talloc_free(tmp_ctx);
-    return ret;
+    return sss_ptr_hash_lookup(sysdb->ts_buffer->entries, key,
+                               struct sysdb_ts_buffer_entry);
 }
 
-/* =Get-New-ID============================================================ */
+void sysdb_ts_buffer_forget(struct sysdb_ctx *sysdb, struct ldb_dn *dn)
+{
+    /* Freeing the entry removes it from the table */
+    talloc_free(sysdb_ts_buffer_lookup(sysdb, dn));
+}
 
-int sysdb_get_new_id(struct sss_domain_info *domain,
-                     uint32_t *_id)
+static errno_t sysdb_ts_buffer_get_expire(struct sysdb_ctx *sysdb,
+                                          struct ldb_dn *dn,
+                                          uint64_t *_expire)
 {
-    TALLOC_CTX *tmp_ctx;
-    const char *attrs_1[] = { SYSDB_NEXTID, NULL };
-    const char *attrs_2[] = { SYSDB_UIDNUM, SYSDB_GIDNUM, NULL };
-    struct ldb_dn *base_dn;
-    char *filter;
-    uint32_t new_id = 0;
+    static const char *attrs[] = { SYSDB_CACHE_EXPIRE, NULL };
     struct ldb_message **msgs;
-    size_t count;
-    struct ldb_message *msg;
-    uint32_t id;
-    int ret;
-    int i;
+    size_t msgs_count;
+    errno_t ret;
 
-    tmp_ctx = talloc_new(NULL);
-    if (!tmp_ctx) {
-        return ENOMEM;
+    ret = sysdb_cache_search_entry(NULL, sysdb->ldb_ts, dn, LDB_SCOPE_BASE,
+                                   NULL, attrs, &msgs_count, &msgs);
+    if (ret != EOK) {
+        return ret;
     }
 
-    if (!local_provider_is_built()
-            || strcasecmp(domain->provider, "local") != 0) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Generating new ID is only supported in the local domain!\n");
-        return ENOTSUP;
-    }
+    *_expire = ldb_msg_find_attr_as_uint64(msgs[0], SYSDB_CACHE_EXPIRE, 0);
+    talloc_free(msgs);
 
-    base_dn = sysdb_domain_dn(tmp_ctx, domain);
-    if (!base_dn) {
-        talloc_zfree(tmp_ctx);
-        return ENOMEM;
-    }
+    return EOK;
+}
 
-    ret = ldb_transaction_start(domain->sysdb->ldb);
-    if (ret) {
-        talloc_zfree(tmp_ctx);
-        ret = sysdb_error_to_errno(ret);
+static errno_t sysdb_ts_buffer_write(struct sysdb_ctx *sysdb,
+                                     struct sysdb_ts_buffer_entry *entry)
+{
+    uint64_t expire;
+    errno_t ret;
+
+    ret = sysdb_ts_buffer_get_expire(sysdb, entry->dn, &expire);
+    if (ret == ENOENT) {
+        /* The entry was removed in the meantime */
+        return EOK;
+    } else if (ret != EOK) {
         return ret;
     }
 
-    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, base_dn, LDB_SCOPE_BASE,
-                             SYSDB_NEXTID_FILTER, attrs_1, &count, &msgs);
-    switch (ret) {
-    case EOK:
-        new_id = get_attr_as_uint32(msgs[0], SYSDB_NEXTID);
-        if (new_id == (uint32_t)(-1)) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Invalid Next ID in domain %s\n", domain->name);
-            ret = ERANGE;
-            goto done;
-        }
+    if (expire != entry->disk_expire) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Timestamps of [%s] were changed in the "
+              "meantime, dropping the buffered update\n",
+              ldb_dn_get_linearized(entry->dn));
+        return EOK;
+    }
 
-        if (new_id < domain->id_min) {
-            new_id = domain->id_min;
-        }
+    return sysdb_set_cache_entry_attr(sysdb->ldb_ts, entry->dn,
+                                      entry->attrs, SYSDB_MOD_REP);
+}
 
-        if ((domain->id_max != 0) && (new_id > domain->id_max)) {
-            DEBUG(SSSDBG_FATAL_FAILURE,
-                  "Failed to allocate new id, out of range (%u/%u)\n",
-                      new_id, domain->id_max);
-            ret = ERANGE;
-            goto done;
-        }
-        break;
+errno_t sysdb_ts_buffer_flush(struct sysdb_ctx *sysdb)
+{
+    struct sysdb_ts_buffer *buf = sysdb->ts_buffer;
+    struct sysdb_ts_buffer_entry *entry;
+    bool in_transaction = false;
+    hash_value_t *values;
+    unsigned long count;
+    unsigned long i;
+    errno_t ret;
+    int hret;
+    int lret;
 
-    case ENOENT:
-        /* looks like the domain is not initialized yet, use min_id */
-        new_id = domain->id_min;
-        break;
+    if (buf == NULL || hash_count(buf->entries) == 0) {
+        return EOK;
+    }
 
-    default:
-        goto done;
+    hret = hash_values(buf->entries, &count, &values);
+    if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to list buffered timestamps "
+              "[%d]: %s\n", hret, hash_error_string(hret));
+        return EIO;
     }
-    talloc_zfree(msgs);
-    count = 0;
 
-    /* verify the id is actually really free.
-     * search all entries with id >= new_id and < max_id */
+    lret = ldb_transaction_start(sysdb->ldb_ts);
+    if (lret == LDB_SUCCESS) {
+        in_transaction = true;
+    } else {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to start timestamp cache "
+              "transaction [%d]: %s\n", lret, ldb_errstring(sysdb->ldb_ts));
+    }
+
+    for (i = 0; i < count; i++) {
+        entry = sss_ptr_get_value(&values[i], struct sysdb_ts_buffer_entry);
+        if (entry == NULL) {
+            continue;
+        }
+
+        ret = sysdb_ts_buffer_write(sysdb, entry);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Cannot write timestamps of [%s] "
+                  "[%d]: %s\n", ldb_dn_get_linearized(entry->dn),
+                  ret, sss_strerror(ret));
+            /* Not fatal */
+        }
+    }
+    talloc_free(values);
+
+    ret = EOK;
+    if (in_transaction) {
+        lret = ldb_transaction_commit(sysdb->ldb_ts);
+        if (lret != LDB_SUCCESS) {
+            /* The timestamps are refreshed with the next update */
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to commit timestamp cache "
+                  "transaction [%d]: %s\n", lret,
+                  ldb_errstring(sysdb->ldb_ts));
+            ret = sysdb_error_to_errno(lret);
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Wrote %lu buffered timestamp updates\n", count);
+
+    sss_ptr_hash_delete_all(buf->entries, true);
+    buf->oldest = 0;
+
+    return ret;
+}
+
+/* Writes the buffered update of the entry before its timestamps are
+ * written directly. */
+static void sysdb_ts_buffer_flush_dn(struct sysdb_ctx *sysdb,
+                                     struct ldb_dn *dn)
+{
+    struct sysdb_ts_buffer_entry *entry;
+    errno_t ret;
+
+    entry = sysdb_ts_buffer_lookup(sysdb, dn);
+    if (entry == NULL) {
+        return;
+    }
+
+    ret = sysdb_ts_buffer_write(sysdb, entry);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot write timestamps of [%s] "
+              "[%d]: %s\n", ldb_dn_get_linearized(dn), ret, sss_strerror(ret));
+    }
+
+    talloc_free(entry);
+}
+
+static errno_t sysdb_ts_buffer_copy_el(TALLOC_CTX *mem_ctx,
+                                       struct ldb_message_element *dst,
+                                       struct ldb_message_element *src)
+{
+    struct ldb_val *values;
+    unsigned int i;
+
+    values = talloc_array(mem_ctx, struct ldb_val, src->num_values);
+    if (values == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < src->num_values; i++) {
+        values[i] = ldb_val_dup(values, &src->values[i]);
+        if (values[i].data == NULL && src->values[i].data != NULL) {
+            talloc_free(values);
+            return ENOMEM;
+        }
+    }
+
+    talloc_free(dst->values);
+    dst->values = values;
+    dst->num_values = src->num_values;
+
+    return EOK;
+}
+
+/* Buffers the timestamps in attrs to be replaced later. Returns EOK if the
+ * update was buffered, any other return value means that the caller has to
+ * write the timestamps itself. */
+static errno_t sysdb_ts_buffer_add(struct sysdb_ctx *sysdb,
+                                   struct ldb_dn *dn,
+                                   struct sysdb_attrs *attrs)
+{
+    struct sysdb_ts_buffer *buf = sysdb->ts_buffer;
+    struct sysdb_ts_buffer_entry *entry;
+    struct ldb_message_element *el;
+    struct sysdb_attrs *ts_attrs;
+    TALLOC_CTX *tmp_ctx;
+    uint64_t expire;
+    time_t now;
+    errno_t ret;
+    int i;
+
+    if (buf == NULL || sysdb->ldb_ts == NULL) {
+        return ERR_NO_TS;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ts_attrs = sysdb_filter_ts_attrs(tmp_ctx, attrs);
+    if (ts_attrs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (ts_attrs->num == 0) {
+        ret = EOK;
+        goto done;
+    }
+
+    now = time(NULL);
+
+    entry = sysdb_ts_buffer_lookup(sysdb, dn);
+    if (entry == NULL) {
+        /* A missing entry is created by the caller */
+        ret = sysdb_ts_buffer_get_expire(sysdb, dn, &expire);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        entry = talloc_zero(buf, struct sysdb_ts_buffer_entry);
+        if (entry == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        entry->disk_expire = expire;
+        entry->dn = ldb_dn_copy(entry, dn);
+        entry->attrs = sysdb_new_attrs(entry);
+        if (entry->dn == NULL || entry->attrs == NULL) {
+            talloc_free(entry);
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = sss_ptr_hash_add(buf->entries, ldb_dn_get_casefold(entry->dn),
+                               entry, struct sysdb_ts_buffer_entry);
+        if (ret != EOK) {
+            talloc_free(entry);
+            goto done;
+        }
+
+        if (buf->oldest == 0) {
+            buf->oldest = now;
+        }
+    }
+
+    for (i = 0; i < ts_attrs->num; i++) {
+        ret = sysdb_attrs_get_el_ext(entry->attrs, ts_attrs->a[i].name,
+                                     true, &el);
+        if (ret == EOK) {
+            ret = sysdb_ts_buffer_copy_el(entry->attrs, el, &ts_attrs->a[i]);
+        }
+        if (ret != EOK) {
+            /* Let the caller write this update */
+            talloc_free(entry);
+            goto done;
+        }
+    }
+
+    if (hash_count(buf->entries) >= buf->max_entries
+            || now - buf->oldest >= buf->max_delay) {
+        ret = sysdb_ts_buffer_flush(sysdb);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write buffered timestamps "
+                  "[%d]: %s\n", ret, sss_strerror(ret));
+            /* Not fatal, the update was handled */
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Replaces the timestamps of msg found in the timestamp cache with the
+ * buffered ones. */
+static void sysdb_ts_buffer_merge(struct sysdb_ctx *sysdb,
+                                  struct ldb_message *msg,
+                                  const char **attrs)
+{
+    struct sysdb_ts_buffer_entry *entry;
+    struct ldb_message_element *src;
+    struct ldb_message_element *dst;
+    uint64_t expire;
+    errno_t ret;
+    int lret;
+    int i;
+
+    entry = sysdb_ts_buffer_lookup(sysdb, msg->dn);
+    if (entry == NULL) {
+        return;
+    }
+
+    if (ldb_msg_find_element(msg, SYSDB_CACHE_EXPIRE) != NULL) {
+        expire = ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0);
+        if (expire != entry->disk_expire) {
+            DEBUG(SSSDBG_TRACE_FUNC, "Timestamps of [%s] were changed in the "
+                  "meantime, dropping the buffered update\n",
+                  ldb_dn_get_linearized(msg->dn));
+            talloc_free(entry);
+            return;
+        }
+    }
+
+    for (i = 0; i < entry->attrs->num; i++) {
+        src = &entry->attrs->a[i];
+        if (attrs != NULL
+                && !string_in_list(src->name, discard_const(attrs), false)
+                && !string_in_list("*", discard_const(attrs), false)) {
+            continue;
+        }
+
+        dst = ldb_msg_find_element(msg, src->name);
+        if (dst == NULL) {
+            lret = ldb_msg_add_empty(msg, src->name, 0, &dst);
+            if (lret != LDB_SUCCESS) {
+                return;
+            }
+        }
+
+        ret = sysdb_ts_buffer_copy_el(msg->elements, dst, src);
+        if (ret != EOK) {
+            return;
+        }
+    }
+}
+
+/* =Replace-Attributes-On-User============================================ */
+
+int sysdb_set_user_attr(struct sss_domain_info *domain,
+                        const char *name,
+                        struct sysdb_attrs *attrs,
+                        int mod_op)
+{
+    struct ldb_dn *dn;
+    TALLOC_CTX *tmp_ctx;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (!tmp_ctx) {
+        return ENOMEM;
+    }
+
+    dn = sysdb_user_dn(tmp_ctx, domain, name);
+    if (!dn) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_set_entry_attr(domain->sysdb, dn, attrs, mod_op);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = EOK;
+done:
+    talloc_zfree(tmp_ctx);
+    return ret;
+}
+
+/* =Replace-Attributes-On-Group=========================================== */
+
+int sysdb_set_group_attr(struct sss_domain_info *domain,
+                         const char *name,
+                         struct sysdb_attrs *attrs,
+                         int mod_op)
+{
+    struct ldb_dn *dn;
+    TALLOC_CTX *tmp_ctx;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (!tmp_ctx) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    dn = sysdb_group_dn(tmp_ctx, domain, name);
+    if (!dn) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_set_entry_attr(domain->sysdb, dn, attrs, mod_op);
+    if (ret) {
+        goto done;
+    }
+
+    ret = EOK;
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* =Replace-Attributes-On-Netgroup=========================================== */
+
+int sysdb_set_netgroup_attr(struct sss_domain_info *domain,
+                            const char *name,
+                            struct sysdb_attrs *attrs,
+                            int mod_op)
+{
+    errno_t ret;
+    struct ldb_dn *dn;
+    TALLOC_CTX *tmp_ctx;
+
+    tmp_ctx = talloc_new(NULL);
+    if (!tmp_ctx) {
+        return ENOMEM;
+    }
+
+    dn = sysdb_netgroup_dn(tmp_ctx, domain, name);
+    if (!dn) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_set_entry_attr(domain->sysdb, dn, attrs, mod_op);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* =Get-New-ID============================================================ */
+
+int sysdb_get_new_id(struct sss_domain_info *domain,
+                     uint32_t *_id)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char *attrs_1[] = { SYSDB_NEXTID, NULL };
+    const char *attrs_2[] = { SYSDB_UIDNUM, SYSDB_GIDNUM, NULL };
+    struct ldb_dn *base_dn;
+    char *filter;
+    uint32_t new_id = 0;
+    struct ldb_message **msgs;
+    size_t count;
+    struct ldb_message *msg;
+    uint32_t id;
+    int ret;
+    int i;
+
+    tmp_ctx = talloc_new(NULL);
+    if (!tmp_ctx) {
+        return ENOMEM;
+    }
+
+    if (!local_provider_is_built()
+            || strcasecmp(domain->provider, "local") != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Generating new ID is only supported in the local domain!\n");
+        return ENOTSUP;
+    }
+
+    base_dn = sysdb_domain_dn(tmp_ctx, domain);
+    if (!base_dn) {
+        talloc_zfree(tmp_ctx);
+        return ENOMEM;
+    }
+
+    ret = ldb_transaction_start(domain->sysdb->ldb);
+    if (ret) {
+        talloc_zfree(tmp_ctx);
+        ret = sysdb_error_to_errno(ret);
+        return ret;
+    }
+
+    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, base_dn, LDB_SCOPE_BASE,
+                             SYSDB_NEXTID_FILTER, attrs_1, &count, &msgs);
+    switch (ret) {
+    case EOK:
+        new_id = get_attr_as_uint32(msgs[0], SYSDB_NEXTID);
+        if (new_id == (uint32_t)(-1)) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Invalid Next ID in domain %s\n", domain->name);
+            ret = ERANGE;
+            goto done;
+        }
+
+        if (new_id < domain->id_min) {
+            new_id = domain->id_min;
+        }
+
+        if ((domain->id_max != 0) && (new_id > domain->id_max)) {
+            DEBUG(SSSDBG_FATAL_FAILURE,
+                  "Failed to allocate new id, out of range (%u/%u)\n",
+                      new_id, domain->id_max);
+            ret = ERANGE;
+            goto done;
+        }
+        break;
+
+    case ENOENT:
+        /* looks like the domain is not initialized yet, use min_id */
+        new_id = domain->id_min;
+        break;
+
+    default:
+        goto done;
+    }
+    talloc_zfree(msgs);
+    count = 0;
+
+    /* verify the id is actually really free.
+     * search all entries with id >= new_id and < max_id */
     if (domain->id_max) {
         filter = talloc_asprintf(tmp_ctx,
                                  "(|(&(%s>=%u)(%s<=%u))(&(%s>=%u)(%s<=%u)))",
@@ -2567,6 +3136,8 @@ int sysdb_mod_group_member(struct sss_domain_info *domain,
         DEBUG(SSSDBG_MINOR_FAILURE,
               "ldb_modify failed: [%s](%d)[%s]\n",
               ldb_strerror(ret), ret, ldb_errstring(domain->sysdb->ldb));
+    } else {
+        sysdb_notify_change(domain->sysdb, group_dn);
     }
     ret = sysdb_error_to_errno(ret);
 
@@ -2918,28 +3489,402 @@ static errno_t sysdb_store_user_attrs(struct sss_domain_info *domain,
         if (ret) return ret;
     }
 
-    ret = sysdb_attrs_add_time_t(attrs, SYSDB_LAST_UPDATE, now);
-    if (ret) return ret;
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_LAST_UPDATE, now);
+    if (ret) return ret;
+
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_CACHE_EXPIRE,
+                                 ((cache_timeout) ?
+                                  (now + cache_timeout) : 0));
+    if (ret) return ret;
+
+    ret = sysdb_set_user_attr(domain, name, attrs, SYSDB_MOD_REP);
+    if (ret) return ret;
+
+    if (remove_attrs) {
+        ret = sysdb_remove_attrs(domain, name,
+                                 SYSDB_MEMBER_USER,
+                                 remove_attrs);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CONF_SETTINGS,
+                  "Could not remove missing attributes\n");
+        }
+    }
+
+    return EOK;
+}
+
+/* =Store-Users-in-bulk=================================================== */
+
+/* Number of users looked up with a single search */
+#define SYSDB_STORE_USERS_CHUNK 100
+
+/* How a name was found in the cache */
+#define SYSDB_STORE_USERS_NAME  0x01
+#define SYSDB_STORE_USERS_ALIAS 0x02
+
+static errno_t sysdb_store_users_mark(hash_table_t *table,
+                                      struct ldb_message_element *el,
+                                      unsigned long flag)
+{
+    hash_key_t key;
+    hash_value_t value;
+    unsigned int i;
+    int hret;
+
+    if (el == NULL) {
+        return EOK;
+    }
+
+    for (i = 0; i < el->num_values; i++) {
+        key.type = HASH_KEY_STRING;
+        key.str = (char *)el->values[i].data;
+
+        hret = hash_lookup(table, &key, &value);
+        if (hret == HASH_SUCCESS) {
+            value.ul |= flag;
+        } else if (hret == HASH_ERROR_KEY_NOT_FOUND) {
+            value.type = HASH_VALUE_ULONG;
+            value.ul = flag;
+        } else {
+            return EIO;
+        }
+
+        hret = hash_enter(table, &key, &value);
+        if (hret != HASH_SUCCESS) {
+            return EIO;
+        }
+    }
+
+    return EOK;
+}
+
+static errno_t sysdb_store_users_mark_name(hash_table_t *table,
+                                           const char *name)
+{
+    struct ldb_message_element el;
+    struct ldb_val val;
+
+    val.data = (uint8_t *)discard_const(name);
+    val.length = strlen(name);
+    el.num_values = 1;
+    el.values = &val;
+
+    return sysdb_store_users_mark(table, &el, SYSDB_STORE_USERS_NAME);
+}
+
+static unsigned long sysdb_store_users_flags(hash_table_t *table,
+                                             const char *name)
+{
+    hash_key_t key;
+    hash_value_t value;
+    int hret;
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(name);
+
+    hret = hash_lookup(table, &key, &value);
+    if (hret != HASH_SUCCESS) {
+        return 0;
+    }
+
+    return value.ul;
+}
+
+/* Records the names and aliases of the cached users that match the names
+ * of users[0..count-1], using the same filter as sysdb_search_user_by_name().
+ * All users must belong to the same domain. */
+static errno_t sysdb_store_users_find(hash_table_t *table,
+                                      struct sysdb_store_user_entry *users,
+                                      size_t count)
+{
+    TALLOC_CTX *tmp_ctx;
+    static const char *attrs[] = { SYSDB_NAME, SYSDB_NAME_ALIAS, NULL };
+    struct sss_domain_info *domain = users[0].domain;
+    struct ldb_result *res;
+    struct ldb_dn *base_dn;
+    char *sanitized;
+    char *lc_sanitized;
+    char *filter;
+    size_t i;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    filter = talloc_strdup(tmp_ctx, "(&("SYSDB_UC")(|");
+    for (i = 0; i < count && filter != NULL; i++) {
+        ret = sss_filter_sanitize_for_dom(tmp_ctx, users[i].name, domain,
+                                          &sanitized, &lc_sanitized);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        filter = talloc_asprintf_append(filter,
+                                        "("SYSDB_NAME_ALIAS"=%s)"
+                                        "("SYSDB_NAME_ALIAS"=%s)"
+                                        "("SYSDB_NAME"=%s)",
+                                        sanitized, lc_sanitized, sanitized);
+    }
+    if (filter != NULL) {
+        filter = talloc_asprintf_append(filter, "))");
+    }
+    if (filter == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    base_dn = sysdb_user_base_dn(tmp_ctx, domain);
+    if (base_dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                     LDB_SCOPE_SUBTREE, attrs, "%s", filter);
+    if (ret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(ret);
+        goto done;
+    }
+
+    for (i = 0; i < res->count; i++) {
+        ret = sysdb_store_users_mark(table,
+                                     ldb_msg_find_element(res->msgs[i],
+                                                          SYSDB_NAME),
+                                     SYSDB_STORE_USERS_NAME);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = sysdb_store_users_mark(table,
+                                     ldb_msg_find_element(res->msgs[i],
+                                                          SYSDB_NAME_ALIAS),
+                                     SYSDB_STORE_USERS_ALIAS);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t sysdb_store_users_entry(hash_table_t *table,
+                                       struct sysdb_store_user_entry *user,
+                                       time_t now)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sss_domain_info *domain = user->domain;
+    struct sysdb_attrs *attrs = user->attrs;
+    unsigned long flags;
+    char *lc_name;
+    bool in_transaction = false;
+    errno_t sret;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    lc_name = sss_tc_utf8_str_tolower(tmp_ctx, user->name);
+    if (lc_name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    flags = sysdb_store_users_flags(table, user->name)
+            | (sysdb_store_users_flags(table, lc_name)
+               & SYSDB_STORE_USERS_ALIAS);
+
+    if (flags != 0 && flags != SYSDB_STORE_USERS_NAME) {
+        /* Found by an alias, let sysdb_store_user() sort it out */
+        ret = sysdb_store_user(domain, user->name, user->pwd, user->uid,
+                               user->gid, user->gecos, user->homedir,
+                               user->shell, user->orig_dn, user->attrs,
+                               user->remove_attrs, user->cache_timeout, now);
+        goto done;
+    }
+
+    if (attrs == NULL) {
+        attrs = sysdb_new_attrs(tmp_ctx);
+        if (attrs == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    if (user->pwd && !*user->pwd) {
+        ret = sysdb_attrs_add_string(attrs, SYSDB_PWD, user->pwd);
+        if (ret) goto done;
+    }
+
+    ret = sysdb_transaction_start(domain->sysdb);
+    if (ret != EOK) {
+        goto done;
+    }
+    in_transaction = true;
+
+    if (flags == 0) {
+        DEBUG(SSSDBG_TRACE_LIBS, "User %s does not exist.\n", user->name);
+        ret = sysdb_store_new_user(domain, user->name, user->uid, user->gid,
+                                   user->gecos, user->homedir, user->shell,
+                                   user->orig_dn, attrs, user->cache_timeout,
+                                   now);
+    } else {
+        ret = sysdb_store_user_attrs(domain, user->name, user->uid,
+                                     user->gid, user->gecos, user->homedir,
+                                     user->shell, user->orig_dn, attrs,
+                                     user->remove_attrs, user->cache_timeout,
+                                     now);
+    }
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_transaction_commit(domain->sysdb);
+    if (ret != EOK) {
+        goto done;
+    }
+    in_transaction = false;
+
+done:
+    if (in_transaction) {
+        sret = sysdb_transaction_cancel(domain->sysdb);
+        if (sret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Could not cancel transaction\n");
+        }
+    }
+
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Cache update of user %s failed [%d]: %s\n",
+              user->name, ret, sss_strerror(ret));
+    } else {
+        DEBUG(SSSDBG_TRACE_FUNC, "User \"%s\" has been stored\n", user->name);
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+errno_t sysdb_store_users(struct sysdb_ctx *sysdb,
+                          struct sysdb_store_user_entry *users,
+                          size_t num_users,
+                          time_t now)
+{
+    TALLOC_CTX *tmp_ctx;
+    hash_table_t *table;
+    bool in_transaction = false;
+    bool in_ts_transaction = false;
+    size_t start;
+    size_t count;
+    size_t i;
+    errno_t sret;
+    errno_t ret;
+    int lret;
+
+    if (num_users == 0) {
+        return EOK;
+    }
+
+    if (now == 0) {
+        now = time(NULL);
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sss_hash_create(tmp_ctx, num_users, &table);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_transaction_start(sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to start transaction\n");
+        goto done;
+    }
+    in_transaction = true;
+
+    /* Without a transaction each timestamp update would be committed to
+     * the timestamp cache on its own. */
+    if (sysdb->ldb_ts != NULL) {
+        lret = ldb_transaction_start(sysdb->ldb_ts);
+        if (lret == LDB_SUCCESS) {
+            in_ts_transaction = true;
+        } else {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to start timestamp cache "
+                  "transaction [%d]: %s\n", lret,
+                  ldb_errstring(sysdb->ldb_ts));
+        }
+    }
+
+    for (start = 0; start < num_users; start += count) {
+        for (count = 1; start + count < num_users
+                        && count < SYSDB_STORE_USERS_CHUNK
+                        && users[start + count].domain == users[start].domain;
+             count++);
+
+        ret = sysdb_store_users_find(table, &users[start], count);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to look up cached users "
+                  "[%d]: %s\n", ret, sss_strerror(ret));
+            goto done;
+        }
+
+        for (i = start; i < start + count; i++) {
+            users[i].ret = sysdb_store_users_entry(table, &users[i], now);
+            if (users[i].ret == EOK) {
+                /* The same user may appear in the batch more than once */
+                ret = sysdb_store_users_mark_name(table, users[i].name);
+                if (ret != EOK) {
+                    goto done;
+                }
+            }
+        }
+    }
+
+    ret = sysdb_transaction_commit(sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to commit transaction\n");
+        goto done;
+    }
+    in_transaction = false;
 
-    ret = sysdb_attrs_add_time_t(attrs, SYSDB_CACHE_EXPIRE,
-                                 ((cache_timeout) ?
-                                  (now + cache_timeout) : 0));
-    if (ret) return ret;
+    if (in_ts_transaction) {
+        lret = ldb_transaction_commit(sysdb->ldb_ts);
+        if (lret != LDB_SUCCESS) {
+            /* The timestamps are refreshed with the next update */
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to commit timestamp cache "
+                  "transaction [%d]: %s\n", lret,
+                  ldb_errstring(sysdb->ldb_ts));
+        }
+        in_ts_transaction = false;
+    }
 
-    ret = sysdb_set_user_attr(domain, name, attrs, SYSDB_MOD_REP);
-    if (ret) return ret;
+    ret = EOK;
 
-    if (remove_attrs) {
-        ret = sysdb_remove_attrs(domain, name,
-                                 SYSDB_MEMBER_USER,
-                                 remove_attrs);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_CONF_SETTINGS,
-                  "Could not remove missing attributes\n");
+done:
+    if (in_ts_transaction) {
+        lret = ldb_transaction_cancel(sysdb->ldb_ts);
+        if (lret != LDB_SUCCESS) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Could not cancel timestamp cache "
+                  "transaction\n");
         }
     }
-
-    return EOK;
+    if (in_transaction) {
+        sret = sysdb_transaction_cancel(sysdb);
+        if (sret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Could not cancel transaction\n");
+        }
+    }
+    talloc_free(tmp_ctx);
+    return ret;
 }
 
 /* =Store-Group-(Native/Legacy)-(replaces-existing-data)================== */
@@ -3388,6 +4333,39 @@ done:
     return ret;
 }
 
+errno_t sysdb_set_entry_access(struct sss_domain_info *domain,
+                               struct ldb_dn *entry_dn,
+                               time_t access_time)
+{
+    struct sysdb_attrs *attrs;
+    errno_t ret;
+
+    if (domain->sysdb->ldb_ts == NULL || !is_ts_ldb_dn(entry_dn)) {
+        return EOK;
+    }
+
+    attrs = sysdb_new_attrs(NULL);
+    if (attrs == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_LAST_ACCESS, access_time);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_set_ts_entry_attr(domain->sysdb, entry_dn, attrs,
+                                  SYSDB_MOD_REP);
+    if (ret == ENOENT) {
+        /* The entry has no timestamps to keep the access time with. */
+        ret = EOK;
+    }
+
+done:
+    talloc_free(attrs);
+    return ret;
+}
+
 /* =Custom Search================== */
 
 int sysdb_search_custom(TALLOC_CTX *mem_ctx,
@@ -3697,6 +4675,17 @@ int sysdb_delete_custom(struct sss_domain_info *domain,
         break;
     }
 
+    if (ret == EOK && is_ts_ldb_dn(dn)) {
+        ret = sysdb_delete_ts_entry(domain->sysdb, dn);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Could not delete the timestamp entry of %s [%d]: %s\n",
+                  ldb_dn_get_linearized(dn), ret, sss_strerror(ret));
+            /* Not fatal */
+            ret = EOK;
+        }
+    }
+
 done:
     talloc_zfree(tmp_ctx);
     return ret;
@@ -3958,6 +4947,12 @@ int sysdb_search_ts_users(TALLOC_CTX *mem_ctx,
         return ERR_NO_TS;
     }
 
+    ret = sysdb_ts_buffer_flush(domain->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write buffered timestamps "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
     ret = sysdb_cache_search_users(mem_ctx, domain, domain->sysdb->ldb_ts,
                                     sub_filter, attrs, &msgs_count, &msgs);
     if (ret == EOK) {
@@ -4238,6 +5233,179 @@ int sysdb_search_groups(TALLOC_CTX *mem_ctx,
                                          attrs);
 }
 
+/* =Stream-Search-Entries================================================= */
+
+struct sysdb_stream_state {
+    struct sysdb_ctx *sysdb;
+    const char **attrs;
+    sysdb_stream_fn fn;
+    void *pvt;
+    size_t count;
+    errno_t ret;
+};
+
+static int sysdb_stream_callback(struct ldb_request *req,
+                                 struct ldb_reply *ares)
+{
+    struct sysdb_stream_state *state;
+    errno_t ret;
+
+    state = talloc_get_type(req->context, struct sysdb_stream_state);
+
+    if (ares == NULL) {
+        return ldb_request_done(req, LDB_ERR_OPERATIONS_ERROR);
+    }
+
+    if (ares->error != LDB_SUCCESS) {
+        ret = ares->error;
+        talloc_free(ares);
+        return ldb_request_done(req, ret);
+    }
+
+    switch (ares->type) {
+    case LDB_REPLY_ENTRY:
+        state->count++;
+
+        ret = sysdb_merge_msg_list_ts_attrs(state->sysdb, 1, &ares->message,
+                                            state->attrs);
+        if (ret == EOK) {
+            ret = state->fn(ares->message, state->pvt);
+        }
+
+        /* Only the current entry is kept in memory */
+        talloc_free(ares);
+        if (ret != EOK) {
+            state->ret = ret;
+            return ldb_request_done(req, LDB_ERR_OPERATIONS_ERROR);
+        }
+        return LDB_SUCCESS;
+    case LDB_REPLY_REFERRAL:
+        talloc_free(ares);
+        return LDB_SUCCESS;
+    case LDB_REPLY_DONE:
+        talloc_free(ares);
+        return ldb_request_done(req, LDB_SUCCESS);
+    }
+
+    talloc_free(ares);
+    return LDB_SUCCESS;
+}
+
+errno_t sysdb_search_entry_stream(struct sysdb_ctx *sysdb,
+                                  struct ldb_dn *base_dn,
+                                  enum ldb_scope scope,
+                                  const char *filter,
+                                  const char **attrs,
+                                  sysdb_stream_fn fn,
+                                  void *pvt)
+{
+    struct sysdb_stream_state *state;
+    struct ldb_request *req;
+    errno_t ret;
+
+    state = talloc_zero(NULL, struct sysdb_stream_state);
+    if (state == NULL) {
+        return ENOMEM;
+    }
+
+    state->sysdb = sysdb;
+    state->attrs = attrs;
+    state->fn = fn;
+    state->pvt = pvt;
+    state->ret = EOK;
+
+    ret = ldb_build_search_req(&req, sysdb->ldb, state, base_dn, scope,
+                               filter, attrs, NULL, state,
+                               sysdb_stream_callback, NULL);
+    if (ret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(ret);
+        goto done;
+    }
+
+    ret = ldb_request(sysdb->ldb, req);
+    if (ret == LDB_SUCCESS) {
+        ret = ldb_wait(req->handle, LDB_WAIT_ALL);
+    }
+
+    if (state->ret != EOK) {
+        /* Stopped by the callback */
+        ret = state->ret;
+        goto done;
+    } else if (ret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(ret);
+        goto done;
+    }
+
+    ret = state->count == 0 ? ENOENT : EOK;
+
+done:
+    talloc_free(state);
+    return ret;
+}
+
+static errno_t sysdb_search_objects_stream(struct sss_domain_info *domain,
+                                           struct ldb_dn *basedn,
+                                           const char *object_filter,
+                                           const char *sub_filter,
+                                           const char **attrs,
+                                           sysdb_stream_fn fn,
+                                           void *pvt)
+{
+    char *filter;
+    errno_t ret;
+
+    if (basedn == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to build base dn\n");
+        return ENOMEM;
+    }
+
+    filter = talloc_asprintf(NULL, "(&(%s)%s)", object_filter, sub_filter);
+    if (filter == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to build filter\n");
+        return ENOMEM;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Streaming entries with filter: %s\n",
+          filter);
+
+    ret = sysdb_search_entry_stream(domain->sysdb, basedn, LDB_SCOPE_SUBTREE,
+                                    filter, attrs, fn, pvt);
+    talloc_free(filter);
+    return ret;
+}
+
+errno_t sysdb_search_users_stream(struct sss_domain_info *domain,
+                                  const char *sub_filter,
+                                  const char **attrs,
+                                  sysdb_stream_fn fn,
+                                  void *pvt)
+{
+    struct ldb_dn *basedn;
+    errno_t ret;
+
+    basedn = sysdb_user_base_dn(NULL, domain);
+    ret = sysdb_search_objects_stream(domain, basedn, SYSDB_UC, sub_filter,
+                                      attrs, fn, pvt);
+    talloc_free(basedn);
+    return ret;
+}
+
+errno_t sysdb_search_groups_stream(struct sss_domain_info *domain,
+                                   const char *sub_filter,
+                                   const char **attrs,
+                                   sysdb_stream_fn fn,
+                                   void *pvt)
+{
+    struct ldb_dn *basedn;
+    errno_t ret;
+
+    basedn = sysdb_group_base_dn(NULL, domain);
+    ret = sysdb_search_objects_stream(domain, basedn, SYSDB_GC, sub_filter,
+                                      attrs, fn, pvt);
+    talloc_free(basedn);
+    return ret;
+}
+
 int sysdb_search_groups_by_timestamp(TALLOC_CTX *mem_ctx,
                                      struct sss_domain_info *domain,
                                      const char *sub_filter,
@@ -4322,6 +5490,12 @@ int sysdb_search_ts_groups(TALLOC_CTX *mem_ctx,
         return ERR_NO_TS;
     }
 
+    ret = sysdb_ts_buffer_flush(domain->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write buffered timestamps "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
     ret = sysdb_cache_search_groups(mem_ctx, domain, domain->sysdb->ldb_ts,
                                     sub_filter, attrs, &msgs_count, &msgs);
     if (ret == EOK) {
@@ -5286,71 +6460,244 @@ errno_t sysdb_search_object_by_uuid(TALLOC_CTX *mem_ctx,
                                            uuid_str, attrs, true, res);
 }
 
-errno_t sysdb_cert_derb64_to_ldap_filter(TALLOC_CTX *mem_ctx,
-                                         const char *derb64,
-                                         const char *attr_name,
-                                         char **ldap_filter)
+errno_t sysdb_cert_derb64_to_ldap_filter(TALLOC_CTX *mem_ctx,
+                                         const char *derb64,
+                                         const char *attr_name,
+                                         char **ldap_filter)
+{
+    int ret;
+    unsigned char *der;
+    size_t der_size;
+    char *val;
+
+    if (derb64 == NULL || attr_name == NULL) {
+        return EINVAL;
+    }
+
+    der = sss_base64_decode(mem_ctx, derb64, &der_size);
+    if (der == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "sss_base64_decode failed.\n");
+        return EINVAL;
+    }
+
+    ret = bin_to_ldap_filter_value(mem_ctx, der, der_size, &val);
+    talloc_free(der);
+    if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "bin_to_ldap_filter_value failed.\n");
+            return ret;
+    }
+
+    *ldap_filter = talloc_asprintf(mem_ctx, "(%s=%s)", attr_name, val);
+    talloc_free(val);
+    if (*ldap_filter == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "talloc_asprintf failed.\n");
+            return ENOMEM;
+    }
+
+    return EOK;
+}
+
+/* Only the first half of the SHA-256 hash is kept, the objects found by
+ * it are compared with the whole certificate anyway */
+#define SYSDB_CERT_HASH_LEN (SSS_SHA256_LENGTH / 2)
+
+errno_t sysdb_cert_hash(TALLOC_CTX *mem_ctx,
+                        const uint8_t *der,
+                        size_t der_size,
+                        char **_hash)
+{
+    unsigned char md[SSS_SHA256_LENGTH];
+    char *hash;
+    size_t c;
+    errno_t ret;
+
+    ret = sss_sha256(der, der_size, md);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "sss_sha256 failed.\n");
+        return ret;
+    }
+
+    hash = talloc_array(mem_ctx, char, SYSDB_CERT_HASH_LEN * 2 + 1);
+    if (hash == NULL) {
+        return ENOMEM;
+    }
+
+    for (c = 0; c < SYSDB_CERT_HASH_LEN; c++) {
+        snprintf(hash + c * 2, 3, "%02x", md[c]);
+    }
+
+    *_hash = hash;
+    return EOK;
+}
+
+/* Adds the hashes of the mapped certificates which msg adds, replaces or
+ * deletes with the same operation, so the index stays in sync */
+errno_t sysdb_msg_add_cert_hashes(struct ldb_message *msg)
+{
+    struct ldb_message_element *el;
+    struct ldb_message_element *hash_el;
+    struct ldb_val *hashes = NULL;
+    unsigned int num_values;
+    unsigned int flags;
+    unsigned int i;
+    char *hash;
+    errno_t ret;
+    int lret;
+
+    el = ldb_msg_find_element(msg, SYSDB_USER_MAPPED_CERT);
+    if (el == NULL
+            || ldb_msg_find_element(msg, SYSDB_USER_MAPPED_CERT_HASH) != NULL) {
+        return EOK;
+    }
+
+    num_values = el->num_values;
+    flags = el->flags;
+
+    if (num_values > 0) {
+        hashes = talloc_array(msg, struct ldb_val, num_values);
+        if (hashes == NULL) {
+            return ENOMEM;
+        }
+
+        for (i = 0; i < num_values; i++) {
+            ret = sysdb_cert_hash(hashes, el->values[i].data,
+                                  el->values[i].length, &hash);
+            if (ret != EOK) {
+                talloc_free(hashes);
+                return ret;
+            }
+            hashes[i].data = (uint8_t *) hash;
+            hashes[i].length = strlen(hash);
+        }
+    }
+
+    /* invalidates el */
+    lret = ldb_msg_add_empty(msg, SYSDB_USER_MAPPED_CERT_HASH, flags, &hash_el);
+    if (lret != LDB_SUCCESS) {
+        talloc_free(hashes);
+        return sysdb_error_to_errno(lret);
+    }
+
+    hash_el->values = hashes;
+    hash_el->num_values = num_values;
+
+    return EOK;
+}
+
+/* Keeps the objects of res which really have the certificate der */
+static void sysdb_filter_cert_result(struct ldb_result *res,
+                                     const uint8_t *der, size_t der_size,
+                                     bool keep_cert_attr)
+{
+    struct ldb_message_element *el;
+    unsigned int count = 0;
+    unsigned int i;
+    unsigned int j;
+
+    for (i = 0; i < res->count; i++) {
+        el = ldb_msg_find_element(res->msgs[i], SYSDB_USER_MAPPED_CERT);
+        for (j = 0; el != NULL && j < el->num_values; j++) {
+            if (el->values[j].length == der_size
+                    && memcmp(el->values[j].data, der, der_size) == 0) {
+                break;
+            }
+        }
+
+        if (el == NULL || j == el->num_values) {
+            DEBUG(SSSDBG_TRACE_FUNC, "[%s] only has the hash of the "
+                  "certificate.\n", ldb_dn_get_linearized(res->msgs[i]->dn));
+            talloc_free(res->msgs[i]);
+            continue;
+        }
+
+        if (!keep_cert_attr) {
+            ldb_msg_remove_element(res->msgs[i], el);
+        }
+        res->msgs[count++] = res->msgs[i];
+    }
+
+    res->count = count;
+}
+
+errno_t sysdb_search_object_by_cert(TALLOC_CTX *mem_ctx,
+                                    struct sss_domain_info *domain,
+                                    const char *cert,
+                                    const char **attrs,
+                                    struct ldb_result **res)
 {
-    int ret;
+    TALLOC_CTX *tmp_ctx;
+    const char *def_attrs[] = { SYSDB_NAME, SYSDB_UIDNUM, SYSDB_GIDNUM,
+                                ORIGINALAD_PREFIX SYSDB_NAME,
+                                SYSDB_DEFAULT_ATTRS,
+                                NULL };
+    const char **search_attrs;
+    bool keep_cert_attr = true;
+    struct ldb_result *result;
     unsigned char *der;
     size_t der_size;
-    char *val;
+    char *hash;
+    char *filter;
+    errno_t ret;
 
-    if (derb64 == NULL || attr_name == NULL) {
+    if (cert == NULL) {
         return EINVAL;
     }
 
-    der = sss_base64_decode(mem_ctx, derb64, &der_size);
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    der = sss_base64_decode(tmp_ctx, cert, &der_size);
     if (der == NULL) {
         DEBUG(SSSDBG_OP_FAILURE, "sss_base64_decode failed.\n");
-        return EINVAL;
+        ret = EINVAL;
+        goto done;
     }
 
-    ret = bin_to_ldap_filter_value(mem_ctx, der, der_size, &val);
-    talloc_free(der);
+    /* The binary certificate is only compared with the objects found by the
+     * short index key of its hash */
+    ret = sysdb_cert_hash(tmp_ctx, der, der_size, &hash);
     if (ret != EOK) {
-            DEBUG(SSSDBG_OP_FAILURE, "bin_to_ldap_filter_value failed.\n");
-            return ret;
+        goto done;
     }
 
-    *ldap_filter = talloc_asprintf(mem_ctx, "(%s=%s)", attr_name, val);
-    talloc_free(val);
-    if (*ldap_filter == NULL) {
-            DEBUG(SSSDBG_OP_FAILURE, "talloc_asprintf failed.\n");
-            return ENOMEM;
+    filter = talloc_asprintf(tmp_ctx, SYSDB_USER_CERT_HASH_FILTER, hash);
+    if (filter == NULL) {
+        ret = ENOMEM;
+        goto done;
     }
 
-    return EOK;
-}
-
-errno_t sysdb_search_object_by_cert(TALLOC_CTX *mem_ctx,
-                                    struct sss_domain_info *domain,
-                                    const char *cert,
-                                    const char **attrs,
-                                    struct ldb_result **res)
-{
-    int ret;
-    char *user_filter = NULL;
-    char *filter = NULL;
+    search_attrs = attrs != NULL ? attrs : def_attrs;
+    if (!string_in_list(SYSDB_USER_MAPPED_CERT, discard_const(search_attrs),
+                        false)) {
+        ret = add_strings_lists(tmp_ctx, search_attrs,
+                                (const char *[]) { SYSDB_USER_MAPPED_CERT,
+                                                   NULL },
+                                false, discard_const(&search_attrs));
+        if (ret != EOK) {
+            goto done;
+        }
+        keep_cert_attr = false;
+    }
 
-    ret = sysdb_cert_derb64_to_ldap_filter(mem_ctx, cert,
-                                           SYSDB_USER_MAPPED_CERT,
-                                           &user_filter);
+    ret = sysdb_search_object_attr(tmp_ctx, domain, filter, search_attrs,
+                                   false, &result);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "sss_cert_derb64_to_ldap_filter failed.\n");
-        return ret;
+        goto done;
     }
 
-    filter = talloc_asprintf(NULL, SYSDB_USER_CERT_FILTER, user_filter);
-    talloc_free(user_filter);
-    if (filter == NULL) {
-        return ENOMEM;
+    sysdb_filter_cert_result(result, der, der_size, keep_cert_attr);
+    if (result->count == 0) {
+        ret = ENOENT;
+        goto done;
     }
 
-    ret = sysdb_search_object_attr(mem_ctx, domain, filter, attrs, false, res);
-
-    talloc_free(filter);
+    *res = talloc_steal(mem_ctx, result);
+    ret = EOK;
 
+done:
+    talloc_free(tmp_ctx);
     return ret;
 }
 
@@ -5738,6 +7085,7 @@ errno_t sysdb_mark_entry_as_expired_ldb_dn(struct sss_domain_info *dom,
     }
 
     if (dom->sysdb->ldb_ts != NULL) {
+        sysdb_ts_buffer_forget(dom->sysdb, msg->dn);
         ret = ldb_modify(dom->sysdb->ldb_ts, msg);
         if (ret != LDB_SUCCESS) {
             DEBUG(SSSDBG_MINOR_FAILURE,
@@ -5833,6 +7181,7 @@ int sysdb_invalidate_cache_entry(struct sss_domain_info *domain,
     }
 
     if (sysdb->ldb_ts != NULL) {
+        sysdb_ts_buffer_forget(sysdb, entry_dn);
         ret = sysdb_set_cache_entry_attr(sysdb->ldb_ts, entry_dn,
                                          attrs, SYSDB_MOD_REP);
         if (ret != EOK) {
@@ -5853,3 +7202,338 @@ done:
     talloc_zfree(tmp_ctx);
     return ret;
 }
+
+/* The times are kept in the timestamp cache when there is one, the cache
+ * itself is not modified then */
+static struct ldb_context *sysdb_invalidated_ldb(struct sysdb_ctx *sysdb)
+{
+    return sysdb->ldb_ts != NULL ? sysdb->ldb_ts : sysdb->ldb;
+}
+
+errno_t sysdb_invalidate_type(struct sss_domain_info *domain,
+                              enum sysdb_member_type type)
+{
+    struct ldb_context *ldb = sysdb_invalidated_ldb(domain->sysdb);
+    struct ldb_message *msg;
+    TALLOC_CTX *tmp_ctx;
+    const char *attr;
+    time_t now;
+    errno_t ret;
+    int lret;
+
+    switch (type) {
+    case SYSDB_MEMBER_USER:
+        attr = SYSDB_USERS_INVALIDATED;
+        break;
+    case SYSDB_MEMBER_GROUP:
+        attr = SYSDB_GROUPS_INVALIDATED;
+        break;
+    default:
+        return EINVAL;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    msg = ldb_msg_new(tmp_ctx);
+    if (msg == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    msg->dn = ldb_dn_new_fmt(msg, ldb, SYSDB_DOM_BASE, domain->name);
+    if (msg->dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    now = time(NULL);
+    lret = ldb_msg_add_empty(msg, attr, LDB_FLAG_MOD_REPLACE, NULL);
+    if (lret == LDB_SUCCESS) {
+        lret = ldb_msg_add_fmt(msg, attr, "%lld", (long long)now);
+    }
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    lret = ldb_modify(ldb, msg);
+    if (lret == LDB_ERR_NO_SUCH_OBJECT) {
+        /* The timestamp cache has no domain entries until now */
+        msg->elements[0].flags = 0;
+        lret = ldb_msg_add_string(msg, "cn", domain->name);
+        if (lret == LDB_SUCCESS) {
+            lret = ldb_add(ldb, msg);
+        }
+    }
+    if (lret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to store %s of domain %s: [%s]\n",
+              attr, domain->name, ldb_errstring(ldb));
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    if (type == SYSDB_MEMBER_USER) {
+        domain->users_invalidated = now;
+    } else {
+        domain->groups_invalidated = now;
+    }
+
+    DEBUG(SSSDBG_FUNC_DATA, "All %s of domain %s have been invalidated.\n",
+          type == SYSDB_MEMBER_USER ? "users" : "groups", domain->name);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static void sysdb_invalidated_refresh(struct sss_domain_info *domain,
+                                      time_t now)
+{
+    static const char *attrs[] = { SYSDB_USERS_INVALIDATED,
+                                   SYSDB_GROUPS_INVALIDATED,
+                                   NULL };
+    struct ldb_context *ldb;
+    struct ldb_message **msgs;
+    struct ldb_dn *dn;
+    size_t count;
+    errno_t ret;
+
+    if (domain->invalidated_read == now || domain->sysdb == NULL) {
+        return;
+    }
+    domain->invalidated_read = now;
+
+    ldb = sysdb_invalidated_ldb(domain->sysdb);
+    dn = ldb_dn_new_fmt(NULL, ldb, SYSDB_DOM_BASE, domain->name);
+    if (dn == NULL) {
+        return;
+    }
+
+    ret = sysdb_cache_search_entry(dn, ldb, dn, LDB_SCOPE_BASE, NULL,
+                                   attrs, &count, &msgs);
+    if (ret == EOK) {
+        domain->users_invalidated = ldb_msg_find_attr_as_uint64(msgs[0],
+                                                SYSDB_USERS_INVALIDATED, 0);
+        domain->groups_invalidated = ldb_msg_find_attr_as_uint64(msgs[0],
+                                                SYSDB_GROUPS_INVALIDATED, 0);
+    } else if (ret != ENOENT) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to read the invalidation of "
+              "domain %s [%d]: %s\n", domain->name, ret, sss_strerror(ret));
+    }
+
+    talloc_free(dn);
+}
+
+bool sysdb_entry_invalidated(struct sss_domain_info *domain,
+                             struct ldb_message *msg)
+{
+    const char *category;
+    uint64_t last_update;
+    time_t invalidated;
+
+    sysdb_invalidated_refresh(domain, time(NULL));
+
+    if (domain->users_invalidated == 0 && domain->groups_invalidated == 0) {
+        return false;
+    }
+
+    category = ldb_msg_find_attr_as_string(msg, SYSDB_OBJECTCATEGORY, NULL);
+    if (category == NULL) {
+        return false;
+    } else if (strcasecmp(category, SYSDB_USER_CLASS) == 0) {
+        invalidated = domain->users_invalidated;
+    } else if (strcasecmp(category, SYSDB_GROUP_CLASS) == 0) {
+        invalidated = domain->groups_invalidated;
+    } else {
+        return false;
+    }
+
+    /* An entry updated in the same second is refreshed once more */
+    last_update = ldb_msg_find_attr_as_uint64(msg, SYSDB_LAST_UPDATE, 0);
+    return invalidated != 0 && last_update <= (uint64_t)invalidated;
+}
+
+/* =Import-Cache-Fixup==================================================== */
+
+static errno_t sysdb_import_shift_time(struct ldb_message *msg,
+                                       struct ldb_message *mod,
+                                       const char *attr,
+                                       time_t delta)
+{
+    uint64_t value;
+    int lret;
+
+    value = ldb_msg_find_attr_as_uint64(msg, attr, 0);
+    if (value == 0) {
+        /* Expired on purpose or never set, keep it that way */
+        return EOK;
+    }
+
+    if (delta < 0 && value <= (uint64_t)(-delta)) {
+        value = 1;
+    } else {
+        value += delta;
+    }
+
+    lret = ldb_msg_add_empty(mod, attr, LDB_FLAG_MOD_REPLACE, NULL);
+    if (lret == LDB_SUCCESS) {
+        lret = ldb_msg_add_fmt(mod, attr, "%llu", (unsigned long long)value);
+    }
+
+    return sysdb_error_to_errno(lret);
+}
+
+static errno_t sysdb_import_fixup_ldb(struct ldb_context *ldb,
+                                      struct ldb_dn *base_dn,
+                                      time_t delta,
+                                      const char **strip_attrs)
+{
+    const char *filter = "(|(" SYSDB_CACHE_EXPIRE "=*)"
+                           "(" SYSDB_INITGR_EXPIRE "=*)"
+                           "(" SYSDB_CACHEDPWD "=*)"
+                           "(" SYSDB_LAST_ONLINE_AUTH "=*)"
+                           "(" SYSDB_FAILED_LOGIN_ATTEMPTS "=*))";
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_result *res;
+    struct ldb_message *mod;
+    bool in_transaction = false;
+    errno_t ret;
+    int lret;
+    size_t i;
+    size_t j;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    lret = ldb_transaction_start(ldb);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+    in_transaction = true;
+
+    lret = ldb_search(ldb, tmp_ctx, &res, base_dn, LDB_SCOPE_SUBTREE,
+                      NULL, "%s", filter);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    for (i = 0; i < res->count; i++) {
+        mod = ldb_msg_new(tmp_ctx);
+        if (mod == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        mod->dn = res->msgs[i]->dn;
+
+        if (delta != 0) {
+            ret = sysdb_import_shift_time(res->msgs[i], mod,
+                                          SYSDB_CACHE_EXPIRE, delta);
+            if (ret != EOK) {
+                goto done;
+            }
+
+            ret = sysdb_import_shift_time(res->msgs[i], mod,
+                                          SYSDB_INITGR_EXPIRE, delta);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+
+        for (j = 0; strip_attrs != NULL && strip_attrs[j] != NULL; j++) {
+            if (ldb_msg_find_element(res->msgs[i], strip_attrs[j]) == NULL) {
+                continue;
+            }
+
+            lret = ldb_msg_add_empty(mod, strip_attrs[j],
+                                     LDB_FLAG_MOD_DELETE, NULL);
+            if (lret != LDB_SUCCESS) {
+                ret = sysdb_error_to_errno(lret);
+                goto done;
+            }
+        }
+
+        if (mod->num_elements == 0) {
+            talloc_free(mod);
+            continue;
+        }
+
+        lret = ldb_modify(ldb, mod);
+        if (lret != LDB_SUCCESS) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to fix up [%s]: %s\n",
+                  ldb_dn_get_linearized(mod->dn), ldb_errstring(ldb));
+            ret = sysdb_error_to_errno(lret);
+            goto done;
+        }
+        talloc_free(mod);
+    }
+
+    lret = ldb_transaction_commit(ldb);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+    in_transaction = false;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Fixed up %u imported entries\n", res->count);
+    ret = EOK;
+
+done:
+    if (in_transaction) {
+        ldb_transaction_cancel(ldb);
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+errno_t sysdb_cache_import_fixup(struct sysdb_ctx *sysdb,
+                                 struct sss_domain_info *domain,
+                                 time_t delta)
+{
+    /* Credentials and login state belong to the host that cached them */
+    const char *strip_attrs[] = { SYSDB_CACHEDPWD,
+                                  SYSDB_CACHEDPWD_TYPE,
+                                  SYSDB_CACHEDPWD_FA2_LEN,
+                                  SYSDB_LAST_ONLINE_AUTH,
+                                  SYSDB_LAST_ONLINE_AUTH_WITH_CURR_TOKEN,
+                                  SYSDB_FAILED_LOGIN_ATTEMPTS,
+                                  SYSDB_LAST_FAILED_LOGIN,
+                                  NULL };
+    struct ldb_dn *base_dn;
+    errno_t ret;
+
+    base_dn = sysdb_domain_dn(NULL, domain);
+    if (base_dn == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_import_fixup_ldb(sysdb->ldb, base_dn, delta, strip_attrs);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to fix up %s [%d]: %s\n",
+              sysdb->ldb_file, ret, sss_strerror(ret));
+        goto done;
+    }
+
+    if (sysdb->ldb_ts != NULL) {
+        ret = sysdb_import_fixup_ldb(sysdb->ldb_ts, base_dn, delta, NULL);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to fix up %s [%d]: %s\n",
+                  sysdb->ldb_ts_file, ret, sss_strerror(ret));
+            goto done;
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(base_dn);
+    return ret;
+}
@@ -23,6 +23,9 @@
 #ifndef __INT_SYS_DB_H__
 #define __INT_SYS_DB_H__
 
+#define SYSDB_VERSION_0_25 "0.25"
+#define SYSDB_VERSION_0_24 "0.24"
+#define SYSDB_VERSION_0_23 "0.23"
 #define SYSDB_VERSION_0_22 "0.22"
 #define SYSDB_VERSION_0_21 "0.21"
 #define SYSDB_VERSION_0_20 "0.20"
@@ -46,7 +49,7 @@
 #define SYSDB_VERSION_0_2 "0.2"
 #define SYSDB_VERSION_0_1 "0.1"
 
-#define SYSDB_VERSION SYSDB_VERSION_0_22
+#define SYSDB_VERSION SYSDB_VERSION_0_25
 
 #define SYSDB_BASE_LDIF \
      "dn: @ATTRIBUTES\n" \
@@ -75,6 +78,7 @@
      "@IDXATTR: servicePort\n" \
      "@IDXATTR: serviceProtocol\n" \
      "@IDXATTR: sudoUser\n" \
+     "@IDXATTR: sudoUserIndex\n" \
      "@IDXATTR: sshKnownHostsExpire\n" \
      "@IDXATTR: objectSIDString\n" \
      "@IDXATTR: ghost\n" \
@@ -83,9 +87,11 @@
      "@IDXATTR: uniqueID\n" \
      "@IDXATTR: mail\n" \
      "@IDXATTR: userMappedCertificate\n" \
+     "@IDXATTR: userMappedCertificateHash\n" \
      "@IDXATTR: ccacheFile\n" \
      "@IDXATTR: ipHostNumber\n" \
      "@IDXATTR: ipNetworkNumber\n" \
+     "@IDXATTR: automountKey\n" \
      "\n" \
      "dn: @MODULES\n" \
      "@LIST: asq,memberof\n" \
@@ -121,6 +127,12 @@
 
 #include "db/sysdb.h"
 
+struct sysdb_initgr_index;
+struct sysdb_ts_buffer;
+
+/* Created next to a cache opened without syncing while SSSD runs */
+#define SYSDB_UNCLEAN_MARKER_SUFFIX ".unclean"
+
 struct sysdb_ctx {
     struct ldb_context *ldb;
     char *ldb_file;
@@ -128,7 +140,36 @@ struct sysdb_ctx {
     struct ldb_context *ldb_ts;
     char *ldb_ts_file;
 
+    /* The databases use the LMDB backend of ldb instead of TDB */
+    bool lmdb;
+
+    /* The cache is opened without syncing, see sysdb_mark_clean_shutdown */
+    bool nosync;
+
     int transaction_nesting;
+
+    /* start of the outermost transaction and totals of the finished ones */
+    struct timeval transaction_start;
+    uint64_t num_transactions;
+    uint64_t transaction_usecs;
+
+    /* Groups of recently looked up users, see sysdb_initgroups_with_views */
+    struct sysdb_initgr_index *initgr_index;
+
+    /* Timestamp updates not written yet, see sysdb_ts_buffer_enable */
+    struct sysdb_ts_buffer *ts_buffer;
+
+    /* Told about written users and groups, see sysdb_set_change_cb */
+    sysdb_change_fn change_fn;
+    void *change_pvt;
+
+    /* Parsed and casefolded base DNs of the domains, see
+     * sysdb_cached_base_dn */
+    hash_table_t *base_dns;
+
+    /* Parsed name filters, see sysdb_name_filter_tree */
+    struct ldb_parse_tree *pwnam_tree;
+    struct ldb_parse_tree *grnam_tree;
 };
 
 /* Internal utility functions */
@@ -142,6 +183,7 @@ errno_t sysdb_ldb_connect(TALLOC_CTX *mem_ctx,
                           const char *filename,
                           int flags,
                           struct ldb_context **_ldb);
+errno_t sysdb_remove_db_file(const char *ldb_file);
 
 struct sysdb_dom_upgrade_ctx {
     struct sss_names_ctx *names; /* upgrade to 0.18 needs to parse names */
@@ -180,9 +222,16 @@ int sysdb_upgrade_18(struct sysdb_ctx *sysdb, const char **ver);
 int sysdb_upgrade_19(struct sysdb_ctx *sysdb, const char **ver);
 int sysdb_upgrade_20(struct sysdb_ctx *sysdb, const char **ver);
 int sysdb_upgrade_21(struct sysdb_ctx *sysdb, const char **ver);
+int sysdb_upgrade_22(struct sysdb_ctx *sysdb, const char **ver);
+int sysdb_upgrade_23(struct sysdb_ctx *sysdb, const char **ver);
+int sysdb_upgrade_24(struct sysdb_ctx *sysdb, const char **ver);
 
 int sysdb_ts_upgrade_01(struct sysdb_ctx *sysdb, const char **ver);
 
+int sysdb_upgrade_backend(const char *ldb_file, bool to_lmdb);
+
+errno_t sysdb_msg_add_cert_hashes(struct ldb_message *msg);
+
 int sysdb_add_string(struct ldb_message *msg,
                      const char *attr, const char *value);
 int sysdb_replace_string(struct ldb_message *msg,
@@ -201,9 +250,9 @@ int sysdb_delete_ulong(struct ldb_message *msg,
  * opaque to the sysdb consumers
  */
 
-/* Returns true if the 'dn' parameter is a user or a group DN, because
- * at the moment, the timestamps cache only handles users and groups.
- * Returns false otherwise.
+/* Returns true if the 'dn' parameter is a DN of a user, group, netgroup,
+ * service, host or sudo rule, because at the moment, the timestamps cache
+ * only handles these objects. Returns false otherwise.
  */
 bool is_ts_ldb_dn(struct ldb_dn *dn);
 
@@ -236,6 +285,34 @@ errno_t sysdb_merge_msg_list_ts_attrs(struct sysdb_ctx *ctx,
                                       struct ldb_message **msgs,
                                       const char *attrs[]);
 
+/* Drops the buffered timestamp update of the entry, used when the
+ * timestamps are changed directly, e.g. when the entry is invalidated.
+ */
+void sysdb_ts_buffer_forget(struct sysdb_ctx *sysdb, struct ldb_dn *dn);
+
+enum sysdb_obj_type {
+    SYSDB_UNKNOWN = 0,
+    SYSDB_USER,
+    SYSDB_GROUP
+};
+
+/* Returns SYSDB_PWNAM_FILTER or SYSDB_GRNAM_FILTER for name as a parse
+ * tree, the filter itself is only parsed once. */
+errno_t sysdb_name_filter_tree(TALLOC_CTX *mem_ctx,
+                               struct sss_domain_info *dom,
+                               enum sysdb_obj_type type,
+                               const char *name,
+                               struct ldb_parse_tree **_tree);
+
+/* ldb_search() with an already parsed filter */
+int sysdb_search_tree(TALLOC_CTX *mem_ctx,
+                      struct ldb_context *ldb,
+                      struct ldb_dn *base_dn,
+                      enum ldb_scope scope,
+                      struct ldb_parse_tree *tree,
+                      const char **attrs,
+                      struct ldb_result **_res);
+
 /* Merge two sets of ldb_result structures. */
 struct ldb_result *sss_merge_ldb_results(struct ldb_result *res,
                                          struct ldb_result *subres);
@@ -20,6 +20,7 @@
 */
 
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
 #include "db/sysdb_private.h"
 #include "confdb/confdb.h"
 #include <time.h>
@@ -282,10 +283,9 @@ int sysdb_getpwnam(TALLOC_CTX *mem_ctx,
 {
     TALLOC_CTX *tmp_ctx;
     static const char *attrs[] = SYSDB_PW_ATTRS;
+    struct ldb_parse_tree *tree;
     struct ldb_dn *base_dn;
     struct ldb_result *res;
-    char *sanitized_name;
-    char *lc_sanitized_name;
     int ret;
 
     tmp_ctx = talloc_new(NULL);
@@ -299,16 +299,13 @@ int sysdb_getpwnam(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = sss_filter_sanitize_for_dom(tmp_ctx, name, domain,
-                                      &sanitized_name, &lc_sanitized_name);
+    ret = sysdb_name_filter_tree(tmp_ctx, domain, SYSDB_USER, name, &tree);
     if (ret != EOK) {
         goto done;
     }
 
-    ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                     LDB_SCOPE_SUBTREE, attrs, SYSDB_PWNAM_FILTER,
-                     lc_sanitized_name,
-                     sanitized_name, sanitized_name);
+    ret = sysdb_search_tree(tmp_ctx, domain->sysdb->ldb, base_dn,
+                            LDB_SCOPE_SUBTREE, tree, attrs, &res);
     if (ret) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -326,7 +323,7 @@ int sysdb_getpwnam(TALLOC_CTX *mem_ctx,
               "address shared among multiple users or an email address of a "
               "user that conflicts with another user's fully qualified name. "
               "SSSD will not be able to handle those users properly.\n",
-              sanitized_name);
+              name);
     }
 
     /* Merge in the timestamps from the fast ts db */
@@ -412,14 +409,14 @@ done:
     return ret;
 }
 
-int sysdb_getpwuid(TALLOC_CTX *mem_ctx,
-                   struct sss_domain_info *domain,
-                   uid_t uid,
-                   struct ldb_result **_res)
+static int sysdb_getpwuid_attrs(TALLOC_CTX *mem_ctx,
+                                struct sss_domain_info *domain,
+                                uid_t uid,
+                                const char **attrs,
+                                struct ldb_result **_res)
 {
     TALLOC_CTX *tmp_ctx;
     unsigned long int ul_uid = uid;
-    static const char *attrs[] = SYSDB_PW_ATTRS;
     struct ldb_dn *base_dn;
     struct ldb_result *res;
     int ret;
@@ -457,14 +454,31 @@ done:
     return ret;
 }
 
-errno_t sysdb_getpwuid_with_views(TALLOC_CTX *mem_ctx,
-                                  struct sss_domain_info *domain,
-                                  uid_t uid,
-                                  struct ldb_result **res)
+int sysdb_getpwuid(TALLOC_CTX *mem_ctx,
+                   struct sss_domain_info *domain,
+                   uid_t uid,
+                   struct ldb_result **_res)
+{
+    static const char *attrs[] = SYSDB_PW_ATTRS;
+
+    return sysdb_getpwuid_attrs(mem_ctx, domain, uid, attrs, _res);
+}
+
+/* If attributes is NULL all user attributes are returned */
+static errno_t sysdb_getpwuid_attrs_with_views(TALLOC_CTX *mem_ctx,
+                                               struct sss_domain_info *domain,
+                                               uid_t uid,
+                                               const char **attributes,
+                                               struct ldb_result **res)
 {
     int ret;
     struct ldb_result *orig_obj = NULL;
     struct ldb_result *override_obj = NULL;
+    static const char *default_attrs[] = SYSDB_PW_ATTRS;
+    const char **attrs = NULL;
+    const char *mandatory_override_attrs[] = {SYSDB_OVERRIDE_DN,
+                                              SYSDB_OVERRIDE_OBJECT_DN,
+                                              NULL};
     TALLOC_CTX *tmp_ctx;
 
     tmp_ctx = talloc_new(NULL);
@@ -473,13 +487,26 @@ errno_t sysdb_getpwuid_with_views(TALLOC_CTX *mem_ctx,
         return ENOMEM;
     }
 
+    attrs = attributes;
+
     /* If there are views we first have to search the overrides for matches */
     if (DOM_HAS_VIEWS(domain)) {
-        ret = sysdb_search_user_override_by_uid(tmp_ctx, domain, uid,
-                                                &override_obj, &orig_obj);
+        if (attributes != NULL) {
+            ret = add_strings_lists(tmp_ctx, attributes,
+                                    mandatory_override_attrs, false,
+                                    discard_const(&attrs));
+            if (ret != EOK) {
+                DEBUG(SSSDBG_OP_FAILURE, "add_strings_lists failed.\n");
+                goto done;
+            }
+        }
+
+        ret = sysdb_search_user_override_attrs_by_uid(tmp_ctx, domain, uid,
+                                                      attrs, &override_obj,
+                                                      &orig_obj);
         if (ret != EOK && ret != ENOENT) {
             DEBUG(SSSDBG_OP_FAILURE,
-                  "sysdb_search_user_override_by_uid failed.\n");
+                  "sysdb_search_user_override_attrs_by_uid failed.\n");
             goto done;
         }
     }
@@ -487,7 +514,9 @@ errno_t sysdb_getpwuid_with_views(TALLOC_CTX *mem_ctx,
     /* If there are no views or nothing was found in the overrides the
      * original objects are searched. */
     if (orig_obj == NULL) {
-        ret = sysdb_getpwuid(tmp_ctx, domain, uid, &orig_obj);
+        ret = sysdb_getpwuid_attrs(tmp_ctx, domain, uid,
+                                   attrs == NULL ? default_attrs : attrs,
+                                   &orig_obj);
         if (ret != EOK) {
             DEBUG(SSSDBG_OP_FAILURE, "sysdb_getpwuid failed.\n");
             goto done;
@@ -499,7 +528,7 @@ errno_t sysdb_getpwuid_with_views(TALLOC_CTX *mem_ctx,
     if (DOM_HAS_VIEWS(domain) && orig_obj->count == 1) {
         ret = sysdb_add_overrides_to_object(domain, orig_obj->msgs[0],
                            override_obj == NULL ? NULL : override_obj->msgs[0],
-                           NULL);
+                           attrs);
         if (ret != EOK && ret != ENOENT) {
             DEBUG(SSSDBG_OP_FAILURE, "sysdb_add_overrides_to_object failed.\n");
             goto done;
@@ -525,6 +554,28 @@ done:
     return ret;
 }
 
+errno_t sysdb_getpwuid_with_views(TALLOC_CTX *mem_ctx,
+                                  struct sss_domain_info *domain,
+                                  uid_t uid,
+                                  struct ldb_result **res)
+{
+    return sysdb_getpwuid_attrs_with_views(mem_ctx, domain, uid, NULL, res);
+}
+
+int sysdb_get_user_attr_by_uid_with_views(TALLOC_CTX *mem_ctx,
+                                          struct sss_domain_info *domain,
+                                          uid_t uid,
+                                          const char **attributes,
+                                          struct ldb_result **res)
+{
+    if (attributes == NULL) {
+        return EINVAL;
+    }
+
+    return sysdb_getpwuid_attrs_with_views(mem_ctx, domain, uid,
+                                           attributes, res);
+}
+
 static char *enum_filter(TALLOC_CTX *mem_ctx,
                          const char *base_filter,
                          const char *name_filter,
@@ -1214,29 +1265,54 @@ done:
     return ret;
 }
 
-int sysdb_getgrgid_with_views(TALLOC_CTX *mem_ctx,
-                              struct sss_domain_info *domain,
-                              gid_t gid,
-                              struct ldb_result **res)
+static int sysdb_getgrgid_search(TALLOC_CTX *mem_ctx,
+                                 struct sss_domain_info *domain,
+                                 gid_t gid,
+                                 const char **attrs,
+                                 struct ldb_result **_res);
+
+/* If attributes is NULL all group attributes are returned, including the
+ * overridden names of the members */
+static int sysdb_getgrgid_attrs_with_views(TALLOC_CTX *mem_ctx,
+                                           struct sss_domain_info *domain,
+                                           gid_t gid,
+                                           const char **attributes,
+                                           struct ldb_result **res)
 {
     TALLOC_CTX *tmp_ctx;
     int ret;
     struct ldb_result *orig_obj = NULL;
     struct ldb_result *override_obj = NULL;
     struct ldb_message_element *el;
+    const char **attrs = NULL;
+    const char *mandatory_attrs[] = {SYSDB_OBJECTCATEGORY,
+                                     ORIGINALAD_PREFIX SYSDB_GIDNUM,
+                                     SYSDB_OVERRIDE_DN,
+                                     SYSDB_OVERRIDE_OBJECT_DN,
+                                     NULL};
 
     tmp_ctx = talloc_new(NULL);
     if (!tmp_ctx) {
         return ENOMEM;
     }
 
+    if (attributes != NULL) {
+        ret = add_strings_lists(tmp_ctx, attributes, mandatory_attrs,
+                                false, discard_const(&attrs));
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "add_strings_lists failed.\n");
+            goto done;
+        }
+    }
+
     /* If there are views we first have to search the overrides for matches */
     if (DOM_HAS_VIEWS(domain)) {
-        ret = sysdb_search_group_override_by_gid(tmp_ctx, domain, gid,
-                                                 &override_obj, &orig_obj);
+        ret = sysdb_search_group_override_attrs_by_gid(tmp_ctx, domain, gid,
+                                                       attrs, &override_obj,
+                                                       &orig_obj);
         if (ret != EOK && ret != ENOENT) {
             DEBUG(SSSDBG_OP_FAILURE,
-                  "sysdb_search_group_override_by_gid failed.\n");
+                  "sysdb_search_group_override_attrs_by_gid failed.\n");
             goto done;
         }
     }
@@ -1244,7 +1320,12 @@ int sysdb_getgrgid_with_views(TALLOC_CTX *mem_ctx,
     /* If there are no views or nothing was found in the overrides the
      * original objects are searched. */
     if (orig_obj == NULL) {
-        ret = sysdb_getgrgid(tmp_ctx, domain, gid, &orig_obj);
+        if (attrs == NULL) {
+            ret = sysdb_getgrgid(tmp_ctx, domain, gid, &orig_obj);
+        } else {
+            ret = sysdb_getgrgid_search(tmp_ctx, domain, gid, attrs,
+                                        &orig_obj);
+        }
         if (ret != EOK) {
             DEBUG(SSSDBG_OP_FAILURE, "sysdb_getgrgid failed.\n");
             goto done;
@@ -1269,7 +1350,7 @@ int sysdb_getgrgid_with_views(TALLOC_CTX *mem_ctx,
 
             ret = sysdb_add_overrides_to_object(domain, orig_obj->msgs[0],
                               override_obj == NULL ? NULL : override_obj ->msgs[0],
-                              NULL);
+                              attrs);
             if (ret != EOK) {
                 DEBUG(SSSDBG_OP_FAILURE, "sysdb_add_overrides_to_object failed.\n");
                 goto done;
@@ -1277,13 +1358,18 @@ int sysdb_getgrgid_with_views(TALLOC_CTX *mem_ctx,
         }
 
         /* Must be called even without views to check to
-         * SYSDB_DEFAULT_OVERRIDE_NAME */
-        ret = sysdb_add_group_member_overrides(domain, orig_obj->msgs[0],
-                                               DOM_HAS_VIEWS(domain));
-        if (ret != EOK) {
-            DEBUG(SSSDBG_OP_FAILURE,
-                  "sysdb_add_group_member_overrides failed.\n");
-            goto done;
+         * SYSDB_DEFAULT_OVERRIDE_NAME. Resolving the members is skipped if
+         * they were not requested. */
+        if (attrs == NULL
+                || string_in_list(SYSDB_MEMBERUID, discard_const(attrs),
+                                  false)) {
+            ret = sysdb_add_group_member_overrides(domain, orig_obj->msgs[0],
+                                                   DOM_HAS_VIEWS(domain));
+            if (ret != EOK) {
+                DEBUG(SSSDBG_OP_FAILURE,
+                      "sysdb_add_group_member_overrides failed.\n");
+                goto done;
+            }
         }
     }
 
@@ -1306,11 +1392,35 @@ done:
     return ret;
 }
 
-int sysdb_getgrgid_attrs(TALLOC_CTX *mem_ctx,
-                         struct sss_domain_info *domain,
-                         gid_t gid,
-                         const char **additional_attrs,
-                         struct ldb_result **_res)
+int sysdb_getgrgid_with_views(TALLOC_CTX *mem_ctx,
+                              struct sss_domain_info *domain,
+                              gid_t gid,
+                              struct ldb_result **res)
+{
+    return sysdb_getgrgid_attrs_with_views(mem_ctx, domain, gid, NULL, res);
+}
+
+int sysdb_get_group_attr_by_gid_with_views(TALLOC_CTX *mem_ctx,
+                                           struct sss_domain_info *domain,
+                                           gid_t gid,
+                                           const char **attributes,
+                                           struct ldb_result **res)
+{
+    if (attributes == NULL) {
+        return EINVAL;
+    }
+
+    return sysdb_getgrgid_attrs_with_views(mem_ctx, domain, gid,
+                                           attributes, res);
+}
+
+/* The attributes must contain SYSDB_OBJECTCATEGORY and the original gid
+ * number, which are needed to tell private groups and overrides apart. */
+static int sysdb_getgrgid_search(TALLOC_CTX *mem_ctx,
+                                 struct sss_domain_info *domain,
+                                 gid_t gid,
+                                 const char **attrs,
+                                 struct ldb_result **_res)
 {
     TALLOC_CTX *tmp_ctx;
     unsigned long int ul_gid = gid;
@@ -1319,25 +1429,12 @@ int sysdb_getgrgid_attrs(TALLOC_CTX *mem_ctx,
     struct ldb_dn *base_dn;
     struct ldb_result *res = NULL;
     int ret;
-    static const char *default_attrs[] = SYSDB_GRSRC_ATTRS;
-    const char **attrs = NULL;
 
     tmp_ctx = talloc_new(NULL);
     if (!tmp_ctx) {
         return ENOMEM;
     }
 
-    if (additional_attrs == NULL) {
-        attrs = default_attrs;
-    } else {
-        ret = add_strings_lists(tmp_ctx, additional_attrs, default_attrs,
-                                false, discard_const(&attrs));
-        if (ret != EOK) {
-            DEBUG(SSSDBG_OP_FAILURE, "add_strings_lists failed.\n");
-            goto done;
-        }
-    }
-
     if (sss_domain_is_mpg(domain)) {
         /* In case the domain supports magic private groups we *must*
          * check whether the searched gid is the very same as the
@@ -1410,6 +1507,41 @@ done:
     return ret;
 }
 
+int sysdb_getgrgid_attrs(TALLOC_CTX *mem_ctx,
+                         struct sss_domain_info *domain,
+                         gid_t gid,
+                         const char **additional_attrs,
+                         struct ldb_result **_res)
+{
+    TALLOC_CTX *tmp_ctx;
+    static const char *default_attrs[] = SYSDB_GRSRC_ATTRS;
+    const char **attrs = NULL;
+    int ret;
+
+    if (additional_attrs == NULL) {
+        return sysdb_getgrgid_search(mem_ctx, domain, gid, default_attrs,
+                                     _res);
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (!tmp_ctx) {
+        return ENOMEM;
+    }
+
+    ret = add_strings_lists(tmp_ctx, additional_attrs, default_attrs,
+                            false, discard_const(&attrs));
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "add_strings_lists failed.\n");
+        goto done;
+    }
+
+    ret = sysdb_getgrgid_search(mem_ctx, domain, gid, attrs, _res);
+
+done:
+    talloc_zfree(tmp_ctx);
+    return ret;
+}
+
 int sysdb_getgrgid(TALLOC_CTX *mem_ctx,
                    struct sss_domain_info *domain,
                    gid_t gid,
@@ -1595,6 +1727,172 @@ int sysdb_enumgrent_with_views(TALLOC_CTX *mem_ctx,
     return sysdb_enumgrent_filter_with_views(mem_ctx, domain, NULL, NULL, _res);
 }
 
+static int sysdb_enum_keys(TALLOC_CTX *mem_ctx,
+                           struct sss_domain_info *domain,
+                           struct ldb_dn *base_dn,
+                           const char *filter,
+                           struct ldb_result **_res)
+{
+    static const char *attrs[] = { SYSDB_NAME, NULL };
+    struct ldb_result *res;
+    int lret;
+
+    DEBUG(SSSDBG_TRACE_LIBS, "Searching cache with [%s]\n", filter);
+
+    lret = ldb_search(domain->sysdb->ldb, mem_ctx, &res, base_dn,
+                      LDB_SCOPE_SUBTREE, attrs, "%s", filter);
+    if (lret != LDB_SUCCESS) {
+        return sysdb_error_to_errno(lret);
+    }
+
+    *_res = res;
+    return EOK;
+}
+
+int sysdb_enumpwent_keys(TALLOC_CTX *mem_ctx,
+                         struct sss_domain_info *domain,
+                         struct ldb_result **_res)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_dn *base_dn;
+    struct ldb_result *res;
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    base_dn = sysdb_user_base_dn(tmp_ctx, domain);
+    if (base_dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_enum_keys(tmp_ctx, domain, base_dn, SYSDB_PWENT_FILTER, &res);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_res = talloc_steal(mem_ctx, res);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+int sysdb_enumgrent_keys(TALLOC_CTX *mem_ctx,
+                         struct sss_domain_info *domain,
+                         struct ldb_result **_res)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char *filter;
+    struct ldb_dn *base_dn;
+    struct ldb_result *res;
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    if (sss_domain_is_mpg(domain)) {
+        filter = SYSDB_GRENT_MPG_FILTER;
+        base_dn = sysdb_domain_dn(tmp_ctx, domain);
+    } else {
+        filter = SYSDB_GRENT_FILTER;
+        base_dn = sysdb_group_base_dn(tmp_ctx, domain);
+    }
+    if (base_dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_enum_keys(tmp_ctx, domain, base_dn, filter, &res);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_res = talloc_steal(mem_ctx, res);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+int sysdb_enum_entry_with_views(TALLOC_CTX *mem_ctx,
+                                struct sss_domain_info *domain,
+                                bool group,
+                                struct ldb_dn *dn,
+                                struct ldb_message **_msg)
+{
+    static const char *pw_attrs[] = SYSDB_PW_ATTRS;
+    static const char *gr_attrs[] = SYSDB_GRSRC_ATTRS;
+    const char **attrs = group ? gr_attrs : pw_attrs;
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_result *res;
+    int lret;
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    lret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, dn,
+                      LDB_SCOPE_BASE, attrs, NULL);
+    if (lret == LDB_ERR_NO_SUCH_OBJECT) {
+        ret = ENOENT;
+        goto done;
+    } else if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    if (res->count != 1) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    if (group) {
+        ret = mpg_res_convert(res);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = sysdb_merge_res_ts_attrs(domain->sysdb, res, attrs);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot merge timestamp cache values\n");
+        /* non-fatal */
+    }
+
+    if (DOM_HAS_VIEWS(domain)) {
+        ret = sysdb_add_overrides_to_object(domain, res->msgs[0], NULL, NULL);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "sysdb_add_overrides_to_object failed.\n");
+            goto done;
+        }
+    }
+
+    if (group) {
+        ret = sysdb_add_group_member_overrides(domain, res->msgs[0],
+                                               DOM_HAS_VIEWS(domain));
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "sysdb_add_group_member_overrides failed.\n");
+            goto done;
+        }
+    }
+
+    *_msg = talloc_steal(mem_ctx, res->msgs[0]);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 int sysdb_initgroups(TALLOC_CTX *mem_ctx,
                      struct sss_domain_info *domain,
                      const char *name,
@@ -1759,6 +2057,156 @@ done:
     return ret;
 }
 
+/* Resolving the nested memberships of a user and applying the overrides of
+ * each of the groups costs a search per group, yet the result only changes
+ * when the cache itself is modified. The groups of recently looked up users
+ * are kept in memory and reused as long as the sequence number of the cache,
+ * which ldb increments on every modification, stays the same. */
+#define SYSDB_INITGR_INDEX_MAX 1000
+
+struct sysdb_initgr_index {
+    hash_table_t *table;
+    uint64_t seq;
+};
+
+struct sysdb_initgr_groups {
+    unsigned int count;
+    struct ldb_message **msgs;
+};
+
+static struct sysdb_initgr_index *
+sysdb_initgr_index_get(struct sysdb_ctx *sysdb)
+{
+    struct sysdb_initgr_index *idx;
+    uint64_t seq;
+    int ret;
+
+    /* Changes made in an open transaction may still be rolled back and
+     * the sequence number along with them */
+    if (sysdb->transaction_nesting > 0) {
+        return NULL;
+    }
+
+    ret = ldb_sequence_number(sysdb->ldb, LDB_SEQ_HIGHEST_SEQ, &seq);
+    if (ret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to read sequence number [%d]: "
+              "%s\n", ret, ldb_errstring(sysdb->ldb));
+        return NULL;
+    }
+
+    idx = sysdb->initgr_index;
+    if (idx == NULL) {
+        idx = talloc_zero(sysdb, struct sysdb_initgr_index);
+        if (idx == NULL) {
+            return NULL;
+        }
+
+        idx->table = sss_ptr_hash_create(idx, NULL, NULL);
+        if (idx->table == NULL) {
+            talloc_free(idx);
+            return NULL;
+        }
+
+        idx->seq = seq;
+        sysdb->initgr_index = idx;
+    } else if (idx->seq != seq) {
+        /* The cache was modified, none of the entries can be trusted */
+        sss_ptr_hash_delete_all(idx->table, true);
+        idx->seq = seq;
+    }
+
+    return idx;
+}
+
+/* Appends the groups of the user to the result, which contains only the
+ * user entry. Returns ENOENT if they are not known. */
+static errno_t sysdb_initgr_index_lookup(struct sysdb_initgr_index *idx,
+                                         struct ldb_dn *user_dn,
+                                         struct ldb_result *res)
+{
+    struct sysdb_initgr_groups *groups;
+    struct ldb_message **msgs;
+    unsigned int i;
+
+    groups = sss_ptr_hash_lookup(idx->table,
+                                 ldb_dn_get_linearized(user_dn),
+                                 struct sysdb_initgr_groups);
+    if (groups == NULL) {
+        return ENOENT;
+    }
+
+    msgs = talloc_realloc(res, res->msgs, struct ldb_message *,
+                          res->count + groups->count + 1);
+    if (msgs == NULL) {
+        return ENOMEM;
+    }
+    res->msgs = msgs;
+
+    for (i = 0; i < groups->count; i++) {
+        msgs[res->count] = ldb_msg_copy(msgs, groups->msgs[i]);
+        if (msgs[res->count] == NULL) {
+            return ENOMEM;
+        }
+        res->count++;
+    }
+    msgs[res->count] = NULL;
+
+    return EOK;
+}
+
+/* Remembers the groups of the user, which are all entries of the result
+ * except the first one. */
+static void sysdb_initgr_index_store(struct sysdb_initgr_index *idx,
+                                     struct ldb_result *res)
+{
+    struct sysdb_initgr_groups *groups;
+    struct sysdb_initgr_groups *old;
+    const char *key;
+    unsigned int i;
+    errno_t ret;
+
+    if (hash_count(idx->table) >= SYSDB_INITGR_INDEX_MAX) {
+        sss_ptr_hash_delete_all(idx->table, true);
+    }
+
+    groups = talloc_zero(idx, struct sysdb_initgr_groups);
+    if (groups == NULL) {
+        return;
+    }
+
+    groups->msgs = talloc_zero_array(groups, struct ldb_message *,
+                                     res->count);
+    if (groups->msgs == NULL) {
+        goto fail;
+    }
+
+    for (i = 1; i < res->count; i++) {
+        groups->msgs[groups->count] = ldb_msg_copy(groups->msgs,
+                                                   res->msgs[i]);
+        if (groups->msgs[groups->count] == NULL) {
+            goto fail;
+        }
+        groups->count++;
+    }
+
+    key = ldb_dn_get_linearized(res->msgs[0]->dn);
+
+    /* Replace the previous copy */
+    old = sss_ptr_hash_lookup(idx->table, key, struct sysdb_initgr_groups);
+    talloc_free(old);
+
+    ret = sss_ptr_hash_add(idx->table, key, groups,
+                           struct sysdb_initgr_groups);
+    if (ret != EOK) {
+        goto fail;
+    }
+
+    return;
+
+fail:
+    talloc_free(groups);
+}
+
 int sysdb_initgroups_with_views(TALLOC_CTX *mem_ctx,
                                 struct sss_domain_info *domain,
                                 const char *name,
@@ -1770,6 +2218,7 @@ int sysdb_initgroups_with_views(TALLOC_CTX *mem_ctx,
     struct ldb_request *req;
     struct ldb_control **ctrl;
     struct ldb_asq_control *control;
+    struct sysdb_initgr_index *idx;
     static const char *attrs[] = SYSDB_INITGR_ATTRS;
     int ret;
     size_t c;
@@ -1779,6 +2228,10 @@ int sysdb_initgroups_with_views(TALLOC_CTX *mem_ctx,
         return ENOMEM;
     }
 
+    /* Read the sequence number before the search, a modification made in
+     * between only causes the groups to be resolved again next time */
+    idx = sysdb_initgr_index_get(domain->sysdb);
+
     ret = sysdb_getpwnam_with_views(tmp_ctx, domain, name, &res);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "sysdb_getpwnam failed: [%d][%s]\n",
@@ -1802,6 +2255,16 @@ int sysdb_initgroups_with_views(TALLOC_CTX *mem_ctx,
     /* no need to steal the dn, we are not freeing the result */
     user_dn = res->msgs[0]->dn;
 
+    if (idx != NULL) {
+        ret = sysdb_initgr_index_lookup(idx, user_dn, res);
+        if (ret == EOK) {
+            *_res = talloc_steal(mem_ctx, res);
+            goto done;
+        } else if (ret != ENOENT) {
+            goto done;
+        }
+    }
+
     /* note we count on the fact that the default search callback
      * will just keep appending values. This is by design and can't
      * change so it is ok to already have a result (from the getpwnam)
@@ -1866,6 +2329,10 @@ int sysdb_initgroups_with_views(TALLOC_CTX *mem_ctx,
         }
     }
 
+    if (idx != NULL) {
+        sysdb_initgr_index_store(idx, res);
+    }
+
     *_res = talloc_steal(mem_ctx, res);
 
 done:
@@ -2307,6 +2774,15 @@ errno_t sysdb_getnetgr(TALLOC_CTX *mem_ctx,
                    sanitized_netgroup, sanitized_netgroup,
                    netgroup_dn);
 
+    if (ret == EOK) {
+        ret = sysdb_merge_res_ts_attrs(domain->sysdb, result, attrs);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Cannot merge timestamp cache values\n");
+            /* non-fatal */
+            ret = EOK;
+        }
+    }
+
     if (ret == EOK || ret == ENOENT) {
         *res = talloc_steal(mem_ctx, result);
     }
@@ -2359,7 +2835,14 @@ int sysdb_get_netgroup_attr(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = sysdb_merge_res_ts_attrs(domain->sysdb, result, attributes);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot merge timestamp cache values\n");
+        /* non-fatal */
+    }
+
     *res = talloc_steal(mem_ctx, result);
+    ret = EOK;
 done:
     talloc_zfree(tmp_ctx);
     return ret;
@@ -2623,11 +3106,89 @@ done:
     return ret;
 }
 
+/* Below this size the entries are compared directly, it is cheaper than
+ * setting up the hash table */
+#define SSS_MERGE_LDB_HASH_MIN 16
+
+/* Returns a table of the indexes of the entries of res by their DN */
+static hash_table_t *sss_merge_ldb_index(struct ldb_result *res)
+{
+    hash_table_t *table;
+    hash_key_t key;
+    hash_value_t value;
+    size_t i;
+    int hret;
+    errno_t ret;
+
+    ret = sss_hash_create(NULL, res->count, &table);
+    if (ret != EOK) {
+        return NULL;
+    }
+
+    for (i = 0; i < res->count; i++) {
+        key.type = HASH_KEY_STRING;
+        key.str = discard_const(ldb_dn_get_casefold(res->msgs[i]->dn));
+        if (key.str == NULL) {
+            goto fail;
+        }
+
+        value.type = HASH_VALUE_ULONG;
+        value.ul = i;
+
+        hret = hash_enter(table, &key, &value);
+        if (hret != HASH_SUCCESS) {
+            goto fail;
+        }
+    }
+
+    return table;
+
+fail:
+    talloc_free(table);
+    return NULL;
+}
+
+static size_t sss_merge_ldb_find(hash_table_t *table,
+                                 struct ldb_result *res,
+                                 struct ldb_dn *dn)
+{
+    hash_key_t key;
+    hash_value_t value;
+    const char *casefold;
+    size_t i;
+    int hret;
+
+    if (table == NULL) {
+        for (i = 0; i < res->count; i++) {
+            if (ldb_dn_compare(dn, res->msgs[i]->dn) == 0) {
+                break;
+            }
+        }
+
+        return i;
+    }
+
+    casefold = ldb_dn_get_casefold(dn);
+    if (casefold == NULL) {
+        return res->count;
+    }
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(casefold);
+
+    hret = hash_lookup(table, &key, &value);
+    if (hret != HASH_SUCCESS) {
+        return res->count;
+    }
+
+    return value.ul;
+}
+
 struct ldb_result *sss_merge_ldb_results(struct ldb_result *sysdb_res,
                                          struct ldb_result *ts_res)
 {
+    hash_table_t *table = NULL;
     size_t i, ii, count, total;
-    int ret;
 
     if (ts_res == NULL || ts_res->count == 0) {
         return sysdb_res;
@@ -2641,19 +3202,25 @@ struct ldb_result *sss_merge_ldb_results(struct ldb_result *sysdb_res,
         return NULL;
     }
 
-    /* FIXME - this is O(2), so inefficient for large sets! */
+    /* Wildcard lookups and enumerations merge large results whose entries
+     * are mostly in both of them, look the DNs up in a hash table instead
+     * of comparing each pair */
+    if (sysdb_res->count >= SSS_MERGE_LDB_HASH_MIN) {
+        table = sss_merge_ldb_index(sysdb_res);
+        if (table == NULL) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot index the result, comparing all entries\n");
+        }
+    }
+
     count = sysdb_res->count;
     for (i = 0; i < ts_res->count; i++) {
-        for (ii = 0; ii < sysdb_res->count; ii++) {
-            ret = ldb_dn_compare(ts_res->msgs[i]->dn, sysdb_res->msgs[ii]->dn);
-            if (ret == 0) {
-                break;
-            }
-        }
+        ii = sss_merge_ldb_find(table, sysdb_res, ts_res->msgs[i]->dn);
 
         if (ii < sysdb_res->count) {
             /* We already have this DN but ts_res might be more up-to-date
-             * wrt timestamps  */
+             * wrt timestamps, the outdated entry is not needed anymore */
+            talloc_free(sysdb_res->msgs[ii]);
             sysdb_res->msgs[ii] = talloc_steal(sysdb_res, ts_res->msgs[i]);
             continue;
         }
@@ -2661,6 +3228,7 @@ struct ldb_result *sss_merge_ldb_results(struct ldb_result *sysdb_res,
         sysdb_res->msgs[count] = talloc_steal(sysdb_res, ts_res->msgs[i]);
         count++;
     }
+    talloc_free(table);
 
     if (count < total) {
         sysdb_res->msgs = talloc_realloc(sysdb_res, sysdb_res->msgs,
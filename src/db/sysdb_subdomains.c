@@ -589,6 +589,7 @@ errno_t sysdb_update_subdomains(struct sss_domain_info *domain,
     ret = EOK;
 
 done:
+    sss_domain_index_invalidate();
     talloc_free(tmp_ctx);
     return ret;
 }
@@ -802,6 +803,7 @@ errno_t sysdb_master_domain_update(struct sss_domain_info *domain)
     ret = EOK;
 
 done:
+    sss_domain_index_invalidate();
     talloc_free(tmp_ctx);
     return ret;
 }
@@ -319,12 +319,13 @@ sysdb_sudo_filter_expired(TALLOC_CTX *mem_ctx,
 
     now = time(NULL);
     filter = talloc_asprintf(mem_ctx,
-                             "(&(%s=%s)(%s<=%lld)(|(%s=defaults)%s(%s=+*)))",
+                             "(&(%s=%s)(%s<=%lld)(|(%s=defaults)%s(%s=%s)))",
                              SYSDB_OBJECTCLASS, SYSDB_SUDO_CACHE_OC,
                              SYSDB_CACHE_EXPIRE, (long long)now,
                              SYSDB_NAME,
                              userfilter,
-                             SYSDB_SUDO_CACHE_AT_USER);
+                             SYSDB_SUDO_CACHE_AT_USER_INDEX,
+                             SYSDB_SUDO_USER_INDEX_NETGROUP);
     talloc_free(userfilter);
 
     return filter;
@@ -374,9 +375,10 @@ sysdb_sudo_filter_netgroups(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    filter = talloc_asprintf(mem_ctx, "(&(%s=%s)(%s=+*)(!(|%s)))",
+    filter = talloc_asprintf(mem_ctx, "(&(%s=%s)(%s=%s)(!(|%s)))",
                              SYSDB_OBJECTCLASS, SYSDB_SUDO_CACHE_OC,
-                             SYSDB_SUDO_CACHE_AT_USER,
+                             SYSDB_SUDO_CACHE_AT_USER_INDEX,
+                             SYSDB_SUDO_USER_INDEX_NETGROUP,
                              userfilter);
     talloc_free(userfilter);
 
@@ -744,12 +746,58 @@ sysdb_sudo_purge_byname(struct sss_domain_info *domain,
     return sysdb_delete_custom(domain, name, SUDORULE_SUBDIR);
 }
 
+/* Returns a table of the names of the rules */
+static errno_t
+sysdb_sudo_rule_names(TALLOC_CTX *mem_ctx,
+                      struct sysdb_attrs **rules,
+                      size_t num_rules,
+                      hash_table_t **_names)
+{
+    hash_table_t *names;
+    hash_key_t key;
+    hash_value_t value;
+    const char *name;
+    errno_t ret;
+    size_t i;
+    int hret;
+
+    ret = sss_hash_create(mem_ctx, num_rules, &names);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    key.type = HASH_KEY_STRING;
+    value.type = HASH_VALUE_ULONG;
+    value.ul = 0;
+
+    for (i = 0; i < num_rules; i++) {
+        name = sysdb_sudo_get_rule_name(rules[i]);
+        if (name == NULL) {
+            continue;
+        }
+
+        key.str = discard_const(name);
+        hret = hash_enter(names, &key, &value);
+        if (hret != HASH_SUCCESS) {
+            talloc_free(names);
+            return EIO;
+        }
+    }
+
+    *_names = names;
+    return EOK;
+}
+
+/* The rules whose names are in the keep table are not removed, they are
+ * replaced later if they changed. */
 static errno_t
 sysdb_sudo_purge_byrules(struct sss_domain_info *dom,
                          struct sysdb_attrs **rules,
-                         size_t num_rules)
+                         size_t num_rules,
+                         hash_table_t *keep)
 {
     const char *name;
+    hash_key_t key;
     errno_t ret;
     size_t i;
 
@@ -759,12 +807,21 @@ sysdb_sudo_purge_byrules(struct sss_domain_info *dom,
         return EOK;
     }
 
+    key.type = HASH_KEY_STRING;
+
     for (i = 0; i < num_rules; i++) {
         name = sysdb_sudo_get_rule_name(rules[i]);
         if (name == NULL) {
             continue;
         }
 
+        if (keep != NULL) {
+            key.str = discard_const(name);
+            if (hash_has_key(keep, &key)) {
+                continue;
+            }
+        }
+
         ret = sysdb_sudo_purge_byname(dom, name);
         if (ret != EOK) {
             DEBUG(SSSDBG_MINOR_FAILURE, "Failed to delete rule "
@@ -778,11 +835,14 @@ sysdb_sudo_purge_byrules(struct sss_domain_info *dom,
 
 static errno_t
 sysdb_sudo_purge_byfilter(struct sss_domain_info *domain,
-                          const char *filter)
+                          const char *filter,
+                          struct sysdb_attrs **new_rules,
+                          size_t num_new_rules)
 {
     TALLOC_CTX *tmp_ctx;
     struct sysdb_attrs **rules;
     struct ldb_message **msgs;
+    hash_table_t *keep = NULL;
     size_t count;
     errno_t ret;
     const char *attrs[] = { SYSDB_OBJECTCLASS,
@@ -790,7 +850,11 @@ sysdb_sudo_purge_byfilter(struct sss_domain_info *domain,
                             SYSDB_SUDO_CACHE_AT_CN,
                             NULL };
 
-    if (filter == NULL || strcmp(filter, SUDO_ALL_FILTER) == 0) {
+    if (filter == NULL) {
+        filter = SUDO_ALL_FILTER;
+    }
+
+    if (num_new_rules == 0 && strcmp(filter, SUDO_ALL_FILTER) == 0) {
         return sysdb_sudo_purge_all(domain);
     }
 
@@ -800,6 +864,15 @@ sysdb_sudo_purge_byfilter(struct sss_domain_info *domain,
         goto done;
     }
 
+    /* Keep the rules that are stored again so that the unchanged ones
+     * do not have to be written again */
+    if (num_new_rules > 0) {
+        ret = sysdb_sudo_rule_names(tmp_ctx, new_rules, num_new_rules, &keep);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
     ret = sysdb_search_custom(tmp_ctx, domain, filter,
                               SUDORULE_SUBDIR, attrs,
                               &count, &msgs);
@@ -819,7 +892,7 @@ sysdb_sudo_purge_byfilter(struct sss_domain_info *domain,
         goto done;
     }
 
-    ret = sysdb_sudo_purge_byrules(domain, rules, count);
+    ret = sysdb_sudo_purge_byrules(domain, rules, count, keep);
 
 done:
     talloc_free(tmp_ctx);
@@ -843,9 +916,10 @@ errno_t sysdb_sudo_purge(struct sss_domain_info *domain,
     in_transaction = true;
 
     if (delete_filter) {
-        ret = sysdb_sudo_purge_byfilter(domain, delete_filter);
+        ret = sysdb_sudo_purge_byfilter(domain, delete_filter,
+                                        rules, num_rules);
     } else {
-        ret = sysdb_sudo_purge_byrules(domain, rules, num_rules);
+        ret = sysdb_sudo_purge_byrules(domain, rules, num_rules, NULL);
     }
 
     if (ret != EOK) {
@@ -875,6 +949,31 @@ done:
     return ret;
 }
 
+static errno_t
+sysdb_sudo_add_user_index(struct sysdb_attrs *rule)
+{
+    struct ldb_message_element *el;
+    unsigned int i;
+    errno_t ret;
+
+    ret = sysdb_attrs_get_el_ext(rule, SYSDB_SUDO_CACHE_AT_USER, false, &el);
+    if (ret == ENOENT) {
+        return EOK;
+    } else if (ret != EOK) {
+        return ret;
+    }
+
+    for (i = 0; i < el->num_values; i++) {
+        if (el->values[i].length > 0 && el->values[i].data[0] == '+') {
+            return sysdb_attrs_add_string_safe(rule,
+                                              SYSDB_SUDO_CACHE_AT_USER_INDEX,
+                                              SYSDB_SUDO_USER_INDEX_NETGROUP);
+        }
+    }
+
+    return EOK;
+}
+
 static errno_t
 sysdb_sudo_add_sss_attrs(struct sysdb_attrs *rule,
                          const char *name,
@@ -906,6 +1005,13 @@ sysdb_sudo_add_sss_attrs(struct sysdb_attrs *rule,
         return ret;
     }
 
+    ret = sysdb_sudo_add_user_index(rule);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to add %s attribute [%d]: %s\n",
+              SYSDB_SUDO_CACHE_AT_USER_INDEX, ret, strerror(ret));
+        return ret;
+    }
+
     return EOK;
 }
 
@@ -962,13 +1068,94 @@ done:
     return ret;
 }
 
+/* Compares the cached rule with the downloaded one, ignoring the attributes
+ * that are kept in the timestamp cache. */
+static bool sysdb_sudo_rule_differs(struct ldb_message *cached,
+                                    struct sysdb_attrs *rule)
+{
+    struct ldb_message_element *cached_el;
+    struct ldb_message_element *el;
+    unsigned int i;
+    errno_t ret;
+
+    for (i = 0; i < rule->num; i++) {
+        el = &rule->a[i];
+        if (is_ts_cache_attr(el->name)) {
+            continue;
+        }
+
+        cached_el = ldb_msg_find_element(cached, el->name);
+        if (cached_el == NULL) {
+            if (el->num_values > 0) {
+                return true;
+            }
+            continue;
+        }
+
+        if (ldb_msg_element_compare(cached_el, el) != 0) {
+            return true;
+        }
+    }
+
+    for (i = 0; i < cached->num_elements; i++) {
+        if (is_ts_cache_attr(cached->elements[i].name)) {
+            continue;
+        }
+
+        ret = sysdb_attrs_get_el_ext(rule, cached->elements[i].name,
+                                     false, &el);
+        if (ret != EOK) {
+            /* The attribute was removed from the rule */
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static errno_t sysdb_sudo_rule_unchanged(struct sss_domain_info *domain,
+                                         const char *name,
+                                         struct sysdb_attrs *rule,
+                                         bool *_unchanged)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char *attrs[] = { "*", NULL };
+    struct ldb_message **msgs;
+    size_t count;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_search_custom_by_name(tmp_ctx, domain, name, SUDORULE_SUBDIR,
+                                      attrs, &count, &msgs);
+    if (ret == ENOENT) {
+        *_unchanged = false;
+        ret = EOK;
+        goto done;
+    } else if (ret != EOK) {
+        goto done;
+    }
+
+    *_unchanged = (count == 1 && !sysdb_sudo_rule_differs(msgs[0], rule));
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 static errno_t
 sysdb_sudo_store_rule(struct sss_domain_info *domain,
                       struct sysdb_attrs *rule,
                       int cache_timeout,
                       time_t now)
 {
+    struct sysdb_attrs *ts_attrs;
     const char *name;
+    bool unchanged;
     errno_t ret;
 
     name = sysdb_sudo_get_rule_name(rule);
@@ -988,18 +1175,45 @@ sysdb_sudo_store_rule(struct sss_domain_info *domain,
         return ret;
     }
 
-    /* Always delete the old rule and add a new one */
-    ret = sysdb_delete_custom(domain, name, SUDORULE_SUBDIR);
+    ret = sysdb_sudo_rule_unchanged(domain, name, rule, &unchanged);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "Unable to delete the old rule %s [%d]: %s\n",
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to look up the old rule %s [%d]: %s\n",
               name, ret, strerror(ret));
         return ret;
     }
 
-    ret = sysdb_store_custom(domain, name, SUDORULE_SUBDIR, rule);
+    if (!unchanged) {
+        /* Delete the old rule and add a new one */
+        ret = sysdb_delete_custom(domain, name, SUDORULE_SUBDIR);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Unable to delete the old rule %s [%d]: %s\n",
+                  name, ret, strerror(ret));
+            return ret;
+        }
+
+        ret = sysdb_store_custom(domain, name, SUDORULE_SUBDIR, rule);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to store rule %s [%d]: %s\n",
+                  name, ret, strerror(ret));
+            return ret;
+        }
+    } else {
+        DEBUG(SSSDBG_TRACE_FUNC, "Rule %s did not change\n", name);
+    }
+
+    /* The timestamps of an unchanged rule are only updated in the
+     * timestamp cache */
+    ts_attrs = sysdb_filter_ts_attrs(NULL, rule);
+    if (ts_attrs == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_set_sudo_rule_attr(domain, name, ts_attrs, SYSDB_MOD_REP);
+    talloc_free(ts_attrs);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "Unable to store rule %s [%d]: %s\n",
-              name, ret, strerror(ret));
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to store timestamps of rule %s "
+              "[%d]: %s\n", name, ret, strerror(ret));
         return ret;
     }
 
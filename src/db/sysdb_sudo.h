@@ -46,6 +46,12 @@
 #define SYSDB_SUDO_CACHE_AT_NOTAFTER   "sudoNotAfter"
 #define SYSDB_SUDO_CACHE_AT_ORDER      "sudoOrder"
 
+/* Indexed keys added when a rule is stored, so that the rules of a user can
+ * be found with equality lookups only. Rules applying to netgroups, where
+ * sudoUser starts with '+', get SYSDB_SUDO_USER_INDEX_NETGROUP. */
+#define SYSDB_SUDO_CACHE_AT_USER_INDEX "sudoUserIndex"
+#define SYSDB_SUDO_USER_INDEX_NETGROUP "netgroup"
+
 /* sysdb ipa attributes */
 #define SYSDB_IPA_SUDORULE_OC                 "ipasudorule"
 #define SYSDB_IPA_SUDORULE_ENABLED            "ipaEnabledFlag"
@@ -27,6 +27,7 @@
 #include "db/sysdb_autofs.h"
 #include "db/sysdb_iphosts.h"
 #include "db/sysdb_ipnetworks.h"
+#include "db/sysdb_sudo.h"
 
 struct upgrade_ctx {
     struct ldb_context *ldb;
@@ -2667,6 +2668,289 @@ done:
     return ret;
 }
 
+int sysdb_upgrade_22(struct sysdb_ctx *sysdb, const char **ver)
+{
+    TALLOC_CTX *tmp_ctx;
+    int ret;
+    struct ldb_message *msg;
+    struct ldb_result *res;
+    struct ldb_dn *basedn;
+    struct upgrade_ctx *ctx;
+    const char *attrs[] = { SYSDB_NAME, NULL };
+    size_t c;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = commence_upgrade(sysdb, sysdb->ldb, SYSDB_VERSION_0_23, &ctx);
+    if (ret) {
+        return ret;
+    }
+
+    /* Add Index for sudoUserIndex */
+    msg = ldb_msg_new(tmp_ctx);
+    if (msg == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    msg->dn = ldb_dn_new(tmp_ctx, sysdb->ldb, "@INDEXLIST");
+    if (msg->dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_msg_add_empty(msg, "@IDXATTR", LDB_FLAG_MOD_ADD, NULL);
+    if (ret != LDB_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_msg_add_string(msg, "@IDXATTR", SYSDB_SUDO_CACHE_AT_USER_INDEX);
+    if (ret != LDB_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_modify(sysdb->ldb, msg);
+    if (ret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(ret);
+        goto done;
+    }
+
+    talloc_zfree(msg);
+
+    /* Add the index key to the cached rules of all domains which apply to
+     * netgroups */
+    basedn = ldb_dn_new(tmp_ctx, sysdb->ldb, SYSDB_BASE);
+    if (basedn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_search(sysdb->ldb, tmp_ctx, &res, basedn, LDB_SCOPE_SUBTREE,
+                     attrs, "(&(%s=%s)(%s=+*))", SYSDB_OBJECTCLASS,
+                     SYSDB_SUDO_CACHE_OC, SYSDB_SUDO_CACHE_AT_USER);
+    if (ret != LDB_SUCCESS) {
+        ret = EIO;
+        goto done;
+    }
+
+    for (c = 0; c < res->count; c++) {
+        msg = ldb_msg_new(tmp_ctx);
+        if (msg == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        msg->dn = res->msgs[c]->dn;
+
+        ret = ldb_msg_add_empty(msg, SYSDB_SUDO_CACHE_AT_USER_INDEX,
+                                LDB_FLAG_MOD_ADD, NULL);
+        if (ret != LDB_SUCCESS) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = ldb_msg_add_string(msg, SYSDB_SUDO_CACHE_AT_USER_INDEX,
+                                 SYSDB_SUDO_USER_INDEX_NETGROUP);
+        if (ret != LDB_SUCCESS) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = ldb_modify(sysdb->ldb, msg);
+        if (ret != LDB_SUCCESS) {
+            ret = sysdb_error_to_errno(ret);
+            goto done;
+        }
+        talloc_zfree(msg);
+    }
+
+    /* conversion done, update version number */
+    ret = update_version(ctx);
+
+done:
+    ret = finish_upgrade(ret, &ctx, ver);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+int sysdb_upgrade_23(struct sysdb_ctx *sysdb, const char **ver)
+{
+    struct upgrade_ctx *ctx;
+    struct ldb_message *msg;
+    errno_t ret;
+
+    ret = commence_upgrade(sysdb, sysdb->ldb, SYSDB_VERSION_0_24, &ctx);
+    if (ret) {
+        return ret;
+    }
+
+    /* Add Index for automountKey */
+    msg = ldb_msg_new(ctx);
+    if (msg == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    msg->dn = ldb_dn_new(msg, sysdb->ldb, "@INDEXLIST");
+    if (msg->dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_msg_add_empty(msg, "@IDXATTR", LDB_FLAG_MOD_ADD, NULL);
+    if (ret != LDB_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_msg_add_string(msg, "@IDXATTR", SYSDB_AUTOFS_ENTRY_KEY);
+    if (ret != LDB_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_modify(sysdb->ldb, msg);
+    if (ret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(ret);
+        goto done;
+    }
+
+    /* conversion done, update version number */
+    ret = update_version(ctx);
+
+done:
+    ret = finish_upgrade(ret, &ctx, ver);
+    return ret;
+}
+
+int sysdb_upgrade_24(struct sysdb_ctx *sysdb, const char **ver)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct upgrade_ctx *ctx;
+    struct ldb_message *msg;
+    struct ldb_message_element *el;
+    struct ldb_result *res;
+    struct ldb_dn *basedn;
+    const char *attrs[] = { SYSDB_USER_MAPPED_CERT, NULL };
+    char *hash;
+    size_t c;
+    unsigned int i;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = commence_upgrade(sysdb, sysdb->ldb, SYSDB_VERSION_0_25, &ctx);
+    if (ret) {
+        talloc_free(tmp_ctx);
+        return ret;
+    }
+
+    /* Add Index for userMappedCertificateHash */
+    msg = ldb_msg_new(tmp_ctx);
+    if (msg == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    msg->dn = ldb_dn_new(msg, sysdb->ldb, "@INDEXLIST");
+    if (msg->dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_msg_add_empty(msg, "@IDXATTR", LDB_FLAG_MOD_ADD, NULL);
+    if (ret != LDB_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_msg_add_string(msg, "@IDXATTR", SYSDB_USER_MAPPED_CERT_HASH);
+    if (ret != LDB_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_modify(sysdb->ldb, msg);
+    if (ret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(ret);
+        goto done;
+    }
+
+    talloc_zfree(msg);
+
+    /* Add the hashes of the certificates which are already cached, the
+     * lookups by certificate only search for them */
+    basedn = ldb_dn_new(tmp_ctx, sysdb->ldb, SYSDB_BASE);
+    if (basedn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_search(sysdb->ldb, tmp_ctx, &res, basedn, LDB_SCOPE_SUBTREE,
+                     attrs, "(%s=*)", SYSDB_USER_MAPPED_CERT);
+    if (ret != LDB_SUCCESS) {
+        ret = EIO;
+        goto done;
+    }
+
+    for (c = 0; c < res->count; c++) {
+        el = ldb_msg_find_element(res->msgs[c], SYSDB_USER_MAPPED_CERT);
+        if (el == NULL || el->num_values == 0) {
+            continue;
+        }
+
+        msg = ldb_msg_new(tmp_ctx);
+        if (msg == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        msg->dn = res->msgs[c]->dn;
+
+        ret = ldb_msg_add_empty(msg, SYSDB_USER_MAPPED_CERT_HASH,
+                                LDB_FLAG_MOD_REPLACE, NULL);
+        if (ret != LDB_SUCCESS) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        for (i = 0; i < el->num_values; i++) {
+            ret = sysdb_cert_hash(msg, el->values[i].data,
+                                  el->values[i].length, &hash);
+            if (ret != EOK) {
+                goto done;
+            }
+
+            ret = ldb_msg_add_string(msg, SYSDB_USER_MAPPED_CERT_HASH, hash);
+            if (ret != LDB_SUCCESS) {
+                ret = ENOMEM;
+                goto done;
+            }
+        }
+
+        ret = ldb_modify(sysdb->ldb, msg);
+        if (ret != LDB_SUCCESS) {
+            ret = sysdb_error_to_errno(ret);
+            goto done;
+        }
+        talloc_zfree(msg);
+    }
+
+    /* conversion done, update version number */
+    ret = update_version(ctx);
+
+done:
+    ret = finish_upgrade(ret, &ctx, ver);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 int sysdb_ts_upgrade_01(struct sysdb_ctx *sysdb, const char **ver)
 {
     struct upgrade_ctx *ctx;
@@ -2712,6 +2996,184 @@ done:
     return ret;
 }
 
+/* Copies all records of the cache in ldb_file to a database of the other
+ * backend and replaces the file with it. The records are copied as they
+ * are, without the modules of the sysdb, so that the memberOf attributes
+ * are preserved. A backup of the original file is kept. */
+int sysdb_upgrade_backend(const char *ldb_file, bool to_lmdb)
+{
+    TALLOC_CTX *tmp_ctx;
+    static const char *special_dns[] = { "@ATTRIBUTES", "@INDEXLIST",
+                                         "@MODULES", NULL };
+    struct ldb_context *src_ldb;
+    struct ldb_context *dst_ldb;
+    struct ldb_result *res;
+    struct ldb_dn *dn;
+    const char *src_url;
+    const char *dst_url;
+    char *tmp_file = NULL;
+    char *lock_file;
+    bool in_transaction = false;
+    unsigned int i;
+    int lret;
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    tmp_file = talloc_asprintf(tmp_ctx, "%s.migrate", ldb_file);
+    if (tmp_file == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    src_url = talloc_asprintf(tmp_ctx, "%s%s", to_lmdb ? "tdb://" : "mdb://",
+                              ldb_file);
+    dst_url = talloc_asprintf(tmp_ctx, "%s%s", to_lmdb ? "mdb://" : "tdb://",
+                              tmp_file);
+    if (src_url == NULL || dst_url == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_IMPORTANT_INFO, "Converting %s to %s\n", src_url, dst_url);
+
+    /* Remove leftovers of an interrupted conversion */
+    ret = sysdb_remove_db_file(tmp_file);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_ldb_connect(tmp_ctx, src_url, 0, &src_ldb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to open %s\n", src_url);
+        goto done;
+    }
+
+    ret = sysdb_ldb_connect(tmp_ctx, dst_url, LDB_FLG_NOSYNC, &dst_ldb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create %s, is ldb built with "
+              "support for this backend?\n", dst_url);
+        goto done;
+    }
+
+    lret = ldb_transaction_start(dst_ldb);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+    in_transaction = true;
+
+    /* The special records go first so that the new records are indexed */
+    for (i = 0; special_dns[i] != NULL; i++) {
+        dn = ldb_dn_new(tmp_ctx, src_ldb, special_dns[i]);
+        if (dn == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        lret = ldb_search(src_ldb, tmp_ctx, &res, dn, LDB_SCOPE_BASE,
+                          NULL, NULL);
+        if (lret != LDB_SUCCESS) {
+            ret = sysdb_error_to_errno(lret);
+            goto done;
+        }
+
+        if (res->count == 1) {
+            lret = ldb_add(dst_ldb, res->msgs[0]);
+            if (lret != LDB_SUCCESS) {
+                DEBUG(SSSDBG_CRIT_FAILURE, "Unable to copy %s [%d]: %s\n",
+                      special_dns[i], lret, ldb_errstring(dst_ldb));
+                ret = sysdb_error_to_errno(lret);
+                goto done;
+            }
+        }
+
+        talloc_free(res);
+    }
+
+    lret = ldb_search(src_ldb, tmp_ctx, &res, NULL, LDB_SCOPE_SUBTREE,
+                      NULL, "(dn=*)");
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    for (i = 0; i < res->count; i++) {
+        if (ldb_dn_is_special(res->msgs[i]->dn)) {
+            continue;
+        }
+
+        lret = ldb_add(dst_ldb, res->msgs[i]);
+        if (lret != LDB_SUCCESS) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to copy %s [%d]: %s\n",
+                  ldb_dn_get_linearized(res->msgs[i]->dn),
+                  lret, ldb_errstring(dst_ldb));
+            ret = sysdb_error_to_errno(lret);
+            goto done;
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Copied %u records\n", res->count);
+
+    lret = ldb_transaction_commit(dst_ldb);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+    in_transaction = false;
+
+    talloc_zfree(src_ldb);
+    talloc_zfree(dst_ldb);
+
+    ret = backup_file(ldb_file, SSSDBG_CRIT_FAILURE);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = rename(tmp_file, ldb_file);
+    if (ret != 0) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to rename %s to %s [%d]: %s\n",
+              tmp_file, ldb_file, ret, sss_strerror(ret));
+        goto done;
+    }
+
+    /* The lock files of LMDB are created again when the database is
+     * opened */
+    lock_file = talloc_asprintf(tmp_ctx, "%s-lock", to_lmdb ? tmp_file
+                                                            : ldb_file);
+    if (lock_file == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = unlink(lock_file);
+    if (ret != 0 && errno != ENOENT) {
+        ret = errno;
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to remove %s [%d]: %s\n",
+              lock_file, ret, sss_strerror(ret));
+    }
+
+    ret = EOK;
+
+done:
+    if (in_transaction) {
+        ldb_transaction_cancel(dst_ldb);
+    }
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to convert %s [%d]: %s\n",
+              ldb_file, ret, sss_strerror(ret));
+        if (tmp_file != NULL) {
+            sysdb_remove_db_file(tmp_file);
+        }
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 /*
  * Example template for future upgrades.
  * Copy and change version numbers as appropriate.
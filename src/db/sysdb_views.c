@@ -279,6 +279,142 @@ done:
     return ret;
 }
 
+/* Override attributes added to the original object with OVERRIDE_PREFIX */
+static const struct override_attr_map {
+    const char *attr;
+    const char *new_attr;
+} override_attr_map[] = {
+    {SYSDB_UIDNUM, OVERRIDE_PREFIX SYSDB_UIDNUM},
+    {SYSDB_GIDNUM, OVERRIDE_PREFIX SYSDB_GIDNUM},
+    {SYSDB_GECOS, OVERRIDE_PREFIX SYSDB_GECOS},
+    {SYSDB_HOMEDIR, OVERRIDE_PREFIX SYSDB_HOMEDIR},
+    {SYSDB_SHELL, OVERRIDE_PREFIX SYSDB_SHELL},
+    {SYSDB_NAME, OVERRIDE_PREFIX SYSDB_NAME},
+    {SYSDB_SSH_PUBKEY, OVERRIDE_PREFIX SYSDB_SSH_PUBKEY},
+    {SYSDB_USER_CERT, OVERRIDE_PREFIX SYSDB_USER_CERT},
+    {NULL, NULL}
+};
+
+/* Replaces the override values kept with the original object by the ones of
+ * attrs, so that sysdb_add_overrides_to_object() does not have to read the
+ * override object again. If attrs is NULL the values are removed. */
+static errno_t add_merged_override(struct ldb_message *msg,
+                                   struct sysdb_attrs *attrs,
+                                   const char *override_dn_str)
+{
+    struct ldb_message_element *el;
+    size_t c;
+    size_t d;
+    int ret;
+
+    for (c = 0; override_attr_map[c].attr != NULL; c++) {
+        ret = ldb_msg_add_empty(msg, override_attr_map[c].new_attr,
+                                LDB_FLAG_MOD_REPLACE, NULL);
+        if (ret != LDB_SUCCESS) {
+            return sysdb_error_to_errno(ret);
+        }
+
+        if (attrs == NULL) {
+            continue;
+        }
+
+        ret = sysdb_attrs_get_el_ext(attrs, override_attr_map[c].attr, false,
+                                     &el);
+        if (ret == ENOENT) {
+            continue;
+        } else if (ret != EOK) {
+            return ret;
+        }
+
+        for (d = 0; d < el->num_values; d++) {
+            ret = ldb_msg_add_value(msg, override_attr_map[c].new_attr,
+                                    &el->values[d], NULL);
+            if (ret != LDB_SUCCESS) {
+                return sysdb_error_to_errno(ret);
+            }
+        }
+    }
+
+    ret = ldb_msg_add_empty(msg, SYSDB_MERGED_OVERRIDE_DN,
+                            LDB_FLAG_MOD_REPLACE, NULL);
+    if (ret != LDB_SUCCESS) {
+        return sysdb_error_to_errno(ret);
+    }
+
+    if (attrs != NULL) {
+        ret = ldb_msg_add_string(msg, SYSDB_MERGED_OVERRIDE_DN,
+                                 override_dn_str);
+        if (ret != LDB_SUCCESS) {
+            return sysdb_error_to_errno(ret);
+        }
+    }
+
+    return EOK;
+}
+
+/* Checks if obj already has the values add_merged_override() would store */
+static bool merged_override_is_current(struct ldb_message *obj,
+                                       struct sysdb_attrs *attrs,
+                                       const char *override_dn_str)
+{
+    struct ldb_message_element *old_el;
+    struct ldb_message_element *el;
+    const char *merged_dn_str;
+    size_t c;
+    size_t d;
+    int ret;
+
+    merged_dn_str = ldb_msg_find_attr_as_string(obj, SYSDB_MERGED_OVERRIDE_DN,
+                                                NULL);
+    if (attrs == NULL) {
+        if (merged_dn_str != NULL) {
+            return false;
+        }
+    } else if (merged_dn_str == NULL
+                || strcmp(merged_dn_str, override_dn_str) != 0) {
+        return false;
+    }
+
+    for (c = 0; override_attr_map[c].attr != NULL; c++) {
+        old_el = ldb_msg_find_element(obj, override_attr_map[c].new_attr);
+
+        el = NULL;
+        if (attrs != NULL) {
+            ret = sysdb_attrs_get_el_ext(attrs, override_attr_map[c].attr,
+                                         false, &el);
+            if (ret != EOK) {
+                el = NULL;
+            }
+        }
+
+        if (old_el == NULL || el == NULL) {
+            if ((old_el != NULL && old_el->num_values != 0)
+                    || (el != NULL && el->num_values != 0)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (old_el->num_values != el->num_values) {
+            return false;
+        }
+
+        for (d = 0; d < el->num_values; d++) {
+            if (ldb_val_equal_exact(&old_el->values[d],
+                                    &el->values[d]) == 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+errno_t sysdb_clear_merged_override(struct ldb_message *msg)
+{
+    return add_merged_override(msg, NULL, NULL);
+}
+
 static errno_t invalidate_entry_override(struct sysdb_ctx *sysdb,
                                          struct ldb_dn *dn,
                                          struct ldb_message *msg_del,
@@ -306,6 +442,7 @@ static errno_t invalidate_entry_override(struct sysdb_ctx *sysdb,
     }
 
     if (sysdb->ldb_ts != NULL) {
+        sysdb_ts_buffer_forget(sysdb, msg_repl->dn);
         ret = ldb_modify(sysdb->ldb_ts, msg_repl);
         if (ret != LDB_SUCCESS && ret != LDB_ERR_NO_SUCH_ATTRIBUTE) {
             DEBUG(SSSDBG_OP_FAILURE,
@@ -384,6 +521,12 @@ errno_t sysdb_invalidate_overrides(struct sysdb_ctx *sysdb)
         goto done;
     }
 
+    ret = sysdb_clear_merged_override(msg_repl);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "sysdb_clear_merged_override failed.\n");
+        goto done;
+    }
+
     ret = sysdb_transaction_start(sysdb);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "sysdb_transaction_start failed.\n");
@@ -499,6 +642,7 @@ errno_t sysdb_store_override(struct sss_domain_info *domain,
     const char *obj_dn_str;
     const char *obj_attrs[] = { SYSDB_OBJECTCLASS,
                                 SYSDB_OVERRIDE_DN,
+                                SYSDB_MERGED_OVERRIDE_ATTRS,
                                 NULL};
     size_t count = 0;
     struct ldb_message **msgs;
@@ -508,6 +652,7 @@ errno_t sysdb_store_override(struct sss_domain_info *domain,
     size_t c;
     bool in_transaction = false;
     bool has_override = true;
+    bool merge = true;
     const char *name_override;
 
     tmp_ctx = talloc_new(NULL);
@@ -693,7 +838,12 @@ errno_t sysdb_store_override(struct sss_domain_info *domain,
         }
     }
 
-    if (add_ref) {
+    /* The override values are kept with the original object as well, so
+     * that lookups do not have to read the override object. */
+    merge = !merged_override_is_current(msgs[0], has_override ? attrs : NULL,
+                                        override_dn_str);
+
+    if (add_ref || merge) {
         talloc_free(msg);
         msg = ldb_msg_new(tmp_ctx);
         if (msg == NULL) {
@@ -702,7 +852,9 @@ errno_t sysdb_store_override(struct sss_domain_info *domain,
         }
 
         msg->dn = obj_dn;
+    }
 
+    if (add_ref) {
         ret = ldb_msg_add_empty(msg, SYSDB_OVERRIDE_DN,
                                 obj_override_dn == NULL ? LDB_FLAG_MOD_ADD
                                                         : LDB_FLAG_MOD_REPLACE,
@@ -718,7 +870,18 @@ errno_t sysdb_store_override(struct sss_domain_info *domain,
             ret = sysdb_error_to_errno(ret);
             goto done;
         }
+    }
+
+    if (merge) {
+        ret = add_merged_override(msg, has_override ? attrs : NULL,
+                                  override_dn_str);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "add_merged_override failed.\n");
+            goto done;
+        }
+    }
 
+    if (add_ref || merge) {
         ret = ldb_modify(domain->sysdb->ldb, msg);
         if (ret != LDB_SUCCESS) {
             DEBUG(SSSDBG_CRIT_FAILURE,
@@ -1248,6 +1411,7 @@ static errno_t sysdb_search_override_by_id(TALLOC_CTX *mem_ctx,
                                            struct sss_domain_info *domain,
                                            unsigned long int id,
                                            enum override_object_type type,
+                                           const char **req_attrs,
                                            struct ldb_result **override_obj,
                                            struct ldb_result **orig_obj)
 {
@@ -1292,6 +1456,10 @@ static errno_t sysdb_search_override_by_id(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    if (req_attrs != NULL) {
+        attrs = req_attrs;
+    }
+
     ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &override_res, base_dn,
                      LDB_SCOPE_SUBTREE, attrs, filter, id);
     if (ret != LDB_SUCCESS) {
@@ -1375,7 +1543,18 @@ errno_t sysdb_search_user_override_by_uid(TALLOC_CTX *mem_ctx,
                                            struct ldb_result **orig_obj)
 {
     return sysdb_search_override_by_id(mem_ctx, domain, uid, OO_TYPE_USER,
-                                       override_obj, orig_obj);
+                                       NULL, override_obj, orig_obj);
+}
+
+errno_t sysdb_search_user_override_attrs_by_uid(TALLOC_CTX *mem_ctx,
+                                            struct sss_domain_info *domain,
+                                            uid_t uid,
+                                            const char **attrs,
+                                            struct ldb_result **override_obj,
+                                            struct ldb_result **orig_obj)
+{
+    return sysdb_search_override_by_id(mem_ctx, domain, uid, OO_TYPE_USER,
+                                       attrs, override_obj, orig_obj);
 }
 
 errno_t sysdb_search_group_override_by_gid(TALLOC_CTX *mem_ctx,
@@ -1385,7 +1564,18 @@ errno_t sysdb_search_group_override_by_gid(TALLOC_CTX *mem_ctx,
                                             struct ldb_result **orig_obj)
 {
     return sysdb_search_override_by_id(mem_ctx, domain, gid, OO_TYPE_GROUP,
-                                       override_obj, orig_obj);
+                                       NULL, override_obj, orig_obj);
+}
+
+errno_t sysdb_search_group_override_attrs_by_gid(TALLOC_CTX *mem_ctx,
+                                            struct sss_domain_info *domain,
+                                            gid_t gid,
+                                            const char **attrs,
+                                            struct ldb_result **override_obj,
+                                            struct ldb_result **orig_obj)
+{
+    return sysdb_search_override_by_id(mem_ctx, domain, gid, OO_TYPE_GROUP,
+                                       attrs, override_obj, orig_obj);
 }
 
 /**
@@ -1419,20 +1609,7 @@ errno_t sysdb_add_overrides_to_object(struct sss_domain_info *domain,
     static const char *user_attrs[] = SYSDB_PW_ATTRS;
     static const char *group_attrs[] = SYSDB_GRSRC_ATTRS;
     const char **attrs;
-    struct attr_map {
-        const char *attr;
-        const char *new_attr;
-    } attr_map[] = {
-        {SYSDB_UIDNUM, OVERRIDE_PREFIX SYSDB_UIDNUM},
-        {SYSDB_GIDNUM, OVERRIDE_PREFIX SYSDB_GIDNUM},
-        {SYSDB_GECOS, OVERRIDE_PREFIX SYSDB_GECOS},
-        {SYSDB_HOMEDIR, OVERRIDE_PREFIX SYSDB_HOMEDIR},
-        {SYSDB_SHELL, OVERRIDE_PREFIX SYSDB_SHELL},
-        {SYSDB_NAME, OVERRIDE_PREFIX SYSDB_NAME},
-        {SYSDB_SSH_PUBKEY, OVERRIDE_PREFIX SYSDB_SSH_PUBKEY},
-        {SYSDB_USER_CERT, OVERRIDE_PREFIX SYSDB_USER_CERT},
-        {NULL, NULL}
-    };
+    const char *merged_dn_str;
     size_t c;
     size_t d;
     struct ldb_message_element *tmp_el;
@@ -1443,9 +1620,24 @@ errno_t sysdb_add_overrides_to_object(struct sss_domain_info *domain,
         return ENOMEM;
     }
 
+    /* The values of the current override were stored with the object and
+     * read together with it. */
+    override_dn_str = ldb_msg_find_attr_as_string(obj, SYSDB_OVERRIDE_DN, NULL);
+    merged_dn_str = ldb_msg_find_attr_as_string(obj, SYSDB_MERGED_OVERRIDE_DN,
+                                                NULL);
+    if (override_dn_str != NULL && merged_dn_str != NULL
+            && strcmp(override_dn_str, merged_dn_str) == 0) {
+        ret = EOK;
+        goto done;
+    }
+
+    /* Outdated values stored with the object must not be used. */
+    for (c = 0; override_attr_map[c].attr != NULL; c++) {
+        ldb_msg_remove_attr(obj, override_attr_map[c].new_attr);
+    }
+    ldb_msg_remove_attr(obj, SYSDB_MERGED_OVERRIDE_DN);
+
     if (override_obj == NULL) {
-        override_dn_str = ldb_msg_find_attr_as_string(obj,
-                                                      SYSDB_OVERRIDE_DN, NULL);
         if (override_dn_str == NULL) {
             if (is_local_view(domain->view_name)) {
                 /* LOCAL view doesn't have to have overrideDN specified. */
@@ -1511,11 +1703,12 @@ errno_t sysdb_add_overrides_to_object(struct sss_domain_info *domain,
         override = override_obj;
     }
 
-    for (c = 0; attr_map[c].attr != NULL; c++) {
-        tmp_el = ldb_msg_find_element(override, attr_map[c].attr);
+    for (c = 0; override_attr_map[c].attr != NULL; c++) {
+        tmp_el = ldb_msg_find_element(override, override_attr_map[c].attr);
         if (tmp_el != NULL) {
             for (d = 0; d < tmp_el->num_values; d++) {
-                ret = ldb_msg_add_steal_value(obj, attr_map[c].new_attr,
+                ret = ldb_msg_add_steal_value(obj,
+                                              override_attr_map[c].new_attr,
                                               &tmp_el->values[d]);
                 if (ret != LDB_SUCCESS) {
                     DEBUG(SSSDBG_OP_FAILURE, "ldb_msg_add_value failed.\n");
@@ -73,14 +73,22 @@ struct mbof_add_operation {
 struct mbof_memberuid_op {
     struct ldb_dn *dn;
     struct ldb_message_element *el;
+    unsigned int alloc;
+
+    /* values already in el */
+    hash_table_t *vals;
 };
 
 struct mbof_add_ctx {
     struct mbof_ctx *ctx;
 
     struct mbof_add_operation *add_list;
+    struct mbof_add_operation *add_last;
     struct mbof_add_operation *current_op;
 
+    /* entries already in add_list */
+    hash_table_t *add_set;
+
     struct ldb_message *msg;
     struct ldb_dn *msg_dn;
     bool terminate;
@@ -94,6 +102,7 @@ struct mbof_add_ctx {
 
 struct mbof_del_ancestors_ctx {
     struct mbof_dn_array *new_list;
+    hash_table_t *new_set;
     int num_direct;
     int cur;
 
@@ -123,7 +132,9 @@ struct mbof_del_ctx {
     struct mbof_ctx *ctx;
 
     struct mbof_del_operation *first;
-    struct mbof_dn *history;
+
+    /* entries that were already processed */
+    hash_table_t *history;
 
     struct ldb_message **mus;
     int num_mus;
@@ -193,6 +204,94 @@ static void hash_free(void *ptr, void *pvt)
     talloc_free(ptr);
 }
 
+/* Sets of strings, so that large member lists do not have to be compared
+ * value by value. DNs are stored in their casefolded form, which matches
+ * the way ldb_dn_compare() compares them. */
+static hash_table_t *mbof_set_create(TALLOC_CTX *memctx, unsigned long count)
+{
+    hash_table_t *set;
+    int ret;
+
+    ret = hash_create_ex(count, &set, 0, 0, 0, 0,
+                         hash_alloc, hash_free, memctx, NULL, NULL);
+    if (ret != HASH_SUCCESS) {
+        return NULL;
+    }
+
+    return set;
+}
+
+/* Returns LDB_ERR_ENTRY_ALREADY_EXISTS if the string is already in the set */
+static int mbof_set_add(hash_table_t *set, const char *str, unsigned long idx)
+{
+    hash_key_t key;
+    hash_value_t value;
+    int ret;
+
+    if (str == NULL) {
+        return LDB_ERR_OPERATIONS_ERROR;
+    }
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(str);
+
+    if (hash_has_key(set, &key)) {
+        return LDB_ERR_ENTRY_ALREADY_EXISTS;
+    }
+
+    value.type = HASH_VALUE_ULONG;
+    value.ul = idx;
+
+    ret = hash_enter(set, &key, &value);
+    if (ret != HASH_SUCCESS) {
+        return LDB_ERR_OPERATIONS_ERROR;
+    }
+
+    return LDB_SUCCESS;
+}
+
+/* Removes the string from the set, returns false if it was not there */
+static bool mbof_set_remove(hash_table_t *set, const char *str,
+                            unsigned long *_idx)
+{
+    hash_key_t key;
+    hash_value_t value;
+    int ret;
+
+    if (str == NULL) {
+        return false;
+    }
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(str);
+
+    ret = hash_lookup(set, &key, &value);
+    if (ret != HASH_SUCCESS) {
+        return false;
+    }
+
+    hash_delete(set, &key);
+
+    if (_idx != NULL) {
+        *_idx = value.ul;
+    }
+    return true;
+}
+
+static bool mbof_set_has(hash_table_t *set, const char *str)
+{
+    hash_key_t key;
+
+    if (str == NULL) {
+        return false;
+    }
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(str);
+
+    return hash_has_key(set, &key);
+}
+
 static int entry_has_objectclass(struct ldb_message *entry,
                                  const char *objectclass)
 {
@@ -237,6 +336,7 @@ static int mbof_append_muop(TALLOC_CTX *memctx,
     int num_muops = *_num_muops;
     struct mbof_memberuid_op *op;
     struct ldb_val *val;
+    int ret;
     int i;
 
     op = NULL;
@@ -262,6 +362,8 @@ static int mbof_append_muop(TALLOC_CTX *memctx,
 
         op->dn = parent;
         op->el = NULL;
+        op->alloc = 0;
+        op->vals = NULL;
     }
 
     if (!op->el) {
@@ -274,19 +376,30 @@ static int mbof_append_muop(TALLOC_CTX *memctx,
             return LDB_ERR_OPERATIONS_ERROR;
         }
         op->el->flags = flags;
-    }
 
-    for (i = 0; i < op->el->num_values; i++) {
-        if (strcmp((char *)op->el->values[i].data, name) == 0) {
-            /* we already have this value, get out*/
-            return LDB_SUCCESS;
+        op->vals = mbof_set_create(op->el, 0);
+        if (!op->vals) {
+            return LDB_ERR_OPERATIONS_ERROR;
         }
     }
 
-    val = talloc_realloc(op->el, op->el->values,
-                         struct ldb_val, op->el->num_values + 1);
-    if (!val) {
-        return LDB_ERR_OPERATIONS_ERROR;
+    ret = mbof_set_add(op->vals, name, op->el->num_values);
+    if (ret == LDB_ERR_ENTRY_ALREADY_EXISTS) {
+        /* we already have this value, get out*/
+        return LDB_SUCCESS;
+    } else if (ret != LDB_SUCCESS) {
+        return ret;
+    }
+
+    val = op->el->values;
+    if (op->el->num_values >= op->alloc) {
+        /* grow geometrically, groups can have many thousands of members */
+        op->alloc = MAX(16, op->alloc * 2);
+        val = talloc_realloc(op->el, op->el->values,
+                             struct ldb_val, op->alloc);
+        if (!val) {
+            return LDB_ERR_OPERATIONS_ERROR;
+        }
     }
     val[op->el->num_values].data = (uint8_t *)talloc_strdup(val, name);
     if (!val[op->el->num_values].data) {
@@ -346,25 +459,24 @@ static int mbof_append_addop(struct mbof_add_ctx *add_ctx,
                              struct mbof_dn_array *parents,
                              struct ldb_dn *entry_dn)
 {
-    struct mbof_add_operation *lastop = NULL;
     struct mbof_add_operation *addop;
+    int ret;
 
-    /* test if this is a duplicate */
-    /* FIXME: this is not efficient */
-    if (add_ctx->add_list) {
-        do {
-            if (lastop) {
-                lastop = lastop->next;
-            } else {
-                lastop = add_ctx->add_list;
-            }
+    if (!add_ctx->add_set) {
+        add_ctx->add_set = mbof_set_create(add_ctx, 0);
+        if (!add_ctx->add_set) {
+            return LDB_ERR_OPERATIONS_ERROR;
+        }
+    }
 
-            /* FIXME: check if this is right, might have to compare parents */
-            if (ldb_dn_compare(lastop->entry_dn, entry_dn) == 0) {
-                /* duplicate found */
-                return LDB_SUCCESS;
-            }
-        } while (lastop->next);
+    /* test if this is a duplicate */
+    /* FIXME: check if this is right, might have to compare parents */
+    ret = mbof_set_add(add_ctx->add_set, ldb_dn_get_casefold(entry_dn), 0);
+    if (ret == LDB_ERR_ENTRY_ALREADY_EXISTS) {
+        /* duplicate found */
+        return LDB_SUCCESS;
+    } else if (ret != LDB_SUCCESS) {
+        return ret;
     }
 
     addop = talloc_zero(add_ctx, struct mbof_add_operation);
@@ -377,10 +489,11 @@ static int mbof_append_addop(struct mbof_add_ctx *add_ctx,
     addop->entry_dn = entry_dn;
 
     if (add_ctx->add_list) {
-        lastop->next = addop;
+        add_ctx->add_last->next = addop;
     } else {
         add_ctx->add_list = addop;
     }
+    add_ctx->add_last = addop;
 
     return LDB_SUCCESS;
 }
@@ -1898,7 +2011,7 @@ static int mbof_del_execute_cont(struct mbof_del_operation *delop)
 {
     struct mbof_del_ancestors_ctx *anc_ctx;
     struct mbof_dn_array *new_list;
-    int i;
+    int i, ret;
 
     anc_ctx = talloc_zero(delop, struct mbof_del_ancestors_ctx);
     if (!anc_ctx) {
@@ -1920,6 +2033,11 @@ static int mbof_del_execute_cont(struct mbof_del_operation *delop)
     delop->anc_ctx->new_list = new_list;
     delop->anc_ctx->num_direct = new_list->num;
 
+    anc_ctx->new_set = mbof_set_create(anc_ctx, 0);
+    if (!anc_ctx->new_set) {
+        return LDB_ERR_OPERATIONS_ERROR;
+    }
+
     /* do we have any direct parent at all? */
     if (new_list->num == 0) {
         /* no entries at all, entry ended up being orphaned */
@@ -1937,6 +2055,12 @@ static int mbof_del_execute_cont(struct mbof_del_operation *delop)
     }
     for (i = 0; i < delop->num_parents; i++) {
         new_list->dns[i] = delop->parents[i]->dn;
+
+        ret = mbof_set_add(anc_ctx->new_set,
+                           ldb_dn_get_casefold(new_list->dns[i]), i);
+        if (ret != LDB_SUCCESS && ret != LDB_ERR_ENTRY_ALREADY_EXISTS) {
+            return ret;
+        }
     }
 
     /* before proceeding we also need to fetch the ancestors (anew as some may
@@ -1985,7 +2109,7 @@ static int mbof_del_anc_callback(struct ldb_request *req,
     const struct ldb_message_element *el;
     struct mbof_dn_array *new_list;
     struct ldb_dn *valdn;
-    int i, j, ret;
+    int i, ret;
 
     delop = talloc_get_type(req->context, struct mbof_del_operation);
     del_ctx = delop->del_ctx;
@@ -2047,13 +2171,14 @@ static int mbof_del_anc_callback(struct ldb_request *req,
                     return ldb_module_done(ctx->req, NULL, NULL,
                                            LDB_ERR_OPERATIONS_ERROR);
                 }
-                for (j = 0; j < new_list->num; j++) {
-                    if (ldb_dn_compare(valdn, new_list->dns[j]) == 0)
-                        break;
-                }
-                if (j < new_list->num) {
+                ret = mbof_set_add(anc_ctx->new_set,
+                                   ldb_dn_get_casefold(valdn), new_list->num);
+                if (ret == LDB_ERR_ENTRY_ALREADY_EXISTS) {
                     talloc_free(valdn);
                     continue;
+                } else if (ret != LDB_SUCCESS) {
+                    return ldb_module_done(ctx->req, NULL, NULL,
+                                           LDB_ERR_OPERATIONS_ERROR);
                 }
 
                 new_list->dns = talloc_realloc(new_list,
@@ -2102,10 +2227,13 @@ static int mbof_del_mod_entry(struct mbof_del_operation *delop)
     struct ldb_request *mod_req;
     struct ldb_message *msg;
     struct ldb_message_element *el;
-    struct ldb_dn **diff = NULL;
-    const char *name;
+    struct ldb_message_element *delel = NULL;
+    struct ldb_message_element *addel = NULL;
+    hash_table_t *keep;
+    struct ldb_dn *valdn;
+    const char *name = NULL;
     const char *val;
-    int i, j, k;
+    int i;
     bool is_user;
     int ret;
 
@@ -2132,34 +2260,9 @@ static int mbof_del_mod_entry(struct mbof_del_operation *delop)
         return ret;
     }
 
-    if (is_user) {
-        /* prepare memberuid delete list */
-        /* copy all original memberof entries, and then later remove
-         * the ones that will survive in the entry */
-        el = ldb_msg_find_element(delop->entry, DB_MEMBEROF);
-        if (!el || !el->num_values) {
-            return LDB_ERR_OPERATIONS_ERROR;
-        }
-        diff = talloc_array(del_ctx, struct ldb_dn *,
-                            el->num_values + 1);
-        if (!diff) {
-            return LDB_ERR_OPERATIONS_ERROR;
-        }
-        for (i = 0, j = 0; i < el->num_values; i++) {
-            diff[j] = ldb_dn_from_ldb_val(diff, ldb, &el->values[i]);
-            if (!diff[j]) {
-                return LDB_ERR_OPERATIONS_ERROR;
-            }
-            /* skip the deleted entry if this is a delete op */
-            if (!del_ctx->is_mod) {
-                if (ldb_dn_compare(del_ctx->first->entry_dn, diff[j]) == 0) {
-                    continue;
-                }
-            }
-            j++;
-        }
-        /* zero terminate array */
-        diff[j] = NULL;
+    el = ldb_msg_find_element(delop->entry, DB_MEMBEROF);
+    if (is_user && (!el || !el->num_values)) {
+        return LDB_ERR_OPERATIONS_ERROR;
     }
 
     /* change memberof on entry */
@@ -2168,76 +2271,132 @@ static int mbof_del_mod_entry(struct mbof_del_operation *delop)
 
     msg->dn = delop->entry_dn;
 
+    /* the new memberof list, the entry is never a member of itself */
+    keep = mbof_set_create(msg, new_list->num);
+    if (!keep) {
+        return LDB_ERR_OPERATIONS_ERROR;
+    }
+    for (i = 0; i < new_list->num; i++) {
+        if (ldb_dn_compare(new_list->dns[i], msg->dn) == 0)
+            continue;
+        ret = mbof_set_add(keep, ldb_dn_get_casefold(new_list->dns[i]), i);
+        if (ret != LDB_SUCCESS && ret != LDB_ERR_ENTRY_ALREADY_EXISTS) {
+            return ret;
+        }
+    }
+
     if (new_list->num) {
-        ret = ldb_msg_add_empty(msg, DB_MEMBEROF, LDB_FLAG_MOD_REPLACE, &el);
+        /* only remove the parents that are gone and add the new ones
+         * instead of replacing the whole attribute */
+        ret = ldb_msg_add_empty(msg, DB_MEMBEROF, LDB_FLAG_MOD_DELETE, &delel);
+        if (ret != LDB_SUCCESS) {
+            return ret;
+        }
+        ret = ldb_msg_add_empty(msg, DB_MEMBEROF, LDB_FLAG_MOD_ADD, &addel);
         if (ret != LDB_SUCCESS) {
             return ret;
         }
+        /* ldb_msg_add_empty() may have moved the first element */
+        delel = &msg->elements[0];
 
-        el->values = talloc_array(el, struct ldb_val, new_list->num);
-        if (!el->values) {
+        if (el && el->num_values) {
+            delel->values = talloc_array(msg, struct ldb_val, el->num_values);
+            if (!delel->values) {
+                return LDB_ERR_OPERATIONS_ERROR;
+            }
+        }
+        addel->values = talloc_array(msg, struct ldb_val, new_list->num);
+        if (!addel->values) {
             return LDB_ERR_OPERATIONS_ERROR;
         }
-        for (i = 0, j = 0; i < new_list->num; i++) {
-            if (ldb_dn_compare(new_list->dns[i], msg->dn) == 0)
-                continue;
-            val = ldb_dn_get_linearized(new_list->dns[i]);
-            if (!val) {
+    }
+    else {
+        ret = ldb_msg_add_empty(msg, DB_MEMBEROF, LDB_FLAG_MOD_DELETE, NULL);
+        if (ret != LDB_SUCCESS) {
+            return ret;
+        }
+    }
+
+    for (i = 0; el && i < el->num_values; i++) {
+        valdn = ldb_dn_from_ldb_val(del_ctx, ldb, &el->values[i]);
+        if (!valdn || !ldb_dn_validate(valdn)) {
+            ldb_debug(ldb, LDB_DEBUG_TRACE, "Invalid dn for memberof: (%s)",
+                                            (const char *)el->values[i].data);
+            return LDB_ERR_OPERATIONS_ERROR;
+        }
+
+        if (mbof_set_remove(keep, ldb_dn_get_casefold(valdn), NULL)) {
+            /* still a parent */
+            talloc_free(valdn);
+            continue;
+        }
+
+        if (delel) {
+            delel->values[delel->num_values] = ldb_val_dup(delel->values,
+                                                           &el->values[i]);
+            if (!delel->values[delel->num_values].data) {
                 return LDB_ERR_OPERATIONS_ERROR;
             }
-            el->values[j].length = strlen(val);
-            el->values[j].data = (uint8_t *)talloc_strdup(el->values, val);
-            if (!el->values[j].data) {
+            delel->num_values++;
+        }
+
+        /* for each parent the user lost schedule the removal of the
+         * memberuid, skip the deleted entry if this is a delete op */
+        if (!is_user || (!del_ctx->is_mod &&
+                ldb_dn_compare(del_ctx->first->entry_dn, valdn) == 0)) {
+            talloc_free(valdn);
+            continue;
+        }
+
+        if (!name) {
+            name = ldb_msg_find_attr_as_string(delop->entry, DB_NAME, NULL);
+            if (!name) {
                 return LDB_ERR_OPERATIONS_ERROR;
             }
-            j++;
-
-            if (is_user) {
-                /* compare the entry's original memberof list with the new
-                 * one and for each missing entry add a memberuid removal
-                 * operation */
-                for (k = 0; diff[k]; k++) {
-                    if (ldb_dn_compare(new_list->dns[i], diff[k]) == 0) {
-                        break;
-                    }
-                }
-                if (diff[k]) {
-                    talloc_zfree(diff[k]);
-                    for (; diff[k + 1]; k++) {
-                        diff[k] = diff[k + 1];
-                    }
-                    diff[k] = NULL;
-                }
-            }
         }
-        el->num_values = j;
 
-    }
-    else {
-        ret = ldb_msg_add_empty(msg, DB_MEMBEROF, LDB_FLAG_MOD_DELETE, &el);
+        ret = mbof_append_muop(del_ctx, &del_ctx->muops,
+                               &del_ctx->num_muops,
+                               LDB_FLAG_MOD_DELETE,
+                               valdn, name,
+                               DB_MEMBERUID);
         if (ret != LDB_SUCCESS) {
             return ret;
         }
+        talloc_steal(del_ctx->muops, valdn);
     }
 
-    if (is_user && diff[0]) {
-        /* file memberuid removal operations */
-        name = ldb_msg_find_attr_as_string(delop->entry, DB_NAME, NULL);
-        if (!name) {
+    /* whatever is left in the set was not a parent before */
+    for (i = 0; addel && i < new_list->num; i++) {
+        if (!mbof_set_remove(keep, ldb_dn_get_casefold(new_list->dns[i]),
+                             NULL)) {
+            continue;
+        }
+        val = ldb_dn_get_linearized(new_list->dns[i]);
+        if (!val) {
             return LDB_ERR_OPERATIONS_ERROR;
         }
-
-        for (i = 0; diff[i]; i++) {
-            ret = mbof_append_muop(del_ctx, &del_ctx->muops,
-                                   &del_ctx->num_muops,
-                                   LDB_FLAG_MOD_DELETE,
-                                   diff[i], name,
-                                   DB_MEMBERUID);
-            if (ret != LDB_SUCCESS) {
-                return ret;
-            }
-            talloc_steal(del_ctx->muops, diff[i]);
+        addel->values[addel->num_values].length = strlen(val);
+        addel->values[addel->num_values].data =
+                                (uint8_t *)talloc_strdup(addel->values, val);
+        if (!addel->values[addel->num_values].data) {
+            return LDB_ERR_OPERATIONS_ERROR;
         }
+        addel->num_values++;
+    }
+
+    /* drop the elements that ended up empty */
+    if (addel && addel->num_values == 0) {
+        msg->num_elements--;
+    }
+    if (delel && delel->num_values == 0) {
+        ldb_msg_remove_element(msg, delel);
+    }
+
+    if (msg->num_elements == 0) {
+        /* the memberof list did not change */
+        talloc_free(msg);
+        return mbof_del_progeny(delop);
     }
 
     ret = ldb_build_mod_req(&mod_req, ldb, delop,
@@ -2379,23 +2538,22 @@ static int mbof_del_get_next(struct mbof_del_operation *delop,
 {
     struct mbof_del_operation *top, *cop;
     struct mbof_del_ctx *del_ctx;
-    struct mbof_dn *save, *tmp;
+    int ret;
 
     del_ctx = delop->del_ctx;
 
     /* first of all, save the current delop in the history */
-    save = talloc_zero(del_ctx, struct mbof_dn);
-    if (!save) {
-        return LDB_ERR_OPERATIONS_ERROR;
+    if (!del_ctx->history) {
+        del_ctx->history = mbof_set_create(del_ctx, 0);
+        if (!del_ctx->history) {
+            return LDB_ERR_OPERATIONS_ERROR;
+        }
     }
-    save->dn = delop->entry_dn;
 
-    if (del_ctx->history) {
-        tmp = del_ctx->history;
-        while (tmp->next) tmp = tmp->next;
-        tmp->next = save;
-    } else {
-        del_ctx->history = save;
+    ret = mbof_set_add(del_ctx->history,
+                       ldb_dn_get_casefold(delop->entry_dn), 0);
+    if (ret != LDB_SUCCESS && ret != LDB_ERR_ENTRY_ALREADY_EXISTS) {
+        return ret;
     }
 
     /* Find next one */
@@ -2410,12 +2568,8 @@ static int mbof_del_get_next(struct mbof_del_operation *delop,
             top->next_child++;
 
             /* verify this operation has not already been performed */
-            for (tmp = del_ctx->history; tmp; tmp = tmp->next) {
-                if (ldb_dn_compare(tmp->dn, cop->entry_dn) == 0) {
-                    break;
-                }
-            }
-            if (tmp == NULL) {
+            if (!mbof_set_has(del_ctx->history,
+                              ldb_dn_get_casefold(cop->entry_dn))) {
                 /* and return the current one */
                 *nextop = cop;
                 return LDB_SUCCESS;
@@ -3416,6 +3570,114 @@ static int mbof_mod_process(struct mbof_mod_ctx *mod_ctx, bool *done)
     return LDB_SUCCESS;
 }
 
+/* Removes the DNs that are in both arrays from both of them */
+static int mbof_dn_array_diff(TALLOC_CTX *mem_ctx,
+                              struct mbof_dn_array *added,
+                              struct mbof_dn_array *removed)
+{
+    TALLOC_CTX *tmp_ctx;
+    hash_table_t *set;
+    unsigned long idx;
+    bool *unchanged;
+    int i, n, ret;
+
+    tmp_ctx = talloc_new(mem_ctx);
+    if (!tmp_ctx) {
+        return LDB_ERR_OPERATIONS_ERROR;
+    }
+
+    set = mbof_set_create(tmp_ctx, removed->num);
+    unchanged = talloc_zero_array(tmp_ctx, bool, removed->num);
+    if (!set || !unchanged) {
+        ret = LDB_ERR_OPERATIONS_ERROR;
+        goto done;
+    }
+
+    for (i = 0; i < removed->num; i++) {
+        ret = mbof_set_add(set, ldb_dn_get_casefold(removed->dns[i]), i);
+        if (ret != LDB_SUCCESS && ret != LDB_ERR_ENTRY_ALREADY_EXISTS) {
+            goto done;
+        }
+    }
+
+    for (i = 0, n = 0; i < added->num; i++) {
+        if (mbof_set_remove(set, ldb_dn_get_casefold(added->dns[i]), &idx)) {
+            /* preexisting one, not removed, nor added */
+            unchanged[idx] = true;
+            continue;
+        }
+        added->dns[n++] = added->dns[i];
+    }
+    added->num = n;
+
+    for (i = 0, n = 0; i < removed->num; i++) {
+        if (!unchanged[i]) {
+            removed->dns[n++] = removed->dns[i];
+        }
+    }
+    removed->num = n;
+
+    ret = LDB_SUCCESS;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Removes the values that are in both arrays from both of them */
+static int mbof_val_array_diff(TALLOC_CTX *mem_ctx,
+                               struct mbof_val_array *added,
+                               struct mbof_val_array *removed)
+{
+    TALLOC_CTX *tmp_ctx;
+    hash_table_t *set;
+    unsigned long idx;
+    bool *unchanged;
+    int i, n, ret;
+
+    tmp_ctx = talloc_new(mem_ctx);
+    if (!tmp_ctx) {
+        return LDB_ERR_OPERATIONS_ERROR;
+    }
+
+    set = mbof_set_create(tmp_ctx, removed->num);
+    unchanged = talloc_zero_array(tmp_ctx, bool, removed->num);
+    if (!set || !unchanged) {
+        ret = LDB_ERR_OPERATIONS_ERROR;
+        goto done;
+    }
+
+    for (i = 0; i < removed->num; i++) {
+        ret = mbof_set_add(set, (const char *) removed->vals[i].data, i);
+        if (ret != LDB_SUCCESS && ret != LDB_ERR_ENTRY_ALREADY_EXISTS) {
+            goto done;
+        }
+    }
+
+    for (i = 0, n = 0; i < added->num; i++) {
+        if (mbof_set_remove(set, (const char *) added->vals[i].data, &idx)) {
+            /* preexisting one, not removed, nor added */
+            unchanged[idx] = true;
+            continue;
+        }
+        added->vals[n++] = added->vals[i];
+    }
+    added->num = n;
+
+    for (i = 0, n = 0; i < removed->num; i++) {
+        if (!unchanged[i]) {
+            removed->vals[n++] = removed->vals[i];
+        }
+    }
+    removed->num = n;
+
+    ret = LDB_SUCCESS;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 static int mbof_mod_process_membel(TALLOC_CTX *mem_ctx,
                                    struct ldb_context *ldb,
                                    struct ldb_message *entry,
@@ -3426,7 +3688,7 @@ static int mbof_mod_process_membel(TALLOC_CTX *mem_ctx,
     const struct ldb_message_element *el;
     struct mbof_dn_array *removed = NULL;
     struct mbof_dn_array *added = NULL;
-    int i, j, ret;
+    int ret;
 
     if (!membel) {
         /* Nothing to do.. */
@@ -3484,24 +3746,11 @@ static int mbof_mod_process_membel(TALLOC_CTX *mem_ctx,
 
         /* remove from arrays values that ended up unchanged */
         if (removed && removed->num && added && added->num) {
-            for (i = 0; i < added->num; i++) {
-                for (j = 0; j < removed->num; j++) {
-                    if (ldb_dn_compare(added->dns[i], removed->dns[j]) == 0) {
-                        break;
-                    }
-                }
-                if (j < removed->num) {
-                    /* preexisting one, not removed, nor added */
-                    for (; j+1 < removed->num; j++) {
-                        removed->dns[j] = removed->dns[j+1];
-                    }
-                    removed->num--;
-                    for (j = i; j+1 < added->num; j++) {
-                        added->dns[j] = added->dns[j+1];
-                    }
-                    added->num--;
-                    i--;
-                }
+            ret = mbof_dn_array_diff(mem_ctx, added, removed);
+            if (ret != LDB_SUCCESS) {
+                talloc_free(added);
+                talloc_free(removed);
+                return ret;
             }
         }
         break;
@@ -3525,7 +3774,7 @@ static int mbof_mod_process_ghel(TALLOC_CTX *mem_ctx,
     const struct ldb_message_element *el;
     struct mbof_val_array *removed = NULL;
     struct mbof_val_array *added = NULL;
-    int i, j, ret;
+    int ret;
 
     if (!ghel) {
         /* Nothing to do.. */
@@ -3593,25 +3842,11 @@ static int mbof_mod_process_ghel(TALLOC_CTX *mem_ctx,
 
         /* remove from arrays values that ended up unchanged */
         if (removed && removed->num && added && added->num) {
-            for (i = 0; i < added->num; i++) {
-                for (j = 0; j < removed->num; j++) {
-                    if (strcmp((const char *) added->vals[i].data,
-                               (const char *) removed->vals[j].data) == 0) {
-                        break;
-                    }
-                }
-                if (j < removed->num) {
-                    /* preexisting one, not removed, nor added */
-                    for (; j+1 < removed->num; j++) {
-                        removed->vals[j] = removed->vals[j+1];
-                    }
-                    removed->num--;
-                    for (j = i; j+1 < added->num; j++) {
-                        added->vals[j] = added->vals[j+1];
-                    }
-                    added->num--;
-                    i--;
-                }
+            ret = mbof_val_array_diff(mem_ctx, added, removed);
+            if (ret != LDB_SUCCESS) {
+                talloc_free(added);
+                talloc_free(removed);
+                return ret;
             }
         }
         break;
@@ -261,6 +261,10 @@ int sss_certmap_add_rule(struct sss_certmap_ctx *ctx,
 
     talloc_steal(ctx, rule);
 
+    /* Compiled again on next use */
+    talloc_zfree(ctx->compiled_rules);
+    ctx->num_compiled_rules = 0;
+
     ret = EOK;
 
 done:
@@ -768,15 +772,149 @@ static int do_match(struct sss_certmap_ctx *ctx,
     return ENOENT;
 }
 
+static int compile_rules(struct sss_certmap_ctx *ctx)
+{
+    struct match_map_rule *r;
+    struct priority_list *p;
+    struct component_list *comp;
+    struct compiled_rule *rules;
+    size_t num = 0;
+    size_t c;
+
+    if (ctx->compiled_rules != NULL || ctx->prio_list == NULL) {
+        return 0;
+    }
+
+    for (p = ctx->prio_list; p != NULL; p = p->next) {
+        for (r = p->rule_list; r != NULL; r = r->next) {
+            num++;
+        }
+    }
+
+    rules = talloc_zero_array(ctx, struct compiled_rule, num);
+    if (rules == NULL) {
+        return ENOMEM;
+    }
+
+    c = 0;
+    for (p = ctx->prio_list; p != NULL; p = p->next) {
+        for (r = p->rule_list; r != NULL; r = r->next) {
+            rules[c].rule = r;
+
+            /* With '&&' all key usage components must match */
+            if (r->parsed_match_rule != NULL
+                    && r->parsed_match_rule->r != relation_or) {
+                for (comp = r->parsed_match_rule->ku; comp != NULL;
+                                                      comp = comp->next) {
+                    rules[c].required_ku |= comp->ku;
+                }
+            }
+            c++;
+        }
+    }
+
+    ctx->compiled_rules = rules;
+    ctx->num_compiled_rules = num;
+
+    return 0;
+}
+
+static struct match_map_rule *find_matching_rule(struct sss_certmap_ctx *ctx,
+                                          struct sss_cert_content *cert_content)
+{
+    struct compiled_rule *cr;
+    size_t c;
+
+    for (c = 0; c < ctx->num_compiled_rules; c++) {
+        cr = &ctx->compiled_rules[c];
+
+        if ((cert_content->key_usage & cr->required_ku) != cr->required_ku) {
+            continue;
+        }
+
+        if (do_match(ctx, cr->rule->parsed_match_rule, cert_content) == 0) {
+            return cr->rule;
+        }
+    }
+
+    return NULL;
+}
+
+/* FNV-1a, only used to find cache entries, the certificates are compared
+ * completely */
+static uint64_t cert_hash(const uint8_t *der_cert, size_t der_size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t c;
+
+    for (c = 0; c < der_size; c++) {
+        hash ^= der_cert[c];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/* The returned content is owned by the cache of the context and must not be
+ * freed by the caller. */
+static int get_cert_content(struct sss_certmap_ctx *ctx,
+                            const uint8_t *der_cert, size_t der_size,
+                            struct sss_cert_content **_cert_content)
+{
+    struct cert_content_cache_entry *entry;
+    struct cert_content_cache_entry *lru = NULL;
+    struct sss_cert_content *cert_content;
+    uint64_t hash;
+    size_t c;
+    int ret;
+
+    if (der_cert == NULL || der_size == 0) {
+        return EINVAL;
+    }
+
+    hash = cert_hash(der_cert, der_size);
+
+    for (c = 0; c < CERT_CONTENT_CACHE_SIZE; c++) {
+        entry = &ctx->content_cache[c];
+
+        if (entry->content != NULL && entry->hash == hash
+                && entry->content->cert_der_size == der_size
+                && memcmp(entry->content->cert_der, der_cert,
+                          der_size) == 0) {
+            entry->last_used = ++ctx->content_cache_tick;
+            *_cert_content = entry->content;
+            return 0;
+        }
+
+        if (lru == NULL || entry->content == NULL
+                || (lru->content != NULL
+                        && entry->last_used < lru->last_used)) {
+            lru = entry;
+        }
+    }
+
+    ret = sss_cert_get_content(ctx, der_cert, der_size, &cert_content);
+    if (ret != 0) {
+        return ret;
+    }
+
+    talloc_free(lru->content);
+    lru->content = cert_content;
+    lru->hash = hash;
+    lru->last_used = ++ctx->content_cache_tick;
+
+    *_cert_content = cert_content;
+
+    return 0;
+}
+
 int sss_certmap_match_cert(struct sss_certmap_ctx *ctx,
                            const uint8_t *der_cert, size_t der_size)
 {
     int ret;
-    struct match_map_rule *r;
-    struct priority_list *p;
     struct sss_cert_content *cert_content = NULL;
 
-    ret = sss_cert_get_content(ctx, der_cert, der_size, &cert_content);
+    ret = get_cert_content(ctx, der_cert, der_size, &cert_content);
     if (ret != 0) {
         CM_DEBUG(ctx, "Failed to get certificate content.");
         return ret;
@@ -784,25 +922,19 @@ int sss_certmap_match_cert(struct sss_certmap_ctx *ctx,
 
     if (ctx->prio_list == NULL) {
         /* Match all certificates if there are no rules applied */
-        ret = 0;
-        goto done;
+        return 0;
     }
 
-    for (p = ctx->prio_list; p != NULL; p = p->next) {
-        for (r = p->rule_list; r != NULL; r = r->next) {
-            ret = do_match(ctx, r->parsed_match_rule, cert_content);
-            if (ret == 0) {
-                /* match */
-                goto done;
-            }
-        }
+    ret = compile_rules(ctx);
+    if (ret != 0) {
+        return ret;
     }
 
-    ret = ENOENT;
-done:
-    talloc_free(cert_content);
+    if (find_matching_rule(ctx, cert_content) == NULL) {
+        return ENOENT;
+    }
 
-    return ret;
+    return 0;
 }
 
 static int expand_mapping_rule_ex(struct sss_certmap_ctx *ctx,
@@ -812,7 +944,6 @@ static int expand_mapping_rule_ex(struct sss_certmap_ctx *ctx,
 {
     int ret;
     struct match_map_rule *r;
-    struct priority_list *p;
     struct sss_cert_content *cert_content = NULL;
     char *filter = NULL;
     char **domains = NULL;
@@ -822,7 +953,7 @@ static int expand_mapping_rule_ex(struct sss_certmap_ctx *ctx,
         return EINVAL;
     }
 
-    ret = sss_cert_get_content(ctx, der_cert, der_size, &cert_content);
+    ret = get_cert_content(ctx, der_cert, der_size, &cert_content);
     if (ret != 0) {
         CM_DEBUG(ctx, "Failed to get certificate content [%d].", ret);
         return ret;
@@ -839,45 +970,44 @@ static int expand_mapping_rule_ex(struct sss_certmap_ctx *ctx,
         goto done;
     }
 
-    for (p = ctx->prio_list; p != NULL; p = p->next) {
-        for (r = p->rule_list; r != NULL; r = r->next) {
-            ret = do_match(ctx, r->parsed_match_rule, cert_content);
-            if (ret == 0) {
-                /* match */
-                ret = get_filter(ctx, r->parsed_mapping_rule, cert_content,
-                                 sanitize, &filter);
-                if (ret != 0) {
-                    CM_DEBUG(ctx, "Failed to get filter");
-                    goto done;
-                }
+    ret = compile_rules(ctx);
+    if (ret != 0) {
+        goto done;
+    }
 
-                if (r->domains != NULL) {
-                    for (c = 0; r->domains[c] != NULL; c++);
-                    domains = talloc_zero_array(ctx, char *, c + 1);
-                    if (domains == NULL) {
-                        ret = ENOMEM;
-                        goto done;
-                    }
-
-                    for (c = 0; r->domains[c] != NULL; c++) {
-                        domains[c] = talloc_strdup(domains, r->domains[c]);
-                        if (domains[c] == NULL) {
-                            ret = ENOMEM;
-                            goto done;
-                        }
-                    }
-                }
+    r = find_matching_rule(ctx, cert_content);
+    if (r == NULL) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    ret = get_filter(ctx, r->parsed_mapping_rule, cert_content,
+                     sanitize, &filter);
+    if (ret != 0) {
+        CM_DEBUG(ctx, "Failed to get filter");
+        goto done;
+    }
 
-                ret = 0;
+    if (r->domains != NULL) {
+        for (c = 0; r->domains[c] != NULL; c++);
+        domains = talloc_zero_array(ctx, char *, c + 1);
+        if (domains == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        for (c = 0; r->domains[c] != NULL; c++) {
+            domains[c] = talloc_strdup(domains, r->domains[c]);
+            if (domains[c] == NULL) {
+                ret = ENOMEM;
                 goto done;
             }
         }
     }
 
-    ret = ENOENT;
+    ret = 0;
 
 done:
-    talloc_free(cert_content);
     if (ret == 0) {
         *_filter = filter;
         *_domains = domains;
@@ -56,6 +56,9 @@ typedef void (sss_certmap_ext_debug)(void *pvt,
 /**
  * @brief Initialize certmap context
  *
+ * The context keeps the content of recently used certificates, so it must
+ * not be used by multiple threads at the same time.
+ *
  * @param[in] mem_ctx    Talloc memory context, may be NULL
  * @param[in] debug      Callback to handle debug output, may be NULL
  * @param[in] debug_priv Private data for debugging callback, may be NULL
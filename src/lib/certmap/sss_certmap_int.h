@@ -136,11 +136,35 @@ struct priority_list {
     struct priority_list *next;
 };
 
+/* All rules of a context in the order they have to be checked, with the
+ * key usage bits a certificate must have for the rule to match so that most
+ * rules can be skipped without evaluating them. */
+struct compiled_rule {
+    struct match_map_rule *rule;
+    uint32_t required_ku;
+};
+
+/* Number of parsed certificates kept by a context */
+#define CERT_CONTENT_CACHE_SIZE 16
+
+struct cert_content_cache_entry {
+    uint64_t hash;
+    uint64_t last_used;
+    struct sss_cert_content *content;
+};
+
 struct sss_certmap_ctx {
     struct priority_list *prio_list;
     sss_certmap_ext_debug *debug;
     void *debug_priv;
     struct ldap_mapping_rule *default_mapping_rule;
+
+    /* Built from prio_list on first use, reset by sss_certmap_add_rule() */
+    struct compiled_rule *compiled_rules;
+    size_t num_compiled_rules;
+
+    struct cert_content_cache_entry content_cache[CERT_CONTENT_CACHE_SIZE];
+    uint64_t content_cache_tick;
 };
 
 struct san_list {
@@ -212,19 +212,10 @@ static int samba_unix_sid_to_id(const char *sid, struct cifs_uxid *cuxid)
     return 0;
 }
 
-static int sss_sid_to_id(struct sssd_ctx *ctx, const char *sid,
-                         struct cifs_uxid *cuxid)
+static int sss_id_type_to_cifs(uint32_t id, enum sss_id_type id_type,
+                               struct cifs_uxid *cuxid)
 {
-    int err;
-    enum sss_id_type id_type;
-    uint32_t uid;
-
-    err = sss_nss_getidbysid(sid, &uid, &id_type);
-    if (err != 0)  {
-        ctx_set_error(ctx, strerror(err));
-        return -1;
-    }
-    cuxid->id.uid = (uid_t)uid;
+    cuxid->id.uid = (uid_t)id;
 
     switch (id_type) {
     case SSS_ID_TYPE_UID:
@@ -238,6 +229,7 @@ static int sss_sid_to_id(struct sssd_ctx *ctx, const char *sid,
         break;
     case SSS_ID_TYPE_NOT_SPECIFIED:
     default:
+        cuxid->type = CIFS_UXID_TYPE_UNKNOWN;
         return -1;
     }
 
@@ -254,9 +246,15 @@ int cifs_idmap_sids_to_ids(void *handle, const struct cifs_sid *csid,
 {
     struct sssd_ctx *ctx = handle;
     enum idmap_error_code err;
+    enum sss_id_type *id_types = NULL;
+    uint32_t *ids = NULL;
+    const char **req_sids = NULL;
+    size_t *req_idx = NULL;
+    char **sids = NULL;
+    size_t num_req = 0;
     int success = -1;
+    int ret;
     size_t i;
-    char *sid;
 
     debug("num: %zd", num);
 
@@ -265,25 +263,65 @@ int cifs_idmap_sids_to_ids(void *handle, const struct cifs_sid *csid,
         return EINVAL;
     }
 
+    if (num == 0) {
+        return success;
+    }
+
+    sids = calloc(num, sizeof(char *));
+    req_sids = calloc(num, sizeof(char *));
+    req_idx = calloc(num, sizeof(size_t));
+    if (sids == NULL || req_sids == NULL || req_idx == NULL) {
+        ctx_set_error(ctx, strerror(ENOMEM));
+        goto done;
+    }
+
     for (i = 0; i < num; ++i) {
+        cuxid[i].type = CIFS_UXID_TYPE_UNKNOWN;
+
         err = sss_idmap_bin_sid_to_sid(ctx->idmap, (const uint8_t *) &csid[i],
-                                       sizeof(csid[i]), &sid);
+                                       sizeof(csid[i]), &sids[i]);
         if (err != IDMAP_SUCCESS) {
             ctx_set_error(ctx, idmap_error_string(err));
             continue;
         }
 
-        cuxid[i].type = CIFS_UXID_TYPE_UNKNOWN;
+        req_sids[num_req] = sids[i];
+        req_idx[num_req] = i;
+        num_req++;
+    }
 
-        if (sss_sid_to_id(ctx, sid, &cuxid[i]) == 0 ||
-            samba_unix_sid_to_id(sid, &cuxid[i]) == 0) {
+    /* All SIDs are resolved with one call instead of one call each. */
+    if (num_req > 0) {
+        ret = sss_nss_getidbysid_multi(req_sids, num_req, &ids, &id_types);
+        if (ret != 0) {
+            ctx_set_error(ctx, strerror(ret));
+        }
+    }
 
-            debug("setting uid of %s to %d", sid, cuxid[i].id.uid);
+    for (i = 0; i < num_req; ++i) {
+        if ((ids != NULL
+                && sss_id_type_to_cifs(ids[i], id_types[i],
+                                       &cuxid[req_idx[i]]) == 0)
+                || samba_unix_sid_to_id(req_sids[i],
+                                        &cuxid[req_idx[i]]) == 0) {
+
+            debug("setting uid of %s to %d", req_sids[i],
+                  cuxid[req_idx[i]].id.uid);
             success = 0;
         }
+    }
 
-        free(sid);
+done:
+    if (sids != NULL) {
+        for (i = 0; i < num; ++i) {
+            free(sids[i]);
+        }
     }
+    free(sids);
+    free(req_sids);
+    free(req_idx);
+    free(ids);
+    free(id_types);
 
     return success;
 }
@@ -294,8 +332,10 @@ int cifs_idmap_ids_to_sids(void *handle, const struct cifs_uxid *cuxid,
 {
     struct sssd_ctx *ctx = handle;
     int err, success = -1;
-    char *sid;
-    enum sss_id_type id_type;
+    enum sss_id_type *id_types = NULL;
+    enum sss_id_type *types = NULL;
+    uint32_t *ids = NULL;
+    char **sids = NULL;
     size_t i;
 
     debug("num ids: %zd", num);
@@ -305,33 +345,64 @@ int cifs_idmap_ids_to_sids(void *handle, const struct cifs_uxid *cuxid,
         return EINVAL;
     }
 
+    if (num == 0) {
+        return success;
+    }
+
+    ids = calloc(num, sizeof(uint32_t));
+    id_types = calloc(num, sizeof(enum sss_id_type));
+    if (ids == NULL || id_types == NULL) {
+        ctx_set_error(ctx, strerror(ENOMEM));
+        goto done;
+    }
+
     for (i = 0; i < num; ++i) {
         switch (cuxid[i].type) {
         case CIFS_UXID_TYPE_UID:
-            err = sss_nss_getsidbyuid((uint32_t)cuxid[i].id.uid,
-                                      &sid, &id_type);
+            ids[i] = (uint32_t)cuxid[i].id.uid;
+            id_types[i] = SSS_ID_TYPE_UID;
             break;
         case CIFS_UXID_TYPE_GID:
-            err = sss_nss_getsidbygid((uint32_t)cuxid[i].id.gid,
-                                      &sid, &id_type);
+            ids[i] = (uint32_t)cuxid[i].id.gid;
+            id_types[i] = SSS_ID_TYPE_GID;
             break;
         default:
-            err = sss_nss_getsidbyid((uint32_t)cuxid[i].id.uid, &sid, &id_type);
+            ids[i] = (uint32_t)cuxid[i].id.uid;
+            id_types[i] = SSS_ID_TYPE_NOT_SPECIFIED;
         }
-        if (err != 0)  {
-            ctx_set_error(ctx, strerror(err));
+    }
+
+    /* All IDs are resolved with one call instead of one call each. */
+    err = sss_nss_getsidbyid_multi(ids, id_types, num, &sids, &types);
+    if (err != 0) {
+        ctx_set_error(ctx, strerror(err));
+        for (i = 0; i < num; ++i) {
+            csid[i].revision = 0;
+        }
+        goto done;
+    }
+
+    for (i = 0; i < num; ++i) {
+        if (sids[i] == NULL) {
+            ctx_set_error(ctx, strerror(ENOENT));
             csid[i].revision = 0;
             /* FIXME: would it be safe to map *any* uid/gids unknown by sssd to
              * SAMBA's UNIX SIDs? */
             continue;
         }
 
-        if (sid_to_cifs_sid(ctx, sid, csid) == 0)
+        if (sid_to_cifs_sid(ctx, sids[i], &csid[i]) == 0)
             success = 0;
         else
             csid[i].revision = 0;
-        free(sid);
+        free(sids[i]);
     }
 
+done:
+    free(sids);
+    free(types);
+    free(ids);
+    free(id_types);
+
     return success;
 }
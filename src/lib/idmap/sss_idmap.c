@@ -151,6 +151,298 @@ static bool id_is_in_range(uint32_t id,
     return false;
 }
 
+/* Domains sharing a domain SID, i.e. the primary and secondary slices
+ * of one domain, in the order of the domain list. */
+struct idmap_sid_group {
+    const char *sid;
+    size_t sid_len;
+    uint32_t hash;
+
+    struct idmap_domain_info **doms;
+    size_t count;
+
+    /* the same domains sorted by first RID, only if the RID ranges do not
+     * overlap and none of the domains uses external mapping */
+    struct idmap_domain_info **by_rid;
+};
+
+struct idmap_index {
+    /* all domains sorted by the first ID, NULL if ID ranges overlap */
+    struct idmap_domain_info **by_id;
+    size_t num_doms;
+
+    struct idmap_sid_group *groups;
+    size_t num_groups;
+
+    /* open addressing hash of the groups, index + 1, 0 if empty */
+    size_t *buckets;
+    size_t num_buckets;
+
+    /* storage of by_id and of the domain pointers of all groups */
+    struct idmap_domain_info **storage;
+};
+
+static void idmap_index_free(struct sss_idmap_ctx *ctx)
+{
+    struct idmap_index *index = ctx->index;
+
+    if (index == NULL) {
+        return;
+    }
+
+    ctx->free_func(index->storage, ctx->alloc_pvt);
+    ctx->free_func(index->groups, ctx->alloc_pvt);
+    ctx->free_func(index->buckets, ctx->alloc_pvt);
+    ctx->free_func(index, ctx->alloc_pvt);
+
+    ctx->index = NULL;
+}
+
+static uint32_t idmap_sid_hash(const char *sid, size_t len)
+{
+    return murmurhash3(sid, len, 0xdeadbeef);
+}
+
+static struct idmap_sid_group *idmap_index_find_sid(struct idmap_index *index,
+                                                    const char *sid,
+                                                    size_t len,
+                                                    uint32_t hash)
+{
+    struct idmap_sid_group *group;
+    size_t b;
+
+    for (b = hash & (index->num_buckets - 1);
+         index->buckets[b] != 0;
+         b = (b + 1) & (index->num_buckets - 1)) {
+        group = &index->groups[index->buckets[b] - 1];
+        if (group->hash == hash && group->sid_len == len
+                && strncmp(group->sid, sid, len) == 0) {
+            return group;
+        }
+    }
+
+    return NULL;
+}
+
+static int idmap_cmp_min_id(const void *a, const void *b)
+{
+    const struct idmap_domain_info *da = *(struct idmap_domain_info **)a;
+    const struct idmap_domain_info *db = *(struct idmap_domain_info **)b;
+
+    if (da->range_params.min_id < db->range_params.min_id) {
+        return -1;
+    }
+
+    return da->range_params.min_id > db->range_params.min_id ? 1 : 0;
+}
+
+static int idmap_cmp_first_rid(const void *a, const void *b)
+{
+    const struct idmap_domain_info *da = *(struct idmap_domain_info **)a;
+    const struct idmap_domain_info *db = *(struct idmap_domain_info **)b;
+
+    if (da->range_params.first_rid < db->range_params.first_rid) {
+        return -1;
+    }
+
+    return da->range_params.first_rid > db->range_params.first_rid ? 1 : 0;
+}
+
+/* Sorts the domains of a group by RID, keeps by_rid NULL if a RID would
+ * belong to more than one of them. */
+static void idmap_index_sort_group(struct idmap_sid_group *group,
+                                   struct idmap_domain_info **storage)
+{
+    uint64_t last_rid = 0;
+    size_t i;
+
+    for (i = 0; i < group->count; i++) {
+        if (group->doms[i]->external_mapping) {
+            return;
+        }
+    }
+
+    memcpy(storage, group->doms, group->count * sizeof(*storage));
+    qsort(storage, group->count, sizeof(*storage), idmap_cmp_first_rid);
+
+    for (i = 0; i < group->count; i++) {
+        if (i > 0 && storage[i]->range_params.first_rid <= last_rid) {
+            return;
+        }
+        last_rid = (uint64_t)storage[i]->range_params.first_rid
+                       + (storage[i]->range_params.max_id
+                              - storage[i]->range_params.min_id);
+    }
+
+    group->by_rid = storage;
+}
+
+static enum idmap_error_code idmap_index_build(struct sss_idmap_ctx *ctx,
+                                               struct idmap_index *index)
+{
+    struct idmap_domain_info *dom;
+    struct idmap_sid_group *group;
+    struct idmap_domain_info **storage;
+    uint64_t last_id = 0;
+    size_t offset;
+    size_t len;
+    uint32_t hash;
+    size_t b;
+    size_t i;
+
+    for (dom = ctx->idmap_domain_info; dom != NULL; dom = dom->next) {
+        index->num_doms++;
+    }
+
+    index->num_buckets = 8;
+    while (index->num_buckets < 2 * index->num_doms) {
+        index->num_buckets *= 2;
+    }
+
+    /* by_id, the groups in list order and the groups sorted by RID */
+    index->storage = ctx->alloc_func(3 * (index->num_doms + 1)
+                                       * sizeof(struct idmap_domain_info *),
+                                     ctx->alloc_pvt);
+    index->groups = ctx->alloc_func((index->num_doms + 1)
+                                      * sizeof(struct idmap_sid_group),
+                                    ctx->alloc_pvt);
+    index->buckets = ctx->alloc_func(index->num_buckets * sizeof(size_t),
+                                     ctx->alloc_pvt);
+    if (index->storage == NULL || index->groups == NULL
+            || index->buckets == NULL) {
+        return IDMAP_OUT_OF_MEMORY;
+    }
+    memset(index->buckets, 0, index->num_buckets * sizeof(size_t));
+
+    index->by_id = index->storage;
+    storage = index->storage + index->num_doms + 1;
+
+    /* count the domains of each SID */
+    for (dom = ctx->idmap_domain_info; dom != NULL; dom = dom->next) {
+        if (dom->sid == NULL) {
+            continue;
+        }
+
+        len = strlen(dom->sid);
+        hash = idmap_sid_hash(dom->sid, len);
+        group = idmap_index_find_sid(index, dom->sid, len, hash);
+        if (group == NULL) {
+            group = &index->groups[index->num_groups];
+            index->num_groups++;
+
+            group->sid = dom->sid;
+            group->sid_len = len;
+            group->hash = hash;
+            group->count = 0;
+            group->by_rid = NULL;
+
+            for (b = hash & (index->num_buckets - 1);
+                 index->buckets[b] != 0;
+                 b = (b + 1) & (index->num_buckets - 1));
+            index->buckets[b] = index->num_groups;
+        }
+        group->count++;
+    }
+
+    offset = 0;
+    for (i = 0; i < index->num_groups; i++) {
+        index->groups[i].doms = storage + offset;
+        offset += index->groups[i].count;
+        index->groups[i].count = 0;
+    }
+
+    /* fill them in the order of the list and sort the domains by ID */
+    i = 0;
+    for (dom = ctx->idmap_domain_info; dom != NULL; dom = dom->next) {
+        index->by_id[i++] = dom;
+
+        if (dom->sid == NULL) {
+            continue;
+        }
+
+        len = strlen(dom->sid);
+        group = idmap_index_find_sid(index, dom->sid, len,
+                                     idmap_sid_hash(dom->sid, len));
+        group->doms[group->count++] = dom;
+    }
+
+    for (i = 0; i < index->num_groups; i++) {
+        idmap_index_sort_group(&index->groups[i],
+                               index->groups[i].doms + index->num_doms + 1);
+    }
+
+    qsort(index->by_id, index->num_doms, sizeof(*index->by_id),
+          idmap_cmp_min_id);
+
+    for (i = 0; i < index->num_doms; i++) {
+        if (i > 0 && index->by_id[i]->range_params.min_id <= last_id) {
+            /* the first matching domain in the list order would win */
+            index->by_id = NULL;
+            break;
+        }
+        last_id = index->by_id[i]->range_params.max_id;
+    }
+
+    return IDMAP_SUCCESS;
+}
+
+/* Returns the lookup index, NULL if it cannot be built, in which case the
+ * domain list has to be searched. */
+static struct idmap_index *idmap_index_get(struct sss_idmap_ctx *ctx)
+{
+    struct idmap_index *index;
+    enum idmap_error_code err;
+
+    if (ctx->index != NULL) {
+        return ctx->index;
+    }
+
+    index = ctx->alloc_func(sizeof(struct idmap_index), ctx->alloc_pvt);
+    if (index == NULL) {
+        return NULL;
+    }
+    memset(index, 0, sizeof(struct idmap_index));
+    ctx->index = index;
+
+    err = idmap_index_build(ctx, index);
+    if (err != IDMAP_SUCCESS) {
+        idmap_index_free(ctx);
+        return NULL;
+    }
+
+    return index;
+}
+
+static struct idmap_domain_info *idmap_index_find_id(struct idmap_index *index,
+                                                     uint32_t id)
+{
+    struct idmap_domain_info *dom;
+    size_t lo = 0;
+    size_t hi = index->num_doms;
+    size_t mid;
+
+    /* find the last domain starting at or below id */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (index->by_id[mid]->range_params.min_id <= id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == 0) {
+        return NULL;
+    }
+
+    dom = index->by_id[lo - 1];
+    if (id_is_in_range(id, &dom->range_params, NULL)) {
+        return dom;
+    }
+
+    return NULL;
+}
+
 const char *idmap_error_string(enum idmap_error_code err)
 {
     switch (err) {
@@ -335,6 +627,7 @@ enum idmap_error_code sss_idmap_free(struct sss_idmap_ctx *ctx)
         sss_idmap_free_domain(ctx, dom);
     }
 
+    idmap_index_free(ctx);
     ctx->free_func(ctx, ctx->alloc_pvt);
 
     return IDMAP_SUCCESS;
@@ -795,6 +1088,7 @@ enum idmap_error_code sss_idmap_add_domain_ex(struct sss_idmap_ctx *ctx,
 
     dom->next = ctx->idmap_domain_info;
     ctx->idmap_domain_info = dom;
+    idmap_index_free(ctx);
 
     return IDMAP_SUCCESS;
 
@@ -1078,12 +1372,93 @@ done:
     return err;
 }
 
+static enum idmap_error_code
+sid_to_unix_indexed(struct sss_idmap_ctx *ctx,
+                    struct idmap_index *index,
+                    const char *sid,
+                    uint32_t *_id)
+{
+    struct idmap_sid_group *group = NULL;
+    struct idmap_domain_info *matched_dom;
+    size_t lo;
+    size_t hi;
+    size_t mid;
+    size_t len;
+    size_t dom_len;
+    long long rid;
+    size_t i;
+
+    /* find the longest domain SID the SID starts with */
+    len = strlen(sid);
+    for (dom_len = len; dom_len > 0; dom_len--) {
+        if (sid[dom_len] != '-') {
+            continue;
+        }
+
+        group = idmap_index_find_sid(index, sid, dom_len,
+                                     idmap_sid_hash(sid, dom_len));
+        if (group != NULL) {
+            break;
+        }
+    }
+
+    if (group == NULL) {
+        return IDMAP_NO_DOMAIN;
+    }
+
+    if (group->doms[0]->external_mapping == true) {
+        return IDMAP_EXTERNAL;
+    }
+
+    if (parse_rid(sid, dom_len, &rid) == false) {
+        return IDMAP_SID_INVALID;
+    }
+
+    if (group->by_rid != NULL) {
+        /* find the last slice starting at or below rid */
+        lo = 0;
+        hi = group->count;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (group->by_rid[mid]->range_params.first_rid <= rid) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (lo > 0 && comp_id(&group->by_rid[lo - 1]->range_params,
+                              rid, _id)) {
+            return IDMAP_SUCCESS;
+        }
+    } else {
+        for (i = 0; i < group->count; i++) {
+            if (group->doms[i]->external_mapping == true) {
+                return IDMAP_EXTERNAL;
+            }
+
+            if (comp_id(&group->doms[i]->range_params, rid, _id)) {
+                return IDMAP_SUCCESS;
+            }
+        }
+    }
+
+    /* the list is searched the same way, the last match is the oldest */
+    matched_dom = group->doms[group->count - 1];
+    if (matched_dom->auto_add_ranges) {
+        return add_dom_for_sid(ctx, matched_dom, sid, _id);
+    }
+
+    return IDMAP_NO_RANGE;
+}
+
 enum idmap_error_code sss_idmap_sid_to_unix(struct sss_idmap_ctx *ctx,
                                             const char *sid,
                                             uint32_t *_id)
 {
     struct idmap_domain_info *idmap_domain_info;
     struct idmap_domain_info *matched_dom = NULL;
+    struct idmap_index *index;
     size_t dom_len;
     long long rid;
 
@@ -1099,6 +1474,11 @@ enum idmap_error_code sss_idmap_sid_to_unix(struct sss_idmap_ctx *ctx,
         return IDMAP_BUILTIN_SID;
     }
 
+    index = idmap_index_get(ctx);
+    if (index != NULL) {
+        return sid_to_unix_indexed(ctx, index, sid, _id);
+    }
+
     /* Try primary slices */
     while (idmap_domain_info != NULL) {
 
@@ -1129,6 +1509,27 @@ enum idmap_error_code sss_idmap_sid_to_unix(struct sss_idmap_ctx *ctx,
     return matched_dom ? IDMAP_NO_RANGE : IDMAP_NO_DOMAIN;
 }
 
+enum idmap_error_code sss_idmap_sids_to_unix(struct sss_idmap_ctx *ctx,
+                                             const char **sids,
+                                             size_t count,
+                                             uint32_t *ids,
+                                             enum idmap_error_code *errs)
+{
+    size_t i;
+
+    if (sids == NULL || ids == NULL || errs == NULL) {
+        return IDMAP_ERROR;
+    }
+
+    CHECK_IDMAP_CTX(ctx, IDMAP_CONTEXT_INVALID);
+
+    for (i = 0; i < count; i++) {
+        errs[i] = sss_idmap_sid_to_unix(ctx, sids[i], &ids[i]);
+    }
+
+    return IDMAP_SUCCESS;
+}
+
 enum idmap_error_code sss_idmap_check_sid_unix(struct sss_idmap_ctx *ctx,
                                                const char *sid,
                                                uint32_t id)
@@ -1208,15 +1609,17 @@ enum idmap_error_code sss_idmap_unix_to_sid(struct sss_idmap_ctx *ctx,
                                             char **_sid)
 {
     struct idmap_domain_info *idmap_domain_info;
+    struct idmap_index *index;
     uint32_t rid;
     enum idmap_error_code err;
 
     CHECK_IDMAP_CTX(ctx, IDMAP_CONTEXT_INVALID);
 
-    idmap_domain_info = ctx->idmap_domain_info;
-
-    while (idmap_domain_info != NULL) {
-        if (id_is_in_range(id, &idmap_domain_info->range_params, &rid)) {
+    index = idmap_index_get(ctx);
+    if (index != NULL && index->by_id != NULL) {
+        idmap_domain_info = idmap_index_find_id(index, id);
+        if (idmap_domain_info != NULL) {
+            id_is_in_range(id, &idmap_domain_info->range_params, &rid);
 
             if (idmap_domain_info->external_mapping == true
                     || idmap_domain_info->sid == NULL) {
@@ -1225,8 +1628,22 @@ enum idmap_error_code sss_idmap_unix_to_sid(struct sss_idmap_ctx *ctx,
 
             return generate_sid(ctx, idmap_domain_info->sid, rid, _sid);
         }
+    } else {
+        idmap_domain_info = ctx->idmap_domain_info;
 
-        idmap_domain_info = idmap_domain_info->next;
+        while (idmap_domain_info != NULL) {
+            if (id_is_in_range(id, &idmap_domain_info->range_params, &rid)) {
+
+                if (idmap_domain_info->external_mapping == true
+                        || idmap_domain_info->sid == NULL) {
+                    return IDMAP_EXTERNAL;
+                }
+
+                return generate_sid(ctx, idmap_domain_info->sid, rid, _sid);
+            }
+
+            idmap_domain_info = idmap_domain_info->next;
+        }
     }
 
     /* Check secondary ranges. */
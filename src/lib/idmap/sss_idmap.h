@@ -441,6 +441,30 @@ enum idmap_error_code sss_idmap_sid_to_unix(struct sss_idmap_ctx *ctx,
                                             const char *sid,
                                             uint32_t *id);
 
+/**
+ * @brief Translate a list of SIDs to unix UIDs or GIDs
+ *
+ * Each SID is translated as by sss_idmap_sid_to_unix(), the result of every
+ * translation is returned in the matching element of errs.
+ *
+ * @param[in] ctx   Idmap context
+ * @param[in] sids  Array of zero-terminated string representations of SIDs
+ * @param[in] count Number of elements of sids
+ * @param[out] ids  Array of count elements for the returned unix UIDs or
+ *                  GIDs, only set where errs is #IDMAP_SUCCESS
+ * @param[out] errs Array of count elements for the results of the single
+ *                  translations
+ *
+ * @return
+ *  - #IDMAP_SUCCESS:       The SIDs were processed, see errs for the results
+ *  - #IDMAP_ERROR:         Missing argument
+ */
+enum idmap_error_code sss_idmap_sids_to_unix(struct sss_idmap_ctx *ctx,
+                                             const char **sids,
+                                             size_t count,
+                                             uint32_t *ids,
+                                             enum idmap_error_code *errs);
+
 /**
  * @brief Translate a SID stucture to a unix UID or GID
  *
@@ -54,12 +54,18 @@ struct sss_idmap_opts {
     int extra_slice_init;
 };
 
+struct idmap_index;
+
 struct sss_idmap_ctx {
     idmap_alloc_func *alloc_func;
     void *alloc_pvt;
     idmap_free_func *free_func;
     struct sss_idmap_opts idmap_opts;
     struct idmap_domain_info *idmap_domain_info;
+
+    /* lookup index of idmap_domain_info, built on first use after the
+     * list changed, see idmap_index_get() */
+    struct idmap_index *index;
 };
 
 /* This is a copy of the definition in the samba gen_ndr/security.h header
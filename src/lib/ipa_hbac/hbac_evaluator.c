@@ -142,71 +142,93 @@ enum hbac_eval_result_int hbac_evaluate_rule(struct hbac_rule *rule,
                                              struct hbac_eval_req *hbac_req,
                                              enum hbac_error_code *error);
 
+static bool hbac_info_new(struct hbac_info **info)
+{
+    if (info) {
+        *info = malloc(sizeof(struct hbac_info));
+        if (!*info) {
+            HBAC_DEBUG(HBAC_DBG_ERROR, "Out of memory.\n");
+            return false;
+        }
+        (*info)->code = HBAC_ERROR_UNKNOWN;
+        (*info)->rule_name = NULL;
+    }
+
+    return true;
+}
+
+/* Returns true if the evaluation is finished with this rule, the result
+ * is stored in *result then.
+ */
+static bool hbac_evaluate_next_rule(struct hbac_rule *rule,
+                                    struct hbac_eval_req *hbac_req,
+                                    struct hbac_info **info,
+                                    enum hbac_eval_result *result)
+{
+    enum hbac_error_code ret;
+    enum hbac_eval_result_int intermediate_result;
+
+    hbac_rule_debug_print(rule);
+    intermediate_result = hbac_evaluate_rule(rule, hbac_req, &ret);
+    if (intermediate_result == HBAC_EVAL_UNMATCHED) {
+        /* This rule did not match at all. Skip it */
+        HBAC_DEBUG(HBAC_DBG_INFO, "The rule [%s] did not match.\n",
+                   rule->name);
+        return false;
+    } else if (intermediate_result == HBAC_EVAL_MATCHED) {
+        HBAC_DEBUG(HBAC_DBG_INFO, "ALLOWED by rule [%s].\n", rule->name);
+        *result = HBAC_EVAL_ALLOW;
+        if (info) {
+            (*info)->code = HBAC_SUCCESS;
+            (*info)->rule_name = strdup(rule->name);
+            if (!(*info)->rule_name) {
+                HBAC_DEBUG(HBAC_DBG_ERROR, "Out of memory.\n");
+                *result = HBAC_EVAL_ERROR;
+                (*info)->code = HBAC_ERROR_OUT_OF_MEMORY;
+            }
+        }
+        return true;
+    }
+
+    /* An error occurred processing this rule */
+    HBAC_DEBUG(HBAC_DBG_ERROR,
+               "Error %d occurred during evaluating of rule [%s].\n",
+               ret, rule->name);
+    *result = HBAC_EVAL_ERROR;
+    if (info) {
+        (*info)->code = ret;
+        (*info)->rule_name = strdup(rule->name);
+    }
+    /* Explicitly not checking the result of strdup(), since if
+     * it's NULL, we can't do anything anyway.
+     */
+    return true;
+}
+
 enum hbac_eval_result hbac_evaluate(struct hbac_rule **rules,
                                     struct hbac_eval_req *hbac_req,
                                     struct hbac_info **info)
 {
     uint32_t i;
 
-    enum hbac_error_code ret;
     enum hbac_eval_result result = HBAC_EVAL_DENY;
-    enum hbac_eval_result_int intermediate_result;
 
     HBAC_DEBUG(HBAC_DBG_INFO, "[< hbac_evaluate()\n");
     hbac_req_debug_print(hbac_req);
 
-    if (info) {
-        *info = malloc(sizeof(struct hbac_info));
-        if (!*info) {
-            HBAC_DEBUG(HBAC_DBG_ERROR, "Out of memory.\n");
-            return HBAC_EVAL_OOM;
-        }
-        (*info)->code = HBAC_ERROR_UNKNOWN;
-        (*info)->rule_name = NULL;
+    if (!hbac_info_new(info)) {
+        return HBAC_EVAL_OOM;
     }
 
     for (i = 0; rules[i]; i++) {
-        hbac_rule_debug_print(rules[i]);
-        intermediate_result = hbac_evaluate_rule(rules[i], hbac_req, &ret);
-        if (intermediate_result == HBAC_EVAL_UNMATCHED) {
-            /* This rule did not match at all. Skip it */
-            HBAC_DEBUG(HBAC_DBG_INFO, "The rule [%s] did not match.\n",
-                       rules[i]->name);
-            continue;
-        } else if (intermediate_result == HBAC_EVAL_MATCHED) {
-            HBAC_DEBUG(HBAC_DBG_INFO, "ALLOWED by rule [%s].\n", rules[i]->name);
-            result = HBAC_EVAL_ALLOW;
-            if (info) {
-                (*info)->code = HBAC_SUCCESS;
-                (*info)->rule_name = strdup(rules[i]->name);
-                if (!(*info)->rule_name) {
-                    HBAC_DEBUG(HBAC_DBG_ERROR, "Out of memory.\n");
-                    result = HBAC_EVAL_ERROR;
-                    (*info)->code = HBAC_ERROR_OUT_OF_MEMORY;
-                }
-            }
+        if (hbac_evaluate_next_rule(rules[i], hbac_req, info, &result)) {
             break;
-        } else {
-            /* An error occurred processing this rule */
-            HBAC_DEBUG(HBAC_DBG_ERROR,
-                       "Error %d occurred during evaluating of rule [%s].\n",
-                       ret, rules[i]->name);
-            result = HBAC_EVAL_ERROR;
-            if (info) {
-                (*info)->code = ret;
-                (*info)->rule_name = strdup(rules[i]->name);
-            }
-            /* Explicitly not checking the result of strdup(), since if
-             * it's NULL, we can't do anything anyway.
-             */
-            goto done;
         }
     }
 
     /* If we've reached the end of the loop, we have either set the
      * result to ALLOW explicitly or we'll stick with the default DENY.
      */
-done:
 
     HBAC_DEBUG(HBAC_DBG_INFO, "hbac_evaluate() >]\n");
     return result;
@@ -356,6 +378,439 @@ static errno_t hbac_evaluate_element(struct hbac_rule_element *rule_el,
     return EOK;
 }
 
+/* Rule elements covered by the index of the compiled rules. Source hosts
+ * are left to hbac_evaluate_rule(), they are not used by IPA anymore.
+ */
+enum hbac_index_element {
+    HBAC_INDEX_SERVICES,
+    HBAC_INDEX_USERS,
+    HBAC_INDEX_TARGETHOSTS,
+    HBAC_INDEX_ELEMENTS
+};
+
+#define HBAC_INDEX_ALL ((1 << HBAC_INDEX_ELEMENTS) - 1)
+#define HBAC_INDEX_MIN_BUCKETS 64
+
+/* The key kind is the element times two, plus one for group names */
+#define HBAC_INDEX_KIND(element, is_group) ((element) * 2 + ((is_group) ? 1 : 0))
+
+/* A case folded name, interned for all rules, with the positions of the
+ * rules using it in ascending order.
+ */
+struct hbac_index_key {
+    struct hbac_index_key *next;
+    unsigned int kind;
+    uint8_t *folded;
+
+    size_t num_rules;
+    size_t max_rules;
+    size_t *rules;
+};
+
+struct hbac_compiled_rules {
+    struct hbac_rule **rules;
+    size_t num_rules;
+
+    /* For each rule the bitmask of the elements in which the rule is a
+     * candidate for every request, e.g. because of HBAC_CATEGORY_ALL.
+     */
+    unsigned char *always;
+
+    size_t num_buckets;
+    struct hbac_index_key **buckets;
+};
+
+static size_t hbac_index_bucket(struct hbac_compiled_rules *compiled,
+                                unsigned int kind,
+                                const uint8_t *folded)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+
+    hash = (hash ^ kind) * 16777619U;
+    for (; *folded != '\0'; folded++) {
+        hash = (hash ^ *folded) * 16777619U;
+    }
+
+    return hash & (compiled->num_buckets - 1);
+}
+
+static struct hbac_index_key *
+hbac_index_lookup(struct hbac_compiled_rules *compiled,
+                  unsigned int kind,
+                  const uint8_t *folded,
+                  size_t *_bucket)
+{
+    struct hbac_index_key *key;
+    size_t bucket;
+
+    bucket = hbac_index_bucket(compiled, kind, folded);
+    if (_bucket != NULL) {
+        *_bucket = bucket;
+    }
+
+    for (key = compiled->buckets[bucket]; key != NULL; key = key->next) {
+        if (key->kind == kind
+                && strcmp((const char *)key->folded,
+                          (const char *)folded) == 0) {
+            return key;
+        }
+    }
+
+    return NULL;
+}
+
+/* Adds the rule at position rule_idx to the key of name. If the name cannot
+ * be folded, *_indexed is set to false and the rule is not added.
+ */
+static enum hbac_error_code
+hbac_index_add(struct hbac_compiled_rules *compiled,
+               unsigned int kind,
+               const char *name,
+               size_t rule_idx,
+               bool *_indexed)
+{
+    struct hbac_index_key *key;
+    uint8_t *folded;
+    size_t *rules;
+    size_t bucket;
+    errno_t ret;
+
+    ret = sss_utf8_case_fold((const uint8_t *)name, &folded);
+    if (ret == ENOMEM) {
+        return HBAC_ERROR_OUT_OF_MEMORY;
+    } else if (ret != EOK) {
+        HBAC_DEBUG(HBAC_DBG_TRACE, "Cannot fold [%s], rule [%s] is not "
+                   "indexed.\n", name, compiled->rules[rule_idx]->name);
+        *_indexed = false;
+        return HBAC_SUCCESS;
+    }
+
+    key = hbac_index_lookup(compiled, kind, folded, &bucket);
+    if (key == NULL) {
+        key = calloc(1, sizeof(struct hbac_index_key));
+        if (key == NULL) {
+            free(folded);
+            return HBAC_ERROR_OUT_OF_MEMORY;
+        }
+        key->kind = kind;
+        key->folded = folded;
+        key->next = compiled->buckets[bucket];
+        compiled->buckets[bucket] = key;
+    } else {
+        free(folded);
+    }
+
+    *_indexed = true;
+
+    if (key->num_rules > 0 && key->rules[key->num_rules - 1] == rule_idx) {
+        /* Listed twice in the same rule */
+        return HBAC_SUCCESS;
+    }
+
+    if (key->num_rules == key->max_rules) {
+        rules = realloc(key->rules, (key->max_rules ? key->max_rules * 2 : 4)
+                                    * sizeof(size_t));
+        if (rules == NULL) {
+            return HBAC_ERROR_OUT_OF_MEMORY;
+        }
+        key->rules = rules;
+        key->max_rules = key->max_rules ? key->max_rules * 2 : 4;
+    }
+
+    key->rules[key->num_rules] = rule_idx;
+    key->num_rules++;
+
+    return HBAC_SUCCESS;
+}
+
+static enum hbac_error_code
+hbac_index_element(struct hbac_compiled_rules *compiled,
+                   enum hbac_index_element element,
+                   struct hbac_rule_element *rule_el,
+                   size_t rule_idx,
+                   bool *_indexed)
+{
+    enum hbac_error_code ret;
+    size_t i;
+
+    *_indexed = true;
+
+    if (rule_el->category & HBAC_CATEGORY_ALL) {
+        compiled->always[rule_idx] |= 1 << element;
+        return HBAC_SUCCESS;
+    }
+
+    for (i = 0; rule_el->names && rule_el->names[i]; i++) {
+        ret = hbac_index_add(compiled, HBAC_INDEX_KIND(element, false),
+                             rule_el->names[i], rule_idx, _indexed);
+        if (ret != HBAC_SUCCESS || !*_indexed) {
+            return ret;
+        }
+    }
+
+    for (i = 0; rule_el->groups && rule_el->groups[i]; i++) {
+        ret = hbac_index_add(compiled, HBAC_INDEX_KIND(element, true),
+                             rule_el->groups[i], rule_idx, _indexed);
+        if (ret != HBAC_SUCCESS || !*_indexed) {
+            return ret;
+        }
+    }
+
+    return HBAC_SUCCESS;
+}
+
+static size_t hbac_count_names(struct hbac_rule_element *rule_el)
+{
+    size_t count = 0;
+    size_t i;
+
+    if (rule_el == NULL) {
+        return 0;
+    }
+
+    for (i = 0; rule_el->names && rule_el->names[i]; i++) {
+        count++;
+    }
+
+    for (i = 0; rule_el->groups && rule_el->groups[i]; i++) {
+        count++;
+    }
+
+    return count;
+}
+
+enum hbac_error_code hbac_compile_rules(struct hbac_rule **rules,
+                                        struct hbac_compiled_rules **_compiled)
+{
+    struct hbac_compiled_rules *compiled;
+    struct hbac_rule_element *elements[HBAC_INDEX_ELEMENTS];
+    enum hbac_error_code ret;
+    size_t num_names = 0;
+    bool indexed;
+    size_t i;
+    int e;
+
+    compiled = calloc(1, sizeof(struct hbac_compiled_rules));
+    if (compiled == NULL) {
+        return HBAC_ERROR_OUT_OF_MEMORY;
+    }
+    compiled->rules = rules;
+
+    for (i = 0; rules[i]; i++) {
+        num_names += hbac_count_names(rules[i]->services)
+                     + hbac_count_names(rules[i]->users)
+                     + hbac_count_names(rules[i]->targethosts);
+    }
+    compiled->num_rules = i;
+
+    compiled->num_buckets = HBAC_INDEX_MIN_BUCKETS;
+    while (compiled->num_buckets < num_names) {
+        compiled->num_buckets *= 2;
+    }
+
+    compiled->always = calloc(compiled->num_rules + 1, sizeof(unsigned char));
+    compiled->buckets = calloc(compiled->num_buckets,
+                               sizeof(struct hbac_index_key *));
+    if (compiled->always == NULL || compiled->buckets == NULL) {
+        ret = HBAC_ERROR_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    for (i = 0; i < compiled->num_rules; i++) {
+        if (!rules[i]->enabled) {
+            /* Never a candidate */
+            continue;
+        }
+
+        if (!rules[i]->users
+                || !rules[i]->services
+                || !rules[i]->targethosts
+                || !rules[i]->srchosts) {
+            /* Always a candidate, so hbac_evaluate_rule() reports it */
+            compiled->always[i] = HBAC_INDEX_ALL;
+            continue;
+        }
+
+        elements[HBAC_INDEX_SERVICES] = rules[i]->services;
+        elements[HBAC_INDEX_USERS] = rules[i]->users;
+        elements[HBAC_INDEX_TARGETHOSTS] = rules[i]->targethosts;
+
+        for (e = 0; e < HBAC_INDEX_ELEMENTS; e++) {
+            ret = hbac_index_element(compiled, e, elements[e], i, &indexed);
+            if (ret != HBAC_SUCCESS) {
+                goto done;
+            }
+
+            if (!indexed) {
+                /* Leave the names hbac_evaluate_rule() might fail on to
+                 * hbac_evaluate_rule() to get the same result. */
+                compiled->always[i] = HBAC_INDEX_ALL;
+                break;
+            }
+        }
+    }
+
+    HBAC_DEBUG(HBAC_DBG_TRACE, "Compiled %lu rules.\n",
+               (unsigned long)compiled->num_rules);
+
+    *_compiled = compiled;
+    ret = HBAC_SUCCESS;
+
+done:
+    if (ret != HBAC_SUCCESS) {
+        HBAC_DEBUG(HBAC_DBG_ERROR, "Cannot compile the rules [%d].\n", ret);
+        hbac_free_compiled_rules(compiled);
+    }
+
+    return ret;
+}
+
+static errno_t hbac_mark_candidates(struct hbac_compiled_rules *compiled,
+                                    unsigned int kind,
+                                    const char *name,
+                                    unsigned char bit,
+                                    unsigned char *candidates)
+{
+    struct hbac_index_key *key;
+    uint8_t *folded;
+    size_t i;
+    errno_t ret;
+
+    if (name == NULL) {
+        return EOK;
+    }
+
+    ret = sss_utf8_case_fold((const uint8_t *)name, &folded);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    key = hbac_index_lookup(compiled, kind, folded, NULL);
+    free(folded);
+    if (key == NULL) {
+        return EOK;
+    }
+
+    for (i = 0; i < key->num_rules; i++) {
+        candidates[key->rules[i]] |= bit;
+    }
+
+    return EOK;
+}
+
+static errno_t hbac_find_candidates(struct hbac_compiled_rules *compiled,
+                                    struct hbac_eval_req *hbac_req,
+                                    unsigned char *candidates)
+{
+    struct hbac_request_element *elements[HBAC_INDEX_ELEMENTS];
+    errno_t ret;
+    size_t i;
+    int e;
+
+    elements[HBAC_INDEX_SERVICES] = hbac_req->service;
+    elements[HBAC_INDEX_USERS] = hbac_req->user;
+    elements[HBAC_INDEX_TARGETHOSTS] = hbac_req->targethost;
+
+    memcpy(candidates, compiled->always, compiled->num_rules);
+
+    for (e = 0; e < HBAC_INDEX_ELEMENTS; e++) {
+        if (elements[e] == NULL) {
+            return EINVAL;
+        }
+
+        ret = hbac_mark_candidates(compiled, HBAC_INDEX_KIND(e, false),
+                                   elements[e]->name, 1 << e, candidates);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        for (i = 0; elements[e]->groups && elements[e]->groups[i]; i++) {
+            ret = hbac_mark_candidates(compiled, HBAC_INDEX_KIND(e, true),
+                                       elements[e]->groups[i], 1 << e,
+                                       candidates);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
+    }
+
+    return EOK;
+}
+
+enum hbac_eval_result
+hbac_evaluate_compiled(struct hbac_compiled_rules *compiled,
+                       struct hbac_eval_req *hbac_req,
+                       struct hbac_info **info)
+{
+    enum hbac_eval_result result = HBAC_EVAL_DENY;
+    unsigned char *candidates;
+    errno_t ret;
+    size_t i;
+
+    candidates = malloc(compiled->num_rules + 1);
+    if (candidates == NULL) {
+        HBAC_DEBUG(HBAC_DBG_ERROR, "Out of memory.\n");
+        return HBAC_EVAL_OOM;
+    }
+
+    ret = hbac_find_candidates(compiled, hbac_req, candidates);
+    if (ret != EOK) {
+        /* Let hbac_evaluate() deal with the request */
+        HBAC_DEBUG(HBAC_DBG_TRACE, "Cannot use the index [%d].\n", ret);
+        free(candidates);
+        return hbac_evaluate(compiled->rules, hbac_req, info);
+    }
+
+    HBAC_DEBUG(HBAC_DBG_INFO, "[< hbac_evaluate_compiled()\n");
+    hbac_req_debug_print(hbac_req);
+
+    if (!hbac_info_new(info)) {
+        free(candidates);
+        return HBAC_EVAL_OOM;
+    }
+
+    /* The candidates are evaluated in the order of the rules, so the same
+     * rule as with hbac_evaluate() decides. */
+    for (i = 0; i < compiled->num_rules; i++) {
+        if (candidates[i] != HBAC_INDEX_ALL) {
+            continue;
+        }
+
+        if (hbac_evaluate_next_rule(compiled->rules[i], hbac_req, info,
+                                    &result)) {
+            break;
+        }
+    }
+
+    free(candidates);
+
+    HBAC_DEBUG(HBAC_DBG_INFO, "hbac_evaluate_compiled() >]\n");
+    return result;
+}
+
+void hbac_free_compiled_rules(struct hbac_compiled_rules *compiled)
+{
+    struct hbac_index_key *key;
+    struct hbac_index_key *next;
+    size_t i;
+
+    if (compiled == NULL) return;
+
+    for (i = 0; compiled->buckets && i < compiled->num_buckets; i++) {
+        for (key = compiled->buckets[i]; key != NULL; key = next) {
+            next = key->next;
+            free(key->folded);
+            free(key->rules);
+            free(key);
+        }
+    }
+
+    free(compiled->buckets);
+    free(compiled->always);
+    free(compiled);
+}
+
 const char *hbac_result_string(enum hbac_eval_result result)
 {
     switch (result) {
@@ -289,6 +289,56 @@ enum hbac_eval_result hbac_evaluate(struct hbac_rule **rules,
                                     struct hbac_eval_req *hbac_req,
                                     struct hbac_info **info);
 
+/** Rules prepared for #hbac_evaluate_compiled */
+struct hbac_compiled_rules;
+
+/**
+ * @brief Prepare a set of HBAC rules for repeated evaluation
+ *
+ * Builds an index of the rules by service, user and target host names and
+ * groups, so that #hbac_evaluate_compiled only has to look at the rules
+ * which can match a request.
+ *
+ * @param[in] rules     A NULL-terminated list of rules
+ * @param[out] compiled The prepared rules, free with
+ *                      #hbac_free_compiled_rules
+ * @return
+ *  - #HBAC_SUCCESS:             The rules were compiled
+ *  - #HBAC_ERROR_OUT_OF_MEMORY: Insufficient memory to compile the rules
+ *
+ * @note The rules are not copied, they must neither be freed nor modified
+ * while the compiled rules are used.
+ */
+enum hbac_error_code hbac_compile_rules(struct hbac_rule **rules,
+                                        struct hbac_compiled_rules **compiled);
+
+/**
+ * @brief Evaluate an authorization request against compiled HBAC rules
+ *
+ * The result is the same as the one of #hbac_evaluate for the rules
+ * passed to #hbac_compile_rules.
+ *
+ * @param[in] compiled Rules returned by #hbac_compile_rules
+ * @param[in] hbac_req A user authorization request
+ * @param[out] info    Extended information (including the name of the
+ *                     rule that allowed access (or caused a parse error)
+ * @return
+ *  - #HBAC_EVAL_ERROR: An error occurred
+ *  - #HBAC_EVAL_ALLOW: Access is granted
+ *  - #HBAC_EVAL_DENY:  Access is denied
+ *  - #HBAC_EVAL_OOM:   Insufficient memory to complete the evaluation
+ */
+enum hbac_eval_result
+hbac_evaluate_compiled(struct hbac_compiled_rules *compiled,
+                       struct hbac_eval_req *hbac_req,
+                       struct hbac_info **info);
+
+/**
+ * @brief Function to safely free rules returned by #hbac_compile_rules
+ * @param compiled Rules returned by #hbac_compile_rules
+ */
+void hbac_free_compiled_rules(struct hbac_compiled_rules *compiled);
+
 /**
  * @brief Display result of hbac evaluation in human-readable form
  * @param[in] result Return value of #hbac_evaluate
@@ -482,6 +482,16 @@ void
 sss_sifp_free_object(sss_sifp_ctx *ctx,
                      sss_sifp_object **_object);
 
+/**
+ * @brief Free NULL terminated array of sss_sifp objects and set it to NULL.
+ *
+ * @param[in] ctx sss_sifp context
+ * @param[in,out] _objects Objects
+ */
+void
+sss_sifp_free_objects(sss_sifp_ctx *ctx,
+                      sss_sifp_object ***_objects);
+
 /**
  * @brief Free string and set it to NULL.
  *
@@ -557,6 +567,45 @@ sss_sifp_fetch_user_by_name(sss_sifp_ctx *ctx,
                             const char *name,
                             sss_sifp_object **_user);
 
+/**
+ * @brief Fetch selected attributes of many users and groups at once.
+ *
+ * The attributes are fetched with a single D-Bus call instead of one
+ * call per object. Attribute names are cache attribute names as used by
+ * the GetUserAttr method and every value is an array of strings. Objects
+ * that are not cached are not returned, so @p _objects may be shorter
+ * than @p object_paths.
+ *
+ * @param[in] ctx          sss_sifp context
+ * @param[in] object_paths NULL terminated list of user and group paths
+ * @param[in] attrs        NULL terminated list of attribute names
+ * @param[out] _objects    NULL terminated list of objects
+ */
+sss_sifp_error
+sss_sifp_fetch_objects_attrs(sss_sifp_ctx *ctx,
+                             const char **object_paths,
+                             const char **attrs,
+                             sss_sifp_object ***_objects);
+
+/**
+ * @brief Fetch selected attributes of many users by name at once.
+ *
+ * The users are looked up with FindByName calls that are all sent before
+ * the first reply is received, then their attributes are fetched with a
+ * single call of #sss_sifp_fetch_objects_attrs. Users that do not exist
+ * are not returned, so @p _users may be shorter than @p names.
+ *
+ * @param[in] ctx     sss_sifp context
+ * @param[in] names   NULL terminated list of user names
+ * @param[in] attrs   NULL terminated list of attribute names
+ * @param[out] _users NULL terminated list of user objects
+ */
+sss_sifp_error
+sss_sifp_fetch_users_by_name(sss_sifp_ctx *ctx,
+                             const char **names,
+                             const char **attrs,
+                             sss_sifp_object ***_users);
+
 /**
  * @}
  */
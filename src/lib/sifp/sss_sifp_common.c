@@ -18,6 +18,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <string.h>
 #include <dbus/dbus.h>
 
 #include "lib/sifp/sss_sifp.h"
@@ -181,3 +182,252 @@ sss_sifp_fetch_user_by_name(sss_sifp_ctx *ctx,
                                          "org.freedesktop.sssd.infopipe.Users.User", "ByName",
                                          name, _user);
 }
+
+static unsigned int
+sss_sifp_string_array_length(const char **array)
+{
+    unsigned int i;
+
+    for (i = 0; array != NULL && array[i] != NULL; i++);
+
+    return i;
+}
+
+static sss_sifp_error
+sss_sifp_set_object_interface(sss_sifp_ctx *ctx,
+                              sss_sifp_object *object)
+{
+    const char *iface;
+
+    if (strncmp(object->object_path, IFP_PATH_USERS "/",
+                sizeof(IFP_PATH_USERS)) == 0) {
+        iface = "org.freedesktop.sssd.infopipe.Users.User";
+    } else if (strncmp(object->object_path, IFP_PATH_GROUPS "/",
+                       sizeof(IFP_PATH_GROUPS)) == 0) {
+        iface = "org.freedesktop.sssd.infopipe.Groups.Group";
+    } else {
+        return SSS_SIFP_INTERNAL_ERROR;
+    }
+
+    object->interface = sss_sifp_strdup(ctx, iface);
+    if (object->interface == NULL) {
+        return SSS_SIFP_OUT_OF_MEMORY;
+    }
+
+    return SSS_SIFP_OK;
+}
+
+sss_sifp_error
+sss_sifp_fetch_objects_attrs(sss_sifp_ctx *ctx,
+                             const char **object_paths,
+                             const char **attrs,
+                             sss_sifp_object ***_objects)
+{
+    sss_sifp_object **objects = NULL;
+    DBusMessage *msg = NULL;
+    DBusMessage *reply = NULL;
+    unsigned int num_paths;
+    unsigned int num_attrs;
+    dbus_bool_t bret;
+    sss_sifp_error ret;
+    unsigned int i;
+
+    if (ctx == NULL || object_paths == NULL || attrs == NULL
+            || _objects == NULL) {
+        return SSS_SIFP_INVALID_ARGUMENT;
+    }
+
+    num_paths = sss_sifp_string_array_length(object_paths);
+    num_attrs = sss_sifp_string_array_length(attrs);
+
+    msg = sss_sifp_create_message(SSS_SIFP_PATH, SSS_SIFP_IFACE,
+                                  "GetObjectsAttrs");
+    if (msg == NULL) {
+        ret = SSS_SIFP_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    bret = dbus_message_append_args(msg,
+                                    DBUS_TYPE_ARRAY, DBUS_TYPE_OBJECT_PATH,
+                                    &object_paths, num_paths,
+                                    DBUS_TYPE_ARRAY, DBUS_TYPE_STRING,
+                                    &attrs, num_attrs,
+                                    DBUS_TYPE_INVALID);
+    if (!bret) {
+        ret = SSS_SIFP_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    ret = sss_sifp_send_message(ctx, msg, &reply);
+    if (ret != SSS_SIFP_OK) {
+        goto done;
+    }
+
+    ret = sss_sifp_parse_object_list(ctx, reply, &objects);
+    if (ret != SSS_SIFP_OK) {
+        goto done;
+    }
+
+    for (i = 0; objects[i] != NULL; i++) {
+        ret = sss_sifp_set_object_interface(ctx, objects[i]);
+        if (ret != SSS_SIFP_OK) {
+            goto done;
+        }
+    }
+
+    *_objects = objects;
+
+    ret = SSS_SIFP_OK;
+
+done:
+    if (ret != SSS_SIFP_OK) {
+        sss_sifp_free_objects(ctx, &objects);
+    }
+
+    if (msg != NULL) {
+        dbus_message_unref(msg);
+    }
+
+    if (reply != NULL) {
+        dbus_message_unref(reply);
+    }
+
+    return ret;
+}
+
+#define SSS_SIFP_ERROR_NOT_FOUND "sbus.Error.NotFound"
+
+static sss_sifp_error
+sss_sifp_find_users_by_name(sss_sifp_ctx *ctx,
+                            const char **names,
+                            char ***_paths)
+{
+    DBusPendingCall **pending = NULL;
+    DBusMessage *msg = NULL;
+    DBusMessage *reply = NULL;
+    const char *error_name;
+    char **paths = NULL;
+    unsigned int num_names;
+    unsigned int num_sent;
+    unsigned int num_paths;
+    sss_sifp_error ret;
+    dbus_bool_t bret;
+    unsigned int i;
+
+    num_names = sss_sifp_string_array_length(names);
+
+    pending = _alloc_zero(ctx, DBusPendingCall *, num_names);
+    paths = _alloc_zero(ctx, char *, num_names + 1);
+    if (pending == NULL || paths == NULL) {
+        ret = SSS_SIFP_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* send all requests first, so they are processed in parallel */
+    ret = SSS_SIFP_OK;
+    for (num_sent = 0; num_sent < num_names; num_sent++) {
+        msg = sss_sifp_create_message(IFP_PATH_USERS,
+                                      "org.freedesktop.sssd.infopipe.Users",
+                                      "FindByName");
+        if (msg == NULL) {
+            ret = SSS_SIFP_OUT_OF_MEMORY;
+            break;
+        }
+
+        bret = dbus_message_append_args(msg, DBUS_TYPE_STRING,
+                                        &names[num_sent], DBUS_TYPE_INVALID);
+        if (!bret) {
+            ret = SSS_SIFP_OUT_OF_MEMORY;
+            break;
+        }
+
+        ret = sss_sifp_send_message_async(ctx, msg, 5000, &pending[num_sent]);
+        if (ret != SSS_SIFP_OK) {
+            break;
+        }
+
+        dbus_message_unref(msg);
+        msg = NULL;
+    }
+
+    /* the replies of the sent requests are collected even on error so no
+     * pending call is left behind */
+    num_paths = 0;
+    for (i = 0; i < num_sent; i++) {
+        if (ret != SSS_SIFP_OK) {
+            dbus_pending_call_cancel(pending[i]);
+            dbus_pending_call_unref(pending[i]);
+            continue;
+        }
+
+        ret = sss_sifp_recv_message(ctx, pending[i], &reply);
+        if (ret != SSS_SIFP_OK) {
+            error_name = sss_sifp_get_last_io_error_name(ctx);
+            if (error_name != NULL
+                    && strcmp(error_name, SSS_SIFP_ERROR_NOT_FOUND) == 0) {
+                ret = SSS_SIFP_OK;
+            }
+            continue;
+        }
+
+        ret = sss_sifp_parse_object_path(ctx, reply, &paths[num_paths]);
+        dbus_message_unref(reply);
+        if (ret == SSS_SIFP_OK) {
+            num_paths++;
+        }
+    }
+
+    if (ret != SSS_SIFP_OK) {
+        goto done;
+    }
+
+    *_paths = paths;
+
+done:
+    if (ret != SSS_SIFP_OK) {
+        sss_sifp_free_string_array(ctx, &paths);
+    }
+
+    if (msg != NULL) {
+        dbus_message_unref(msg);
+    }
+
+    if (pending != NULL) {
+        _free(ctx, pending);
+    }
+
+    return ret;
+}
+
+sss_sifp_error
+sss_sifp_fetch_users_by_name(sss_sifp_ctx *ctx,
+                             const char **names,
+                             const char **attrs,
+                             sss_sifp_object ***_users)
+{
+    char **paths = NULL;
+    sss_sifp_error ret;
+
+    if (ctx == NULL || names == NULL || attrs == NULL || _users == NULL) {
+        return SSS_SIFP_INVALID_ARGUMENT;
+    }
+
+    ret = sss_sifp_find_users_by_name(ctx, names, &paths);
+    if (ret != SSS_SIFP_OK) {
+        return ret;
+    }
+
+    if (paths[0] == NULL) {
+        /* none of the users exists */
+        *_users = _alloc_zero(ctx, sss_sifp_object *, 1);
+        ret = *_users == NULL ? SSS_SIFP_OUT_OF_MEMORY : SSS_SIFP_OK;
+        goto done;
+    }
+
+    ret = sss_sifp_fetch_objects_attrs(ctx, (const char **)paths, attrs,
+                                       _users);
+
+done:
+    sss_sifp_free_string_array(ctx, &paths);
+    return ret;
+}
@@ -120,6 +120,80 @@ done:
     return ret;
 }
 
+sss_sifp_error
+sss_sifp_send_message_async(sss_sifp_ctx *ctx,
+                            DBusMessage *msg,
+                            int timeout,
+                            DBusPendingCall **_pending)
+{
+    DBusPendingCall *pending = NULL;
+    dbus_bool_t bret;
+
+    if (ctx == NULL || msg == NULL || _pending == NULL) {
+        return SSS_SIFP_INVALID_ARGUMENT;
+    }
+
+    bret = dbus_connection_send_with_reply(ctx->conn, msg, &pending, timeout);
+    if (!bret) {
+        return SSS_SIFP_OUT_OF_MEMORY;
+    }
+
+    if (pending == NULL) {
+        /* the connection is closed */
+        return SSS_SIFP_IO_ERROR;
+    }
+
+    *_pending = pending;
+
+    return SSS_SIFP_OK;
+}
+
+sss_sifp_error
+sss_sifp_recv_message(sss_sifp_ctx *ctx,
+                      DBusPendingCall *pending,
+                      DBusMessage **_reply)
+{
+    DBusMessage *reply = NULL;
+    DBusError dbus_error;
+    sss_sifp_error ret;
+
+    if (ctx == NULL || pending == NULL) {
+        return SSS_SIFP_INVALID_ARGUMENT;
+    }
+
+    dbus_error_init(&dbus_error);
+
+    /* returns immediately if the reply is already there */
+    dbus_pending_call_block(pending);
+    reply = dbus_pending_call_steal_reply(pending);
+    dbus_pending_call_unref(pending);
+    if (reply == NULL) {
+        ret = SSS_SIFP_IO_ERROR;
+        goto done;
+    }
+
+    if (dbus_set_error_from_message(&dbus_error, reply)) {
+        sss_sifp_set_io_error(ctx, &dbus_error);
+        ret = SSS_SIFP_IO_ERROR;
+        goto done;
+    }
+
+    if (_reply != NULL) {
+        *_reply = reply;
+        reply = NULL;
+    }
+
+    ret = SSS_SIFP_OK;
+
+done:
+    if (reply != NULL) {
+        dbus_message_unref(reply);
+    }
+
+    dbus_error_free(&dbus_error);
+    return ret;
+}
+
 static sss_sifp_error
 sss_sifp_invoke_list_va(sss_sifp_ctx *ctx,
                         const char *object_path,
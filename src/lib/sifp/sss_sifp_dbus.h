@@ -84,6 +84,41 @@ sss_sifp_send_message_ex(sss_sifp_ctx *ctx,
                          int timeout,
                          DBusMessage **_reply);
 
+/**
+ * @brief Send D-Bus message to SSSD InfoPipe bus without waiting for the
+ * reply.
+ *
+ * Any number of messages can be sent before the first reply is received,
+ * SSSD then processes them in parallel. The reply is received with
+ * #sss_sifp_recv_message either right away or, when the application runs
+ * a D-Bus main loop on the system bus connection, from a notify function
+ * set with dbus_pending_call_set_notify().
+ *
+ * @param[in] ctx       sss_sifp context
+ * @param[in] msg       D-Bus message
+ * @param[in] timeout   Timeout
+ * @param[out] _pending Pending call, pass it to #sss_sifp_recv_message
+ */
+sss_sifp_error
+sss_sifp_send_message_async(sss_sifp_ctx *ctx,
+                            DBusMessage *msg,
+                            int timeout,
+                            DBusPendingCall **_pending);
+
+/**
+ * @brief Receive the reply of a message sent with
+ * #sss_sifp_send_message_async. Waits for the reply if it has not arrived
+ * yet. The pending call is released in any case.
+ *
+ * @param[in] ctx     sss_sifp context
+ * @param[in] pending Pending call
+ * @param[in] _reply  D-Bus reply, may be NULL if the caller is not interested
+ */
+sss_sifp_error
+sss_sifp_recv_message(sss_sifp_ctx *ctx,
+                      DBusPendingCall *pending,
+                      DBusMessage **_reply);
+
 /**
  * @brief List objects that satisfies given conditions. This routine will
  * invoke List<method> D-Bus method on given interface and object path. If
@@ -565,13 +565,14 @@ done:
 /**
  * DBusMessage format:
  * array of dict_entry(string:attr_name, variant:value)
+ *
+ * Iterator has to point to the array but not inside the array.
  */
-sss_sifp_error
-sss_sifp_parse_attr_list(sss_sifp_ctx *ctx,
-                         DBusMessage *msg,
+static sss_sifp_error
+sss_sifp_parse_attr_dict(sss_sifp_ctx *ctx,
+                         DBusMessageIter *iter,
                          sss_sifp_attr ***_attrs)
 {
-    DBusMessageIter iter;
     DBusMessageIter array_iter;
     DBusMessageIter dict_iter;
     sss_sifp_attr **attrs = NULL;
@@ -580,23 +581,21 @@ sss_sifp_parse_attr_list(sss_sifp_ctx *ctx,
     sss_sifp_error ret;
     unsigned int i;
 
-    dbus_message_iter_init(msg, &iter);
-
-    check_dbus_arg(&iter, DBUS_TYPE_ARRAY, ret, done);
+    check_dbus_arg(iter, DBUS_TYPE_ARRAY, ret, done);
 
-    if (dbus_message_iter_get_element_type(&iter) != DBUS_TYPE_DICT_ENTRY) {
+    if (dbus_message_iter_get_element_type(iter) != DBUS_TYPE_DICT_ENTRY) {
         ret = SSS_SIFP_INTERNAL_ERROR;
         goto done;
     }
 
-    num_values = sss_sifp_get_array_length(&iter);
+    num_values = sss_sifp_get_array_length(iter);
     attrs = _alloc_zero(ctx, sss_sifp_attr *, num_values + 1);
     if (attrs == NULL) {
         ret = SSS_SIFP_OUT_OF_MEMORY;
         goto done;
     }
 
-    dbus_message_iter_recurse(&iter, &array_iter);
+    dbus_message_iter_recurse(iter, &array_iter);
 
     for (i = 0; i < num_values; i++) {
         dbus_message_iter_recurse(&array_iter, &dict_iter);
@@ -632,6 +631,117 @@ done:
     return ret;
 }
 
+/**
+ * DBusMessage format:
+ * array of dict_entry(string:attr_name, variant:value)
+ */
+sss_sifp_error
+sss_sifp_parse_attr_list(sss_sifp_ctx *ctx,
+                         DBusMessage *msg,
+                         sss_sifp_attr ***_attrs)
+{
+    DBusMessageIter iter;
+
+    dbus_message_iter_init(msg, &iter);
+
+    return sss_sifp_parse_attr_dict(ctx, &iter, _attrs);
+}
+
+/**
+ * DBusMessage format:
+ * array of dict_entry(object_path:path,
+ *                     array of dict_entry(string:attr_name, variant:value))
+ */
+sss_sifp_error
+sss_sifp_parse_object_list(sss_sifp_ctx *ctx,
+                           DBusMessage *msg,
+                           sss_sifp_object ***_objects)
+{
+    DBusMessageIter iter;
+    DBusMessageIter array_iter;
+    DBusMessageIter dict_iter;
+    sss_sifp_object **objects = NULL;
+    sss_sifp_object *object = NULL;
+    const char * const *names = NULL;
+    const char *path = NULL;
+    unsigned int num_names;
+    unsigned int num_objects;
+    sss_sifp_error ret;
+    unsigned int i;
+
+    dbus_message_iter_init(msg, &iter);
+
+    check_dbus_arg(&iter, DBUS_TYPE_ARRAY, ret, done);
+
+    if (dbus_message_iter_get_element_type(&iter) != DBUS_TYPE_DICT_ENTRY) {
+        ret = SSS_SIFP_INTERNAL_ERROR;
+        goto done;
+    }
+
+    num_objects = sss_sifp_get_array_length(&iter);
+    objects = _alloc_zero(ctx, sss_sifp_object *, num_objects + 1);
+    if (objects == NULL) {
+        ret = SSS_SIFP_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    dbus_message_iter_recurse(&iter, &array_iter);
+
+    for (i = 0; i < num_objects; i++) {
+        dbus_message_iter_recurse(&array_iter, &dict_iter);
+
+        /* get the key */
+        check_dbus_arg(&dict_iter, DBUS_TYPE_OBJECT_PATH, ret, done);
+        dbus_message_iter_get_basic(&dict_iter, &path);
+
+        if (!dbus_message_iter_next(&dict_iter)) {
+            ret = SSS_SIFP_INTERNAL_ERROR;
+            goto done;
+        }
+
+        object = _alloc_zero(ctx, sss_sifp_object, 1);
+        if (object == NULL) {
+            ret = SSS_SIFP_OUT_OF_MEMORY;
+            goto done;
+        }
+        objects[i] = object;
+
+        object->object_path = sss_sifp_strdup(ctx, path);
+        if (object->object_path == NULL) {
+            ret = SSS_SIFP_OUT_OF_MEMORY;
+            goto done;
+        }
+
+        /* now read the attributes */
+        ret = sss_sifp_parse_attr_dict(ctx, &dict_iter, &object->attrs);
+        if (ret != SSS_SIFP_OK) {
+            goto done;
+        }
+
+        ret = sss_sifp_find_attr_as_string_array(object->attrs, "name",
+                                                 &num_names, &names);
+        if (ret == SSS_SIFP_OK && num_names > 0) {
+            object->name = sss_sifp_strdup(ctx, names[0]);
+            if (object->name == NULL) {
+                ret = SSS_SIFP_OUT_OF_MEMORY;
+                goto done;
+            }
+        }
+
+        dbus_message_iter_next(&array_iter);
+    }
+
+    *_objects = objects;
+    ret = SSS_SIFP_OK;
+
+done:
+    if (ret != SSS_SIFP_OK) {
+        sss_sifp_free_objects(ctx, &objects);
+    }
+
+    return ret;
+}
+
 sss_sifp_error
 sss_sifp_parse_object_path(sss_sifp_ctx *ctx,
                            DBusMessage *msg,
@@ -68,9 +68,12 @@ static NTSTATUS idmap_sss_unixids_to_sids(struct idmap_domain *dom,
                                           struct id_map **map)
 {
     size_t c;
+    size_t count;
     int ret;
-    char *sid_str;
-    enum sss_id_type id_type;
+    uint32_t *ids;
+    enum sss_id_type *id_types;
+    char **sid_strs = NULL;
+    enum sss_id_type *types = NULL;
     struct dom_sid *sid;
     enum idmap_error_code err;
     struct idmap_sss_ctx *ctx;
@@ -87,26 +90,49 @@ static NTSTATUS idmap_sss_unixids_to_sids(struct idmap_domain *dom,
     for (c = 0; map[c]; c++) {
         map[c]->status = ID_UNKNOWN;
     }
+    count = c;
 
-    for (c = 0; map[c]; c++) {
+    if (count == 0) {
+        return NT_STATUS_OK;
+    }
+
+    ids = talloc_array(ctx, uint32_t, count);
+    id_types = talloc_array(ctx, enum sss_id_type, count);
+    if (ids == NULL || id_types == NULL) {
+        talloc_free(ids);
+        talloc_free(id_types);
+        return NT_STATUS_NO_MEMORY;
+    }
+
+    for (c = 0; c < count; c++) {
+        ids[c] = map[c]->xid.id;
         switch (map[c]->xid.type) {
         case ID_TYPE_UID:
-            ret = sss_nss_getsidbyuid(map[c]->xid.id, &sid_str, &id_type);
+            id_types[c] = SSS_ID_TYPE_UID;
             break;
         case ID_TYPE_GID:
-            ret = sss_nss_getsidbygid(map[c]->xid.id, &sid_str, &id_type);
+            id_types[c] = SSS_ID_TYPE_GID;
             break;
         default:
-            ret = sss_nss_getsidbyid(map[c]->xid.id, &sid_str, &id_type);
+            id_types[c] = SSS_ID_TYPE_NOT_SPECIFIED;
         }
-        if (ret != 0) {
-            if (ret == ENOENT) {
-                map[c]->status = ID_UNMAPPED;
-            }
+    }
+
+    /* All IDs are resolved with one call instead of one call each. */
+    ret = sss_nss_getsidbyid_multi(ids, id_types, count, &sid_strs, &types);
+    talloc_free(ids);
+    talloc_free(id_types);
+    if (ret != 0) {
+        return NT_STATUS_OK;
+    }
+
+    for (c = 0; c < count; c++) {
+        if (sid_strs[c] == NULL) {
+            map[c]->status = ID_UNMAPPED;
             continue;
         }
 
-        switch (id_type) {
+        switch (types[c]) {
         case SSS_ID_TYPE_UID:
             map[c]->xid.type = ID_TYPE_UID;
             break;
@@ -117,12 +143,10 @@ static NTSTATUS idmap_sss_unixids_to_sids(struct idmap_domain *dom,
             map[c]->xid.type = ID_TYPE_BOTH;
             break;
         default:
-            free(sid_str);
             continue;
         }
 
-        err = sss_idmap_sid_to_smb_sid(ctx->idmap_ctx, sid_str, &sid);
-        free(sid_str);
+        err = sss_idmap_sid_to_smb_sid(ctx->idmap_ctx, sid_strs[c], &sid);
         if (err != IDMAP_SUCCESS) {
             continue;
         }
@@ -133,6 +157,12 @@ static NTSTATUS idmap_sss_unixids_to_sids(struct idmap_domain *dom,
         map[c]->status = ID_MAPPED;
     }
 
+    for (c = 0; c < count; c++) {
+        free(sid_strs[c]);
+    }
+    free(sid_strs);
+    free(types);
+
     return NT_STATUS_OK;
 }
 
@@ -140,12 +170,16 @@ static NTSTATUS idmap_sss_sids_to_unixids(struct idmap_domain *dom,
                                           struct id_map **map)
 {
     size_t c;
+    size_t count;
+    size_t num_sids;
     int ret;
-    char *sid_str;
-    enum sss_id_type id_type;
+    char **sid_strs;
+    size_t *sid_idx;
+    uint32_t *ids = NULL;
+    enum sss_id_type *types = NULL;
     enum idmap_error_code err;
     struct idmap_sss_ctx *ctx;
-    uint32_t id;
+    size_t i;
 
     if (dom == NULL) {
         return ERROR_INVALID_PARAMETER;
@@ -159,23 +193,49 @@ static NTSTATUS idmap_sss_sids_to_unixids(struct idmap_domain *dom,
     for (c = 0; map[c]; c++) {
         map[c]->status = ID_UNKNOWN;
     }
+    count = c;
 
-    for (c = 0; map[c]; c++) {
-        err = sss_idmap_smb_sid_to_sid(ctx->idmap_ctx, map[c]->sid, &sid_str);
+    if (count == 0) {
+        return NT_STATUS_OK;
+    }
+
+    sid_strs = talloc_zero_array(ctx, char *, count);
+    sid_idx = talloc_array(ctx, size_t, count);
+    if (sid_strs == NULL || sid_idx == NULL) {
+        talloc_free(sid_strs);
+        talloc_free(sid_idx);
+        return NT_STATUS_NO_MEMORY;
+    }
+
+    num_sids = 0;
+    for (c = 0; c < count; c++) {
+        err = sss_idmap_smb_sid_to_sid(ctx->idmap_ctx, map[c]->sid,
+                                       &sid_strs[num_sids]);
         if (err != IDMAP_SUCCESS) {
             continue;
         }
+        sid_idx[num_sids++] = c;
+    }
 
-        ret = sss_nss_getidbysid(sid_str, &id, &id_type);
-        sss_idmap_free_sid(ctx->idmap_ctx, sid_str);
-        if (ret != 0) {
-            if (ret == ENOENT) {
-                map[c]->status = ID_UNMAPPED;
-            }
-            continue;
-        }
+    /* All SIDs are resolved with one call instead of one call each. */
+    ret = 0;
+    if (num_sids > 0) {
+        ret = sss_nss_getidbysid_multi((const char * const *) sid_strs,
+                                       num_sids, &ids, &types);
+    }
+    for (i = 0; i < num_sids; i++) {
+        sss_idmap_free_sid(ctx->idmap_ctx, sid_strs[i]);
+    }
+    talloc_free(sid_strs);
+    if (ret != 0) {
+        talloc_free(sid_idx);
+        return NT_STATUS_OK;
+    }
 
-        switch (id_type) {
+    for (i = 0; i < num_sids; i++) {
+        c = sid_idx[i];
+
+        switch (types[i]) {
         case SSS_ID_TYPE_UID:
             map[c]->xid.type = ID_TYPE_UID;
             break;
@@ -185,15 +245,22 @@ static NTSTATUS idmap_sss_sids_to_unixids(struct idmap_domain *dom,
         case SSS_ID_TYPE_BOTH:
             map[c]->xid.type = ID_TYPE_BOTH;
             break;
+        case SSS_ID_TYPE_NOT_SPECIFIED:
+            map[c]->status = ID_UNMAPPED;
+            continue;
         default:
             continue;
         }
 
-        map[c]->xid.id = id;
+        map[c]->xid.id = ids[i];
 
         map[c]->status = ID_MAPPED;
     }
 
+    talloc_free(sid_idx);
+    free(ids);
+    free(types);
+
     return NT_STATUS_OK;
 }
 
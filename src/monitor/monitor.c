@@ -21,6 +21,7 @@
 
 #include "util/util.h"
 #include "util/child_common.h"
+#include "util/sss_prof.h"
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/time.h>
@@ -116,9 +117,14 @@ struct mt_svc {
 
     int restarts;
     time_t last_restart;
+    /* when the service process was forked, to report the startup time */
+    struct timespec start_time;
 
     int debug_level;
 
+    /* CPUs the process is bound to, NULL if it may run on all of them */
+    cpu_set_t *cpu_affinity;
+
     struct sss_child_ctx *child_ctx;
 };
 
@@ -161,6 +167,8 @@ struct mt_ctx {
     int service_id_timeout;
     bool check_children;
     bool services_started;
+    bool parallel_startup;
+    struct timespec start_time;
     struct netlink_ctx *nlctx;
     const char *conf_path;
     struct sss_sigchild_ctx *sigchld_ctx;
@@ -462,6 +470,16 @@ static int notify_startup(void)
     return EOK;
 }
 
+static long elapsed_ms(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) * 1000
+           + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
 static int mark_service_as_started(struct mt_svc *svc)
 {
     struct mt_ctx *ctx = svc->mt_ctx;
@@ -472,6 +490,12 @@ static int mark_service_as_started(struct mt_svc *svc)
     DEBUG(SSSDBG_FUNC_DATA, "Marking %s as started.\n", svc->name);
     svc->svc_started = true;
 
+    /* Socket and D-Bus activated services were not forked by us */
+    if (svc->start_time.tv_sec != 0 || svc->start_time.tv_nsec != 0) {
+        DEBUG(SSSDBG_IMPORTANT_INFO, "Service [%s] started in %ld ms\n",
+              svc->name, elapsed_ms(&svc->start_time));
+    }
+
     /* We need to attach a spy to the connection structure so that if some code
      * frees it we can zero it out in the service structure. Otherwise we may
      * try to access or even free, freed memory. */
@@ -520,8 +544,9 @@ static int mark_service_as_started(struct mt_svc *svc)
             goto done;
         }
 
-        DEBUG(SSSDBG_TRACE_FUNC,
-              "All services have successfully started, creating pid file\n");
+        DEBUG(SSSDBG_IMPORTANT_INFO,
+              "All services have successfully started in %ld ms, "
+              "creating pid file\n", elapsed_ms(&ctx->start_time));
         ret = pidfile(SSSD_PIDFILE);
         if (ret != EOK) {
             DEBUG(SSSDBG_FATAL_FAILURE,
@@ -933,6 +958,18 @@ static int get_monitor_config(struct mt_ctx *ctx)
 
     ctx->service_id_timeout = timeout_seconds * 1000; /* service_id_timeout is in ms */
 
+    ret = confdb_get_bool(ctx->cdb,
+                          CONFDB_MONITOR_CONF_ENTRY,
+                          CONFDB_MONITOR_PARALLEL_STARTUP,
+                          CONFDB_MONITOR_PARALLEL_STARTUP_DEFAULT,
+                          &ctx->parallel_startup);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to read parallel_startup from confdb: [%d] %s\n",
+              ret, sss_strerror(ret));
+        return ret;
+    }
+
     ret = confdb_get_string_as_list(ctx->cdb, ctx,
                                     CONFDB_MONITOR_CONF_ENTRY,
                                     CONFDB_MONITOR_ACTIVE_SERVICES,
@@ -1024,6 +1061,37 @@ static bool svc_supported_as_nonroot(const char *svc_name)
     return false;
 }
 
+/* Reads the CPUs the service is bound to. Memory is allocated on the NUMA
+ * node of the CPU a process runs on, so a process bound to the CPUs of one
+ * node also keeps its pages of the caches there. */
+static errno_t get_cpu_affinity(struct mt_svc *svc,
+                                const char *path,
+                                const char *attr)
+{
+    char *list;
+    errno_t ret;
+
+    ret = confdb_get_string(svc->mt_ctx->cdb, svc, path, attr, NULL, &list);
+    if (ret != EOK || list == NULL) {
+        return ret;
+    }
+
+    svc->cpu_affinity = talloc(svc, cpu_set_t);
+    if (svc->cpu_affinity == NULL) {
+        talloc_free(list);
+        return ENOMEM;
+    }
+
+    ret = sss_parse_cpu_list(list, svc->cpu_affinity);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Invalid value [%s] of %s of [%s]\n", list, attr, svc->name);
+    }
+
+    talloc_free(list);
+    return ret;
+}
+
 static int get_service_config(struct mt_ctx *ctx, const char *name,
                               struct mt_svc **svc_cfg)
 {
@@ -1072,6 +1140,12 @@ static int get_service_config(struct mt_ctx *ctx, const char *name,
         return ret;
     }
 
+    ret = get_cpu_affinity(svc, path, CONFDB_SERVICE_CPU_AFFINITY);
+    if (ret != EOK) {
+        talloc_free(svc);
+        return ret;
+    }
+
     if (svc_supported_as_nonroot(svc->name)) {
         uid = ctx->uid;
         gid = ctx->gid;
@@ -1220,6 +1294,12 @@ static int get_provider_config(struct mt_ctx *ctx, const char *name,
         return ret;
     }
 
+    ret = get_cpu_affinity(svc, path, CONFDB_DOMAIN_CPU_AFFINITY);
+    if (ret != EOK) {
+        talloc_free(svc);
+        return ret;
+    }
+
     talloc_free(path);
 
     /* if no provider is present do not run the domain */
@@ -1352,6 +1432,10 @@ static void monitor_hup(struct tevent_context *ev,
             service_signal_clear_enum_cache(cur_svc);
         }
 
+        if (!strcmp(SSS_SUDO_SBUS_SERVICE_NAME, cur_svc->name)) {
+            service_signal_clear_enum_cache(cur_svc);
+        }
+
     }
 
 }
@@ -1468,6 +1552,14 @@ static void monitor_quit(struct mt_ctx *mt_ctx, int ret)
     }
 #endif
 
+    /* nothing writes to the caches anymore */
+    error = sysdb_mark_clean_shutdown(mt_ctx->domains, DB_PATH);
+    if (error != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to mark the caches as cleanly shut down [%d]: %s\n",
+              error, sss_strerror(error));
+    }
+
     monitor_cleanup();
 
     exit(ret);
@@ -1528,6 +1620,28 @@ static void signal_offline(struct tevent_context *ev,
     }
 }
 
+/* The monitor writes out its own backtrace or toggles its own profiler in
+ * the handlers set up by server_setup(), the signal is forwarded to the
+ * services. */
+static void signal_forward_to_services(struct tevent_context *ev,
+                                   struct tevent_signal *se,
+                                   int signum,
+                                   int count,
+                                   void *siginfo,
+                                   void *private_data)
+{
+    struct mt_ctx *monitor;
+    struct mt_svc *cur_svc;
+
+    monitor = talloc_get_type(private_data, struct mt_ctx);
+
+    for(cur_svc = monitor->svc_list; cur_svc; cur_svc = cur_svc->next) {
+        if (cur_svc->pid != 0) {
+            kill(cur_svc->pid, signum);
+        }
+    }
+}
+
 static void signal_offline_reset(struct tevent_context *ev,
                                  struct tevent_signal *se,
                                  int signum,
@@ -1593,6 +1707,7 @@ errno_t load_configuration(TALLOC_CTX *mem_ctx,
     }
 
     ctx->pid_file_created = false;
+    clock_gettime(CLOCK_MONOTONIC, &ctx->start_time);
     talloc_set_destructor((TALLOC_CTX *)ctx, monitor_ctx_destructor);
 
     cdb_file = talloc_asprintf(ctx, "%s/%s", DB_PATH, CONFDB_FILE);
@@ -1709,14 +1824,19 @@ static void poll_config_file(struct tevent_context *ev,
     }
 }
 
-static int resolv_conf_inotify_cb(const char *filename,
+static int resolv_conf_inotify_cb(const char **filenames,
                                   uint32_t flags,
                                   void *pvt)
 {
     struct config_file_ctx *file_ctx;
+    const char *filename;
+
+    /* The group only watches one file */
+    filename = filenames != NULL ? filenames[0] : NULL;
 
     DEBUG(SSSDBG_TRACE_INTERNAL,
-          "Received inotify notification for %s\n", filename);
+          "Received inotify notification for %s\n",
+          filename != NULL ? filename : "the watched file");
 
     file_ctx = talloc_get_type(pvt, struct config_file_ctx);
     if (file_ctx == NULL) {
@@ -1730,20 +1850,28 @@ static int try_inotify(struct config_file_ctx *file_ctx,
                        const char *filename)
 {
 #ifdef HAVE_INOTIFY
-    struct snotify_ctx *snctx;
-    /* We will queue the file for update in one second.
-     * This way, if there is a script writing to the file
-     * repeatedly, we won't be attempting to update multiple
-     * times.
+    struct snotify_group *group;
+    errno_t ret;
+    /* We will queue the file for update once it was not written to for
+     * a quarter of a second, but at the latest in one second. This way,
+     * if there is a script writing to the file repeatedly, we won't be
+     * attempting to update multiple times.
      */
-    struct timeval delay = { .tv_sec = 1, .tv_usec = 0 };
-
-    snctx = snotify_create(file_ctx, file_ctx->mt_ctx->ev, SNOTIFY_WATCH_DIR,
-                           filename, &delay,
-                           IN_DELETE_SELF | IN_CLOSE_WRITE | IN_MOVE_SELF | \
-                           IN_CREATE | IN_MOVED_TO | IN_IGNORED,
-                           resolv_conf_inotify_cb, file_ctx);
-    if (snctx == NULL) {
+    struct timeval quiet = { .tv_sec = 0, .tv_usec = 250000 };
+    struct timeval max_wait = { .tv_sec = 1, .tv_usec = 0 };
+
+    group = snotify_group_create(file_ctx, file_ctx->mt_ctx->ev,
+                                 &quiet, &max_wait, NULL,
+                                 resolv_conf_inotify_cb, file_ctx);
+    if (group == NULL) {
+        return EIO;
+    }
+
+    ret = snotify_group_add(group, SNOTIFY_WATCH_DIR, filename,
+                            IN_DELETE_SELF | IN_CLOSE_WRITE | IN_MOVE_SELF | \
+                            IN_CREATE | IN_MOVED_TO | IN_IGNORED);
+    if (ret != EOK) {
+        talloc_free(group);
         return EIO;
     }
 
@@ -1978,6 +2106,20 @@ static int monitor_process_init(struct mt_ctx *ctx,
         return EIO;
     }
 
+    /* Forward the request for the debug backtraces to the services */
+    tes = tevent_add_signal(ctx->ev, ctx, SSS_DEBUG_BACKTRACE_SIGNAL, 0,
+                            signal_forward_to_services, ctx);
+    if (tes == NULL) {
+        return EIO;
+    }
+
+    /* Forward the request to start or stop profiling to the services */
+    tes = tevent_add_signal(ctx->ev, ctx, SSS_PROF_SIGNAL, 0,
+                            signal_forward_to_services, ctx);
+    if (tes == NULL) {
+        return EIO;
+    }
+
     /* Set up the SIGCHLD handler */
     ret = sss_sigchld_init(ctx, ctx->ev, &ctx->sigchld_ctx);
     if (ret != EOK) return ret;
@@ -2098,7 +2240,7 @@ static void monitor_sbus_connected(struct tevent_req *req)
         }
     }
 
-    if (num_providers > 0) {
+    if (num_providers > 0 && !ctx->parallel_startup) {
         /* now set the services startup timeout *
          * (responders will be started automatically when all
          *  providers are up and running or when the timeout
@@ -2113,7 +2255,10 @@ static void monitor_sbus_connected(struct tevent_req *req)
         ctx->services_started = true;
 
         /* No providers start services immediately
-         * Normally this means only LOCAL is configured */
+         * Normally this means only LOCAL is configured.
+         * With parallel_startup the responders do not wait for the
+         * providers either, they serve from the cache until the
+         * provider connects. */
         for (i = 0; ctx->services[i]; i++) {
             ret = add_new_service(ctx, ctx->services[i], 0);
             if (ret != EOK) {
@@ -2210,6 +2355,7 @@ static void service_startup_handler(struct tevent_context *ev,
 
         /* Parent */
         mt_svc->mt_ctx->check_children = true;
+        clock_gettime(CLOCK_MONOTONIC, &mt_svc->start_time);
 
         /* Handle process exit */
         ret = sss_child_register(mt_svc,
@@ -2233,6 +2379,15 @@ static void service_startup_handler(struct tevent_context *ev,
 
     /* child */
 
+    /* inherited by the helper processes the service starts */
+    if (mt_svc->cpu_affinity != NULL
+            && sched_setaffinity(0, sizeof(cpu_set_t),
+                                 mt_svc->cpu_affinity) != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Could not set the CPU affinity of %s, reason: %s\n",
+              mt_svc->name, strerror(errno));
+    }
+
     args = parse_args(mt_svc->command);
     execvp(args[0], args);
 
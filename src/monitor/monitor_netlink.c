@@ -69,6 +69,10 @@
 
 #define BUFSIZE 8
 
+/* Changes reported within this many seconds of the first one are signaled
+ * to the providers together */
+#define NETLINK_CHANGE_DELAY 2
+
 #ifdef HAVE_LIBNL
 /* Wrappers determining use of libnl version 1 or 3 */
 #ifdef HAVE_LIBNL3
@@ -106,7 +110,12 @@ struct netlink_ctx {
 #ifdef HAVE_LIBNL
     struct nlw_handle *nlp;
 #endif
+    struct tevent_context *ev;
     struct tevent_fd *tefd;
+    struct tevent_timer *change_te;
+
+    /* indexes of the interfaces whose changes are ignored */
+    hash_table_t *ignored_links;
 
     network_change_cb change_cb;
     void *cb_data;
@@ -290,6 +299,69 @@ static bool discard_iff_up(const char *ifname)
     return false;
 }
 
+/* Kinds of virtual links that container runtimes and overlay networks create
+ * and remove all the time, the host does not reach its servers through
+ * them */
+static const char *ignored_link_kinds[] = { "veth", "vxlan", "geneve", NULL };
+
+static bool link_kind_is_ignored(struct rtnl_link *link_obj)
+{
+#ifdef HAVE_LIBNL3
+    const char *kind;
+    int i;
+
+    kind = rtnl_link_get_type(link_obj);
+    if (kind == NULL) {
+        return false;
+    }
+
+    for (i = 0; ignored_link_kinds[i] != NULL; i++) {
+        if (strcmp(kind, ignored_link_kinds[i]) == 0) {
+            return true;
+        }
+    }
+#endif
+
+    return false;
+}
+
+static void link_set_ignored(struct netlink_ctx *ctx, int ifidx, bool ignored)
+{
+    hash_key_t key;
+    hash_value_t value;
+    int hret;
+
+    key.type = HASH_KEY_ULONG;
+    key.ul = ifidx;
+
+    if (!ignored) {
+        hret = hash_delete(ctx->ignored_links, &key);
+        if (hret != HASH_SUCCESS && hret != HASH_ERROR_KEY_NOT_FOUND) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot remove iface idx %d [%d]: %s\n",
+                  ifidx, hret, hash_error_string(hret));
+        }
+        return;
+    }
+
+    value.type = HASH_VALUE_UNDEF;
+    hret = hash_enter(ctx->ignored_links, &key, &value);
+    if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot add iface idx %d [%d]: %s\n",
+              ifidx, hret, hash_error_string(hret));
+    }
+}
+
+static bool link_is_ignored(struct netlink_ctx *ctx, int ifidx)
+{
+    hash_key_t key;
+
+    key.type = HASH_KEY_ULONG;
+    key.ul = ifidx;
+
+    return hash_has_key(ctx->ignored_links, &key);
+}
+
 static void nladdr_to_string(struct nl_addr *nl, char *buf, size_t bufsize)
 {
     int addr_family;
@@ -500,8 +572,9 @@ static enum nlw_msg_type message_type(struct nlmsghdr *hdr)
 {
     DEBUG(SSSDBG_FUNC_DATA, "netlink Message type: %d\n", hdr->nlmsg_type);
     switch (hdr->nlmsg_type) {
-        /* network interface added */
+        /* network interface added, changed or removed */
         case RTM_NEWLINK:
+        case RTM_DELLINK:
             return NLW_LINK;
         /* routing table changed */
         case RTM_NEWROUTE:
@@ -570,6 +643,38 @@ static int nlw_set_callbacks(struct nlw_handle *nlp, void *data)
     return ret;
 }
 
+static void netlink_change_timeout(struct tevent_context *ev,
+                                   struct tevent_timer *te,
+                                   struct timeval tv,
+                                   void *pvt)
+{
+    struct netlink_ctx *ctx = talloc_get_type(pvt, struct netlink_ctx);
+
+    ctx->change_te = NULL;
+    ctx->change_cb(ctx->cb_data);
+}
+
+/* A network going up or down usually produces a burst of link, address and
+ * route messages; the providers are signaled once for all of them */
+static void netlink_changed(struct netlink_ctx *ctx)
+{
+    struct timeval tv;
+
+    if (ctx->change_te != NULL) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "A networking status change is already pending\n");
+        return;
+    }
+
+    tv = tevent_timeval_current_ofs(NETLINK_CHANGE_DELAY, 0);
+    ctx->change_te = tevent_add_timer(ctx->ev, ctx, tv,
+                                      netlink_change_timeout, ctx);
+    if (ctx->change_te == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "tevent_add_timer() failed\n");
+        ctx->change_cb(ctx->cb_data);
+    }
+}
+
 static void route_msg_debug_print(struct rtnl_route *route_obj)
 {
     int prefixlen;
@@ -628,6 +733,25 @@ static bool route_is_multicast(struct rtnl_route *route_obj)
     return false;
 }
 
+/* Routes of the local table and the local, broadcast and multicast types
+ * follow the addresses of the host, which are handled on their own */
+static bool route_is_relevant(struct rtnl_route *route_obj)
+{
+    if (rtnl_route_get_table(route_obj) == RT_TABLE_LOCAL) {
+        return false;
+    }
+
+    switch (rtnl_route_get_type(route_obj)) {
+    case RTN_LOCAL:
+    case RTN_BROADCAST:
+    case RTN_ANYCAST:
+    case RTN_MULTICAST:
+        return false;
+    default:
+        return true;
+    }
+}
+
 static void route_msg_handler(struct nl_object *obj, void *arg)
 {
     struct rtnl_route *route_obj;
@@ -647,7 +771,18 @@ static void route_msg_handler(struct nl_object *obj, void *arg)
         route_msg_debug_print(route_obj);
     }
 
-    ctx->change_cb(ctx->cb_data);
+    if (!route_is_relevant(route_obj)) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Discarding local route message\n");
+        return;
+    }
+
+    if (link_is_ignored(ctx, rtnlw_route_get_oif(route_obj))) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Discarding route message of an ignored interface\n");
+        return;
+    }
+
+    netlink_changed(ctx);
 }
 
 static void addr_msg_debug_print(struct rtnl_addr *addr_obj)
@@ -686,6 +821,12 @@ static void addr_msg_handler(struct nl_object *obj, void *arg)
         addr_msg_debug_print(addr_obj);
     }
 
+    if (link_is_ignored(ctx, rtnl_addr_get_ifindex(addr_obj))) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Discarding addr message of an ignored interface\n");
+        return;
+    }
+
     local_addr = rtnl_addr_get_local(addr_obj);
     if (local_addr == NULL) {
     DEBUG(SSSDBG_MINOR_FAILURE,
@@ -731,7 +872,7 @@ static void addr_msg_handler(struct nl_object *obj, void *arg)
         return;
     }
 
-    ctx->change_cb(ctx->cb_data);
+    netlink_changed(ctx);
 }
 
 static void link_msg_handler(struct nl_object *obj, void *arg)
@@ -755,10 +896,22 @@ static void link_msg_handler(struct nl_object *obj, void *arg)
     DEBUG(SSSDBG_TRACE_LIBS, "netlink link message: iface idx %u (%s) "
           "flags 0x%X (%s)\n", ifidx, ifname, flags, str_flags);
 
+    if (nl_object_get_msgtype(obj) == RTM_DELLINK) {
+        link_set_ignored(ctx, ifidx, false);
+        return;
+    }
+
+    if (link_kind_is_ignored(link_obj)) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Ignoring changes of virtual iface %s\n", ifname);
+        link_set_ignored(ctx, ifidx, true);
+        return;
+    }
+
     /* IFF_LOWER_UP is the indicator of carrier status */
     if ((flags & IFF_RUNNING) && (flags & IFF_LOWER_UP) &&
          !discard_iff_up(ifname)) {
-        ctx->change_cb(ctx->cb_data);
+        netlink_changed(ctx);
     }
 }
 
@@ -799,9 +952,15 @@ int setup_netlink(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
     if (!nlctx) return ENOMEM;
     talloc_set_destructor((TALLOC_CTX *) nlctx, netlink_ctx_destructor);
 
+    nlctx->ev        = ev;
     nlctx->change_cb = change_cb;
     nlctx->cb_data   = cb_data;
 
+    ret = sss_hash_create(nlctx, 0, &nlctx->ignored_links);
+    if (ret != EOK) {
+        goto fail;
+    }
+
     /* allocate the libnl handle/socket and register the default filter set */
     nlctx->nlp = nlw_alloc();
     if (!nlctx->nlp) {
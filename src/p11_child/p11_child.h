@@ -65,6 +65,15 @@ errno_t init_verification(struct p11_ctx *p11_ctx,
 
 bool do_verification_b64(struct p11_ctx *p11_ctx, const char *cert_b64);
 
+/* Keep the PKCS#11 modules initialized and remember good OCSP results
+ * between the requests handled by a p11_child running with --service. */
+void p11c_set_service_mode(struct p11_ctx *p11_ctx);
+
+/* Drop the kept PKCS#11 modules if a slot event, e.g. a reader or card being
+ * plugged in or removed, was reported, so that the next request starts with
+ * freshly initialized modules. */
+void p11c_check_slot_events(struct p11_ctx *p11_ctx);
+
 errno_t do_card(TALLOC_CTX *mem_ctx, struct p11_ctx *p11_ctx,
                 enum op_mode mode, const char *pin,
                 const char *module_name_in, const char *token_name_in,
@@ -55,13 +55,126 @@ static const char *op_mode_str(enum op_mode mode)
     }
 }
 
-static int do_work(TALLOC_CTX *mem_ctx, enum op_mode mode, const char *ca_db,
-                   struct cert_verify_opts *cert_verify_opts,
-                   bool wait_for_card,
-                   const char *cert_b64, const char *pin,
-                   const char *module_name, const char *token_name,
-                   const char *key_id, const char *label, const char *uri,
-                   char **multi)
+/* Limits for a single request sent to p11_child running with --service */
+#define P11C_SERVICE_MAX_ARGS 32
+#define P11C_SERVICE_MAX_LEN (64 * 1024)
+
+struct p11c_req {
+    enum op_mode mode;
+    enum pin_mode pin_mode;
+    char *ca_db;
+    char *verify_opts;
+    char *module_name;
+    char *token_name;
+    char *key_id;
+    char *label;
+    char *cert_b64;
+    char *uri;
+    bool wait_for_card;
+};
+
+/* Options describing a single operation, used on the command line and for
+ * the requests sent to p11_child running with --service */
+#define P11C_REQ_OPTS(r) \
+        {"auth", 0, POPT_ARG_NONE, NULL, 'a', _("Run in auth mode"), NULL}, \
+        {"pre", 0, POPT_ARG_NONE, NULL, 'p', _("Run in pre-auth mode"), NULL}, \
+        {"wait_for_card", 0, POPT_ARG_NONE, NULL, 'w', _("Wait until card is available"), NULL}, \
+        {"verification", 0, POPT_ARG_NONE, NULL, 'v', _("Run in verification mode"), \
+         NULL}, \
+        {"pin", 0, POPT_ARG_NONE, NULL, 'i', _("Expect PIN on stdin"), NULL}, \
+        {"keypad", 0, POPT_ARG_NONE, NULL, 'k', _("Expect PIN on keypad"), \
+         NULL}, \
+        {"verify", 0, POPT_ARG_STRING, &(r).verify_opts, 0 , _("Tune validation"), \
+         NULL}, \
+        {"ca_db", 0, POPT_ARG_STRING, &(r).ca_db, 0, _("CA DB to use"), \
+         NULL}, \
+        {"module_name", 0, POPT_ARG_STRING, &(r).module_name, 0, \
+         _("Module name for authentication"), NULL}, \
+        {"token_name", 0, POPT_ARG_STRING, &(r).token_name, 0, \
+         _("Token name for authentication"), NULL}, \
+        {"key_id", 0, POPT_ARG_STRING, &(r).key_id, 0, \
+         _("Key ID for authentication"), NULL}, \
+        {"label", 0, POPT_ARG_STRING, &(r).label, 0, \
+         _("Label for authentication"), NULL}, \
+        {"certificate", 0, POPT_ARG_STRING, &(r).cert_b64, 0, \
+         _("certificate to verify, base64 encoded"), NULL}, \
+        {"uri", 0, POPT_ARG_STRING, &(r).uri, 0, \
+         _("PKCS#11 URI to restrict selection"), NULL}
+
+/* Returns EINVAL with a message in _msg for conflicting options and EINVAL
+ * without message for unknown ones. */
+static errno_t p11c_req_set_opt(struct p11c_req *req, int opt,
+                                const char **_msg)
+{
+    *_msg = NULL;
+
+    switch(opt) {
+    case 'a':
+    case 'p':
+    case 'v':
+        if (req->mode != OP_NONE) {
+            *_msg = "--verify, --auth and --pre are mutually "
+                    "exclusive and should be only used once.";
+            return EINVAL;
+        }
+        req->mode = (opt == 'a') ? OP_AUTH
+                                 : ((opt == 'p') ? OP_PREAUTH : OP_VERIFIY);
+        break;
+    case 'i':
+    case 'k':
+        if (req->pin_mode != PIN_NONE) {
+            *_msg = "--pin and --keypad are mutually exclusive "
+                    "and should be only used once.";
+            return EINVAL;
+        }
+        req->pin_mode = (opt == 'i') ? PIN_STDIN : PIN_KEYPAD;
+        break;
+    case 'w':
+        req->wait_for_card = true;
+        break;
+    default:
+        return EINVAL;
+    }
+
+    return EOK;
+}
+
+static const char *p11c_req_check(struct p11c_req *req)
+{
+    if (req->ca_db == NULL) {
+        return "Missing CA DB path: --ca_db must be specified.";
+    }
+
+    if (req->mode == OP_NONE) {
+        return "Missing operation mode, either "
+               "--verify, --auth or --pre must be specified.";
+    } else if (req->mode == OP_AUTH && req->pin_mode == PIN_NONE) {
+        return "Missing PIN mode for authentication, "
+               "either --pin or --keypad must be specified.";
+    } else if (req->mode == OP_VERIFIY && req->cert_b64 == NULL) {
+        return "Missing certificate for verify operation, "
+               "--certificate base64_encoded_certificate must be added.";
+    }
+
+    return NULL;
+}
+
+static void p11c_req_free_strings(struct p11c_req *req)
+{
+    /* popt allocates string arguments with malloc() */
+    free(req->ca_db);
+    free(req->verify_opts);
+    free(req->module_name);
+    free(req->token_name);
+    free(req->key_id);
+    free(req->label);
+    free(req->cert_b64);
+    free(req->uri);
+}
+
+static errno_t p11c_setup(TALLOC_CTX *mem_ctx, const char *ca_db,
+                          struct cert_verify_opts *cert_verify_opts,
+                          bool wait_for_card, struct p11_ctx **_p11_ctx)
 {
     int ret;
     struct p11_ctx *p11_ctx;
@@ -76,10 +189,25 @@ static int do_work(TALLOC_CTX *mem_ctx, enum op_mode mode, const char *ca_db,
         ret = init_verification(p11_ctx, cert_verify_opts);
         if (ret != 0) {
             DEBUG(SSSDBG_OP_FAILURE, "init_verification failed.\n");
-            goto done;
+            talloc_free(p11_ctx);
+            return ret;
         }
     }
 
+    *_p11_ctx = p11_ctx;
+
+    return EOK;
+}
+
+static int p11c_run(TALLOC_CTX *mem_ctx, struct p11_ctx *p11_ctx,
+                    enum op_mode mode,
+                    struct cert_verify_opts *cert_verify_opts,
+                    const char *cert_b64, const char *pin,
+                    const char *module_name, const char *token_name,
+                    const char *key_id, const char *label, const char *uri,
+                    char **multi)
+{
+    int ret;
 
     if (mode == OP_VERIFIY) {
         if (!cert_verify_opts->do_verification
@@ -95,18 +223,68 @@ static int do_work(TALLOC_CTX *mem_ctx, enum op_mode mode, const char *ca_db,
                       module_name, token_name, key_id, label, uri, multi);
     }
 
-done:
+    return ret;
+}
+
+static int do_work(TALLOC_CTX *mem_ctx, enum op_mode mode, const char *ca_db,
+                   struct cert_verify_opts *cert_verify_opts,
+                   bool wait_for_card,
+                   const char *cert_b64, const char *pin,
+                   const char *module_name, const char *token_name,
+                   const char *key_id, const char *label, const char *uri,
+                   char **multi)
+{
+    int ret;
+    struct p11_ctx *p11_ctx;
+
+    ret = p11c_setup(mem_ctx, ca_db, cert_verify_opts, wait_for_card,
+                     &p11_ctx);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = p11c_run(mem_ctx, p11_ctx, mode, cert_verify_opts, cert_b64, pin,
+                   module_name, token_name, key_id, label, uri, multi);
+
     talloc_free(p11_ctx);
 
     return ret;
 }
 
+static errno_t p11c_pin_from_buf(TALLOC_CTX *mem_ctx, uint8_t *buf,
+                                 size_t len, char **pin)
+{
+    char *str;
+
+    if (len == 0 || *buf == '\0') {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Missing PIN.\n");
+        return EINVAL;
+    }
+
+    str = talloc_strndup(mem_ctx, (char *) buf, len);
+    if (str == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strndup failed.\n");
+        return ENOMEM;
+    }
+    talloc_set_destructor((void *) str, sss_erase_talloc_mem_securely);
+
+    if (strlen(str) != len) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Input contains additional data, only PIN expected.\n");
+        talloc_free(str);
+        return EINVAL;
+    }
+
+    *pin = str;
+
+    return EOK;
+}
+
 static errno_t p11c_recv_data(TALLOC_CTX *mem_ctx, int fd, char **pin)
 {
     uint8_t buf[IN_BUF_SIZE];
     ssize_t len;
     errno_t ret;
-    char *str;
 
     errno = 0;
     len = sss_atomic_read_s(fd, buf, IN_BUF_SIZE);
@@ -118,29 +296,332 @@ static errno_t p11c_recv_data(TALLOC_CTX *mem_ctx, int fd, char **pin)
         return ret;
     }
 
-    if (len == 0 || *buf == '\0') {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Missing PIN.\n");
-        return EINVAL;
+    ret = p11c_pin_from_buf(mem_ctx, buf, len, pin);
+    sss_erase_mem_securely(buf, sizeof(buf));
+
+    return ret;
+}
+
+/* State of a p11_child running with --service, the PKCS#11 modules, the
+ * X509 store and the OCSP results are kept in p11_ctx as long as the
+ * requests use the same CA DB and verification options. */
+struct p11c_service {
+    TALLOC_CTX *cfg_ctx;
+    char *ca_db;
+    char *verify_opts;
+    struct cert_verify_opts *cert_verify_opts;
+    struct p11_ctx *p11_ctx;
+};
+
+static bool p11c_str_equal(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b;
     }
 
-    str = talloc_strndup(mem_ctx, (char *) buf, len);
-    if (str == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strndup failed.\n");
+    return strcmp(a, b) == 0;
+}
+
+static errno_t p11c_service_setup(struct p11c_service *svc,
+                                  struct p11c_req *req)
+{
+    TALLOC_CTX *cfg_ctx;
+    errno_t ret;
+
+    if (svc->p11_ctx != NULL && p11c_str_equal(svc->ca_db, req->ca_db)
+            && p11c_str_equal(svc->verify_opts, req->verify_opts)) {
+        return EOK;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Setting up CA DB [%s].\n", req->ca_db);
+
+    talloc_zfree(svc->cfg_ctx);
+    svc->p11_ctx = NULL;
+
+    cfg_ctx = talloc_new(svc);
+    if (cfg_ctx == NULL) {
         return ENOMEM;
     }
 
-    if (strlen(str) != len) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Input contains additional data, only PIN expected.\n");
-        talloc_free(str);
-        return EINVAL;
+    svc->ca_db = talloc_strdup(cfg_ctx, req->ca_db);
+    if (svc->ca_db == NULL) {
+        ret = ENOMEM;
+        goto done;
     }
 
-    *pin = str;
+    svc->verify_opts = NULL;
+    if (req->verify_opts != NULL) {
+        svc->verify_opts = talloc_strdup(cfg_ctx, req->verify_opts);
+        if (svc->verify_opts == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    ret = parse_cert_verify_opts(cfg_ctx, svc->verify_opts,
+                                 &svc->cert_verify_opts);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to parse verify option.\n");
+        goto done;
+    }
+
+    ret = p11c_setup(cfg_ctx, svc->ca_db, svc->cert_verify_opts, false,
+                     &svc->p11_ctx);
+    if (ret != EOK) {
+        goto done;
+    }
+    p11c_set_service_mode(svc->p11_ctx);
+
+    svc->cfg_ctx = cfg_ctx;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        svc->p11_ctx = NULL;
+        talloc_free(cfg_ctx);
+    }
+
+    return ret;
+}
+
+static errno_t p11c_service_request(struct p11c_service *svc,
+                                    TALLOC_CTX *mem_ctx,
+                                    int argc, const char **argv,
+                                    uint8_t *data, size_t data_len,
+                                    char **_multi)
+{
+    struct p11c_req req = { 0 };
+    struct poptOption options[] = {
+        P11C_REQ_OPTS(req),
+        POPT_TABLEEND
+    };
+    poptContext pc;
+    const char *msg;
+    char *pin = NULL;
+    int opt;
+    errno_t ret;
+
+    pc = poptGetContext(argv[0], argc, argv, options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        ret = p11c_req_set_opt(&req, opt, &msg);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Invalid request: %s\n",
+                  msg != NULL ? msg : poptStrerror(opt));
+            goto done;
+        }
+    }
+
+    msg = p11c_req_check(&req);
+    if (msg != NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "Invalid request: %s\n", msg);
+        ret = EINVAL;
+        goto done;
+    }
+
+    /* Waiting would block all other requests */
+    if (req.wait_for_card) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "--wait_for_card is not supported in service mode.\n");
+        ret = EINVAL;
+        goto done;
+    }
+
+    if (req.mode == OP_AUTH && (req.module_name == NULL
+                                    || req.token_name == NULL
+                                    || req.key_id == NULL)) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "--module_name, --token_name and --key_id must be given for "
+              "authentication.\n");
+        ret = EINVAL;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Running in [%s] mode.\n",
+          op_mode_str(req.mode));
+
+    if (req.mode == OP_AUTH && req.pin_mode == PIN_STDIN) {
+        ret = p11c_pin_from_buf(mem_ctx, data, data_len, &pin);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Failed to read PIN.\n");
+            goto done;
+        }
+    }
+
+    ret = p11c_service_setup(svc, &req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    p11c_check_slot_events(svc->p11_ctx);
+
+    ret = p11c_run(mem_ctx, svc->p11_ctx, req.mode, svc->cert_verify_opts,
+                   req.cert_b64, pin, req.module_name, req.token_name,
+                   req.key_id, req.label, req.uri, _multi);
+
+done:
+    talloc_free(pin);
+    poptFreeContext(pc);
+    p11c_req_free_strings(&req);
+
+    return ret;
+}
+
+/* Reads a request of the form
+ *     uint32_t argc, uint32_t args_len, uint32_t data_len,
+ *     args_len bytes of argc NUL-terminated arguments,
+ *     data_len bytes of data, e.g. the PIN
+ * where the arguments are the same as used on the command line. Returns
+ * ENOTCONN if the responder closed the connection. */
+static errno_t p11c_service_read(TALLOC_CTX *mem_ctx, int fd,
+                                 int *_argc, const char ***_argv,
+                                 uint8_t **_data, size_t *_data_len)
+{
+    uint32_t hdr[3];
+    uint8_t *buf;
+    const char **argv;
+    size_t args_len;
+    size_t data_len;
+    size_t c;
+    size_t l;
+    uint32_t argc;
+    ssize_t len;
+
+    len = sss_atomic_read_s(fd, hdr, sizeof(hdr));
+    if (len == 0) {
+        return ENOTCONN;
+    } else if (len != sizeof(hdr)) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Short read of request header.\n");
+        return ENOTCONN;
+    }
+
+    argc = hdr[0];
+    args_len = hdr[1];
+    data_len = hdr[2];
+    if (argc > P11C_SERVICE_MAX_ARGS || args_len > P11C_SERVICE_MAX_LEN
+            || data_len > P11C_SERVICE_MAX_LEN) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Request is too large.\n");
+        return ENOTCONN;
+    }
+
+    buf = talloc_size(mem_ctx, args_len + data_len + 1);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+    talloc_set_destructor((void *) buf, sss_erase_talloc_mem_securely);
+
+    len = sss_atomic_read_s(fd, buf, args_len + data_len);
+    if (len != (ssize_t) (args_len + data_len)) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Short read of request.\n");
+        return ENOTCONN;
+    }
+    buf[args_len + data_len] = '\0';
+
+    argv = talloc_zero_array(mem_ctx, const char *, argc + 2);
+    if (argv == NULL) {
+        return ENOMEM;
+    }
+
+    argv[0] = "p11_child";
+    for (c = 0, l = 0; c < argc; c++) {
+        if (l >= args_len || memchr(buf + l, '\0', args_len - l) == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Malformed request arguments.\n");
+            return ENOTCONN;
+        }
+        argv[c + 1] = (const char *) buf + l;
+        l += strlen(argv[c + 1]) + 1;
+    }
+    if (l != args_len) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Malformed request arguments.\n");
+        return ENOTCONN;
+    }
+
+    *_argc = argc + 1;
+    *_argv = argv;
+    *_data = buf + args_len;
+    *_data_len = data_len;
+
+    return EOK;
+}
+
+/* Writes the reply uint32_t status, uint32_t len, len bytes of output */
+static errno_t p11c_service_write(int fd, errno_t status, const char *multi)
+{
+    uint32_t hdr[2];
+    size_t len;
+    ssize_t written;
+
+    len = (status == EOK && multi != NULL) ? strlen(multi) : 0;
+    hdr[0] = status;
+    hdr[1] = len;
+
+    written = sss_atomic_write_s(fd, hdr, sizeof(hdr));
+    if (written != sizeof(hdr)) {
+        return ENOTCONN;
+    }
+
+    if (len != 0) {
+        written = sss_atomic_write_s(fd, discard_const(multi), len);
+        if (written != (ssize_t) len) {
+            return ENOTCONN;
+        }
+    }
 
     return EOK;
 }
 
+static errno_t p11c_service_loop(TALLOC_CTX *mem_ctx)
+{
+    struct p11c_service *svc;
+    TALLOC_CTX *tmp_ctx;
+    const char **argv;
+    uint8_t *data;
+    size_t data_len;
+    char *multi;
+    int argc;
+    errno_t ret;
+
+    svc = talloc_zero(mem_ctx, struct p11c_service);
+    if (svc == NULL) {
+        return ENOMEM;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Waiting for requests.\n");
+
+    for (;;) {
+        tmp_ctx = talloc_new(svc);
+        if (tmp_ctx == NULL) {
+            ret = ENOMEM;
+            break;
+        }
+
+        ret = p11c_service_read(tmp_ctx, STDIN_FILENO, &argc, &argv,
+                                &data, &data_len);
+        if (ret != EOK) {
+            talloc_free(tmp_ctx);
+            break;
+        }
+
+        multi = NULL;
+        ret = p11c_service_request(svc, tmp_ctx, argc, argv, data, data_len,
+                                   &multi);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Request failed [%d]: %s.\n",
+                  ret, sss_strerror(ret));
+        }
+
+        ret = p11c_service_write(STDOUT_FILENO, ret, multi);
+        talloc_free(tmp_ctx);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Failed to send reply.\n");
+            break;
+        }
+    }
+
+    talloc_free(svc);
+
+    return (ret == ENOTCONN) ? EOK : ret;
+}
+
 int main(int argc, const char *argv[])
 {
     int opt;
@@ -149,20 +630,12 @@ int main(int argc, const char *argv[])
     const char *opt_logger = NULL;
     errno_t ret;
     TALLOC_CTX *main_ctx = NULL;
-    enum op_mode mode = OP_NONE;
-    enum pin_mode pin_mode = PIN_NONE;
+    struct p11c_req req = { 0 };
+    const char *msg;
     char *pin = NULL;
-    char *ca_db = NULL;
     struct cert_verify_opts *cert_verify_opts;
-    char *verify_opts = NULL;
     char *multi = NULL;
-    char *module_name = NULL;
-    char *token_name = NULL;
-    char *key_id = NULL;
-    char *label = NULL;
-    char *cert_b64 = NULL;
-    bool wait_for_card = false;
-    char *uri = NULL;
+    int service = 0;
 
     struct poptOption long_options[] = {
         POPT_AUTOHELP
@@ -178,33 +651,11 @@ int main(int argc, const char *argv[])
          &debug_to_stderr, 0,
          _("Send the debug output to stderr directly."), NULL },
         SSSD_LOGGER_OPTS
-        {"auth", 0, POPT_ARG_NONE, NULL, 'a', _("Run in auth mode"), NULL},
-        {"pre", 0, POPT_ARG_NONE, NULL, 'p', _("Run in pre-auth mode"), NULL},
-        {"wait_for_card", 0, POPT_ARG_NONE, NULL, 'w', _("Wait until card is available"), NULL},
-        {"verification", 0, POPT_ARG_NONE, NULL, 'v', _("Run in verification mode"),
-         NULL},
-        {"pin", 0, POPT_ARG_NONE, NULL, 'i', _("Expect PIN on stdin"), NULL},
-        {"keypad", 0, POPT_ARG_NONE, NULL, 'k', _("Expect PIN on keypad"),
-         NULL},
-        {"verify", 0, POPT_ARG_STRING, &verify_opts, 0 , _("Tune validation"),
-         NULL},
-        {"ca_db", 0, POPT_ARG_STRING, &ca_db, 0, _("CA DB to use"),
-         NULL},
-        {"module_name", 0, POPT_ARG_STRING, &module_name, 0,
-         _("Module name for authentication"), NULL},
-        {"token_name", 0, POPT_ARG_STRING, &token_name, 0,
-         _("Token name for authentication"), NULL},
-        {"key_id", 0, POPT_ARG_STRING, &key_id, 0,
-         _("Key ID for authentication"), NULL},
-        {"label", 0, POPT_ARG_STRING, &label, 0,
-         _("Label for authentication"), NULL},
-        {"certificate", 0, POPT_ARG_STRING, &cert_b64, 0,
-         _("certificate to verify, base64 encoded"), NULL},
-        {"uri", 0, POPT_ARG_STRING, &uri, 0,
-         _("PKCS#11 URI to restrict selection"), NULL},
+        {"service", 0, POPT_ARG_NONE, &service, 0,
+         _("Read requests from stdin until it is closed"), NULL},
+        P11C_REQ_OPTS(req),
         POPT_TABLEEND
     };
-
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
     debug_level = SSSDBG_INVALID;
 
@@ -220,88 +671,26 @@ int main(int argc, const char *argv[])
 
     pc = poptGetContext(argv[0], argc, argv, long_options, 0);
     while ((opt = poptGetNextOpt(pc)) != -1) {
-        switch(opt) {
-        case 'a':
-            if (mode != OP_NONE) {
-                fprintf(stderr,
-                        "\n--verify, --auth and --pre are mutually " \
-                        "exclusive and should be only used once.\n\n");
-                poptPrintUsage(pc, stderr, 0);
-                _exit(-1);
-            }
-            mode = OP_AUTH;
-            break;
-        case 'p':
-            if (mode != OP_NONE) {
-                fprintf(stderr,
-                        "\n--verify, --auth and --pre are mutually " \
-                        "exclusive and should be only used once.\n\n");
-                poptPrintUsage(pc, stderr, 0);
-                _exit(-1);
-            }
-            mode = OP_PREAUTH;
-            break;
-        case 'v':
-            if (mode != OP_NONE) {
-                fprintf(stderr,
-                        "\n--verify, --auth and --pre are mutually " \
-                        "exclusive and should be only used once.\n\n");
-                poptPrintUsage(pc, stderr, 0);
-                _exit(-1);
-            }
-            mode = OP_VERIFIY;
-            break;
-        case 'i':
-            if (pin_mode != PIN_NONE) {
-                fprintf(stderr, "\n--pin and --keypad are mutually exclusive " \
-                                "and should be only used once.\n\n");
-                poptPrintUsage(pc, stderr, 0);
-                _exit(-1);
-            }
-            pin_mode = PIN_STDIN;
-            break;
-        case 'k':
-            if (pin_mode != PIN_NONE) {
-                fprintf(stderr, "\n--pin and --keypad are mutually exclusive " \
-                                "and should be only used once.\n\n");
-                poptPrintUsage(pc, stderr, 0);
-                _exit(-1);
+        ret = p11c_req_set_opt(&req, opt, &msg);
+        if (ret != EOK) {
+            if (msg != NULL) {
+                fprintf(stderr, "\n%s\n\n", msg);
+            } else {
+                fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                      poptBadOption(pc, 0), poptStrerror(opt));
             }
-            pin_mode = PIN_KEYPAD;
-            break;
-        case 'w':
-            wait_for_card = true;
-            break;
-        default:
-            fprintf(stderr, "\nInvalid option %s: %s\n\n",
-                  poptBadOption(pc, 0), poptStrerror(opt));
             poptPrintUsage(pc, stderr, 0);
             _exit(-1);
         }
     }
 
-    if (ca_db == NULL) {
-        fprintf(stderr, "\nMissing CA DB path: --ca_db must be specified.\n\n");
-        poptPrintUsage(pc, stderr, 0);
-        _exit(-1);
-    }
-
-    if (mode == OP_NONE) {
-        fprintf(stderr, "\nMissing operation mode, either " \
-                        "--verify, --auth or --pre must be specified.\n\n");
-        poptPrintUsage(pc, stderr, 0);
-        _exit(-1);
-    } else if (mode == OP_AUTH && pin_mode == PIN_NONE) {
-        fprintf(stderr, "\nMissing PIN mode for authentication, " \
-                        "either --pin or --keypad must be specified.\n");
-        poptPrintUsage(pc, stderr, 0);
-        _exit(-1);
-    } else if (mode == OP_VERIFIY && cert_b64 == NULL) {
-        fprintf(stderr, "\nMissing certificate for verify operation, " \
-                        "--certificate base64_encoded_certificate " \
-                        "must be added.\n");
-        poptPrintUsage(pc, stderr, 0);
-        _exit(-1);
+    if (!service) {
+        msg = p11c_req_check(&req);
+        if (msg != NULL) {
+            fprintf(stderr, "\n%s\n\n", msg);
+            poptPrintUsage(pc, stderr, 0);
+            _exit(-1);
+        }
     }
 
     poptFreeContext(pc);
@@ -326,7 +715,10 @@ int main(int argc, const char *argv[])
 
     DEBUG(SSSDBG_TRACE_FUNC, "p11_child started.\n");
 
-    DEBUG(SSSDBG_TRACE_INTERNAL, "Running in [%s] mode.\n", op_mode_str(mode));
+    if (!service) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Running in [%s] mode.\n",
+              op_mode_str(req.mode));
+    }
 
     DEBUG(SSSDBG_TRACE_INTERNAL,
           "Running with effective IDs: [%"SPRIuid"][%"SPRIgid"].\n",
@@ -344,28 +736,40 @@ int main(int argc, const char *argv[])
     }
     talloc_steal(main_ctx, debug_prg_name);
 
+    if (service) {
+        ret = p11c_service_loop(main_ctx);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "p11c_service_loop failed.\n");
+            goto fail;
+        }
+
+        talloc_free(main_ctx);
+        return EXIT_SUCCESS;
+    }
+
     /* We do not require the label, but it is recommended */
-    if (mode == OP_AUTH && (module_name == NULL || token_name == NULL
-                                || key_id == NULL)) {
+    if (req.mode == OP_AUTH && (req.module_name == NULL
+                                    || req.token_name == NULL
+                                    || req.key_id == NULL)) {
         DEBUG(SSSDBG_FATAL_FAILURE,
               "--module_name, --token_name and --key_id must be given for "
               "authentication");
         goto fail;
     }
 
-    ret = parse_cert_verify_opts(main_ctx, verify_opts, &cert_verify_opts);
+    ret = parse_cert_verify_opts(main_ctx, req.verify_opts, &cert_verify_opts);
     if (ret != EOK) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Failed to parse verify option.\n");
         goto fail;
     }
 
-    if (mode == OP_VERIFIY && !cert_verify_opts->do_verification) {
+    if (req.mode == OP_VERIFIY && !cert_verify_opts->do_verification) {
         fprintf(stderr,
                 "Called verification with option 'no_verification', "
                 "it this intended?\n");
     }
 
-    if (mode == OP_AUTH && pin_mode == PIN_STDIN) {
+    if (req.mode == OP_AUTH && req.pin_mode == PIN_STDIN) {
         ret = p11c_recv_data(main_ctx, STDIN_FILENO, &pin);
         if (ret != EOK) {
             DEBUG(SSSDBG_FATAL_FAILURE, "Failed to read PIN.\n");
@@ -373,9 +777,9 @@ int main(int argc, const char *argv[])
         }
     }
 
-    ret = do_work(main_ctx, mode, ca_db, cert_verify_opts, wait_for_card,
-                  cert_b64, pin, module_name, token_name, key_id, label, uri,
-                  &multi);
+    ret = do_work(main_ctx, req.mode, req.ca_db, cert_verify_opts,
+                  req.wait_for_card, req.cert_b64, pin, req.module_name,
+                  req.token_name, req.key_id, req.label, req.uri, &multi);
     if (ret != 0) {
         DEBUG(SSSDBG_OP_FAILURE, "do_work failed.\n");
         goto fail;
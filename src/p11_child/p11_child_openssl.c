@@ -39,11 +39,28 @@
 #include "util/child_common.h"
 #include "p11_child/p11_child.h"
 
+/* Number of certificates with a good OCSP status remembered by a
+ * p11_child running as service and the maximal time in seconds a status is
+ * reused if the OCSP response does not expire earlier. */
+#define P11C_OCSP_CACHE_SIZE 64
+#define P11C_OCSP_CACHE_TTL 300
+
+struct p11c_ocsp_cache_entry {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len;
+    time_t expire;
+};
+
 struct p11_ctx {
     X509_STORE *x509_store;
     const char *ca_db;
     bool wait_for_card;
     struct cert_verify_opts *cert_verify_opts;
+
+    /* Only set if running as service */
+    bool service_mode;
+    CK_FUNCTION_LIST **modules;
+    struct p11c_ocsp_cache_entry *ocsp_cache;
 };
 
 static OCSP_RESPONSE *query_responder(BIO *cbio, const char *host,
@@ -278,6 +295,103 @@ done:
     return str;
 }
 
+static struct p11c_ocsp_cache_entry *
+ocsp_cache_find(struct p11_ctx *p11_ctx, const unsigned char *digest,
+                unsigned int digest_len)
+{
+    size_t c;
+
+    if (p11_ctx->ocsp_cache == NULL) {
+        return NULL;
+    }
+
+    for (c = 0; c < P11C_OCSP_CACHE_SIZE; c++) {
+        if (p11_ctx->ocsp_cache[c].digest_len == digest_len
+                && memcmp(p11_ctx->ocsp_cache[c].digest, digest,
+                          digest_len) == 0) {
+            return &p11_ctx->ocsp_cache[c];
+        }
+    }
+
+    return NULL;
+}
+
+static bool ocsp_cache_check(struct p11_ctx *p11_ctx, X509 *cert)
+{
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len;
+    struct p11c_ocsp_cache_entry *entry;
+
+    if (p11_ctx->ocsp_cache == NULL
+            || X509_digest(cert, EVP_sha256(), digest, &digest_len) != 1) {
+        return false;
+    }
+
+    entry = ocsp_cache_find(p11_ctx, digest, digest_len);
+    if (entry == NULL) {
+        return false;
+    }
+
+    if (entry->expire <= time(NULL)) {
+        entry->digest_len = 0;
+        return false;
+    }
+
+    return true;
+}
+
+static void ocsp_cache_add(struct p11_ctx *p11_ctx, X509 *cert,
+                           ASN1_GENERALIZEDTIME *nextupd)
+{
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len;
+    struct p11c_ocsp_cache_entry *entry;
+    time_t ttl = P11C_OCSP_CACHE_TTL;
+    int day;
+    int sec;
+    size_t c;
+
+    if (!p11_ctx->service_mode
+            || X509_digest(cert, EVP_sha256(), digest, &digest_len) != 1) {
+        return;
+    }
+
+    if (p11_ctx->ocsp_cache == NULL) {
+        p11_ctx->ocsp_cache = talloc_zero_array(p11_ctx,
+                                                struct p11c_ocsp_cache_entry,
+                                                P11C_OCSP_CACHE_SIZE);
+        if (p11_ctx->ocsp_cache == NULL) {
+            return;
+        }
+    }
+
+    /* Never reuse the status longer than the response is valid */
+    if (nextupd != NULL && ASN1_TIME_diff(&day, &sec, NULL, nextupd) == 1) {
+        if (day < 0 || sec < 0) {
+            return;
+        }
+        if (day == 0 && sec < ttl) {
+            ttl = sec;
+        }
+    }
+
+    entry = ocsp_cache_find(p11_ctx, digest, digest_len);
+    if (entry == NULL) {
+        /* Replace the entry which expires first */
+        entry = &p11_ctx->ocsp_cache[0];
+        for (c = 1; c < P11C_OCSP_CACHE_SIZE && entry->digest_len != 0; c++) {
+            if (p11_ctx->ocsp_cache[c].digest_len == 0
+                    || p11_ctx->ocsp_cache[c].expire < entry->expire) {
+                entry = &p11_ctx->ocsp_cache[c];
+            }
+        }
+    }
+
+    memcpy(entry->digest, digest, digest_len);
+    entry->digest_len = digest_len;
+    entry->expire = time(NULL) + ttl;
+}
+
 static errno_t do_ocsp(struct p11_ctx *p11_ctx, X509 *cert)
 {
     OCSP_REQUEST *ocsp_req = NULL;
@@ -306,6 +420,11 @@ static errno_t do_ocsp(struct p11_ctx *p11_ctx, X509 *cert)
     const EVP_MD *ocsp_dgst = NULL;
     char *tmp_str;
 
+    if (ocsp_cache_check(p11_ctx, cert)) {
+        DEBUG(SSSDBG_TRACE_ALL, "Using cached OCSP status of certificate.\n");
+        return EOK;
+    }
+
     ocsp_urls = X509_get1_ocsp(cert);
     if (ocsp_urls == NULL
             && p11_ctx->cert_verify_opts->ocsp_default_responder == NULL) {
@@ -490,6 +609,7 @@ static errno_t do_ocsp(struct p11_ctx *p11_ctx, X509 *cert)
     }
 
     DEBUG(SSSDBG_TRACE_ALL, "OCSP check was successful.\n");
+    ocsp_cache_add(p11_ctx, cert, nextupd);
     ret = EOK;
 
 done:
@@ -572,6 +692,13 @@ done:
 
 static int talloc_cleanup_openssl(struct p11_ctx *p11_ctx)
 {
+    X509_STORE_free(p11_ctx->x509_store);
+
+    if (p11_ctx->modules != NULL) {
+        p11_kit_modules_finalize_and_release(p11_ctx->modules);
+        p11_ctx->modules = NULL;
+    }
+
     CRYPTO_cleanup_all_ex_data();
 
     return 0;
@@ -610,11 +737,86 @@ errno_t init_p11_ctx(TALLOC_CTX *mem_ctx, const char *ca_db,
     return EOK;
 }
 
-static int talloc_free_x509_store(struct p11_ctx *p11_ctx)
+void p11c_set_service_mode(struct p11_ctx *p11_ctx)
 {
-    X509_STORE_free(p11_ctx->x509_store);
+    p11_ctx->service_mode = true;
+}
 
-    return 0;
+void p11c_check_slot_events(struct p11_ctx *p11_ctx)
+{
+    size_t c;
+    CK_SLOT_ID slot_id;
+    CK_RV rv;
+    bool reload = false;
+
+    if (p11_ctx->modules == NULL) {
+        return;
+    }
+
+    for (c = 0; p11_ctx->modules[c] != NULL; c++) {
+        rv = p11_ctx->modules[c]->C_WaitForSlotEvent(CKF_DONT_BLOCK, &slot_id,
+                                                     NULL);
+        if (rv == CKR_NO_EVENT) {
+            continue;
+        }
+
+        if (rv == CKR_OK) {
+            DEBUG(SSSDBG_TRACE_ALL, "Event for slot [%lu].\n", slot_id);
+        } else {
+            /* Without slot events we cannot tell if a reader or card was
+             * added, just start from scratch like a new p11_child would. */
+            DEBUG(SSSDBG_TRACE_ALL,
+                  "C_WaitForSlotEvent failed [%lu][%s].\n",
+                  rv, p11_kit_strerror(rv));
+        }
+        reload = true;
+    }
+
+    if (reload) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Reinitializing PKCS#11 modules.\n");
+        p11_kit_modules_finalize_and_release(p11_ctx->modules);
+        p11_ctx->modules = NULL;
+    }
+}
+
+static CK_FUNCTION_LIST **get_modules(struct p11_ctx *p11_ctx)
+{
+    CK_FUNCTION_LIST **modules;
+
+    if (p11_ctx->modules != NULL) {
+        return p11_ctx->modules;
+    }
+
+    /* Maybe use P11_KIT_MODULE_TRUSTED ? */
+    modules = p11_kit_modules_load_and_initialize(0);
+    if (modules == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "p11_kit_modules_load_and_initialize failed.\n");
+        return NULL;
+    }
+
+    if (p11_ctx->service_mode) {
+        p11_ctx->modules = modules;
+    }
+
+    return modules;
+}
+
+static void release_modules(struct p11_ctx *p11_ctx,
+                            CK_FUNCTION_LIST **modules, bool force)
+{
+    if (modules == NULL) {
+        return;
+    }
+
+    if (modules == p11_ctx->modules) {
+        if (!force) {
+            return;
+        }
+        p11_ctx->modules = NULL;
+    }
+
+    p11_kit_modules_finalize_and_release(modules);
 }
 
 errno_t init_verification(struct p11_ctx *p11_ctx,
@@ -677,7 +879,6 @@ errno_t init_verification(struct p11_ctx *p11_ctx,
 
     p11_ctx->x509_store = store;
     p11_ctx->cert_verify_opts = cert_verify_opts;
-    talloc_set_destructor(p11_ctx, talloc_free_x509_store);
 
     ret = EOK;
 
@@ -1631,11 +1832,8 @@ errno_t do_card(TALLOC_CTX *mem_ctx, struct p11_ctx *p11_ctx,
     }
 
 
-    /* Maybe use P11_KIT_MODULE_TRUSTED ? */
-    modules = p11_kit_modules_load_and_initialize(0);
+    modules = get_modules(p11_ctx);
     if (modules == NULL) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "p11_kit_modules_load_and_initialize failed.\n");
         return EIO;
     }
 
@@ -1730,14 +1928,12 @@ errno_t do_card(TALLOC_CTX *mem_ctx, struct p11_ctx *p11_ctx,
         /* When e.g. using Yubikeys the slot isn't present until the device is
          * inserted, so we should wait for a slot as well. */
         if (p11_ctx->wait_for_card && modules[c] == NULL) {
-            p11_kit_modules_finalize_and_release(modules);
+            release_modules(p11_ctx, modules, true);
 
             sleep(PKCS11_FINIALIZE_INITIALIZE_WAIT_TIME);
 
-            modules = p11_kit_modules_load_and_initialize(0);
+            modules = get_modules(p11_ctx);
             if (modules == NULL) {
-                DEBUG(SSSDBG_OP_FAILURE,
-                      "p11_kit_modules_load_and_initialize failed.\n");
                 ret = EIO;
                 goto done;
             }
@@ -1974,7 +2170,7 @@ done:
     free(slot_name);
     free(token_name);
     free(module_file_name);
-    p11_kit_modules_finalize_and_release(modules);
+    release_modules(p11_ctx, modules, false);
     p11_kit_uri_free(uri);
 
     return ret;
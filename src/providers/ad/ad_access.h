@@ -49,6 +49,8 @@ struct ad_access_ctx {
     } gpo_map_type;
     hash_table_t *gpo_map_options_table;
     enum gpo_map_type gpo_default_right;
+    /* parsed policy files of the GPOs, see ad_gpo.c */
+    struct ad_gpo_policy *gpo_policies;
 };
 
 struct tevent_req *
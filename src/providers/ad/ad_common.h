@@ -71,6 +71,9 @@ enum ad_basic_opt {
     AD_UPDATE_SAMBA_MACHINE_ACCOUNT_PASSWORD,
     AD_USE_LDAPS,
     AD_ALLOW_REMOTE_DOMAIN_LOCAL,
+    AD_DISCOVERY_CACHE_TIMEOUT,
+    AD_PAC_RECONCILE_INITGROUPS,
+    AD_PARALLEL_GC_LOOKUP,
 
     AD_OPTS_BASIC /* opts counter */
 };
@@ -111,6 +114,9 @@ struct ad_options {
     /* Dynamic DNS updates */
     struct be_resolv_ctx *be_res;
     struct be_nsupdate_ctx *dyndns_ctx;
+
+    /* Group memberships read from the PAC of each user, see ad_pac.c */
+    hash_table_t *pac_cache;
 };
 
 errno_t
@@ -105,7 +105,8 @@ errno_t ad_dyndns_init(struct be_ctx *be_ctx,
                           "Dyndns update",
                           extraflags |
                           BE_PTASK_OFFLINE_DISABLE |
-                          BE_PTASK_SCHEDULE_FROM_LAST,
+                          BE_PTASK_SCHEDULE_FROM_LAST |
+                          BE_PTASK_BULK,
                           NULL);
 
     if (ret != EOK) {
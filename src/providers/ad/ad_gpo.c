@@ -66,6 +66,7 @@
 #define AD_AT_MACHINE_EXT_NAMES "gPCMachineExtensionNames"
 #define AD_AT_FUNC_VERSION "gPCFunctionalityVersion"
 #define AD_AT_FLAGS "flags"
+#define AD_AT_VERSION_NUMBER "versionNumber"
 #define AD_AT_SID "objectSid"
 
 #define UAC_WORKSTATION_TRUST_ACCOUNT 0x00001000
@@ -131,6 +132,7 @@ struct gp_gpo {
     int num_gpo_cse_guids;
     int gpo_func_version;
     int gpo_flags;
+    int gpo_version;
     bool send_to_child;
     const char *policy_filename;
 };
@@ -182,7 +184,8 @@ struct tevent_req *ad_gpo_process_cse_send(TALLOC_CTX *mem_ctx,
                                            int cached_gpt_version,
                                            int gpo_timeout_option);
 
-int ad_gpo_process_cse_recv(struct tevent_req *req);
+int ad_gpo_process_cse_recv(struct tevent_req *req,
+                            int *_sysvol_gpt_version);
 
 /* == ad_gpo_parse_map_options and helpers ==================================*/
 
@@ -1314,22 +1317,65 @@ ad_gpo_extract_policy_setting(TALLOC_CTX *mem_ctx,
     return ret;
 }
 
+/*
+ * The allow_key and deny_key values of all of the gpo_map_types found in
+ * the policy file of a GPO. They do not change as long as the version of
+ * the GPO stays the same, so they are kept in memory and the file is
+ * parsed again only after a new version was downloaded.
+ */
+struct ad_gpo_policy {
+    struct ad_gpo_policy *prev;
+    struct ad_gpo_policy *next;
+
+    const char *gpo_guid;
+    int gpt_version;
+
+    const char **keys;
+    const char **values;
+    size_t num_settings;
+};
+
+static errno_t
+ad_gpo_policy_add_setting(struct ad_gpo_policy *policy,
+                          const char *key,
+                          const char *value)
+{
+    /* The NO_SID val is used as special SID value for the case when
+     * no SIDs are found in the rule, but we need to store some
+     * value (SID) with the key (rule name) so that it is clear
+     * that the rule is defined on the server. */
+    if (value == NULL) {
+        value = "NO_SID";
+    }
+
+    policy->keys[policy->num_settings] = key;
+    policy->values[policy->num_settings] = talloc_strdup(policy->values,
+                                                         value);
+    if (policy->values[policy->num_settings] == NULL) {
+        return ENOMEM;
+    }
+    policy->num_settings++;
+
+    return EOK;
+}
+
 /*
  * This function parses the cse-specific (GP_EXT_GUID_SECURITY) filename,
- * and stores the allow_key and deny_key of all of the gpo_map_types present
- * in the file (as part of the GPO Result object in the sysdb cache).
+ * and returns the allow_key and deny_key of all of the gpo_map_types present
+ * in the file.
  */
 static errno_t
-ad_gpo_store_policy_settings(struct sss_domain_info *domain,
-                             const char *filename)
+ad_gpo_parse_policy_settings(TALLOC_CTX *mem_ctx,
+                             const char *filename,
+                             struct ad_gpo_policy **_policy)
 {
+    struct ad_gpo_policy *policy = NULL;
     struct ini_cfgfile *file_ctx = NULL;
     struct ini_cfgobj *ini_config = NULL;
     int ret;
     int i;
     char *allow_value = NULL;
     char *deny_value = NULL;
-    const char *empty_val = "NO_SID";
     const char *allow_key = NULL;
     const char *deny_key = NULL;
     TALLOC_CTX *tmp_ctx = NULL;
@@ -1340,6 +1386,21 @@ ad_gpo_store_policy_settings(struct sss_domain_info *domain,
         goto done;
     }
 
+    policy = talloc_zero(tmp_ctx, struct ad_gpo_policy);
+    if (policy == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    policy->keys = talloc_zero_array(policy, const char *,
+                                     2 * GPO_MAP_NUM_OPTS);
+    policy->values = talloc_zero_array(policy, const char *,
+                                       2 * GPO_MAP_NUM_OPTS);
+    if (policy->keys == NULL || policy->values == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
     ret = ini_config_create(&ini_config);
     if (ret != 0) {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -1434,10 +1495,6 @@ ad_gpo_store_policy_settings(struct sss_domain_info *domain,
     }
 
     for (i = 0; i < GPO_MAP_NUM_OPTS; i++) {
-        /* The NO_SID val is used as special SID value for the case when
-         * no SIDs are found in the rule, but we need to store some
-         * value (SID) with the key (rule name) so that it is clear
-         * that the rule is defined on the server. */
         struct gpo_map_option_entry entry = gpo_map_option_entries[i];
 
         allow_key = entry.allow_key;
@@ -1453,15 +1510,8 @@ ad_gpo_store_policy_settings(struct sss_domain_info *domain,
                       allow_key, ret, sss_strerror(ret));
                 goto done;
             } else if (ret != ENOENT) {
-                const char *value = allow_value ? allow_value : empty_val;
-                ret = sysdb_gpo_store_gpo_result_setting(domain,
-                                                         allow_key,
-                                                         value);
+                ret = ad_gpo_policy_add_setting(policy, allow_key, allow_value);
                 if (ret != EOK) {
-                    DEBUG(SSSDBG_CRIT_FAILURE,
-                          "sysdb_gpo_store_gpo_result_setting failed for key:"
-                          "'%s' value:'%s' [%d][%s]\n", allow_key, allow_value,
-                          ret, sss_strerror(ret));
                     goto done;
                 }
             }
@@ -1480,21 +1530,15 @@ ad_gpo_store_policy_settings(struct sss_domain_info *domain,
                       deny_key, ret, sss_strerror(ret));
                 goto done;
             } else if (ret != ENOENT) {
-                const char *value = deny_value ? deny_value : empty_val;
-                ret = sysdb_gpo_store_gpo_result_setting(domain,
-                                                         deny_key,
-                                                         value);
+                ret = ad_gpo_policy_add_setting(policy, deny_key, deny_value);
                 if (ret != EOK) {
-                    DEBUG(SSSDBG_CRIT_FAILURE,
-                          "sysdb_gpo_store_gpo_result_setting failed for key:"
-                          "'%s' value:'%s' [%d][%s]\n", deny_key, deny_value,
-                          ret, sss_strerror(ret));
                     goto done;
                 }
             }
         }
     }
 
+    *_policy = talloc_steal(mem_ctx, policy);
     ret = EOK;
 
  done:
@@ -1508,6 +1552,84 @@ ad_gpo_store_policy_settings(struct sss_domain_info *domain,
     return ret;
 }
 
+/*
+ * This function returns the parsed policy settings of the GPO with the
+ * given version. The policy file is parsed only if the settings of this
+ * version are not kept in memory yet.
+ */
+static errno_t
+ad_gpo_get_policy_settings(struct ad_access_ctx *access_ctx,
+                           const char *gpo_guid,
+                           int gpt_version,
+                           const char *filename,
+                           struct ad_gpo_policy **_policy)
+{
+    struct ad_gpo_policy *policy;
+    struct ad_gpo_policy *old = NULL;
+    errno_t ret;
+
+    DLIST_FOR_EACH(policy, access_ctx->gpo_policies) {
+        if (strcasecmp(policy->gpo_guid, gpo_guid) == 0) {
+            old = policy;
+            break;
+        }
+    }
+
+    if (old != NULL && old->gpt_version == gpt_version) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Using parsed policy settings of GPO %s "
+              "version %d\n", gpo_guid, gpt_version);
+        *_policy = old;
+        return EOK;
+    }
+
+    ret = ad_gpo_parse_policy_settings(access_ctx, filename, &policy);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    policy->gpo_guid = talloc_strdup(policy, gpo_guid);
+    if (policy->gpo_guid == NULL) {
+        talloc_free(policy);
+        return ENOMEM;
+    }
+    policy->gpt_version = gpt_version;
+
+    if (old != NULL) {
+        DLIST_REMOVE(access_ctx->gpo_policies, old);
+        talloc_free(old);
+    }
+    DLIST_ADD(access_ctx->gpo_policies, policy);
+
+    *_policy = policy;
+    return EOK;
+}
+
+/*
+ * This function stores the policy settings of a GPO as part of the GPO
+ * Result object in the sysdb cache.
+ */
+static errno_t
+ad_gpo_store_policy_settings(struct sss_domain_info *domain,
+                             struct ad_gpo_policy *policy)
+{
+    size_t i;
+    errno_t ret;
+
+    for (i = 0; i < policy->num_settings; i++) {
+        ret = sysdb_gpo_store_gpo_result_setting(domain, policy->keys[i],
+                                                 policy->values[i]);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "sysdb_gpo_store_gpo_result_setting failed for key:"
+                  "'%s' value:'%s' [%d][%s]\n", policy->keys[i],
+                  policy->values[i], ret, sss_strerror(ret));
+            return ret;
+        }
+    }
+
+    return EOK;
+}
+
 /*
  * This cse-specific function (GP_EXT_GUID_SECURITY) performs the access
  * check for determining whether logon access is granted or denied for
@@ -2693,6 +2815,32 @@ ad_gpo_cse_step(struct tevent_req *req)
         return ret;
     }
 
+    if (send_to_child && cached_gpt_version >= 0
+            && cse_filtered_gpo->gpo_version == cached_gpt_version
+            && access(cse_filtered_gpo->policy_filename, R_OK) == 0) {
+        /*
+         * The version of the GPO in LDAP is the same as the version of the
+         * policy files we already have, there is nothing new to download.
+         * Just extend the timeout of the cache entry.
+         */
+        DEBUG(SSSDBG_TRACE_FUNC, "GPO version %d has not changed\n",
+              cached_gpt_version);
+
+        ret = sysdb_gpo_store_gpo(state->host_domain,
+                                  cse_filtered_gpo->gpo_guid,
+                                  cached_gpt_version,
+                                  state->gpo_timeout_option,
+                                  time(NULL));
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Unable to store gpo cache entry: [%d](%s)\n",
+                  ret, sss_strerror(ret));
+            return ret;
+        }
+
+        send_to_child = false;
+    }
+
     DEBUG(SSSDBG_TRACE_FUNC, "send_to_child: %d\n", send_to_child);
     DEBUG(SSSDBG_TRACE_FUNC, "cached_gpt_version: %d\n", cached_gpt_version);
 
@@ -2727,6 +2875,8 @@ ad_gpo_cse_done(struct tevent_req *subreq)
 {
     struct tevent_req *req;
     struct ad_gpo_access_state *state;
+    struct ad_gpo_policy *policy;
+    int sysvol_gpt_version;
     int ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
@@ -2739,7 +2889,7 @@ ad_gpo_cse_done(struct tevent_req *subreq)
 
     DEBUG(SSSDBG_TRACE_FUNC, "gpo_guid: %s\n", gpo_guid);
 
-    ret = ad_gpo_process_cse_recv(subreq);
+    ret = ad_gpo_process_cse_recv(subreq, &sysvol_gpt_version);
 
     talloc_zfree(subreq);
 
@@ -2754,8 +2904,18 @@ ad_gpo_cse_done(struct tevent_req *subreq)
      * GPO CACHE, we store all of the supported keys present in the file
      * (as part of the GPO Result object in the sysdb cache).
      */
-    ret = ad_gpo_store_policy_settings(state->host_domain,
-                                       cse_filtered_gpo->policy_filename);
+    ret = ad_gpo_get_policy_settings(state->access_ctx, gpo_guid,
+                                     sysvol_gpt_version,
+                                     cse_filtered_gpo->policy_filename,
+                                     &policy);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "ad_gpo_get_policy_settings failed: [%d](%s)\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = ad_gpo_store_policy_settings(state->host_domain, policy);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE,
               "ad_gpo_store_policy_settings failed: [%d](%s)\n",
@@ -4402,6 +4562,21 @@ ad_gpo_sd_process_attrs(struct tevent_req *req,
 
     DEBUG(SSSDBG_TRACE_ALL, "gpo_flags: %d\n", gp_gpo->gpo_flags);
 
+    /* retrieve AD_AT_VERSION_NUMBER, it should match the version of the
+     * GPT.INI file on the SYSVOL share */
+    ret = sysdb_attrs_get_int32_t(result, AD_AT_VERSION_NUMBER,
+                                  &gp_gpo->gpo_version);
+    if (ret == ENOENT) {
+        gp_gpo->gpo_version = -1;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "sysdb_attrs_get_int32_t failed: [%d](%s)\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_ALL, "gpo_version: %d\n", gp_gpo->gpo_version);
+
     /* retrieve AD_AT_NT_SEC_DESC */
     ret = sysdb_attrs_get_el(result, AD_AT_NT_SEC_DESC, &el);
     if (ret != EOK && ret != ENOENT) {
@@ -4576,6 +4751,7 @@ struct ad_gpo_process_cse_state {
     const char *gpo_guid;
     const char *smb_path;
     const char *smb_cse_suffix;
+    int sysvol_gpt_version;
     pid_t child_pid;
     uint8_t *buf;
     ssize_t len;
@@ -4618,6 +4794,8 @@ ad_gpo_process_cse_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
+    state->sysvol_gpt_version = cached_gpt_version;
+
     if (!send_to_child) {
         /*
          * if we don't need to talk to child (b/c cache timeout is still valid),
@@ -4758,13 +4936,22 @@ static void gpo_cse_done(struct tevent_req *subreq)
         return;
     }
 
+    state->sysvol_gpt_version = sysvol_gpt_version;
+
     tevent_req_done(req);
     return;
 }
 
-int ad_gpo_process_cse_recv(struct tevent_req *req)
+int ad_gpo_process_cse_recv(struct tevent_req *req,
+                            int *_sysvol_gpt_version)
 {
+    struct ad_gpo_process_cse_state *state;
+
+    state = tevent_req_data(req, struct ad_gpo_process_cse_state);
+
     TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_sysvol_gpt_version = state->sysvol_gpt_version;
     return EOK;
 }
 
@@ -4794,35 +4981,27 @@ gpo_fork_child(struct tevent_req *req)
         goto fail;
     }
 
-    pid = fork();
-
-    if (pid == 0) { /* child */
-        exec_child_ex(state,
-                      pipefd_to_child, pipefd_from_child,
-                      GPO_CHILD, GPO_CHILD_LOG_FILE, NULL, false,
-                      STDIN_FILENO, AD_GPO_CHILD_OUT_FILENO);
+    ret = sss_child_spawn(state,
+                          pipefd_to_child, pipefd_from_child,
+                          GPO_CHILD, GPO_CHILD_LOG_FILE, NULL, false,
+                          STDIN_FILENO, AD_GPO_CHILD_OUT_FILENO, &pid);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not start gpo_child\n");
+        goto fail;
+    }
 
-        /* We should never get here */
-        DEBUG(SSSDBG_CRIT_FAILURE, "BUG: Could not exec gpo_child:\n");
-    } else if (pid > 0) { /* parent */
-        state->child_pid = pid;
-        state->io->read_from_child_fd = pipefd_from_child[0];
-        PIPE_FD_CLOSE(pipefd_from_child[1]);
-        state->io->write_to_child_fd = pipefd_to_child[1];
-        PIPE_FD_CLOSE(pipefd_to_child[0]);
-        sss_fd_nonblocking(state->io->read_from_child_fd);
-        sss_fd_nonblocking(state->io->write_to_child_fd);
+    state->child_pid = pid;
+    state->io->read_from_child_fd = pipefd_from_child[0];
+    PIPE_FD_CLOSE(pipefd_from_child[1]);
+    state->io->write_to_child_fd = pipefd_to_child[1];
+    PIPE_FD_CLOSE(pipefd_to_child[0]);
+    sss_fd_nonblocking(state->io->read_from_child_fd);
+    sss_fd_nonblocking(state->io->write_to_child_fd);
 
-        ret = child_handler_setup(state->ev, pid, NULL, NULL, NULL);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Could not set up child signal handler\n");
-            goto fail;
-        }
-    } else { /* error */
-        ret = errno;
+    ret = child_handler_setup(state->ev, pid, NULL, NULL, NULL);
+    if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
-              "fork failed [%d][%s].\n", errno, strerror(errno));
+              "Could not set up child signal handler\n");
         goto fail;
     }
 
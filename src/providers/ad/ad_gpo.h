@@ -32,6 +32,7 @@
                       AD_AT_MACHINE_EXT_NAMES, \
                       AD_AT_FUNC_VERSION, \
                       AD_AT_FLAGS, \
+                      AD_AT_VERSION_NUMBER, \
                       NULL}
 
 /*
@@ -111,12 +111,22 @@ struct ad_handle_acct_info_state {
     struct ad_options *ad_options;
     bool using_pac;
 
+    /* lookups running at the same time in the GC and the domain LDAP
+     * server with ad_parallel_gc_lookup */
+    struct tevent_req *parallel[2];
+    int num_parallel;
+    errno_t parallel_ret;
+
     int dp_error;
     const char *err;
 };
 
 static errno_t ad_handle_acct_info_step(struct tevent_req *req);
 static void ad_handle_acct_info_done(struct tevent_req *subreq);
+static bool ad_handle_acct_info_can_parallel(struct ad_handle_acct_info_state *state);
+static errno_t ad_handle_acct_info_parallel(struct tevent_req *req);
+static void ad_handle_acct_info_parallel_done(struct tevent_req *subreq);
+static void ad_handle_acct_info_fail(struct tevent_req *req, errno_t ret);
 
 struct tevent_req *
 ad_handle_acct_info_send(TALLOC_CTX *mem_ctx,
@@ -160,7 +170,11 @@ ad_handle_acct_info_send(TALLOC_CTX *mem_ctx,
         goto immediate;
     }
 
-    ret = ad_handle_acct_info_step(req);
+    if (ad_handle_acct_info_can_parallel(state)) {
+        ret = ad_handle_acct_info_parallel(req);
+    } else {
+        ret = ad_handle_acct_info_step(req);
+    }
     if (ret != EAGAIN) {
         goto immediate;
     }
@@ -210,6 +224,7 @@ ad_handle_acct_info_step(struct tevent_req *req)
                                                state->sdom,
                                                state->conn[state->cindex],
                                                noexist_delete,
+                                               state->ad_options,
                                                msg);
             if (subreq == NULL) {
                 DEBUG(SSSDBG_OP_FAILURE, "ad_handle_pac_initgr_send failed.\n");
@@ -302,6 +317,14 @@ ad_handle_acct_info_done(struct tevent_req *subreq)
     return;
 
 fail:
+    ad_handle_acct_info_fail(req, ret);
+}
+
+static void ad_handle_acct_info_fail(struct tevent_req *req, errno_t ret)
+{
+    struct ad_handle_acct_info_state *state = tevent_req_data(req,
+                                            struct ad_handle_acct_info_state);
+
     if (IS_SUBDOMAIN(state->sdom->dom)) {
         /* Deactivate subdomain on lookup errors instead of going
          * offline completely.
@@ -313,7 +336,133 @@ fail:
         ret = ERR_SUBDOM_INACTIVE;
     }
     tevent_req_error(req, ret);
-    return;
+}
+
+/* The GC and the domain LDAP server are searched at the same time if
+ * there are exactly these two connections and the PAC is not used */
+static bool ad_handle_acct_info_can_parallel(struct ad_handle_acct_info_state *state)
+{
+    struct ldb_message *msg;
+    errno_t ret;
+
+    if (state->ad_options == NULL
+            || !dp_opt_get_bool(state->ad_options->basic,
+                                AD_PARALLEL_GC_LOOKUP)) {
+        return false;
+    }
+
+    if (state->conn[0] == NULL || state->conn[1] == NULL
+            || state->conn[2] != NULL) {
+        return false;
+    }
+
+    if ((state->ar->entry_type & BE_REQ_TYPE_MASK) == BE_REQ_INITGROUPS) {
+        ret = check_if_pac_is_available(state, state->sdom->dom,
+                                        state->ar, &msg);
+        if (ret == EOK) {
+            talloc_free(msg);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static errno_t ad_handle_acct_info_parallel(struct tevent_req *req)
+{
+    struct ad_handle_acct_info_state *state = tevent_req_data(req,
+                                            struct ad_handle_acct_info_state);
+    struct tevent_req *subreq;
+    size_t i;
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Searching the Global Catalog and LDAP at the same time\n");
+
+    for (i = 0; i < 2; i++) {
+        /* Nothing is removed from the cache before both missed */
+        subreq = sdap_handle_acct_req_send(state, state->ctx->be,
+                                           state->ar, state->ctx,
+                                           state->sdom, state->conn[i],
+                                           false);
+        if (subreq == NULL) {
+            talloc_zfree(state->parallel[0]);
+            return ENOMEM;
+        }
+        tevent_req_set_callback(subreq, ad_handle_acct_info_parallel_done, req);
+        state->parallel[i] = subreq;
+        state->num_parallel++;
+    }
+
+    return EAGAIN;
+}
+
+static void ad_handle_acct_info_parallel_done(struct tevent_req *subreq)
+{
+    errno_t ret;
+    int dp_error;
+    int sdap_err;
+    const char *err;
+    size_t i;
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct ad_handle_acct_info_state *state = tevent_req_data(req,
+                                            struct ad_handle_acct_info_state);
+
+    i = subreq == state->parallel[0] ? 0 : 1;
+    state->parallel[i] = NULL;
+    state->num_parallel--;
+
+    ret = sdap_handle_acct_req_recv(subreq, &dp_error, &err, &sdap_err);
+    talloc_zfree(subreq);
+    if (i == 0 && dp_error == DP_ERR_OFFLINE
+            && state->conn[0]->ignore_mark_offline) {
+        /* GC does not work, the LDAP lookup is enough */
+        ret = EOK;
+        sdap_err = ENOENT;
+    }
+
+    if (ret == EOK && sdap_err == EOK) {
+        /* The object is stored in the cache, where it is merged with what
+         * the other lookup may already have stored. Like in the lookup one
+         * after the other the first hit completes the request. */
+        DEBUG(SSSDBG_TRACE_FUNC, "Object found in %s, abandoning the "
+              "other lookup\n", i == 0 ? "the Global Catalog" : "LDAP");
+        talloc_zfree(state->parallel[1 - i]);
+        state->num_parallel = 0;
+        tevent_req_done(req);
+        return;
+    }
+
+    if (state->parallel_ret == EOK) {
+        state->dp_error = dp_error;
+        state->err = err;
+        if (ret != EOK) {
+            state->parallel_ret = ret;
+        } else if (sdap_err != ENOENT) {
+            state->parallel_ret = EIO;
+        }
+    }
+
+    if (state->num_parallel > 0) {
+        /* wait for the other lookup */
+        return;
+    }
+
+    if (state->parallel_ret != EOK) {
+        ad_handle_acct_info_fail(req, state->parallel_ret);
+        return;
+    }
+
+    /* Neither found the object. The LDAP server is asked again the way
+     * the last lookup one after the other would, so that an object
+     * removed from the server is removed from the cache as well. */
+    state->cindex = 1;
+    ret = ad_handle_acct_info_step(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        ad_handle_acct_info_fail(req, ret);
+    }
 }
 
 errno_t
@@ -209,14 +209,18 @@ static errno_t ad_init_srv_plugin(struct be_ctx *be_ctx,
     srv_ctx = ad_srv_plugin_ctx_init(be_ctx, be_ctx, be_ctx->be_res,
                                      default_host_dbs, ad_options->id,
                                      hostname, ad_domain,
-                                     ad_site_override);
+                                     ad_site_override,
+                                     dp_opt_get_int(ad_options->basic,
+                                                    AD_DISCOVERY_CACHE_TIMEOUT));
     if (srv_ctx == NULL) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory?\n");
         return ENOMEM;
     }
 
+    /* the AD plugin keeps the discovered servers in the sysdb */
     be_fo_set_srv_lookup_plugin(be_ctx, ad_srv_plugin_send,
-                                ad_srv_plugin_recv, srv_ctx, "AD");
+                                ad_srv_plugin_recv, srv_ctx,
+                                srv_ctx->cache_timeout > 0, "AD");
 
     return EOK;
 }
@@ -227,6 +231,7 @@ static errno_t ad_init_sdap_access_ctx(struct ad_access_ctx *access_ctx)
     struct sdap_id_ctx *sdap_id_ctx = access_ctx->ad_id_ctx->sdap_id_ctx;
     struct sdap_access_ctx *sdap_access_ctx;
     const char *filter;
+    errno_t ret;
 
     sdap_access_ctx = talloc_zero(access_ctx, struct sdap_access_ctx);
     if (sdap_access_ctx == NULL) {
@@ -235,6 +240,14 @@ static errno_t ad_init_sdap_access_ctx(struct ad_access_ctx *access_ctx)
 
     sdap_access_ctx->id_ctx = sdap_id_ctx;
 
+    ret = be_access_cache_init(sdap_access_ctx,
+                               dp_opt_get_int(sdap_id_ctx->opts->basic,
+                                              SDAP_ACCESS_CACHE_TIMEOUT),
+                               &sdap_access_ctx->cache);
+    if (ret != EOK) {
+        talloc_free(sdap_access_ctx);
+        return ret;
+    }
 
     /* If ad_access_filter is set, the value of ldap_acess_order is
      * expire, filter, otherwise only expire.
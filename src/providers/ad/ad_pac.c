@@ -21,6 +21,7 @@
 */
 
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
 #include "providers/ad/ad_pac.h"
 #include "providers/ad/ad_common.h"
 #include "providers/ad/ad_id.h"
@@ -517,6 +518,261 @@ done:
     return ret;
 }
 
+/* The data read from the PAC of a user. It is kept as long as the PAC is
+ * valid, so that the same PAC is not parsed again for every initgroups
+ * request. */
+struct ad_pac_cache_entry {
+    uint8_t *pac_blob;
+    size_t pac_len;
+
+    char *username;
+    char *user_sid;
+    char *primary_group_sid;
+    size_t num_sids;
+    char **group_sids;
+};
+
+static void ad_pac_cache_entry_expired(struct tevent_context *ev,
+                                       struct tevent_timer *te,
+                                       struct timeval tv,
+                                       void *pvt)
+{
+    /* This removes the entry from the table as well. */
+    talloc_free(pvt);
+}
+
+static errno_t ad_pac_cache_get_entry(struct tevent_context *ev,
+                                      struct ad_options *ad_options,
+                                      struct ldb_message *msg,
+                                      struct sss_idmap_ctx *idmap_ctx,
+                                      struct ad_pac_cache_entry **_entry,
+                                      bool *_parsed)
+{
+    struct ad_pac_cache_entry *entry;
+    struct ldb_message_element *el;
+    struct tevent_timer *te;
+    struct timeval tv;
+    uint64_t pac_expires;
+    const char *key;
+    time_t now;
+    errno_t ret;
+
+    el = ldb_msg_find_element(msg, SYSDB_PAC_BLOB);
+    if (el == NULL || el->num_values != 1) {
+        DEBUG(SSSDBG_OP_FAILURE, "Expected exactly one PAC blob.\n");
+        return EINVAL;
+    }
+
+    key = ldb_dn_get_linearized(msg->dn);
+    if (key == NULL) {
+        return EINVAL;
+    }
+
+    if (ad_options->pac_cache == NULL) {
+        ad_options->pac_cache = sss_ptr_hash_create(ad_options, NULL, NULL);
+        if (ad_options->pac_cache == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    entry = sss_ptr_hash_lookup(ad_options->pac_cache, key,
+                                struct ad_pac_cache_entry);
+    if (entry != NULL) {
+        if (entry->pac_len == el->values[0].length
+                && memcmp(entry->pac_blob, el->values[0].data,
+                          entry->pac_len) == 0) {
+            DEBUG(SSSDBG_TRACE_ALL, "PAC of [%s] was already parsed.\n", key);
+            *_entry = entry;
+            *_parsed = false;
+            return EOK;
+        }
+
+        sss_ptr_hash_delete(ad_options->pac_cache, key, true);
+    }
+
+    entry = talloc_zero(ad_options->pac_cache, struct ad_pac_cache_entry);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+
+    ret = ad_get_pac_data_from_user_entry(entry, msg, idmap_ctx,
+                                          &entry->username,
+                                          &entry->user_sid,
+                                          &entry->primary_group_sid,
+                                          &entry->num_sids,
+                                          &entry->group_sids);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "ad_get_pac_data_from_user_entry failed.\n");
+        goto done;
+    }
+
+    entry->pac_blob = talloc_memdup(entry, el->values[0].data,
+                                    el->values[0].length);
+    if (entry->pac_blob == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    entry->pac_len = el->values[0].length;
+
+    pac_expires = ldb_msg_find_attr_as_uint64(msg, SYSDB_PAC_BLOB_EXPIRE, 0);
+    now = time(NULL);
+    tv = tevent_timeval_current_ofs(pac_expires > now ? pac_expires - now : 0,
+                                    0);
+    te = tevent_add_timer(ev, entry, tv, ad_pac_cache_entry_expired, entry);
+    if (te == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sss_ptr_hash_add(ad_options->pac_cache, key, entry,
+                           struct ad_pac_cache_entry);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_entry = entry;
+    *_parsed = true;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(entry);
+    }
+
+    return ret;
+}
+
+errno_t ad_get_cached_pac_data(TALLOC_CTX *mem_ctx,
+                               struct tevent_context *ev,
+                               struct ad_options *ad_options,
+                               struct ldb_message *msg,
+                               struct sss_idmap_ctx *idmap_ctx,
+                               char **_username,
+                               size_t *_num_sids,
+                               char ***_group_sids,
+                               bool *_parsed)
+{
+    struct ad_pac_cache_entry *entry;
+    TALLOC_CTX *tmp_ctx;
+    char *username;
+    char **group_sids;
+    bool parsed;
+    size_t c;
+    errno_t ret;
+
+    ret = ad_pac_cache_get_entry(ev, ad_options, msg, idmap_ctx,
+                                 &entry, &parsed);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    /* The callers own the returned data and may steal or free parts of it,
+     * so the cache entry is never handed out directly. */
+    username = talloc_strdup(tmp_ctx, entry->username);
+    if (username == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    group_sids = talloc_zero_array(tmp_ctx, char *, entry->num_sids + 1);
+    if (group_sids == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (c = 0; c < entry->num_sids; c++) {
+        group_sids[c] = talloc_strdup(group_sids, entry->group_sids[c]);
+        if (group_sids[c] == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    *_username = talloc_steal(mem_ctx, username);
+    *_num_sids = entry->num_sids;
+    *_group_sids = talloc_steal(mem_ctx, group_sids);
+    *_parsed = parsed;
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static void ad_pac_reconcile_initgr_done(struct tevent_req *subreq);
+
+/* The PAC was trusted to answer the request, now run the LDAP lookup of
+ * the group memberships in the background to pick up changes which are
+ * not part of the PAC. */
+static errno_t ad_pac_reconcile_initgr(struct be_ctx *be_ctx,
+                                       struct dp_id_data *ar,
+                                       struct sdap_id_ctx *id_ctx,
+                                       struct sdap_domain *sdom,
+                                       struct sdap_id_conn_ctx *conn,
+                                       bool noexist_delete)
+{
+    struct dp_id_data *bg_ar;
+    struct tevent_req *subreq;
+
+    bg_ar = talloc_zero(id_ctx, struct dp_id_data);
+    if (bg_ar == NULL) {
+        return ENOMEM;
+    }
+
+    bg_ar->entry_type = ar->entry_type;
+    bg_ar->filter_type = ar->filter_type;
+    bg_ar->filter_value = talloc_strdup(bg_ar, ar->filter_value);
+    bg_ar->extra_value = talloc_strdup(bg_ar, ar->extra_value);
+    bg_ar->domain = talloc_strdup(bg_ar, ar->domain);
+    if ((ar->filter_value != NULL && bg_ar->filter_value == NULL)
+            || (ar->extra_value != NULL && bg_ar->extra_value == NULL)
+            || (ar->domain != NULL && bg_ar->domain == NULL)) {
+        talloc_free(bg_ar);
+        return ENOMEM;
+    }
+
+    subreq = sdap_handle_acct_req_send(bg_ar, be_ctx, bg_ar, id_ctx, sdom,
+                                       conn, noexist_delete);
+    if (subreq == NULL) {
+        talloc_free(bg_ar);
+        return ENOMEM;
+    }
+
+    tevent_req_set_callback(subreq, ad_pac_reconcile_initgr_done, bg_ar);
+
+    return EOK;
+}
+
+static void ad_pac_reconcile_initgr_done(struct tevent_req *subreq)
+{
+    struct dp_id_data *bg_ar;
+    const char *err = NULL;
+    int dp_error;
+    int sdap_ret;
+    errno_t ret;
+
+    bg_ar = tevent_req_callback_data(subreq, struct dp_id_data);
+
+    ret = sdap_handle_acct_req_recv(subreq, &dp_error, &err, &sdap_ret);
+    talloc_zfree(subreq);
+    if (ret != EOK || sdap_ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "LDAP initgroups of [%s] after the PAC "
+              "processing failed [%d]: %s\n", bg_ar->filter_value,
+              ret != EOK ? ret : sdap_ret,
+              err != NULL ? err : sss_strerror(ret != EOK ? ret : sdap_ret));
+    } else {
+        DEBUG(SSSDBG_TRACE_FUNC, "Group memberships of [%s] were updated "
+              "from LDAP.\n", bg_ar->filter_value);
+    }
+
+    talloc_free(bg_ar);
+}
+
 struct ad_handle_pac_initgr_state {
     struct dp_id_data *ar;
     const char *err;
@@ -530,10 +786,36 @@ struct ad_handle_pac_initgr_state {
     char **cached_groups;
     char *username;
     struct sss_domain_info *user_dom;
+
+    /* only set if the group memberships from LDAP are requested as well */
+    bool reconcile;
+    struct be_ctx *be_ctx;
+    struct sdap_id_ctx *id_ctx;
+    struct sdap_domain *sdom;
+    struct sdap_id_conn_ctx *conn;
+    bool noexist_delete;
 };
 
 static void ad_handle_pac_initgr_lookup_sids_done(struct tevent_req *subreq);
 
+static void ad_handle_pac_initgr_reconcile(struct ad_handle_pac_initgr_state *state)
+{
+    errno_t ret;
+
+    if (!state->reconcile) {
+        return;
+    }
+
+    ret = ad_pac_reconcile_initgr(state->be_ctx, state->ar, state->id_ctx,
+                                  state->sdom, state->conn,
+                                  state->noexist_delete);
+    if (ret != EOK) {
+        /* Not fatal, the PAC was valid. */
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to start LDAP initgroups "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+}
+
 struct tevent_req *ad_handle_pac_initgr_send(TALLOC_CTX *mem_ctx,
                                              struct be_ctx *be_ctx,
                                              struct dp_id_data *ar,
@@ -541,17 +823,17 @@ struct tevent_req *ad_handle_pac_initgr_send(TALLOC_CTX *mem_ctx,
                                              struct sdap_domain *sdom,
                                              struct sdap_id_conn_ctx *conn,
                                              bool noexist_delete,
+                                             struct ad_options *ad_options,
                                              struct ldb_message *msg)
 {
     int ret;
     struct ad_handle_pac_initgr_state *state;
     struct tevent_req *req;
     struct tevent_req *subreq;
-    char *user_sid;
-    char *primary_group_sid;
     size_t num_sids;
     char **group_sids;
     bool use_id_mapping;
+    bool parsed;
 
     req = tevent_req_create(mem_ctx, &state,
                             struct ad_handle_pac_initgr_state);
@@ -570,16 +852,27 @@ struct tevent_req *ad_handle_pac_initgr_send(TALLOC_CTX *mem_ctx,
     state->dp_error = DP_ERR_OK;
     state->sdap_ret = EOK;
 
-    ret = ad_get_pac_data_from_user_entry(state, msg,
-                                          id_ctx->opts->idmap_ctx->map,
-                                          &state->username,
-                                          &user_sid, &primary_group_sid,
-                                          &num_sids, &group_sids);
+    ret = ad_get_cached_pac_data(state, be_ctx->ev, ad_options, msg,
+                                 id_ctx->opts->idmap_ctx->map,
+                                 &state->username, &num_sids, &group_sids,
+                                 &parsed);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "ad_get_pac_data_from_user_entry failed.\n");
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to read the PAC data.\n");
         goto done;
     }
 
+    /* The LDAP lookup is done only once for each new PAC. */
+    if (parsed && dp_opt_get_bool(ad_options->basic,
+                                  AD_PAC_RECONCILE_INITGROUPS)) {
+        state->reconcile = true;
+        state->ar = ar;
+        state->be_ctx = be_ctx;
+        state->id_ctx = id_ctx;
+        state->sdom = sdom;
+        state->conn = conn;
+        state->noexist_delete = noexist_delete;
+    }
+
     use_id_mapping = sdap_idmap_domain_has_algorithmic_mapping(
                                                        id_ctx->opts->idmap_ctx,
                                                        sdom->dom->name,
@@ -652,6 +945,7 @@ struct tevent_req *ad_handle_pac_initgr_send(TALLOC_CTX *mem_ctx,
 
 done:
     if (ret == EOK) {
+        ad_handle_pac_initgr_reconcile(state);
         tevent_req_done(req);
     } else {
         tevent_req_error(req, ret);
@@ -720,6 +1014,7 @@ done:
         return;
     }
 
+    ad_handle_pac_initgr_reconcile(state);
     tevent_req_done(req);
 }
 
@@ -40,6 +40,8 @@
 #include "util/util.h"
 #include "providers/ldap/ldap_common.h"
 
+struct ad_options;
+
 errno_t check_if_pac_is_available(TALLOC_CTX *mem_ctx,
                                   struct sss_domain_info *dom,
                                   struct dp_id_data *ar,
@@ -66,6 +68,19 @@ errno_t ad_get_pac_data_from_user_entry(TALLOC_CTX *mem_ctx,
                                         size_t *num_sids,
                                         char ***group_sids);
 
+/* Like ad_get_pac_data_from_user_entry() but the data of an unchanged PAC
+ * is taken from a cache. The returned data is a copy owned by mem_ctx.
+ * _parsed is set to true if the PAC was not in the cache. */
+errno_t ad_get_cached_pac_data(TALLOC_CTX *mem_ctx,
+                               struct tevent_context *ev,
+                               struct ad_options *ad_options,
+                               struct ldb_message *msg,
+                               struct sss_idmap_ctx *idmap_ctx,
+                               char **_username,
+                               size_t *_num_sids,
+                               char ***_group_sids,
+                               bool *_parsed);
+
 struct tevent_req *ad_handle_pac_initgr_send(TALLOC_CTX *mem_ctx,
                                              struct be_ctx *be_ctx,
                                              struct dp_id_data *ar,
@@ -73,6 +88,7 @@ struct tevent_req *ad_handle_pac_initgr_send(TALLOC_CTX *mem_ctx,
                                              struct sdap_domain *sdom,
                                              struct sdap_id_conn_ctx *conn,
                                              bool noexist_delete,
+                                             struct ad_options *ad_options,
                                              struct ldb_message *msg);
 
 errno_t ad_handle_pac_initgr_recv(struct tevent_req *req,
@@ -38,6 +38,19 @@
 
 #define AD_SITE_DOMAIN_FMT "%s._sites.%s"
 
+#define AD_SRV_CACHE_SUBDIR "ad_srv"
+#define AD_SRV_CACHE_FOREST "adForest"
+#define AD_SRV_CACHE_DNS_DOMAIN "dnsDomain"
+#define AD_SRV_CACHE_TTL "dnsTTL"
+#define AD_SRV_CACHE_PRIMARY "primaryServer"
+#define AD_SRV_CACHE_BACKUP "backupServer"
+#define AD_SRV_CACHE_SERVER_FMT "%hu %d %s"
+
+/* Maximal delay of the background discovery after the servers were
+ * served from the cache, so the clients that start together do not
+ * contact the DNS and the domain controllers at the same time. */
+#define AD_SRV_CACHE_VALIDATE_DELAY 60
+
 char *ad_site_dns_discovery_domain(TALLOC_CTX *mem_ctx,
                                    const char *site,
                                    const char *domain)
@@ -122,6 +135,9 @@ static void ad_srv_mark_renew_site(void *pvt)
 
     ctx = talloc_get_type(pvt, struct ad_srv_plugin_ctx);
     ctx->renew_site = true;
+
+    /* The cached servers might be the reason why we are offline. */
+    ctx->use_cache = false;
 }
 
 struct ad_srv_plugin_ctx *
@@ -132,7 +148,8 @@ ad_srv_plugin_ctx_init(TALLOC_CTX *mem_ctx,
                        struct sdap_options *opts,
                        const char *hostname,
                        const char *ad_domain,
-                       const char *ad_site_override)
+                       const char *ad_site_override,
+                       int cache_timeout)
 {
     struct ad_srv_plugin_ctx *ctx = NULL;
     errno_t ret;
@@ -147,6 +164,8 @@ ad_srv_plugin_ctx_init(TALLOC_CTX *mem_ctx,
     ctx->host_dbs = host_dbs;
     ctx->opts = opts;
     ctx->renew_site = true;
+    ctx->cache_timeout = cache_timeout;
+    ctx->use_cache = cache_timeout > 0;
 
     ctx->hostname = talloc_strdup(ctx, hostname);
     if (ctx->hostname == NULL) {
@@ -240,12 +259,183 @@ ad_srv_plugin_ctx_switch_site(struct ad_srv_plugin_ctx *ctx,
     return EOK;
 }
 
+static char *ad_srv_cache_key(TALLOC_CTX *mem_ctx,
+                              const char *service,
+                              const char *protocol,
+                              const char *discovery_domain)
+{
+    return talloc_asprintf(mem_ctx, "_%s._%s.%s", service, protocol,
+                           discovery_domain);
+}
+
+static errno_t ad_srv_cache_add_servers(struct sysdb_attrs *attrs,
+                                        const char *name,
+                                        struct fo_server_info *servers,
+                                        size_t num_servers)
+{
+    char *value;
+    size_t i;
+    errno_t ret;
+
+    for (i = 0; i < num_servers; i++) {
+        value = talloc_asprintf(attrs, AD_SRV_CACHE_SERVER_FMT,
+                                servers[i].priority, servers[i].port,
+                                servers[i].host);
+        if (value == NULL) {
+            return ENOMEM;
+        }
+
+        ret = sysdb_attrs_add_string_safe(attrs, name, value);
+        talloc_free(value);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    return EOK;
+}
+
+static errno_t ad_srv_cache_store(struct ad_srv_plugin_ctx *ctx,
+                                  const char *key,
+                                  const char *site,
+                                  const char *forest,
+                                  const char *dns_domain,
+                                  uint32_t ttl,
+                                  struct fo_server_info *primary_servers,
+                                  size_t num_primary_servers,
+                                  struct fo_server_info *backup_servers,
+                                  size_t num_backup_servers)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sysdb_attrs *attrs;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    attrs = sysdb_new_attrs(tmp_ctx);
+    if (attrs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (site != NULL) {
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SITE, site);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    if (forest != NULL) {
+        ret = sysdb_attrs_add_string(attrs, AD_SRV_CACHE_FOREST, forest);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    if (dns_domain != NULL) {
+        ret = sysdb_attrs_add_string(attrs, AD_SRV_CACHE_DNS_DOMAIN,
+                                     dns_domain);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = sysdb_attrs_add_uint32(attrs, AD_SRV_CACHE_TTL, ttl);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_CACHE_EXPIRE,
+                                 time(NULL) + ctx->cache_timeout);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = ad_srv_cache_add_servers(attrs, AD_SRV_CACHE_PRIMARY,
+                                   primary_servers, num_primary_servers);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = ad_srv_cache_add_servers(attrs, AD_SRV_CACHE_BACKUP,
+                                   backup_servers, num_backup_servers);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* Remove the previous entry first, sysdb_store_custom() would keep the
+     * attributes that are missing in the new one. */
+    ret = sysdb_delete_custom(ctx->be_ctx->domain, key, AD_SRV_CACHE_SUBDIR);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_store_custom(ctx->be_ctx->domain, key, AD_SRV_CACHE_SUBDIR,
+                             attrs);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t ad_srv_cache_get_servers(TALLOC_CTX *mem_ctx,
+                                        struct ldb_message *msg,
+                                        const char *name,
+                                        struct fo_server_info **_servers,
+                                        size_t *_num_servers)
+{
+    struct ldb_message_element *el;
+    struct fo_server_info *servers;
+    const char *value;
+    int offset;
+    size_t i;
+
+    el = ldb_msg_find_element(msg, name);
+    if (el == NULL || el->num_values == 0) {
+        *_servers = NULL;
+        *_num_servers = 0;
+        return EOK;
+    }
+
+    servers = talloc_zero_array(mem_ctx, struct fo_server_info,
+                                el->num_values);
+    if (servers == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < el->num_values; i++) {
+        value = (const char *)el->values[i].data;
+        if (sscanf(value, "%hu %d %n", &servers[i].priority,
+                   &servers[i].port, &offset) != 2
+                || value[offset] == '\0') {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Malformed cached server [%s]\n", value);
+            talloc_free(servers);
+            return EINVAL;
+        }
+
+        servers[i].host = talloc_strdup(servers, value + offset);
+        if (servers[i].host == NULL) {
+            talloc_free(servers);
+            return ENOMEM;
+        }
+    }
+
+    *_servers = servers;
+    *_num_servers = el->num_values;
+    return EOK;
+}
+
 struct ad_srv_plugin_state {
     struct tevent_context *ev;
     struct ad_srv_plugin_ctx *ctx;
     const char *service;
     const char *protocol;
     const char *discovery_domain;
+    const char *cache_key;
 
     const char *site;
     char *dns_domain;
@@ -260,6 +450,183 @@ struct ad_srv_plugin_state {
 static void ad_srv_plugin_ping_done(struct tevent_req *subreq);
 static void ad_srv_plugin_servers_done(struct tevent_req *subreq);
 
+/* The cached servers of each query are used only once after startup and
+ * never after we went offline. Later lookups do the discovery. */
+static errno_t ad_srv_cache_lookup(struct ad_srv_plugin_state *state)
+{
+    struct ad_srv_plugin_ctx *ctx = state->ctx;
+    const char *attrs[] = { SYSDB_SITE, AD_SRV_CACHE_FOREST,
+                            AD_SRV_CACHE_DNS_DOMAIN, AD_SRV_CACHE_TTL,
+                            SYSDB_CACHE_EXPIRE, AD_SRV_CACHE_PRIMARY,
+                            AD_SRV_CACHE_BACKUP, NULL };
+    struct ldb_message **msgs;
+    const char *site;
+    const char *forest;
+    const char *dns_domain;
+    size_t count;
+    time_t expire;
+    errno_t ret;
+
+    if (!ctx->use_cache
+            || string_in_list(state->cache_key, ctx->cache_served, false)) {
+        return ENOENT;
+    }
+
+    ret = add_string_to_list(ctx, state->cache_key, &ctx->cache_served);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sysdb_search_custom_by_name(state, ctx->be_ctx->domain,
+                                      state->cache_key, AD_SRV_CACHE_SUBDIR,
+                                      attrs, &count, &msgs);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    expire = ldb_msg_find_attr_as_uint64(msgs[0], SYSDB_CACHE_EXPIRE, 0);
+    if (expire < time(NULL)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Cached servers of [%s] are expired\n",
+              state->cache_key);
+        return ENOENT;
+    }
+
+    site = ldb_msg_find_attr_as_string(msgs[0], SYSDB_SITE, NULL);
+    if (ctx->ad_site_override != NULL
+            && (site == NULL || strcmp(site, ctx->ad_site_override) != 0)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Cached servers of [%s] are not from the "
+              "configured site\n", state->cache_key);
+        return ENOENT;
+    }
+
+    dns_domain = ldb_msg_find_attr_as_string(msgs[0], AD_SRV_CACHE_DNS_DOMAIN,
+                                             NULL);
+    if (dns_domain == NULL) {
+        return ENOENT;
+    }
+
+    ret = ad_srv_cache_get_servers(state, msgs[0], AD_SRV_CACHE_PRIMARY,
+                                   &state->primary_servers,
+                                   &state->num_primary_servers);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (state->num_primary_servers == 0) {
+        return ENOENT;
+    }
+
+    ret = ad_srv_cache_get_servers(state, msgs[0], AD_SRV_CACHE_BACKUP,
+                                   &state->backup_servers,
+                                   &state->num_backup_servers);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    forest = ldb_msg_find_attr_as_string(msgs[0], AD_SRV_CACHE_FOREST, NULL);
+
+    state->site = talloc_strdup(state, site);
+    state->forest = talloc_strdup(state, forest);
+    state->dns_domain = talloc_strdup(state, dns_domain);
+    if ((site != NULL && state->site == NULL)
+            || (forest != NULL && state->forest == NULL)
+            || state->dns_domain == NULL) {
+        return ENOMEM;
+    }
+
+    state->ttl = ldb_msg_find_attr_as_uint(msgs[0], AD_SRV_CACHE_TTL, 0);
+
+    return ad_srv_plugin_ctx_switch_site(ctx, state->site, state->forest);
+}
+
+struct ad_srv_validate_ctx {
+    struct ad_srv_plugin_ctx *ctx;
+    const char *service;
+    const char *protocol;
+    const char *discovery_domain;
+};
+
+static void ad_srv_cache_validate_done(struct tevent_req *subreq);
+
+static void ad_srv_cache_validate(struct tevent_context *ev,
+                                  struct tevent_timer *te,
+                                  struct timeval tv,
+                                  void *pvt)
+{
+    struct ad_srv_validate_ctx *vctx;
+    struct tevent_req *subreq;
+
+    vctx = talloc_get_type(pvt, struct ad_srv_validate_ctx);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Validating the cached servers of "
+          "[_%s._%s.%s]\n", vctx->service, vctx->protocol,
+          vctx->discovery_domain);
+
+    subreq = ad_srv_plugin_send(vctx, ev, vctx->service, vctx->protocol,
+                                vctx->discovery_domain, vctx->ctx);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Out of memory!\n");
+        talloc_free(vctx);
+        return;
+    }
+
+    tevent_req_set_callback(subreq, ad_srv_cache_validate_done, vctx);
+}
+
+static void ad_srv_cache_validate_done(struct tevent_req *subreq)
+{
+    struct ad_srv_validate_ctx *vctx;
+    errno_t ret;
+
+    vctx = tevent_req_callback_data(subreq, struct ad_srv_validate_ctx);
+
+    /* The discovery updates the cache by itself. */
+    ret = ad_srv_plugin_recv(vctx, subreq, NULL, NULL, NULL, NULL, NULL, NULL);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to validate the cached servers "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
+    talloc_free(vctx);
+}
+
+static errno_t ad_srv_cache_schedule_validation(struct ad_srv_plugin_ctx *ctx,
+                                                struct tevent_context *ev,
+                                                const char *service,
+                                                const char *protocol,
+                                                const char *discovery_domain)
+{
+    struct ad_srv_validate_ctx *vctx;
+    struct tevent_timer *te;
+    struct timeval tv;
+
+    vctx = talloc_zero(ctx, struct ad_srv_validate_ctx);
+    if (vctx == NULL) {
+        return ENOMEM;
+    }
+
+    vctx->ctx = ctx;
+    vctx->service = talloc_strdup(vctx, service);
+    vctx->protocol = talloc_strdup(vctx, protocol);
+    vctx->discovery_domain = talloc_strdup(vctx, discovery_domain);
+    if (vctx->service == NULL || vctx->protocol == NULL
+            || vctx->discovery_domain == NULL) {
+        talloc_free(vctx);
+        return ENOMEM;
+    }
+
+    tv = tevent_timeval_current_ofs(sss_rand() % AD_SRV_CACHE_VALIDATE_DELAY,
+                                    0);
+    te = tevent_add_timer(ev, vctx, tv, ad_srv_cache_validate, vctx);
+    if (te == NULL) {
+        talloc_free(vctx);
+        return ENOMEM;
+    }
+
+    return EOK;
+}
+
 /* 1. Do a DNS lookup to find any DC in domain
  *    _ldap._tcp.domain.name
  * 2. Send a CLDAP ping to the found DC to get the desirable site
@@ -321,6 +688,35 @@ struct tevent_req *ad_srv_plugin_send(TALLOC_CTX *mem_ctx,
         goto immediately;
     }
 
+    state->cache_key = ad_srv_cache_key(state, service, protocol,
+                                        state->discovery_domain);
+    if (state->cache_key == NULL) {
+        ret = ENOMEM;
+        goto immediately;
+    }
+
+    ret = ad_srv_cache_lookup(state);
+    if (ret == EOK) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Using %zu primary and %zu backup servers "
+              "of [%s] from the cache\n", state->num_primary_servers,
+              state->num_backup_servers, state->cache_key);
+
+        ret = ad_srv_cache_schedule_validation(ctx, ev, service, protocol,
+                                               state->discovery_domain);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to schedule the validation "
+                  "of the cached servers [%d]: %s\n", ret, sss_strerror(ret));
+        }
+
+        tevent_req_done(req);
+        tevent_req_post(req, ev);
+        return req;
+    } else if (ret != ENOENT) {
+        /* Not fatal, do the discovery. */
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to read the cached servers "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
     subreq = ad_cldap_ping_send(state, ev, state->ctx, state->discovery_domain);
     if (subreq == NULL) {
         ret = ENOMEM;
@@ -492,6 +888,20 @@ static void ad_srv_plugin_servers_done(struct tevent_req *subreq)
         /* continue */
     }
 
+    if (state->ctx->cache_timeout > 0) {
+        ret = ad_srv_cache_store(state->ctx, state->cache_key, state->site,
+                                 state->forest, state->dns_domain, state->ttl,
+                                 state->primary_servers,
+                                 state->num_primary_servers,
+                                 state->backup_servers,
+                                 state->num_backup_servers);
+        if (ret != EOK) {
+            /* Not fatal. */
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to store the servers in the "
+                  "cache [%d]: %s\n", ret, sss_strerror(ret));
+        }
+    }
+
     tevent_req_done(req);
 }
 
@@ -33,6 +33,13 @@ struct ad_srv_plugin_ctx {
     const char *current_forest;
 
     bool renew_site;
+
+    /* Discovery results are kept in the cache for cache_timeout seconds.
+     * Each of them is served from there at most once after startup, the
+     * discovery is then repeated in the background. */
+    int cache_timeout;
+    bool use_cache;
+    char **cache_served;
 };
 
 struct ad_srv_plugin_ctx *
@@ -43,7 +50,8 @@ ad_srv_plugin_ctx_init(TALLOC_CTX *mem_ctx,
                        struct sdap_options *opts,
                        const char *hostname,
                        const char *ad_domain,
-                       const char *ad_site_override);
+                       const char *ad_site_override,
+                       int cache_timeout);
 
 struct tevent_req *ad_srv_plugin_send(TALLOC_CTX *mem_ctx,
                                        struct tevent_context *ev,
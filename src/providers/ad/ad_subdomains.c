@@ -411,13 +411,17 @@ ad_subdom_ad_ctx_new(struct be_ctx *be_ctx,
                                      ad_id_ctx->ad_options->id,
                                      hostname,
                                      ad_domain,
-                                     ad_site_override);
+                                     ad_site_override,
+                                     dp_opt_get_int(ad_options->basic,
+                                                    AD_DISCOVERY_CACHE_TIMEOUT));
     if (srv_ctx == NULL) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory?\n");
         return ENOMEM;
     }
+    /* the AD plugin keeps the discovered servers in the sysdb */
     be_fo_set_srv_lookup_plugin(be_ctx, ad_srv_plugin_send,
-                                ad_srv_plugin_recv, srv_ctx, "AD");
+                                ad_srv_plugin_recv, srv_ctx,
+                                srv_ctx->cache_timeout > 0, "AD");
 
     ret = sdap_domain_subdom_add(ad_id_ctx->sdap_id_ctx,
                                  ad_id_ctx->sdap_id_ctx->opts->sdom,
@@ -2270,7 +2274,8 @@ errno_t ad_subdomains_init(TALLOC_CTX *mem_ctx,
                           sd_ctx,
                           "Subdomains Refresh",
                           BE_PTASK_OFFLINE_DISABLE |
-                          BE_PTASK_SCHEDULE_FROM_LAST,
+                          BE_PTASK_SCHEDULE_FROM_LAST |
+                          BE_PTASK_BULK,
                           NULL);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to setup ptask "
@@ -2328,6 +2333,7 @@ static int ad_check_domain_destructor(void *mem)
         sss_domain_set_state(state->dom, DOM_DISABLED);
         DLIST_REMOVE(state->be_ctx->domain->subdomains, state->dom);
         talloc_zfree(state->dom);
+        sss_domain_index_invalidate();
     }
 
     return 0;
@@ -2385,6 +2391,7 @@ ad_check_domain_send(TALLOC_CTX *mem_ctx,
 
         DLIST_ADD_END(state->parent->subdomains, state->dom,
                       struct sss_domain_info *);
+        sss_domain_index_invalidate();
 
         ret = sdap_domain_add(state->opts, state->dom, &state->sdom);
         if (ret != EOK) {
@@ -60,6 +60,11 @@ struct be_svc_data {
 
     struct be_svc_callback *callbacks;
     struct fo_server *first_resolved;
+
+    /* search tuning reported by the provider, zero if none */
+    uint32_t page_size;
+    uint32_t pool_size;
+    uint32_t page_msecs;
 };
 
 struct be_failover_ctx {
@@ -104,6 +109,10 @@ struct be_ctx {
     /* Periodically check if we can go online. */
     struct be_ptask *check_if_online_ptask;
 
+    /* Periodic tasks that load the servers in bulk. */
+    unsigned int ptask_bulk_running;
+    struct be_ptask *ptask_bulk_waiting;
+
     struct sbus_connection *mon_conn;
 
     struct be_refresh_ctx *refresh_ctx;
@@ -170,6 +179,7 @@ void be_fo_set_srv_lookup_plugin(struct be_ctx *ctx,
                                  fo_srv_lookup_plugin_send_t send_fn,
                                  fo_srv_lookup_plugin_recv_t recv_fn,
                                  void *pvt,
+                                 bool persistent,
                                  const char *plugin_name);
 
 errno_t be_fo_set_dns_srv_lookup_plugin(struct be_ctx *be_ctx,
@@ -190,10 +200,22 @@ struct tevent_req *be_resolve_server_send(TALLOC_CTX *memctx,
                                           struct be_ctx *ctx,
                                           const char *service_name,
                                           bool first_try);
+/* Resolves a server other than those with a connection attempt in progress,
+ * see fo_set_server_connecting(). Finish with be_resolve_server_recv(). */
+struct tevent_req *be_resolve_other_server_send(TALLOC_CTX *memctx,
+                                                struct tevent_context *ev,
+                                                struct be_ctx *ctx,
+                                                const char *service_name);
 int be_resolve_server_recv(struct tevent_req *req,
                            TALLOC_CTX *ref_ctx,
                            struct fo_server **srv);
 
+/* Runs the service callbacks for 'server' unless they were run for it last,
+ * for when several servers were resolved and 'server' is the one used. */
+errno_t be_fo_use_server(struct be_ctx *ctx,
+                         const char *service_name,
+                         struct fo_server *server);
+
 #define be_fo_set_port_status(ctx, service_name, server, status) \
     _be_fo_set_port_status(ctx, service_name, server, status, \
                            __LINE__, __FILE__, __FUNCTION__)
@@ -213,6 +235,14 @@ void _be_fo_set_port_status(struct be_ctx *ctx,
  */
 void be_fo_try_next_server(struct be_ctx *ctx, const char *service_name);
 
+/* Remember the search tuning the provider uses with the active server so
+ * that it can be queried through the failover interface. */
+void be_fo_set_server_tuning(struct be_ctx *ctx,
+                             const char *service_name,
+                             uint32_t page_size,
+                             uint32_t pool_size,
+                             uint32_t page_msecs);
+
 int be_fo_run_callbacks_at_next_request(struct be_ctx *ctx,
                                         const char *service_name);
 
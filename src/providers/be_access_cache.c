@@ -0,0 +1,215 @@
+/*
+    SSSD
+
+    Cache of the access control decisions of a provider
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "util/util.h"
+#include "util/sss_ptr_hash.h"
+#include "shared/murmurhash3.h"
+#include "db/sysdb.h"
+#include "providers/be_access_cache.h"
+
+/* SSH, cron and similar services open several sessions of the same user in
+ * a short time, each of them asks the access provider again. The cache keeps
+ * the decision of a user for a short time, as long as neither the entry of
+ * the user nor the rules changed in between. */
+
+#define BE_ACCESS_CACHE_MAX_ENTRIES 4096
+
+struct be_access_cache {
+    hash_table_t *table;
+    time_t timeout;
+};
+
+struct be_access_cache_entry {
+    uint32_t state;
+    bool allowed;
+    time_t expire;
+    time_t refresh;
+};
+
+errno_t be_access_cache_init(TALLOC_CTX *mem_ctx,
+                             time_t timeout,
+                             struct be_access_cache **_cache)
+{
+    struct be_access_cache *cache;
+
+    if (timeout <= 0) {
+        *_cache = NULL;
+        return EOK;
+    }
+
+    cache = talloc_zero(mem_ctx, struct be_access_cache);
+    if (cache == NULL) {
+        return ENOMEM;
+    }
+    cache->timeout = timeout;
+
+    cache->table = sss_ptr_hash_create(cache, NULL, NULL);
+    if (cache->table == NULL) {
+        talloc_free(cache);
+        return ENOMEM;
+    }
+
+    *_cache = cache;
+    return EOK;
+}
+
+static uint32_t be_access_cache_hash(const char *str, uint32_t seed)
+{
+    if (str == NULL) {
+        return seed;
+    }
+
+    return murmurhash3(str, strlen(str) + 1, seed);
+}
+
+uint32_t be_access_cache_user_state(struct ldb_message *user_entry,
+                                    const char *rules)
+{
+    struct ldb_message_element *el;
+    uint32_t state;
+    unsigned int i;
+
+    state = be_access_cache_hash(rules, 0xdeadbeef);
+    state = be_access_cache_hash(ldb_msg_find_attr_as_string(user_entry,
+                                                      SYSDB_ORIG_MODSTAMP,
+                                                      NULL),
+                                 state);
+
+    el = ldb_msg_find_element(user_entry, SYSDB_MEMBEROF);
+    if (el != NULL) {
+        for (i = 0; i < el->num_values; i++) {
+            state = murmurhash3((const char *)el->values[i].data,
+                                el->values[i].length, state);
+        }
+    }
+
+    return state;
+}
+
+errno_t be_access_cache_check(struct be_access_cache *cache,
+                              const char *username,
+                              uint32_t state,
+                              bool *_allowed,
+                              bool *_refresh)
+{
+    struct be_access_cache_entry *entry;
+    time_t now;
+
+    if (cache == NULL) {
+        return ENOENT;
+    }
+
+    entry = sss_ptr_hash_lookup(cache->table, username,
+                                struct be_access_cache_entry);
+    if (entry == NULL) {
+        return ENOENT;
+    }
+
+    now = time(NULL);
+    if (entry->expire <= now || entry->state != state) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Cached access decision of [%s] is no longer valid\n",
+              username);
+        talloc_free(entry);
+        return ENOENT;
+    }
+
+    *_refresh = false;
+    if (entry->refresh <= now) {
+        /* only one refresh of each decision */
+        entry->refresh = entry->expire;
+        *_refresh = true;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Access of [%s] %s by cached decision\n",
+          username, entry->allowed ? "granted" : "denied");
+    *_allowed = entry->allowed;
+    return EOK;
+}
+
+static void be_access_cache_purge(struct be_access_cache *cache)
+{
+    struct be_access_cache_entry *entry;
+    hash_value_t *values;
+    unsigned long count;
+    unsigned long i;
+    time_t now;
+    int hret;
+
+    hret = hash_values(cache->table, &count, &values);
+    if (hret != HASH_SUCCESS) {
+        return;
+    }
+
+    now = time(NULL);
+    for (i = 0; i < count; i++) {
+        entry = sss_ptr_get_value(&values[i], struct be_access_cache_entry);
+        if (entry != NULL && entry->expire <= now) {
+            talloc_free(entry);
+        }
+    }
+
+    talloc_free(values);
+}
+
+errno_t be_access_cache_add(struct be_access_cache *cache,
+                            const char *username,
+                            uint32_t state,
+                            bool allowed)
+{
+    struct be_access_cache_entry *entry;
+    errno_t ret;
+
+    if (cache == NULL) {
+        return EOK;
+    }
+
+    /* replace the previous decision */
+    talloc_free(sss_ptr_hash_lookup(cache->table, username,
+                                    struct be_access_cache_entry));
+
+    if (hash_count(cache->table) >= BE_ACCESS_CACHE_MAX_ENTRIES) {
+        be_access_cache_purge(cache);
+        if (hash_count(cache->table) >= BE_ACCESS_CACHE_MAX_ENTRIES) {
+            DEBUG(SSSDBG_TRACE_INTERNAL, "Access decision cache is full.\n");
+            return EOK;
+        }
+    }
+
+    entry = talloc_zero(cache, struct be_access_cache_entry);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+    entry->state = state;
+    entry->allowed = allowed;
+    entry->expire = time(NULL) + cache->timeout;
+    entry->refresh = entry->expire - cache->timeout / 2;
+
+    ret = sss_ptr_hash_add(cache->table, username, entry,
+                           struct be_access_cache_entry);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Could not cache the access decision of [%s] [%d]: %s\n",
+              username, ret, sss_strerror(ret));
+        talloc_free(entry);
+        return ret;
+    }
+
+    return EOK;
+}
@@ -0,0 +1,57 @@
+/*
+    SSSD
+
+    Cache of the access control decisions of a provider
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _BE_ACCESS_CACHE_H_
+#define _BE_ACCESS_CACHE_H_
+
+#include <talloc.h>
+#include <ldb.h>
+
+#include "util/util_errors.h"
+
+struct be_access_cache;
+
+/* A timeout of 0 disables the cache, *_cache is then set to NULL, which all
+ * other functions accept. */
+errno_t be_access_cache_init(TALLOC_CTX *mem_ctx,
+                             time_t timeout,
+                             struct be_access_cache **_cache);
+
+/* Returns a value which changes when the cached entry of the user changes on
+ * the server or its group memberships change, combined with the rules the
+ * decision is made with. A decision is only used with the same value. */
+uint32_t be_access_cache_user_state(struct ldb_message *user_entry,
+                                    const char *rules);
+
+/* Returns EOK and the decision for the user if there is one for the same
+ * state and it did not expire yet, ENOENT otherwise. _refresh is set once
+ * for each decision which is past half of its lifetime, the caller is
+ * expected to make the decision again in the background then. */
+errno_t be_access_cache_check(struct be_access_cache *cache,
+                              const char *username,
+                              uint32_t state,
+                              bool *_allowed,
+                              bool *_refresh);
+
+errno_t be_access_cache_add(struct be_access_cache *cache,
+                            const char *username,
+                            uint32_t state,
+                            bool allowed);
+
+#endif /* _BE_ACCESS_CACHE_H_ */
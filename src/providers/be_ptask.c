@@ -22,15 +22,21 @@
 #include <talloc.h>
 #include <time.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "util/util.h"
+#include "util/dlinklist.h"
 #include "util/crypto/sss_crypto.h"
+#include "shared/murmurhash3.h"
 #include "providers/backend.h"
 #include "providers/be_ptask_private.h"
 #include "providers/be_ptask.h"
 
 #define backoff_allowed(ptask) (ptask->max_backoff != 0)
 
+/* The delay after overload errors is at most 2^MAX times the period */
+#define BE_PTASK_OVERLOAD_MAX 4
+
 enum be_ptask_delay {
     BE_PTASK_FIRST_DELAY,
     BE_PTASK_ENABLED_DELAY,
@@ -41,6 +47,52 @@ static void be_ptask_schedule(struct be_ptask *task,
                               enum be_ptask_delay delay_type,
                               uint32_t from);
 
+static void be_ptask_execute(struct tevent_context *ev,
+                             struct tevent_timer *tt,
+                             struct timeval tv,
+                             void *pvt);
+
+static void be_ptask_bulk_unqueue(struct be_ptask *task)
+{
+    if (!task->bulk_waiting) {
+        return;
+    }
+
+    DLIST_REMOVE(task->be_ctx->ptask_bulk_waiting, task);
+    task->bulk_waiting = false;
+}
+
+/* A bulk task finished, let the next waiting one run. */
+static void be_ptask_bulk_release(struct be_ptask *task)
+{
+    struct be_ctx *be_ctx = task->be_ctx;
+    struct be_ptask *next;
+
+    if (!task->bulk_running) {
+        return;
+    }
+
+    task->bulk_running = false;
+    be_ctx->ptask_bulk_running--;
+
+    next = be_ctx->ptask_bulk_waiting;
+    if (next == NULL) {
+        return;
+    }
+
+    be_ptask_bulk_unqueue(next);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Task [%s]: resuming\n", next->name);
+
+    next->timer = tevent_add_timer(next->ev, next, tevent_timeval_zero(),
+                                   be_ptask_execute, next);
+    if (next->timer == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to resume task [%s]\n",
+                                    next->name);
+        be_ptask_disable(next);
+    }
+}
+
 static int be_ptask_destructor(void *pvt)
 {
     struct be_ptask *task;
@@ -53,9 +105,62 @@ static int be_ptask_destructor(void *pvt)
 
     DEBUG(SSSDBG_TRACE_FUNC, "Terminating periodic task [%s]\n", task->name);
 
+    be_ptask_bulk_unqueue(task);
+    be_ptask_bulk_release(task);
+
     return 0;
 }
 
+static bool be_ptask_is_overload(errno_t ret)
+{
+    switch (ret) {
+    case ETIMEDOUT:
+    case EBUSY:
+    case ERR_NETWORK_IO:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Record the end of a run. */
+static void be_ptask_finished(struct be_ptask *task, errno_t ret)
+{
+    struct timeval now = tevent_timeval_current();
+    uint64_t duration;
+
+    duration = (now.tv_sec - task->started.tv_sec) * 1000
+               + (now.tv_usec - task->started.tv_usec) / 1000;
+
+    task->stats.last_duration = duration;
+    task->stats.total_duration += duration;
+    task->stats.max_duration = MAX(task->stats.max_duration, duration);
+
+    if (ret == ETIMEDOUT) {
+        task->stats.timeouts++;
+    }
+
+    if (ret != EOK) {
+        task->stats.failures++;
+    }
+
+    if (be_ptask_is_overload(ret)) {
+        task->stats.overload = MIN(task->stats.overload + 1,
+                                   BE_PTASK_OVERLOAD_MAX);
+        DEBUG(SSSDBG_MINOR_FAILURE, "Task [%s]: server seems overloaded, "
+              "backing off %u time(s)\n", task->name, task->stats.overload);
+    } else if (ret == EOK) {
+        task->stats.overload = 0;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Task [%s]: run took %"PRIu64" ms, "
+          "%"PRIu64" runs, %"PRIu64" failed, %"PRIu64" timed out\n",
+          task->name, duration, task->stats.runs, task->stats.failures,
+          task->stats.timeouts);
+
+    be_ptask_bulk_release(task);
+}
+
 static void be_ptask_online_cb(void *pvt)
 {
     struct be_ptask *task = NULL;
@@ -90,6 +195,7 @@ static void be_ptask_timeout(struct tevent_context *ev,
     DEBUG(SSSDBG_OP_FAILURE, "Task [%s]: timed out\n", task->name);
 
     talloc_zfree(task->req);
+    be_ptask_finished(task, ETIMEDOUT);
     be_ptask_schedule(task, BE_PTASK_PERIOD, BE_PTASK_SCHEDULE_FROM_NOW);
 }
 
@@ -124,10 +230,28 @@ static void be_ptask_execute(struct tevent_context *ev,
         /* continue */
     }
 
+    if (task->flags & BE_PTASK_BULK) {
+        if (task->be_ctx->ptask_bulk_running >= BE_PTASK_BULK_MAX_RUNNING) {
+            DEBUG(SSSDBG_TRACE_FUNC, "Task [%s]: %u bulk tasks are running, "
+                  "waiting\n", task->name, task->be_ctx->ptask_bulk_running);
+
+            DLIST_ADD_END(task->be_ctx->ptask_bulk_waiting, task,
+                          struct be_ptask *);
+            task->bulk_waiting = true;
+            task->stats.deferred++;
+            return;
+        }
+
+        task->bulk_running = true;
+        task->be_ctx->ptask_bulk_running++;
+    }
+
     DEBUG(SSSDBG_TRACE_FUNC, "Task [%s]: executing task, timeout %lu "
                               "seconds\n", task->name, task->timeout);
 
     task->last_execution = tv.tv_sec;
+    task->started = tevent_timeval_current();
+    task->stats.runs++;
 
     task->req = task->send_fn(task, task->ev, task->be_ctx, task, task->pvt);
     if (task->req == NULL) {
@@ -135,6 +259,7 @@ static void be_ptask_execute(struct tevent_context *ev,
         DEBUG(SSSDBG_OP_FAILURE, "Task [%s]: failed to execute task, "
               "will try again later\n", task->name);
 
+        be_ptask_finished(task, ENOMEM);
         be_ptask_schedule(task, BE_PTASK_PERIOD, BE_PTASK_SCHEDULE_FROM_NOW);
         return;
     }
@@ -150,6 +275,7 @@ static void be_ptask_execute(struct tevent_context *ev,
             /* If we can't guarantee a timeout,
              * we need to cancel the request. */
             talloc_zfree(task->req);
+            be_ptask_finished(task, ENOMEM);
 
             DEBUG(SSSDBG_OP_FAILURE, "Task [%s]: failed to set timeout, "
                   "the task will be rescheduled\n", task->name);
@@ -172,6 +298,7 @@ static void be_ptask_done(struct tevent_req *req)
     ret = task->recv_fn(req);
     talloc_zfree(req);
     task->req = NULL;
+    be_ptask_finished(task, ret);
     switch (ret) {
     case EOK:
         DEBUG(SSSDBG_TRACE_FUNC, "Task [%s]: finished successfully\n",
@@ -220,6 +347,13 @@ static void be_ptask_schedule(struct be_ptask *task,
         }
 
         delay = task->period;
+
+        /* move the schedule of a bulk task to its phase on this host */
+        delay = delay + task->host_phase;
+        task->host_phase = 0;
+
+        /* back off from an overloaded server */
+        delay = delay << task->stats.overload;
         break;
     }
 
@@ -259,6 +393,34 @@ static void be_ptask_schedule(struct be_ptask *task,
     task->next_execution = tv.tv_sec;
 }
 
+/* Phase of the task on this host, stable across restarts. */
+static time_t be_ptask_host_phase(const char *name, time_t period)
+{
+    char hostname[HOST_NAME_MAX + 1];
+    time_t range = period / 2;
+    char *key;
+    uint32_t hash;
+
+    if (range == 0) {
+        return 0;
+    }
+
+    if (gethostname(hostname, sizeof(hostname)) != 0) {
+        return sss_rand() % range;
+    }
+    hostname[HOST_NAME_MAX] = '\0';
+
+    key = talloc_asprintf(NULL, "%s:%s", hostname, name);
+    if (key == NULL) {
+        return sss_rand() % range;
+    }
+
+    hash = murmurhash3(key, strlen(key), 0);
+    talloc_free(key);
+
+    return hash % range;
+}
+
 static unsigned int be_ptask_flag_bits(uint32_t flags)
 {
     unsigned int cnt = 0;
@@ -349,6 +511,10 @@ errno_t be_ptask_create(TALLOC_CTX *mem_ctx,
     task->flags = flags;
     task->enabled = true;
 
+    if (flags & BE_PTASK_BULK) {
+        task->host_phase = be_ptask_host_phase(name, period);
+    }
+
     talloc_set_destructor((TALLOC_CTX*)task, be_ptask_destructor);
 
     if (flags & BE_PTASK_OFFLINE_DISABLE) {
@@ -412,6 +578,7 @@ void be_ptask_disable(struct be_ptask *task)
         DEBUG(SSSDBG_TRACE_FUNC, "Task [%s]: disabling task\n", task->name);
 
         talloc_zfree(task->timer);
+        be_ptask_bulk_unqueue(task);
         task->enabled = false;
         task->period = task->orig_period;
     }
@@ -432,6 +599,11 @@ time_t be_ptask_get_timeout(struct be_ptask *task)
     return task->timeout;
 }
 
+const struct be_ptask_stats *be_ptask_get_stats(struct be_ptask *task)
+{
+    return &task->stats;
+}
+
 struct be_ptask_sync_ctx {
     be_ptask_sync_t fn;
     void *pvt;
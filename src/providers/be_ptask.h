@@ -24,6 +24,7 @@
 #include <tevent.h>
 #include <talloc.h>
 #include <time.h>
+#include <stdint.h>
 
 /* solve circular dependency */
 struct be_ctx;
@@ -57,6 +58,36 @@ struct be_ptask;
 /* current request will be executed as planned */
 #define BE_PTASK_OFFLINE_EXECUTE     0x0020
 
+/**
+ * The task loads the servers in bulk, e.g. a full refresh or a cleanup.
+ * The first periodic run is delayed once by a phase of up to half of the
+ * period that is derived from the host name, so that hosts restarted at
+ * the same time do not hit the servers at the same time afterwards. At most
+ * BE_PTASK_BULK_MAX_RUNNING such tasks run at the same time in one back
+ * end, others wait for their turn.
+ */
+#define BE_PTASK_BULK                0x0040
+
+#define BE_PTASK_BULK_MAX_RUNNING 2
+
+/**
+ * Runtime statistics of a task. Durations are in milliseconds.
+ */
+struct be_ptask_stats {
+    uint64_t runs;
+    uint64_t failures;
+    uint64_t timeouts;
+    /* how many times a bulk task waited for another one to finish */
+    uint64_t deferred;
+
+    uint64_t last_duration;
+    uint64_t max_duration;
+    uint64_t total_duration;
+
+    /* the period is multiplied by 2^overload after overload errors */
+    unsigned int overload;
+};
+
 typedef struct tevent_req *
 (*be_ptask_send_t)(TALLOC_CTX *mem_ctx,
                    struct tevent_context *ev,
@@ -109,6 +140,11 @@ typedef errno_t
  * original value when the task is disabled. With max_backoff
  * set to zero, this feature is disabled.
  *
+ * If the request times out or fails with an error that indicates an
+ * overloaded or unreachable server (ETIMEDOUT, EBUSY, ERR_NETWORK_IO),
+ * the delay until the next run is doubled, up to 16 times the period.
+ * It is reset by the next successful run.
+ *
  * If an internal error occurred, the task is automatically disabled.
  */
 errno_t be_ptask_create(TALLOC_CTX *mem_ctx,
@@ -146,5 +182,6 @@ void be_ptask_destroy(struct be_ptask **task);
 
 time_t be_ptask_get_period(struct be_ptask *task);
 time_t be_ptask_get_timeout(struct be_ptask *task);
+const struct be_ptask_stats *be_ptask_get_stats(struct be_ptask *task);
 
 #endif /* _DP_PTASK_H_ */
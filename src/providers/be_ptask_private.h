@@ -42,6 +42,16 @@ struct be_ptask {
     struct tevent_timer *timer; /* active tevent timer */
     uint32_t flags;
     bool enabled;
+
+    time_t host_phase;      /* shift of the schedule of a bulk task */
+    bool bulk_running;      /* counted in the running bulk tasks */
+    bool bulk_waiting;      /* waits in the list of bulk tasks */
+    struct timeval started; /* start of the current run */
+    struct be_ptask_stats stats;
+
+    /* list of bulk tasks waiting for their turn */
+    struct be_ptask *prev;
+    struct be_ptask *next;
 };
 
 #endif /* DP_PTASK_PRIVATE_H_ */
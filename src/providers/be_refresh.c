@@ -29,9 +29,41 @@
 #include "util/util_errors.h"
 #include "db/sysdb.h"
 
+/* Initial size of a batch and delay between two batches */
+#define BE_REFRESH_BATCH_SIZE 200
+#define BE_REFRESH_BATCH_DELAY 500
+/* The batch size and delay are adapted so that one batch takes about this
+ * many milliseconds to refresh */
+#define BE_REFRESH_BATCH_TARGET 2000
+#define BE_REFRESH_BATCH_SIZE_MIN 10
+#define BE_REFRESH_BATCH_SIZE_MAX 1000
+#define BE_REFRESH_BATCH_DELAY_MIN 100
+#define BE_REFRESH_BATCH_DELAY_MAX 10000
+
+struct be_refresh_value {
+    const char *value;
+    time_t last_access;
+};
+
+/* Most recently used entries first. */
+static int be_refresh_value_cmp(const void *a, const void *b)
+{
+    const struct be_refresh_value *va = a;
+    const struct be_refresh_value *vb = b;
+
+    if (va->last_access > vb->last_access) {
+        return -1;
+    } else if (va->last_access < vb->last_access) {
+        return 1;
+    }
+
+    return 0;
+}
+
 static errno_t be_refresh_get_values_ex(TALLOC_CTX *mem_ctx,
                                         struct sss_domain_info *domain,
                                         time_t period,
+                                        uint32_t max_idle,
                                         struct ldb_dn *base_dn,
                                         const char *key_attr,
                                         const char *value_attr,
@@ -39,12 +71,16 @@ static errno_t be_refresh_get_values_ex(TALLOC_CTX *mem_ctx,
                                         char ***_values)
 {
     TALLOC_CTX *tmp_ctx = NULL;
-    const char *attrs[] = {value_attr, NULL};
+    const char *attrs[] = {value_attr, SYSDB_LAST_ACCESS, NULL};
     const char *filter = NULL;
     char **values = NULL;
-    struct sysdb_attrs **records = NULL;
+    struct be_refresh_value *records = NULL;
     struct ldb_result *res;
     time_t now = time(NULL);
+    time_t idle_since = 0;
+    const char *value;
+    size_t count = 0;
+    size_t i;
     errno_t ret;
 
     if (key_attr == NULL || domain == NULL || base_dn == NULL) {
@@ -72,16 +108,50 @@ static errno_t be_refresh_get_values_ex(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = sysdb_msg2attrs(tmp_ctx, res->count, res->msgs, &records);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Could not convert ldb message to sysdb_attrs\n");
+    records = talloc_zero_array(tmp_ctx, struct be_refresh_value,
+                                res->count);
+    values = talloc_zero_array(tmp_ctx, char *, res->count + 1);
+    if (records == NULL || values == NULL) {
+        ret = ENOMEM;
         goto done;
     }
 
-    ret = sysdb_attrs_to_list(tmp_ctx, records, res->count, value_attr, &values);
-    if (ret != EOK) {
-        goto done;
+    if (max_idle > 0) {
+        idle_since = now - (time_t)max_idle * period;
+    }
+
+    for (i = 0; i < res->count; i++) {
+        value = ldb_msg_find_attr_as_string(res->msgs[i], value_attr, NULL);
+        if (value == NULL) {
+            continue;
+        }
+
+        records[count].value = value;
+        records[count].last_access = ldb_msg_find_attr_as_uint64(res->msgs[i],
+                                                         SYSDB_LAST_ACCESS, 0);
+
+        /* Entries that nobody uses are left to expire. */
+        if (max_idle > 0 && records[count].last_access < idle_since) {
+            continue;
+        }
+
+        count++;
+    }
+
+    if (count < res->count) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Skipping %zu entries that were not used "
+              "for %u refresh periods\n", res->count - count, max_idle);
+    }
+
+    qsort(records, count, sizeof(struct be_refresh_value),
+          be_refresh_value_cmp);
+
+    for (i = 0; i < count; i++) {
+        values[i] = talloc_strdup(values, records[i].value);
+        if (values[i] == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
     }
 
     *_values = talloc_steal(mem_ctx, values);
@@ -98,6 +168,7 @@ static errno_t be_refresh_get_values(TALLOC_CTX *mem_ctx,
                                      const char *attr_name,
                                      struct sss_domain_info *domain,
                                      time_t period,
+                                     uint32_t max_idle,
                                      char ***_values)
 {
     struct ldb_dn *base_dn = NULL;
@@ -120,8 +191,6 @@ static errno_t be_refresh_get_values(TALLOC_CTX *mem_ctx,
         break;
     case BE_REFRESH_TYPE_NETGROUPS:
         key_attr = SYSDB_CACHE_EXPIRE;
-        // Netgroup will reside in persistent cache rather than timestamp one
-        search_cache = SYSDB_CACHE_TYPE_PERSISTENT;
         base_dn = sysdb_netgroup_base_dn(mem_ctx, domain);
         break;
     default:
@@ -135,7 +204,7 @@ static errno_t be_refresh_get_values(TALLOC_CTX *mem_ctx,
         return ENOMEM;
     }
 
-    ret = be_refresh_get_values_ex(mem_ctx, domain, period,
+    ret = be_refresh_get_values_ex(mem_ctx, domain, period, max_idle,
                                    base_dn, key_attr,
                                    attr_name, search_cache, _values);
 
@@ -296,12 +365,15 @@ struct be_refresh_state {
     struct sss_domain_info *domain;
     enum be_refresh_type index;
     time_t period;
+    uint32_t max_idle;
 
     char **refresh_values;
     size_t refresh_val_size;
     size_t refresh_index;
 
     size_t batch_size;
+    uint32_t batch_delay;
+    struct timeval batch_start;
     char **refresh_batch;
 };
 
@@ -335,14 +407,17 @@ struct tevent_req *be_refresh_send(TALLOC_CTX *mem_ctx,
     state->be_ctx = be_ctx;
     state->domain = be_ctx->domain;
     state->period = be_ptask_get_period(be_ptask);
+    state->max_idle = be_ctx->domain->refresh_expired_max_idle;
     state->ctx = talloc_get_type(pvt, struct be_refresh_ctx);
     if (state->ctx == NULL) {
         ret = EINVAL;
         goto immediately;
     }
 
-    state->batch_size = 200;
-    state->refresh_batch = talloc_zero_array(state, char *, state->batch_size+1);
+    state->batch_size = BE_REFRESH_BATCH_SIZE;
+    state->batch_delay = BE_REFRESH_BATCH_DELAY;
+    state->refresh_batch = talloc_zero_array(state, char *,
+                                             BE_REFRESH_BATCH_SIZE_MAX + 1);
     if (state->refresh_batch == NULL) {
         ret = ENOMEM;
         goto immediately;
@@ -409,6 +484,7 @@ static errno_t be_refresh_step(struct tevent_req *req)
         ret = be_refresh_get_values(state, state->index,
                                     state->cb_ctx->attr_name,
                                     state->domain, state->period,
+                                    state->max_idle,
                                     &state->refresh_values);
         if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Unable to obtain DN list [%d]: %s\n",
@@ -454,7 +530,8 @@ static errno_t be_refresh_batch_step(struct tevent_req *req,
     size_t remaining;
     size_t batch_size;
 
-    memset(state->refresh_batch, 0, sizeof(char *) * state->batch_size);
+    memset(state->refresh_batch, 0,
+           sizeof(char *) * (BE_REFRESH_BATCH_SIZE_MAX + 1));
 
     if (state->refresh_index >= state->refresh_val_size) {
         DEBUG(SSSDBG_FUNC_DATA, "The batch is done\n");
@@ -496,6 +573,7 @@ static void be_refresh_batch_step_wakeup(struct tevent_context *ev,
     state = tevent_req_data(req, struct be_refresh_state);
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Issuing refresh\n");
+    state->batch_start = tevent_timeval_current();
     subreq = state->cb_ctx->cb.send_fn(state, state->ev, state->be_ctx,
                                        state->domain,
                                        state->refresh_batch,
@@ -507,6 +585,33 @@ static void be_refresh_batch_step_wakeup(struct tevent_context *ev,
     tevent_req_set_callback(subreq, be_refresh_done, req);
 }
 
+/* Grow the batches while the back end answers quickly and shrink them and
+ * wait longer between them when it becomes slow. */
+static void be_refresh_adapt_batch(struct be_refresh_state *state)
+{
+    struct timeval now = tevent_timeval_current();
+    int64_t elapsed;
+
+    elapsed = (now.tv_sec - state->batch_start.tv_sec) * 1000
+              + (now.tv_usec - state->batch_start.tv_usec) / 1000;
+
+    if (elapsed < BE_REFRESH_BATCH_TARGET / 2) {
+        state->batch_size = MIN(state->batch_size * 2,
+                                BE_REFRESH_BATCH_SIZE_MAX);
+        state->batch_delay = MAX(state->batch_delay / 2,
+                                 BE_REFRESH_BATCH_DELAY_MIN);
+    } else if (elapsed > BE_REFRESH_BATCH_TARGET) {
+        state->batch_size = MAX(state->batch_size / 2,
+                                BE_REFRESH_BATCH_SIZE_MIN);
+        state->batch_delay = MIN(state->batch_delay * 2,
+                                 BE_REFRESH_BATCH_DELAY_MAX);
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Batch took %"PRId64" ms, next batch size "
+          "is %zu with delay %u ms\n", elapsed, state->batch_size,
+          state->batch_delay);
+}
+
 static void be_refresh_done(struct tevent_req *subreq)
 {
     struct be_refresh_state *state = NULL;
@@ -522,7 +627,9 @@ static void be_refresh_done(struct tevent_req *subreq)
         goto done;
     }
 
-    ret = be_refresh_batch_step(req, 500);
+    be_refresh_adapt_batch(state);
+
+    ret = be_refresh_batch_step(req, state->batch_delay);
     if (ret == EAGAIN) {
         DEBUG(SSSDBG_TRACE_INTERNAL,
               "Another batch in this step in progress\n");
@@ -268,6 +268,7 @@ enum dp_res_opts {
     DP_RES_OPT_RESOLVER_OP_TIMEOUT,
     DP_RES_OPT_RESOLVER_SERVER_TIMEOUT,
     DP_RES_OPT_DNS_DOMAIN,
+    DP_RES_OPT_RESOLVER_CACHE_SIZE,
 
     DP_RES_OPTS /* attrs counter */
 };
@@ -28,6 +28,10 @@
 #include "providers/backend.h"
 #include "util/util.h"
 
+/* Seconds for which a successful lookup answers the refreshes of the same
+ * entry. */
+#define DP_REFRESH_DEDUP_TIMEOUT_DEFAULT 5
+
 static errno_t
 dp_init_interface(struct data_provider *provider)
 {
@@ -45,7 +49,9 @@ dp_init_interface(struct data_provider *provider)
     SBUS_INTERFACE(iface_dp_backend,
         sssd_DataProvider_Backend,
         SBUS_METHODS(
-            SBUS_SYNC(METHOD, sssd_DataProvider_Backend, IsOnline, dp_backend_is_online, provider->be_ctx)
+            SBUS_SYNC(METHOD, sssd_DataProvider_Backend, IsOnline, dp_backend_is_online, provider->be_ctx),
+            SBUS_SYNC(METHOD, sssd_DataProvider_Backend, RequestStats, dp_backend_request_stats, provider->be_ctx),
+            SBUS_SYNC(METHOD, sssd_DataProvider_Backend, PerfStats, dp_backend_perf_stats, provider->be_ctx)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(SBUS_NO_PROPERTIES)
@@ -56,7 +62,8 @@ dp_init_interface(struct data_provider *provider)
         SBUS_METHODS(
             SBUS_SYNC(METHOD, sssd_DataProvider_Failover, ListServices, dp_failover_list_services, provider->be_ctx),
             SBUS_SYNC(METHOD, sssd_DataProvider_Failover, ListServers, dp_failover_list_servers, provider->be_ctx),
-            SBUS_SYNC(METHOD, sssd_DataProvider_Failover, ActiveServer, dp_failover_active_server, provider->be_ctx)
+            SBUS_SYNC(METHOD, sssd_DataProvider_Failover, ActiveServer, dp_failover_active_server, provider->be_ctx),
+            SBUS_SYNC(METHOD, sssd_DataProvider_Failover, ServerTuning, dp_failover_server_tuning, provider->be_ctx)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(SBUS_NO_PROPERTIES)
@@ -122,6 +129,10 @@ static int dp_destructor(struct data_provider *provider)
 
     provider->terminating = true;
 
+    if (provider->be_ctx->domain->sysdb != NULL) {
+        sysdb_set_change_cb(provider->be_ctx->domain->sysdb, NULL, NULL);
+    }
+
     dp_terminate_active_requests(provider);
 
     for (client = 0; client != DP_CLIENT_SENTINEL; client++) {
@@ -150,6 +161,7 @@ dp_init_send(TALLOC_CTX *mem_ctx,
     struct tevent_req *subreq;
     struct tevent_req *req;
     char *sbus_address;
+    int recent_timeout;
     errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state, struct dp_init_state);
@@ -177,6 +189,16 @@ dp_init_send(TALLOC_CTX *mem_ctx,
     state->provider->gid = gid;
     state->provider->be_ctx = be_ctx;
 
+    ret = confdb_get_int(be_ctx->cdb, be_ctx->conf_path,
+                         CONFDB_DOMAIN_REFRESH_DEDUP_TIMEOUT,
+                         DP_REFRESH_DEDUP_TIMEOUT_DEFAULT, &recent_timeout);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to read %s [%d]: %s\n",
+              CONFDB_DOMAIN_REFRESH_DEDUP_TIMEOUT, ret, sss_strerror(ret));
+        goto done;
+    }
+    state->provider->requests.recent_timeout = MAX(recent_timeout, 0);
+
     state->sbus_name = sss_iface_domain_bus(state, be_ctx->domain);
     if (state->sbus_name == NULL) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Could not get sbus backend name.\n");
@@ -260,6 +282,10 @@ static void dp_init_done(struct tevent_req *subreq)
         goto done;
     }
 
+    /* Subdomains share the sysdb of the domain */
+    sysdb_set_change_cb(state->be_ctx->domain->sysdb, dp_sysdb_changed,
+                        state->provider);
+
 done:
     if (ret != EOK) {
         talloc_zfree(state->be_ctx->provider);
@@ -115,6 +115,17 @@ typedef errno_t
 
 typedef char dp_no_output;
 
+/* Priority classes of data provider requests. Interactive requests are
+ * always run immediately while the background ones may wait in a queue. */
+enum dp_req_priority {
+    DP_PRIORITY_INTERACTIVE,
+    DP_PRIORITY_REFRESH,
+    DP_PRIORITY_PERIODIC
+};
+
+/* Return priority class of the request that ctx was allocated within. */
+enum dp_req_priority dp_req_priority_of(TALLOC_CTX *ctx);
+
 /* Data provider initialization. */
 
 struct tevent_req *
@@ -186,6 +197,9 @@ void dp_sbus_domain_active(struct data_provider *provider,
                            struct sss_domain_info *dom);
 void dp_sbus_domain_inconsistent(struct data_provider *provider,
                                  struct sss_domain_info *dom);
+void dp_sbus_domain_degraded(struct data_provider *provider,
+                             struct sss_domain_info *dom,
+                             bool degraded);
 
 void dp_sbus_reset_users_ncache(struct data_provider *provider,
                                 struct sss_domain_info *dom);
@@ -197,6 +211,10 @@ void dp_sbus_reset_groups_memcache(struct data_provider *provider);
 void dp_sbus_reset_initgr_memcache(struct data_provider *provider);
 void dp_sbus_invalidate_group_memcache(struct data_provider *provider,
                                        gid_t gid);
+void dp_sbus_invalidate_user_memcache(struct data_provider *provider,
+                                      uid_t uid);
+void dp_sbus_invalidate_domain_memcache(struct data_provider *provider,
+                                        struct sss_domain_info *dom);
 
 /*
  * A dummy handler for DPM_ACCT_DOMAIN_HANDLER.
@@ -26,4 +26,17 @@
  */
 #define DP_FAST_REPLY   0x0001
 
+/**
+ * The request is not needed by anyone right now (e.g. midpoint cache
+ * refresh) and it is served only after interactive requests.
+ */
+#define DP_BACKGROUND   0x0002
+
+/**
+ * The request only refreshes data that the caller has in its cache (e.g.
+ * the online lookup of PAM before a login). Like background requests, it is
+ * answered immediately if an identical request succeeded recently.
+ */
+#define DP_REFRESH      0x0004
+
 #endif /* _DP_FLAGS_H_ */
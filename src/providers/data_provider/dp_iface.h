@@ -34,7 +34,8 @@ dp_get_account_info_send(TALLOC_CTX *mem_ctx,
                          uint32_t entry_type,
                          const char *filter,
                          const char *domain,
-                         const char *extra);
+                         const char *extra,
+                         uint32_t trace_id);
 
 errno_t
 dp_get_account_info_recv(TALLOC_CTX *mem_ctx,
@@ -204,6 +205,20 @@ errno_t dp_backend_is_online(TALLOC_CTX *mem_ctx,
                              const char *domname,
                              bool *_is_online);
 
+errno_t dp_backend_request_stats(TALLOC_CTX *mem_ctx,
+                                 struct sbus_request *sbus_req,
+                                 struct be_ctx *be_ctx,
+                                 uint32_t *_active,
+                                 uint64_t *_coalesced);
+
+errno_t dp_backend_perf_stats(TALLOC_CTX *mem_ctx,
+                              struct sbus_request *sbus_req,
+                              struct be_ctx *be_ctx,
+                              uint64_t *_server_ops,
+                              uint64_t *_server_usecs,
+                              uint64_t *_sysdb_transactions,
+                              uint64_t *_sysdb_usecs);
+
 /* sssd.DataProvider.Failover */
 errno_t
 dp_failover_list_services(TALLOC_CTX *mem_ctx,
@@ -226,6 +241,15 @@ dp_failover_list_servers(TALLOC_CTX *mem_ctx,
                          const char *service_name,
                          const char ***_servers);
 
+errno_t
+dp_failover_server_tuning(TALLOC_CTX *mem_ctx,
+                          struct sbus_request *sbus_req,
+                          struct be_ctx *be_ctx,
+                          const char *service_name,
+                          uint32_t *_page_size,
+                          uint32_t *_pool_size,
+                          uint32_t *_page_msecs);
+
 /* sssd.DataProvider.AccessControl */
 struct tevent_req *
 dp_access_control_refresh_rules_send(TALLOC_CTX *mem_ctx,
@@ -57,3 +57,38 @@ dp_backend_is_online(TALLOC_CTX *mem_ctx,
 
     return EOK;
 }
+
+errno_t
+dp_backend_request_stats(TALLOC_CTX *mem_ctx,
+                         struct sbus_request *sbus_req,
+                         struct be_ctx *be_ctx,
+                         uint32_t *_active,
+                         uint64_t *_coalesced)
+{
+    *_active = be_ctx->provider->requests.num_active;
+    *_coalesced = be_ctx->provider->requests.num_coalesced;
+
+    return EOK;
+}
+
+errno_t
+dp_backend_perf_stats(TALLOC_CTX *mem_ctx,
+                      struct sbus_request *sbus_req,
+                      struct be_ctx *be_ctx,
+                      uint64_t *_server_ops,
+                      uint64_t *_server_usecs,
+                      uint64_t *_sysdb_transactions,
+                      uint64_t *_sysdb_usecs)
+{
+    *_server_ops = 0;
+    *_server_usecs = 0;
+    if (be_ctx->be_fo != NULL) {
+        fo_get_operation_stats(be_ctx->be_fo->fo_ctx,
+                               _server_ops, _server_usecs);
+    }
+
+    sysdb_get_transaction_stats(be_ctx->domain->sysdb,
+                                _sysdb_transactions, _sysdb_usecs);
+
+    return EOK;
+}
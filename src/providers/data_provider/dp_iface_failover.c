@@ -326,3 +326,34 @@ dp_failover_list_servers(TALLOC_CTX *mem_ctx,
 
     return EOK;
 }
+
+errno_t
+dp_failover_server_tuning(TALLOC_CTX *mem_ctx,
+                          struct sbus_request *sbus_req,
+                          struct be_ctx *be_ctx,
+                          const char *service_name,
+                          uint32_t *_page_size,
+                          uint32_t *_pool_size,
+                          uint32_t *_page_msecs)
+{
+    struct be_svc_data *svc;
+    bool found = false;
+
+    DLIST_FOR_EACH(svc, be_ctx->be_fo->svcs) {
+        if (strcmp(svc->name, service_name) == 0) {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to get server tuning\n");
+        return ENOENT;
+    }
+
+    *_page_size = svc->page_size;
+    *_pool_size = svc->pool_size;
+    *_page_msecs = svc->page_msecs;
+
+    return EOK;
+}
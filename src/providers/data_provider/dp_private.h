@@ -43,6 +43,7 @@ enum dp_clients {
 };
 
 struct dp_req;
+struct dp_req_queued;
 struct dp_client;
 
 struct dp_module {
@@ -90,8 +91,40 @@ struct data_provider {
         /* List of all ongoing requests. */
         uint32_t num_active;
         struct dp_req *active;
+
+        /* Number of requests that were attached to an identical ongoing
+         * request or answered by a recently finished one instead of being
+         * run. */
+        uint64_t num_coalesced;
+
+        /* Keys of the requests that succeeded in the last recent_timeout
+         * seconds, refreshes of them are not run again. */
+        hash_table_t *recent;
+        time_t recent_timeout;
+
+        /* Number of running interactive and background handlers. */
+        uint32_t num_interactive;
+        uint32_t num_background;
+
+        /* Background requests waiting for their turn. */
+        uint32_t num_queued;
+        struct dp_req_queued *queued;
+        struct tevent_timer *queue_te;
     } requests;
 
+    struct {
+        /* Identity requests in a row that got no answer from the server. */
+        uint32_t failures;
+
+        /* The responders were told to serve expired entries. */
+        bool degraded;
+    } health;
+
+    /* Users and groups changed in the cache that InfoPipe was not told
+     * about yet, see dp_sysdb_changed. */
+    struct dp_changes *changes;
+    struct tevent_timer *changes_te;
+
     struct dp_module **modules;
     struct dp_target **targets;
 };
@@ -122,6 +155,13 @@ errno_t dp_init_targets(TALLOC_CTX *mem_ctx,
 
 void dp_terminate_active_requests(struct data_provider *provider);
 
+/* Queues a change of the cache for the InfoPipe responder, it is the
+ * change callback of the sysdb of the domain. */
+void dp_sysdb_changed(const char *domain,
+                      enum sysdb_member_type type,
+                      const char *name,
+                      void *pvt);
+
 /* Client shared functions. */
 
 errno_t
@@ -25,12 +25,40 @@
 #include "providers/data_provider/dp_private.h"
 #include "providers/backend.h"
 #include "util/dlinklist.h"
+#include "util/sss_ptr_hash.h"
 #include "util/util.h"
 #include "util/probes.h"
 
+/* Maximum number of background handlers that may run at once while there
+ * is no interactive request. Only one is allowed otherwise. */
+#define DP_BACKGROUND_MAX 4
+
+/* The responders stop waiting for identity lookups after this many of them
+ * failed in a row with a timeout or because the backend is offline, or
+ * after one lookup that took at least DP_DEGRADED_LATENCY_MS. The backend
+ * also goes offline straight away when the failures are timeouts rather
+ * than waiting for the next connection attempt to fail. */
+#define DP_DEGRADED_FAILURES 3
+#define DP_DEGRADED_LATENCY_MS 3000
+
+/* Maximum number of recently succeeded requests that are remembered. */
+#define DP_RECENT_MAX 4096
+
+struct dp_req_follower;
+
 struct dp_req {
     struct data_provider *provider;
     uint32_t dp_flags;
+    enum dp_req_priority priority;
+
+    /* Set while the request waits for its turn to run. */
+    struct dp_req_queued *queued;
+    struct dp_req_params *params;
+    bool running;
+
+    /* Requests with the same key are attached to this one. */
+    const char *key;
+    struct dp_req_follower *followers;
 
     struct sss_domain_info *domain;
 
@@ -38,7 +66,12 @@ struct dp_req {
     enum dp_methods method;
     struct dp_method *execute;
     const char *name;
+    /* the name without the number */
+    const char *base_name;
     uint32_t num;
+    /* of the client request that filed it, 0 if none */
+    uint32_t trace_id;
+    struct timeval start;
 
     struct tevent_req *req;
     struct tevent_req *handler_req;
@@ -81,8 +114,43 @@ static bool check_method_data(struct dp_method *method,
     return true;
 }
 
+/* A request that waits for the result of an identical ongoing request. */
+struct dp_req_follower {
+    struct dp_req *leader;
+    struct tevent_req *req;
+
+    struct dp_req_follower *prev;
+    struct dp_req_follower *next;
+};
+
+/* A request that succeeded recently. */
+struct dp_req_recent {
+    time_t expire;
+};
+
+/* A background request that waits until it may be run. */
+struct dp_req_queued {
+    struct dp_req *dp_req;
+
+    struct dp_req_queued *prev;
+    struct dp_req_queued *next;
+};
+
+static void dp_req_finish_followers(struct dp_req *dp_req,
+                                    errno_t ret,
+                                    struct dp_reply_std *reply);
+
+static void dp_req_unqueue(struct dp_req *dp_req);
+
+static void dp_req_stopped(struct dp_req *dp_req);
+
 static int dp_req_destructor(struct dp_req *dp_req)
 {
+    /* The request is freed before its handler finished. */
+    dp_req_finish_followers(dp_req, ERR_TERMINATED, NULL);
+    dp_req_unqueue(dp_req);
+    dp_req_stopped(dp_req);
+
     DLIST_REMOVE(dp_req->provider->requests.active, dp_req);
 
     if (dp_req->provider->requests.num_active == 0) {
@@ -108,7 +176,8 @@ static errno_t dp_attach_req(struct dp_req *dp_req,
     /* If we run out of numbers we simply overflow. */
     dp_req->num = provider->requests.index++;
     dp_req->name = talloc_asprintf(dp_req, "%s #%u", name, dp_req->num);
-    if (dp_req->name == NULL) {
+    dp_req->base_name = talloc_strdup(dp_req, name);
+    if (dp_req->name == NULL || dp_req->base_name == NULL) {
         return ENOMEM;
     }
 
@@ -153,10 +222,13 @@ dp_req_new(TALLOC_CTX *mem_ctx,
 
     dp_req->provider = provider;
     dp_req->dp_flags = dp_flags;
+    dp_req->priority = dp_flags & DP_BACKGROUND ? DP_PRIORITY_REFRESH
+                                                : dp_req_priority_of(mem_ctx);
     dp_req->target = target;
     dp_req->method = method;
     dp_req->request_data = request_data;
     dp_req->req = req;
+    dp_req->trace_id = debug_trace_id;
 
     ret = dp_attach_req(dp_req, provider, name, dp_flags);
     if (ret != EOK) {
@@ -200,7 +272,6 @@ file_dp_request(TALLOC_CTX *mem_ctx,
                 struct dp_req **_dp_req)
 {
     struct dp_req_params *dp_params;
-    dp_req_send_fn send_fn;
     struct dp_req *dp_req;
     struct be_ctx *be_ctx;
     errno_t ret;
@@ -245,14 +316,7 @@ file_dp_request(TALLOC_CTX *mem_ctx,
     dp_params->domain = dp_req->domain;
     dp_params->target = dp_req->target;
     dp_params->method = dp_req->method;
-
-    send_fn = dp_req->execute->send_fn;
-    dp_req->handler_req = send_fn(dp_req, dp_req->execute->method_data,
-                                  dp_req->request_data, dp_params);
-    if (dp_req->handler_req == NULL) {
-        ret = ENOMEM;
-        goto done;
-    }
+    dp_req->params = dp_params;
 
     *_dp_req = dp_req;
 
@@ -264,12 +328,504 @@ done:
 
 struct dp_req_state {
     struct dp_req *dp_req;
+    struct dp_req_follower *follower;
+    bool recent;
     dp_req_recv_fn recv_fn;
     void *output_data;
 };
 
 static void dp_req_done(struct tevent_req *subreq);
 
+enum dp_req_priority dp_req_priority_of(TALLOC_CTX *ctx)
+{
+    struct dp_req *dp_req;
+    const char *name;
+
+    for (; ctx != NULL; ctx = talloc_parent(ctx)) {
+        name = talloc_get_name(ctx);
+        if (strcmp(name, "struct dp_req") == 0) {
+            dp_req = talloc_get_type(ctx, struct dp_req);
+            return dp_req->priority;
+        }
+
+        if (strcmp(name, "struct be_ptask") == 0) {
+            return DP_PRIORITY_PERIODIC;
+        }
+    }
+
+    return DP_PRIORITY_INTERACTIVE;
+}
+
+static const char *dp_req_priority_str(enum dp_req_priority priority)
+{
+    switch (priority) {
+    case DP_PRIORITY_INTERACTIVE:
+        return "interactive";
+    case DP_PRIORITY_REFRESH:
+        return "refresh";
+    case DP_PRIORITY_PERIODIC:
+        return "periodic";
+    }
+
+    return "unknown";
+}
+
+static bool dp_req_may_run(struct data_provider *provider,
+                           struct dp_req *dp_req)
+{
+    uint32_t max;
+
+    if (dp_req->priority == DP_PRIORITY_INTERACTIVE) {
+        return true;
+    }
+
+    /* Background work yields to interactive requests. */
+    max = provider->requests.num_interactive > 0 ? 1 : DP_BACKGROUND_MAX;
+
+    return provider->requests.num_background < max;
+}
+
+static errno_t dp_req_run(struct dp_req *dp_req)
+{
+    struct data_provider *provider = dp_req->provider;
+    dp_req_send_fn send_fn;
+
+    dp_req->start = tevent_timeval_current();
+    send_fn = dp_req->execute->send_fn;
+    dp_req->handler_req = send_fn(dp_req, dp_req->execute->method_data,
+                                  dp_req->request_data, dp_req->params);
+    if (dp_req->handler_req == NULL) {
+        return ENOMEM;
+    }
+
+    dp_req->running = true;
+    if (dp_req->priority == DP_PRIORITY_INTERACTIVE) {
+        provider->requests.num_interactive++;
+    } else {
+        provider->requests.num_background++;
+    }
+
+    tevent_req_set_callback(dp_req->handler_req, dp_req_done, dp_req->req);
+
+    return EOK;
+}
+
+static void dp_req_unqueue(struct dp_req *dp_req)
+{
+    if (dp_req->queued == NULL) {
+        return;
+    }
+
+    DLIST_REMOVE(dp_req->provider->requests.queued, dp_req->queued);
+    dp_req->provider->requests.num_queued--;
+    talloc_zfree(dp_req->queued);
+}
+
+static void dp_req_start(struct dp_req *dp_req)
+{
+    errno_t ret;
+
+    debug_trace_id = dp_req->trace_id;
+    DP_REQ_DEBUG(SSSDBG_TRACE_FUNC, dp_req->name, "Starting %s request.",
+                 dp_req_priority_str(dp_req->priority));
+
+    ret = dp_req_run(dp_req);
+    if (ret != EOK) {
+        dp_req_finish_followers(dp_req, ret, NULL);
+        tevent_req_error(dp_req->req, ret);
+    }
+}
+
+static void dp_req_queue_next(struct tevent_context *ev,
+                              struct tevent_timer *te,
+                              struct timeval tv,
+                              void *pvt)
+{
+    struct data_provider *provider;
+    struct dp_req *dp_req;
+
+    provider = talloc_get_type(pvt, struct data_provider);
+    provider->requests.queue_te = NULL;
+
+    while (provider->requests.queued != NULL) {
+        dp_req = provider->requests.queued->dp_req;
+        if (!dp_req_may_run(provider, dp_req)) {
+            break;
+        }
+
+        dp_req_unqueue(dp_req);
+        dp_req_start(dp_req);
+    }
+}
+
+static void dp_req_profile(struct dp_req *dp_req)
+{
+    char op[128];
+
+    if (!sss_prof_active) {
+        return;
+    }
+
+    snprintf(op, sizeof(op), "dp_request;%s", dp_req->base_name);
+    sss_prof_record_since(op, &dp_req->start);
+}
+
+static void dp_req_stopped(struct dp_req *dp_req)
+{
+    struct data_provider *provider = dp_req->provider;
+
+    if (!dp_req->running) {
+        return;
+    }
+
+    dp_req->running = false;
+    if (dp_req->priority == DP_PRIORITY_INTERACTIVE) {
+        provider->requests.num_interactive--;
+    } else {
+        provider->requests.num_background--;
+    }
+
+    if (provider->requests.queued == NULL || provider->terminating
+            || provider->requests.queue_te != NULL) {
+        return;
+    }
+
+    /* Start waiting requests from the main loop so they do not run
+     * from the callback chain of this one. */
+    provider->requests.queue_te = tevent_add_timer(provider->ev, provider,
+                                                   tevent_timeval_zero(),
+                                                   dp_req_queue_next,
+                                                   provider);
+    if (provider->requests.queue_te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to schedule queued requests!\n");
+    }
+}
+
+static errno_t dp_req_schedule(struct dp_req *dp_req)
+{
+    struct data_provider *provider = dp_req->provider;
+
+    if (dp_req_may_run(provider, dp_req)) {
+        return dp_req_run(dp_req);
+    }
+
+    dp_req->queued = talloc_zero(dp_req, struct dp_req_queued);
+    if (dp_req->queued == NULL) {
+        return ENOMEM;
+    }
+
+    dp_req->queued->dp_req = dp_req;
+    DLIST_ADD_END(provider->requests.queued, dp_req->queued,
+                  struct dp_req_queued *);
+    provider->requests.num_queued++;
+
+    DP_REQ_DEBUG(SSSDBG_TRACE_FUNC, dp_req->name,
+                 "Queued %s request, %u requests are waiting.",
+                 dp_req_priority_str(dp_req->priority),
+                 provider->requests.num_queued);
+
+    return EOK;
+}
+
+/* An interactive request needs the result of a queued one. */
+static void dp_req_promote(struct dp_req *dp_req)
+{
+    if (dp_req->queued == NULL) {
+        return;
+    }
+
+    dp_req_unqueue(dp_req);
+    dp_req->priority = DP_PRIORITY_INTERACTIVE;
+    dp_req_start(dp_req);
+}
+
+static int dp_req_follower_destructor(struct dp_req_follower *follower)
+{
+    if (follower->leader != NULL) {
+        DLIST_REMOVE(follower->leader->followers, follower);
+    }
+
+    return 0;
+}
+
+static void dp_req_finish_followers(struct dp_req *dp_req,
+                                    errno_t ret,
+                                    struct dp_reply_std *reply)
+{
+    struct dp_req_follower *follower;
+    struct dp_reply_std *output;
+    struct dp_req_state *state;
+    errno_t fret;
+
+    /* Always take the list head since finished followers leave the list. */
+    while ((follower = dp_req->followers) != NULL) {
+        DLIST_REMOVE(dp_req->followers, follower);
+        follower->leader = NULL;
+
+        state = tevent_req_data(follower->req, struct dp_req_state);
+        output = talloc_get_type(state->output_data, struct dp_reply_std);
+
+        fret = ret;
+        if (fret == EOK && reply != NULL && output != NULL) {
+            output->dp_error = reply->dp_error;
+            output->error = reply->error;
+            output->message = NULL;
+            if (reply->message != NULL) {
+                output->message = talloc_strdup(output, reply->message);
+                if (output->message == NULL) {
+                    fret = ENOMEM;
+                }
+            }
+        }
+
+        /* Callbacks must not run while we iterate over the list. */
+        tevent_req_defer_callback(follower->req, dp_req->provider->ev);
+        if (fret == EOK) {
+            tevent_req_done(follower->req);
+        } else {
+            tevent_req_error(follower->req, fret);
+        }
+    }
+}
+
+static const char *dp_req_full_key(TALLOC_CTX *mem_ctx,
+                                   struct data_provider *provider,
+                                   const char *domain,
+                                   enum dp_targets target,
+                                   enum dp_methods method,
+                                   const char *key)
+{
+    if (domain == NULL) {
+        domain = provider->be_ctx->domain->name;
+    }
+
+    return talloc_asprintf(mem_ctx, "%d:%d:%s:%s", target, method,
+                           domain, key);
+}
+
+static void dp_req_recent_prune(struct data_provider *provider, time_t now)
+{
+    struct dp_req_recent *recent;
+    hash_value_t *values;
+    unsigned long count;
+    unsigned long i;
+    int hret;
+
+    hret = hash_values(provider->requests.recent, &count, &values);
+    if (hret != HASH_SUCCESS) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        recent = talloc_get_type(values[i].ptr, struct dp_req_recent);
+        if (recent != NULL && recent->expire <= now) {
+            /* removes the entry from the table */
+            talloc_free(recent);
+        }
+    }
+
+    talloc_free(values);
+}
+
+/* Remembers that the request with this key succeeded, so refreshes of the
+ * same entry that follow shortly after are not run again. */
+static void dp_req_recent_add(struct data_provider *provider,
+                              const char *key)
+{
+    struct dp_req_recent *recent;
+    time_t now;
+    errno_t ret;
+
+    if (provider->requests.recent_timeout == 0) {
+        return;
+    }
+
+    if (provider->requests.recent == NULL) {
+        provider->requests.recent = sss_ptr_hash_create(provider, NULL, NULL);
+        if (provider->requests.recent == NULL) {
+            return;
+        }
+    }
+
+    now = time(NULL);
+
+    talloc_free(sss_ptr_hash_lookup(provider->requests.recent, key,
+                                    struct dp_req_recent));
+
+    if (hash_count(provider->requests.recent) >= DP_RECENT_MAX) {
+        dp_req_recent_prune(provider, now);
+        if (hash_count(provider->requests.recent) >= DP_RECENT_MAX) {
+            return;
+        }
+    }
+
+    recent = talloc_zero(provider->requests.recent, struct dp_req_recent);
+    if (recent == NULL) {
+        return;
+    }
+    recent->expire = now + provider->requests.recent_timeout;
+
+    ret = sss_ptr_hash_add(provider->requests.recent, key, recent,
+                           struct dp_req_recent);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to remember request [%d]: %s\n",
+              ret, sss_strerror(ret));
+        talloc_free(recent);
+    }
+}
+
+static bool dp_req_recent_check(struct data_provider *provider,
+                                const char *key)
+{
+    struct dp_req_recent *recent;
+
+    if (provider->requests.recent == NULL) {
+        return false;
+    }
+
+    recent = sss_ptr_hash_lookup(provider->requests.recent, key,
+                                 struct dp_req_recent);
+    if (recent == NULL) {
+        return false;
+    }
+
+    if (recent->expire <= time(NULL)) {
+        talloc_free(recent);
+        return false;
+    }
+
+    return true;
+}
+
+/* Answers a refresh of an entry that was looked up recently. */
+static errno_t dp_req_recent_reply(struct tevent_req *req,
+                                   struct data_provider *provider,
+                                   const char *full_key,
+                                   void *request_data)
+{
+    struct dp_req_state *state;
+    struct dp_reply_std *reply;
+
+    state = tevent_req_data(req, struct dp_req_state);
+
+    reply = talloc_zero(state, struct dp_reply_std);
+    if (reply == NULL) {
+        return ENOMEM;
+    }
+
+    reply->dp_error = DP_ERR_OK;
+    reply->error = EOK;
+    reply->message = "Success";
+    state->output_data = reply;
+    state->recent = true;
+
+    /* We own request data even though it is not used. */
+    talloc_steal(state, request_data);
+
+    provider->requests.num_coalesced++;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Request [%s] succeeded recently, "
+          "not refreshing it again\n", full_key);
+
+    return EOK;
+}
+
+static struct dp_req *dp_req_find_leader(struct data_provider *provider,
+                                         const char *key)
+{
+    struct dp_req *dp_req;
+
+    DLIST_FOR_EACH(dp_req, provider->requests.active) {
+        /* The handler of the request must still be running or queued. */
+        if (dp_req->key == NULL
+                || (dp_req->handler_req == NULL && dp_req->queued == NULL)) {
+            continue;
+        }
+
+        if (strcmp(dp_req->key, key) == 0) {
+            return dp_req;
+        }
+    }
+
+    return NULL;
+}
+
+/* The caller of a request that others are attached to went away before the
+ * request finished. Instead of terminating the attached requests the first
+ * of them takes the running request over. */
+static int dp_req_state_destructor(struct dp_req_state *state)
+{
+    struct dp_req *dp_req = state->dp_req;
+    struct dp_req_follower *follower;
+    struct dp_req_state *fstate;
+
+    if (dp_req == NULL || dp_req->followers == NULL
+            || (dp_req->handler_req == NULL && dp_req->queued == NULL)) {
+        return 0;
+    }
+
+    follower = dp_req->followers;
+    DLIST_REMOVE(dp_req->followers, follower);
+    follower->leader = NULL;
+
+    fstate = tevent_req_data(follower->req, struct dp_req_state);
+    fstate->dp_req = talloc_steal(fstate, dp_req);
+    fstate->recv_fn = dp_req->execute->recv_fn;
+    fstate->follower = NULL;
+    talloc_set_destructor(fstate, dp_req_state_destructor);
+
+    dp_req->req = follower->req;
+    if (dp_req->handler_req != NULL) {
+        tevent_req_set_callback(dp_req->handler_req, dp_req_done,
+                                dp_req->req);
+    }
+
+    state->dp_req = NULL;
+    talloc_free(follower);
+
+    DP_REQ_DEBUG(SSSDBG_TRACE_FUNC, dp_req->name,
+                 "Caller went away, an attached request took it over.");
+
+    return 0;
+}
+
+static errno_t dp_req_follow(struct tevent_req *req,
+                             struct dp_req *leader,
+                             void *request_data)
+{
+    struct dp_req_follower *follower;
+    struct dp_req_state *state;
+
+    state = tevent_req_data(req, struct dp_req_state);
+
+    state->output_data = talloc_zero(state, struct dp_reply_std);
+    if (state->output_data == NULL) {
+        return ENOMEM;
+    }
+
+    follower = talloc_zero(state, struct dp_req_follower);
+    if (follower == NULL) {
+        return ENOMEM;
+    }
+
+    /* We own request data even though it is not used. */
+    talloc_steal(state, request_data);
+
+    follower->leader = leader;
+    follower->req = req;
+    DLIST_ADD_END(leader->followers, follower, struct dp_req_follower *);
+    talloc_set_destructor(follower, dp_req_follower_destructor);
+    state->follower = follower;
+
+    leader->provider->requests.num_coalesced++;
+
+    DP_REQ_DEBUG(SSSDBG_TRACE_FUNC, leader->name,
+                 "Identical request attached to the one of trace ID [%u].",
+                 leader->trace_id);
+
+    return EOK;
+}
+
 struct tevent_req *dp_req_send(TALLOC_CTX *mem_ctx,
                                struct data_provider *provider,
                                const char *domain,
@@ -279,11 +835,28 @@ struct tevent_req *dp_req_send(TALLOC_CTX *mem_ctx,
                                uint32_t dp_flags,
                                void *request_data,
                                const char **_request_name)
+{
+    return dp_req_keyed_send(mem_ctx, provider, domain, name, NULL, target,
+                             method, dp_flags, request_data, _request_name);
+}
+
+struct tevent_req *dp_req_keyed_send(TALLOC_CTX *mem_ctx,
+                                     struct data_provider *provider,
+                                     const char *domain,
+                                     const char *name,
+                                     const char *key,
+                                     enum dp_targets target,
+                                     enum dp_methods method,
+                                     uint32_t dp_flags,
+                                     void *request_data,
+                                     const char **_request_name)
 {
     struct dp_req_state *state;
     const char *request_name;
+    const char *full_key = NULL;
     struct tevent_req *req;
     struct dp_req *dp_req;
+    struct dp_req *leader;
     errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state, struct dp_req_state);
@@ -292,6 +865,52 @@ struct tevent_req *dp_req_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
+    /* Fast reply requests that fail when offline are filed as usual. */
+    if (key != NULL && !(dp_flags & DP_FAST_REPLY
+                         && be_is_offline(provider->be_ctx))) {
+        full_key = dp_req_full_key(state, provider, domain, target,
+                                   method, key);
+        if (full_key == NULL) {
+            ret = ENOMEM;
+            if (_request_name != NULL) {
+                *_request_name = "Request Not Yet Created";
+            }
+            goto immediately;
+        }
+
+        if (dp_flags & (DP_BACKGROUND | DP_REFRESH)
+                && dp_req_recent_check(provider, full_key)) {
+            if (_request_name != NULL) {
+                *_request_name = "Recently Finished Request";
+            }
+
+            ret = dp_req_recent_reply(req, provider, full_key, request_data);
+            goto immediately;
+        }
+
+        leader = dp_req_find_leader(provider, full_key);
+        if (leader != NULL) {
+            if (_request_name != NULL) {
+                request_name = talloc_strdup(mem_ctx, leader->name);
+                *_request_name = request_name != NULL
+                                     ? request_name
+                                     : "Request Not Yet Created";
+            }
+
+            ret = dp_req_follow(req, leader, request_data);
+            if (ret != EOK) {
+                goto immediately;
+            }
+
+            if (!(dp_flags & DP_BACKGROUND)
+                    && dp_req_priority_of(mem_ctx) == DP_PRIORITY_INTERACTIVE) {
+                dp_req_promote(leader);
+            }
+
+            return req;
+        }
+    }
+
     ret = file_dp_request(state, provider, domain, name, target,
                           method, dp_flags, request_data, req, &dp_req);
 
@@ -304,8 +923,10 @@ struct tevent_req *dp_req_send(TALLOC_CTX *mem_ctx,
         goto immediately;
     }
 
-    PROBE(DP_REQ_SEND, domain, dp_req->name, target, method);
+    PROBE(DP_REQ_SEND, domain, dp_req->name, target, method,
+          dp_req->trace_id);
     state->dp_req = dp_req;
+    talloc_set_destructor(state, dp_req_state_destructor);
     if (_request_name != NULL) {
         request_name = talloc_strdup(mem_ctx, dp_req->name);
         if (request_name == NULL) {
@@ -329,7 +950,17 @@ struct tevent_req *dp_req_send(TALLOC_CTX *mem_ctx,
 
     talloc_set_name_const(state->output_data, dp_req->execute->output_dtype);
 
-    tevent_req_set_callback(dp_req->handler_req, dp_req_done, req);
+    /* Only the standard reply can be copied to attached requests. */
+    if (full_key != NULL
+            && strcmp(dp_req->execute->output_dtype,
+                      "struct dp_reply_std") == 0) {
+        dp_req->key = talloc_steal(dp_req, full_key);
+    }
+
+    ret = dp_req_schedule(dp_req);
+    if (ret != EOK) {
+        goto immediately;
+    }
 
     return req;
 
@@ -344,27 +975,137 @@ immediately:
     return req;
 }
 
+static void dp_req_update_health(struct dp_req *dp_req,
+                                 errno_t ret,
+                                 void *output_data)
+{
+    struct data_provider *provider = dp_req->provider;
+    struct be_ctx *be_ctx = provider->be_ctx;
+    struct sss_domain_info *dom;
+    struct dp_reply_std *reply;
+    struct timeval now;
+    struct timeval elapsed;
+    uint64_t elapsed_ms;
+    bool degraded;
+    bool failed;
+
+    if (dp_req->target != DPT_ID) {
+        return;
+    }
+
+    reply = talloc_get_type(output_data, struct dp_reply_std);
+    if (ret == EOK && reply != NULL) {
+        failed = reply->dp_error == DP_ERR_OFFLINE
+                     || reply->dp_error == DP_ERR_TIMEOUT;
+    } else {
+        failed = ret == ETIMEDOUT || ret == ERR_OFFLINE;
+    }
+
+    now = tevent_timeval_current();
+    elapsed = tevent_timeval_until(&dp_req->start, &now);
+    elapsed_ms = elapsed.tv_sec * 1000 + elapsed.tv_usec / 1000;
+
+    degraded = provider->health.degraded;
+    if (failed) {
+        provider->health.failures++;
+        if (provider->health.failures >= DP_DEGRADED_FAILURES) {
+            degraded = true;
+        }
+
+        if (provider->health.failures == DP_DEGRADED_FAILURES
+                && !be_is_offline(be_ctx)) {
+            DEBUG(SSSDBG_OP_FAILURE, "%u identity requests in a row did not "
+                  "get an answer, going offline\n",
+                  provider->health.failures);
+            be_mark_offline(be_ctx);
+        }
+    } else if (ret != EOK || reply == NULL || reply->dp_error != DP_ERR_OK) {
+        /* Other errors do not tell anything about the servers. */
+        return;
+    } else if (elapsed_ms >= DP_DEGRADED_LATENCY_MS) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Request [%s] took %"PRIu64" ms\n",
+              dp_req->name, elapsed_ms);
+        degraded = true;
+    } else {
+        provider->health.failures = 0;
+        degraded = false;
+    }
+
+    if (degraded == provider->health.degraded) {
+        return;
+    }
+
+    provider->health.degraded = degraded;
+    DEBUG(degraded ? SSSDBG_MINOR_FAILURE : SSSDBG_TRACE_FUNC,
+          "Backend is %s\n", degraded ? "degraded" : "healthy again");
+
+    for (dom = be_ctx->domain;
+         dom != NULL;
+         dom = get_next_domain(dom, SSS_GND_DESCEND)) {
+        dp_sbus_domain_degraded(provider, dom, degraded);
+    }
+}
+
+/* The responders read the timestamps from the cache on disk as soon as they
+ * get the reply, so the updates buffered by the request must be written
+ * out before it. */
+static void dp_req_flush_timestamps(struct dp_req *dp_req)
+{
+    struct be_ctx *be_ctx = dp_req->provider->be_ctx;
+    errno_t ret;
+
+    if (be_ctx == NULL || be_ctx->domain == NULL
+            || be_ctx->domain->sysdb == NULL) {
+        return;
+    }
+
+    ret = sysdb_ts_buffer_flush(be_ctx->domain->sysdb);
+    if (ret != EOK) {
+        DP_REQ_DEBUG(SSSDBG_MINOR_FAILURE, dp_req->name,
+                     "Unable to write buffered timestamps [%d]: %s",
+                     ret, sss_strerror(ret));
+    }
+}
+
 static void dp_req_done(struct tevent_req *subreq)
 {
+    struct dp_reply_std *reply;
     struct dp_req_state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct dp_req_state);
+    debug_trace_id = state->dp_req->trace_id;
 
     ret = state->recv_fn(state->output_data, subreq, state->output_data);
 
     /* subreq is the same as dp_req->handler_req */
     talloc_zfree(subreq);
     state->dp_req->handler_req = NULL;
+    dp_req_stopped(state->dp_req);
+    dp_req_update_health(state->dp_req, ret, state->output_data);
 
     PROBE(DP_REQ_DONE, state->dp_req->name, state->dp_req->target,
-          state->dp_req->method, ret, sss_strerror(ret));
+          state->dp_req->method, ret, sss_strerror(ret),
+          state->dp_req->trace_id);
+    dp_req_profile(state->dp_req);
 
     DP_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->dp_req->name,
                  "Request handler finished [%d]: %s", ret, sss_strerror(ret));
 
+    dp_req_flush_timestamps(state->dp_req);
+
+    reply = talloc_get_type(state->output_data, struct dp_reply_std);
+    if (state->dp_req->key != NULL && ret == EOK && reply != NULL
+            && reply->dp_error == DP_ERR_OK) {
+        dp_req_recent_add(state->dp_req->provider, state->dp_req->key);
+    }
+
+    if (state->dp_req->followers != NULL) {
+        dp_req_finish_followers(state->dp_req, ret, reply);
+    }
+
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
@@ -385,6 +1126,10 @@ errno_t _dp_req_recv(TALLOC_CTX *mem_ctx,
     if (state->dp_req != NULL) {
         DP_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->dp_req->name,
                      "Receiving request data.");
+    } else if (state->follower != NULL) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Receiving data of attached request.\n");
+    } else if (state->recent) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Receiving data of recent request.\n");
     } else {
         /* dp_req may be NULL in case we error when filing request */
         DEBUG(SSSDBG_TRACE_FUNC,
@@ -406,6 +1151,15 @@ errno_t _dp_req_recv(TALLOC_CTX *mem_ctx,
 
 static void dp_terminate_request(struct dp_req *dp_req)
 {
+    if (dp_req->queued != NULL) {
+        DP_REQ_DEBUG(SSSDBG_TRACE_ALL, dp_req->name, "Terminating queued.");
+
+        dp_req_unqueue(dp_req);
+        dp_req_finish_followers(dp_req, ERR_TERMINATED, NULL);
+        tevent_req_error(dp_req->req, ERR_TERMINATED);
+        return;
+    }
+
     if (dp_req->handler_req == NULL) {
         /* This may occur when the handler already finished but the caller
          * of dp request did not yet received data/free dp_req. We just
@@ -418,6 +1172,8 @@ static void dp_terminate_request(struct dp_req *dp_req)
     DP_REQ_DEBUG(SSSDBG_TRACE_ALL, dp_req->name, "Terminating.");
 
     talloc_zfree(dp_req->handler_req);
+    dp_req_stopped(dp_req);
+    dp_req_finish_followers(dp_req, ERR_TERMINATED, NULL);
     tevent_req_error(dp_req->req, ERR_TERMINATED);
 }
 
@@ -39,6 +39,27 @@ struct tevent_req *dp_req_send(TALLOC_CTX *mem_ctx,
                                void *request_data,
                                const char **_request_name);
 
+/**
+ * Same as dp_req_send() but requests with the same @key that are sent
+ * while the first one is still running are attached to it and receive
+ * a copy of its result. @key shall describe everything that determines
+ * the result, such as entry type, filter and extra value. Target, method
+ * and domain are added automatically. Requests with NULL key are never
+ * coalesced.
+ *
+ * Only methods with struct dp_reply_std output can be coalesced.
+ */
+struct tevent_req *dp_req_keyed_send(TALLOC_CTX *mem_ctx,
+                                     struct data_provider *provider,
+                                     const char *domain,
+                                     const char *name,
+                                     const char *key,
+                                     enum dp_targets target,
+                                     enum dp_methods method,
+                                     uint32_t dp_flags,
+                                     void *request_data,
+                                     const char **_request_name);
+
 errno_t _dp_req_recv(TALLOC_CTX *mem_ctx,
                      struct tevent_req *req,
                      const char *data_type,
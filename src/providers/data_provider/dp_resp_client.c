@@ -114,6 +114,42 @@ void dp_sbus_domain_inconsistent(struct data_provider *provider,
     }
 }
 
+void dp_sbus_domain_degraded(struct data_provider *provider,
+                             struct sss_domain_info *dom,
+                             bool degraded)
+{
+    const char *bus;
+    struct tevent_req *subreq;
+    struct sbus_connection *conn;
+    int i;
+
+    if (provider == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "No provider pointer\n");
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Ordering responders to %s degraded mode of "
+          "domain %s\n", degraded ? "enter" : "leave", dom->name);
+
+    conn = provider->sbus_conn;
+    for (i = 0; all_clients[i] != NULL; i++) {
+        bus = all_clients[i];
+        if (degraded) {
+            subreq = sbus_call_resp_domain_SetDegraded_send(provider, conn,
+                        bus, SSS_BUS_PATH, dom->name);
+        } else {
+            subreq = sbus_call_resp_domain_ClearDegraded_send(provider, conn,
+                        bus, SSS_BUS_PATH, dom->name);
+        }
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            return;
+        }
+
+        tevent_req_set_callback(subreq, sbus_unwanted_reply, NULL);
+    }
+}
+
 void dp_sbus_reset_users_ncache(struct data_provider *provider,
                                 struct sss_domain_info *dom)
 {
@@ -273,3 +309,242 @@ void dp_sbus_invalidate_group_memcache(struct data_provider *provider,
 
     return;
 }
+
+void dp_sbus_invalidate_user_memcache(struct data_provider *provider,
+                                      uid_t uid)
+{
+    struct tevent_req *subreq;
+
+    if (provider == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "No provider pointer\n");
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Ordering NSS responder to invalidate the user %"PRIu32" \n",
+          uid);
+
+    subreq = sbus_call_nss_memcache_InvalidateUserById_send(provider,
+                 provider->sbus_conn, SSS_BUS_NSS, SSS_BUS_PATH,
+                 (uint32_t)uid);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        return;
+    }
+
+    tevent_req_set_callback(subreq, sbus_unwanted_reply, NULL);
+
+    return;
+}
+
+void dp_sbus_invalidate_domain_memcache(struct data_provider *provider,
+                                        struct sss_domain_info *dom)
+{
+    struct tevent_req *subreq;
+
+    if (provider == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "No provider pointer\n");
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Ordering NSS responder to invalidate the domain %s\n",
+          dom->name);
+
+    subreq = sbus_call_nss_memcache_InvalidateDomain_send(provider,
+                 provider->sbus_conn, SSS_BUS_NSS, SSS_BUS_PATH, dom->name);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        return;
+    }
+
+    tevent_req_set_callback(subreq, sbus_unwanted_reply, NULL);
+
+    return;
+}
+
+/* Changes of the cache are collected for this long before the InfoPipe
+ * responder is told about them, a refresh or enumeration writes many
+ * entries in a row. */
+#define DP_CHANGES_DELAY_MSEC 1000
+
+/* More changed entries of a domain are sent as a change of all of them */
+#define DP_CHANGES_MAX_NAMES 256
+
+struct dp_changes_list {
+    const char **names;
+    size_t count;
+    bool all;
+};
+
+struct dp_changes {
+    struct dp_changes *prev;
+    struct dp_changes *next;
+
+    const char *domain;
+    struct dp_changes_list users;
+    struct dp_changes_list groups;
+};
+
+static void dp_sbus_changes_list(struct data_provider *provider,
+                                 const char *domain,
+                                 bool users,
+                                 struct dp_changes_list *list)
+{
+    struct tevent_req *subreq;
+
+    if (!list->all && list->count == 0) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Telling InfoPipe responder that %s %s of domain %s changed\n",
+          list->all ? "all" : "some", users ? "users" : "groups", domain);
+
+    if (users) {
+        subreq = sbus_call_ifp_changes_UsersChanged_send(provider,
+                     provider->sbus_conn, SSS_BUS_IFP, SSS_BUS_PATH,
+                     domain, list->all ? NULL : list->names);
+    } else {
+        subreq = sbus_call_ifp_changes_GroupsChanged_send(provider,
+                     provider->sbus_conn, SSS_BUS_IFP, SSS_BUS_PATH,
+                     domain, list->all ? NULL : list->names);
+    }
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        return;
+    }
+
+    tevent_req_set_callback(subreq, sbus_unwanted_reply, NULL);
+}
+
+static void dp_sbus_changes_flush(struct tevent_context *ev,
+                                  struct tevent_timer *te,
+                                  struct timeval tv,
+                                  void *pvt)
+{
+    struct data_provider *provider;
+    struct dp_changes *changes;
+
+    provider = talloc_get_type(pvt, struct data_provider);
+    provider->changes_te = NULL;
+
+    /* The arguments are copied into the messages right away */
+    while ((changes = provider->changes) != NULL) {
+        DLIST_REMOVE(provider->changes, changes);
+
+        if (provider->sbus_conn != NULL) {
+            dp_sbus_changes_list(provider, changes->domain, true,
+                                 &changes->users);
+            dp_sbus_changes_list(provider, changes->domain, false,
+                                 &changes->groups);
+        }
+
+        talloc_free(changes);
+    }
+}
+
+static errno_t dp_changes_list_add(struct dp_changes *changes,
+                                   struct dp_changes_list *list,
+                                   const char *name)
+{
+    const char **names;
+    size_t i;
+
+    if (list->all) {
+        return EOK;
+    }
+
+    for (i = 0; i < list->count; i++) {
+        if (strcmp(list->names[i], name) == 0) {
+            return EOK;
+        }
+    }
+
+    if (list->count == DP_CHANGES_MAX_NAMES) {
+        list->all = true;
+        list->count = 0;
+        talloc_zfree(list->names);
+        return EOK;
+    }
+
+    /* NULL-terminated for the D-Bus message */
+    names = talloc_realloc(changes, list->names, const char *,
+                           list->count + 2);
+    if (names == NULL) {
+        return ENOMEM;
+    }
+    list->names = names;
+
+    list->names[list->count] = talloc_strdup(list->names, name);
+    if (list->names[list->count] == NULL) {
+        return ENOMEM;
+    }
+    list->count++;
+    list->names[list->count] = NULL;
+
+    return EOK;
+}
+
+void dp_sysdb_changed(const char *domain,
+                      enum sysdb_member_type type,
+                      const char *name,
+                      void *pvt)
+{
+    struct data_provider *provider;
+    struct dp_changes *changes;
+    struct timeval tv;
+    errno_t ret;
+
+    provider = talloc_get_type(pvt, struct data_provider);
+    if (provider == NULL || provider->terminating) {
+        return;
+    }
+
+    if (type != SYSDB_MEMBER_USER && type != SYSDB_MEMBER_GROUP) {
+        return;
+    }
+
+    DLIST_FOR_EACH(changes, provider->changes) {
+        if (strcasecmp(changes->domain, domain) == 0) {
+            break;
+        }
+    }
+
+    if (changes == NULL) {
+        changes = talloc_zero(provider, struct dp_changes);
+        if (changes == NULL) {
+            return;
+        }
+
+        changes->domain = talloc_strdup(changes, domain);
+        if (changes->domain == NULL) {
+            talloc_free(changes);
+            return;
+        }
+
+        DLIST_ADD_END(provider->changes, changes, struct dp_changes *);
+    }
+
+    ret = dp_changes_list_add(changes,
+                              type == SYSDB_MEMBER_USER ? &changes->users
+                                                        : &changes->groups,
+                              name);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to queue change of [%s] for "
+              "InfoPipe [%d]: %s\n", name, ret, sss_strerror(ret));
+        return;
+    }
+
+    if (provider->changes_te != NULL) {
+        return;
+    }
+
+    tv = tevent_timeval_current_ofs(0, DP_CHANGES_DELAY_MSEC * 1000);
+    provider->changes_te = tevent_add_timer(provider->ev, provider, tv,
+                                            dp_sbus_changes_flush, provider);
+    if (provider->changes_te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to schedule sending of the changes to InfoPipe\n");
+    }
+}
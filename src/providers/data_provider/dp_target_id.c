@@ -451,6 +451,8 @@ static void dp_req_initgr_pp_set_initgr_timestamp(struct dp_initgr_ctx *ctx,
 struct dp_get_account_info_state {
     const char *request_name;
     bool initgroups;
+    /* of the client request in the responder, 0 if not known */
+    uint32_t trace_id;
 
     struct data_provider *provider;
     struct dp_id_data *data;
@@ -471,19 +473,26 @@ dp_get_account_info_send(TALLOC_CTX *mem_ctx,
                          uint32_t entry_type,
                          const char *filter,
                          const char *domain,
-                         const char *extra)
+                         const char *extra,
+                         uint32_t trace_id)
 {
     struct dp_get_account_info_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
+    const char *key;
     errno_t ret;
 
+    /* the messages of the lookup and the DP request take it from here */
+    debug_trace_id = trace_id;
+
     req = tevent_req_create(mem_ctx, &state, struct dp_get_account_info_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
     }
 
+    state->trace_id = trace_id;
+
     state->data = talloc_zero(state, struct dp_id_data);
     if (state->data == NULL) {
         ret = ENOMEM;
@@ -517,9 +526,22 @@ dp_get_account_info_send(TALLOC_CTX *mem_ctx,
         }
     }
 
-    subreq = dp_req_send(state, provider, domain, state->request_name, DPT_ID,
-                         DPM_ACCOUNT_HANDLER, dp_flags, state->data,
-                         &state->request_name);
+    /* Identical lookups that differ only in flags or in the responder that
+     * sent them share one request. */
+    key = talloc_asprintf(state, "%#"PRIx32":%d:%s:%s",
+                          state->data->entry_type, state->data->filter_type,
+                          state->data->filter_value == NULL
+                              ? "" : state->data->filter_value,
+                          state->data->extra_value == NULL
+                              ? "" : state->data->extra_value);
+    if (key == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    subreq = dp_req_keyed_send(state, provider, domain, state->request_name,
+                               key, DPT_ID, DPM_ACCOUNT_HANDLER, dp_flags,
+                               state->data, &state->request_name);
     if (subreq == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
         ret = ENOMEM;
@@ -550,6 +572,7 @@ static void dp_get_account_info_request_done(struct tevent_req *subreq)
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct dp_get_account_info_state);
+    debug_trace_id = state->trace_id;
 
     ret = dp_req_recv(state, subreq, struct dp_reply_std, &state->reply);
     talloc_zfree(subreq);
@@ -55,6 +55,11 @@
 #define OFFLINE_TIMEOUT_DEFAULT 60
 #define OFFLINE_TIMEOUT_MAX_DEFAULT 3600
 
+/* Timestamp updates of unchanged entries are written in batches of at most
+ * this many entries and at most this many seconds late */
+#define TS_BUFFER_MAX_ENTRIES 1000
+#define TS_BUFFER_MAX_DELAY 5
+
 /* sssd.service */
 static errno_t
 data_provider_res_init(TALLOC_CTX *mem_ctx,
@@ -476,6 +481,52 @@ be_register_monitor_iface(struct sbus_connection *conn, struct be_ctx *be_ctx)
 
 static void dp_initialized(struct tevent_req *req);
 
+static void be_ts_buffer_timer(struct tevent_context *ev,
+                               struct tevent_timer *te,
+                               struct timeval current_time,
+                               void *pvt)
+{
+    struct be_ctx *be_ctx = talloc_get_type(pvt, struct be_ctx);
+    struct timeval tv;
+    errno_t ret;
+
+    ret = sysdb_ts_buffer_flush(be_ctx->domain->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write buffered timestamps "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
+    tv = tevent_timeval_current_ofs(TS_BUFFER_MAX_DELAY, 0);
+    te = tevent_add_timer(ev, be_ctx, tv, be_ts_buffer_timer, be_ctx);
+    if (te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to schedule writing of the "
+              "buffered timestamps\n");
+    }
+}
+
+static errno_t be_ts_buffer_init(struct be_ctx *be_ctx)
+{
+    struct tevent_timer *te;
+    struct timeval tv;
+    errno_t ret;
+
+    ret = sysdb_ts_buffer_enable(be_ctx->domain->sysdb,
+                                 TS_BUFFER_MAX_ENTRIES, TS_BUFFER_MAX_DELAY);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    /* Without lookups nothing else writes the buffer out */
+    tv = tevent_timeval_current_ofs(TS_BUFFER_MAX_DELAY, 0);
+    te = tevent_add_timer(be_ctx->ev, be_ctx, tv, be_ts_buffer_timer, be_ctx);
+    if (te == NULL) {
+        sysdb_ts_buffer_enable(be_ctx->domain->sysdb, 0, 0);
+        return ENOMEM;
+    }
+
+    return EOK;
+}
+
 errno_t be_process_init(TALLOC_CTX *mem_ctx,
                         const char *be_domain,
                         uid_t uid,
@@ -525,6 +576,13 @@ errno_t be_process_init(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = be_ts_buffer_init(be_ctx);
+    if (ret != EOK) {
+        /* Not fatal, the timestamps are written right away */
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to buffer timestamp updates "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
     /* We need this for subdomains support, as they have to store fully
      * qualified user and group names for now. */
     ret = sss_names_init(be_ctx->domain, cdb, be_ctx->domain->name,
@@ -811,5 +869,15 @@ data_provider_logrotate(TALLOC_CTX *mem_ctx,
                         struct sbus_request *sbus_req,
                         struct be_ctx *be_ctx)
 {
+    errno_t ret;
+
+    /* sss_cache signals the monitor that rotates the logs after it changed
+     * the cache, the buffered updates it invalidated are dropped here */
+    ret = sysdb_ts_buffer_flush(be_ctx->domain->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write buffered timestamps "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
     return server_common_rotate_logs(be_ctx->cdb, be_ctx->conf_path);
 }
@@ -44,11 +44,29 @@ int be_fo_is_srv_identifier(const char *server)
 static int be_fo_get_options(struct be_ctx *ctx,
                              struct fo_options *opts)
 {
+    errno_t ret;
+
+    ret = confdb_get_bool(ctx->cdb, ctx->conf_path,
+                          CONFDB_DOMAIN_FAILOVER_PREFER_FASTEST, false,
+                          &opts->prefer_fastest);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to get %s from confdb\n",
+              CONFDB_DOMAIN_FAILOVER_PREFER_FASTEST);
+        return ret;
+    }
+
     opts->service_resolv_timeout = dp_opt_get_int(ctx->be_res->opts,
                                                   DP_RES_OPT_RESOLVER_TIMEOUT);
     opts->retry_timeout = 30;
     opts->srv_retry_neg_timeout = 15;
     opts->family_order = ctx->be_res->family_order;
+    opts->dns_stale_timeout = 86400;
+
+    opts->srv_cache_path = talloc_asprintf(ctx->be_fo, "%s/fo_srv_%s.cache",
+                                           DB_PATH, ctx->domain->name);
+    if (opts->srv_cache_path == NULL) {
+        return ENOMEM;
+    }
 
     return EOK;
 }
@@ -214,6 +232,7 @@ void be_fo_set_srv_lookup_plugin(struct be_ctx *ctx,
                                  fo_srv_lookup_plugin_send_t send_fn,
                                  fo_srv_lookup_plugin_recv_t recv_fn,
                                  void *pvt,
+                                 bool persistent,
                                  const char *plugin_name)
 {
     bool bret;
@@ -221,7 +240,8 @@ void be_fo_set_srv_lookup_plugin(struct be_ctx *ctx,
     DEBUG(SSSDBG_TRACE_FUNC, "Trying to set SRV lookup plugin to %s\n",
                               plugin_name);
 
-    bret = fo_set_srv_lookup_plugin(ctx->be_fo->fo_ctx, send_fn, recv_fn, pvt);
+    bret = fo_set_srv_lookup_plugin(ctx->be_fo->fo_ctx, send_fn, recv_fn, pvt,
+                                    persistent);
     if (bret) {
         DEBUG(SSSDBG_TRACE_FUNC, "SRV lookup plugin is now %s\n",
                                   plugin_name);
@@ -260,7 +280,8 @@ errno_t be_fo_set_dns_srv_lookup_plugin(struct be_ctx *be_ctx,
     }
 
     be_fo_set_srv_lookup_plugin(be_ctx, fo_resolve_srv_dns_send,
-                                fo_resolve_srv_dns_recv, srv_ctx, "DNS");
+                                fo_resolve_srv_dns_recv, srv_ctx, false,
+                                "DNS");
 
     return EOK;
 }
@@ -364,6 +385,8 @@ struct be_resolve_server_state {
 
     struct fo_server *srv;
     bool first_try;
+    /* pass over servers with a connection attempt in progress */
+    bool other;
 };
 
 struct be_primary_server_ctx {
@@ -502,11 +525,29 @@ be_primary_server_timeout_activate(TALLOC_CTX *mem_ctx,
 
 static void be_resolve_server_done(struct tevent_req *subreq);
 
-struct tevent_req *be_resolve_server_send(TALLOC_CTX *memctx,
-                                          struct tevent_context *ev,
-                                          struct be_ctx *ctx,
-                                          const char *service_name,
-                                          bool first_try)
+static struct tevent_req *
+be_resolve_service_send(struct be_resolve_server_state *state)
+{
+    if (state->other) {
+        return fo_resolve_other_service_send(state, state->ev,
+                                             state->ctx->be_fo->be_res->resolv,
+                                             state->ctx->be_fo->fo_ctx,
+                                             state->svc->fo_service);
+    }
+
+    return fo_resolve_service_send(state, state->ev,
+                                   state->ctx->be_fo->be_res->resolv,
+                                   state->ctx->be_fo->fo_ctx,
+                                   state->svc->fo_service);
+}
+
+static struct tevent_req *
+be_resolve_server_internal_send(TALLOC_CTX *memctx,
+                                struct tevent_context *ev,
+                                struct be_ctx *ctx,
+                                const char *service_name,
+                                bool first_try,
+                                bool other)
 {
     struct tevent_req *req, *subreq;
     struct be_resolve_server_state *state;
@@ -528,11 +569,9 @@ struct tevent_req *be_resolve_server_send(TALLOC_CTX *memctx,
     state->svc = svc;
     state->attempts = 0;
     state->first_try = first_try;
+    state->other = other;
 
-    subreq = fo_resolve_service_send(state, ev,
-                                     ctx->be_fo->be_res->resolv,
-                                     ctx->be_fo->fo_ctx,
-                                     svc->fo_service);
+    subreq = be_resolve_service_send(state);
     if (!subreq) {
         talloc_zfree(req);
         return NULL;
@@ -542,6 +581,25 @@ struct tevent_req *be_resolve_server_send(TALLOC_CTX *memctx,
     return req;
 }
 
+struct tevent_req *be_resolve_server_send(TALLOC_CTX *memctx,
+                                          struct tevent_context *ev,
+                                          struct be_ctx *ctx,
+                                          const char *service_name,
+                                          bool first_try)
+{
+    return be_resolve_server_internal_send(memctx, ev, ctx, service_name,
+                                           first_try, false);
+}
+
+struct tevent_req *be_resolve_other_server_send(TALLOC_CTX *memctx,
+                                                struct tevent_context *ev,
+                                                struct be_ctx *ctx,
+                                                const char *service_name)
+{
+    return be_resolve_server_internal_send(memctx, ev, ctx, service_name,
+                                           false, true);
+}
+
 static void be_resolve_server_done(struct tevent_req *subreq)
 {
     struct tevent_req *new_subreq;
@@ -581,14 +639,48 @@ fail:
     tevent_req_error(req, ret);
 }
 
+static errno_t be_svc_run_callbacks(struct be_svc_data *svc,
+                                    struct fo_server *srv)
+{
+    time_t srv_status_change;
+    struct be_svc_callback *callback;
+    char *srvname;
+
+    srv_status_change = fo_get_server_hostname_last_change(srv);
+
+    /* now call all svc callbacks if server changed or if it is explicitly
+     * requested or if the server is the same but changed status since last time*/
+    if (svc->last_good_srv == NULL ||
+        strcmp(fo_get_server_name(srv), svc->last_good_srv) != 0 ||
+        fo_get_server_port(srv) != svc->last_good_port ||
+        svc->run_callbacks ||
+        srv_status_change > svc->last_status_change) {
+        svc->last_status_change = srv_status_change;
+        svc->run_callbacks = false;
+
+        srvname = talloc_strdup(svc, fo_get_server_name(srv));
+        if (srvname == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to copy server name\n");
+            return ENOMEM;
+        }
+
+        talloc_free(svc->last_good_srv);
+        svc->last_good_srv = srvname;
+        svc->last_good_port = fo_get_server_port(srv);
+
+        DLIST_FOR_EACH(callback, svc->callbacks) {
+            callback->fn(callback->private_data, srv);
+        }
+    }
+
+    return EOK;
+}
+
 errno_t be_resolve_server_process(struct tevent_req *subreq,
                                   struct be_resolve_server_state *state,
                                   struct tevent_req **new_subreq)
 {
     errno_t ret;
-    time_t srv_status_change;
-    struct be_svc_callback *callback;
-    char *srvname;
 
     ret = fo_resolve_service_recv(subreq, state, &state->srv);
     switch (ret) {
@@ -620,10 +712,7 @@ errno_t be_resolve_server_process(struct tevent_req *subreq,
 
         /* now try next one */
         DEBUG(SSSDBG_TRACE_LIBS, "Trying with the next one!\n");
-        subreq = fo_resolve_service_send(state, state->ev,
-                                         state->ctx->be_fo->be_res->resolv,
-                                         state->ctx->be_fo->fo_ctx,
-                                         state->svc->fo_service);
+        subreq = be_resolve_service_send(state);
         if (!subreq) {
             return ENOMEM;
         }
@@ -664,34 +753,7 @@ errno_t be_resolve_server_process(struct tevent_req *subreq,
               srvaddr->addr_list[0]->ttl);
     }
 
-    srv_status_change = fo_get_server_hostname_last_change(state->srv);
-
-    /* now call all svc callbacks if server changed or if it is explicitly
-     * requested or if the server is the same but changed status since last time*/
-    if (state->svc->last_good_srv == NULL ||
-        strcmp(fo_get_server_name(state->srv), state->svc->last_good_srv) != 0 ||
-        fo_get_server_port(state->srv) != state->svc->last_good_port ||
-        state->svc->run_callbacks ||
-        srv_status_change > state->svc->last_status_change) {
-        state->svc->last_status_change = srv_status_change;
-        state->svc->run_callbacks = false;
-
-        srvname = talloc_strdup(state->svc, fo_get_server_name(state->srv));
-        if (srvname == NULL) {
-            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to copy server name\n");
-            return ENOMEM;
-        }
-
-        talloc_free(state->svc->last_good_srv);
-        state->svc->last_good_srv = srvname;
-        state->svc->last_good_port = fo_get_server_port(state->srv);
-
-        DLIST_FOR_EACH(callback, state->svc->callbacks) {
-            callback->fn(callback->private_data, state->srv);
-        }
-    }
-
-    return EOK;
+    return be_svc_run_callbacks(state->svc, state->srv);
 }
 
 int be_resolve_server_recv(struct tevent_req *req,
@@ -738,6 +800,38 @@ const char *be_fo_get_active_server_name(struct be_ctx *ctx,
     return NULL;
 }
 
+errno_t be_fo_use_server(struct be_ctx *ctx,
+                         const char *service_name,
+                         struct fo_server *server)
+{
+    struct be_svc_data *svc;
+
+    svc = be_fo_find_svc_data(ctx, service_name);
+    if (svc == NULL) {
+        return ENOENT;
+    }
+
+    return be_svc_run_callbacks(svc, server);
+}
+
+void be_fo_set_server_tuning(struct be_ctx *ctx,
+                             const char *service_name,
+                             uint32_t page_size,
+                             uint32_t pool_size,
+                             uint32_t page_msecs)
+{
+    struct be_svc_data *svc;
+
+    svc = be_fo_find_svc_data(ctx, service_name);
+    if (svc == NULL) {
+        return;
+    }
+
+    svc->page_size = page_size;
+    svc->pool_size = pool_size;
+    svc->page_msecs = page_msecs;
+}
+
 int be_fo_run_callbacks_at_next_request(struct be_ctx *ctx,
                                         const char *service_name)
 {
@@ -837,6 +931,7 @@ static struct dp_option dp_res_default_opts[] = {
     { "dns_resolver_op_timeout", DP_OPT_NUMBER, { .number = 3 }, NULL_NUMBER },
     { "dns_resolver_server_timeout", DP_OPT_NUMBER, { .number = 1000 }, NULL_NUMBER },
     { "dns_discovery_domain", DP_OPT_STRING, NULL_STRING, NULL_STRING },
+    { "dns_resolver_cache_size", DP_OPT_NUMBER, { .number = 512 }, NULL_NUMBER },
     DP_OPTION_TERMINATOR
 };
 
@@ -877,6 +972,7 @@ static errno_t be_res_get_opts(struct be_resolv_ctx *res_ctx,
 
 errno_t be_res_init(struct be_ctx *ctx)
 {
+    int cache_size;
     errno_t ret;
 
     if (ctx->be_res != NULL) {
@@ -905,5 +1001,15 @@ errno_t be_res_init(struct be_ctx *ctx)
         return ret;
     }
 
+    cache_size = dp_opt_get_int(ctx->be_res->opts,
+                                DP_RES_OPT_RESOLVER_CACHE_SIZE);
+    if (cache_size > 0) {
+        ret = resolv_cache_init(ctx->be_res->resolv, cache_size);
+        if (ret != EOK) {
+            talloc_zfree(ctx->be_res);
+            return ret;
+        }
+    }
+
     return EOK;
 }
@@ -24,11 +24,15 @@
 */
 
 #include <sys/time.h>
+#include <arpa/inet.h>
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <strings.h>
 #include <talloc.h>
+#include <unistd.h>
 
 #include "util/dlinklist.h"
 #include "util/refcount.h"
@@ -43,6 +47,13 @@
 #define DEFAULT_SERVER_STATUS SERVER_NAME_NOT_RESOLVED
 #define DEFAULT_SRV_STATUS SRV_NEUTRAL
 
+/* how much faster, in percent, another server must be to replace the
+ * active one when prefer_fastest is set */
+#define FO_LATENCY_HYSTERESIS 25
+
+/* longest line of the SRV cache file */
+#define FO_SRV_CACHE_LINE 1024
+
 enum srv_lookup_status {
     SRV_NEUTRAL,        /* We didn't try this SRV lookup yet */
     SRV_RESOLVED,       /* This SRV lookup is resolved       */
@@ -59,6 +70,12 @@ struct fo_ctx {
     fo_srv_lookup_plugin_send_t srv_send_fn;
     fo_srv_lookup_plugin_recv_t srv_recv_fn;
     void *srv_pvt;
+    /* the plugin keeps its results across restarts by itself */
+    bool srv_persistent;
+
+    /* totals of the operation latencies reported for all servers */
+    uint64_t num_ops;
+    uint64_t ops_usecs;
 };
 
 struct fo_service {
@@ -85,9 +102,16 @@ struct fo_server {
     struct fo_server *next;
 
     bool primary;
+    /* SRV priority, zero for configured servers */
+    unsigned short priority;
     void *user_data;
     int port;
     enum port_status port_status;
+    /* moving averages of the reported latencies, zero if unknown */
+    uint64_t connect_usecs;
+    uint64_t op_usecs;
+    /* connection attempts in progress, see fo_set_server_connecting() */
+    int connecting;
     struct srv_data *srv_data;
     struct fo_service *service;
     struct timeval last_status_change;
@@ -109,6 +133,10 @@ struct server_common {
     struct resolve_service_request *request_list;
     enum server_status server_status;
     struct timeval last_status_change;
+
+    /* background refresh of the hostname resolution */
+    struct tevent_req *refresh_req;
+    time_t refresh_retry;
 };
 
 struct srv_data {
@@ -123,6 +151,12 @@ struct srv_data {
     int srv_lookup_status;
     int ttl;
     struct timeval last_status_change;
+
+    /* background refresh of the SRV lookup */
+    struct tevent_req *refresh_req;
+    time_t refresh_retry;
+    /* the SRV cache file was already consulted */
+    bool cache_loaded;
 };
 
 struct resolve_service_request {
@@ -159,6 +193,16 @@ fo_context_init(TALLOC_CTX *mem_ctx, struct fo_options *opts)
     ctx->opts->retry_timeout = opts->retry_timeout;
     ctx->opts->family_order  = opts->family_order;
     ctx->opts->service_resolv_timeout = opts->service_resolv_timeout;
+    ctx->opts->prefer_fastest = opts->prefer_fastest;
+    ctx->opts->dns_stale_timeout = opts->dns_stale_timeout;
+    if (opts->srv_cache_path != NULL) {
+        ctx->opts->srv_cache_path = talloc_strdup(ctx->opts,
+                                                  opts->srv_cache_path);
+        if (ctx->opts->srv_cache_path == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "No memory\n");
+            return NULL;
+        }
+    }
 
     DEBUG(SSSDBG_TRACE_FUNC,
           "Created new fail over context, retry timeout is %ld\n",
@@ -295,8 +339,9 @@ get_srv_data_status(struct srv_data *data)
         case SRV_NEUTRAL:
             break;
         case SRV_RESOLVED:
+            /* keep the time of the lookup, expired results may still be
+             * served while they are refreshed */
             data->srv_lookup_status = SRV_EXPIRED;
-            data->last_status_change.tv_sec = 0;
             break;
         case SRV_RESOLVE_ERROR:
             data->srv_lookup_status = SRV_NEUTRAL;
@@ -323,6 +368,24 @@ set_srv_data_status(struct srv_data *data, enum srv_lookup_status status)
     data->srv_lookup_status = status;
 }
 
+/*
+ * Expired DNS results are still used for up to dns_stale_timeout seconds
+ * while they are refreshed in the background.
+ */
+static bool
+fo_dns_stale_usable(struct fo_ctx *ctx, time_t age, time_t ttl)
+{
+    return ctx->opts->dns_stale_timeout > 0
+           && age <= ttl + ctx->opts->dns_stale_timeout;
+}
+
+/* Refresh ahead of expiry once three quarters of the TTL are gone. */
+static bool
+fo_dns_refresh_due(struct fo_ctx *ctx, time_t age, time_t ttl)
+{
+    return ctx->opts->dns_stale_timeout > 0 && age >= ttl - ttl / 4;
+}
+
 /*
  * This function will return the status of the server. If the status was
  * last updated a long time ago, we will first reset the status.
@@ -353,10 +416,20 @@ get_server_status(struct fo_server *server)
 
     if (server->common->rhostent && STATUS_DIFF(server->common, tv) >
         server->common->rhostent->addr_list[0]->ttl) {
-        DEBUG(SSSDBG_CONF_SETTINGS,
-              "Hostname resolution expired, resetting the server "
-                  "status of '%s'\n", SERVER_NAME(server));
-        fo_set_server_status(server, SERVER_NAME_NOT_RESOLVED);
+        if ((server->common->server_status == SERVER_NAME_RESOLVED
+                || server->common->server_status == SERVER_WORKING)
+                && fo_dns_stale_usable(server->service->ctx,
+                                STATUS_DIFF(server->common, tv),
+                                server->common->rhostent->addr_list[0]->ttl)) {
+            DEBUG(SSSDBG_TRACE_LIBS,
+                  "Hostname resolution of '%s' expired, using it until "
+                  "it is refreshed\n", SERVER_NAME(server));
+        } else {
+            DEBUG(SSSDBG_CONF_SETTINGS,
+                  "Hostname resolution expired, resetting the server "
+                      "status of '%s'\n", SERVER_NAME(server));
+            fo_set_server_status(server, SERVER_NAME_NOT_RESOLVED);
+        }
     }
 
     return server->common->server_status;
@@ -417,6 +490,15 @@ service_works(struct fo_server *server)
     return 1;
 }
 
+static int
+service_available(struct fo_server *server, bool skip_connecting)
+{
+    if (skip_connecting && server->connecting > 0)
+        return 0;
+
+    return service_works(server);
+}
+
 static int
 service_destructor(struct fo_service *service)
 {
@@ -539,6 +621,8 @@ create_server_common(TALLOC_CTX *mem_ctx, struct fo_ctx *ctx, const char *name)
     common->server_status = DEFAULT_SERVER_STATUS;
     common->last_status_change.tv_sec = 0;
     common->last_status_change.tv_usec = 0;
+    common->refresh_req = NULL;
+    common->refresh_retry = 0;
 
     talloc_set_destructor((TALLOC_CTX *) common, server_common_destructor);
     DLIST_ADD_END(ctx->server_common_list, common, struct server_common *);
@@ -817,6 +901,7 @@ static errno_t fo_add_server_list(struct fo_service *service,
         }
 
         server->srv_data = srv_data;
+        server->priority = servers[i].priority;
 
         ret = fo_add_server_to_list(&srv_list, service->server_list,
                                     server, service->name);
@@ -869,18 +954,77 @@ void fo_ref_server(TALLOC_CTX *ref_ctx,
     }
 }
 
+static uint64_t
+fo_server_latency_score(struct fo_server *server)
+{
+    /* the first reply to an operation tells more than the connection */
+    return server->op_usecs != 0 ? server->op_usecs : server->connect_usecs;
+}
+
+/* Returns a working server from the same tier as 'active' whose latency is
+ * clearly lower, or 'active' itself. Only servers that were used before
+ * have a latency to compare, if conditions change the average of the
+ * active server goes up until the switch happens. */
+static struct fo_server *
+fo_find_faster_server(struct fo_service *service, struct fo_server *active)
+{
+    struct fo_server *fastest = NULL;
+    struct fo_server *server;
+    uint64_t active_score;
+    uint64_t score;
+
+    active_score = fo_server_latency_score(active);
+    if (active_score == 0) {
+        return active;
+    }
+
+    DLIST_FOR_EACH(server, service->server_list) {
+        if (server == active || fo_is_srv_lookup(server)) continue;
+        if (server->primary != active->primary
+                || server->priority != active->priority) continue;
+        if (!service_works(server)) continue;
+
+        score = fo_server_latency_score(server);
+        if (score == 0) continue;
+
+        if (fastest == NULL || score < fo_server_latency_score(fastest)) {
+            fastest = server;
+        }
+    }
+
+    if (fastest == NULL) {
+        return active;
+    }
+
+    score = fo_server_latency_score(fastest);
+    if (score * (100 + FO_LATENCY_HYSTERESIS) >= active_score * 100) {
+        return active;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Server '%s' answers in %"PRIu64" us, "
+          "switching from '%s' which answers in %"PRIu64" us\n",
+          SERVER_NAME(fastest), score, SERVER_NAME(active), active_score);
+
+    return fastest;
+}
+
 static int
-get_first_server_entity(struct fo_service *service, struct fo_server **_server)
+get_first_server_entity(struct fo_service *service, bool skip_connecting,
+                        struct fo_server **_server)
 {
     struct fo_server *server;
 
     /* If we already have a working server, use that one. */
     server = service->active_server;
     if (server != NULL) {
-        if (service_works(server) && fo_is_server_primary(server)) {
+        if (!service_works(server) || !fo_is_server_primary(server)) {
+            service->active_server = NULL;
+        } else if (service_available(server, skip_connecting)) {
+            if (service->ctx->opts->prefer_fastest) {
+                server = fo_find_faster_server(service, server);
+            }
             goto done;
         }
-        service->active_server = NULL;
     }
 
     /*
@@ -893,7 +1037,7 @@ get_first_server_entity(struct fo_service *service, struct fo_server **_server)
     if (service->last_tried_server != NULL &&
         service->last_tried_server->primary) {
         if (service->last_tried_server->port_status == PORT_NEUTRAL &&
-            server_works(service->last_tried_server)) {
+            service_available(service->last_tried_server, skip_connecting)) {
             server = service->last_tried_server;
             goto done;
         }
@@ -902,7 +1046,7 @@ get_first_server_entity(struct fo_service *service, struct fo_server **_server)
             /* Go only through primary servers */
             if (!server->primary) continue;
 
-            if (service_works(server)) {
+            if (service_available(server, skip_connecting)) {
                 goto done;
             }
         }
@@ -913,7 +1057,7 @@ get_first_server_entity(struct fo_service *service, struct fo_server **_server)
         /* First iterate only over primary servers */
         if (!server->primary) continue;
 
-        if (service_works(server)) {
+        if (service_available(server, skip_connecting)) {
             goto done;
         }
         if (server == service->last_tried_server) {
@@ -925,7 +1069,7 @@ get_first_server_entity(struct fo_service *service, struct fo_server **_server)
         /* Now iterate only over backup servers */
         if (server->primary) continue;
 
-        if (service_works(server)) {
+        if (service_available(server, skip_connecting)) {
             goto done;
         }
     }
@@ -1002,10 +1146,18 @@ resolve_srv_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
 static int
 resolve_srv_recv(struct tevent_req *req, struct fo_server **server);
 
-struct tevent_req *
-fo_resolve_service_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
-                        struct resolv_ctx *resolv, struct fo_ctx *ctx,
-                        struct fo_service *service)
+static void fo_refresh_server_common(struct tevent_context *ev,
+                                     struct resolv_ctx *resolv,
+                                     struct server_common *common);
+static void fo_srv_cache_store(struct fo_ctx *ctx);
+
+static struct tevent_req *
+fo_resolve_service_internal_send(TALLOC_CTX *mem_ctx,
+                                 struct tevent_context *ev,
+                                 struct resolv_ctx *resolv,
+                                 struct fo_ctx *ctx,
+                                 struct fo_service *service,
+                                 bool skip_connecting)
 {
     int ret;
     struct fo_server *server;
@@ -1023,7 +1175,7 @@ fo_resolve_service_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
     state->ev = ev;
     state->fo_ctx = ctx;
 
-    ret = get_first_server_entity(service, &server);
+    ret = get_first_server_entity(service, skip_connecting, &server);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "No available servers for service '%s'\n", service->name);
@@ -1068,6 +1220,24 @@ done:
     return req;
 }
 
+struct tevent_req *
+fo_resolve_service_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
+                        struct resolv_ctx *resolv, struct fo_ctx *ctx,
+                        struct fo_service *service)
+{
+    return fo_resolve_service_internal_send(mem_ctx, ev, resolv, ctx,
+                                            service, false);
+}
+
+struct tevent_req *
+fo_resolve_other_service_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
+                              struct resolv_ctx *resolv, struct fo_ctx *ctx,
+                              struct fo_service *service)
+{
+    return fo_resolve_service_internal_send(mem_ctx, ev, resolv, ctx,
+                                            service, true);
+}
+
 static void set_server_common_status(struct server_common *common,
                                      enum server_status status);
 
@@ -1116,6 +1286,9 @@ fo_resolve_service_cont(struct tevent_req *subreq)
     int ret;
 
     ret = resolve_srv_recv(subreq, &state->server);
+    /* A background refresh may replace the server while its name is
+     * resolved */
+    fo_ref_server(state, state->server);
     talloc_zfree(subreq);
 
     /* We will proceed normally on ERR_SRV_DUPLICATES and if the server
@@ -1162,6 +1335,8 @@ fo_resolve_service_server(struct tevent_req *req)
         }
         break;
     default: /* The name is already resolved. Return immediately. */
+        fo_refresh_server_common(state->ev, state->resolv,
+                                 state->server->common);
         tevent_req_done(req);
         return true;
     }
@@ -1202,6 +1377,7 @@ fo_resolve_service_done(struct tevent_req *subreq)
         set_server_common_status(common, SERVER_NOT_WORKING);
     } else {
         set_server_common_status(common, SERVER_NAME_RESOLVED);
+        fo_srv_cache_store(common->ctx);
     }
 
     /* Take care of all requests for this server. */
@@ -1222,6 +1398,88 @@ fo_resolve_service_done(struct tevent_req *subreq)
     }
 }
 
+static void fo_refresh_server_common_done(struct tevent_req *subreq);
+
+/* Resolve the hostname again in the background when its addresses are about
+ * to expire or have expired, the old addresses are used meanwhile. */
+static void
+fo_refresh_server_common(struct tevent_context *ev,
+                         struct resolv_ctx *resolv,
+                         struct server_common *common)
+{
+    struct timeval tv;
+
+    if (common == NULL || common->rhostent == NULL
+            || common->refresh_req != NULL) {
+        return;
+    }
+
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec < common->refresh_retry
+            || !fo_dns_refresh_due(common->ctx, STATUS_DIFF(common, tv),
+                                   common->rhostent->addr_list[0]->ttl)) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Refreshing addresses of server '%s' in the background\n",
+          common->name);
+
+    common->refresh_req = resolv_gethostbyname_send(common, ev, resolv,
+                                        common->name,
+                                        common->ctx->opts->family_order,
+                                        default_host_dbs);
+    if (common->refresh_req == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to refresh server '%s'\n",
+              common->name);
+        return;
+    }
+
+    tevent_req_set_callback(common->refresh_req,
+                            fo_refresh_server_common_done, common);
+}
+
+static void
+fo_refresh_server_common_done(struct tevent_req *subreq)
+{
+    struct server_common *common = tevent_req_callback_data(subreq,
+                                                        struct server_common);
+    struct resolv_hostent *rhostent = NULL;
+    int resolv_status = 0;
+    int ret;
+
+    common->refresh_req = NULL;
+
+    ret = resolv_gethostbyname_recv(subreq, common,
+                                    &resolv_status, NULL,
+                                    &rhostent);
+    talloc_zfree(subreq);
+    if (ret != EOK || rhostent == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Failed to refresh server '%s', keeping its old "
+              "addresses: %s\n", common->name,
+              resolv_strerror(resolv_status));
+        common->refresh_retry = time(NULL)
+                                + common->ctx->opts->srv_retry_neg_timeout;
+        return;
+    }
+
+    if (common->server_status != SERVER_NAME_RESOLVED
+            && common->server_status != SERVER_WORKING) {
+        /* The server was reset meanwhile, a regular resolution takes over */
+        talloc_free(rhostent);
+        return;
+    }
+
+    talloc_free(common->rhostent);
+    common->rhostent = rhostent;
+    common->refresh_retry = 0;
+    /* The addresses are valid for their whole TTL again */
+    gettimeofday(&common->last_status_change, NULL);
+
+    fo_srv_cache_store(common->ctx);
+}
+
 int
 fo_resolve_service_recv(struct tevent_req *req,
                         TALLOC_CTX *ref_ctx,
@@ -1247,174 +1505,1005 @@ fo_resolve_service_recv(struct tevent_req *req,
  * Resolve the server to connect to using a SRV query.             *
  *******************************************************************/
 
-static void resolve_srv_done(struct tevent_req *subreq);
+/* Insert the servers an SRV lookup resolved to in place of its meta server.
+ * The first of them is returned in _first. */
+static errno_t
+fo_srv_expand(struct fo_server *meta, char *dns_domain, uint32_t ttl,
+              struct fo_server_info *primary_servers,
+              size_t num_primary_servers,
+              struct fo_server_info *backup_servers,
+              size_t num_backup_servers,
+              struct fo_server **_first)
+{
+    struct fo_service *service = meta->service;
+    struct fo_server *last_server;
+    errno_t ret;
 
-struct resolve_srv_state {
-    struct fo_server *meta;
-    struct fo_service *service;
+    if ((num_primary_servers == 0 || primary_servers == NULL)
+            && (num_backup_servers == 0 || backup_servers == NULL)) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "SRV lookup plugin returned EOK but "
+                                    "no servers\n");
+        return EFAULT;
+    }
 
-    struct fo_server *out;
+    meta->srv_data->ttl = ttl;
+    talloc_zfree(meta->srv_data->dns_domain);
+    meta->srv_data->dns_domain = talloc_steal(meta->srv_data, dns_domain);
 
-    struct resolv_ctx *resolv;
-    struct tevent_context *ev;
-    struct fo_ctx *fo_ctx;
+    last_server = meta;
+
+    if (primary_servers != NULL) {
+        ret = fo_add_server_list(service, last_server,
+                                 primary_servers, num_primary_servers,
+                                 meta->srv_data, meta->user_data,
+                                 true, &last_server);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    if (backup_servers != NULL) {
+        ret = fo_add_server_list(service, last_server,
+                                 backup_servers, num_backup_servers,
+                                 meta->srv_data, meta->user_data,
+                                 false, &last_server);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    if (last_server == meta) {
+        /* SRV lookup returned only those servers that are already present.
+         * This may happen only when an ongoing SRV resolution already
+         * exist. We will return server, but won't set any state. */
+        DEBUG(SSSDBG_TRACE_FUNC, "SRV lookup did not return "
+                                  "any new server.\n");
+        return ERR_SRV_DUPLICATES;
+    }
+
+    /* At least one new server was inserted.
+     * We will return the first new server. */
+    if (meta->next == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+             "BUG: meta->next is NULL\n");
+        return ERR_INTERNAL;
+    }
+
+    *_first = meta->next;
+
+    /* And remove meta server from the server list. It will be
+     * inserted again during srv collapse. */
+    DLIST_REMOVE(service->server_list, meta);
+    if (service->last_tried_server == meta) {
+        service->last_tried_server = *_first;
+    }
+
+    set_srv_data_status(meta->srv_data, SRV_RESOLVED);
+    return EOK;
+}
+
+/*******************************************************************
+ * SRV cache file.                                                 *
+ *                                                                 *
+ * The expanded SRV lookups and the addresses of their servers are *
+ * kept in srv_cache_path so that a restarted provider can use     *
+ * them before DNS answers. One entry per line, fields separated   *
+ * by tabs:                                                        *
+ *   srv <service> <srv> <proto> <discovery domain> <dns domain>   *
+ *       <expiration>                                              *
+ *   server <host> <port> <priority> <primary>                     *
+ *   addr <address> <expiration>                                   *
+ * Each srv line is followed by its servers, each server line by   *
+ * its addresses.                                                  *
+ *******************************************************************/
+
+struct fo_srv_cache_entry {
+    struct fo_server_info info;
+    bool primary;
+    const char **addrs;
+    size_t num_addrs;
+    time_t addr_expire;
 };
 
-static struct tevent_req *
-resolve_srv_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
-                 struct resolv_ctx *resolv, struct fo_ctx *ctx,
-                 struct fo_server *server)
+static char *
+fo_srv_cache_append_addrs(char *contents, struct server_common *common)
 {
-    int ret;
-    struct tevent_req *req;
-    struct tevent_req *subreq;
-    struct resolve_srv_state *state;
-    int status;
-
-    req = tevent_req_create(mem_ctx, &state, struct resolve_srv_state);
-    if (req == NULL)
-        return NULL;
+    char buf[INET6_ADDRSTRLEN];
+    size_t i;
 
-    state->service = server->service;
-    state->ev = ev;
-    state->resolv = resolv;
-    state->fo_ctx = ctx;
-    state->meta = server->srv_data->meta;
+    if (common->rhostent == NULL
+            || (common->server_status != SERVER_NAME_RESOLVED
+                && common->server_status != SERVER_WORKING)) {
+        return contents;
+    }
 
-    status = get_srv_data_status(server->srv_data);
-    DEBUG(SSSDBG_FUNC_DATA, "The status of SRV lookup is %s\n",
-          str_srv_data_status(status));
-    switch(status) {
-    case SRV_EXPIRED: /* Need a refresh */
-        state->meta = collapse_srv_lookup(&server);
-        /* FALLTHROUGH.
-         * "server" might be invalid now if the SRV
-         * query collapsed
-         * */
-        SSS_ATTRIBUTE_FALLTHROUGH;
-    case SRV_NEUTRAL: /* Request SRV lookup */
-        if (server != NULL && server != state->meta) {
-            /* A server created by expansion of meta server was marked as
-             * neutral. We have to collapse the servers and issue new
-             * SRV resolution. */
-            state->meta = collapse_srv_lookup(&server);
+    for (i = 0; contents != NULL
+                && common->rhostent->addr_list[i] != NULL; i++) {
+        if (inet_ntop(common->rhostent->family,
+                      common->rhostent->addr_list[i]->ipaddr,
+                      buf, sizeof(buf)) == NULL) {
+            continue;
         }
 
-        if (ctx->srv_send_fn == NULL || ctx->srv_recv_fn == NULL) {
-            DEBUG(SSSDBG_OP_FAILURE, "No SRV lookup plugin is set\n");
-            ret = ENOTSUP;
-            goto done;
-        }
+        contents = talloc_asprintf_append(contents, "addr\t%s\t%lld\n", buf,
+                        (long long) common->last_status_change.tv_sec
+                        + common->rhostent->addr_list[i]->ttl);
+    }
 
-        subreq = ctx->srv_send_fn(state, ev,
-                                  state->meta->srv_data->srv,
-                                  state->meta->srv_data->proto,
-                                  state->meta->srv_data->discovery_domain,
-                                  ctx->srv_pvt);
-        if (subreq == NULL) {
-            ret = ENOMEM;
-            goto done;
-        }
+    return contents;
+}
 
-        tevent_req_set_callback(subreq, resolve_srv_done, req);
-        break;
-    case SRV_RESOLVE_ERROR: /* query could not be resolved but don't retry yet */
-        ret = EIO;
-        state->out = server;
+static errno_t
+fo_srv_cache_write(TALLOC_CTX *mem_ctx, const char *path,
+                   const char *contents)
+{
+    char *tmp_name;
+    size_t len;
+    ssize_t written;
+    int fd = -1;
+    errno_t ret;
 
-        /* The port status was reseted to neutral but we still haven't reached
-         * timeout to try to resolve SRV record again. We will set the port
-         * status back to not working. */
-        fo_set_port_status(state->meta, PORT_NOT_WORKING);
+    tmp_name = talloc_asprintf(mem_ctx, "%s.XXXXXX", path);
+    if (tmp_name == NULL) {
+        return ENOMEM;
+    }
+
+    fd = sss_unique_file(mem_ctx, tmp_name, &ret);
+    if (fd == -1) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "sss_unique_file failed [%d][%s].\n", ret, strerror(ret));
+        return ret;
+    }
+
+    len = strlen(contents);
+    errno = 0;
+    written = sss_atomic_write_s(fd, discard_const(contents), len);
+    if (written == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_OP_FAILURE,
+              "write failed [%d][%s].\n", ret, strerror(ret));
         goto done;
-    case SRV_RESOLVED:  /* The query is resolved and valid. Return. */
-        state->out = server;
-        tevent_req_done(req);
-        tevent_req_post(req, state->ev);
-        return req;
-    default:
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Unexpected status %d for a SRV server\n", status);
+    }
+
+    if (written != len) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Write error, wrote [%zd] bytes, expected [%zu]\n",
+               written, len);
         ret = EIO;
         goto done;
     }
 
+    ret = close(fd);
+    fd = -1;
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_OP_FAILURE,
+              "close failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+
+    ret = rename(tmp_name, path);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_OP_FAILURE,
+              "rename failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+
     ret = EOK;
 done:
-    if (ret != EOK) {
-        tevent_req_error(req, ret);
-        tevent_req_post(req, ev);
+    if (fd != -1) {
+        close(fd);
     }
-    return req;
+    return ret;
 }
 
 static void
-resolve_srv_done(struct tevent_req *subreq)
+fo_srv_cache_store(struct fo_ctx *ctx)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
-    struct resolve_srv_state *state = tevent_req_data(req,
-                                                struct resolve_srv_state);
-    struct fo_server *last_server = NULL;
-    struct fo_server_info *primary_servers = NULL;
-    struct fo_server_info *backup_servers = NULL;
-    size_t num_primary_servers = 0;
-    size_t num_backup_servers = 0;
-    char *dns_domain = NULL;
-    int ret;
-    uint32_t ttl;
+    TALLOC_CTX *tmp_ctx;
+    struct fo_service *service;
+    struct fo_server *server;
+    struct srv_data *data;
+    struct srv_data *last;
+    char *contents;
+    bool found = false;
+    errno_t ret;
 
-    ret = state->fo_ctx->srv_recv_fn(state, subreq, &dns_domain, &ttl,
-                                     &primary_servers, &num_primary_servers,
-                                     &backup_servers, &num_backup_servers);
-    talloc_free(subreq);
-    switch (ret) {
-    case EOK:
-        if ((num_primary_servers == 0 || primary_servers == NULL)
-                && (num_backup_servers == 0 || backup_servers == NULL)) {
-            DEBUG(SSSDBG_CRIT_FAILURE, "SRV lookup plugin returned EOK but "
-                                        "no servers\n");
-            ret = EFAULT;
+    if (ctx->opts->srv_cache_path == NULL || ctx->srv_persistent) {
+        return;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return;
+    }
+
+    contents = talloc_strdup(tmp_ctx, "");
+    DLIST_FOR_EACH(service, ctx->service_list) {
+        last = NULL;
+        DLIST_FOR_EACH(server, service->server_list) {
+            data = server->srv_data;
+            if (contents == NULL) {
+                break;
+            }
+
+            if (data == NULL || server == data->meta
+                    || server->common == NULL
+                    || (data->srv_lookup_status != SRV_RESOLVED
+                        && data->srv_lookup_status != SRV_EXPIRED)) {
+                continue;
+            }
+
+            /* The servers of one lookup are always next to each other */
+            if (data != last) {
+                contents = talloc_asprintf_append(contents,
+                                "srv\t%s\t%s\t%s\t%s\t%s\t%lld\n",
+                                service->name, data->srv, data->proto,
+                                data->discovery_domain ?: "",
+                                data->dns_domain ?: "",
+                                (long long) data->last_status_change.tv_sec
+                                + data->ttl);
+                last = data;
+                found = true;
+            }
+
+            if (contents != NULL) {
+                contents = talloc_asprintf_append(contents,
+                                "server\t%s\t%d\t%hu\t%d\n",
+                                server->common->name, server->port,
+                                server->priority, server->primary ? 1 : 0);
+            }
+
+            if (contents != NULL) {
+                contents = fo_srv_cache_append_addrs(contents,
+                                                     server->common);
+            }
+        }
+    }
+
+    if (contents == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "No memory\n");
+        goto done;
+    }
+
+    if (!found) {
+        goto done;
+    }
+
+    ret = fo_srv_cache_write(tmp_ctx, ctx->opts->srv_cache_path, contents);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write SRV cache file %s "
+              "[%d]: %s\n", ctx->opts->srv_cache_path, ret, sss_strerror(ret));
+    }
+
+done:
+    talloc_free(tmp_ctx);
+}
+
+static bool
+fo_srv_cache_time(const char *str, time_t *_time)
+{
+    char *end;
+    long long num;
+
+    errno = 0;
+    num = strtoll(str, &end, 10);
+    if (errno != 0 || end == str || *end != '\0' || num < 0) {
+        return false;
+    }
+
+    *_time = num;
+    return true;
+}
+
+static bool
+fo_srv_cache_number(const char *str, long max, long *_num)
+{
+    char *end;
+    long num;
+
+    errno = 0;
+    num = strtol(str, &end, 10);
+    if (errno != 0 || end == str || *end != '\0' || num < 0 || num > max) {
+        return false;
+    }
+
+    *_num = num;
+    return true;
+}
+
+static bool
+fo_srv_cache_srv_matches(struct srv_data *data, char **fields)
+{
+    const char *discovery_domain = data->discovery_domain ?: "";
+
+    return strcmp(fields[1], data->meta->service->name) == 0
+           && strcmp(fields[2], data->srv) == 0
+           && strcmp(fields[3], data->proto) == 0
+           && strcasecmp(fields[4], discovery_domain) == 0;
+}
+
+/* Parse the servers cached for the SRV lookup data. */
+static errno_t
+fo_srv_cache_read(TALLOC_CTX *mem_ctx, struct srv_data *data,
+                  char **_dns_domain, time_t *_expire,
+                  struct fo_srv_cache_entry **_entries, size_t *_num_entries)
+{
+    const char *path = data->meta->service->ctx->opts->srv_cache_path;
+    struct fo_srv_cache_entry *entries = NULL;
+    struct fo_srv_cache_entry *entry = NULL;
+    char line[FO_SRV_CACHE_LINE];
+    char *dns_domain = NULL;
+    char **fields;
+    size_t num_entries = 0;
+    time_t expire = 0;
+    time_t addr_expire;
+    long port;
+    long priority;
+    bool in_srv = false;
+    bool found = false;
+    char *end;
+    int num_fields;
+    FILE *f;
+    errno_t ret;
+
+    if (path == NULL) {
+        return ENOENT;
+    }
+
+    f = fopen(path, "r");
+    if (f == NULL) {
+        ret = errno;
+        if (ret != ENOENT) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to open SRV cache file %s "
+                  "[%d]: %s\n", path, ret, sss_strerror(ret));
+        }
+        return ENOENT;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        end = strchr(line, '\n');
+        if (end == NULL) {
+            /* truncated file or overlong line */
+            ret = EINVAL;
             goto done;
         }
+        *end = '\0';
 
-        state->meta->srv_data->ttl = ttl;
-        talloc_zfree(state->meta->srv_data->dns_domain);
-        state->meta->srv_data->dns_domain = talloc_steal(state->meta->srv_data,
-                                                         dns_domain);
+        ret = split_on_separator(mem_ctx, line, '\t', false, false,
+                                 &fields, &num_fields);
+        if (ret != EOK) {
+            goto done;
+        }
 
-        last_server = state->meta;
+        if (strcmp(fields[0], "srv") == 0 && num_fields == 7) {
+            if (found) {
+                /* the servers of our lookup are complete */
+                break;
+            }
 
-        if (primary_servers != NULL) {
-            ret = fo_add_server_list(state->service, last_server,
-                                     primary_servers, num_primary_servers,
-                                     state->meta->srv_data,
-                                     state->meta->user_data,
-                                     true, &last_server);
-            if (ret != EOK) {
+            in_srv = fo_srv_cache_srv_matches(data, fields);
+            if (in_srv) {
+                found = true;
+                if (!fo_srv_cache_time(fields[6], &expire)) {
+                    ret = EINVAL;
+                    goto done;
+                }
+                if (fields[5][0] != '\0') {
+                    dns_domain = talloc_strdup(mem_ctx, fields[5]);
+                    if (dns_domain == NULL) {
+                        ret = ENOMEM;
+                        goto done;
+                    }
+                }
+            }
+        } else if (!in_srv) {
+            continue;
+        } else if (strcmp(fields[0], "server") == 0 && num_fields == 5) {
+            if (fields[1][0] == '\0'
+                    || !fo_srv_cache_number(fields[2], 65535, &port)
+                    || !fo_srv_cache_number(fields[3], 65535, &priority)) {
+                ret = EINVAL;
+                goto done;
+            }
+
+            entries = talloc_realloc(mem_ctx, entries,
+                                     struct fo_srv_cache_entry,
+                                     num_entries + 1);
+            if (entries == NULL) {
+                ret = ENOMEM;
+                goto done;
+            }
+
+            entry = &entries[num_entries];
+            memset(entry, 0, sizeof(struct fo_srv_cache_entry));
+            entry->info.host = fields[1];
+            entry->info.port = port;
+            entry->info.priority = priority;
+            entry->primary = strcmp(fields[4], "1") == 0;
+            num_entries++;
+        } else if (strcmp(fields[0], "addr") == 0 && num_fields == 3
+                   && entry != NULL) {
+            if (!fo_srv_cache_time(fields[2], &addr_expire)) {
+                ret = EINVAL;
                 goto done;
             }
-        }
 
-        if (backup_servers != NULL) {
-            ret = fo_add_server_list(state->service, last_server,
-                                     backup_servers, num_backup_servers,
-                                     state->meta->srv_data,
-                                     state->meta->user_data,
-                                     false, &last_server);
-            if (ret != EOK) {
+            entry->addrs = talloc_realloc(entries, entry->addrs,
+                                          const char *, entry->num_addrs + 1);
+            if (entry->addrs == NULL) {
+                ret = ENOMEM;
                 goto done;
             }
+
+            entry->addrs[entry->num_addrs] = fields[1];
+            if (entry->num_addrs == 0 || addr_expire < entry->addr_expire) {
+                entry->addr_expire = addr_expire;
+            }
+            entry->num_addrs++;
+        } else {
+            ret = EINVAL;
+            goto done;
+        }
+    }
+
+    if (num_entries == 0) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    *_dns_domain = dns_domain;
+    *_expire = expire;
+    *_entries = entries;
+    *_num_entries = num_entries;
+    ret = EOK;
+
+done:
+    fclose(f);
+    if (ret == EINVAL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Malformed SRV cache file %s\n", path);
+    }
+    return ret;
+}
+
+static struct resolv_hostent *
+fo_srv_cache_hostent(TALLOC_CTX *mem_ctx, const char *name,
+                     struct fo_srv_cache_entry *entry, int ttl)
+{
+    struct resolv_hostent *rhostent;
+    size_t len;
+    size_t i;
+    int family;
+
+    family = strchr(entry->addrs[0], ':') == NULL ? AF_INET : AF_INET6;
+    len = family == AF_INET ? sizeof(struct in_addr)
+                            : sizeof(struct in6_addr);
+
+    rhostent = talloc_zero(mem_ctx, struct resolv_hostent);
+    if (rhostent == NULL) {
+        return NULL;
+    }
+
+    rhostent->family = family;
+    rhostent->name = talloc_strdup(rhostent, name);
+    rhostent->aliases = talloc_zero_array(rhostent, char *, 1);
+    rhostent->addr_list = talloc_zero_array(rhostent, struct resolv_addr *,
+                                            entry->num_addrs + 1);
+    if (rhostent->name == NULL || rhostent->aliases == NULL
+            || rhostent->addr_list == NULL) {
+        goto fail;
+    }
+
+    for (i = 0; i < entry->num_addrs; i++) {
+        rhostent->addr_list[i] = talloc_zero(rhostent->addr_list,
+                                             struct resolv_addr);
+        if (rhostent->addr_list[i] == NULL) {
+            goto fail;
+        }
+
+        rhostent->addr_list[i]->ttl = ttl;
+        rhostent->addr_list[i]->ipaddr = talloc_array(rhostent->addr_list[i],
+                                                      uint8_t, len);
+        if (rhostent->addr_list[i]->ipaddr == NULL
+                || inet_pton(family, entry->addrs[i],
+                             rhostent->addr_list[i]->ipaddr) != 1) {
+            goto fail;
+        }
+    }
+
+    return rhostent;
+
+fail:
+    talloc_free(rhostent);
+    return NULL;
+}
+
+/* Expand the SRV lookup data from the cache file, returning the first
+ * server in _first. Addresses of the servers are restored as well. */
+static errno_t
+fo_srv_cache_load(struct srv_data *data, struct fo_server **_first)
+{
+    struct fo_ctx *ctx = data->meta->service->ctx;
+    struct fo_srv_cache_entry *entries;
+    struct fo_server_info *primary_servers;
+    struct fo_server_info *backup_servers;
+    struct resolv_hostent *rhostent;
+    struct server_common *common;
+    struct fo_server *server;
+    size_t num_primary_servers = 0;
+    size_t num_backup_servers = 0;
+    size_t num_entries;
+    TALLOC_CTX *tmp_ctx;
+    char *dns_domain;
+    time_t expire;
+    time_t now;
+    size_t i;
+    errno_t ret;
+
+    if (ctx->opts->srv_cache_path == NULL
+            || ctx->opts->dns_stale_timeout == 0
+            || ctx->srv_persistent) {
+        return ENOENT;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = fo_srv_cache_read(tmp_ctx, data, &dns_domain, &expire,
+                            &entries, &num_entries);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    now = time(NULL);
+    if (!fo_dns_stale_usable(ctx, now - expire, 0)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Cached SRV lookup of service '%s' is "
+              "too old\n", data->meta->service->name);
+        ret = ENOENT;
+        goto done;
+    }
+
+    primary_servers = talloc_array(tmp_ctx, struct fo_server_info,
+                                   num_entries);
+    backup_servers = talloc_array(tmp_ctx, struct fo_server_info,
+                                  num_entries);
+    if (primary_servers == NULL || backup_servers == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < num_entries; i++) {
+        if (entries[i].primary) {
+            primary_servers[num_primary_servers++] = entries[i].info;
+        } else {
+            backup_servers[num_backup_servers++] = entries[i].info;
+        }
+    }
+
+    ret = fo_srv_expand(data->meta, dns_domain,
+                        expire > now ? expire - now : 0,
+                        primary_servers, num_primary_servers,
+                        backup_servers, num_backup_servers,
+                        _first);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Using cached SRV lookup of service '%s'\n",
+          data->meta->service->name);
+
+    for (server = *_first;
+         server != NULL && server->srv_data == data;
+         server = server->next) {
+        common = server->common;
+        if (common == NULL || common->rhostent != NULL
+                || common->server_status != SERVER_NAME_NOT_RESOLVED) {
+            continue;
+        }
+
+        for (i = 0; i < num_entries; i++) {
+            if (strcasecmp(entries[i].info.host, common->name) == 0) {
+                break;
+            }
+        }
+
+        if (i == num_entries || entries[i].num_addrs == 0
+                || !fo_dns_stale_usable(ctx, now - entries[i].addr_expire,
+                                        0)) {
+            continue;
+        }
+
+        rhostent = fo_srv_cache_hostent(common, common->name, &entries[i],
+                        entries[i].addr_expire > now ?
+                                    entries[i].addr_expire - now : 0);
+        if (rhostent == NULL) {
+            continue;
+        }
+
+        common->rhostent = rhostent;
+        set_server_common_status(common, SERVER_NAME_RESOLVED);
+    }
+
+    ret = EOK;
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/*******************************************************************
+ * Refresh of expanded SRV lookups in the background.              *
+ *******************************************************************/
+
+/* Swap the servers of an expanded SRV lookup for the result of its
+ * background refresh, the active server stays active if it is still
+ * listed. */
+static errno_t
+fo_srv_replace(struct srv_data *data, char *dns_domain, uint32_t ttl,
+               struct fo_server_info *primary_servers,
+               size_t num_primary_servers,
+               struct fo_server_info *backup_servers,
+               size_t num_backup_servers)
+{
+    struct fo_service *service = data->meta->service;
+    struct fo_server *active = service->active_server;
+    struct fo_server *server = NULL;
+    struct fo_server *first;
+    struct fo_server *s;
+    TALLOC_CTX *tmp_ctx;
+    char *active_name = NULL;
+    int active_port = 0;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    DLIST_FOR_EACH(s, service->server_list) {
+        if (s->srv_data != data) {
+            continue;
+        }
+
+        if (server == NULL) {
+            server = s;
+        }
+
+        /* Keep the resolved addresses while the servers are replaced */
+        if (s->common != NULL
+                && rc_reference(tmp_ctx, struct server_common,
+                                s->common) == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    if (server == NULL || server == data->meta) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    /* The active server might have been replaced by an earlier refresh
+     * already, so it is matched by its name once the servers are in. */
+    if (active != NULL && active->srv_data == data && active != data->meta
+            && active->common != NULL) {
+        active_name = talloc_strdup(tmp_ctx, active->common->name);
+        if (active_name == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        active_port = active->port;
+        service->active_server = NULL;
+    }
+
+    if (service->last_tried_server != NULL
+            && service->last_tried_server->srv_data == data) {
+        service->last_tried_server = NULL;
+    }
+
+    collapse_srv_lookup(&server);
+
+    ret = fo_srv_expand(data->meta, dns_domain, ttl,
+                        primary_servers, num_primary_servers,
+                        backup_servers, num_backup_servers,
+                        &first);
+    if (ret != EOK) {
+        /* The next request repeats the lookup of the collapsed servers */
+        goto done;
+    }
+
+    if (active_name == NULL) {
+        goto done;
+    }
+
+    DLIST_FOR_EACH(s, first) {
+        if (s->srv_data != data) {
+            break;
+        }
+
+        if (fo_server_match(s, active_name, active_port, s->user_data)) {
+            s->port_status = PORT_WORKING;
+            gettimeofday(&s->last_status_change, NULL);
+            service->active_server = s;
+            service->last_tried_server = s;
+            break;
+        }
+    }
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static void fo_srv_refresh_done(struct tevent_req *subreq);
+
+static void
+fo_srv_refresh(struct tevent_context *ev, struct fo_ctx *ctx,
+               struct srv_data *data)
+{
+    if (data->refresh_req != NULL || time(NULL) < data->refresh_retry) {
+        return;
+    }
+
+    if (ctx->srv_send_fn == NULL || ctx->srv_recv_fn == NULL) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Refreshing SRV lookup of service '%s' in the background\n",
+          data->meta->service->name);
+
+    data->refresh_req = ctx->srv_send_fn(data, ev, data->srv, data->proto,
+                                         data->discovery_domain,
+                                         ctx->srv_pvt);
+    if (data->refresh_req == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to refresh SRV lookup\n");
+        return;
+    }
+
+    tevent_req_set_callback(data->refresh_req, fo_srv_refresh_done, data);
+}
+
+static void
+fo_srv_refresh_done(struct tevent_req *subreq)
+{
+    struct srv_data *data = tevent_req_callback_data(subreq,
+                                                     struct srv_data);
+    struct fo_ctx *ctx = data->meta->service->ctx;
+    struct fo_server_info *primary_servers = NULL;
+    struct fo_server_info *backup_servers = NULL;
+    size_t num_primary_servers = 0;
+    size_t num_backup_servers = 0;
+    char *dns_domain = NULL;
+    TALLOC_CTX *tmp_ctx;
+    uint32_t ttl;
+    errno_t ret;
+
+    data->refresh_req = NULL;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        talloc_free(subreq);
+        return;
+    }
+
+    ret = ctx->srv_recv_fn(tmp_ctx, subreq, &dns_domain, &ttl,
+                           &primary_servers, &num_primary_servers,
+                           &backup_servers, &num_backup_servers);
+    talloc_free(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to refresh SRV lookup [%d]: %s, "
+              "keeping the old servers\n", ret, sss_strerror(ret));
+        data->refresh_retry = time(NULL) + ctx->opts->srv_retry_neg_timeout;
+        goto done;
+    }
+
+    if (data->srv_lookup_status != SRV_RESOLVED
+            && data->srv_lookup_status != SRV_EXPIRED) {
+        /* The servers were reset meanwhile, a regular lookup takes over */
+        goto done;
+    }
+
+    ret = fo_srv_replace(data, dns_domain, ttl,
+                         primary_servers, num_primary_servers,
+                         backup_servers, num_backup_servers);
+    if (ret != EOK && ret != ERR_SRV_DUPLICATES) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to replace the servers of the "
+              "SRV lookup [%d]: %s\n", ret, sss_strerror(ret));
+        goto done;
+    }
+
+    data->refresh_retry = 0;
+    fo_srv_cache_store(ctx);
+
+done:
+    talloc_free(tmp_ctx);
+}
+
+/* Start a background refresh of expired servers if they may still be
+ * used, returns false if they have to be resolved again first. */
+static bool
+fo_srv_serve_stale(struct tevent_context *ev, struct fo_ctx *ctx,
+                   struct srv_data *data)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    if (!fo_dns_stale_usable(ctx, STATUS_DIFF(data, tv), data->ttl)) {
+        return false;
+    }
+
+    fo_srv_refresh(ev, ctx, data);
+    return true;
+}
+
+static void
+fo_srv_refresh_ahead(struct tevent_context *ev, struct fo_ctx *ctx,
+                     struct srv_data *data)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    if (fo_dns_refresh_due(ctx, STATUS_DIFF(data, tv), data->ttl)) {
+        fo_srv_refresh(ev, ctx, data);
+    }
+}
+
+static void resolve_srv_done(struct tevent_req *subreq);
+
+struct resolve_srv_state {
+    struct fo_server *meta;
+    struct fo_service *service;
+
+    struct fo_server *out;
+
+    struct resolv_ctx *resolv;
+    struct tevent_context *ev;
+    struct fo_ctx *fo_ctx;
+};
+
+static struct tevent_req *
+resolve_srv_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
+                 struct resolv_ctx *resolv, struct fo_ctx *ctx,
+                 struct fo_server *server)
+{
+    int ret;
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+    struct resolve_srv_state *state;
+    int status;
+
+    req = tevent_req_create(mem_ctx, &state, struct resolve_srv_state);
+    if (req == NULL)
+        return NULL;
+
+    state->service = server->service;
+    state->ev = ev;
+    state->resolv = resolv;
+    state->fo_ctx = ctx;
+    state->meta = server->srv_data->meta;
+
+    status = get_srv_data_status(server->srv_data);
+    DEBUG(SSSDBG_FUNC_DATA, "The status of SRV lookup is %s\n",
+          str_srv_data_status(status));
+    switch(status) {
+    case SRV_EXPIRED: /* Need a refresh */
+        if (server != state->meta
+                && fo_srv_serve_stale(ev, ctx, server->srv_data)) {
+            /* Keep using the servers until the background refresh
+             * replaces them. */
+            state->out = server;
+            fo_ref_server(state, state->out);
+            tevent_req_done(req);
+            tevent_req_post(req, state->ev);
+            return req;
+        }
+
+        state->meta = collapse_srv_lookup(&server);
+        /* FALLTHROUGH.
+         * "server" might be invalid now if the SRV
+         * query collapsed
+         * */
+        SSS_ATTRIBUTE_FALLTHROUGH;
+    case SRV_NEUTRAL: /* Request SRV lookup */
+        if (server != NULL && server != state->meta) {
+            /* A server created by expansion of meta server was marked as
+             * neutral. We have to collapse the servers and issue new
+             * SRV resolution. */
+            state->meta = collapse_srv_lookup(&server);
+        }
+
+        if (!state->meta->srv_data->cache_loaded) {
+            /* First lookup since start, try the servers resolved before
+             * and validate them in the background right away. */
+            state->meta->srv_data->cache_loaded = true;
+            ret = fo_srv_cache_load(state->meta->srv_data, &state->out);
+            if (ret == EOK) {
+                fo_ref_server(state, state->out);
+                fo_srv_refresh(ev, ctx, state->out->srv_data);
+                tevent_req_done(req);
+                tevent_req_post(req, state->ev);
+                return req;
+            }
         }
 
-        if (last_server == state->meta) {
-            /* SRV lookup returned only those servers that are already present.
-             * This may happen only when an ongoing SRV resolution already
-             * exist. We will return server, but won't set any state. */
-            DEBUG(SSSDBG_TRACE_FUNC, "SRV lookup did not return "
-                                      "any new server.\n");
-            ret = ERR_SRV_DUPLICATES;
+        if (ctx->srv_send_fn == NULL || ctx->srv_recv_fn == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "No SRV lookup plugin is set\n");
+            ret = ENOTSUP;
+            goto done;
+        }
+
+        subreq = ctx->srv_send_fn(state, ev,
+                                  state->meta->srv_data->srv,
+                                  state->meta->srv_data->proto,
+                                  state->meta->srv_data->discovery_domain,
+                                  ctx->srv_pvt);
+        if (subreq == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
 
+        tevent_req_set_callback(subreq, resolve_srv_done, req);
+        break;
+    case SRV_RESOLVE_ERROR: /* query could not be resolved but don't retry yet */
+        ret = EIO;
+        state->out = server;
+
+        /* The port status was reseted to neutral but we still haven't reached
+         * timeout to try to resolve SRV record again. We will set the port
+         * status back to not working. */
+        fo_set_port_status(state->meta, PORT_NOT_WORKING);
+        goto done;
+    case SRV_RESOLVED:  /* The query is resolved and valid. Return. */
+        state->out = server;
+        fo_srv_refresh_ahead(ev, ctx, server->srv_data);
+        tevent_req_done(req);
+        tevent_req_post(req, state->ev);
+        return req;
+    default:
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unexpected status %d for a SRV server\n", status);
+        ret = EIO;
+        goto done;
+    }
+
+    ret = EOK;
+done:
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+    return req;
+}
+
+static void
+resolve_srv_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct resolve_srv_state *state = tevent_req_data(req,
+                                                struct resolve_srv_state);
+    struct fo_server_info *primary_servers = NULL;
+    struct fo_server_info *backup_servers = NULL;
+    size_t num_primary_servers = 0;
+    size_t num_backup_servers = 0;
+    char *dns_domain = NULL;
+    int ret;
+    uint32_t ttl;
+
+    ret = state->fo_ctx->srv_recv_fn(state, subreq, &dns_domain, &ttl,
+                                     &primary_servers, &num_primary_servers,
+                                     &backup_servers, &num_backup_servers);
+    talloc_free(subreq);
+    switch (ret) {
+    case EOK:
+        ret = fo_srv_expand(state->meta, dns_domain, ttl,
+                            primary_servers, num_primary_servers,
+                            backup_servers, num_backup_servers,
+                            &state->out);
+        if (ret == ERR_SRV_DUPLICATES) {
             /* Since no new server is returned, state->meta->next is NULL.
              * We return last tried server if possible which is server
              * from previous resolution of SRV record, and first server
@@ -1426,28 +2515,11 @@ resolve_srv_done(struct tevent_req *subreq)
 
             state->out = state->service->server_list;
             goto done;
-        }
-
-        /* At least one new server was inserted.
-         * We will return the first new server. */
-        if (state->meta->next == NULL) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                 "BUG: state->meta->next is NULL\n");
-            ret = ERR_INTERNAL;
+        } else if (ret != EOK) {
             goto done;
         }
 
-        state->out = state->meta->next;
-
-        /* And remove meta server from the server list. It will be
-         * inserted again during srv collapse. */
-        DLIST_REMOVE(state->service->server_list, state->meta);
-        if (state->service->last_tried_server == state->meta) {
-            state->service->last_tried_server = state->out;
-        }
-
-        set_srv_data_status(state->meta->srv_data, SRV_RESOLVED);
-        ret = EOK;
+        fo_srv_cache_store(state->fo_ctx);
         break;
     case ERR_SRV_NOT_FOUND:
         /* fall through */
@@ -1551,6 +2623,79 @@ fo_set_port_status(struct fo_server *server, enum port_status status)
     }
 }
 
+void fo_set_server_connecting(struct fo_server *server, bool connecting)
+{
+    if (server == NULL) {
+        return;
+    }
+
+    if (connecting) {
+        server->connecting++;
+    } else if (server->connecting > 0) {
+        server->connecting--;
+    }
+}
+
+void fo_set_server_latency(struct fo_server *server,
+                           enum fo_latency_type type,
+                           uint64_t usecs)
+{
+    uint64_t *avg;
+
+    if (server == NULL) {
+        return;
+    }
+
+    switch (type) {
+    case FO_LATENCY_CONNECT:
+        avg = &server->connect_usecs;
+        break;
+    case FO_LATENCY_OPERATION:
+        avg = &server->op_usecs;
+        if (server->service != NULL) {
+            server->service->ctx->num_ops++;
+            server->service->ctx->ops_usecs += usecs;
+        }
+        break;
+    default:
+        return;
+    }
+
+    /* keep zero for "unknown" */
+    usecs = MAX(usecs, 1);
+
+    if (*avg == 0) {
+        *avg = usecs;
+    } else {
+        *avg = (*avg * 3 + usecs) / 4;
+    }
+}
+
+uint64_t fo_get_server_latency(struct fo_server *server,
+                               enum fo_latency_type type)
+{
+    if (server == NULL) {
+        return 0;
+    }
+
+    switch (type) {
+    case FO_LATENCY_CONNECT:
+        return server->connect_usecs;
+    case FO_LATENCY_OPERATION:
+        return server->op_usecs;
+    }
+
+    return 0;
+}
+
+void fo_get_operation_stats(struct fo_ctx *ctx,
+                            uint64_t *_ops,
+                            uint64_t *_usecs)
+{
+    *_ops = ctx->num_ops;
+    *_usecs = ctx->ops_usecs;
+}
+
 struct fo_server *fo_get_active_server(struct fo_service *service)
 {
     return service->active_server;
@@ -1759,7 +2904,8 @@ const char **fo_svc_server_list(TALLOC_CTX *mem_ctx,
 bool fo_set_srv_lookup_plugin(struct fo_ctx *ctx,
                               fo_srv_lookup_plugin_send_t send_fn,
                               fo_srv_lookup_plugin_recv_t recv_fn,
-                              void *pvt)
+                              void *pvt,
+                              bool persistent)
 {
     if (ctx == NULL || send_fn == NULL || recv_fn == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Invalid parameters\n");
@@ -1774,6 +2920,7 @@ bool fo_set_srv_lookup_plugin(struct fo_ctx *ctx,
     ctx->srv_send_fn = send_fn;
     ctx->srv_recv_fn = recv_fn;
     ctx->srv_pvt = talloc_steal(ctx, pvt);
+    ctx->srv_persistent = persistent;
 
     return true;
 }
@@ -82,6 +82,14 @@ struct fo_options {
     time_t retry_timeout;
     int service_resolv_timeout;
     enum restrict_family family_order;
+    /* switch to a clearly faster working server of the same priority */
+    bool prefer_fastest;
+    /* serve expired DNS results for up to this many seconds while they are
+     * refreshed in the background, zero to resolve them again right away */
+    time_t dns_stale_timeout;
+    /* file keeping the resolved SRV records across restarts, or NULL;
+     * not used with a persistent SRV lookup plugin */
+    const char *srv_cache_path;
 };
 
 /*
@@ -146,6 +154,16 @@ struct tevent_req *fo_resolve_service_send(TALLOC_CTX *mem_ctx,
                                            struct fo_ctx *ctx,
                                            struct fo_service *service);
 
+/*
+ * Like fo_resolve_service_send(), but servers with a connection attempt in
+ * progress are passed over. Used to try several servers at the same time.
+ */
+struct tevent_req *fo_resolve_other_service_send(TALLOC_CTX *mem_ctx,
+                                                 struct tevent_context *ev,
+                                                 struct resolv_ctx *resolv,
+                                                 struct fo_ctx *ctx,
+                                                 struct fo_service *service);
+
 int fo_resolve_service_recv(struct tevent_req *req,
                             TALLOC_CTX *ref_ctx,
                             struct fo_server **server);
@@ -179,6 +197,39 @@ void fo_set_server_status(struct fo_server *server,
 void fo_set_port_status(struct fo_server *server,
                         enum port_status status);
 
+/*
+ * Mark the start (connecting is true) or the end of a connection attempt
+ * to 'server'. Calls must be paired.
+ */
+void fo_set_server_connecting(struct fo_server *server, bool connecting);
+
+enum fo_latency_type {
+    FO_LATENCY_CONNECT,
+    FO_LATENCY_OPERATION,
+};
+
+/*
+ * Report how long connecting to 'server', or waiting for the first reply
+ * to an operation, took. A moving average is kept for each type. With
+ * prefer_fastest set, the active server is given up for another working
+ * server of the same priority whose average is clearly lower.
+ */
+void fo_set_server_latency(struct fo_server *server,
+                           enum fo_latency_type type,
+                           uint64_t usecs);
+
+/* Returns the moving average in microseconds, zero if nothing was reported */
+uint64_t fo_get_server_latency(struct fo_server *server,
+                               enum fo_latency_type type);
+
+/*
+ * Number of operations reported with FO_LATENCY_OPERATION for all servers
+ * of 'ctx' and the sum of their latencies in microseconds.
+ */
+void fo_get_operation_stats(struct fo_ctx *ctx,
+                            uint64_t *_ops,
+                            uint64_t *_usecs);
+
 /*
  * Instruct fail-over to try next server on the next connect attempt.
  * Should be used after connection to service was unexpectedly dropped
@@ -227,10 +278,14 @@ size_t fo_server_count(struct fo_server *server);
 
 /*
  * pvt will be talloc_stealed to ctx
+ *
+ * If persistent is true, the plugin keeps its results across restarts by
+ * itself and they are not stored in srv_cache_path.
  */
 bool fo_set_srv_lookup_plugin(struct fo_ctx *ctx,
                               fo_srv_lookup_plugin_send_t send_fn,
                               fo_srv_lookup_plugin_recv_t recv_fn,
-                              void *pvt);
+                              void *pvt,
+                              bool persistent);
 
 #endif /* !__FAIL_OVER_H__ */
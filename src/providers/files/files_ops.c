@@ -19,6 +19,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <dlfcn.h>
+#include <stdlib.h>
 
 #include "config.h"
 
@@ -40,6 +41,11 @@
 #define SF_UPDATE_GROUP     1<<1
 #define SF_UPDATE_BOTH      (SF_UPDATE_PASSWD | SF_UPDATE_GROUP)
 
+/* The files are updated once they were not written to for SF_QUIET_MSEC,
+ * but at the latest SF_MAX_WAIT_MSEC after the first change */
+#define SF_QUIET_MSEC       100
+#define SF_MAX_WAIT_MSEC    1000
+
 struct files_ctx {
     struct files_ops_ctx *ops;
 };
@@ -245,108 +251,6 @@ done:
     return ret;
 }
 
-static errno_t delete_all_users(struct sss_domain_info *dom)
-{
-    TALLOC_CTX *tmp_ctx;
-    struct ldb_dn *base_dn;
-    errno_t ret;
-
-    tmp_ctx = talloc_new(NULL);
-    if (tmp_ctx == NULL) {
-        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
-        return ENOMEM;
-    }
-
-    base_dn = sysdb_user_base_dn(tmp_ctx, dom);
-    if (base_dn == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Out of memory!\n");
-        ret = ENOMEM;
-        goto done;
-    }
-
-    ret = sysdb_delete_recursive(dom->sysdb, base_dn, true);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "Unable to delete users subtree [%d]: %s\n",
-              ret, sss_strerror(ret));
-        goto done;
-    }
-
-    ret = EOK;
-
-done:
-    talloc_free(tmp_ctx);
-
-    return ret;
-}
-
-static errno_t save_file_user(struct files_id_ctx *id_ctx,
-                              struct passwd *pw)
-{
-    errno_t ret;
-    char *fqname;
-    TALLOC_CTX *tmp_ctx = NULL;
-    const char *shell;
-    const char *gecos;
-    struct sysdb_attrs *attrs = NULL;
-
-    if (strcmp(pw->pw_name, "root") == 0
-            || pw->pw_uid == 0
-            || pw->pw_gid == 0) {
-        DEBUG(SSSDBG_TRACE_FUNC, "Skipping %s\n", pw->pw_name);
-        return EOK;
-    }
-
-    tmp_ctx = talloc_new(NULL);
-    if (tmp_ctx == NULL) {
-        return ENOMEM;
-    }
-
-    fqname = sss_create_internal_fqname(tmp_ctx, pw->pw_name,
-                                        id_ctx->domain->name);
-    if (fqname == NULL) {
-        ret = ENOMEM;
-        goto done;
-    }
-
-    attrs = sysdb_new_attrs(tmp_ctx);
-    if (attrs == NULL) {
-        ret = ENOMEM;
-        goto done;
-    }
-
-    if (pw->pw_shell && pw->pw_shell[0] != '\0') {
-        shell = pw->pw_shell;
-    } else {
-        shell = NULL;
-    }
-
-    if (pw->pw_gecos && pw->pw_gecos[0] != '\0') {
-        gecos = pw->pw_gecos;
-    } else {
-        gecos = NULL;
-    }
-
-    /* FIXME - optimize later */
-    ret = sysdb_store_user(id_ctx->domain,
-                           fqname,
-                           pw->pw_passwd,
-                           pw->pw_uid,
-                           pw->pw_gid,
-                           gecos,
-                           pw->pw_dir,
-                           shell,
-                           NULL, attrs,
-                           NULL, 0, 0);
-    if (ret != EOK) {
-        goto done;
-    }
-
-    ret = EOK;
-done:
-    talloc_free(tmp_ctx);
-    return ret;
-}
-
 static errno_t refresh_override_attrs(struct files_id_ctx *id_ctx,
                                       enum sysdb_member_type type)
 {
@@ -448,156 +352,661 @@ done:
     return ret;
 }
 
-static errno_t sf_enum_groups(struct files_id_ctx *id_ctx,
-                              const char *group_file);
+/* The files are compared with the cache on each change and only the
+ * differences are written. Past this many changed entries it is cheaper
+ * to reset the memory cache than to invalidate the entries one by one. */
+#define SF_MC_INVALIDATE_MAX 256
+
+/* The memory cache records made stale by a reload */
+struct sf_changes {
+    uint32_t *uids;
+    size_t num_uids;
+    bool all_users;
+
+    uint32_t *gids;
+    size_t num_gids;
+    bool all_groups;
+
+    bool initgroups;
+};
+
+/* An entry of the passwd or group files under its internal name */
+struct sf_entry {
+    char *fqname;
+    /* position in all the files, a later entry replaces an earlier one */
+    size_t idx;
+    /* struct passwd or struct group */
+    void *data;
+};
+
+static void sf_changes_add_id(struct sf_changes *changes,
+                              uint32_t **_ids, size_t *_num_ids, bool *_all,
+                              uint32_t id)
+{
+    uint32_t *ids;
+
+    if (*_all) {
+        return;
+    }
+
+    if (*_num_ids >= SF_MC_INVALIDATE_MAX) {
+        *_all = true;
+        return;
+    }
+
+    ids = talloc_realloc(changes, *_ids, uint32_t, *_num_ids + 1);
+    if (ids == NULL) {
+        /* Resetting the whole memory cache is always correct */
+        *_all = true;
+        return;
+    }
+
+    ids[*_num_ids] = id;
+    *_ids = ids;
+    (*_num_ids)++;
+}
+
+static void sf_changes_add_uid(struct sf_changes *changes, uid_t uid)
+{
+    if (changes == NULL) {
+        return;
+    }
+
+    sf_changes_add_id(changes, &changes->uids, &changes->num_uids,
+                      &changes->all_users, uid);
+}
+
+static void sf_changes_add_gid(struct sf_changes *changes, gid_t gid)
+{
+    if (changes == NULL) {
+        return;
+    }
+
+    sf_changes_add_id(changes, &changes->gids, &changes->num_gids,
+                      &changes->all_groups, gid);
+}
+
+static void sf_changes_add_initgroups(struct sf_changes *changes)
+{
+    if (changes != NULL) {
+        changes->initgroups = true;
+    }
+}
+
+static int sf_entry_cmp(const void *a, const void *b)
+{
+    const struct sf_entry *ea = a;
+    const struct sf_entry *eb = b;
+    int ret;
+
+    ret = strcmp(ea->fqname, eb->fqname);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return ea->idx < eb->idx ? -1 : (ea->idx > eb->idx ? 1 : 0);
+}
+
+/* Sorts the entries by name and drops the ones replaced by a later entry
+ * of the same name, returns the number of entries left */
+static size_t sf_entries_sort(struct sf_entry *entries, size_t count)
+{
+    size_t n = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    qsort(entries, count, sizeof(struct sf_entry), sf_entry_cmp);
+
+    for (size_t i = 0; i < count; i++) {
+        if (i + 1 < count
+                && strcmp(entries[i].fqname, entries[i + 1].fqname) == 0) {
+            continue;
+        }
+        entries[n] = entries[i];
+        n++;
+    }
+
+    return n;
+}
+
+static errno_t sf_entries_add(TALLOC_CTX *mem_ctx,
+                              struct sf_entry **_entries,
+                              size_t *_count,
+                              char *fqname,
+                              void *data)
+{
+    struct sf_entry *entries = *_entries;
+    size_t count = *_count;
+
+    if (count % FILES_REALLOC_CHUNK == 0) {
+        entries = talloc_realloc(mem_ctx, entries, struct sf_entry,
+                                 count + FILES_REALLOC_CHUNK);
+        if (entries == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    entries[count].fqname = fqname;
+    entries[count].idx = count;
+    entries[count].data = data;
+
+    *_entries = entries;
+    *_count = count + 1;
+    return EOK;
+}
+
+static const char *sf_msg_name(struct ldb_message *msg)
+{
+    return ldb_msg_find_attr_as_string(msg, SYSDB_NAME, "");
+}
+
+static int sf_msg_cmp(const void *a, const void *b)
+{
+    return strcmp(sf_msg_name(*(struct ldb_message *const *)a),
+                  sf_msg_name(*(struct ldb_message *const *)b));
+}
 
-errno_t sf_enum_users(struct files_id_ctx *id_ctx,
-                      const char *passwd_file)
+/* Returns the cached users or groups sorted by name */
+static errno_t sf_get_cached_entries(TALLOC_CTX *mem_ctx,
+                                     struct sss_domain_info *dom,
+                                     enum sysdb_member_type type,
+                                     const char **attrs,
+                                     struct ldb_message ***_msgs,
+                                     size_t *_count)
 {
+    struct ldb_message **msgs = NULL;
+    size_t count = 0;
     errno_t ret;
-    TALLOC_CTX *tmp_ctx = NULL;
-    struct passwd **users = NULL;
 
-    tmp_ctx = talloc_new(NULL);
-    if (tmp_ctx == NULL) {
-        return ENOMEM;
+    if (type == SYSDB_MEMBER_USER) {
+        ret = sysdb_search_users(mem_ctx, dom, "", attrs, &count, &msgs);
+    } else {
+        ret = sysdb_search_groups(mem_ctx, dom, "", attrs, &count, &msgs);
+    }
+    if (ret == ENOENT) {
+        count = 0;
+        msgs = NULL;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Cannot read the cached %s [%d]: %s\n",
+              type == SYSDB_MEMBER_USER ? "users" : "groups",
+              ret, sss_strerror(ret));
+        return ret;
     }
 
-    ret = enum_files_users(tmp_ctx, passwd_file, &users);
-    if (ret != EOK) {
-        goto done;
+    if (count > 0) {
+        qsort(msgs, count, sizeof(struct ldb_message *), sf_msg_cmp);
     }
 
-    for (size_t i = 0; users[i]; i++) {
-        ret = save_file_user(id_ctx, users[i]);
+    *_msgs = msgs;
+    *_count = count;
+    return EOK;
+}
+
+/* Compares the entries read from the files with the cached ones. Both lists
+ * are sorted by name, the callbacks are called for entries that are only in
+ * the files (msg == NULL), only in the cache (entry == NULL) or in both. */
+typedef errno_t (*sf_diff_fn)(struct sf_entry *entry,
+                              struct ldb_message *msg,
+                              void *pvt);
+
+static errno_t sf_diff(struct sf_entry *entries, size_t num_entries,
+                       struct ldb_message **msgs, size_t num_msgs,
+                       sf_diff_fn fn, void *pvt)
+{
+    size_t i = 0;
+    size_t j = 0;
+    errno_t ret;
+    int cmp;
+
+    while (i < num_entries || j < num_msgs) {
+        if (j == num_msgs) {
+            cmp = -1;
+        } else if (i == num_entries) {
+            cmp = 1;
+        } else {
+            cmp = strcmp(entries[i].fqname, sf_msg_name(msgs[j]));
+        }
+
+        if (cmp < 0) {
+            ret = fn(&entries[i], NULL, pvt);
+            i++;
+        } else if (cmp > 0) {
+            ret = fn(NULL, msgs[j], pvt);
+            j++;
+        } else {
+            ret = fn(&entries[i], msgs[j], pvt);
+            i++;
+            j++;
+        }
+
         if (ret != EOK) {
-            DEBUG(SSSDBG_MINOR_FAILURE,
-                  "Cannot save user %s: [%d]: %s\n",
-                  users[i]->pw_name, ret, sss_strerror(ret));
-            continue;
+            return ret;
         }
     }
 
-    ret = refresh_override_attrs(id_ctx, SYSDB_MEMBER_USER);
+    return EOK;
+}
+
+static errno_t sf_delete_cached(struct sss_domain_info *dom,
+                                struct ldb_message *msg)
+{
+    errno_t ret;
+
+    DEBUG(SSSDBG_TRACE_LIBS, "Removing %s\n", sf_msg_name(msg));
+
+    ret = sysdb_delete_entry(dom->sysdb, msg->dn, true);
     if (ret != EOK) {
-        DEBUG(SSSDBG_MINOR_FAILURE,
-              "Failed to refresh override attributes, "
-              "override values might not be available.\n");
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to delete %s [%d]: %s\n",
+              sf_msg_name(msg), ret, sss_strerror(ret));
     }
 
-    ret = EOK;
-done:
-    talloc_free(tmp_ctx);
     return ret;
 }
 
-static const char **get_cached_user_names(TALLOC_CTX *mem_ctx,
-                                          struct sss_domain_info *dom)
+/* Empty values are not stored in the cache */
+static bool sf_value_changed(const char *value, const char *cached)
+{
+    if (value == NULL || value[0] == '\0') {
+        return cached != NULL;
+    }
+
+    return cached == NULL || strcmp(value, cached) != 0;
+}
+
+static bool skip_file_user(struct passwd *pw)
 {
+    if (strcmp(pw->pw_name, "root") == 0
+            || pw->pw_uid == 0
+            || pw->pw_gid == 0) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Skipping %s\n", pw->pw_name);
+        return true;
+    }
+
+    return false;
+}
+
+static errno_t read_file_users(TALLOC_CTX *mem_ctx,
+                               struct files_id_ctx *id_ctx,
+                               struct sf_entry **_entries,
+                               size_t *_count)
+{
+    struct sf_entry *entries = NULL;
+    struct passwd **users;
+    size_t count = 0;
+    char *fqname;
     errno_t ret;
-    struct ldb_result *res = NULL;
-    const char **user_names = NULL;
-    unsigned c = 0;
 
-    ret = sysdb_enumpwent(mem_ctx, dom, &res);
-    if (ret != EOK) {
-        goto done;
+    for (size_t i = 0; id_ctx->passwd_files[i] != NULL; i++) {
+        ret = enum_files_users(mem_ctx, id_ctx->passwd_files[i], &users);
+        if (ret == ENOENT) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "The file %s does not exist (yet), skipping\n",
+                  id_ctx->passwd_files[i]);
+            continue;
+        } else if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Cannot enumerate users from %s, aborting\n",
+                  id_ctx->passwd_files[i]);
+            return ret;
+        }
+
+        for (size_t j = 0; users[j] != NULL; j++) {
+            if (skip_file_user(users[j])) {
+                continue;
+            }
+
+            fqname = sss_create_internal_fqname(users[j], users[j]->pw_name,
+                                                id_ctx->domain->name);
+            if (fqname == NULL) {
+                return ENOMEM;
+            }
+
+            ret = sf_entries_add(mem_ctx, &entries, &count, fqname, users[j]);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
     }
 
-    user_names = talloc_zero_array(mem_ctx, const char *, res->count + 1);
-    if (user_names == NULL) {
-        goto done;
+    *_count = sf_entries_sort(entries, count);
+    *_entries = entries;
+    return EOK;
+}
+
+static bool file_user_changed(struct passwd *pw, struct ldb_message *msg)
+{
+    return pw->pw_uid != ldb_msg_find_attr_as_uint64(msg, SYSDB_UIDNUM, 0)
+        || pw->pw_gid != ldb_msg_find_attr_as_uint64(msg, SYSDB_GIDNUM, 0)
+        || sf_value_changed(pw->pw_gecos,
+                            ldb_msg_find_attr_as_string(msg, SYSDB_GECOS,
+                                                        NULL))
+        || sf_value_changed(pw->pw_dir,
+                            ldb_msg_find_attr_as_string(msg, SYSDB_HOMEDIR,
+                                                        NULL))
+        || sf_value_changed(pw->pw_shell,
+                            ldb_msg_find_attr_as_string(msg, SYSDB_SHELL,
+                                                        NULL));
+}
+
+static errno_t prepare_file_user(TALLOC_CTX *mem_ctx,
+                                 struct files_id_ctx *id_ctx,
+                                 struct sf_entry *entry,
+                                 struct sysdb_store_user_entry *user)
+{
+    struct passwd *pw = entry->data;
+    size_t ri = 0;
+
+    /* Attributes the user no longer has in the file must be removed from
+     * a cached user */
+    user->remove_attrs = talloc_zero_array(mem_ctx, char *, 3);
+    if (user->remove_attrs == NULL) {
+        return ENOMEM;
     }
 
-    for (unsigned i = 0; i < res->count; i++) {
-        user_names[c] = ldb_msg_find_attr_as_string(res->msgs[i],
-                                                    SYSDB_NAME,
-                                                    NULL);
-        if (user_names[c] == NULL) {
-            continue;
+    user->domain = id_ctx->domain;
+    user->name = entry->fqname;
+    user->pwd = pw->pw_passwd;
+    user->uid = pw->pw_uid;
+    user->gid = pw->pw_gid;
+    user->homedir = pw->pw_dir;
+
+    if (pw->pw_shell && pw->pw_shell[0] != '\0') {
+        user->shell = pw->pw_shell;
+    } else {
+        user->shell = NULL;
+        user->remove_attrs[ri++] = discard_const(SYSDB_SHELL);
+    }
+
+    if (pw->pw_gecos && pw->pw_gecos[0] != '\0') {
+        user->gecos = pw->pw_gecos;
+    } else {
+        user->gecos = NULL;
+        user->remove_attrs[ri++] = discard_const(SYSDB_GECOS);
+    }
+
+    return EOK;
+}
+
+struct sf_users_diff {
+    struct files_id_ctx *id_ctx;
+    struct sf_changes *changes;
+
+    struct sysdb_store_user_entry *store;
+    size_t num_store;
+
+    size_t added;
+    size_t modified;
+    size_t deleted;
+};
+
+static errno_t sf_users_diff_cb(struct sf_entry *entry,
+                                struct ldb_message *msg,
+                                void *pvt)
+{
+    struct sf_users_diff *diff = pvt;
+    struct passwd *pw;
+    uid_t cached_uid;
+    errno_t ret;
+
+    if (entry == NULL) {
+        cached_uid = ldb_msg_find_attr_as_uint64(msg, SYSDB_UIDNUM, 0);
+        ret = sf_delete_cached(diff->id_ctx->domain, msg);
+        if (ret != EOK) {
+            return ret;
         }
-        c++;
+
+        sf_changes_add_uid(diff->changes, cached_uid);
+        sf_changes_add_initgroups(diff->changes);
+        diff->deleted++;
+        return EOK;
     }
 
-done:
-    /* Don't free res and keep it around to avoid duplicating the names */
-    return user_names;
+    pw = entry->data;
+    if (msg != NULL) {
+        if (!file_user_changed(pw, msg)) {
+            return EOK;
+        }
+
+        cached_uid = ldb_msg_find_attr_as_uint64(msg, SYSDB_UIDNUM, 0);
+        sf_changes_add_uid(diff->changes, cached_uid);
+        if (cached_uid != pw->pw_uid) {
+            sf_changes_add_uid(diff->changes, pw->pw_uid);
+        }
+        if (pw->pw_gid != ldb_msg_find_attr_as_uint64(msg, SYSDB_GIDNUM, 0)) {
+            sf_changes_add_initgroups(diff->changes);
+        }
+        diff->modified++;
+    } else {
+        diff->added++;
+    }
+
+    ret = prepare_file_user(diff->store, diff->id_ctx, entry,
+                            &diff->store[diff->num_store]);
+    if (ret != EOK) {
+        return ret;
+    }
+    diff->num_store++;
+
+    return EOK;
 }
 
-static errno_t delete_all_groups(struct sss_domain_info *dom)
+static errno_t sf_update_users(struct files_id_ctx *id_ctx,
+                               struct sf_changes *changes)
 {
+    const char *attrs[] = { SYSDB_NAME, SYSDB_UIDNUM, SYSDB_GIDNUM,
+                            SYSDB_GECOS, SYSDB_HOMEDIR, SYSDB_SHELL,
+                            NULL };
+    struct sf_users_diff diff = { 0 };
+    struct sf_entry *entries = NULL;
+    struct ldb_message **msgs = NULL;
+    size_t num_entries = 0;
+    size_t num_msgs = 0;
     TALLOC_CTX *tmp_ctx;
-    struct ldb_dn *base_dn;
     errno_t ret;
 
     tmp_ctx = talloc_new(NULL);
     if (tmp_ctx == NULL) {
-        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
         return ENOMEM;
     }
 
-    base_dn = sysdb_group_base_dn(tmp_ctx, dom);
-    if (base_dn == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Out of memory!\n");
+    ret = read_file_users(tmp_ctx, id_ctx, &entries, &num_entries);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sf_get_cached_entries(tmp_ctx, id_ctx->domain, SYSDB_MEMBER_USER,
+                                attrs, &msgs, &num_msgs);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    diff.id_ctx = id_ctx;
+    diff.changes = changes;
+    diff.store = talloc_zero_array(tmp_ctx, struct sysdb_store_user_entry,
+                                   num_entries + 1);
+    if (diff.store == NULL) {
         ret = ENOMEM;
         goto done;
     }
 
-    ret = sysdb_delete_recursive(dom->sysdb, base_dn, true);
+    ret = sf_diff(entries, num_entries, msgs, num_msgs,
+                  sf_users_diff_cb, &diff);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "Unable to delete groups subtree [%d]: %s\n",
-              ret, sss_strerror(ret));
         goto done;
     }
 
-    ret = EOK;
+    DEBUG(SSSDBG_TRACE_FUNC, "Users: %zu added, %zu modified, %zu deleted\n",
+          diff.added, diff.modified, diff.deleted);
+
+    if (diff.num_store == 0) {
+        ret = EOK;
+        goto done;
+    }
+
+    ret = sysdb_store_users(id_ctx->domain->sysdb, diff.store,
+                            diff.num_store, 0);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    for (size_t i = 0; i < diff.num_store; i++) {
+        if (diff.store[i].ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot save user %s: [%d]: %s\n",
+                  diff.store[i].name, diff.store[i].ret,
+                  sss_strerror(diff.store[i].ret));
+        }
+    }
+
+    ret = refresh_override_attrs(id_ctx, SYSDB_MEMBER_USER);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Failed to refresh override attributes, "
+              "override values might not be available.\n");
+    }
 
+    ret = EOK;
 done:
     talloc_free(tmp_ctx);
-
     return ret;
 }
 
-static errno_t save_file_group(struct files_id_ctx *id_ctx,
-                               struct group *grp,
-                               const char **cached_users)
+static int sf_name_cmp(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/* Returns the names of the cached users sorted so that group members can
+ * be looked up quickly */
+static errno_t get_cached_user_names(TALLOC_CTX *mem_ctx,
+                                     struct sss_domain_info *dom,
+                                     const char ***_user_names,
+                                     size_t *_count)
 {
+    const char *attrs[] = { SYSDB_NAME, NULL };
     errno_t ret;
-    char *fqname;
-    struct sysdb_attrs *attrs = NULL;
-    TALLOC_CTX *tmp_ctx = NULL;
-    char **fq_gr_files_mem;
-    const char **fq_gr_mem;
-    unsigned mi = 0;
+    struct ldb_message **msgs = NULL;
+    const char **user_names = NULL;
+    size_t count = 0;
+    size_t c = 0;
+
+    ret = sysdb_search_users(mem_ctx, dom, "", attrs, &count, &msgs);
+    if (ret == ENOENT) {
+        count = 0;
+    } else if (ret != EOK) {
+        return ret;
+    }
+
+    user_names = talloc_zero_array(mem_ctx, const char *, count + 1);
+    if (user_names == NULL) {
+        return ENOMEM;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        user_names[c] = ldb_msg_find_attr_as_string(msgs[i],
+                                                    SYSDB_NAME,
+                                                    NULL);
+        if (user_names[c] == NULL) {
+            continue;
+        }
+        c++;
+    }
+
+    if (c > 0) {
+        qsort(user_names, c, sizeof(const char *), sf_name_cmp);
+    }
+
+    /* Don't free msgs and keep them around to avoid duplicating the names */
+    *_user_names = user_names;
+    *_count = c;
+    return EOK;
+}
 
+static bool skip_file_group(struct group *grp)
+{
     if (strcmp(grp->gr_name, "root") == 0
             || grp->gr_gid == 0) {
         DEBUG(SSSDBG_TRACE_FUNC, "Skipping %s\n", grp->gr_name);
-        return EOK;
+        return true;
     }
 
-    tmp_ctx = talloc_new(NULL);
-    if (tmp_ctx == NULL) {
-        return ENOMEM;
-    }
+    return false;
+}
 
-    fqname = sss_create_internal_fqname(tmp_ctx, grp->gr_name,
-                                        id_ctx->domain->name);
-    if (fqname == NULL) {
-        ret = ENOMEM;
-        goto done;
+static errno_t read_file_groups(TALLOC_CTX *mem_ctx,
+                                struct files_id_ctx *id_ctx,
+                                struct sf_entry **_entries,
+                                size_t *_count)
+{
+    struct sf_entry *entries = NULL;
+    struct group **groups;
+    size_t count = 0;
+    char *fqname;
+    errno_t ret;
+
+    for (size_t i = 0; id_ctx->group_files[i] != NULL; i++) {
+        ret = enum_files_groups(mem_ctx, id_ctx->group_files[i], &groups);
+        if (ret == ENOENT) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "The file %s does not exist (yet), skipping\n",
+                  id_ctx->group_files[i]);
+            continue;
+        } else if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Cannot enumerate groups from %s, aborting\n",
+                  id_ctx->group_files[i]);
+            return ret;
+        }
+
+        for (size_t j = 0; groups[j] != NULL; j++) {
+            if (skip_file_group(groups[j])) {
+                continue;
+            }
+
+            fqname = sss_create_internal_fqname(groups[j], groups[j]->gr_name,
+                                                id_ctx->domain->name);
+            if (fqname == NULL) {
+                return ENOMEM;
+            }
 
+            ret = sf_entries_add(mem_ctx, &entries, &count, fqname,
+                                 groups[j]);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
     }
 
-    attrs = sysdb_new_attrs(tmp_ctx);
+    *_count = sf_entries_sort(entries, count);
+    *_entries = entries;
+    return EOK;
+}
+
+/* Builds the attributes a group is stored with, its members are linked
+ * to the cached users or kept as ghosts */
+static errno_t file_group_attrs(TALLOC_CTX *mem_ctx,
+                                struct files_id_ctx *id_ctx,
+                                struct group *grp,
+                                const char **cached_users,
+                                size_t num_cached_users,
+                                struct sysdb_attrs **_attrs)
+{
+    errno_t ret;
+    struct sysdb_attrs *attrs = NULL;
+    char **fq_gr_files_mem;
+    const char **fq_gr_mem;
+    unsigned mi = 0;
+
+    attrs = sysdb_new_attrs(mem_ctx);
     if (attrs == NULL) {
-        ret = ENOMEM;
-        goto done;
+        return ENOMEM;
     }
 
     if (grp->gr_mem && grp->gr_mem[0]) {
         fq_gr_files_mem = sss_create_internal_fqname_list(
-                                            tmp_ctx,
+                                            attrs,
                                             (const char *const*) grp->gr_mem,
                                             id_ctx->domain->name);
         if (fq_gr_files_mem == NULL) {
@@ -605,7 +1014,7 @@ static errno_t save_file_group(struct files_id_ctx *id_ctx,
             goto done;
         }
 
-        fq_gr_mem = talloc_zero_array(tmp_ctx, const char *,
+        fq_gr_mem = talloc_zero_array(attrs, const char *,
                                       talloc_array_length(fq_gr_files_mem));
         if (fq_gr_mem == NULL) {
             ret = ENOMEM;
@@ -613,9 +1022,10 @@ static errno_t save_file_group(struct files_id_ctx *id_ctx,
         }
 
         for (unsigned i=0; fq_gr_files_mem[i] != NULL; i++) {
-            if (string_in_list(fq_gr_files_mem[i],
-                               discard_const(cached_users),
-                               true)) {
+            if (num_cached_users > 0
+                    && bsearch(&fq_gr_files_mem[i], cached_users,
+                               num_cached_users, sizeof(const char *),
+                               sf_name_cmp) != NULL) {
                 fq_gr_mem[mi] = fq_gr_files_mem[i];
                 mi++;
 
@@ -629,7 +1039,7 @@ static errno_t save_file_group(struct files_id_ctx *id_ctx,
                 if (ret != EOK) {
                     DEBUG(SSSDBG_MINOR_FAILURE,
                           "Cannot add ghost %s for group %s\n",
-                          fq_gr_files_mem[i], fqname);
+                          fq_gr_files_mem[i], grp->gr_name);
                     continue;
                 }
 
@@ -651,56 +1061,228 @@ static errno_t save_file_group(struct files_id_ctx *id_ctx,
 
     }
 
-    ret = sysdb_store_group(id_ctx->domain, fqname, grp->gr_gid,
-                            attrs, 0, 0);
-    if (ret) {
-        DEBUG(SSSDBG_OP_FAILURE, "Could not add group to cache\n");
-        goto done;
+    *_attrs = attrs;
+    ret = EOK;
+done:
+    if (ret != EOK) {
+        talloc_free(attrs);
+    }
+    return ret;
+}
+
+static int sf_value_cmp(const void *a, const void *b)
+{
+    return strcasecmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/* Whether an attribute has the same values in the group read from the file
+ * and in the cached group, in any order */
+static bool sf_values_equal(struct ldb_message_element *a,
+                            struct ldb_message_element *b)
+{
+    unsigned int na = a != NULL ? a->num_values : 0;
+    unsigned int nb = b != NULL ? b->num_values : 0;
+    const char **va;
+    const char **vb;
+    bool equal = true;
+
+    if (na != nb) {
+        return false;
+    }
+
+    if (na == 0) {
+        return true;
+    }
+
+    va = talloc_array(NULL, const char *, na);
+    vb = talloc_array(NULL, const char *, nb);
+    if (va == NULL || vb == NULL) {
+        /* rewriting the group is always correct */
+        talloc_free(va);
+        talloc_free(vb);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < na; i++) {
+        va[i] = (const char *)a->values[i].data;
+        vb[i] = (const char *)b->values[i].data;
+    }
+
+    qsort(va, na, sizeof(const char *), sf_value_cmp);
+    qsort(vb, nb, sizeof(const char *), sf_value_cmp);
+
+    for (unsigned int i = 0; i < na; i++) {
+        if (strcasecmp(va[i], vb[i]) != 0) {
+            equal = false;
+            break;
+        }
+    }
+
+    talloc_free(va);
+    talloc_free(vb);
+    return equal;
+}
+
+static bool file_group_changed(struct group *grp,
+                               struct sysdb_attrs *attrs,
+                               struct ldb_message *msg)
+{
+    struct ldb_message_element *el;
+    errno_t ret;
+
+    if (grp->gr_gid != ldb_msg_find_attr_as_uint64(msg, SYSDB_GIDNUM, 0)) {
+        return true;
+    }
+
+    ret = sysdb_attrs_get_el_ext(attrs, SYSDB_MEMBER, false, &el);
+    if (!sf_values_equal(ret == EOK ? el : NULL,
+                         ldb_msg_find_element(msg, SYSDB_MEMBER))) {
+        return true;
+    }
+
+    ret = sysdb_attrs_get_el_ext(attrs, SYSDB_GHOST, false, &el);
+    if (!sf_values_equal(ret == EOK ? el : NULL,
+                         ldb_msg_find_element(msg, SYSDB_GHOST))) {
+        return true;
+    }
+
+    return false;
+}
+
+struct sf_groups_diff {
+    struct files_id_ctx *id_ctx;
+    struct sf_changes *changes;
+
+    const char **cached_users;
+    size_t num_cached_users;
+
+    size_t added;
+    size_t modified;
+    size_t deleted;
+};
+
+static errno_t sf_groups_diff_cb(struct sf_entry *entry,
+                                 struct ldb_message *msg,
+                                 void *pvt)
+{
+    struct sf_groups_diff *diff = pvt;
+    struct sss_domain_info *dom = diff->id_ctx->domain;
+    struct sysdb_attrs *attrs = NULL;
+    struct group *grp;
+    gid_t cached_gid = 0;
+    errno_t ret;
+
+    if (msg != NULL) {
+        cached_gid = ldb_msg_find_attr_as_uint64(msg, SYSDB_GIDNUM, 0);
+    }
+
+    if (entry == NULL) {
+        ret = sf_delete_cached(dom, msg);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        sf_changes_add_gid(diff->changes, cached_gid);
+        sf_changes_add_initgroups(diff->changes);
+        diff->deleted++;
+        return EOK;
+    }
+
+    grp = entry->data;
+    ret = file_group_attrs(NULL, diff->id_ctx, grp, diff->cached_users,
+                           diff->num_cached_users, &attrs);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (msg != NULL) {
+        if (!file_group_changed(grp, attrs, msg)) {
+            ret = EOK;
+            goto done;
+        }
+
+        /* The group is stored again from scratch so that the members that
+         * were removed from the file are removed from the cache as well */
+        ret = sf_delete_cached(dom, msg);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        sf_changes_add_gid(diff->changes, cached_gid);
+        if (cached_gid != grp->gr_gid) {
+            sf_changes_add_gid(diff->changes, grp->gr_gid);
+        }
+        diff->modified++;
+    } else {
+        diff->added++;
+    }
+    sf_changes_add_initgroups(diff->changes);
+
+    ret = sysdb_store_group(dom, entry->fqname, grp->gr_gid, attrs, 0, 0);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot save group %s\n", grp->gr_name);
     }
 
     ret = EOK;
 done:
-    talloc_free(tmp_ctx);
+    talloc_free(attrs);
     return ret;
 }
 
-static errno_t sf_enum_groups(struct files_id_ctx *id_ctx,
-                              const char *group_file)
+static errno_t sf_update_groups(struct files_id_ctx *id_ctx,
+                                struct sf_changes *changes)
 {
+    const char *attrs[] = { SYSDB_NAME, SYSDB_GIDNUM, SYSDB_MEMBER,
+                            SYSDB_GHOST, NULL };
+    struct sf_groups_diff diff = { 0 };
+    struct sf_entry *entries = NULL;
+    struct ldb_message **msgs = NULL;
+    size_t num_entries = 0;
+    size_t num_msgs = 0;
+    TALLOC_CTX *tmp_ctx;
     errno_t ret;
-    TALLOC_CTX *tmp_ctx = NULL;
-    struct group **groups = NULL;
-    const char **cached_users = NULL;
 
     tmp_ctx = talloc_new(NULL);
     if (tmp_ctx == NULL) {
         return ENOMEM;
     }
 
-    ret = enum_files_groups(tmp_ctx, group_file, &groups);
+    ret = read_file_groups(tmp_ctx, id_ctx, &entries, &num_entries);
     if (ret != EOK) {
         goto done;
     }
 
-    cached_users = get_cached_user_names(tmp_ctx, id_ctx->domain);
-    if (cached_users == NULL) {
+    ret = sf_get_cached_entries(tmp_ctx, id_ctx->domain, SYSDB_MEMBER_GROUP,
+                                attrs, &msgs, &num_msgs);
+    if (ret != EOK) {
         goto done;
     }
 
-    for (size_t i = 0; groups[i]; i++) {
-        ret = save_file_group(id_ctx, groups[i], cached_users);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_MINOR_FAILURE,
-                  "Cannot save group %s\n", groups[i]->gr_name);
-            continue;
-        }
+    diff.id_ctx = id_ctx;
+    diff.changes = changes;
+    ret = get_cached_user_names(tmp_ctx, id_ctx->domain,
+                                &diff.cached_users, &diff.num_cached_users);
+    if (ret != EOK) {
+        goto done;
     }
 
-    ret = refresh_override_attrs(id_ctx, SYSDB_MEMBER_GROUP);
+    ret = sf_diff(entries, num_entries, msgs, num_msgs,
+                  sf_groups_diff_cb, &diff);
     if (ret != EOK) {
-        DEBUG(SSSDBG_MINOR_FAILURE,
-              "Failed to refresh override attributes, "
-              "override values might not be available.\n");
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Groups: %zu added, %zu modified, %zu deleted\n",
+          diff.added, diff.modified, diff.deleted);
+
+    if (diff.added + diff.modified > 0) {
+        ret = refresh_override_attrs(id_ctx, SYSDB_MEMBER_GROUP);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Failed to refresh override attributes, "
+                  "override values might not be available.\n");
+        }
     }
 
     ret = EOK;
@@ -710,7 +1292,8 @@ done:
 }
 
 static errno_t sf_enum_files(struct files_id_ctx *id_ctx,
-                             uint8_t flags)
+                             uint8_t flags,
+                             struct sf_changes *changes)
 {
     errno_t ret;
     errno_t tret;
@@ -723,49 +1306,19 @@ static errno_t sf_enum_files(struct files_id_ctx *id_ctx,
     in_transaction = true;
 
     if (flags & SF_UPDATE_PASSWD) {
-        ret = delete_all_users(id_ctx->domain);
+        ret = sf_update_users(id_ctx, changes);
         if (ret != EOK) {
             goto done;
         }
-
-        /* All users were deleted, therefore we need to enumerate each file again */
-        for (size_t i = 0; id_ctx->passwd_files[i] != NULL; i++) {
-            ret = sf_enum_users(id_ctx, id_ctx->passwd_files[i]);
-            if (ret == ENOENT) {
-                DEBUG(SSSDBG_MINOR_FAILURE,
-                      "The file %s does not exist (yet), skipping\n",
-                      id_ctx->passwd_files[i]);
-                continue;
-            } else if (ret != EOK) {
-                DEBUG(SSSDBG_OP_FAILURE,
-                      "Cannot enumerate users from %s, aborting\n",
-                      id_ctx->passwd_files[i]);
-                goto done;
-            }
-        }
     }
 
+    /* The groups are compared after the users are updated, so that the
+     * members of the groups are linked to the right users */
     if (flags & SF_UPDATE_GROUP) {
-        ret = delete_all_groups(id_ctx->domain);
+        ret = sf_update_groups(id_ctx, changes);
         if (ret != EOK) {
             goto done;
         }
-
-        /* All groups were deleted, therefore we need to enumerate each file again */
-        for (size_t i = 0; id_ctx->group_files[i] != NULL; i++) {
-            ret = sf_enum_groups(id_ctx, id_ctx->group_files[i]);
-            if (ret == ENOENT) {
-                DEBUG(SSSDBG_MINOR_FAILURE,
-                      "The file %s does not exist (yet), skipping\n",
-                      id_ctx->group_files[i]);
-                continue;
-            } else if (ret != EOK) {
-                DEBUG(SSSDBG_OP_FAILURE,
-                      "Cannot enumerate groups from %s, aborting\n",
-                      id_ctx->group_files[i]);
-                goto done;
-            }
-        }
     }
 
     ret = dp_add_sr_attribute(id_ctx->be);
@@ -793,6 +1346,43 @@ done:
     return ret;
 }
 
+/* Tells the NSS responder which memory cache records are stale, without
+ * changes all records of the domain are */
+static void sf_invalidate_memcache(struct files_id_ctx *id_ctx,
+                                   struct sf_changes *changes)
+{
+    struct data_provider *provider = id_ctx->be->provider;
+
+    if (changes == NULL
+            || (changes->all_users && changes->all_groups
+                    && changes->initgroups)) {
+        dp_sbus_invalidate_domain_memcache(provider, id_ctx->domain);
+        return;
+    }
+
+    if (changes->all_users) {
+        dp_sbus_reset_users_memcache(provider);
+    } else {
+        for (size_t i = 0; i < changes->num_uids; i++) {
+            dp_sbus_invalidate_user_memcache(provider, changes->uids[i]);
+        }
+    }
+
+    if (changes->all_groups) {
+        dp_sbus_reset_groups_memcache(provider);
+    } else {
+        for (size_t i = 0; i < changes->num_gids; i++) {
+            dp_sbus_invalidate_group_memcache(provider, changes->gids[i]);
+        }
+    }
+
+    /* The initgroups records are stored by name and can only be reset as
+     * a whole */
+    if (changes->initgroups) {
+        dp_sbus_reset_initgr_memcache(provider);
+    }
+}
+
 static void sf_cb_done(struct files_id_ctx *id_ctx)
 {
     /* Only activate a domain when both callbacks are done */
@@ -803,48 +1393,47 @@ static void sf_cb_done(struct files_id_ctx *id_ctx)
     }
 }
 
-static int sf_passwd_cb(const char *filename, uint32_t flags, void *pvt)
+static bool sf_is_passwd_file(struct files_id_ctx *id_ctx,
+                              const char *filename)
+{
+    for (size_t i = 0; id_ctx->passwd_files[i] != NULL; i++) {
+        if (strcmp(id_ctx->passwd_files[i], filename) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* The first change of a file makes the requests of the responders wait for
+ * the update, which only starts once the files are quiet */
+static int sf_pending_cb(const char *filename, uint32_t flags, void *pvt)
 {
     struct files_id_ctx *id_ctx;
-    errno_t ret;
 
     id_ctx = talloc_get_type(pvt, struct files_id_ctx);
     if (id_ctx == NULL) {
         return EINVAL;
     }
 
-    DEBUG(SSSDBG_TRACE_FUNC, "passwd notification\n");
-
-    id_ctx->updating_passwd = true;
-    dp_sbus_domain_inconsistent(id_ctx->be->provider, id_ctx->domain);
-
-    dp_sbus_reset_users_ncache(id_ctx->be->provider, id_ctx->domain);
-    dp_sbus_reset_users_memcache(id_ctx->be->provider);
-    dp_sbus_reset_initgr_memcache(id_ctx->be->provider);
+    DEBUG(SSSDBG_TRACE_FUNC, "%s changed, update pending\n", filename);
 
-    /* Using SF_UDPATE_BOTH here the case when someone edits /etc/group, adds a group member and
-     * only then edits passwd and adds the user. The reverse is not needed,
-     * because member/memberof links are established when groups are saved.
-     */
-    ret = sf_enum_files(id_ctx, SF_UPDATE_BOTH);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Could not update files: [%d]: %s\n",
-              ret, sss_strerror(ret));
-        goto done;
+    if (sf_is_passwd_file(id_ctx, filename)) {
+        id_ctx->updating_passwd = true;
+    } else {
+        id_ctx->updating_groups = true;
     }
+    dp_sbus_domain_inconsistent(id_ctx->be->provider, id_ctx->domain);
 
-    ret = EOK;
-done:
-    id_ctx->updating_passwd = false;
-    sf_cb_done(id_ctx);
-    files_account_info_finished(id_ctx, BE_REQ_USER, ret);
-    return ret;
+    return EOK;
 }
 
-static int sf_group_cb(const char *filename, uint32_t flags, void *pvt)
+static int sf_files_cb(const char **filenames, uint32_t flags, void *pvt)
 {
     struct files_id_ctx *id_ctx;
+    struct sf_changes *changes;
+    bool passwd_changed = false;
+    bool group_changed = false;
     errno_t ret;
 
     id_ctx = talloc_get_type(pvt, struct files_id_ctx);
@@ -852,28 +1441,66 @@ static int sf_group_cb(const char *filename, uint32_t flags, void *pvt)
         return EINVAL;
     }
 
-    DEBUG(SSSDBG_TRACE_FUNC, "group notification\n");
+    if (filenames == NULL) {
+        passwd_changed = true;
+        group_changed = true;
+    } else {
+        for (size_t i = 0; filenames[i] != NULL; i++) {
+            if (sf_is_passwd_file(id_ctx, filenames[i])) {
+                passwd_changed = true;
+            } else {
+                group_changed = true;
+            }
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "%s%s%s notification\n",
+          passwd_changed ? "passwd" : "",
+          passwd_changed && group_changed ? " and " : "",
+          group_changed ? "group" : "");
 
-    id_ctx->updating_groups = true;
+    id_ctx->updating_passwd = passwd_changed;
+    id_ctx->updating_groups = group_changed;
     dp_sbus_domain_inconsistent(id_ctx->be->provider, id_ctx->domain);
 
-    dp_sbus_reset_groups_ncache(id_ctx->be->provider, id_ctx->domain);
-    dp_sbus_reset_groups_memcache(id_ctx->be->provider);
-    dp_sbus_reset_initgr_memcache(id_ctx->be->provider);
+    if (passwd_changed) {
+        dp_sbus_reset_users_ncache(id_ctx->be->provider, id_ctx->domain);
+    }
+    if (group_changed) {
+        dp_sbus_reset_groups_ncache(id_ctx->be->provider, id_ctx->domain);
+    }
 
-    ret = sf_enum_files(id_ctx, SF_UPDATE_GROUP);
+    /* Without the list of changes the whole memory cache is reset */
+    changes = talloc_zero(NULL, struct sf_changes);
+
+    /* Using SF_UDPATE_BOTH here the case when someone edits /etc/group, adds a group member and
+     * only then edits passwd and adds the user. The reverse is not needed,
+     * because member/memberof links are established when groups are saved.
+     */
+    ret = sf_enum_files(id_ctx,
+                        passwd_changed ? SF_UPDATE_BOTH : SF_UPDATE_GROUP,
+                        changes);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE,
               "Could not update files: [%d]: %s\n",
               ret, sss_strerror(ret));
+        talloc_zfree(changes);
         goto done;
     }
 
     ret = EOK;
 done:
+    sf_invalidate_memcache(id_ctx, changes);
+    talloc_free(changes);
+    id_ctx->updating_passwd = false;
     id_ctx->updating_groups = false;
     sf_cb_done(id_ctx);
-    files_account_info_finished(id_ctx, BE_REQ_GROUP, ret);
+    if (passwd_changed) {
+        files_account_info_finished(id_ctx, BE_REQ_USER, ret);
+    }
+    if (group_changed) {
+        files_account_info_finished(id_ctx, BE_REQ_GROUP, ret);
+    }
     return ret;
 }
 
@@ -886,7 +1513,7 @@ static void startup_enum_files(struct tevent_context *ev,
 
     talloc_zfree(imm);
 
-    ret = sf_enum_files(id_ctx, SF_UPDATE_BOTH);
+    ret = sf_enum_files(id_ctx, SF_UPDATE_BOTH, NULL);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE,
               "Could not update files after startup: [%d]: %s\n",
@@ -894,17 +1521,12 @@ static void startup_enum_files(struct tevent_context *ev,
     }
 }
 
-static struct snotify_ctx *sf_setup_watch(TALLOC_CTX *mem_ctx,
-                                          struct tevent_context *ev,
-                                          const char *filename,
-                                          snotify_cb_fn fn,
-                                          struct files_id_ctx *id_ctx)
+static errno_t sf_setup_watch(struct snotify_group *group,
+                              const char *filename)
 {
-    return snotify_create(mem_ctx, ev, SNOTIFY_WATCH_DIR,
-                          filename, NULL,
-                          IN_DELETE_SELF | IN_CLOSE_WRITE | IN_MOVE_SELF | \
-                          IN_CREATE | IN_MOVED_TO,
-                          fn, id_ctx);
+    return snotify_group_add(group, SNOTIFY_WATCH_DIR, filename,
+                             IN_DELETE_SELF | IN_CLOSE_WRITE | IN_MOVE_SELF | \
+                             IN_CREATE | IN_MOVED_TO);
 }
 
 struct files_ctx *sf_init(TALLOC_CTX *mem_ctx,
@@ -916,17 +1538,30 @@ struct files_ctx *sf_init(TALLOC_CTX *mem_ctx,
     struct files_ctx *fctx;
     struct tevent_immediate *imm;
     int i;
-    struct snotify_ctx *snctx;
+    struct snotify_group *group;
+    struct timeval quiet = { .tv_sec = 0,
+                             .tv_usec = SF_QUIET_MSEC * 1000 };
+    struct timeval max_wait = { .tv_sec = SF_MAX_WAIT_MSEC / 1000,
+                                .tv_usec = SF_MAX_WAIT_MSEC % 1000 * 1000 };
+    errno_t ret;
 
     fctx = talloc(mem_ctx, struct files_ctx);
     if (fctx == NULL) {
         return NULL;
     }
 
+    /* All files share one group, a tool that rewrites both passwd and group
+     * then causes a single update */
+    group = snotify_group_create(fctx, ev, &quiet, &max_wait,
+                                 sf_pending_cb, sf_files_cb, id_ctx);
+    if (group == NULL) {
+        talloc_free(fctx);
+        return NULL;
+    }
+
     for (i = 0; passwd_files[i]; i++) {
-        snctx = sf_setup_watch(fctx, ev, passwd_files[i],
-                               sf_passwd_cb, id_ctx);
-        if (snctx == NULL) {
+        ret = sf_setup_watch(group, passwd_files[i]);
+        if (ret != EOK) {
             DEBUG(SSSDBG_FATAL_FAILURE,
                   "Cannot set watch for passwd file %s\n", passwd_files[i]);
             /* Rather than reporting incomplete or inconsistent information
@@ -938,9 +1573,8 @@ struct files_ctx *sf_init(TALLOC_CTX *mem_ctx,
     }
 
     for (i = 0; group_files[i]; i++) {
-        snctx = sf_setup_watch(fctx, ev, group_files[i],
-                                sf_group_cb, id_ctx);
-        if (snctx == NULL) {
+        ret = sf_setup_watch(group, group_files[i]);
+        if (ret != EOK) {
             DEBUG(SSSDBG_FATAL_FAILURE,
                   "Cannot set watch for group file %s\n", group_files[i]);
             /* Rather than reporting incomplete or inconsistent information
@@ -408,6 +408,7 @@ static void ipa_fetch_hbac_rules_done(struct tevent_req *subreq)
 {
     struct ipa_fetch_hbac_state *state = NULL;
     struct tevent_req *req = NULL;
+    uint64_t fingerprint;
     int dp_error;
     errno_t ret;
     bool found;
@@ -443,6 +444,23 @@ static void ipa_fetch_hbac_rules_done(struct tevent_req *subreq)
         return;
     }
 
+    /* Most refreshes download exactly what is stored already. Rewriting
+     * the cache and compiling the rules again is skipped then. */
+    fingerprint = ipa_common_rules_fingerprint(state->hosts, state->services,
+                                               found ? state->rules : NULL);
+    if (state->access_ctx->rules_fingerprint_valid
+            && state->access_ctx->rules_fingerprint == fingerprint) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "HBAC rules did not change, keeping the stored ones\n");
+        state->access_ctx->last_update = time(NULL);
+        ret = found ? EOK : ENOENT;
+        goto done;
+    }
+    state->access_ctx->rules_fingerprint_valid = false;
+
+    /* The rules are converted and compiled again on the next access */
+    talloc_zfree(state->access_ctx->compiled_rules);
+
     if (found == false) {
         /* No rules were found that apply to this host. */
         ret = ipa_common_purge_rules(state->be_ctx->domain,
@@ -452,6 +470,8 @@ static void ipa_fetch_hbac_rules_done(struct tevent_req *subreq)
             goto done;
         }
 
+        state->access_ctx->rules_fingerprint = fingerprint;
+        state->access_ctx->rules_fingerprint_valid = true;
         ret = ENOENT;
         goto done;
     }
@@ -465,6 +485,8 @@ static void ipa_fetch_hbac_rules_done(struct tevent_req *subreq)
         goto done;
     }
 
+    state->access_ctx->rules_fingerprint = fingerprint;
+    state->access_ctx->rules_fingerprint_valid = true;
     ret = EOK;
 
 done:
@@ -483,17 +505,31 @@ static errno_t ipa_fetch_hbac_recv(struct tevent_req *req)
     return EOK;
 }
 
-errno_t ipa_hbac_evaluate_rules(struct be_ctx *be_ctx,
-                                struct dp_option *ipa_options,
-                                struct pam_data *pd)
+/* The HBAC rules converted from the cache and compiled by libipa_hbac.
+ * Users are resolved from the cache while converting, so the rules are
+ * converted again if the requesting user was cached later. */
+struct ipa_hbac_compiled_rules {
+    time_t created;
+    struct hbac_rule **rules;
+    struct hbac_compiled_rules *compiled;
+};
+
+static int ipa_hbac_compiled_rules_destructor(struct ipa_hbac_compiled_rules *cr)
+{
+    hbac_free_compiled_rules(cr->compiled);
+    return 0;
+}
+
+static errno_t ipa_hbac_compile_rules(TALLOC_CTX *mem_ctx,
+                                      struct hbac_ctx *hbac_ctx,
+                                      struct hbac_eval_req **_eval_req,
+                                      struct ipa_hbac_compiled_rules **_cr)
 {
     TALLOC_CTX *tmp_ctx;
-    struct hbac_ctx hbac_ctx;
-    struct hbac_rule **hbac_rules;
-    struct hbac_eval_req *eval_req;
-    enum hbac_eval_result result;
-    struct hbac_info *info = NULL;
+    struct ipa_hbac_compiled_rules *cr;
     const char **attrs_get_cached_rules;
+    struct hbac_eval_req *eval_req;
+    enum hbac_error_code hret;
     errno_t ret;
 
     tmp_ctx = talloc_new(NULL);
@@ -501,9 +537,12 @@ errno_t ipa_hbac_evaluate_rules(struct be_ctx *be_ctx,
         return ENOMEM;
     }
 
-    hbac_ctx.be_ctx = be_ctx;
-    hbac_ctx.ipa_options = ipa_options;
-    hbac_ctx.pd = pd;
+    cr = talloc_zero(tmp_ctx, struct ipa_hbac_compiled_rules);
+    if (cr == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    cr->created = time(NULL);
 
     /* Get HBAC rules from the sysdb */
     attrs_get_cached_rules = hbac_get_attrs_to_get_cached_rules(tmp_ctx);
@@ -513,29 +552,131 @@ errno_t ipa_hbac_evaluate_rules(struct be_ctx *be_ctx,
         ret = ENOMEM;
         goto done;
     }
-    ret = ipa_common_get_cached_rules(tmp_ctx, be_ctx->domain,
+    ret = ipa_common_get_cached_rules(tmp_ctx, hbac_ctx->be_ctx->domain,
                                       IPA_HBAC_RULE, HBAC_RULES_SUBDIR,
                                       attrs_get_cached_rules,
-                                      &hbac_ctx.rule_count, &hbac_ctx.rules);
+                                      &hbac_ctx->rule_count,
+                                      &hbac_ctx->rules);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Could not retrieve rules from the cache\n");
         goto done;
     }
 
-    ret = hbac_ctx_to_rules(tmp_ctx, &hbac_ctx, &hbac_rules, &eval_req);
-    if (ret == EPERM) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "DENY rules detected. Denying access to all users\n");
-        ret = ERR_ACCESS_DENIED;
+    ret = hbac_ctx_to_rules(cr, hbac_ctx, &cr->rules, &eval_req);
+    if (ret != EOK) {
         goto done;
-    } else if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Could not construct HBAC rules\n");
+    }
+
+    hret = hbac_compile_rules(cr->rules, &cr->compiled);
+    if (hret != HBAC_SUCCESS) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not compile HBAC rules [%s]\n",
+              hbac_error_string(hret));
+        ret = ENOMEM;
+        goto done;
+    }
+    talloc_set_destructor(cr, ipa_hbac_compiled_rules_destructor);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Compiled %zu HBAC rules\n",
+          hbac_ctx->rule_count);
+
+    *_eval_req = talloc_steal(mem_ctx, eval_req);
+    *_cr = talloc_steal(mem_ctx, cr);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Returns true if the user was not in the cache yet when the rules were
+ * compiled. */
+static bool ipa_hbac_user_is_newer(struct be_ctx *be_ctx,
+                                   struct pam_data *pd,
+                                   struct ipa_hbac_compiled_rules *cr)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sss_domain_info *user_dom;
+    struct ldb_message *msg;
+    const char *attrs[] = { SYSDB_CREATE_TIME, NULL };
+    uint64_t create_time;
+    bool newer = true;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return true;
+    }
+
+    user_dom = find_domain_by_name(be_ctx->domain, pd->domain, true);
+    if (user_dom == NULL) {
         goto done;
     }
 
+    ret = sysdb_search_user_by_name(tmp_ctx, user_dom, pd->user, attrs, &msg);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    create_time = ldb_msg_find_attr_as_uint64(msg, SYSDB_CREATE_TIME, 0);
+    newer = (create_time == 0 || create_time >= cr->created);
+
+done:
+    talloc_free(tmp_ctx);
+    return newer;
+}
+
+errno_t ipa_hbac_evaluate_rules(struct be_ctx *be_ctx,
+                                struct ipa_access_ctx *access_ctx,
+                                struct pam_data *pd)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct hbac_ctx hbac_ctx;
+    struct hbac_eval_req *eval_req;
+    enum hbac_eval_result result;
+    struct hbac_info *info = NULL;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    hbac_ctx.be_ctx = be_ctx;
+    hbac_ctx.ipa_options = access_ctx->ipa_options;
+    hbac_ctx.pd = pd;
+    hbac_ctx.rule_count = 0;
+    hbac_ctx.rules = NULL;
+
+    if (access_ctx->compiled_rules != NULL
+            && !ipa_hbac_user_is_newer(be_ctx, pd,
+                                       access_ctx->compiled_rules)) {
+        ret = hbac_ctx_to_eval_request(tmp_ctx, &hbac_ctx, &eval_req);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Could not construct eval request\n");
+            goto done;
+        }
+    } else {
+        talloc_zfree(access_ctx->compiled_rules);
+
+        ret = ipa_hbac_compile_rules(tmp_ctx, &hbac_ctx, &eval_req,
+                                     &access_ctx->compiled_rules);
+        if (ret == EOK) {
+            talloc_steal(access_ctx, access_ctx->compiled_rules);
+        } else if (ret == EPERM) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "DENY rules detected. Denying access to all users\n");
+            ret = ERR_ACCESS_DENIED;
+            goto done;
+        } else {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Could not construct HBAC rules\n");
+            goto done;
+        }
+    }
+
     hbac_enable_debug(hbac_debug_messages);
 
-    result = hbac_evaluate(hbac_rules, eval_req, &info);
+    result = hbac_evaluate_compiled(access_ctx->compiled_rules->compiled,
+                                    eval_req, &info);
     if (result == HBAC_EVAL_ALLOW) {
         DEBUG(SSSDBG_MINOR_FAILURE, "Access granted by HBAC rule [%s]\n",
               info->rule_name);
@@ -681,8 +822,8 @@ static void ipa_pam_access_handler_done(struct tevent_req *subreq)
         goto done;
     }
 
-    ret = ipa_hbac_evaluate_rules(state->be_ctx,
-                                  state->access_ctx->ipa_options, state->pd);
+    ret = ipa_hbac_evaluate_rules(state->be_ctx, state->access_ctx,
+                                  state->pd);
     if (ret == EOK) {
         state->pd->pam_status = PAM_SUCCESS;
     } else if (ret == ERR_ACCESS_DENIED) {
@@ -42,6 +42,14 @@ struct ipa_access_ctx {
     struct sdap_attr_map *hostgroup_map;
     struct sdap_search_base **host_search_bases;
     struct sdap_search_base **hbac_search_bases;
+
+    /* The cached HBAC rules prepared for the evaluation, they are dropped
+     * whenever the refreshed rules differ from the stored ones. */
+    struct ipa_hbac_compiled_rules *compiled_rules;
+
+    /* Fingerprint of the hosts, services and rules stored last */
+    uint64_t rules_fingerprint;
+    bool rules_fingerprint_valid;
 };
 
 struct hbac_ctx {
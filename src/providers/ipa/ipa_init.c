@@ -339,7 +339,8 @@ static errno_t ipa_init_client_mode(struct be_ctx *be_ctx,
         }
 
         be_fo_set_srv_lookup_plugin(be_ctx, ipa_srv_plugin_send,
-                                    ipa_srv_plugin_recv, srv_ctx, "IPA");
+                                    ipa_srv_plugin_recv, srv_ctx, false,
+                                    "IPA");
     } else {
         /* fall back to standard plugin on clients. */
         ret = be_fo_set_dns_srv_lookup_plugin(be_ctx, hostname);
@@ -168,6 +168,17 @@ struct dp_option ipa_def_ldap_opts[] = {
     { "ldap_pwdlockout_dn", DP_OPT_STRING, NULL_STRING, NULL_STRING },
     { "wildcard_limit", DP_OPT_NUMBER, { .number = 1000 }, NULL_NUMBER},
     { "ldap_library_debug_level", DP_OPT_NUMBER, NULL_NUMBER, NULL_NUMBER},
+    { "ldap_connection_pool_size", DP_OPT_NUMBER, { .number = 1 }, NULL_NUMBER },
+    { "ldap_group_member_batch_size", DP_OPT_NUMBER, { .number = 50 }, NULL_NUMBER },
+    { "ldap_sync_mode", DP_OPT_STRING, { "none" }, NULL_STRING },
+    { "ldap_page_size_min", DP_OPT_NUMBER, { .number = 100 }, NULL_NUMBER },
+    { "ldap_page_size_max", DP_OPT_NUMBER, { .number = 0 }, NULL_NUMBER },
+    { "ldap_connection_race_servers", DP_OPT_NUMBER, { .number = 3 }, NULL_NUMBER },
+    { "ldap_connection_race_delay", DP_OPT_NUMBER, { .number = 250 }, NULL_NUMBER },
+    { "ldap_auth_connection_pool_size", DP_OPT_NUMBER, { .number = 0 }, NULL_NUMBER },
+    { "ldap_nested_group_parallel", DP_OPT_NUMBER, { .number = 4 }, NULL_NUMBER },
+    { "ldap_save_chunk_size", DP_OPT_NUMBER, { .number = 500 }, NULL_NUMBER },
+    { "ldap_access_cache_timeout", DP_OPT_NUMBER, { .number = 0 }, NULL_NUMBER },
     DP_OPTION_TERMINATOR
 };
 
@@ -328,6 +339,9 @@ struct dp_option ipa_def_krb5_opts[] = {
     { "krb5_use_kdcinfo", DP_OPT_BOOL, BOOL_TRUE, BOOL_TRUE },
     { "krb5_kdcinfo_lookahead", DP_OPT_STRING, NULL_STRING, NULL_STRING },
     { "krb5_map_user", DP_OPT_STRING, NULL_STRING, NULL_STRING },
+    { "krb5_child_pool_size", DP_OPT_NUMBER, { .number = 0 }, NULL_NUMBER },
+    { "krb5_child_pool_max_requests", DP_OPT_NUMBER, { .number = 100 }, NULL_NUMBER },
+    { "krb5_child_max_concurrent", DP_OPT_NUMBER, { .number = 0 }, NULL_NUMBER },
     DP_OPTION_TERMINATOR
 };
 
@@ -20,8 +20,12 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "shared/murmurhash3.h"
 #include "providers/ipa/ipa_rules_common.h"
 
+#define IPA_FINGERPRINT_SEED_LO 0x5a3c9b17
+#define IPA_FINGERPRINT_SEED_HI 0xc1e5d00b
+
 static errno_t
 ipa_common_save_list(struct sss_domain_info *domain,
                      bool delete_subdir,
@@ -255,6 +259,68 @@ done:
     return ret;
 }
 
+static uint64_t ipa_common_attrs_hash(struct sysdb_attrs *attrs)
+{
+    struct ldb_message_element *el;
+    uint32_t lo = IPA_FINGERPRINT_SEED_LO;
+    uint32_t hi = IPA_FINGERPRINT_SEED_HI;
+    unsigned int j;
+    int i;
+
+    for (i = 0; i < attrs->num; i++) {
+        el = &attrs->a[i];
+        lo = murmurhash3(el->name, strlen(el->name), lo);
+        hi = murmurhash3(el->name, strlen(el->name), hi);
+
+        for (j = 0; j < el->num_values; j++) {
+            lo = murmurhash3((const char *)el->values[j].data,
+                             el->values[j].length, lo);
+            hi = murmurhash3((const char *)el->values[j].data,
+                             el->values[j].length, hi);
+        }
+    }
+
+    return (uint64_t)hi << 32 | lo;
+}
+
+static uint64_t ipa_common_list_hash(size_t count, struct sysdb_attrs **list)
+{
+    uint64_t sum = count;
+    size_t c;
+
+    /* The sum does not depend on the order the server returned the
+     * entries in */
+    for (c = 0; c < count; c++) {
+        sum += ipa_common_attrs_hash(list[c]);
+    }
+
+    return sum;
+}
+
+uint64_t ipa_common_rules_fingerprint(struct ipa_common_entries *hosts,
+                                      struct ipa_common_entries *services,
+                                      struct ipa_common_entries *rules)
+{
+    struct ipa_common_entries *sets[] = { hosts, services, rules };
+    uint64_t fingerprint = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof(sets) / sizeof(sets[0]); i++) {
+        fingerprint *= 0x100000001b3ULL;
+        if (sets[i] == NULL) {
+            continue;
+        }
+
+        fingerprint += ipa_common_list_hash(sets[i]->entry_count,
+                                            sets[i]->entries);
+        fingerprint *= 0x100000001b3ULL;
+        fingerprint += ipa_common_list_hash(sets[i]->group_count,
+                                            sets[i]->groups);
+    }
+
+    return fingerprint;
+}
+
 errno_t ipa_common_save_rules(struct sss_domain_info *domain,
                               struct ipa_common_entries *hosts,
                               struct ipa_common_entries *services,
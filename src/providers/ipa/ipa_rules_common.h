@@ -80,6 +80,12 @@ ipa_common_save_rules(struct sss_domain_info *domain,
                       struct ipa_common_entries *rules,
                       time_t *last_update);
 
+/* Returns a value that changes when any of the downloaded entries does;
+ * NULL sets are allowed */
+uint64_t ipa_common_rules_fingerprint(struct ipa_common_entries *hosts,
+                                      struct ipa_common_entries *services,
+                                      struct ipa_common_entries *rules);
+
 errno_t
 ipa_common_get_hostgroupname(TALLOC_CTX *mem_ctx,
                              struct sysdb_ctx *sysdb,
@@ -1170,6 +1170,24 @@ static const char *ipa_s2n_reqinp2str(TALLOC_CTX *mem_ctx,
     return str;
 }
 
+/* With V2 the requests for the list entries, e.g. the missing members of a
+ * trusted group, are sent without waiting for the reply of the previous
+ * one, up to IPA_S2N_BATCH_SIZE of them on the same connection. The replies
+ * are processed one by one in the order of the list. Only the extended
+ * operations defined by the IPA extdom plugin are used. */
+#define IPA_S2N_BATCH_SIZE 50
+
+struct ipa_s2n_batch_result {
+    errno_t ret;
+    char *retoid;
+    struct berval *retdata;
+};
+
+struct ipa_s2n_batch_item {
+    struct tevent_req *req;
+    size_t idx;
+};
+
 struct ipa_s2n_get_list_state {
     struct tevent_context *ev;
     struct ipa_id_ctx *ipa_ctx;
@@ -1186,12 +1204,26 @@ struct ipa_s2n_get_list_state {
     struct sss_domain_info *obj_domain;
     struct sysdb_attrs *override_attrs;
     struct sysdb_attrs *mapped_attrs;
+
+    /* results of the last batch, for the list entries starting at
+     * batch_start */
+    bool use_batch;
+    struct ipa_s2n_batch_result *batch_results;
+    size_t batch_start;
+    size_t batch_count;
+    size_t batch_requested;
+    size_t batch_pending;
 };
 
 static errno_t ipa_s2n_get_list_step(struct tevent_req *req);
 static void ipa_s2n_get_list_get_override_done(struct tevent_req *subreq);
 static void ipa_s2n_get_list_next(struct tevent_req *subreq);
 static void ipa_s2n_get_list_ipa_next(struct tevent_req *subreq);
+static errno_t ipa_s2n_get_list_batch_send(struct tevent_req *req);
+static void ipa_s2n_get_list_batch_done(struct tevent_req *subreq);
+static void ipa_s2n_get_list_batch_next(struct tevent_context *ev,
+                                        struct tevent_immediate *imm,
+                                        void *pvt);
 static errno_t ipa_s2n_get_list_save_step(struct tevent_req *req);
 
 static struct tevent_req *ipa_s2n_get_list_send(TALLOC_CTX *mem_ctx,
@@ -1238,6 +1270,7 @@ static struct tevent_req *ipa_s2n_get_list_send(TALLOC_CTX *mem_ctx,
     state->attrs = NULL;
     state->override_attrs = NULL;
     state->mapped_attrs = mapped_attrs;
+    state->use_batch = (state->protocol == EXTDOM_V2);
 
     ret = ipa_s2n_get_list_step(req);
     if (ret != EOK) {
@@ -1254,29 +1287,30 @@ done:
     return req;
 }
 
-static errno_t ipa_s2n_get_list_step(struct tevent_req *req)
+/* Sets req_input and obj_domain for the list entry idx, *_ipa_object is
+ * set to true if the object has to be read from the IPA LDAP tree. */
+static errno_t ipa_s2n_get_list_prepare(struct ipa_s2n_get_list_state *state,
+                                        size_t idx,
+                                        bool *_ipa_object)
 {
     int ret;
-    struct ipa_s2n_get_list_state *state = tevent_req_data(req,
-                                               struct ipa_s2n_get_list_state);
-    struct berval *bv_req;
-    struct tevent_req *subreq;
     struct sss_domain_info *parent_domain;
     char *short_name = NULL;
     char *domain_name = NULL;
     uint32_t id;
     char *endptr;
-    struct dp_id_data *ar;
+
+    *_ipa_object = false;
 
     parent_domain = get_domains_head(state->dom);
     switch (state->req_input.type) {
     case REQ_INP_NAME:
 
-        ret = sss_parse_name(state, state->dom->names, state->list[state->list_idx],
+        ret = sss_parse_name(state, state->dom->names, state->list[idx],
                              &domain_name, &short_name);
         if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse name '%s' [%d]: %s\n",
-                                        state->list[state->list_idx],
+                                        state->list[idx],
                                         ret, sss_strerror(ret));
             return ret;
         }
@@ -1296,39 +1330,15 @@ static errno_t ipa_s2n_get_list_step(struct tevent_req *req)
 
         if (strcmp(state->obj_domain->name,
             state->ipa_ctx->sdap_id_ctx->be->domain->name) == 0) {
-            DEBUG(SSSDBG_TRACE_INTERNAL,
-                  "Looking up IPA object [%s] from LDAP.\n",
-                  state->list[state->list_idx]);
-            ret = get_dp_id_data_for_user_name(state,
-                                               state->list[state->list_idx],
-                                               state->obj_domain->name,
-                                               &ar);
-            if (ret != EOK) {
-                DEBUG(SSSDBG_OP_FAILURE,
-                      "Failed to create lookup date for IPA object [%s].\n",
-                      state->list[state->list_idx]);
-                return ret;
-            }
-            ar->entry_type = state->entry_type;
-
-            subreq = ipa_id_get_account_info_send(state, state->ev,
-                                                  state->ipa_ctx, ar);
-            if (subreq == NULL) {
-                DEBUG(SSSDBG_OP_FAILURE,
-                      "ipa_id_get_account_info_send failed.\n");
-                return ENOMEM;
-            }
-            tevent_req_set_callback(subreq, ipa_s2n_get_list_ipa_next, req);
-
-            return EOK;
+            *_ipa_object = true;
         }
 
         break;
     case REQ_INP_ID:
         errno = 0;
-        id = strtouint32(state->list[state->list_idx], &endptr, 10);
+        id = strtouint32(state->list[idx], &endptr, 10);
         if (errno != 0 || *endptr != '\0'
-                || (state->list[state->list_idx] == endptr)) {
+                || (state->list[idx] == endptr)) {
             DEBUG(SSSDBG_OP_FAILURE, "strtouint32 failed.\n");
             return EINVAL;
         }
@@ -1337,7 +1347,7 @@ static errno_t ipa_s2n_get_list_step(struct tevent_req *req)
 
         break;
     case REQ_INP_SECID:
-        state->req_input.inp.secid = state->list[state->list_idx];
+        state->req_input.inp.secid = state->list[idx];
         state->obj_domain = find_domain_by_sid(parent_domain,
                                                state->req_input.inp.secid);
         if (state->obj_domain == NULL) {
@@ -1354,6 +1364,71 @@ static errno_t ipa_s2n_get_list_step(struct tevent_req *req)
         return EINVAL;
     }
 
+    return EOK;
+}
+
+static errno_t ipa_s2n_get_list_step(struct tevent_req *req)
+{
+    int ret;
+    struct ipa_s2n_get_list_state *state = tevent_req_data(req,
+                                               struct ipa_s2n_get_list_state);
+    struct berval *bv_req;
+    struct tevent_req *subreq;
+    struct tevent_immediate *imm;
+    struct dp_id_data *ar;
+    bool ipa_object;
+
+    ret = ipa_s2n_get_list_prepare(state, state->list_idx, &ipa_object);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (ipa_object) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Looking up IPA object [%s] from LDAP.\n",
+              state->list[state->list_idx]);
+        ret = get_dp_id_data_for_user_name(state,
+                                           state->list[state->list_idx],
+                                           state->obj_domain->name,
+                                           &ar);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Failed to create lookup date for IPA object [%s].\n",
+                  state->list[state->list_idx]);
+            return ret;
+        }
+        ar->entry_type = state->entry_type;
+
+        subreq = ipa_id_get_account_info_send(state, state->ev,
+                                              state->ipa_ctx, ar);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "ipa_id_get_account_info_send failed.\n");
+            return ENOMEM;
+        }
+        tevent_req_set_callback(subreq, ipa_s2n_get_list_ipa_next, req);
+
+        return EOK;
+    }
+
+    if (state->use_batch) {
+        if (state->list_idx >= state->batch_start
+                && state->list_idx < state->batch_start + state->batch_count) {
+            /* Already received, continue from the main loop */
+            imm = tevent_create_immediate(state);
+            if (imm == NULL) {
+                DEBUG(SSSDBG_OP_FAILURE, "tevent_create_immediate failed.\n");
+                return ENOMEM;
+            }
+            tevent_schedule_immediate(imm, state->ev,
+                                      ipa_s2n_get_list_batch_next, req);
+
+            return EOK;
+        }
+
+        return ipa_s2n_get_list_batch_send(req);
+    }
+
     ret = s2n_encode_request(state, state->obj_domain->name, state->entry_type,
                              state->request_type, &state->req_input,
                              state->protocol, &bv_req);
@@ -1386,46 +1461,111 @@ static errno_t ipa_s2n_get_list_step(struct tevent_req *req)
     return EOK;
 }
 
-static void ipa_s2n_get_list_next(struct tevent_req *subreq)
+/* Sends the requests for the next list entries, starting with the current
+ * one, at once. The batch ends before the first entry which is not looked
+ * up with the extdom plugin. */
+static errno_t ipa_s2n_get_list_batch_send(struct tevent_req *req)
 {
     int ret;
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
     struct ipa_s2n_get_list_state *state = tevent_req_data(req,
                                                struct ipa_s2n_get_list_state);
-    char *retoid = NULL;
-    struct berval *retdata = NULL;
-    const char *sid_str;
-    struct dp_id_data *ar;
+    struct ipa_s2n_batch_item *item;
+    struct berval *bv_req;
+    struct tevent_req *subreq;
+    bool ipa_object;
+    size_t c;
 
-    ret = ipa_s2n_exop_recv(subreq, state, &retoid, &retdata);
-    talloc_zfree(subreq);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "s2n exop request failed.\n");
-        goto fail;
+    talloc_zfree(state->batch_results);
+    state->batch_results = talloc_zero_array(state,
+                                             struct ipa_s2n_batch_result,
+                                             IPA_S2N_BATCH_SIZE);
+    if (state->batch_results == NULL) {
+        return ENOMEM;
     }
+    state->batch_start = state->list_idx;
+    state->batch_count = 0;
+    state->batch_pending = 0;
 
-    talloc_zfree(state->attrs);
-    ret = s2n_response_to_attrs(state, state->dom, retoid, retdata,
-                                &state->attrs);
+    for (c = 0; c < IPA_S2N_BATCH_SIZE
+                    && state->list[state->list_idx + c] != NULL; c++) {
+        if (c > 0) {
+            /* Anything unexpected is left to the next batch which starts
+             * with this entry and reports it. */
+            ret = ipa_s2n_get_list_prepare(state, state->list_idx + c,
+                                           &ipa_object);
+            if (ret != EOK || ipa_object) {
+                break;
+            }
+        }
+
+        ret = s2n_encode_request(state, state->obj_domain->name,
+                                 state->entry_type, state->request_type,
+                                 &state->req_input, state->protocol,
+                                 &bv_req);
+        if (ret != EOK) {
+            if (c == 0) {
+                DEBUG(SSSDBG_OP_FAILURE, "s2n_encode_request failed.\n");
+                return ret;
+            }
+            break;
+        }
+
+        item = talloc_zero(state->batch_results, struct ipa_s2n_batch_item);
+        if (item == NULL) {
+            return ENOMEM;
+        }
+        item->req = req;
+        item->idx = c;
+
+        subreq = ipa_s2n_exop_send(item, state->ev, state->sh,
+                                   state->protocol, state->exop_timeout,
+                                   bv_req);
+        talloc_free(bv_req);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "ipa_s2n_exop_send failed.\n");
+            return ENOMEM;
+        }
+        tevent_req_set_callback(subreq, ipa_s2n_get_list_batch_done, item);
+        state->batch_pending++;
+    }
+
+    /* Switch back to the current entry */
+    ret = ipa_s2n_get_list_prepare(state, state->list_idx, &ipa_object);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "s2n_response_to_attrs failed.\n");
-        goto fail;
+        return ret;
     }
 
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Sent request_type: [%s] for [%zu] objects starting with [%s].\n",
+          ipa_s2n_reqtype2str(state->request_type), c,
+          state->list[state->list_idx]);
+
+    state->batch_requested = c;
+
+    return EOK;
+}
+
+/* Continues with the object in state->attrs. Returns EOK if the whole list
+ * is processed and EAGAIN if there is more to do. */
+static errno_t ipa_s2n_get_list_process_attrs(struct tevent_req *req)
+{
+    int ret;
+    struct ipa_s2n_get_list_state *state = tevent_req_data(req,
+                                               struct ipa_s2n_get_list_state);
+    struct tevent_req *subreq;
+    const char *sid_str;
+    struct dp_id_data *ar;
+
     DEBUG(SSSDBG_TRACE_FUNC, "Received [%s] attributes from IPA server.\n",
                              state->attrs->a.name);
 
     if (is_default_view(state->ipa_ctx->view_name)) {
         ret = ipa_s2n_get_list_save_step(req);
-        if (ret == EOK) {
-            tevent_req_done(req);
-        } else if (ret != EAGAIN) {
+        if (ret != EOK && ret != EAGAIN) {
             DEBUG(SSSDBG_OP_FAILURE, "ipa_s2n_get_list_save_step failed.\n");
-            goto fail;
         }
 
-        return;
+        return ret;
     }
 
     ret = sysdb_attrs_get_string(state->attrs->sysdb_attrs, SYSDB_SID_STR,
@@ -1435,13 +1575,13 @@ static void ipa_s2n_get_list_next(struct tevent_req *subreq)
               "Object [%s] has no SID, please check the "
               "ipaNTSecurityIdentifier attribute on the server-side",
               state->attrs->a.name);
-        goto fail;
+        return ret;
     }
 
     ret = get_dp_id_data_for_sid(state, sid_str, state->obj_domain->name, &ar);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "get_dp_id_data_for_sid failed.\n");
-        goto fail;
+        return ret;
     }
 
     subreq = ipa_get_ad_override_send(state, state->ev,
@@ -1453,11 +1593,45 @@ static void ipa_s2n_get_list_next(struct tevent_req *subreq)
                            ar);
     if (subreq == NULL) {
         DEBUG(SSSDBG_OP_FAILURE, "ipa_get_ad_override_send failed.\n");
-        ret = ENOMEM;
-        goto fail;
+        return ENOMEM;
     }
     tevent_req_set_callback(subreq, ipa_s2n_get_list_get_override_done, req);
 
+    return EAGAIN;
+}
+
+static void ipa_s2n_get_list_next(struct tevent_req *subreq)
+{
+    int ret;
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct ipa_s2n_get_list_state *state = tevent_req_data(req,
+                                               struct ipa_s2n_get_list_state);
+    char *retoid = NULL;
+    struct berval *retdata = NULL;
+
+    ret = ipa_s2n_exop_recv(subreq, state, &retoid, &retdata);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "s2n exop request failed.\n");
+        goto fail;
+    }
+
+    talloc_zfree(state->attrs);
+    ret = s2n_response_to_attrs(state, state->dom, retoid, retdata,
+                                &state->attrs);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "s2n_response_to_attrs failed.\n");
+        goto fail;
+    }
+
+    ret = ipa_s2n_get_list_process_attrs(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        goto fail;
+    }
+
     return;
 
 fail:
@@ -1465,6 +1639,79 @@ fail:
     return;
 }
 
+/* Handles the result of the current list entry from the last batch */
+static errno_t ipa_s2n_get_list_batch_item(struct tevent_req *req)
+{
+    int ret;
+    struct ipa_s2n_get_list_state *state = tevent_req_data(req,
+                                               struct ipa_s2n_get_list_state);
+    struct ipa_s2n_batch_result *result;
+
+    result = &state->batch_results[state->list_idx - state->batch_start];
+    if (result->ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "s2n exop request for [%s] failed.\n",
+              state->list[state->list_idx]);
+        return result->ret;
+    }
+
+    talloc_zfree(state->attrs);
+    ret = s2n_response_to_attrs(state, state->dom, result->retoid,
+                                result->retdata, &state->attrs);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "s2n_response_to_attrs failed.\n");
+        return ret;
+    }
+
+    return ipa_s2n_get_list_process_attrs(req);
+}
+
+static void ipa_s2n_get_list_batch_done(struct tevent_req *subreq)
+{
+    int ret;
+    struct ipa_s2n_batch_item *item = tevent_req_callback_data(subreq,
+                                                    struct ipa_s2n_batch_item);
+    struct tevent_req *req = item->req;
+    struct ipa_s2n_get_list_state *state = tevent_req_data(req,
+                                               struct ipa_s2n_get_list_state);
+    struct ipa_s2n_batch_result *result;
+
+    result = &state->batch_results[item->idx];
+    result->ret = ipa_s2n_exop_recv(subreq, state->batch_results,
+                                    &result->retoid, &result->retdata);
+    talloc_zfree(subreq);
+    talloc_free(item);
+
+    state->batch_pending--;
+    if (state->batch_pending > 0) {
+        return;
+    }
+    state->batch_count = state->batch_requested;
+
+    ret = ipa_s2n_get_list_batch_item(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void ipa_s2n_get_list_batch_next(struct tevent_context *ev,
+                                        struct tevent_immediate *imm,
+                                        void *pvt)
+{
+    int ret;
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+
+    talloc_free(imm);
+
+    ret = ipa_s2n_get_list_batch_item(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
 static void ipa_s2n_get_list_ipa_next(struct tevent_req *subreq)
 {
     int ret;
@@ -25,6 +25,7 @@
 
 #include "db/sysdb_selinux.h"
 #include "util/child_common.h"
+#include "util/sss_ptr_hash.h"
 #include "util/sss_selinux.h"
 #include "providers/ldap/sdap_async.h"
 #include "providers/ipa/ipa_common.h"
@@ -64,7 +65,8 @@ static errno_t ipa_get_selinux_recv(struct tevent_req *req,
                                     size_t *hbac_count,
                                     struct sysdb_attrs ***hbac_rules,
                                     char **default_user,
-                                    char **map_order);
+                                    char **map_order,
+                                    bool *from_cache);
 
 static void ipa_get_selinux_connect_done(struct tevent_req *subreq);
 static void ipa_get_selinux_hosts_done(struct tevent_req *subreq);
@@ -555,6 +557,85 @@ done:
     return ret;
 }
 
+/* What selinux_child set for a user. The child is not started again to
+ * set the same, until the entry expires after the SELinux refresh interval
+ * so that local changes to the login mapping are eventually corrected. */
+struct ipa_selinux_applied {
+    char *seuser;
+    char *mls_range;
+    time_t expire;
+};
+
+static bool ipa_selinux_applied_check(struct ipa_selinux_ctx *selinux_ctx,
+                                      struct selinux_child_input *sci)
+{
+    struct ipa_selinux_applied *applied;
+
+    if (selinux_ctx->applied == NULL) {
+        return false;
+    }
+
+    applied = sss_ptr_hash_lookup(selinux_ctx->applied, sci->username,
+                                  struct ipa_selinux_applied);
+    if (applied == NULL) {
+        return false;
+    }
+
+    if (applied->expire <= time(NULL)) {
+        talloc_free(applied);
+        return false;
+    }
+
+    return strcmp(applied->seuser, sci->seuser) == 0
+           && strcmp(applied->mls_range, sci->mls_range) == 0;
+}
+
+static void ipa_selinux_applied_set(struct ipa_selinux_ctx *selinux_ctx,
+                                    struct selinux_child_input *sci,
+                                    bool success)
+{
+    struct ipa_selinux_applied *applied;
+    errno_t ret;
+
+    if (selinux_ctx->applied == NULL) {
+        if (!success) {
+            return;
+        }
+
+        selinux_ctx->applied = sss_ptr_hash_create(selinux_ctx, NULL, NULL);
+        if (selinux_ctx->applied == NULL) {
+            return;
+        }
+    }
+
+    talloc_free(sss_ptr_hash_lookup(selinux_ctx->applied, sci->username,
+                                    struct ipa_selinux_applied));
+    if (!success) {
+        return;
+    }
+
+    applied = talloc_zero(selinux_ctx->applied, struct ipa_selinux_applied);
+    if (applied == NULL) {
+        return;
+    }
+
+    applied->seuser = talloc_strdup(applied, sci->seuser);
+    applied->mls_range = talloc_strdup(applied, sci->mls_range);
+    if (applied->seuser == NULL || applied->mls_range == NULL) {
+        talloc_free(applied);
+        return;
+    }
+    applied->expire = time(NULL)
+        + dp_opt_get_int(selinux_ctx->id_ctx->ipa_options->basic,
+                         IPA_SELINUX_REFRESH);
+
+    ret = sss_ptr_hash_add(selinux_ctx->applied, sci->username, applied,
+                           struct ipa_selinux_applied);
+    if (ret != EOK) {
+        talloc_free(applied);
+    }
+}
+
 struct selinux_child_state {
     struct selinux_child_input *sci;
     struct tevent_context *ev;
@@ -693,32 +774,26 @@ static errno_t selinux_fork_child(struct selinux_child_state *state)
         return ret;
     }
 
-    pid = fork();
-
-    if (pid == 0) { /* child */
-        exec_child(state, pipefd_to_child, pipefd_from_child,
-                   SELINUX_CHILD, SELINUX_CHILD_LOG_FILE);
-        DEBUG(SSSDBG_CRIT_FAILURE, "Could not exec selinux_child: [%d][%s].\n",
+    ret = sss_child_spawn(state, pipefd_to_child, pipefd_from_child,
+                          SELINUX_CHILD, SELINUX_CHILD_LOG_FILE, NULL, false,
+                          STDIN_FILENO, STDOUT_FILENO, &pid);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not start selinux_child: [%d][%s].\n",
               ret, sss_strerror(ret));
         return ret;
-    } else if (pid > 0) { /* parent */
-        state->io->read_from_child_fd = pipefd_from_child[0];
-        close(pipefd_from_child[1]);
-        state->io->write_to_child_fd = pipefd_to_child[1];
-        close(pipefd_to_child[0]);
-        sss_fd_nonblocking(state->io->read_from_child_fd);
-        sss_fd_nonblocking(state->io->write_to_child_fd);
-
-        ret = child_handler_setup(state->ev, pid, NULL, NULL, NULL);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Could not set up child signal handler\n");
-            return ret;
-        }
-    } else { /* error */
-        ret = errno;
+    }
+
+    state->io->read_from_child_fd = pipefd_from_child[0];
+    close(pipefd_from_child[1]);
+    state->io->write_to_child_fd = pipefd_to_child[1];
+    close(pipefd_to_child[0]);
+    sss_fd_nonblocking(state->io->read_from_child_fd);
+    sss_fd_nonblocking(state->io->write_to_child_fd);
+
+    ret = child_handler_setup(state->ev, pid, NULL, NULL, NULL);
+    if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
-              "fork failed [%d][%s].\n", errno, sss_strerror(errno));
+              "Could not set up child signal handler\n");
         return ret;
     }
 
@@ -831,6 +906,9 @@ struct ipa_get_selinux_state {
 
     struct sysdb_attrs **hbac_rules;
     size_t hbac_rule_count;
+
+    /* The maps were read from the cache, not downloaded */
+    bool from_cache;
 };
 
 static errno_t
@@ -1001,6 +1079,8 @@ ipa_get_selinux_maps_offline(struct tevent_req *req)
     struct ipa_get_selinux_state *state = tevent_req_data(req,
                                                   struct ipa_get_selinux_state);
 
+    state->from_cache = true;
+
     /* read the config entry */
     ret = sysdb_search_selinux_config(state, state->be_ctx->domain,
                                       NULL, &defaults);
@@ -1273,7 +1353,8 @@ ipa_get_selinux_recv(struct tevent_req *req,
                      size_t *hbac_count,
                      struct sysdb_attrs ***hbac_rules,
                      char **default_user,
-                     char **map_order)
+                     char **map_order,
+                     bool *from_cache)
 {
     struct ipa_get_selinux_state *state =
             tevent_req_data(req, struct ipa_get_selinux_state);
@@ -1314,6 +1395,8 @@ ipa_get_selinux_recv(struct tevent_req *req,
     *hbac_count = state->hbac_rule_count;
     *hbac_rules = talloc_steal(mem_ctx, state->hbac_rules);
 
+    *from_cache = state->from_cache;
+
     return EOK;
 }
 
@@ -1513,6 +1596,8 @@ struct ipa_selinux_handler_state {
 
     struct sysdb_attrs *user;
     struct sysdb_attrs *host;
+
+    struct selinux_child_input *sci;
 };
 
 static void ipa_selinux_handler_get_done(struct tevent_req *subreq);
@@ -1590,6 +1675,7 @@ static void ipa_selinux_handler_get_done(struct tevent_req *subreq)
     size_t hbac_count = 0;
     char *default_user = NULL;
     char *map_order = NULL;
+    bool from_cache = false;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
@@ -1597,18 +1683,23 @@ static void ipa_selinux_handler_get_done(struct tevent_req *subreq)
 
     ret = ipa_get_selinux_recv(subreq, state, &map_count, &maps,
                                &hbac_count, &hbac_rules,
-                               &default_user, &map_order);
+                               &default_user, &map_order, &from_cache);
     talloc_free(subreq);
     if (ret != EOK) {
         goto done;
     }
 
-    ret = ipa_selinux_store_config(state->ipa_domain->sysdb, state->ipa_domain,
-                                   default_user, map_order, map_count, maps);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to store SELinux config [%d]: %s\n",
-              ret, sss_strerror(ret));
-        goto done;
+    /* Maps read from the cache are stored there already */
+    if (!from_cache) {
+        ret = ipa_selinux_store_config(state->ipa_domain->sysdb,
+                                       state->ipa_domain, default_user,
+                                       map_order, map_count, maps);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Unable to store SELinux config [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            goto done;
+        }
     }
 
     ret = ipa_selinux_create_child_input(state, state->user, state->host,
@@ -1622,6 +1713,17 @@ static void ipa_selinux_handler_get_done(struct tevent_req *subreq)
         goto done;
     }
 
+    if (ipa_selinux_applied_check(state->selinux_ctx, sci)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "SELinux user [%s] of [%s] is set already\n",
+              sci->seuser, sci->username);
+        if (!be_is_offline(state->be_ctx) && !from_cache) {
+            state->selinux_ctx->last_update = time(NULL);
+        }
+        state->pd->pam_status = PAM_SUCCESS;
+        goto done;
+    }
+    state->sci = sci;
+
     /* Update the SELinux context in a privileged child as the back end is
      * running unprivileged
      */
@@ -1648,6 +1750,7 @@ static void ipa_selinux_handler_done(struct tevent_req *subreq)
 
     ret = selinux_child_recv(subreq);
     talloc_free(subreq);
+    ipa_selinux_applied_set(state->selinux_ctx, state->sci, ret == EOK);
     if (ret != EOK) {
         state->pd->pam_status = PAM_SYSTEM_ERR;
         goto done;
@@ -31,6 +31,9 @@ struct ipa_selinux_ctx {
     struct ipa_id_ctx *id_ctx;
     time_t last_update;
 
+    /* SELinux users that selinux_child set for the users, by user name */
+    hash_table_t *applied;
+
     struct sdap_search_base **selinux_search_bases;
     struct sdap_search_base **host_search_bases;
     struct sdap_search_base **hbac_search_bases;
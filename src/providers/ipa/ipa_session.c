@@ -24,6 +24,7 @@
 #include <security/pam_modules.h>
 
 #include "util/child_common.h"
+#include "util/sss_ptr_hash.h"
 #include "providers/ldap/sdap_async.h"
 #include "providers/ipa/ipa_common.h"
 #include "providers/ipa/ipa_config.h"
@@ -463,9 +464,13 @@ ipa_pam_session_handler_get_deskprofile_user_info(
                                                 uid_t *uid,
                                                 gid_t *gid);
 static void ipa_pam_session_handler_done(struct tevent_req *subreq);
+static void
+ipa_pam_session_handler_forget_rules(struct ipa_session_ctx *session_ctx,
+                                     const char *username);
 static errno_t
 ipa_pam_session_handler_save_deskprofile_rules(
                                     struct be_ctx *be_ctx,
+                                    struct ipa_session_ctx *session_ctx,
                                     struct sss_domain_info *domain,
                                     const char *username, /* fully-qualified */
                                     const char *user_dir,
@@ -525,19 +530,6 @@ ipa_pam_session_handler_send(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    /* As no proper merging mechanism has been implemented yet ...
-     * let's just remove the user directory stored in the disk as it's
-     * going to be created again in case there's any rule fetched. */
-    ret = ipa_deskprofile_rules_remove_user_dir(state->user_dir,
-                                                state->uid,
-                                                state->gid);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "ipa_deskprofile_rules_remove_user_dir() failed.\n");
-        state->pd->pam_status = PAM_SESSION_ERR;
-        goto done;
-    }
-
     subreq = ipa_fetch_deskprofile_send(state, state->ev, state->be_ctx,
                                         state->session_ctx, pd->user);
     if (subreq == NULL) {
@@ -569,6 +561,20 @@ ipa_pam_session_handler_done(struct tevent_req *subreq)
     ret = ipa_fetch_deskprofile_recv(subreq);
     talloc_free(subreq);
 
+    if (ret != EOK) {
+        /* No rules apply to the user anymore */
+        ipa_pam_session_handler_forget_rules(state->session_ctx,
+                                             state->pd->user);
+        if (ipa_deskprofile_rules_remove_user_dir(state->user_dir,
+                                                  state->uid,
+                                                  state->gid) != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "ipa_deskprofile_rules_remove_user_dir() failed.\n");
+            state->pd->pam_status = PAM_SESSION_ERR;
+            goto done;
+        }
+    }
+
     if (ret == ENOENT) {
         DEBUG(SSSDBG_FUNC_DATA, "No Desktop Profile rules found\n");
         if (!state->session_ctx->no_rules_found) {
@@ -589,6 +595,7 @@ ipa_pam_session_handler_done(struct tevent_req *subreq)
 
     hostname = dp_opt_get_string(state->session_ctx->ipa_options, IPA_HOSTNAME);
     ret = ipa_pam_session_handler_save_deskprofile_rules(state->be_ctx,
+                                                         state->session_ctx,
                                                          state->be_ctx->domain,
                                                          state->pd->user,
                                                          state->user_dir,
@@ -697,9 +704,194 @@ done:
     return ret;
 }
 
+/* The fingerprint covers everything the files written for the user depend
+ * on: the rules, the priority, the host and its host groups and the user
+ * and their groups */
+static errno_t
+ipa_pam_session_handler_rules_fingerprint(struct sss_domain_info *domain,
+                                          const char *username,
+                                          const char *hostname,
+                                          uint16_t priority,
+                                          size_t rule_count,
+                                          struct sysdb_attrs **rules,
+                                          uint64_t *_fingerprint)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ipa_common_entries entries = { 0 };
+    struct sysdb_attrs *inputs;
+    struct ldb_result *res;
+    struct ldb_message **msgs;
+    struct ldb_message_element *el;
+    struct ldb_dn *host_dn;
+    const char *memberof_attrs[] = { SYSDB_ORIG_MEMBEROF, NULL };
+    const char *name;
+    size_t count;
+    size_t i;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    inputs = sysdb_new_attrs(tmp_ctx);
+    if (inputs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_attrs_add_string(inputs, SYSDB_NAME, username);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_attrs_add_string(inputs, SYSDB_FQDN, hostname);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_attrs_add_uint32(inputs, IPA_DESKPROFILE_PRIORITY, priority);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_initgroups(tmp_ctx, domain, username, &res);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* The first entry is the user */
+    for (i = 1; i < res->count; i++) {
+        name = ldb_msg_find_attr_as_string(res->msgs[i], SYSDB_NAME, NULL);
+        if (name == NULL) {
+            continue;
+        }
+
+        ret = sysdb_attrs_add_string(inputs, SYSDB_MEMBEROF, name);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    host_dn = sysdb_custom_dn(tmp_ctx, domain, hostname,
+                              DESKPROFILE_HOSTS_SUBDIR);
+    if (host_dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, host_dn, LDB_SCOPE_BASE,
+                             NULL, memberof_attrs, &count, &msgs);
+    if (ret == EOK && count == 1) {
+        el = ldb_msg_find_element(msgs[0], SYSDB_ORIG_MEMBEROF);
+        for (i = 0; el != NULL && i < el->num_values; i++) {
+            ret = sysdb_attrs_add_val(inputs, SYSDB_ORIG_MEMBEROF,
+                                      &el->values[i]);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+    } else if (ret != EOK && ret != ENOENT) {
+        goto done;
+    }
+
+    entries.entries = talloc_array(tmp_ctx, struct sysdb_attrs *,
+                                   rule_count + 1);
+    if (entries.entries == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < rule_count; i++) {
+        entries.entries[i] = rules[i];
+    }
+    entries.entries[rule_count] = inputs;
+    entries.entry_count = rule_count + 1;
+
+    *_fingerprint = ipa_common_rules_fingerprint(NULL, NULL, &entries);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+struct ipa_pam_session_written_rules {
+    uint64_t fingerprint;
+};
+
+static void
+ipa_pam_session_handler_forget_rules(struct ipa_session_ctx *session_ctx,
+                                     const char *username)
+{
+    if (session_ctx->written_rules == NULL) {
+        return;
+    }
+
+    talloc_free(sss_ptr_hash_lookup(session_ctx->written_rules, username,
+                                    struct ipa_pam_session_written_rules));
+}
+
+static bool
+ipa_pam_session_handler_rules_written(struct ipa_session_ctx *session_ctx,
+                                      const char *username,
+                                      const char *user_dir,
+                                      uint64_t fingerprint)
+{
+    struct ipa_pam_session_written_rules *written;
+
+    if (session_ctx->written_rules == NULL) {
+        return false;
+    }
+
+    written = sss_ptr_hash_lookup(session_ctx->written_rules, username,
+                                  struct ipa_pam_session_written_rules);
+    if (written == NULL || written->fingerprint != fingerprint) {
+        return false;
+    }
+
+    /* Somebody may have removed the files in the meantime */
+    if (access(user_dir, F_OK) != 0) {
+        return false;
+    }
+
+    return true;
+}
+
+static void
+ipa_pam_session_handler_remember_rules(struct ipa_session_ctx *session_ctx,
+                                       const char *username,
+                                       uint64_t fingerprint)
+{
+    struct ipa_pam_session_written_rules *written;
+    errno_t ret;
+
+    if (session_ctx->written_rules == NULL) {
+        session_ctx->written_rules = sss_ptr_hash_create(session_ctx,
+                                                         NULL, NULL);
+        if (session_ctx->written_rules == NULL) {
+            return;
+        }
+    }
+
+    written = talloc_zero(session_ctx->written_rules,
+                          struct ipa_pam_session_written_rules);
+    if (written == NULL) {
+        return;
+    }
+    written->fingerprint = fingerprint;
+
+    ret = sss_ptr_hash_add(session_ctx->written_rules, username, written,
+                           struct ipa_pam_session_written_rules);
+    if (ret != EOK) {
+        talloc_free(written);
+    }
+}
+
 static errno_t
 ipa_pam_session_handler_save_deskprofile_rules(
                                     struct be_ctx *be_ctx,
+                                    struct ipa_session_ctx *session_ctx,
                                     struct sss_domain_info *domain,
                                     const char *username, /* fully-qualified */
                                     const char *user_dir,
@@ -711,6 +903,8 @@ ipa_pam_session_handler_save_deskprofile_rules(
     const char **attrs_get_cached_rules;
     size_t rule_count;
     struct sysdb_attrs **rules;
+    uint64_t fingerprint = 0;
+    bool have_fingerprint;
     uint16_t priority;
     errno_t ret;
 
@@ -749,6 +943,36 @@ ipa_pam_session_handler_save_deskprofile_rules(
         goto done;
     }
 
+    ret = ipa_pam_session_handler_rules_fingerprint(domain, username,
+                                                    hostname, priority,
+                                                    rule_count, rules,
+                                                    &fingerprint);
+    have_fingerprint = (ret == EOK);
+    if (!have_fingerprint) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot compute the fingerprint of the rules [%d]: %s\n",
+              ret, sss_strerror(ret));
+    }
+
+    if (have_fingerprint
+            && ipa_pam_session_handler_rules_written(session_ctx, username,
+                                                     user_dir, fingerprint)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Desktop Profile rules of [%s] did not "
+              "change, keeping the files\n", username);
+        goto notify;
+    }
+
+    /* As no proper merging mechanism has been implemented yet ...
+     * let's just remove the user directory stored in the disk as it's
+     * going to be created again with the current rules. */
+    ipa_pam_session_handler_forget_rules(session_ctx, username);
+    ret = ipa_deskprofile_rules_remove_user_dir(user_dir, uid, gid);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "ipa_deskprofile_rules_remove_user_dir() failed.\n");
+        goto done;
+    }
+
     /* Create the user directory where the rules are going to be stored */
     ret = ipa_deskprofile_rules_create_user_dir(username, uid, gid);
     if (ret != EOK) {
@@ -772,10 +996,18 @@ ipa_pam_session_handler_save_deskprofile_rules(
             DEBUG(SSSDBG_OP_FAILURE,
                   "Failed to save a Desktop Profile Rule to disk [%d]: %s\n",
                   ret, sss_strerror(ret));
+            /* write all files again on the next session */
+            have_fingerprint = false;
             continue;
         }
     }
 
+    if (have_fingerprint) {
+        ipa_pam_session_handler_remember_rules(session_ctx, username,
+                                               fingerprint);
+    }
+
+notify:
     /* Notify FleetCommander that our side is done */
     ret = ipa_pam_session_handler_notify_deskprofile_client(be_ctx,
                                                             be_ctx->ev,
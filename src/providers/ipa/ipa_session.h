@@ -34,6 +34,9 @@ struct ipa_session_ctx {
     time_t last_request;
     bool no_rules_found;
 
+    /* Fingerprints of the rules last written for each user, by user name */
+    hash_table_t *written_rules;
+
     struct sdap_attr_map *host_map;
     struct sdap_attr_map *hostgroup_map;
     struct sdap_search_base **deskprofile_search_bases;
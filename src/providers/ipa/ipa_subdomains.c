@@ -3274,7 +3274,8 @@ errno_t ipa_subdomains_init(TALLOC_CTX *mem_ctx,
                           ipa_subdomains_ptask_send, ipa_subdomains_ptask_recv, sd_ctx,
                           "Subdomains Refresh",
                           BE_PTASK_OFFLINE_DISABLE |
-                          BE_PTASK_SCHEDULE_FROM_LAST,
+                          BE_PTASK_SCHEDULE_FROM_LAST |
+                          BE_PTASK_BULK,
                           NULL);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to setup ptask "
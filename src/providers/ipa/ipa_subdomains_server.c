@@ -344,13 +344,17 @@ ipa_ad_ctx_new(struct be_ctx *be_ctx,
                                      ad_id_ctx->ad_options->id,
                                      id_ctx->server_mode->hostname,
                                      ad_domain,
-                                     ad_site_override);
+                                     ad_site_override,
+                                     dp_opt_get_int(ad_options->basic,
+                                                    AD_DISCOVERY_CACHE_TIMEOUT));
     if (srv_ctx == NULL) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory?\n");
         return ENOMEM;
     }
+    /* the AD plugin keeps the discovered servers in the sysdb */
     be_fo_set_srv_lookup_plugin(be_ctx, ad_srv_plugin_send,
-                                ad_srv_plugin_recv, srv_ctx, "AD");
+                                ad_srv_plugin_recv, srv_ctx,
+                                srv_ctx->cache_timeout > 0, "AD");
 
     ret = sdap_domain_subdom_add(ad_id_ctx->sdap_id_ctx,
                                  ad_id_ctx->sdap_id_ctx->opts->sdom,
@@ -262,6 +262,13 @@ ipa_sudo_init_ipa_schema(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = sss_hash_create(sudo_ctx, 0, &sudo_ctx->conv_cache);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create hash table [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
     ret = ipa_sudo_ptask_setup(be_ctx, sudo_ctx);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to setup periodic tasks "
@@ -21,6 +21,8 @@
 #ifndef _IPA_SUDO_H_
 #define _IPA_SUDO_H_
 
+#include <dhash.h>
+
 #include "providers/ipa/ipa_common.h"
 
 struct ipa_sudo_ctx {
@@ -34,6 +36,9 @@ struct ipa_sudo_ctx {
     struct sdap_attr_map *sudocmd_map;
     struct sdap_search_base **sudo_sb;
     int sudocmd_threshold;
+
+    /* rules converted by previous refreshes, by name */
+    hash_table_t *conv_cache;
 };
 
 errno_t
@@ -126,7 +131,12 @@ ipa_sudo_conv_cmd_filter(TALLOC_CTX *mem_ctx,
 errno_t
 ipa_sudo_conv_result(TALLOC_CTX *mem_ctx,
                      struct ipa_sudo_conv *conv,
+                     hash_table_t *cache,
                      struct sysdb_attrs ***_rules,
                      size_t *_num_rules);
 
+errno_t
+ipa_sudo_conv_prune_cache(struct ipa_sudo_conv *conv,
+                          hash_table_t *cache);
+
 #endif /* _IPA_SUDO_H_ */
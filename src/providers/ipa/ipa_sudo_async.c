@@ -371,6 +371,7 @@ struct ipa_sudo_fetch_state {
     struct sdap_handle *sh;
     const char *search_filter;
     const char *cmdgroups_filter;
+    bool full_refresh;
 
     struct sdap_attr_map *map_cmdgroup;
     struct sdap_attr_map *map_rule;
@@ -425,6 +426,7 @@ ipa_sudo_fetch_send(TALLOC_CTX *mem_ctx,
     state->sdap_opts = sudo_ctx->sdap_opts;
     state->host = host;
     state->sh = sh;
+    state->full_refresh = (search_filter == NULL && cmdgroups_filter == NULL);
     state->search_filter = search_filter == NULL ? "" : search_filter;
     state->cmdgroups_filter = cmdgroups_filter;
 
@@ -798,7 +800,7 @@ ipa_sudo_fetch_done(struct tevent_req *req)
 
     DEBUG(SSSDBG_TRACE_FUNC, "About to convert rules\n");
 
-    ret = ipa_sudo_conv_result(state, state->conv,
+    ret = ipa_sudo_conv_result(state, state->conv, state->sudo_ctx->conv_cache,
                                &state->rules, &state->num_rules);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to convert rules [%d]: %s\n",
@@ -806,6 +808,16 @@ ipa_sudo_fetch_done(struct tevent_req *req)
         goto done;
     }
 
+    if (state->full_refresh) {
+        ret = ipa_sudo_conv_prune_cache(state->conv,
+                                        state->sudo_ctx->conv_cache);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to prune conversion cache "
+                  "[%d]: %s\n", ret, sss_strerror(ret));
+            goto done;
+        }
+    }
+
     ret = EOK;
 
 done:
@@ -81,6 +81,14 @@ struct ipa_sudo_rule {
 struct ipa_sudo_cmdgroup {
     struct ipa_sudo_dn_list *cmds;
     const char **expanded;
+    const char *usn;
+};
+
+/* Converted rule kept between refreshes. It is reused as long as the
+ * highest entryUSN of the rule and its command groups stays the same. */
+struct ipa_sudo_cached_rule {
+    const char *usn;
+    struct sysdb_attrs *attrs;
 };
 
 static size_t
@@ -471,6 +479,7 @@ ipa_sudo_conv_cmdgroups(struct ipa_sudo_conv *conv,
 {
     struct ipa_sudo_cmdgroup *cmdgroup = NULL;
     const char *key;
+    const char *usn;
     errno_t ret;
     size_t i;
 
@@ -500,6 +509,15 @@ ipa_sudo_conv_cmdgroups(struct ipa_sudo_conv *conv,
             return ret;
         }
 
+        ret = sysdb_attrs_get_string(cmdgroups[i], SYSDB_USN, &usn);
+        if (ret == EOK) {
+            cmdgroup->usn = talloc_strdup(cmdgroup, usn);
+            if (cmdgroup->usn == NULL) {
+                ret = ENOMEM;
+                goto done;
+            }
+        }
+
         ret = ipa_sudo_conv_store(conv->cmdgroups, key, cmdgroup);
         if (ret != EOK) {
             DEBUG(SSSDBG_OP_FAILURE, "Failed to store command group into "
@@ -767,8 +785,10 @@ ipa_sudo_conv_cmd_filter(TALLOC_CTX *mem_ctx,
 
 struct ipa_sudo_conv_result_ctx {
     struct ipa_sudo_conv *conv;
+    hash_table_t *cache;
     struct sysdb_attrs **rules;
     size_t num_rules;
+    size_t num_cached;
     errno_t ret;
 };
 
@@ -1214,13 +1234,128 @@ done:
     return ret;
 }
 
+/* Returns the highest entryUSN of the rule and its command groups or NULL
+ * if it is not known for any of them. */
+static const char *
+rule_usn(struct ipa_sudo_conv *conv,
+         struct ipa_sudo_rule *rule)
+{
+    struct ipa_sudo_dn_list *lists[] = { rule->allow.cmdgroups,
+                                         rule->deny.cmdgroups,
+                                         NULL };
+    struct ipa_sudo_cmdgroup *cmdgroup;
+    struct ipa_sudo_dn_list *listitem;
+    const char *usn;
+    errno_t ret;
+    int i;
+
+    ret = sysdb_attrs_get_string(rule->attrs, SYSDB_USN, &usn);
+    if (ret != EOK) {
+        return NULL;
+    }
+
+    for (i = 0; lists[i] != NULL; i++) {
+        DLIST_FOR_EACH(listitem, lists[i]) {
+            cmdgroup = ipa_sudo_conv_lookup(conv->cmdgroups, listitem->dn);
+            if (cmdgroup == NULL || cmdgroup->usn == NULL) {
+                return NULL;
+            }
+
+            if (sysdb_compare_usn(cmdgroup->usn, usn) > 0) {
+                usn = cmdgroup->usn;
+            }
+        }
+    }
+
+    return usn;
+}
+
+static struct ipa_sudo_cached_rule *
+lookup_cached_rule(hash_table_t *cache,
+                   const char *name)
+{
+    hash_key_t hkey;
+    hash_value_t hvalue;
+    int hret;
+
+    hkey.type = HASH_KEY_STRING;
+    hkey.str = discard_const(name);
+
+    hret = hash_lookup(cache, &hkey, &hvalue);
+    if (hret != HASH_SUCCESS) {
+        return NULL;
+    }
+
+    return hvalue.ptr;
+}
+
+static errno_t
+cache_rule(hash_table_t *cache,
+           const char *name,
+           const char *usn,
+           struct sysdb_attrs *attrs)
+{
+    struct ipa_sudo_cached_rule *cached;
+    struct ipa_sudo_cached_rule *old;
+    hash_key_t hkey;
+    hash_value_t hvalue;
+    errno_t ret;
+    int hret;
+
+    cached = talloc_zero(cache, struct ipa_sudo_cached_rule);
+    if (cached == NULL) {
+        return ENOMEM;
+    }
+
+    cached->usn = talloc_strdup(cached, usn);
+    cached->attrs = sysdb_new_attrs(cached);
+    if (cached->usn == NULL || cached->attrs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_attrs_copy(attrs, cached->attrs);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    hkey.type = HASH_KEY_STRING;
+    hkey.str = discard_const(name);
+
+    old = lookup_cached_rule(cache, name);
+    if (old != NULL) {
+        hash_delete(cache, &hkey);
+        talloc_free(old);
+    }
+
+    hvalue.type = HASH_VALUE_PTR;
+    hvalue.ptr = cached;
+
+    hret = hash_enter(cache, &hkey, &hvalue);
+    if (hret != HASH_SUCCESS) {
+        ret = EIO;
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(cached);
+    }
+
+    return ret;
+}
+
 static bool
 rules_iterator(hash_entry_t *item,
                void *user_data)
 {
     struct ipa_sudo_conv_result_ctx *ctx = user_data;
     struct ipa_sudo_rule *rule = item->value.ptr;
+    struct ipa_sudo_cached_rule *cached = NULL;
     struct sysdb_attrs *attrs;
+    const char *usn = NULL;
 
     if (ctx == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Bug: ctx is NULL\n");
@@ -1239,6 +1374,28 @@ rules_iterator(hash_entry_t *item,
         return false;
     }
 
+    if (ctx->cache != NULL) {
+        usn = rule_usn(ctx->conv, rule);
+        if (usn != NULL) {
+            cached = lookup_cached_rule(ctx->cache, item->key.str);
+        }
+    }
+
+    if (cached != NULL && strcmp(cached->usn, usn) == 0) {
+        /* Neither the rule nor its command groups changed. */
+        ctx->ret = sysdb_attrs_copy(cached->attrs, attrs);
+        if (ctx->ret != EOK) {
+            talloc_free(attrs);
+            return false;
+        }
+
+        ctx->rules[ctx->num_rules] = attrs;
+        ctx->num_rules++;
+        ctx->num_cached++;
+
+        return true;
+    }
+
     ctx->ret = convert_attributes(ctx->conv, rule, attrs);
     if (ctx->ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "Unable to convert attributes [%d]: %s\n",
@@ -1255,6 +1412,16 @@ rules_iterator(hash_entry_t *item,
         return false;
     }
 
+    if (usn != NULL) {
+        ctx->ret = cache_rule(ctx->cache, item->key.str, usn, attrs);
+        if (ctx->ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to cache converted rule "
+                  "[%d]: %s\n", ctx->ret, sss_strerror(ctx->ret));
+            talloc_free(attrs);
+            return false;
+        }
+    }
+
     ctx->rules[ctx->num_rules] = attrs;
     ctx->num_rules++;
 
@@ -1296,6 +1463,7 @@ cmdgroups_iterator(hash_entry_t *item,
 errno_t
 ipa_sudo_conv_result(TALLOC_CTX *mem_ctx,
                      struct ipa_sudo_conv *conv,
+                     hash_table_t *cache,
                      struct sysdb_attrs ***_rules,
                      size_t *_num_rules)
 {
@@ -1312,8 +1480,10 @@ ipa_sudo_conv_result(TALLOC_CTX *mem_ctx,
     }
 
     ctx.conv = conv;
+    ctx.cache = cache;
     ctx.rules = NULL;
     ctx.num_rules = 0;
+    ctx.num_cached = 0;
 
     /* If there are no cmdgroups the iterator is not called and ctx.ret is
      * uninitialized. Since it is ok that there are no cmdgroups initializing
@@ -1356,8 +1526,49 @@ ipa_sudo_conv_result(TALLOC_CTX *mem_ctx,
         return ctx.ret;
     }
 
+    DEBUG(SSSDBG_TRACE_FUNC, "%zu of %zu rules did not change since they "
+          "were last converted\n", ctx.num_cached, ctx.num_rules);
+
     *_rules = ctx.rules;
     *_num_rules = ctx.num_rules;
 
     return EOK;
 }
+
+/* Removes the cached rules that were not downloaded. This is only
+ * correct after all rules were downloaded. */
+errno_t
+ipa_sudo_conv_prune_cache(struct ipa_sudo_conv *conv,
+                          hash_table_t *cache)
+{
+    hash_key_t *keys;
+    hash_value_t hvalue;
+    unsigned long int count;
+    unsigned long int i;
+    int hret;
+
+    hret = hash_keys(cache, &count, &keys);
+    if (hret != HASH_SUCCESS) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (hash_has_key(conv->rules, &keys[i])) {
+            continue;
+        }
+
+        hret = hash_lookup(cache, &keys[i], &hvalue);
+        if (hret != HASH_SUCCESS) {
+            continue;
+        }
+
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Removing rule %s from conversion "
+              "cache\n", keys[i].str);
+        hash_delete(cache, &keys[i]);
+        talloc_free(hvalue.ptr);
+    }
+
+    talloc_free(keys);
+
+    return EOK;
+}
@@ -47,6 +47,7 @@
 #define CHILD_OPT_FAST_PRINCIPAL "fast-principal"
 #define CHILD_OPT_CANONICALIZE "canonicalize"
 #define CHILD_OPT_SSS_CREDS_PASSWORD "sss-creds-password"
+#define CHILD_OPT_WORKER_TIMEOUT "worker-timeout"
 
 struct krb5child_req {
     struct pam_data *pd;
@@ -129,6 +130,9 @@ errno_t init_delayed_online_authentication(struct krb5_ctx *krb5_ctx,
 
 errno_t init_renew_tgt(struct krb5_ctx *krb5_ctx, struct be_ctx *be_ctx,
                        struct tevent_context *ev, time_t renew_intv);
+
+errno_t krb5_fast_armor_init(struct krb5_ctx *krb5_ctx,
+                             struct be_ctx *be_ctx);
 errno_t add_tgt_to_renew_table(struct krb5_ctx *krb5_ctx, const char *ccfile,
                                struct tgt_times *tgtt, struct pam_data *pd,
                                const char *upn);
@@ -27,7 +27,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <ctype.h>
+#include <poll.h>
 #include <popt.h>
+#include <sys/wait.h>
 
 #include <security/pam_modules.h>
 
@@ -40,10 +42,13 @@
 #include "providers/backend.h"
 #include "providers/krb5/krb5_auth.h"
 #include "providers/krb5/krb5_utils.h"
+#include "providers/krb5/krb5_child_worker.h"
 #include "sss_cli.h"
 
 #define SSSD_KRB5_CHANGEPW_PRINCIPAL "kadmin/changepw"
 
+#define K5C_WORKER_POLL_MS 1000
+
 #define IS_SC_AUTHTOK(tok) ( \
     sss_authtok_get_type((tok)) == SSS_AUTHTOK_TYPE_SC_PIN \
         || sss_authtok_get_type((tok)) == SSS_AUTHTOK_TYPE_SC_KEYPAD)
@@ -2428,6 +2433,8 @@ static const char *krb5_child_command_to_str(int cmd)
         return "ticket renewal";
     case SSS_PAM_PREAUTH:
         return "pre-auth";
+    case SSS_CMD_FAST_ARMOR:
+        return "FAST armor refresh";
     }
 
     DEBUG(SSSDBG_MINOR_FAILURE, "Unexpected command %d\n", cmd);
@@ -2487,6 +2494,7 @@ static errno_t unpack_buffer(uint8_t *buf, size_t size,
     if (pd->cmd == SSS_PAM_AUTHENTICATE ||
         pd->cmd == SSS_PAM_PREAUTH ||
         pd->cmd == SSS_CMD_RENEW ||
+        pd->cmd == SSS_CMD_FAST_ARMOR ||
         pd->cmd == SSS_PAM_CHAUTHTOK_PRELIM || pd->cmd == SSS_PAM_CHAUTHTOK) {
         SAFEALIGN_COPY_UINT32_CHECK(&len, buf + p, size, &p);
         if (len > size - p) return EINVAL;
@@ -2636,6 +2644,7 @@ static krb5_error_code check_fast_ccache(TALLOC_CTX *mem_ctx,
                                          const char *primary,
                                          const char *realm,
                                          const char *keytab_name,
+                                         time_t min_lifetime,
                                          char **fast_ccname)
 {
     TALLOC_CTX *tmp_ctx = NULL;
@@ -2701,7 +2710,7 @@ static krb5_error_code check_fast_ccache(TALLOC_CTX *mem_ctx,
     memset(&tgtt, 0, sizeof(tgtt));
     kerr = get_tgt_times(ctx, ccname, server_princ, client_princ, &tgtt);
     if (kerr == 0) {
-        if (tgtt.endtime > time(NULL)) {
+        if (tgtt.endtime > time(NULL) + min_lifetime) {
             DEBUG(SSSDBG_FUNC_DATA, "FAST TGT is still valid.\n");
             goto done;
         }
@@ -2832,6 +2841,7 @@ static errno_t k5c_recv_data(struct krb5_req *kr, int fd, uint32_t *offline)
 
 static int k5c_setup_fast(struct krb5_req *kr, bool demand)
 {
+    time_t min_lifetime = 0;
     krb5_principal fast_princ_struct;
     krb5_data *realm_data;
     char *fast_principal_realm;
@@ -2874,10 +2884,16 @@ static int k5c_setup_fast(struct krb5_req *kr, bool demand)
         fast_principal = NULL;
     }
 
+    /* The periodic refresh of the backend renews the TGT before the
+     * requests of the users find it expired */
+    if (kr->pd->cmd == SSS_CMD_FAST_ARMOR) {
+        min_lifetime = 2 * KRB5_FAST_ARMOR_REFRESH_INTERVAL;
+    }
+
     kerr = check_fast_ccache(kr, kr->ctx, kr->fast_uid, kr->fast_gid,
                              kr->posix_domain, kr->cli_opts,
                              fast_principal, fast_principal_realm,
-                             kr->keytab, &kr->fast_ccname);
+                             kr->keytab, min_lifetime, &kr->fast_ccname);
     if (kerr != 0) {
         DEBUG(SSSDBG_CRIT_FAILURE, "check_fast_ccache failed.\n");
         KRB5_CHILD_DEBUG(SSSDBG_CRIT_FAILURE, kerr);
@@ -3158,6 +3174,205 @@ static int k5c_setup(struct krb5_req *kr, uint32_t offline)
     return kerr;
 }
 
+/* Context initialized by a worker and inherited by every request process
+ * forked from it, together with the environment of the worker. */
+static krb5_context k5c_worker_ctx = NULL;
+static char **k5c_worker_env = NULL;
+
+struct k5c_worker_child {
+    pid_t pid;
+    time_t started;
+};
+
+static void k5c_worker_reap(struct k5c_worker_child *children,
+                            size_t *_num_children, int timeout)
+{
+    size_t num_children = *_num_children;
+    time_t now = time(NULL);
+    pid_t pid;
+    size_t c;
+    int ret;
+
+    while ((pid = waitpid(-1, NULL, WNOHANG)) > 0) {
+        for (c = 0; c < num_children; c++) {
+            if (children[c].pid == pid) {
+                children[c] = children[num_children - 1];
+                num_children--;
+                break;
+            }
+        }
+    }
+
+    /* The backend does not know the pids of the request processes, so it
+     * is up to the worker to enforce krb5_auth_timeout. */
+    for (c = 0; c < num_children; c++) {
+        if (now - children[c].started > timeout) {
+            DEBUG(SSSDBG_IMPORTANT_INFO,
+                  "Timeout for request process [%d] reached.\n",
+                  children[c].pid);
+            ret = kill(children[c].pid, SIGKILL);
+            if (ret == -1) {
+                ret = errno;
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "kill failed [%d][%s].\n", ret, strerror(ret));
+            }
+            /* do not kill it again, waitpid() will still reap it */
+            children[c].started = now;
+        }
+    }
+
+    *_num_children = num_children;
+}
+
+/* Serves the requests the backend passes over the socket on stdin. Each
+ * request comes with the child ends of a pair of pipes. The worker forks
+ * a process which continues as a regular krb5_child on those pipes, i.e.
+ * this function only returns in the request processes. The worker itself
+ * exits once the backend closes the socket and all requests finished. */
+/* The krb5 context is created again when the krb5 configuration changed
+ * since it was created, e.g. after the domain mappings were updated. */
+static errno_t k5c_worker_init_ctx(time_t *_config_mtime)
+{
+    krb5_error_code kerr;
+    time_t config_mtime;
+    errno_t ret;
+
+    ret = krb5_child_worker_config_mtime(&config_mtime);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (k5c_worker_ctx != NULL) {
+        if (config_mtime == *_config_mtime) {
+            return EOK;
+        }
+
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "krb5 configuration changed, reloading the krb5 context.\n");
+        krb5_free_context(k5c_worker_ctx);
+        k5c_worker_ctx = NULL;
+    }
+
+    kerr = krb5_init_context(&k5c_worker_ctx);
+    if (kerr != 0) {
+        KRB5_CHILD_DEBUG(SSSDBG_CRIT_FAILURE, kerr);
+        return EIO;
+    }
+
+    *_config_mtime = config_mtime;
+
+    return EOK;
+}
+
+static void k5c_worker_loop(int timeout)
+{
+    struct k5c_worker_child *children = NULL;
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    size_t num_children = 0;
+    bool retired = false;
+    time_t config_mtime = 0;
+    int in_fd;
+    int out_fd;
+    pid_t pid;
+    errno_t ret;
+
+    ret = krb5_child_worker_save_env(NULL, &k5c_worker_env);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "krb5_child_worker_save_env failed.\n");
+        exit(-1);
+    }
+
+    ret = k5c_worker_init_ctx(&config_mtime);
+    if (ret != EOK) {
+        exit(-1);
+    }
+
+    while (!retired || num_children > 0) {
+        k5c_worker_reap(children, &num_children, timeout);
+
+        ret = poll(&pfd, retired ? 0 : 1, K5C_WORKER_POLL_MS);
+        if (ret == -1) {
+            ret = errno;
+            if (ret != EINTR) {
+                DEBUG(SSSDBG_CRIT_FAILURE,
+                      "poll failed [%d][%s].\n", ret, strerror(ret));
+                retired = true;
+            }
+            continue;
+        } else if (ret == 0) {
+            continue;
+        }
+
+        ret = krb5_child_worker_recv_fds(STDIN_FILENO, &in_fd, &out_fd);
+        if (ret == EINTR || ret == EAGAIN || ret == EINVAL) {
+            continue;
+        } else if (ret != EOK) {
+            DEBUG(ret == ENOTCONN ? SSSDBG_TRACE_FUNC : SSSDBG_CRIT_FAILURE,
+                  "Worker retired [%d][%s].\n", ret, sss_strerror(ret));
+            retired = true;
+            continue;
+        }
+
+        children = talloc_realloc(NULL, children, struct k5c_worker_child,
+                                  num_children + 1);
+        if (children == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "talloc_realloc failed.\n");
+            exit(-1);
+        }
+
+        ret = k5c_worker_init_ctx(&config_mtime);
+        if (ret != EOK) {
+            /* the backend sees the closed pipes and fails the request */
+            close(in_fd);
+            close(out_fd);
+            exit(-1);
+        }
+
+        pid = fork();
+        if (pid == 0) {
+            talloc_free(children);
+
+            ret = krb5_child_worker_reset_request(k5c_worker_ctx,
+                                                  k5c_worker_env);
+            if (ret != EOK) {
+                _exit(-1);
+            }
+
+            if (dup2(in_fd, STDIN_FILENO) == -1
+                    || dup2(out_fd, STDOUT_FILENO) == -1) {
+                ret = errno;
+                DEBUG(SSSDBG_CRIT_FAILURE,
+                      "dup2 failed [%d][%s].\n", ret, strerror(ret));
+                _exit(-1);
+            }
+            close(in_fd);
+            close(out_fd);
+            return;
+        }
+
+        /* If fork() failed the backend sees the closed pipes and fails
+         * the request. */
+        close(in_fd);
+        close(out_fd);
+        if (pid == -1) {
+            ret = errno;
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "fork failed [%d][%s].\n", ret, strerror(ret));
+            continue;
+        }
+
+        children[num_children].pid = pid;
+        children[num_children].started = time(NULL);
+        num_children++;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "krb5_child worker finished.\n");
+    talloc_free(children);
+    talloc_free(k5c_worker_env);
+    krb5_free_context(k5c_worker_ctx);
+    exit(0);
+}
+
 static krb5_error_code privileged_krb5_setup(struct krb5_req *kr,
                                              uint32_t offline)
 {
@@ -3170,10 +3385,16 @@ static krb5_error_code privileged_krb5_setup(struct krb5_req *kr,
         DEBUG(SSSDBG_MINOR_FAILURE, "Realm not available.\n");
     }
 
-    kerr = krb5_init_context(&kr->ctx);
-    if (kerr != 0) {
-        KRB5_CHILD_DEBUG(SSSDBG_CRIT_FAILURE, kerr);
-        return kerr;
+    if (k5c_worker_ctx != NULL) {
+        /* forked from a worker, the context is already set up */
+        kr->ctx = k5c_worker_ctx;
+        k5c_worker_ctx = NULL;
+    } else {
+        kerr = krb5_init_context(&kr->ctx);
+        if (kerr != 0) {
+            KRB5_CHILD_DEBUG(SSSDBG_CRIT_FAILURE, kerr);
+            return kerr;
+        }
     }
 
     kerr = sss_krb5_get_init_creds_opt_alloc(kr->ctx, &kr->options);
@@ -3189,8 +3410,9 @@ static krb5_error_code privileged_krb5_setup(struct krb5_req *kr,
     }
 
     /* For ccache types FILE: and DIR: we might need to create some directory
-     * components as root. Cache files are not needed during preauth. */
-    if (kr->pd->cmd != SSS_PAM_PREAUTH) {
+     * components as root. Cache files are not needed during preauth and
+     * the refresh of the FAST armor ccache. */
+    if (kr->pd->cmd != SSS_PAM_PREAUTH && kr->pd->cmd != SSS_CMD_FAST_ARMOR) {
         ret = k5c_ccache_setup(kr, offline);
         if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE, "k5c_ccache_setup failed.\n");
@@ -3267,6 +3489,7 @@ int main(int argc, const char *argv[])
     gid_t fast_gid = 0;
     struct cli_opts cli_opts = { 0 };
     int sss_creds_password = 0;
+    int worker_timeout = 0;
 
     struct poptOption long_options[] = {
         POPT_AUTOHELP
@@ -3301,6 +3524,8 @@ int main(int argc, const char *argv[])
          _("Requests canonicalization of the principal name"), NULL},
         {CHILD_OPT_SSS_CREDS_PASSWORD, 0, POPT_ARG_NONE, &sss_creds_password,
          0, _("Use custom version of krb5_get_init_creds_password"), NULL},
+        {CHILD_OPT_WORKER_TIMEOUT, 0, POPT_ARG_INT, &worker_timeout, 0,
+         _("Serve requests as a worker with the given timeout"), NULL},
         POPT_TABLEEND
     };
 
@@ -3347,6 +3572,20 @@ int main(int argc, const char *argv[])
 
     DEBUG(SSSDBG_TRACE_FUNC, "krb5_child started.\n");
 
+    if (worker_timeout > 0) {
+        k5c_worker_loop(worker_timeout);
+
+        /* request process forked by the worker */
+        talloc_free(discard_const(debug_prg_name));
+        debug_prg_name = talloc_asprintf(NULL, "krb5_child[%d]", getpid());
+        if (debug_prg_name == NULL) {
+            debug_prg_name = "krb5_child";
+            DEBUG(SSSDBG_CRIT_FAILURE, "talloc_asprintf failed.\n");
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
     kr = talloc_zero(NULL, struct krb5_req);
     if (kr == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
@@ -3444,6 +3683,15 @@ int main(int argc, const char *argv[])
     case SSS_PAM_PREAUTH:
         ret = tgt_req_child(kr);
         break;
+    case SSS_CMD_FAST_ARMOR:
+        if (offline || kr->fast_val == K5C_FAST_NEVER) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "FAST armor ccache not refreshed\n");
+            ret = offline ? KRB5_KDC_UNREACH : EINVAL;
+            goto done;
+        }
+        /* privileged_krb5_setup() already refreshed the ccache */
+        ret = EOK;
+        break;
     default:
         DEBUG(SSSDBG_CRIT_FAILURE,
               "PAM command [%d] not supported.\n", kr->pd->cmd);
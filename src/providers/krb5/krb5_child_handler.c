@@ -23,11 +23,15 @@
 */
 
 #include <signal.h>
+#include <fcntl.h>
+#include <sys/socket.h>
 
 #include "util/util.h"
+#include "util/probes.h"
 #include "util/child_common.h"
 #include "providers/krb5/krb5_common.h"
 #include "providers/krb5/krb5_auth.h"
+#include "providers/krb5/krb5_child_worker.h"
 #include "src/providers/krb5/krb5_utils.h"
 
 #ifndef KRB5_CHILD_DIR
@@ -53,6 +57,13 @@ struct handle_child_state {
     pid_t child_pid;
 
     struct child_io_fds *io;
+
+    /* the request sent to krb5_child */
+    struct io_buffer *send_buf;
+    /* set while the request waits for krb5_child_max_concurrent */
+    struct krb5_child_waiter *waiter;
+    /* set while the request counts towards krb5_child_max_concurrent */
+    struct krb5_child_slot *slot;
 };
 
 static errno_t pack_authtok(struct io_buffer *buf, size_t *rp,
@@ -270,12 +281,16 @@ static void krb5_child_timeout(struct tevent_context *ev,
            "is slow you may consider increasing value of krb5_auth_timeout.\n",
            state->child_pid);
 
-    ret = kill(state->child_pid, SIGKILL);
-    if (ret == -1) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "kill failed [%d][%s].\n", errno, strerror(errno));
+    /* Requests served by a worker are killed by the worker itself */
+    if (state->child_pid != -1) {
+        ret = kill(state->child_pid, SIGKILL);
+        if (ret == -1) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "kill failed [%d][%s].\n", errno, strerror(errno));
+        }
     }
 
+    talloc_zfree(state->slot);
     tevent_req_error(req, ETIMEDOUT);
 }
 
@@ -429,6 +444,386 @@ done:
     return ret;
 }
 
+/* Long-lived krb5_child processes started with --worker-timeout. Each of
+ * them runs privileged and forks a process per request, which drops to the
+ * user's IDs and talks to the backend over the usual pair of pipes. */
+struct krb5_child_worker {
+    struct krb5_child_worker *prev;
+    struct krb5_child_worker *next;
+
+    struct krb5_child_pool *pool;
+    pid_t pid;
+    int sock_fd;
+    int num_requests;
+    bool retired;
+    /* the command line options the worker was started with */
+    const char *args;
+};
+
+struct krb5_child_pool {
+    struct tevent_context *ev;
+    struct krb5_child_worker *workers;
+    int num_workers;
+};
+
+static int krb5_child_worker_destructor(struct krb5_child_worker *worker)
+{
+    PIPE_FD_CLOSE(worker->sock_fd);
+    return 0;
+}
+
+/* The worker exits on its own once it sees the closed socket and the
+ * requests it still serves are finished. */
+static void krb5_child_worker_retire(struct krb5_child_worker *worker)
+{
+    if (worker->retired) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Retiring krb5_child worker [%d] after [%d] requests.\n",
+          worker->pid, worker->num_requests);
+
+    worker->retired = true;
+    DLIST_REMOVE(worker->pool->workers, worker);
+    worker->pool->num_workers--;
+    PIPE_FD_CLOSE(worker->sock_fd);
+}
+
+/* A worker which exited while it was in use is replaced by a new one with
+ * the next request. */
+static void krb5_child_worker_exited(int child_status,
+                                     struct tevent_signal *sige,
+                                     void *pvt)
+{
+    struct krb5_child_worker *worker;
+
+    worker = talloc_get_type(pvt, struct krb5_child_worker);
+
+    if (!worker->retired) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "krb5_child worker [%d] exited unexpectedly.\n", worker->pid);
+        krb5_child_worker_retire(worker);
+    }
+
+    talloc_free(worker);
+}
+
+/* The options of a new krb5_child with --worker-timeout added. They are
+ * also returned as a single string to recognize the workers which were
+ * started with other options. */
+static errno_t krb5_child_worker_args(TALLOC_CTX *mem_ctx,
+                                      struct krb5_ctx *krb5_ctx,
+                                      const char ***_args,
+                                      char **_args_str)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char **extra_args;
+    const char **args;
+    char *args_str;
+    size_t c;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = set_extra_args(tmp_ctx, krb5_ctx, &extra_args);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "set_extra_args failed.\n");
+        goto done;
+    }
+
+    for (c = 0; extra_args[c] != NULL; c++);
+
+    args = talloc_zero_array(tmp_ctx, const char *, c + 2);
+    if (args == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    memcpy(args, extra_args, c * sizeof(const char *));
+    talloc_steal(args, extra_args);
+
+    args[c] = talloc_asprintf(args, "--"CHILD_OPT_WORKER_TIMEOUT"=%d",
+                              dp_opt_get_int(krb5_ctx->opts,
+                                             KRB5_AUTH_TIMEOUT));
+    if (args[c] == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    args_str = talloc_strdup(tmp_ctx, "");
+    for (c = 0; args_str != NULL && args[c] != NULL; c++) {
+        args_str = talloc_asprintf_append(args_str, "%s ", args[c]);
+    }
+    if (args_str == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    *_args = talloc_steal(mem_ctx, args);
+    *_args_str = talloc_steal(mem_ctx, args_str);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t krb5_child_worker_start(struct krb5_child_pool *pool,
+                                       const char **args,
+                                       const char *args_str,
+                                       struct krb5_child_worker **_worker)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct krb5_child_worker *worker;
+    int sv[2] = PIPE_INIT;
+    int worker_in[2];
+    int worker_out[2];
+    pid_t pid;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    worker = talloc_zero(tmp_ctx, struct krb5_child_worker);
+    if (worker == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    worker->pool = pool;
+    worker->sock_fd = -1;
+    talloc_set_destructor(worker, krb5_child_worker_destructor);
+
+    worker->args = talloc_strdup(worker, args_str);
+    if (worker->args == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "socketpair failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+
+    pid = fork();
+
+    if (pid == 0) { /* child */
+        /* The worker reads the requests from and writes to its end of the
+         * socket, so it is used as both stdin and stdout. */
+        worker_in[0] = sv[1];
+        worker_in[1] = sv[0];
+        worker_out[0] = sv[0];
+        worker_out[1] = sv[1];
+
+        exec_child_ex(tmp_ctx,
+                      worker_in, worker_out,
+                      KRB5_CHILD, KRB5_CHILD_LOG_FILE,
+                      args, false,
+                      STDIN_FILENO, STDOUT_FILENO);
+
+        /* We should never get here */
+        DEBUG(SSSDBG_CRIT_FAILURE, "BUG: Could not exec KRB5 child\n");
+    } else if (pid == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "fork failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+
+    worker->pid = pid;
+    worker->sock_fd = sv[0];
+    sv[0] = -1;
+
+    ret = child_handler_setup(pool->ev, pid, krb5_child_worker_exited,
+                              worker, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Could not set up child signal handler\n");
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Started krb5_child worker [%d].\n", pid);
+
+    DLIST_ADD_END(pool->workers, worker, struct krb5_child_worker *);
+    pool->num_workers++;
+    *_worker = talloc_steal(pool, worker);
+
+    ret = EOK;
+
+done:
+    PIPE_CLOSE(sv);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t krb5_child_pool_get_worker(struct krb5_ctx *krb5_ctx,
+                                          struct krb5_child_worker **_worker)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct krb5_child_pool *pool = krb5_ctx->child_pool;
+    struct krb5_child_worker *worker;
+    struct krb5_child_worker *next;
+    const char **args;
+    char *args_str;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = krb5_child_worker_args(tmp_ctx, krb5_ctx, &args, &args_str);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* The configuration changed since these workers were started, they
+     * only finish the requests they already have. */
+    DLIST_FOR_EACH_SAFE(worker, next, pool->workers) {
+        if (strcmp(worker->args, args_str) != 0) {
+            DEBUG(SSSDBG_TRACE_FUNC,
+                  "Options of krb5_child changed.\n");
+            krb5_child_worker_retire(worker);
+        }
+    }
+
+    if (pool->num_workers < dp_opt_get_int(krb5_ctx->opts,
+                                          KRB5_CHILD_POOL_SIZE)) {
+        ret = krb5_child_worker_start(pool, args, args_str, _worker);
+        goto done;
+    }
+
+    /* hand out the workers in turn */
+    worker = pool->workers;
+    DLIST_REMOVE(pool->workers, worker);
+    DLIST_ADD_END(pool->workers, worker, struct krb5_child_worker *);
+
+    *_worker = worker;
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+errno_t krb5_child_pool_pass_fds(struct krb5_ctx *krb5_ctx,
+                                 struct tevent_context *ev,
+                                 int in_fd, int out_fd)
+{
+    struct krb5_child_worker *worker;
+    int max_requests;
+    errno_t ret;
+
+    if (krb5_ctx->child_pool == NULL) {
+        krb5_ctx->child_pool = talloc_zero(krb5_ctx, struct krb5_child_pool);
+        if (krb5_ctx->child_pool == NULL) {
+            return ENOMEM;
+        }
+        krb5_ctx->child_pool->ev = ev;
+    }
+
+    ret = krb5_child_pool_get_worker(krb5_ctx, &worker);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "No krb5_child worker available.\n");
+        return ret;
+    }
+
+    ret = krb5_child_worker_send_fds(worker->sock_fd, in_fd, out_fd);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Unable to pass the request to krb5_child worker [%d] "
+              "[%d][%s].\n", worker->pid, ret, strerror(ret));
+        krb5_child_worker_retire(worker);
+        return ret;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "Request passed to krb5_child worker [%d].\n", worker->pid);
+
+    worker->num_requests++;
+    max_requests = dp_opt_get_int(krb5_ctx->opts,
+                                  KRB5_CHILD_POOL_MAX_REQUESTS);
+    if (max_requests > 0 && worker->num_requests >= max_requests) {
+        krb5_child_worker_retire(worker);
+    }
+
+    return EOK;
+}
+
+int krb5_child_pool_num_workers(struct krb5_ctx *krb5_ctx)
+{
+    if (krb5_ctx->child_pool == NULL) {
+        return 0;
+    }
+
+    return krb5_ctx->child_pool->num_workers;
+}
+
+static errno_t krb5_child_pool_run(struct tevent_req *req)
+{
+    int pipefd_to_child[2] = PIPE_INIT;
+    int pipefd_from_child[2] = PIPE_INIT;
+    struct krb5_ctx *krb5_ctx;
+    errno_t ret;
+    struct handle_child_state *state = tevent_req_data(req,
+                                                     struct handle_child_state);
+
+    krb5_ctx = state->kr->krb5_ctx;
+
+    /* Only the worker may hold the child ends, they must not leak into
+     * other children started meanwhile. */
+    ret = pipe2(pipefd_from_child, O_CLOEXEC);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "pipe (from) failed [%d][%s].\n", errno, strerror(errno));
+        goto fail;
+    }
+    ret = pipe2(pipefd_to_child, O_CLOEXEC);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "pipe (to) failed [%d][%s].\n", errno, strerror(errno));
+        goto fail;
+    }
+
+    ret = krb5_child_pool_pass_fds(krb5_ctx, state->ev, pipefd_to_child[0],
+                                   pipefd_from_child[1]);
+    if (ret != EOK) {
+        goto fail;
+    }
+
+    /* the request process is forked by the worker */
+    state->child_pid = -1;
+    state->io->read_from_child_fd = pipefd_from_child[0];
+    PIPE_FD_CLOSE(pipefd_from_child[1]);
+    state->io->write_to_child_fd = pipefd_to_child[1];
+    PIPE_FD_CLOSE(pipefd_to_child[0]);
+    sss_fd_nonblocking(state->io->read_from_child_fd);
+    sss_fd_nonblocking(state->io->write_to_child_fd);
+
+    ret = activate_child_timeout_handler(req, state->ev,
+                  dp_opt_get_int(krb5_ctx->opts, KRB5_AUTH_TIMEOUT));
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "activate_child_timeout_handler failed.\n");
+    }
+
+    return EOK;
+
+fail:
+    PIPE_CLOSE(pipefd_from_child);
+    PIPE_CLOSE(pipefd_to_child);
+    return ret;
+}
+
 static errno_t fork_child(struct tevent_req *req)
 {
     int pipefd_to_child[2] = PIPE_INIT;
@@ -439,6 +834,16 @@ static errno_t fork_child(struct tevent_req *req)
     struct handle_child_state *state = tevent_req_data(req,
                                                      struct handle_child_state);
 
+    if (dp_opt_get_int(state->kr->krb5_ctx->opts, KRB5_CHILD_POOL_SIZE) > 0) {
+        ret = krb5_child_pool_run(req);
+        if (ret == EOK) {
+            return EOK;
+        }
+
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "krb5_child pool failed, forking a single krb5_child.\n");
+    }
+
     ret = set_extra_args(state, state->kr->krb5_ctx, &krb5_child_extra_args);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "set_extra_args failed.\n");
@@ -460,47 +865,39 @@ static errno_t fork_child(struct tevent_req *req)
         goto fail;
     }
 
-    pid = fork();
-
-    if (pid == 0) { /* child */
-        exec_child_ex(state,
-                      pipefd_to_child, pipefd_from_child,
-                      KRB5_CHILD, KRB5_CHILD_LOG_FILE,
-                      krb5_child_extra_args, false,
-                      STDIN_FILENO, STDOUT_FILENO);
-
-        /* We should never get here */
-        DEBUG(SSSDBG_CRIT_FAILURE, "BUG: Could not exec KRB5 child\n");
-    } else if (pid > 0) { /* parent */
-        state->child_pid = pid;
-        state->io->read_from_child_fd = pipefd_from_child[0];
-        PIPE_FD_CLOSE(pipefd_from_child[1]);
-        state->io->write_to_child_fd = pipefd_to_child[1];
-        PIPE_FD_CLOSE(pipefd_to_child[0]);
-        sss_fd_nonblocking(state->io->read_from_child_fd);
-        sss_fd_nonblocking(state->io->write_to_child_fd);
-
-        ret = child_handler_setup(state->ev, pid, NULL, NULL, NULL);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Could not set up child signal handler\n");
-            goto fail;
-        }
+    ret = sss_child_spawn(state,
+                          pipefd_to_child, pipefd_from_child,
+                          KRB5_CHILD, KRB5_CHILD_LOG_FILE,
+                          krb5_child_extra_args, false,
+                          STDIN_FILENO, STDOUT_FILENO, &pid);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not start KRB5 child\n");
+        goto fail;
+    }
 
-        ret = activate_child_timeout_handler(req, state->ev,
-                  dp_opt_get_int(state->kr->krb5_ctx->opts, KRB5_AUTH_TIMEOUT));
-        if (ret != EOK) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "activate_child_timeout_handler failed.\n");
-        }
+    PROBE(KRB5_CHILD_SPAWN, pid, 0);
+    state->child_pid = pid;
+    state->io->read_from_child_fd = pipefd_from_child[0];
+    PIPE_FD_CLOSE(pipefd_from_child[1]);
+    state->io->write_to_child_fd = pipefd_to_child[1];
+    PIPE_FD_CLOSE(pipefd_to_child[0]);
+    sss_fd_nonblocking(state->io->read_from_child_fd);
+    sss_fd_nonblocking(state->io->write_to_child_fd);
 
-    } else { /* error */
-        ret = errno;
+    ret = child_handler_setup(state->ev, pid, NULL, NULL, NULL);
+    if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
-              "fork failed [%d][%s].\n", errno, strerror(ret));
+              "Could not set up child signal handler\n");
         goto fail;
     }
 
+    ret = activate_child_timeout_handler(req, state->ev,
+              dp_opt_get_int(state->kr->krb5_ctx->opts, KRB5_AUTH_TIMEOUT));
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "activate_child_timeout_handler failed.\n");
+    }
+
     return EOK;
 
 fail:
@@ -512,14 +909,287 @@ fail:
 static void handle_child_step(struct tevent_req *subreq);
 static void handle_child_done(struct tevent_req *subreq);
 
+/* A login storm would start a krb5_child for every user at once, which
+ * then compete for the CPU and the KDC until they time out. With
+ * krb5_child_max_concurrent only that many requests run at the same time.
+ * The others wait in a queue of each user and the users are served in
+ * turn, so that e.g. the ticket renewals of one user do not delay the
+ * logins of the others. The requests of one user are still serialized by
+ * the wait queue of krb5_auth_queue_send() before they get here. */
+struct krb5_child_limit {
+    struct tevent_context *ev;
+    struct krb5_ctx *krb5_ctx;
+    struct tevent_immediate *imm;
+    bool scheduled;
+
+    int running;
+    struct krb5_child_user_queue *users;
+
+    /* queue time of the requests that had to wait */
+    uint64_t num_waited;
+    uint64_t total_wait_usec;
+    uint64_t max_wait_usec;
+};
+
+struct krb5_child_user_queue {
+    struct krb5_child_user_queue *prev;
+    struct krb5_child_user_queue *next;
+
+    struct krb5_child_limit *limit;
+    const char *user;
+    struct krb5_child_waiter *waiters;
+};
+
+struct krb5_child_waiter {
+    struct krb5_child_waiter *prev;
+    struct krb5_child_waiter *next;
+
+    struct krb5_child_user_queue *uq;
+    struct tevent_req *req;
+    struct timeval queued;
+};
+
+struct krb5_child_slot {
+    struct krb5_child_limit *limit;
+};
+
+static void krb5_child_limit_dispatch(struct tevent_context *ev,
+                                      struct tevent_immediate *imm,
+                                      void *pvt);
+
+static void krb5_child_limit_schedule(struct krb5_child_limit *limit)
+{
+    if (limit->scheduled || limit->users == NULL) {
+        return;
+    }
+
+    tevent_schedule_immediate(limit->imm, limit->ev,
+                              krb5_child_limit_dispatch, limit);
+    limit->scheduled = true;
+}
+
+static int krb5_child_slot_destructor(struct krb5_child_slot *slot)
+{
+    slot->limit->running--;
+    krb5_child_limit_schedule(slot->limit);
+    return 0;
+}
+
+static int krb5_child_waiter_destructor(struct krb5_child_waiter *waiter)
+{
+    struct krb5_child_user_queue *uq = waiter->uq;
+
+    DLIST_REMOVE(uq->waiters, waiter);
+    if (uq->waiters == NULL) {
+        DLIST_REMOVE(uq->limit->users, uq);
+        talloc_free(uq);
+    }
+
+    return 0;
+}
+
+static struct krb5_child_limit *krb5_child_get_limit(struct krb5_ctx *krb5_ctx,
+                                                     struct tevent_context *ev)
+{
+    struct krb5_child_limit *limit;
+
+    if (krb5_ctx->child_limit != NULL) {
+        return krb5_ctx->child_limit;
+    }
+
+    limit = talloc_zero(krb5_ctx, struct krb5_child_limit);
+    if (limit == NULL) {
+        return NULL;
+    }
+    limit->ev = ev;
+    limit->krb5_ctx = krb5_ctx;
+
+    limit->imm = tevent_create_immediate(limit);
+    if (limit->imm == NULL) {
+        talloc_free(limit);
+        return NULL;
+    }
+
+    krb5_ctx->child_limit = limit;
+    return limit;
+}
+
+static errno_t handle_child_run(struct tevent_req *req,
+                                struct krb5_child_limit *limit)
+{
+    struct handle_child_state *state = tevent_req_data(req,
+                                                     struct handle_child_state);
+    struct tevent_req *subreq;
+    errno_t ret;
+
+    if (limit != NULL) {
+        state->slot = talloc_zero(state, struct krb5_child_slot);
+        if (state->slot == NULL) {
+            return ENOMEM;
+        }
+        state->slot->limit = limit;
+        limit->running++;
+        talloc_set_destructor(state->slot, krb5_child_slot_destructor);
+    }
+
+    ret = fork_child(req);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "fork_child failed.\n");
+        goto done;
+    }
+
+    subreq = write_pipe_send(state, state->ev, state->send_buf->data,
+                             state->send_buf->size,
+                             state->io->write_to_child_fd);
+    if (!subreq) {
+        ret = ENOMEM;
+        goto done;
+    }
+    tevent_req_set_callback(subreq, handle_child_step, req);
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_zfree(state->slot);
+    }
+
+    return ret;
+}
+
+static void krb5_child_limit_dispatch(struct tevent_context *ev,
+                                      struct tevent_immediate *imm,
+                                      void *pvt)
+{
+    struct krb5_child_limit *limit;
+    struct krb5_child_user_queue *uq;
+    struct krb5_child_waiter *waiter;
+    struct handle_child_state *state;
+    struct tevent_req *req;
+    struct timeval now;
+    struct timeval waited;
+    uint64_t wait_usec;
+    int max_concurrent;
+    errno_t ret;
+
+    limit = talloc_get_type(pvt, struct krb5_child_limit);
+    limit->scheduled = false;
+
+    max_concurrent = dp_opt_get_int(limit->krb5_ctx->opts,
+                                    KRB5_CHILD_MAX_CONCURRENT);
+
+    while (limit->users != NULL
+            && (max_concurrent <= 0 || limit->running < max_concurrent)) {
+        uq = limit->users;
+        waiter = uq->waiters;
+        req = waiter->req;
+
+        /* the next request of this user waits for the other users */
+        if (waiter->next != NULL) {
+            DLIST_DEMOTE(limit->users, uq, struct krb5_child_user_queue *);
+        }
+
+        now = tevent_timeval_current();
+        waited = tevent_timeval_until(&waiter->queued, &now);
+        wait_usec = waited.tv_sec * 1000000ULL + waited.tv_usec;
+        limit->num_waited++;
+        limit->total_wait_usec += wait_usec;
+        limit->max_wait_usec = MAX(limit->max_wait_usec, wait_usec);
+
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "krb5_child request of [%s] waited %"PRIu64" ms, "
+              "%"PRIu64" requests waited %"PRIu64" ms on average and "
+              "%"PRIu64" ms at most.\n",
+              uq->user, wait_usec / 1000, limit->num_waited,
+              limit->total_wait_usec / limit->num_waited / 1000,
+              limit->max_wait_usec / 1000);
+
+        state = tevent_req_data(req, struct handle_child_state);
+        talloc_zfree(state->waiter);
+
+        ret = handle_child_run(req, limit);
+        if (ret != EOK) {
+            tevent_req_error(req, ret);
+        }
+    }
+}
+
+static errno_t handle_child_queue(struct tevent_req *req)
+{
+    struct handle_child_state *state = tevent_req_data(req,
+                                                     struct handle_child_state);
+    struct krb5_ctx *krb5_ctx = state->kr->krb5_ctx;
+    struct krb5_child_limit *limit;
+    struct krb5_child_user_queue *uq;
+    struct krb5_child_waiter *waiter;
+    const char *user;
+    int max_concurrent;
+
+    max_concurrent = dp_opt_get_int(krb5_ctx->opts, KRB5_CHILD_MAX_CONCURRENT);
+    if (max_concurrent <= 0) {
+        return handle_child_run(req, NULL);
+    }
+
+    limit = krb5_child_get_limit(krb5_ctx, state->ev);
+    if (limit == NULL) {
+        return ENOMEM;
+    }
+
+    if (limit->running < max_concurrent && limit->users == NULL) {
+        return handle_child_run(req, limit);
+    }
+
+    user = state->kr->pd->user != NULL ? state->kr->pd->user : "";
+
+    DLIST_FOR_EACH(uq, limit->users) {
+        if (strcmp(uq->user, user) == 0) {
+            break;
+        }
+    }
+
+    if (uq == NULL) {
+        uq = talloc_zero(limit, struct krb5_child_user_queue);
+        if (uq == NULL) {
+            return ENOMEM;
+        }
+        uq->limit = limit;
+        uq->user = talloc_strdup(uq, user);
+        if (uq->user == NULL) {
+            talloc_free(uq);
+            return ENOMEM;
+        }
+        DLIST_ADD_END(limit->users, uq, struct krb5_child_user_queue *);
+    }
+
+    waiter = talloc_zero(state, struct krb5_child_waiter);
+    if (waiter == NULL) {
+        if (uq->waiters == NULL) {
+            DLIST_REMOVE(limit->users, uq);
+            talloc_free(uq);
+        }
+        return ENOMEM;
+    }
+    waiter->uq = uq;
+    waiter->req = req;
+    waiter->queued = tevent_timeval_current();
+    DLIST_ADD_END(uq->waiters, waiter, struct krb5_child_waiter *);
+    talloc_set_destructor(waiter, krb5_child_waiter_destructor);
+    state->waiter = waiter;
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "%d krb5_child requests are running, queueing the request "
+          "of [%s].\n", limit->running, user);
+
+    return EOK;
+}
+
 struct tevent_req *handle_child_send(TALLOC_CTX *mem_ctx,
                                      struct tevent_context *ev,
                                      struct krb5child_req *kr)
 {
-    struct tevent_req *req, *subreq;
+    struct tevent_req *req;
     struct handle_child_state *state;
     int ret;
-    struct io_buffer *buf = NULL;
 
     req = tevent_req_create(mem_ctx, &state, struct handle_child_state);
     if (req == NULL) {
@@ -543,25 +1213,16 @@ struct tevent_req *handle_child_send(TALLOC_CTX *mem_ctx,
     state->io->read_from_child_fd = -1;
     talloc_set_destructor((void *) state->io, child_io_destructor);
 
-    ret = create_send_buffer(kr, &buf);
+    ret = create_send_buffer(kr, &state->send_buf);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "create_send_buffer failed.\n");
         goto fail;
     }
 
-    ret = fork_child(req);
+    ret = handle_child_queue(req);
     if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "fork_child failed.\n");
-        goto fail;
-    }
-
-    subreq = write_pipe_send(state, ev, buf->data, buf->size,
-                             state->io->write_to_child_fd);
-    if (!subreq) {
-        ret = ENOMEM;
         goto fail;
     }
-    tevent_req_set_callback(subreq, handle_child_step, req);
 
     return req;
 
@@ -582,6 +1243,7 @@ static void handle_child_step(struct tevent_req *subreq)
     ret = write_pipe_recv(subreq);
     talloc_zfree(subreq);
     if (ret != EOK) {
+        talloc_zfree(state->slot);
         tevent_req_error(req, ret);
         return;
     }
@@ -605,6 +1267,7 @@ static void handle_child_done(struct tevent_req *subreq)
     int ret;
 
     talloc_zfree(state->timeout_handler);
+    talloc_zfree(state->slot);
 
     ret = read_pipe_recv(subreq, state, &state->buf, &state->len);
     talloc_zfree(subreq);
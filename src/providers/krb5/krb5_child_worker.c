@@ -0,0 +1,203 @@
+/*
+    SSSD
+
+    Kerberos 5 Backend Module -- krb5_child workers
+
+    Copyright (C) 2026 Red Hat
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "util/util.h"
+#include "providers/krb5/krb5_child_worker.h"
+
+extern char **environ;
+
+errno_t krb5_child_worker_send_fds(int sock, int in_fd, int out_fd)
+{
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+    } cbuf;
+    struct msghdr msg = { 0 };
+    struct cmsghdr *cmsg;
+    struct iovec iov;
+    int fds[2] = { in_fd, out_fd };
+    ssize_t len;
+    char c = 0;
+
+    memset(&cbuf, 0, sizeof(cbuf));
+
+    iov.iov_base = &c;
+    iov.iov_len = sizeof(c);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf.buf;
+    msg.msg_controllen = sizeof(cbuf.buf);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    len = sendmsg(sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (len == -1) {
+        return errno;
+    } else if (len != sizeof(c)) {
+        return EIO;
+    }
+
+    return EOK;
+}
+
+errno_t krb5_child_worker_recv_fds(int sock, int *_in_fd, int *_out_fd)
+{
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+    } cbuf;
+    struct msghdr msg = { 0 };
+    struct cmsghdr *cmsg;
+    struct iovec iov;
+    int fds[2];
+    ssize_t len;
+    char c;
+
+    iov.iov_base = &c;
+    iov.iov_len = sizeof(c);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf.buf;
+    msg.msg_controllen = sizeof(cbuf.buf);
+
+    len = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if (len == -1) {
+        return errno;
+    } else if (len == 0) {
+        /* the backend retired this worker */
+        return ENOTCONN;
+    }
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL
+            || cmsg->cmsg_level != SOL_SOCKET
+            || cmsg->cmsg_type != SCM_RIGHTS
+            || cmsg->cmsg_len != CMSG_LEN(sizeof(fds))) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Malformed worker request.\n");
+        return EINVAL;
+    }
+
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    *_in_fd = fds[0];
+    *_out_fd = fds[1];
+
+    return EOK;
+}
+
+errno_t krb5_child_worker_save_env(TALLOC_CTX *mem_ctx, char ***_env)
+{
+    char **env;
+    size_t c;
+
+    for (c = 0; environ != NULL && environ[c] != NULL; c++);
+
+    env = talloc_zero_array(mem_ctx, char *, c + 1);
+    if (env == NULL) {
+        return ENOMEM;
+    }
+
+    for (c = 0; environ != NULL && environ[c] != NULL; c++) {
+        env[c] = talloc_strdup(env, environ[c]);
+        if (env[c] == NULL) {
+            talloc_free(env);
+            return ENOMEM;
+        }
+    }
+
+    *_env = env;
+
+    return EOK;
+}
+
+errno_t krb5_child_worker_reset_request(krb5_context ctx, char **env)
+{
+    krb5_error_code kerr;
+    size_t c;
+    errno_t ret;
+
+    ret = clearenv();
+    if (ret != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "clearenv failed.\n");
+        return EIO;
+    }
+
+    /* the request process exits before the worker frees env */
+    for (c = 0; env[c] != NULL; c++) {
+        ret = putenv(env[c]);
+        if (ret != 0) {
+            ret = errno;
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "putenv failed [%d][%s].\n", ret, strerror(ret));
+            return ret;
+        }
+    }
+
+    kerr = krb5_cc_set_default_name(ctx, NULL);
+    if (kerr != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "krb5_cc_set_default_name failed.\n");
+        return EIO;
+    }
+
+    kerr = krb5_set_default_realm(ctx, NULL);
+    if (kerr != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "krb5_set_default_realm failed.\n");
+        return EIO;
+    }
+
+    return EOK;
+}
+
+errno_t krb5_child_worker_config_mtime(time_t *_mtime)
+{
+    const char *config;
+    struct stat sb;
+    errno_t ret;
+
+    config = getenv("KRB5_CONFIG");
+    if (config == NULL) {
+        config = KRB5_CONF_PATH;
+    }
+
+    ret = stat(config, &sb);
+    if (ret == -1) {
+        ret = errno;
+        if (ret == ENOENT) {
+            *_mtime = 0;
+            return EOK;
+        }
+
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to stat \"%s\" [%d]: %s\n",
+                                 config, ret, strerror(ret));
+        return ret;
+    }
+
+    *_mtime = sb.st_mtime;
+
+    return EOK;
+}
@@ -0,0 +1,64 @@
+/*
+    SSSD
+
+    Kerberos 5 Backend Module -- krb5_child workers
+
+    Copyright (C) 2026 Red Hat
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __KRB5_CHILD_WORKER_H__
+#define __KRB5_CHILD_WORKER_H__
+
+#ifdef HAVE_KRB5_KRB5_H
+#include <krb5/krb5.h>
+#else
+#include <krb5.h>
+#endif
+
+#include "util/util.h"
+
+struct krb5_ctx;
+struct tevent_context;
+
+/* Used by the backend and by krb5_child to pass a request, the child ends
+ * of a pair of pipes, to a worker. */
+errno_t krb5_child_worker_send_fds(int sock, int in_fd, int out_fd);
+
+errno_t krb5_child_worker_recv_fds(int sock, int *_in_fd, int *_out_fd);
+
+/* A copy of the environment the worker was started with. */
+errno_t krb5_child_worker_save_env(TALLOC_CTX *mem_ctx, char ***_env);
+
+/* Called in each request process forked by a worker, so that it starts
+ * like a krb5_child executed by the backend: the environment is the one
+ * saved by the worker and the default ccache name and realm of the
+ * inherited krb5 context are cleared. */
+errno_t krb5_child_worker_reset_request(krb5_context ctx, char **env);
+
+/* Modification time of the krb5 configuration, a worker reloads its krb5
+ * context when it changes. */
+errno_t krb5_child_worker_config_mtime(time_t *_mtime);
+
+/* The pool functions are only 'exported' to be able to call them from unit
+ * tests. The request is passed to a worker of the pool of krb5_ctx, which
+ * is started first if needed. */
+errno_t krb5_child_pool_pass_fds(struct krb5_ctx *krb5_ctx,
+                                 struct tevent_context *ev,
+                                 int in_fd, int out_fd);
+
+int krb5_child_pool_num_workers(struct krb5_ctx *krb5_ctx);
+
+#endif /* __KRB5_CHILD_WORKER_H__ */
@@ -106,7 +106,7 @@ static errno_t sss_get_system_ccname_template(TALLOC_CTX *mem_ctx,
 
     *ccname = NULL;
 
-    ret = sss_krb5_init_context(&ctx);
+    ret = sss_krb5_get_shared_context(&ctx);
     if (ret) return ret;
 
     ret = krb5_get_profile(ctx, &p);
@@ -131,7 +131,6 @@ static errno_t sss_get_system_ccname_template(TALLOC_CTX *mem_ctx,
     ret = EOK;
 
 done:
-    krb5_free_context(ctx);
     free(value);
     return ret;
 }
@@ -41,6 +41,10 @@
 #define SSS_KRB5_LOOKAHEAD_PRIMARY_DEFAULT 3
 #define SSS_KRB5_LOOKAHEAD_BACKUP_DEFAULT 1
 
+/* The backend lets krb5_child check the FAST armor ccache this often, it is
+ * renewed when it expires within two periods */
+#define KRB5_FAST_ARMOR_REFRESH_INTERVAL 300
+
 enum krb5_opts {
     KRB5_KDC = 0,
     KRB5_BACKUP_KDC,
@@ -63,6 +67,9 @@ enum krb5_opts {
     KRB5_USE_KDCINFO,
     KRB5_KDCINFO_LOOKAHEAD,
     KRB5_MAP_USER,
+    KRB5_CHILD_POOL_SIZE,
+    KRB5_CHILD_POOL_MAX_REQUESTS,
+    KRB5_CHILD_MAX_CONCURRENT,
 
     KRB5_OPTS
 };
@@ -82,6 +89,8 @@ struct krb5_service {
 struct fo_service;
 struct deferred_auth_ctx;
 struct renew_tgt_ctx;
+struct krb5_child_pool;
+struct krb5_child_limit;
 
 enum krb5_config_type {
     K5C_GENERIC,
@@ -144,6 +153,9 @@ struct krb5_ctx {
     const char *fast_principal;
 
     bool canonicalize;
+
+    struct krb5_child_pool *child_pool;
+    struct krb5_child_limit *child_limit;
 };
 
 struct remove_info_files_ctx {
@@ -0,0 +1,243 @@
+/*
+    SSSD
+
+    Kerberos 5 Backend Module -- refresh of the FAST armor ccache
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "util/util.h"
+#include "providers/be_ptask.h"
+#include "providers/krb5/krb5_common.h"
+#include "providers/krb5/krb5_auth.h"
+
+/* All krb5_child processes of a realm share the FAST armor ccache in
+ * DB_PATH, each of them copies it into memory and only uses the copy. The
+ * child which finds the armor TGT expired gets a new one from the keytab
+ * before it can send the request of its user. This task runs a krb5_child
+ * periodically which renews the TGT while it is still valid, so the
+ * requests of the users do not pay for the additional round trip to the
+ * KDC. */
+
+struct krb5_fast_armor_state {
+    struct tevent_context *ev;
+    struct be_ctx *be_ctx;
+    struct krb5_ctx *krb5_ctx;
+    struct krb5child_req *kr;
+};
+
+static void krb5_fast_armor_resolve_done(struct tevent_req *subreq);
+static void krb5_fast_armor_child_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+krb5_fast_armor_send(TALLOC_CTX *mem_ctx,
+                     struct tevent_context *ev,
+                     struct be_ctx *be_ctx,
+                     struct be_ptask *be_ptask,
+                     void *pvt)
+{
+    struct krb5_fast_armor_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct krb5_fast_armor_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+    state->ev = ev;
+    state->be_ctx = be_ctx;
+    state->krb5_ctx = talloc_get_type(pvt, struct krb5_ctx);
+
+    /* writes the kdcinfo file which tells krb5_child which KDC to use */
+    subreq = be_resolve_server_send(state, ev, be_ctx,
+                                    state->krb5_ctx->service->name, true);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto immediately;
+    }
+    tevent_req_set_callback(subreq, krb5_fast_armor_resolve_done, req);
+
+    return req;
+
+immediately:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static errno_t krb5_fast_armor_child_req(struct krb5_fast_armor_state *state,
+                                         struct fo_server *srv)
+{
+    struct krb5child_req *kr;
+    const char *realm;
+
+    realm = dp_opt_get_cstring(state->krb5_ctx->opts, KRB5_REALM);
+    if (realm == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Missing Kerberos realm.\n");
+        return EINVAL;
+    }
+
+    kr = talloc_zero(state, struct krb5child_req);
+    if (kr == NULL) {
+        return ENOMEM;
+    }
+
+    kr->pd = create_pam_data(kr);
+    if (kr->pd == NULL) {
+        talloc_free(kr);
+        return ENOMEM;
+    }
+    kr->pd->cmd = SSS_CMD_FAST_ARMOR;
+    kr->pd->user = talloc_strdup(kr->pd, "");
+
+    /* krb5_child only needs a valid principal, it does not request a ticket
+     * for it */
+    kr->upn = talloc_asprintf(kr, "krbtgt/%s@%s", realm, realm);
+    kr->ccname = "";
+    if (kr->pd->user == NULL || kr->upn == NULL) {
+        talloc_free(kr);
+        return ENOMEM;
+    }
+
+    kr->krb5_ctx = state->krb5_ctx;
+    kr->dom = state->be_ctx->domain;
+    kr->srv = srv;
+    kr->uid = geteuid();
+    kr->gid = getegid();
+
+    state->kr = kr;
+    return EOK;
+}
+
+static void krb5_fast_armor_resolve_done(struct tevent_req *subreq)
+{
+    struct krb5_fast_armor_state *state;
+    struct fo_server *srv = NULL;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct krb5_fast_armor_state);
+
+    ret = be_resolve_server_recv(subreq, state, &srv);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "No KDC to refresh the FAST armor ccache [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = krb5_fast_armor_child_req(state, srv);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    subreq = handle_child_send(state, state->ev, state->kr);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    tevent_req_set_callback(subreq, krb5_fast_armor_child_done, req);
+    return;
+
+done:
+    tevent_req_error(req, ret);
+}
+
+static void krb5_fast_armor_child_done(struct tevent_req *subreq)
+{
+    struct krb5_fast_armor_state *state;
+    struct krb5_child_response *res;
+    struct tevent_req *req;
+    uint8_t *buf = NULL;
+    ssize_t len = -1;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct krb5_fast_armor_state);
+
+    ret = handle_child_recv(subreq, state, &buf, &len);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "krb5_child failed [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = parse_krb5_child_response(state, buf, len, state->kr->pd, 0, &res);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "parse_krb5_child_response failed.\n");
+        goto done;
+    }
+
+    if (res->msg_status == ERR_NETWORK_IO) {
+        be_fo_set_port_status(state->be_ctx, state->krb5_ctx->service->name,
+                              state->kr->srv, PORT_NOT_WORKING);
+    }
+
+    ret = res->msg_status;
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Refreshing the FAST armor ccache failed [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "FAST armor ccache is valid.\n");
+
+done:
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+static errno_t krb5_fast_armor_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+errno_t krb5_fast_armor_init(struct krb5_ctx *krb5_ctx,
+                             struct be_ctx *be_ctx)
+{
+    errno_t ret;
+
+    if (!krb5_ctx->use_fast || krb5_ctx->service == NULL) {
+        return EOK;
+    }
+
+    ret = be_ptask_create(krb5_ctx, be_ctx,
+                          KRB5_FAST_ARMOR_REFRESH_INTERVAL, 10, 5, 0,
+                          KRB5_FAST_ARMOR_REFRESH_INTERVAL, 0,
+                          krb5_fast_armor_send, krb5_fast_armor_recv,
+                          krb5_ctx, "FAST armor ccache refresh",
+                          BE_PTASK_OFFLINE_DISABLE
+                              | BE_PTASK_SCHEDULE_FROM_LAST,
+                          NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to set up the refresh of the FAST armor ccache "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        return ret;
+    }
+
+    return EOK;
+}
@@ -21,6 +21,7 @@
     You should have received a copy of the GNU General Public License
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <stdlib.h>
 #include <security/pam_modules.h>
 
 #include "util/util.h"
@@ -29,6 +30,17 @@
 #include "providers/krb5/krb5_utils.h"
 #include "providers/krb5/krb5_ccache.h"
 
+/* Number of renewals which may run at the same time */
+#define RENEW_MAX_RUNNING 10
+
+/* TGTs are renewed at a random point between these fractions of their
+ * lifetime, so that tickets obtained at the same time are not renewed in a
+ * burst. */
+#define RENEW_AT_MIN 0.5
+#define RENEW_AT_MAX 0.75
+
+#define RENEW_HEAP_NONE ((size_t) -1)
+
 struct renew_tgt_ctx {
     hash_table_t *tgt_table;
     struct be_ctx *be_ctx;
@@ -36,58 +48,286 @@ struct renew_tgt_ctx {
     struct krb5_ctx *krb5_ctx;
     time_t timer_interval;
     struct tevent_timer *te;
+
+    /* renewal items which wait for their renewal time, as a min-heap
+     * ordered by start_renew_at */
+    struct renew_data **heap;
+    size_t heap_len;
+    size_t heap_size;
+
+    size_t running;
 };
 
 struct renew_data {
+    const char *upn;
     const char *ccfile;
     time_t start_time;
     time_t lifetime;
     time_t start_renew_at;
     struct pam_data *pd;
+
+    struct renew_tgt_ctx *renew_tgt_ctx;
+    size_t heap_idx;
 };
 
 struct auth_data {
     struct be_ctx *be_ctx;
     struct krb5_ctx *krb5_ctx;
+    struct renew_tgt_ctx *renew_tgt_ctx;
     struct pam_data *pd;
     struct renew_data *renew_data;
     hash_table_t *table;
     hash_key_t key;
 };
 
+static void renew_heap_set(struct renew_tgt_ctx *renew_tgt_ctx, size_t idx,
+                           struct renew_data *renew_data)
+{
+    renew_tgt_ctx->heap[idx] = renew_data;
+    renew_data->heap_idx = idx;
+}
+
+static void renew_heap_up(struct renew_tgt_ctx *renew_tgt_ctx, size_t idx)
+{
+    struct renew_data *renew_data = renew_tgt_ctx->heap[idx];
+    size_t parent;
+
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (renew_tgt_ctx->heap[parent]->start_renew_at
+                <= renew_data->start_renew_at) {
+            break;
+        }
+        renew_heap_set(renew_tgt_ctx, idx, renew_tgt_ctx->heap[parent]);
+        idx = parent;
+    }
+
+    renew_heap_set(renew_tgt_ctx, idx, renew_data);
+}
+
+static void renew_heap_down(struct renew_tgt_ctx *renew_tgt_ctx, size_t idx)
+{
+    struct renew_data *renew_data = renew_tgt_ctx->heap[idx];
+    size_t child;
+
+    while ((child = 2 * idx + 1) < renew_tgt_ctx->heap_len) {
+        if (child + 1 < renew_tgt_ctx->heap_len
+                && renew_tgt_ctx->heap[child + 1]->start_renew_at
+                        < renew_tgt_ctx->heap[child]->start_renew_at) {
+            child++;
+        }
+        if (renew_data->start_renew_at
+                <= renew_tgt_ctx->heap[child]->start_renew_at) {
+            break;
+        }
+        renew_heap_set(renew_tgt_ctx, idx, renew_tgt_ctx->heap[child]);
+        idx = child;
+    }
+
+    renew_heap_set(renew_tgt_ctx, idx, renew_data);
+}
+
+static errno_t renew_heap_insert(struct renew_tgt_ctx *renew_tgt_ctx,
+                                 struct renew_data *renew_data)
+{
+    struct renew_data **heap;
+    size_t size;
+
+    if (renew_tgt_ctx->heap_len == renew_tgt_ctx->heap_size) {
+        size = renew_tgt_ctx->heap_size == 0 ? 64
+                                             : 2 * renew_tgt_ctx->heap_size;
+        heap = talloc_realloc(renew_tgt_ctx, renew_tgt_ctx->heap,
+                              struct renew_data *, size);
+        if (heap == NULL) {
+            return ENOMEM;
+        }
+        renew_tgt_ctx->heap = heap;
+        renew_tgt_ctx->heap_size = size;
+    }
+
+    renew_heap_set(renew_tgt_ctx, renew_tgt_ctx->heap_len, renew_data);
+    renew_tgt_ctx->heap_len++;
+    renew_heap_up(renew_tgt_ctx, renew_data->heap_idx);
+
+    return EOK;
+}
+
+static void renew_heap_remove(struct renew_tgt_ctx *renew_tgt_ctx,
+                              struct renew_data *renew_data)
+{
+    size_t idx = renew_data->heap_idx;
+    struct renew_data *last;
+
+    if (idx == RENEW_HEAP_NONE) {
+        return;
+    }
+    renew_data->heap_idx = RENEW_HEAP_NONE;
+
+    renew_tgt_ctx->heap_len--;
+    if (idx == renew_tgt_ctx->heap_len) {
+        return;
+    }
+
+    last = renew_tgt_ctx->heap[renew_tgt_ctx->heap_len];
+    renew_heap_set(renew_tgt_ctx, idx, last);
+    renew_heap_up(renew_tgt_ctx, idx);
+    renew_heap_down(renew_tgt_ctx, last->heap_idx);
+}
+
+static int renew_data_destructor(struct renew_data *renew_data)
+{
+    renew_heap_remove(renew_data->renew_tgt_ctx, renew_data);
+    return 0;
+}
+
+static int renew_tgt_ctx_destructor(struct renew_tgt_ctx *renew_tgt_ctx)
+{
+    size_t c;
+
+    /* the renewal items are freed after the heap */
+    for (c = 0; c < renew_tgt_ctx->heap_len; c++) {
+        renew_tgt_ctx->heap[c]->heap_idx = RENEW_HEAP_NONE;
+    }
+    renew_tgt_ctx->heap_len = 0;
+
+    return 0;
+}
+
+static void renew_tgt_timer_handler(struct tevent_context *ev,
+                                    struct tevent_timer *te,
+                                    struct timeval current_time, void *data);
+
+/* Arms the timer for the next renewal item which is due. */
+static void renew_tgt_schedule(struct renew_tgt_ctx *renew_tgt_ctx)
+{
+    struct timeval next;
+    time_t at;
+
+    talloc_zfree(renew_tgt_ctx->te);
+
+    if (be_is_offline(renew_tgt_ctx->be_ctx)) {
+        DEBUG(SSSDBG_CONF_SETTINGS, "Offline, disable renew timer.\n");
+        return;
+    }
+
+    if (renew_tgt_ctx->heap_len == 0) {
+        DEBUG(SSSDBG_TRACE_LIBS, "No TGTs to renew.\n");
+        return;
+    }
+
+    if (renew_tgt_ctx->running >= RENEW_MAX_RUNNING) {
+        /* rescheduled once a running renewal is finished */
+        return;
+    }
+
+    at = renew_tgt_ctx->heap[0]->start_renew_at;
+    next = at > time(NULL) ? tevent_timeval_set(at, 0)
+                           : tevent_timeval_current();
+
+    renew_tgt_ctx->te = tevent_add_timer(renew_tgt_ctx->ev, renew_tgt_ctx,
+                                         next, renew_tgt_timer_handler,
+                                         renew_tgt_ctx);
+    if (renew_tgt_ctx->te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_add_timer failed.\n");
+    }
+}
+
+/* Puts the renewal item back to retry the renewal after the renew
+ * interval. */
+static void renew_tgt_retry(struct renew_tgt_ctx *renew_tgt_ctx,
+                            struct renew_data *renew_data,
+                            hash_key_t *key)
+{
+    errno_t ret;
+
+    renew_data->start_renew_at = time(NULL) + renew_tgt_ctx->timer_interval;
+
+    ret = renew_heap_insert(renew_tgt_ctx, renew_data);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to reschedule renewal of [%s].\n", renew_data->ccfile);
+        ret = hash_delete(renew_tgt_ctx->tgt_table, key);
+        if (ret != HASH_SUCCESS) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "hash_delete failed.\n");
+        }
+    }
+}
 
 static void renew_tgt_done(struct tevent_req *req);
-static void renew_tgt(struct tevent_context *ev, struct tevent_timer *te,
-                      struct timeval current_time, void *private_data)
+static errno_t renew_tgt(struct renew_tgt_ctx *renew_tgt_ctx,
+                         struct renew_data *renew_data)
 {
-    struct auth_data *auth_data = talloc_get_type(private_data,
-                                                  struct auth_data);
+    struct auth_data *auth_data;
     struct tevent_req *req;
+    hash_key_t key;
+    errno_t ret;
 
-    req = krb5_auth_queue_send(auth_data, ev, auth_data->be_ctx, auth_data->pd,
+    auth_data = talloc_zero(renew_tgt_ctx, struct auth_data);
+    if (auth_data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
+        return ENOMEM;
+    }
+
+    auth_data->krb5_ctx = renew_tgt_ctx->krb5_ctx;
+    auth_data->be_ctx = renew_tgt_ctx->be_ctx;
+    auth_data->renew_tgt_ctx = renew_tgt_ctx;
+    auth_data->table = renew_tgt_ctx->tgt_table;
+    auth_data->renew_data = renew_data;
+    auth_data->key.type = HASH_KEY_STRING;
+    auth_data->key.str = talloc_strdup(auth_data, renew_data->upn);
+    if (auth_data->key.str == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strdup failed.\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+/* We need to steal the pam_data here, because a successful renewal of the
+ * ticket might add a new renewal item to the list with the same key (upn).
+ * This would delete renew_data and all its children. But we cannot be sure
+ * that adding the new renewal item is the last operation of the renewal
+ * process with access the pam_data. To be on the safe side we steal the
+ * pam_data and make it a child of auth_data which is only freed after the
+ * renewal process is finished. In the case of an error during renewal we
+ * might want to steal the pam_data back to renew_data before freeing
+ * auth_data to allow a new renewal attempt. */
+    auth_data->pd = talloc_move(auth_data, &renew_data->pd);
+
+    req = krb5_auth_queue_send(auth_data, renew_tgt_ctx->ev,
+                               auth_data->be_ctx, auth_data->pd,
                                auth_data->krb5_ctx);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "krb5_auth_send failed.\n");
-/* Give back the pam data to the renewal item to be able to retry at the next
- * time the renewals re run. */
-        auth_data->renew_data->pd = talloc_steal(auth_data->renew_data,
-                                                 auth_data->pd);
-        talloc_free(auth_data);
-        return;
+/* Give back the pam data to the renewal item to be able to retry after the
+ * renew interval. */
+        renew_data->pd = talloc_steal(renew_data, auth_data->pd);
+        key = auth_data->key;
+        renew_tgt_retry(renew_tgt_ctx, renew_data, &key);
+        ret = EOK;
+        goto done;
     }
 
+    renew_tgt_ctx->running++;
     tevent_req_set_callback(req, renew_tgt_done, auth_data);
+
+    return EOK;
+
+done:
+    talloc_free(auth_data);
+    return ret;
 }
 
 static void renew_tgt_done(struct tevent_req *req)
 {
     struct auth_data *auth_data = tevent_req_callback_data(req,
                                                            struct auth_data);
+    struct renew_tgt_ctx *renew_tgt_ctx = auth_data->renew_tgt_ctx;
     int ret;
     int pam_status = PAM_SYSTEM_ERR;
     int dp_err;
     hash_value_t value;
 
+    renew_tgt_ctx->running--;
+
     ret = krb5_auth_queue_recv(req, &pam_status, &dp_err);
     talloc_free(req);
     if (ret) {
@@ -96,6 +336,8 @@ static void renew_tgt_done(struct tevent_req *req)
             DEBUG(SSSDBG_FUNC_DATA, "Giving back pam data.\n");
             auth_data->renew_data->pd = talloc_steal(auth_data->renew_data,
                                                      auth_data->pd);
+            renew_tgt_retry(renew_tgt_ctx, auth_data->renew_data,
+                            &auth_data->key);
         }
     } else {
         switch (pam_status) {
@@ -135,6 +377,8 @@ static void renew_tgt_done(struct tevent_req *req)
                     DEBUG(SSSDBG_FUNC_DATA, "Giving back pam data.\n");
                     auth_data->renew_data->pd = talloc_steal(auth_data->renew_data,
                                                              auth_data->pd);
+                    renew_tgt_retry(renew_tgt_ctx, auth_data->renew_data,
+                                    &auth_data->key);
                 }
                 break;
             default:
@@ -149,87 +393,47 @@ static void renew_tgt_done(struct tevent_req *req)
     }
 
     talloc_zfree(auth_data);
+
+    renew_tgt_schedule(renew_tgt_ctx);
 }
 
-static errno_t renew_all_tgts(struct renew_tgt_ctx *renew_tgt_ctx)
+/* Starts the renewals which are due, at most RENEW_MAX_RUNNING at a time. */
+static void renew_due_tgts(struct renew_tgt_ctx *renew_tgt_ctx)
 {
-    int ret;
-    hash_entry_t *entries;
-    unsigned long count;
-    size_t c;
-    time_t now;
-    struct auth_data *auth_data;
     struct renew_data *renew_data;
-    struct tevent_timer *te = NULL;
-
-    ret = hash_entries(renew_tgt_ctx->tgt_table, &count, &entries);
-    if (ret != HASH_SUCCESS) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "hash_entries failed.\n");
-        return ENOMEM;
-    }
+    hash_key_t key;
+    time_t now;
+    int ret;
 
     now = time(NULL);
 
-    for (c = 0; c < count; c++) {
-        renew_data = talloc_get_type(entries[c].value.ptr, struct renew_data);
+    while (renew_tgt_ctx->heap_len > 0
+            && renew_tgt_ctx->running < RENEW_MAX_RUNNING) {
+        renew_data = renew_tgt_ctx->heap[0];
+        if (renew_data->start_renew_at > now) {
+            break;
+        }
+
         DEBUG(SSSDBG_TRACE_ALL,
-              "Checking [%s] for renewal at [%.24s].\n", renew_data->ccfile,
+              "Renewing [%s] scheduled at [%.24s].\n", renew_data->ccfile,
                   ctime(&renew_data->start_renew_at));
-        /* If renew_data->pd == NULL a renewal request for this data is
-         * currently running so we skip it. */
-        if (renew_data->start_renew_at < now && renew_data->pd != NULL) {
-            auth_data = talloc_zero(renew_tgt_ctx, struct auth_data);
-            if (auth_data == NULL) {
-                DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
-            } else {
-/* We need to steal the pam_data here, because a successful renewal of the
- * ticket might add a new renewal item to the list with the same key (upn).
- * This would delete renew_data and all its children. But we cannot be sure
- * that adding the new renewal item is the last operation of the renewal
- * process with access the pam_data. To be on the safe side we steal the
- * pam_data and make it a child of auth_data which is only freed after the
- * renewal process is finished. In the case of an error during renewal we
- * might want to steal the pam_data back to renew_data before freeing
- * auth_data to allow a new renewal attempt. */
-                auth_data->pd = talloc_move(auth_data, &renew_data->pd);
-                auth_data->krb5_ctx = renew_tgt_ctx->krb5_ctx;
-                auth_data->be_ctx = renew_tgt_ctx->be_ctx;
-                auth_data->table = renew_tgt_ctx->tgt_table;
-                auth_data->renew_data = renew_data;
-                auth_data->key.type = entries[c].key.type;
-                auth_data->key.str = talloc_strdup(auth_data,
-                                                   entries[c].key.str);
-                if (auth_data->key.str == NULL) {
-                    DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strdup failed.\n");
-                } else {
-                    te = tevent_add_timer(renew_tgt_ctx->ev,
-                                          auth_data, tevent_timeval_current(),
-                                          renew_tgt, auth_data);
-                    if (te == NULL) {
-                        DEBUG(SSSDBG_CRIT_FAILURE,
-                              "tevent_add_timer failed.\n");
-                    }
-                }
-            }
 
-            if (auth_data == NULL || te == NULL) {
-                DEBUG(SSSDBG_CRIT_FAILURE,
-                      "Failed to renew TGT in [%s].\n", renew_data->ccfile);
-                ret = hash_delete(renew_tgt_ctx->tgt_table, &entries[c].key);
-                if (ret != HASH_SUCCESS) {
-                    DEBUG(SSSDBG_CRIT_FAILURE, "hash_delete failed.\n");
-                }
+        renew_heap_remove(renew_tgt_ctx, renew_data);
+
+        ret = renew_tgt(renew_tgt_ctx, renew_data);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Failed to renew TGT in [%s].\n", renew_data->ccfile);
+            key.type = HASH_KEY_STRING;
+            key.str = discard_const_p(char, renew_data->upn);
+            ret = hash_delete(renew_tgt_ctx->tgt_table, &key);
+            if (ret != HASH_SUCCESS) {
+                DEBUG(SSSDBG_CRIT_FAILURE, "hash_delete failed.\n");
             }
         }
     }
-
-    talloc_free(entries);
-
-    return EOK;
 }
 
-static void renew_handler(struct renew_tgt_ctx *renew_tgt_ctx);
-
 static void renew_tgt_offline_callback(void *private_data)
 {
     struct renew_tgt_ctx *renew_tgt_ctx = talloc_get_type(private_data,
@@ -243,7 +447,7 @@ static void renew_tgt_online_callback(void *private_data)
     struct renew_tgt_ctx *renew_tgt_ctx = talloc_get_type(private_data,
                                                           struct renew_tgt_ctx);
 
-    renew_handler(renew_tgt_ctx);
+    renew_tgt_schedule(renew_tgt_ctx);
 }
 
 static void renew_tgt_timer_handler(struct tevent_context *ev,
@@ -256,48 +460,13 @@ static void renew_tgt_timer_handler(struct tevent_context *ev,
     /* forget the timer event, it will be freed by the tevent timer loop */
     renew_tgt_ctx->te = NULL;
 
-    renew_handler(renew_tgt_ctx);
-}
-
-static void renew_handler(struct renew_tgt_ctx *renew_tgt_ctx)
-{
-    struct timeval next;
-    int ret;
-
     if (be_is_offline(renew_tgt_ctx->be_ctx)) {
         DEBUG(SSSDBG_CONF_SETTINGS, "Offline, disable renew timer.\n");
         return;
     }
 
-    ret = renew_all_tgts(renew_tgt_ctx);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "renew_all_tgts failed. "
-                  "Disabling automatic TGT renewal\n");
-        sss_log(SSS_LOG_ERR, "Disabling automatic TGT renewal.");
-        talloc_zfree(renew_tgt_ctx);
-        return;
-    }
-
-    if (renew_tgt_ctx->te != NULL) {
-        DEBUG(SSSDBG_TRACE_LIBS,
-              "There is an active renewal timer, doing nothing.\n");
-        return;
-    }
-
-    DEBUG(SSSDBG_TRACE_LIBS, "Adding new renew timer.\n");
-
-    next = tevent_timeval_current_ofs(renew_tgt_ctx->timer_interval,
-                                      0);
-    renew_tgt_ctx->te = tevent_add_timer(renew_tgt_ctx->ev, renew_tgt_ctx,
-                                         next, renew_tgt_timer_handler,
-                                         renew_tgt_ctx);
-    if (renew_tgt_ctx->te == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_add_timer failed.\n");
-        sss_log(SSS_LOG_ERR, "Disabling automatic TGT renewal.");
-        talloc_zfree(renew_tgt_ctx);
-    }
-
-    return;
+    renew_due_tgts(renew_tgt_ctx);
+    renew_tgt_schedule(renew_tgt_ctx);
 }
 
 static void renew_del_cb(hash_entry_t *entry, hash_destroy_enum type, void *pvt)
@@ -474,13 +643,13 @@ errno_t init_renew_tgt(struct krb5_ctx *krb5_ctx, struct be_ctx *be_ctx,
                        struct tevent_context *ev, time_t renew_intv)
 {
     int ret;
-    struct timeval next;
 
     krb5_ctx->renew_tgt_ctx = talloc_zero(krb5_ctx, struct renew_tgt_ctx);
     if (krb5_ctx->renew_tgt_ctx == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
         return ENOMEM;
     }
+    talloc_set_destructor(krb5_ctx->renew_tgt_ctx, renew_tgt_ctx_destructor);
 
     ret = sss_hash_create_ex(krb5_ctx->renew_tgt_ctx, 0,
                              &krb5_ctx->renew_tgt_ctx->tgt_table, 0, 0, 0, 0,
@@ -501,16 +670,7 @@ errno_t init_renew_tgt(struct krb5_ctx *krb5_ctx, struct be_ctx *be_ctx,
               "Failed to read ccache files, continuing ...\n");
     }
 
-    next = tevent_timeval_current_ofs(krb5_ctx->renew_tgt_ctx->timer_interval,
-                                      0);
-    krb5_ctx->renew_tgt_ctx->te = tevent_add_timer(ev, krb5_ctx->renew_tgt_ctx,
-                                                   next, renew_tgt_timer_handler,
-                                                   krb5_ctx->renew_tgt_ctx);
-    if (krb5_ctx->renew_tgt_ctx->te == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_add_timer failed.\n");
-        ret = ENOMEM;
-        goto fail;
-    }
+    renew_tgt_schedule(krb5_ctx->renew_tgt_ctx);
 
     DEBUG(SSSDBG_TRACE_LIBS,
           "Adding offline callback to remove renewal timer.\n");
@@ -576,6 +736,16 @@ errno_t add_tgt_to_renew_table(struct krb5_ctx *krb5_ctx, const char *ccfile,
         ret = ENOMEM;
         goto done;
     }
+    renew_data->renew_tgt_ctx = krb5_ctx->renew_tgt_ctx;
+    renew_data->heap_idx = RENEW_HEAP_NONE;
+    talloc_set_destructor(renew_data, renew_data_destructor);
+
+    renew_data->upn = talloc_strdup(renew_data, upn);
+    if (renew_data->upn == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strdup failed.\n");
+        ret = ENOMEM;
+        goto done;
+    }
 
     if (ccfile[0] == '/') {
         renew_data->ccfile = talloc_asprintf(renew_data, "FILE:%s", ccfile);
@@ -591,7 +761,10 @@ errno_t add_tgt_to_renew_table(struct krb5_ctx *krb5_ctx, const char *ccfile,
     renew_data->start_time = tgtt->starttime;
     renew_data->lifetime = tgtt->endtime;
     renew_data->start_renew_at = (time_t) (tgtt->starttime +
-                                        0.5 *(tgtt->endtime - tgtt->starttime));
+                                        (RENEW_AT_MIN
+                                         + (RENEW_AT_MAX - RENEW_AT_MIN)
+                                           * (sss_rand() / (RAND_MAX + 1.0)))
+                                        * (tgtt->endtime - tgtt->starttime));
 
     ret = copy_pam_data(renew_data, pd, &renew_data->pd);
     if (ret != EOK) {
@@ -619,6 +792,19 @@ errno_t add_tgt_to_renew_table(struct krb5_ctx *krb5_ctx, const char *ccfile,
         goto done;
     }
 
+    ret = renew_heap_insert(krb5_ctx->renew_tgt_ctx, renew_data);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "renew_heap_insert failed.\n");
+        /* frees renew_data */
+        hash_delete(krb5_ctx->renew_tgt_ctx->tgt_table, &key);
+        return ret;
+    }
+
+    /* the new item might be due before the one the timer waits for */
+    if (krb5_ctx->renew_tgt_ctx->heap[0] == renew_data) {
+        renew_tgt_schedule(krb5_ctx->renew_tgt_ctx);
+    }
+
     DEBUG(SSSDBG_TRACE_LIBS,
           "Added [%s] for renewal at [%.24s].\n", renew_data->ccfile,
                                            ctime(&renew_data->start_renew_at));
@@ -616,6 +616,10 @@ struct auth_state {
     struct sdap_service *sdap_service;
 
     struct sdap_handle *sh;
+    /* the connection is kept for the next user bind when done */
+    bool keep_conn;
+    /* the connection was not bound before the user bind */
+    bool conn_unbound;
 
     char *dn;
     enum pwexpire pw_expire_type;
@@ -626,8 +630,62 @@ static struct tevent_req *auth_connect_send(struct tevent_req *req);
 static void auth_get_dn_done(struct tevent_req *subreq);
 static void auth_do_bind(struct tevent_req *req);
 static void auth_connect_done(struct tevent_req *subreq);
+static void auth_fast_bind_done(struct tevent_req *subreq);
 static void auth_bind_user_done(struct tevent_req *subreq);
 
+struct sdap_handle *sdap_auth_conn_get(TALLOC_CTX *mem_ctx,
+                                       struct sdap_auth_ctx *ctx)
+{
+    struct sdap_auth_conn *conn;
+    struct sdap_handle *sh;
+    time_t now = time(NULL);
+
+    while ((conn = ctx->idle_conns) != NULL) {
+        DLIST_REMOVE(ctx->idle_conns, conn);
+        ctx->num_idle_conns--;
+
+        if (conn->sh->connected
+                && (conn->sh->expire_time == 0
+                    || conn->sh->expire_time > now)) {
+            sh = talloc_steal(mem_ctx, conn->sh);
+            talloc_free(conn);
+            return sh;
+        }
+
+        DEBUG(SSSDBG_TRACE_FUNC, "Dropping expired idle connection\n");
+        talloc_free(conn);
+    }
+
+    return NULL;
+}
+
+void sdap_auth_conn_put(struct sdap_auth_ctx *ctx, struct sdap_handle *sh)
+{
+    struct sdap_auth_conn *conn;
+    int max_conns;
+
+    if (sh == NULL) {
+        return;
+    }
+
+    max_conns = dp_opt_get_int(ctx->opts->basic, SDAP_AUTH_CONN_POOL_SIZE);
+    if (!sh->connected || ctx->num_idle_conns >= max_conns
+            || (sh->expire_time != 0 && sh->expire_time <= time(NULL))) {
+        talloc_free(sh);
+        return;
+    }
+
+    conn = talloc_zero(ctx, struct sdap_auth_conn);
+    if (conn == NULL) {
+        talloc_free(sh);
+        return;
+    }
+
+    conn->sh = talloc_steal(conn, sh);
+    DLIST_ADD(ctx->idle_conns, conn);
+    ctx->num_idle_conns++;
+}
+
 static struct tevent_req *auth_send(TALLOC_CTX *memctx,
                                     struct tevent_context *ev,
                                     struct sdap_auth_ctx *ctx,
@@ -663,6 +721,10 @@ static struct tevent_req *auth_send(TALLOC_CTX *memctx,
         state->sdap_service = ctx->chpass_service;
     } else {
         state->sdap_service = ctx->service;
+        /* The password change keeps using the connection, plain
+         * authentications can give it back */
+        state->keep_conn = dp_opt_get_int(ctx->opts->basic,
+                                          SDAP_AUTH_CONN_POOL_SIZE) > 0;
     }
 
     ret = get_user_dn(state, state->ctx->be->domain,
@@ -677,6 +739,22 @@ static struct tevent_req *auth_send(TALLOC_CTX *memctx,
         goto fail;
     }
 
+    /* An idle connection can only be used if nothing has to be looked up,
+     * it might still be bound as the previous user */
+    if (state->keep_conn && state->dn != NULL) {
+        state->sh = sdap_auth_conn_get(state, ctx);
+        if (state->sh != NULL) {
+            DEBUG(SSSDBG_TRACE_FUNC,
+                  "Using an idle connection to bind as %s\n",
+                  state->username);
+            auth_do_bind(req);
+            if (!tevent_req_is_in_progress(req)) {
+                tevent_req_post(req, ev);
+            }
+            return req;
+        }
+    }
+
     if (auth_connect_send(req) == NULL) {
         ret = ENOMEM;
         goto fail;
@@ -722,6 +800,7 @@ static struct tevent_req *auth_connect_send(struct tevent_req *req)
          */
         skip_conn_auth = true;
     }
+    state->conn_unbound = skip_conn_auth;
 
     if (skip_conn_auth == false) {
         sasl_mech = dp_opt_get_string(state->ctx->opts->basic,
@@ -827,12 +906,47 @@ static void auth_connect_done(struct tevent_req *subreq)
         return;
     }
 
+    /* A connection which is kept for more binds only needs the password to
+     * be verified, let the server skip building the user's token */
+    if (state->keep_conn && state->conn_unbound
+            && sdap_is_extension_supported(state->sh,
+                                           LDAP_SERVER_FAST_BIND_OID)) {
+        subreq = sdap_fast_bind_send(state, state->ev, state->sh,
+                                     dp_opt_get_int(state->ctx->opts->basic,
+                                                    SDAP_OPT_TIMEOUT));
+        if (subreq == NULL) {
+            tevent_req_error(req, ENOMEM);
+            return;
+        }
+        tevent_req_set_callback(subreq, auth_fast_bind_done, req);
+        return;
+    }
+
     /* All required user data was pre-cached during an identity lookup.
      * We can proceed with the bind */
     auth_do_bind(req);
     return;
 }
 
+static void auth_fast_bind_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    errno_t ret;
+
+    ret = sdap_fast_bind_recv(subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        /* not fatal, the bind works the same way without it */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to enable fast bind [%d]: %s\n", ret, sss_strerror(ret));
+    } else {
+        DEBUG(SSSDBG_TRACE_FUNC, "Fast bind enabled on the connection\n");
+    }
+
+    auth_do_bind(req);
+}
+
 static void auth_get_dn_done(struct tevent_req *subreq)
 {
     struct tevent_req *req = tevent_req_callback_data(subreq,
@@ -892,11 +1006,22 @@ static void auth_bind_user_done(struct tevent_req *subreq)
         break;
     case ETIMEDOUT:
     case ERR_NETWORK_IO:
+        talloc_zfree(state->sh);
         if (auth_connect_send(req) == NULL) {
             tevent_req_error(req, ENOMEM);
         }
         return;
     default:
+        break;
+    }
+
+    /* The bind finished, so the connection can take the next one */
+    if (state->keep_conn) {
+        sdap_auth_conn_put(state->ctx, state->sh);
+        state->sh = NULL;
+    }
+
+    if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
     }
@@ -42,5 +42,14 @@ errno_t check_pwexpire_policy(enum pwexpire pw_expire_type,
                               struct pam_data *pd,
                               errno_t checkb);
 
+/* Take an idle connection for a user bind, returns NULL if there is no
+ * connection which is still usable */
+struct sdap_handle *sdap_auth_conn_get(TALLOC_CTX *mem_ctx,
+                                       struct sdap_auth_ctx *ctx);
+
+/* Keep sh for the next user bind if ldap_auth_connection_pool_size
+ * allows it, otherwise free it */
+void sdap_auth_conn_put(struct sdap_auth_ctx *ctx, struct sdap_handle *sh);
+
 
 #endif /* _LDAP_AUTH_H_ */
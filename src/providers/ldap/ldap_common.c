@@ -37,10 +37,17 @@
 
 errno_t ldap_id_setup_tasks(struct sdap_id_ctx *ctx)
 {
-    return sdap_id_setup_tasks(ctx->be, ctx, ctx->opts->sdom,
-                               ldap_id_enumeration_send,
-                               ldap_id_enumeration_recv,
-                               ctx);
+    errno_t ret;
+
+    ret = sdap_id_setup_tasks(ctx->be, ctx, ctx->opts->sdom,
+                              ldap_id_enumeration_send,
+                              ldap_id_enumeration_recv,
+                              ctx);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return ldap_id_setup_sync(ctx, ctx->opts->sdom);
 }
 
 errno_t sdap_id_setup_tasks(struct be_ctx *be_ctx,
@@ -242,7 +249,7 @@ sdap_gssapi_get_default_realm(TALLOC_CTX *mem_ctx)
     krb5_error_code krberr;
     krb5_context context = NULL;
 
-    krberr = sss_krb5_init_context(&context);
+    krberr = sss_krb5_get_shared_context(&context);
     if (krberr) {
         DEBUG(SSSDBG_OP_FAILURE, "Failed to init kerberos context\n");
         goto done;
@@ -266,7 +273,6 @@ sdap_gssapi_get_default_realm(TALLOC_CTX *mem_ctx)
 
     DEBUG(SSSDBG_TRACE_LIBS, "Will use default realm %s\n", realm);
 done:
-    if (context) krb5_free_context(context);
     return realm;
 }
 
@@ -82,11 +82,21 @@ struct sdap_id_ctx {
     struct timeval last_purge;
 };
 
+/* A connection kept for the next user bind */
+struct sdap_auth_conn {
+    struct sdap_auth_conn *prev, *next;
+    struct sdap_handle *sh;
+};
+
 struct sdap_auth_ctx {
     struct be_ctx *be;
     struct sdap_options *opts;
     struct sdap_service *service;
     struct sdap_service *chpass_service;
+
+    /* idle connections to service, most recently used first */
+    struct sdap_auth_conn *idle_conns;
+    int num_idle_conns;
 };
 
 struct sdap_resolver_ctx {
@@ -283,6 +293,17 @@ errno_t ldap_id_setup_cleanup(struct sdap_id_ctx *id_ctx,
 errno_t ldap_id_cleanup(struct sdap_id_ctx *id_ctx,
                         struct sdap_domain *sdom);
 
+/* Like ldap_id_cleanup(), but returns to the event loop between the
+ * transactions */
+struct tevent_req *ldap_id_cleanup_send(TALLOC_CTX *mem_ctx,
+                                        struct tevent_context *ev,
+                                        struct sdap_id_ctx *id_ctx,
+                                        struct sdap_domain *sdom);
+errno_t ldap_id_cleanup_recv(struct tevent_req *req);
+
+errno_t ldap_id_setup_sync(struct sdap_id_ctx *id_ctx,
+                           struct sdap_domain *sdom);
+
 struct tevent_req *groups_get_send(TALLOC_CTX *memctx,
                                    struct tevent_context *ev,
                                    struct sdap_id_ctx *ctx,
@@ -294,6 +315,16 @@ struct tevent_req *groups_get_send(TALLOC_CTX *memctx,
                                    bool no_members);
 int groups_get_recv(struct tevent_req *req, int *dp_error_out, int *sdap_ret);
 
+/* Looks up the groups of the NULL-terminated list of SIDs with one search
+ * and saves them without members, the result is read with groups_get_recv().
+ * Unlike groups_get_send() SIDs that are not found are left alone. */
+struct tevent_req *groups_get_by_sids_send(TALLOC_CTX *memctx,
+                                           struct tevent_context *ev,
+                                           struct sdap_id_ctx *ctx,
+                                           struct sdap_domain *sdom,
+                                           struct sdap_id_conn_ctx *conn,
+                                           const char **sids);
+
 struct tevent_req *ldap_netgroup_get_send(TALLOC_CTX *memctx,
                                           struct tevent_context *ev,
                                           struct sdap_id_ctx *ctx,
@@ -438,6 +469,15 @@ errno_t sdap_setup_certmap(struct sdap_certmap_ctx *sdap_certmap_ctx,
                            struct certmap_info **certmap_list);
 struct sss_certmap_ctx *sdap_get_sss_certmap(struct sdap_certmap_ctx *ctx);
 
+/* Like sss_cert_derb64_to_ldap_filter() but the result of the mapping rules
+ * is remembered for the certificate until the rules change. */
+errno_t sdap_cert_derb64_to_ldap_filter(TALLOC_CTX *mem_ctx,
+                                        struct sdap_certmap_ctx *ctx,
+                                        const char *derb64,
+                                        const char *attr_name,
+                                        struct sss_domain_info *dom,
+                                        char **_filter);
+
 errno_t users_get_handle_no_user(TALLOC_CTX *mem_ctx,
                                  struct sss_domain_info *domain,
                                  int filter_type, const char *filter_value,
@@ -338,12 +338,13 @@ struct tevent_req *users_get_send(TALLOC_CTX *memctx,
             goto done;
         }
 
-        ret = sss_cert_derb64_to_ldap_filter(state, filter_value, attr_name,
-                              sdap_get_sss_certmap(ctx->opts->sdap_certmap_ctx),
-                              state->domain, &user_filter);
+        ret = sdap_cert_derb64_to_ldap_filter(state,
+                                              ctx->opts->sdap_certmap_ctx,
+                                              filter_value, attr_name,
+                                              state->domain, &user_filter);
         if (ret != EOK) {
             DEBUG(SSSDBG_OP_FAILURE,
-                  "sss_cert_derb64_to_ldap_filter failed.\n");
+                  "sdap_cert_derb64_to_ldap_filter failed.\n");
 
             /* Typically sss_cert_derb64_to_ldap_filter() will fail if there
              * is no mapping rule matching the current certificate. But this
@@ -649,6 +650,8 @@ struct groups_get_state {
     int sdap_ret;
     bool noexist_delete;
     bool no_members;
+    /* several groups are looked up with one search */
+    bool multiple;
 };
 
 static int groups_get_retry(struct tevent_req *req);
@@ -879,6 +882,110 @@ done:
     return tevent_req_post(req, ev);
 }
 
+struct tevent_req *groups_get_by_sids_send(TALLOC_CTX *memctx,
+                                           struct tevent_context *ev,
+                                           struct sdap_id_ctx *ctx,
+                                           struct sdap_domain *sdom,
+                                           struct sdap_id_conn_ctx *conn,
+                                           const char **sids)
+{
+    struct tevent_req *req;
+    struct groups_get_state *state;
+    const char *attr_name;
+    const char *member_filter[2];
+    char *clean_value;
+    char *sid_filter;
+    char *oc_list;
+    size_t i;
+    int ret;
+
+    req = tevent_req_create(memctx, &state, struct groups_get_state);
+    if (!req) return NULL;
+
+    state->ev = ev;
+    state->ctx = ctx;
+    state->sdom = sdom;
+    state->conn = conn;
+    state->dp_error = DP_ERR_FATAL;
+    state->noexist_delete = false;
+    state->no_members = true;
+    state->multiple = true;
+
+    state->op = sdap_id_op_create(state, state->conn->conn_cache);
+    if (!state->op) {
+        DEBUG(SSSDBG_OP_FAILURE, "sdap_id_op_create failed\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    state->domain = sdom->dom;
+    state->sysdb = sdom->dom->sysdb;
+    state->filter_type = BE_FILTER_SECID;
+
+    attr_name = ctx->opts->group_map[SDAP_AT_GROUP_OBJECTSID].name;
+    if (attr_name == NULL || sids == NULL || sids[0] == NULL) {
+        ret = EINVAL;
+        goto done;
+    }
+
+    sid_filter = talloc_strdup(state, "");
+    if (sid_filter == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; sids[i] != NULL; i++) {
+        ret = sss_filter_sanitize(state, sids[i], &clean_value);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        sid_filter = talloc_asprintf_append_buffer(sid_filter, "(%s=%s)",
+                                                   attr_name, clean_value);
+        talloc_free(clean_value);
+        if (sid_filter == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    oc_list = sdap_make_oc_list(state, ctx->opts->group_map);
+    if (oc_list == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to create objectClass list.\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    state->filter = talloc_asprintf(state, "(&(|%s)(%s)(%s=*))",
+                                    sid_filter, oc_list,
+                                    ctx->opts->group_map[SDAP_AT_GROUP_NAME].name);
+    talloc_free(sid_filter);
+    if (!state->filter) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to build filter\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    member_filter[0] = (const char *)ctx->opts->group_map[SDAP_AT_GROUP_MEMBER].name;
+    member_filter[1] = NULL;
+
+    ret = build_attrs_from_map(state, ctx->opts->group_map, SDAP_OPTS_GROUP,
+                               (const char **)member_filter,
+                               &state->attrs, NULL);
+    if (ret != EOK) goto done;
+
+    ret = groups_get_retry(req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    return req;
+
+done:
+    tevent_req_error(req, ret);
+    return tevent_req_post(req, ev);
+}
+
 static int groups_get_retry(struct tevent_req *req)
 {
     struct groups_get_state *state = tevent_req_data(req,
@@ -977,6 +1084,7 @@ static void groups_get_done(struct tevent_req *subreq)
     }
 
     if (ret == ENOENT
+            && !state->multiple
             && sss_domain_is_mpg(state->domain) == true
             && !state->conn->no_mpg_user_fallback) {
         /* The requested filter did not find a group. Before giving up, we must
@@ -1412,7 +1520,7 @@ sdap_handle_acct_req_send(TALLOC_CTX *mem_ctx,
     PROBE(SDAP_ACCT_REQ_SEND,
           state->ar->entry_type & BE_REQ_TYPE_MASK,
           state->ar->filter_type, state->ar->filter_value,
-          PROBE_SAFE_STR(state->ar->extra_value));
+          PROBE_SAFE_STR(state->ar->extra_value), debug_trace_id);
 
     switch (ar->entry_type & BE_REQ_TYPE_MASK) {
     case BE_REQ_USER: /* user */
@@ -1627,7 +1735,7 @@ sdap_handle_acct_req_recv(struct tevent_req *req,
     PROBE(SDAP_ACCT_REQ_RECV,
           state->ar->entry_type & BE_REQ_TYPE_MASK,
           state->ar->filter_type, state->ar->filter_value,
-          PROBE_SAFE_STR(state->ar->extra_value));
+          PROBE_SAFE_STR(state->ar->extra_value), debug_trace_id);
 
     if (_dp_error) {
         *_dp_error = state->dp_error;
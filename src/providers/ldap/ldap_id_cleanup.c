@@ -32,22 +32,35 @@
 #include "providers/ldap/ldap_common.h"
 #include "providers/ldap/sdap_async.h"
 
+/* Expired entries are deleted in transactions of at most this many entries,
+ * with a pause of LDAP_ID_CLEANUP_PAUSE_MSEC between them when the cleanup
+ * runs asynchronously, so that the responders are not locked out of the
+ * cache for the whole run. */
+#define LDAP_ID_CLEANUP_CHUNK 50
+#define LDAP_ID_CLEANUP_PAUSE_MSEC 10
+
 /* ==Cleanup-Task========================================================= */
 struct ldap_id_cleanup_ctx {
     struct sdap_id_ctx *ctx;
     struct sdap_domain *sdom;
 };
 
-static errno_t ldap_cleanup_task(TALLOC_CTX *mem_ctx,
-                                 struct tevent_context *ev,
-                                 struct be_ctx *be_ctx,
-                                 struct be_ptask *be_ptask,
-                                 void *pvt)
+static struct tevent_req *ldap_cleanup_task_send(TALLOC_CTX *mem_ctx,
+                                                 struct tevent_context *ev,
+                                                 struct be_ctx *be_ctx,
+                                                 struct be_ptask *be_ptask,
+                                                 void *pvt)
 {
     struct ldap_id_cleanup_ctx *cleanup_ctx = NULL;
 
     cleanup_ctx = talloc_get_type(pvt, struct ldap_id_cleanup_ctx);
-    return ldap_id_cleanup(cleanup_ctx->ctx, cleanup_ctx->sdom);
+    return ldap_id_cleanup_send(mem_ctx, ev, cleanup_ctx->ctx,
+                                cleanup_ctx->sdom);
+}
+
+static errno_t ldap_cleanup_task_recv(struct tevent_req *req)
+{
+    return ldap_id_cleanup_recv(req);
 }
 
 errno_t ldap_id_setup_cleanup(struct sdap_id_ctx *id_ctx,
@@ -85,12 +98,13 @@ errno_t ldap_id_setup_cleanup(struct sdap_id_ctx *id_ctx,
         return ENOMEM;
     }
 
-    ret = be_ptask_create_sync(id_ctx, id_ctx->be, period, first_delay,
-                               5 /* enabled delay */, 0 /* random offset */,
-                               period /* timeout */, 0,
-                               ldap_cleanup_task, cleanup_ctx, name,
-                               BE_PTASK_OFFLINE_SKIP,
-                               &id_ctx->task);
+    ret = be_ptask_create(id_ctx, id_ctx->be, period, first_delay,
+                          5 /* enabled delay */, 0 /* random offset */,
+                          period /* timeout */, 0,
+                          ldap_cleanup_task_send, ldap_cleanup_task_recv,
+                          cleanup_ctx, name,
+                          BE_PTASK_OFFLINE_SKIP | BE_PTASK_BULK,
+                          &id_ctx->task);
     if (ret != EOK) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Unable to initialize cleanup periodic "
                                      "task for %s\n", sdom->dom->name);
@@ -108,61 +122,294 @@ done:
     return ret;
 }
 
-static int cleanup_users(struct sdap_options *opts,
-                         struct sss_domain_info *dom);
-static int cleanup_groups(TALLOC_CTX *memctx,
-                          struct sysdb_ctx *sysdb,
-                          struct sss_domain_info *domain);
+/* ==Cleanup-Run========================================================== */
 
-errno_t ldap_id_cleanup(struct sdap_id_ctx *ctx,
-                        struct sdap_domain *sdom)
+/* One cleanup run. Only the names of the expired entries are kept, the
+ * entries themselves are read again when their chunk is processed. */
+struct ldap_id_cleanup_run {
+    struct sdap_id_ctx *ctx;
+    struct sdap_domain *sdom;
+    time_t now;
+    struct timeval start;
+
+    const char **users;
+    size_t num_users;
+    size_t next_user;
+    const char **groups;
+    size_t num_groups;
+    size_t next_group;
+
+    hash_table_t *uid_table;
+    bool uid_table_checked;
+
+    size_t deleted_users;
+    size_t deleted_groups;
+};
+
+static int cleanup_users_search(struct ldap_id_cleanup_run *run);
+static int cleanup_user(struct ldap_id_cleanup_run *run, const char *name);
+static int cleanup_groups_search(struct ldap_id_cleanup_run *run);
+static int cleanup_group(struct ldap_id_cleanup_run *run, const char *name);
+
+static errno_t ldap_id_cleanup_run_init(TALLOC_CTX *mem_ctx,
+                                        struct sdap_id_ctx *ctx,
+                                        struct sdap_domain *sdom,
+                                        struct ldap_id_cleanup_run **_run)
 {
-    int ret, tret;
-    bool in_transaction = false;
-    TALLOC_CTX *tmp_ctx;
+    struct ldap_id_cleanup_run *run;
+    errno_t ret;
 
-    tmp_ctx = talloc_new(NULL);
-    if (tmp_ctx == NULL) {
+    run = talloc_zero(mem_ctx, struct ldap_id_cleanup_run);
+    if (run == NULL) {
         return ENOMEM;
     }
 
-    ret = sysdb_transaction_start(sdom->dom->sysdb);
+    run->ctx = ctx;
+    run->sdom = sdom;
+    run->now = time(NULL);
+    run->start = tevent_timeval_current();
+
+    ret = cleanup_users_search(run);
+    if (ret != EOK) {
+        talloc_free(run);
+        return ret;
+    }
+
+    *_run = run;
+    return EOK;
+}
+
+/* Process the next chunk of entries in one transaction. The groups are
+ * searched only after all users were processed, because deleting a user
+ * can leave a group without members. */
+static errno_t ldap_id_cleanup_run_chunk(struct ldap_id_cleanup_run *run,
+                                         bool *_done)
+{
+    struct sysdb_ctx *sysdb = run->sdom->dom->sysdb;
+    bool in_transaction = false;
+    size_t processed = 0;
+    int ret, tret;
+
+    if (run->next_user == run->num_users && run->groups == NULL) {
+        ret = cleanup_groups_search(run);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    if (run->next_user == run->num_users
+            && run->next_group == run->num_groups) {
+        *_done = true;
+        return EOK;
+    }
+
+    ret = sysdb_transaction_start(sysdb);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Failed to start transaction\n");
         goto done;
     }
     in_transaction = true;
 
-    ret = cleanup_users(ctx->opts, sdom->dom);
-    if (ret && ret != ENOENT) {
-        goto done;
+    while (run->next_user < run->num_users
+            && processed < LDAP_ID_CLEANUP_CHUNK) {
+        ret = cleanup_user(run, run->users[run->next_user]);
+        if (ret != EOK) {
+            goto done;
+        }
+        run->next_user++;
+        processed++;
     }
 
-    ret = cleanup_groups(tmp_ctx, sdom->dom->sysdb, sdom->dom);
-    if (ret) {
-        goto done;
+    while (run->groups != NULL && run->next_group < run->num_groups
+            && processed < LDAP_ID_CLEANUP_CHUNK) {
+        ret = cleanup_group(run, run->groups[run->next_group]);
+        if (ret != EOK) {
+            goto done;
+        }
+        run->next_group++;
+        processed++;
     }
 
-    ret = sysdb_transaction_commit(sdom->dom->sysdb);
+    ret = sysdb_transaction_commit(sysdb);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Failed to commit transaction\n");
         goto done;
     }
     in_transaction = false;
 
-    ctx->last_purge = tevent_timeval_current();
+    *_done = false;
     ret = EOK;
+
 done:
     if (in_transaction) {
-        tret = sysdb_transaction_cancel(sdom->dom->sysdb);
+        tret = sysdb_transaction_cancel(sysdb);
         if (tret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Could not cancel transaction\n");
         }
     }
-    talloc_free(tmp_ctx);
     return ret;
 }
 
+static void ldap_id_cleanup_run_finish(struct ldap_id_cleanup_run *run)
+{
+    struct timeval took;
+
+    run->ctx->last_purge = tevent_timeval_current();
+    took = tevent_timeval_until(&run->start, &run->ctx->last_purge);
+
+    DEBUG(SSSDBG_FUNC_DATA,
+          "Cleanup of %s removed %zu users and %zu groups in %lu ms\n",
+          run->sdom->dom->name, run->deleted_users, run->deleted_groups,
+          (unsigned long) (took.tv_sec * 1000 + took.tv_usec / 1000));
+}
+
+errno_t ldap_id_cleanup(struct sdap_id_ctx *ctx,
+                        struct sdap_domain *sdom)
+{
+    struct ldap_id_cleanup_run *run;
+    bool done = false;
+    errno_t ret;
+
+    ret = ldap_id_cleanup_run_init(NULL, ctx, sdom, &run);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    while (!done) {
+        ret = ldap_id_cleanup_run_chunk(run, &done);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ldap_id_cleanup_run_finish(run);
+    ret = EOK;
+
+done:
+    talloc_free(run);
+    return ret;
+}
+
+struct ldap_id_cleanup_state {
+    struct tevent_context *ev;
+    struct ldap_id_cleanup_run *run;
+};
+
+static void ldap_id_cleanup_next(struct tevent_context *ev,
+                                 struct tevent_timer *te,
+                                 struct timeval tv, void *pvt);
+
+struct tevent_req *ldap_id_cleanup_send(TALLOC_CTX *mem_ctx,
+                                        struct tevent_context *ev,
+                                        struct sdap_id_ctx *ctx,
+                                        struct sdap_domain *sdom)
+{
+    struct ldap_id_cleanup_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct ldap_id_cleanup_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    state->ev = ev;
+
+    ret = ldap_id_cleanup_run_init(state, ctx, sdom, &state->run);
+    if (ret != EOK) {
+        goto immediately;
+    }
+
+    ldap_id_cleanup_next(ev, NULL, tevent_timeval_current(), req);
+    if (!tevent_req_is_in_progress(req)) {
+        return tevent_req_post(req, ev);
+    }
+
+    return req;
+
+immediately:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static void ldap_id_cleanup_next(struct tevent_context *ev,
+                                 struct tevent_timer *te,
+                                 struct timeval tv, void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    struct ldap_id_cleanup_state *state;
+    struct tevent_timer *next;
+    bool done;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct ldap_id_cleanup_state);
+
+    ret = ldap_id_cleanup_run_chunk(state->run, &done);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    if (done) {
+        ldap_id_cleanup_run_finish(state->run);
+        tevent_req_done(req);
+        return;
+    }
+
+    /* Give the event loop and the other processes using the cache a
+     * chance before the next transaction */
+    next = tevent_add_timer(state->ev, state,
+                            tevent_timeval_current_ofs(0,
+                                    LDAP_ID_CLEANUP_PAUSE_MSEC * 1000),
+                            ldap_id_cleanup_next, req);
+    if (next == NULL) {
+        tevent_req_error(req, ENOMEM);
+        return;
+    }
+}
+
+errno_t ldap_id_cleanup_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+/* Collect the values of SYSDB_NAME of msgs */
+static errno_t cleanup_collect_names(TALLOC_CTX *mem_ctx,
+                                     struct ldb_message **msgs,
+                                     size_t count,
+                                     const char ***_names)
+{
+    const char **names;
+    const char *name;
+    size_t i;
+
+    names = talloc_zero_array(mem_ctx, const char *, count + 1);
+    if (names == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        name = ldb_msg_find_attr_as_string(msgs[i], SYSDB_NAME, NULL);
+        if (name == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "Entry %s has no Name Attribute ?!?\n",
+                  ldb_dn_get_linearized(msgs[i]->dn));
+            talloc_free(names);
+            return EFAULT;
+        }
+
+        names[i] = talloc_strdup(names, name);
+        if (names[i] == NULL) {
+            talloc_free(names);
+            return ENOMEM;
+        }
+    }
+
+    *_names = names;
+    return EOK;
+}
 
 /* ==User-Cleanup-Process================================================= */
 
@@ -172,28 +419,26 @@ static int cleanup_users_logged_in(hash_table_t *table,
 static errno_t expire_memberof_target_groups(struct sss_domain_info *dom,
                                              struct ldb_message *user);
 
-static int cleanup_users(struct sdap_options *opts,
-                         struct sss_domain_info *dom)
+static int cleanup_users_search(struct ldap_id_cleanup_run *run)
 {
     TALLOC_CTX *tmpctx;
-    const char *attrs[] = { SYSDB_NAME, SYSDB_UIDNUM, SYSDB_MEMBEROF, NULL };
-    time_t now = time(NULL);
+    const char *attrs[] = { SYSDB_NAME, NULL };
+    struct sss_domain_info *dom = run->sdom->dom;
+    time_t now = run->now;
     char *subfilter = NULL;
     char *ts_subfilter = NULL;
     int account_cache_expiration;
-    hash_table_t *uid_table;
     struct ldb_message **msgs;
     size_t count;
-    const char *name;
     int ret;
-    int i;
 
     tmpctx = talloc_new(NULL);
     if (!tmpctx) {
         return ENOMEM;
     }
 
-    account_cache_expiration = dp_opt_get_int(opts->basic, SDAP_ACCOUNT_CACHE_EXPIRATION);
+    account_cache_expiration = dp_opt_get_int(run->ctx->opts->basic,
+                                              SDAP_ACCOUNT_CACHE_EXPIRATION);
     DEBUG(SSSDBG_TRACE_ALL, "Cache expiration is set to %d days\n",
               account_cache_expiration);
 
@@ -236,76 +481,135 @@ static int cleanup_users(struct sdap_options *opts,
                                           attrs, &count, &msgs);
     if (ret == ENOENT) {
         count = 0;
+        msgs = NULL;
     } else if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "sysdb_search_users failed: %d\n", ret);
         goto done;
     }
     DEBUG(SSSDBG_FUNC_DATA, "Found %zu expired user entries!\n", count);
 
-    if (count == 0) {
+    ret = cleanup_collect_names(run, msgs, count, &run->users);
+    if (ret != EOK) {
+        goto done;
+    }
+    run->num_users = count;
+
+done:
+    talloc_zfree(tmpctx);
+    return ret;
+}
+
+/* The entry might have been refreshed since the search */
+static bool cleanup_user_is_expired(struct ldap_id_cleanup_run *run,
+                                    struct ldb_message *msg)
+{
+    int account_cache_expiration;
+    uint64_t cache_expire;
+    uint64_t last_login;
+
+    cache_expire = ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0);
+    if (cache_expire == 0 || cache_expire > run->now) {
+        return false;
+    }
+
+    last_login = ldb_msg_find_attr_as_uint64(msg, SYSDB_LAST_LOGIN, 0);
+    if (last_login == 0) {
+        return true;
+    }
+
+    account_cache_expiration = dp_opt_get_int(run->ctx->opts->basic,
+                                              SDAP_ACCOUNT_CACHE_EXPIRATION);
+    return account_cache_expiration > 0
+        && last_login <= run->now - (account_cache_expiration * 86400);
+}
+
+static int cleanup_user(struct ldap_id_cleanup_run *run, const char *name)
+{
+    TALLOC_CTX *tmpctx;
+    const char *attrs[] = { SYSDB_NAME, SYSDB_UIDNUM, SYSDB_MEMBEROF,
+                            SYSDB_CACHE_EXPIRE, SYSDB_LAST_LOGIN, NULL };
+    struct sss_domain_info *dom = run->sdom->dom;
+    struct ldb_message *msg;
+    int ret;
+
+    tmpctx = talloc_new(NULL);
+    if (!tmpctx) {
+        return ENOMEM;
+    }
+
+    DEBUG(SSSDBG_TRACE_ALL, "Processing user %s\n", name);
+
+    ret = sysdb_search_user_by_name(tmpctx, dom, name, attrs, &msg);
+    if (ret == ENOENT) {
         ret = EOK;
         goto done;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Cannot read user %s: %d\n", name, ret);
+        goto done;
     }
 
-    ret = get_uid_table(tmpctx, &uid_table);
-    /* get_uid_table returns ENOSYS on non-Linux platforms. We proceed with
-     * the cleanup in that case
-     */
-    if (ret != EOK && ret != ENOSYS) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "get_uid_table failed: %d\n", ret);
+    if (!cleanup_user_is_expired(run, msg)) {
+        DEBUG(SSSDBG_TRACE_ALL, "User %s was refreshed, keeping data\n",
+              name);
+        ret = EOK;
         goto done;
     }
 
-    for (i = 0; i < count; i++) {
-        name = ldb_msg_find_attr_as_string(msgs[i], SYSDB_NAME, NULL);
-        if (!name) {
-            DEBUG(SSSDBG_OP_FAILURE, "Entry %s has no Name Attribute ?!?\n",
-                       ldb_dn_get_linearized(msgs[i]->dn));
-            ret = EFAULT;
+    if (!run->uid_table_checked) {
+        ret = get_uid_table(run, &run->uid_table);
+        /* get_uid_table returns ENOSYS on non-Linux platforms. We proceed
+         * with the cleanup in that case
+         */
+        if (ret != EOK && ret != ENOSYS) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "get_uid_table failed: %d\n", ret);
             goto done;
         }
-        DEBUG(SSSDBG_TRACE_ALL, "Processing user %s\n", name);
-
-        if (uid_table) {
-            ret = cleanup_users_logged_in(uid_table, msgs[i]);
-            if (ret == EOK) {
-                /* If the user is logged in, proceed to the next one */
-                DEBUG(SSSDBG_FUNC_DATA,
-                      "User %s is still logged in or a dummy entry, "
-                          "keeping data\n", name);
-                continue;
-            } else if (ret != ENOENT) {
-                DEBUG(SSSDBG_CRIT_FAILURE,
-                      "Cannot check if user is logged in: %d\n", ret);
-                goto done;
-            }
-        }
+        run->uid_table_checked = true;
+    }
 
-        /* If not logged in or cannot check the table, delete him */
-        DEBUG(SSSDBG_TRACE_ALL, "About to delete user %s\n", name);
-        ret = sysdb_delete_user(dom, name, 0);
-        if (ret) {
-            DEBUG(SSSDBG_CRIT_FAILURE, "sysdb_delete_user failed: %d\n", ret);
+    if (run->uid_table) {
+        ret = cleanup_users_logged_in(run->uid_table, msg);
+        if (ret == EOK) {
+            /* If the user is logged in, proceed to the next one */
+            DEBUG(SSSDBG_FUNC_DATA,
+                  "User %s is still logged in or a dummy entry, "
+                      "keeping data\n", name);
             goto done;
-        }
-
-        /* Mark all groups of which user was a member as expired in cache,
-         * so that its ghost/member attributes are refreshed on next
-         * request. */
-        ret = expire_memberof_target_groups(dom, msgs[i]);
-        if (ret != EOK && ret != ENOENT) {
+        } else if (ret != ENOENT) {
             DEBUG(SSSDBG_CRIT_FAILURE,
-                  "expire_memberof_target_groups failed: [%d]:%s\n",
-                  ret, sss_strerror(ret));
+                  "Cannot check if user is logged in: %d\n", ret);
             goto done;
         }
     }
 
+    /* If not logged in or cannot check the table, delete him */
+    DEBUG(SSSDBG_TRACE_ALL, "About to delete user %s\n", name);
+    ret = sysdb_delete_user(dom, name, 0);
+    if (ret) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "sysdb_delete_user failed: %d\n", ret);
+        goto done;
+    }
+    run->deleted_users++;
+
+    /* Mark all groups of which user was a member as expired in cache,
+     * so that its ghost/member attributes are refreshed on next
+     * request. */
+    ret = expire_memberof_target_groups(dom, msg);
+    if (ret != EOK && ret != ENOENT) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "expire_memberof_target_groups failed: [%d]:%s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = EOK;
+
 done:
     talloc_zfree(tmpctx);
     return ret;
 }
 
+
 static errno_t expire_memberof_target_groups(struct sss_domain_info *dom,
                                              struct ldb_message *user)
 {
@@ -373,29 +677,20 @@ static int cleanup_users_logged_in(hash_table_t *table,
     return EIO;
 }
 
+
 /* ==Group-Cleanup-Process================================================ */
 
-static int cleanup_groups(TALLOC_CTX *memctx,
-                          struct sysdb_ctx *sysdb,
-                          struct sss_domain_info *domain)
+static int cleanup_groups_search(struct ldap_id_cleanup_run *run)
 {
     TALLOC_CTX *tmpctx;
-    const char *attrs[] = { SYSDB_NAME, SYSDB_GIDNUM, NULL };
-    time_t now = time(NULL);
+    const char *attrs[] = { SYSDB_NAME, NULL };
     char *subfilter;
     char *ts_subfilter;
-    const char *dn;
-    gid_t gid;
     struct ldb_message **msgs;
     size_t count;
-    struct ldb_message **u_msgs;
-    size_t u_count;
     int ret;
-    int i;
-    const char *posix;
-    struct ldb_dn *base_dn;
 
-    tmpctx = talloc_new(memctx);
+    tmpctx = talloc_new(NULL);
     if (!tmpctx) {
         return ENOMEM;
     }
@@ -409,17 +704,18 @@ static int cleanup_groups(TALLOC_CTX *memctx,
 
     ts_subfilter = talloc_asprintf(tmpctx, "(&(!(%s=0))(%s<=%ld))",
                                    SYSDB_CACHE_EXPIRE,
-                                   SYSDB_CACHE_EXPIRE, (long)now);
+                                   SYSDB_CACHE_EXPIRE, (long)run->now);
     if (ts_subfilter == NULL) {
         DEBUG(SSSDBG_OP_FAILURE, "Failed to build filter\n");
         ret = ENOMEM;
         goto done;
     }
 
-    ret = sysdb_search_groups_by_timestamp(tmpctx, domain, subfilter,
+    ret = sysdb_search_groups_by_timestamp(tmpctx, run->sdom->dom, subfilter,
                                            ts_subfilter, attrs, &count, &msgs);
     if (ret == ENOENT) {
         count = 0;
+        msgs = NULL;
     } else if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "sysdb_search_groups failed: %d\n", ret);
         goto done;
@@ -427,92 +723,128 @@ static int cleanup_groups(TALLOC_CTX *memctx,
 
     DEBUG(SSSDBG_FUNC_DATA, "Found %zu expired group entries!\n", count);
 
-    if (count == 0) {
+    ret = cleanup_collect_names(run, msgs, count, &run->groups);
+    if (ret != EOK) {
+        goto done;
+    }
+    run->num_groups = count;
+
+done:
+    talloc_zfree(tmpctx);
+    return ret;
+}
+
+static int cleanup_group(struct ldap_id_cleanup_run *run, const char *name)
+{
+    TALLOC_CTX *tmpctx;
+    const char *attrs[] = { SYSDB_NAME, SYSDB_GIDNUM, SYSDB_CACHE_EXPIRE,
+                            NULL };
+    struct sss_domain_info *domain = run->sdom->dom;
+    struct sysdb_ctx *sysdb = domain->sysdb;
+    uint64_t cache_expire;
+    char *subfilter;
+    const char *dn;
+    char *sanitized_dn;
+    gid_t gid;
+    struct ldb_message *msg;
+    struct ldb_message **u_msgs;
+    size_t u_count;
+    int ret;
+    const char *posix;
+    struct ldb_dn *base_dn;
+
+    tmpctx = talloc_new(NULL);
+    if (!tmpctx) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_search_group_by_name(tmpctx, domain, name, attrs, &msg);
+    if (ret == ENOENT) {
         ret = EOK;
         goto done;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Cannot read group %s: %d\n", name, ret);
+        goto done;
     }
 
-    for (i = 0; i < count; i++) {
-        char *sanitized_dn;
+    /* The entry might have been refreshed since the search */
+    cache_expire = ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0);
+    if (cache_expire == 0 || cache_expire > run->now) {
+        DEBUG(SSSDBG_TRACE_ALL, "Group %s was refreshed, keeping data\n",
+              name);
+        ret = EOK;
+        goto done;
+    }
 
-        dn = ldb_dn_get_linearized(msgs[i]->dn);
-        if (!dn) {
-            DEBUG(SSSDBG_CRIT_FAILURE, "Cannot linearize DN!\n");
-            ret = EFAULT;
-            goto done;
-        }
+    dn = ldb_dn_get_linearized(msg->dn);
+    if (!dn) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Cannot linearize DN!\n");
+        ret = EFAULT;
+        goto done;
+    }
 
-        /* sanitize dn */
-        ret = sss_filter_sanitize_dn(tmpctx, dn, &sanitized_dn);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_MINOR_FAILURE,
-                  "sss_filter_sanitize failed: %s:[%d]\n",
-                  sss_strerror(ret), ret);
-            goto done;
-        }
+    /* sanitize dn */
+    ret = sss_filter_sanitize_dn(tmpctx, dn, &sanitized_dn);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "sss_filter_sanitize failed: %s:[%d]\n",
+              sss_strerror(ret), ret);
+        goto done;
+    }
 
-        posix = ldb_msg_find_attr_as_string(msgs[i], SYSDB_POSIX, NULL);
-        if (!posix || strcmp(posix, "TRUE") == 0) {
-            /* Search for users that are members of this group, or
-             * that have this group as their primary GID.
-             * Include subdomain users as well.
-             */
-            gid = (gid_t) ldb_msg_find_attr_as_uint(msgs[i], SYSDB_GIDNUM, 0);
-            subfilter = talloc_asprintf(tmpctx, "(&(%s=%s)(|(%s=%s)(%s=%lu)))",
-                                        SYSDB_OBJECTCATEGORY, SYSDB_USER_CLASS,
-                                        SYSDB_MEMBEROF, sanitized_dn,
-                                        SYSDB_GIDNUM, (long unsigned) gid);
-        } else {
-            subfilter = talloc_asprintf(tmpctx, "(%s=%s)", SYSDB_MEMBEROF,
-                                        sanitized_dn);
-        }
-        talloc_zfree(sanitized_dn);
+    posix = ldb_msg_find_attr_as_string(msg, SYSDB_POSIX, NULL);
+    if (!posix || strcmp(posix, "TRUE") == 0) {
+        /* Search for users that are members of this group, or
+         * that have this group as their primary GID.
+         * Include subdomain users as well.
+         */
+        gid = (gid_t) ldb_msg_find_attr_as_uint(msg, SYSDB_GIDNUM, 0);
+        subfilter = talloc_asprintf(tmpctx, "(&(%s=%s)(|(%s=%s)(%s=%lu)))",
+                                    SYSDB_OBJECTCATEGORY, SYSDB_USER_CLASS,
+                                    SYSDB_MEMBEROF, sanitized_dn,
+                                    SYSDB_GIDNUM, (long unsigned) gid);
+    } else {
+        subfilter = talloc_asprintf(tmpctx, "(%s=%s)", SYSDB_MEMBEROF,
+                                    sanitized_dn);
+    }
+    talloc_zfree(sanitized_dn);
 
-        if (!subfilter) {
-            DEBUG(SSSDBG_OP_FAILURE, "Failed to build filter\n");
-            ret = ENOMEM;
-            goto done;
-        }
+    if (!subfilter) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to build filter\n");
+        ret = ENOMEM;
+        goto done;
+    }
 
-        base_dn = sysdb_base_dn(sysdb, tmpctx);
-        if (base_dn == NULL) {
-            DEBUG(SSSDBG_OP_FAILURE, "Failed to build base dn\n");
-            ret = ENOMEM;
-            goto done;
-        }
+    base_dn = sysdb_base_dn(sysdb, tmpctx);
+    if (base_dn == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to build base dn\n");
+        ret = ENOMEM;
+        goto done;
+    }
 
-        DEBUG(SSSDBG_TRACE_LIBS, "Searching with: %s\n", subfilter);
-
-        ret = sysdb_search_entry(tmpctx, sysdb, base_dn,
-                                 LDB_SCOPE_SUBTREE, subfilter, NULL,
-                                 &u_count, &u_msgs);
-        if (ret == ENOENT) {
-            const char *name;
-
-            name = ldb_msg_find_attr_as_string(msgs[i], SYSDB_NAME, NULL);
-            if (!name) {
-                DEBUG(SSSDBG_OP_FAILURE, "Entry %s has no Name Attribute ?!?\n",
-                          ldb_dn_get_linearized(msgs[i]->dn));
-                ret = EFAULT;
-                goto done;
-            }
-
-            DEBUG(SSSDBG_TRACE_INTERNAL, "About to delete group %s\n", name);
-            ret = sysdb_delete_group(domain, name, 0);
-            if (ret) {
-                DEBUG(SSSDBG_OP_FAILURE, "Group delete returned %d (%s)\n",
-                          ret, strerror(ret));
-                goto done;
-            }
-        } else if (ret != EOK) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Failed to search sysdb using %s: [%d] %s\n",
-                  subfilter, ret, sss_strerror(ret));
+    DEBUG(SSSDBG_TRACE_LIBS, "Searching with: %s\n", subfilter);
+
+    ret = sysdb_search_entry(tmpctx, sysdb, base_dn,
+                             LDB_SCOPE_SUBTREE, subfilter, NULL,
+                             &u_count, &u_msgs);
+    if (ret == ENOENT) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "About to delete group %s\n", name);
+        ret = sysdb_delete_group(domain, name, 0);
+        if (ret) {
+            DEBUG(SSSDBG_OP_FAILURE, "Group delete returned %d (%s)\n",
+                      ret, strerror(ret));
             goto done;
         }
-        talloc_zfree(u_msgs);
+        run->deleted_groups++;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to search sysdb using %s: [%d] %s\n",
+              subfilter, ret, sss_strerror(ret));
+        goto done;
     }
 
+    ret = EOK;
+
 done:
     talloc_zfree(tmpctx);
     return ret;
@@ -0,0 +1,769 @@
+/*
+    SSSD
+
+    LDAP Identity Backend Module - change notification
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Keeps a refreshAndPersist Content Synchronization (RFC 4533) search open
+ * against the server and expires the cached users and groups as soon as the
+ * server reports a change of the corresponding LDAP entry. The entries are
+ * not updated from the notification itself, the next lookup refreshes them
+ * from the server. */
+
+#include <errno.h>
+#include <lber.h>
+
+#include "util/util.h"
+#include "db/sysdb.h"
+#include "providers/ldap/ldap_common.h"
+#include "providers/ldap/sdap_async_private.h"
+#include "providers/data_provider/dp.h"
+
+/* how long to wait before the search is started again once it ended */
+#define LDAP_SYNC_RESTART_PERIOD 60
+
+struct ldap_sync_ctx {
+    struct sdap_id_ctx *id_ctx;
+    struct sdap_domain *sdom;
+
+    /* the last cookie sent by the server, kept only in memory */
+    struct berval cookie;
+};
+
+/* Takes over a cookie returned by one of the parsers below */
+static void ldap_sync_set_cookie(struct ldap_sync_ctx *sync_ctx,
+                                 struct berval *cookie)
+{
+    if (cookie->bv_val == NULL) {
+        return;
+    }
+
+    talloc_free(sync_ctx->cookie.bv_val);
+    sync_ctx->cookie.bv_val = talloc_steal(sync_ctx, cookie->bv_val);
+    sync_ctx->cookie.bv_len = cookie->bv_len;
+}
+
+static errno_t ldap_sync_copy_cookie(TALLOC_CTX *mem_ctx,
+                                     struct berval *value,
+                                     struct berval *_cookie)
+{
+    if (value->bv_len == 0) {
+        return EOK;
+    }
+
+    _cookie->bv_val = talloc_memdup(mem_ctx, value->bv_val, value->bv_len);
+    if (_cookie->bv_val == NULL) {
+        return ENOMEM;
+    }
+    _cookie->bv_len = value->bv_len;
+
+    return EOK;
+}
+
+static errno_t ldap_sync_parse_state(TALLOC_CTX *mem_ctx,
+                                     struct berval *value,
+                                     int *_entry_state,
+                                     struct berval *_cookie)
+{
+    BerElement *ber;
+    struct berval uuid;
+    struct berval cookie;
+    ber_len_t len;
+    ber_int_t entry_state;
+    errno_t ret;
+
+    _cookie->bv_val = NULL;
+    _cookie->bv_len = 0;
+
+    ber = ber_init(value);
+    if (ber == NULL) {
+        return ENOMEM;
+    }
+
+    if (ber_scanf(ber, "{em", &entry_state, &uuid) == LBER_ERROR) {
+        DEBUG(SSSDBG_OP_FAILURE, "Malformed Sync State control\n");
+        ret = EIO;
+        goto done;
+    }
+
+    if (ber_peek_tag(ber, &len) == LDAP_TAG_SYNC_COOKIE) {
+        if (ber_scanf(ber, "m", &cookie) == LBER_ERROR) {
+            ret = EIO;
+            goto done;
+        }
+        ret = ldap_sync_copy_cookie(mem_ctx, &cookie, _cookie);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    *_entry_state = entry_state;
+    ret = EOK;
+
+done:
+    ber_free(ber, 1);
+    return ret;
+}
+
+static errno_t ldap_sync_parse_info(TALLOC_CTX *mem_ctx,
+                                    struct berval *data,
+                                    bool *_refresh_done,
+                                    struct berval *_cookie)
+{
+    BerElement *ber;
+    struct berval cookie;
+    ber_len_t len;
+    ber_tag_t tag;
+    ber_int_t refresh_done = 1;
+    errno_t ret;
+
+    _cookie->bv_val = NULL;
+    _cookie->bv_len = 0;
+    *_refresh_done = false;
+
+    ber = ber_init(data);
+    if (ber == NULL) {
+        return ENOMEM;
+    }
+
+    cookie.bv_val = NULL;
+    cookie.bv_len = 0;
+
+    tag = ber_peek_tag(ber, &len);
+    switch (tag) {
+    case LDAP_TAG_SYNC_NEW_COOKIE:
+        if (ber_scanf(ber, "m", &cookie) == LBER_ERROR) {
+            ret = EIO;
+            goto done;
+        }
+        break;
+    case LDAP_TAG_SYNC_REFRESH_DELETE:
+    case LDAP_TAG_SYNC_REFRESH_PRESENT:
+        if (ber_scanf(ber, "{") == LBER_ERROR) {
+            ret = EIO;
+            goto done;
+        }
+        if (ber_peek_tag(ber, &len) == LDAP_TAG_SYNC_COOKIE
+                && ber_scanf(ber, "m", &cookie) == LBER_ERROR) {
+            ret = EIO;
+            goto done;
+        }
+        if (ber_peek_tag(ber, &len) == LDAP_TAG_REFRESHDONE
+                && ber_scanf(ber, "b", &refresh_done) == LBER_ERROR) {
+            ret = EIO;
+            goto done;
+        }
+        *_refresh_done = refresh_done;
+        break;
+    case LDAP_TAG_SYNC_ID_SET:
+        if (ber_scanf(ber, "{") == LBER_ERROR) {
+            ret = EIO;
+            goto done;
+        }
+        if (ber_peek_tag(ber, &len) == LDAP_TAG_SYNC_COOKIE
+                && ber_scanf(ber, "m", &cookie) == LBER_ERROR) {
+            ret = EIO;
+            goto done;
+        }
+        /* the set only carries entryUUIDs which are not cached */
+        DEBUG(SSSDBG_TRACE_FUNC, "Ignoring syncIdSet\n");
+        break;
+    default:
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unknown Sync Info message [%lx]\n",
+              (unsigned long)tag);
+        ret = EOK;
+        goto done;
+    }
+
+    ret = ldap_sync_copy_cookie(mem_ctx, &cookie, _cookie);
+
+done:
+    ber_free(ber, 1);
+    return ret;
+}
+
+static bool ldap_sync_entry_changed(bool had_cookie, bool refresh_done,
+                                    int entry_state)
+{
+    /* entries of the initial refresh without a cookie are the whole
+     * content, not changes */
+    if (!had_cookie && !refresh_done) {
+        return false;
+    }
+
+    switch (entry_state) {
+    case LDAP_SYNC_ADD:
+    case LDAP_SYNC_MODIFY:
+    case LDAP_SYNC_DELETE:
+        return true;
+    default:
+        /* present entries did not change */
+        return false;
+    }
+}
+
+static void ldap_sync_drop_cookie(struct ldap_sync_ctx *sync_ctx)
+{
+    talloc_zfree(sync_ctx->cookie.bv_val);
+    sync_ctx->cookie.bv_len = 0;
+}
+
+struct ldap_sync_state {
+    struct tevent_context *ev;
+    struct ldap_sync_ctx *sync_ctx;
+    struct sdap_id_op *op;
+    struct sdap_handle *sh;
+    struct sdap_op *sop;
+
+    bool had_cookie;
+    bool refresh_done;
+};
+
+static void ldap_sync_connect_done(struct tevent_req *subreq);
+static void ldap_sync_reply(struct sdap_op *op, struct sdap_msg *reply,
+                            int error, void *pvt);
+
+static struct tevent_req *ldap_id_sync_send(TALLOC_CTX *mem_ctx,
+                                            struct tevent_context *ev,
+                                            struct be_ctx *be_ctx,
+                                            struct be_ptask *be_ptask,
+                                            void *pvt)
+{
+    struct ldap_sync_state *state;
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+    struct ldap_sync_ctx *sync_ctx;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct ldap_sync_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    sync_ctx = talloc_get_type(pvt, struct ldap_sync_ctx);
+    state->ev = ev;
+    state->sync_ctx = sync_ctx;
+
+    state->op = sdap_id_op_create(state, sync_ctx->id_ctx->conn->conn_cache);
+    if (state->op == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "sdap_id_op_create failed\n");
+        ret = ENOMEM;
+        goto immediately;
+    }
+
+    subreq = sdap_id_op_connect_send(state->op, state, &ret);
+    if (subreq == NULL) {
+        goto immediately;
+    }
+    tevent_req_set_callback(subreq, ldap_sync_connect_done, req);
+
+    return req;
+
+immediately:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static errno_t ldap_sync_create_control(struct ldap_sync_state *state,
+                                        LDAPControl **_ctrl)
+{
+    struct berval *cookie = &state->sync_ctx->cookie;
+    struct berval value;
+    BerElement *ber;
+    int ret;
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    if (ber == NULL) {
+        return ENOMEM;
+    }
+
+    ret = ber_printf(ber, "{e", LDAP_SYNC_REFRESH_AND_PERSIST);
+    if (ret != -1 && cookie->bv_val != NULL) {
+        ret = ber_printf(ber, "O", cookie);
+    }
+    if (ret != -1) {
+        ret = ber_printf(ber, "N}");
+    }
+    if (ret == -1) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "ber_printf failed\n");
+        ber_free(ber, 1);
+        return EIO;
+    }
+
+    ret = ber_flatten2(ber, &value, 0);
+    if (ret == -1) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "ber_flatten2 failed\n");
+        ber_free(ber, 1);
+        return EIO;
+    }
+
+    ret = sdap_control_create(state->sh, LDAP_CONTROL_SYNC, 1,
+                              &value, 1, _ctrl);
+    ber_free(ber, 1);
+    if (ret != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "sdap_control_create failed to create "
+              "Content Synchronization control\n");
+        return EIO;
+    }
+
+    return EOK;
+}
+
+static void ldap_sync_connect_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req;
+    struct ldap_sync_state *state;
+    struct sdap_options *opts;
+    LDAPControl *ctrls[2] = { NULL, NULL };
+    const char *attrs[] = { "1.1", NULL };
+    const char *base;
+    char *oc_list;
+    char *filter;
+    int dp_error;
+    int msgid;
+    int lret;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct ldap_sync_state);
+    opts = state->sync_ctx->id_ctx->opts;
+
+    ret = sdap_id_op_connect_recv(subreq, &dp_error);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        if (dp_error == DP_ERR_OFFLINE) {
+            DEBUG(SSSDBG_TRACE_FUNC, "Backend is offline, retrying later\n");
+            tevent_req_done(req);
+            return;
+        }
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    state->sh = sdap_id_op_handle(state->op);
+
+    base = state->sync_ctx->sdom->basedn;
+    if (base == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "No base DN to synchronize\n");
+        tevent_req_error(req, EINVAL);
+        return;
+    }
+
+    oc_list = sdap_make_oc_list(state, opts->group_map);
+    if (oc_list == NULL) {
+        tevent_req_error(req, ENOMEM);
+        return;
+    }
+
+    filter = talloc_asprintf(state, "(|(objectclass=%s)(%s))",
+                             opts->user_map[SDAP_OC_USER].name, oc_list);
+    if (filter == NULL) {
+        tevent_req_error(req, ENOMEM);
+        return;
+    }
+
+    ret = ldap_sync_create_control(state, &ctrls[0]);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    state->had_cookie = (state->sync_ctx->cookie.bv_val != NULL);
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Starting Content Synchronization of [%s] with filter [%s]%s\n",
+          base, filter, state->had_cookie ? " from the last cookie" : "");
+
+    lret = ldap_search_ext(state->sh->ldap, base, LDAP_SCOPE_SUBTREE, filter,
+                           discard_const(attrs), 0, ctrls, NULL, NULL, 0,
+                           &msgid);
+    ldap_control_free(ctrls[0]);
+    if (lret != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "ldap_search_ext failed: %s\n",
+              sss_ldap_err2string(lret));
+        if (lret == LDAP_SERVER_DOWN) {
+            sdap_id_op_done(state->op, ETIMEDOUT, &dp_error);
+            tevent_req_error(req, ETIMEDOUT);
+        } else {
+            tevent_req_error(req, EIO);
+        }
+        return;
+    }
+
+    /* the search is expected to never end, so no timeout */
+    ret = sdap_op_add(state, state->ev, state->sh, msgid,
+                      ldap_sync_reply, req, 0, &state->sop);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to set up operation!\n");
+        tevent_req_error(req, ret);
+        return;
+    }
+}
+
+static void ldap_sync_invalidate(struct sdap_id_ctx *id_ctx,
+                                 struct sss_domain_info *dom,
+                                 const char *orig_dn)
+{
+    struct data_provider *provider = id_ctx->be->provider;
+    const char *user_attrs[] = { SYSDB_NAME, SYSDB_UIDNUM, NULL };
+    const char *group_attrs[] = { SYSDB_NAME, SYSDB_GIDNUM, NULL };
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_message **msgs;
+    const char *name;
+    size_t count;
+    uint32_t id;
+    bool is_user;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return;
+    }
+
+    is_user = true;
+    ret = sysdb_search_users_by_orig_dn(tmp_ctx, dom, orig_dn, user_attrs,
+                                        &count, &msgs);
+    if (ret == ENOENT) {
+        is_user = false;
+        ret = sysdb_search_groups_by_orig_dn(tmp_ctx, dom, orig_dn,
+                                             group_attrs, &count, &msgs);
+    }
+    if (ret == ENOENT) {
+        DEBUG(SSSDBG_TRACE_ALL, "[%s] is not cached\n", orig_dn);
+        goto done;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to look up [%s] [%d]: %s\n",
+              orig_dn, ret, sss_strerror(ret));
+        goto done;
+    }
+
+    if (count != 1) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "[%s] matches %zu cached entries\n", orig_dn, count);
+        goto done;
+    }
+
+    name = ldb_msg_find_attr_as_string(msgs[0], SYSDB_NAME, NULL);
+    if (name == NULL) {
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Server reported a change of %s [%s]\n",
+          is_user ? "user" : "group", name);
+
+    ret = sysdb_invalidate_cache_entry(dom, name, is_user);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to expire [%s] [%d]: %s\n",
+              name, ret, sss_strerror(ret));
+        goto done;
+    }
+
+    id = ldb_msg_find_attr_as_uint(msgs[0],
+                                   is_user ? SYSDB_UIDNUM : SYSDB_GIDNUM, 0);
+    if (id != 0) {
+        if (is_user) {
+            dp_sbus_invalidate_user_memcache(provider, id);
+        } else {
+            dp_sbus_invalidate_group_memcache(provider, id);
+        }
+    }
+
+done:
+    talloc_free(tmp_ctx);
+}
+
+static errno_t ldap_sync_entry(struct ldap_sync_state *state,
+                               LDAPMessage *msg)
+{
+    LDAPControl **ctrls = NULL;
+    LDAPControl *ctrl;
+    struct berval cookie;
+    int entry_state;
+    char *dn = NULL;
+    errno_t ret;
+    int lret;
+
+    lret = ldap_get_entry_controls(state->sh->ldap, msg, &ctrls);
+    if (lret != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "ldap_get_entry_controls failed\n");
+        return EIO;
+    }
+
+    ctrl = ldap_control_find(LDAP_CONTROL_SYNC_STATE, ctrls, NULL);
+    if (ctrl == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Entry without Sync State control\n");
+        ret = EOK;
+        goto done;
+    }
+
+    ret = ldap_sync_parse_state(state, &ctrl->ldctl_value, &entry_state,
+                                &cookie);
+    if (ret != EOK) {
+        goto done;
+    }
+    ldap_sync_set_cookie(state->sync_ctx, &cookie);
+
+    if (ldap_sync_entry_changed(state->had_cookie, state->refresh_done,
+                                entry_state)) {
+        dn = ldap_get_dn(state->sh->ldap, msg);
+        if (dn == NULL) {
+            ret = EIO;
+            goto done;
+        }
+        ldap_sync_invalidate(state->sync_ctx->id_ctx,
+                             state->sync_ctx->sdom->dom, dn);
+    }
+
+    ret = EOK;
+
+done:
+    ldap_memfree(dn);
+    ldap_controls_free(ctrls);
+    return ret;
+}
+
+static errno_t ldap_sync_info(struct ldap_sync_state *state,
+                              LDAPMessage *msg)
+{
+    struct berval *data = NULL;
+    struct berval cookie;
+    char *oid = NULL;
+    bool refresh_done;
+    errno_t ret;
+    int lret;
+
+    lret = ldap_parse_intermediate(state->sh->ldap, msg, &oid, &data,
+                                   NULL, 0);
+    if (lret != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "ldap_parse_intermediate failed\n");
+        return EIO;
+    }
+
+    if (oid == NULL || strcmp(oid, LDAP_SYNC_INFO) != 0 || data == NULL) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Ignoring intermediate response [%s]\n",
+              oid == NULL ? "-" : oid);
+        ret = EOK;
+        goto done;
+    }
+
+    ret = ldap_sync_parse_info(state, data, &refresh_done, &cookie);
+    if (ret != EOK) {
+        goto done;
+    }
+    ldap_sync_set_cookie(state->sync_ctx, &cookie);
+
+    if (refresh_done && !state->refresh_done) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Refresh phase finished\n");
+        state->refresh_done = true;
+    }
+
+done:
+    ber_bvfree(data);
+    ldap_memfree(oid);
+    return ret;
+}
+
+static errno_t ldap_sync_result(struct ldap_sync_state *state,
+                                LDAPMessage *msg)
+{
+    LDAPControl **ctrls = NULL;
+    LDAPControl *ctrl;
+    BerElement *ber = NULL;
+    struct berval value;
+    struct berval cookie = { 0, NULL };
+    ber_len_t len;
+    char *errmsg = NULL;
+    int result;
+    errno_t ret;
+    int lret;
+
+    lret = ldap_parse_result(state->sh->ldap, msg, &result, NULL, &errmsg,
+                             NULL, &ctrls, 0);
+    if (lret != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "ldap_parse_result failed (%d)\n",
+              state->sop->msgid);
+        return EIO;
+    }
+
+    if (result == LDAP_SYNC_REFRESH_REQUIRED) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Server requires a full refresh, dropping the cookie\n");
+        ldap_sync_drop_cookie(state->sync_ctx);
+        ret = EOK;
+        goto done;
+    } else if (result != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Content Synchronization ended with [%d]: %s\n",
+              result, errmsg == NULL ? "-" : errmsg);
+        ret = result == LDAP_UNAVAILABLE_CRITICAL_EXTENSION ? ENOTSUP : EIO;
+        goto done;
+    }
+
+    ctrl = ldap_control_find(LDAP_CONTROL_SYNC_DONE, ctrls, NULL);
+    if (ctrl != NULL && ctrl->ldctl_value.bv_len > 0) {
+        ber = ber_init(&ctrl->ldctl_value);
+        if (ber == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        if (ber_scanf(ber, "{") != LBER_ERROR
+                && ber_peek_tag(ber, &len) == LDAP_TAG_SYNC_COOKIE
+                && ber_scanf(ber, "m", &value) != LBER_ERROR) {
+            ret = ldap_sync_copy_cookie(state, &value, &cookie);
+            if (ret != EOK) {
+                goto done;
+            }
+            ldap_sync_set_cookie(state->sync_ctx, &cookie);
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Server ended the Content Synchronization\n");
+    ret = EOK;
+
+done:
+    if (ber != NULL) {
+        ber_free(ber, 1);
+    }
+    ldap_controls_free(ctrls);
+    ldap_memfree(errmsg);
+    return ret;
+}
+
+static void ldap_sync_reply(struct sdap_op *op, struct sdap_msg *reply,
+                            int error, void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    struct ldap_sync_state *state;
+    int dp_error;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct ldap_sync_state);
+
+    if (error != EOK) {
+        ret = error;
+        goto done;
+    }
+
+    switch (ldap_msgtype(reply->msg)) {
+    case LDAP_RES_SEARCH_ENTRY:
+        ret = ldap_sync_entry(state, reply->msg);
+        if (ret != EOK) {
+            goto done;
+        }
+        sdap_unlock_next_reply(op);
+        return;
+    case LDAP_RES_INTERMEDIATE:
+        ret = ldap_sync_info(state, reply->msg);
+        if (ret != EOK) {
+            goto done;
+        }
+        sdap_unlock_next_reply(op);
+        return;
+    case LDAP_RES_SEARCH_REFERENCE:
+        /* references are not followed */
+        sdap_unlock_next_reply(op);
+        return;
+    case LDAP_RES_SEARCH_RESULT:
+        ret = ldap_sync_result(state, reply->msg);
+        break;
+    default:
+        ret = EIO;
+        break;
+    }
+
+done:
+    ret = sdap_id_op_done(state->op, ret, &dp_error);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Content Synchronization failed [%d]: %s\n",
+              ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+static errno_t ldap_id_sync_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+errno_t ldap_id_setup_sync(struct sdap_id_ctx *id_ctx,
+                           struct sdap_domain *sdom)
+{
+    struct ldap_sync_ctx *sync_ctx;
+    struct be_ptask *task;
+    const char *mode;
+    char *name;
+    errno_t ret;
+
+    mode = dp_opt_get_string(id_ctx->opts->basic, SDAP_SYNC_MODE);
+    if (mode == NULL || strcasecmp(mode, "none") == 0) {
+        return EOK;
+    } else if (strcasecmp(mode, "syncrepl") != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unknown value [%s] of %s\n", mode,
+              id_ctx->opts->basic[SDAP_SYNC_MODE].opt_name);
+        return EINVAL;
+    }
+
+    sync_ctx = talloc_zero(id_ctx, struct ldap_sync_ctx);
+    if (sync_ctx == NULL) {
+        return ENOMEM;
+    }
+    sync_ctx->id_ctx = id_ctx;
+    sync_ctx->sdom = sdom;
+
+    name = talloc_asprintf(NULL, "Content Synchronization of %s",
+                           sdom->dom->name);
+    if (name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* The request only finishes when the search ends; it is started again
+     * after the period, offline the task waits for the backend to return. */
+    ret = be_ptask_create(sync_ctx, id_ctx->be,
+                          LDAP_SYNC_RESTART_PERIOD, /* period */
+                          0,                        /* first_delay */
+                          5,                        /* enabled delay */
+                          0,                        /* random offset */
+                          0,                        /* timeout */
+                          0,                        /* max_backoff */
+                          ldap_id_sync_send, ldap_id_sync_recv,
+                          sync_ctx, name,
+                          BE_PTASK_OFFLINE_DISABLE | BE_PTASK_SCHEDULE_FROM_NOW,
+                          &task);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Unable to initialize Content Synchronization task\n");
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(name);
+    if (ret != EOK) {
+        talloc_free(sync_ctx);
+    }
+    return ret;
+}
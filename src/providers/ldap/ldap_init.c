@@ -76,7 +76,7 @@ static errno_t ldap_init_auth_ctx(TALLOC_CTX *mem_ctx,
 {
     struct sdap_auth_ctx *auth_ctx;
 
-    auth_ctx = talloc(mem_ctx, struct sdap_auth_ctx);
+    auth_ctx = talloc_zero(mem_ctx, struct sdap_auth_ctx);
     if (auth_ctx == NULL) {
         return ENOMEM;
     }
@@ -626,6 +626,14 @@ errno_t sssm_ldap_access_init(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = be_access_cache_init(access_ctx,
+                               dp_opt_get_int(access_ctx->id_ctx->opts->basic,
+                                              SDAP_ACCESS_CACHE_TIMEOUT),
+                               &access_ctx->cache);
+    if (ret != EOK) {
+        goto done;
+    }
+
     dp_set_method(dp_methods, DPM_ACCESS_HANDLER,
                   sdap_pam_access_handler_send, sdap_pam_access_handler_recv, access_ctx,
                   struct sdap_access_ctx, struct pam_data, struct pam_data *);
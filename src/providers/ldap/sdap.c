@@ -19,6 +19,8 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <ctype.h>
+
 #include "util/util.h"
 #include "util/crypto/sss_crypto.h"
 #include "confdb/confdb.h"
@@ -46,12 +48,197 @@ errno_t sdap_copy_map_entry(const struct sdap_attr_map *src_map,
     return EOK;
 }
 
+/* =Map-Index============================================================= */
+
+/* Map entries by lower-cased LDAP name. The index remembers the names it was
+ * built from, so a map whose names were replaced after the index was built
+ * gets a new index before it is used. */
+struct sdap_attr_map_index {
+    hash_table_t *table;    /* name -> first entry with that name */
+    const char **names;     /* map names the index was built from */
+    int *next;              /* next entry with the same name or -1 */
+    int num_entries;
+};
+
+#define SDAP_MAP_KEY_MAX 128
+
+static bool sdap_map_key(const char *name, char *key)
+{
+    size_t i;
+
+    for (i = 0; name[i] != '\0'; i++) {
+        if (i == SDAP_MAP_KEY_MAX - 1) {
+            return false;
+        }
+        key[i] = tolower((unsigned char)name[i]);
+    }
+    key[i] = '\0';
+
+    return true;
+}
+
+static errno_t sdap_map_index_build(struct sdap_attr_map *map,
+                                    int num_entries)
+{
+    struct sdap_attr_map_index *index;
+    char key_buf[SDAP_MAP_KEY_MAX];
+    hash_key_t key;
+    hash_value_t value;
+    int *last;
+    int ret;
+    int i;
+
+    talloc_zfree(map[0].index);
+
+    index = talloc_zero(map, struct sdap_attr_map_index);
+    if (index == NULL) {
+        return ENOMEM;
+    }
+    index->num_entries = num_entries;
+
+    index->names = talloc_array(index, const char *, num_entries);
+    index->next = talloc_array(index, int, num_entries);
+    last = talloc_array(index, int, num_entries);
+    if (index->names == NULL || index->next == NULL || last == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sss_hash_create(index, num_entries, &index->table);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    key.type = HASH_KEY_STRING;
+    key.str = key_buf;
+
+    for (i = 0; i < num_entries; i++) {
+        index->names[i] = map[i].name;
+        index->next[i] = -1;
+
+        /* the first entry is the objectclass */
+        if (i == 0 || map[i].name == NULL) {
+            continue;
+        }
+
+        if (!sdap_map_key(map[i].name, key_buf)) {
+            /* no index for maps the names of which do not fit */
+            ret = E2BIG;
+            goto done;
+        }
+
+        ret = hash_lookup(index->table, &key, &value);
+        if (ret == HASH_SUCCESS) {
+            index->next[last[value.i]] = i;
+            last[value.i] = i;
+            continue;
+        } else if (ret != HASH_ERROR_KEY_NOT_FOUND) {
+            ret = EIO;
+            goto done;
+        }
+
+        value.type = HASH_VALUE_INT;
+        value.i = i;
+        ret = hash_enter(index->table, &key, &value);
+        if (ret != HASH_SUCCESS) {
+            ret = EIO;
+            goto done;
+        }
+        last[i] = i;
+    }
+
+    talloc_free(last);
+    map[0].index = index;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(index);
+    }
+    return ret;
+}
+
+/* Makes sure the index of the map matches its current names. Maps that had
+ * no index from the start, like static ones, are not indexed. */
+static void sdap_map_index_refresh(struct sdap_attr_map *map, int num_entries)
+{
+    struct sdap_attr_map_index *index = map[0].index;
+    errno_t ret;
+    int i;
+
+    if (index == NULL) {
+        return;
+    }
+
+    if (index->num_entries == num_entries) {
+        for (i = 0; i < num_entries; i++) {
+            if (index->names[i] != map[i].name) {
+                break;
+            }
+        }
+        if (i == num_entries) {
+            return;
+        }
+    }
+
+    ret = sdap_map_index_build(map, num_entries);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to index the map [%d]: %s, "
+              "entries will be matched one by one\n", ret, sss_strerror(ret));
+    }
+}
+
+/* Returns the first entry after prev that maps the LDAP attribute attr,
+ * or num_entries if there is none. Use prev = 0 to get the first entry. */
+static int sdap_map_find(struct sdap_attr_map *map, int num_entries,
+                         const char *attr, int prev)
+{
+    struct sdap_attr_map_index *index = map[0].index;
+    char key_buf[SDAP_MAP_KEY_MAX];
+    hash_key_t key;
+    hash_value_t value;
+    int i;
+
+    if (index != NULL && index->num_entries >= num_entries) {
+        if (prev == 0) {
+            if (!sdap_map_key(attr, key_buf)) {
+                return num_entries;
+            }
+
+            key.type = HASH_KEY_STRING;
+            key.str = key_buf;
+            if (hash_lookup(index->table, &key, &value) != HASH_SUCCESS) {
+                return num_entries;
+            }
+            i = value.i;
+        } else {
+            i = index->next[prev];
+        }
+
+        /* the chain is ordered, entries past num_entries are not used */
+        if (i < 0 || i >= num_entries) {
+            return num_entries;
+        }
+        return i;
+    }
+
+    for (i = prev + 1; i < num_entries; i++) {
+        /* check if this attr is valid with the chosen schema */
+        if (!map[i].name) continue;
+        /* check if it is an attr we are interested in */
+        if (strcasecmp(attr, map[i].name) == 0) break;
+    }
+
+    return i;
+}
+
 int sdap_copy_map(TALLOC_CTX *memctx,
                  struct sdap_attr_map *src_map,
                  int num_entries,
                  struct sdap_attr_map **_map)
 {
     struct sdap_attr_map *map;
+    errno_t ret;
     int i;
 
     map = talloc_array(memctx, struct sdap_attr_map, num_entries + 1);
@@ -85,6 +272,15 @@ int sdap_copy_map(TALLOC_CTX *memctx,
     /* Include the sentinel */
     memset(&map[num_entries], 0, sizeof(struct sdap_attr_map));
 
+    map[0].index = NULL;
+    if (num_entries > 0) {
+        ret = sdap_map_index_build(map, num_entries);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to index the map [%d]: %s\n",
+                  ret, sss_strerror(ret));
+        }
+    }
+
     *_map = map;
     return EOK;
 }
@@ -381,6 +577,14 @@ int sdap_get_map(TALLOC_CTX *memctx,
               map[i].name ? map[i].name : "");
     }
 
+    if (num_entries > 0) {
+        ret = sdap_map_index_build(map, num_entries);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to index the map [%d]: %s\n",
+                  ret, sss_strerror(ret));
+        }
+    }
+
     *_map = map;
     return EOK;
 }
@@ -389,16 +593,96 @@ int sdap_get_map(TALLOC_CTX *memctx,
 
 static bool objectclass_matched(struct sdap_attr_map *map,
                                 const char *objcl, int len);
+
+static errno_t sdap_parse_entry_add_range(TALLOC_CTX *mem_ctx,
+                                          struct sysdb_attrs *attrs,
+                                          const char *attr_desc,
+                                          const char *base_attr,
+                                          struct sdap_attr_map *map,
+                                          int attrs_num,
+                                          int base_attr_idx,
+                                          struct sdap_range_pending **_pending,
+                                          size_t *_num_pending)
+{
+    struct sdap_range_pending *pending;
+    const char *dn;
+    uint32_t start;
+    uint32_t end;
+    bool last;
+    size_t num_names = 0;
+    int ai;
+    errno_t ret;
+
+    ret = sdap_parse_range_bounds(attr_desc, base_attr, &start, &end, &last);
+    if (ret != EOK || last) {
+        /* sdap_parse_range() accepted it, keep the values we have */
+        return EOK;
+    }
+
+    ret = sysdb_attrs_get_string(attrs, SYSDB_ORIG_DN, &dn);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    pending = talloc_realloc(mem_ctx, *_pending, struct sdap_range_pending,
+                             *_num_pending + 1);
+    if (pending == NULL) {
+        return ENOMEM;
+    }
+    *_pending = pending;
+    pending = &pending[*_num_pending];
+
+    pending->attrs = attrs;
+    pending->offset = end + 1;
+    pending->step = end - start + 1;
+    pending->dn = talloc_strdup(*_pending, dn);
+    pending->base_attr = talloc_strdup(*_pending, base_attr);
+    pending->sys_names = talloc_zero_array(*_pending, const char *,
+                                           attrs_num + 2);
+    if (pending->dn == NULL || pending->base_attr == NULL
+            || pending->sys_names == NULL) {
+        return ENOMEM;
+    }
+
+    if (map != NULL) {
+        for (ai = base_attr_idx; ai < attrs_num;
+             ai = sdap_map_find(map, attrs_num, base_attr, ai)) {
+            pending->sys_names[num_names++] = map[ai].sys_name;
+        }
+    } else {
+        pending->sys_names[num_names++] = pending->base_attr;
+    }
+
+    DEBUG(SSSDBG_TRACE_LIBS, "[%s] of [%s] continues at value %u\n",
+          base_attr, dn, pending->offset);
+    (*_num_pending)++;
+    return EOK;
+}
+
 int sdap_parse_entry(TALLOC_CTX *memctx,
                      struct sdap_handle *sh, struct sdap_msg *sm,
                      struct sdap_attr_map *map, int attrs_num,
                      struct sysdb_attrs **_attrs,
                      bool disable_range_retrieval)
+{
+    return sdap_parse_entry_ranges(memctx, sh, sm, map, attrs_num, _attrs,
+                                   disable_range_retrieval, NULL, NULL);
+}
+
+int sdap_parse_entry_ranges(TALLOC_CTX *memctx,
+                            struct sdap_handle *sh, struct sdap_msg *sm,
+                            struct sdap_attr_map *map, int attrs_num,
+                            struct sysdb_attrs **_attrs,
+                            bool disable_range_retrieval,
+                            struct sdap_range_pending **_pending,
+                            size_t *_num_pending)
 {
     struct sysdb_attrs *attrs;
     BerElement *ber = NULL;
     struct berval **vals;
-    struct ldb_val v;
+    struct ldb_val *ldb_vals;
+    struct ldb_val *v;
+    size_t num_vals;
     char *str;
     int lerrno;
     int i, ret, ai;
@@ -408,9 +692,14 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
     bool base64;
     char *base_attr;
     uint32_t range_offset;
+    bool ranged;
+    struct sdap_range_pending *pending = NULL;
+    size_t num_pending = 0;
     TALLOC_CTX *tmp_ctx = talloc_new(NULL);
     if (!tmp_ctx) return ENOMEM;
 
+    SSS_PROF_PUSH("sdap_parse_entry");
+
     lerrno = 0;
     ret = ldap_set_option(sh->ldap, LDAP_OPT_RESULT_CODE, &lerrno);
     if (ret != LDAP_OPT_SUCCESS) {
@@ -440,6 +729,8 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
     if (ret) goto done;
 
     if (map) {
+        sdap_map_index_refresh(map, attrs_num);
+
         vals = ldap_get_values_len(sh->ldap, sm->msg, "objectClass");
         if (!vals) {
             DEBUG(SSSDBG_CRIT_FAILURE,
@@ -482,13 +773,12 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
 
         ret = sdap_parse_range(tmp_ctx, str, &base_attr, &range_offset,
                                disable_range_retrieval);
+        ranged = (ret == EAGAIN);
         switch(ret) {
         case EAGAIN:
             /* This attribute contained range values and needs more to
-             * be retrieved
-             */
-            /* TODO: return the set of attributes that need additional retrieval
-             * For now, we'll continue below and treat it as regular values.
+             * be retrieved. The caller reads the remaining ranges if it
+             * asked for them, the values of this one are stored below.
              */
             /* FALLTHROUGH */
         case ECANCELED:
@@ -504,12 +794,7 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
         if (ret == ECANCELED) {
             store = false;
         } else if (map) {
-            for (i = 1; i < attrs_num; i++) {
-                /* check if this attr is valid with the chosen schema */
-                if (!map[i].name) continue;
-                /* check if it is an attr we are interested in */
-                if (strcasecmp(base_attr, map[i].name) == 0) break;
-            }
+            i = sdap_map_find(map, attrs_num, base_attr, 0);
             /* interesting attr */
             if (i < attrs_num) {
                 store = true;
@@ -550,6 +835,16 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
                     ret = EINVAL;
                     goto done;
                 }
+                for (num_vals = 0; vals[num_vals]; num_vals++) ;
+
+                ldb_vals = talloc_array(tmp_ctx, struct ldb_val, num_vals);
+                if (ldb_vals == NULL) {
+                    ldap_value_free_len(vals);
+                    ret = ENOMEM;
+                    goto done;
+                }
+
+                num_vals = 0;
                 for (i = 0; vals[i]; i++) {
                     if (vals[i]->bv_len == 0) {
                         DEBUG(SSSDBG_TRACE_LIBS,
@@ -557,53 +852,60 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
                                "Skipping this value.\n", str);
                         continue;
                     }
+                    v = &ldb_vals[num_vals];
                     if (base64) {
-                        v.data = (uint8_t *) sss_base64_encode(attrs,
+                        v->data = (uint8_t *) sss_base64_encode(ldb_vals,
                                  (uint8_t *) vals[i]->bv_val, vals[i]->bv_len);
-                        if (!v.data) {
+                        if (!v->data) {
                             ldap_value_free_len(vals);
                             ret = ENOMEM;
                             goto done;
                         }
-                        v.length = strlen((const char *)v.data);
+                        v->length = strlen((const char *)v->data);
                     } else {
-                        v.data = (uint8_t *)vals[i]->bv_val;
-                        v.length = vals[i]->bv_len;
+                        v->data = (uint8_t *)vals[i]->bv_val;
+                        v->length = vals[i]->bv_len;
                     }
-                    PROBE(SDAP_PARSE_ENTRY, str, v.data, v.length);
-
-                    if (map) {
-                        /* The same LDAP attr might be used for more sysdb
-                         * attrs in case there is a map. Find all that match
-                         * and copy the value
-                         */
-                        for (ai = base_attr_idx; ai < attrs_num; ai++) {
-                            /* check if this attr is valid with the chosen
-                             * schema */
-                            if (!map[ai].name) continue;
-
-                            /* check if it is an attr we are interested in */
-                            if (strcasecmp(base_attr, map[ai].name) == 0) {
-                                ret = sysdb_attrs_add_val(attrs,
-                                                          map[ai].sys_name,
-                                                          &v);
-                                if (ret) {
-                                    ldap_value_free_len(vals);
-                                    goto done;
-                                }
-                            }
-                        }
-                    } else {
-                        /* No map, just store the attribute */
-                        ret = sysdb_attrs_add_val(attrs, name, &v);
+                    PROBE(SDAP_PARSE_ENTRY, str, v->data, v->length);
+                    num_vals++;
+                }
+
+                if (map) {
+                    /* The same LDAP attr might be used for more sysdb
+                     * attrs in case there is a map. Find all that match
+                     * and copy the values
+                     */
+                    for (ai = base_attr_idx; ai < attrs_num;
+                         ai = sdap_map_find(map, attrs_num, base_attr, ai)) {
+                        ret = sysdb_attrs_add_vals(attrs, map[ai].sys_name,
+                                                   ldb_vals, num_vals);
                         if (ret) {
                             ldap_value_free_len(vals);
                             goto done;
                         }
                     }
+                } else {
+                    /* No map, just store the attribute */
+                    ret = sysdb_attrs_add_vals(attrs, name,
+                                               ldb_vals, num_vals);
+                    if (ret) {
+                        ldap_value_free_len(vals);
+                        goto done;
+                    }
                 }
+                talloc_free(ldb_vals);
                 ldap_value_free_len(vals);
             }
+
+            if (ranged && _pending != NULL) {
+                ret = sdap_parse_entry_add_range(tmp_ctx, attrs, str,
+                                                 base_attr, map, attrs_num,
+                                                 base_attr_idx,
+                                                 &pending, &num_pending);
+                if (ret != EOK) {
+                    goto done;
+                }
+            }
         }
 
         ldap_memfree(str);
@@ -622,11 +924,16 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
 
     PROBE(SDAP_PARSE_ENTRY_DONE);
     *_attrs = talloc_steal(memctx, attrs);
+    if (_pending != NULL) {
+        *_pending = talloc_steal(memctx, pending);
+        *_num_pending = num_pending;
+    }
     ret = EOK;
 
 done:
     if (ber) ber_free(ber, 0);
     talloc_free(tmp_ctx);
+    SSS_PROF_POP("sdap_parse_entry");
     return ret;
 }
 
@@ -759,6 +1066,8 @@ errno_t sdap_parse_deref(TALLOC_CTX *mem_ctx,
         }
         if (!map) continue;
 
+        sdap_map_index_refresh(map, num_attrs);
+
         res[mi]->attrs = sysdb_new_attrs(res[mi]);
         if (!res[mi]->attrs) {
             ret = ENOMEM;
@@ -785,12 +1094,7 @@ errno_t sdap_parse_deref(TALLOC_CTX *mem_ctx,
             DEBUG(SSSDBG_TRACE_INTERNAL,
                   "Dereferenced attribute: %s\n", dval->type);
 
-            for (a = 1; a < num_attrs; a++) {
-                /* check if this attr is valid with the chosen schema */
-                if (!map[a].name) continue;
-                /* check if it is an attr we are interested in */
-                if (strcasecmp(dval->type, map[a].name) == 0) break;
-            }
+            a = sdap_map_find(map, num_attrs, dval->type, 0);
 
             /* interesting attr */
             if (a < num_attrs) {
@@ -824,10 +1128,20 @@ done:
     return ret;
 }
 
+static void sss_ldap_vdebug(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    sss_vdebug_fn(__FILE__, __LINE__, "sss_ldap_debug", SSSDBG_TRACE_ALL, 0,
+                  format, ap);
+    va_end(ap);
+}
+
+/* enabled by ldap_library_debug_level, so written at any debug_level */
 static void sss_ldap_debug(const char *buf)
 {
-    sss_debug_fn(__FILE__, __LINE__, __FUNCTION__, SSSDBG_TRACE_ALL,
-                "libldap: %s", buf);
+    sss_ldap_vdebug("libldap: %s", buf);
 }
 
 void setup_ldap_debug(struct dp_option *basic_opts)
@@ -1883,3 +2197,130 @@ void sdap_domain_copy_search_bases(struct sdap_domain *to,
     to->ipnetwork_search_bases = from->ipnetwork_search_bases;
     to->autofs_search_bases = from->autofs_search_bases;
 }
+
+struct sdap_server_tuning *
+sdap_server_tuning_get(struct sdap_service *service,
+                       struct sdap_options *opts,
+                       const char *uri)
+{
+    struct sdap_server_tuning *tuning;
+    int timeout;
+
+    DLIST_FOR_EACH(tuning, service->tuning_list) {
+        if (strcmp(tuning->uri, uri) == 0) {
+            return tuning;
+        }
+    }
+
+    tuning = talloc_zero(service, struct sdap_server_tuning);
+    if (tuning == NULL) {
+        return NULL;
+    }
+
+    tuning->uri = talloc_strdup(tuning, uri);
+    if (tuning->uri == NULL) {
+        talloc_free(tuning);
+        return NULL;
+    }
+
+    tuning->page_size = dp_opt_get_int(opts->basic, SDAP_PAGE_SIZE);
+    tuning->min_page_size = dp_opt_get_int(opts->basic, SDAP_PAGE_SIZE_MIN);
+    tuning->max_page_size = dp_opt_get_int(opts->basic, SDAP_PAGE_SIZE_MAX);
+    if (tuning->max_page_size <= tuning->page_size) {
+        /* the page size is fixed */
+        tuning->min_page_size = tuning->page_size;
+        tuning->max_page_size = tuning->page_size;
+    } else if (tuning->min_page_size < 1) {
+        tuning->min_page_size = 1;
+    } else if (tuning->min_page_size > tuning->page_size) {
+        tuning->min_page_size = tuning->page_size;
+    }
+
+    tuning->max_pool_size = dp_opt_get_int(opts->basic,
+                                           SDAP_CONNECTION_POOL_SIZE);
+    if (tuning->max_pool_size < 1) {
+        tuning->max_pool_size = 1;
+    }
+    tuning->pool_size = tuning->max_pool_size;
+
+    timeout = dp_opt_get_int(opts->basic, SDAP_SEARCH_TIMEOUT);
+    if (timeout < 1) {
+        timeout = 1;
+    }
+    tuning->grow_usecs = (uint64_t)timeout * 1000000 / 10;
+    tuning->shrink_usecs = (uint64_t)timeout * 1000000 / 3;
+
+    DLIST_ADD(service->tuning_list, tuning);
+
+    return tuning;
+}
+
+bool sdap_server_tuning_update(struct sdap_server_tuning *tuning,
+                               ber_int_t page_size,
+                               int num_entries,
+                               uint64_t usecs)
+{
+    ber_int_t old_page_size;
+    int old_pool_size;
+
+    if (tuning == NULL) {
+        return false;
+    }
+
+    if (tuning->page_usecs == 0) {
+        tuning->page_usecs = usecs;
+    } else {
+        tuning->page_usecs = (tuning->page_usecs * 3 + usecs) / 4;
+    }
+
+    if (tuning->max_page_size == tuning->min_page_size) {
+        return false;
+    }
+
+    old_page_size = tuning->page_size;
+    old_pool_size = tuning->pool_size;
+
+    if (tuning->page_usecs > tuning->shrink_usecs) {
+        tuning->page_size = MAX(tuning->page_size / 2,
+                                tuning->min_page_size);
+        tuning->pool_size = MAX(tuning->pool_size - 1, 1);
+    } else if (tuning->page_usecs < tuning->grow_usecs
+                   && num_entries >= page_size) {
+        /* only a full page tells how fast a larger one would be */
+        tuning->page_size = MIN(tuning->page_size * 2,
+                                tuning->max_page_size);
+        tuning->pool_size = MIN(tuning->pool_size + 1,
+                                tuning->max_pool_size);
+    }
+
+    if (tuning->page_size == old_page_size
+            && tuning->pool_size == old_pool_size) {
+        return false;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Pages from [%s] take %"PRIu64" ms, "
+          "changing the page size from %d to %d and the number of "
+          "connections from %d to %d\n", tuning->uri,
+          tuning->page_usecs / 1000, old_page_size, tuning->page_size,
+          old_pool_size, tuning->pool_size);
+
+    /* expect the time to follow the page size until it is measured */
+    tuning->page_usecs = tuning->page_usecs * tuning->page_size
+                             / old_page_size;
+
+    return true;
+}
+
+int sdap_service_pool_size(struct sdap_service *service,
+                           struct sdap_options *opts)
+{
+    int pool_size;
+
+    if (service != NULL && service->tuning != NULL) {
+        return service->tuning->pool_size;
+    }
+
+    pool_size = dp_opt_get_int(opts->basic, SDAP_CONNECTION_POOL_SIZE);
+
+    return pool_size < 1 ? 1 : pool_size;
+}
@@ -45,6 +45,11 @@ struct sdap_op {
 
     int msgid;
     bool done;
+    /* when the request was sent, until the first reply arrives */
+    struct timeval start;
+    bool replied;
+    /* of the request that sent it, restored when the replies arrive */
+    uint32_t trace_id;
 
     sdap_op_callback_t *callback;
     void *data;
@@ -73,6 +78,31 @@ struct sup_list {
     char **vals;
 };
 
+/* Paged search tuning of one server, kept by its service across
+ * reconnects. The page size and the number of pooled connections only
+ * change if ldap_page_size_max is larger than ldap_page_size. */
+struct sdap_server_tuning {
+    struct sdap_server_tuning *prev, *next;
+    char *uri;
+
+    /* where the values are reported, set on connect */
+    struct be_ctx *be;
+    const char *service_name;
+
+    ber_int_t page_size;
+    ber_int_t min_page_size;
+    ber_int_t max_page_size;
+    int pool_size;
+    int max_pool_size;
+
+    /* full pages faster than grow_usecs grow the page size, pages
+     * slower than shrink_usecs shrink it */
+    uint64_t grow_usecs;
+    uint64_t shrink_usecs;
+    /* moving average of the time a page takes */
+    uint64_t page_usecs;
+};
+
 struct sdap_handle {
     LDAP *ldap;
     bool connected;
@@ -81,6 +111,11 @@ struct sdap_handle {
     ber_int_t page_size;
     bool disable_deref;
 
+    /* owned by the service, may be NULL */
+    struct sdap_server_tuning *tuning;
+    /* the server the latencies are reported to, may be NULL */
+    struct fo_server *srv;
+
     struct sdap_fd_events *sdap_fd_events;
 
     struct sup_list supported_saslmechs;
@@ -96,11 +131,35 @@ struct sdap_handle {
     bool release_memory;
 };
 
+/* The TGT ldap_child obtained for the connections of a service. It is
+ * used by new connections until shortly before it expires and refreshed
+ * in the background before that. */
+struct sdap_kinit_cache {
+    char *ccname;
+    char *principal;
+    char *realm;
+    time_t expire_time;
+
+    struct tevent_context *ev;
+    struct be_ctx *be;
+    struct sdap_options *opts;
+    struct sdap_service *service;
+    struct tevent_timer *refresh_te;
+    struct tevent_req *refresh_req;
+};
+
 struct sdap_service {
     char *name;
     char *uri;
     char *kinit_service_name;
     struct sockaddr_storage *sockaddr;
+
+    /* tuning of every server connected so far and of the last one */
+    struct sdap_server_tuning *tuning_list;
+    struct sdap_server_tuning *tuning;
+
+    /* may be NULL */
+    struct sdap_kinit_cache *kinit_cache;
 };
 
 struct sdap_ppolicy_data {
@@ -241,6 +300,17 @@ enum sdap_basic_opt {
     SDAP_PWDLOCKOUT_DN,
     SDAP_WILDCARD_LIMIT,
     SDAP_LIBRARY_DEBUG_LEVEL,
+    SDAP_CONNECTION_POOL_SIZE,
+    SDAP_GROUP_MEMBER_BATCH_SIZE,
+    SDAP_SYNC_MODE,
+    SDAP_PAGE_SIZE_MIN,
+    SDAP_PAGE_SIZE_MAX,
+    SDAP_CONNECTION_RACE_SERVERS,
+    SDAP_CONNECTION_RACE_DELAY,
+    SDAP_AUTH_CONN_POOL_SIZE,
+    SDAP_NESTED_GROUP_PARALLEL,
+    SDAP_SAVE_CHUNK_SIZE,
+    SDAP_ACCESS_CACHE_TIMEOUT,
 
     SDAP_OPTS_BASIC /* opts counter */
 };
@@ -402,13 +472,19 @@ enum sdap_autofs_entry_attrs {
     SDAP_OPTS_AUTOFS_ENTRY  /* attrs counter */
 };
 
+struct sdap_attr_map_index;
+
 struct sdap_attr_map {
     const char *opt_name;
     const char *def_name;
     const char *sys_name;
     char *name;
+
+    /* lookup by LDAP name, only set in the first entry of maps created
+     * by sdap_get_map() or sdap_copy_map() */
+    struct sdap_attr_map_index *index;
 };
-#define SDAP_ATTR_MAP_TERMINATOR { NULL, NULL, NULL, NULL }
+#define SDAP_ATTR_MAP_TERMINATOR { NULL, NULL, NULL, NULL, NULL }
 
 struct sdap_search_base {
     const char *basedn;
@@ -618,6 +694,18 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
                      struct sysdb_attrs **_attrs,
                      bool disable_range_retrieval);
 
+struct sdap_range_pending;
+
+/* Like sdap_parse_entry(), but also returns the attributes of which the
+ * server returned only the first range of values */
+int sdap_parse_entry_ranges(TALLOC_CTX *memctx,
+                            struct sdap_handle *sh, struct sdap_msg *sm,
+                            struct sdap_attr_map *map, int attrs_num,
+                            struct sysdb_attrs **_attrs,
+                            bool disable_range_retrieval,
+                            struct sdap_range_pending **_pending,
+                            size_t *_num_pending);
+
 errno_t sdap_parse_deref(TALLOC_CTX *mem_ctx,
                          struct sdap_attr_map_info *minfo,
                          size_t num_maps,
@@ -705,4 +793,18 @@ bool sdap_object_in_domain(struct sdap_options *opts,
 void sdap_domain_copy_search_bases(struct sdap_domain *to,
                                    struct sdap_domain *from);
 
+struct sdap_server_tuning *
+sdap_server_tuning_get(struct sdap_service *service,
+                       struct sdap_options *opts,
+                       const char *uri);
+
+/* Returns true if the page size or the pool size changed */
+bool sdap_server_tuning_update(struct sdap_server_tuning *tuning,
+                               ber_int_t page_size,
+                               int num_entries,
+                               uint64_t usecs);
+
+int sdap_service_pool_size(struct sdap_service *service,
+                           struct sdap_options *opts);
+
 #endif /* _SDAP_H_ */
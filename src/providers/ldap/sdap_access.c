@@ -119,6 +119,7 @@ struct sdap_access_req_ctx {
 static errno_t sdap_access_check_next_rule(struct sdap_access_req_ctx *state,
                                            struct tevent_req *req);
 static void sdap_access_done(struct tevent_req *subreq);
+static errno_t sdap_access_filter_cached(struct sdap_access_req_ctx *state);
 
 struct tevent_req *
 sdap_access_send(TALLOC_CTX *mem_ctx,
@@ -258,6 +259,11 @@ static errno_t sdap_access_check_next_rule(struct sdap_access_req_ctx *state,
             return EAGAIN;
 
         case LDAP_ACCESS_FILTER:
+            ret = sdap_access_filter_cached(state);
+            if (ret != ENOENT) {
+                break;
+            }
+
             subreq = sdap_access_filter_send(state, state->ev, state->be_ctx,
                                              state->domain,
                                              state->access_ctx,
@@ -826,6 +832,7 @@ struct sdap_access_filter_req_ctx {
     /* cached result of access control checks */
     bool cached_access;
     const char *basedn;
+    uint32_t cache_state;
 };
 
 static errno_t sdap_access_decide_offline(bool cached_ac);
@@ -875,6 +882,8 @@ static struct tevent_req *sdap_access_filter_send(TALLOC_CTX *mem_ctx,
     state->cached_access = ldb_msg_find_attr_as_bool(user_entry,
                                                      SYSDB_LDAP_ACCESS_FILTER,
                                                      false);
+    state->cache_state = be_access_cache_user_state(user_entry,
+                                                    access_ctx->filter);
 
     /* Ok, we have one result, check if we are online or offline */
     if (be_is_offline(be_ctx)) {
@@ -1103,6 +1112,12 @@ static void sdap_access_filter_done(struct tevent_req *subreq)
         ret = ERR_ACCESS_DENIED;
     }
 
+    tret = be_access_cache_add(state->access_ctx->cache, state->username,
+                               state->cache_state, found);
+    if (tret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Failed to cache the access decision\n");
+    }
+
     tret = sdap_save_user_cache_bool(state->domain, state->username,
                                      SYSDB_LDAP_ACCESS_FILTER, found);
     if (tret != EOK) {
@@ -1129,6 +1144,102 @@ static errno_t sdap_access_filter_recv(struct tevent_req *req)
     return EOK;
 }
 
+static void sdap_access_filter_refresh_done(struct tevent_req *subreq)
+{
+    TALLOC_CTX *refresh_ctx;
+    errno_t ret;
+
+    refresh_ctx = tevent_req_callback_data(subreq, TALLOC_CTX);
+
+    /* the filter request updated the cache */
+    ret = sdap_access_filter_recv(subreq);
+    if (ret != EOK && ret != ERR_ACCESS_DENIED) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Refreshing the access filter result failed [%d]: %s\n",
+              ret, sss_strerror(ret));
+    }
+
+    talloc_free(refresh_ctx);
+}
+
+/* Checks the filter again for the next sessions of the user while the
+ * current one continues with the cached result. The request works on copies
+ * of the data which does not live as long as the cache. */
+static void sdap_access_filter_refresh(struct sdap_access_req_ctx *state)
+{
+    struct sdap_access_ctx *access_ctx;
+    struct ldb_message *user_entry;
+    struct tevent_req *subreq;
+    TALLOC_CTX *refresh_ctx;
+    const char *username;
+
+    refresh_ctx = talloc_new(state->access_ctx->cache);
+    if (refresh_ctx == NULL) {
+        return;
+    }
+
+    access_ctx = talloc_memdup(refresh_ctx, state->access_ctx,
+                               sizeof(struct sdap_access_ctx));
+    user_entry = ldb_msg_copy(refresh_ctx, state->user_entry);
+    username = talloc_strdup(refresh_ctx, state->pd->user);
+    if (access_ctx == NULL || user_entry == NULL || username == NULL) {
+        goto fail;
+    }
+
+    access_ctx->filter = talloc_strdup(access_ctx, state->access_ctx->filter);
+    if (access_ctx->filter == NULL) {
+        goto fail;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Refreshing the access filter result of [%s]\n", username);
+
+    subreq = sdap_access_filter_send(refresh_ctx, state->ev, state->be_ctx,
+                                     state->domain, access_ctx, state->conn,
+                                     username, user_entry);
+    if (subreq == NULL) {
+        goto fail;
+    }
+    tevent_req_set_callback(subreq, sdap_access_filter_refresh_done,
+                            refresh_ctx);
+    return;
+
+fail:
+    DEBUG(SSSDBG_MINOR_FAILURE,
+          "Unable to refresh the access filter result\n");
+    talloc_free(refresh_ctx);
+}
+
+/* Returns the recent result of the filter check of the user or ENOENT. The
+ * cache is only used while online, offline the result kept in sysdb is
+ * used as before. */
+static errno_t sdap_access_filter_cached(struct sdap_access_req_ctx *state)
+{
+    uint32_t cache_state;
+    bool allowed;
+    bool refresh;
+    errno_t ret;
+
+    if (state->access_ctx->cache == NULL || be_is_offline(state->be_ctx)
+            || state->access_ctx->filter == NULL) {
+        return ENOENT;
+    }
+
+    cache_state = be_access_cache_user_state(state->user_entry,
+                                             state->access_ctx->filter);
+    ret = be_access_cache_check(state->access_ctx->cache, state->pd->user,
+                                cache_state, &allowed, &refresh);
+    if (ret != EOK) {
+        return ENOENT;
+    }
+
+    if (refresh) {
+        sdap_access_filter_refresh(state);
+    }
+
+    return allowed ? EOK : ERR_ACCESS_DENIED;
+}
+
 #define AUTHR_SRV_MISSING_MSG "Authorized service attribute missing, " \
                               "access denied"
 #define AUTHR_SRV_DENY_MSG "Access denied by authorized service attribute"
@@ -26,6 +26,7 @@
 #define SDAP_ACCESS_H_
 
 #include "providers/backend.h"
+#include "providers/be_access_cache.h"
 #include "providers/ldap/ldap_common.h"
 
 /* Attributes in sysdb, used for caching last values of lockout or filter
@@ -75,6 +76,8 @@ struct sdap_access_ctx {
     struct sdap_id_ctx *id_ctx;
     const char *filter;
     int access_rule[LDAP_ACCESS_LAST + 1];
+    /* recent results of the filter check, NULL if disabled */
+    struct be_access_cache *cache;
 };
 
 struct tevent_req *
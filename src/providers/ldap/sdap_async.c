@@ -25,6 +25,7 @@
 #include "util/strtonum.h"
 #include "util/probes.h"
 #include "providers/ldap/sdap_async_private.h"
+#include "providers/ldap/sdap_range.h"
 
 #define REPLY_REALLOC_INCREMENT 10
 
@@ -245,6 +246,22 @@ static const char *sdap_ldap_result_str(int msgtype)
  * NOTE: this function may even end up freeing the sdap_handle
  * so sdap_handle must not be used after this function is called
  */
+static void sdap_op_report_latency(struct sdap_op *op)
+{
+    struct timeval now;
+    uint64_t usecs;
+
+    if (op->sh->srv == NULL) {
+        return;
+    }
+
+    now = tevent_timeval_current();
+    usecs = (now.tv_sec - op->start.tv_sec) * UINT64_C(1000000)
+            + now.tv_usec - op->start.tv_usec;
+
+    fo_set_server_latency(op->sh->srv, FO_LATENCY_OPERATION, usecs);
+}
+
 static void sdap_process_message(struct tevent_context *ev,
                                  struct sdap_handle *sh, LDAPMessage *msg)
 {
@@ -283,13 +300,22 @@ static void sdap_process_message(struct tevent_context *ev,
         return;
     }
 
+    debug_trace_id = op->trace_id;
+
     DEBUG(SSSDBG_TRACE_ALL,
           "Message type: [%s]\n", sdap_ldap_result_str(msgtype));
 
+    if (!op->replied) {
+        op->replied = true;
+        sdap_op_report_latency(op);
+    }
+
     switch (msgtype) {
     case LDAP_RES_SEARCH_ENTRY:
     case LDAP_RES_SEARCH_REFERENCE:
-        /* go and process entry */
+    case LDAP_RES_INTERMEDIATE:
+        /* go and process entry, intermediate responses are followed
+         * by more results with this msgid */
         break;
 
     case LDAP_RES_BIND:
@@ -300,7 +326,6 @@ static void sdap_process_message(struct tevent_context *ev,
     case LDAP_RES_MODDN:
     case LDAP_RES_COMPARE:
     case LDAP_RES_EXTENDED:
-    case LDAP_RES_INTERMEDIATE:
         /* no more results expected with this msgid */
         op->done = true;
         break;
@@ -342,7 +367,7 @@ static void sdap_process_message(struct tevent_context *ev,
     }
 }
 
-static void sdap_unlock_next_reply(struct sdap_op *op)
+void sdap_unlock_next_reply(struct sdap_op *op)
 {
     struct timeval tv;
     struct tevent_timer *te;
@@ -382,6 +407,7 @@ static void sdap_process_next_reply(struct tevent_context *ev,
 {
     struct sdap_op *op = talloc_get_type(pvt, struct sdap_op);
 
+    debug_trace_id = op->trace_id;
     op->callback(op, op->list, EOK, op->data);
 }
 
@@ -418,6 +444,8 @@ static void sdap_op_timeout(struct tevent_req *req)
         return;
     }
 
+    debug_trace_id = op->trace_id;
+
     /* signal the caller that we have a timeout */
     DEBUG(SSSDBG_TRACE_LIBS, "Issuing timeout for %d\n", op->msgid);
     op->callback(op, NULL, ETIMEDOUT, op->data);
@@ -438,6 +466,8 @@ int sdap_op_add(TALLOC_CTX *memctx, struct tevent_context *ev,
     op->callback = callback;
     op->data = data;
     op->ev = ev;
+    op->start = tevent_timeval_current();
+    op->trace_id = debug_trace_id;
 
     DEBUG(SSSDBG_TRACE_INTERNAL,
           "New operation %d timeout %d\n", op->msgid, timeout);
@@ -694,6 +724,103 @@ errno_t sdap_exop_modify_passwd_recv(struct tevent_req *req,
     return EOK;
 }
 
+struct sdap_fast_bind_state {
+    struct sdap_handle *sh;
+    struct sdap_op *op;
+};
+
+static void sdap_fast_bind_done(struct sdap_op *op,
+                                struct sdap_msg *reply,
+                                int error, void *pvt);
+
+struct tevent_req *sdap_fast_bind_send(TALLOC_CTX *mem_ctx,
+                                       struct tevent_context *ev,
+                                       struct sdap_handle *sh,
+                                       int timeout)
+{
+    struct sdap_fast_bind_state *state;
+    struct tevent_req *req;
+    int msgid;
+    int ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sdap_fast_bind_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    state->sh = sh;
+
+    ret = ldap_extended_operation(state->sh->ldap, LDAP_SERVER_FAST_BIND_OID,
+                                  NULL, NULL, NULL, &msgid);
+    if (ret != LDAP_SUCCESS || msgid == -1) {
+        DEBUG(SSSDBG_OP_FAILURE, "ldap_extended_operation failed: %s\n",
+              sss_ldap_err2string(ret));
+        ret = ERR_NETWORK_IO;
+        goto fail;
+    }
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "ldap_extended_operation sent, msgid = %d\n", msgid);
+
+    ret = sdap_op_add(state, ev, state->sh, msgid,
+                      sdap_fast_bind_done, req, timeout, &state->op);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to set up operation!\n");
+        ret = ERR_INTERNAL;
+        goto fail;
+    }
+
+    return req;
+
+fail:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static void sdap_fast_bind_done(struct sdap_op *op,
+                                struct sdap_msg *reply,
+                                int error, void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    struct sdap_fast_bind_state *state = tevent_req_data(req,
+                                                struct sdap_fast_bind_state);
+    char *errmsg = NULL;
+    int result;
+    int ret;
+
+    if (error) {
+        tevent_req_error(req, error);
+        return;
+    }
+
+    ret = ldap_parse_result(state->sh->ldap, reply->msg,
+                            &result, NULL, &errmsg, NULL, NULL, 0);
+    if (ret != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "ldap_parse_result failed (%d)\n", state->op->msgid);
+        tevent_req_error(req, ERR_INTERNAL);
+        return;
+    }
+
+    if (result != LDAP_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Fast bind was refused: %s(%d), %s\n",
+              sss_ldap_err2string(result), result, errmsg);
+        ldap_memfree(errmsg);
+        tevent_req_error(req, ENOTSUP);
+        return;
+    }
+
+    ldap_memfree(errmsg);
+    tevent_req_done(req);
+}
+
+errno_t sdap_fast_bind_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
 struct sdap_modify_state {
     struct tevent_context *ev;
     struct sdap_handle *sh;
@@ -1304,6 +1431,14 @@ struct sdap_get_generic_ext_state {
 
     struct berval cookie;
 
+    /* for the profiler */
+    struct timeval start;
+
+    /* the current page, for the server tuning */
+    ber_int_t page_size;
+    int page_entries;
+    struct timeval page_start;
+
     LDAPControl **serverctrls;
     int nserverctrls;
     LDAPControl **clientctrls;
@@ -1436,6 +1571,7 @@ sdap_get_generic_ext_send(TALLOC_CTX *memctx,
 
     PROBE(SDAP_GET_GENERIC_EXT_SEND, state->search_base,
           state->scope, state->filter, state->attrs);
+    state->start = tevent_timeval_current();
 
     ret = sdap_get_generic_ext_step(req);
     if (ret != EOK) {
@@ -1447,6 +1583,31 @@ sdap_get_generic_ext_send(TALLOC_CTX *memctx,
     return req;
 }
 
+static void
+sdap_get_generic_ext_tune(struct sdap_get_generic_ext_state *state)
+{
+    struct sdap_server_tuning *tuning = state->sh->tuning;
+    struct timeval now;
+    uint64_t usecs;
+
+    if (tuning == NULL || state->page_size == 0) {
+        return;
+    }
+
+    now = tevent_timeval_current();
+    usecs = (now.tv_sec - state->page_start.tv_sec) * UINT64_C(1000000)
+            + now.tv_usec - state->page_start.tv_usec;
+
+    sdap_server_tuning_update(tuning, state->page_size,
+                              state->page_entries, usecs);
+
+    if (tuning->be != NULL) {
+        be_fo_set_server_tuning(tuning->be, tuning->service_name,
+                                tuning->page_size, tuning->pool_size,
+                                tuning->page_usecs / 1000);
+    }
+}
+
 static errno_t sdap_get_generic_ext_step(struct tevent_req *req)
 {
     struct sdap_get_generic_ext_state *state =
@@ -1457,6 +1618,7 @@ static errno_t sdap_get_generic_ext_step(struct tevent_req *req)
     errno_t ret;
     int msgid;
     bool disable_paging;
+    ber_int_t page_size;
 
     LDAPControl *page_control = NULL;
 
@@ -1487,8 +1649,10 @@ static errno_t sdap_get_generic_ext_step(struct tevent_req *req)
             && (state->flags & SDAP_SRCH_FLG_PAGING)
             && sdap_is_control_supported(state->sh,
                                          LDAP_CONTROL_PAGEDRESULTS)) {
+        page_size = state->sh->tuning != NULL ? state->sh->tuning->page_size
+                                              : state->sh->page_size;
         lret = ldap_create_page_control(state->sh->ldap,
-                                        state->sh->page_size,
+                                        page_size,
                                         state->cookie.bv_val ?
                                             &state->cookie :
                                             NULL,
@@ -1500,6 +1664,10 @@ static errno_t sdap_get_generic_ext_step(struct tevent_req *req)
         }
         state->serverctrls[state->nserverctrls] = page_control;
         state->serverctrls[state->nserverctrls+1] = NULL;
+
+        state->page_size = page_size;
+        state->page_entries = 0;
+        state->page_start = tevent_timeval_current();
     }
 
     lret = ldap_search_ext(state->sh->ldap, state->search_base,
@@ -1646,6 +1814,13 @@ static void sdap_get_generic_op_finished(struct sdap_op *op,
             return;
         }
 
+        state->page_entries++;
+        sdap_unlock_next_reply(state->op);
+        break;
+
+    case LDAP_RES_INTERMEDIATE:
+        /* not requested by any control we send, skip it */
+        DEBUG(SSSDBG_TRACE_FUNC, "Ignoring intermediate response\n");
         sdap_unlock_next_reply(state->op);
         break;
 
@@ -1689,6 +1864,14 @@ static void sdap_get_generic_op_finished(struct sdap_op *op,
             ldap_memfree(errmsg);
             tevent_req_error(req, ENOTSUP);
             return;
+        } else if (result == LDAP_BUSY || result == LDAP_UNAVAILABLE) {
+            /* Let periodic tasks back off from an overloaded server. */
+            DEBUG(SSSDBG_OP_FAILURE, "Server is busy: %s(%d), %s\n",
+                  sss_ldap_err2string(result), result,
+                  errmsg ? errmsg : "no errmsg set");
+            ldap_memfree(errmsg);
+            tevent_req_error(req, EBUSY);
+            return;
         } else if (result == LDAP_REFERRAL) {
             ret = sdap_get_generic_ext_add_references(state, refs);
             if (ret != EOK) {
@@ -1728,6 +1911,8 @@ static void sdap_get_generic_op_finished(struct sdap_op *op,
         }
         DEBUG(SSSDBG_TRACE_INTERNAL, "Total count [%d]\n", total_count);
 
+        sdap_get_generic_ext_tune(state);
+
         if (cookie.bv_val != NULL && cookie.bv_len > 0) {
             /* Cookie contains data, which means there are more requests
              * to be processed.
@@ -1777,6 +1962,7 @@ sdap_get_generic_ext_recv(struct tevent_req *req,
 
     PROBE(SDAP_GET_GENERIC_EXT_RECV, state->search_base,
           state->scope, state->filter);
+    sss_prof_record_since("ldap_search", &state->start);
 
     TEVENT_REQ_RETURN_ON_ERROR(req);
 
@@ -1827,16 +2013,338 @@ static void generic_ext_search_handler(struct tevent_req *subreq,
     tevent_req_done(req);
 }
 
+/* ==Retrieve the remaining ranges of an attribute========================= */
+
+/* Active Directory returns at most MaxValRange values of an attribute with
+ * an entry, e.g. member;range=0-1499. The following ranges are read with
+ * base searches of the entry. Their bounds are predictable, so
+ * SDAP_RANGE_PARALLEL of them are requested at the same time. A range the
+ * server shortens or an error ends the round at the first gap, the next
+ * round continues from there. */
+struct sdap_range_get_state;
+
+struct sdap_range_slice {
+    struct sdap_range_get_state *state;
+    uint32_t start;
+    uint32_t end;
+    bool found;
+    bool last;
+    struct ldb_val *vals;
+    size_t num_vals;
+};
+
+struct sdap_range_get_state {
+    struct tevent_context *ev;
+    struct sdap_options *opts;
+    struct sdap_handle *sh;
+    struct sdap_range_pending *pending;
+    int timeout;
+
+    uint32_t offset;
+    uint32_t step;
+    uint32_t retrieved;
+
+    TALLOC_CTX *round;
+    struct sdap_range_slice slices[SDAP_RANGE_PARALLEL];
+    int running;
+};
+
+static errno_t sdap_range_get_next(struct tevent_req *req);
+static errno_t sdap_range_get_parse_entry(struct sdap_handle *sh,
+                                          struct sdap_msg *msg,
+                                          void *pvt);
+static void sdap_range_get_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sdap_range_get_send(TALLOC_CTX *mem_ctx,
+                    struct tevent_context *ev,
+                    struct sdap_options *opts,
+                    struct sdap_handle *sh,
+                    struct sdap_range_pending *pending)
+{
+    struct sdap_range_get_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sdap_range_get_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    state->ev = ev;
+    state->opts = opts;
+    state->sh = sh;
+    state->pending = pending;
+    state->timeout = dp_opt_get_int(opts->basic, SDAP_SEARCH_TIMEOUT);
+    state->offset = pending->offset;
+    state->step = pending->step;
+
+    ret = sdap_range_get_next(req);
+    if (ret != EAGAIN) {
+        talloc_zfree(state->round);
+        if (ret == EOK) {
+            tevent_req_done(req);
+        } else {
+            tevent_req_error(req, ret);
+        }
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static errno_t sdap_range_get_next(struct tevent_req *req)
+{
+    struct sdap_range_get_state *state;
+    struct sdap_range_slice *slice;
+    struct tevent_req *subreq;
+    const char *attrs[2] = { NULL, NULL };
+    int i;
+
+    state = tevent_req_data(req, struct sdap_range_get_state);
+
+    talloc_zfree(state->round);
+    state->round = talloc_new(state);
+    if (state->round == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < SDAP_RANGE_PARALLEL; i++) {
+        slice = &state->slices[i];
+        memset(slice, 0, sizeof(struct sdap_range_slice));
+        slice->state = state;
+        slice->start = state->offset + i * state->step;
+        slice->end = slice->start + state->step - 1;
+        if (slice->start < state->offset || slice->end < slice->start) {
+            /* the next range would overflow, request it in a later round */
+            break;
+        }
+
+        attrs[0] = talloc_asprintf(state->round, "%s;range=%u-%u",
+                                   state->pending->base_attr,
+                                   slice->start, slice->end);
+        if (attrs[0] == NULL) {
+            return ENOMEM;
+        }
+
+        subreq = sdap_get_generic_ext_send(state->round, state->ev,
+                                           state->opts, state->sh,
+                                           state->pending->dn,
+                                           LDAP_SCOPE_BASE, "(objectclass=*)",
+                                           attrs, NULL, NULL, 0,
+                                           state->timeout,
+                                           sdap_range_get_parse_entry,
+                                           slice, 0);
+        if (subreq == NULL) {
+            return ENOMEM;
+        }
+        tevent_req_set_callback(subreq, sdap_range_get_done, req);
+        state->running++;
+    }
+
+    if (state->running == 0) {
+        return EIO;
+    }
+
+    return EAGAIN;
+}
+
+static errno_t sdap_range_get_parse_entry(struct sdap_handle *sh,
+                                          struct sdap_msg *msg,
+                                          void *pvt)
+{
+    struct sdap_range_slice *slice = pvt;
+    struct sdap_range_get_state *state = slice->state;
+    struct berval **vals;
+    BerElement *ber = NULL;
+    uint32_t start;
+    uint32_t end;
+    bool last;
+    char *str;
+    size_t count;
+    size_t i;
+    errno_t ret = EOK;
+
+    for (str = ldap_first_attribute(sh->ldap, msg->msg, &ber);
+         str != NULL;
+         str = ldap_next_attribute(sh->ldap, msg->msg, ber)) {
+        ret = sdap_parse_range_bounds(str, state->pending->base_attr,
+                                      &start, &end, &last);
+        if (ret == ENOENT) {
+            ldap_memfree(str);
+            ret = EOK;
+            continue;
+        } else if (ret != EOK || slice->found) {
+            ldap_memfree(str);
+            break;
+        }
+
+        vals = ldap_get_values_len(sh->ldap, msg->msg, str);
+        ldap_memfree(str);
+
+        for (count = 0; vals != NULL && vals[count] != NULL; count++) ;
+
+        slice->vals = talloc_zero_array(state->round, struct ldb_val, count);
+        if (slice->vals == NULL) {
+            ldap_value_free_len(vals);
+            ret = ENOMEM;
+            break;
+        }
+
+        for (i = 0; i < count; i++) {
+            if (vals[i]->bv_len == 0) {
+                continue;
+            }
+            slice->vals[slice->num_vals].data = talloc_memdup(slice->vals,
+                                                              vals[i]->bv_val,
+                                                              vals[i]->bv_len);
+            if (slice->vals[slice->num_vals].data == NULL) {
+                ret = ENOMEM;
+                break;
+            }
+            slice->vals[slice->num_vals].length = vals[i]->bv_len;
+            slice->num_vals++;
+        }
+        ldap_value_free_len(vals);
+        if (ret != EOK) {
+            break;
+        }
+
+        slice->found = true;
+        slice->start = start;
+        slice->end = end;
+        slice->last = last;
+    }
+
+    if (ber != NULL) {
+        ber_free(ber, 0);
+    }
+
+    return ret;
+}
+
+static void sdap_range_get_done(struct tevent_req *subreq)
+{
+    struct sdap_range_get_state *state;
+    struct sdap_range_slice *slice;
+    struct tevent_req *req;
+    uint32_t expected;
+    bool finished = false;
+    size_t n;
+    int i;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sdap_range_get_state);
+
+    ret = sdap_get_generic_ext_recv(subreq, state, NULL, NULL);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Range of [%s] of [%s] could not be read [%d]: %s\n",
+              state->pending->base_attr, state->pending->dn,
+              ret, sss_strerror(ret));
+    }
+
+    state->running--;
+    if (state->running > 0) {
+        return;
+    }
+
+    /* All ranges of this round are in, add them in order until the first
+     * one that does not start where the one before it ended */
+    expected = state->offset;
+    for (i = 0; i < SDAP_RANGE_PARALLEL; i++) {
+        slice = &state->slices[i];
+        if (!slice->found || slice->start != expected) {
+            break;
+        }
+
+        for (n = 0; state->pending->sys_names[n] != NULL; n++) {
+            ret = sysdb_attrs_add_vals(state->pending->attrs,
+                                       state->pending->sys_names[n],
+                                       slice->vals, slice->num_vals);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+        state->retrieved += slice->num_vals;
+
+        if (slice->last) {
+            finished = true;
+            break;
+        }
+
+        expected = slice->end + 1;
+        if (slice->end - slice->start + 1 < state->step) {
+            /* the server shortened the range, use its size from now on */
+            state->step = slice->end - slice->start + 1;
+            break;
+        }
+    }
+
+    if (finished) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Read %u more values of [%s] of [%s]\n",
+              state->retrieved, state->pending->base_attr,
+              state->pending->dn);
+        ret = EOK;
+        goto done;
+    }
+
+    if (expected == state->offset) {
+        /* Nothing was added, keep the values read so far as before the
+         * ranges were retrieved */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot read [%s] of [%s] from value %u on, it is "
+              "incomplete\n", state->pending->base_attr,
+              state->pending->dn, state->offset);
+        ret = EOK;
+        goto done;
+    }
+
+    state->offset = expected;
+    ret = sdap_range_get_next(req);
+
+done:
+    if (ret == EAGAIN) {
+        return;
+    }
+
+    talloc_zfree(state->round);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+static errno_t sdap_range_get_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
 /* ==Generic Search exposing all options======================= */
 struct sdap_get_and_parse_generic_state {
+    struct tevent_context *ev;
+    struct sdap_handle *sh;
     struct sdap_attr_map *map;
     int map_num_attrs;
 
     struct sdap_reply sreply;
     struct sdap_options *opts;
+
+    /* attributes of the entries that are retrieved in ranges */
+    struct sdap_range_pending *pending;
+    size_t num_pending;
+    size_t next_pending;
 };
 
 static void sdap_get_and_parse_generic_done(struct tevent_req *subreq);
+static errno_t sdap_get_and_parse_generic_ranges(struct tevent_req *req);
+static void sdap_get_and_parse_generic_range_done(struct tevent_req *subreq);
 static errno_t sdap_get_and_parse_generic_parse_entry(struct sdap_handle *sh,
                                                       struct sdap_msg *msg,
                                                       void *pvt);
@@ -1867,6 +2375,8 @@ struct tevent_req *sdap_get_and_parse_generic_send(TALLOC_CTX *memctx,
                             struct sdap_get_and_parse_generic_state);
     if (!req) return NULL;
 
+    state->ev = ev;
+    state->sh = sh;
     state->map = map;
     state->map_num_attrs = map_num_attrs;
     state->opts = opts;
@@ -1899,21 +2409,42 @@ static errno_t sdap_get_and_parse_generic_parse_entry(struct sdap_handle *sh,
 {
     errno_t ret;
     struct sysdb_attrs *attrs;
+    struct sdap_range_pending *pending = NULL;
+    struct sdap_range_pending *all;
+    size_t num_pending = 0;
     struct sdap_get_and_parse_generic_state *state =
                 talloc_get_type(pvt, struct sdap_get_and_parse_generic_state);
 
     bool disable_range_rtrvl = dp_opt_get_bool(state->opts->basic,
                                                SDAP_DISABLE_RANGE_RETRIEVAL);
 
-    ret = sdap_parse_entry(state, sh, msg,
-                           state->map, state->map_num_attrs,
-                           &attrs, disable_range_rtrvl);
+    ret = sdap_parse_entry_ranges(state, sh, msg,
+                                  state->map, state->map_num_attrs,
+                                  &attrs, disable_range_rtrvl,
+                                  &pending, &num_pending);
     if (ret != EOK) {
         DEBUG(SSSDBG_MINOR_FAILURE,
               "sdap_parse_entry failed [%d]: %s\n", ret, strerror(ret));
         return ret;
     }
 
+    if (num_pending > 0) {
+        all = talloc_realloc(state, state->pending, struct sdap_range_pending,
+                             state->num_pending + num_pending);
+        if (all == NULL) {
+            talloc_free(pending);
+            talloc_free(attrs);
+            return ENOMEM;
+        }
+
+        /* the strings stay with the array they were allocated on */
+        memcpy(&all[state->num_pending], pending,
+               num_pending * sizeof(struct sdap_range_pending));
+        talloc_steal(all, pending);
+        state->pending = all;
+        state->num_pending += num_pending;
+    }
+
     ret = add_to_reply(state, &state->sreply, attrs);
     if (ret != EOK) {
         talloc_free(attrs);
@@ -1931,8 +2462,74 @@ static void sdap_get_and_parse_generic_done(struct tevent_req *subreq)
                                                       struct tevent_req);
     struct sdap_get_and_parse_generic_state *state =
                 tevent_req_data(req, struct sdap_get_and_parse_generic_state);
+    errno_t ret;
 
-    return generic_ext_search_handler(subreq, state->opts);
+    if (state->num_pending == 0) {
+        return generic_ext_search_handler(subreq, state->opts);
+    }
+
+    ret = sdap_get_generic_ext_recv(subreq, state, NULL, NULL);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "sdap_get_generic_ext_recv failed [%d]: %s\n",
+              ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sdap_get_and_parse_generic_ranges(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+/* The ranges are read for one attribute after another, each of them with
+ * SDAP_RANGE_PARALLEL requests at a time */
+static errno_t sdap_get_and_parse_generic_ranges(struct tevent_req *req)
+{
+    struct sdap_get_and_parse_generic_state *state =
+                tevent_req_data(req, struct sdap_get_and_parse_generic_state);
+    struct tevent_req *subreq;
+
+    if (state->next_pending >= state->num_pending) {
+        talloc_zfree(state->pending);
+        return EOK;
+    }
+
+    subreq = sdap_range_get_send(state, state->ev, state->opts, state->sh,
+                                 &state->pending[state->next_pending]);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+    tevent_req_set_callback(subreq, sdap_get_and_parse_generic_range_done,
+                            req);
+    state->next_pending++;
+
+    return EAGAIN;
+}
+
+static void sdap_get_and_parse_generic_range_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    errno_t ret;
+
+    ret = sdap_range_get_recv(subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sdap_get_and_parse_generic_ranges(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
 }
 
 int sdap_get_and_parse_generic_recv(struct tevent_req *req,
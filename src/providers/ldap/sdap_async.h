@@ -174,6 +174,14 @@ errno_t sdap_exop_modify_passwd_recv(struct tevent_req *req,
                                      TALLOC_CTX *mem_ctx,
                                      char **user_error_msg);
 
+/* Switch a connection which was not bound yet to the Active Directory fast
+ * concurrent bind mode, see LDAP_SERVER_FAST_BIND_OID */
+struct tevent_req *sdap_fast_bind_send(TALLOC_CTX *mem_ctx,
+                                       struct tevent_context *ev,
+                                       struct sdap_handle *sh,
+                                       int timeout);
+errno_t sdap_fast_bind_recv(struct tevent_req *req);
+
 struct tevent_req *
 sdap_modify_passwd_send(TALLOC_CTX *mem_ctx,
                         struct tevent_context *ev,
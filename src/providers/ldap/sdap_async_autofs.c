@@ -159,6 +159,69 @@ save_autofs_entries(struct sss_domain_info *domain,
     return EOK;
 }
 
+static errno_t
+refresh_autofs_entries(struct sss_domain_info *domain,
+                       const char *map,
+                       struct sdap_options *opts,
+                       char **dn_list,
+                       hash_table_t *entry_hash)
+{
+    struct sysdb_attrs *attrs;
+    struct sysdb_attrs *entry;
+    hash_key_t key;
+    hash_value_t value;
+    const char *ekey;
+    const char *evalue;
+    size_t i;
+    int hret;
+    errno_t ret;
+
+    attrs = sysdb_new_attrs(NULL);
+    if (attrs == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_CACHE_EXPIRE,
+                                 domain->autofsmap_timeout ?
+                                     time(NULL) + domain->autofsmap_timeout
+                                     : 0);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* The entries did not change, only their expiration is updated */
+    for (i = 0; dn_list[i]; i++) {
+        key.type = HASH_KEY_STRING;
+        key.str = dn_list[i];
+
+        hret = hash_lookup(entry_hash, &key, &value);
+        if (hret != HASH_SUCCESS) {
+            continue;
+        }
+
+        entry = talloc_get_type(value.ptr, struct sysdb_attrs);
+        ekey = entry ? get_autofs_entry_key(entry, opts) : NULL;
+        evalue = entry ? get_autofs_entry_value(entry, opts) : NULL;
+        if (ekey == NULL || evalue == NULL) {
+            continue;
+        }
+
+        ret = sysdb_set_autofsentry_attr(domain, map, ekey, evalue,
+                                         attrs, SYSDB_MOD_REP);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot refresh entry [%s]\n", dn_list[i]);
+            continue;
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(attrs);
+    return ret;
+}
+
 static errno_t
 del_autofs_entries(struct sss_domain_info *dom,
                    char **del_dn_list)
@@ -788,6 +851,7 @@ sdap_autofs_setautomntent_save(struct tevent_req *req)
     char **ldap_entrylist = NULL;
     char **add_entries = NULL;
     char **del_entries = NULL;
+    char **kept_entries = NULL;
     size_t i, j;
 
     hash_table_t *entry_hash = NULL;
@@ -887,10 +951,11 @@ sdap_autofs_setautomntent_save(struct tevent_req *req)
     }
 
     /* Find the differences between the sysdb and LDAP lists
-     * Entries in the sysdb only must be removed.
+     * Entries in the sysdb only must be removed, entries in both lists
+     * are kept as they are and only get a new expiration.
      */
     ret = diff_string_lists(tmp_ctx, ldap_entrylist, sysdb_entrylist,
-                            &add_entries, &del_entries, NULL);
+                            &add_entries, &del_entries, &kept_entries);
     if (ret != EOK) goto done;
 
     ret = sysdb_transaction_start(state->sysdb);
@@ -924,6 +989,18 @@ sdap_autofs_setautomntent_save(struct tevent_req *req)
         }
     }
 
+    /* Extend the lifetime of entries that did not change */
+    if (kept_entries && kept_entries[0]) {
+        ret = refresh_autofs_entries(state->dom, state->mapname, state->opts,
+                                     kept_entries, entry_hash);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Cannot refresh autofs entries [%d]: %s\n",
+                  ret, strerror(ret));
+            goto done;
+        }
+    }
+
     /* Delete entries that don't exist anymore */
     if (del_entries && del_entries[0]) {
         ret = del_autofs_entries(state->dom, del_entries);
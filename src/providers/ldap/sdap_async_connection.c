@@ -1094,6 +1094,7 @@ struct sdap_kinit_state {
 
     struct fo_server *kdc_srv;
     time_t expire_time;
+    char *ccname;
 };
 
 static void sdap_kinit_done(struct tevent_req *subreq);
@@ -1259,6 +1260,7 @@ static void sdap_kinit_done(struct tevent_req *subreq)
         }
 
         state->expire_time = expire_time;
+        state->ccname = ccname;
         tevent_req_done(req);
         return;
     } else {
@@ -1280,7 +1282,9 @@ static void sdap_kinit_done(struct tevent_req *subreq)
 }
 
 static errno_t sdap_kinit_recv(struct tevent_req *req,
-                               time_t *expire_time)
+                               TALLOC_CTX *mem_ctx,
+                               time_t *expire_time,
+                               char **_ccname)
 {
     struct sdap_kinit_state *state = tevent_req_data(req,
                                                      struct sdap_kinit_state);
@@ -1299,9 +1303,206 @@ static errno_t sdap_kinit_recv(struct tevent_req *req,
     }
 
     *expire_time = state->expire_time;
+    if (_ccname != NULL) {
+        *_ccname = talloc_steal(mem_ctx, state->ccname);
+    }
+    return EOK;
+}
+
+/* ==Keep-the-TGT-of-a-service=========================================== */
+
+/* A cached TGT is not given to new connections during its last
+ * SDAP_KINIT_CACHE_MIN_LIFETIME seconds, it is refreshed
+ * SDAP_KINIT_CACHE_REFRESH seconds (at most half of its lifetime) before
+ * it expires. */
+#define SDAP_KINIT_CACHE_MIN_LIFETIME 30
+#define SDAP_KINIT_CACHE_REFRESH 300
+
+static struct tevent_req *sdap_kinit_service_send(TALLOC_CTX *mem_ctx,
+                                                  struct tevent_context *ev,
+                                                  struct be_ctx *be,
+                                                  struct sdap_options *opts,
+                                                  struct sdap_service *service)
+{
+    return sdap_kinit_send(mem_ctx, ev, be, NULL,
+                           service->kinit_service_name,
+                           dp_opt_get_int(opts->basic, SDAP_OPT_TIMEOUT),
+                           dp_opt_get_string(opts->basic, SDAP_KRB5_KEYTAB),
+                           dp_opt_get_string(opts->basic, SDAP_SASL_AUTHID),
+                           sdap_gssapi_realm(opts->basic),
+                           dp_opt_get_bool(opts->basic,
+                                           SDAP_KRB5_CANONICALIZE),
+                           dp_opt_get_int(opts->basic,
+                                          SDAP_KRB5_TICKET_LIFETIME));
+}
+
+static bool sdap_kinit_cache_matches(struct sdap_kinit_cache *cache,
+                                     struct sdap_options *opts)
+{
+    const char *principal;
+    const char *realm;
+
+    principal = dp_opt_get_string(opts->basic, SDAP_SASL_AUTHID);
+    realm = sdap_gssapi_realm(opts->basic);
+
+    return cache->ccname != NULL
+        && ((principal == NULL && cache->principal == NULL)
+            || (principal != NULL && cache->principal != NULL
+                && strcmp(principal, cache->principal) == 0))
+        && ((realm == NULL && cache->realm == NULL)
+            || (realm != NULL && cache->realm != NULL
+                && strcmp(realm, cache->realm) == 0));
+}
+
+/* Point KRB5CCNAME to the cached TGT of service if it can still be used */
+static errno_t sdap_kinit_cache_use(struct sdap_service *service,
+                                    struct sdap_options *opts,
+                                    time_t *_expire_time)
+{
+    struct sdap_kinit_cache *cache = service->kinit_cache;
+    int ret;
+
+    if (cache == NULL || !sdap_kinit_cache_matches(cache, opts)
+            || cache->expire_time - SDAP_KINIT_CACHE_MIN_LIFETIME
+                    <= time(NULL)) {
+        return ENOENT;
+    }
+
+    ret = setenv("KRB5CCNAME", cache->ccname, 1);
+    if (ret == -1) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Unable to set env. variable KRB5CCNAME!\n");
+        return EIO;
+    }
+
+    *_expire_time = cache->expire_time;
     return EOK;
 }
 
+static void sdap_kinit_cache_refresh(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval tv, void *pvt);
+static void sdap_kinit_cache_refresh_done(struct tevent_req *subreq);
+
+static void sdap_kinit_cache_store(struct tevent_context *ev,
+                                   struct be_ctx *be,
+                                   struct sdap_options *opts,
+                                   struct sdap_service *service,
+                                   const char *ccname,
+                                   time_t expire_time)
+{
+    struct sdap_kinit_cache *cache = service->kinit_cache;
+    const char *principal;
+    const char *realm;
+    struct timeval tv;
+    time_t now = time(NULL);
+    time_t refresh;
+
+    if (ccname == NULL || expire_time <= now) {
+        return;
+    }
+
+    if (cache == NULL) {
+        cache = talloc_zero(service, struct sdap_kinit_cache);
+        if (cache == NULL) {
+            return;
+        }
+        service->kinit_cache = cache;
+    }
+
+    principal = dp_opt_get_string(opts->basic, SDAP_SASL_AUTHID);
+    realm = sdap_gssapi_realm(opts->basic);
+
+    talloc_zfree(cache->ccname);
+    talloc_zfree(cache->principal);
+    talloc_zfree(cache->realm);
+    cache->ccname = talloc_strdup(cache, ccname);
+    cache->principal = principal == NULL ? NULL
+                                         : talloc_strdup(cache, principal);
+    cache->realm = realm == NULL ? NULL : talloc_strdup(cache, realm);
+    if (cache->ccname == NULL || (principal != NULL && cache->principal == NULL)
+            || (realm != NULL && cache->realm == NULL)) {
+        talloc_zfree(service->kinit_cache);
+        return;
+    }
+
+    cache->expire_time = expire_time;
+    cache->ev = ev;
+    cache->be = be;
+    cache->opts = opts;
+    cache->service = service;
+
+    if (cache->refresh_req != NULL) {
+        /* the running refresh schedules the next one */
+        return;
+    }
+
+    refresh = MIN(SDAP_KINIT_CACHE_REFRESH, (expire_time - now) / 2);
+    tv = tevent_timeval_set(expire_time - refresh, 0);
+
+    talloc_zfree(cache->refresh_te);
+    cache->refresh_te = tevent_add_timer(ev, cache, tv,
+                                         sdap_kinit_cache_refresh, cache);
+    if (cache->refresh_te == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to schedule the refresh of the TGT\n");
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "TGT of service %s will be refreshed at %ld\n",
+          service->name, (long) tv.tv_sec);
+}
+
+static void sdap_kinit_cache_refresh(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval tv, void *pvt)
+{
+    struct sdap_kinit_cache *cache;
+
+    cache = talloc_get_type(pvt, struct sdap_kinit_cache);
+    cache->refresh_te = NULL;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Refreshing the TGT of service %s\n",
+          cache->service->name);
+
+    cache->refresh_req = sdap_kinit_service_send(cache, ev, cache->be,
+                                                 cache->opts, cache->service);
+    if (cache->refresh_req == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to refresh the TGT\n");
+        return;
+    }
+    tevent_req_set_callback(cache->refresh_req,
+                            sdap_kinit_cache_refresh_done, cache);
+}
+
+static void sdap_kinit_cache_refresh_done(struct tevent_req *subreq)
+{
+    struct sdap_kinit_cache *cache;
+    struct sdap_service *service;
+    time_t expire_time = 0;
+    char *ccname = NULL;
+    errno_t ret;
+
+    cache = tevent_req_callback_data(subreq, struct sdap_kinit_cache);
+    service = cache->service;
+    cache->refresh_req = NULL;
+
+    ret = sdap_kinit_recv(subreq, cache, &expire_time, &ccname);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        /* the next connection will call ldap_child itself */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to refresh the TGT of service %s [%d]: %s\n",
+              service->name, ret, sss_strerror(ret));
+        talloc_zfree(service->kinit_cache);
+        return;
+    }
+
+    sdap_kinit_cache_store(cache->ev, cache->be, cache->opts, service,
+                           ccname, expire_time);
+    talloc_free(ccname);
+}
+
 
 /* ==Authenticaticate-User-by-DN========================================== */
 
@@ -1430,6 +1631,19 @@ errno_t sdap_auth_recv(struct tevent_req *req,
 
 /* ==Client connect============================================ */
 
+/* A connection attempt to one server. When a server is slow to accept the
+ * connection, attempts to the next servers are started after a delay and
+ * the first one to succeed is used. */
+struct sdap_cli_attempt {
+    struct sdap_cli_attempt *prev;
+    struct sdap_cli_attempt *next;
+
+    struct tevent_req *req;
+    struct fo_server *srv;
+    struct timeval start;
+    bool use_tls;
+};
+
 struct sdap_cli_connect_state {
     struct tevent_context *ev;
     struct sdap_options *opts;
@@ -1442,12 +1656,21 @@ struct sdap_cli_connect_state {
     struct sdap_handle *sh;
 
     struct fo_server *srv;
+    struct timeval connect_start;
 
     struct sdap_server_opts *srv_opts;
 
     enum connect_tls force_tls;
     bool do_auth;
     bool use_tls;
+
+    /* attempts in progress and the resolution of the next server */
+    struct sdap_cli_attempt *attempts;
+    int num_attempts;
+    int max_attempts;
+    struct tevent_req *resolve_req;
+    struct tevent_timer *race_te;
+    bool no_more_servers;
 };
 
 static int sdap_cli_resolve_next(struct tevent_req *req);
@@ -1521,6 +1744,12 @@ struct tevent_req *sdap_cli_connect_send(TALLOC_CTX *memctx,
     state->force_tls = force_tls;
     state->do_auth = !skip_auth;
 
+    state->max_attempts = dp_opt_get_int(opts->basic,
+                                         SDAP_CONNECTION_RACE_SERVERS);
+    if (state->max_attempts < 1) {
+        state->max_attempts = 1;
+    }
+
     ret = sdap_cli_resolve_next(req);
     if (ret) {
         tevent_req_error(req, ret);
@@ -1537,17 +1766,124 @@ static int sdap_cli_resolve_next(struct tevent_req *req)
 
     /* Before stepping to next server  destroy any connection from previous attempt */
     talloc_zfree(state->sh);
+    talloc_zfree(state->race_te);
 
     /* NOTE: this call may cause service->uri to be refreshed
      * with a new valid server. Do not use service->uri before */
-    subreq = be_resolve_server_send(state, state->ev,
-                                    state->be, state->service->name,
-                                    state->srv == NULL ? true : false);
+    if (state->num_attempts > 0) {
+        /* racing the attempts in progress */
+        subreq = be_resolve_other_server_send(state, state->ev, state->be,
+                                              state->service->name);
+    } else {
+        state->no_more_servers = false;
+        subreq = be_resolve_server_send(state, state->ev,
+                                        state->be, state->service->name,
+                                        state->srv == NULL ? true : false);
+    }
     if (!subreq) {
         return ENOMEM;
     }
 
     tevent_req_set_callback(subreq, sdap_cli_resolve_done, req);
+    state->resolve_req = subreq;
+    return EOK;
+}
+
+static void sdap_cli_race_timeout(struct tevent_context *ev,
+                                  struct tevent_timer *te,
+                                  struct timeval tv, void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    struct sdap_cli_connect_state *state = tevent_req_data(req,
+                                             struct sdap_cli_connect_state);
+    int ret;
+
+    state->race_te = NULL;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "No connection yet, trying the next server "
+          "as well\n");
+
+    ret = sdap_cli_resolve_next(req);
+    if (ret != EOK) {
+        /* keep waiting for the attempts in progress */
+        state->no_more_servers = true;
+    }
+}
+
+static void sdap_cli_race_schedule(struct tevent_req *req)
+{
+    struct sdap_cli_connect_state *state = tevent_req_data(req,
+                                             struct sdap_cli_connect_state);
+    struct timeval tv;
+    int delay;
+
+    talloc_zfree(state->race_te);
+
+    if (state->no_more_servers || state->resolve_req != NULL
+            || state->num_attempts >= state->max_attempts) {
+        return;
+    }
+
+    delay = dp_opt_get_int(state->opts->basic, SDAP_CONNECTION_RACE_DELAY);
+    tv = tevent_timeval_current_ofs(0, MAX(delay, 0) * 1000);
+
+    state->race_te = tevent_add_timer(state->ev, state, tv,
+                                      sdap_cli_race_timeout, req);
+    if (state->race_te == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to schedule the next server, "
+              "trying one server at a time\n");
+    }
+}
+
+static int sdap_cli_attempt_destructor(struct sdap_cli_attempt *attempt)
+{
+    struct sdap_cli_connect_state *state = tevent_req_data(attempt->req,
+                                             struct sdap_cli_connect_state);
+
+    fo_set_server_connecting(attempt->srv, false);
+    DLIST_REMOVE(state->attempts, attempt);
+    state->num_attempts--;
+
+    return 0;
+}
+
+static errno_t sdap_cli_attempt_start(struct tevent_req *req,
+                                      struct fo_server *srv,
+                                      bool use_tls)
+{
+    struct sdap_cli_connect_state *state = tevent_req_data(req,
+                                             struct sdap_cli_connect_state);
+    struct sdap_cli_attempt *attempt;
+    struct tevent_req *subreq;
+
+    attempt = talloc_zero(state, struct sdap_cli_attempt);
+    if (attempt == NULL) {
+        return ENOMEM;
+    }
+
+    attempt->req = req;
+    attempt->srv = srv;
+    attempt->use_tls = use_tls;
+    attempt->start = tevent_timeval_current();
+    fo_ref_server(attempt, srv);
+
+    fo_set_server_connecting(srv, true);
+    DLIST_ADD_END(state->attempts, attempt, struct sdap_cli_attempt *);
+    state->num_attempts++;
+    talloc_set_destructor(attempt, sdap_cli_attempt_destructor);
+
+    subreq = sdap_connect_send(attempt, state->ev, state->opts,
+                               state->service->uri,
+                               state->service->sockaddr,
+                               use_tls);
+    if (subreq == NULL) {
+        talloc_free(attempt);
+        return ENOMEM;
+    }
+    tevent_req_set_callback(subreq, sdap_cli_connect_done, attempt);
+
+    sdap_cli_race_schedule(req);
+
     return EOK;
 }
 
@@ -1557,11 +1893,21 @@ static void sdap_cli_resolve_done(struct tevent_req *subreq)
                                                       struct tevent_req);
     struct sdap_cli_connect_state *state = tevent_req_data(req,
                                              struct sdap_cli_connect_state);
+    struct sdap_cli_attempt *attempt;
+    struct fo_server *srv;
+    bool use_tls;
     int ret;
 
-    ret = be_resolve_server_recv(subreq, state, &state->srv);
+    state->resolve_req = NULL;
+
+    ret = be_resolve_server_recv(subreq, state, &srv);
     talloc_zfree(subreq);
-    if (ret) {
+    if (ret && state->num_attempts > 0) {
+        DEBUG(SSSDBG_TRACE_FUNC, "No other server to try, waiting for "
+              "the attempts in progress\n");
+        state->no_more_servers = true;
+        return;
+    } else if (ret) {
         state->srv = NULL;
         /* all servers have been tried and none
          * was found good, go offline */
@@ -1569,29 +1915,75 @@ static void sdap_cli_resolve_done(struct tevent_req *subreq)
         return;
     }
 
+    DLIST_FOR_EACH(attempt, state->attempts) {
+        if (attempt->srv == srv) {
+            /* the fail over returned a server already being tried */
+            state->no_more_servers = true;
+            return;
+        }
+    }
+
+    state->srv = srv;
+
     ret = decide_tls_usage(state->force_tls, state->opts->basic,
-                           state->service->uri, &state->use_tls);
+                           state->service->uri, &use_tls);
 
     if (ret != EOK) {
         tevent_req_error(req, EINVAL);
         return;
     }
 
-    subreq = sdap_connect_send(state, state->ev, state->opts,
-                               state->service->uri,
-                               state->service->sockaddr,
-                               state->use_tls);
-    if (!subreq) {
-        tevent_req_error(req, ENOMEM);
+    ret = sdap_cli_attempt_start(req, srv, use_tls);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
         return;
     }
-    tevent_req_set_callback(subreq, sdap_cli_connect_done, req);
+}
+
+static void sdap_cli_attach_tuning(struct sdap_cli_connect_state *state)
+{
+    struct sdap_server_tuning *tuning;
+
+    tuning = sdap_server_tuning_get(state->service, state->opts,
+                                    state->service->uri);
+    if (tuning == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to track the search tuning of [%s]\n",
+              state->service->uri);
+        return;
+    }
+
+    tuning->be = state->be;
+    tuning->service_name = state->service->name;
+    state->sh->tuning = tuning;
+    state->service->tuning = tuning;
+
+    be_fo_set_server_tuning(tuning->be, tuning->service_name,
+                            tuning->page_size, tuning->pool_size,
+                            tuning->page_usecs / 1000);
+}
+
+static void sdap_cli_report_connect(struct sdap_cli_connect_state *state)
+{
+    struct timeval now;
+    uint64_t usecs;
+
+    if (state->srv == NULL) {
+        return;
+    }
+
+    now = tevent_timeval_current();
+    usecs = (now.tv_sec - state->connect_start.tv_sec) * UINT64_C(1000000)
+            + now.tv_usec - state->connect_start.tv_usec;
+
+    fo_set_server_latency(state->srv, FO_LATENCY_CONNECT, usecs);
 }
 
 static void sdap_cli_connect_done(struct tevent_req *subreq)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
+    struct sdap_cli_attempt *attempt = tevent_req_callback_data(subreq,
+                                                    struct sdap_cli_attempt);
+    struct tevent_req *req = attempt->req;
     struct sdap_cli_connect_state *state = tevent_req_data(req,
                                              struct sdap_cli_connect_state);
     const char *sasl_mech;
@@ -1601,9 +1993,21 @@ static void sdap_cli_connect_done(struct tevent_req *subreq)
     ret = sdap_connect_recv(subreq, state, &state->sh);
     talloc_zfree(subreq);
     if (ret) {
-        /* retry another server */
         be_fo_set_port_status(state->be, state->service->name,
-                              state->srv, PORT_NOT_WORKING);
+                              attempt->srv, PORT_NOT_WORKING);
+        talloc_free(attempt);
+
+        if (state->resolve_req != NULL) {
+            /* the next server is being resolved already */
+            return;
+        }
+
+        if (state->num_attempts > 0 && state->no_more_servers) {
+            /* wait for the attempts in progress */
+            return;
+        }
+
+        /* retry another server */
         ret = sdap_cli_resolve_next(req);
         if (ret != EOK) {
             tevent_req_error(req, ret);
@@ -1611,6 +2015,26 @@ static void sdap_cli_connect_done(struct tevent_req *subreq)
         return;
     }
 
+    /* the first connection wins, cancel the other attempts */
+    state->srv = attempt->srv;
+    state->use_tls = attempt->use_tls;
+    state->connect_start = attempt->start;
+    talloc_zfree(state->race_te);
+    talloc_zfree(state->resolve_req);
+    while (state->attempts != NULL) {
+        talloc_free(state->attempts);
+    }
+
+    /* service->uri belongs to the server resolved last */
+    ret = be_fo_use_server(state->be, state->service->name, state->srv);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    sdap_cli_attach_tuning(state);
+    sdap_cli_report_connect(state);
+
     if (state->use_rootdse) {
         /* fetch the rootDSE this time */
         sdap_cli_rootdse_step(req);
@@ -1763,22 +2187,20 @@ static void sdap_cli_kinit_step(struct tevent_req *req)
     struct sdap_cli_connect_state *state = tevent_req_data(req,
                                              struct sdap_cli_connect_state);
     struct tevent_req *subreq;
+    time_t expire_time;
+    errno_t ret;
+
+    ret = sdap_kinit_cache_use(state->service, state->opts, &expire_time);
+    if (ret == EOK) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Using the cached TGT of service %s\n",
+              state->service->name);
+        state->sh->expire_time = expire_time;
+        sdap_cli_auth_step(req);
+        return;
+    }
 
-    subreq = sdap_kinit_send(state, state->ev,
-                             state->be,
-                             state->sh,
-                             state->service->kinit_service_name,
-                        dp_opt_get_int(state->opts->basic,
-                                                   SDAP_OPT_TIMEOUT),
-                        dp_opt_get_string(state->opts->basic,
-                                                   SDAP_KRB5_KEYTAB),
-                        dp_opt_get_string(state->opts->basic,
-                                                   SDAP_SASL_AUTHID),
-                        sdap_gssapi_realm(state->opts->basic),
-                        dp_opt_get_bool(state->opts->basic,
-                                                   SDAP_KRB5_CANONICALIZE),
-                        dp_opt_get_int(state->opts->basic,
-                                                   SDAP_KRB5_TICKET_LIFETIME));
+    subreq = sdap_kinit_service_send(state, state->ev, state->be,
+                                     state->opts, state->service);
     if (!subreq) {
         tevent_req_error(req, ENOMEM);
         return;
@@ -1793,9 +2215,10 @@ static void sdap_cli_kinit_done(struct tevent_req *subreq)
     struct sdap_cli_connect_state *state = tevent_req_data(req,
                                              struct sdap_cli_connect_state);
     time_t expire_time = 0;
+    char *ccname = NULL;
     errno_t ret;
 
-    ret = sdap_kinit_recv(subreq, &expire_time);
+    ret = sdap_kinit_recv(subreq, state, &expire_time, &ccname);
     talloc_zfree(subreq);
     if (ret != EOK) {
         /* We're not able to authenticate to the LDAP server.
@@ -1807,6 +2230,10 @@ static void sdap_cli_kinit_done(struct tevent_req *subreq)
     }
     state->sh->expire_time = expire_time;
 
+    sdap_kinit_cache_store(state->ev, state->be, state->opts, state->service,
+                           ccname, expire_time);
+    talloc_free(ccname);
+
     sdap_cli_auth_step(req);
 }
 
@@ -1983,6 +2410,8 @@ static void sdap_cli_auth_reconnect_done(struct tevent_req *subreq)
         goto done;
     }
 
+    sdap_cli_attach_tuning(state);
+
     sdap_cli_auth_step(req);
 
     ret = EOK;
@@ -2112,6 +2541,10 @@ int sdap_cli_connect_recv(struct tevent_req *req,
 
         be_fo_set_port_status(state->be, state->service->name,
                               state->srv, PORT_WORKING);
+
+        /* operations on the handle report their latency to the server */
+        fo_ref_server(state->sh, state->srv);
+        state->sh->srv = state->srv;
     }
 
     if (gsh) {
@@ -32,14 +32,6 @@
 #include "providers/ldap/sdap_async_enum.h"
 #include "providers/ldap/sdap_idmap.h"
 
-static struct tevent_req *enum_users_send(TALLOC_CTX *memctx,
-                                          struct tevent_context *ev,
-                                          struct sdap_id_ctx *ctx,
-                                          struct sdap_domain *sdom,
-                                          struct sdap_id_op *op,
-                                          bool purge);
-static errno_t enum_users_recv(struct tevent_req *req);
-
 static struct tevent_req *enum_groups_send(TALLOC_CTX *memctx,
                                           struct tevent_context *ev,
                                           struct sdap_id_ctx *ctx,
@@ -48,7 +40,25 @@ static struct tevent_req *enum_groups_send(TALLOC_CTX *memctx,
                                           bool purge);
 static errno_t enum_groups_recv(struct tevent_req *req);
 
+static struct tevent_req *enum_users_slice_send(TALLOC_CTX *memctx,
+                                        struct tevent_context *ev,
+                                        struct sdap_id_ctx *ctx,
+                                        struct sdap_domain *sdom,
+                                        struct sdap_id_conn_ctx *conn,
+                                        struct sdap_search_base *search_base,
+                                        bool purge);
+static errno_t enum_users_slice_recv(TALLOC_CTX *mem_ctx,
+                                     struct tevent_req *req,
+                                     bool *_offline,
+                                     char **_usn_value);
+
 /* ==Enumeration-Request-with-connections=================================== */
+
+/* Users are enumerated with one search per user search base, all of them
+ * running at once over the pooled connections. Services do not depend on
+ * users or groups and are enumerated at the same time. Groups are only
+ * enumerated once all users are stored so that their members can be
+ * linked. */
 struct sdap_dom_enum_ex_state {
     struct tevent_context *ev;
     struct sdap_id_ctx *ctx;
@@ -57,10 +67,14 @@ struct sdap_dom_enum_ex_state {
     struct sdap_id_conn_ctx *user_conn;
     struct sdap_id_conn_ctx *group_conn;
     struct sdap_id_conn_ctx *svc_conn;
-    struct sdap_id_op *user_op;
     struct sdap_id_op *group_op;
     struct sdap_id_op *svc_op;
 
+    int user_slices;
+    char *user_usn;
+    bool groups_done;
+    bool svcs_done;
+
     bool purge;
 };
 
@@ -68,12 +82,13 @@ static errno_t sdap_dom_enum_ex_retry(struct tevent_req *req,
                                       struct sdap_id_op *op,
                                       tevent_req_fn tcb);
 static bool sdap_dom_enum_ex_connected(struct tevent_req *subreq);
-static void sdap_dom_enum_ex_get_users(struct tevent_req *subreq);
 static void sdap_dom_enum_ex_users_done(struct tevent_req *subreq);
 static void sdap_dom_enum_ex_get_groups(struct tevent_req *subreq);
 static void sdap_dom_enum_ex_groups_done(struct tevent_req *subreq);
 static void sdap_dom_enum_ex_get_svcs(struct tevent_req *subreq);
 static void sdap_dom_enum_ex_svcs_done(struct tevent_req *subreq);
+static void sdap_dom_enum_ex_finish(struct tevent_req *req);
+static void sdap_dom_enum_ex_cleanup_done(struct tevent_req *subreq);
 
 struct tevent_req *
 sdap_dom_enum_ex_send(TALLOC_CTX *memctx,
@@ -85,8 +100,10 @@ sdap_dom_enum_ex_send(TALLOC_CTX *memctx,
                       struct sdap_id_conn_ctx *svc_conn)
 {
     struct tevent_req *req;
+    struct tevent_req *subreq;
     struct sdap_dom_enum_ex_state *state;
     int t;
+    int i;
     errno_t ret;
 
     req = tevent_req_create(memctx, &state, struct sdap_dom_enum_ex_state);
@@ -105,15 +122,39 @@ sdap_dom_enum_ex_send(TALLOC_CTX *memctx,
         state->purge = true;
     }
 
-    state->user_op = sdap_id_op_create(state, user_conn->conn_cache);
-    if (state->user_op == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for users\n");
+    if (sdom->user_search_bases == NULL
+            || sdom->user_search_bases[0] == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "User enumeration request without a search base\n");
+        ret = EINVAL;
+        goto fail;
+    }
+
+    for (i = 0; sdom->user_search_bases[i] != NULL; i++) {
+        subreq = enum_users_slice_send(state, state->ev, state->ctx,
+                                       state->sdom, state->user_conn,
+                                       sdom->user_search_bases[i],
+                                       state->purge);
+        if (subreq == NULL) {
+            ret = ENOMEM;
+            goto fail;
+        }
+        tevent_req_set_callback(subreq, sdap_dom_enum_ex_users_done, req);
+        state->user_slices++;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Enumerating users in %d slices\n",
+          state->user_slices);
+
+    state->svc_op = sdap_id_op_create(state, state->svc_conn->conn_cache);
+    if (state->svc_op == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for svcs\n");
         ret = EIO;
         goto fail;
     }
 
-    ret = sdap_dom_enum_ex_retry(req, state->user_op,
-                                 sdap_dom_enum_ex_get_users);
+    ret = sdap_dom_enum_ex_retry(req, state->svc_op,
+                                 sdap_dom_enum_ex_get_svcs);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "sdap_dom_enum_ex_retry failed\n");
         goto fail;
@@ -173,25 +214,22 @@ static bool sdap_dom_enum_ex_connected(struct tevent_req *subreq)
     return true;
 }
 
-static void sdap_dom_enum_ex_get_users(struct tevent_req *subreq)
+static void sdap_dom_enum_ex_keep_user_usn(struct sdap_dom_enum_ex_state *state,
+                                           char *usn_value)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
-    struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
-                                                struct sdap_dom_enum_ex_state);
-
-    if (sdap_dom_enum_ex_connected(subreq) == false) {
+    if (usn_value == NULL) {
         return;
     }
 
-    subreq = enum_users_send(state, state->ev,
-                             state->ctx, state->sdom,
-                             state->user_op, state->purge);
-    if (subreq == NULL) {
-        tevent_req_error(req, ENOMEM);
+    if (state->user_usn != NULL
+            && strtoull(usn_value, NULL, 10)
+                    <= strtoull(state->user_usn, NULL, 10)) {
+        talloc_free(usn_value);
         return;
     }
-    tevent_req_set_callback(subreq, sdap_dom_enum_ex_users_done, req);
+
+    talloc_free(state->user_usn);
+    state->user_usn = talloc_steal(state, usn_value);
 }
 
 static void sdap_dom_enum_ex_users_done(struct tevent_req *subreq)
@@ -200,33 +238,50 @@ static void sdap_dom_enum_ex_users_done(struct tevent_req *subreq)
                                                       struct tevent_req);
     struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
                                                 struct sdap_dom_enum_ex_state);
+    char *usn_value = NULL;
+    char *endptr = NULL;
+    unsigned usn_number;
+    bool offline = false;
     errno_t ret;
-    int dp_error;
 
-    ret = enum_users_recv(subreq);
+    ret = enum_users_slice_recv(state, subreq, &offline, &usn_value);
     talloc_zfree(subreq);
-    ret = sdap_id_op_done(state->user_op, ret, &dp_error);
-    if (dp_error == DP_ERR_OK && ret != EOK) {
-        /* retry */
-        ret = sdap_dom_enum_ex_retry(req, state->user_op,
-                                     sdap_dom_enum_ex_get_users);
-        if (ret != EOK) {
-            tevent_req_error(req, ret);
-            return;
-        }
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
         return;
-    } else if (dp_error == DP_ERR_OFFLINE) {
+    } else if (offline) {
         DEBUG(SSSDBG_TRACE_FUNC, "Backend is offline, retrying later\n");
         tevent_req_done(req);
         return;
-    } else if (ret != EOK && ret != ENOENT) {
-        /* Non-recoverable error */
-        DEBUG(SSSDBG_OP_FAILURE,
-              "User enumeration failed: %d: %s\n", ret, sss_strerror(ret));
-        tevent_req_error(req, ret);
+    }
+
+    sdap_dom_enum_ex_keep_user_usn(state, usn_value);
+
+    state->user_slices--;
+    if (state->user_slices > 0) {
         return;
     }
 
+    /* Only move the USN forward when all the slices succeeded, otherwise
+     * the next run would miss the changes of the failed ones */
+    if (state->user_usn != NULL) {
+        talloc_zfree(state->ctx->srv_opts->max_user_value);
+        state->ctx->srv_opts->max_user_value =
+                                talloc_steal(state->ctx, state->user_usn);
+        state->user_usn = NULL;
+
+        usn_number = strtoul(state->ctx->srv_opts->max_user_value,
+                             &endptr, 10);
+        if ((endptr == NULL || (*endptr == '\0'
+                    && endptr != state->ctx->srv_opts->max_user_value))
+            && (usn_number > state->ctx->srv_opts->last_usn)) {
+            state->ctx->srv_opts->last_usn = usn_number;
+        }
+    }
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Users higher USN value: [%s]\n",
+              state->ctx->srv_opts->max_user_value);
+
     state->group_op = sdap_id_op_create(state, state->group_conn->conn_cache);
     if (state->group_op == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for groups\n");
@@ -298,20 +353,8 @@ static void sdap_dom_enum_ex_groups_done(struct tevent_req *subreq)
         return;
     }
 
-
-    state->svc_op = sdap_id_op_create(state, state->svc_conn->conn_cache);
-    if (state->svc_op == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for svcs\n");
-        tevent_req_error(req, EIO);
-        return;
-    }
-
-    ret = sdap_dom_enum_ex_retry(req, state->svc_op,
-                                 sdap_dom_enum_ex_get_svcs);
-    if (ret != EOK) {
-        tevent_req_error(req, ret);
-        return;
-    }
+    state->groups_done = true;
+    sdap_dom_enum_ex_finish(req);
 }
 
 static void sdap_dom_enum_ex_get_svcs(struct tevent_req *subreq)
@@ -348,7 +391,7 @@ static void sdap_dom_enum_ex_svcs_done(struct tevent_req *subreq)
     ret = sdap_id_op_done(state->svc_op, ret, &dp_error);
     if (dp_error == DP_ERR_OK && ret != EOK) {
         /* retry */
-        ret = sdap_dom_enum_ex_retry(req, state->user_op,
+        ret = sdap_dom_enum_ex_retry(req, state->svc_op,
                                      sdap_dom_enum_ex_get_svcs);
         if (ret != EOK) {
             tevent_req_error(req, ret);
@@ -367,6 +410,22 @@ static void sdap_dom_enum_ex_svcs_done(struct tevent_req *subreq)
         return;
     }
 
+    state->svcs_done = true;
+    sdap_dom_enum_ex_finish(req);
+}
+
+static void sdap_dom_enum_ex_finish(struct tevent_req *req)
+{
+    struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
+                                                struct sdap_dom_enum_ex_state);
+    struct tevent_req *subreq;
+    errno_t ret;
+
+    if (!state->groups_done || !state->svcs_done) {
+        /* wait for the rest */
+        return;
+    }
+
     /* Ok, we've completed an enumeration. Save this to the
      * sysdb so we can postpone starting up the enumeration
      * process on the next SSSD service restart (to avoid
@@ -381,14 +440,35 @@ static void sdap_dom_enum_ex_svcs_done(struct tevent_req *subreq)
     }
 
     if (state->purge) {
-        ret = ldap_id_cleanup(state->ctx, state->sdom);
-        if (ret != EOK) {
-            /* Not fatal, worst case we'll have stale entries that would be
-             * removed on a subsequent online lookup
-             */
-            DEBUG(SSSDBG_MINOR_FAILURE, "Cleanup failed: [%d]: %s\n",
-                  ret, sss_strerror(ret));
+        subreq = ldap_id_cleanup_send(state, state->ev, state->ctx,
+                                      state->sdom);
+        if (subreq == NULL) {
+            /* Not fatal, see sdap_dom_enum_ex_cleanup_done() */
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to start the cleanup\n");
+            tevent_req_done(req);
+            return;
         }
+        tevent_req_set_callback(subreq, sdap_dom_enum_ex_cleanup_done, req);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+static void sdap_dom_enum_ex_cleanup_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    errno_t ret;
+
+    ret = ldap_id_cleanup_recv(subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        /* Not fatal, worst case we'll have stale entries that would be
+         * removed on a subsequent online lookup
+         */
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cleanup failed: [%d]: %s\n",
+              ret, sss_strerror(ret));
     }
 
     tevent_req_done(req);
@@ -424,8 +504,10 @@ struct enum_users_state {
     struct sdap_domain *sdom;
     struct sdap_id_op *op;
 
+    struct sdap_search_base *search_bases[2];
     char *filter;
     const char **attrs;
+    char *usn_value;
 };
 
 static void enum_users_done(struct tevent_req *subreq);
@@ -434,6 +516,7 @@ static struct tevent_req *enum_users_send(TALLOC_CTX *memctx,
                                           struct tevent_context *ev,
                                           struct sdap_id_ctx *ctx,
                                           struct sdap_domain *sdom,
+                                          struct sdap_search_base *search_base,
                                           struct sdap_id_op *op,
                                           bool purge)
 {
@@ -449,6 +532,8 @@ static struct tevent_req *enum_users_send(TALLOC_CTX *memctx,
     state->sdom = sdom;
     state->ctx = ctx;
     state->op = op;
+    state->search_bases[0] = search_base;
+    state->search_bases[1] = NULL;
 
     use_mapping = sdap_idmap_domain_has_algorithmic_mapping(
                                                         ctx->opts->idmap_ctx,
@@ -521,15 +606,11 @@ static struct tevent_req *enum_users_send(TALLOC_CTX *memctx,
                                NULL, &state->attrs, NULL);
     if (ret != EOK) goto fail;
 
-    /* TODO: restrict the enumerations to using a single
-     * search base at a time.
-     */
-
     subreq = sdap_get_users_send(state, state->ev,
                                  state->sdom->dom,
                                  state->sdom->dom->sysdb,
                                  state->ctx->opts,
-                                 state->sdom->user_search_bases,
+                                 state->search_bases,
                                  sdap_id_op_handle(state->op),
                                  state->attrs, state->filter,
                                  dp_opt_get_int(state->ctx->opts->basic,
@@ -555,40 +636,198 @@ static void enum_users_done(struct tevent_req *subreq)
                                                       struct tevent_req);
     struct enum_users_state *state = tevent_req_data(req,
                                                      struct enum_users_state);
-    char *usn_value;
-    char *endptr = NULL;
-    unsigned usn_number;
     int ret;
 
-    ret = sdap_get_users_recv(subreq, state, &usn_value);
+    ret = sdap_get_users_recv(subreq, state, &state->usn_value);
     talloc_zfree(subreq);
     if (ret) {
         tevent_req_error(req, ret);
         return;
     }
 
-    if (usn_value) {
-        talloc_zfree(state->ctx->srv_opts->max_user_value);
-        state->ctx->srv_opts->max_user_value =
-                                        talloc_steal(state->ctx, usn_value);
+    DEBUG(SSSDBG_TRACE_FUNC, "Users higher USN value under [%s]: [%s]\n",
+          state->search_bases[0]->basedn, state->usn_value);
 
-        usn_number = strtoul(usn_value, &endptr, 10);
-        if ((endptr == NULL || (*endptr == '\0' && endptr != usn_value))
-            && (usn_number > state->ctx->srv_opts->last_usn)) {
-            state->ctx->srv_opts->last_usn = usn_number;
+    tevent_req_done(req);
+}
+
+static errno_t enum_users_recv(TALLOC_CTX *mem_ctx,
+                               struct tevent_req *req,
+                               char **_usn_value)
+{
+    struct enum_users_state *state = tevent_req_data(req,
+                                                     struct enum_users_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_usn_value = talloc_steal(mem_ctx, state->usn_value);
+
+    return EOK;
+}
+
+/* ==User-Enumeration-Slice=============================================== */
+struct enum_users_slice_state {
+    struct tevent_context *ev;
+    struct sdap_id_ctx *ctx;
+    struct sdap_domain *sdom;
+    struct sdap_search_base *search_base;
+    struct sdap_id_op *op;
+    bool purge;
+
+    bool offline;
+    char *usn_value;
+};
+
+static errno_t enum_users_slice_connect(struct tevent_req *req);
+static void enum_users_slice_connect_done(struct tevent_req *subreq);
+static void enum_users_slice_done(struct tevent_req *subreq);
+
+/* Enumerates the users of one search base on a connection of its own,
+ * retrying on another connection if the current one fails. The users are
+ * stored by sdap_get_users_send() in transactions of ldap_save_chunk_size
+ * users. */
+static struct tevent_req *enum_users_slice_send(TALLOC_CTX *memctx,
+                                        struct tevent_context *ev,
+                                        struct sdap_id_ctx *ctx,
+                                        struct sdap_domain *sdom,
+                                        struct sdap_id_conn_ctx *conn,
+                                        struct sdap_search_base *search_base,
+                                        bool purge)
+{
+    struct tevent_req *req;
+    struct enum_users_slice_state *state;
+    errno_t ret;
+
+    req = tevent_req_create(memctx, &state, struct enum_users_slice_state);
+    if (req == NULL) return NULL;
+
+    state->ev = ev;
+    state->ctx = ctx;
+    state->sdom = sdom;
+    state->search_base = search_base;
+    state->purge = purge;
+
+    state->op = sdap_id_op_create(state, conn->conn_cache);
+    if (state->op == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for users\n");
+        ret = EIO;
+        goto fail;
+    }
+
+    ret = enum_users_slice_connect(req);
+    if (ret != EOK) {
+        goto fail;
+    }
+
+    return req;
+
+fail:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static errno_t enum_users_slice_connect(struct tevent_req *req)
+{
+    struct enum_users_slice_state *state = tevent_req_data(req,
+                                                struct enum_users_slice_state);
+    struct tevent_req *subreq;
+    errno_t ret;
+
+    subreq = sdap_id_op_connect_send(state->op, state, &ret);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "sdap_id_op_connect_send failed: %d\n", ret);
+        return ret;
+    }
+
+    tevent_req_set_callback(subreq, enum_users_slice_connect_done, req);
+    return EOK;
+}
+
+static void enum_users_slice_connect_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct enum_users_slice_state *state = tevent_req_data(req,
+                                                struct enum_users_slice_state);
+    errno_t ret;
+    int dp_error;
+
+    ret = sdap_id_op_connect_recv(subreq, &dp_error);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        if (dp_error == DP_ERR_OFFLINE) {
+            DEBUG(SSSDBG_TRACE_FUNC,
+                  "Backend is marked offline, retry later!\n");
+            state->offline = true;
+            tevent_req_done(req);
+        } else {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Domain enumeration failed to connect to " \
+                   "LDAP server: (%d)[%s]\n", ret, strerror(ret));
+            tevent_req_error(req, ret);
         }
+        return;
     }
 
-    DEBUG(SSSDBG_CONF_SETTINGS, "Users higher USN value: [%s]\n",
-              state->ctx->srv_opts->max_user_value);
+    subreq = enum_users_send(state, state->ev, state->ctx, state->sdom,
+                             state->search_base, state->op, state->purge);
+    if (subreq == NULL) {
+        tevent_req_error(req, ENOMEM);
+        return;
+    }
+    tevent_req_set_callback(subreq, enum_users_slice_done, req);
+}
+
+static void enum_users_slice_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct enum_users_slice_state *state = tevent_req_data(req,
+                                                struct enum_users_slice_state);
+    errno_t ret;
+    int dp_error;
+
+    ret = enum_users_recv(state, subreq, &state->usn_value);
+    talloc_zfree(subreq);
+    ret = sdap_id_op_done(state->op, ret, &dp_error);
+    if (dp_error == DP_ERR_OK && ret != EOK) {
+        /* retry */
+        ret = enum_users_slice_connect(req);
+        if (ret != EOK) {
+            tevent_req_error(req, ret);
+        }
+        return;
+    } else if (dp_error == DP_ERR_OFFLINE) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Backend is offline, retrying later\n");
+        state->offline = true;
+        tevent_req_done(req);
+        return;
+    } else if (ret != EOK && ret != ENOENT) {
+        /* Non-recoverable error */
+        DEBUG(SSSDBG_OP_FAILURE,
+              "User enumeration failed: %d: %s\n", ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
 
     tevent_req_done(req);
 }
 
-static errno_t enum_users_recv(struct tevent_req *req)
+static errno_t enum_users_slice_recv(TALLOC_CTX *mem_ctx,
+                                     struct tevent_req *req,
+                                     bool *_offline,
+                                     char **_usn_value)
 {
+    struct enum_users_slice_state *state = tevent_req_data(req,
+                                                struct enum_users_slice_state);
+
     TEVENT_REQ_RETURN_ON_ERROR(req);
 
+    *_offline = state->offline;
+    *_usn_value = talloc_steal(mem_ctx, state->usn_value);
+
     return EOK;
 }
 
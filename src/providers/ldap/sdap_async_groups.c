@@ -1069,6 +1069,8 @@ static int sdap_save_groups(TALLOC_CTX *memctx,
         return ENOMEM;
     }
 
+    SSS_PROF_PUSH("sdap_save_groups");
+
     ret = sysdb_transaction_start(sysdb);
     if (ret) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Failed to start transaction\n");
@@ -1164,6 +1166,7 @@ done:
         }
     }
     talloc_zfree(tmpctx);
+    SSS_PROF_POP("sdap_save_groups");
     return ret;
 }
 
@@ -1766,11 +1769,26 @@ struct sdap_get_groups_state {
 
     struct sdap_handle *ldap_sh;
     struct sdap_id_op *op;
+
+    size_t chunk_size;
+    size_t saved;
 };
 
+/* Pause between the transactions of a chunked save. A timer that is already
+ * due is run before the file descriptors are polled, the pause lets the
+ * replies of other lookups in. */
+#define SDAP_SAVE_CHUNK_PAUSE_MSEC 1
+
 static errno_t sdap_get_groups_next_base(struct tevent_req *req);
 static void sdap_get_groups_ldap_connect_done(struct tevent_req *subreq);
 static void sdap_get_groups_process(struct tevent_req *subreq);
+static errno_t sdap_get_groups_save_step(struct tevent_req *req);
+static void sdap_get_groups_save_next(struct tevent_context *ev,
+                                      struct tevent_timer *te,
+                                      struct timeval tv,
+                                      void *pvt);
+static errno_t sdap_get_groups_process_members(struct tevent_req *req,
+                                               bool save_first);
 static void sdap_get_groups_done(struct tevent_req *subreq);
 
 struct tevent_req *sdap_get_groups_send(TALLOC_CTX *memctx,
@@ -1944,8 +1962,9 @@ static void sdap_get_groups_process(struct tevent_req *subreq)
     struct sdap_get_groups_state *state =
                         tevent_req_data(req, struct sdap_get_groups_state);
     int ret;
-    int i;
     bool next_base = false;
+    bool save_first;
+    int chunk_size;
     size_t count;
     struct sysdb_attrs **groups;
     char **sysdb_groupnamelist;
@@ -2054,20 +2073,112 @@ static void sdap_get_groups_process(struct tevent_req *subreq)
         }
     }
 
+    save_first = (state->lookup_type == SDAP_LOOKUP_ENUMERATE
+                      || state->lookup_type == SDAP_LOOKUP_WILDCARD)
+                 && state->opts->schema_type != SDAP_SCHEMA_RFC2307
+                 && dp_opt_get_int(state->opts->basic, SDAP_NESTING_LEVEL) != 0;
+
+    chunk_size = dp_opt_get_int(state->opts->basic, SDAP_SAVE_CHUNK_SIZE);
+    if (save_first && chunk_size > 0 && state->count > (size_t)chunk_size) {
+        /* The groups are stored without their members in chunks first.
+         * The members are only stored after all of the groups are in
+         * place, so a group is never seen with a partial membership. */
+        DEBUG(SSSDBG_TRACE_ALL, "Saving %zu groups without members in "
+              "chunks of %d first to allow unrolling of nested groups.\n",
+              state->count, chunk_size);
+        state->chunk_size = chunk_size;
+        state->saved = 0;
+
+        ret = sdap_get_groups_save_step(req);
+        if (ret != EOK && ret != EAGAIN) {
+            tevent_req_error(req, ret);
+        }
+        return;
+    }
+
+    ret = sdap_get_groups_process_members(req, save_first);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+    }
+}
+
+/* Stores the next chunk of the groups without their members in a
+ * transaction of its own. Once all of them are stored, the members are
+ * processed. Returns EAGAIN if the rest is stored after a pause. */
+static errno_t sdap_get_groups_save_step(struct tevent_req *req)
+{
+    struct sdap_get_groups_state *state =
+                        tevent_req_data(req, struct sdap_get_groups_state);
+    struct tevent_timer *te;
+    size_t num;
+    int ret;
+
+    num = MIN(state->chunk_size, state->count - state->saved);
+
+    ret = sdap_save_groups(state, state->sysdb, state->dom, state->opts,
+                           state->groups + state->saved, num, false,
+                           NULL, true, NULL);
+    if (ret) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to store groups.\n");
+        return ret;
+    }
+    state->saved += num;
+
+    if (state->saved < state->count) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Saved %zu of %zu Groups\n",
+              state->saved, state->count);
+
+        te = tevent_add_timer(state->ev, state,
+                              tevent_timeval_current_ofs(0,
+                                        SDAP_SAVE_CHUNK_PAUSE_MSEC * 1000),
+                              sdap_get_groups_save_next, req);
+        if (te == NULL) {
+            return ENOMEM;
+        }
+
+        return EAGAIN;
+    }
+
+    return sdap_get_groups_process_members(req, false);
+}
+
+static void sdap_get_groups_save_next(struct tevent_context *ev,
+                                      struct tevent_timer *te,
+                                      struct timeval tv,
+                                      void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    errno_t ret;
+
+    ret = sdap_get_groups_save_step(req);
+    if (ret != EOK && ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+/* Processes the members of all groups and stores the groups with them in
+ * one transaction. If save_first is set, the groups are stored without
+ * their members in the same transaction first. */
+static errno_t sdap_get_groups_process_members(struct tevent_req *req,
+                                               bool save_first)
+{
+    struct sdap_get_groups_state *state =
+                        tevent_req_data(req, struct sdap_get_groups_state);
+    struct tevent_req *subreq;
+    size_t i;
+    int ret;
+    errno_t sret;
+
     /* We have all of the groups. Save them to the sysdb */
     state->check_count = state->count;
 
     ret = sysdb_transaction_start(state->sysdb);
     if (ret != EOK) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Failed to start transaction\n");
-        tevent_req_error(req, ret);
-        return;
+        return ret;
     }
 
-    if ((state->lookup_type == SDAP_LOOKUP_ENUMERATE
-                || state->lookup_type == SDAP_LOOKUP_WILDCARD)
-            && state->opts->schema_type != SDAP_SCHEMA_RFC2307
-            && dp_opt_get_int(state->opts->basic, SDAP_NESTING_LEVEL) != 0) {
+    if (save_first) {
         DEBUG(SSSDBG_TRACE_ALL, "Saving groups without members first "
                   "to allow unrolling of nested groups.\n");
         ret = sdap_save_groups(state, state->sysdb, state->dom, state->opts,
@@ -2075,8 +2186,7 @@ static void sdap_get_groups_process(struct tevent_req *subreq)
                                NULL, true, NULL);
         if (ret) {
             DEBUG(SSSDBG_OP_FAILURE, "Failed to store groups.\n");
-            tevent_req_error(req, ret);
-            return;
+            goto fail;
         }
     }
 
@@ -2087,11 +2197,20 @@ static void sdap_get_groups_process(struct tevent_req *subreq)
                                          state->lookup_type == SDAP_LOOKUP_ENUMERATE);
 
         if (!subreq) {
-            tevent_req_error(req, ENOMEM);
-            return;
+            ret = ENOMEM;
+            goto fail;
         }
         tevent_req_set_callback(subreq, sdap_get_groups_done, req);
     }
+
+    return EOK;
+
+fail:
+    sret = sysdb_transaction_cancel(state->sysdb);
+    if (sret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to cancel transaction\n");
+    }
+    return ret;
 }
 
 static void sdap_search_group_copy_batch(struct sdap_get_groups_state *state,
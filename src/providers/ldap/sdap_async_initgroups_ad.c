@@ -251,6 +251,15 @@ done:
     return ret;
 }
 
+/* SIDs of one domain looked up with one search */
+#define SDAP_AD_SIDS_BATCH_SIZE 50
+
+struct sdap_ad_sids_batch {
+    struct sdap_domain *sdom;
+    const char **sids;
+    size_t num_sids;
+};
+
 struct sdap_ad_resolve_sids_state {
     struct tevent_context *ev;
     struct sdap_id_ctx *id_ctx;
@@ -259,10 +268,19 @@ struct sdap_ad_resolve_sids_state {
     struct sss_domain_info *domain;
     char **sids;
 
+    struct sdap_ad_sids_batch *batches;
+    size_t num_batches;
+    size_t next_batch;
+    size_t active_batches;
+
     const char *current_sid;
     int index;
 };
 
+static errno_t sdap_ad_resolve_sids_make_batches(
+                                    struct sdap_ad_resolve_sids_state *state);
+static errno_t sdap_ad_resolve_sids_next_batch(struct tevent_req *req);
+static void sdap_ad_resolve_sids_batch_done(struct tevent_req *subreq);
 static errno_t sdap_ad_resolve_sids_step(struct tevent_req *req);
 static void sdap_ad_resolve_sids_done(struct tevent_req *subreq);
 
@@ -277,6 +295,7 @@ sdap_ad_resolve_sids_send(TALLOC_CTX *mem_ctx,
 {
     struct sdap_ad_resolve_sids_state *state = NULL;
     struct tevent_req *req = NULL;
+    int parallel;
     errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state,
@@ -299,11 +318,30 @@ sdap_ad_resolve_sids_send(TALLOC_CTX *mem_ctx,
         goto immediately;
     }
 
-    ret = sdap_ad_resolve_sids_step(req);
-    if (ret != EAGAIN) {
+    ret = sdap_ad_resolve_sids_make_batches(state);
+    if (ret != EOK) {
         goto immediately;
     }
 
+    if (state->num_batches == 0) {
+        ret = sdap_ad_resolve_sids_step(req);
+        if (ret != EAGAIN) {
+            goto immediately;
+        }
+        return req;
+    }
+
+    /* run as many searches at once as there may be connections */
+    parallel = sdap_service_pool_size(conn->service, opts);
+
+    do {
+        ret = sdap_ad_resolve_sids_next_batch(req);
+        if (ret != EAGAIN) {
+            goto immediately;
+        }
+    } while (state->active_batches < (size_t)parallel
+                && state->next_batch < state->num_batches);
+
     return req;
 
 immediately:
@@ -317,6 +355,167 @@ immediately:
     return req;
 }
 
+/* Groups the SIDs by domain. SIDs that would be looked up alone are left to
+ * sdap_ad_resolve_sids_step(). */
+static errno_t sdap_ad_resolve_sids_make_batches(
+                                    struct sdap_ad_resolve_sids_state *state)
+{
+    struct sdap_ad_sids_batch *batch;
+    struct sss_domain_info *domain;
+    struct sdap_domain *sdom;
+    size_t num_sids;
+    size_t i;
+    size_t b;
+
+    for (num_sids = 0; state->sids[num_sids] != NULL; num_sids++) ;
+    if (num_sids < 2) {
+        return EOK;
+    }
+
+    /* at worst all SIDs belong to different domains */
+    state->batches = talloc_zero_array(state, struct sdap_ad_sids_batch,
+                                       num_sids);
+    if (state->batches == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; state->sids[i] != NULL; i++) {
+        domain = sss_get_domain_by_sid_ldap_fallback(state->domain,
+                                                     state->sids[i]);
+        if (domain == NULL) {
+            continue;
+        }
+
+        sdom = sdap_domain_get(state->opts, domain);
+        if (sdom == NULL) {
+            continue;
+        }
+
+        for (b = 0; b < state->num_batches; b++) {
+            if (state->batches[b].sdom == sdom
+                    && state->batches[b].num_sids < SDAP_AD_SIDS_BATCH_SIZE) {
+                break;
+            }
+        }
+
+        batch = &state->batches[b];
+        if (b == state->num_batches) {
+            batch->sdom = sdom;
+            batch->sids = talloc_zero_array(state->batches, const char *,
+                                            SDAP_AD_SIDS_BATCH_SIZE + 1);
+            if (batch->sids == NULL) {
+                return ENOMEM;
+            }
+            state->num_batches++;
+        }
+
+        batch->sids[batch->num_sids] = state->sids[i];
+        batch->num_sids++;
+    }
+
+    /* drop the batches with a single SID */
+    for (i = 0, b = 0; b < state->num_batches; b++) {
+        if (state->batches[b].num_sids < 2) {
+            talloc_free(state->batches[b].sids);
+            continue;
+        }
+        state->batches[i++] = state->batches[b];
+    }
+    state->num_batches = i;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Looking up %zu SIDs with %zu batches\n",
+          num_sids, state->num_batches);
+
+    return EOK;
+}
+
+static errno_t sdap_ad_resolve_sids_next_batch(struct tevent_req *req)
+{
+    struct sdap_ad_resolve_sids_state *state = NULL;
+    struct sdap_ad_sids_batch *batch;
+    struct tevent_req *subreq = NULL;
+
+    state = tevent_req_data(req, struct sdap_ad_resolve_sids_state);
+
+    batch = &state->batches[state->next_batch];
+    state->next_batch++;
+
+    subreq = groups_get_by_sids_send(state, state->ev, state->id_ctx,
+                                     batch->sdom, state->conn, batch->sids);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+
+    tevent_req_set_callback(subreq, sdap_ad_resolve_sids_batch_done, req);
+    state->active_batches++;
+
+    return EAGAIN;
+}
+
+static void sdap_ad_resolve_sids_batch_done(struct tevent_req *subreq)
+{
+    struct sdap_ad_resolve_sids_state *state = NULL;
+    struct tevent_req *req = NULL;
+    int dp_error;
+    int sdap_error;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sdap_ad_resolve_sids_state);
+
+    ret = groups_get_recv(subreq, &dp_error, &sdap_error);
+    talloc_zfree(subreq);
+    state->active_batches--;
+    if (ret != EOK || dp_error != DP_ERR_OK
+            || (sdap_error != EOK && sdap_error != ENOENT)) {
+        /* the SIDs are looked up one by one afterwards */
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to resolve a batch of SIDs "
+              "[dp_error: %d, sdap_error: %d, ret: %d]: %s\n",
+              dp_error, sdap_error, ret, sss_strerror(ret));
+    }
+
+    if (state->next_batch < state->num_batches) {
+        ret = sdap_ad_resolve_sids_next_batch(req);
+        if (ret != EAGAIN) {
+            tevent_req_error(req, ret);
+        }
+        return;
+    }
+
+    if (state->active_batches > 0) {
+        return;
+    }
+
+    /* look up the SIDs no batch has found */
+    ret = sdap_ad_resolve_sids_step(req);
+    if (ret == EAGAIN) {
+        return;
+    } else if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+static bool sdap_ad_resolve_sids_is_cached(
+                                    struct sdap_ad_resolve_sids_state *state,
+                                    struct sss_domain_info *domain,
+                                    const char *sid)
+{
+    const char *attrs[] = { SYSDB_NAME, NULL };
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_search_object_by_sid(state, domain, sid, attrs, &res);
+    if (ret != EOK) {
+        return false;
+    }
+
+    talloc_free(res);
+    return true;
+}
+
 static errno_t sdap_ad_resolve_sids_step(struct tevent_req *req)
 {
     struct sdap_ad_resolve_sids_state *state = NULL;
@@ -339,6 +538,11 @@ static errno_t sdap_ad_resolve_sids_step(struct tevent_req *req)
         if (domain == NULL) {
             DEBUG(SSSDBG_MINOR_FAILURE, "SID %s does not belong to any known "
                                          "domain\n", state->current_sid);
+        } else if (state->num_batches > 0
+                && sdap_ad_resolve_sids_is_cached(state, domain,
+                                                  state->current_sid)) {
+            /* resolved by one of the batches */
+            domain = NULL;
         }
     } while (domain == NULL);
 
@@ -55,6 +55,13 @@ struct sdap_nested_group_member {
     const char *dn;
     const char *user_filter;
     const char *group_filter;
+
+    /* set when the member was already searched for in a batch, entry is
+     * NULL if it was not found */
+    bool looked_up;
+    bool was_unknown;
+    bool not_user;
+    struct sysdb_attrs *entry;
 };
 
 #ifndef EXTERNAL_MEMBERS_CHUNK
@@ -78,6 +85,8 @@ struct sdap_nested_group_ctx {
     bool try_deref;
     int deref_threshold;
     int max_nesting_level;
+    int batch_size;
+    int parallel;
 };
 
 static struct tevent_req *
@@ -132,6 +141,15 @@ sdap_nested_group_lookup_unknown_recv(TALLOC_CTX *mem_ctx,
                                       struct sysdb_attrs **_entry,
                                       enum sdap_nested_group_dn_type *_type);
 
+static struct tevent_req *
+sdap_nested_group_lookup_batch_send(TALLOC_CTX *mem_ctx,
+                                    struct tevent_context *ev,
+                                    struct sdap_nested_group_ctx *group_ctx,
+                                    struct sdap_nested_group_member *members,
+                                    int num_members);
+
+static errno_t sdap_nested_group_lookup_batch_recv(struct tevent_req *req);
+
 static struct tevent_req *
 sdap_nested_group_deref_send(TALLOC_CTX *mem_ctx,
                              struct tevent_context *ev,
@@ -835,6 +853,13 @@ sdap_nested_group_send(TALLOC_CTX *mem_ctx,
                                                       SDAP_DEREF_THRESHOLD);
     state->group_ctx->max_nesting_level = dp_opt_get_int(opts->basic,
                                                          SDAP_NESTING_LEVEL);
+    state->group_ctx->batch_size = dp_opt_get_int(opts->basic,
+                                                  SDAP_GROUP_MEMBER_BATCH_SIZE);
+    state->group_ctx->parallel = dp_opt_get_int(opts->basic,
+                                                SDAP_NESTED_GROUP_PARALLEL);
+    if (state->group_ctx->parallel < 1) {
+        state->group_ctx->parallel = 1;
+    }
     state->group_ctx->domain = sdom->dom;
     state->group_ctx->opts = opts;
     state->group_ctx->user_search_bases = sdom->user_search_bases;
@@ -1234,6 +1259,7 @@ struct sdap_nested_group_recurse_state {
     struct sysdb_attrs **groups;
     int num_groups;
     int index;
+    int running;
     int nesting_level;
 };
 
@@ -1266,7 +1292,8 @@ sdap_nested_group_recurse_send(TALLOC_CTX *mem_ctx,
     state->index = 0;
     state->nesting_level = nesting_level;
 
-    /* process each group individually */
+    /* process up to group_ctx->parallel groups at the same time, their
+     * searches are multiplexed over the connection of the lookup */
     ret = sdap_nested_group_recurse_step(req);
     if (ret != EAGAIN) {
         goto immediately;
@@ -1292,34 +1319,42 @@ static errno_t sdap_nested_group_recurse_step(struct tevent_req *req)
 
     state = tevent_req_data(req, struct sdap_nested_group_recurse_state);
 
-    if (state->index >= state->num_groups) {
-        /* we're done */
-        return EOK;
-    }
+    while (state->index < state->num_groups
+            && state->running < state->group_ctx->parallel) {
+        subreq = sdap_nested_group_process_send(state, state->ev,
+                                                state->group_ctx,
+                                                state->nesting_level,
+                                                state->groups[state->index]);
+        if (subreq == NULL) {
+            return ENOMEM;
+        }
 
-    subreq = sdap_nested_group_process_send(state, state->ev, state->group_ctx,
-                                            state->nesting_level,
-                                            state->groups[state->index]);
-    if (subreq == NULL) {
-        return ENOMEM;
-    }
+        tevent_req_set_callback(subreq, sdap_nested_group_recurse_done, req);
 
-    tevent_req_set_callback(subreq, sdap_nested_group_recurse_done, req);
+        state->index++;
+        state->running++;
+    }
 
-    state->index++;
+    if (state->running == 0) {
+        /* we're done */
+        return EOK;
+    }
 
     return EAGAIN;
 }
 
 static void sdap_nested_group_recurse_done(struct tevent_req *subreq)
 {
+    struct sdap_nested_group_recurse_state *state = NULL;
     struct tevent_req *req = NULL;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sdap_nested_group_recurse_state);
 
     ret = sdap_nested_group_process_recv(subreq);
     talloc_zfree(subreq);
+    state->running--;
     if (ret != EOK) {
         goto done;
     }
@@ -1358,6 +1393,8 @@ struct sdap_nested_group_single_state {
 };
 
 static errno_t sdap_nested_group_single_step(struct tevent_req *req);
+static errno_t sdap_nested_group_single_next(struct tevent_req *req);
+static void sdap_nested_group_single_batch_done(struct tevent_req *subreq);
 static void sdap_nested_group_single_step_done(struct tevent_req *subreq);
 static void sdap_nested_group_single_done(struct tevent_req *subreq);
 
@@ -1372,6 +1409,7 @@ sdap_nested_group_single_send(TALLOC_CTX *mem_ctx,
 {
     struct sdap_nested_group_single_state *state = NULL;
     struct tevent_req *req = NULL;
+    struct tevent_req *subreq = NULL;
     errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state,
@@ -1396,6 +1434,21 @@ sdap_nested_group_single_send(TALLOC_CTX *mem_ctx,
     }
     state->num_groups = 0; /* we will count exact number of the groups */
 
+    if (group_ctx->batch_size > 1 && num_members > 1) {
+        /* look up members of the same container together first */
+        subreq = sdap_nested_group_lookup_batch_send(state, ev, group_ctx,
+                                                     members, num_members);
+        if (subreq == NULL) {
+            ret = ENOMEM;
+            goto immediately;
+        }
+
+        tevent_req_set_callback(subreq, sdap_nested_group_single_batch_done,
+                                req);
+
+        return req;
+    }
+
     /* process each member individually */
     ret = sdap_nested_group_single_step(req);
     if (ret != EAGAIN) {
@@ -1415,89 +1468,22 @@ immediately:
     return req;
 }
 
-static errno_t sdap_nested_group_single_step(struct tevent_req *req)
-{
-    struct sdap_nested_group_single_state *state = NULL;
-    struct tevent_req *subreq = NULL;
-
-    state = tevent_req_data(req, struct sdap_nested_group_single_state);
-
-    if (state->member_index >= state->num_members) {
-        /* we're done */
-        return EOK;
-    }
-
-    state->current_member = &state->members[state->member_index];
-    state->member_index++;
-
-    switch (state->current_member->type) {
-    case SDAP_NESTED_GROUP_DN_USER:
-        subreq = sdap_nested_group_lookup_user_send(state, state->ev,
-                                                    state->group_ctx,
-                                                    state->current_member);
-        break;
-    case SDAP_NESTED_GROUP_DN_GROUP:
-        subreq = sdap_nested_group_lookup_group_send(state, state->ev,
-                                                     state->group_ctx,
-                                                     state->current_member);
-        break;
-    case SDAP_NESTED_GROUP_DN_UNKNOWN:
-        subreq = sdap_nested_group_lookup_unknown_send(state, state->ev,
-                                                   state->group_ctx,
-                                                   state->current_member);
-        break;
-    }
-
-    if (subreq == NULL) {
-        return ENOMEM;
-    }
-
-    tevent_req_set_callback(subreq, sdap_nested_group_single_step_done, req);
-
-    return EAGAIN;
-}
-
 static errno_t
-sdap_nested_group_single_step_process(struct tevent_req *subreq)
+sdap_nested_group_single_save(struct sdap_nested_group_single_state *state,
+                              struct sdap_nested_group_member *member,
+                              struct sysdb_attrs *entry,
+                              bool was_unknown)
 {
-    struct sdap_nested_group_single_state *state = NULL;
-    struct tevent_req *req = NULL;
-    struct sysdb_attrs *entry = NULL;
-    enum sdap_nested_group_dn_type type = SDAP_NESTED_GROUP_DN_UNKNOWN;
     const char *orig_dn = NULL;
     errno_t ret;
 
-    req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct sdap_nested_group_single_state);
-
-    /* set correct type if possible */
-    if (state->current_member->type == SDAP_NESTED_GROUP_DN_UNKNOWN) {
-        ret = sdap_nested_group_lookup_unknown_recv(state, subreq,
-                                                    &entry, &type);
-        if (ret != EOK) {
-            goto done;
-        }
-
-        if (entry != NULL) {
-            state->current_member->type = type;
-        }
+    if (entry == NULL) {
+        /* not found, continue */
+        return EOK;
     }
 
-    switch (state->current_member->type) {
+    switch (member->type) {
     case SDAP_NESTED_GROUP_DN_USER:
-        if (entry == NULL) {
-            /* type was not unknown, receive data */
-            ret = sdap_nested_group_lookup_user_recv(state, subreq, &entry);
-            if (ret != EOK) {
-                goto done;
-            }
-
-            if (entry == NULL) {
-                /* user not found, continue */
-                break;
-            }
-        }
-
         /* The original DN of the user object itself might differ from the one
          * used in the member attribute, e.g. different case. To make sure if
          * can be found in a hash table when iterating over group members the
@@ -1505,10 +1491,10 @@ sdap_nested_group_single_step_process(struct tevent_req *subreq)
          */
         ret = sysdb_attrs_add_string(entry,
                                      SYSDB_DN_FOR_MEMBER_HASH_TABLE,
-                                     state->current_member->dn);
+                                     member->dn);
         if (ret != EOK) {
             DEBUG(SSSDBG_OP_FAILURE, "sysdb_attrs_add_string failed.\n");
-            goto done;
+            return ret;
         }
 
         /* save user in hash table */
@@ -1516,42 +1502,29 @@ sdap_nested_group_single_step_process(struct tevent_req *subreq)
         if (ret == EEXIST) {
             /* the user is already present, skip it */
             talloc_zfree(entry);
-            ret = EOK;
-            goto done;
+            return EOK;
         } else if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Unable to save user in hash table "
                                         "[%d]: %s\n", ret, strerror(ret));
-            goto done;
+            return ret;
         }
         break;
     case SDAP_NESTED_GROUP_DN_GROUP:
-        if (entry == NULL) {
-            /* type was not unknown, receive data */
-            ret = sdap_nested_group_lookup_group_recv(state, subreq, &entry);
+        /* the type was unknown so we had to pull the group,
+         * but we don't want to process it if we have reached
+         * the nesting level */
+        if (was_unknown
+                && state->nesting_level >= state->group_ctx->max_nesting_level) {
+            ret = sysdb_attrs_get_string(entry, SYSDB_ORIG_DN, &orig_dn);
             if (ret != EOK) {
-                goto done;
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "The entry has no originalDN\n");
+                orig_dn = "invalid";
             }
 
-            if (entry == NULL) {
-                /* group not found, continue */
-                break;
-            }
-        } else {
-            /* the type was unknown so we had to pull the group,
-             * but we don't want to process it if we have reached
-             * the nesting level */
-            if (state->nesting_level >= state->group_ctx->max_nesting_level) {
-                ret = sysdb_attrs_get_string(entry, SYSDB_ORIG_DN, &orig_dn);
-                if (ret != EOK) {
-                    DEBUG(SSSDBG_MINOR_FAILURE,
-                          "The entry has no originalDN\n");
-                    orig_dn = "invalid";
-                }
-
-                DEBUG(SSSDBG_TRACE_ALL, "[%s] is outside nesting limit "
-                      "(level %d), skipping\n", orig_dn, state->nesting_level);
-                break;
-            }
+            DEBUG(SSSDBG_TRACE_ALL, "[%s] is outside nesting limit "
+                  "(level %d), skipping\n", orig_dn, state->nesting_level);
+            break;
         }
 
         /* save group in hash table */
@@ -1559,12 +1532,11 @@ sdap_nested_group_single_step_process(struct tevent_req *subreq)
         if (ret == EEXIST) {
             /* the group is already present, skip it */
             talloc_zfree(entry);
-            ret = EOK;
-            goto done;
+            return EOK;
         } else if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Unable to save group in hash table "
                                         "[%d]: %s\n", ret, strerror(ret));
-            goto done;
+            return ret;
         }
 
         /* remember the group for later processing */
@@ -1577,21 +1549,171 @@ sdap_nested_group_single_step_process(struct tevent_req *subreq)
         break;
     }
 
-    ret = EOK;
+    return EOK;
+}
 
-done:
-    return ret;
+static errno_t sdap_nested_group_single_step(struct tevent_req *req)
+{
+    struct sdap_nested_group_single_state *state = NULL;
+    struct sdap_nested_group_member *member = NULL;
+    struct tevent_req *subreq = NULL;
+    struct sysdb_attrs *entry = NULL;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct sdap_nested_group_single_state);
+
+    while (state->member_index < state->num_members) {
+        member = &state->members[state->member_index];
+        state->current_member = member;
+        state->member_index++;
+
+        if (member->looked_up) {
+            /* the member was already searched for in a batch */
+            entry = member->entry;
+            member->entry = NULL;
+
+            ret = sdap_nested_group_single_save(state, member, entry,
+                                                member->was_unknown);
+            if (ret != EOK) {
+                return ret;
+            }
+
+            continue;
+        }
+
+        switch (member->type) {
+        case SDAP_NESTED_GROUP_DN_USER:
+            subreq = sdap_nested_group_lookup_user_send(state, state->ev,
+                                                        state->group_ctx,
+                                                        member);
+            break;
+        case SDAP_NESTED_GROUP_DN_GROUP:
+            subreq = sdap_nested_group_lookup_group_send(state, state->ev,
+                                                         state->group_ctx,
+                                                         member);
+            break;
+        case SDAP_NESTED_GROUP_DN_UNKNOWN:
+            subreq = sdap_nested_group_lookup_unknown_send(state, state->ev,
+                                                           state->group_ctx,
+                                                           member);
+            break;
+        }
+
+        if (subreq == NULL) {
+            return ENOMEM;
+        }
+
+        tevent_req_set_callback(subreq, sdap_nested_group_single_step_done,
+                                req);
+
+        return EAGAIN;
+    }
+
+    /* we're done */
+    return EOK;
 }
 
-static void sdap_nested_group_single_step_done(struct tevent_req *subreq)
+static errno_t sdap_nested_group_single_next(struct tevent_req *req)
+{
+    struct sdap_nested_group_single_state *state = NULL;
+    struct tevent_req *subreq = NULL;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct sdap_nested_group_single_state);
+
+    ret = sdap_nested_group_single_step(req);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    /* we have processed all direct members,
+     * now recurse and process nested groups */
+    subreq = sdap_nested_group_recurse_send(state, state->ev,
+                                            state->group_ctx,
+                                            state->nested_groups,
+                                            state->num_groups,
+                                            state->nesting_level + 1);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+
+    tevent_req_set_callback(subreq, sdap_nested_group_single_done, req);
+
+    return EAGAIN;
+}
+
+static void sdap_nested_group_single_batch_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = NULL;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+
+    ret = sdap_nested_group_lookup_batch_recv(subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Error looking up members in batches "
+                                    "[%d]: %s\n", ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    /* process the members found and look up the rest individually */
+    ret = sdap_nested_group_single_next(req);
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static errno_t
+sdap_nested_group_single_step_process(struct tevent_req *subreq)
 {
     struct sdap_nested_group_single_state *state = NULL;
     struct tevent_req *req = NULL;
+    struct sysdb_attrs *entry = NULL;
+    enum sdap_nested_group_dn_type type = SDAP_NESTED_GROUP_DN_UNKNOWN;
+    bool was_unknown = false;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct sdap_nested_group_single_state);
 
+    switch (state->current_member->type) {
+    case SDAP_NESTED_GROUP_DN_USER:
+        ret = sdap_nested_group_lookup_user_recv(state, subreq, &entry);
+        break;
+    case SDAP_NESTED_GROUP_DN_GROUP:
+        ret = sdap_nested_group_lookup_group_recv(state, subreq, &entry);
+        break;
+    case SDAP_NESTED_GROUP_DN_UNKNOWN:
+        ret = sdap_nested_group_lookup_unknown_recv(state, subreq,
+                                                    &entry, &type);
+        if (ret == EOK && entry != NULL) {
+            /* set correct type */
+            state->current_member->type = type;
+            was_unknown = true;
+        }
+        break;
+    default:
+        ret = EINVAL;
+        break;
+    }
+
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return sdap_nested_group_single_save(state, state->current_member, entry,
+                                         was_unknown);
+}
+
+static void sdap_nested_group_single_step_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = NULL;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+
     /* process direct members */
     ret = sdap_nested_group_single_step_process(subreq);
     talloc_zfree(subreq);
@@ -1601,35 +1723,11 @@ static void sdap_nested_group_single_step_done(struct tevent_req *subreq)
         goto done;
     }
 
-    ret = sdap_nested_group_single_step(req);
-    if (ret == EOK) {
-        /* we have processed all direct members,
-         * now recurse and process nested groups */
-        subreq = sdap_nested_group_recurse_send(state, state->ev,
-                                                state->group_ctx,
-                                                state->nested_groups,
-                                                state->num_groups,
-                                                state->nesting_level + 1);
-        if (subreq == NULL) {
-            ret = ENOMEM;
-            goto done;
-        }
-
-        tevent_req_set_callback(subreq, sdap_nested_group_single_done, req);
-    } else if (ret != EAGAIN) {
-        /* error */
-        goto done;
-    }
-
-    /* we're not done yet */
-    ret = EAGAIN;
+    /* continue with the next member or recurse into nested groups */
+    ret = sdap_nested_group_single_next(req);
 
 done:
-    if (ret == EOK) {
-        /* tevent_req_error() cannot cope with EOK */
-        DEBUG(SSSDBG_CRIT_FAILURE, "We should not get here with EOK\n");
-        tevent_req_error(req, EINVAL);
-    } else if (ret != EAGAIN) {
+    if (ret != EAGAIN) {
         tevent_req_error(req, ret);
     }
 
@@ -2193,17 +2291,499 @@ sdap_nested_group_lookup_unknown_recv(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
-struct sdap_nested_group_deref_state {
-    struct tevent_context *ev;
-    struct sdap_nested_group_ctx *group_ctx;
-    struct ldb_message_element *members;
-    int nesting_level;
+/* Members that live in the same container are looked up together with one
+ * ONELEVEL search of the container, filtered by an OR list of their RDNs.
+ * Users are searched for first, members of unknown type that are not found
+ * among users are searched for in the group round. Members which are in
+ * a batch of their own or whose batch failed are left for the individual
+ * lookups. */
+
+enum sdap_nested_group_batch_round {
+    SDAP_NESTED_GROUP_BATCH_START,
+    SDAP_NESTED_GROUP_BATCH_USERS,
+    SDAP_NESTED_GROUP_BATCH_GROUPS
+};
 
-    struct sysdb_attrs **nested_groups;
-    int num_groups;
+struct sdap_nested_group_batch {
+    struct ldb_dn *base_dn;
+    const char *search_filter;
+    char *rdn_filter;
+    struct sdap_nested_group_member **members;
+    struct ldb_dn **dns;
+    int num_members;
 };
 
-static void sdap_nested_group_deref_direct_done(struct tevent_req *subreq);
+struct sdap_nested_group_lookup_batch_state {
+    struct tevent_context *ev;
+    struct sdap_nested_group_ctx *group_ctx;
+    struct sdap_nested_group_member *members;
+    int num_members;
+
+    enum sdap_nested_group_batch_round round;
+    TALLOC_CTX *round_ctx;
+    const char **attrs;
+    const char *base_filter;
+    struct sdap_attr_map *map;
+    size_t map_cnt;
+
+    struct sdap_nested_group_batch *batches;
+    int num_batches;
+    int batch_index;
+};
+
+static errno_t
+sdap_nested_group_lookup_batch_step(struct tevent_req *req);
+static void
+sdap_nested_group_lookup_batch_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sdap_nested_group_lookup_batch_send(TALLOC_CTX *mem_ctx,
+                                    struct tevent_context *ev,
+                                    struct sdap_nested_group_ctx *group_ctx,
+                                    struct sdap_nested_group_member *members,
+                                    int num_members)
+{
+    struct sdap_nested_group_lookup_batch_state *state = NULL;
+    struct tevent_req *req = NULL;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state,
+                            struct sdap_nested_group_lookup_batch_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->ev = ev;
+    state->group_ctx = group_ctx;
+    state->members = members;
+    state->num_members = num_members;
+    state->round = SDAP_NESTED_GROUP_BATCH_START;
+
+    ret = sdap_nested_group_lookup_batch_step(req);
+    if (ret != EAGAIN) {
+        goto immediately;
+    }
+
+    return req;
+
+immediately:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else {
+        tevent_req_error(req, ret);
+    }
+    tevent_req_post(req, ev);
+
+    return req;
+}
+
+static bool
+sdap_nested_group_batch_wants(struct sdap_nested_group_lookup_batch_state *state,
+                              struct sdap_nested_group_member *member)
+{
+    if (member->looked_up) {
+        return false;
+    }
+
+    switch (member->type) {
+    case SDAP_NESTED_GROUP_DN_USER:
+        return state->round == SDAP_NESTED_GROUP_BATCH_USERS;
+    case SDAP_NESTED_GROUP_DN_GROUP:
+        return state->round == SDAP_NESTED_GROUP_BATCH_GROUPS;
+    case SDAP_NESTED_GROUP_DN_UNKNOWN:
+        if (state->round == SDAP_NESTED_GROUP_BATCH_USERS) {
+            return true;
+        }
+        return member->not_user;
+    }
+
+    return false;
+}
+
+static bool sdap_nested_group_batch_same_filter(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+
+    return strcmp(a, b) == 0;
+}
+
+static errno_t
+sdap_nested_group_batch_add(struct sdap_nested_group_lookup_batch_state *state,
+                            struct sdap_nested_group_member *member)
+{
+    struct ldb_context *ldb = sysdb_ctx_get_ldb(state->group_ctx->domain->sysdb);
+    struct sdap_nested_group_batch *batch = NULL;
+    const struct ldb_val *rdn_val;
+    const char *rdn_name;
+    const char *search_filter;
+    struct ldb_dn *parent;
+    struct ldb_dn *dn;
+    char *value;
+    errno_t ret;
+    int i;
+
+    dn = ldb_dn_new(state->round_ctx, ldb, member->dn);
+    if (dn == NULL) {
+        return ENOMEM;
+    }
+
+    rdn_name = ldb_dn_get_rdn_name(dn);
+    rdn_val = ldb_dn_get_rdn_val(dn);
+    if (!ldb_dn_validate(dn) || ldb_dn_get_comp_num(dn) < 2
+            || rdn_name == NULL || rdn_val == NULL) {
+        /* leave it for the individual lookup */
+        DEBUG(SSSDBG_TRACE_ALL, "Unable to batch [%s]\n", member->dn);
+        talloc_free(dn);
+        return EOK;
+    }
+
+    parent = ldb_dn_get_parent(state->round_ctx, dn);
+    if (parent == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sss_filter_sanitize(state->round_ctx, (const char *)rdn_val->data,
+                              &value);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    search_filter = state->round == SDAP_NESTED_GROUP_BATCH_USERS
+                        ? member->user_filter : member->group_filter;
+
+    for (i = 0; i < state->num_batches; i++) {
+        if (state->batches[i].num_members < state->group_ctx->batch_size
+                && ldb_dn_compare(state->batches[i].base_dn, parent) == 0
+                && sdap_nested_group_batch_same_filter(
+                                            state->batches[i].search_filter,
+                                            search_filter)) {
+            batch = &state->batches[i];
+            break;
+        }
+    }
+
+    if (batch == NULL) {
+        state->batches = talloc_realloc(state->round_ctx, state->batches,
+                                        struct sdap_nested_group_batch,
+                                        state->num_batches + 1);
+        if (state->batches == NULL) {
+            return ENOMEM;
+        }
+
+        batch = &state->batches[state->num_batches];
+        state->num_batches++;
+
+        batch->base_dn = parent;
+        batch->search_filter = search_filter;
+        batch->num_members = 0;
+        batch->rdn_filter = talloc_strdup(state->batches, "");
+        batch->members = talloc_array(state->batches,
+                                      struct sdap_nested_group_member *,
+                                      state->group_ctx->batch_size);
+        batch->dns = talloc_array(state->batches, struct ldb_dn *,
+                                  state->group_ctx->batch_size);
+        if (batch->rdn_filter == NULL || batch->members == NULL
+                || batch->dns == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    batch->rdn_filter = talloc_asprintf_append_buffer(batch->rdn_filter,
+                                                      "(%s=%s)",
+                                                      rdn_name, value);
+    if (batch->rdn_filter == NULL) {
+        return ENOMEM;
+    }
+
+    batch->members[batch->num_members] = member;
+    batch->dns[batch->num_members] = dn;
+    batch->num_members++;
+
+    return EOK;
+}
+
+static errno_t
+sdap_nested_group_batch_round(struct sdap_nested_group_lookup_batch_state *state)
+{
+    struct sdap_nested_group_ctx *group_ctx = state->group_ctx;
+    char *oc_list;
+    errno_t ret;
+    int i;
+
+    talloc_zfree(state->round_ctx);
+    state->batches = NULL;
+    state->num_batches = 0;
+    state->batch_index = 0;
+
+    if (state->round == SDAP_NESTED_GROUP_BATCH_USERS
+            && group_ctx->opts->schema_type == SDAP_SCHEMA_IPA_V1) {
+        /* IPA users are resolved from their DN without a search */
+        return EOK;
+    }
+
+    state->round_ctx = talloc_new(state);
+    if (state->round_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    if (state->round == SDAP_NESTED_GROUP_BATCH_USERS) {
+        /* same attributes as sdap_nested_group_lookup_user_send() */
+        state->attrs = talloc_array(state->round_ctx, const char *, 3);
+        if (state->attrs == NULL) {
+            return ENOMEM;
+        }
+
+        state->attrs[0] = "objectClass";
+        state->attrs[1] = group_ctx->opts->user_map[SDAP_AT_USER_NAME].name;
+        state->attrs[2] = NULL;
+
+        state->base_filter = talloc_asprintf(state->round_ctx,
+                                    "(objectclass=%s)",
+                                    group_ctx->opts->user_map[SDAP_OC_USER].name);
+        state->map = group_ctx->opts->user_map;
+        state->map_cnt = group_ctx->opts->user_map_cnt;
+    } else {
+        /* same attributes as sdap_nested_group_lookup_group_send() */
+        ret = build_attrs_from_map(state->round_ctx, group_ctx->opts->group_map,
+                                   SDAP_OPTS_GROUP, NULL, &state->attrs, NULL);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        oc_list = sdap_make_oc_list(state->round_ctx,
+                                    group_ctx->opts->group_map);
+        if (oc_list == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Failed to create objectClass list.\n");
+            return ENOMEM;
+        }
+
+        state->base_filter = talloc_asprintf(state->round_ctx,
+                            "(&(%s)(%s=*))", oc_list,
+                            group_ctx->opts->group_map[SDAP_AT_GROUP_NAME].name);
+        state->map = group_ctx->opts->group_map;
+        state->map_cnt = SDAP_OPTS_GROUP;
+    }
+
+    if (state->base_filter == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < state->num_members; i++) {
+        if (!sdap_nested_group_batch_wants(state, &state->members[i])) {
+            continue;
+        }
+
+        ret = sdap_nested_group_batch_add(state, &state->members[i]);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    return EOK;
+}
+
+static errno_t
+sdap_nested_group_lookup_batch_step(struct tevent_req *req)
+{
+    struct sdap_nested_group_lookup_batch_state *state = NULL;
+    struct sdap_nested_group_batch *batch = NULL;
+    struct tevent_req *subreq = NULL;
+    const char *filter;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct sdap_nested_group_lookup_batch_state);
+
+    do {
+        while (state->batch_index >= state->num_batches) {
+            if (state->round == SDAP_NESTED_GROUP_BATCH_GROUPS) {
+                /* we're done */
+                return EOK;
+            }
+
+            state->round++;
+            ret = sdap_nested_group_batch_round(state);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
+
+        batch = &state->batches[state->batch_index];
+        state->batch_index++;
+
+        /* a single member is cheaper to look up with a BASE search */
+    } while (batch->num_members < 2);
+
+    filter = talloc_asprintf(batch->members, "(&%s(|%s))",
+                             state->base_filter, batch->rdn_filter);
+    if (filter == NULL) {
+        return ENOMEM;
+    }
+
+    /* use search base filter if needed */
+    filter = sdap_combine_filters(batch->members, filter,
+                                  batch->search_filter);
+    if (filter == NULL) {
+        return ENOMEM;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Looking up %d %s under [%s]\n",
+          batch->num_members,
+          state->round == SDAP_NESTED_GROUP_BATCH_USERS ? "users" : "groups",
+          ldb_dn_get_linearized(batch->base_dn));
+
+    if (state->round == SDAP_NESTED_GROUP_BATCH_USERS) {
+        PROBE(SDAP_NESTED_GROUP_LOOKUP_USER_SEND);
+    } else {
+        PROBE(SDAP_NESTED_GROUP_LOOKUP_GROUP_SEND);
+    }
+
+    subreq = sdap_get_generic_send(state, state->ev, state->group_ctx->opts,
+                                   state->group_ctx->sh,
+                                   ldb_dn_get_linearized(batch->base_dn),
+                                   LDAP_SCOPE_ONELEVEL, filter, state->attrs,
+                                   state->map, state->map_cnt,
+                                   dp_opt_get_int(state->group_ctx->opts->basic,
+                                                  SDAP_SEARCH_TIMEOUT),
+                                   false);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+
+    tevent_req_set_callback(subreq, sdap_nested_group_lookup_batch_done, req);
+
+    return EAGAIN;
+}
+
+static void
+sdap_nested_group_batch_match(struct sdap_nested_group_lookup_batch_state *state,
+                              struct sdap_nested_group_batch *batch,
+                              struct sysdb_attrs **entries,
+                              size_t count)
+{
+    struct ldb_context *ldb = sysdb_ctx_get_ldb(state->group_ctx->domain->sysdb);
+    struct sdap_nested_group_member *member;
+    struct ldb_dn *dn;
+    const char *orig_dn;
+    errno_t ret;
+    size_t i;
+    int j;
+
+    for (i = 0; i < count; i++) {
+        ret = sysdb_attrs_get_string(entries[i], SYSDB_ORIG_DN, &orig_dn);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "The entry has no originalDN\n");
+            continue;
+        }
+
+        dn = ldb_dn_new(batch->members, ldb, orig_dn);
+        if (dn == NULL || !ldb_dn_validate(dn)) {
+            talloc_free(dn);
+            continue;
+        }
+
+        /* the filter may match other entries of the container as well */
+        for (j = 0; j < batch->num_members; j++) {
+            member = batch->members[j];
+            if (member->looked_up || ldb_dn_compare(batch->dns[j], dn) != 0) {
+                continue;
+            }
+
+            member->entry = talloc_steal(state->members, entries[i]);
+            member->looked_up = true;
+            if (member->type == SDAP_NESTED_GROUP_DN_UNKNOWN) {
+                member->type = state->round == SDAP_NESTED_GROUP_BATCH_USERS
+                                    ? SDAP_NESTED_GROUP_DN_USER
+                                    : SDAP_NESTED_GROUP_DN_GROUP;
+                member->was_unknown = true;
+            }
+            break;
+        }
+
+        talloc_free(dn);
+    }
+
+    /* the members that were not returned do not exist */
+    for (j = 0; j < batch->num_members; j++) {
+        member = batch->members[j];
+        if (member->looked_up) {
+            continue;
+        }
+
+        if (member->type == SDAP_NESTED_GROUP_DN_UNKNOWN
+                && state->round == SDAP_NESTED_GROUP_BATCH_USERS) {
+            /* try to find it among groups */
+            member->not_user = true;
+        } else {
+            member->looked_up = true;
+        }
+    }
+}
+
+static void
+sdap_nested_group_lookup_batch_done(struct tevent_req *subreq)
+{
+    struct sdap_nested_group_lookup_batch_state *state = NULL;
+    struct tevent_req *req = NULL;
+    struct sysdb_attrs **entries = NULL;
+    size_t count = 0;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sdap_nested_group_lookup_batch_state);
+
+    ret = sdap_get_generic_recv(subreq, state, &count, &entries);
+    talloc_zfree(subreq);
+
+    if (state->round == SDAP_NESTED_GROUP_BATCH_USERS) {
+        PROBE(SDAP_NESTED_GROUP_LOOKUP_USER_RECV);
+    } else {
+        PROBE(SDAP_NESTED_GROUP_LOOKUP_GROUP_RECV);
+    }
+
+    if (ret == ENOENT) {
+        count = 0;
+        ret = EOK;
+    }
+
+    if (ret == EOK) {
+        sdap_nested_group_batch_match(state,
+                                      &state->batches[state->batch_index - 1],
+                                      entries, count);
+    } else {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Batched lookup failed [%d]: %s, the "
+              "members will be looked up individually\n",
+              ret, sss_strerror(ret));
+    }
+
+    ret = sdap_nested_group_lookup_batch_step(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static errno_t sdap_nested_group_lookup_batch_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+struct sdap_nested_group_deref_state {
+    struct tevent_context *ev;
+    struct sdap_nested_group_ctx *group_ctx;
+    struct ldb_message_element *members;
+    int nesting_level;
+
+    struct sysdb_attrs **nested_groups;
+    int num_groups;
+};
+
+static void sdap_nested_group_deref_direct_done(struct tevent_req *subreq);
 static void sdap_nested_group_deref_done(struct tevent_req *subreq);
 
 static struct tevent_req *
@@ -2293,6 +2873,35 @@ immediately:
     return req;
 }
 
+/* Adds the DN to the set of member DNs, returns EEXIST if it is there */
+static errno_t sdap_nested_group_member_dn_add(hash_table_t *dns,
+                                               const char *dn)
+{
+    hash_key_t key;
+    hash_value_t value;
+    int hret;
+
+    key.type = HASH_KEY_STRING;
+    key.str = sss_tc_utf8_str_tolower(dns, dn);
+    if (key.str == NULL) {
+        return ENOMEM;
+    }
+
+    if (hash_has_key(dns, &key)) {
+        talloc_free(key.str);
+        return EEXIST;
+    }
+
+    value.type = HASH_VALUE_UNDEF;
+    hret = hash_enter(dns, &key, &value);
+    talloc_free(key.str);
+    if (hret != HASH_SUCCESS) {
+        return EIO;
+    }
+
+    return EOK;
+}
+
 static errno_t
 sdap_nested_group_deref_direct_process(struct tevent_req *subreq)
 {
@@ -2302,10 +2911,9 @@ sdap_nested_group_deref_direct_process(struct tevent_req *subreq)
     struct sdap_deref_attrs **entries = NULL;
     struct ldb_message_element *members = NULL;
     const char *orig_dn = NULL;
-    const char *member_dn = NULL;
+    hash_table_t *member_dns = NULL;
     size_t num_entries = 0;
-    size_t i, j;
-    bool member_found;
+    size_t i;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
@@ -2334,6 +2942,22 @@ sdap_nested_group_deref_direct_process(struct tevent_req *subreq)
         goto done;
     }
 
+    /* The member list of a large group can have hundreds of thousands of
+     * values once all of its ranges were read, look them up in a hash
+     * table instead of scanning the list for each result */
+    ret = sss_hash_create(state, members->num_values, &member_dns);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    for (i = 0; i < members->num_values; i++) {
+        orig_dn = (const char *)members->values[i].data;
+        ret = sdap_nested_group_member_dn_add(member_dns, orig_dn);
+        if (ret != EOK && ret != EEXIST) {
+            goto done;
+        }
+    }
+
     PROBE(SDAP_NESTED_GROUP_DEREF_PROCESS_PRE);
     for (i = 0; i < num_entries; i++) {
         ret = sysdb_attrs_get_string(entries[i]->attrs,
@@ -2348,17 +2972,12 @@ sdap_nested_group_deref_direct_process(struct tevent_req *subreq)
          * from deref/asq than we got from the initial lookup, as is the case
          * with Active Directory and its range retrieval mechanism.
          */
-        member_found = false;
-        for (j = 0; j < members->num_values; j++) {
-            /* FIXME: This is inefficient for very large sets of groups */
-            member_dn = (const char *)members->values[j].data;
-            if (strcasecmp(orig_dn, member_dn) == 0) {
-                member_found = true;
-                break;
-            }
+        ret = sdap_nested_group_member_dn_add(member_dns, orig_dn);
+        if (ret != EOK && ret != EEXIST) {
+            goto done;
         }
 
-        if (!member_found) {
+        if (ret == EOK) {
             /* Append newly found member to member list.
              * Changes in state->members will propagate into sysdb_attrs of
              * the group. */
@@ -2455,6 +3074,7 @@ sdap_nested_group_deref_direct_process(struct tevent_req *subreq)
     ret = EOK;
 
 done:
+    talloc_free(member_dns);
     return ret;
 }
 
@@ -169,13 +169,14 @@ static int sdap_user_set_mpg(struct sysdb_attrs *user_attrs,
 }
 
 /* FIXME: support storing additional attributes */
-int sdap_save_user(TALLOC_CTX *memctx,
-                   struct sdap_options *opts,
-                   struct sss_domain_info *dom,
-                   struct sysdb_attrs *attrs,
-                   struct sysdb_attrs *mapped_attrs,
-                   char **_usn_value,
-                   time_t now)
+/* Converts the LDAP attributes of a user into the data stored in the
+ * cache. The name of the entry is left NULL if the user is skipped. */
+static int sdap_save_user_prepare(TALLOC_CTX *memctx,
+                                  struct sdap_options *opts,
+                                  struct sss_domain_info *dom,
+                                  struct sysdb_attrs *attrs,
+                                  struct sysdb_store_user_entry *entry,
+                                  char **_usn_value)
 {
     struct ldb_message_element *el;
     int ret;
@@ -206,6 +207,8 @@ int sdap_save_user(TALLOC_CTX *memctx,
 
     DEBUG(SSSDBG_TRACE_FUNC, "Save user\n");
 
+    memset(entry, 0, sizeof(*entry));
+
     tmpctx = talloc_new(NULL);
     if (!tmpctx) {
         ret = ENOMEM;
@@ -616,23 +619,23 @@ int sdap_save_user(TALLOC_CTX *memctx,
         goto done;
     }
 
-    DEBUG(SSSDBG_TRACE_FUNC, "Storing info for user %s\n", user_name);
-
-    ret = sysdb_store_user(dom, user_name, pwd, uid, gid,
-                           gecos, homedir, shell, orig_dn,
-                           user_attrs, missing, cache_timeout, now);
-    if (ret) goto done;
-
-    if (mapped_attrs != NULL) {
-        ret = sysdb_set_user_attr(dom, user_name, mapped_attrs, SYSDB_MOD_ADD);
-        if (ret) return ret;
-    }
+    entry->domain = dom;
+    entry->name = user_name;
+    entry->pwd = pwd;
+    entry->uid = uid;
+    entry->gid = gid;
+    entry->gecos = gecos;
+    entry->homedir = homedir;
+    entry->shell = shell;
+    entry->orig_dn = orig_dn;
+    entry->attrs = talloc_steal(memctx, user_attrs);
+    entry->remove_attrs = missing;
+    entry->cache_timeout = cache_timeout;
 
     if (_usn_value) {
         *_usn_value = talloc_steal(memctx, usn_value);
     }
 
-    talloc_steal(memctx, user_attrs);
     ret = EOK;
 
 done:
@@ -645,6 +648,52 @@ done:
     return ret;
 }
 
+int sdap_save_user(TALLOC_CTX *memctx,
+                   struct sdap_options *opts,
+                   struct sss_domain_info *dom,
+                   struct sysdb_attrs *attrs,
+                   struct sysdb_attrs *mapped_attrs,
+                   char **_usn_value,
+                   time_t now)
+{
+    struct sysdb_store_user_entry entry;
+    char *usn_value = NULL;
+    int ret;
+
+    ret = sdap_save_user_prepare(memctx, opts, dom, attrs, &entry,
+                                 &usn_value);
+    if (ret != EOK || entry.name == NULL) {
+        return ret;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Storing info for user %s\n", entry.name);
+
+    ret = sysdb_store_user(entry.domain, entry.name, entry.pwd, entry.uid,
+                           entry.gid, entry.gecos, entry.homedir, entry.shell,
+                           entry.orig_dn, entry.attrs, entry.remove_attrs,
+                           entry.cache_timeout, now);
+    if (ret) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to save user [%s]\n", entry.name);
+        talloc_free(usn_value);
+        return ret;
+    }
+
+    if (mapped_attrs != NULL) {
+        ret = sysdb_set_user_attr(entry.domain, entry.name, mapped_attrs,
+                                  SYSDB_MOD_ADD);
+        if (ret) return ret;
+    }
+
+    if (_usn_value) {
+        *_usn_value = usn_value;
+    } else {
+        talloc_free(usn_value);
+    }
+
+    return EOK;
+}
+
 
 /* ==Generic-Function-to-save-multiple-users============================= */
 
@@ -658,11 +707,14 @@ int sdap_save_users(TALLOC_CTX *memctx,
                     char **_usn_value)
 {
     TALLOC_CTX *tmpctx;
+    struct sysdb_store_user_entry *entries;
+    char **usn_values;
+    size_t num_entries = 0;
     char *higher_usn = NULL;
     char *usn_value;
     int ret;
     errno_t sret;
-    int i;
+    size_t i;
     time_t now;
     bool in_transaction = false;
 
@@ -676,6 +728,8 @@ int sdap_save_users(TALLOC_CTX *memctx,
         return ENOMEM;
     }
 
+    SSS_PROF_PUSH("sdap_save_users");
+
     ret = sysdb_transaction_start(sysdb);
     if (ret) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Failed to start transaction\n");
@@ -691,29 +745,64 @@ int sdap_save_users(TALLOC_CTX *memctx,
         }
     }
 
-    now = time(NULL);
-    for (i = 0; i < num_users; i++) {
-        usn_value = NULL;
+    entries = talloc_zero_array(tmpctx, struct sysdb_store_user_entry,
+                                num_users);
+    usn_values = talloc_zero_array(tmpctx, char *, num_users);
+    if (entries == NULL || usn_values == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
 
-        ret = sdap_save_user(tmpctx, opts, dom, users[i], mapped_attrs,
-                             &usn_value, now);
+    for (i = 0; i < (size_t)num_users; i++) {
+        ret = sdap_save_user_prepare(tmpctx, opts, dom, users[i],
+                                     &entries[num_entries],
+                                     &usn_values[num_entries]);
 
         /* Do not fail completely on errors.
          * Just report the failure to save and go on */
         if (ret) {
-            DEBUG(SSSDBG_OP_FAILURE, "Failed to store user %d. Ignoring.\n", i);
-        } else {
-            DEBUG(SSSDBG_TRACE_ALL, "User %d processed!\n", i);
+            DEBUG(SSSDBG_OP_FAILURE, "Failed to store user %zu. Ignoring.\n", i);
+            continue;
+        }
+
+        if (entries[num_entries].name != NULL) {
+            num_entries++;
+        }
+    }
+
+    now = time(NULL);
+    ret = sysdb_store_users(sysdb, entries, num_entries, now);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to store users [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    for (i = 0; i < num_entries; i++) {
+        if (entries[i].ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Failed to store user [%s]. Ignoring.\n",
+                  entries[i].name);
+            continue;
+        }
+
+        if (mapped_attrs != NULL) {
+            ret = sysdb_set_user_attr(entries[i].domain, entries[i].name,
+                                      mapped_attrs, SYSDB_MOD_ADD);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_OP_FAILURE, "Failed to store mapped data of "
+                      "user [%s]. Ignoring.\n", entries[i].name);
+                continue;
+            }
         }
 
+        DEBUG(SSSDBG_TRACE_ALL, "User [%s] processed!\n", entries[i].name);
+
+        usn_value = usn_values[i];
         if (usn_value) {
             if (higher_usn) {
                 if ((strlen(usn_value) > strlen(higher_usn)) ||
                     (strcmp(usn_value, higher_usn) > 0)) {
-                    talloc_zfree(higher_usn);
                     higher_usn = usn_value;
-                } else {
-                    talloc_zfree(usn_value);
                 }
             } else {
                 higher_usn = usn_value;
@@ -740,6 +829,7 @@ done:
         }
     }
     talloc_zfree(tmpctx);
+    SSS_PROF_POP("sdap_save_users");
     return ret;
 }
 
@@ -987,7 +1077,13 @@ int sdap_search_user_recv(TALLOC_CTX *memctx, struct tevent_req *req,
 }
 
 /* ==Search-And-Save-Users-with-filter============================================= */
+/* Pause between the transactions of a chunked save. A timer that is already
+ * due is run before the file descriptors are polled, the pause lets the
+ * replies of other lookups in. */
+#define SDAP_SAVE_CHUNK_PAUSE_MSEC 1
+
 struct sdap_get_users_state {
+    struct tevent_context *ev;
     struct sysdb_ctx *sysdb;
     struct sdap_options *opts;
     struct sss_domain_info *dom;
@@ -997,9 +1093,17 @@ struct sdap_get_users_state {
     struct sysdb_attrs **users;
     struct sysdb_attrs *mapped_attrs;
     size_t count;
+
+    size_t chunk_size;
+    size_t saved;
 };
 
 static void sdap_get_users_done(struct tevent_req *subreq);
+static errno_t sdap_get_users_save_step(struct tevent_req *req);
+static void sdap_get_users_save_next(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval tv,
+                                     void *pvt);
 
 struct tevent_req *sdap_get_users_send(TALLOC_CTX *memctx,
                                        struct tevent_context *ev,
@@ -1022,6 +1126,7 @@ struct tevent_req *sdap_get_users_send(TALLOC_CTX *memctx,
     req = tevent_req_create(memctx, &state, struct sdap_get_users_state);
     if (!req) return NULL;
 
+    state->ev = ev;
     state->sysdb = sysdb;
     state->opts = opts;
     state->dom = dom;
@@ -1070,6 +1175,7 @@ static void sdap_get_users_done(struct tevent_req *subreq)
                                                       struct tevent_req);
     struct sdap_get_users_state *state = tevent_req_data(req,
                                             struct sdap_get_users_state);
+    int chunk_size;
     int ret;
 
     ret = sdap_search_user_recv(state, subreq, &state->higher_usn,
@@ -1083,23 +1189,116 @@ static void sdap_get_users_done(struct tevent_req *subreq)
         return;
     }
 
+    /* The mapped data is removed from all cached users before the first
+     * chunk is stored, so it has to be saved in one go. */
+    chunk_size = dp_opt_get_int(state->opts->basic, SDAP_SAVE_CHUNK_SIZE);
+    if (chunk_size <= 0 || state->mapped_attrs != NULL
+            || state->count <= (size_t)chunk_size) {
+        state->chunk_size = state->count;
+    } else {
+        state->chunk_size = chunk_size;
+    }
+
+    if (state->count > 0) {
+        /* The USN comes from the users that were stored */
+        talloc_zfree(state->higher_usn);
+    }
+    state->saved = 0;
+
     PROBE(SDAP_SEARCH_USER_SAVE_BEGIN, state->filter);
 
+    ret = sdap_get_users_save_step(req);
+    if (ret == EAGAIN) {
+        return;
+    } else if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+/* Stores the next chunk of the users in a transaction of its own and
+ * returns EAGAIN if the rest is stored after a pause. */
+static errno_t sdap_get_users_save_step(struct tevent_req *req)
+{
+    struct sdap_get_users_state *state = tevent_req_data(req,
+                                            struct sdap_get_users_state);
+    struct tevent_timer *te;
+    char *usn_value = NULL;
+    size_t num;
+    size_t i;
+    int ret;
+
+    num = MIN(state->chunk_size, state->count - state->saved);
+
     ret = sdap_save_users(state, state->sysdb,
                           state->dom, state->opts,
-                          state->users, state->count,
+                          state->users + state->saved, num,
                           state->mapped_attrs,
-                          &state->higher_usn);
-    PROBE(SDAP_SEARCH_USER_SAVE_END, state->filter);
+                          &usn_value);
     if (ret) {
+        PROBE(SDAP_SEARCH_USER_SAVE_END, state->filter);
         DEBUG(SSSDBG_OP_FAILURE, "Failed to store users [%d][%s].\n",
               ret, sss_strerror(ret));
-        tevent_req_error(req, ret);
-        return;
+        return ret;
+    }
+
+    if (usn_value != NULL) {
+        if (state->higher_usn == NULL
+                || strlen(usn_value) > strlen(state->higher_usn)
+                || strcmp(usn_value, state->higher_usn) > 0) {
+            talloc_free(state->higher_usn);
+            state->higher_usn = usn_value;
+        } else {
+            talloc_free(usn_value);
+        }
+    }
+
+    /* The stored users are not needed anymore */
+    for (i = state->saved; i < state->saved + num; i++) {
+        talloc_zfree(state->users[i]);
+    }
+    state->saved += num;
+
+    if (state->saved < state->count) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Saved %zu of %zu Users\n",
+              state->saved, state->count);
+
+        te = tevent_add_timer(state->ev, state,
+                              tevent_timeval_current_ofs(0,
+                                        SDAP_SAVE_CHUNK_PAUSE_MSEC * 1000),
+                              sdap_get_users_save_next, req);
+        if (te == NULL) {
+            PROBE(SDAP_SEARCH_USER_SAVE_END, state->filter);
+            return ENOMEM;
+        }
+
+        return EAGAIN;
     }
 
+    PROBE(SDAP_SEARCH_USER_SAVE_END, state->filter);
     DEBUG(SSSDBG_TRACE_ALL, "Saving %zu Users - Done\n", state->count);
 
+    return EOK;
+}
+
+static void sdap_get_users_save_next(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval tv,
+                                     void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    errno_t ret;
+
+    ret = sdap_get_users_save_step(req);
+    if (ret == EAGAIN) {
+        return;
+    } else if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
     tevent_req_done(req);
 }
 
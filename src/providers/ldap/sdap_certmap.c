@@ -22,11 +22,24 @@
 */
 
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
+#include "util/crypto/sss_crypto.h"
 #include "lib/certmap/sss_certmap.h"
 #include "providers/ldap/ldap_common.h"
 
+/* Evaluating the mapping rules means parsing the certificate and matching
+ * it against every rule. The same certificates of a few users are looked up
+ * again and again, so the result, a filter or no match, is kept per hash of
+ * the certificate until the rules change. */
+#define SDAP_CERTMAP_CACHE_MAX_ENTRIES 1024
+
 struct sdap_certmap_ctx {
     struct sss_certmap_ctx *certmap_ctx;
+    hash_table_t *filters;
+};
+
+struct sdap_certmap_filter {
+    char *filter;
 };
 
 struct priv_sss_debug {
@@ -108,6 +121,7 @@ done:
     if (ret == EOK) {
         sss_certmap_free_ctx(sdap_certmap_ctx->certmap_ctx);
         sdap_certmap_ctx->certmap_ctx = sss_certmap_ctx;
+        talloc_zfree(sdap_certmap_ctx->filters);
     } else {
         sss_certmap_free_ctx(sss_certmap_ctx);
     }
@@ -150,3 +164,113 @@ done:
 
     return ret;
 }
+
+static char *sdap_certmap_filter_key(TALLOC_CTX *mem_ctx,
+                                     const char *derb64,
+                                     const char *attr_name,
+                                     struct sss_domain_info *dom)
+{
+    unsigned char *der;
+    size_t der_size;
+    char *hash;
+    char *key;
+    errno_t ret;
+
+    der = sss_base64_decode(mem_ctx, derb64, &der_size);
+    if (der == NULL) {
+        return NULL;
+    }
+
+    ret = sysdb_cert_hash(mem_ctx, der, der_size, &hash);
+    talloc_free(der);
+    if (ret != EOK) {
+        return NULL;
+    }
+
+    key = talloc_asprintf(mem_ctx, "%s:%s:%s", hash, dom->name, attr_name);
+    talloc_free(hash);
+
+    return key;
+}
+
+errno_t sdap_cert_derb64_to_ldap_filter(TALLOC_CTX *mem_ctx,
+                                        struct sdap_certmap_ctx *ctx,
+                                        const char *derb64,
+                                        const char *attr_name,
+                                        struct sss_domain_info *dom,
+                                        char **_filter)
+{
+    struct sdap_certmap_filter *entry;
+    char *filter = NULL;
+    char *key = NULL;
+    errno_t ret;
+
+    if (ctx == NULL || ctx->certmap_ctx == NULL
+            || derb64 == NULL || attr_name == NULL) {
+        /* without rules the filter is just the certificate */
+        return sss_cert_derb64_to_ldap_filter(mem_ctx, derb64, attr_name,
+                                              sdap_get_sss_certmap(ctx),
+                                              dom, _filter);
+    }
+
+    key = sdap_certmap_filter_key(mem_ctx, derb64, attr_name, dom);
+    if (key != NULL && ctx->filters != NULL) {
+        entry = sss_ptr_hash_lookup(ctx->filters, key,
+                                    struct sdap_certmap_filter);
+        if (entry != NULL) {
+            talloc_free(key);
+            if (entry->filter == NULL) {
+                DEBUG(SSSDBG_TRACE_FUNC,
+                      "Certificate is known not to match any rule.\n");
+                return ENOENT;
+            }
+
+            *_filter = talloc_strdup(mem_ctx, entry->filter);
+            return *_filter == NULL ? ENOMEM : EOK;
+        }
+    }
+
+    ret = sss_cert_derb64_to_ldap_filter(mem_ctx, derb64, attr_name,
+                                         ctx->certmap_ctx, dom, &filter);
+    if ((ret != EOK && ret != ENOENT) || key == NULL) {
+        goto done;
+    }
+
+    if (ctx->filters == NULL) {
+        ctx->filters = sss_ptr_hash_create(ctx, NULL, NULL);
+        if (ctx->filters == NULL) {
+            goto done;
+        }
+    }
+
+    if (hash_count(ctx->filters) >= SDAP_CERTMAP_CACHE_MAX_ENTRIES) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Certificate filter cache is full.\n");
+        goto done;
+    }
+
+    entry = talloc_zero(ctx->filters, struct sdap_certmap_filter);
+    if (entry == NULL) {
+        goto done;
+    }
+
+    if (ret == EOK) {
+        entry->filter = talloc_strdup(entry, filter);
+        if (entry->filter == NULL) {
+            talloc_free(entry);
+            goto done;
+        }
+    }
+
+    if (sss_ptr_hash_add(ctx->filters, key, entry,
+                         struct sdap_certmap_filter) != EOK) {
+        talloc_free(entry);
+    }
+
+done:
+    talloc_free(key);
+    if (ret == EOK) {
+        *_filter = filter;
+    }
+
+    return ret;
+}
@@ -26,14 +26,31 @@
 #include "providers/ldap/sdap_async.h"
 #include "providers/ldap/sdap_id_op.h"
 
-/* LDAP async connection cache */
+/* LDAP async connection cache
+ *
+ * New operations are given the cached connection with the fewest
+ * operations in flight. When all cached connections are busy and there
+ * are fewer than ldap_connection_pool_size of them, another connection
+ * is opened, so one slow search does not stall the other lookups. The
+ * server tuning may lower the limit while the server is slow.
+ *
+ * Shortly before a connection expires a replacement is opened in the
+ * background. New operations keep using the old connection until the
+ * replacement is bound, then they are switched to it and the old one is
+ * released once its operations finish, so no lookup waits for the
+ * reconnect. */
 struct sdap_id_conn_cache {
     struct sdap_id_conn_ctx *id_conn;
 
     /* list of all open connections */
     struct sdap_id_conn_data *connections;
-    /* cached (current) connection */
-    struct sdap_id_conn_data *cached_connection;
+    /* number of cached connections, the rest is only finishing
+     * the operations that already run on them */
+    int num_cached;
+
+    /* operations that waited for a connection to be established */
+    uint64_t num_waits;
+    uint64_t wait_usecs;
 };
 
 /* LDAP async operation tracker:
@@ -48,6 +65,8 @@ struct sdap_id_op {
     struct sdap_id_conn_data *conn_data;
     /* number of reconnects for this operation */
     int reconnect_retry_count;
+    /* operation of a background data provider request */
+    bool background;
     /* connection request
      * It is required as we need to know which requests to notify
      * when shared connection request to sdap_handle completes.
@@ -68,20 +87,34 @@ struct sdap_id_conn_data {
     struct tevent_req *connect_req;
     /* timer for connection expiration */
     struct tevent_timer *expire_timer;
+    /* timer which opens the replacement of the connection */
+    struct tevent_timer *rotate_timer;
     /* number of running connection notifies */
     int notify_lock;
     /* list of operations using connect */
     struct sdap_id_op *ops;
+    /* number of operations in the ops list */
+    int num_ops;
+    /* the connection is in the pool of connections given to
+     * new operations */
+    bool cached;
     /* A flag which is signalizing that this
      * connection will be disconnected and should
      * not be used any more */
     bool disconnecting;
+    /* the connection replaces the expiring ones, it is not given to
+     * operations before it is connected */
+    bool replacement;
+    /* a replacement of this expiring connection is being opened */
+    bool rotating;
 };
 
 static void sdap_id_conn_cache_be_offline_cb(void *pvt);
 static void sdap_id_conn_cache_fo_reconnect_cb(void *pvt);
 
 static void sdap_id_release_conn_data(struct sdap_id_conn_data *conn_data);
+static void sdap_id_uncache_conn_data(struct sdap_id_conn_data *conn_data);
+static void sdap_id_conn_cache_release_all(struct sdap_id_conn_cache *conn_cache);
 static int sdap_id_conn_data_destroy(struct sdap_id_conn_data *conn_data);
 static bool sdap_is_connection_expired(struct sdap_id_conn_data *conn_data, int timeout);
 static bool sdap_can_reuse_connection(struct sdap_id_conn_data *conn_data);
@@ -89,7 +122,13 @@ static void sdap_id_conn_data_expire_handler(struct tevent_context *ev,
                                              struct tevent_timer *te,
                                              struct timeval current_time,
                                              void *pvt);
+static void sdap_id_conn_data_rotate_handler(struct tevent_context *ev,
+                                             struct tevent_timer *te,
+                                             struct timeval current_time,
+                                             void *pvt);
 static int sdap_id_conn_data_set_expire_timer(struct sdap_id_conn_data *conn_data);
+static struct sdap_id_conn_data *
+sdap_id_conn_data_connect(struct sdap_id_conn_cache *conn_cache);
 
 static void sdap_id_op_hook_conn_data(struct sdap_id_op *op, struct sdap_id_conn_data *conn_data);
 static int sdap_id_op_destroy(void *pvt);
@@ -144,24 +183,46 @@ fail:
 static void sdap_id_conn_cache_be_offline_cb(void *pvt)
 {
     struct sdap_id_conn_cache *conn_cache = talloc_get_type(pvt, struct sdap_id_conn_cache);
-    struct sdap_id_conn_data *cached_connection = conn_cache->cached_connection;
 
     /* Release any cached connection on going offline */
-    if (cached_connection != NULL) {
-        conn_cache->cached_connection = NULL;
-        sdap_id_release_conn_data(cached_connection);
-    }
+    sdap_id_conn_cache_release_all(conn_cache);
 }
 
 /* Callback for attempt to reconnect to primary server */
 static void sdap_id_conn_cache_fo_reconnect_cb(void *pvt)
 {
     struct sdap_id_conn_cache *conn_cache = talloc_get_type(pvt, struct sdap_id_conn_cache);
-    struct sdap_id_conn_data *cached_connection = conn_cache->cached_connection;
+    struct sdap_id_conn_data *conn_data;
 
     /* Release any cached connection on going offline */
-    if (cached_connection != NULL) {
-        cached_connection->disconnecting = true;
+    DLIST_FOR_EACH(conn_data, conn_cache->connections) {
+        if (conn_data->cached) {
+            conn_data->disconnecting = true;
+        }
+    }
+}
+
+/* Stop giving the connection to new operations */
+static void sdap_id_uncache_conn_data(struct sdap_id_conn_data *conn_data)
+{
+    if (conn_data->cached) {
+        conn_data->cached = false;
+        conn_data->conn_cache->num_cached--;
+    }
+}
+
+/* Drop all cached connections and release those that are not in use */
+static void sdap_id_conn_cache_release_all(struct sdap_id_conn_cache *conn_cache)
+{
+    struct sdap_id_conn_data *conn_data;
+    struct sdap_id_conn_data *next;
+
+    for (conn_data = conn_cache->connections; conn_data; conn_data = next) {
+        next = conn_data->next;
+        if (conn_data->cached) {
+            sdap_id_uncache_conn_data(conn_data);
+            sdap_id_release_conn_data(conn_data);
+        }
     }
 }
 
@@ -175,7 +236,7 @@ static void sdap_id_release_conn_data(struct sdap_id_conn_data *conn_data)
     }
 
     conn_cache = conn_data->conn_cache;
-    if (conn_data == conn_cache->cached_connection) {
+    if (conn_data->cached) {
         return;
     }
 
@@ -195,6 +256,9 @@ static int sdap_id_conn_data_destroy(struct sdap_id_conn_data *conn_data)
         op->conn_data = NULL;
         DLIST_REMOVE(conn_data->ops, op);
     }
+    conn_data->num_ops = 0;
+
+    sdap_id_uncache_conn_data(conn_data);
 
     return 0;
 }
@@ -264,9 +328,83 @@ static int sdap_id_conn_data_set_expire_timer(struct sdap_id_conn_data *conn_dat
         return ENOMEM;
     }
 
+    /* The replacement has the time of a connect and a bind to be ready
+     * before the connection expires */
+    tv.tv_sec -= dp_opt_get_int(conn_data->conn_cache->id_conn->id_ctx->opts->basic,
+                                SDAP_NETWORK_TIMEOUT);
+    if (timeout > 0) {
+        tv.tv_sec -= timeout;
+    }
+
+    if (tv.tv_sec <= time(NULL)) {
+        return EOK;
+    }
+
+    talloc_zfree(conn_data->rotate_timer);
+
+    conn_data->rotate_timer =
+              tevent_add_timer(conn_data->conn_cache->id_conn->id_ctx->be->ev,
+                               conn_data, tv,
+                               sdap_id_conn_data_rotate_handler,
+                               conn_data);
+    if (!conn_data->rotate_timer) {
+        return ENOMEM;
+    }
+
     return EOK;
 }
 
+/* Handler for the timer which opens the replacement of a connection */
+static void sdap_id_conn_data_rotate_handler(struct tevent_context *ev,
+                                             struct tevent_timer *te,
+                                             struct timeval current_time,
+                                             void *pvt)
+{
+    struct sdap_id_conn_data *conn_data = talloc_get_type(pvt,
+                                                          struct sdap_id_conn_data);
+    struct sdap_id_conn_cache *conn_cache = conn_data->conn_cache;
+    struct sdap_id_conn_data *replacement;
+
+    conn_data->rotate_timer = NULL;
+
+    if (!conn_data->cached || conn_data->disconnecting || conn_data->rotating
+            || be_is_offline(conn_cache->id_conn->id_ctx->be)) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "connection is about to expire, opening its replacement\n");
+
+    replacement = sdap_id_conn_data_connect(conn_cache);
+    if (replacement == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to open the replacement of an expiring connection\n");
+        return;
+    }
+
+    replacement->replacement = true;
+    conn_data->rotating = true;
+}
+
+/* Switch new operations from the expiring connections to their
+ * replacement, the old ones are released when their operations finish */
+static void sdap_id_conn_cache_rotate(struct sdap_id_conn_cache *conn_cache)
+{
+    struct sdap_id_conn_data *conn_data;
+    struct sdap_id_conn_data *next;
+
+    for (conn_data = conn_cache->connections; conn_data; conn_data = next) {
+        next = conn_data->next;
+        if (conn_data->cached && conn_data->rotating) {
+            DEBUG(SSSDBG_TRACE_FUNC, "replacement of the expiring connection "
+                  "%p is ready, %d operations still use it\n",
+                  conn_data, conn_data->num_ops);
+            sdap_id_uncache_conn_data(conn_data);
+            sdap_id_release_conn_data(conn_data);
+        }
+    }
+}
+
 /* Handler for connection expiration timer */
 static void sdap_id_conn_data_expire_handler(struct tevent_context *ev,
                                               struct tevent_timer *te,
@@ -275,13 +413,12 @@ static void sdap_id_conn_data_expire_handler(struct tevent_context *ev,
 {
     struct sdap_id_conn_data *conn_data = talloc_get_type(pvt,
                                                           struct sdap_id_conn_data);
-    struct sdap_id_conn_cache *conn_cache = conn_data->conn_cache;
 
     DEBUG(SSSDBG_MINOR_FAILURE,
           "connection is about to expire, releasing it\n");
 
-    if (conn_cache->cached_connection == conn_data) {
-        conn_cache->cached_connection = NULL;
+    if (conn_data->cached) {
+        sdap_id_uncache_conn_data(conn_data);
 
         sdap_id_release_conn_data(conn_data);
     }
@@ -296,6 +433,7 @@ struct sdap_id_op *sdap_id_op_create(TALLOC_CTX *memctx, struct sdap_id_conn_cac
     }
 
     op->conn_cache = conn_cache;
+    op->background = dp_req_priority_of(memctx) != DP_PRIORITY_INTERACTIVE;
 
     talloc_set_destructor((void*)op, sdap_id_op_destroy);
     return op;
@@ -316,12 +454,14 @@ static void sdap_id_op_hook_conn_data(struct sdap_id_op *op, struct sdap_id_conn
 
     if (current) {
         DLIST_REMOVE(current->ops, op);
+        current->num_ops--;
     }
 
     op->conn_data = conn_data;
 
     if (conn_data) {
         DLIST_ADD_END(conn_data->ops, op, struct sdap_id_op*);
+        conn_data->num_ops++;
     }
 
     if (current) {
@@ -366,6 +506,7 @@ struct sdap_id_op_connect_state {
     struct sdap_id_conn_ctx *id_conn;
     struct tevent_context *ev;
     struct sdap_id_op *op;
+    struct timespec start;
     int dp_error;
     int result;
 };
@@ -418,6 +559,7 @@ struct tevent_req *sdap_id_op_connect_send(struct sdap_id_op *op,
     state->ev = state->id_conn->id_ctx->be->ev;
     state->op = op;
     op->connect_req = req;
+    clock_gettime(CLOCK_MONOTONIC, &state->start);
 
     if (op->conn_data) {
         /* If the operation is already connected,
@@ -448,78 +590,119 @@ done:
     return req;
 }
 
-/* Begin a connection retry to LDAP server */
-static int sdap_id_op_connect_step(struct tevent_req *req)
+/* Find the cached connection with the fewest operations in flight,
+ * releasing the cached connections that can not be reused anymore */
+static struct sdap_id_conn_data *
+sdap_id_conn_cache_least_loaded(struct sdap_id_conn_cache *conn_cache)
 {
-    struct sdap_id_op_connect_state *state =
-                    tevent_req_data(req, struct sdap_id_op_connect_state);
-    struct sdap_id_op *op = state->op;
-    struct sdap_id_conn_cache *conn_cache = op->conn_cache;
-
-    int ret = EOK;
     struct sdap_id_conn_data *conn_data;
-    struct tevent_req *subreq = NULL;
+    struct sdap_id_conn_data *next;
+    struct sdap_id_conn_data *best = NULL;
 
-    /* Try to reuse context cached connection */
-    conn_data = conn_cache->cached_connection;
-    if (conn_data) {
-        if (conn_data->connect_req) {
-            DEBUG(SSSDBG_TRACE_ALL, "waiting for connection to complete\n");
-            sdap_id_op_hook_conn_data(op, conn_data);
-            goto done;
+    for (conn_data = conn_cache->connections; conn_data; conn_data = next) {
+        next = conn_data->next;
+        if (!conn_data->cached || conn_data->replacement) {
+            continue;
         }
 
-        if (sdap_can_reuse_connection(conn_data)) {
-            DEBUG(SSSDBG_TRACE_ALL, "reusing cached connection\n");
-            sdap_id_op_hook_conn_data(op, conn_data);
-            goto done;
+        if (!conn_data->connect_req && !sdap_can_reuse_connection(conn_data)) {
+            DEBUG(SSSDBG_TRACE_ALL, "releasing expired cached connection\n");
+            sdap_id_uncache_conn_data(conn_data);
+            sdap_id_release_conn_data(conn_data);
+            continue;
         }
 
-        DEBUG(SSSDBG_TRACE_ALL, "releasing expired cached connection\n");
-        conn_cache->cached_connection = NULL;
-        sdap_id_release_conn_data(conn_data);
+        DEBUG(SSSDBG_TRACE_ALL, "cached connection %p has %d operations "
+              "in flight\n", conn_data, conn_data->num_ops);
+
+        if (best == NULL || conn_data->num_ops < best->num_ops) {
+            best = conn_data;
+        }
     }
 
-    DEBUG(SSSDBG_TRACE_ALL, "beginning to connect\n");
+    return best;
+}
+
+/* Start a new cached connection */
+static struct sdap_id_conn_data *
+sdap_id_conn_data_connect(struct sdap_id_conn_cache *conn_cache)
+{
+    struct sdap_id_ctx *id_ctx = conn_cache->id_conn->id_ctx;
+    struct sdap_id_conn_data *conn_data;
+    struct tevent_req *subreq;
 
     conn_data = talloc_zero(conn_cache, struct sdap_id_conn_data);
     if (!conn_data) {
-        ret = ENOMEM;
-        goto done;
+        return NULL;
     }
 
     talloc_set_destructor(conn_data, sdap_id_conn_data_destroy);
 
     conn_data->conn_cache = conn_cache;
-    subreq = sdap_cli_connect_send(conn_data, state->ev,
-                                   state->id_conn->id_ctx->opts,
-                                   state->id_conn->id_ctx->be,
-                                   state->id_conn->service, false,
+    subreq = sdap_cli_connect_send(conn_data, id_ctx->be->ev,
+                                   id_ctx->opts, id_ctx->be,
+                                   conn_cache->id_conn->service, false,
                                    CON_TLS_DFL, false);
-
     if (!subreq) {
-        ret = ENOMEM;
-        goto done;
+        talloc_free(conn_data);
+        return NULL;
     }
 
     tevent_req_set_callback(subreq, sdap_id_op_connect_done, conn_data);
     conn_data->connect_req = subreq;
 
     DLIST_ADD(conn_cache->connections, conn_data);
-    conn_cache->cached_connection = conn_data;
+    conn_data->cached = true;
+    conn_cache->num_cached++;
 
-    sdap_id_op_hook_conn_data(op, conn_data);
+    return conn_data;
+}
 
-done:
-    if (ret != EOK && conn_data) {
-        sdap_id_release_conn_data(conn_data);
+/* Begin a connection retry to LDAP server */
+static int sdap_id_op_connect_step(struct tevent_req *req)
+{
+    struct sdap_id_op_connect_state *state =
+                    tevent_req_data(req, struct sdap_id_op_connect_state);
+    struct sdap_id_op *op = state->op;
+    struct sdap_id_conn_cache *conn_cache = op->conn_cache;
+
+    int pool_size;
+    struct sdap_id_conn_data *conn_data;
+
+    pool_size = sdap_service_pool_size(conn_cache->id_conn->service,
+                                       conn_cache->id_conn->id_ctx->opts);
+
+    /* Try to reuse context cached connection, another one is only opened
+     * when all of them are busy. Background operations never open another
+     * one so the spare connections are left to interactive requests. */
+    conn_data = sdap_id_conn_cache_least_loaded(conn_cache);
+    if (conn_data != NULL
+            && (conn_data->num_ops == 0 || op->background
+                || conn_cache->num_cached >= pool_size)) {
+        if (conn_data->connect_req) {
+            DEBUG(SSSDBG_TRACE_ALL, "waiting for connection to complete\n");
+        } else {
+            DEBUG(SSSDBG_TRACE_ALL, "reusing cached connection\n");
+        }
+        sdap_id_op_hook_conn_data(op, conn_data);
+        return EOK;
     }
 
-    if (ret != EOK) {
-        talloc_zfree(subreq);
+    if (conn_data != NULL) {
+        DEBUG(SSSDBG_TRACE_FUNC, "All %d cached connections are busy, "
+              "opening another one\n", conn_cache->num_cached);
     }
 
-    return ret;
+    DEBUG(SSSDBG_TRACE_ALL, "beginning to connect\n");
+
+    conn_data = sdap_id_conn_data_connect(conn_cache);
+    if (!conn_data) {
+        return ENOMEM;
+    }
+
+    sdap_id_op_hook_conn_data(op, conn_data);
+
+    return EOK;
 }
 
 static void sdap_id_op_connect_reinit_done(struct tevent_req *req);
@@ -535,6 +718,8 @@ static void sdap_id_op_connect_done(struct tevent_req *subreq)
     bool can_retry = false;
     bool is_offline = false;
     struct tevent_req *reinit_req = NULL;
+    struct sdap_id_conn_data *other;
+    bool was_online = false;
     bool reinit = false;
     int ret;
 
@@ -543,6 +728,17 @@ static void sdap_id_op_connect_done(struct tevent_req *subreq)
     conn_data->connect_req = NULL;
     talloc_zfree(subreq);
 
+    if (conn_data->replacement && ret != EOK) {
+        /* No operation waits for it, the expiring connection is kept until
+         * it expires and the backend is not marked offline because of it */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to open the replacement of an expiring connection "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        sdap_id_uncache_conn_data(conn_data);
+        sdap_id_release_conn_data(conn_data);
+        return;
+    }
+
     conn_data->notify_lock++;
 
     if (ret == ENOTSUP) {
@@ -658,9 +854,7 @@ static void sdap_id_op_connect_done(struct tevent_req *subreq)
             bool retry = false;
 
             /* drop connection from cache now */
-            if (conn_cache->cached_connection == conn_data) {
-                conn_cache->cached_connection = NULL;
-            }
+            sdap_id_uncache_conn_data(conn_data);
 
             if (can_retry) {
                 /* determining whether retry is possible */
@@ -723,17 +917,43 @@ static void sdap_id_op_connect_done(struct tevent_req *subreq)
         !be_is_offline(conn_cache->id_conn->id_ctx->be)) {
         DEBUG(SSSDBG_TRACE_ALL,
               "caching successful connection after %d notifies\n", notify_count);
-        conn_cache->cached_connection = conn_data;
+        if (!conn_data->cached) {
+            conn_data->cached = true;
+            conn_cache->num_cached++;
+        }
 
-        /* Run any post-connection routines */
-        be_run_unconditional_online_cb(conn_cache->id_conn->id_ctx->be);
-        be_run_online_cb(conn_cache->id_conn->id_ctx->be);
+        if (conn_data->replacement) {
+            conn_data->replacement = false;
+            sdap_id_conn_cache_rotate(conn_cache);
+        }
 
-    } else {
-        if (conn_cache->cached_connection == conn_data) {
-            conn_cache->cached_connection = NULL;
+        /* The post-connection routines already ran for the first
+         * connection of the pool */
+        DLIST_FOR_EACH(other, conn_cache->connections) {
+            if (other != conn_data && other->cached && !other->connect_req
+                    && other->sh != NULL && other->sh->connected) {
+                was_online = true;
+                break;
+            }
+        }
+
+        if (conn_cache->num_cached > 1) {
+            DEBUG(SSSDBG_TRACE_FUNC, "%d cached connections, waited for "
+                  "a connection %"PRIu64" times, %"PRIu64" us on average\n",
+                  conn_cache->num_cached, conn_cache->num_waits,
+                  conn_cache->num_waits == 0 ? 0 :
+                      conn_cache->wait_usecs / conn_cache->num_waits);
         }
 
+        if (!was_online) {
+            /* Run any post-connection routines */
+            be_run_unconditional_online_cb(conn_cache->id_conn->id_ctx->be);
+            be_run_online_cb(conn_cache->id_conn->id_ctx->be);
+        }
+
+    } else {
+        sdap_id_uncache_conn_data(conn_data);
+
         sdap_id_release_conn_data(conn_data);
     }
 
@@ -775,6 +995,9 @@ static void sdap_id_op_connect_req_complete(struct sdap_id_op *op, int dp_error,
 {
     struct tevent_req *req = op->connect_req;
     struct sdap_id_op_connect_state *state;
+    struct sdap_id_conn_cache *conn_cache = op->conn_cache;
+    struct timespec now;
+    uint64_t usecs;
 
     if (!req) {
         return;
@@ -786,6 +1009,14 @@ static void sdap_id_op_connect_req_complete(struct sdap_id_op *op, int dp_error,
     state->dp_error = dp_error;
     state->result = ret;
 
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    usecs = (now.tv_sec - state->start.tv_sec) * 1000000
+            + (now.tv_nsec - state->start.tv_nsec) / 1000;
+    conn_cache->num_waits++;
+    conn_cache->wait_usecs += usecs;
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "operation waited %"PRIu64" us for a connection\n", usecs);
+
     if (ret == EOK) {
         tevent_req_done(req);
     } else {
@@ -822,6 +1053,7 @@ int sdap_id_op_done(struct sdap_id_op *op, int retval, int *dp_err_out)
 {
     bool communication_error;
     struct sdap_id_conn_data *current_conn = op->conn_data;
+    struct sdap_id_conn_data *other;
     switch (retval) {
         case EIO:
         case ETIMEDOUT:
@@ -834,10 +1066,15 @@ int sdap_id_op_done(struct sdap_id_op *op, int retval, int *dp_err_out)
             break;
     }
 
-    if (communication_error && current_conn != 0
-            && current_conn == op->conn_cache->cached_connection) {
-        /* do not reuse failed connection */
-        op->conn_cache->cached_connection = NULL;
+    if (communication_error && current_conn != 0 && current_conn->cached) {
+        /* do not reuse failed connection, nor the other connections
+         * to the same server */
+        sdap_id_uncache_conn_data(current_conn);
+        DLIST_FOR_EACH(other, op->conn_cache->connections) {
+            if (other->cached) {
+                other->disconnecting = true;
+            }
+        }
 
         DEBUG(SSSDBG_FUNC_DATA,
               "communication error on cached connection, moving to next server\n");
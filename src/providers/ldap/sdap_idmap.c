@@ -21,10 +21,27 @@
 */
 
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
 #include "util/dlinklist.h"
 #include "providers/ldap/sdap_idmap.h"
 #include "util/util_sss_idmap.h"
 
+/* Seconds before a domain whose ranges could not be found is looked for
+ * again. The IPA provider reads all ranges from the cache each time, the
+ * other providers compute a new slice. */
+#define SDAP_IDMAP_UNKNOWN_DOMAIN_RETRY 60
+
+struct sdap_idmap_unknown_domain {
+    time_t retry_after;
+};
+
+static errno_t
+sdap_idmap_add_domain_ex(struct sdap_idmap_ctx *idmap_ctx,
+                         const char *dom_name,
+                         const char *dom_sid,
+                         id_t slice,
+                         bool store);
+
 static errno_t
 sdap_idmap_get_configured_external_range(struct sdap_idmap_ctx *idmap_ctx,
                                          struct sss_idmap_range *range)
@@ -125,6 +142,61 @@ errno_t sdap_idmap_find_new_domain(struct sdap_idmap_ctx *idmap_ctx,
     return EOK;
 }
 
+/* Lookups of many objects of a domain that cannot be added to the map would
+ * each try to add it again, so a failure is remembered for a while. */
+static errno_t sdap_idmap_add_new_domain(struct sdap_idmap_ctx *idmap_ctx,
+                                         const char *dom_name,
+                                         const char *dom_sid_str)
+{
+    struct sdap_idmap_unknown_domain *unknown;
+    time_t now;
+    errno_t ret;
+
+    now = time(NULL);
+
+    if (idmap_ctx->unknown_domains == NULL) {
+        idmap_ctx->unknown_domains = sss_ptr_hash_create(idmap_ctx,
+                                                         NULL, NULL);
+        if (idmap_ctx->unknown_domains == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    unknown = sss_ptr_hash_lookup(idmap_ctx->unknown_domains, dom_sid_str,
+                                  struct sdap_idmap_unknown_domain);
+    if (unknown != NULL && unknown->retry_after > now) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Domain [%s] was not found recently, not trying again\n",
+              dom_sid_str);
+        return ENOENT;
+    }
+
+    ret = idmap_ctx->find_new_domain(idmap_ctx, dom_name, dom_sid_str);
+    if (ret == EOK || ret == ENOMEM) {
+        if (unknown != NULL) {
+            sss_ptr_hash_delete(idmap_ctx->unknown_domains, dom_sid_str, true);
+        }
+        return ret;
+    }
+
+    if (unknown == NULL) {
+        unknown = talloc_zero(idmap_ctx->unknown_domains,
+                              struct sdap_idmap_unknown_domain);
+        if (unknown == NULL) {
+            return ret;
+        }
+
+        if (sss_ptr_hash_add(idmap_ctx->unknown_domains, dom_sid_str,
+                             unknown, struct sdap_idmap_unknown_domain) != EOK) {
+            talloc_free(unknown);
+            return ret;
+        }
+    }
+    unknown->retry_after = now + SDAP_IDMAP_UNKNOWN_DOMAIN_RETRY;
+
+    return ret;
+}
+
 errno_t
 sdap_idmap_init(TALLOC_CTX *mem_ctx,
                 struct sdap_id_ctx *id_ctx,
@@ -267,8 +339,9 @@ sdap_idmap_init(TALLOC_CTX *mem_ctx,
                 goto done;
             }
 
-            ret = sdap_idmap_add_domain(idmap_ctx, dom_name,
-                                        sid_str, slice_num);
+            /* already in the cache, not stored again */
+            ret = sdap_idmap_add_domain_ex(idmap_ctx, dom_name,
+                                           sid_str, slice_num, false);
             if (ret != EOK) {
                 DEBUG(SSSDBG_CRIT_FAILURE,
                       "Could not add domain [%s][%s][%"SPRIid"] "
@@ -335,6 +408,16 @@ sdap_idmap_add_domain(struct sdap_idmap_ctx *idmap_ctx,
                       const char *dom_name,
                       const char *dom_sid,
                       id_t slice)
+{
+    return sdap_idmap_add_domain_ex(idmap_ctx, dom_name, dom_sid, slice, true);
+}
+
+static errno_t
+sdap_idmap_add_domain_ex(struct sdap_idmap_ctx *idmap_ctx,
+                         const char *dom_name,
+                         const char *dom_sid,
+                         id_t slice,
+                         bool store)
 {
     errno_t ret;
     struct sss_idmap_range range;
@@ -394,7 +477,7 @@ sdap_idmap_add_domain(struct sdap_idmap_ctx *idmap_ctx,
 
     /* If algorithmic mapping is used add this domain to the SYSDB cache so it
      * will survive reboot */
-    if (!external_mapping) {
+    if (!external_mapping && store) {
         ret = sysdb_idmap_store_mapping(idmap_ctx->id_ctx->be->domain,
                                         dom_name, dom_sid,
                                         slice);
@@ -482,7 +565,7 @@ sdap_idmap_sid_to_unix(struct sdap_idmap_ctx *idmap_ctx,
             goto done;
         }
 
-        ret = idmap_ctx->find_new_domain(idmap_ctx, dom_sid_str, dom_sid_str);
+        ret = sdap_idmap_add_new_domain(idmap_ctx, dom_sid_str, dom_sid_str);
         if (ret != EOK) {
             DEBUG(SSSDBG_MINOR_FAILURE,
                   "Could not add new domain for sid [%s]\n", sid_str);
@@ -600,7 +683,7 @@ bool sdap_idmap_domain_has_algorithmic_mapping(struct sdap_idmap_ctx *ctx,
         }
     }
 
-    ret = ctx->find_new_domain(ctx, dom_name, new_dom_sid);
+    ret = sdap_idmap_add_new_domain(ctx, dom_name, new_dom_sid);
     talloc_free(tmp_ctx);
     if (ret != EOK) {
         DEBUG(SSSDBG_MINOR_FAILURE,
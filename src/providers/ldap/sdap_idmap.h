@@ -34,6 +34,9 @@ struct sdap_idmap_ctx {
 
     struct sdap_id_ctx *id_ctx;
     find_new_domain_fn_t *find_new_domain;
+
+    /* Domain SIDs find_new_domain failed for recently */
+    hash_table_t *unknown_domains;
 };
 
 errno_t sdap_idmap_init(TALLOC_CTX *mem_ctx,
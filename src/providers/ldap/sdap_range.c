@@ -140,3 +140,49 @@ done:
     talloc_free(tmp_ctx);
     return ret;
 }
+
+errno_t sdap_parse_range_bounds(const char *attr_desc,
+                                const char *base_attr,
+                                uint32_t *_start,
+                                uint32_t *_end,
+                                bool *_last)
+{
+    size_t baselen = strlen(base_attr);
+    size_t rangestringlen = sizeof(SDAP_RANGE_STRING) - 1;
+    const char *p;
+    char *endptr;
+    uint32_t start;
+    uint32_t end = 0;
+    bool last = false;
+
+    if (strncasecmp(attr_desc, base_attr, baselen) != 0
+            || attr_desc[baselen] != ';'
+            || strncasecmp(attr_desc + baselen + 1, SDAP_RANGE_STRING,
+                           rangestringlen) != 0) {
+        return ENOENT;
+    }
+    p = attr_desc + baselen + 1 + rangestringlen;
+
+    start = strtouint32(p, &endptr, 10);
+    if (errno != 0 || endptr == p || *endptr != '-') {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Malformed range in [%s]\n", attr_desc);
+        return EINVAL;
+    }
+    p = endptr + 1;
+
+    if (strcmp(p, "*") == 0) {
+        last = true;
+    } else {
+        end = strtouint32(p, &endptr, 10);
+        if (errno != 0 || endptr == p || *endptr != '\0' || end < start) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Malformed range in [%s]\n", attr_desc);
+            return EINVAL;
+        }
+    }
+
+    *_start = start;
+    *_end = end;
+    *_last = last;
+    return EOK;
+}
@@ -25,10 +25,40 @@
 
 #include "src/util/util.h"
 
+struct sysdb_attrs;
+
+/* Number of ranges of an attribute that are requested at the same time */
+#define SDAP_RANGE_PARALLEL 4
+
+/* An attribute of a parsed entry of which the server returned only the
+ * first range of values. The remaining values are read from the entry
+ * with the DN dn and added to the sysdb attributes sys_names of attrs. */
+struct sdap_range_pending {
+    struct sysdb_attrs *attrs;
+    const char *dn;
+    const char *base_attr;
+    const char **sys_names;
+
+    /* the first value that was not returned yet */
+    uint32_t offset;
+    /* the number of values the server returned in the first range */
+    uint32_t step;
+};
+
 errno_t sdap_parse_range(TALLOC_CTX *mem_ctx,
                          const char *attr_desc,
                          char **base_attr,
                          uint32_t *range_offset,
                          bool disable_range_retrieval);
 
+/* Reads the bounds of the attribute description attr_desc of the form
+ * "<base_attr>;range=<start>-<end>". If the end is "*", _last is set and
+ * _end is undefined. Returns ENOENT if attr_desc is not a range of
+ * base_attr. */
+errno_t sdap_parse_range_bounds(const char *attr_desc,
+                                const char *base_attr,
+                                uint32_t *_start,
+                                uint32_t *_end,
+                                bool *_last);
+
 #endif /* SDAP_RANGE_H_ */
@@ -94,7 +94,8 @@ sdap_sudo_ptask_setup_generic(struct be_ctx *be_ctx,
                               full_send_fn, full_recv_fn, pvt,
                               "SUDO Full Refresh",
                               BE_PTASK_OFFLINE_DISABLE |
-                              BE_PTASK_SCHEDULE_FROM_LAST,
+                              BE_PTASK_SCHEDULE_FROM_LAST |
+                              BE_PTASK_BULK,
                               NULL);
         if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Unable to setup full refresh ptask "
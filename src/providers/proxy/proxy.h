@@ -48,10 +48,15 @@ struct authtok_conv {
     bool sent_old;
 };
 
+struct proxy_worker_pool;
+
 struct proxy_id_ctx {
     struct be_ctx *be;
     bool fast_alias;
     struct sss_nss_ops ops;
+
+    /* NULL if the NSS calls are made by sssd_be itself */
+    struct proxy_worker_pool *worker_pool;
 };
 
 struct proxy_auth_ctx {
@@ -116,6 +121,59 @@ errno_t proxy_account_info_handler_recv(TALLOC_CTX *mem_ctx,
                                        struct tevent_req *req,
                                        struct dp_reply_std *data);
 
+/* From proxy_worker.c */
+errno_t proxy_worker_pool_init(TALLOC_CTX *mem_ctx,
+                               struct tevent_context *ev,
+                               struct sss_nss_ops *ops,
+                               int max_workers,
+                               struct proxy_worker_pool **_pool);
+
+struct tevent_req *proxy_worker_getpwnam_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              const char *name);
+
+struct tevent_req *proxy_worker_getpwuid_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              uid_t uid);
+
+/* The entry is only filled in if the status is NSS_STATUS_SUCCESS. */
+errno_t proxy_worker_getpw_recv(TALLOC_CTX *mem_ctx,
+                                struct tevent_req *req,
+                                enum nss_status *_status,
+                                struct passwd **_pwd);
+
+struct tevent_req *proxy_worker_getgrnam_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              const char *name);
+
+struct tevent_req *proxy_worker_getgrgid_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              gid_t gid);
+
+errno_t proxy_worker_getgr_recv(TALLOC_CTX *mem_ctx,
+                                struct tevent_req *req,
+                                enum nss_status *_status,
+                                struct group **_grp);
+
+/* The primary group gid is always the first of the returned groups. */
+struct tevent_req *
+proxy_worker_initgroups_send(TALLOC_CTX *mem_ctx,
+                             struct tevent_context *ev,
+                             struct proxy_worker_pool *pool,
+                             const char *name,
+                             gid_t gid);
+
+errno_t proxy_worker_initgroups_recv(TALLOC_CTX *mem_ctx,
+                                     struct tevent_req *req,
+                                     enum nss_status *_status,
+                                     int *_err,
+                                     size_t *_num_gids,
+                                     gid_t **_gids);
+
 /* From proxy_auth.c */
 struct tevent_req *
 proxy_pam_handler_send(TALLOC_CTX *mem_ctx,
@@ -43,6 +43,11 @@ static int
 delete_user(struct sss_domain_info *domain,
             const char *name, uid_t uid);
 
+static const char *cached_user_name(TALLOC_CTX *mem_ctx,
+                                    struct proxy_id_ctx *ctx,
+                                    struct sss_domain_info *dom,
+                                    uid_t uid);
+
 static int get_pw_name(struct proxy_id_ctx *ctx,
                        struct sss_domain_info *dom,
                        const char *i_name)
@@ -55,7 +60,6 @@ static int get_pw_name(struct proxy_id_ctx *ctx,
     int ret;
     uid_t uid;
     bool del_user;
-    struct ldb_result *cached_pwd = NULL;
     const char *real_name = NULL;
     char *shortname_or_alias;
 
@@ -103,22 +107,7 @@ static int get_pw_name(struct proxy_id_ctx *ctx,
 
     /* Canonicalize the username in case it was actually an alias */
 
-    if (ctx->fast_alias == true) {
-        ret = sysdb_getpwuid(tmpctx, dom, uid, &cached_pwd);
-        if (ret != EOK) {
-            /* Non-fatal, attempt to canonicalize online */
-            DEBUG(SSSDBG_TRACE_FUNC, "Request to cache failed [%d]: %s\n",
-                  ret, strerror(ret));
-        }
-
-        if (ret == EOK && cached_pwd->count == 1) {
-            real_name = ldb_msg_find_attr_as_string(cached_pwd->msgs[0],
-                                                    SYSDB_NAME, NULL);
-            if (!real_name) {
-                DEBUG(SSSDBG_MINOR_FAILURE, "Cached user has no name?\n");
-            }
-        }
-    }
+    real_name = cached_user_name(tmpctx, ctx, dom, uid);
 
     if (real_name == NULL) {
         memset(buffer, 0, buflen);
@@ -343,8 +332,63 @@ done:
     return ret;
 }
 
+/* Returns the canonical name of the user from the cache if proxy_fast_alias
+ * is set, NULL if it has to be looked up online. */
+static const char *cached_user_name(TALLOC_CTX *mem_ctx,
+                                    struct proxy_id_ctx *ctx,
+                                    struct sss_domain_info *dom,
+                                    uid_t uid)
+{
+    struct ldb_result *cached_pwd = NULL;
+    const char *real_name = NULL;
+    errno_t ret;
+
+    if (ctx->fast_alias == false) {
+        return NULL;
+    }
+
+    ret = sysdb_getpwuid(mem_ctx, dom, uid, &cached_pwd);
+    if (ret != EOK) {
+        /* Non-fatal, attempt to canonicalize online */
+        DEBUG(SSSDBG_TRACE_FUNC, "Request to cache failed [%d]: %s\n",
+              ret, strerror(ret));
+    }
+
+    if (ret == EOK && cached_pwd->count == 1) {
+        real_name = ldb_msg_find_attr_as_string(cached_pwd->msgs[0],
+                                                SYSDB_NAME, NULL);
+        if (!real_name) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Cached user has no name?\n");
+        }
+    }
+
+    return real_name;
+}
+
 /* =Getpwuid-wrapper======================================================*/
 
+static int store_pw_uid(struct sss_domain_info *dom, uid_t uid,
+                        struct passwd *pwd, bool del_user)
+{
+    char *name;
+    int ret;
+
+    if (del_user) {
+        return delete_user(dom, NULL, uid);
+    }
+
+    name = sss_create_internal_fqname(NULL, pwd->pw_name, dom->name);
+    if (name == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "failed to qualify name '%s'\n",
+              pwd->pw_name);
+        return ENOMEM;
+    }
+
+    ret = save_user(dom, pwd, name, NULL);
+    talloc_free(name);
+    return ret;
+}
+
 static int get_pw_uid(struct proxy_id_ctx *ctx,
                       struct sss_domain_info *dom,
                       uid_t uid)
@@ -356,7 +400,6 @@ static int get_pw_uid(struct proxy_id_ctx *ctx,
     size_t buflen;
     bool del_user = false;
     int ret;
-    char *name;
 
     DEBUG(SSSDBG_TRACE_FUNC, "Searching user by uid (%"SPRIuid")\n", uid);
 
@@ -386,18 +429,7 @@ static int get_pw_uid(struct proxy_id_ctx *ctx,
         goto done;
     }
 
-    if (del_user) {
-        ret = delete_user(dom, NULL, uid);
-        goto done;
-    }
-
-    name = sss_create_internal_fqname(tmpctx, pwd->pw_name, dom->name);
-    if (name == NULL) {
-        DEBUG(SSSDBG_OP_FAILURE, "failed to qualify name '%s'\n",
-              pwd->pw_name);
-        goto done;
-    }
-    ret = save_user(dom, pwd, name, NULL);
+    ret = store_pw_uid(dom, uid, pwd, del_user);
 
 done:
     talloc_zfree(tmpctx);
@@ -947,6 +979,39 @@ handle_getgr_result(enum nss_status status, struct group *grp,
     return EOK;
 }
 
+/* Returns the canonical name of the group from the cache if
+ * proxy_fast_alias is set, NULL if it has to be looked up online. */
+static const char *cached_group_name(TALLOC_CTX *mem_ctx,
+                                     struct proxy_id_ctx *ctx,
+                                     struct sss_domain_info *dom,
+                                     gid_t gid)
+{
+    struct ldb_result *cached_grp = NULL;
+    const char *real_name = NULL;
+    errno_t ret;
+
+    if (ctx->fast_alias == false) {
+        return NULL;
+    }
+
+    ret = sysdb_getgrgid(mem_ctx, dom, gid, &cached_grp);
+    if (ret != EOK) {
+        /* Non-fatal, attempt to canonicalize online */
+        DEBUG(SSSDBG_TRACE_FUNC, "Request to cache failed [%d]: %s\n",
+              ret, strerror(ret));
+    }
+
+    if (ret == EOK && cached_grp->count == 1) {
+        real_name = ldb_msg_find_attr_as_string(cached_grp->msgs[0],
+                                                SYSDB_NAME, NULL);
+        if (!real_name) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Cached group has no name?\n");
+        }
+    }
+
+    return real_name;
+}
+
 static int get_gr_name(struct proxy_id_ctx *ctx,
                        struct sysdb_ctx *sysdb,
                        struct sss_domain_info *dom,
@@ -960,7 +1025,6 @@ static int get_gr_name(struct proxy_id_ctx *ctx,
     bool delete_group = false;
     int ret;
     gid_t gid;
-    struct ldb_result *cached_grp = NULL;
     const char *real_name = NULL;
     char *shortname_or_alias;
 
@@ -1018,22 +1082,7 @@ static int get_gr_name(struct proxy_id_ctx *ctx,
     gid = grp->gr_gid;
 
     /* Canonicalize the group name in case it was actually an alias */
-    if (ctx->fast_alias == true) {
-        ret = sysdb_getgrgid(tmpctx, dom, gid, &cached_grp);
-        if (ret != EOK) {
-            /* Non-fatal, attempt to canonicalize online */
-            DEBUG(SSSDBG_TRACE_FUNC, "Request to cache failed [%d]: %s\n",
-                  ret, strerror(ret));
-        }
-
-        if (ret == EOK && cached_grp->count == 1) {
-            real_name = ldb_msg_find_attr_as_string(cached_grp->msgs[0],
-                                                    SYSDB_NAME, NULL);
-            if (!real_name) {
-                DEBUG(SSSDBG_MINOR_FAILURE, "Cached group has no name?\n");
-            }
-        }
-    }
+    real_name = cached_group_name(tmpctx, ctx, dom, gid);
 
     if (real_name == NULL) {
         talloc_zfree(buffer);
@@ -1097,6 +1146,41 @@ done:
 }
 
 /* =Getgrgid-wrapper======================================================*/
+static int store_gr_gid(struct sysdb_ctx *sysdb,
+                        struct sss_domain_info *dom,
+                        gid_t gid,
+                        struct group *grp,
+                        bool delete_group)
+{
+    char *name;
+    int ret;
+
+    if (delete_group) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Group %"SPRIgid" does not exist (or is invalid) on remote "
+               "server, deleting!\n", gid);
+
+        ret = sysdb_delete_group(dom, NULL, gid);
+        if (ret == ENOENT) {
+            ret = EOK;
+        }
+        return ret;
+    }
+
+    name = sss_create_internal_fqname(NULL, grp->gr_name, dom->name);
+    if (name == NULL) {
+        return ENOMEM;
+    }
+
+    ret = save_group(sysdb, dom, grp, name, NULL);
+    talloc_free(name);
+    if (ret) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot save group [%d]: %s\n", ret, strerror(ret));
+    }
+    return ret;
+}
+
 static int get_gr_gid(TALLOC_CTX *mem_ctx,
                       struct proxy_id_ctx *ctx,
                       struct sysdb_ctx *sysdb,
@@ -1111,7 +1195,6 @@ static int get_gr_gid(TALLOC_CTX *mem_ctx,
     size_t buflen = 0;
     bool delete_group = false;
     int ret;
-    char *name;
 
     DEBUG(SSSDBG_TRACE_FUNC, "Searching group by gid (%"SPRIgid")\n", gid);
 
@@ -1146,30 +1229,7 @@ static int get_gr_gid(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    if (delete_group) {
-        DEBUG(SSSDBG_TRACE_FUNC,
-              "Group %"SPRIgid" does not exist (or is invalid) on remote "
-               "server, deleting!\n", gid);
-
-        ret = sysdb_delete_group(dom, NULL, gid);
-        if (ret == ENOENT) {
-            ret = EOK;
-        }
-        goto done;
-    }
-
-    name = sss_create_internal_fqname(tmpctx, grp->gr_name, dom->name);
-    if (name == NULL) {
-        ret = ENOMEM;
-        goto done;
-    }
-
-    ret = save_group(sysdb, dom, grp, name, NULL);
-    if (ret) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Cannot save user [%d]: %s\n", ret, strerror(ret));
-        goto done;
-    }
+    ret = store_gr_gid(sysdb, dom, gid, grp, delete_group);
 
 done:
     talloc_zfree(tmpctx);
@@ -1357,7 +1417,6 @@ static int get_initgr(TALLOC_CTX *mem_ctx,
     errno_t sret;
     bool del_user;
     uid_t uid;
-    struct ldb_result *cached_pwd = NULL;
     const char *real_name = NULL;
     char *shortname_or_alias;
 
@@ -1415,22 +1474,7 @@ static int get_initgr(TALLOC_CTX *mem_ctx,
     memset(buffer, 0, buflen);
 
     /* Canonicalize the username in case it was actually an alias */
-    if (ctx->fast_alias == true) {
-        ret = sysdb_getpwuid(tmpctx, dom, uid, &cached_pwd);
-        if (ret != EOK) {
-            /* Non-fatal, attempt to canonicalize online */
-            DEBUG(SSSDBG_TRACE_FUNC, "Request to cache failed [%d]: %s\n",
-                  ret, strerror(ret));
-        }
-
-        if (ret == EOK && cached_pwd->count == 1) {
-            real_name = ldb_msg_find_attr_as_string(cached_pwd->msgs[0],
-                                                    SYSDB_NAME, NULL);
-            if (!real_name) {
-                DEBUG(SSSDBG_MINOR_FAILURE, "Cached user has no name?\n");
-            }
-        }
-    }
+    real_name = cached_user_name(tmpctx, ctx, dom, uid);
 
     if (real_name == NULL) {
         memset(buffer, 0, buflen);
@@ -1576,104 +1620,926 @@ static int get_initgr_groups_process(TALLOC_CTX *memctx,
     return ret;
 }
 
-/* =Proxy_Id-Functions====================================================*/
+/* =Worker-requests=======================================================*/
 
-static struct dp_reply_std
-proxy_account_info(TALLOC_CTX *mem_ctx,
-                   struct proxy_id_ctx *ctx,
-                   struct dp_id_data *data,
-                   struct be_ctx *be_ctx,
-                   struct sss_domain_info *domain)
+/* The requests below do the same as the functions above but the NSS calls
+ * are made by the proxy workers, so sssd_be does not wait for them. */
+
+static errno_t proxy_lookup_recv(struct tevent_req *req)
 {
-    struct dp_reply_std reply;
-    struct sysdb_ctx *sysdb;
-    uid_t uid;
-    gid_t gid;
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+struct proxy_get_pw_name_state {
+    struct tevent_context *ev;
+    struct proxy_id_ctx *ctx;
+    struct sss_domain_info *dom;
+    const char *i_name;
+    struct passwd *pwd;
+};
+
+static void proxy_get_pw_name_done(struct tevent_req *subreq);
+static void proxy_get_pw_name_uid_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+proxy_get_pw_name_send(TALLOC_CTX *mem_ctx,
+                       struct tevent_context *ev,
+                       struct proxy_id_ctx *ctx,
+                       struct sss_domain_info *dom,
+                       const char *i_name)
+{
+    struct proxy_get_pw_name_state *state;
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+    char *shortname_or_alias;
     errno_t ret;
-    char *endptr;
 
-    sysdb = domain->sysdb;
+    req = tevent_req_create(mem_ctx, &state, struct proxy_get_pw_name_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
 
-    /* Proxy provider does not support security ID lookups. */
-    if (data->filter_type == BE_FILTER_SECID) {
-        dp_reply_std_set(&reply, DP_ERR_FATAL, ENOSYS,
-                         "Security lookups are not supported");
-        return reply;
+    state->ev = ev;
+    state->ctx = ctx;
+    state->dom = dom;
+    state->i_name = talloc_strdup(state, i_name);
+    if (state->i_name == NULL) {
+        ret = ENOMEM;
+        goto done;
     }
 
-    switch (data->entry_type & BE_REQ_TYPE_MASK) {
-    case BE_REQ_USER: /* user */
-        switch (data->filter_type) {
-        case BE_FILTER_ENUM:
-            ret = enum_users(mem_ctx, ctx, sysdb, domain);
-            break;
+    DEBUG(SSSDBG_TRACE_FUNC, "Searching user by name (%s)\n", i_name);
 
-        case BE_FILTER_NAME:
-            ret = get_pw_name(ctx, domain, data->filter_value);
-            break;
+    ret = sss_parse_internal_fqname(state, i_name, &shortname_or_alias, NULL);
+    if (ret != EOK) {
+        goto done;
+    }
 
-        case BE_FILTER_IDNUM:
-            uid = (uid_t) strtouint32(data->filter_value, &endptr, 10);
-            if (errno || *endptr || (data->filter_value == endptr)) {
-                dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
-                                 "Invalid attr type");
-                return reply;
-            }
-            ret = get_pw_uid(ctx, domain, uid);
-            break;
-        default:
-            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
-                             "Invalid filter type");
-            return reply;
-        }
-        break;
+    subreq = proxy_worker_getpwnam_send(state, ev, ctx->worker_pool,
+                                        shortname_or_alias);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    tevent_req_set_callback(subreq, proxy_get_pw_name_done, req);
 
-    case BE_REQ_GROUP: /* group */
-        switch (data->filter_type) {
-        case BE_FILTER_ENUM:
-            ret = enum_groups(mem_ctx, ctx, sysdb, domain);
-            break;
-        case BE_FILTER_NAME:
-            ret = get_gr_name(ctx, sysdb, domain, data->filter_value);
-            break;
-        case BE_FILTER_IDNUM:
-            gid = (gid_t) strtouint32(data->filter_value, &endptr, 10);
-            if (errno || *endptr || (data->filter_value == endptr)) {
-                dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
-                                 "Invalid attr type");
-                return reply;
-            }
-            ret = get_gr_gid(mem_ctx, ctx, sysdb, domain, gid, 0);
-            break;
-        default:
-            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
-                             "Invalid filter type");
-            return reply;
-        }
-        break;
+    return req;
 
-    case BE_REQ_INITGROUPS: /* init groups for user */
-        if (data->filter_type != BE_FILTER_NAME) {
-            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
-                             "Invalid filter type");
-            return reply;
-        }
-        if (ctx->ops.initgroups_dyn == NULL) {
-            dp_reply_std_set(&reply, DP_ERR_FATAL, ENODEV,
-                             "Initgroups call not supported");
-            return reply;
-        }
-        ret = get_initgr(mem_ctx, ctx, sysdb, domain, data->filter_value);
-        break;
+done:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
 
-    case BE_REQ_NETGROUP:
-        if (data->filter_type != BE_FILTER_NAME) {
-            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
-                             "Invalid filter type");
-            return reply;
-        }
-        if (ctx->ops.setnetgrent == NULL || ctx->ops.getnetgrent_r == NULL ||
-            ctx->ops.endnetgrent == NULL) {
+static void proxy_get_pw_name_done(struct tevent_req *subreq)
+{
+    struct proxy_get_pw_name_state *state;
+    struct tevent_req *req;
+    enum nss_status status;
+    const char *real_name;
+    bool del_user;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_pw_name_state);
+
+    ret = proxy_worker_getpw_recv(state, subreq, &status, &state->pwd);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = handle_getpw_result(status, state->pwd, state->dom, &del_user);
+    if (ret) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "getpwnam failed [%d]: %s\n", ret, strerror(ret));
+        goto done;
+    }
+
+    if (del_user) {
+        state->pwd = NULL;
+        ret = delete_user(state->dom, state->i_name, 0);
+        goto done;
+    }
+
+    /* Canonicalize the username in case it was actually an alias */
+    real_name = cached_user_name(state, state->ctx, state->dom,
+                                 state->pwd->pw_uid);
+    if (real_name != NULL) {
+        ret = save_user(state->dom, state->pwd, real_name, state->i_name);
+        goto done;
+    }
+
+    subreq = proxy_worker_getpwuid_send(state, state->ev,
+                                        state->ctx->worker_pool,
+                                        state->pwd->pw_uid);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    tevent_req_set_callback(subreq, proxy_get_pw_name_uid_done, req);
+    return;
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "proxy -> getpwnam_r failed for '%s' <%d>: %s\n",
+               state->i_name, ret, strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+static void proxy_get_pw_name_uid_done(struct tevent_req *subreq)
+{
+    struct proxy_get_pw_name_state *state;
+    struct tevent_req *req;
+    enum nss_status status;
+    struct passwd *pwd;
+    const char *real_name;
+    bool del_user;
+    uid_t uid;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_pw_name_state);
+    uid = state->pwd->pw_uid;
+
+    ret = proxy_worker_getpw_recv(state, subreq, &status, &pwd);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = handle_getpw_result(status, pwd, state->dom, &del_user);
+    if (ret) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "getpwuid failed [%d]: %s\n", ret, strerror(ret));
+        goto done;
+    }
+
+    if (del_user) {
+        state->pwd = NULL;
+        ret = delete_user(state->dom, state->i_name, uid);
+        goto done;
+    }
+
+    real_name = sss_create_internal_fqname(state, pwd->pw_name,
+                                           state->dom->name);
+    if (real_name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* Both lookups went fine, we can save the user now */
+    state->pwd = pwd;
+    ret = save_user(state->dom, pwd, real_name, state->i_name);
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "proxy -> getpwnam_r failed for '%s' <%d>: %s\n",
+               state->i_name, ret, strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+/* _pwd is set to NULL if the user was removed from the cache. */
+static errno_t proxy_get_pw_name_recv(TALLOC_CTX *mem_ctx,
+                                      struct tevent_req *req,
+                                      struct passwd **_pwd)
+{
+    struct proxy_get_pw_name_state *state;
+
+    state = tevent_req_data(req, struct proxy_get_pw_name_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_pwd = talloc_steal(mem_ctx, state->pwd);
+
+    return EOK;
+}
+
+struct proxy_get_pw_uid_state {
+    struct sss_domain_info *dom;
+    uid_t uid;
+};
+
+static void proxy_get_pw_uid_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+proxy_get_pw_uid_send(TALLOC_CTX *mem_ctx,
+                      struct tevent_context *ev,
+                      struct proxy_id_ctx *ctx,
+                      struct sss_domain_info *dom,
+                      uid_t uid)
+{
+    struct proxy_get_pw_uid_state *state;
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+
+    req = tevent_req_create(mem_ctx, &state, struct proxy_get_pw_uid_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->dom = dom;
+    state->uid = uid;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Searching user by uid (%"SPRIuid")\n", uid);
+
+    subreq = proxy_worker_getpwuid_send(state, ev, ctx->worker_pool, uid);
+    if (subreq == NULL) {
+        tevent_req_error(req, ENOMEM);
+        tevent_req_post(req, ev);
+        return req;
+    }
+    tevent_req_set_callback(subreq, proxy_get_pw_uid_done, req);
+
+    return req;
+}
+
+static void proxy_get_pw_uid_done(struct tevent_req *subreq)
+{
+    struct proxy_get_pw_uid_state *state;
+    struct tevent_req *req;
+    enum nss_status status;
+    struct passwd *pwd;
+    bool del_user = false;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_pw_uid_state);
+
+    ret = proxy_worker_getpw_recv(state, subreq, &status, &pwd);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = handle_getpw_result(status, pwd, state->dom, &del_user);
+    if (ret) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "getpwuid failed [%d]: %s\n", ret, strerror(ret));
+        goto done;
+    }
+
+    ret = store_pw_uid(state->dom, state->uid, pwd, del_user);
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "proxy -> getpwuid_r failed for '%"SPRIuid"' <%d>: %s\n",
+               state->uid, ret, strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+struct proxy_get_gr_name_state {
+    struct tevent_context *ev;
+    struct proxy_id_ctx *ctx;
+    struct sysdb_ctx *sysdb;
+    struct sss_domain_info *dom;
+    const char *i_name;
+    gid_t gid;
+};
+
+static void proxy_get_gr_name_done(struct tevent_req *subreq);
+static void proxy_get_gr_name_gid_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+proxy_get_gr_name_send(TALLOC_CTX *mem_ctx,
+                       struct tevent_context *ev,
+                       struct proxy_id_ctx *ctx,
+                       struct sysdb_ctx *sysdb,
+                       struct sss_domain_info *dom,
+                       const char *i_name)
+{
+    struct proxy_get_gr_name_state *state;
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+    char *shortname_or_alias;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct proxy_get_gr_name_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->ev = ev;
+    state->ctx = ctx;
+    state->sysdb = sysdb;
+    state->dom = dom;
+    state->i_name = talloc_strdup(state, i_name);
+    if (state->i_name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_FUNC_DATA, "Searching group by name (%s)\n", i_name);
+
+    ret = sss_parse_internal_fqname(state, i_name, &shortname_or_alias, NULL);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    subreq = proxy_worker_getgrnam_send(state, ev, ctx->worker_pool,
+                                        shortname_or_alias);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    tevent_req_set_callback(subreq, proxy_get_gr_name_done, req);
+
+    return req;
+
+done:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static errno_t proxy_get_gr_name_delete(struct proxy_get_gr_name_state *state,
+                                        gid_t gid)
+{
+    errno_t ret;
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Group %s does not exist (or is invalid) on remote server,"
+           " deleting!\n", state->i_name);
+
+    ret = sysdb_delete_group(state->dom, state->i_name, gid);
+    if (ret == ENOENT) {
+        ret = EOK;
+    }
+
+    return ret;
+}
+
+static void proxy_get_gr_name_done(struct tevent_req *subreq)
+{
+    struct proxy_get_gr_name_state *state;
+    struct tevent_req *req;
+    enum nss_status status;
+    struct group *grp;
+    const char *real_name;
+    bool delete_group = false;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_gr_name_state);
+
+    ret = proxy_worker_getgr_recv(state, subreq, &status, &grp);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = handle_getgr_result(status, grp, state->dom, &delete_group);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "getgrnam failed [%d]: %s\n", ret, strerror(ret));
+        goto done;
+    }
+
+    if (delete_group) {
+        ret = proxy_get_gr_name_delete(state, 0);
+        goto done;
+    }
+
+    state->gid = grp->gr_gid;
+
+    /* Canonicalize the group name in case it was actually an alias */
+    real_name = cached_group_name(state, state->ctx, state->dom, state->gid);
+    if (real_name != NULL) {
+        ret = save_group(state->sysdb, state->dom, grp, real_name,
+                         state->i_name);
+        goto done;
+    }
+
+    subreq = proxy_worker_getgrgid_send(state, state->ev,
+                                        state->ctx->worker_pool, state->gid);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    tevent_req_set_callback(subreq, proxy_get_gr_name_gid_done, req);
+    return;
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "proxy -> getgrnam_r failed for '%s' <%d>: %s\n",
+              state->i_name, ret, strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+static void proxy_get_gr_name_gid_done(struct tevent_req *subreq)
+{
+    struct proxy_get_gr_name_state *state;
+    struct tevent_req *req;
+    enum nss_status status;
+    struct group *grp;
+    const char *real_name;
+    bool delete_group = false;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_gr_name_state);
+
+    ret = proxy_worker_getgr_recv(state, subreq, &status, &grp);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = handle_getgr_result(status, grp, state->dom, &delete_group);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "getgrgid failed [%d]: %s\n", ret, strerror(ret));
+        goto done;
+    }
+
+    if (delete_group) {
+        ret = proxy_get_gr_name_delete(state, state->gid);
+        goto done;
+    }
+
+    real_name = sss_create_internal_fqname(state, grp->gr_name,
+                                           state->dom->name);
+    if (real_name == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to create fqdn '%s'\n",
+              grp->gr_name);
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = save_group(state->sysdb, state->dom, grp, real_name, state->i_name);
+    if (ret) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot save group [%d]: %s\n", ret, strerror(ret));
+    }
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "proxy -> getgrnam_r failed for '%s' <%d>: %s\n",
+              state->i_name, ret, strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+struct proxy_get_gr_gid_state {
+    struct sysdb_ctx *sysdb;
+    struct sss_domain_info *dom;
+    gid_t gid;
+};
+
+static void proxy_get_gr_gid_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+proxy_get_gr_gid_send(TALLOC_CTX *mem_ctx,
+                      struct tevent_context *ev,
+                      struct proxy_id_ctx *ctx,
+                      struct sysdb_ctx *sysdb,
+                      struct sss_domain_info *dom,
+                      gid_t gid)
+{
+    struct proxy_get_gr_gid_state *state;
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+
+    req = tevent_req_create(mem_ctx, &state, struct proxy_get_gr_gid_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->sysdb = sysdb;
+    state->dom = dom;
+    state->gid = gid;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Searching group by gid (%"SPRIgid")\n", gid);
+
+    subreq = proxy_worker_getgrgid_send(state, ev, ctx->worker_pool, gid);
+    if (subreq == NULL) {
+        tevent_req_error(req, ENOMEM);
+        tevent_req_post(req, ev);
+        return req;
+    }
+    tevent_req_set_callback(subreq, proxy_get_gr_gid_done, req);
+
+    return req;
+}
+
+static void proxy_get_gr_gid_done(struct tevent_req *subreq)
+{
+    struct proxy_get_gr_gid_state *state;
+    struct tevent_req *req;
+    enum nss_status status;
+    struct group *grp;
+    bool delete_group = false;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_gr_gid_state);
+
+    ret = proxy_worker_getgr_recv(state, subreq, &status, &grp);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = handle_getgr_result(status, grp, state->dom, &delete_group);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "getgrgid failed [%d]: %s\n", ret, strerror(ret));
+        goto done;
+    }
+
+    ret = store_gr_gid(state->sysdb, state->dom, state->gid, grp,
+                       delete_group);
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "proxy -> getgrgid_r failed for '%"SPRIgid"' <%d>: %s\n",
+               state->gid, ret, strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+/* The groups of the user are looked up one after the other, so a single
+ * initgroups request does not take all the workers. */
+struct proxy_get_initgr_state {
+    struct tevent_context *ev;
+    struct proxy_id_ctx *ctx;
+    struct sysdb_ctx *sysdb;
+    struct sss_domain_info *dom;
+    struct passwd *pwd;
+
+    gid_t *gids;
+    size_t num_gids;
+    size_t gid_idx;
+};
+
+static void proxy_get_initgr_user_done(struct tevent_req *subreq);
+static void proxy_get_initgr_groups_done(struct tevent_req *subreq);
+static errno_t proxy_get_initgr_next_group(struct tevent_req *req);
+static void proxy_get_initgr_group_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+proxy_get_initgr_send(TALLOC_CTX *mem_ctx,
+                      struct tevent_context *ev,
+                      struct proxy_id_ctx *ctx,
+                      struct sysdb_ctx *sysdb,
+                      struct sss_domain_info *dom,
+                      const char *i_name)
+{
+    struct proxy_get_initgr_state *state;
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+
+    req = tevent_req_create(mem_ctx, &state, struct proxy_get_initgr_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->ev = ev;
+    state->ctx = ctx;
+    state->sysdb = sysdb;
+    state->dom = dom;
+
+    subreq = proxy_get_pw_name_send(state, ev, ctx, dom, i_name);
+    if (subreq == NULL) {
+        tevent_req_error(req, ENOMEM);
+        tevent_req_post(req, ev);
+        return req;
+    }
+    tevent_req_set_callback(subreq, proxy_get_initgr_user_done, req);
+
+    return req;
+}
+
+static void proxy_get_initgr_user_done(struct tevent_req *subreq)
+{
+    struct proxy_get_initgr_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_initgr_state);
+
+    ret = proxy_get_pw_name_recv(state, subreq, &state->pwd);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    if (state->pwd == NULL) {
+        /* the user was removed */
+        tevent_req_done(req);
+        return;
+    }
+
+    subreq = proxy_worker_initgroups_send(state, state->ev,
+                                          state->ctx->worker_pool,
+                                          state->pwd->pw_name,
+                                          state->pwd->pw_gid);
+    if (subreq == NULL) {
+        tevent_req_error(req, ENOMEM);
+        return;
+    }
+    tevent_req_set_callback(subreq, proxy_get_initgr_groups_done, req);
+}
+
+static void proxy_get_initgr_groups_done(struct tevent_req *subreq)
+{
+    struct proxy_get_initgr_state *state;
+    struct tevent_req *req;
+    enum nss_status status;
+    int err;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_initgr_state);
+
+    ret = proxy_worker_initgroups_recv(state, subreq, &status, &err,
+                                       &state->num_gids, &state->gids);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    switch (status) {
+    case NSS_STATUS_NOTFOUND:
+        DEBUG(SSSDBG_FUNC_DATA, "The initgroups call returned 'NOTFOUND'. "
+                                 "Assume the user is only member of its "
+                                 "primary group (%"SPRIgid")\n",
+                                 state->pwd->pw_gid);
+        /* fall through */
+        SSS_ATTRIBUTE_FALLTHROUGH;
+    case NSS_STATUS_SUCCESS:
+        DEBUG(SSSDBG_CONF_SETTINGS, "User [%s] appears to be member of %zu "
+              "groups\n", state->pwd->pw_name, state->num_gids);
+        break;
+
+    default:
+        DEBUG(SSSDBG_OP_FAILURE, "proxy -> initgroups_dyn failed (%d)[%s]\n",
+              err, strerror(err));
+        tevent_req_error(req, EIO);
+        return;
+    }
+
+    ret = proxy_get_initgr_next_group(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static errno_t proxy_get_initgr_next_group(struct tevent_req *req)
+{
+    struct proxy_get_initgr_state *state;
+    struct tevent_req *subreq;
+
+    state = tevent_req_data(req, struct proxy_get_initgr_state);
+
+    if (state->gid_idx >= state->num_gids) {
+        return EOK;
+    }
+
+    subreq = proxy_get_gr_gid_send(state, state->ev, state->ctx,
+                                   state->sysdb, state->dom,
+                                   state->gids[state->gid_idx]);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+    tevent_req_set_callback(subreq, proxy_get_initgr_group_done, req);
+
+    return EAGAIN;
+}
+
+static void proxy_get_initgr_group_done(struct tevent_req *subreq)
+{
+    struct proxy_get_initgr_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_get_initgr_state);
+
+    ret = proxy_lookup_recv(subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    state->gid_idx++;
+    ret = proxy_get_initgr_next_group(req);
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+/* Returns ENOENT if the request is not handled by the workers, invalid
+ * requests are left to proxy_account_info() as well. */
+static errno_t proxy_account_info_worker_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_id_ctx *ctx,
+                                              struct dp_id_data *data,
+                                              struct sss_domain_info *domain,
+                                              struct tevent_req **_subreq)
+{
+    struct tevent_req *subreq;
+    char *endptr;
+    uint32_t id = 0;
+
+    if (ctx->worker_pool == NULL) {
+        return ENOENT;
+    }
+
+    if (data->filter_type == BE_FILTER_IDNUM) {
+        id = strtouint32(data->filter_value, &endptr, 10);
+        if (errno || *endptr || (data->filter_value == endptr)) {
+            return ENOENT;
+        }
+    }
+
+    switch (data->entry_type & BE_REQ_TYPE_MASK) {
+    case BE_REQ_USER:
+        if (data->filter_type == BE_FILTER_NAME) {
+            subreq = proxy_get_pw_name_send(mem_ctx, ev, ctx, domain,
+                                            data->filter_value);
+        } else if (data->filter_type == BE_FILTER_IDNUM) {
+            subreq = proxy_get_pw_uid_send(mem_ctx, ev, ctx, domain,
+                                           (uid_t) id);
+        } else {
+            return ENOENT;
+        }
+        break;
+
+    case BE_REQ_GROUP:
+        if (data->filter_type == BE_FILTER_NAME) {
+            subreq = proxy_get_gr_name_send(mem_ctx, ev, ctx, domain->sysdb,
+                                            domain, data->filter_value);
+        } else if (data->filter_type == BE_FILTER_IDNUM) {
+            subreq = proxy_get_gr_gid_send(mem_ctx, ev, ctx, domain->sysdb,
+                                           domain, (gid_t) id);
+        } else {
+            return ENOENT;
+        }
+        break;
+
+    case BE_REQ_INITGROUPS:
+        if (data->filter_type != BE_FILTER_NAME
+                || ctx->ops.initgroups_dyn == NULL) {
+            return ENOENT;
+        }
+        subreq = proxy_get_initgr_send(mem_ctx, ev, ctx, domain->sysdb,
+                                       domain, data->filter_value);
+        break;
+
+    default:
+        return ENOENT;
+    }
+
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+
+    *_subreq = subreq;
+    return EOK;
+}
+
+/* =Proxy_Id-Functions====================================================*/
+
+static struct dp_reply_std
+proxy_account_info(TALLOC_CTX *mem_ctx,
+                   struct proxy_id_ctx *ctx,
+                   struct dp_id_data *data,
+                   struct be_ctx *be_ctx,
+                   struct sss_domain_info *domain)
+{
+    struct dp_reply_std reply;
+    struct sysdb_ctx *sysdb;
+    uid_t uid;
+    gid_t gid;
+    errno_t ret;
+    char *endptr;
+
+    sysdb = domain->sysdb;
+
+    /* Proxy provider does not support security ID lookups. */
+    if (data->filter_type == BE_FILTER_SECID) {
+        dp_reply_std_set(&reply, DP_ERR_FATAL, ENOSYS,
+                         "Security lookups are not supported");
+        return reply;
+    }
+
+    switch (data->entry_type & BE_REQ_TYPE_MASK) {
+    case BE_REQ_USER: /* user */
+        switch (data->filter_type) {
+        case BE_FILTER_ENUM:
+            ret = enum_users(mem_ctx, ctx, sysdb, domain);
+            break;
+
+        case BE_FILTER_NAME:
+            ret = get_pw_name(ctx, domain, data->filter_value);
+            break;
+
+        case BE_FILTER_IDNUM:
+            uid = (uid_t) strtouint32(data->filter_value, &endptr, 10);
+            if (errno || *endptr || (data->filter_value == endptr)) {
+                dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
+                                 "Invalid attr type");
+                return reply;
+            }
+            ret = get_pw_uid(ctx, domain, uid);
+            break;
+        default:
+            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
+                             "Invalid filter type");
+            return reply;
+        }
+        break;
+
+    case BE_REQ_GROUP: /* group */
+        switch (data->filter_type) {
+        case BE_FILTER_ENUM:
+            ret = enum_groups(mem_ctx, ctx, sysdb, domain);
+            break;
+        case BE_FILTER_NAME:
+            ret = get_gr_name(ctx, sysdb, domain, data->filter_value);
+            break;
+        case BE_FILTER_IDNUM:
+            gid = (gid_t) strtouint32(data->filter_value, &endptr, 10);
+            if (errno || *endptr || (data->filter_value == endptr)) {
+                dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
+                                 "Invalid attr type");
+                return reply;
+            }
+            ret = get_gr_gid(mem_ctx, ctx, sysdb, domain, gid, 0);
+            break;
+        default:
+            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
+                             "Invalid filter type");
+            return reply;
+        }
+        break;
+
+    case BE_REQ_INITGROUPS: /* init groups for user */
+        if (data->filter_type != BE_FILTER_NAME) {
+            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
+                             "Invalid filter type");
+            return reply;
+        }
+        if (ctx->ops.initgroups_dyn == NULL) {
+            dp_reply_std_set(&reply, DP_ERR_FATAL, ENODEV,
+                             "Initgroups call not supported");
+            return reply;
+        }
+        ret = get_initgr(mem_ctx, ctx, sysdb, domain, data->filter_value);
+        break;
+
+    case BE_REQ_NETGROUP:
+        if (data->filter_type != BE_FILTER_NAME) {
+            dp_reply_std_set(&reply, DP_ERR_FATAL, EINVAL,
+                             "Invalid filter type");
+            return reply;
+        }
+        if (ctx->ops.setnetgrent == NULL || ctx->ops.getnetgrent_r == NULL ||
+            ctx->ops.endnetgrent == NULL) {
             dp_reply_std_set(&reply, DP_ERR_FATAL, ENODEV,
                              "Netgroups are not supported");
             return reply;
@@ -1744,8 +2610,11 @@ proxy_account_info(TALLOC_CTX *mem_ctx,
 
 struct proxy_account_info_handler_state {
     struct dp_reply_std reply;
+    struct be_ctx *be_ctx;
 };
 
+static void proxy_account_info_handler_done(struct tevent_req *subreq);
+
 struct tevent_req *
 proxy_account_info_handler_send(TALLOC_CTX *mem_ctx,
                                struct proxy_id_ctx *id_ctx,
@@ -1754,6 +2623,8 @@ proxy_account_info_handler_send(TALLOC_CTX *mem_ctx,
 {
     struct proxy_account_info_handler_state *state;
     struct tevent_req *req;
+    struct tevent_req *subreq;
+    errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state,
                             struct proxy_account_info_handler_state);
@@ -1762,6 +2633,20 @@ proxy_account_info_handler_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
+    state->be_ctx = params->be_ctx;
+
+    ret = proxy_account_info_worker_send(state, params->ev, id_ctx, data,
+                                         params->be_ctx->domain, &subreq);
+    if (ret == EOK) {
+        tevent_req_set_callback(subreq, proxy_account_info_handler_done, req);
+        return req;
+    } else if (ret != ENOENT) {
+        dp_reply_std_set(&state->reply, DP_ERR_FATAL, ret, NULL);
+        tevent_req_done(req);
+        tevent_req_post(req, params->ev);
+        return req;
+    }
+
     state->reply = proxy_account_info(state, id_ctx, data, params->be_ctx,
                                       params->be_ctx->domain);
 
@@ -1772,6 +2657,34 @@ proxy_account_info_handler_send(TALLOC_CTX *mem_ctx,
     return req;
 }
 
+static void proxy_account_info_handler_done(struct tevent_req *subreq)
+{
+    struct proxy_account_info_handler_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct proxy_account_info_handler_state);
+
+    ret = proxy_lookup_recv(subreq);
+    talloc_zfree(subreq);
+
+    if (ret == ENXIO) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "proxy returned UNAVAIL error, going offline!\n");
+        be_mark_offline(state->be_ctx);
+    }
+
+    if (ret != EOK) {
+        dp_reply_std_set(&state->reply, DP_ERR_FATAL, ret, NULL);
+    } else {
+        dp_reply_std_set(&state->reply, DP_ERR_OK, EOK, NULL);
+    }
+
+    /* TODO For backward compatibility we always return EOK to DP now. */
+    tevent_req_done(req);
+}
+
 errno_t proxy_account_info_handler_recv(TALLOC_CTX *mem_ctx,
                                        struct tevent_req *req,
                                        struct dp_reply_std *data)
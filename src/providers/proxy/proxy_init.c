@@ -28,15 +28,18 @@
 #include "providers/proxy/proxy.h"
 
 #define OPT_MAX_CHILDREN_DEFAULT 10
+#define OPT_ID_WORKERS_DEFAULT 0
 
 static errno_t proxy_id_conf(TALLOC_CTX *mem_ctx,
                              struct be_ctx *be_ctx,
                              char **_libname,
-                             bool *_fast_alias)
+                             bool *_fast_alias,
+                             int *_id_workers)
 {
     TALLOC_CTX *tmp_ctx;
     char *libname;
     bool fast_alias;
+    int id_workers;
     errno_t ret;
 
     tmp_ctx = talloc_new(NULL);
@@ -65,8 +68,25 @@ static errno_t proxy_id_conf(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = confdb_get_int(be_ctx->cdb, be_ctx->conf_path,
+                         CONFDB_PROXY_ID_WORKERS, OPT_ID_WORKERS_DEFAULT,
+                         &id_workers);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to read confdb [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    if (id_workers < 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Option " CONFDB_PROXY_ID_WORKERS " must not be negative\n");
+        ret = EINVAL;
+        goto done;
+    }
+
     *_libname = talloc_steal(mem_ctx, libname);
     *_fast_alias = fast_alias;
+    *_id_workers = id_workers;
 
     ret = EOK;
 
@@ -324,6 +344,7 @@ errno_t sssm_proxy_id_init(TALLOC_CTX *mem_ctx,
 {
     struct proxy_module_ctx *module_ctx;
     char *libname;
+    int id_workers;
     errno_t ret;
 
     module_ctx = talloc_get_type(module_data, struct proxy_module_ctx);
@@ -335,7 +356,7 @@ errno_t sssm_proxy_id_init(TALLOC_CTX *mem_ctx,
     module_ctx->id_ctx->be = be_ctx;
 
     ret = proxy_id_conf(module_ctx->id_ctx, be_ctx, &libname,
-                        &module_ctx->id_ctx->fast_alias);
+                        &module_ctx->id_ctx->fast_alias, &id_workers);
     if (ret != EOK) {
         goto done;
     }
@@ -347,6 +368,18 @@ errno_t sssm_proxy_id_init(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    if (id_workers > 0) {
+        ret = proxy_worker_pool_init(module_ctx->id_ctx, be_ctx->ev,
+                                     &module_ctx->id_ctx->ops, id_workers,
+                                     &module_ctx->id_ctx->worker_pool);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_FATAL_FAILURE,
+                  "Unable to set up the proxy workers [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            goto done;
+        }
+    }
+
     dp_set_method(dp_methods, DPM_ACCOUNT_HANDLER,
                   proxy_account_info_handler_send, proxy_account_info_handler_recv,
                   module_ctx->id_ctx, struct proxy_id_ctx, struct dp_id_data,
@@ -0,0 +1,1240 @@
+/*
+    SSSD
+
+    proxy_worker.c
+
+    Copyright (C) 2026 Red Hat
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The wrapped NSS modules are free to block, for example nss_ldap or nss_nis
+ * while the server does not answer. To keep the event loop of the backend
+ * running, the getpw*, getgr* and initgroups_dyn calls can be run by a small
+ * pool of processes forked from sssd_be, so they inherit the loaded module.
+ * The workers only call the module and pass back the flattened result over a
+ * pipe, everything touching the cache stays in sssd_be. */
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+
+#include "util/util.h"
+#include "util/atomic_io.h"
+#include "util/child_common.h"
+#include "providers/proxy/proxy.h"
+
+#define PROXY_WORKER_MAX_NAME 4096
+#define PROXY_WORKER_MAX_RESPONSE (2 * MAX_BUF_SIZE)
+
+enum proxy_worker_call {
+    PROXY_WORKER_GETPWNAM = 1,
+    PROXY_WORKER_GETPWUID,
+    PROXY_WORKER_GETGRNAM,
+    PROXY_WORKER_GETGRGID,
+    PROXY_WORKER_INITGROUPS,
+};
+
+/* The request is followed by name_len bytes of the NUL terminated name, the
+ * response by len bytes of the flattened entry. Both ends are the same
+ * binary, so the structures are passed as they are. */
+struct proxy_worker_request {
+    uint32_t call;
+    uint32_t id;
+    uint32_t name_len;
+};
+
+struct proxy_worker_response {
+    uint32_t ret;
+    uint32_t status;
+    uint32_t err;
+    uint32_t len;
+};
+
+struct proxy_worker_call_state;
+
+struct proxy_worker {
+    struct proxy_worker *prev;
+    struct proxy_worker *next;
+
+    struct proxy_worker_pool *pool;
+    struct sss_child_ctx_old *child_ctx;
+    pid_t pid;
+    int req_fd;
+    int res_fd;
+    struct tevent_fd *fde;
+
+    /* set while the worker runs a call, call is reset if the caller is
+     * not interested in the result anymore */
+    bool busy;
+    struct proxy_worker_call_state *call;
+
+    struct proxy_worker_response rsp;
+    size_t rsp_read;
+    uint8_t *payload;
+    size_t payload_read;
+
+    bool retired;
+};
+
+struct proxy_worker_pool {
+    struct tevent_context *ev;
+    struct sss_nss_ops *ops;
+    int max_workers;
+
+    struct proxy_worker *workers;
+    int num_workers;
+
+    /* calls waiting for a free worker, oldest first */
+    struct proxy_worker_call_state *queue;
+};
+
+struct proxy_worker_call_state {
+    struct proxy_worker_call_state *prev;
+    struct proxy_worker_call_state *next;
+
+    struct tevent_req *req;
+    struct proxy_worker_pool *pool;
+    struct proxy_worker *worker;
+    bool queued;
+
+    struct proxy_worker_request hdr;
+    const char *name;
+
+    enum nss_status status;
+    int err;
+    uint8_t *payload;
+    size_t len;
+};
+
+static void proxy_worker_pool_dispatch(struct proxy_worker_pool *pool);
+
+/* =Worker-process========================================================*/
+
+static void proxy_worker_pack_str(uint8_t *buf, const char *str, size_t *p)
+{
+    if (str == NULL) {
+        str = "";
+    }
+
+    safealign_memcpy(&buf[*p], str, strlen(str) + 1, p);
+}
+
+static size_t proxy_worker_str_size(const char *str)
+{
+    return str == NULL ? 1 : strlen(str) + 1;
+}
+
+static errno_t proxy_worker_pack_passwd(TALLOC_CTX *mem_ctx,
+                                        struct passwd *pwd,
+                                        uint8_t **_buf,
+                                        size_t *_len)
+{
+    uint8_t *buf;
+    size_t len;
+    size_t p = 0;
+
+    len = 2 * sizeof(uint32_t)
+          + proxy_worker_str_size(pwd->pw_name)
+          + proxy_worker_str_size(pwd->pw_passwd)
+          + proxy_worker_str_size(pwd->pw_gecos)
+          + proxy_worker_str_size(pwd->pw_dir)
+          + proxy_worker_str_size(pwd->pw_shell);
+
+    buf = talloc_size(mem_ctx, len);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+
+    SAFEALIGN_SETMEM_UINT32(&buf[p], pwd->pw_uid, &p);
+    SAFEALIGN_SETMEM_UINT32(&buf[p], pwd->pw_gid, &p);
+    proxy_worker_pack_str(buf, pwd->pw_name, &p);
+    proxy_worker_pack_str(buf, pwd->pw_passwd, &p);
+    proxy_worker_pack_str(buf, pwd->pw_gecos, &p);
+    proxy_worker_pack_str(buf, pwd->pw_dir, &p);
+    proxy_worker_pack_str(buf, pwd->pw_shell, &p);
+
+    *_buf = buf;
+    *_len = len;
+    return EOK;
+}
+
+static errno_t proxy_worker_pack_group(TALLOC_CTX *mem_ctx,
+                                       struct group *grp,
+                                       uint8_t **_buf,
+                                       size_t *_len)
+{
+    uint8_t *buf;
+    size_t len;
+    size_t num_mem = 0;
+    size_t p = 0;
+    size_t i;
+
+    len = 2 * sizeof(uint32_t)
+          + proxy_worker_str_size(grp->gr_name)
+          + proxy_worker_str_size(grp->gr_passwd);
+
+    if (grp->gr_mem != NULL) {
+        for (num_mem = 0; grp->gr_mem[num_mem] != NULL; num_mem++) {
+            len += proxy_worker_str_size(grp->gr_mem[num_mem]);
+        }
+    }
+
+    buf = talloc_size(mem_ctx, len);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+
+    SAFEALIGN_SETMEM_UINT32(&buf[p], grp->gr_gid, &p);
+    SAFEALIGN_SETMEM_UINT32(&buf[p], num_mem, &p);
+    proxy_worker_pack_str(buf, grp->gr_name, &p);
+    proxy_worker_pack_str(buf, grp->gr_passwd, &p);
+    for (i = 0; i < num_mem; i++) {
+        proxy_worker_pack_str(buf, grp->gr_mem[i], &p);
+    }
+
+    *_buf = buf;
+    *_len = len;
+    return EOK;
+}
+
+static errno_t proxy_worker_call_pw(TALLOC_CTX *mem_ctx,
+                                    struct sss_nss_ops *ops,
+                                    struct proxy_worker_request *hdr,
+                                    const char *name,
+                                    struct proxy_worker_response *rsp,
+                                    uint8_t **_buf)
+{
+    struct passwd pwd;
+    enum nss_status status;
+    char *buffer = NULL;
+    size_t buflen = DEFAULT_BUFSIZE;
+    size_t len = 0;
+    int err;
+    errno_t ret;
+
+    do {
+        buffer = talloc_realloc_size(mem_ctx, buffer, buflen);
+        if (buffer == NULL) {
+            return ENOMEM;
+        }
+
+        memset(&pwd, 0, sizeof(pwd));
+        err = 0;
+        if (hdr->call == PROXY_WORKER_GETPWNAM) {
+            status = ops->getpwnam_r(name, &pwd, buffer, buflen, &err);
+        } else {
+            status = ops->getpwuid_r(hdr->id, &pwd, buffer, buflen, &err);
+        }
+
+        if (status != NSS_STATUS_TRYAGAIN || err != ERANGE
+                || buflen >= MAX_BUF_SIZE) {
+            break;
+        }
+        buflen = MIN(buflen * 2, MAX_BUF_SIZE);
+    } while (true);
+
+    if (status == NSS_STATUS_SUCCESS) {
+        ret = proxy_worker_pack_passwd(mem_ctx, &pwd, _buf, &len);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    rsp->status = status;
+    rsp->err = err;
+    rsp->len = len;
+    return EOK;
+}
+
+static errno_t proxy_worker_call_gr(TALLOC_CTX *mem_ctx,
+                                    struct sss_nss_ops *ops,
+                                    struct proxy_worker_request *hdr,
+                                    const char *name,
+                                    struct proxy_worker_response *rsp,
+                                    uint8_t **_buf)
+{
+    struct group grp;
+    enum nss_status status;
+    char *buffer = NULL;
+    size_t buflen = DEFAULT_BUFSIZE;
+    size_t len = 0;
+    int err;
+    errno_t ret;
+
+    do {
+        buffer = talloc_realloc_size(mem_ctx, buffer, buflen);
+        if (buffer == NULL) {
+            return ENOMEM;
+        }
+
+        memset(&grp, 0, sizeof(grp));
+        err = 0;
+        if (hdr->call == PROXY_WORKER_GETGRNAM) {
+            status = ops->getgrnam_r(name, &grp, buffer, buflen, &err);
+        } else {
+            status = ops->getgrgid_r(hdr->id, &grp, buffer, buflen, &err);
+        }
+
+        /* like the direct calls, treat TRYAGAIN as a too small buffer */
+        if (status != NSS_STATUS_TRYAGAIN || buflen >= MAX_BUF_SIZE) {
+            break;
+        }
+        buflen = MIN(buflen * 2, MAX_BUF_SIZE);
+    } while (true);
+
+    if (status == NSS_STATUS_SUCCESS) {
+        ret = proxy_worker_pack_group(mem_ctx, &grp, _buf, &len);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    rsp->status = status;
+    rsp->err = err;
+    rsp->len = len;
+    return EOK;
+}
+
+static errno_t proxy_worker_call_initgr(TALLOC_CTX *mem_ctx,
+                                        struct sss_nss_ops *ops,
+                                        struct proxy_worker_request *hdr,
+                                        const char *name,
+                                        struct proxy_worker_response *rsp,
+                                        uint8_t **_buf)
+{
+    enum nss_status status;
+    long int limit = 4096;
+    long int num = 4096;
+    long int num_gids = 0;
+    gid_t *gids;
+    gid_t *newgids;
+    uint8_t *buf = NULL;
+    size_t p = 0;
+    long int i;
+    int err = 0;
+    errno_t ret;
+
+    /* the modules may grow the array with realloc() themselves */
+    gids = malloc(num * sizeof(gid_t));
+    if (gids == NULL) {
+        return ENOMEM;
+    }
+
+    /* nss modules may skip the primary group when we pass it in so always add
+     * it in advance */
+    gids[0] = hdr->id;
+    num_gids++;
+
+    do {
+        status = ops->initgroups_dyn(name, hdr->id, &num_gids, &num, &gids,
+                                     limit, &err);
+        if (status != NSS_STATUS_TRYAGAIN
+                || num * sizeof(gid_t) >= MAX_BUF_SIZE) {
+            break;
+        }
+
+        /* buffer too small? */
+        num = MIN(num * 2, MAX_BUF_SIZE / sizeof(gid_t));
+        limit = num;
+        newgids = realloc(gids, num * sizeof(gid_t));
+        if (newgids == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        gids = newgids;
+    } while (true);
+
+    rsp->status = status;
+    rsp->err = err;
+    rsp->len = 0;
+
+    if (status == NSS_STATUS_SUCCESS || status == NSS_STATUS_NOTFOUND) {
+        rsp->len = (num_gids + 1) * sizeof(uint32_t);
+        buf = talloc_size(mem_ctx, rsp->len);
+        if (buf == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        SAFEALIGN_SETMEM_UINT32(&buf[p], num_gids, &p);
+        for (i = 0; i < num_gids; i++) {
+            SAFEALIGN_SETMEM_UINT32(&buf[p], gids[i], &p);
+        }
+    }
+
+    *_buf = buf;
+    ret = EOK;
+
+done:
+    free(gids);
+    return ret;
+}
+
+static errno_t proxy_worker_run(TALLOC_CTX *mem_ctx,
+                                struct sss_nss_ops *ops,
+                                struct proxy_worker_request *hdr,
+                                const char *name,
+                                struct proxy_worker_response *rsp,
+                                uint8_t **_buf)
+{
+    switch (hdr->call) {
+    case PROXY_WORKER_GETPWNAM:
+    case PROXY_WORKER_GETPWUID:
+        return proxy_worker_call_pw(mem_ctx, ops, hdr, name, rsp, _buf);
+    case PROXY_WORKER_GETGRNAM:
+    case PROXY_WORKER_GETGRGID:
+        return proxy_worker_call_gr(mem_ctx, ops, hdr, name, rsp, _buf);
+    case PROXY_WORKER_INITGROUPS:
+        return proxy_worker_call_initgr(mem_ctx, ops, hdr, name, rsp, _buf);
+    }
+
+    return EINVAL;
+}
+
+/* Serves calls until sssd_be closes the request pipe, never returns. */
+static void proxy_worker_main(struct sss_nss_ops *ops, int in_fd, int out_fd)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct proxy_worker_request hdr;
+    struct proxy_worker_response rsp;
+    char name[PROXY_WORKER_MAX_NAME];
+    uint8_t *buf;
+    ssize_t len;
+
+    while (true) {
+        len = sss_atomic_read_s(in_fd, &hdr, sizeof(hdr));
+        if (len != sizeof(hdr)) {
+            break;
+        }
+
+        if (hdr.name_len > sizeof(name)) {
+            break;
+        }
+
+        name[0] = '\0';
+        if (hdr.name_len > 0) {
+            len = sss_atomic_read_s(in_fd, name, hdr.name_len);
+            if (len != hdr.name_len || name[hdr.name_len - 1] != '\0') {
+                break;
+            }
+        }
+
+        tmp_ctx = talloc_new(NULL);
+        if (tmp_ctx == NULL) {
+            break;
+        }
+
+        buf = NULL;
+        memset(&rsp, 0, sizeof(rsp));
+        rsp.ret = proxy_worker_run(tmp_ctx, ops, &hdr, name, &rsp, &buf);
+        if (rsp.ret != EOK) {
+            rsp.len = 0;
+        }
+
+        len = sss_atomic_write_s(out_fd, &rsp, sizeof(rsp));
+        if (len == sizeof(rsp) && rsp.len > 0) {
+            len = sss_atomic_write_s(out_fd, buf, rsp.len) == rsp.len
+                      ? sizeof(rsp) : -1;
+        }
+        talloc_free(tmp_ctx);
+
+        if (len != sizeof(rsp)) {
+            break;
+        }
+    }
+
+    _exit(0);
+}
+
+static void proxy_worker_child_setup(struct proxy_worker_pool *pool)
+{
+    struct proxy_worker *worker;
+    int signals[] = { SIGTERM, SIGINT, SIGHUP, SIGUSR1, SIGUSR2, SIGCHLD };
+    size_t i;
+
+    /* only sssd_be may hold the ends of the other workers, so they see when
+     * it goes away */
+    DLIST_FOR_EACH(worker, pool->workers) {
+        PIPE_FD_CLOSE(worker->req_fd);
+        PIPE_FD_CLOSE(worker->res_fd);
+    }
+
+    /* the tevent handlers inherited from sssd_be would never run */
+    for (i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        signal(signals[i], SIG_DFL);
+    }
+}
+
+/* =Pool==================================================================*/
+
+static void proxy_worker_call_finish(struct proxy_worker_call_state *state,
+                                     errno_t ret)
+{
+    state->worker = NULL;
+
+    if (ret != EOK) {
+        tevent_req_error(state->req, ret);
+        return;
+    }
+
+    tevent_req_done(state->req);
+}
+
+/* The worker is not handed out anymore. Its process exits on its own once it
+ * sees the closed request pipe. */
+static void proxy_worker_retire(struct proxy_worker *worker, errno_t ret)
+{
+    struct proxy_worker_call_state *call;
+
+    if (worker->retired) {
+        return;
+    }
+
+    worker->retired = true;
+    DLIST_REMOVE(worker->pool->workers, worker);
+    worker->pool->num_workers--;
+    talloc_zfree(worker->fde);
+    PIPE_FD_CLOSE(worker->req_fd);
+    PIPE_FD_CLOSE(worker->res_fd);
+
+    call = worker->call;
+    worker->call = NULL;
+    worker->busy = false;
+    if (call != NULL) {
+        proxy_worker_call_finish(call, ret);
+    }
+}
+
+static int proxy_worker_destructor(struct proxy_worker *worker)
+{
+    if (!worker->retired) {
+        DLIST_REMOVE(worker->pool->workers, worker);
+        worker->pool->num_workers--;
+    }
+
+    if (worker->call != NULL) {
+        worker->call->worker = NULL;
+    }
+
+    PIPE_FD_CLOSE(worker->req_fd);
+    PIPE_FD_CLOSE(worker->res_fd);
+
+    if (worker->child_ctx != NULL) {
+        /* kills the process and drops the callback */
+        child_handler_destroy(worker->child_ctx);
+    }
+
+    return 0;
+}
+
+static void proxy_worker_exited(int child_status,
+                                struct tevent_signal *sige,
+                                void *pvt)
+{
+    struct proxy_worker *worker;
+    struct proxy_worker_pool *pool;
+
+    worker = talloc_get_type(pvt, struct proxy_worker);
+    pool = worker->pool;
+
+    /* freed by the caller */
+    worker->child_ctx = NULL;
+
+    if (!worker->retired) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "proxy worker [%d] exited unexpectedly.\n", worker->pid);
+        proxy_worker_retire(worker, EIO);
+    }
+
+    talloc_free(worker);
+
+    proxy_worker_pool_dispatch(pool);
+}
+
+static void proxy_worker_done(struct proxy_worker *worker)
+{
+    struct proxy_worker_call_state *call;
+    errno_t ret;
+
+    call = worker->call;
+    worker->call = NULL;
+    worker->busy = false;
+    worker->rsp_read = 0;
+    worker->payload_read = 0;
+
+    if (call == NULL) {
+        talloc_zfree(worker->payload);
+        return;
+    }
+
+    call->status = worker->rsp.status;
+    call->err = worker->rsp.err;
+    call->len = worker->rsp.len;
+    call->payload = talloc_steal(call, worker->payload);
+    worker->payload = NULL;
+
+    ret = worker->rsp.ret;
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "proxy worker [%d] failed [%d]: %s\n",
+              worker->pid, ret, sss_strerror(ret));
+    }
+
+    proxy_worker_call_finish(call, ret);
+}
+
+static errno_t proxy_worker_read(int fd, void *buf, size_t len,
+                                 size_t *_read)
+{
+    ssize_t n;
+
+    n = read(fd, (uint8_t *)buf + *_read, len - *_read);
+    if (n == -1) {
+        if (errno == EAGAIN || errno == EINTR) {
+            return EAGAIN;
+        }
+        return errno;
+    } else if (n == 0) {
+        return EPIPE;
+    }
+
+    *_read += n;
+    return *_read < len ? EAGAIN : EOK;
+}
+
+static void proxy_worker_readable(struct tevent_context *ev,
+                                  struct tevent_fd *fde,
+                                  uint16_t flags,
+                                  void *pvt)
+{
+    struct proxy_worker *worker;
+    struct proxy_worker_pool *pool;
+    errno_t ret;
+
+    worker = talloc_get_type(pvt, struct proxy_worker);
+    pool = worker->pool;
+
+    if (!worker->busy) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Unexpected data from proxy worker [%d].\n", worker->pid);
+        ret = EIO;
+        goto fail;
+    }
+
+    if (worker->rsp_read < sizeof(worker->rsp)) {
+        ret = proxy_worker_read(worker->res_fd, &worker->rsp,
+                                sizeof(worker->rsp), &worker->rsp_read);
+        if (ret == EAGAIN) {
+            return;
+        } else if (ret != EOK) {
+            goto fail;
+        }
+
+        if (worker->rsp.len > PROXY_WORKER_MAX_RESPONSE) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Response from proxy worker [%d] is too large.\n",
+                  worker->pid);
+            ret = EIO;
+            goto fail;
+        }
+
+        if (worker->rsp.len > 0) {
+            worker->payload = talloc_size(worker, worker->rsp.len);
+            if (worker->payload == NULL) {
+                ret = ENOMEM;
+                goto fail;
+            }
+        }
+    }
+
+    if (worker->payload_read < worker->rsp.len) {
+        ret = proxy_worker_read(worker->res_fd, worker->payload,
+                                worker->rsp.len, &worker->payload_read);
+        if (ret == EAGAIN) {
+            return;
+        } else if (ret != EOK) {
+            goto fail;
+        }
+    }
+
+    proxy_worker_done(worker);
+    proxy_worker_pool_dispatch(pool);
+    return;
+
+fail:
+    DEBUG(SSSDBG_OP_FAILURE, "Lost proxy worker [%d] [%d]: %s\n",
+          worker->pid, ret, sss_strerror(ret));
+    talloc_zfree(worker->payload);
+    proxy_worker_retire(worker, ret == EPIPE ? EIO : ret);
+    proxy_worker_pool_dispatch(pool);
+}
+
+static errno_t proxy_worker_start(struct proxy_worker_pool *pool,
+                                  struct proxy_worker **_worker)
+{
+    struct proxy_worker *worker;
+    int to_worker[2] = PIPE_INIT;
+    int from_worker[2] = PIPE_INIT;
+    pid_t pid;
+    errno_t ret;
+
+    worker = talloc_zero(pool, struct proxy_worker);
+    if (worker == NULL) {
+        return ENOMEM;
+    }
+    worker->pool = pool;
+    worker->req_fd = -1;
+    worker->res_fd = -1;
+    /* not in the list yet */
+    worker->retired = true;
+    talloc_set_destructor(worker, proxy_worker_destructor);
+
+    /* the ends must not leak into other children exec'd by sssd_be */
+    ret = pipe2(to_worker, O_CLOEXEC);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "pipe (to) failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+    ret = pipe2(from_worker, O_CLOEXEC);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "pipe (from) failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+
+    pid = fork();
+    if (pid == 0) { /* child */
+        PIPE_FD_CLOSE(to_worker[1]);
+        PIPE_FD_CLOSE(from_worker[0]);
+        proxy_worker_child_setup(pool);
+        proxy_worker_main(pool->ops, to_worker[0], from_worker[1]);
+        /* not reached */
+    } else if (pid == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "fork failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+
+    worker->pid = pid;
+    worker->req_fd = to_worker[1];
+    to_worker[1] = -1;
+    worker->res_fd = from_worker[0];
+    from_worker[0] = -1;
+
+    ret = child_handler_setup(pool->ev, pid, proxy_worker_exited, worker,
+                              &worker->child_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Could not set up child signal handler\n");
+        (void)kill(pid, SIGKILL);
+        goto done;
+    }
+
+    ret = sss_fd_nonblocking(worker->res_fd);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    worker->fde = tevent_add_fd(pool->ev, worker, worker->res_fd,
+                                TEVENT_FD_READ, proxy_worker_readable,
+                                worker);
+    if (worker->fde == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Started proxy worker [%d].\n", pid);
+
+    worker->retired = false;
+    DLIST_ADD_END(pool->workers, worker, struct proxy_worker *);
+    pool->num_workers++;
+    *_worker = worker;
+
+    ret = EOK;
+
+done:
+    PIPE_CLOSE(to_worker);
+    PIPE_CLOSE(from_worker);
+    if (ret != EOK) {
+        talloc_free(worker);
+    }
+    return ret;
+}
+
+static errno_t proxy_worker_pool_get_worker(struct proxy_worker_pool *pool,
+                                            struct proxy_worker **_worker)
+{
+    struct proxy_worker *worker;
+
+    DLIST_FOR_EACH(worker, pool->workers) {
+        if (!worker->busy) {
+            *_worker = worker;
+            return EOK;
+        }
+    }
+
+    if (pool->num_workers < pool->max_workers) {
+        return proxy_worker_start(pool, _worker);
+    }
+
+    return EAGAIN;
+}
+
+static errno_t proxy_worker_submit(struct proxy_worker *worker,
+                                   struct proxy_worker_call_state *state)
+{
+    uint8_t *buf;
+    size_t len;
+    ssize_t written;
+    errno_t ret;
+
+    len = sizeof(state->hdr) + state->hdr.name_len;
+    buf = talloc_size(state, len);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+
+    memcpy(buf, &state->hdr, sizeof(state->hdr));
+    if (state->hdr.name_len > 0) {
+        memcpy(buf + sizeof(state->hdr), state->name, state->hdr.name_len);
+    }
+
+    /* the pipe of an idle worker is empty and the request is small, so
+     * this does not block */
+    written = sss_atomic_write_s(worker->req_fd, buf, len);
+    ret = written == -1 ? errno : EOK;
+    talloc_free(buf);
+    if (written != len) {
+        ret = ret == EOK ? EIO : ret;
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Unable to pass the call to proxy worker [%d] [%d]: %s\n",
+              worker->pid, ret, sss_strerror(ret));
+        proxy_worker_retire(worker, EIO);
+        return ret;
+    }
+
+    worker->busy = true;
+    worker->call = state;
+    state->worker = worker;
+    return EOK;
+}
+
+static void proxy_worker_pool_dispatch(struct proxy_worker_pool *pool)
+{
+    struct proxy_worker_call_state *state;
+    struct proxy_worker *worker;
+    errno_t ret;
+
+    while (pool->queue != NULL) {
+        ret = proxy_worker_pool_get_worker(pool, &worker);
+        if (ret == EAGAIN) {
+            return;
+        }
+
+        state = pool->queue;
+        DLIST_REMOVE(pool->queue, state);
+        state->queued = false;
+
+        if (ret == EOK) {
+            ret = proxy_worker_submit(worker, state);
+        }
+        if (ret != EOK) {
+            proxy_worker_call_finish(state, ret);
+        }
+    }
+}
+
+static int proxy_worker_pool_destructor(struct proxy_worker_pool *pool)
+{
+    struct proxy_worker_call_state *state;
+
+    while ((state = pool->queue) != NULL) {
+        DLIST_REMOVE(pool->queue, state);
+        state->queued = false;
+        state->pool = NULL;
+    }
+
+    return 0;
+}
+
+errno_t proxy_worker_pool_init(TALLOC_CTX *mem_ctx,
+                               struct tevent_context *ev,
+                               struct sss_nss_ops *ops,
+                               int max_workers,
+                               struct proxy_worker_pool **_pool)
+{
+    struct proxy_worker_pool *pool;
+
+    if (max_workers < 1) {
+        return EINVAL;
+    }
+
+    pool = talloc_zero(mem_ctx, struct proxy_worker_pool);
+    if (pool == NULL) {
+        return ENOMEM;
+    }
+
+    pool->ev = ev;
+    pool->ops = ops;
+    pool->max_workers = max_workers;
+    talloc_set_destructor(pool, proxy_worker_pool_destructor);
+
+    *_pool = pool;
+    return EOK;
+}
+
+/* =Calls=================================================================*/
+
+static int proxy_worker_call_destructor(struct proxy_worker_call_state *state)
+{
+    if (state->queued && state->pool != NULL) {
+        DLIST_REMOVE(state->pool->queue, state);
+    }
+
+    if (state->worker != NULL) {
+        /* the worker drops the answer once it arrives */
+        state->worker->call = NULL;
+    }
+
+    return 0;
+}
+
+static struct tevent_req *
+proxy_worker_call_send(TALLOC_CTX *mem_ctx,
+                       struct tevent_context *ev,
+                       struct proxy_worker_pool *pool,
+                       enum proxy_worker_call call,
+                       uint32_t id,
+                       const char *name)
+{
+    struct proxy_worker_call_state *state;
+    struct proxy_worker *worker;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct proxy_worker_call_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->req = req;
+    state->pool = pool;
+    state->hdr.call = call;
+    state->hdr.id = id;
+    talloc_set_destructor(state, proxy_worker_call_destructor);
+
+    if (name != NULL) {
+        if (strlen(name) + 1 > PROXY_WORKER_MAX_NAME) {
+            ret = EINVAL;
+            goto done;
+        }
+
+        state->name = talloc_strdup(state, name);
+        if (state->name == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        state->hdr.name_len = strlen(name) + 1;
+    }
+
+    ret = EAGAIN;
+    if (pool->queue == NULL) {
+        ret = proxy_worker_pool_get_worker(pool, &worker);
+        if (ret == EOK) {
+            ret = proxy_worker_submit(worker, state);
+        }
+    }
+
+    if (ret == EAGAIN) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "All proxy workers are busy, queueing the call.\n");
+        DLIST_ADD_END(pool->queue, state, struct proxy_worker_call_state *);
+        state->queued = true;
+        ret = EOK;
+    }
+
+done:
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+struct tevent_req *proxy_worker_getpwnam_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              const char *name)
+{
+    return proxy_worker_call_send(mem_ctx, ev, pool, PROXY_WORKER_GETPWNAM,
+                                  0, name);
+}
+
+struct tevent_req *proxy_worker_getpwuid_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              uid_t uid)
+{
+    return proxy_worker_call_send(mem_ctx, ev, pool, PROXY_WORKER_GETPWUID,
+                                  uid, NULL);
+}
+
+struct tevent_req *proxy_worker_getgrnam_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              const char *name)
+{
+    return proxy_worker_call_send(mem_ctx, ev, pool, PROXY_WORKER_GETGRNAM,
+                                  0, name);
+}
+
+struct tevent_req *proxy_worker_getgrgid_send(TALLOC_CTX *mem_ctx,
+                                              struct tevent_context *ev,
+                                              struct proxy_worker_pool *pool,
+                                              gid_t gid)
+{
+    return proxy_worker_call_send(mem_ctx, ev, pool, PROXY_WORKER_GETGRGID,
+                                  gid, NULL);
+}
+
+struct tevent_req *
+proxy_worker_initgroups_send(TALLOC_CTX *mem_ctx,
+                             struct tevent_context *ev,
+                             struct proxy_worker_pool *pool,
+                             const char *name,
+                             gid_t gid)
+{
+    return proxy_worker_call_send(mem_ctx, ev, pool, PROXY_WORKER_INITGROUPS,
+                                  gid, name);
+}
+
+static errno_t proxy_worker_unpack_str(TALLOC_CTX *mem_ctx,
+                                       uint8_t *buf, size_t len, size_t *p,
+                                       char **_str)
+{
+    uint8_t *end;
+    size_t slen;
+
+    if (*p >= len) {
+        return EINVAL;
+    }
+
+    end = memchr(&buf[*p], '\0', len - *p);
+    if (end == NULL) {
+        return EINVAL;
+    }
+    slen = end - &buf[*p];
+
+    *_str = talloc_strndup(mem_ctx, (const char *)&buf[*p], slen);
+    if (*_str == NULL) {
+        return ENOMEM;
+    }
+
+    *p += slen + 1;
+    return EOK;
+}
+
+static errno_t proxy_worker_unpack_passwd(TALLOC_CTX *mem_ctx,
+                                          uint8_t *buf, size_t len,
+                                          struct passwd *pwd)
+{
+    uint32_t value;
+    size_t p = 0;
+    errno_t ret;
+
+    SAFEALIGN_COPY_UINT32_CHECK(&value, &buf[p], len, &p);
+    pwd->pw_uid = value;
+    SAFEALIGN_COPY_UINT32_CHECK(&value, &buf[p], len, &p);
+    pwd->pw_gid = value;
+
+    ret = proxy_worker_unpack_str(mem_ctx, buf, len, &p, &pwd->pw_name);
+    if (ret != EOK) {
+        return ret;
+    }
+    ret = proxy_worker_unpack_str(mem_ctx, buf, len, &p, &pwd->pw_passwd);
+    if (ret != EOK) {
+        return ret;
+    }
+    ret = proxy_worker_unpack_str(mem_ctx, buf, len, &p, &pwd->pw_gecos);
+    if (ret != EOK) {
+        return ret;
+    }
+    ret = proxy_worker_unpack_str(mem_ctx, buf, len, &p, &pwd->pw_dir);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return proxy_worker_unpack_str(mem_ctx, buf, len, &p, &pwd->pw_shell);
+}
+
+static errno_t proxy_worker_unpack_group(TALLOC_CTX *mem_ctx,
+                                         uint8_t *buf, size_t len,
+                                         struct group *grp)
+{
+    uint32_t value;
+    uint32_t num_mem;
+    size_t p = 0;
+    size_t i;
+    errno_t ret;
+
+    SAFEALIGN_COPY_UINT32_CHECK(&value, &buf[p], len, &p);
+    grp->gr_gid = value;
+    SAFEALIGN_COPY_UINT32_CHECK(&num_mem, &buf[p], len, &p);
+
+    /* every member takes at least its terminating NUL */
+    if (num_mem > len) {
+        return EINVAL;
+    }
+
+    ret = proxy_worker_unpack_str(mem_ctx, buf, len, &p, &grp->gr_name);
+    if (ret != EOK) {
+        return ret;
+    }
+    ret = proxy_worker_unpack_str(mem_ctx, buf, len, &p, &grp->gr_passwd);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    grp->gr_mem = talloc_zero_array(mem_ctx, char *, num_mem + 1);
+    if (grp->gr_mem == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_mem; i++) {
+        ret = proxy_worker_unpack_str(grp->gr_mem, buf, len, &p,
+                                      &grp->gr_mem[i]);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    return EOK;
+}
+
+errno_t proxy_worker_getpw_recv(TALLOC_CTX *mem_ctx,
+                                struct tevent_req *req,
+                                enum nss_status *_status,
+                                struct passwd **_pwd)
+{
+    struct proxy_worker_call_state *state;
+    struct passwd *pwd;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct proxy_worker_call_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    pwd = talloc_zero(mem_ctx, struct passwd);
+    if (pwd == NULL) {
+        return ENOMEM;
+    }
+
+    if (state->status == NSS_STATUS_SUCCESS) {
+        ret = proxy_worker_unpack_passwd(pwd, state->payload, state->len,
+                                         pwd);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Malformed passwd entry from worker\n");
+            talloc_free(pwd);
+            return ret;
+        }
+    }
+
+    *_status = state->status;
+    *_pwd = pwd;
+    return EOK;
+}
+
+errno_t proxy_worker_getgr_recv(TALLOC_CTX *mem_ctx,
+                                struct tevent_req *req,
+                                enum nss_status *_status,
+                                struct group **_grp)
+{
+    struct proxy_worker_call_state *state;
+    struct group *grp;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct proxy_worker_call_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    grp = talloc_zero(mem_ctx, struct group);
+    if (grp == NULL) {
+        return ENOMEM;
+    }
+
+    if (state->status == NSS_STATUS_SUCCESS) {
+        ret = proxy_worker_unpack_group(grp, state->payload, state->len,
+                                        grp);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Malformed group entry from worker\n");
+            talloc_free(grp);
+            return ret;
+        }
+    }
+
+    *_status = state->status;
+    *_grp = grp;
+    return EOK;
+}
+
+errno_t proxy_worker_initgroups_recv(TALLOC_CTX *mem_ctx,
+                                     struct tevent_req *req,
+                                     enum nss_status *_status,
+                                     int *_err,
+                                     size_t *_num_gids,
+                                     gid_t **_gids)
+{
+    struct proxy_worker_call_state *state;
+    uint32_t num_gids = 0;
+    uint32_t value;
+    gid_t *gids = NULL;
+    size_t p = 0;
+    size_t i;
+
+    state = tevent_req_data(req, struct proxy_worker_call_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    if (state->len > 0) {
+        SAFEALIGN_COPY_UINT32_CHECK(&num_gids, &state->payload[p],
+                                    state->len, &p);
+        if (num_gids > (state->len - p) / sizeof(uint32_t)) {
+            return EINVAL;
+        }
+
+        gids = talloc_array(mem_ctx, gid_t, num_gids);
+        if (gids == NULL) {
+            return ENOMEM;
+        }
+
+        for (i = 0; i < num_gids; i++) {
+            SAFEALIGN_COPY_UINT32(&value, &state->payload[p], &p);
+            gids[i] = value;
+        }
+    }
+
+    *_status = state->status;
+    *_err = state->err;
+    *_num_gids = num_gids;
+    *_gids = gids;
+    return EOK;
+}
@@ -33,6 +33,8 @@
 #define CONFDB_SIMPLE_ALLOW_GROUPS "simple_allow_groups"
 #define CONFDB_SIMPLE_DENY_GROUPS "simple_deny_groups"
 
+#define CONFDB_SIMPLE_ACCESS_CACHE_TIMEOUT "simple_access_cache_timeout"
+
 #define TIMEOUT_OF_REFRESH_FILTER_LISTS 5
 
 static errno_t simple_access_parse_names(TALLOC_CTX *mem_ctx,
@@ -108,6 +110,28 @@ done:
     return ret;
 }
 
+static char *simple_access_rules(TALLOC_CTX *mem_ctx, struct simple_ctx *ctx)
+{
+    char **lists[] = {ctx->allow_users, ctx->deny_users,
+                      ctx->allow_groups, ctx->deny_groups};
+    char *rules;
+    size_t i;
+    size_t j;
+
+    rules = talloc_strdup(mem_ctx, "");
+    for (i = 0; i < sizeof(lists) / sizeof(lists[0]) && rules != NULL; i++) {
+        for (j = 0; lists[i] != NULL && lists[i][j] != NULL; j++) {
+            rules = talloc_asprintf_append_buffer(rules, "%s,", lists[i][j]);
+            if (rules == NULL) {
+                return NULL;
+            }
+        }
+        rules = talloc_strdup_append_buffer(rules, ";");
+    }
+
+    return rules;
+}
+
 int simple_access_obtain_filter_lists(struct simple_ctx *ctx)
 {
     struct be_ctx *bectx = ctx->be_ctx;
@@ -165,6 +189,12 @@ int simple_access_obtain_filter_lists(struct simple_ctx *ctx)
     talloc_free(ctx->deny_groups);
     ctx->deny_groups = talloc_steal(ctx, lists[3].ctx_list);
 
+    talloc_free(ctx->rules);
+    ctx->rules = simple_access_rules(ctx, ctx);
+    if (ctx->rules == NULL) {
+        return ENOMEM;
+    }
+
     if (!ctx->allow_users &&
             !ctx->allow_groups &&
             !ctx->deny_users &&
@@ -185,7 +215,140 @@ failed:
     return ret;
 }
 
+static errno_t simple_access_user_state(struct simple_ctx *ctx,
+                                        const char *username,
+                                        uint32_t *_state)
+{
+    const char *attrs[] = {SYSDB_ORIG_MODSTAMP, SYSDB_MEMBEROF, NULL};
+    struct sss_domain_info *domain;
+    struct ldb_message *msg;
+    errno_t ret;
+
+    domain = find_domain_by_object_name(ctx->domain, username);
+    if (domain == NULL) {
+        return ERR_DOMAIN_NOT_FOUND;
+    }
+
+    ret = sysdb_search_user_by_name(NULL, domain, username, attrs, &msg);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    *_state = be_access_cache_user_state(msg, ctx->rules);
+    talloc_free(msg);
+
+    return EOK;
+}
+
+static void simple_access_cache_add(struct simple_ctx *ctx,
+                                    const char *username,
+                                    bool access_granted)
+{
+    uint32_t user_state;
+    errno_t ret;
+
+    if (ctx->cache == NULL) {
+        return;
+    }
+
+    /* the check may have updated the group memberships of the user */
+    ret = simple_access_user_state(ctx, username, &user_state);
+    if (ret == EOK) {
+        ret = be_access_cache_add(ctx->cache, username, user_state,
+                                  access_granted);
+    }
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Failed to cache the access decision of [%s] [%d]: %s\n",
+              username, ret, sss_strerror(ret));
+    }
+}
+
+struct simple_access_refresh_state {
+    struct simple_ctx *ctx;
+    char *username;
+};
+
+static void simple_access_refresh_done(struct tevent_req *subreq)
+{
+    struct simple_access_refresh_state *state;
+    bool access_granted;
+    errno_t ret;
+
+    state = tevent_req_callback_data(subreq,
+                                     struct simple_access_refresh_state);
+
+    ret = simple_access_check_recv(subreq, &access_granted);
+    if (ret == EOK) {
+        simple_access_cache_add(state->ctx, state->username, access_granted);
+    }
+
+    talloc_free(state);
+}
+
+/* Checks the access of the user again for the next sessions of the user
+ * while the current one continues with the cached decision */
+static void simple_access_refresh(struct tevent_context *ev,
+                                  struct simple_ctx *ctx,
+                                  const char *username)
+{
+    struct simple_access_refresh_state *state;
+    struct tevent_req *subreq;
+
+    state = talloc_zero(ctx, struct simple_access_refresh_state);
+    if (state == NULL) {
+        return;
+    }
+    state->ctx = ctx;
+
+    state->username = talloc_strdup(state, username);
+    if (state->username == NULL) {
+        talloc_free(state);
+        return;
+    }
+
+    subreq = simple_access_check_send(state, ev, ctx, state->username);
+    if (subreq == NULL) {
+        talloc_free(state);
+        return;
+    }
+    tevent_req_set_callback(subreq, simple_access_refresh_done, state);
+}
+
+/* Returns EOK and the recent decision for the user if it is cached */
+static errno_t simple_access_cached(struct tevent_context *ev,
+                                    struct simple_ctx *ctx,
+                                    const char *username,
+                                    bool *_access_granted)
+{
+    uint32_t user_state;
+    bool refresh;
+    errno_t ret;
+
+    if (ctx->cache == NULL) {
+        return ENOENT;
+    }
+
+    ret = simple_access_user_state(ctx, username, &user_state);
+    if (ret != EOK) {
+        return ENOENT;
+    }
+
+    ret = be_access_cache_check(ctx->cache, username, user_state,
+                                _access_granted, &refresh);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (refresh) {
+        simple_access_refresh(ev, ctx, username);
+    }
+
+    return EOK;
+}
+
 struct simple_access_handler_state {
+    struct simple_ctx *ctx;
     struct pam_data *pd;
 };
 
@@ -200,6 +363,7 @@ simple_access_handler_send(TALLOC_CTX *mem_ctx,
     struct simple_access_handler_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
+    bool access_granted;
     errno_t ret;
     time_t now;
 
@@ -210,6 +374,7 @@ simple_access_handler_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
+    state->ctx = simple_ctx;
     state->pd = pd;
 
     pd->pam_status = PAM_SYSTEM_ERR;
@@ -234,6 +399,13 @@ simple_access_handler_send(TALLOC_CTX *mem_ctx,
         simple_ctx->last_refresh_of_filter_lists = now;
     }
 
+    ret = simple_access_cached(params->ev, simple_ctx, pd->user,
+                               &access_granted);
+    if (ret == EOK) {
+        pd->pam_status = access_granted ? PAM_SUCCESS : PAM_PERM_DENIED;
+        goto immediately;
+    }
+
     subreq = simple_access_check_send(state, params->ev, simple_ctx, pd->user);
     if (subreq == NULL) {
         pd->pam_status = PAM_SYSTEM_ERR;
@@ -269,6 +441,8 @@ static void simple_access_handler_done(struct tevent_req *subreq)
         goto done;
     }
 
+    simple_access_cache_add(state->ctx, state->pd->user, access_granted);
+
     if (access_granted) {
         state->pd->pam_status = PAM_SUCCESS;
     } else {
@@ -304,6 +478,7 @@ errno_t sssm_simple_access_init(TALLOC_CTX *mem_ctx,
     struct simple_ctx *ctx;
     int ret;
     int i;
+    int cache_timeout;
     char *simple_list_values = NULL;
     const char *simple_access_lists[] = {CONFDB_SIMPLE_ALLOW_USERS,
                                          CONFDB_SIMPLE_DENY_USERS,
@@ -338,6 +513,19 @@ errno_t sssm_simple_access_init(TALLOC_CTX *mem_ctx,
     ctx->be_ctx = be_ctx;
     ctx->last_refresh_of_filter_lists = 0;
 
+    ret = confdb_get_int(be_ctx->cdb, be_ctx->conf_path,
+                         CONFDB_SIMPLE_ACCESS_CACHE_TIMEOUT, 0,
+                         &cache_timeout);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "confdb_get_int failed.\n");
+        return ret;
+    }
+
+    ret = be_access_cache_init(ctx, cache_timeout, &ctx->cache);
+    if (ret != EOK) {
+        return ret;
+    }
+
     dp_set_method(dp_methods, DPM_ACCESS_HANDLER,
                   simple_access_handler_send, simple_access_handler_recv, ctx,
                   struct simple_ctx, struct pam_data, struct pam_data *);
@@ -23,6 +23,7 @@
 #define __SIMPLE_ACCESS_H__
 
 #include "util/util.h"
+#include "providers/be_access_cache.h"
 
 struct simple_ctx {
     struct sss_domain_info *domain;
@@ -32,8 +33,11 @@ struct simple_ctx {
     char **deny_users;
     char **allow_groups;
     char **deny_groups;
+    /* all lists in one string, a change of it invalidates the cache */
+    char *rules;
 
     time_t last_refresh_of_filter_lists;
+    struct be_access_cache *cache;
 };
 
 struct tevent_req *simple_access_check_send(TALLOC_CTX *mem_ctx,
@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <Python.h>
+#include <stdbool.h>
 
 #include "util/sss_python.h"
 #include "sss_client/idmap/sss_nss_idmap.h"
@@ -125,7 +126,9 @@ static int do_getsidbyname(PyObject *py_result, PyObject *py_name)
         return EINVAL;
     }
 
-    ret = sss_nss_getsidbyname(name, &sid, &id_type);
+    Py_BEGIN_ALLOW_THREADS
+        ret = sss_nss_getsidbyname(name, &sid, &id_type);
+    Py_END_ALLOW_THREADS
     if (ret == 0) {
         ret = add_dict(py_result, py_name, PyUnicode_FromString(SSS_SID_KEY),
                        PyUnicode_FromString(sid), PYNUMBER_FROMLONG(id_type));
@@ -147,7 +150,9 @@ static int do_getnamebysid(PyObject *py_result, PyObject *py_sid)
         return EINVAL;
     }
 
-    ret = sss_nss_getnamebysid(sid, &name, &id_type);
+    Py_BEGIN_ALLOW_THREADS
+        ret = sss_nss_getnamebysid(sid, &name, &id_type);
+    Py_END_ALLOW_THREADS
     if (ret == 0) {
         ret = add_dict(py_result, py_sid, PyUnicode_FromString(SSS_NAME_KEY),
                        PyUnicode_FromString(name), PYNUMBER_FROMLONG(id_type));
@@ -157,15 +162,24 @@ static int do_getnamebysid(PyObject *py_result, PyObject *py_sid)
     return ret;
 }
 
-static int do_getsidbyid(enum lookup_type type, PyObject *py_result,
-                         PyObject *py_id)
+static PyObject *py_string_or_unicode_as_bytes(PyObject *inp)
+{
+    if (PyUnicode_Check(inp)) {
+        return PyUnicode_AsUTF8String(inp);
+    } else if (PyBytes_Check(inp)) {
+        Py_INCREF(inp);
+        return inp;
+    }
+
+    PyErr_Format(PyExc_TypeError, "input must be unicode or a string");
+    return NULL;
+}
+
+static int py_id_as_uint32(PyObject *py_id, uint32_t *_id)
 {
     long id;
     const char *id_str;
     char *endptr;
-    char *sid = NULL;
-    int ret;
-    enum sss_id_type id_type;
 
 #ifndef IS_PY3K
     if (PyInt_Check(py_id)) {
@@ -190,18 +204,41 @@ static int do_getsidbyid(enum lookup_type type, PyObject *py_result,
         return EINVAL;
     }
 
+    *_id = (uint32_t) id;
+    return 0;
+}
+
+static int do_getsidbyid(enum lookup_type type, PyObject *py_result,
+                         PyObject *py_id)
+{
+    uint32_t id;
+    char *sid = NULL;
+    int ret;
+    enum sss_id_type id_type;
+
+    ret = py_id_as_uint32(py_id, &id);
+    if (ret != 0) {
+        return ret;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
     switch (type) {
     case SIDBYID:
-        ret = sss_nss_getsidbyid((uint32_t) id, &sid, &id_type);
+        ret = sss_nss_getsidbyid(id, &sid, &id_type);
         break;
     case SIDBYUID:
-        ret = sss_nss_getsidbyuid((uint32_t) id, &sid, &id_type);
+        ret = sss_nss_getsidbyuid(id, &sid, &id_type);
         break;
     case SIDBYGID:
-        ret = sss_nss_getsidbygid((uint32_t) id, &sid, &id_type);
+        ret = sss_nss_getsidbygid(id, &sid, &id_type);
         break;
     default:
-        return EINVAL;
+        ret = EINVAL;
+        break;
+    }
+    Py_END_ALLOW_THREADS
+    if (ret == EINVAL) {
+        return ret;
     }
     if (ret == 0) {
         ret = add_dict(py_result, py_id, PyUnicode_FromString(SSS_SID_KEY),
@@ -224,7 +261,9 @@ static int do_getnamebycert(PyObject *py_result, PyObject *py_cert)
         return EINVAL;
     }
 
-    ret = sss_nss_getnamebycert(cert, &name, &id_type);
+    Py_BEGIN_ALLOW_THREADS
+        ret = sss_nss_getnamebycert(cert, &name, &id_type);
+    Py_END_ALLOW_THREADS
     if (ret == 0) {
         ret = add_dict(py_result, py_cert, PyUnicode_FromString(SSS_NAME_KEY),
                        PyUnicode_FromString(name), PYNUMBER_FROMLONG(id_type));
@@ -247,7 +286,9 @@ static int do_getlistbycert(PyObject *py_result, PyObject *py_cert)
         return EINVAL;
     }
 
-    ret = sss_nss_getlistbycert(cert, &names, &id_types);
+    Py_BEGIN_ALLOW_THREADS
+        ret = sss_nss_getlistbycert(cert, &names, &id_types);
+    Py_END_ALLOW_THREADS
     if (ret == 0) {
 
         PyObject *py_list;
@@ -297,7 +338,9 @@ static int do_getidbysid(PyObject *py_result, PyObject *py_sid)
         return EINVAL;
     }
 
-    ret = sss_nss_getidbysid(sid, &id, &id_type);
+    Py_BEGIN_ALLOW_THREADS
+        ret = sss_nss_getidbysid(sid, &id, &id_type);
+    Py_END_ALLOW_THREADS
     if (ret == 0) {
         ret = add_dict(py_result, py_sid, PyUnicode_FromString(SSS_ID_KEY),
                        PYNUMBER_FROMLONG(id), PYNUMBER_FROMLONG(id_type));
@@ -337,6 +380,179 @@ static int do_lookup(enum lookup_type type, PyObject *py_result,
     return ENOSYS;
 }
 
+/* Looks up all elements of a list or tuple with the batch requests of
+ * libsss_nss_idmap, i.e. with one request per SSS_NSS_MULTI_MAX_IDS elements
+ * instead of one per element. Elements of the wrong type are skipped like
+ * in the loop of check_args(). */
+static int do_lookup_multi(enum lookup_type type, PyObject *py_result,
+                           PyObject *py_inp)
+{
+    PyObject *py_seq;
+    PyObject *py_value;
+    PyObject **py_keys = NULL;
+    PyObject **py_bytes = NULL;
+    const char **keys = NULL;
+    uint32_t *ids = NULL;
+    enum sss_id_type *id_types = NULL;
+    char **strs = NULL;
+    uint32_t *res_ids = NULL;
+    enum sss_id_type *types = NULL;
+    const char *res_key;
+    Py_ssize_t len;
+    Py_ssize_t i;
+    size_t count = 0;
+    size_t c;
+    bool by_id;
+    int ret;
+
+    by_id = (type == SIDBYID || type == SIDBYUID || type == SIDBYGID);
+
+    py_seq = PySequence_Fast(py_inp, "input must be a list or a tuple");
+    if (py_seq == NULL) {
+        return EINVAL;
+    }
+
+    len = PySequence_Fast_GET_SIZE(py_seq);
+    if (len == 0) {
+        ret = 0;
+        goto done;
+    }
+
+    py_keys = calloc(len, sizeof(PyObject *));
+    py_bytes = calloc(len, sizeof(PyObject *));
+    keys = calloc(len, sizeof(char *));
+    ids = calloc(len, sizeof(uint32_t));
+    id_types = calloc(len, sizeof(enum sss_id_type));
+    if (py_keys == NULL || py_bytes == NULL || keys == NULL || ids == NULL
+            || id_types == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < len; i++) {
+        py_value = PySequence_Fast_GET_ITEM(py_seq, i);
+
+        if (by_id) {
+            if (!(PyBytes_Check(py_value) || PyUnicode_Check(py_value)
+                    || PYNUMBER_CHECK(py_value))
+                    || py_id_as_uint32(py_value, &ids[count]) != 0) {
+                PyErr_Clear();
+                continue;
+            }
+
+            if (type == SIDBYUID) {
+                id_types[count] = SSS_ID_TYPE_UID;
+            } else if (type == SIDBYGID) {
+                id_types[count] = SSS_ID_TYPE_GID;
+            } else {
+                id_types[count] = SSS_ID_TYPE_NOT_SPECIFIED;
+            }
+        } else {
+            py_bytes[count] = py_string_or_unicode_as_bytes(py_value);
+            if (py_bytes[count] == NULL) {
+                PyErr_Clear();
+                continue;
+            }
+
+            keys[count] = PyBytes_AS_STRING(py_bytes[count]);
+            if (keys[count][0] == '\0') {
+                Py_CLEAR(py_bytes[count]);
+                continue;
+            }
+        }
+
+        py_keys[count] = py_value;
+        count++;
+    }
+
+    if (count == 0) {
+        ret = 0;
+        goto done;
+    }
+
+    /* The lookups do not need the interpreter, other threads can run while
+     * waiting for SSSD. */
+    Py_BEGIN_ALLOW_THREADS
+    switch (type) {
+    case SIDBYNAME:
+        ret = sss_nss_getsidbyname_multi(keys, count, &strs, &types);
+        break;
+    case NAMEBYSID:
+        ret = sss_nss_getnamebysid_multi(keys, count, &strs, &types);
+        break;
+    case IDBYSID:
+        ret = sss_nss_getidbysid_multi(keys, count, &res_ids, &types);
+        break;
+    case SIDBYID:
+    case SIDBYUID:
+    case SIDBYGID:
+        ret = sss_nss_getsidbyid_multi(ids, id_types, count, &strs, &types);
+        break;
+    default:
+        ret = ENOSYS;
+        break;
+    }
+    Py_END_ALLOW_THREADS
+    if (ret != 0) {
+        goto done;
+    }
+
+    if (type == NAMEBYSID) {
+        res_key = SSS_NAME_KEY;
+    } else if (type == IDBYSID) {
+        res_key = SSS_ID_KEY;
+    } else {
+        res_key = SSS_SID_KEY;
+    }
+
+    for (c = 0; c < count; c++) {
+        if (type == IDBYSID) {
+            if (types[c] == SSS_ID_TYPE_NOT_SPECIFIED) {
+                continue;
+            }
+            ret = add_dict(py_result, py_keys[c], PyUnicode_FromString(res_key),
+                           PYNUMBER_FROMLONG(res_ids[c]),
+                           PYNUMBER_FROMLONG(types[c]));
+        } else {
+            if (strs[c] == NULL) {
+                continue;
+            }
+            ret = add_dict(py_result, py_keys[c], PyUnicode_FromString(res_key),
+                           PyUnicode_FromString(strs[c]),
+                           PYNUMBER_FROMLONG(types[c]));
+        }
+        if (ret != 0) {
+            goto done;
+        }
+    }
+
+    ret = 0;
+
+done:
+    if (strs != NULL) {
+        for (c = 0; c < count; c++) {
+            free(strs[c]);
+        }
+        free(strs);
+    }
+    free(res_ids);
+    free(types);
+
+    if (py_bytes != NULL) {
+        for (c = 0; c < count; c++) {
+            Py_XDECREF(py_bytes[c]);
+        }
+        free(py_bytes);
+    }
+    free(py_keys);
+    free(keys);
+    free(ids);
+    free(id_types);
+    Py_DECREF(py_seq);
+
+    return ret;
+}
+
 static PyObject *check_args(enum lookup_type type, PyObject *args)
 {
     PyObject *obj, *py_value;
@@ -369,6 +585,17 @@ static PyObject *check_args(enum lookup_type type, PyObject *args)
     }
 
     if (PyList_Check(obj) || PyTuple_Check(obj)) {
+        if (type != NAMEBYCERT && type != LISTBYCERT) {
+            ret = do_lookup_multi(type, py_result, obj);
+            if (ret == 0) {
+                Py_XDECREF(py_result);
+                return py_result;
+            }
+            /* e.g. SSSD does not know the batch requests yet, look up the
+             * elements one by one */
+            PyErr_Clear();
+        }
+
         len = PySequence_Size(obj);
         for(i=0; i < len; i++) {
             py_value = PySequence_GetItem(obj, i);
@@ -56,9 +56,21 @@
                           ((unsigned int)((unsigned char)(p)[2]) <<  8U) | \
                           ((unsigned int)((unsigned char)(p)[3]))))
 
+#define DNS_HEADER_QDCOUNT(h)           DNS__16BIT((h) + 4)
 #define DNS_HEADER_ANCOUNT(h)           DNS__16BIT((h) + 6)
+#define DNS_HEADER_NSCOUNT(h)           DNS__16BIT((h) + 8)
+#define DNS_RR_TYPE(r)                  DNS__16BIT(r)
 #define DNS_RR_LEN(r)                   DNS__16BIT((r) + 8)
 #define DNS_RR_TTL(r)                   DNS__32BIT((r) + 4)
+/* MINIMUM is the last of the five 32 bit fields following the names */
+#define DNS_SOA_MINIMUM(r)              DNS__32BIT((r) + 16)
+
+/* Negative TTL of failed host name lookups without a SOA record in the
+ * answer, and the upper limit of negative TTLs in general */
+#define RESOLV_CACHE_NEG_TTL            30
+#define RESOLV_CACHE_NEG_TTL_MAX        300
+/* Log the cache statistics after this many lookups */
+#define RESOLV_CACHE_STATS_INTERVAL     1000
 
 enum host_database default_host_dbs[] = { DB_FILES, DB_DNS, DB_SENTINEL };
 
@@ -88,6 +100,9 @@ struct resolv_ctx {
      * if our pending requests didn't timeout. */
     int pending_requests;
     struct tevent_timer *timeout_watcher;
+
+    /* Cache of host name lookups, NULL if disabled */
+    struct resolv_cache *cache;
 };
 
 struct request_watch {
@@ -489,6 +504,7 @@ void
 resolv_reread_configuration(struct resolv_ctx *ctx)
 {
     recreate_ares_channel(ctx);
+    resolv_cache_flush(ctx);
 }
 
 static errno_t
@@ -755,6 +771,101 @@ resolv_gethostbyname_files_recv(struct tevent_req *req, TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+/*
+ * Read the negative caching TTL of a failed query, defined by RFC 2308 as
+ * the smaller of the TTL of the SOA record in the authority section and
+ * its MINIMUM field.
+ *
+ * Returns false if the answer does not contain a SOA record.
+ */
+static bool
+resolv_get_negative_ttl(const unsigned char *abuf, const int alen,
+                        uint32_t *_ttl)
+{
+    const unsigned char *aptr;
+    const unsigned char *rdata;
+    char *name = NULL;
+    unsigned int qdcount;
+    unsigned int ancount;
+    unsigned int nscount;
+    unsigned int rr_len;
+    unsigned int i;
+    long len;
+    int ret;
+
+    if (abuf == NULL || alen < NS_HFIXEDSZ) {
+        return false;
+    }
+
+    qdcount = DNS_HEADER_QDCOUNT(abuf);
+    ancount = DNS_HEADER_ANCOUNT(abuf);
+    nscount = DNS_HEADER_NSCOUNT(abuf);
+    aptr = abuf + NS_HFIXEDSZ;
+
+    /* Skip the questions */
+    for (i = 0; i < qdcount; i++) {
+        ret = ares_expand_name(aptr, abuf, alen, &name, &len);
+        ares_free_string(name);
+        if (ret != ARES_SUCCESS) {
+            return false;
+        }
+
+        aptr += len + NS_QFIXEDSZ;
+        if (aptr > abuf + alen) {
+            return false;
+        }
+    }
+
+    /* Skip the answers, e.g. the CNAME of a name without this record, and
+     * look for the SOA record in the authority section */
+    for (i = 0; i < ancount + nscount; i++) {
+        ret = ares_expand_name(aptr, abuf, alen, &name, &len);
+        ares_free_string(name);
+        if (ret != ARES_SUCCESS) {
+            return false;
+        }
+
+        aptr += len;
+        if (aptr + NS_RRFIXEDSZ > abuf + alen) {
+            return false;
+        }
+
+        rr_len = DNS_RR_LEN(aptr);
+        rdata = aptr + NS_RRFIXEDSZ;
+        if (rdata + rr_len > abuf + alen) {
+            return false;
+        }
+
+        if (i >= ancount && DNS_RR_TYPE(aptr) == ns_t_soa) {
+            /* MNAME and RNAME */
+            ret = ares_expand_name(rdata, abuf, alen, &name, &len);
+            ares_free_string(name);
+            if (ret != ARES_SUCCESS) {
+                return false;
+            }
+            rdata += len;
+
+            ret = ares_expand_name(rdata, abuf, alen, &name, &len);
+            ares_free_string(name);
+            if (ret != ARES_SUCCESS) {
+                return false;
+            }
+            rdata += len;
+
+            if (rdata + 5 * sizeof(uint32_t) > aptr + NS_RRFIXEDSZ + rr_len) {
+                return false;
+            }
+
+            *_ttl = MIN(DNS_RR_TTL(aptr), DNS_SOA_MINIMUM(rdata));
+            return true;
+        }
+
+        aptr = rdata + rr_len;
+    }
+
+    return false;
+}
+
 /* ==================== Resolve host name in DNS =========================*/
 struct gethostbyname_dns_state {
     struct resolv_ctx *resolv_ctx;
@@ -766,6 +877,9 @@ struct gethostbyname_dns_state {
 
     /* query result */
     struct resolv_hostent *rhostent;
+    /* negative TTL if the name was not found, RESOLV_CACHE_NEG_TTL if the
+     * answer had none */
+    uint32_t neg_ttl;
 
     /* These are returned by ares. */
     int status;
@@ -813,6 +927,7 @@ resolv_gethostbyname_dns_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
     state->timeouts = 0;
     state->retrying = 0;
     state->family = family;
+    state->neg_ttl = RESOLV_CACHE_NEG_TTL;
 
     /* We need to have a wrapper around ares async calls, because
      * they can in some cases call it's callback immediately.
@@ -912,6 +1027,9 @@ resolv_gethostbyname_dns_query_done(void *arg, int status, int timeouts,
     if (status == ARES_ENOTFOUND || status == ARES_ENODATA) {
         /* Just say we didn't find anything and let the caller decide
          * about retrying */
+        if (!resolv_get_negative_ttl(abuf, alen, &state->neg_ttl)) {
+            state->neg_ttl = RESOLV_CACHE_NEG_TTL;
+        }
         tevent_req_error(req, ENOENT);
         return;
     }
@@ -1010,7 +1128,7 @@ fail:
 
 static int
 resolv_gethostbyname_dns_recv(struct tevent_req *req, TALLOC_CTX *mem_ctx,
-                              int *status, int *timeouts,
+                              int *status, int *timeouts, uint32_t *neg_ttl,
                               struct resolv_hostent **rhostent)
 {
     struct gethostbyname_dns_state *state = tevent_req_data(req,
@@ -1024,6 +1142,9 @@ resolv_gethostbyname_dns_recv(struct tevent_req *req, TALLOC_CTX *mem_ctx,
     if (timeouts) {
         *timeouts = state->timeouts;
     }
+    if (neg_ttl) {
+        *neg_ttl = state->neg_ttl;
+    }
 
     TEVENT_REQ_RETURN_ON_ERROR(req);
 
@@ -1059,6 +1180,8 @@ struct gethostbyname_state {
     int status;
     int timeouts;
     int retrying;
+    /* smallest negative TTL of the databases that did not know the name */
+    uint32_t neg_ttl;
 };
 
 static errno_t
@@ -1069,11 +1192,11 @@ resolv_gethostbyname_family_init(enum restrict_family family_order);
 static errno_t
 resolv_gethostbyname_step(struct tevent_req *req);
 
-struct tevent_req *
-resolv_gethostbyname_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
-                          struct resolv_ctx *ctx, const char *name,
-                          enum restrict_family family_order,
-                          enum host_database *db)
+static struct tevent_req *
+resolv_gethostbyname_query_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
+                                struct resolv_ctx *ctx, const char *name,
+                                enum restrict_family family_order,
+                                enum host_database *db)
 {
     struct tevent_req *req;
     struct gethostbyname_state *state;
@@ -1106,6 +1229,7 @@ resolv_gethostbyname_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
     state->family = resolv_gethostbyname_family_init(state->family_order);
     state->db = db;
     state->dbi = 0;
+    state->neg_ttl = RESOLV_CACHE_NEG_TTL_MAX;
 
     /* Do not attempt to resolve IP addresses */
     if (resolv_is_address(state->name)) {
@@ -1319,6 +1443,7 @@ resolv_gethostbyname_done(struct tevent_req *subreq)
                                                       struct tevent_req);
     struct gethostbyname_state *state = tevent_req_data(req,
                                                 struct gethostbyname_state);
+    uint32_t neg_ttl = RESOLV_CACHE_NEG_TTL;
     errno_t ret;
 
     switch(state->db[state->dbi]) {
@@ -1332,7 +1457,7 @@ resolv_gethostbyname_done(struct tevent_req *subreq)
         case DB_DNS:
             ret = resolv_gethostbyname_dns_recv(subreq, state,
                                                 &state->status, &state->timeouts,
-                                                &state->rhostent);
+                                                &neg_ttl, &state->rhostent);
             break;
         default:
             DEBUG(SSSDBG_CRIT_FAILURE, "Invalid hosts database\n");
@@ -1343,6 +1468,7 @@ resolv_gethostbyname_done(struct tevent_req *subreq)
     talloc_zfree(subreq);
 
     if (ret == ENOENT) {
+        state->neg_ttl = MIN(state->neg_ttl, neg_ttl);
         ret = resolv_gethostbyname_next(state);
         if (ret == EOK) {
             ret = resolv_gethostbyname_step(req);
@@ -1370,12 +1496,575 @@ resolv_gethostbyname_done(struct tevent_req *subreq)
     tevent_req_done(req);
 }
 
+static int
+resolv_gethostbyname_query_recv(struct tevent_req *req, TALLOC_CTX *mem_ctx,
+                                int *status, int *timeouts, uint32_t *neg_ttl,
+                                struct resolv_hostent **rhostent)
+{
+    struct gethostbyname_state *state = tevent_req_data(req, struct gethostbyname_state);
+
+    /* Fill in even in case of error as status contains the
+     * c-ares return code */
+    if (status) {
+        *status = state->status;
+    }
+    if (timeouts) {
+        *timeouts = state->timeouts;
+    }
+    if (neg_ttl) {
+        *neg_ttl = state->neg_ttl;
+    }
+    if (rhostent) {
+        *rhostent = talloc_steal(mem_ctx, state->rhostent);
+    }
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+/* =================== Cache of host name lookups =========================*/
+struct resolv_cache_waiter;
+
+struct resolv_cache_entry {
+    struct resolv_cache_entry *prev;
+    struct resolv_cache_entry *next;
+
+    struct resolv_cache *cache;
+    char *key;
+
+    /* The lookup in flight and the requests waiting for it */
+    struct tevent_req *lookup;
+    struct resolv_cache_waiter *waiters;
+    enum host_database *db;
+    /* The cache was flushed while the lookup was in flight, do not keep
+     * its result */
+    bool flushed;
+
+    /* The result of the lookup */
+    errno_t error;
+    int status;
+    int timeouts;
+    struct resolv_hostent *rhostent;
+    time_t created;
+    time_t expire;
+};
+
+struct resolv_cache_waiter {
+    struct resolv_cache_waiter *prev;
+    struct resolv_cache_waiter *next;
+
+    struct resolv_cache_entry *entry;
+    struct tevent_context *ev;
+    struct tevent_req *req;
+};
+
+struct resolv_cache {
+    /* Most recently used entries first */
+    struct resolv_cache_entry *entries;
+    size_t num_entries;
+    size_t max_entries;
+
+    struct resolv_cache_stats stats;
+};
+
+static int
+resolv_cache_entry_destructor(struct resolv_cache_entry *entry)
+{
+    struct resolv_cache_waiter *w;
+
+    DLIST_REMOVE(entry->cache->entries, entry);
+    entry->cache->num_entries--;
+
+    /* The requests are completed by resolv_cache_lookup_done(), just make
+     * sure they do not point to freed memory */
+    while ((w = entry->waiters) != NULL) {
+        DLIST_REMOVE(entry->waiters, w);
+        w->entry = NULL;
+    }
+
+    return 0;
+}
+
+static int
+resolv_cache_waiter_destructor(struct resolv_cache_waiter *w)
+{
+    if (w->entry != NULL) {
+        DLIST_REMOVE(w->entry->waiters, w);
+        w->entry = NULL;
+    }
+
+    return 0;
+}
+
+static void
+resolv_cache_log_stats(struct resolv_cache *cache)
+{
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "DNS cache: %zu entries, %"PRIu64" lookups, %"PRIu64" hits, "
+          "%"PRIu64" negative hits, %"PRIu64" coalesced, %"PRIu64" misses\n",
+          cache->num_entries, cache->stats.lookups, cache->stats.hits,
+          cache->stats.negative_hits, cache->stats.coalesced,
+          cache->stats.misses);
+}
+
+errno_t
+resolv_cache_init(struct resolv_ctx *ctx, size_t max_entries)
+{
+    struct resolv_cache *cache;
+
+    if (max_entries == 0) {
+        return EINVAL;
+    }
+
+    if (ctx->cache != NULL) {
+        ctx->cache->max_entries = max_entries;
+        return EOK;
+    }
+
+    cache = talloc_zero(ctx, struct resolv_cache);
+    if (cache == NULL) {
+        return ENOMEM;
+    }
+    cache->max_entries = max_entries;
+    ctx->cache = cache;
+
+    DEBUG(SSSDBG_CONF_SETTINGS,
+          "Caching up to %zu host name lookups\n", max_entries);
+    return EOK;
+}
+
+void
+resolv_cache_flush(struct resolv_ctx *ctx)
+{
+    struct resolv_cache_entry *entry;
+    struct resolv_cache_entry *next;
+
+    if (ctx->cache == NULL) {
+        return;
+    }
+
+    resolv_cache_log_stats(ctx->cache);
+
+    for (entry = ctx->cache->entries; entry != NULL; entry = next) {
+        next = entry->next;
+        if (entry->lookup != NULL) {
+            entry->flushed = true;
+            continue;
+        }
+        talloc_free(entry);
+    }
+}
+
+void
+resolv_cache_get_stats(struct resolv_ctx *ctx,
+                       struct resolv_cache_stats *stats)
+{
+    if (ctx->cache == NULL) {
+        memset(stats, 0, sizeof(struct resolv_cache_stats));
+        return;
+    }
+
+    *stats = ctx->cache->stats;
+}
+
+static char *
+resolv_cache_key(TALLOC_CTX *mem_ctx, const char *name,
+                 enum restrict_family family_order,
+                 enum host_database *db)
+{
+    char *key;
+    int i;
+
+    key = talloc_asprintf(mem_ctx, "%d:", family_order);
+    for (i = 0; key != NULL && db[i] != DB_SENTINEL; i++) {
+        key = talloc_asprintf_append(key, "%c",
+                                     db[i] == DB_FILES ? 'f' : 'd');
+    }
+    if (key != NULL) {
+        key = talloc_asprintf_append(key, ":%s", name);
+    }
+
+    return key;
+}
+
+/* The time the addresses can be cached, which is the lowest TTL */
+static time_t
+resolv_cache_hostent_ttl(struct resolv_hostent *rhostent)
+{
+    time_t ttl = 0;
+    int i;
+
+    if (rhostent == NULL || rhostent->addr_list == NULL) {
+        return 0;
+    }
+
+    for (i = 0; rhostent->addr_list[i] != NULL; i++) {
+        if (i == 0 || rhostent->addr_list[i]->ttl < ttl) {
+            ttl = rhostent->addr_list[i]->ttl;
+        }
+    }
+
+    return ttl > 0 ? ttl : 0;
+}
+
+/* Copy a cached hostent, the TTLs count down like they would in the
+ * DNS server's cache */
+static struct resolv_hostent *
+resolv_cache_copy_hostent(TALLOC_CTX *mem_ctx, struct resolv_hostent *src,
+                          time_t elapsed)
+{
+    struct resolv_hostent *ret;
+    size_t addrlen;
+    int len;
+    int i;
+
+    ret = talloc_zero(mem_ctx, struct resolv_hostent);
+    if (ret == NULL) {
+        return NULL;
+    }
+
+    ret->family = src->family;
+    if (src->name != NULL) {
+        ret->name = talloc_strdup(ret, src->name);
+        if (ret->name == NULL) {
+            goto fail;
+        }
+    }
+
+    if (src->aliases != NULL) {
+        for (len = 0; src->aliases[len] != NULL; len++);
+
+        ret->aliases = talloc_array(ret, char *, len + 1);
+        if (ret->aliases == NULL) {
+            goto fail;
+        }
+
+        for (i = 0; i < len; i++) {
+            ret->aliases[i] = talloc_strdup(ret->aliases, src->aliases[i]);
+            if (ret->aliases[i] == NULL) {
+                goto fail;
+            }
+        }
+        ret->aliases[len] = NULL;
+    }
+
+    if (src->addr_list != NULL) {
+        addrlen = src->family == AF_INET6 ? sizeof(struct in6_addr)
+                                          : sizeof(struct in_addr);
+        for (len = 0; src->addr_list[len] != NULL; len++);
+
+        ret->addr_list = talloc_array(ret, struct resolv_addr *, len + 1);
+        if (ret->addr_list == NULL) {
+            goto fail;
+        }
+
+        for (i = 0; i < len; i++) {
+            ret->addr_list[i] = talloc_zero(ret->addr_list,
+                                            struct resolv_addr);
+            if (ret->addr_list[i] == NULL) {
+                goto fail;
+            }
+
+            ret->addr_list[i]->ipaddr = talloc_memdup(ret->addr_list[i],
+                                                      src->addr_list[i]->ipaddr,
+                                                      addrlen);
+            if (ret->addr_list[i]->ipaddr == NULL) {
+                goto fail;
+            }
+            ret->addr_list[i]->ttl = MAX(src->addr_list[i]->ttl - elapsed, 0);
+        }
+        ret->addr_list[len] = NULL;
+    }
+
+    return ret;
+
+fail:
+    talloc_free(ret);
+    return NULL;
+}
+
+struct gethostbyname_cache_state {
+    struct resolv_cache_waiter *waiter;
+
+    struct resolv_hostent *rhostent;
+    int status;
+    int timeouts;
+};
+
+/* Complete req with the result stored in the entry */
+static void
+resolv_cache_reply(struct tevent_req *req, struct resolv_cache_entry *entry,
+                   int timeouts, time_t now)
+{
+    struct gethostbyname_cache_state *state;
+
+    state = tevent_req_data(req, struct gethostbyname_cache_state);
+    state->status = entry->status;
+    state->timeouts = timeouts;
+
+    if (entry->error != EOK) {
+        tevent_req_error(req, entry->error);
+        return;
+    }
+
+    state->rhostent = resolv_cache_copy_hostent(state, entry->rhostent,
+                                                now - entry->created);
+    if (state->rhostent == NULL) {
+        tevent_req_error(req, ENOMEM);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
+/* Make room for a new entry by evicting the least recently used one
+ * that has no lookup in flight */
+static void
+resolv_cache_evict(struct resolv_cache *cache)
+{
+    struct resolv_cache_entry *entry;
+    struct resolv_cache_entry *victim = NULL;
+
+    if (cache->num_entries < cache->max_entries) {
+        return;
+    }
+
+    for (entry = cache->entries; entry != NULL; entry = entry->next) {
+        if (entry->lookup == NULL) {
+            victim = entry;
+        }
+    }
+
+    talloc_free(victim);
+}
+
+static void resolv_cache_lookup_done(struct tevent_req *subreq);
+static void resolv_gethostbyname_uncached_done(struct tevent_req *subreq);
+
+static struct resolv_cache_entry *
+resolv_cache_entry_new(struct tevent_context *ev, struct resolv_ctx *ctx,
+                       char *key, const char *name,
+                       enum restrict_family family_order,
+                       enum host_database *db)
+{
+    struct resolv_cache_entry *entry;
+    int num_db;
+
+    resolv_cache_evict(ctx->cache);
+
+    entry = talloc_zero(ctx->cache, struct resolv_cache_entry);
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->cache = ctx->cache;
+    entry->key = talloc_steal(entry, key);
+
+    /* The caller's list of databases may go away before the lookup that
+     * is shared with other callers finishes */
+    for (num_db = 0; db[num_db] != DB_SENTINEL; num_db++);
+    entry->db = talloc_memdup(entry, db,
+                              (num_db + 1) * sizeof(enum host_database));
+    if (entry->db == NULL) {
+        talloc_free(entry);
+        return NULL;
+    }
+
+    entry->lookup = resolv_gethostbyname_query_send(entry, ev, ctx, name,
+                                                    family_order, entry->db);
+    if (entry->lookup == NULL) {
+        talloc_free(entry);
+        return NULL;
+    }
+    tevent_req_set_callback(entry->lookup, resolv_cache_lookup_done, entry);
+
+    DLIST_ADD(ctx->cache->entries, entry);
+    ctx->cache->num_entries++;
+    talloc_set_destructor(entry, resolv_cache_entry_destructor);
+
+    return entry;
+}
+
+struct tevent_req *
+resolv_gethostbyname_send(TALLOC_CTX *mem_ctx, struct tevent_context *ev,
+                          struct resolv_ctx *ctx, const char *name,
+                          enum restrict_family family_order,
+                          enum host_database *db)
+{
+    struct gethostbyname_cache_state *state;
+    struct resolv_cache_entry *entry;
+    struct resolv_cache_entry *next;
+    struct resolv_cache *cache;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    char *key = NULL;
+    time_t now;
+
+    req = tevent_req_create(mem_ctx, &state, struct gethostbyname_cache_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    cache = ctx->cache;
+    if (cache == NULL || resolv_is_address(name)) {
+        subreq = resolv_gethostbyname_query_send(state, ev, ctx, name,
+                                                 family_order, db);
+        if (subreq == NULL) {
+            goto fail;
+        }
+        tevent_req_set_callback(subreq, resolv_gethostbyname_uncached_done,
+                                req);
+        return req;
+    }
+
+    key = resolv_cache_key(state, name, family_order, db);
+    if (key == NULL) {
+        goto fail;
+    }
+
+    cache->stats.lookups++;
+    if (cache->stats.lookups % RESOLV_CACHE_STATS_INTERVAL == 0) {
+        resolv_cache_log_stats(cache);
+    }
+
+    now = time(NULL);
+    for (entry = cache->entries; entry != NULL; entry = next) {
+        next = entry->next;
+        if (strcasecmp(entry->key, key) != 0) {
+            continue;
+        }
+
+        if (entry->lookup != NULL) {
+            break;
+        }
+
+        if (entry->expire > now) {
+            DEBUG(SSSDBG_TRACE_INTERNAL, "Cache hit for [%s]\n", name);
+            if (entry->error == EOK) {
+                cache->stats.hits++;
+            } else {
+                cache->stats.negative_hits++;
+            }
+            DLIST_PROMOTE(cache->entries, entry);
+            resolv_cache_reply(req, entry, 0, now);
+            tevent_req_post(req, ev);
+            talloc_free(key);
+            return req;
+        }
+
+        /* expired */
+        talloc_free(entry);
+        entry = NULL;
+        break;
+    }
+
+    if (entry != NULL) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Waiting for the lookup of [%s] in progress\n", name);
+        cache->stats.coalesced++;
+        talloc_free(key);
+    } else {
+        cache->stats.misses++;
+        entry = resolv_cache_entry_new(ev, ctx, key, name, family_order, db);
+        if (entry == NULL) {
+            goto fail;
+        }
+    }
+
+    state->waiter = talloc_zero(state, struct resolv_cache_waiter);
+    if (state->waiter == NULL) {
+        goto fail;
+    }
+    state->waiter->entry = entry;
+    state->waiter->ev = ev;
+    state->waiter->req = req;
+    DLIST_ADD_END(entry->waiters, state->waiter, struct resolv_cache_waiter *);
+    talloc_set_destructor(state->waiter, resolv_cache_waiter_destructor);
+
+    return req;
+
+fail:
+    talloc_zfree(req);
+    return NULL;
+}
+
+static void
+resolv_cache_lookup_done(struct tevent_req *subreq)
+{
+    struct resolv_cache_entry *entry;
+    struct resolv_cache_waiter *w;
+    uint32_t neg_ttl = 0;
+    time_t now;
+
+    entry = tevent_req_callback_data(subreq, struct resolv_cache_entry);
+
+    entry->error = resolv_gethostbyname_query_recv(subreq, entry,
+                                                   &entry->status,
+                                                   &entry->timeouts,
+                                                   &neg_ttl,
+                                                   &entry->rhostent);
+    talloc_zfree(subreq);
+    entry->lookup = NULL;
+
+    now = time(NULL);
+    entry->created = now;
+    switch (entry->error) {
+    case EOK:
+        entry->expire = now + resolv_cache_hostent_ttl(entry->rhostent);
+        break;
+    case ENOENT:
+        entry->expire = now + neg_ttl;
+        break;
+    default:
+        /* Time outs and server failures are not cached */
+        entry->expire = 0;
+        break;
+    }
+
+    /* The callbacks are deferred so that they cannot free the entry
+     * while we are still using it */
+    while ((w = entry->waiters) != NULL) {
+        DLIST_REMOVE(entry->waiters, w);
+        w->entry = NULL;
+        tevent_req_defer_callback(w->req, w->ev);
+        resolv_cache_reply(w->req, entry, entry->timeouts, now);
+    }
+
+    if (entry->flushed || entry->expire <= now) {
+        talloc_free(entry);
+    }
+}
+
+static void
+resolv_gethostbyname_uncached_done(struct tevent_req *subreq)
+{
+    struct gethostbyname_cache_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct gethostbyname_cache_state);
+
+    ret = resolv_gethostbyname_query_recv(subreq, state, &state->status,
+                                          &state->timeouts, NULL,
+                                          &state->rhostent);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
 int
 resolv_gethostbyname_recv(struct tevent_req *req, TALLOC_CTX *mem_ctx,
                           int *status, int *timeouts,
                           struct resolv_hostent **rhostent)
 {
-    struct gethostbyname_state *state = tevent_req_data(req, struct gethostbyname_state);
+    struct gethostbyname_cache_state *state;
+
+    state = tevent_req_data(req, struct gethostbyname_cache_state);
 
     /* Fill in even in case of error as status contains the
      * c-ares return code */
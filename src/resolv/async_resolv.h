@@ -112,6 +112,26 @@ int resolv_gethostbyname_recv(struct tevent_req *req, TALLOC_CTX *mem_ctx,
                               int *status, int *timeouts,
                               struct resolv_hostent **rhostent);
 
+/* Host name lookups can be cached in the resolver context. Positive
+ * answers are kept for the lowest TTL of the addresses, negative ones for
+ * the negative TTL announced in the SOA record of the zone. Concurrent
+ * lookups of the same name share a single query. The cache is flushed
+ * by resolv_reread_configuration(). */
+struct resolv_cache_stats {
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t negative_hits;
+    uint64_t coalesced;
+    uint64_t misses;
+};
+
+errno_t resolv_cache_init(struct resolv_ctx *ctx, size_t max_entries);
+
+void resolv_cache_flush(struct resolv_ctx *ctx);
+
+void resolv_cache_get_stats(struct resolv_ctx *ctx,
+                            struct resolv_cache_stats *stats);
+
 struct resolv_hostport {
     const char *host;
     int port;
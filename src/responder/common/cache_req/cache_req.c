@@ -145,6 +145,10 @@ cache_req_create(TALLOC_CTX *mem_ctx,
     /* It is perfectly fine to just overflow here. */
     cr->reqid = rctx->cache_req_num++;
 
+    /* Lookups that are not done for a client get their own trace ID. */
+    cr->trace_id = debug_trace_id != 0 ? debug_trace_id
+                                       : sss_cmd_new_trace_id(rctx);
+
     ret = cache_req_set_plugin(cr, data->type);
     if (ret != EOK) {
         talloc_free(cr);
@@ -428,14 +432,21 @@ static void cache_req_domain_set_locate_flag(struct cache_req_domain *domains,
     }
 }
 
+/* The input may be a UPN as well as a name qualified with a domain */
+static bool
+cache_req_maybe_upn(struct cache_req *cr)
+{
+    return cr->plugin->allow_switch_to_upn
+           && cr->data->name.input != NULL
+           && strchr(cr->data->name.input, '@') != NULL;
+}
+
 static bool
 cache_req_assume_upn(struct cache_req *cr)
 {
     errno_t ret;
 
-    if (cr->plugin->allow_switch_to_upn == false
-            || cr->data->name.input == NULL
-            || strchr(cr->data->name.input, '@') == NULL) {
+    if (!cache_req_maybe_upn(cr)) {
         return false;
     }
 
@@ -678,6 +689,206 @@ static errno_t cache_req_locate_dom_cache_recv(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+/* Copies the request for a search in another domain that runs at the
+ * same time as the search in the original domain. */
+static struct cache_req *
+cache_req_copy_for_domain(TALLOC_CTX *mem_ctx,
+                          struct cache_req *cr,
+                          struct sss_domain_info *domain)
+{
+    struct cache_req *copy;
+    errno_t ret;
+
+    copy = talloc(mem_ctx, struct cache_req);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    *copy = *cr;
+    copy->domain = NULL;
+    copy->debugobj = NULL;
+
+    copy->data = talloc(copy, struct cache_req_data);
+    if (copy->data == NULL) {
+        talloc_free(copy);
+        return NULL;
+    }
+
+    /* The lookup name is the only member that is prepared for each domain
+     * by the plug-ins of object lookups. */
+    *copy->data = *cr->data;
+    copy->data->name.lookup = NULL;
+
+    ret = cache_req_set_domain(copy, domain);
+    if (ret != EOK) {
+        talloc_free(copy);
+        return NULL;
+    }
+
+    return copy;
+}
+
+struct cache_req_parallel_search {
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+    struct ldb_result *result;
+    bool finished;
+    errno_t ret;
+};
+
+struct cache_req_parallel_state {
+    struct cache_req_parallel_search *searches;
+    size_t num_searches;
+    size_t winner;
+    bool dp_success;
+};
+
+static void cache_req_parallel_cancel(struct cache_req_parallel_state *state);
+static void cache_req_parallel_done(struct tevent_req *subreq);
+
+/* Searches all domains at the same time. The result is taken from the
+ * first domain in the list that has the object, so it does not differ
+ * from searching them one after another. */
+static struct tevent_req *
+cache_req_parallel_send(TALLOC_CTX *mem_ctx,
+                        struct tevent_context *ev,
+                        struct cache_req *cr,
+                        struct sss_domain_info **domains,
+                        size_t num_domains,
+                        bool first_iteration)
+{
+    struct cache_req_parallel_state *state;
+    struct cache_req_parallel_search *search;
+    struct cache_req *copy;
+    struct tevent_req *req;
+    errno_t ret;
+    size_t i;
+
+    req = tevent_req_create(mem_ctx, &state, struct cache_req_parallel_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->dp_success = true;
+    state->searches = talloc_zero_array(state,
+                                        struct cache_req_parallel_search,
+                                        num_domains);
+    if (state->searches == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    state->num_searches = num_domains;
+
+    CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                    "Searching %zu domains in parallel\n", num_domains);
+
+    for (i = 0; i < num_domains; i++) {
+        search = &state->searches[i];
+        search->req = req;
+
+        copy = cache_req_copy_for_domain(state->searches, cr, domains[i]);
+        if (copy == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        search->subreq = cache_req_search_send(copy, ev, copy,
+                                               first_iteration, false);
+        if (search->subreq == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        tevent_req_set_callback(search->subreq, cache_req_parallel_done,
+                                search);
+    }
+
+    return req;
+
+done:
+    cache_req_parallel_cancel(state);
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static void cache_req_parallel_cancel(struct cache_req_parallel_state *state)
+{
+    size_t i;
+
+    /* The data provider still finishes the lookups, only the replies
+     * are dropped. */
+    for (i = 0; i < state->num_searches; i++) {
+        talloc_zfree(state->searches[i].subreq);
+    }
+}
+
+static void cache_req_parallel_done(struct tevent_req *subreq)
+{
+    struct cache_req_parallel_state *state;
+    struct cache_req_parallel_search *search;
+    struct tevent_req *req;
+    bool dp_success;
+    size_t i;
+
+    search = tevent_req_callback_data(subreq,
+                                      struct cache_req_parallel_search);
+    req = search->req;
+    state = tevent_req_data(req, struct cache_req_parallel_state);
+
+    search->ret = cache_req_search_recv(state->searches, subreq,
+                                        &search->result, &dp_success);
+    talloc_zfree(search->subreq);
+    search->finished = true;
+
+    state->dp_success = !dp_success ? false : state->dp_success;
+
+    for (i = 0; i < state->num_searches; i++) {
+        search = &state->searches[i];
+        if (!search->finished) {
+            /* A domain that comes first may still have the object. */
+            return;
+        }
+
+        switch (search->ret) {
+        case EOK:
+            state->winner = i;
+            cache_req_parallel_cancel(state);
+            tevent_req_done(req);
+            return;
+        case ERR_ID_OUTSIDE_RANGE:
+        case ENOENT:
+            continue;
+        default:
+            cache_req_parallel_cancel(state);
+            tevent_req_error(req, search->ret);
+            return;
+        }
+    }
+
+    tevent_req_error(req, ENOENT);
+}
+
+static errno_t cache_req_parallel_recv(TALLOC_CTX *mem_ctx,
+                                       struct tevent_req *req,
+                                       size_t *_winner,
+                                       struct ldb_result **_result,
+                                       bool *_dp_success)
+{
+    struct cache_req_parallel_state *state;
+
+    state = tevent_req_data(req, struct cache_req_parallel_state);
+
+    *_dp_success = state->dp_success;
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_winner = state->winner;
+    *_result = talloc_steal(mem_ctx, state->searches[state->winner].result);
+
+    return EOK;
+}
+
 struct cache_req_search_domains_state {
     /* input data */
     struct tevent_context *ev;
@@ -693,6 +904,9 @@ struct cache_req_search_domains_state {
     bool dp_success;
     bool first_iteration;
     enum cache_req_behavior cache_behavior;
+
+    /* Domains that are searched at the same time */
+    struct sss_domain_info **parallel_domains;
 };
 
 static errno_t cache_req_search_domains_next(struct tevent_req *req);
@@ -758,48 +972,142 @@ cache_req_search_domains_send(TALLOC_CTX *mem_ctx,
     return req;
 }
 
+static bool
+cache_req_search_domains_is_candidate(struct cache_req_search_domains_state *state,
+                                      struct cache_req_domain *cr_domain)
+{
+    struct cache_req *cr = state->cr;
+    struct sss_domain_info *domain = cr_domain->domain;
+
+    /* As the cr_domain list is a flatten version of the domains
+     * list, we have to ensure to only go through the subdomains in
+     * case it's specified in the plugin to do so.
+     */
+    if (cr->plugin->get_next_domain_flags == 0 && IS_SUBDOMAIN(domain)) {
+        return false;
+    }
+
+    /* Check if this domain is valid for this request. */
+    if (!cache_req_validate_domain(cr, domain)) {
+        return false;
+    }
+
+    /* If not specified otherwise, we skip domains that require fully
+     * qualified names on domain less search. We do not descend into
+     * subdomains here since those are implicitly qualified.
+     */
+    if (state->check_next && !cr->plugin->allow_missing_fqn
+            && cr_domain->fqnames) {
+        return false;
+    }
+
+    return true;
+}
+
+/* The data provider lookups of a domain less search can be sent to all
+ * domains at once if each domain is going to be asked anyway. */
+static bool
+cache_req_search_domains_can_parallel(struct cache_req_search_domains_state *state)
+{
+    struct cache_req *cr = state->cr;
+
+    if (!cr->rctx->parallel_domain_lookup || !state->check_next
+            || cr->plugin->search_all_domains
+            || !cache_req_is_object_lookup(cr)) {
+        return false;
+    }
+
+    switch (cr->cache_behavior) {
+    case CACHE_REQ_CACHE_FIRST:
+        return !state->first_iteration;
+    case CACHE_REQ_BYPASS_CACHE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void cache_req_search_domains_parallel_done(struct tevent_req *subreq);
+
+/* Starts the search of all following domains that do not need to be
+ * located first. Returns ENOENT if there are not at least two of them. */
+static errno_t cache_req_search_domains_parallel(struct tevent_req *req)
+{
+    struct cache_req_search_domains_state *state;
+    struct cache_req_domain *cr_domain;
+    struct tevent_req *subreq;
+    size_t num_domains = 0;
+    size_t i;
+
+    state = tevent_req_data(req, struct cache_req_search_domains_state);
+
+    for (cr_domain = state->cr_domain;
+            cr_domain != NULL && !cr_domain->locate_domain;
+            cr_domain = cr_domain->next) {
+        if (cache_req_search_domains_is_candidate(state, cr_domain)) {
+            num_domains++;
+        }
+    }
+
+    if (num_domains < 2) {
+        return ENOENT;
+    }
+
+    talloc_zfree(state->parallel_domains);
+    state->parallel_domains = talloc_array(state, struct sss_domain_info *,
+                                           num_domains);
+    if (state->parallel_domains == NULL) {
+        return ENOMEM;
+    }
+
+    i = 0;
+    for (cr_domain = state->cr_domain;
+            cr_domain != NULL && !cr_domain->locate_domain;
+            cr_domain = cr_domain->next) {
+        if (cache_req_search_domains_is_candidate(state, cr_domain)) {
+            state->parallel_domains[i++] = cr_domain->domain;
+        }
+    }
+
+    /* we will continue with the following domain the next time */
+    state->cr_domain = cr_domain;
+
+    subreq = cache_req_parallel_send(state, state->ev, state->cr,
+                                     state->parallel_domains, num_domains,
+                                     state->first_iteration);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+    tevent_req_set_callback(subreq, cache_req_search_domains_parallel_done,
+                            req);
+
+    return EAGAIN;
+}
+
 static errno_t cache_req_search_domains_next(struct tevent_req *req)
 {
     struct cache_req_search_domains_state *state;
     struct tevent_req *subreq;
     struct cache_req *cr;
     struct sss_domain_info *domain;
-    uint32_t next_domain_flag;
-    bool is_domain_valid;
-    bool allow_no_fqn;
     errno_t ret;
 
     state = tevent_req_data(req, struct cache_req_search_domains_state);
     cr = state->cr;
 
-    next_domain_flag = cr->plugin->get_next_domain_flags;
-    allow_no_fqn = cr->plugin->allow_missing_fqn;
-
     while (state->cr_domain != NULL) {
         domain = state->cr_domain->domain;
-        /* As the cr_domain list is a flatten version of the domains
-         * list, we have to ensure to only go through the subdomains in
-         * case it's specified in the plugin to do so.
-         */
-        if (next_domain_flag == 0 && IS_SUBDOMAIN(domain)) {
-            state->cr_domain = state->cr_domain->next;
-            continue;
-        }
-
-        /* Check if this domain is valid for this request. */
-        is_domain_valid = cache_req_validate_domain(cr, domain);
-        if (!is_domain_valid) {
+        if (!cache_req_search_domains_is_candidate(state, state->cr_domain)) {
             state->cr_domain = state->cr_domain->next;
             continue;
         }
 
-        /* If not specified otherwise, we skip domains that require fully
-         * qualified names on domain less search. We do not descend into
-         * subdomains here since those are implicitly qualified.
-         */
-        if (state->check_next && !allow_no_fqn && state->cr_domain->fqnames) {
-            state->cr_domain = state->cr_domain->next;
-            continue;
+        if (cache_req_search_domains_can_parallel(state)
+                && !state->cr_domain->locate_domain) {
+            ret = cache_req_search_domains_parallel(req);
+            if (ret != ENOENT) {
+                return ret;
+            }
         }
 
         state->selected_domain = domain;
@@ -947,6 +1255,36 @@ static errno_t cache_req_handle_result(struct tevent_req *req,
     return EAGAIN;
 }
 
+static void cache_req_search_domains_finish(struct tevent_req *req,
+                                            errno_t ret)
+{
+    struct cache_req_search_domains_state *state;
+
+    state = tevent_req_data(req, struct cache_req_search_domains_state);
+
+    if (ret == ENOENT && state->results != NULL) {
+        /* We have at least one result. */
+        ret = EOK;
+    }
+
+    switch (ret) {
+    case EOK:
+        tevent_req_done(req);
+        break;
+    case EAGAIN:
+        break;
+    default:
+        if (ret == ENOENT && state->cr->data->propogate_offline_status
+                && !state->dp_success) {
+            /* Not found and data provider request failed so we were
+             * unable to fetch the data. */
+            ret = ERR_OFFLINE;
+        }
+        tevent_req_error(req, ret);
+        break;
+    }
+}
+
 static void cache_req_search_domains_done(struct tevent_req *subreq)
 {
     struct cache_req_search_domains_state *state;
@@ -997,29 +1335,53 @@ static void cache_req_search_domains_done(struct tevent_req *subreq)
     ret = cache_req_search_domains_next(req);
 
 done:
-    if (ret == ENOENT && state->results != NULL) {
-        /* We have at least one result. */
-        ret = EOK;
-    }
+    cache_req_search_domains_finish(req, ret);
+}
+
+static void cache_req_search_domains_parallel_done(struct tevent_req *subreq)
+{
+    struct cache_req_search_domains_state *state;
+    struct ldb_result *result;
+    struct tevent_req *req;
+    bool dp_success;
+    size_t winner;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct cache_req_search_domains_state);
+
+    ret = cache_req_parallel_recv(state, subreq, &winner, &result,
+                                  &dp_success);
+    talloc_zfree(subreq);
+
+    /* Remember if any DP request fails. */
+    state->dp_success = !dp_success ? false : state->dp_success;
 
     switch (ret) {
     case EOK:
-        tevent_req_done(req);
+        state->selected_domain = state->parallel_domains[winner];
+        ret = cache_req_set_domain(state->cr, state->selected_domain);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = cache_req_handle_result(req, result);
+        if (ret != EAGAIN) {
+            goto done;
+        }
         break;
-    case EAGAIN:
+    case ENOENT:
+        /* Continue with the domains that need to be located. */
         break;
     default:
-        if (ret == ENOENT && state->cr->data->propogate_offline_status
-                && !state->dp_success) {
-            /* Not found and data provider request failed so we were
-             * unable to fetch the data. */
-            ret = ERR_OFFLINE;
-        }
-        tevent_req_error(req, ret);
-        break;
+        /* Some serious error has happened. Finish. */
+        goto done;
     }
 
-    return;
+    ret = cache_req_search_domains_next(req);
+
+done:
+    cache_req_search_domains_finish(req, ret);
 }
 
 static errno_t
@@ -1055,6 +1417,14 @@ struct cache_req_state {
     struct cache_req_result **results;
     size_t num_results;
     bool first_iteration;
+
+    /* lookup of an ambiguous name as UPN, sent together with the
+     * data provider lookup of the name */
+    struct tevent_req *upn_req;
+    struct cache_req_result **upn_results;
+    errno_t upn_ret;
+    bool upn_done;
+    bool wait_for_upn;
 };
 
 static errno_t cache_req_process_input(TALLOC_CTX *mem_ctx,
@@ -1084,6 +1454,12 @@ static void cache_req_process_result(struct tevent_req *subreq);
 
 static void cache_req_done(struct tevent_req *subreq);
 
+static void cache_req_upn_parallel_send(struct cache_req *cr, void *pvt);
+
+static void cache_req_upn_parallel_done(struct tevent_req *subreq);
+
+static void cache_req_upn_parallel_finish(struct tevent_req *req);
+
 struct tevent_req *cache_req_send(TALLOC_CTX *mem_ctx,
                                   struct tevent_context *ev,
                                   struct resp_ctx *rctx,
@@ -1338,6 +1714,16 @@ static errno_t cache_req_select_domains(struct tevent_req *req,
             return ERR_DOMAIN_NOT_FOUND;
         }
         check_next = false;
+
+        /* Instead of trying the UPN only after the name was not found, it
+         * is looked up together with the name if the data provider
+         * has to be asked for it. */
+        if (state->first_iteration && state->upn_req == NULL
+                && state->cr->rctx->parallel_domain_lookup
+                && cache_req_maybe_upn(state->cr)) {
+            state->cr->dp_lookup_fn = cache_req_upn_parallel_send;
+            state->cr->dp_lookup_pvt = req;
+        }
     } else {
         CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->cr,
                         "Performing a multi-domain search\n");
@@ -1407,6 +1793,30 @@ static void cache_req_process_result(struct tevent_req *subreq)
                                         &state->results, &state->num_results);
     talloc_zfree(subreq);
 
+    state->cr->dp_lookup_fn = NULL;
+    state->cr->dp_lookup_pvt = NULL;
+
+    if (ret == ENOENT && state->upn_req != NULL) {
+        /* The name has the higher precedence, only now the result of the
+         * UPN lookup running at the same time is used. */
+        CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->cr,
+                        "Name was not found, waiting for the UPN lookup\n");
+        state->wait_for_upn = true;
+        return;
+    }
+
+    if (state->upn_done) {
+        if (ret == ENOENT) {
+            cache_req_upn_parallel_finish(req);
+            return;
+        }
+
+        talloc_zfree(state->upn_results);
+    }
+
+    /* the name wins, the UPN lookup is not needed anymore */
+    talloc_zfree(state->upn_req);
+
     if (ret == ENOENT && state->first_iteration) {
         /* Try again different search schema. */
         state->first_iteration = false;
@@ -1464,6 +1874,87 @@ static void cache_req_process_result(struct tevent_req *subreq)
     return;
 }
 
+static void cache_req_upn_parallel_send(struct cache_req *cr, void *pvt)
+{
+    struct cache_req_state *state;
+    struct cache_req_data *data;
+    struct tevent_req *req;
+
+    req = talloc_get_type(pvt, struct tevent_req);
+    state = tevent_req_data(req, struct cache_req_state);
+
+    cr->dp_lookup_fn = NULL;
+    cr->dp_lookup_pvt = NULL;
+
+    data = cache_req_data_copy_type(state, cr->data, cr->plugin->upn_equivalent);
+    if (data == NULL) {
+        /* The UPN is tried after the name then */
+        return;
+    }
+
+    CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                    "Looking up [%s] as UPN at the same time\n",
+                    cr->data->name.input);
+
+    state->upn_req = cache_req_steal_data_and_send(state, state->ev, cr->rctx,
+                                                   cr->ncache, cr->midpoint,
+                                                   cr->req_dom_type, NULL,
+                                                   data);
+    if (state->upn_req == NULL) {
+        return;
+    }
+
+    tevent_req_set_callback(state->upn_req, cache_req_upn_parallel_done, req);
+}
+
+static void cache_req_upn_parallel_done(struct tevent_req *subreq)
+{
+    struct cache_req_state *state;
+    struct tevent_req *req;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct cache_req_state);
+
+    state->upn_ret = cache_req_recv(state, subreq, &state->upn_results);
+    talloc_zfree(subreq);
+    state->upn_req = NULL;
+    state->upn_done = true;
+
+    if (!state->wait_for_upn) {
+        /* the name lookup is still running */
+        return;
+    }
+
+    cache_req_upn_parallel_finish(req);
+}
+
+/* The name was not found, the request ends with the UPN lookup */
+static void cache_req_upn_parallel_finish(struct tevent_req *req)
+{
+    struct cache_req_state *state;
+
+    state = tevent_req_data(req, struct cache_req_state);
+
+    switch (state->upn_ret) {
+    case EOK:
+        CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->cr,
+                        "Finished: Success, found as UPN\n");
+        state->results = state->upn_results;
+        tevent_req_done(req);
+        break;
+    case ENOENT:
+        CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->cr, "Finished: Not found\n");
+        tevent_req_error(req, ENOENT);
+        break;
+    default:
+        CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->cr,
+                        "Finished: Error %d: %s\n",
+                        state->upn_ret, sss_strerror(state->upn_ret));
+        tevent_req_error(req, state->upn_ret);
+        break;
+    }
+}
+
 static void cache_req_done(struct tevent_req *subreq)
 {
     struct cache_req_state *state;
@@ -167,6 +167,21 @@ void
 cache_req_data_set_bypass_dp(struct cache_req_data *data,
                              bool bypass_dp);
 
+/* Return expired objects from the cache instead of waiting for the data
+ * provider. Unless the data provider is bypassed, they are refreshed in
+ * the background. */
+void
+cache_req_data_set_allow_stale(struct cache_req_data *data,
+                               bool allow_stale);
+
+void
+cache_req_data_set_background(struct cache_req_data *data,
+                              bool background);
+
+void
+cache_req_data_set_refresh(struct cache_req_data *data,
+                           bool refresh);
+
 void
 cache_req_data_set_requested_domains(struct cache_req_data *data,
                                      char **requested_domains);
@@ -175,6 +190,17 @@ void
 cache_req_data_set_propogate_offline_status(struct cache_req_data *data,
                                             bool propogate_offline_status);
 
+void
+cache_req_data_set_enum_keys(struct cache_req_data *data,
+                             bool enum_keys);
+
+/* Refresh the object also when the entry is expired, not only its part the
+ * request is for, e.g. when an initgroups request returns the user entry as
+ * well. */
+void
+cache_req_data_set_entry_expiration(struct cache_req_data *data,
+                                    bool entry_expiration);
+
 enum cache_req_type
 cache_req_data_get_type(struct cache_req_data *data);
 
@@ -249,6 +275,47 @@ errno_t cache_req_single_domain_recv(TALLOC_CTX *mem_ctx,
                                      struct tevent_req *req,
                                      struct cache_req_result **_result);
 
+/* In-memory cache of recently looked up objects. */
+
+errno_t cache_req_hot_init(struct resp_ctx *rctx,
+                           size_t max_size,
+                           time_t timeout);
+
+void cache_req_hot_flush(struct resp_ctx *rctx);
+
+void cache_req_hot_stats(struct resp_ctx *rctx,
+                         uint64_t *_entries,
+                         uint64_t *_hits,
+                         uint64_t *_misses);
+
+/* Object cache shared by the responders in a file. */
+
+#define CACHE_REQ_SHARED_FILE DB_PATH "/object_cache.mcache"
+
+errno_t cache_req_shared_init(struct resp_ctx *rctx,
+                              const char *path,
+                              time_t timeout);
+
+void cache_req_shared_invalidate(struct resp_ctx *rctx);
+
+/* Filters of the objects cached in each domain. */
+
+errno_t cache_req_prefilter_init(struct resp_ctx *rctx,
+                                 time_t interval);
+
+/* Refresh of frequently used objects before they expire. */
+
+errno_t cache_req_prefetch_init(struct resp_ctx *rctx,
+                                unsigned int min_lookups);
+
+/* Queues the refreshes of the objects that expire soon, this is done every
+ * 30 seconds and only called directly by the unit tests. */
+void cache_req_prefetch_check(struct resp_ctx *rctx);
+
+void cache_req_prefetch_stats(struct resp_ctx *rctx,
+                              uint64_t *_tracked,
+                              uint64_t *_pending);
+
 /* Plug-ins. */
 
 struct tevent_req *
@@ -302,6 +369,19 @@ cache_req_user_by_id_send(TALLOC_CTX *mem_ctx,
 #define cache_req_user_by_id_recv(mem_ctx, req, _result) \
     cache_req_single_domain_recv(mem_ctx, req, _result);
 
+struct tevent_req *
+cache_req_user_by_id_attrs_send(TALLOC_CTX *mem_ctx,
+                                struct tevent_context *ev,
+                                struct resp_ctx *rctx,
+                                struct sss_nc_ctx *ncache,
+                                int cache_refresh_percent,
+                                const char *domain,
+                                uid_t uid,
+                                const char **attrs);
+
+#define cache_req_user_by_id_attrs_recv(mem_ctx, req, _result) \
+    cache_req_single_domain_recv(mem_ctx, req, _result)
+
 struct tevent_req *
 cache_req_user_by_cert_send(TALLOC_CTX *mem_ctx,
                             struct tevent_context *ev,
@@ -340,6 +420,19 @@ cache_req_group_by_id_send(TALLOC_CTX *mem_ctx,
 #define cache_req_group_by_id_recv(mem_ctx, req, _result) \
     cache_req_single_domain_recv(mem_ctx, req, _result)
 
+struct tevent_req *
+cache_req_group_by_id_attrs_send(TALLOC_CTX *mem_ctx,
+                                 struct tevent_context *ev,
+                                 struct resp_ctx *rctx,
+                                 struct sss_nc_ctx *ncache,
+                                 int cache_refresh_percent,
+                                 const char *domain,
+                                 gid_t gid,
+                                 const char **attrs);
+
+#define cache_req_group_by_id_attrs_recv(mem_ctx, req, _result) \
+    cache_req_single_domain_recv(mem_ctx, req, _result)
+
 struct tevent_req *
 cache_req_initgr_by_name_send(TALLOC_CTX *mem_ctx,
                               struct tevent_context *ev,
@@ -27,9 +27,12 @@ static const char **
 cache_req_data_create_attrs(TALLOC_CTX *mem_ctx,
                             const char **requested)
 {
+    /* The ids are needed by the plugins to look the object up in the
+     * data provider and in the negative cache */
     static const char *defattrs[] = { SYSDB_DEFAULT_ATTRS, SYSDB_NAME,
                                       OVERRIDE_PREFIX SYSDB_NAME,
-                                      SYSDB_DEFAULT_OVERRIDE_NAME };
+                                      SYSDB_DEFAULT_OVERRIDE_NAME,
+                                      SYSDB_UIDNUM, SYSDB_GIDNUM };
     static size_t defnum = sizeof(defattrs) / sizeof(defattrs[0]);
     const char **attrs;
     size_t reqnum;
@@ -269,6 +272,31 @@ done:
     return data;
 }
 
+/* Copy of the input and the flags of data for a request of another type */
+struct cache_req_data *
+cache_req_data_copy_type(TALLOC_CTX *mem_ctx,
+                         struct cache_req_data *data,
+                         enum cache_req_type type)
+{
+    struct cache_req_data *copy;
+
+    copy = cache_req_data_create(mem_ctx, type, data);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    copy->bypass_cache = data->bypass_cache;
+    copy->bypass_dp = data->bypass_dp;
+    copy->allow_stale = data->allow_stale;
+    copy->background = data->background;
+    copy->refresh = data->refresh;
+    copy->propogate_offline_status = data->propogate_offline_status;
+    /* only read, the copy does not outlive the request of data */
+    copy->requested_domains = data->requested_domains;
+
+    return copy;
+}
+
 struct cache_req_data *
 cache_req_data_name(TALLOC_CTX *mem_ctx,
                     enum cache_req_type type,
@@ -443,6 +471,42 @@ cache_req_data_set_bypass_dp(struct cache_req_data *data,
     data->bypass_dp = bypass_dp;
 }
 
+void
+cache_req_data_set_allow_stale(struct cache_req_data *data,
+                               bool allow_stale)
+{
+    if (data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "cache_req_data should never be NULL\n");
+        return;
+    }
+
+    data->allow_stale = allow_stale;
+}
+
+void
+cache_req_data_set_background(struct cache_req_data *data,
+                              bool background)
+{
+    if (data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "cache_req_data should never be NULL\n");
+        return;
+    }
+
+    data->background = background;
+}
+
+void
+cache_req_data_set_refresh(struct cache_req_data *data,
+                           bool refresh)
+{
+    if (data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "cache_req_data should never be NULL\n");
+        return;
+    }
+
+    data->refresh = refresh;
+}
+
 void
 cache_req_data_set_requested_domains(struct cache_req_data *data,
                                      char **requested_domains)
@@ -467,6 +531,30 @@ cache_req_data_set_propogate_offline_status(struct cache_req_data *data,
     data->propogate_offline_status = propogate_offline_status;
 }
 
+void
+cache_req_data_set_enum_keys(struct cache_req_data *data,
+                             bool enum_keys)
+{
+    if (data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "cache_req_data should never be NULL\n");
+        return;
+    }
+
+    data->enum_keys = enum_keys;
+}
+
+void
+cache_req_data_set_entry_expiration(struct cache_req_data *data,
+                                    bool entry_expiration)
+{
+    if (data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "cache_req_data should never be NULL\n");
+        return;
+    }
+
+    data->entry_expiration = entry_expiration;
+}
+
 enum cache_req_type
 cache_req_data_get_type(struct cache_req_data *data)
 {
@@ -0,0 +1,350 @@
+/*
+    SSSD
+
+    Cache request - in-memory copy of recently used objects
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Objects that are looked up over and over again are kept in memory for a
+ * short time, so that each lookup does not have to search the sysdb and
+ * unpack the ldb messages again. Only valid objects are stored; the entry
+ * is dropped when it is older than object_cache_timeout, when the object
+ * expires in the sysdb or when the responder is told that cached data
+ * changed. The entries are limited in total size, the least recently used
+ * ones are evicted first.
+ */
+
+#include <ldb.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "util/dlinklist.h"
+#include "util/sss_ptr_hash.h"
+#include "responder/common/cache_req/cache_req_private.h"
+#include "responder/common/cache_req/cache_req_plugin.h"
+
+struct cache_req_hot_entry {
+    struct cache_req_hot_entry *prev;
+    struct cache_req_hot_entry *next;
+    struct cache_req_hot *hot;
+    struct ldb_result *result;
+    size_t size;
+    time_t expire;
+};
+
+struct cache_req_hot {
+    hash_table_t *table;
+
+    /* Most recently used entry first */
+    struct cache_req_hot_entry *lru;
+    struct cache_req_hot_entry *lru_tail;
+
+    size_t size;
+    size_t max_size;
+    time_t timeout;
+
+    uint64_t hits;
+    uint64_t misses;
+};
+
+/* True if the request looks up a single object by its key. */
+bool cache_req_is_object_lookup(struct cache_req *cr)
+{
+    switch (cr->data->type) {
+    case CACHE_REQ_USER_BY_NAME:
+    case CACHE_REQ_USER_BY_UPN:
+    case CACHE_REQ_USER_BY_ID:
+    case CACHE_REQ_GROUP_BY_NAME:
+    case CACHE_REQ_GROUP_BY_ID:
+    case CACHE_REQ_INITGROUPS:
+    case CACHE_REQ_INITGROUPS_BY_UPN:
+    case CACHE_REQ_OBJECT_BY_SID:
+    case CACHE_REQ_OBJECT_BY_NAME:
+    case CACHE_REQ_OBJECT_BY_ID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Returns the key that identifies the looked up object or NULL if the
+ * lookup is not of a single object by its key. It is used both for the
+ * data provider lookups in flight and for the object cache; the debug
+ * name identifies the key. */
+const char *cache_req_object_key(TALLOC_CTX *mem_ctx,
+                                 struct cache_req *cr)
+{
+    if (!cache_req_is_object_lookup(cr)) {
+        return NULL;
+    }
+
+    return talloc_asprintf(mem_ctx, "%s:%s:%s", cr->plugin->name,
+                           cr->domain->name, cr->debugobj);
+}
+
+static void cache_req_hot_unlink(struct cache_req_hot *hot,
+                                 struct cache_req_hot_entry *entry)
+{
+    if (hot->lru_tail == entry) {
+        hot->lru_tail = entry->prev;
+    }
+
+    DLIST_REMOVE(hot->lru, entry);
+}
+
+static void cache_req_hot_link(struct cache_req_hot *hot,
+                               struct cache_req_hot_entry *entry)
+{
+    DLIST_ADD(hot->lru, entry);
+
+    if (hot->lru_tail == NULL) {
+        hot->lru_tail = entry;
+    }
+}
+
+static int cache_req_hot_entry_destructor(struct cache_req_hot_entry *entry)
+{
+    cache_req_hot_unlink(entry->hot, entry);
+    entry->hot->size -= entry->size;
+
+    return 0;
+}
+
+errno_t cache_req_hot_init(struct resp_ctx *rctx,
+                           size_t max_size,
+                           time_t timeout)
+{
+    struct cache_req_hot *hot;
+
+    talloc_zfree(rctx->cache_req_hot);
+
+    if (max_size == 0 || timeout <= 0) {
+        DEBUG(SSSDBG_CONF_SETTINGS, "Object cache is disabled\n");
+        return EOK;
+    }
+
+    hot = talloc_zero(rctx, struct cache_req_hot);
+    if (hot == NULL) {
+        return ENOMEM;
+    }
+
+    hot->table = sss_ptr_hash_create(hot, NULL, NULL);
+    if (hot->table == NULL) {
+        talloc_free(hot);
+        return ENOMEM;
+    }
+
+    hot->max_size = max_size;
+    hot->timeout = timeout;
+    rctx->cache_req_hot = hot;
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Object cache holds up to %zu bytes "
+          "for %ld seconds\n", max_size, (long)timeout);
+
+    return EOK;
+}
+
+void cache_req_hot_flush(struct resp_ctx *rctx)
+{
+    struct cache_req_hot *hot = rctx->cache_req_hot;
+
+    if (hot == NULL || hot->lru == NULL) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Flushing object cache\n");
+
+    sss_ptr_hash_delete_all(hot->table, true);
+}
+
+void cache_req_hot_stats(struct resp_ctx *rctx,
+                         uint64_t *_entries,
+                         uint64_t *_hits,
+                         uint64_t *_misses)
+{
+    struct cache_req_hot *hot = rctx->cache_req_hot;
+
+    if (hot == NULL) {
+        *_entries = 0;
+        *_hits = 0;
+        *_misses = 0;
+        return;
+    }
+
+    *_entries = hash_count(hot->table);
+    *_hits = hot->hits;
+    *_misses = hot->misses;
+}
+
+/* Returns the key of the object or NULL if it is not cached. The requested
+ * attributes are part of the key since the result is limited to them. The
+ * shared object cache uses the same key. */
+const char *cache_req_hot_key(TALLOC_CTX *mem_ctx,
+                              struct cache_req *cr)
+{
+    char *key;
+    int i;
+
+    key = discard_const(cache_req_object_key(mem_ctx, cr));
+    if (key == NULL || cr->data->attrs == NULL) {
+        return key;
+    }
+
+    for (i = 0; key != NULL && cr->data->attrs[i] != NULL; i++) {
+        key = talloc_asprintf_append(key, "%c%s", i == 0 ? ':' : ',',
+                                     cr->data->attrs[i]);
+    }
+
+    return key;
+}
+
+static struct ldb_result *cache_req_hot_copy(TALLOC_CTX *mem_ctx,
+                                             struct ldb_result *result)
+{
+    struct ldb_result *copy;
+    unsigned int i;
+
+    copy = talloc_zero(mem_ctx, struct ldb_result);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    copy->msgs = talloc_zero_array(copy, struct ldb_message *,
+                                   result->count + 1);
+    if (copy->msgs == NULL) {
+        goto fail;
+    }
+
+    for (i = 0; i < result->count; i++) {
+        copy->msgs[i] = ldb_msg_copy(copy->msgs, result->msgs[i]);
+        if (copy->msgs[i] == NULL) {
+            goto fail;
+        }
+    }
+    copy->count = result->count;
+
+    return copy;
+
+fail:
+    talloc_free(copy);
+    return NULL;
+}
+
+errno_t cache_req_hot_lookup(TALLOC_CTX *mem_ctx,
+                             struct cache_req *cr,
+                             struct ldb_result **_result)
+{
+    struct cache_req_hot *hot = cr->rctx->cache_req_hot;
+    struct cache_req_hot_entry *entry;
+    struct ldb_result *result;
+    const char *key;
+
+    if (hot == NULL) {
+        return ENOENT;
+    }
+
+    key = cache_req_hot_key(cr, cr);
+    if (key == NULL) {
+        return ENOENT;
+    }
+
+    entry = sss_ptr_hash_lookup(hot->table, key, struct cache_req_hot_entry);
+    talloc_free(discard_const(key));
+    if (entry == NULL) {
+        hot->misses++;
+        return ENOENT;
+    }
+
+    if (entry->expire < time(NULL)) {
+        talloc_free(entry);
+        hot->misses++;
+        return ENOENT;
+    }
+
+    result = cache_req_hot_copy(mem_ctx, entry->result);
+    if (result == NULL) {
+        return ENOMEM;
+    }
+
+    cache_req_hot_unlink(hot, entry);
+    cache_req_hot_link(hot, entry);
+    hot->hits++;
+
+    CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                    "Found [%s] in object cache\n", cr->debugobj);
+
+    *_result = result;
+    return EOK;
+}
+
+void cache_req_hot_store(struct cache_req *cr,
+                         struct ldb_result *result)
+{
+    struct cache_req_hot *hot = cr->rctx->cache_req_hot;
+    struct cache_req_hot_entry *entry;
+    struct cache_req_hot_entry *old;
+    const char *key;
+    errno_t ret;
+
+    if (hot == NULL || result == NULL || result->count == 0) {
+        return;
+    }
+
+    entry = talloc_zero(hot, struct cache_req_hot_entry);
+    if (entry == NULL) {
+        return;
+    }
+
+    key = cache_req_hot_key(entry, cr);
+    if (key == NULL) {
+        talloc_free(entry);
+        return;
+    }
+
+    entry->result = cache_req_hot_copy(entry, result);
+    if (entry->result == NULL) {
+        talloc_free(entry);
+        return;
+    }
+
+    entry->hot = hot;
+    entry->expire = time(NULL) + hot->timeout;
+    entry->size = talloc_total_size(entry);
+    if (entry->size > hot->max_size) {
+        talloc_free(entry);
+        return;
+    }
+
+    /* Replace the previous copy of the object */
+    old = sss_ptr_hash_lookup(hot->table, key, struct cache_req_hot_entry);
+    talloc_free(old);
+
+    while (hot->lru_tail != NULL && hot->size + entry->size > hot->max_size) {
+        talloc_free(hot->lru_tail);
+    }
+
+    ret = sss_ptr_hash_add(hot->table, key, entry, struct cache_req_hot_entry);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to cache [%s] [%d]: %s\n",
+              key, ret, sss_strerror(ret));
+        talloc_free(entry);
+        return;
+    }
+
+    cache_req_hot_link(hot, entry);
+    hot->size += entry->size;
+    talloc_set_destructor(entry, cache_req_hot_entry_destructor);
+}
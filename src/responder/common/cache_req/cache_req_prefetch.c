@@ -0,0 +1,351 @@
+/*
+    SSSD
+
+    Cache request - refresh of frequently used objects before they expire
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The midpoint refresh only happens when an object is looked up in the
+ * second half of its lifetime, so an object that is used every few minutes
+ * can still expire between two lookups and the next client waits for the
+ * data provider. The lookups of each object that is returned from the cache
+ * are counted instead, and the objects that were looked up at least
+ * prefetch_min_lookups times are refreshed shortly before they expire.
+ * Objects that were used less often are forgotten and left to expire.
+ *
+ * The refreshes run in the background as ordinary cache requests that
+ * bypass the cache, only a few of them at a time.
+ */
+
+#include <ldb.h>
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util.h"
+#include "util/dlinklist.h"
+#include "util/sss_ptr_hash.h"
+#include "responder/common/cache_req/cache_req_private.h"
+#include "responder/common/cache_req/cache_req_plugin.h"
+
+/* How often the objects are checked */
+#define PREFETCH_INTERVAL 30
+/* Objects that expire sooner than this are refreshed */
+#define PREFETCH_LEAD (2 * PREFETCH_INTERVAL)
+/* Limits of the tracked objects and of the refreshes */
+#define PREFETCH_MAX_OBJECTS 10000
+#define PREFETCH_MAX_QUEUED 1000
+#define PREFETCH_MAX_RUNNING 8
+
+struct cache_req_prefetch_entry {
+    struct cache_req_prefetch_entry *prev;
+    struct cache_req_prefetch_entry *next;
+    struct cache_req_prefetch *pf;
+
+    const char *key;
+    enum cache_req_type type;
+    enum cache_req_dom_type req_dom_type;
+    const char *domain;
+    const char *name;
+    uint32_t id;
+
+    unsigned int lookups;
+    time_t expire;
+};
+
+struct cache_req_prefetch {
+    struct resp_ctx *rctx;
+    struct tevent_timer *te;
+    unsigned int min_lookups;
+
+    /* Objects returned from the cache, by their key */
+    hash_table_t *objects;
+
+    /* Objects waiting for a refresh, oldest first */
+    struct cache_req_prefetch_entry *queue;
+    size_t num_queued;
+    size_t num_running;
+};
+
+static void cache_req_prefetch_timer(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval current_time,
+                                     void *pvt);
+
+static void cache_req_prefetch_schedule(struct cache_req_prefetch *pf)
+{
+    struct timeval tv;
+
+    tv = tevent_timeval_current_ofs(PREFETCH_INTERVAL, 0);
+    pf->te = tevent_add_timer(pf->rctx->ev, pf, tv,
+                              cache_req_prefetch_timer, pf);
+    if (pf->te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to schedule prefetch, objects "
+              "are not refreshed in advance anymore\n");
+    }
+}
+
+errno_t cache_req_prefetch_init(struct resp_ctx *rctx,
+                                unsigned int min_lookups)
+{
+    struct cache_req_prefetch *pf;
+
+    talloc_zfree(rctx->cache_req_prefetch);
+
+    if (min_lookups == 0) {
+        return EOK;
+    }
+
+    pf = talloc_zero(rctx, struct cache_req_prefetch);
+    if (pf == NULL) {
+        return ENOMEM;
+    }
+
+    pf->objects = sss_ptr_hash_create(pf, NULL, NULL);
+    if (pf->objects == NULL) {
+        talloc_free(pf);
+        return ENOMEM;
+    }
+
+    pf->rctx = rctx;
+    pf->min_lookups = min_lookups;
+    rctx->cache_req_prefetch = pf;
+
+    cache_req_prefetch_schedule(pf);
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Objects looked up at least %u times are "
+          "refreshed before they expire\n", min_lookups);
+
+    return EOK;
+}
+
+static bool cache_req_prefetch_supported(struct cache_req *cr)
+{
+    switch (cr->data->type) {
+    case CACHE_REQ_USER_BY_NAME:
+    case CACHE_REQ_GROUP_BY_NAME:
+    case CACHE_REQ_INITGROUPS:
+        return cr->data->name.name != NULL;
+    case CACHE_REQ_USER_BY_ID:
+    case CACHE_REQ_GROUP_BY_ID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void cache_req_prefetch_touch(struct cache_req *cr,
+                              struct ldb_result *result)
+{
+    struct cache_req_prefetch *pf = cr->rctx->cache_req_prefetch;
+    struct cache_req_prefetch_entry *entry;
+    const char *key;
+    errno_t ret;
+
+    if (pf == NULL || result == NULL || result->count == 0
+            || !cache_req_prefetch_supported(cr)) {
+        return;
+    }
+
+    key = cache_req_object_key(NULL, cr);
+    if (key == NULL) {
+        return;
+    }
+
+    entry = sss_ptr_hash_lookup(pf->objects, key,
+                                struct cache_req_prefetch_entry);
+    if (entry != NULL) {
+        talloc_free(discard_const(key));
+        goto done;
+    }
+
+    if (hash_count(pf->objects) >= PREFETCH_MAX_OBJECTS) {
+        talloc_free(discard_const(key));
+        return;
+    }
+
+    entry = talloc_zero(pf, struct cache_req_prefetch_entry);
+    if (entry == NULL) {
+        talloc_free(discard_const(key));
+        return;
+    }
+
+    entry->pf = pf;
+    entry->key = talloc_steal(entry, key);
+    entry->type = cr->data->type;
+    entry->req_dom_type = cr->req_dom_type;
+    entry->id = cr->data->id;
+    entry->domain = talloc_strdup(entry, cr->domain->name);
+    if (entry->domain == NULL) {
+        talloc_free(entry);
+        return;
+    }
+
+    if (cr->data->name.name != NULL) {
+        entry->name = talloc_strdup(entry, cr->data->name.name);
+        if (entry->name == NULL) {
+            talloc_free(entry);
+            return;
+        }
+    }
+
+    ret = sss_ptr_hash_add(pf->objects, entry->key, entry,
+                           struct cache_req_prefetch_entry);
+    if (ret != EOK) {
+        talloc_free(entry);
+        return;
+    }
+
+done:
+    entry->lookups++;
+    entry->expire = ldb_msg_find_attr_as_uint64(result->msgs[0],
+                                                cr->plugin->attr_expiration,
+                                                0);
+}
+
+static void cache_req_prefetch_done(struct tevent_req *subreq);
+
+static void cache_req_prefetch_run(struct cache_req_prefetch *pf)
+{
+    struct cache_req_prefetch_entry *entry;
+    struct cache_req_data *data;
+    struct tevent_req *subreq;
+
+    while (pf->queue != NULL && pf->num_running < PREFETCH_MAX_RUNNING) {
+        entry = pf->queue;
+        DLIST_REMOVE(pf->queue, entry);
+        pf->num_queued--;
+
+        if (entry->name != NULL) {
+            data = cache_req_data_name(entry, entry->type, entry->name);
+        } else {
+            data = cache_req_data_id(entry, entry->type, entry->id);
+        }
+        if (data == NULL) {
+            talloc_free(entry);
+            continue;
+        }
+
+        cache_req_data_set_bypass_cache(data, true);
+        cache_req_data_set_background(data, true);
+
+        DEBUG(SSSDBG_TRACE_FUNC, "Refreshing [%s] before it expires\n",
+              entry->key);
+
+        subreq = cache_req_send(entry, pf->rctx->ev, pf->rctx,
+                                pf->rctx->ncache, 0, entry->req_dom_type,
+                                entry->domain, data);
+        if (subreq == NULL) {
+            talloc_free(entry);
+            continue;
+        }
+        tevent_req_set_callback(subreq, cache_req_prefetch_done, entry);
+        pf->num_running++;
+    }
+}
+
+static void cache_req_prefetch_done(struct tevent_req *subreq)
+{
+    struct cache_req_prefetch_entry *entry;
+    struct cache_req_prefetch *pf;
+
+    entry = tevent_req_callback_data(subreq, struct cache_req_prefetch_entry);
+    pf = entry->pf;
+
+    /* The result is in the cache now, the next lookup starts counting the
+     * uses of the refreshed object. */
+    talloc_free(entry);
+    pf->num_running--;
+
+    cache_req_prefetch_run(pf);
+}
+
+void cache_req_prefetch_check(struct resp_ctx *rctx)
+{
+    struct cache_req_prefetch *pf = rctx->cache_req_prefetch;
+    struct cache_req_prefetch_entry *entry;
+    hash_value_t *values;
+    unsigned long count;
+    unsigned long i;
+    time_t now;
+    int hret;
+
+    if (pf == NULL) {
+        return;
+    }
+
+    now = time(NULL);
+
+    hret = hash_values(pf->objects, &count, &values);
+    if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to list tracked objects [%d]: %s\n",
+              hret, hash_error_string(hret));
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        entry = sss_ptr_get_value(&values[i],
+                                  struct cache_req_prefetch_entry);
+        if (entry == NULL || entry->expire > now + PREFETCH_LEAD) {
+            continue;
+        }
+
+        sss_ptr_hash_delete(pf->objects, entry->key, false);
+
+        if (entry->expire <= now
+                || entry->lookups < pf->min_lookups
+                || pf->num_queued >= PREFETCH_MAX_QUEUED) {
+            /* Used too rarely, let it expire */
+            talloc_free(entry);
+            continue;
+        }
+
+        DLIST_ADD_END(pf->queue, entry, struct cache_req_prefetch_entry *);
+        pf->num_queued++;
+    }
+
+    talloc_free(values);
+
+    cache_req_prefetch_run(pf);
+}
+
+void cache_req_prefetch_stats(struct resp_ctx *rctx,
+                              uint64_t *_tracked,
+                              uint64_t *_pending)
+{
+    struct cache_req_prefetch *pf = rctx->cache_req_prefetch;
+
+    if (pf == NULL) {
+        *_tracked = 0;
+        *_pending = 0;
+        return;
+    }
+
+    *_tracked = hash_count(pf->objects);
+    *_pending = pf->num_queued + pf->num_running;
+}
+
+static void cache_req_prefetch_timer(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval current_time,
+                                     void *pvt)
+{
+    struct cache_req_prefetch *pf = pvt;
+
+    pf->te = NULL;
+
+    cache_req_prefetch_check(pf->rctx);
+    cache_req_prefetch_schedule(pf);
+}
@@ -0,0 +1,468 @@
+/*
+    SSSD
+
+    Cache request - Bloom filters of the objects cached in each domain
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * A lookup of a name that does not exist searches the cache of every
+ * domain in turn. With many trusted domains most of these searches are
+ * wasted, so the names and IDs of the users and groups cached in each
+ * domain are kept in a Bloom filter that is rebuilt periodically.
+ *
+ * The filter is only consulted by cache-only searches that are followed
+ * by a data provider lookup: the first pass with cache_first and the
+ * search done before locating the domain of an ID. Objects cached after
+ * the filter was built can be missing from it, and then the data provider
+ * pass finds them.
+ */
+
+#include <ldb.h>
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util.h"
+#include "util/sss_ptr_hash.h"
+#include "shared/wyhash.h"
+#include "db/sysdb.h"
+#include "responder/common/cache_req/cache_req_private.h"
+
+#define PREFILTER_BITS_PER_KEY 10
+#define PREFILTER_HASHES 7
+#define PREFILTER_MIN_BITS 1024
+#define PREFILTER_SEED 0x5353
+
+struct cache_req_bloom {
+    uint8_t *bits;
+    uint32_t num_bits;
+};
+
+struct cache_req_prefilter {
+    struct resp_ctx *rctx;
+    /* Domain name -> struct cache_req_bloom */
+    hash_table_t *filters;
+    time_t interval;
+    /* Index of the domain that is rebuilt next */
+    unsigned int next_domain;
+};
+
+static void cache_req_bloom_hash(const char *key,
+                                 uint32_t *_h1,
+                                 uint32_t *_h2)
+{
+    int len = strlen(key);
+
+    *_h1 = wyhash32(key, len, PREFILTER_SEED);
+    /* odd, so that the probes do not repeat when num_bits is even */
+    *_h2 = wyhash32(key, len, *_h1) | 1;
+}
+
+static void cache_req_bloom_add(struct cache_req_bloom *bloom,
+                                const char *key)
+{
+    uint32_t h1;
+    uint32_t h2;
+    uint32_t bit;
+    int i;
+
+    cache_req_bloom_hash(key, &h1, &h2);
+    for (i = 0; i < PREFILTER_HASHES; i++) {
+        bit = (h1 + i * h2) % bloom->num_bits;
+        bloom->bits[bit / 8] |= 1 << (bit % 8);
+    }
+}
+
+static bool cache_req_bloom_check(struct cache_req_bloom *bloom,
+                                  const char *key)
+{
+    uint32_t h1;
+    uint32_t h2;
+    uint32_t bit;
+    int i;
+
+    cache_req_bloom_hash(key, &h1, &h2);
+    for (i = 0; i < PREFILTER_HASHES; i++) {
+        bit = (h1 + i * h2) % bloom->num_bits;
+        if ((bloom->bits[bit / 8] & (1 << (bit % 8))) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Names are always stored in lower case, a case sensitive lookup then
+ * only gets a few more false positives. */
+static char *cache_req_prefilter_name_key(TALLOC_CTX *mem_ctx,
+                                          char type,
+                                          const char *name)
+{
+    char *lower;
+    char *key;
+
+    lower = sss_tc_utf8_str_tolower(mem_ctx, name);
+    if (lower == NULL) {
+        return NULL;
+    }
+
+    key = talloc_asprintf(mem_ctx, "%c:%s", type, lower);
+    talloc_free(lower);
+
+    return key;
+}
+
+static char *cache_req_prefilter_id_key(TALLOC_CTX *mem_ctx,
+                                        char type,
+                                        uint32_t id)
+{
+    return talloc_asprintf(mem_ctx, "%c:%"PRIu32, type, id);
+}
+
+/* Adds the names and the ID of the objects, name_type and id_type select
+ * the kind of keys that are added. */
+static errno_t cache_req_prefilter_add_msgs(struct cache_req_bloom *bloom,
+                                            struct ldb_message **msgs,
+                                            size_t count,
+                                            const char *id_attr,
+                                            char name_type,
+                                            char id_type)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_message_element *el;
+    const char *names[] = { SYSDB_NAME, SYSDB_NAME_ALIAS, NULL };
+    uint32_t id;
+    char *key;
+    size_t i;
+    unsigned int j;
+    int n;
+
+    for (i = 0; i < count; i++) {
+        tmp_ctx = talloc_new(NULL);
+        if (tmp_ctx == NULL) {
+            return ENOMEM;
+        }
+
+        for (n = 0; names[n] != NULL; n++) {
+            el = ldb_msg_find_element(msgs[i], names[n]);
+            if (el == NULL) {
+                continue;
+            }
+
+            for (j = 0; j < el->num_values; j++) {
+                key = cache_req_prefilter_name_key(tmp_ctx, name_type,
+                                            (const char *)el->values[j].data);
+                if (key == NULL) {
+                    talloc_free(tmp_ctx);
+                    return ENOMEM;
+                }
+                cache_req_bloom_add(bloom, key);
+            }
+        }
+
+        id = ldb_msg_find_attr_as_uint(msgs[i], id_attr, 0);
+        if (id != 0) {
+            key = cache_req_prefilter_id_key(tmp_ctx, id_type, id);
+            if (key == NULL) {
+                talloc_free(tmp_ctx);
+                return ENOMEM;
+            }
+            cache_req_bloom_add(bloom, key);
+        }
+
+        talloc_free(tmp_ctx);
+    }
+
+    return EOK;
+}
+
+static size_t cache_req_prefilter_count_keys(struct ldb_message **msgs,
+                                             size_t count)
+{
+    struct ldb_message_element *el;
+    size_t keys = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        /* name and ID */
+        keys += 2;
+
+        el = ldb_msg_find_element(msgs[i], SYSDB_NAME_ALIAS);
+        if (el != NULL) {
+            keys += el->num_values;
+        }
+    }
+
+    return keys;
+}
+
+static errno_t cache_req_prefilter_search(TALLOC_CTX *mem_ctx,
+                                          struct sss_domain_info *domain,
+                                          struct ldb_dn *base_dn,
+                                          const char *filter,
+                                          const char **attrs,
+                                          size_t *_count,
+                                          struct ldb_message ***_msgs)
+{
+    errno_t ret;
+
+    if (base_dn == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_search_entry(mem_ctx, domain->sysdb, base_dn,
+                             LDB_SCOPE_SUBTREE, filter, attrs,
+                             _count, _msgs);
+    if (ret == ENOENT) {
+        *_count = 0;
+        *_msgs = NULL;
+        ret = EOK;
+    }
+
+    return ret;
+}
+
+static errno_t cache_req_prefilter_build(TALLOC_CTX *mem_ctx,
+                                         struct sss_domain_info *domain,
+                                         struct cache_req_bloom **_bloom)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct cache_req_bloom *bloom;
+    const char *user_attrs[] = { SYSDB_NAME, SYSDB_NAME_ALIAS,
+                                 SYSDB_UIDNUM, NULL };
+    const char *group_attrs[] = { SYSDB_NAME, SYSDB_NAME_ALIAS,
+                                  SYSDB_GIDNUM, NULL };
+    struct ldb_message **users;
+    struct ldb_message **groups;
+    size_t num_users;
+    size_t num_groups;
+    size_t keys;
+    bool mpg;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = cache_req_prefilter_search(tmp_ctx, domain,
+                                     sysdb_user_base_dn(tmp_ctx, domain),
+                                     "("SYSDB_UC")", user_attrs,
+                                     &num_users, &users);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = cache_req_prefilter_search(tmp_ctx, domain,
+                                     sysdb_group_base_dn(tmp_ctx, domain),
+                                     "("SYSDB_GC")", group_attrs,
+                                     &num_groups, &groups);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* Users of domains with magic private groups are also their groups */
+    mpg = sss_domain_is_mpg(domain);
+
+    keys = cache_req_prefilter_count_keys(users, num_users) * (mpg ? 2 : 1)
+           + cache_req_prefilter_count_keys(groups, num_groups);
+
+    bloom = talloc_zero(tmp_ctx, struct cache_req_bloom);
+    if (bloom == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    bloom->num_bits = MAX(keys * PREFILTER_BITS_PER_KEY, PREFILTER_MIN_BITS);
+    bloom->bits = talloc_zero_array(bloom, uint8_t, bloom->num_bits / 8 + 1);
+    if (bloom->bits == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = cache_req_prefilter_add_msgs(bloom, users, num_users,
+                                       SYSDB_UIDNUM, 'u', 'U');
+    if (ret == EOK && mpg) {
+        ret = cache_req_prefilter_add_msgs(bloom, users, num_users,
+                                           SYSDB_UIDNUM, 'g', 'G');
+    }
+    if (ret == EOK) {
+        ret = cache_req_prefilter_add_msgs(bloom, groups, num_groups,
+                                           SYSDB_GIDNUM, 'g', 'G');
+    }
+    if (ret != EOK) {
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Built prefilter of domain %s with %zu users "
+          "and %zu groups\n", domain->name, num_users, num_groups);
+
+    *_bloom = talloc_steal(mem_ctx, bloom);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static void cache_req_prefilter_timer(struct tevent_context *ev,
+                                      struct tevent_timer *te,
+                                      struct timeval current_time,
+                                      void *pvt);
+
+static void cache_req_prefilter_schedule(struct cache_req_prefilter *pf,
+                                         time_t delay)
+{
+    struct tevent_timer *te;
+    struct timeval tv;
+
+    tv = tevent_timeval_current_ofs(delay, 0);
+    te = tevent_add_timer(pf->rctx->ev, pf, tv,
+                          cache_req_prefilter_timer, pf);
+    if (te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to schedule prefilter rebuild, "
+              "the filters are not updated anymore\n");
+    }
+}
+
+/* Rebuilds the filter of one domain at a time, so that other requests
+ * are served in between. */
+static void cache_req_prefilter_timer(struct tevent_context *ev,
+                                      struct tevent_timer *te,
+                                      struct timeval current_time,
+                                      void *pvt)
+{
+    struct cache_req_prefilter *pf = pvt;
+    struct cache_req_bloom *bloom;
+    struct cache_req_bloom *old;
+    struct sss_domain_info *dom;
+    unsigned int i;
+    errno_t ret;
+
+    dom = pf->rctx->domains;
+    for (i = 0; dom != NULL && i < pf->next_domain; i++) {
+        dom = get_next_domain(dom, SSS_GND_DESCEND);
+    }
+
+    if (dom == NULL) {
+        /* All domains are done, start again after the interval */
+        pf->next_domain = 0;
+        cache_req_prefilter_schedule(pf, pf->interval);
+        return;
+    }
+
+    pf->next_domain++;
+
+    old = sss_ptr_hash_lookup(pf->filters, dom->name, struct cache_req_bloom);
+    talloc_free(old);
+
+    /* The cache is searched through the view but the filter only knows
+     * the original names. */
+    if (!DOM_HAS_VIEWS(dom) && dom->sysdb != NULL) {
+        ret = cache_req_prefilter_build(pf, dom, &bloom);
+        if (ret == EOK) {
+            ret = sss_ptr_hash_add(pf->filters, dom->name, bloom,
+                                   struct cache_req_bloom);
+            if (ret != EOK) {
+                talloc_free(bloom);
+            }
+        }
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to build prefilter of "
+                  "domain %s [%d]: %s\n", dom->name, ret, sss_strerror(ret));
+        }
+    }
+
+    cache_req_prefilter_schedule(pf, 0);
+}
+
+errno_t cache_req_prefilter_init(struct resp_ctx *rctx,
+                                 time_t interval)
+{
+    struct cache_req_prefilter *pf;
+
+    talloc_zfree(rctx->cache_req_prefilter);
+
+    if (interval <= 0) {
+        return EOK;
+    }
+
+    pf = talloc_zero(rctx, struct cache_req_prefilter);
+    if (pf == NULL) {
+        return ENOMEM;
+    }
+
+    pf->filters = sss_ptr_hash_create(pf, NULL, NULL);
+    if (pf->filters == NULL) {
+        talloc_free(pf);
+        return ENOMEM;
+    }
+
+    pf->rctx = rctx;
+    pf->interval = interval;
+    rctx->cache_req_prefilter = pf;
+
+    cache_req_prefilter_schedule(pf, 0);
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Domain prefilters are rebuilt every "
+          "%ld seconds\n", (long)interval);
+
+    return EOK;
+}
+
+bool cache_req_prefilter_may_exist(struct cache_req *cr)
+{
+    struct cache_req_prefilter *pf = cr->rctx->cache_req_prefilter;
+    struct cache_req_bloom *bloom;
+    char *key;
+    bool found;
+
+    if (pf == NULL || DOM_HAS_VIEWS(cr->domain)) {
+        return true;
+    }
+
+    bloom = sss_ptr_hash_lookup(pf->filters, cr->domain->name,
+                                struct cache_req_bloom);
+    if (bloom == NULL) {
+        return true;
+    }
+
+    switch (cr->data->type) {
+    case CACHE_REQ_USER_BY_NAME:
+    case CACHE_REQ_INITGROUPS:
+        key = cache_req_prefilter_name_key(cr, 'u', cr->data->name.lookup);
+        break;
+    case CACHE_REQ_GROUP_BY_NAME:
+        key = cache_req_prefilter_name_key(cr, 'g', cr->data->name.lookup);
+        break;
+    case CACHE_REQ_USER_BY_ID:
+        key = cache_req_prefilter_id_key(cr, 'U', cr->data->id);
+        break;
+    case CACHE_REQ_GROUP_BY_ID:
+        key = cache_req_prefilter_id_key(cr, 'G', cr->data->id);
+        break;
+    default:
+        return true;
+    }
+
+    if (key == NULL) {
+        return true;
+    }
+
+    found = cache_req_bloom_check(bloom, key);
+    talloc_free(key);
+
+    return found;
+}
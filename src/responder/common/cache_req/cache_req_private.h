@@ -26,8 +26,13 @@
 #include "responder/common/responder.h"
 #include "responder/common/cache_req/cache_req.h"
 
-#define CACHE_REQ_DEBUG(level, cr, fmt, ...) \
-    DEBUG(level, "CR #%u: " fmt, (cr)->reqid, ##__VA_ARGS__)
+/* The messages of a cache request carry the trace ID of the client request
+ * it was created for, and so do the following ones of the same event. The
+ * data provider lookups take it from there as well. */
+#define CACHE_REQ_DEBUG(level, cr, fmt, ...) do { \
+    debug_trace_id = (cr)->trace_id; \
+    DEBUG(level, "CR #%u: " fmt, (cr)->reqid, ##__VA_ARGS__); \
+} while (0)
 
 struct cache_req {
     /* Provided input. */
@@ -49,11 +54,17 @@ struct cache_req {
 
     /* Debug information */
     uint32_t reqid;
+    uint32_t trace_id;
     const char *reqname;
     const char *debugobj;
 
     /* Time when the request started. Useful for by-filter lookups */
     time_t req_start;
+
+    /* Called once the object is going to be looked up in the data
+     * provider, before the lookup is sent */
+    void (*dp_lookup_fn)(struct cache_req *cr, void *pvt);
+    void *dp_lookup_pvt;
 };
 
 /**
@@ -100,12 +111,26 @@ struct cache_req_data {
 
     bool bypass_cache;
     bool bypass_dp;
+    bool allow_stale;
+
+    /* no client waits for the result */
+    bool background;
+
+    /* the lookup only refreshes the cache, the backend may answer it from
+     * a lookup it did recently */
+    bool refresh;
 
     /* if set, only search in the listed domains */
     char **requested_domains;
 
     /* if set, ERR_OFFLINE is returned if data provider is offline */
     bool propogate_offline_status;
+
+    /* if set, enumeration returns only the DN and name of each object */
+    bool enum_keys;
+
+    /* if set, the object is also expired when the entry is */
+    bool entry_expiration;
 };
 
 struct tevent_req *
@@ -137,9 +162,41 @@ cache_req_steal_data_and_send(TALLOC_CTX *mem_ctx,
                               const char *domain,
                               struct cache_req_data *data);
 
+struct cache_req_data *
+cache_req_data_copy_type(TALLOC_CTX *mem_ctx,
+                         struct cache_req_data *data,
+                         enum cache_req_type type);
+
 void cache_req_search_ncache_add_to_domain(struct cache_req *cr,
                                            struct sss_domain_info *domain);
 
+bool cache_req_is_object_lookup(struct cache_req *cr);
+
+const char *cache_req_object_key(TALLOC_CTX *mem_ctx,
+                                 struct cache_req *cr);
+
+errno_t cache_req_hot_lookup(TALLOC_CTX *mem_ctx,
+                             struct cache_req *cr,
+                             struct ldb_result **_result);
+
+void cache_req_hot_store(struct cache_req *cr,
+                         struct ldb_result *result);
+
+const char *cache_req_hot_key(TALLOC_CTX *mem_ctx,
+                              struct cache_req *cr);
+
+errno_t cache_req_shared_lookup(TALLOC_CTX *mem_ctx,
+                                struct cache_req *cr,
+                                struct ldb_result **_result);
+
+void cache_req_shared_store(struct cache_req *cr,
+                            struct ldb_result *result);
+
+bool cache_req_prefilter_may_exist(struct cache_req *cr);
+
+void cache_req_prefetch_touch(struct cache_req *cr,
+                              struct ldb_result *result);
+
 errno_t
 cache_req_add_result(TALLOC_CTX *mem_ctx,
                      struct cache_req_result *new_result,
@@ -23,6 +23,8 @@
 #include <tevent.h>
 
 #include "util/util.h"
+#include "util/probes.h"
+#include "util/sss_ptr_hash.h"
 #include "responder/common/cache_req/cache_req_private.h"
 #include "responder/common/cache_req/cache_req_plugin.h"
 #include "db/sysdb.h"
@@ -42,6 +44,8 @@ static errno_t cache_req_search_ncache(struct cache_req *cr)
                     cr->debugobj);
 
     ret = cr->plugin->ncache_check_fn(cr->ncache, cr->domain, cr->data);
+    PROBE(CACHE_REQ_NCACHE_CHECK, cr->plugin->name,
+          PROBE_SAFE_STR(cr->debugobj), cr->domain->name, ret);
     if (ret == EEXIST) {
         CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
                         "[%s] does not exist (negative cache)\n",
@@ -95,41 +99,33 @@ static errno_t cache_req_search_ncache_filter(TALLOC_CTX *mem_ctx,
                                               struct cache_req *cr,
                                               struct ldb_result **_result)
 {
-    TALLOC_CTX *tmp_ctx;
-    struct ldb_result *filtered_result;
-    struct ldb_message **msgs;
+    struct ldb_result *result = *_result;
     size_t msg_count;
     const char *name;
     errno_t ret;
 
-    tmp_ctx = talloc_new(NULL);
-    if (tmp_ctx == NULL) {
-        return ENOMEM;
-    }
-
     if (cr->plugin->ncache_filter_fn == NULL) {
         CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
                         "This request type does not support filtering "
                         "result by negative cache\n");
 
-        ret = EOK;
-        goto done;
+        return EOK;
     }
 
     CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
                     "Filtering out results by negative cache\n");
 
-    msgs = talloc_zero_array(tmp_ctx, struct ldb_message *, (*_result)->count);
+    /* The entries that are kept are moved to the front of the result, it is
+     * neither copied nor are its messages moved to another context. */
     msg_count = 0;
 
-    for (size_t i = 0; i < (*_result)->count; i++) {
-        name = sss_get_name_from_msg(cr->domain, (*_result)->msgs[i]);
+    for (size_t i = 0; i < result->count; i++) {
+        name = sss_get_name_from_msg(cr->domain, result->msgs[i]);
         if (name == NULL) {
             CACHE_REQ_DEBUG(SSSDBG_CRIT_FAILURE, cr,
                   "sss_get_name_from_msg() returned NULL, which should never "
                   "happen in this scenario!\n");
-            ret = ERR_INTERNAL;
-            goto done;
+            return ERR_INTERNAL;
         }
 
         ret = cr->plugin->ncache_filter_fn(cr->ncache, cr->domain, name);
@@ -137,37 +133,29 @@ static errno_t cache_req_search_ncache_filter(TALLOC_CTX *mem_ctx,
             CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
                             "[%s] filtered out! (negative cache)\n",
                             name);
+            talloc_zfree(result->msgs[i]);
             continue;
         } else if (ret != EOK && ret != ENOENT) {
             CACHE_REQ_DEBUG(SSSDBG_CRIT_FAILURE, cr,
                             "Unable to check negative cache [%d]: %s\n",
                             ret, sss_strerror(ret));
-            goto done;
+            return ret;
         }
 
-        msgs[msg_count] = talloc_steal(msgs, (*_result)->msgs[i]);
+        result->msgs[msg_count] = result->msgs[i];
         msg_count++;
     }
 
-    if (msg_count == 0) {
-        ret = ENOENT;
-        goto done;
+    for (size_t i = msg_count; i < result->count; i++) {
+        result->msgs[i] = NULL;
     }
+    result->count = msg_count;
 
-    filtered_result = cache_req_create_ldb_result_from_msg_list(tmp_ctx, msgs,
-                                                                msg_count);
-    if (filtered_result == NULL) {
-        ret = ENOMEM;
-        goto done;
+    if (msg_count == 0) {
+        return ENOENT;
     }
 
-    talloc_zfree(*_result);
-    *_result = talloc_steal(mem_ctx, filtered_result);
-    ret = EOK;
-
-done:
-    talloc_free(tmp_ctx);
-    return ret;
+    return EOK;
 }
 
 static int
@@ -194,6 +182,11 @@ cache_req_should_be_in_cache(struct cache_req *cr,
     return EOK;
 }
 
+/* The cache is searched synchronously from the event loop. The searches
+ * cannot be moved to helper threads: ldb is not thread safe and ldb_tdb
+ * shares one tdb context between all handles of a file in the process, so
+ * a second handle would not isolate the searches. Use the NSS workers
+ * option to keep long searches from delaying other clients. */
 static errno_t cache_req_search_cache(TALLOC_CTX *mem_ctx,
                                       struct cache_req *cr,
                                       struct ldb_result **_result)
@@ -220,6 +213,9 @@ static errno_t cache_req_search_cache(TALLOC_CTX *mem_ctx,
         ret = cache_req_should_be_in_cache(cr, result);
     }
 
+    PROBE(CACHE_REQ_CACHE_SEARCH, cr->plugin->name,
+          PROBE_SAFE_STR(cr->debugobj), cr->domain->name, ret);
+
     switch (ret) {
     case EOK:
         if (cr->plugin->only_one_result && result->count > 1) {
@@ -261,6 +257,7 @@ static enum cache_object_status
 cache_req_expiration_status(struct cache_req *cr,
                             struct ldb_result *result)
 {
+    time_t entry_expire;
     time_t expire;
     errno_t ret;
 
@@ -268,9 +265,21 @@ cache_req_expiration_status(struct cache_req *cr,
         return CACHE_OBJECT_MISSING;
     }
 
+    /* sss_cache invalidated all users or groups of the domain */
+    if (sysdb_entry_invalidated(cr->domain, result->msgs[0])) {
+        return CACHE_OBJECT_EXPIRED;
+    }
+
     expire = ldb_msg_find_attr_as_uint64(result->msgs[0],
                                          cr->plugin->attr_expiration, 0);
 
+    if (cr->data->entry_expiration
+            && strcmp(cr->plugin->attr_expiration, SYSDB_CACHE_EXPIRE) != 0) {
+        entry_expire = ldb_msg_find_attr_as_uint64(result->msgs[0],
+                                                   SYSDB_CACHE_EXPIRE, 0);
+        expire = MIN(expire, entry_expire);
+    }
+
     ret = sss_cmd_check_cache(result->msgs[0], cr->midpoint, expire);
     if (ret == EOK) {
         return CACHE_OBJECT_VALID;
@@ -281,6 +290,53 @@ cache_req_expiration_status(struct cache_req *cr,
     return CACHE_OBJECT_EXPIRED;
 }
 
+/* The background refresh of the back end prefers recently used objects, so
+ * remember when an object was returned from the cache. The time is written
+ * at most twice per refresh period to keep the timestamp cache writes low. */
+static void cache_req_search_mark_access(struct cache_req *cr,
+                                         struct ldb_result *result)
+{
+    struct sss_domain_info *head;
+    struct ldb_message *msg;
+    time_t granularity;
+    time_t last;
+    time_t now;
+    errno_t ret;
+
+    if (result == NULL || result->count == 0) {
+        return;
+    }
+
+    head = cr->domain->parent != NULL ? cr->domain->parent : cr->domain;
+    if (head->refresh_expired_interval == 0) {
+        return;
+    }
+
+    /* The first message is the object itself, e.g. the user of initgroups */
+    msg = result->msgs[0];
+    granularity = MAX(head->refresh_expired_interval / 2, 1);
+    now = time(NULL);
+    last = ldb_msg_find_attr_as_uint64(msg, SYSDB_LAST_ACCESS, 0);
+    if (now - last < granularity) {
+        return;
+    }
+
+    ret = sysdb_set_entry_access(cr->domain, msg->dn, now);
+    if (ret != EOK) {
+        CACHE_REQ_DEBUG(SSSDBG_MINOR_FAILURE, cr,
+                        "Unable to record access of [%s] [%d]: %s\n",
+                        cr->debugobj, ret, sss_strerror(ret));
+        return;
+    }
+
+    /* Keep the cached copy of the object up to date as well. */
+    ldb_msg_remove_attr(msg, SYSDB_LAST_ACCESS);
+    ret = ldb_msg_add_fmt(msg, SYSDB_LAST_ACCESS, "%lld", (long long)now);
+    if (ret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to update the access time\n");
+    }
+}
+
 struct cache_req_search_state {
     /* input data */
     struct tevent_context *ev;
@@ -290,12 +346,34 @@ struct cache_req_search_state {
     /* output data */
     struct ldb_result *result;
     bool dp_success;
+
+    /* when the request started to wait for the data provider */
+    struct timespec dp_start;
+    bool dp_waited;
+};
+
+/* Data provider lookup shared by identical requests that are in flight
+ * at the same time. */
+struct cache_req_inflight {
+    struct resp_ctx *rctx;
+    const char *key;
+    struct cache_req_inflight_waiter *waiters;
+};
+
+struct cache_req_inflight_waiter {
+    struct cache_req_inflight_waiter *prev;
+    struct cache_req_inflight_waiter *next;
+    struct cache_req_inflight *inflight;
+    struct tevent_req *req;
 };
 
 static errno_t cache_req_search_dp(struct tevent_req *req,
                                    enum cache_object_status status);
+static errno_t cache_req_search_inflight(struct tevent_req *req);
 static void cache_req_search_oob_done(struct tevent_req *subreq);
 static void cache_req_search_done(struct tevent_req *subreq);
+static void cache_req_search_inflight_done(struct tevent_req *subreq);
+static void cache_req_search_dp_finish(struct tevent_req *req);
 
 struct tevent_req *
 cache_req_search_send(TALLOC_CTX *mem_ctx,
@@ -310,6 +388,8 @@ cache_req_search_send(TALLOC_CTX *mem_ctx,
     bool bypass_cache = false;
     bool bypass_dp = false;
     bool skip_refresh = false;
+    bool from_hot = false;
+    bool from_shared = false;
     errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state, struct cache_req_search_state);
@@ -358,20 +438,80 @@ cache_req_search_send(TALLOC_CTX *mem_ctx,
      */
     state->result = NULL;
     status = CACHE_OBJECT_MISSING;
+
+    /* A cache-only search that is followed by a data provider lookup
+     * does not need to search a domain that does not have the object. */
+    if (!bypass_cache && bypass_dp && !skip_refresh
+            && !cache_req_prefilter_may_exist(cr)) {
+        CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                        "[%s] is not cached in this domain\n", cr->debugobj);
+        bypass_cache = true;
+        ret = ENOENT;
+    }
+
     if (!bypass_cache) {
-        ret = cache_req_search_cache(state, cr, &state->result);
+        ret = cache_req_hot_lookup(state, cr, &state->result);
+        from_hot = (ret == EOK);
+        if (ret == ENOENT) {
+            ret = cache_req_shared_lookup(state, cr, &state->result);
+            from_shared = (ret == EOK);
+        }
+        if (ret == ENOENT) {
+            ret = cache_req_search_cache(state, cr, &state->result);
+        }
         if (ret != EOK && ret != ENOENT) {
             goto done;
         }
 
         status = cache_req_expiration_status(cr, state->result);
+        if (status == CACHE_OBJECT_VALID || status == CACHE_OBJECT_MIDPOINT) {
+            cache_req_prefetch_touch(cr, state->result);
+            if (!from_hot) {
+                cache_req_search_mark_access(cr, state->result);
+            }
+        }
+
         if (status == CACHE_OBJECT_VALID) {
+            if (!from_hot) {
+                cache_req_hot_store(cr, state->result);
+            }
+            if (!from_hot && !from_shared) {
+                cache_req_shared_store(cr, state->result);
+            }
             CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
                             "Returning [%s] from cache\n", cr->debugobj);
             ret = EOK;
             goto done;
         }
 
+        /* Waiting for a backend that is about to go offline only delays
+         * the expired entry the client would get anyway. */
+        if (status == CACHE_OBJECT_EXPIRED && cr->domain->degraded
+                && !skip_refresh) {
+            CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                            "Domain is degraded, returning expired [%s] "
+                            "and refreshing it in the background\n",
+                            cr->debugobj);
+            status = CACHE_OBJECT_MIDPOINT;
+        }
+
+        /* The client prefers stale data over waiting for the backend */
+        if (cr->data->allow_stale && status != CACHE_OBJECT_VALID
+                && status != CACHE_OBJECT_MISSING) {
+            if (skip_refresh) {
+                CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                                "Returning stale [%s] from cache\n",
+                                cr->debugobj);
+                ret = EOK;
+                goto done;
+            }
+
+            CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                            "Returning stale [%s] and refreshing it in the "
+                            "background\n", cr->debugobj);
+            status = CACHE_OBJECT_MIDPOINT;
+        }
+
         /* For the CACHE_REQ_CACHE_FIRST case, if bypass_dp is true but we
          * found the object in this domain, we will contact the data provider
          * anyway to refresh it so we can return it without searching the rest
@@ -430,10 +570,12 @@ static errno_t cache_req_search_dp(struct tevent_req *req,
                         "Performing midpoint cache update of [%s]\n",
                         state->cr->debugobj);
 
+        state->rctx->dp_background = true;
         subreq = state->cr->plugin->dp_send_fn(state->rctx, state->cr,
                                                state->cr->data,
                                                state->cr->domain,
                                                state->result);
+        state->rctx->dp_background = false;
         if (subreq == NULL) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Out of memory sending out-of-band "
                                        "data provider request\n");
@@ -450,10 +592,30 @@ static errno_t cache_req_search_dp(struct tevent_req *req,
                         "Looking up [%s] in data provider\n",
                         state->cr->debugobj);
 
+        if (state->cr->dp_lookup_fn != NULL) {
+            state->cr->dp_lookup_fn(state->cr, state->cr->dp_lookup_pvt);
+        }
+
+        sss_cmd_stats_mark_dp(state->cr);
+        clock_gettime(CLOCK_MONOTONIC, &state->dp_start);
+        state->dp_waited = true;
+        PROBE(CACHE_REQ_DP_SEND, state->cr->plugin->name,
+              PROBE_SAFE_STR(state->cr->debugobj), state->cr->domain->name,
+              state->cr->trace_id);
+
+        ret = cache_req_search_inflight(req);
+        if (ret != ENOTSUP) {
+            break;
+        }
+
+        state->rctx->dp_background = state->cr->data->background;
+        state->rctx->dp_refresh = state->cr->data->refresh;
         subreq = state->cr->plugin->dp_send_fn(state->cr, state->cr,
                                                state->cr->data,
                                                state->cr->domain,
                                                state->result);
+        state->rctx->dp_background = false;
+        state->rctx->dp_refresh = false;
         if (subreq == NULL) {
             DEBUG(SSSDBG_CRIT_FAILURE,
                   "Out of memory sending data provider request\n");
@@ -475,6 +637,100 @@ static errno_t cache_req_search_dp(struct tevent_req *req,
     return ret;
 }
 
+static int
+cache_req_inflight_waiter_destructor(struct cache_req_inflight_waiter *waiter)
+{
+    if (waiter->inflight != NULL) {
+        DLIST_REMOVE(waiter->inflight->waiters, waiter);
+    }
+
+    return 0;
+}
+
+/* Sends the data provider request or attaches to an identical one that
+ * is already running. Returns ENOTSUP if the lookup cannot be shared. */
+static errno_t cache_req_search_inflight(struct tevent_req *req)
+{
+    struct cache_req_search_state *state;
+    struct cache_req_inflight *inflight;
+    struct cache_req_inflight_waiter *waiter;
+    struct tevent_req *subreq;
+    struct resp_ctx *rctx;
+    struct cache_req *cr;
+    const char *key;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct cache_req_search_state);
+    cr = state->cr;
+    rctx = cr->rctx;
+
+    key = cache_req_object_key(state, cr);
+    if (key == NULL) {
+        return ENOTSUP;
+    }
+
+    if (rctx->cache_req_inflight == NULL) {
+        rctx->cache_req_inflight = sss_ptr_hash_create(rctx, NULL, NULL);
+        if (rctx->cache_req_inflight == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    inflight = sss_ptr_hash_lookup(rctx->cache_req_inflight, key,
+                                   struct cache_req_inflight);
+    if (inflight != NULL) {
+        rctx->cache_req_coalesced++;
+        CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                        "Waiting for data provider lookup of [%s] that "
+                        "is already in progress\n", cr->debugobj);
+    } else {
+        /* The lookup is owned by the table and not by this request, so
+         * that it keeps running for the other requests if this one is
+         * freed. */
+        inflight = talloc_zero(rctx, struct cache_req_inflight);
+        if (inflight == NULL) {
+            return ENOMEM;
+        }
+
+        inflight->rctx = rctx;
+        inflight->key = talloc_steal(inflight, key);
+
+        subreq = cr->plugin->dp_send_fn(inflight, cr, cr->data, cr->domain,
+                                        state->result);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Out of memory sending data provider request\n");
+            talloc_free(inflight);
+            return ENOMEM;
+        }
+
+        tevent_req_set_callback(subreq, cache_req_search_inflight_done,
+                                inflight);
+
+        ret = sss_ptr_hash_add(rctx->cache_req_inflight, inflight->key,
+                               inflight, struct cache_req_inflight);
+        if (ret != EOK) {
+            talloc_free(inflight);
+            return ret;
+        }
+    }
+
+    waiter = talloc_zero(state, struct cache_req_inflight_waiter);
+    if (waiter == NULL) {
+        if (inflight->waiters == NULL) {
+            talloc_free(inflight);
+        }
+        return ENOMEM;
+    }
+
+    waiter->inflight = inflight;
+    waiter->req = req;
+    DLIST_ADD_END(inflight->waiters, waiter, struct cache_req_inflight_waiter *);
+    talloc_set_destructor(waiter, cache_req_inflight_waiter_destructor);
+
+    return EAGAIN;
+}
+
 static void cache_req_search_oob_done(struct tevent_req *subreq)
 {
     DEBUG(SSSDBG_TRACE_INTERNAL, "Out of band request finished\n");
@@ -487,7 +743,6 @@ static void cache_req_search_done(struct tevent_req *subreq)
 {
     struct cache_req_search_state *state;
     struct tevent_req *req;
-    errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct cache_req_search_state);
@@ -495,6 +750,61 @@ static void cache_req_search_done(struct tevent_req *subreq)
     state->dp_success = state->cr->plugin->dp_recv_fn(subreq, state->cr);
     talloc_zfree(subreq);
 
+    cache_req_search_dp_finish(req);
+}
+
+static void cache_req_search_inflight_done(struct tevent_req *subreq)
+{
+    struct cache_req_search_state *state;
+    struct cache_req_inflight_waiter *waiter;
+    struct cache_req_inflight *inflight;
+    bool dp_success = false;
+
+    inflight = tevent_req_callback_data(subreq, struct cache_req_inflight);
+
+    /* Requests that come from now on start a new lookup. */
+    sss_ptr_hash_delete(inflight->rctx->cache_req_inflight, inflight->key,
+                        false);
+
+    if (inflight->waiters != NULL) {
+        state = tevent_req_data(inflight->waiters->req,
+                                struct cache_req_search_state);
+        dp_success = state->cr->plugin->dp_recv_fn(subreq, state->cr);
+    }
+    talloc_zfree(subreq);
+
+    /* Finishing a request may free other waiters, always take the head. */
+    while ((waiter = inflight->waiters) != NULL) {
+        DLIST_REMOVE(inflight->waiters, waiter);
+        waiter->inflight = NULL;
+
+        state = tevent_req_data(waiter->req, struct cache_req_search_state);
+        state->dp_success = dp_success;
+        cache_req_search_dp_finish(waiter->req);
+    }
+
+    talloc_free(inflight);
+}
+
+static void cache_req_search_dp_finish(struct tevent_req *req)
+{
+    struct cache_req_search_state *state;
+    struct timespec now;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct cache_req_search_state);
+
+    PROBE(CACHE_REQ_DP_RECV, state->cr->plugin->name,
+          PROBE_SAFE_STR(state->cr->debugobj), state->cr->domain->name,
+          state->dp_success, state->cr->trace_id);
+
+    if (state->dp_waited) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        sss_cmd_stats_dp_done(state->cr,
+                              (now.tv_sec - state->dp_start.tv_sec) * 1000000
+                              + (now.tv_nsec - state->dp_start.tv_nsec) / 1000);
+    }
+
     /* Get result from cache again. */
     ret = cache_req_search_cache(state, state->cr, &state->result);
     if (ret != EOK) {
@@ -509,6 +819,12 @@ static void cache_req_search_done(struct tevent_req *subreq)
     }
 
     /* ret == EOK */
+    if (cache_req_expiration_status(state->cr, state->result)
+            == CACHE_OBJECT_VALID) {
+        cache_req_hot_store(state->cr, state->result);
+        cache_req_shared_store(state->cr, state->result);
+    }
+
     ret = cache_req_search_ncache_filter(state, state->cr, &state->result);
     if (ret != EOK) {
         goto done;
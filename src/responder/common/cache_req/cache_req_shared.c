@@ -0,0 +1,664 @@
+/*
+    SSSD
+
+    Cache request - copy of recently used objects shared by the responders
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * During a login the same user is looked up by the PAM, NSS and often
+ * other responders. The object cache of each responder is extended by a
+ * file that all of them map, so the first responder that searches the
+ * sysdb for an object stores the result and the others read it from there.
+ *
+ * The file is laid out like the memory caches of the NSS responder, but
+ * every responder writes to it: the key of the object selects one slot,
+ * a writer takes a record lock on the slot and skips the store if another
+ * process holds it. Readers do not lock; the sequence number of the slot
+ * is odd while it is written and changes with every write, so a reader
+ * that sees it change while copying the slot ignores the copy.
+ *
+ * An entry is valid for object_cache_timeout seconds. Whenever the NSS
+ * responder invalidates its memory caches, the generation in the header
+ * is raised, which invalidates all entries of the file at once.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <ldb.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "shared/murmurhash3.h"
+#include "shared/safealign.h"
+#include "db/sysdb.h"
+#include "responder/common/cache_req/cache_req_private.h"
+#include "responder/common/cache_req/cache_req_plugin.h"
+
+#define CACHE_REQ_SHARED_MAGIC      0x53435251
+#define CACHE_REQ_SHARED_VERSION    1
+#define CACHE_REQ_SHARED_SEED       0x6f626a63
+#define CACHE_REQ_SHARED_SLOTS      2048
+#define CACHE_REQ_SHARED_SLOT_SIZE  8192
+
+/* The header takes the place of one slot at the start of the file. */
+#define CACHE_REQ_SHARED_FILE_SIZE \
+    ((CACHE_REQ_SHARED_SLOTS + 1) * CACHE_REQ_SHARED_SLOT_SIZE)
+
+struct cache_req_shared_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_slots;
+    uint32_t slot_size;
+    uint64_t generation;
+};
+
+struct cache_req_shared_slot {
+    uint32_t seq;
+    uint32_t len;
+    uint64_t hash;
+    uint64_t generation;
+    int64_t expire;
+    /* The key including its NUL, then the packed result. */
+    uint8_t data[];
+};
+
+#define CACHE_REQ_SHARED_DATA_SIZE \
+    (CACHE_REQ_SHARED_SLOT_SIZE - sizeof(struct cache_req_shared_slot))
+
+struct cache_req_shared {
+    int fd;
+    uint8_t *mem;
+    struct cache_req_shared_header *header;
+    time_t timeout;
+};
+
+static int cache_req_shared_destructor(struct cache_req_shared *shared)
+{
+    if (shared->mem != NULL) {
+        munmap(shared->mem, CACHE_REQ_SHARED_FILE_SIZE);
+    }
+
+    if (shared->fd != -1) {
+        close(shared->fd);
+    }
+
+    return 0;
+}
+
+/* Returns EAGAIN if the file has another layout. */
+static errno_t cache_req_shared_open(struct cache_req_shared *shared,
+                                     const char *path)
+{
+    struct cache_req_shared_header *header;
+    struct stat st;
+    bool created = false;
+    void *mem;
+    errno_t ret;
+
+    shared->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (shared->fd == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to open %s [%d]: %s\n",
+              path, ret, sss_strerror(ret));
+        return ret;
+    }
+
+    /* Only one responder may set up a new file. */
+    if (flock(shared->fd, LOCK_EX) == -1) {
+        ret = errno;
+        goto done;
+    }
+
+    if (fstat(shared->fd, &st) == -1) {
+        ret = errno;
+        goto done;
+    }
+
+    if (st.st_size == 0) {
+        if (ftruncate(shared->fd, CACHE_REQ_SHARED_FILE_SIZE) == -1) {
+            ret = errno;
+            goto done;
+        }
+        created = true;
+    } else if (st.st_size != CACHE_REQ_SHARED_FILE_SIZE) {
+        ret = EAGAIN;
+        goto done;
+    }
+
+    mem = mmap(NULL, CACHE_REQ_SHARED_FILE_SIZE, PROT_READ | PROT_WRITE,
+               MAP_SHARED, shared->fd, 0);
+    if (mem == MAP_FAILED) {
+        ret = errno;
+        goto done;
+    }
+    shared->mem = mem;
+    header = (struct cache_req_shared_header *)shared->mem;
+
+    if (created) {
+        header->version = CACHE_REQ_SHARED_VERSION;
+        header->num_slots = CACHE_REQ_SHARED_SLOTS;
+        header->slot_size = CACHE_REQ_SHARED_SLOT_SIZE;
+        header->generation = 0;
+        __sync_synchronize();
+        header->magic = CACHE_REQ_SHARED_MAGIC;
+    } else if (header->magic != CACHE_REQ_SHARED_MAGIC
+            || header->version != CACHE_REQ_SHARED_VERSION
+            || header->num_slots != CACHE_REQ_SHARED_SLOTS
+            || header->slot_size != CACHE_REQ_SHARED_SLOT_SIZE) {
+        ret = EAGAIN;
+        goto done;
+    }
+
+    shared->header = header;
+    ret = EOK;
+
+done:
+    if (ret != EOK && ret != EAGAIN) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to set up %s [%d]: %s\n",
+              path, ret, sss_strerror(ret));
+    }
+
+    if (ret != EOK) {
+        if (shared->mem != NULL) {
+            munmap(shared->mem, CACHE_REQ_SHARED_FILE_SIZE);
+            shared->mem = NULL;
+        }
+        close(shared->fd);
+        shared->fd = -1;
+        return ret;
+    }
+
+    flock(shared->fd, LOCK_UN);
+    return EOK;
+}
+
+errno_t cache_req_shared_init(struct resp_ctx *rctx,
+                              const char *path,
+                              time_t timeout)
+{
+    struct cache_req_shared *shared;
+    errno_t ret;
+
+    talloc_zfree(rctx->cache_req_shared);
+
+    if (timeout <= 0) {
+        DEBUG(SSSDBG_CONF_SETTINGS, "Shared object cache is disabled\n");
+        return EOK;
+    }
+
+    shared = talloc_zero(rctx, struct cache_req_shared);
+    if (shared == NULL) {
+        return ENOMEM;
+    }
+    shared->fd = -1;
+    shared->timeout = timeout;
+    talloc_set_destructor(shared, cache_req_shared_destructor);
+
+    ret = cache_req_shared_open(shared, path);
+    if (ret == EAGAIN) {
+        /* Left behind by another version; processes that still have it
+         * mapped keep using the removed file. */
+        DEBUG(SSSDBG_TRACE_FUNC, "Replacing %s of another layout\n", path);
+        if (unlink(path) == -1) {
+            ret = errno;
+        } else {
+            ret = cache_req_shared_open(shared, path);
+        }
+    }
+
+    if (ret != EOK) {
+        talloc_free(shared);
+        return ret;
+    }
+
+    rctx->cache_req_shared = shared;
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Shared object cache %s keeps objects "
+          "for %ld seconds\n", path, (long)timeout);
+
+    return EOK;
+}
+
+void cache_req_shared_invalidate(struct resp_ctx *rctx)
+{
+    struct cache_req_shared *shared = rctx->cache_req_shared;
+
+    if (shared == NULL) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Invalidating shared object cache\n");
+
+    __sync_add_and_fetch(&shared->header->generation, 1);
+}
+
+static struct cache_req_shared_slot *
+cache_req_shared_slot(struct cache_req_shared *shared,
+                      uint64_t hash,
+                      off_t *_offset)
+{
+    off_t offset;
+
+    offset = (hash % CACHE_REQ_SHARED_SLOTS + 1) * CACHE_REQ_SHARED_SLOT_SIZE;
+    if (_offset != NULL) {
+        *_offset = offset;
+    }
+
+    return (struct cache_req_shared_slot *)(shared->mem + offset);
+}
+
+static errno_t cache_req_shared_put(uint8_t *buf, size_t *_p,
+                                    const void *data, size_t len)
+{
+    if (len > CACHE_REQ_SHARED_DATA_SIZE - *_p) {
+        return ERANGE;
+    }
+
+    memcpy(buf + *_p, data, len);
+    *_p += len;
+
+    return EOK;
+}
+
+static errno_t cache_req_shared_put_blob(uint8_t *buf, size_t *_p,
+                                         const void *data, size_t len)
+{
+    uint32_t len32 = len;
+    errno_t ret;
+
+    ret = cache_req_shared_put(buf, _p, &len32, sizeof(len32));
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return cache_req_shared_put(buf, _p, data, len);
+}
+
+/* The result is stored as the number of messages and for each message its
+ * DN and elements, each element with its name and values. The numbers are
+ * 32-bit and every string or value is preceded by its length. */
+static errno_t cache_req_shared_pack(uint8_t *buf,
+                                     size_t *_p,
+                                     struct ldb_result *result)
+{
+    struct ldb_message_element *el;
+    const char *dn;
+    unsigned int i;
+    unsigned int j;
+    unsigned int k;
+    uint32_t num;
+    errno_t ret;
+
+    num = result->count;
+    ret = cache_req_shared_put(buf, _p, &num, sizeof(num));
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (i = 0; i < result->count; i++) {
+        dn = ldb_dn_get_linearized(result->msgs[i]->dn);
+        if (dn == NULL) {
+            return EINVAL;
+        }
+
+        ret = cache_req_shared_put_blob(buf, _p, dn, strlen(dn));
+        if (ret != EOK) {
+            return ret;
+        }
+
+        num = result->msgs[i]->num_elements;
+        ret = cache_req_shared_put(buf, _p, &num, sizeof(num));
+        if (ret != EOK) {
+            return ret;
+        }
+
+        for (j = 0; j < result->msgs[i]->num_elements; j++) {
+            el = &result->msgs[i]->elements[j];
+
+            ret = cache_req_shared_put_blob(buf, _p, el->name,
+                                            strlen(el->name));
+            if (ret != EOK) {
+                return ret;
+            }
+
+            num = el->num_values;
+            ret = cache_req_shared_put(buf, _p, &num, sizeof(num));
+            if (ret != EOK) {
+                return ret;
+            }
+
+            for (k = 0; k < el->num_values; k++) {
+                ret = cache_req_shared_put_blob(buf, _p, el->values[k].data,
+                                                el->values[k].length);
+                if (ret != EOK) {
+                    return ret;
+                }
+            }
+        }
+    }
+
+    return EOK;
+}
+
+static errno_t cache_req_shared_get_blob(TALLOC_CTX *mem_ctx,
+                                         const uint8_t *buf,
+                                         size_t len,
+                                         size_t *_p,
+                                         struct ldb_val *_val)
+{
+    uint32_t blob_len;
+    uint8_t *data;
+
+    SAFEALIGN_COPY_UINT32_CHECK(&blob_len, buf + *_p, len, _p);
+    if (blob_len > len - *_p) {
+        return EINVAL;
+    }
+
+    /* Values in ldb are NUL terminated. */
+    data = talloc_size(mem_ctx, blob_len + 1);
+    if (data == NULL) {
+        return ENOMEM;
+    }
+
+    SAFEALIGN_MEMCPY_CHECK(data, buf + *_p, blob_len, len, _p);
+    data[blob_len] = '\0';
+
+    _val->data = data;
+    _val->length = blob_len;
+
+    return EOK;
+}
+
+static errno_t cache_req_shared_unpack_msg(struct ldb_message *msg,
+                                           struct ldb_context *ldb,
+                                           const uint8_t *buf,
+                                           size_t len,
+                                           size_t *_p)
+{
+    struct ldb_message_element *el;
+    struct ldb_val val;
+    uint32_t num;
+    uint32_t i;
+    uint32_t j;
+    errno_t ret;
+
+    ret = cache_req_shared_get_blob(msg, buf, len, _p, &val);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    msg->dn = ldb_dn_new(msg, ldb, (const char *)val.data);
+    talloc_free(val.data);
+    if (msg->dn == NULL) {
+        return ENOMEM;
+    }
+
+    SAFEALIGN_COPY_UINT32_CHECK(&num, buf + *_p, len, _p);
+    if (num > (len - *_p) / sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    msg->elements = talloc_zero_array(msg, struct ldb_message_element, num);
+    if (msg->elements == NULL) {
+        return ENOMEM;
+    }
+    msg->num_elements = num;
+
+    for (i = 0; i < msg->num_elements; i++) {
+        el = &msg->elements[i];
+
+        ret = cache_req_shared_get_blob(msg->elements, buf, len, _p, &val);
+        if (ret != EOK) {
+            return ret;
+        }
+        el->name = (const char *)val.data;
+
+        SAFEALIGN_COPY_UINT32_CHECK(&num, buf + *_p, len, _p);
+        if (num > (len - *_p) / sizeof(uint32_t)) {
+            return EINVAL;
+        }
+
+        el->values = talloc_zero_array(msg->elements, struct ldb_val, num);
+        if (el->values == NULL) {
+            return ENOMEM;
+        }
+        el->num_values = num;
+
+        for (j = 0; j < el->num_values; j++) {
+            ret = cache_req_shared_get_blob(el->values, buf, len, _p,
+                                            &el->values[j]);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
+    }
+
+    return EOK;
+}
+
+static errno_t cache_req_shared_unpack(TALLOC_CTX *mem_ctx,
+                                       struct ldb_context *ldb,
+                                       const uint8_t *buf,
+                                       size_t len,
+                                       struct ldb_result **_result)
+{
+    struct ldb_result *result;
+    size_t p = 0;
+    uint32_t count;
+    uint32_t i;
+    errno_t ret;
+
+    SAFEALIGN_COPY_UINT32_CHECK(&count, buf, len, &p);
+    if (count == 0 || count > (len - p) / sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    result = talloc_zero(mem_ctx, struct ldb_result);
+    if (result == NULL) {
+        return ENOMEM;
+    }
+
+    result->msgs = talloc_zero_array(result, struct ldb_message *, count + 1);
+    if (result->msgs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < count; i++) {
+        result->msgs[i] = ldb_msg_new(result->msgs);
+        if (result->msgs[i] == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = cache_req_shared_unpack_msg(result->msgs[i], ldb, buf, len, &p);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+    result->count = count;
+
+    *_result = result;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(result);
+    }
+    return ret;
+}
+
+errno_t cache_req_shared_lookup(TALLOC_CTX *mem_ctx,
+                                struct cache_req *cr,
+                                struct ldb_result **_result)
+{
+    struct cache_req_shared *shared = cr->rctx->cache_req_shared;
+    struct cache_req_shared_slot *slot;
+    struct cache_req_shared_slot copy;
+    TALLOC_CTX *tmp_ctx;
+    const char *key;
+    uint8_t *data;
+    size_t key_size;
+    uint64_t hash;
+    errno_t ret;
+
+    if (shared == NULL) {
+        return ENOENT;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    key = cache_req_hot_key(tmp_ctx, cr);
+    if (key == NULL) {
+        ret = ENOENT;
+        goto done;
+    }
+    key_size = strlen(key) + 1;
+    hash = murmurhash3(key, key_size, CACHE_REQ_SHARED_SEED);
+    slot = cache_req_shared_slot(shared, hash, NULL);
+
+    copy.seq = slot->seq;
+    __sync_synchronize();
+    if (copy.seq & 1) {
+        /* being written */
+        ret = ENOENT;
+        goto done;
+    }
+
+    memcpy(&copy, slot, sizeof(copy));
+    if (copy.hash != hash || copy.len <= key_size
+            || copy.len > CACHE_REQ_SHARED_DATA_SIZE) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    data = talloc_size(tmp_ctx, copy.len);
+    if (data == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    memcpy(data, slot->data, copy.len);
+
+    __sync_synchronize();
+    if (slot->seq != copy.seq) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    if (copy.generation != shared->header->generation
+            || copy.expire < time(NULL)
+            || memcmp(data, key, key_size) != 0) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    ret = cache_req_shared_unpack(mem_ctx,
+                                  sysdb_ctx_get_ldb(cr->domain->sysdb),
+                                  data + key_size, copy.len - key_size,
+                                  _result);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to read [%s] from the shared "
+              "object cache [%d]: %s\n", key, ret, sss_strerror(ret));
+        ret = ENOENT;
+        goto done;
+    }
+
+    CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                    "Found [%s] in shared object cache\n", cr->debugobj);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+void cache_req_shared_store(struct cache_req *cr,
+                            struct ldb_result *result)
+{
+    struct cache_req_shared *shared = cr->rctx->cache_req_shared;
+    struct cache_req_shared_slot *slot;
+    TALLOC_CTX *tmp_ctx;
+    struct flock lock;
+    const char *key;
+    uint8_t *data;
+    uint64_t hash;
+    uint32_t seq;
+    off_t offset;
+    size_t len = 0;
+    errno_t ret;
+
+    if (shared == NULL || result == NULL || result->count == 0) {
+        return;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return;
+    }
+
+    key = cache_req_hot_key(tmp_ctx, cr);
+    data = talloc_size(tmp_ctx, CACHE_REQ_SHARED_DATA_SIZE);
+    if (key == NULL || data == NULL) {
+        goto done;
+    }
+
+    ret = cache_req_shared_put(data, &len, key, strlen(key) + 1);
+    if (ret == EOK) {
+        ret = cache_req_shared_pack(data, &len, result);
+    }
+    if (ret != EOK) {
+        /* too large for a slot */
+        goto done;
+    }
+
+    hash = murmurhash3(key, strlen(key) + 1, CACHE_REQ_SHARED_SEED);
+    slot = cache_req_shared_slot(shared, hash, &offset);
+
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = offset;
+    lock.l_len = CACHE_REQ_SHARED_SLOT_SIZE;
+    if (fcntl(shared->fd, F_SETLK, &lock) == -1) {
+        /* another responder is writing the slot */
+        goto done;
+    }
+
+    /* A writer that died left an odd number behind. */
+    seq = slot->seq | 1;
+    slot->seq = seq;
+    __sync_synchronize();
+
+    slot->len = len;
+    slot->hash = hash;
+    slot->generation = shared->header->generation;
+    slot->expire = time(NULL) + shared->timeout;
+    memcpy(slot->data, data, len);
+
+    __sync_synchronize();
+    slot->seq = seq + 1;
+
+    lock.l_type = F_UNLCK;
+    fcntl(shared->fd, F_SETLK, &lock);
+
+done:
+    talloc_free(tmp_ctx);
+}
@@ -35,7 +35,7 @@ struct cache_req_sr_overlay_state {
 static errno_t cache_req_sr_overlay_match_users(
                                 struct cache_req_sr_overlay_state *state);
 
-static errno_t cache_req_sr_overlay_match_users(
+static bool cache_req_sr_overlay_find_next(
                                 struct cache_req_sr_overlay_state *state);
 
 static struct tevent_req *cache_req_sr_overlay_match_all_step_send(
@@ -82,6 +82,12 @@ struct tevent_req *cache_req_sr_overlay_send(
                  rctx->sr_conf.groups[0] != NULL) ||
                 (rctx->sr_conf.exclude_groups != NULL &&
                  rctx->sr_conf.exclude_groups[0] != NULL)) {
+                if (!cache_req_sr_overlay_find_next(state)) {
+                    /* The stored decisions of all users are current */
+                    ret = EOK;
+                    break;
+                }
+
                 /* Pull and match group and user names for each user entry */
                 subreq = cache_req_sr_overlay_match_all_step_send(state);
                 if (subreq == NULL) {
@@ -230,6 +236,44 @@ done:
     return ret;
 }
 
+/* The backend decides whether the sessions of a user are recorded each time
+ * it resolves the groups of the user and stores the decision on the user
+ * entry. As long as the initgroups data of the entry are valid, the stored
+ * value is used as it is, so that a group scope does not cost an initgroups
+ * request for every user lookup. */
+static bool cache_req_sr_overlay_is_current(struct ldb_message *msg)
+{
+    uint64_t expire;
+
+    if (ldb_msg_find_element(msg, SYSDB_SESSION_RECORDING) == NULL) {
+        return false;
+    }
+
+    expire = ldb_msg_find_attr_as_uint64(msg, SYSDB_INITGR_EXPIRE, 0);
+    return expire > time(NULL);
+}
+
+/* Moves to the next user entry, starting with the current one, whose groups
+ * have to be resolved. Returns false if there is none. */
+static bool cache_req_sr_overlay_find_next(
+                                struct cache_req_sr_overlay_state *state)
+{
+    struct cache_req_result *result;
+
+    for (; state->res_idx < state->num_results; state->res_idx++) {
+        result = state->results[state->res_idx];
+        for (; state->msg_idx < result->count; state->msg_idx++) {
+            if (!cache_req_sr_overlay_is_current(
+                                result->msgs[state->msg_idx])) {
+                return true;
+            }
+        }
+        state->msg_idx = 0;
+    }
+
+    return false;
+}
+
 static struct tevent_req *cache_req_sr_overlay_match_all_step_send(
                                 struct cache_req_sr_overlay_state *state)
 {
@@ -308,14 +352,9 @@ static void cache_req_sr_overlay_match_all_step_done(
 
     /* Move onto next entry, if any */
     state->msg_idx++;
-    if (state->msg_idx >=
-            state->results[state->res_idx]->count) {
-        state->res_idx++;
-        if (state->res_idx >= state->num_results) {
-            ret = EOK;
-            goto done;
-        }
-        state->msg_idx = 0;
+    if (!cache_req_sr_overlay_find_next(state)) {
+        ret = EOK;
+        goto done;
     }
 
     /* Schedule next entry overlay */
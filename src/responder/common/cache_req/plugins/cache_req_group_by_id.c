@@ -87,7 +87,13 @@ cache_req_group_by_id_lookup(TALLOC_CTX *mem_ctx,
     if (ret != EOK) {
         return ret;
     }
-    return sysdb_getgrgid_with_views(mem_ctx, domain, data->id, _result);
+
+    if (data->attrs == NULL) {
+        return sysdb_getgrgid_with_views(mem_ctx, domain, data->id, _result);
+    }
+
+    return sysdb_get_group_attr_by_gid_with_views(mem_ctx, domain, data->id,
+                                                  data->attrs, _result);
 }
 
 static errno_t
@@ -243,3 +249,26 @@ cache_req_group_by_id_send(TALLOC_CTX *mem_ctx,
                                          CACHE_REQ_POSIX_DOM, domain,
                                          data);
 }
+
+struct tevent_req *
+cache_req_group_by_id_attrs_send(TALLOC_CTX *mem_ctx,
+                                 struct tevent_context *ev,
+                                 struct resp_ctx *rctx,
+                                 struct sss_nc_ctx *ncache,
+                                 int cache_refresh_percent,
+                                 const char *domain,
+                                 gid_t gid,
+                                 const char **attrs)
+{
+    struct cache_req_data *data;
+
+    data = cache_req_data_id_attrs(mem_ctx, CACHE_REQ_GROUP_BY_ID, gid, attrs);
+    if (data == NULL) {
+        return NULL;
+    }
+
+    return cache_req_steal_data_and_send(mem_ctx, ev, rctx, ncache,
+                                         cache_refresh_percent,
+                                         CACHE_REQ_POSIX_DOM, domain,
+                                         data);
+}
@@ -75,6 +75,22 @@ cache_req_ip_network_by_name_create_debug_name(TALLOC_CTX *mem_ctx,
     return talloc_asprintf(mem_ctx, "%s@%s", name, domain->name);
 }
 
+static errno_t
+cache_req_ip_network_by_name_ncache_check(struct sss_nc_ctx *ncache,
+                                          struct sss_domain_info *domain,
+                                          struct cache_req_data *data)
+{
+    return sss_ncache_check_network(ncache, domain, data->name.lookup);
+}
+
+static errno_t
+cache_req_ip_network_by_name_ncache_add(struct sss_nc_ctx *ncache,
+                                        struct sss_domain_info *domain,
+                                        struct cache_req_data *data)
+{
+    return sss_ncache_set_network(ncache, false, domain, data->name.lookup);
+}
+
 static errno_t
 cache_req_ip_network_by_name_lookup(TALLOC_CTX *mem_ctx,
                                     struct cache_req *cr,
@@ -134,8 +150,8 @@ const struct cache_req_plugin cache_req_ip_network_by_name = {
     .prepare_domain_data_fn = cache_req_ip_network_by_name_prepare_domain_data,
     .create_debug_name_fn = cache_req_ip_network_by_name_create_debug_name,
     .global_ncache_add_fn = NULL,
-    .ncache_check_fn = NULL,
-    .ncache_add_fn = NULL,
+    .ncache_check_fn = cache_req_ip_network_by_name_ncache_check,
+    .ncache_add_fn = cache_req_ip_network_by_name_ncache_add,
     .ncache_filter_fn = NULL,
     .lookup_fn = cache_req_ip_network_by_name_lookup,
     .dp_send_fn = cache_req_ip_network_by_name_dp_send,
@@ -19,11 +19,11 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <fcntl.h>
 #include <time.h>
-#include "tdb.h"
 #include "util/util.h"
+#include "util/probes.h"
 #include "util/nss_dl_load.h"
+#include "shared/wyhash.h"
 #include "confdb/confdb.h"
 #include "responder/common/negcache_files.h"
 #include "responder/common/responder.h"
@@ -35,6 +35,10 @@
 #define NC_GROUP_PREFIX NC_ENTRY_PREFIX"GROUP"
 #define NC_NETGROUP_PREFIX NC_ENTRY_PREFIX"NETGR"
 #define NC_SERVICE_PREFIX NC_ENTRY_PREFIX"SERVICE"
+#define NC_HOST_PREFIX NC_ENTRY_PREFIX"HOST"
+#define NC_HOST_ADDR_PREFIX NC_ENTRY_PREFIX"HOST_ADDR"
+#define NC_NETWORK_PREFIX NC_ENTRY_PREFIX"NETWORK"
+#define NC_NETWORK_ADDR_PREFIX NC_ENTRY_PREFIX"NETWORK_ADDR"
 #define NC_UID_PREFIX NC_ENTRY_PREFIX"UID"
 #define NC_GID_PREFIX NC_ENTRY_PREFIX"GID"
 #define NC_SID_PREFIX NC_ENTRY_PREFIX"SID"
@@ -42,10 +46,43 @@
 #define NC_DOMAIN_ACCT_LOCATE_PREFIX NC_ENTRY_PREFIX"DOM_LOCATE"
 #define NC_DOMAIN_ACCT_LOCATE_TYPE_PREFIX NC_ENTRY_PREFIX"DOM_LOCATE_TYPE"
 
+/* Initial number of slots in the table, must be a power of two */
+#define NC_TABLE_MIN_SIZE 1024
+#define NC_HASH_SEED 0x4e43
+
+/* Entries that are reset together by sss_ncache_reset_users() and
+ * sss_ncache_reset_groups() */
+enum sss_nc_class {
+    NC_CLASS_OTHER = 0,
+    NC_CLASS_USERS,
+    NC_CLASS_GROUPS,
+
+    NC_CLASS_SENTINEL
+};
+
+struct sss_nc_entry {
+    char *key;              /* NULL if the slot is not used */
+    uint32_t hash;
+    uint32_t generation;    /* generation of the class when stored */
+    time_t expire;          /* 0 for permanent entries */
+    enum sss_nc_class class;
+    bool deleted;           /* removed entry, keeps the probe chain intact */
+};
+
+/* The entries are kept in an open addressing table with linear probing.
+ * Resetting a class of entries only bumps its generation; entries that are
+ * expired or belong to an older generation are removed when a lookup finds
+ * them or when the table is rebuilt. */
 struct sss_nc_ctx {
-    struct tdb_context *tdb;
+    struct sss_nc_entry *table;
+    uint32_t size;          /* number of slots */
+    uint32_t used;          /* slots with an entry or a deleted entry */
+    uint32_t count;         /* slots with an entry */
+    uint32_t generation[NC_CLASS_SENTINEL];
+
     uint32_t timeout;
     uint32_t local_timeout;
+    uint32_t resolver_timeout;  /* hosts and networks */
     struct sss_nss_ops ops;
 };
 
@@ -56,16 +93,6 @@ static int sss_ncache_set_ent(struct sss_nc_ctx *ctx, bool permanent,
                               struct sss_domain_info *dom, const char *name,
                               ncache_set_byname_fn_t setter);
 
-static int string_to_tdb_data(char *str, TDB_DATA *ret)
-{
-    if (!str || !ret) return EINVAL;
-
-    ret->dptr = (uint8_t *)str;
-    ret->dsize = strlen(str)+1;
-
-    return EOK;
-}
-
 static errno_t ncache_load_nss_symbols(struct sss_nss_ops *ops)
 {
     errno_t ret;
@@ -102,13 +129,17 @@ int sss_ncache_init(TALLOC_CTX *memctx, uint32_t timeout,
         return ret;
     }
 
-    errno = 0;
-    /* open a memory only tdb with default hash size */
-    ctx->tdb = tdb_open("memcache", 0, TDB_INTERNAL, O_RDWR|O_CREAT, 0);
-    if (!ctx->tdb) return errno;
+    ctx->table = talloc_zero_array(ctx, struct sss_nc_entry,
+                                   NC_TABLE_MIN_SIZE);
+    if (ctx->table == NULL) {
+        talloc_free(ctx);
+        return ENOMEM;
+    }
+    ctx->size = NC_TABLE_MIN_SIZE;
 
     ctx->timeout = timeout;
     ctx->local_timeout = local_timeout;
+    ctx->resolver_timeout = timeout;
 
     *_ctx = ctx;
     return EOK;
@@ -119,107 +150,241 @@ uint32_t sss_ncache_get_timeout(struct sss_nc_ctx *ctx)
     return ctx->timeout;
 }
 
-static int sss_ncache_check_str(struct sss_nc_ctx *ctx, char *str)
+void sss_ncache_set_resolver_timeout(struct sss_nc_ctx *ctx, uint32_t timeout)
 {
-    TDB_DATA key;
-    TDB_DATA data;
-    unsigned long long int timestamp;
-    bool expired = false;
-    char *ep;
-    int ret;
+    ctx->resolver_timeout = timeout;
+}
 
-    DEBUG(SSSDBG_TRACE_INTERNAL, "Checking negative cache for [%s]\n", str);
+uint32_t sss_ncache_get_resolver_timeout(struct sss_nc_ctx *ctx)
+{
+    return ctx->resolver_timeout;
+}
 
-    data.dptr = NULL;
+static enum sss_nc_class sss_ncache_class(const char *str)
+{
+    if (strncmp(str, NC_USER_PREFIX, sizeof(NC_USER_PREFIX) - 1) == 0
+            || strncmp(str, NC_UID_PREFIX, sizeof(NC_UID_PREFIX) - 1) == 0) {
+        return NC_CLASS_USERS;
+    }
 
-    ret = string_to_tdb_data(str, &key);
-    if (ret != EOK) goto done;
+    if (strncmp(str, NC_GROUP_PREFIX, sizeof(NC_GROUP_PREFIX) - 1) == 0
+            || strncmp(str, NC_GID_PREFIX, sizeof(NC_GID_PREFIX) - 1) == 0) {
+        return NC_CLASS_GROUPS;
+    }
 
-    data = tdb_fetch(ctx->tdb, key);
+    return NC_CLASS_OTHER;
+}
 
-    if (!data.dptr) {
-        ret = ENOENT;
-        goto done;
+static bool sss_ncache_entry_valid(struct sss_nc_ctx *ctx,
+                                   struct sss_nc_entry *entry,
+                                   time_t now)
+{
+    if (entry->expire == 0) {
+        /* permanent entries are only removed by sss_ncache_reset_permanent */
+        return true;
     }
 
-    errno = 0;
-    timestamp = strtoull((const char *)data.dptr, &ep, 10);
-    if (errno != 0 || *ep != '\0') {
-        /* Malformed entry, remove it and return no entry */
-        expired = true;
-        goto done;
+    return entry->expire >= now
+           && entry->generation == ctx->generation[entry->class];
+}
+
+static void sss_ncache_entry_remove(struct sss_nc_ctx *ctx,
+                                    struct sss_nc_entry *entry)
+{
+    talloc_zfree(entry->key);
+    entry->deleted = true;
+    ctx->count--;
+}
+
+/* Returns the slot that holds the key or NULL */
+static struct sss_nc_entry *sss_ncache_lookup(struct sss_nc_ctx *ctx,
+                                              const char *str,
+                                              uint32_t hash)
+{
+    struct sss_nc_entry *entry;
+    uint32_t mask = ctx->size - 1;
+    uint32_t i;
+
+    for (i = hash & mask; ; i = (i + 1) & mask) {
+        entry = &ctx->table[i];
+        if (entry->key == NULL) {
+            if (!entry->deleted) {
+                return NULL;
+            }
+            continue;
+        }
+
+        if (entry->hash == hash && strcmp(entry->key, str) == 0) {
+            return entry;
+        }
     }
+}
 
-    if (timestamp == 0) {
-        /* a 0 timestamp means this is a permanent entry */
-        ret = EEXIST;
-        goto done;
+/* Returns the first free slot of the probe chain of the hash */
+static struct sss_nc_entry *sss_ncache_free_slot(struct sss_nc_entry *table,
+                                                 uint32_t size,
+                                                 uint32_t hash)
+{
+    uint32_t mask = size - 1;
+    uint32_t i;
+
+    for (i = hash & mask; table[i].key != NULL; i = (i + 1) & mask);
+
+    return &table[i];
+}
+
+/* Moves the entries to a new table of the given size, dropping the
+ * deleted slots. */
+static errno_t sss_ncache_rehash(struct sss_nc_ctx *ctx, uint32_t size)
+{
+    struct sss_nc_entry *table;
+    struct sss_nc_entry *entry;
+    struct sss_nc_entry *slot;
+    uint32_t count = 0;
+    uint32_t i;
+
+    table = talloc_zero_array(ctx, struct sss_nc_entry, size);
+    if (table == NULL) {
+        return ENOMEM;
     }
 
-    if (timestamp >= time(NULL)) {
-        /* still valid */
-        ret = EEXIST;
-        goto done;
+    for (i = 0; i < ctx->size; i++) {
+        entry = &ctx->table[i];
+        if (entry->key == NULL) {
+            continue;
+        }
+
+        slot = sss_ncache_free_slot(table, size, entry->hash);
+        *slot = *entry;
+        count++;
     }
 
-    expired = true;
+    talloc_free(ctx->table);
+    ctx->table = table;
+    ctx->size = size;
+    ctx->used = count;
+    ctx->count = count;
 
-done:
-    if (expired) {
-        /* expired, remove and return no entry */
-        tdb_delete(ctx->tdb, key);
-        ret = ENOENT;
+    return EOK;
+}
+
+/* Moves the valid entries to a new table, dropping the others and the
+ * deleted slots. The table grows when it is at least half full. */
+static errno_t sss_ncache_rebuild(struct sss_nc_ctx *ctx)
+{
+    struct sss_nc_entry *entry;
+    uint32_t size;
+    time_t now;
+    uint32_t i;
+
+    now = time(NULL);
+    for (i = 0; i < ctx->size; i++) {
+        entry = &ctx->table[i];
+        if (entry->key != NULL && !sss_ncache_entry_valid(ctx, entry, now)) {
+            sss_ncache_entry_remove(ctx, entry);
+        }
     }
 
-    free(data.dptr);
-    return ret;
+    size = ctx->size;
+    if (ctx->count * 2 >= size) {
+        size *= 2;
+    }
+
+    return sss_ncache_rehash(ctx, size);
 }
 
-static int sss_ncache_set_str(struct sss_nc_ctx *ctx, char *str,
-                              bool permanent, bool use_local_negative)
+static int sss_ncache_check_str(struct sss_nc_ctx *ctx, char *str)
 {
-    TDB_DATA key;
-    TDB_DATA data;
-    char *timest;
-    unsigned long long int timell;
-    int ret;
+    struct sss_nc_entry *entry;
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Checking negative cache for [%s]\n", str);
+
+    entry = sss_ncache_lookup(ctx, str, wyhash32(str, strlen(str),
+                                                 NC_HASH_SEED));
+    if (entry == NULL) {
+        return ENOENT;
+    }
+
+    if (!sss_ncache_entry_valid(ctx, entry, time(NULL))) {
+        /* expired, remove and return no entry */
+        sss_ncache_entry_remove(ctx, entry);
+        return ENOENT;
+    }
+
+    PROBE(NEGCACHE_HIT, str);
+    return EEXIST;
+}
 
-    ret = string_to_tdb_data(str, &key);
-    if (ret != EOK) return ret;
+static int sss_ncache_set_str_ttl(struct sss_nc_ctx *ctx, char *str,
+                                  bool permanent, uint32_t ttl)
+{
+    struct sss_nc_entry *entry;
+    enum sss_nc_class class;
+    time_t expire;
+    uint32_t hash;
+    errno_t ret;
 
     if (permanent) {
-        timest = talloc_strdup(ctx, "0");
+        expire = 0;
     } else {
-        if (use_local_negative == true && ctx->local_timeout > ctx->timeout) {
-            timell = ctx->local_timeout;
-        } else {
-            /* EOK is tested in cwrap based unit test */
-            if (ctx->timeout == 0) {
-                return EOK;
-            }
-            timell = ctx->timeout;
+        /* EOK is tested in cwrap based unit test */
+        if (ttl == 0) {
+            return EOK;
         }
-        timell += (unsigned long long int)time(NULL);
-        timest = talloc_asprintf(ctx, "%llu", timell);
+        expire = ttl + time(NULL);
     }
-    if (!timest) return ENOMEM;
-
-    ret = string_to_tdb_data(timest, &data);
-    if (ret != EOK) goto done;
 
     DEBUG(SSSDBG_TRACE_FUNC, "Adding [%s] to negative cache%s\n",
               str, permanent?" permanently":"");
+    PROBE(NEGCACHE_SET, str, permanent);
+
+    hash = wyhash32(str, strlen(str), NC_HASH_SEED);
+    class = sss_ncache_class(str);
+
+    entry = sss_ncache_lookup(ctx, str, hash);
+    if (entry == NULL) {
+        /* keep at least a quarter of the slots free for short probes */
+        if ((ctx->used + 1) * 4 > ctx->size * 3) {
+            ret = sss_ncache_rebuild(ctx);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_CRIT_FAILURE,
+                      "Negative cache failed to set entry: [%s]\n",
+                      sss_strerror(ret));
+                return ret;
+            }
+        }
 
-    ret = tdb_store(ctx->tdb, key, data, TDB_REPLACE);
-    if (ret != 0) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Negative cache failed to set entry: [%s]\n",
-                  tdb_errorstr(ctx->tdb));
-        ret = EFAULT;
+        entry = sss_ncache_free_slot(ctx->table, ctx->size, hash);
+        entry->key = talloc_strdup(ctx, str);
+        if (entry->key == NULL) {
+            return ENOMEM;
+        }
+
+        if (!entry->deleted) {
+            ctx->used++;
+        }
+        entry->deleted = false;
+        entry->hash = hash;
+        ctx->count++;
     }
 
-done:
-    talloc_free(timest);
-    return ret;
+    entry->expire = expire;
+    entry->class = class;
+    entry->generation = ctx->generation[class];
+
+    return EOK;
+}
+
+static int sss_ncache_set_str(struct sss_nc_ctx *ctx, char *str,
+                              bool permanent, bool use_local_negative)
+{
+    uint32_t ttl = ctx->timeout;
+
+    if (use_local_negative == true && ctx->local_timeout > ctx->timeout) {
+        ttl = ctx->local_timeout;
+    }
+
+    return sss_ncache_set_str_ttl(ctx, str, permanent, ttl);
 }
 
 static int sss_ncache_check_user_int(struct sss_nc_ctx *ctx, const char *domain,
@@ -437,6 +602,101 @@ int sss_ncache_check_service_port(struct sss_nc_ctx *ctx,
 
 
 
+/* Host and network names are case insensitive, the cache requests look
+ * them up in lower case. Addresses are in the form of inet_ntop(). */
+static int sss_ncache_check_resolver(struct sss_nc_ctx *ctx,
+                                     const char *prefix,
+                                     struct sss_domain_info *dom,
+                                     const char *key)
+{
+    char *str;
+    int ret;
+
+    if (!key || !*key) return EINVAL;
+
+    str = talloc_asprintf(ctx, "%s/%s/%s", prefix, dom->name, key);
+    if (!str) return ENOMEM;
+
+    ret = sss_ncache_check_str(ctx, str);
+
+    talloc_free(str);
+    return ret;
+}
+
+static int sss_ncache_set_resolver(struct sss_nc_ctx *ctx, bool permanent,
+                                   const char *prefix,
+                                   struct sss_domain_info *dom,
+                                   const char *key)
+{
+    char *str;
+    int ret;
+
+    if (!key || !*key) return EINVAL;
+
+    str = talloc_asprintf(ctx, "%s/%s/%s", prefix, dom->name, key);
+    if (!str) return ENOMEM;
+
+    ret = sss_ncache_set_str_ttl(ctx, str, permanent, ctx->resolver_timeout);
+
+    talloc_free(str);
+    return ret;
+}
+
+int sss_ncache_check_host(struct sss_nc_ctx *ctx, struct sss_domain_info *dom,
+                          const char *name)
+{
+    return sss_ncache_check_resolver(ctx, NC_HOST_PREFIX, dom, name);
+}
+
+int sss_ncache_check_host_addr(struct sss_nc_ctx *ctx,
+                               struct sss_domain_info *dom,
+                               const char *addr)
+{
+    return sss_ncache_check_resolver(ctx, NC_HOST_ADDR_PREFIX, dom, addr);
+}
+
+int sss_ncache_check_network(struct sss_nc_ctx *ctx,
+                             struct sss_domain_info *dom,
+                             const char *name)
+{
+    return sss_ncache_check_resolver(ctx, NC_NETWORK_PREFIX, dom, name);
+}
+
+int sss_ncache_check_network_addr(struct sss_nc_ctx *ctx,
+                                  struct sss_domain_info *dom,
+                                  const char *addr)
+{
+    return sss_ncache_check_resolver(ctx, NC_NETWORK_ADDR_PREFIX, dom, addr);
+}
+
+int sss_ncache_set_host(struct sss_nc_ctx *ctx, bool permanent,
+                        struct sss_domain_info *dom, const char *name)
+{
+    return sss_ncache_set_resolver(ctx, permanent, NC_HOST_PREFIX, dom, name);
+}
+
+int sss_ncache_set_host_addr(struct sss_nc_ctx *ctx, bool permanent,
+                             struct sss_domain_info *dom, const char *addr)
+{
+    return sss_ncache_set_resolver(ctx, permanent, NC_HOST_ADDR_PREFIX,
+                                   dom, addr);
+}
+
+int sss_ncache_set_network(struct sss_nc_ctx *ctx, bool permanent,
+                           struct sss_domain_info *dom, const char *name)
+{
+    return sss_ncache_set_resolver(ctx, permanent, NC_NETWORK_PREFIX,
+                                   dom, name);
+}
+
+int sss_ncache_set_network_addr(struct sss_nc_ctx *ctx, bool permanent,
+                                struct sss_domain_info *dom,
+                                const char *addr)
+{
+    return sss_ncache_set_resolver(ctx, permanent, NC_NETWORK_ADDR_PREFIX,
+                                   dom, addr);
+}
+
 int sss_ncache_check_uid(struct sss_nc_ctx *ctx, struct sss_domain_info *dom,
                          uid_t uid)
 {
@@ -851,114 +1111,100 @@ int sss_ncache_check_locate_uid(struct sss_nc_ctx *ctx,
     return ret;
 }
 
-static int delete_permanent(struct tdb_context *tdb,
-                            TDB_DATA key, TDB_DATA data, void *state)
+int sss_ncache_reset_permanent(struct sss_nc_ctx *ctx)
 {
-    unsigned long long int timestamp;
-    bool remove_key = false;
-    char *ep;
+    uint32_t i;
 
-    if (strncmp((char *)key.dptr,
-                NC_ENTRY_PREFIX, sizeof(NC_ENTRY_PREFIX) - 1) != 0) {
-        /* not interested in this key */
-        return 0;
-    }
-
-    errno = 0;
-    timestamp = strtoull((const char *)data.dptr, &ep, 10);
-    if (errno != 0 || *ep != '\0') {
-        /* Malformed entry, remove it */
-        remove_key = true;
-        goto done;
+    for (i = 0; i < ctx->size; i++) {
+        if (ctx->table[i].key != NULL && ctx->table[i].expire == 0) {
+            sss_ncache_entry_remove(ctx, &ctx->table[i]);
+        }
     }
 
-    if (timestamp == 0) {
-        /* a 0 timestamp means this is a permanent entry */
-        remove_key = true;
-    }
+    return EOK;
+}
 
-done:
-    if (remove_key) {
-        return tdb_delete(tdb, key);
-    }
+/* Permanent entries of the class are kept */
+static int sss_ncache_reset_class(struct sss_nc_ctx *ctx,
+                                  enum sss_nc_class class)
+{
+    ctx->generation[class]++;
 
-    return 0;
+    return EOK;
 }
 
-int sss_ncache_reset_permanent(struct sss_nc_ctx *ctx)
+int sss_ncache_shrink(struct sss_nc_ctx *ctx)
 {
-    int ret;
+    uint32_t size;
+    uint32_t i;
+
+    for (i = 0; i < ctx->size; i++) {
+        if (ctx->table[i].key != NULL && ctx->table[i].expire != 0) {
+            sss_ncache_entry_remove(ctx, &ctx->table[i]);
+        }
+    }
 
-    ret = tdb_traverse(ctx->tdb, delete_permanent, NULL);
-    if (ret < 0)
-        return EIO;
+    for (size = NC_TABLE_MIN_SIZE; ctx->count * 2 >= size; size *= 2);
 
-    return EOK;
+    DEBUG(SSSDBG_TRACE_FUNC, "Shrinking negative cache from %"PRIu32" to "
+          "%"PRIu32" slots\n", ctx->size, size);
+
+    return sss_ncache_rehash(ctx, size);
 }
 
-static int delete_prefix(struct tdb_context *tdb,
-                         TDB_DATA key, TDB_DATA data, void *state)
+errno_t sss_ncache_foreach(struct sss_nc_ctx *ctx,
+                           sss_ncache_entry_fn fn,
+                           void *pvt)
 {
-    const char *prefix = (const char *) state;
-    unsigned long long int timestamp;
-    char *ep = NULL;
+    struct sss_nc_entry *entry;
+    time_t now;
+    uint32_t i;
+    errno_t ret;
 
-    if (strncmp((char *)key.dptr, prefix, strlen(prefix) - 1) != 0) {
-        /* not interested in this key */
-        return 0;
-    }
+    now = time(NULL);
+    for (i = 0; i < ctx->size; i++) {
+        entry = &ctx->table[i];
+        if (entry->key == NULL || entry->expire == 0
+                || !sss_ncache_entry_valid(ctx, entry, now)) {
+            continue;
+        }
 
-    errno = 0;
-    timestamp = strtoull((const char *)data.dptr, &ep, 10);
-    if ((errno == 0) && (*ep == '\0') && (timestamp == 0)) {
-        /* skip permanent entries */
-        return 0;
+        ret = fn(entry->key, entry->expire, pvt);
+        if (ret != EOK) {
+            return ret;
+        }
     }
 
-    return tdb_delete(tdb, key);
+    return EOK;
 }
 
-static int sss_ncache_reset_pfx(struct sss_nc_ctx *ctx,
-                                const char **prefixes)
+errno_t sss_ncache_restore(struct sss_nc_ctx *ctx, const char *key,
+                           time_t expire)
 {
-    int ret;
+    time_t now;
 
-    if (prefixes == NULL) {
-        return EOK;
+    if (key == NULL || strncmp(key, NC_ENTRY_PREFIX,
+                               sizeof(NC_ENTRY_PREFIX) - 1) != 0) {
+        return EINVAL;
     }
 
-    for (int i = 0; prefixes[i] != NULL; i++) {
-        ret = tdb_traverse(ctx->tdb,
-                           delete_prefix,
-                           discard_const(prefixes[i]));
-        if (ret < 0) {
-            return EIO;
-        }
+    now = time(NULL);
+    if (expire <= now) {
+        return EOK;
     }
 
-    return EOK;
+    return sss_ncache_set_str_ttl(ctx, discard_const(key), false,
+                                  expire - now);
 }
 
 int sss_ncache_reset_users(struct sss_nc_ctx *ctx)
 {
-    const char *prefixes[] = {
-        NC_USER_PREFIX,
-        NC_UID_PREFIX,
-        NULL,
-    };
-
-    return sss_ncache_reset_pfx(ctx, prefixes);
+    return sss_ncache_reset_class(ctx, NC_CLASS_USERS);
 }
 
 int sss_ncache_reset_groups(struct sss_nc_ctx *ctx)
 {
-    const char *prefixes[] = {
-        NC_GROUP_PREFIX,
-        NC_GID_PREFIX,
-        NULL,
-    };
-
-    return sss_ncache_reset_pfx(ctx, prefixes);
+    return sss_ncache_reset_class(ctx, NC_CLASS_GROUPS);
 }
 
 errno_t sss_ncache_prepopulate(struct sss_nc_ctx *ncache,
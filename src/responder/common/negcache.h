@@ -30,6 +30,11 @@ int sss_ncache_init(TALLOC_CTX *memctx, uint32_t timeout,
 
 uint32_t sss_ncache_get_timeout(struct sss_nc_ctx *ctx);
 
+/* time to live of the entries of hosts and networks, the default is the
+ * timeout of sss_ncache_init() */
+void sss_ncache_set_resolver_timeout(struct sss_nc_ctx *ctx, uint32_t timeout);
+uint32_t sss_ncache_get_resolver_timeout(struct sss_nc_ctx *ctx);
+
 /* check if the user is expired according to the passed in time to live */
 int sss_ncache_check_user(struct sss_nc_ctx *ctx, struct sss_domain_info *dom,
                           const char *name);
@@ -54,6 +59,17 @@ int sss_ncache_check_service_port(struct sss_nc_ctx *ctx,
                                   struct sss_domain_info *dom,
                                   uint16_t port,
                                   const char *proto);
+int sss_ncache_check_host(struct sss_nc_ctx *ctx, struct sss_domain_info *dom,
+                          const char *name);
+int sss_ncache_check_host_addr(struct sss_nc_ctx *ctx,
+                               struct sss_domain_info *dom,
+                               const char *addr);
+int sss_ncache_check_network(struct sss_nc_ctx *ctx,
+                             struct sss_domain_info *dom,
+                             const char *name);
+int sss_ncache_check_network_addr(struct sss_nc_ctx *ctx,
+                                  struct sss_domain_info *dom,
+                                  const char *addr);
 
 /* add a new neg-cache entry setting the timestamp to "now" unless
  * "permanent" is set to true, in which case the timestamps is set to 0
@@ -80,6 +96,15 @@ int sss_ncache_set_service_name(struct sss_nc_ctx *ctx, bool permanent,
 int sss_ncache_set_service_port(struct sss_nc_ctx *ctx, bool permanent,
                                 struct sss_domain_info *dom,
                                 uint16_t port, const char *proto);
+int sss_ncache_set_host(struct sss_nc_ctx *ctx, bool permanent,
+                        struct sss_domain_info *dom, const char *name);
+int sss_ncache_set_host_addr(struct sss_nc_ctx *ctx, bool permanent,
+                             struct sss_domain_info *dom, const char *addr);
+int sss_ncache_set_network(struct sss_nc_ctx *ctx, bool permanent,
+                           struct sss_domain_info *dom, const char *name);
+int sss_ncache_set_network_addr(struct sss_nc_ctx *ctx, bool permanent,
+                                struct sss_domain_info *dom,
+                                const char *addr);
 /*
  * Mark the lookup_type as not supporting the negative cache. This
  * would be used by the corresponding checker to avoid needless
@@ -149,6 +174,22 @@ int sss_ncache_reset_permanent(struct sss_nc_ctx *ctx);
 /* sss_ncache_reset_[users/groups] skips permanent entries */
 int sss_ncache_reset_users(struct sss_nc_ctx *ctx);
 int sss_ncache_reset_groups(struct sss_nc_ctx *ctx);
+/* Removes all entries but the permanent ones and releases the memory of
+ * the table */
+int sss_ncache_shrink(struct sss_nc_ctx *ctx);
+
+/* Calls fn for each valid entry that expires, so the entries can outlive
+ * the process. The permanent entries are not listed, they are built from
+ * the configuration. */
+typedef errno_t (*sss_ncache_entry_fn)(const char *key, time_t expire,
+                                       void *pvt);
+errno_t sss_ncache_foreach(struct sss_nc_ctx *ctx,
+                           sss_ncache_entry_fn fn,
+                           void *pvt);
+/* Stores an entry listed by sss_ncache_foreach() again, it is ignored if
+ * it has expired in the meantime. */
+errno_t sss_ncache_restore(struct sss_nc_ctx *ctx, const char *key,
+                           time_t expire);
 
 struct resp_ctx;
 
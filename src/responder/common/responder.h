@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <sys/un.h>
 #include <sys/resource.h>
+#include <time.h>
 #include <talloc.h>
 #include <tevent.h>
 #include <ldb.h>
@@ -62,14 +63,68 @@ extern hash_table_t *dp_requests;
     (provider != NULL && \
       (!local_provider_is_built() || strcmp(provider, "local") != 0))
 
+/* Maximum number of complete requests a client that pipelines requests
+ * may have waiting for execution before we stop reading from it */
+#define CLI_MAX_QUEUED_REQUESTS 16
+
 /* needed until nsssrv.h is updated */
 struct cli_request {
+    struct cli_request *prev;
+    struct cli_request *next;
 
     /* original request from the wire */
     struct sss_packet *in;
 
     /* reply data */
     struct sss_packet *out;
+
+    /* Accounting of the request in the command statistics */
+    struct resp_ctx *rctx;
+    struct timespec start;
+    int cmd_index;
+    bool queued;
+    bool executing;
+    bool dp_called;
+    bool replied;
+
+    /* Identifies the request in the debug messages of the responder and
+     * of the data provider */
+    uint32_t trace_id;
+    /* Sampled requests log the time spent in each stage */
+    bool traced;
+    struct timespec received;
+    uint64_t dp_usecs;
+    unsigned int dp_lookups;
+
+    /* Memory of the command, NULL if request_pool_size is 0, and the
+     * bytes allocated from it when the reply was ready */
+    TALLOC_CTX *pool;
+    size_t pool_used;
+};
+
+/* Latency histogram bucket i counts the commands that took between 2^i and
+ * 2^(i+1) microseconds, the last one also the slower ones. */
+#define SSS_CMD_STATS_BUCKETS 24
+
+enum sss_cmd_stats_result {
+    SSS_CMD_STATS_CACHE,    /* answered without asking the data provider */
+    SSS_CMD_STATS_DP,       /* the data provider was asked */
+    SSS_CMD_STATS_ERROR,    /* error reply or client went away */
+
+    SSS_CMD_STATS_RESULTS
+};
+
+struct sss_cmd_stats {
+    uint64_t count[SSS_CMD_STATS_RESULTS];
+    uint64_t usecs[SSS_CMD_STATS_RESULTS];
+    uint64_t buckets[SSS_CMD_STATS_RESULTS][SSS_CMD_STATS_BUCKETS];
+
+    /* Memory used by the requests that had a pool, and how many of them
+     * used more than the pool holds */
+    uint64_t pool_requests;
+    uint64_t pool_used_sum;
+    uint64_t pool_used_max;
+    uint64_t pool_overflows;
 };
 
 struct cli_protocol_version {
@@ -79,8 +134,16 @@ struct cli_protocol_version {
 };
 
 struct cli_protocol {
+    /* request being executed */
     struct cli_request *creq;
     struct cli_protocol_version *cli_protocol_version;
+
+    /* Clients that tag their requests may send the next requests before
+     * they get the reply to the current one. They are received into rreq
+     * and wait in the queue, replies are sent in the order of requests. */
+    struct cli_request *rreq;
+    struct cli_request *queue;
+    int num_queued;
 };
 
 struct resp_ctx;
@@ -110,17 +173,31 @@ struct resp_ctx {
     const char *priv_sock_name;
 
     struct sss_nc_ctx *ncache;
+    /* Called after the negative or the object cache was reset on request
+     * of a backend, NULL if the responder has nothing else to drop */
+    void (*caches_reset_cb)(struct resp_ctx *rctx);
     struct sss_names_ctx *global_names;
 
     struct sbus_connection *mon_conn;
     struct be_conn *be_conns;
 
+    /* Set while sending a data provider request that nobody waits for. */
+    bool dp_background;
+    /* Set while sending a data provider request that refreshes the cache. */
+    bool dp_refresh;
+
     struct sss_domain_info *domains;
     int domains_timeout;
     int client_idle_timeout;
 
     struct cache_req_domain *cr_domains;
     const char *domain_resolution_order;
+    /* Fingerprint of the domains cr_domains was built from */
+    uint64_t domains_fingerprint;
+    bool domains_fingerprint_valid;
+    /* Domain list the previous instance ended with, 0 if there is none */
+    time_t saved_domains_time;
+    uint64_t saved_domains_fingerprint;
 
     time_t last_request_time;
     int idle_timeout;
@@ -148,6 +225,40 @@ struct resp_ctx {
     struct session_recording_conf sr_conf;
 
     uint32_t cache_req_num;
+    /* Data provider lookups in flight and the number of requests that
+     * were attached to one of them instead of sending their own */
+    hash_table_t *cache_req_inflight;
+    uint64_t cache_req_coalesced;
+    /* Recently looked up objects, NULL if disabled */
+    struct cache_req_hot *cache_req_hot;
+    /* Recently looked up objects of all responders, NULL if disabled */
+    struct cache_req_shared *cache_req_shared;
+    /* Names and IDs cached in each domain, NULL if disabled */
+    struct cache_req_prefilter *cache_req_prefilter;
+    /* Lookups of the objects returned from the cache, NULL if disabled */
+    struct cache_req_prefetch *cache_req_prefetch;
+
+    /* Statistics of each entry of sss_cmds */
+    struct sss_cmd_stats *cmd_stats;
+    uint64_t cmd_in_flight;
+    uint64_t cmd_queued;
+
+    /* Requests per second of the clients of each uid, NULL if unlimited */
+    struct sss_client_throttle *client_throttle;
+
+    /* Next request trace ID, one of every trace_sampling client requests
+     * logs its timings, 0 disables it */
+    uint32_t trace_id_next;
+    int trace_sampling;
+    uint64_t trace_count;
+
+    /* Size of the memory pool of each client request, 0 disables it */
+    size_t request_pool_size;
+
+    /* Connected clients, for the memory accounting */
+    struct cli_ctx *clients;
+    /* Caches are dropped close to this limit, NULL if there is none */
+    struct sss_mem_limit *mem_limit;
 
     void *pvt_ctx;
 
@@ -155,17 +266,25 @@ struct resp_ctx {
     bool socket_activated;
     bool dbus_activated;
     bool cache_first;
+    bool parallel_domain_lookup;
     bool enumeration_warn_logged;
 };
 
 struct cli_creds;
+struct sss_client_bucket;
+struct sss_client_wait;
 
 struct cli_ctx {
+    struct cli_ctx *prev;
+    struct cli_ctx *next;
+
     struct tevent_context *ev;
     struct resp_ctx *rctx;
     int cfd;
     struct tevent_fd *cfde;
     tevent_fd_handler_t cfd_handler;
+    /* Sends the reply of the current request on the next loop iteration */
+    struct tevent_immediate *reply_im;
     struct sockaddr_un addr;
     int priv;
 
@@ -176,6 +295,10 @@ struct cli_ctx {
 
     struct tevent_timer *idle;
     time_t last_request_time;
+
+    /* Request budget shared by the clients of the same uid */
+    struct sss_client_bucket *bucket;
+    struct sss_client_wait *bucket_wait;
 };
 
 struct sss_cmd_table {
@@ -195,6 +318,8 @@ typedef int (*connection_setup_t)(struct cli_ctx *cctx);
 
 int sss_connection_setup(struct cli_ctx *cctx);
 
+void sss_client_reply_ready(struct cli_ctx *cctx);
+
 void sss_client_fd_handler(void *ptr,
                            void (*recv_fn) (struct cli_ctx *cctx),
                            void (*send_fn) (struct cli_ctx *cctx),
@@ -232,11 +357,45 @@ int sss_cmd_send_empty(struct cli_ctx *cctx);
 int sss_cmd_send_error(struct cli_ctx *cctx, int err);
 void sss_cmd_done(struct cli_ctx *cctx, void *freectx);
 int sss_cmd_get_version(struct cli_ctx *cctx);
+errno_t sss_cmd_stats_init(struct resp_ctx *rctx);
+void sss_cmd_stats_queue(struct resp_ctx *rctx, struct cli_request *creq);
+void sss_cmd_stats_start(struct resp_ctx *rctx, struct cli_request *creq);
+void sss_cmd_stats_mark_dp(const void *ptr);
+void sss_cmd_stats_dp_done(const void *ptr, uint64_t usecs);
+TALLOC_CTX *sss_cmd_mem_ctx(struct cli_ctx *cctx);
+
+/* responder_mem.c */
+
+/* Bytes allocated by the responder, the categories are part of total */
+struct sss_mem_usage {
+    uint64_t total;
+    uint64_t clients;       /* connections and the requests they run */
+    uint64_t object_cache;
+    uint64_t negcache;
+    uint64_t prefilter;
+    uint64_t packet_pool;   /* unused buffers only */
+};
+
+void sss_mem_usage_get(struct resp_ctx *rctx, struct sss_mem_usage *usage);
+errno_t sss_mem_limit_init(struct resp_ctx *rctx, uint64_t soft_limit);
+void sss_mem_limit_stats(struct resp_ctx *rctx,
+                         uint64_t *_soft_limit,
+                         uint64_t *_sheds);
+uint32_t sss_cmd_new_trace_id(struct resp_ctx *rctx);
+void sss_cmd_trace_start(struct cli_ctx *cctx, struct cli_request *creq);
 int sss_cmd_execute(struct cli_ctx *cctx,
                     enum sss_cli_command cmd,
                     struct sss_cmd_table *sss_cmds);
 struct cli_protocol_version *register_cli_protocol_version(void);
 
+/* responder_state.c */
+
+/* Path of the state file of the responder, next to the caches */
+char *sss_resp_state_path(TALLOC_CTX *mem_ctx, struct resp_ctx *rctx);
+errno_t sss_resp_state_save(struct resp_ctx *rctx, const char *path);
+/* Restores the saved state and removes the file, ENOENT if there is none */
+errno_t sss_resp_state_load(struct resp_ctx *rctx, const char *path);
+
 struct setent_req_list;
 
 /* A facility for notifying setent requests */
@@ -318,6 +477,10 @@ void responder_set_fd_limit(rlim_t fd_limit);
 
 errno_t reset_client_idle_timer(struct cli_ctx *cctx);
 
+/* Arms the idle timer of the client, which terminates the connection after
+ * client_idle_timeout seconds without activity */
+errno_t setup_client_idle_timer(struct cli_ctx *cctx);
+
 errno_t responder_setup_idle_timeout_config(struct resp_ctx *rctx);
 
 #define GET_DOMAINS_DEFAULT_TIMEOUT 60
@@ -376,6 +539,14 @@ errno_t csv_string_to_uid_array(TALLOC_CTX *mem_ctx, const char *csv_string,
                                 size_t *_uid_count, uid_t **_uids);
 
 uid_t client_euid(struct cli_creds *creds);
+
+errno_t sss_client_throttle_init(struct resp_ctx *rctx, uint32_t rate);
+errno_t sss_client_throttle_attach(struct cli_ctx *cctx);
+bool sss_client_throttle_admit(struct cli_ctx *cctx);
+void sss_client_throttle_stats(struct resp_ctx *rctx,
+                               uint64_t *_deferred,
+                               uint64_t *_waiting,
+                               uint64_t *_uids);
 errno_t check_allowed_uids(uid_t uid, size_t allowed_uids_count,
                            uid_t *allowed_uids);
 
@@ -452,4 +623,10 @@ sss_resp_register_sbus_iface(struct sbus_connection *conn,
 errno_t
 sss_resp_register_service_iface(struct resp_ctx *rctx);
 
+/**
+ * Register responder statistics sbus interface on monitor connection.
+ */
+errno_t
+sss_resp_register_stats_iface(struct resp_ctx *rctx);
+
 #endif /* __SSS_RESPONDER_H__ */
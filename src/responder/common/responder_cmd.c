@@ -21,8 +21,11 @@
 #include <errno.h>
 #include "db/sysdb.h"
 #include "util/util.h"
+#include "util/probes.h"
 #include "responder/common/responder.h"
 #include "responder/common/responder_packet.h"
+#include "util/sss_cli_cmd.h"
+#include "util/util_creds.h"
 
 
 int sss_cmd_send_error(struct cli_ctx *cctx, int err)
@@ -93,9 +96,18 @@ int sss_cmd_send_empty(struct cli_ctx *cctx)
 
 void sss_cmd_done(struct cli_ctx *cctx, void *freectx)
 {
-    /* now that the packet is in place, unlock queue
-     * making the event writable */
-    TEVENT_FD_WRITEABLE(cctx->cfde);
+    struct cli_protocol *pctx;
+
+    /* the command data is still allocated, measure the pool before it
+     * is freed */
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    if (pctx != NULL && pctx->creq != NULL && pctx->creq->pool != NULL) {
+        pctx->creq->pool_used = talloc_total_size(pctx->creq->pool)
+                                - talloc_get_size(pctx->creq->pool);
+    }
+
+    /* now that the packet is in place, send it */
+    sss_client_reply_ready(cctx);
 
     /* free all request related data through the talloc hierarchy */
     talloc_free(freectx);
@@ -162,6 +174,269 @@ int sss_cmd_get_version(struct cli_ctx *cctx)
     return EOK;
 }
 
+errno_t sss_cmd_stats_init(struct resp_ctx *rctx)
+{
+    size_t num_cmds;
+
+    for (num_cmds = 0; rctx->sss_cmds[num_cmds].cmd != SSS_CLI_NULL;
+            num_cmds++);
+
+    rctx->cmd_stats = talloc_zero_array(rctx, struct sss_cmd_stats, num_cmds);
+    if (rctx->cmd_stats == NULL) {
+        return ENOMEM;
+    }
+
+    /* the backend gets the requests of all responders, start at a random
+     * ID so that they are unlikely to overlap in its logs */
+    rctx->trace_id_next = sss_rand();
+
+    return EOK;
+}
+
+static unsigned int sss_cmd_stats_bucket(uint64_t usecs)
+{
+    unsigned int i;
+
+    for (i = 0; i < SSS_CMD_STATS_BUCKETS - 1 && usecs >= 2; i++) {
+        usecs >>= 1;
+    }
+
+    return i;
+}
+
+static uint64_t sss_cmd_usecs(const struct timespec *from,
+                              const struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) * 1000000
+           + (to->tv_nsec - from->tv_nsec) / 1000;
+}
+
+static void sss_cmd_trace_printf(const char *format, ...)
+                SSS_ATTRIBUTE_PRINTF(1, 2);
+
+/* The sampled traces are written at any debug level. */
+static void sss_cmd_trace_printf(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    sss_vdebug_fn(__FILE__, __LINE__, "sss_cmd_trace", SSSDBG_TRACE_FUNC, 0,
+                  format, ap);
+    va_end(ap);
+}
+
+static void sss_cmd_trace_write(struct cli_request *creq,
+                                enum sss_cmd_stats_result result,
+                                uint64_t usecs)
+{
+    const char *results[] = { "cache", "data provider", "error" };
+
+    debug_trace_id = creq->trace_id;
+    sss_cmd_trace_printf("Trace of [%s]: queued %"PRIu64" us, executed "
+                         "%"PRIu64" us, data provider %"PRIu64" us in %u "
+                         "lookups, result [%s]\n",
+                         sss_cmd2str(sss_packet_get_cmd(creq->in)),
+                         sss_cmd_usecs(&creq->received, &creq->start),
+                         usecs, creq->dp_usecs, creq->dp_lookups,
+                         results[result]);
+}
+
+static void sss_cmd_stats_record(struct cli_request *creq)
+{
+    struct sss_cmd_stats *stats;
+    enum sss_cmd_stats_result result;
+    struct timespec now;
+    uint64_t usecs;
+
+    if (creq->cmd_index < 0 || creq->rctx->cmd_stats == NULL) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    usecs = sss_cmd_usecs(&creq->start, &now);
+
+    if (!creq->replied || creq->out == NULL
+            || sss_packet_get_status(creq->out) != EOK) {
+        result = SSS_CMD_STATS_ERROR;
+    } else if (creq->dp_called) {
+        result = SSS_CMD_STATS_DP;
+    } else {
+        result = SSS_CMD_STATS_CACHE;
+    }
+
+    stats = &creq->rctx->cmd_stats[creq->cmd_index];
+    stats->count[result]++;
+    stats->usecs[result] += usecs;
+    stats->buckets[result][sss_cmd_stats_bucket(usecs)]++;
+
+    if (creq->pool != NULL) {
+        stats->pool_requests++;
+        stats->pool_used_sum += creq->pool_used;
+        if (creq->pool_used > stats->pool_used_max) {
+            stats->pool_used_max = creq->pool_used;
+        }
+        if (creq->pool_used > creq->rctx->request_pool_size) {
+            stats->pool_overflows++;
+        }
+    }
+
+    if (creq->traced) {
+        sss_cmd_trace_write(creq, result, usecs);
+    }
+}
+
+static int sss_cmd_stats_destructor(struct cli_request *creq)
+{
+    if (creq->queued) {
+        creq->rctx->cmd_queued--;
+    }
+
+    if (creq->executing) {
+        creq->rctx->cmd_in_flight--;
+        sss_cmd_stats_record(creq);
+    }
+
+    return 0;
+}
+
+/* Called when a complete request is waiting for execution */
+void sss_cmd_stats_queue(struct resp_ctx *rctx, struct cli_request *creq)
+{
+    creq->rctx = rctx;
+    creq->queued = true;
+    creq->cmd_index = -1;
+    rctx->cmd_queued++;
+
+    if (rctx->trace_sampling > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &creq->received);
+    }
+
+    talloc_set_destructor(creq, sss_cmd_stats_destructor);
+}
+
+/* Called right before the request is executed, the statistics are
+ * recorded once the request is freed after its reply was sent. */
+void sss_cmd_stats_start(struct resp_ctx *rctx, struct cli_request *creq)
+{
+    enum sss_cli_command cmd;
+    int i;
+
+    if (creq->queued) {
+        creq->queued = false;
+        rctx->cmd_queued--;
+    }
+
+    cmd = sss_packet_get_cmd(creq->in);
+    for (i = 0; rctx->sss_cmds[i].cmd != SSS_CLI_NULL; i++) {
+        if (rctx->sss_cmds[i].cmd == cmd) {
+            break;
+        }
+    }
+
+    creq->rctx = rctx;
+    creq->cmd_index = rctx->sss_cmds[i].cmd == cmd ? i : -1;
+    creq->executing = true;
+    rctx->cmd_in_flight++;
+    clock_gettime(CLOCK_MONOTONIC, &creq->start);
+
+    if (rctx->request_pool_size > 0 && creq->pool == NULL) {
+        /* Without the pool the command just allocates from the heap */
+        creq->pool = talloc_pool(creq, rctx->request_pool_size);
+        if (creq->pool == NULL) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to allocate request pool\n");
+        }
+    }
+
+    talloc_set_destructor(creq, sss_cmd_stats_destructor);
+}
+
+/* Marks the client request that @ptr belongs to as one that needed the
+ * data provider. Lookups that are not done for a client are ignored. */
+void sss_cmd_stats_mark_dp(const void *ptr)
+{
+    struct cli_protocol *pctx;
+    struct cli_ctx *cctx;
+
+    cctx = talloc_find_parent_bytype(ptr, struct cli_ctx);
+    if (cctx == NULL) {
+        return;
+    }
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    if (pctx != NULL && pctx->creq != NULL) {
+        pctx->creq->dp_called = true;
+    }
+}
+
+/* Adds the time a data provider lookup took to the client request that
+ * @ptr belongs to. */
+void sss_cmd_stats_dp_done(const void *ptr, uint64_t usecs)
+{
+    struct cli_protocol *pctx;
+    struct cli_ctx *cctx;
+
+    cctx = talloc_find_parent_bytype(ptr, struct cli_ctx);
+    if (cctx == NULL) {
+        return;
+    }
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    if (pctx != NULL && pctx->creq != NULL) {
+        pctx->creq->dp_usecs += usecs;
+        pctx->creq->dp_lookups++;
+    }
+}
+
+/* Returns the memory context of the data of the command being executed.
+ * It is the pool of the request if there is one, the data must be freed
+ * before the reply is sent. */
+TALLOC_CTX *sss_cmd_mem_ctx(struct cli_ctx *cctx)
+{
+    struct cli_protocol *pctx;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    if (pctx == NULL || pctx->creq == NULL || pctx->creq->pool == NULL) {
+        return cctx;
+    }
+
+    return pctx->creq->pool;
+}
+
+uint32_t sss_cmd_new_trace_id(struct resp_ctx *rctx)
+{
+    /* 0 means no trace ID */
+    if (rctx->trace_id_next == 0) {
+        rctx->trace_id_next++;
+    }
+
+    return rctx->trace_id_next++;
+}
+
+/* Gives the request its trace ID right before it is executed. The client
+ * knows the request by its pid and the tag of the request, the debug
+ * message maps them to the trace ID. */
+void sss_cmd_trace_start(struct cli_ctx *cctx, struct cli_request *creq)
+{
+    struct resp_ctx *rctx = cctx->rctx;
+
+    creq->trace_id = sss_cmd_new_trace_id(rctx);
+    debug_trace_id = creq->trace_id;
+
+    if (rctx->trace_sampling > 0) {
+        creq->traced = (rctx->trace_count++ % rctx->trace_sampling == 0);
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Client [%p][pid %d] executing [%s] with tag [%u]\n",
+          cctx, cctx->creds != NULL ? (int)cli_creds_get_pid(cctx->creds) : -1,
+          sss_cmd2str(sss_packet_get_cmd(creq->in)),
+          sss_packet_get_tag(creq->in));
+
+    PROBE(RESPONDER_CLIENT_EXEC, cctx->cfd,
+          sss_cmd2str(sss_packet_get_cmd(creq->in)),
+          sss_packet_get_tag(creq->in), creq->trace_id);
+}
+
 int sss_cmd_execute(struct cli_ctx *cctx,
                     enum sss_cli_command cmd,
                     struct sss_cmd_table *sss_cmds)
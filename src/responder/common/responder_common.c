@@ -34,11 +34,16 @@
 #include <dbus/dbus.h>
 
 #include "util/util.h"
+#include "util/probes.h"
+#include "util/sss_cli_cmd.h"
 #include "util/strtonum.h"
+#include "util/sss_ptr_hash.h"
+#include "shared/wyhash.h"
 #include "db/sysdb.h"
 #include "confdb/confdb.h"
 #include "responder/common/responder.h"
 #include "responder/common/responder_packet.h"
+#include "responder/common/cache_req/cache_req.h"
 #include "providers/data_provider.h"
 #include "util/util_creds.h"
 #include "sss_iface/sss_iface_async.h"
@@ -269,6 +274,351 @@ done:
     return ret;
 }
 
+static void client_process_queue(struct cli_ctx *cctx);
+
+/*
+ * The clients of each uid share a token bucket that is refilled with
+ * client_rate_limit tokens per second and holds at most one second worth
+ * of them. Each executed request takes a token. A client that finds the
+ * bucket empty keeps its requests queued and is not read from until the
+ * bucket is refilled, the clients are then served in the order in which
+ * they had to wait. The buckets are kept for a while after the last
+ * client of the uid disconnects, so that reconnecting does not reset
+ * the budget.
+ */
+
+#define CLIENT_TOKEN 1000000
+
+struct sss_client_throttle {
+    struct resp_ctx *rctx;
+    hash_table_t *buckets;
+    uint64_t rate;
+
+    uint64_t deferred;
+    uint64_t waiting;
+};
+
+struct sss_client_wait {
+    struct sss_client_wait *prev;
+    struct sss_client_wait *next;
+    struct sss_client_bucket *bucket;
+    struct cli_ctx *cctx;
+    /* Got its token, no longer waiting */
+    bool granted;
+};
+
+struct sss_client_bucket {
+    struct sss_client_throttle *throttle;
+    struct tevent_timer *te;
+    const char *key;
+
+    /* In millionths of a request */
+    uint64_t tokens;
+    struct timeval updated;
+
+    unsigned int refs;
+    struct sss_client_wait *waiting;
+};
+
+errno_t sss_client_throttle_init(struct resp_ctx *rctx, uint32_t rate)
+{
+    struct sss_client_throttle *throttle;
+
+    talloc_zfree(rctx->client_throttle);
+
+    if (rate == 0) {
+        return EOK;
+    }
+
+    throttle = talloc_zero(rctx, struct sss_client_throttle);
+    if (throttle == NULL) {
+        return ENOMEM;
+    }
+
+    throttle->buckets = sss_ptr_hash_create(throttle, NULL, NULL);
+    if (throttle->buckets == NULL) {
+        talloc_free(throttle);
+        return ENOMEM;
+    }
+
+    throttle->rctx = rctx;
+    throttle->rate = rate;
+    rctx->client_throttle = throttle;
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Clients of each user are limited to %u "
+          "requests per second\n", rate);
+
+    return EOK;
+}
+
+void sss_client_throttle_stats(struct resp_ctx *rctx,
+                               uint64_t *_deferred,
+                               uint64_t *_waiting,
+                               uint64_t *_uids)
+{
+    struct sss_client_throttle *throttle = rctx->client_throttle;
+
+    if (throttle == NULL) {
+        *_deferred = 0;
+        *_waiting = 0;
+        *_uids = 0;
+        return;
+    }
+
+    *_deferred = throttle->deferred;
+    *_waiting = throttle->waiting;
+    *_uids = hash_count(throttle->buckets);
+}
+
+static void sss_client_bucket_refill(struct sss_client_bucket *bucket)
+{
+    struct timeval now;
+    struct timeval diff;
+    uint64_t usecs;
+
+    now = tevent_timeval_current();
+    diff = tevent_timeval_until(&bucket->updated, &now);
+    usecs = diff.tv_sec * 1000000 + diff.tv_usec;
+    bucket->updated = now;
+
+    bucket->tokens += usecs * bucket->throttle->rate;
+    if (bucket->tokens > bucket->throttle->rate * CLIENT_TOKEN) {
+        bucket->tokens = bucket->throttle->rate * CLIENT_TOKEN;
+    }
+}
+
+static void sss_client_bucket_expire(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval current_time,
+                                     void *pvt)
+{
+    struct sss_client_bucket *bucket;
+
+    bucket = talloc_get_type(pvt, struct sss_client_bucket);
+    bucket->te = NULL;
+
+    if (bucket->refs == 0) {
+        talloc_free(bucket);
+    }
+}
+
+static void sss_client_bucket_wakeup(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval current_time,
+                                     void *pvt);
+
+static void sss_client_bucket_schedule(struct sss_client_bucket *bucket)
+{
+    struct tevent_context *ev = bucket->throttle->rctx->ev;
+    uint64_t usecs;
+
+    talloc_zfree(bucket->te);
+
+    if (bucket->waiting != NULL) {
+        /* Until the next token is available */
+        usecs = (CLIENT_TOKEN - bucket->tokens + bucket->throttle->rate - 1)
+                / bucket->throttle->rate;
+        bucket->te = tevent_add_timer(ev, bucket,
+                                      tevent_timeval_current_ofs(
+                                          usecs / 1000000, usecs % 1000000),
+                                      sss_client_bucket_wakeup, bucket);
+    } else if (bucket->refs == 0) {
+        /* Until the bucket is full again */
+        bucket->te = tevent_add_timer(ev, bucket,
+                                      tevent_timeval_current_ofs(2, 0),
+                                      sss_client_bucket_expire, bucket);
+    } else {
+        return;
+    }
+
+    if (bucket->te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to schedule request budget "
+              "of [%s]\n", bucket->key);
+    }
+}
+
+static void sss_client_bucket_wakeup(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval current_time,
+                                     void *pvt)
+{
+    struct sss_client_bucket *bucket;
+    struct sss_client_wait *wait;
+    struct cli_ctx *cctx;
+
+    bucket = talloc_get_type(pvt, struct sss_client_bucket);
+    bucket->te = NULL;
+
+    sss_client_bucket_refill(bucket);
+
+    while (bucket->waiting != NULL && bucket->tokens >= CLIENT_TOKEN) {
+        wait = bucket->waiting;
+        DLIST_REMOVE(bucket->waiting, wait);
+        bucket->throttle->waiting--;
+        bucket->tokens -= CLIENT_TOKEN;
+        wait->granted = true;
+
+        /* cctx may be freed */
+        cctx = wait->cctx;
+        client_process_queue(cctx);
+    }
+
+    sss_client_bucket_schedule(bucket);
+}
+
+static int sss_client_wait_destructor(struct sss_client_wait *wait)
+{
+    if (!wait->granted) {
+        DLIST_REMOVE(wait->bucket->waiting, wait);
+        wait->bucket->throttle->waiting--;
+    }
+    wait->cctx->bucket_wait = NULL;
+
+    return 0;
+}
+
+static int sss_client_bucket_destructor(struct sss_client_bucket *bucket)
+{
+    /* Only unused buckets are freed before the responder, just make sure
+     * no client points to it anymore */
+    while (bucket->waiting != NULL) {
+        talloc_free(bucket->waiting);
+    }
+
+    return 0;
+}
+
+errno_t sss_client_throttle_attach(struct cli_ctx *cctx)
+{
+    struct sss_client_throttle *throttle = cctx->rctx->client_throttle;
+    struct sss_client_bucket *bucket;
+    uid_t uid;
+    char *key;
+    errno_t ret;
+
+    if (throttle == NULL) {
+        return EOK;
+    }
+
+    uid = client_euid(cctx->creds);
+    if (uid == (uid_t)-1) {
+        return EOK;
+    }
+
+    key = talloc_asprintf(NULL, "%"SPRIuid, uid);
+    if (key == NULL) {
+        return ENOMEM;
+    }
+
+    bucket = sss_ptr_hash_lookup(throttle->buckets, key,
+                                 struct sss_client_bucket);
+    if (bucket != NULL) {
+        talloc_free(key);
+        goto done;
+    }
+
+    bucket = talloc_zero(throttle, struct sss_client_bucket);
+    if (bucket == NULL) {
+        talloc_free(key);
+        return ENOMEM;
+    }
+
+    bucket->throttle = throttle;
+    bucket->key = talloc_steal(bucket, key);
+    bucket->tokens = throttle->rate * CLIENT_TOKEN;
+    bucket->updated = tevent_timeval_current();
+
+    ret = sss_ptr_hash_add(throttle->buckets, bucket->key, bucket,
+                           struct sss_client_bucket);
+    if (ret != EOK) {
+        talloc_free(bucket);
+        return ret;
+    }
+
+    talloc_set_destructor(bucket, sss_client_bucket_destructor);
+
+done:
+    if (bucket->refs == 0) {
+        talloc_zfree(bucket->te);
+    }
+
+    bucket->refs++;
+    cctx->bucket = bucket;
+
+    return EOK;
+}
+
+static void sss_client_throttle_detach(struct cli_ctx *cctx)
+{
+    struct sss_client_bucket *bucket = cctx->bucket;
+
+    if (bucket == NULL) {
+        return;
+    }
+
+    talloc_zfree(cctx->bucket_wait);
+    cctx->bucket = NULL;
+    bucket->refs--;
+
+    if (bucket->refs == 0 && bucket->te == NULL) {
+        sss_client_bucket_schedule(bucket);
+    }
+}
+
+/* Returns true if the client may execute its next request now. Otherwise
+ * the client waits for its turn and its queue is processed later. */
+bool sss_client_throttle_admit(struct cli_ctx *cctx)
+{
+    struct sss_client_bucket *bucket = cctx->bucket;
+    struct sss_client_wait *wait;
+
+    if (bucket == NULL) {
+        return true;
+    }
+
+    if (cctx->bucket_wait != NULL) {
+        if (!cctx->bucket_wait->granted) {
+            return false;
+        }
+
+        talloc_zfree(cctx->bucket_wait);
+        return true;
+    }
+
+    sss_client_bucket_refill(bucket);
+
+    /* Clients that already wait go first */
+    if (bucket->waiting == NULL && bucket->tokens >= CLIENT_TOKEN) {
+        bucket->tokens -= CLIENT_TOKEN;
+        return true;
+    }
+
+    wait = talloc_zero(cctx, struct sss_client_wait);
+    if (wait == NULL) {
+        /* Better serve the client than leave it hanging */
+        return true;
+    }
+
+    wait->bucket = bucket;
+    wait->cctx = cctx;
+    DLIST_ADD_END(bucket->waiting, wait, struct sss_client_wait *);
+    talloc_set_destructor(wait, sss_client_wait_destructor);
+    cctx->bucket_wait = wait;
+
+    bucket->throttle->deferred++;
+    bucket->throttle->waiting++;
+
+    if (bucket->te == NULL) {
+        sss_client_bucket_schedule(bucket);
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Client [%p] of uid [%s] is over its "
+          "request budget, deferring\n", cctx, bucket->key);
+
+    return false;
+}
+
+
 static void client_send(struct cli_ctx *cctx)
 {
     struct cli_protocol *pctx;
@@ -276,9 +626,13 @@ static void client_send(struct cli_ctx *cctx)
 
     pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
 
+    /* Echo the tag so the client can match the reply with its request. */
+    sss_packet_set_tag(pctx->creq->out, sss_packet_get_tag(pctx->creq->in));
+
     ret = sss_packet_send(pctx->creq->out, cctx->cfd);
     if (ret == EAGAIN) {
-        /* not all data was sent, loop again */
+        /* not all data was sent, wait until the socket can take more */
+        TEVENT_FD_WRITEABLE(cctx->cfde);
         return;
     }
     if (ret != EOK) {
@@ -288,12 +642,59 @@ static void client_send(struct cli_ctx *cctx)
     }
 
     /* ok all sent */
+    PROBE(RESPONDER_CLIENT_SEND, cctx->cfd,
+          sss_cmd2str(sss_packet_get_cmd(pctx->creq->in)),
+          pctx->creq->trace_id, sss_packet_get_status(pctx->creq->out));
     TEVENT_FD_NOT_WRITEABLE(cctx->cfde);
-    TEVENT_FD_READABLE(cctx->cfde);
+    pctx->creq->replied = true;
     talloc_zfree(pctx->creq);
+
+    /* go on with the next request if the client sent one already */
+    client_process_queue(cctx);
     return;
 }
 
+static void client_recv(struct cli_ctx *cctx);
+static void client_fd_handler(struct tevent_context *ev,
+                              struct tevent_fd *fde,
+                              uint16_t flags, void *ptr);
+
+static void client_reply_handler(struct tevent_context *ev,
+                                 struct tevent_immediate *imm,
+                                 void *pvt)
+{
+    struct cli_ctx *cctx = talloc_get_type(pvt, struct cli_ctx);
+
+    sss_client_fd_handler(cctx, client_recv, client_send, TEVENT_FD_WRITE);
+}
+
+/* Called when the reply of the current request is complete. The socket of
+ * a client that waits for its reply has room for it almost always, so the
+ * reply is written right away on the next loop iteration instead of making
+ * the socket writeable and waiting for the event loop to report that. Only
+ * a reply that does not fit into the socket waits for it to be writeable.
+ *
+ * The reply is not written here, because the caller still uses the data of
+ * the request and a send error frees the client. */
+void sss_client_reply_ready(struct cli_ctx *cctx)
+{
+    if (cctx->cfd_handler != client_fd_handler) {
+        TEVENT_FD_WRITEABLE(cctx->cfde);
+        return;
+    }
+
+    if (cctx->reply_im == NULL) {
+        cctx->reply_im = tevent_create_immediate(cctx);
+        if (cctx->reply_im == NULL) {
+            TEVENT_FD_WRITEABLE(cctx->cfde);
+            return;
+        }
+    }
+
+    tevent_schedule_immediate(cctx->reply_im, cctx->ev,
+                              client_reply_handler, cctx);
+}
+
 static int client_cmd_execute(struct cli_ctx *cctx, struct sss_cmd_table *sss_cmds)
 {
     struct cli_protocol *pctx;
@@ -304,46 +705,175 @@ static int client_cmd_execute(struct cli_ctx *cctx, struct sss_cmd_table *sss_cm
     return sss_cmd_execute(cctx, cmd, sss_cmds);
 }
 
-static void client_recv(struct cli_ctx *cctx)
+static struct cli_request *client_new_request(struct cli_ctx *cctx)
+{
+    struct cli_request *creq;
+    int ret;
+
+    creq = talloc_zero(cctx, struct cli_request);
+    if (creq == NULL) {
+        return NULL;
+    }
+
+    ret = sss_packet_new(creq, SSS_PACKET_MAX_RECV_SIZE, 0, &creq->in);
+    if (ret != EOK) {
+        talloc_free(creq);
+        return NULL;
+    }
+
+    return creq;
+}
+
+/* Moves the request that was just received to the queue, together with
+ * any other complete request the client pipelined in the same read. */
+static errno_t client_queue_request(struct cli_ctx *cctx)
 {
     struct cli_protocol *pctx;
+    struct cli_request *creq;
     int ret;
 
     pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
 
-    if (!pctx->creq) {
-        pctx->creq = talloc_zero(cctx, struct cli_request);
-        if (!pctx->creq) {
-            DEBUG(SSSDBG_FATAL_FAILURE,
-                  "Failed to alloc request, aborting client!\n");
-            talloc_free(cctx);
-            return;
+    do {
+        creq = pctx->rreq;
+        pctx->rreq = NULL;
+        DLIST_ADD_END(pctx->queue, creq, struct cli_request *);
+        pctx->num_queued++;
+        sss_cmd_stats_queue(cctx->rctx, creq);
+        PROBE(RESPONDER_CLIENT_RECV, cctx->cfd,
+              sss_cmd2str(sss_packet_get_cmd(creq->in)),
+              sss_packet_get_tag(creq->in),
+              cctx->creds != NULL ? (int)cli_creds_get_pid(cctx->creds) : -1);
+
+        pctx->rreq = client_new_request(cctx);
+        if (pctx->rreq == NULL) {
+            return ENOMEM;
+        }
+
+        ret = sss_packet_recv_surplus(creq->in, pctx->rreq->in);
+    } while (ret == EOK);
+
+    switch (ret) {
+    case ENOENT:
+        talloc_zfree(pctx->rreq);
+        return EOK;
+    case EAGAIN:
+        return EOK;
+    default:
+        return ret;
+    }
+}
+
+/* Executes the first queued request unless a request is being executed. */
+static void client_process_queue(struct cli_ctx *cctx)
+{
+    struct cli_protocol *pctx;
+    struct cli_request *creq;
+    int ret;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+
+    if (pctx->creq != NULL) {
+        if (pctx->num_queued >= CLI_MAX_QUEUED_REQUESTS) {
+            TEVENT_FD_NOT_READABLE(cctx->cfde);
         }
+        return;
     }
 
-    if (!pctx->creq->in) {
-        ret = sss_packet_new(pctx->creq, SSS_PACKET_MAX_RECV_SIZE,
-                             0, &pctx->creq->in);
-        if (ret != EOK) {
+    creq = pctx->queue;
+    if (creq == NULL) {
+        TEVENT_FD_READABLE(cctx->cfde);
+        return;
+    }
+
+    if (!sss_client_throttle_admit(cctx)) {
+        /* Defer reading too, the client is resumed when its turn comes */
+        TEVENT_FD_NOT_READABLE(cctx->cfde);
+        return;
+    }
+
+    DLIST_REMOVE(pctx->queue, creq);
+    pctx->num_queued--;
+    pctx->creq = creq;
+    sss_cmd_stats_start(cctx->rctx, creq);
+    sss_cmd_trace_start(cctx, creq);
+
+    if (sss_packet_get_tag(creq->in) == 0 && pctx->rreq == NULL
+            && pctx->queue == NULL) {
+        /* Clients that do not tag requests wait for the reply before
+         * sending anything else, do not read anymore */
+        TEVENT_FD_NOT_READABLE(cctx->cfde);
+    } else if (pctx->num_queued < CLI_MAX_QUEUED_REQUESTS) {
+        TEVENT_FD_READABLE(cctx->cfde);
+    } else {
+        TEVENT_FD_NOT_READABLE(cctx->cfde);
+    }
+
+    /* execute command */
+    ret = client_cmd_execute(cctx, cctx->rctx->sss_cmds);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to execute request, aborting client!\n");
+        talloc_free(cctx);
+    }
+    /* past this point cctx can be freed at any time by callbacks
+     * in case of error, do not use it */
+}
+
+/* The socket of a client that tags its requests is read while one of them
+ * is executing, so the client may go away in the middle of it. The running
+ * request still uses the client context, which is then freed only after the
+ * reply was sent, or failed to be sent, and the socket reports the end of
+ * the connection again. */
+static void client_close(struct cli_ctx *cctx)
+{
+    struct cli_protocol *pctx;
+    struct cli_request *creq;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+
+    if (pctx->creq == NULL) {
+        talloc_free(cctx);
+        return;
+    }
+
+    TEVENT_FD_NOT_READABLE(cctx->cfde);
+    talloc_zfree(pctx->rreq);
+    while ((creq = pctx->queue) != NULL) {
+        DLIST_REMOVE(pctx->queue, creq);
+        talloc_free(creq);
+    }
+    pctx->num_queued = 0;
+}
+
+static void client_recv(struct cli_ctx *cctx)
+{
+    struct cli_protocol *pctx;
+    int ret;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+
+    if (!pctx->rreq) {
+        pctx->rreq = client_new_request(cctx);
+        if (!pctx->rreq) {
             DEBUG(SSSDBG_FATAL_FAILURE,
                   "Failed to alloc request, aborting client!\n");
-            talloc_free(cctx);
+            client_close(cctx);
             return;
         }
     }
 
-    ret = sss_packet_recv(pctx->creq->in, cctx->cfd);
+    ret = sss_packet_recv(pctx->rreq->in, cctx->cfd);
     switch (ret) {
     case EOK:
-        /* do not read anymore */
-        TEVENT_FD_NOT_READABLE(cctx->cfde);
-        /* execute command */
-        ret = client_cmd_execute(cctx, cctx->rctx->sss_cmds);
+        ret = client_queue_request(cctx);
         if (ret != EOK) {
-            DEBUG(SSSDBG_FATAL_FAILURE,
-                  "Failed to execute request, aborting client!\n");
-            talloc_free(cctx);
+            DEBUG(SSSDBG_TRACE_FUNC,
+                  "Invalid data from client, closing connection!\n");
+            client_close(cctx);
+            return;
         }
+        client_process_queue(cctx);
         /* past this point cctx can be freed at any time by callbacks
          * in case of error, do not use it */
         return;
@@ -355,17 +885,17 @@ static void client_recv(struct cli_ctx *cctx)
     case EINVAL:
         DEBUG(SSSDBG_TRACE_FUNC,
               "Invalid data from client, closing connection!\n");
-        talloc_free(cctx);
+        client_close(cctx);
         break;
 
     case ENODATA:
         DEBUG(SSSDBG_FUNC_DATA, "Client disconnected!\n");
-        talloc_free(cctx);
+        client_close(cctx);
         break;
 
     default:
         DEBUG(SSSDBG_TRACE_FUNC, "Failed to read request, aborting client!\n");
-        talloc_free(cctx);
+        client_close(cctx);
     }
 
     return;
@@ -381,6 +911,8 @@ static void responder_idle_handler(struct tevent_context *ev,
     struct resp_ctx *rctx;
     time_t now;
 
+    char *state_path;
+
     rctx = talloc_get_type(data, struct resp_ctx);
 
     now = time(NULL);
@@ -395,6 +927,12 @@ static void responder_idle_handler(struct tevent_context *ev,
         DEBUG(SSSDBG_TRACE_INTERNAL,
               "Terminating idle responder [%p]\n", rctx);
 
+        /* the next instance starts where this one stopped */
+        state_path = sss_resp_state_path(rctx, rctx);
+        if (state_path != NULL) {
+            sss_resp_state_save(rctx, state_path);
+        }
+
         talloc_free(rctx);
 
         orderly_shutdown(0);
@@ -460,10 +998,13 @@ static void client_fd_handler(struct tevent_context *ev,
     sss_client_fd_handler(ptr, client_recv, client_send, flags);
 }
 
-static errno_t setup_client_idle_timer(struct cli_ctx *cctx);
-
 static int cli_ctx_destructor(struct cli_ctx *cctx)
 {
+    if (cctx->rctx != NULL) {
+        DLIST_REMOVE(cctx->rctx->clients, cctx);
+    }
+    sss_client_throttle_detach(cctx);
+
     if (cctx->creds == NULL) {
         return 0;
     }
@@ -500,60 +1041,56 @@ static void accept_and_terminate_cli(int fd)
     if (client_fd == -1) {
         return;
     }
-    close(client_fd);
-    return;
-}
-
-static void accept_fd_handler(struct tevent_context *ev,
-                              struct tevent_fd *fde,
-                              uint16_t flags, void *ptr)
-{
-    /* accept and attach new event handler */
-    struct accept_fd_ctx *accept_ctx =
-            talloc_get_type(ptr, struct accept_fd_ctx);
-    struct resp_ctx *rctx = accept_ctx->rctx;
-    struct cli_ctx *cctx;
-    socklen_t len;
-    struct stat stat_buf;
-    int ret;
-    int fd = accept_ctx->is_private ? rctx->priv_lfd : rctx->lfd;
-
-    if (accept_ctx->is_private) {
-        ret = stat(rctx->priv_sock_name, &stat_buf);
-        if (ret == -1) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "stat on privileged pipe failed: [%d][%s].\n",
-                  errno, strerror(errno));
-            accept_and_terminate_cli(fd);
-            return;
-        }
-
-        if ( ! (stat_buf.st_uid == 0 && stat_buf.st_gid == 0 &&
-               (stat_buf.st_mode&(S_IFSOCK|S_IRUSR|S_IWUSR)) == stat_buf.st_mode)) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "privileged pipe has an illegal status.\n");
-            accept_and_terminate_cli(fd);
-            return;
-        }
-    }
+    close(client_fd);
+    return;
+}
+
+/* Most clients connect, send one request and disconnect, so a busy
+ * responder finds several connections waiting whenever it wakes up. They are
+ * accepted in one go, but only up to this number so that the requests of
+ * the connected clients are not held up. */
+#define RESP_ACCEPT_BATCH 16
+
+/* Space of the talloc pool of a client context. It holds the credentials,
+ * the protocol context and the event handlers of the client, so setting up
+ * a connection takes a single allocation. */
+#define CLI_CTX_POOL_OBJECTS 8
+#define CLI_CTX_POOL_SIZE 1024
+
+/* Returns EOK if a connection was accepted, whether it was kept or not, or
+ * the error of accept() otherwise. */
+static errno_t accept_client(struct tevent_context *ev,
+                             struct accept_fd_ctx *accept_ctx,
+                             int fd)
+{
+    struct resp_ctx *rctx = accept_ctx->rctx;
+    struct cli_ctx *cctx;
+    socklen_t len;
+    int ret;
 
-    cctx = talloc_zero(rctx, struct cli_ctx);
+    cctx = talloc_pooled_object(rctx, struct cli_ctx, CLI_CTX_POOL_OBJECTS,
+                                CLI_CTX_POOL_SIZE);
     if (!cctx) {
         DEBUG(SSSDBG_FATAL_FAILURE,
               "Out of memory trying to setup client context%s!\n",
               accept_ctx->is_private ? " on privileged pipe": "");
         accept_and_terminate_cli(fd);
-        return;
+        return EOK;
     }
+    memset(cctx, 0, sizeof(struct cli_ctx));
 
     talloc_set_destructor(cctx, cli_ctx_destructor);
 
     len = sizeof(cctx->addr);
     cctx->cfd = accept(fd, (struct sockaddr *)&cctx->addr, &len);
     if (cctx->cfd == -1) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Accept failed [%s]\n", strerror(errno));
+        ret = errno;
+        if (ret != EAGAIN && ret != EWOULDBLOCK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Accept failed [%s]\n",
+                  strerror(ret));
+        }
         talloc_free(cctx);
-        return;
+        return ret == EWOULDBLOCK ? EAGAIN : ret;
     }
 
     cctx->priv = accept_ctx->is_private;
@@ -572,7 +1109,7 @@ static void accept_fd_handler(struct tevent_context *ev,
                                         "socket. Access denied.\n");
             close(cctx->cfd);
             talloc_free(cctx);
-            return;
+            return EOK;
         }
 
         ret = check_allowed_uids(client_euid(cctx->creds), rctx->allowed_uids_count,
@@ -587,7 +1124,7 @@ static void accept_fd_handler(struct tevent_context *ev,
             }
             close(cctx->cfd);
             talloc_free(cctx);
-            return;
+            return EOK;
         }
     }
 
@@ -598,7 +1135,7 @@ static void accept_fd_handler(struct tevent_context *ev,
         DEBUG(SSSDBG_OP_FAILURE,
               "Failed to setup client handler%s\n",
                accept_ctx->is_private ? " on privileged pipe" : "");
-        return;
+        return EOK;
     }
 
     cctx->cfde = tevent_add_fd(ev, cctx, cctx->cfd,
@@ -610,12 +1147,21 @@ static void accept_fd_handler(struct tevent_context *ev,
         DEBUG(SSSDBG_OP_FAILURE,
               "Failed to queue client handler%s\n",
                accept_ctx->is_private ? " on privileged pipe" : "");
-        return;
+        return EOK;
     }
     tevent_fd_set_close_fn(cctx->cfde, client_close_fn);
 
     cctx->ev = ev;
     cctx->rctx = rctx;
+    DLIST_ADD(rctx->clients, cctx);
+
+    ret = sss_client_throttle_attach(cctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Could not set up request budget for client, "
+              "its requests are not limited\n");
+        /* Non-fatal, continue */
+    }
 
     /* Record the new time and set up the idle timer */
     ret = reset_client_idle_timer(cctx);
@@ -639,7 +1185,53 @@ static void accept_fd_handler(struct tevent_context *ev,
           cctx, cctx->cfd,
           accept_ctx->is_private ? " to privileged pipe" : "");
 
-    return;
+    return EOK;
+}
+
+static void accept_fd_handler(struct tevent_context *ev,
+                              struct tevent_fd *fde,
+                              uint16_t flags, void *ptr)
+{
+    /* accept and attach new event handlers */
+    struct accept_fd_ctx *accept_ctx =
+            talloc_get_type(ptr, struct accept_fd_ctx);
+    struct resp_ctx *rctx = accept_ctx->rctx;
+    struct stat stat_buf;
+    int ret;
+    int fd = accept_ctx->is_private ? rctx->priv_lfd : rctx->lfd;
+    int i;
+
+    if (accept_ctx->is_private) {
+        ret = stat(rctx->priv_sock_name, &stat_buf);
+        if (ret == -1) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "stat on privileged pipe failed: [%d][%s].\n",
+                  errno, strerror(errno));
+            accept_and_terminate_cli(fd);
+            return;
+        }
+
+        if ( ! (stat_buf.st_uid == 0 && stat_buf.st_gid == 0 &&
+               (stat_buf.st_mode&(S_IFSOCK|S_IRUSR|S_IWUSR)) == stat_buf.st_mode)) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "privileged pipe has an illegal status.\n");
+            accept_and_terminate_cli(fd);
+            return;
+        }
+    }
+
+    /* The listening sockets are non-blocking, accept() fails with EAGAIN
+     * once the backlog is empty. */
+    for (i = 0; i < RESP_ACCEPT_BATCH; i++) {
+        ret = accept_client(ev, accept_ctx, fd);
+        if (ret == EAGAIN && i == 0) {
+            /* Another process sharing the socket was faster */
+            DEBUG(SSSDBG_TRACE_ALL, "No connection to accept\n");
+        }
+        if (ret != EOK) {
+            break;
+        }
+    }
 }
 
 static void client_idle_handler(struct tevent_context *ev,
@@ -649,6 +1241,17 @@ static void client_idle_handler(struct tevent_context *ev,
 {
     time_t now = time(NULL);
     struct cli_ctx *cctx = talloc_get_type(data, struct cli_ctx);
+    struct cli_protocol *pctx;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    if (pctx != NULL && pctx->creq != NULL) {
+        /* The running request still uses the client context, the reply
+         * counts as activity again */
+        DEBUG(SSSDBG_TRACE_ALL,
+              "Client [%p][%d] is waiting for a reply, not idle\n",
+              cctx, cctx->cfd);
+        goto done;
+    }
 
     if (cctx->last_request_time > now) {
         DEBUG(SSSDBG_IMPORTANT_INFO,
@@ -678,7 +1281,7 @@ errno_t reset_client_idle_timer(struct cli_ctx *cctx)
     return EOK;
 }
 
-static errno_t setup_client_idle_timer(struct cli_ctx *cctx)
+errno_t setup_client_idle_timer(struct cli_ctx *cctx)
 {
     struct timeval tv =
             tevent_timeval_current_ofs(cctx->rctx->client_idle_timeout/2, 0);
@@ -1258,6 +1861,14 @@ int sss_process_init(TALLOC_CTX *mem_ctx,
 {
     struct resp_ctx *rctx;
     struct sss_domain_info *dom;
+    int object_cache_size;
+    int object_cache_timeout;
+    bool object_cache_shared;
+    int prefilter_interval;
+    int prefetch_min_lookups;
+    int client_rate_limit;
+    int request_pool_size;
+    int memory_soft_limit;
     int ret;
     char *tmp = NULL;
 
@@ -1280,6 +1891,20 @@ int sss_process_init(TALLOC_CTX *mem_ctx,
 
     talloc_set_destructor((TALLOC_CTX*)rctx, sss_responder_ctx_destructor);
 
+    ret = sss_packet_pool_init(rctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to set up packet buffer pool "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    ret = sss_cmd_stats_init(rctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to set up command statistics "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        goto fail;
+    }
+
     ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
                          CONFDB_RESPONDER_CLI_IDLE_TIMEOUT,
                          CONFDB_RESPONDER_CLI_IDLE_DEFAULT_TIMEOUT,
@@ -1314,6 +1939,177 @@ int sss_process_init(TALLOC_CTX *mem_ctx,
               ret, sss_strerror(ret));
     }
 
+    ret = confdb_get_bool(rctx->cdb, rctx->confdb_service_path,
+                          CONFDB_RESPONDER_PARALLEL_DOMAIN_LOOKUP,
+                          false, &rctx->parallel_domain_lookup);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get \"parallel_domain_lookup\" option, the domains "
+              "will be searched one after another [%d]: %s.\n",
+              ret, sss_strerror(ret));
+    }
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_OBJECT_CACHE_SIZE,
+                         CONFDB_RESPONDER_OBJECT_CACHE_SIZE_DEFAULT,
+                         &object_cache_size);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the object cache size [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_OBJECT_CACHE_TIMEOUT,
+                         CONFDB_RESPONDER_OBJECT_CACHE_TIMEOUT_DEFAULT,
+                         &object_cache_timeout);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the object cache timeout [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    if (object_cache_size > 0 && object_cache_timeout > 0) {
+        ret = cache_req_hot_init(rctx, (size_t)object_cache_size * 1024,
+                                 object_cache_timeout);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Unable to set up the object cache [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            goto fail;
+        }
+    }
+
+    ret = confdb_get_bool(rctx->cdb, rctx->confdb_service_path,
+                          CONFDB_RESPONDER_OBJECT_CACHE_SHARED,
+                          CONFDB_RESPONDER_OBJECT_CACHE_SHARED_DEFAULT,
+                          &object_cache_shared);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get \"object_cache_shared\" option [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    if (object_cache_shared && object_cache_timeout > 0) {
+        ret = cache_req_shared_init(rctx, CACHE_REQ_SHARED_FILE,
+                                    object_cache_timeout);
+        if (ret != EOK) {
+            /* Each responder still has its own object cache. */
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Unable to set up the shared object cache [%d]: %s\n",
+                  ret, sss_strerror(ret));
+        }
+    }
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_PREFILTER_INTERVAL,
+                         CONFDB_RESPONDER_PREFILTER_INTERVAL_DEFAULT,
+                         &prefilter_interval);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the prefilter refresh interval [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    ret = cache_req_prefilter_init(rctx, prefilter_interval);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Unable to set up the domain prefilters [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_PREFETCH_MIN_LOOKUPS,
+                         CONFDB_RESPONDER_PREFETCH_MIN_LOOKUPS_DEFAULT,
+                         &prefetch_min_lookups);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the prefetch threshold [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    if (prefetch_min_lookups > 0) {
+        ret = cache_req_prefetch_init(rctx, prefetch_min_lookups);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Unable to set up the prefetch [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            goto fail;
+        }
+    }
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_CLIENT_RATE_LIMIT,
+                         CONFDB_RESPONDER_CLIENT_RATE_LIMIT_DEFAULT,
+                         &client_rate_limit);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the client rate limit [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    if (client_rate_limit > 0) {
+        ret = sss_client_throttle_init(rctx, client_rate_limit);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Unable to set up the client rate limit [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            goto fail;
+        }
+    }
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_REQUEST_TRACE_SAMPLING,
+                         CONFDB_RESPONDER_REQUEST_TRACE_SAMPLING_DEFAULT,
+                         &rctx->trace_sampling);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the request trace sampling [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_REQUEST_POOL_SIZE,
+                         CONFDB_RESPONDER_REQUEST_POOL_SIZE_DEFAULT,
+                         &request_pool_size);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the request pool size [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+    rctx->request_pool_size = request_pool_size > 0 ? request_pool_size : 0;
+
+    ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
+                         CONFDB_RESPONDER_MEMORY_SOFT_LIMIT,
+                         CONFDB_RESPONDER_MEMORY_SOFT_LIMIT_DEFAULT,
+                         &memory_soft_limit);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the memory soft limit [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    if (memory_soft_limit > 0) {
+        ret = sss_mem_limit_init(rctx,
+                                 (uint64_t)memory_soft_limit * 1024 * 1024);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Cannot set up the memory soft limit [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            goto fail;
+        }
+    }
+
     ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
                          CONFDB_RESPONDER_GET_DOMAINS_TIMEOUT,
                          GET_DOMAINS_DEFAULT_TIMEOUT, &rctx->domains_timeout);
@@ -1462,6 +2258,14 @@ int sss_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
+    if (rctx->socket_activated || rctx->dbus_activated) {
+        tmp = sss_resp_state_path(rctx, rctx);
+        if (tmp != NULL) {
+            sss_resp_state_load(rctx, tmp);
+            talloc_free(tmp);
+        }
+    }
+
     ret = sss_ad_default_names_ctx(rctx, &rctx->global_names);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "sss_ad_default_names_ctx failed.\n");
@@ -1503,23 +2307,9 @@ int sss_dp_get_domain_conn(struct resp_ctx *rctx, const char *domain,
 struct sss_domain_info *
 responder_get_domain(struct resp_ctx *rctx, const char *name)
 {
-    struct sss_domain_info *dom;
-    struct sss_domain_info *ret_dom = NULL;
-
-    for (dom = rctx->domains; dom;
-            dom = get_next_domain(dom, SSS_GND_DESCEND)) {
-        if (sss_domain_get_state(dom) == DOM_DISABLED) {
-            continue;
-        }
-
-        if (strcasecmp(dom->name, name) == 0 ||
-            (dom->flat_name != NULL &&
-             strcasecmp(dom->flat_name, name) == 0)) {
-            ret_dom = dom;
-            break;
-        }
-    }
+    struct sss_domain_info *ret_dom;
 
+    ret_dom = find_domain_by_name(rctx->domains, name, true);
     if (!ret_dom) {
         DEBUG(SSSDBG_OP_FAILURE, "Unknown domain [%s]\n", name);
     }
@@ -1530,39 +2320,21 @@ responder_get_domain(struct resp_ctx *rctx, const char *name)
 errno_t responder_get_domain_by_id(struct resp_ctx *rctx, const char *id,
                                    struct sss_domain_info **_ret_dom)
 {
-    struct sss_domain_info *dom;
-    struct sss_domain_info *ret_dom = NULL;
-    size_t id_len;
-    size_t dom_id_len;
+    struct sss_domain_info *ret_dom;
     int ret;
 
     if (id == NULL || _ret_dom == NULL) {
         return EINVAL;
     }
 
-    id_len = strlen(id);
-
-    for (dom = rctx->domains; dom;
-            dom = get_next_domain(dom, SSS_GND_DESCEND)) {
-        if (sss_domain_get_state(dom) == DOM_DISABLED ||
-                dom->domain_id == NULL) {
-            continue;
-        }
-
-        dom_id_len = strlen(dom->domain_id);
-        if ((id_len >= dom_id_len) &&
-            strncasecmp(dom->domain_id, id, dom_id_len) == 0) {
-            if (IS_SUBDOMAIN(dom) &&
-                ((time(NULL) - dom->parent->subdomains_last_checked.tv_sec) >
+    ret_dom = find_domain_by_sid(rctx->domains, id);
+    if (ret_dom != NULL && IS_SUBDOMAIN(ret_dom) &&
+        ((time(NULL) - ret_dom->parent->subdomains_last_checked.tv_sec) >
                                                       rctx->domains_timeout)) {
-                DEBUG(SSSDBG_TRACE_FUNC, "Domain entry with id [%s] " \
-                                          "is expired.\n", id);
-                ret = EAGAIN;
-                goto done;
-            }
-            ret_dom = dom;
-            break;
-        }
+        DEBUG(SSSDBG_TRACE_FUNC, "Domain entry with id [%s] " \
+                                  "is expired.\n", id);
+        ret = EAGAIN;
+        goto done;
     }
 
     if (ret_dom == NULL) {
@@ -1884,6 +2656,86 @@ done:
 /**
  * Helper functions to format output names
  */
+
+/* Members of large groups are formatted again for every reply. The output
+ * names of each domain are kept in a small direct-mapped cache, a slot is
+ * simply overwritten by the next name that hashes to it. */
+#define SSS_OUTPUT_NAME_CACHE_SLOTS 1024
+
+struct sss_output_name {
+    char *orig_name;
+    char *output_name;
+    size_t len;
+};
+
+struct sss_output_name_cache {
+    /* The output names depend on these settings of the domain */
+    bool fqnames;
+    char *flat_name;
+
+    struct sss_output_name *slots[SSS_OUTPUT_NAME_CACHE_SLOTS];
+};
+
+static struct sss_output_name_cache *
+sss_output_name_cache_get(struct sss_domain_info *dom)
+{
+    struct sss_output_name_cache *cache = dom->output_names;
+    bool fqnames;
+
+    fqnames = sss_domain_info_get_output_fqnames(dom) || dom->fqnames;
+
+    if (cache != NULL && (cache->fqnames != fqnames
+            || (fqnames && strcmp(cache->flat_name,
+                                  dom->flat_name ? dom->flat_name : "") != 0))) {
+        talloc_zfree(dom->output_names);
+        cache = NULL;
+    }
+
+    if (cache == NULL) {
+        cache = talloc_zero(dom, struct sss_output_name_cache);
+        if (cache == NULL) {
+            return NULL;
+        }
+
+        cache->fqnames = fqnames;
+        cache->flat_name = talloc_strdup(cache, dom->flat_name ? dom->flat_name
+                                                               : "");
+        if (cache->flat_name == NULL) {
+            talloc_free(cache);
+            return NULL;
+        }
+
+        dom->output_names = cache;
+    }
+
+    return cache;
+}
+
+static void sss_output_name_cache_set(struct sss_output_name **_slot,
+                                      TALLOC_CTX *cache,
+                                      const char *orig_name,
+                                      const char *output_name,
+                                      size_t len)
+{
+    struct sss_output_name *entry;
+
+    entry = talloc_zero(cache, struct sss_output_name);
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->orig_name = talloc_strdup(entry, orig_name);
+    entry->output_name = talloc_memdup(entry, output_name, len);
+    if (entry->orig_name == NULL || entry->output_name == NULL) {
+        talloc_free(entry);
+        return;
+    }
+    entry->len = len;
+
+    talloc_free(*_slot);
+    *_slot = entry;
+}
+
 int sized_output_name(TALLOC_CTX *mem_ctx,
                       struct resp_ctx *rctx,
                       const char *orig_name,
@@ -1891,10 +2743,36 @@ int sized_output_name(TALLOC_CTX *mem_ctx,
                       struct sized_string **_name)
 {
     TALLOC_CTX *tmp_ctx = NULL;
+    struct sss_output_name_cache *cache;
+    struct sss_output_name **slot = NULL;
     errno_t ret;
     char *name_str;
     struct sized_string *name;
 
+    cache = sss_output_name_cache_get(name_dom);
+    if (cache != NULL) {
+        slot = &cache->slots[wyhash32(orig_name, strlen(orig_name),
+                                      0xdeadbeef)
+                             % SSS_OUTPUT_NAME_CACHE_SLOTS];
+        if (*slot != NULL && strcmp((*slot)->orig_name, orig_name) == 0) {
+            name = talloc_zero(mem_ctx, struct sized_string);
+            if (name == NULL) {
+                return ENOMEM;
+            }
+
+            name_str = talloc_memdup(name, (*slot)->output_name, (*slot)->len);
+            if (name_str == NULL) {
+                talloc_free(name);
+                return ENOMEM;
+            }
+
+            name->str = name_str;
+            name->len = (*slot)->len;
+            *_name = name;
+            return EOK;
+        }
+    }
+
     tmp_ctx = talloc_new(NULL);
     if (tmp_ctx == NULL) {
         return ENOMEM;
@@ -1913,6 +2791,12 @@ int sized_output_name(TALLOC_CTX *mem_ctx,
     }
 
     to_sized_string(name, name_str);
+
+    if (slot != NULL) {
+        sss_output_name_cache_set(slot, cache, orig_name, name->str,
+                                  name->len);
+    }
+
     *_name = talloc_steal(mem_ctx, name);
     ret = EOK;
 done:
@@ -1925,37 +2809,25 @@ int sized_domain_name(TALLOC_CTX *mem_ctx,
                       const char *member_name,
                       struct sized_string **_name)
 {
-    TALLOC_CTX *tmp_ctx = NULL;
-    errno_t ret;
-    char *domname;
+    const char *separator;
     struct sss_domain_info *member_dom;
 
-    tmp_ctx = talloc_new(NULL);
-    if (tmp_ctx == NULL) {
-        return ENOMEM;
-    }
-
-    ret = sss_parse_internal_fqname(tmp_ctx, member_name, NULL, &domname);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "sss_parse_internal_fqname failed\n");
-        goto done;
-    }
-
-    if (domname == NULL) {
-        ret = ERR_WRONG_NAME_FORMAT;
-        goto done;
+    /* Called for every member of a group, find the domain the way
+     * sss_parse_internal_fqname() splits the name but without copying */
+    separator = strrchr(member_name, '@');
+    if (separator == NULL || separator[1] == '\0'
+            || separator == member_name) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unexpected name format [%s]\n",
+              member_name);
+        return ERR_WRONG_NAME_FORMAT;
     }
 
     member_dom = find_domain_by_name(get_domains_head(rctx->domains),
-                                     domname, true);
+                                     separator + 1, true);
     if (member_dom == NULL) {
-        ret = ERR_DOMAIN_NOT_FOUND;
-        goto done;
+        return ERR_DOMAIN_NOT_FOUND;
     }
 
-    ret = sized_output_name(mem_ctx, rctx, member_name,
-                            member_dom, _name);
-done:
-    talloc_free(tmp_ctx);
-    return ret;
+    return sized_output_name(mem_ctx, rctx, member_name,
+                             member_dom, _name);
 }
@@ -257,14 +257,24 @@ sss_dp_get_account_send(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    if (rctx->dp_background) {
+        dp_flags |= DP_BACKGROUND;
+    }
+
+    if (rctx->dp_refresh) {
+        dp_flags |= DP_REFRESH;
+    }
+
     DEBUG(SSSDBG_TRACE_FUNC,
           "Creating request for [%s][%#x][%s][%s:%s]\n",
           dom->name, entry_type, be_req2str(entry_type),
           filter, extra == NULL ? "-" : extra);
 
+    /* The data provider prints the trace ID of the client request in the
+     * messages of this lookup, cache_req has set it. */
     subreq = sbus_call_dp_dp_getAccountInfo_send(state, be_conn->conn,
                  be_conn->bus_name, SSS_BUS_PATH, dp_flags,
-                 entry_type, filter, dom->name, extra);
+                 entry_type, filter, dom->name, extra, debug_trace_id);
     if (subreq == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
         ret = ENOMEM;
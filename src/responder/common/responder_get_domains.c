@@ -19,6 +19,7 @@
 */
 
 #include "util/util.h"
+#include "shared/murmurhash3.h"
 #include "responder/common/responder.h"
 #include "providers/data_provider.h"
 #include "db/sysdb.h"
@@ -262,6 +263,113 @@ static void sss_resp_update_certmaps(struct resp_ctx *rctx)
     }
 }
 
+struct sss_resp_domains_hash {
+    uint32_t lo;
+    uint32_t hi;
+};
+
+static void sss_resp_domains_hash_data(struct sss_resp_domains_hash *hash,
+                                       const void *data, size_t len)
+{
+    hash->lo = murmurhash3(data, len, hash->lo);
+    hash->hi = murmurhash3(data, len, hash->hi);
+}
+
+static void sss_resp_domains_hash_str(struct sss_resp_domains_hash *hash,
+                                      const char *str)
+{
+    if (str == NULL) {
+        str = "";
+    }
+
+    /* with the terminating zero, so "ab" "c" differs from "a" "bc" */
+    sss_resp_domains_hash_data(hash, str, strlen(str) + 1);
+}
+
+static void sss_resp_domains_hash_uint(struct sss_resp_domains_hash *hash,
+                                       uint32_t value)
+{
+    sss_resp_domains_hash_data(hash, &value, sizeof(value));
+}
+
+/* A refresh of the subdomains of a large forest usually finds the same
+ * domains again. The fingerprint covers everything the domain list of
+ * cache_req and the permanent negative cache entries are built from, so
+ * both are only rebuilt when one of the domains or the resolution order
+ * changed. */
+static errno_t sss_resp_domains_fingerprint(struct resp_ctx *rctx,
+                                            uint64_t *_fingerprint)
+{
+    struct sss_resp_domains_hash hash = { 0, 0x9e3779b9 };
+    struct sss_domain_info *ipa_dom = NULL;
+    struct sss_domain_info *dom;
+    const char *order;
+    TALLOC_CTX *tmp_ctx;
+    errno_t ret;
+    size_t c;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    for (dom = rctx->domains; dom != NULL;
+            dom = get_next_domain(dom, SSS_GND_ALL_DOMAINS)) {
+        sss_resp_domains_hash_str(&hash, dom->name);
+        sss_resp_domains_hash_str(&hash, dom->realm);
+        sss_resp_domains_hash_str(&hash, dom->flat_name);
+        sss_resp_domains_hash_str(&hash, dom->domain_id);
+        sss_resp_domains_hash_str(&hash, dom->forest);
+        sss_resp_domains_hash_str(&hash, dom->parent == NULL ? NULL
+                                                         : dom->parent->name);
+        sss_resp_domains_hash_uint(&hash, sss_domain_get_state(dom));
+        sss_resp_domains_hash_uint(&hash, dom->mpg_mode);
+        sss_resp_domains_hash_uint(&hash, dom->enumerate);
+        sss_resp_domains_hash_uint(&hash, dom->trust_direction);
+        for (c = 0; dom->upn_suffixes != NULL
+                        && dom->upn_suffixes[c] != NULL; c++) {
+            sss_resp_domains_hash_str(&hash, dom->upn_suffixes[c]);
+        }
+        sss_resp_domains_hash_uint(&hash, c);
+
+        if (ipa_dom == NULL && dom->parent == NULL && dom->provider != NULL
+                && strcmp(dom->provider, "ipa") == 0) {
+            ipa_dom = dom;
+        }
+    }
+
+    /* the resolution order sss_resp_populate_cr_domains() may pick */
+    if (ipa_dom != NULL) {
+        sss_resp_domains_hash_uint(&hash, ipa_dom->has_views);
+        sss_resp_domains_hash_str(&hash, ipa_dom->view_name);
+
+        order = NULL;
+        ret = sysdb_get_view_domain_resolution_order(tmp_ctx, ipa_dom->sysdb,
+                                                     &order);
+        if (ret != EOK && ret != ENOENT) {
+            goto done;
+        }
+        sss_resp_domains_hash_str(&hash, order);
+
+        order = NULL;
+        ret = sysdb_domain_get_domain_resolution_order(tmp_ctx,
+                                                       ipa_dom->sysdb,
+                                                       ipa_dom->name,
+                                                       &order);
+        if (ret != EOK && ret != ENOENT) {
+            goto done;
+        }
+        sss_resp_domains_hash_str(&hash, order);
+    }
+
+    *_fingerprint = (uint64_t)hash.hi << 32 | hash.lo;
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 static void
 sss_dp_get_domains_process(struct tevent_req *subreq)
 {
@@ -273,6 +381,8 @@ sss_dp_get_domains_process(struct tevent_req *subreq)
     uint16_t dp_err;
     uint32_t dp_ret;
     const char *err_msg;
+    uint64_t fingerprint;
+    errno_t fret;
 
     ret = get_subdomains_recv(subreq, subreq, &dp_err, &dp_ret, &err_msg);
     talloc_zfree(subreq);
@@ -298,6 +408,22 @@ sss_dp_get_domains_process(struct tevent_req *subreq)
     if (state->dom == NULL) {
         /* No more domains to check, refreshing the active configuration */
         set_time_of_last_request(state->rctx);
+
+        fret = sss_resp_domains_fingerprint(state->rctx, &fingerprint);
+        if (fret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot compare the domains [%d]: %s, rebuilding them.\n",
+                  fret, sss_strerror(fret));
+        } else if (state->rctx->domains_fingerprint_valid
+                       && state->rctx->domains_fingerprint == fingerprint) {
+            DEBUG(SSSDBG_TRACE_FUNC,
+                  "The domains did not change, keeping the domain list.\n");
+            sss_resp_update_certmaps(state->rctx);
+            tevent_req_done(req);
+            return;
+        }
+
+        state->rctx->domains_fingerprint_valid = false;
         ret = sss_resp_populate_cr_domains(state->rctx);
         if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE,
@@ -306,6 +432,11 @@ sss_dp_get_domains_process(struct tevent_req *subreq)
             goto fail;
         }
 
+        if (fret == EOK) {
+            state->rctx->domains_fingerprint = fingerprint;
+            state->rctx->domains_fingerprint_valid = true;
+        }
+
         sss_resp_update_certmaps(state->rctx);
 
         ret = sss_ncache_reset_repopulate_permanent(state->rctx,
@@ -432,18 +563,9 @@ struct get_domains_state {
     struct sss_nc_ctx *optional_ncache;
 };
 
-static void get_domains_at_startup_done(struct tevent_req *req)
+static void get_domains_at_startup_finish(struct get_domains_state *state)
 {
     int ret;
-    struct get_domains_state *state;
-
-    state = tevent_req_callback_data(req, struct get_domains_state);
-
-    ret = sss_dp_get_domains_recv(req);
-    talloc_free(req);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_MINOR_FAILURE, "sss_dp_get_domains request failed.\n");
-    }
 
     if (state->optional_ncache != NULL) {
         ret = sss_ncache_reset_repopulate_permanent(state->rctx,
@@ -466,6 +588,80 @@ static void get_domains_at_startup_done(struct tevent_req *req)
     return;
 }
 
+static void get_domains_at_startup_done(struct tevent_req *req)
+{
+    int ret;
+    struct get_domains_state *state;
+
+    state = tevent_req_callback_data(req, struct get_domains_state);
+
+    ret = sss_dp_get_domains_recv(req);
+    talloc_free(req);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "sss_dp_get_domains request failed.\n");
+    }
+
+    get_domains_at_startup_finish(state);
+}
+
+/* Rebuilds the domain list the previous instance of the responder saved
+ * from the sysdb, so the providers do not have to be asked again. EAGAIN
+ * if there is none or it is not valid anymore. */
+static errno_t get_domains_restore(struct resp_ctx *rctx)
+{
+    struct sss_domain_info *dom;
+    uint64_t fingerprint;
+    time_t saved;
+    errno_t ret;
+
+    saved = rctx->saved_domains_time;
+    rctx->saved_domains_time = 0;
+
+    if (saved == 0 || time(NULL) - saved >= rctx->domains_timeout) {
+        return EAGAIN;
+    }
+
+    for (dom = rctx->domains; dom != NULL; dom = get_next_domain(dom, 0)) {
+        if (!NEED_CHECK_PROVIDER(dom->provider)) {
+            continue;
+        }
+
+        ret = process_subdomains(dom, rctx->cdb);
+        if (ret != EOK) {
+            return ret;
+        }
+        /* the subdomains are as old as the saved list */
+        dom->subdomains_last_checked.tv_sec = saved;
+        dom->subdomains_last_checked.tv_usec = 0;
+    }
+
+    ret = sss_resp_domains_fingerprint(rctx, &fingerprint);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (fingerprint != rctx->saved_domains_fingerprint) {
+        DEBUG(SSSDBG_TRACE_FUNC, "The saved domain list is out of date.\n");
+        return EAGAIN;
+    }
+
+    ret = sss_resp_populate_cr_domains(rctx);
+    if (ret != EOK) {
+        return ret;
+    }
+    rctx->domains_fingerprint = fingerprint;
+    rctx->domains_fingerprint_valid = true;
+
+    sss_resp_update_certmaps(rctx);
+
+    rctx->get_domains_last_call.tv_sec = saved;
+    rctx->get_domains_last_call.tv_usec = 0;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Restored the saved domain list.\n");
+
+    return EOK;
+}
+
 static void get_domains_at_startup(struct tevent_context *ev,
                                    struct tevent_immediate *imm,
                                    void *pvt)
@@ -475,6 +671,11 @@ static void get_domains_at_startup(struct tevent_context *ev,
 
     state = talloc_get_type(pvt, struct get_domains_state);
 
+    if (get_domains_restore(state->rctx) == EOK) {
+        get_domains_at_startup_finish(state);
+        return;
+    }
+
     req = sss_dp_get_domains_send(state, state->rctx, true, NULL);
     if (req == NULL) {
         DEBUG(SSSDBG_OP_FAILURE, "sss_dp_get_domains_send failed.\n");
@@ -19,20 +19,19 @@
 #include "sss_iface/sss_iface_async.h"
 #include "responder/common/negcache.h"
 #include "responder/common/responder.h"
+#include "responder/common/responder_packet.h"
+#include "responder/common/cache_req/cache_req.h"
 
-static void set_domain_state_by_name(struct resp_ctx *rctx,
-                                     const char *domain_name,
-                                     enum sss_domain_state state)
+static struct sss_domain_info *resp_find_domain(struct resp_ctx *rctx,
+                                                const char *domain_name)
 {
     struct sss_domain_info *dom;
 
     if (domain_name == NULL) {
         DEBUG(SSSDBG_MINOR_FAILURE, "BUG: NULL domain name\n");
-        return;
+        return NULL;
     }
 
-    DEBUG(SSSDBG_TRACE_LIBS, "Setting state of domain %s\n", domain_name);
-
     for (dom = rctx->domains;
          dom != NULL;
          dom = get_next_domain(dom, SSS_GND_ALL_DOMAINS)) {
@@ -42,11 +41,44 @@ static void set_domain_state_by_name(struct resp_ctx *rctx,
         }
     }
 
+    return dom;
+}
+
+static void set_domain_state_by_name(struct resp_ctx *rctx,
+                                     const char *domain_name,
+                                     enum sss_domain_state state)
+{
+    struct sss_domain_info *dom;
+
+    DEBUG(SSSDBG_TRACE_LIBS, "Setting state of domain %s\n", domain_name);
+
+    dom = resp_find_domain(rctx, domain_name);
     if (dom != NULL) {
         sss_domain_set_state(dom, state);
     }
 }
 
+static void set_domain_degraded_by_name(struct resp_ctx *rctx,
+                                        const char *domain_name,
+                                        bool degraded)
+{
+    struct sss_domain_info *dom;
+
+    dom = resp_find_domain(rctx, domain_name);
+    if (dom != NULL) {
+        dom->degraded = degraded;
+    }
+}
+
+static void sss_resp_caches_reset(struct resp_ctx *rctx)
+{
+    cache_req_hot_flush(rctx);
+
+    if (rctx->caches_reset_cb != NULL) {
+        rctx->caches_reset_cb(rctx);
+    }
+}
+
 static errno_t
 sss_resp_domain_active(TALLOC_CTX *mem_ctx,
                        struct sbus_request *sbus_req,
@@ -56,6 +88,7 @@ sss_resp_domain_active(TALLOC_CTX *mem_ctx,
     DEBUG(SSSDBG_TRACE_LIBS, "Enabling domain %s\n", domain_name);
 
     set_domain_state_by_name(rctx, domain_name, DOM_ACTIVE);
+    sss_resp_caches_reset(rctx);
 
     return EOK;
 }
@@ -69,6 +102,35 @@ sss_resp_domain_inconsistent(TALLOC_CTX *mem_ctx,
     DEBUG(SSSDBG_TRACE_LIBS, "Disabling domain %s\n", domain_name);
 
     set_domain_state_by_name(rctx, domain_name, DOM_INCONSISTENT);
+    sss_resp_caches_reset(rctx);
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_domain_degraded(TALLOC_CTX *mem_ctx,
+                         struct sbus_request *sbus_req,
+                         struct resp_ctx *rctx,
+                         const char *domain_name)
+{
+    DEBUG(SSSDBG_TRACE_LIBS, "Domain %s is degraded, expired entries will "
+          "be returned and refreshed in the background\n", domain_name);
+
+    set_domain_degraded_by_name(rctx, domain_name, true);
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_domain_recovered(TALLOC_CTX *mem_ctx,
+                          struct sbus_request *sbus_req,
+                          struct resp_ctx *rctx,
+                          const char *domain_name)
+{
+    DEBUG(SSSDBG_TRACE_LIBS, "Domain %s is not degraded anymore\n",
+          domain_name);
+
+    set_domain_degraded_by_name(rctx, domain_name, false);
 
     return EOK;
 }
@@ -79,6 +141,7 @@ sss_resp_reset_ncache_users(TALLOC_CTX *mem_ctx,
                             struct resp_ctx *rctx)
 {
     sss_ncache_reset_users(rctx->ncache);
+    sss_resp_caches_reset(rctx);
 
     return EOK;
 }
@@ -89,6 +152,283 @@ sss_resp_reset_ncache_groups(TALLOC_CTX *mem_ctx,
                             struct resp_ctx *rctx)
 {
     sss_ncache_reset_groups(rctx->ncache);
+    sss_resp_caches_reset(rctx);
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_packet_pool(TALLOC_CTX *mem_ctx,
+                           struct sbus_request *sbus_req,
+                           struct resp_ctx *rctx,
+                           uint64_t *_hits,
+                           uint64_t *_misses,
+                           uint64_t *_discards,
+                           uint64_t *_num_used,
+                           uint64_t *_used_bytes,
+                           uint64_t *_num_free,
+                           uint64_t *_free_bytes)
+{
+    struct sss_packet_pool_stats stats;
+
+    sss_packet_pool_get_stats(&stats);
+
+    *_hits = stats.hits;
+    *_misses = stats.misses;
+    *_discards = stats.discards;
+    *_num_used = stats.num_used;
+    *_used_bytes = stats.used_bytes;
+    *_num_free = stats.num_free;
+    *_free_bytes = stats.free_bytes;
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_cache_req(TALLOC_CTX *mem_ctx,
+                         struct sbus_request *sbus_req,
+                         struct resp_ctx *rctx,
+                         uint64_t *_in_flight,
+                         uint64_t *_coalesced)
+{
+    *_in_flight = 0;
+    if (rctx->cache_req_inflight != NULL) {
+        *_in_flight = hash_count(rctx->cache_req_inflight);
+    }
+
+    *_coalesced = rctx->cache_req_coalesced;
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_object_cache(TALLOC_CTX *mem_ctx,
+                            struct sbus_request *sbus_req,
+                            struct resp_ctx *rctx,
+                            uint64_t *_entries,
+                            uint64_t *_hits,
+                            uint64_t *_misses)
+{
+    cache_req_hot_stats(rctx, _entries, _hits, _misses);
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_commands(TALLOC_CTX *mem_ctx,
+                        struct sbus_request *sbus_req,
+                        struct resp_ctx *rctx,
+                        uint64_t *_in_flight,
+                        uint64_t *_queued,
+                        uint32_t **_commands,
+                        uint64_t **_counts,
+                        uint64_t **_usecs,
+                        uint64_t **_buckets)
+{
+    struct sss_cmd_stats *stats;
+    uint32_t *commands;
+    uint64_t *counts;
+    uint64_t *usecs;
+    uint64_t *buckets;
+    size_t num_cmds;
+    size_t i;
+    size_t r;
+
+    num_cmds = talloc_array_length(rctx->cmd_stats);
+
+    /* Counts and times are ordered by command and result class, buckets
+     * by command, result class and bucket. */
+    commands = talloc_array(mem_ctx, uint32_t, num_cmds);
+    counts = talloc_array(mem_ctx, uint64_t, num_cmds * SSS_CMD_STATS_RESULTS);
+    usecs = talloc_array(mem_ctx, uint64_t, num_cmds * SSS_CMD_STATS_RESULTS);
+    buckets = talloc_array(mem_ctx, uint64_t, num_cmds * SSS_CMD_STATS_RESULTS
+                                              * SSS_CMD_STATS_BUCKETS);
+    if (commands == NULL || counts == NULL || usecs == NULL
+            || buckets == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_cmds; i++) {
+        stats = &rctx->cmd_stats[i];
+        commands[i] = rctx->sss_cmds[i].cmd;
+
+        for (r = 0; r < SSS_CMD_STATS_RESULTS; r++) {
+            counts[i * SSS_CMD_STATS_RESULTS + r] = stats->count[r];
+            usecs[i * SSS_CMD_STATS_RESULTS + r] = stats->usecs[r];
+            memcpy(&buckets[(i * SSS_CMD_STATS_RESULTS + r)
+                            * SSS_CMD_STATS_BUCKETS],
+                   stats->buckets[r], sizeof(stats->buckets[r]));
+        }
+    }
+
+    *_in_flight = rctx->cmd_in_flight;
+    *_queued = rctx->cmd_queued;
+    *_commands = commands;
+    *_counts = counts;
+    *_usecs = usecs;
+    *_buckets = buckets;
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_memory(TALLOC_CTX *mem_ctx,
+                      struct sbus_request *sbus_req,
+                      struct resp_ctx *rctx,
+                      uint64_t *_pool_size,
+                      uint32_t **_commands,
+                      uint64_t **_requests,
+                      uint64_t **_used_sum,
+                      uint64_t **_used_max,
+                      uint64_t **_overflows)
+{
+    struct sss_cmd_stats *stats;
+    uint32_t *commands;
+    uint64_t *requests;
+    uint64_t *used_sum;
+    uint64_t *used_max;
+    uint64_t *overflows;
+    size_t num_cmds;
+    size_t i;
+
+    num_cmds = talloc_array_length(rctx->cmd_stats);
+
+    commands = talloc_array(mem_ctx, uint32_t, num_cmds);
+    requests = talloc_array(mem_ctx, uint64_t, num_cmds);
+    used_sum = talloc_array(mem_ctx, uint64_t, num_cmds);
+    used_max = talloc_array(mem_ctx, uint64_t, num_cmds);
+    overflows = talloc_array(mem_ctx, uint64_t, num_cmds);
+    if (commands == NULL || requests == NULL || used_sum == NULL
+            || used_max == NULL || overflows == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_cmds; i++) {
+        stats = &rctx->cmd_stats[i];
+        commands[i] = rctx->sss_cmds[i].cmd;
+        requests[i] = stats->pool_requests;
+        used_sum[i] = stats->pool_used_sum;
+        used_max[i] = stats->pool_used_max;
+        overflows[i] = stats->pool_overflows;
+    }
+
+    *_pool_size = rctx->request_pool_size;
+    *_commands = commands;
+    *_requests = requests;
+    *_used_sum = used_sum;
+    *_used_max = used_max;
+    *_overflows = overflows;
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_memory_usage(TALLOC_CTX *mem_ctx,
+                            struct sbus_request *sbus_req,
+                            struct resp_ctx *rctx,
+                            uint64_t *_total,
+                            uint64_t *_clients,
+                            uint64_t *_object_cache,
+                            uint64_t *_negcache,
+                            uint64_t *_prefilter,
+                            uint64_t *_packet_pool,
+                            uint64_t *_soft_limit,
+                            uint64_t *_sheds)
+{
+    struct sss_mem_usage usage;
+
+    sss_mem_usage_get(rctx, &usage);
+    sss_mem_limit_stats(rctx, _soft_limit, _sheds);
+
+    *_total = usage.total;
+    *_clients = usage.clients;
+    *_object_cache = usage.object_cache;
+    *_negcache = usage.negcache;
+    *_prefilter = usage.prefilter;
+    *_packet_pool = usage.packet_pool;
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_throttle(TALLOC_CTX *mem_ctx,
+                        struct sbus_request *sbus_req,
+                        struct resp_ctx *rctx,
+                        uint64_t *_deferred,
+                        uint64_t *_waiting,
+                        uint64_t *_uids)
+{
+    sss_client_throttle_stats(rctx, _deferred, _waiting, _uids);
+
+    return EOK;
+}
+
+static errno_t
+sss_resp_stats_dispatcher(TALLOC_CTX *mem_ctx,
+                          struct sbus_request *sbus_req,
+                          struct resp_ctx *rctx,
+                          const char ***_connections,
+                          uint64_t **_wakeups,
+                          uint64_t **_messages,
+                          uint64_t **_deferred,
+                          uint32_t **_max_batch)
+{
+    struct sbus_dispatch_stats stats;
+    struct sbus_connection *conn;
+    struct be_conn *be_conn;
+    const char **connections;
+    uint64_t *wakeups;
+    uint64_t *messages;
+    uint64_t *deferred;
+    uint32_t *max_batch;
+    size_t num_conns;
+    size_t i;
+
+    /* The monitor connection comes first, followed by the connections to
+     * the backends. */
+    num_conns = 1;
+    DLIST_FOR_EACH(be_conn, rctx->be_conns) {
+        num_conns++;
+    }
+
+    connections = talloc_zero_array(mem_ctx, const char *, num_conns + 1);
+    wakeups = talloc_array(mem_ctx, uint64_t, num_conns);
+    messages = talloc_array(mem_ctx, uint64_t, num_conns);
+    deferred = talloc_array(mem_ctx, uint64_t, num_conns);
+    max_batch = talloc_array(mem_ctx, uint32_t, num_conns);
+    if (connections == NULL || wakeups == NULL || messages == NULL
+            || deferred == NULL || max_batch == NULL) {
+        return ENOMEM;
+    }
+
+    conn = rctx->mon_conn;
+    be_conn = rctx->be_conns;
+    for (i = 0; i < num_conns; i++) {
+        if (i == 0) {
+            connections[i] = "monitor";
+        } else {
+            connections[i] = be_conn->domain != NULL ? be_conn->domain->name
+                                                     : be_conn->cli_name;
+            conn = be_conn->conn;
+            be_conn = be_conn->next;
+        }
+
+        memset(&stats, 0, sizeof(stats));
+        if (conn != NULL) {
+            sbus_connection_get_dispatch_stats(conn, &stats);
+        }
+
+        wakeups[i] = stats.wakeups;
+        messages[i] = stats.messages;
+        deferred[i] = stats.deferred;
+        max_batch[i] = stats.max_batch;
+    }
+
+    *_connections = connections;
+    *_wakeups = wakeups;
+    *_messages = messages;
+    *_deferred = deferred;
+    *_max_batch = max_batch;
 
     return EOK;
 }
@@ -103,7 +443,9 @@ sss_resp_register_sbus_iface(struct sbus_connection *conn,
         sssd_Responder_Domain,
         SBUS_METHODS(
             SBUS_SYNC(METHOD, sssd_Responder_Domain, SetActive, sss_resp_domain_active, rctx),
-            SBUS_SYNC(METHOD, sssd_Responder_Domain, SetInconsistent, sss_resp_domain_inconsistent, rctx)
+            SBUS_SYNC(METHOD, sssd_Responder_Domain, SetInconsistent, sss_resp_domain_inconsistent, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Domain, SetDegraded, sss_resp_domain_degraded, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Domain, ClearDegraded, sss_resp_domain_recovered, rctx)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(SBUS_NO_PROPERTIES)
@@ -134,6 +476,36 @@ sss_resp_register_sbus_iface(struct sbus_connection *conn,
     return ret;
 }
 
+errno_t
+sss_resp_register_stats_iface(struct resp_ctx *rctx)
+{
+    errno_t ret;
+
+    SBUS_INTERFACE(iface_stats,
+        sssd_Responder_Stats,
+        SBUS_METHODS(
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, PacketPool, sss_resp_stats_packet_pool, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, CacheReq, sss_resp_stats_cache_req, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, ObjectCache, sss_resp_stats_object_cache, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, Commands, sss_resp_stats_commands, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, Throttle, sss_resp_stats_throttle, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, Memory, sss_resp_stats_memory, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, MemoryUsage, sss_resp_stats_memory_usage, rctx),
+            SBUS_SYNC(METHOD, sssd_Responder_Stats, Dispatcher, sss_resp_stats_dispatcher, rctx)
+        ),
+        SBUS_SIGNALS(SBUS_NO_SIGNALS),
+        SBUS_PROPERTIES(SBUS_NO_PROPERTIES)
+    );
+
+    ret = sbus_connection_add_path(rctx->mon_conn, SSS_BUS_PATH, &iface_stats);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to register statistics interface"
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
+    return ret;
+}
+
 errno_t
 sss_resp_register_service_iface(struct resp_ctx *rctx)
 {
@@ -153,7 +525,8 @@ sss_resp_register_service_iface(struct resp_ctx *rctx)
     if (ret != EOK) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Unable to register service interface"
               "[%d]: %s\n", ret, sss_strerror(ret));
+        return ret;
     }
 
-    return ret;
+    return sss_resp_register_stats_iface(rctx);
 }
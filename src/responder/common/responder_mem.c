@@ -0,0 +1,177 @@
+/*
+    SSSD
+
+    Responder memory accounting and soft limit
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The memory of the responder is accounted by walking the talloc trees of
+ * its largest consumers. With a soft limit the accounting is repeated
+ * periodically and the in-memory caches, which can be rebuilt from the
+ * sysdb, are dropped when the responder gets close to the limit: first
+ * the object cache, then the negative cache.
+ */
+
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util.h"
+#include "responder/common/responder.h"
+#include "responder/common/responder_packet.h"
+#include "responder/common/negcache.h"
+#include "responder/common/cache_req/cache_req.h"
+
+#define SSS_MEM_CHECK_INTERVAL 30
+/* The caches are dropped above this part of the limit */
+#define SSS_MEM_SHED_PERCENT 90
+
+struct sss_mem_limit {
+    struct resp_ctx *rctx;
+    uint64_t soft_limit;
+    uint64_t sheds;
+};
+
+static uint64_t sss_mem_tree_size(const void *ptr)
+{
+    return ptr == NULL ? 0 : talloc_total_size(ptr);
+}
+
+void sss_mem_usage_get(struct resp_ctx *rctx, struct sss_mem_usage *usage)
+{
+    struct sss_packet_pool_stats stats;
+    struct cli_ctx *cctx;
+
+    memset(usage, 0, sizeof(struct sss_mem_usage));
+
+    for (cctx = rctx->clients; cctx != NULL; cctx = cctx->next) {
+        usage->clients += talloc_total_size(cctx);
+    }
+
+    usage->object_cache = sss_mem_tree_size(rctx->cache_req_hot);
+    usage->negcache = sss_mem_tree_size(rctx->ncache);
+    usage->prefilter = sss_mem_tree_size(rctx->cache_req_prefilter);
+
+    /* The buffers in use belong to the packets of the clients */
+    sss_packet_pool_get_stats(&stats);
+    usage->packet_pool = stats.free_bytes;
+
+    usage->total = talloc_total_size(rctx);
+}
+
+static void sss_mem_limit_timer(struct tevent_context *ev,
+                                struct tevent_timer *te,
+                                struct timeval current_time,
+                                void *pvt);
+
+static void sss_mem_limit_schedule(struct sss_mem_limit *ml)
+{
+    struct tevent_timer *te;
+    struct timeval tv;
+
+    tv = tevent_timeval_current_ofs(SSS_MEM_CHECK_INTERVAL, 0);
+    te = tevent_add_timer(ml->rctx->ev, ml, tv, sss_mem_limit_timer, ml);
+    if (te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to schedule memory check, "
+              "the soft limit is not enforced anymore\n");
+    }
+}
+
+static void sss_mem_limit_timer(struct tevent_context *ev,
+                                struct tevent_timer *te,
+                                struct timeval current_time,
+                                void *pvt)
+{
+    struct sss_mem_limit *ml = talloc_get_type(pvt, struct sss_mem_limit);
+    struct resp_ctx *rctx = ml->rctx;
+    struct sss_mem_usage usage;
+    uint64_t threshold;
+    uint64_t left;
+
+    sss_mem_limit_schedule(ml);
+
+    sss_mem_usage_get(rctx, &usage);
+
+    threshold = ml->soft_limit / 100 * SSS_MEM_SHED_PERCENT;
+    if (usage.total < threshold) {
+        return;
+    }
+
+    DEBUG(SSSDBG_MINOR_FAILURE, "Using %"PRIu64" bytes of memory, the soft "
+          "limit is %"PRIu64" bytes. Dropping the object cache "
+          "(%"PRIu64" bytes)\n", usage.total, ml->soft_limit,
+          usage.object_cache);
+
+    ml->sheds++;
+    cache_req_hot_flush(rctx);
+
+    left = usage.total - usage.object_cache;
+    if (left < threshold || rctx->ncache == NULL) {
+        return;
+    }
+
+    DEBUG(SSSDBG_MINOR_FAILURE, "Dropping the negative cache "
+          "(%"PRIu64" bytes)\n", usage.negcache);
+
+    sss_ncache_shrink(rctx->ncache);
+
+    left -= usage.negcache;
+    if (left >= threshold) {
+        DEBUG(SSSDBG_OP_FAILURE, "The caches are empty but the responder "
+              "still uses about %"PRIu64" bytes, %"PRIu64" of them by its "
+              "clients\n", left, usage.clients);
+    }
+}
+
+errno_t sss_mem_limit_init(struct resp_ctx *rctx, uint64_t soft_limit)
+{
+    struct sss_mem_limit *ml;
+
+    talloc_zfree(rctx->mem_limit);
+
+    if (soft_limit == 0) {
+        return EOK;
+    }
+
+    ml = talloc_zero(rctx, struct sss_mem_limit);
+    if (ml == NULL) {
+        return ENOMEM;
+    }
+
+    ml->rctx = rctx;
+    ml->soft_limit = soft_limit;
+    rctx->mem_limit = ml;
+
+    sss_mem_limit_schedule(ml);
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Memory soft limit is %"PRIu64" bytes\n",
+          soft_limit);
+
+    return EOK;
+}
+
+void sss_mem_limit_stats(struct resp_ctx *rctx,
+                         uint64_t *_soft_limit,
+                         uint64_t *_sheds)
+{
+    if (rctx->mem_limit == NULL) {
+        *_soft_limit = 0;
+        *_sheds = 0;
+        return;
+    }
+
+    *_soft_limit = rctx->mem_limit->soft_limit;
+    *_sheds = rctx->mem_limit->sheds;
+}
@@ -30,9 +30,37 @@
 
 #define SSSSRV_PACKET_MEM_SIZE 512
 
+/* Size classes of the packet buffer pool and the number of free buffers
+ * kept for each of them. Larger buffers are not pooled. */
+static const struct {
+    size_t size;
+    size_t max_free;
+} sss_packet_pool_classes[] = {
+    { SSSSRV_PACKET_MEM_SIZE, 64 },
+    { 4 * 1024, 32 },
+    { 16 * 1024, 16 },
+    { 64 * 1024, 8 },
+    { 256 * 1024, 4 },
+};
+
+#define SSS_PACKET_POOL_NUM_CLASSES \
+    (sizeof(sss_packet_pool_classes) / sizeof(sss_packet_pool_classes[0]))
+
+struct sss_packet_pool {
+    uint8_t **free_bufs[SSS_PACKET_POOL_NUM_CLASSES];
+    size_t num_free[SSS_PACKET_POOL_NUM_CLASSES];
+    struct sss_packet_pool_stats stats;
+};
+
+/* There is one pool per responder process. */
+static struct sss_packet_pool *sss_packet_pool;
+
 struct sss_packet {
     size_t memsize;
 
+    /* size class of the buffer, -1 if it does not come from the pool */
+    int pool_class;
+
     /* Structure of the buffer:
     * Bytes    Content
     * ---------------------------------
@@ -40,7 +68,7 @@ struct sss_packet {
     * 0-3      packet length (uint32_t)
     * 4-7      command type (uint32_t)
     * 8-11     status (uint32_t)
-    * 12-15    reserved
+    * 12-15    request tag (uint32_t), echoed back in the reply
     * 16+      packet body */
     uint8_t *buffer;
 
@@ -52,6 +80,7 @@ struct sss_packet {
 #define SSS_PACKET_LEN_OFFSET 0
 #define SSS_PACKET_CMD_OFFSET sizeof(uint32_t)
 #define SSS_PACKET_ERR_OFFSET (2*(sizeof(uint32_t)))
+#define SSS_PACKET_TAG_OFFSET (3*(sizeof(uint32_t)))
 #define SSS_PACKET_BODY_OFFSET (4*(sizeof(uint32_t)))
 
 static void sss_packet_set_len(struct sss_packet *packet, uint32_t len);
@@ -59,32 +88,200 @@ static void sss_packet_set_cmd(struct sss_packet *packet,
                                enum sss_cli_command cmd);
 static uint32_t sss_packet_get_len(struct sss_packet *packet);
 
+static int sss_packet_pool_destructor(struct sss_packet_pool *pool)
+{
+    if (sss_packet_pool == pool) {
+        sss_packet_pool = NULL;
+    }
+
+    return 0;
+}
+
+errno_t sss_packet_pool_init(TALLOC_CTX *mem_ctx)
+{
+    struct sss_packet_pool *pool;
+    size_t c;
+
+    if (sss_packet_pool != NULL) {
+        return EEXIST;
+    }
+
+    pool = talloc_zero(mem_ctx, struct sss_packet_pool);
+    if (pool == NULL) {
+        return ENOMEM;
+    }
+
+    for (c = 0; c < SSS_PACKET_POOL_NUM_CLASSES; c++) {
+        pool->free_bufs[c] = talloc_array(pool, uint8_t *,
+                                          sss_packet_pool_classes[c].max_free);
+        if (pool->free_bufs[c] == NULL) {
+            talloc_free(pool);
+            return ENOMEM;
+        }
+    }
+
+    talloc_set_destructor(pool, sss_packet_pool_destructor);
+    sss_packet_pool = pool;
+
+    return EOK;
+}
+
+void sss_packet_pool_get_stats(struct sss_packet_pool_stats *stats)
+{
+    if (sss_packet_pool == NULL) {
+        memset(stats, 0, sizeof(struct sss_packet_pool_stats));
+        return;
+    }
+
+    *stats = sss_packet_pool->stats;
+}
+
+/* Returns the smallest size class that holds size bytes or -1 */
+static int sss_packet_pool_class(size_t size)
+{
+    size_t c;
+
+    for (c = 0; c < SSS_PACKET_POOL_NUM_CLASSES; c++) {
+        if (size <= sss_packet_pool_classes[c].size) {
+            return c;
+        }
+    }
+
+    return -1;
+}
+
+/* Takes a buffer of the given size class from the pool, or allocates one,
+ * and makes it a child of the packet. The caller sets the packet buffer. */
+static uint8_t *sss_packet_pool_get(struct sss_packet *packet, int class)
+{
+    struct sss_packet_pool *pool = sss_packet_pool;
+    uint8_t *buf;
+
+    if (pool->num_free[class] > 0) {
+        buf = pool->free_bufs[class][--pool->num_free[class]];
+        talloc_steal(packet, buf);
+        pool->stats.hits++;
+        pool->stats.num_free--;
+        pool->stats.free_bytes -= sss_packet_pool_classes[class].size;
+    } else {
+        buf = talloc_size(packet, sss_packet_pool_classes[class].size);
+        if (buf == NULL) {
+            return NULL;
+        }
+        pool->stats.misses++;
+    }
+
+    pool->stats.num_used++;
+    pool->stats.used_bytes += sss_packet_pool_classes[class].size;
+
+    return buf;
+}
+
+/* Gives the buffer of the packet back to the pool, it is freed if the
+ * pool is gone or there are enough free buffers of its size class. */
+static void sss_packet_pool_put(struct sss_packet *packet)
+{
+    struct sss_packet_pool *pool = sss_packet_pool;
+    int class = packet->pool_class;
+
+    packet->pool_class = -1;
+    if (class < 0 || pool == NULL) {
+        talloc_zfree(packet->buffer);
+        return;
+    }
+
+    pool->stats.num_used--;
+    pool->stats.used_bytes -= sss_packet_pool_classes[class].size;
+
+    if (pool->num_free[class] >= sss_packet_pool_classes[class].max_free) {
+        pool->stats.discards++;
+        talloc_zfree(packet->buffer);
+        return;
+    }
+
+    talloc_steal(pool, packet->buffer);
+    pool->free_bufs[class][pool->num_free[class]++] = packet->buffer;
+    packet->buffer = NULL;
+    pool->stats.num_free++;
+    pool->stats.free_bytes += sss_packet_pool_classes[class].size;
+}
+
+static int sss_packet_destructor(struct sss_packet *packet)
+{
+    sss_packet_pool_put(packet);
+    return 0;
+}
+
+/* Replaces the buffer of the packet with a pooled buffer of the given size
+ * class, keeping the first copy_len bytes. */
+static errno_t sss_packet_pool_swap(struct sss_packet *packet, int class,
+                                    size_t copy_len)
+{
+    uint8_t *buf;
+
+    buf = sss_packet_pool_get(packet, class);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+
+    if (packet->buffer != NULL) {
+        memcpy(buf, packet->buffer, copy_len);
+        sss_packet_pool_put(packet);
+    }
+
+    packet->buffer = buf;
+    packet->pool_class = class;
+    packet->memsize = sss_packet_pool_classes[class].size;
+
+    return EOK;
+}
+
 /*
  * Allocate a new packet structure
  *
  * - if size is defined use it otherwise the default packet will be
  *   SSSSRV_PACKET_MEM_SIZE bytes.
+ * - the buffer comes from the packet buffer pool if it was initialized
+ *   and the size fits one of its size classes.
  */
 int sss_packet_new(TALLOC_CTX *mem_ctx, size_t size,
                    enum sss_cli_command cmd,
                    struct sss_packet **rpacket)
 {
     struct sss_packet *packet;
+    int class = -1;
+    errno_t ret;
 
     packet = talloc(mem_ctx, struct sss_packet);
     if (!packet) return ENOMEM;
 
-    if (size) {
-        int n = (size + SSS_NSS_HEADER_SIZE) / SSSSRV_PACKET_MEM_SIZE;
-        packet->memsize = (n + 1) * SSSSRV_PACKET_MEM_SIZE;
-    } else {
-        packet->memsize = SSSSRV_PACKET_MEM_SIZE;
+    packet->buffer = NULL;
+    packet->pool_class = -1;
+    talloc_set_destructor(packet, sss_packet_destructor);
+
+    if (sss_packet_pool != NULL) {
+        class = sss_packet_pool_class(size + SSS_NSS_HEADER_SIZE);
     }
 
-    packet->buffer = talloc_size(packet, packet->memsize);
-    if (!packet->buffer) {
-        talloc_free(packet);
-        return ENOMEM;
+    if (class >= 0) {
+        ret = sss_packet_pool_swap(packet, class, 0);
+        if (ret != EOK) {
+            talloc_free(packet);
+            return ret;
+        }
+    } else {
+        if (size) {
+            int n = (size + SSS_NSS_HEADER_SIZE) / SSSSRV_PACKET_MEM_SIZE;
+            packet->memsize = (n + 1) * SSSSRV_PACKET_MEM_SIZE;
+        } else {
+            packet->memsize = SSSSRV_PACKET_MEM_SIZE;
+        }
+
+        packet->buffer = talloc_size(packet, packet->memsize);
+        if (!packet->buffer) {
+            talloc_free(packet);
+            return ENOMEM;
+        }
     }
     memset(packet->buffer, 0, SSS_NSS_HEADER_SIZE);
 
@@ -104,6 +301,8 @@ int sss_packet_grow(struct sss_packet *packet, size_t size)
     size_t totlen, len;
     uint8_t *newmem;
     uint32_t packet_len;
+    int class = -1;
+    errno_t ret;
 
     if (size == 0) {
         return EOK;
@@ -123,7 +322,27 @@ int sss_packet_grow(struct sss_packet *packet, size_t size)
         }
     }
 
-    if (totlen > packet->memsize) {
+    if (totlen > packet->memsize && sss_packet_pool != NULL) {
+        class = sss_packet_pool_class(len);
+    }
+
+    if (class >= 0) {
+        ret = sss_packet_pool_swap(packet, class, packet->memsize);
+        if (ret != EOK) {
+            return ret;
+        }
+    } else if (totlen > packet->memsize && packet->pool_class >= 0) {
+        /* too large for the pool */
+        newmem = talloc_size(packet, totlen);
+        if (!newmem) {
+            return ENOMEM;
+        }
+
+        memcpy(newmem, packet->buffer, packet->memsize);
+        sss_packet_pool_put(packet);
+        packet->buffer = newmem;
+        packet->memsize = totlen;
+    } else if (totlen > packet->memsize) {
         newmem = talloc_realloc_size(packet, packet->buffer, totlen);
         if (!newmem) {
             return ENOMEM;
@@ -174,13 +393,53 @@ int sss_packet_set_size(struct sss_packet *packet, size_t size)
     return 0;
 }
 
+/* Checks the length of a packet once some data was received into it and
+ * tells if the packet is complete. */
+static int sss_packet_recv_check(struct sss_packet *packet)
+{
+    size_t new_len;
+    int ret;
+
+    if (packet->iop < SSS_PACKET_CMD_OFFSET) {
+        return EAGAIN;
+    }
+
+    new_len = sss_packet_get_len(packet);
+    if (new_len < SSS_NSS_HEADER_SIZE) {
+        return EINVAL;
+    }
+
+    if (new_len > packet->memsize) {
+        /* Allow certificate based requests to use larger buffer but not
+         * larger than SSS_CERT_PACKET_MAX_RECV_SIZE. Due to the way
+         * sss_packet_grow() works the packet len must be set to '0' first and
+         * then grow to the expected size. */
+        if ((sss_packet_get_cmd(packet) == SSS_NSS_GETNAMEBYCERT
+                    || sss_packet_get_cmd(packet) == SSS_NSS_GETLISTBYCERT)
+                && packet->memsize < SSS_CERT_PACKET_MAX_RECV_SIZE
+                && new_len < SSS_CERT_PACKET_MAX_RECV_SIZE) {
+            sss_packet_set_len(packet, 0);
+            ret = sss_packet_grow(packet, new_len);
+            if (ret != EOK) {
+                return ret;
+            }
+        } else {
+            return EINVAL;
+        }
+    }
+
+    if (packet->iop < new_len) {
+        return EAGAIN;
+    }
+
+    return EOK;
+}
+
 int sss_packet_recv(struct sss_packet *packet, int fd)
 {
     size_t rb;
     size_t len;
     void *buf;
-    size_t new_len;
-    int ret;
 
     buf = (uint8_t *)packet->buffer + packet->iop;
     if (packet->iop >= SSS_PACKET_CMD_OFFSET) {
@@ -210,35 +469,35 @@ int sss_packet_recv(struct sss_packet *packet, int fd)
     }
 
     packet->iop += rb;
-    if (packet->iop < SSS_PACKET_CMD_OFFSET) {
-        return EAGAIN;
-    }
 
-    new_len = sss_packet_get_len(packet);
-    if (new_len > packet->memsize) {
-        /* Allow certificate based requests to use larger buffer but not
-         * larger than SSS_CERT_PACKET_MAX_RECV_SIZE. Due to the way
-         * sss_packet_grow() works the packet len must be set to '0' first and
-         * then grow to the expected size. */
-        if ((sss_packet_get_cmd(packet) == SSS_NSS_GETNAMEBYCERT
-                    || sss_packet_get_cmd(packet) == SSS_NSS_GETLISTBYCERT)
-                && packet->memsize < SSS_CERT_PACKET_MAX_RECV_SIZE
-                && new_len < SSS_CERT_PACKET_MAX_RECV_SIZE) {
-            sss_packet_set_len(packet, 0);
-            ret = sss_packet_grow(packet, new_len);
-            if (ret != EOK) {
-                return ret;
-            }
-        } else {
-            return EINVAL;
-        }
+    return sss_packet_recv_check(packet);
+}
+
+/* A client that pipelines requests may have sent the beginning of the next
+ * request together with the current one. Moves the bytes received past the
+ * end of the packet into an empty packet. Returns ENOENT if there are no such
+ * bytes, EAGAIN if the next packet is not complete yet. */
+int sss_packet_recv_surplus(struct sss_packet *packet,
+                            struct sss_packet *next)
+{
+    size_t len;
+    size_t surplus;
+
+    len = sss_packet_get_len(packet);
+    if (packet->iop <= len) {
+        return ENOENT;
     }
 
-    if (packet->iop < new_len) {
-        return EAGAIN;
+    surplus = packet->iop - len;
+    if (surplus > next->memsize - next->iop) {
+        return EINVAL;
     }
 
-    return EOK;
+    memcpy(next->buffer + next->iop, packet->buffer + len, surplus);
+    next->iop += surplus;
+    packet->iop = len;
+
+    return sss_packet_recv_check(next);
 }
 
 int sss_packet_send(struct sss_packet *packet, int fd)
@@ -321,6 +580,19 @@ errno_t sss_packet_set_body(struct sss_packet *packet,
     return EOK;
 }
 
+uint32_t sss_packet_get_tag(struct sss_packet *packet)
+{
+    uint32_t tag;
+
+    SAFEALIGN_COPY_UINT32(&tag, packet->buffer + SSS_PACKET_TAG_OFFSET, NULL);
+    return tag;
+}
+
+void sss_packet_set_tag(struct sss_packet *packet, uint32_t tag)
+{
+    SAFEALIGN_SETMEM_UINT32(packet->buffer + SSS_PACKET_TAG_OFFSET, tag, NULL);
+}
+
 void sss_packet_set_error(struct sss_packet *packet, int error)
 {
     SAFEALIGN_SETMEM_UINT32(packet->buffer + SSS_PACKET_ERR_OFFSET, error,
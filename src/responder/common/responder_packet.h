@@ -29,6 +29,26 @@
 
 struct sss_packet;
 
+/* Usage counters of the packet buffer pool */
+struct sss_packet_pool_stats {
+    /* buffers taken from the pool / newly allocated */
+    uint64_t hits;
+    uint64_t misses;
+    /* buffers freed because their size class was full */
+    uint64_t discards;
+    /* buffers held by packets and free buffers kept in the pool */
+    uint64_t num_used;
+    uint64_t used_bytes;
+    uint64_t num_free;
+    uint64_t free_bytes;
+};
+
+/* Sets up the buffer pool used by all packets of the process. The pool is
+ * freed together with mem_ctx, buffers still in use are then freed with
+ * their packets. */
+errno_t sss_packet_pool_init(TALLOC_CTX *mem_ctx);
+void sss_packet_pool_get_stats(struct sss_packet_pool_stats *stats);
+
 int sss_packet_new(TALLOC_CTX *mem_ctx, size_t size,
                    enum sss_cli_command cmd,
                    struct sss_packet **rpacket);
@@ -36,9 +56,13 @@ int sss_packet_grow(struct sss_packet *packet, size_t size);
 int sss_packet_shrink(struct sss_packet *packet, size_t size);
 int sss_packet_set_size(struct sss_packet *packet, size_t size);
 int sss_packet_recv(struct sss_packet *packet, int fd);
+int sss_packet_recv_surplus(struct sss_packet *packet,
+                            struct sss_packet *next);
 int sss_packet_send(struct sss_packet *packet, int fd);
 enum sss_cli_command sss_packet_get_cmd(struct sss_packet *packet);
 uint32_t sss_packet_get_status(struct sss_packet *packet);
+uint32_t sss_packet_get_tag(struct sss_packet *packet);
+void sss_packet_set_tag(struct sss_packet *packet, uint32_t tag);
 void sss_packet_get_body(struct sss_packet *packet, uint8_t **body, size_t *blen);
 void sss_packet_set_error(struct sss_packet *packet, int error);
 
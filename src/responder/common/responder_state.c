@@ -0,0 +1,315 @@
+/*
+    SSSD
+
+    Responder state kept across idle restarts
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * A socket or D-Bus activated responder exits when it is idle and starts
+ * again with the next request. So that this request does not start from
+ * cold caches the responder writes a small state file when it exits: the
+ * time and the fingerprint of its domain list and the negative cache
+ * entries that have not expired yet. The next instance reads it once and
+ * removes it.
+ *
+ * The domain list is restored from the sysdb when the saved one is not
+ * older than get_domains_timeout and the sysdb still describes the same
+ * domains, otherwise the domains are discovered as usual. The negative
+ * entries are only restored if none of the domain caches was written since
+ * they were saved, as a new object in the cache would be hidden by them.
+ * The object cache is not part of the state, its shared part is kept in a
+ * file anyway.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "db/sysdb.h"
+#include "responder/common/responder.h"
+#include "responder/common/negcache.h"
+
+#define SSS_RESP_STATE_MAGIC "SSSD_RESP_STATE"
+#define SSS_RESP_STATE_VERSION 1
+
+char *sss_resp_state_path(TALLOC_CTX *mem_ctx, struct resp_ctx *rctx)
+{
+    const char *name;
+
+    if (rctx->confdb_service_path == NULL) {
+        return NULL;
+    }
+
+    name = strrchr(rctx->confdb_service_path, '/');
+    name = name == NULL ? rctx->confdb_service_path : name + 1;
+
+    return talloc_asprintf(mem_ctx, "%s/%s.state", DB_PATH, name);
+}
+
+static errno_t sss_resp_state_write_entry(const char *key, time_t expire,
+                                          void *pvt)
+{
+    FILE *f = pvt;
+
+    /* one entry per line */
+    if (strchr(key, '\n') != NULL) {
+        return EOK;
+    }
+
+    if (fprintf(f, "nc %lld %s\n", (long long)expire, key) < 0) {
+        return EIO;
+    }
+
+    return EOK;
+}
+
+errno_t sss_resp_state_save(struct resp_ctx *rctx, const char *path)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct timespec now;
+    char *tmp_path;
+    FILE *f = NULL;
+    int fd;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    tmp_path = talloc_asprintf(tmp_ctx, "%s.tmp", path);
+    if (tmp_path == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to create [%s] [%d]: %s\n",
+              tmp_path, ret, sss_strerror(ret));
+        goto done;
+    }
+
+    f = fdopen(fd, "w");
+    if (f == NULL) {
+        ret = errno;
+        close(fd);
+        goto done;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    fprintf(f, "%s %d\n", SSS_RESP_STATE_MAGIC, SSS_RESP_STATE_VERSION);
+    fprintf(f, "saved %lld %ld\n", (long long)now.tv_sec, now.tv_nsec);
+
+    if (rctx->domains_fingerprint_valid
+            && rctx->get_domains_last_call.tv_sec != 0) {
+        fprintf(f, "domains %lld %"PRIx64"\n",
+                (long long)rctx->get_domains_last_call.tv_sec,
+                rctx->domains_fingerprint);
+    }
+
+    if (rctx->ncache != NULL) {
+        ret = sss_ncache_foreach(rctx->ncache, sss_resp_state_write_entry, f);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = fclose(f);
+    f = NULL;
+    if (ret != 0) {
+        ret = errno;
+        goto done;
+    }
+
+    ret = rename(tmp_path, path);
+    if (ret != 0) {
+        ret = errno;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Responder state saved to [%s]\n", path);
+    ret = EOK;
+
+done:
+    if (f != NULL) {
+        fclose(f);
+    }
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to save the responder state "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        unlink(tmp_path);
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static bool sss_resp_state_file_newer(const char *file,
+                                      const struct timespec *saved)
+{
+    struct stat st;
+    int ret;
+
+    ret = stat(file, &st);
+    if (ret != 0) {
+        /* unknown, so possibly changed */
+        return true;
+    }
+
+    return st.st_mtim.tv_sec > saved->tv_sec
+           || (st.st_mtim.tv_sec == saved->tv_sec
+                   && st.st_mtim.tv_nsec > saved->tv_nsec);
+}
+
+/* True if no cache of the domains, or timestamp cache, was written after
+ * saved */
+static bool sss_resp_state_caches_unchanged(struct resp_ctx *rctx,
+                                            const char *db_path,
+                                            const struct timespec *saved)
+{
+    struct sss_domain_info *dom;
+    TALLOC_CTX *tmp_ctx;
+    char *ldb_file;
+    char *ts_file;
+    bool unchanged = false;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return false;
+    }
+
+    for (dom = rctx->domains; dom != NULL; dom = get_next_domain(dom, 0)) {
+        ret = sysdb_cache_files(tmp_ctx, dom, db_path, &ldb_file, &ts_file);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        if (sss_resp_state_file_newer(ldb_file, saved)
+                || (ts_file != NULL
+                        && sss_resp_state_file_newer(ts_file, saved))) {
+            DEBUG(SSSDBG_TRACE_FUNC, "The cache of [%s] changed\n",
+                  dom->name);
+            goto done;
+        }
+    }
+
+    unchanged = true;
+
+done:
+    talloc_free(tmp_ctx);
+    return unchanged;
+}
+
+errno_t sss_resp_state_load(struct resp_ctx *rctx, const char *path)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct timespec saved = { 0, 0 };
+    bool restore_ncache = false;
+    char *line = NULL;
+    size_t len = 0;
+    char *db_path;
+    char *key;
+    long long when;
+    long nsec;
+    uint64_t fingerprint;
+    int version;
+    int restored = 0;
+    int n;
+    FILE *f;
+    errno_t ret;
+
+    f = fopen(path, "r");
+    if (f == NULL) {
+        ret = errno;
+        if (ret != ENOENT) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to open [%s] [%d]: %s\n",
+                  path, ret, sss_strerror(ret));
+        }
+        return ret;
+    }
+
+    /* the state is only used once */
+    unlink(path);
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    db_path = talloc_strdup(tmp_ctx, path);
+    if (db_path == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    key = strrchr(db_path, '/');
+    if (key != NULL) {
+        *key = '\0';
+    } else {
+        db_path = discard_const(".");
+    }
+
+    if (getline(&line, &len, f) < 0
+            || sscanf(line, SSS_RESP_STATE_MAGIC" %d", &version) != 1
+            || version != SSS_RESP_STATE_VERSION) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Ignoring unknown state file [%s]\n",
+              path);
+        ret = EINVAL;
+        goto done;
+    }
+
+    while (getline(&line, &len, f) > 0) {
+        line[strcspn(line, "\n")] = '\0';
+
+        if (sscanf(line, "saved %lld %ld", &when, &nsec) == 2) {
+            saved.tv_sec = when;
+            saved.tv_nsec = nsec;
+            restore_ncache = sss_resp_state_caches_unchanged(rctx, db_path,
+                                                             &saved);
+        } else if (sscanf(line, "domains %lld %"SCNx64,
+                          &when, &fingerprint) == 2) {
+            rctx->saved_domains_time = when;
+            rctx->saved_domains_fingerprint = fingerprint;
+        } else if (sscanf(line, "nc %lld %n", &when, &n) == 1) {
+            if (!restore_ncache || rctx->ncache == NULL) {
+                continue;
+            }
+
+            ret = sss_ncache_restore(rctx->ncache, line + n, when);
+            if (ret == ENOMEM) {
+                goto done;
+            } else if (ret == EOK) {
+                restored++;
+            }
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Responder state loaded from [%s], %s domain "
+          "list and %d negative cache entries\n", path,
+          rctx->saved_domains_time != 0 ? "with" : "without", restored);
+    ret = EOK;
+
+done:
+    free(line);
+    fclose(f);
+    talloc_free(tmp_ctx);
+    return ret;
+}
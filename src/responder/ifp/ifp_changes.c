@@ -0,0 +1,184 @@
+/*
+    SSSD
+
+    InfoPipe responder: signals about changed users and groups
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <talloc.h>
+
+#include "db/sysdb.h"
+#include "util/util.h"
+#include "responder/common/responder.h"
+#include "responder/ifp/ifp_private.h"
+#include "responder/ifp/ifp_users.h"
+#include "responder/ifp/ifp_groups.h"
+#include "sss_iface/sss_iface_async.h"
+
+/* The backends collect the users and groups they write to the cache for a
+ * short while and send their names here. They are turned into the object
+ * paths of the Users and Groups interfaces, so clients that keep the
+ * objects they are interested in do not have to poll for changes. An
+ * object that is not in the cache anymore has no path, the signal then
+ * says that any object of the domain may have changed, as it does when the
+ * backend sends no names at all. */
+
+static const char **
+ifp_changes_paths(TALLOC_CTX *mem_ctx,
+                  struct sss_domain_info *domain,
+                  bool users,
+                  const char **names)
+{
+    struct ldb_result *res;
+    const char **paths;
+    size_t count;
+    size_t i;
+    errno_t ret;
+
+    count = names == NULL ? 0 : talloc_array_length(names) - 1;
+    if (count == 0) {
+        return NULL;
+    }
+
+    paths = talloc_zero_array(mem_ctx, const char *, count + 1);
+    if (paths == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (users) {
+            ret = sysdb_getpwnam(paths, domain, names[i], &res);
+        } else {
+            ret = sysdb_getgrnam(paths, domain, names[i], &res);
+        }
+        if (ret != EOK || res->count != 1) {
+            DEBUG(SSSDBG_TRACE_FUNC, "[%s] is not in the cache\n", names[i]);
+            talloc_free(paths);
+            return NULL;
+        }
+
+        if (users) {
+            paths[i] = ifp_users_build_path_from_msg(paths, domain,
+                                                     res->msgs[0]);
+        } else {
+            paths[i] = ifp_groups_build_path_from_msg(paths, domain,
+                                                      res->msgs[0]);
+        }
+        talloc_free(res);
+        if (paths[i] == NULL) {
+            talloc_free(paths);
+            return NULL;
+        }
+    }
+
+    return paths;
+}
+
+static errno_t
+ifp_changes_emit(struct ifp_ctx *ifp_ctx,
+                 const char *domain_name,
+                 bool users,
+                 const char **names)
+{
+    struct sss_domain_info *domain;
+    const char *domain_path;
+    const char **paths;
+    TALLOC_CTX *tmp_ctx;
+
+    if (ifp_ctx->sysbus == NULL) {
+        /* Nobody to tell */
+        return EOK;
+    }
+
+    domain = find_domain_by_name(ifp_ctx->rctx->domains, domain_name, true);
+    if (domain == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unknown domain [%s]\n", domain_name);
+        return EOK;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    domain_path = sbus_opath_compose(tmp_ctx, IFP_PATH_DOMAINS, domain->name);
+    if (domain_path == NULL) {
+        talloc_free(tmp_ctx);
+        return ENOMEM;
+    }
+
+    paths = ifp_changes_paths(tmp_ctx, domain, users, names);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "%s of domain %s changed\n",
+          paths == NULL ? (users ? "All users" : "All groups")
+                        : (users ? "Users" : "Groups"),
+          domain->name);
+
+    if (users) {
+        sbus_emit_ifp_users_UsersChanged(ifp_ctx->sysbus, IFP_PATH_USERS,
+                                         domain_path, paths);
+    } else {
+        sbus_emit_ifp_groups_GroupsChanged(ifp_ctx->sysbus, IFP_PATH_GROUPS,
+                                           domain_path, paths);
+    }
+
+    talloc_free(tmp_ctx);
+    return EOK;
+}
+
+static errno_t
+ifp_changes_users_changed(TALLOC_CTX *mem_ctx,
+                          struct sbus_request *sbus_req,
+                          struct ifp_ctx *ifp_ctx,
+                          const char *domain,
+                          const char **names)
+{
+    return ifp_changes_emit(ifp_ctx, domain, true, names);
+}
+
+static errno_t
+ifp_changes_groups_changed(TALLOC_CTX *mem_ctx,
+                           struct sbus_request *sbus_req,
+                           struct ifp_ctx *ifp_ctx,
+                           const char *domain,
+                           const char **names)
+{
+    return ifp_changes_emit(ifp_ctx, domain, false, names);
+}
+
+errno_t
+ifp_register_backend_iface(struct sbus_connection *conn,
+                           struct ifp_ctx *ifp_ctx)
+{
+    errno_t ret;
+
+    SBUS_INTERFACE(iface,
+        sssd_ifp_Changes,
+        SBUS_METHODS(
+            SBUS_SYNC(METHOD, sssd_ifp_Changes, UsersChanged, ifp_changes_users_changed, ifp_ctx),
+            SBUS_SYNC(METHOD, sssd_ifp_Changes, GroupsChanged, ifp_changes_groups_changed, ifp_ctx)
+        ),
+        SBUS_SIGNALS(SBUS_NO_SIGNALS),
+        SBUS_PROPERTIES(SBUS_NO_PROPERTIES)
+    );
+
+    ret = sbus_connection_add_path(conn, SSS_BUS_PATH, &iface);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to register changes interface"
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
+    return ret;
+}
@@ -180,6 +180,20 @@ ifp_domains_domain_list_servers_recv(TALLOC_CTX *mem_ctx,
                                       struct tevent_req *req,
                                       const char ***_servers);
 
+struct tevent_req *
+ifp_domains_domain_server_tuning_send(TALLOC_CTX *mem_ctx,
+                                      struct tevent_context *ev,
+                                      struct sbus_request *sbus_req,
+                                      struct ifp_ctx *ifp_ctx,
+                                      const char *service);
+
+errno_t
+ifp_domains_domain_server_tuning_recv(TALLOC_CTX *mem_ctx,
+                                      struct tevent_req *req,
+                                      uint32_t *_page_size,
+                                      uint32_t *_pool_size,
+                                      uint32_t *_page_msecs);
+
 struct tevent_req *
 ifp_domains_domain_refresh_access_rules_send(TALLOC_CTX *mem_ctx,
                                              struct tevent_context *ev,
@@ -221,6 +221,8 @@ ifp_groups_find_by_id_send(TALLOC_CTX *mem_ctx,
     struct ifp_groups_find_by_id_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
+    /* Only the object path is returned, the members are not needed */
+    const char *attrs[] = { SYSDB_GIDNUM, NULL };
     errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state, struct ifp_groups_find_by_id_state);
@@ -229,8 +231,9 @@ ifp_groups_find_by_id_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    subreq = cache_req_group_by_id_send(state, ctx->rctx->ev, ctx->rctx,
-                                        ctx->rctx->ncache, 0, NULL, id);
+    subreq = cache_req_group_by_id_attrs_send(state, ctx->rctx->ev, ctx->rctx,
+                                              ctx->rctx->ncache, 0, NULL, id,
+                                              attrs);
     if (subreq == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
         ret = ENOMEM;
@@ -260,7 +263,7 @@ static void ifp_groups_find_by_id_done(struct tevent_req *subreq)
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct ifp_groups_find_by_id_state);
 
-    ret = cache_req_group_by_id_recv(state, subreq, &result);
+    ret = cache_req_group_by_id_attrs_recv(state, subreq, &result);
     talloc_zfree(subreq);
     if (ret != EOK) {
         DEBUG(SSSDBG_MINOR_FAILURE, "Unable to find group [%d]: %s\n",
@@ -521,6 +524,54 @@ ifp_groups_list_by_domain_and_name_recv(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+struct tevent_req *
+ifp_groups_list_by_name_paged_send(TALLOC_CTX *mem_ctx,
+                                   struct tevent_context *ev,
+                                   struct sbus_request *sbus_req,
+                                   struct ifp_ctx *ctx,
+                                   const char *filter,
+                                   const char *cursor,
+                                   uint32_t page_size,
+                                   const char **attrs,
+                                   DBusMessageIter *write_iter)
+{
+    static const char *whitelist[] = IFP_GROUPS_ALLOWED_ATTRS;
+    struct tevent_req *req;
+    void *state;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, void *);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    /* Only the cache is searched so the whole page is built at once */
+    ret = ifp_list_page_write_reply(ctx, sysdb_search_groups_stream,
+                                    ifp_groups_build_path_from_msg,
+                                    whitelist, filter, cursor,
+                                    page_size, attrs, write_iter);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to list groups [%d]: %s\n",
+              ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+    } else {
+        tevent_req_done(req);
+    }
+    tevent_req_post(req, ev);
+
+    return req;
+}
+
+errno_t
+ifp_groups_list_by_name_paged_recv(TALLOC_CTX *mem_ctx,
+                                   struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
 static errno_t
 ifp_groups_get_from_cache(TALLOC_CTX *mem_ctx,
                           struct sss_domain_info *domain,
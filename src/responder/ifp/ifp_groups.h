@@ -25,6 +25,10 @@
 
 /* Utility functions */
 
+/* Attributes of the Group object that may be requested by name */
+#define IFP_GROUPS_ALLOWED_ATTRS {SYSDB_NAME, SYSDB_GIDNUM, SYSDB_UUID, \
+                                  SYSDB_SID_STR, "domainname", NULL}
+
 char * ifp_groups_build_path_from_msg(TALLOC_CTX *mem_ctx,
                                       struct sss_domain_info *domain,
                                       struct ldb_message *msg);
@@ -82,6 +86,21 @@ ifp_groups_list_by_domain_and_name_recv(TALLOC_CTX *mem_ctx,
                                         struct tevent_req *req,
                                         const char ***_paths);
 
+struct tevent_req *
+ifp_groups_list_by_name_paged_send(TALLOC_CTX *mem_ctx,
+                                   struct tevent_context *ev,
+                                   struct sbus_request *sbus_req,
+                                   struct ifp_ctx *ctx,
+                                   const char *filter,
+                                   const char *cursor,
+                                   uint32_t page_size,
+                                   const char **attrs,
+                                   DBusMessageIter *write_iter);
+
+errno_t
+ifp_groups_list_by_name_paged_recv(TALLOC_CTX *mem_ctx,
+                                   struct tevent_req *req);
+
 /* org.freedesktop.sssd.infopipe.Groups.Group */
 
 struct tevent_req *
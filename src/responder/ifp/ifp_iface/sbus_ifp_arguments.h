@@ -43,6 +43,22 @@ _sbus_ifp_invoker_write_ao
    (DBusMessageIter *iter,
     struct _sbus_ifp_invoker_args_ao *args);
 
+struct _sbus_ifp_invoker_args_aoas {
+    const char ** arg0;
+    const char ** arg1;
+};
+
+errno_t
+_sbus_ifp_invoker_read_aoas
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_aoas *args);
+
+errno_t
+_sbus_ifp_invoker_write_aoas
+   (DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_aoas *args);
+
 struct _sbus_ifp_invoker_args_as {
     const char ** arg0;
 };
@@ -103,6 +119,22 @@ _sbus_ifp_invoker_write_o
    (DBusMessageIter *iter,
     struct _sbus_ifp_invoker_args_o *args);
 
+struct _sbus_ifp_invoker_args_oao {
+    const char * arg0;
+    const char ** arg1;
+};
+
+errno_t
+_sbus_ifp_invoker_read_oao
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_oao *args);
+
+errno_t
+_sbus_ifp_invoker_write_oao
+   (DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_oao *args);
+
 struct _sbus_ifp_invoker_args_s {
     const char * arg0;
 };
@@ -167,6 +199,24 @@ _sbus_ifp_invoker_write_ssu
    (DBusMessageIter *iter,
     struct _sbus_ifp_invoker_args_ssu *args);
 
+struct _sbus_ifp_invoker_args_ssuas {
+    const char * arg0;
+    const char * arg1;
+    uint32_t arg2;
+    const char ** arg3;
+};
+
+errno_t
+_sbus_ifp_invoker_read_ssuas
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_ssuas *args);
+
+errno_t
+_sbus_ifp_invoker_write_ssuas
+   (DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_ssuas *args);
+
 struct _sbus_ifp_invoker_args_su {
     const char * arg0;
     uint32_t arg1;
@@ -198,4 +248,21 @@ _sbus_ifp_invoker_write_u
    (DBusMessageIter *iter,
     struct _sbus_ifp_invoker_args_u *args);
 
+struct _sbus_ifp_invoker_args_uuu {
+    uint32_t arg0;
+    uint32_t arg1;
+    uint32_t arg2;
+};
+
+errno_t
+_sbus_ifp_invoker_read_uuu
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_uuu *args);
+
+errno_t
+_sbus_ifp_invoker_write_uuu
+   (DBusMessageIter *iter,
+    struct _sbus_ifp_invoker_args_uuu *args);
+
 #endif /* _SBUS_IFP_ARGUMENTS_H_ */
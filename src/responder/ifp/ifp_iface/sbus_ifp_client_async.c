@@ -29,3 +29,43 @@
 #include "responder/ifp/ifp_iface/sbus_ifp_keygens.h"
 #include "responder/ifp/ifp_iface/sbus_ifp_client_properties.h"
 
+static void
+sbus_emit_signal_oao
+    (struct sbus_connection *conn,
+     const char *path,
+     const char *iface,
+     const char *signal_name,
+     const char * arg0,
+     const char ** arg1)
+{
+    struct _sbus_ifp_invoker_args_oao args;
+
+    args.arg0 = arg0;
+    args.arg1 = arg1;
+
+    sbus_call_signal_send(conn, NULL, (sbus_invoker_writer_fn)_sbus_ifp_invoker_write_oao,
+                          path, iface, signal_name, &args);
+}
+
+void
+sbus_emit_ifp_groups_GroupsChanged
+    (struct sbus_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_groups)
+{
+    sbus_emit_signal_oao(conn, object_path,
+        "org.freedesktop.sssd.infopipe.Groups", "GroupsChanged", arg_domain, arg_groups);
+}
+
+void
+sbus_emit_ifp_users_UsersChanged
+    (struct sbus_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_users)
+{
+    sbus_emit_signal_oao(conn, object_path,
+        "org.freedesktop.sssd.infopipe.Users", "UsersChanged", arg_domain, arg_users);
+}
+
@@ -28,4 +28,18 @@
 #include "responder/ifp/ifp_iface/sbus_ifp_client_properties.h"
 #include "responder/ifp/ifp_iface/ifp_iface_types.h"
 
+void
+sbus_emit_ifp_groups_GroupsChanged
+    (struct sbus_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_groups);
+
+void
+sbus_emit_ifp_users_UsersChanged
+    (struct sbus_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_users);
+
 #endif /* _SBUS_IFP_CLIENT_ASYNC_H_ */
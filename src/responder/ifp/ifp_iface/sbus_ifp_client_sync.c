@@ -265,6 +265,64 @@ done:
     return ret;
 }
 
+static errno_t
+sbus_method_in_aoas_out_raw
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     const char ** arg0,
+     const char ** arg1,
+     DBusMessage **_reply)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_ifp_invoker_args_aoas in;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    in.arg0 = arg0;
+    in.arg1 = arg1;
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL,
+                                (sbus_invoker_writer_fn)_sbus_ifp_invoker_write_aoas,
+                                bus, path, iface, method, &in, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* Bounded reference cannot be unreferenced with dbus_message_unref.
+     * For that reason we do not allow NULL memory context as it would
+     * result in leaking the message memory. */
+    if (mem_ctx == NULL) {
+        ret = EINVAL;
+        goto done;
+    }
+
+    ret = sbus_message_bound_steal(mem_ctx, reply);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to steal message [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    *_reply = reply;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
 static errno_t
 sbus_method_in_s_out_ao
     (TALLOC_CTX *mem_ctx,
@@ -485,6 +543,64 @@ done:
     return ret;
 }
 
+static errno_t
+sbus_method_in_s_out_uuu
+    (struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     const char * arg0,
+     uint32_t* _arg0,
+     uint32_t* _arg1,
+     uint32_t* _arg2)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_ifp_invoker_args_s in;
+    struct _sbus_ifp_invoker_args_uuu *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_ifp_invoker_args_uuu);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    in.arg0 = arg0;
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL,
+                                (sbus_invoker_writer_fn)_sbus_ifp_invoker_write_s,
+                                bus, path, iface, method, &in, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_ifp_invoker_read_uuu, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = out->arg0;
+    *_arg1 = out->arg1;
+    *_arg2 = out->arg2;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
 static errno_t
 sbus_method_in_sas_out_raw
     (TALLOC_CTX *mem_ctx,
@@ -659,6 +775,68 @@ done:
     return ret;
 }
 
+static errno_t
+sbus_method_in_ssuas_out_raw
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     const char * arg0,
+     const char * arg1,
+     uint32_t arg2,
+     const char ** arg3,
+     DBusMessage **_reply)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_ifp_invoker_args_ssuas in;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    in.arg0 = arg0;
+    in.arg1 = arg1;
+    in.arg2 = arg2;
+    in.arg3 = arg3;
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL,
+                                (sbus_invoker_writer_fn)_sbus_ifp_invoker_write_ssuas,
+                                bus, path, iface, method, &in, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* Bounded reference cannot be unreferenced with dbus_message_unref.
+     * For that reason we do not allow NULL memory context as it would
+     * result in leaking the message memory. */
+    if (mem_ctx == NULL) {
+        ret = EINVAL;
+        goto done;
+    }
+
+    ret = sbus_message_bound_steal(mem_ctx, reply);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to steal message [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    *_reply = reply;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
 static errno_t
 sbus_method_in_su_out_ao
     (TALLOC_CTX *mem_ctx,
@@ -826,6 +1004,21 @@ sbus_call_ifp_FindResponderByName
           _arg_responder);
 }
 
+errno_t
+sbus_call_ifp_GetObjectsAttrs
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char ** arg_paths,
+     const char ** arg_attrs,
+     DBusMessage **_reply)
+{
+     return sbus_method_in_aoas_out_raw(mem_ctx, conn,
+          busname, object_path, "org.freedesktop.sssd.infopipe", "GetObjectsAttrs", arg_paths, arg_attrs,
+          _reply);
+}
+
 errno_t
 sbus_call_ifp_GetUserAttr
     (TALLOC_CTX *mem_ctx,
@@ -1035,6 +1228,23 @@ sbus_call_ifp_domain_RefreshAccessRules
           busname, object_path, "org.freedesktop.sssd.infopipe.Domains.Domain", "RefreshAccessRules");
 }
 
+errno_t
+sbus_call_ifp_domain_ServerTuning
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_service_name,
+     uint32_t* _arg_page_size,
+     uint32_t* _arg_pool_size,
+     uint32_t* _arg_page_msecs)
+{
+     return sbus_method_in_s_out_uuu(conn,
+          busname, object_path, "org.freedesktop.sssd.infopipe.Domains.Domain", "ServerTuning", arg_service_name,
+          _arg_page_size,
+          _arg_pool_size,
+          _arg_page_msecs);
+}
+
 errno_t
 sbus_call_ifp_groups_FindByID
     (TALLOC_CTX *mem_ctx,
@@ -1094,6 +1304,23 @@ sbus_call_ifp_groups_ListByName
           _arg_result);
 }
 
+errno_t
+sbus_call_ifp_groups_ListByNamePaged
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name_filter,
+     const char * arg_cursor,
+     uint32_t arg_page_size,
+     const char ** arg_attrs,
+     DBusMessage **_reply)
+{
+     return sbus_method_in_ssuas_out_raw(mem_ctx, conn,
+          busname, object_path, "org.freedesktop.sssd.infopipe.Groups", "ListByNamePaged", arg_name_filter, arg_cursor, arg_page_size, arg_attrs,
+          _reply);
+}
+
 errno_t
 sbus_call_ifp_group_UpdateMemberList
     (struct sbus_sync_connection *conn,
@@ -1207,6 +1434,23 @@ sbus_call_ifp_users_ListByName
           _arg_result);
 }
 
+errno_t
+sbus_call_ifp_users_ListByNamePaged
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name_filter,
+     const char * arg_cursor,
+     uint32_t arg_page_size,
+     const char ** arg_attrs,
+     DBusMessage **_reply)
+{
+     return sbus_method_in_ssuas_out_raw(mem_ctx, conn,
+          busname, object_path, "org.freedesktop.sssd.infopipe.Users", "ListByNamePaged", arg_name_filter, arg_cursor, arg_page_size, arg_attrs,
+          _reply);
+}
+
 errno_t
 sbus_call_ifp_user_UpdateGroupsList
     (struct sbus_sync_connection *conn,
@@ -1217,6 +1461,46 @@ sbus_call_ifp_user_UpdateGroupsList
           busname, object_path, "org.freedesktop.sssd.infopipe.Users.User", "UpdateGroupsList");
 }
 
+static void
+sbus_emit_signal_oao
+    (struct sbus_sync_connection *conn,
+     const char *path,
+     const char *iface,
+     const char *signal_name,
+     const char * arg0,
+     const char ** arg1)
+{
+    struct _sbus_ifp_invoker_args_oao args;
+
+    args.arg0 = arg0;
+    args.arg1 = arg1;
+
+    sbus_sync_call_signal(conn, NULL, (sbus_invoker_writer_fn)_sbus_ifp_invoker_write_oao,
+                          path, iface, signal_name, &args);
+}
+
+void
+sbus_sync_emit_ifp_groups_GroupsChanged
+    (struct sbus_sync_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_groups)
+{
+    sbus_emit_signal_oao(conn, object_path,
+        "org.freedesktop.sssd.infopipe.Groups", "GroupsChanged", arg_domain, arg_groups);
+}
+
+void
+sbus_sync_emit_ifp_users_UsersChanged
+    (struct sbus_sync_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_users)
+{
+    sbus_emit_signal_oao(conn, object_path,
+        "org.freedesktop.sssd.infopipe.Users", "UsersChanged", arg_domain, arg_users);
+}
+
 static errno_t
 sbus_get_ao
     (TALLOC_CTX *mem_ctx,
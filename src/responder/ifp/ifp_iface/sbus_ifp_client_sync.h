@@ -63,6 +63,16 @@ sbus_call_ifp_FindResponderByName
      const char * arg_name,
      const char ** _arg_responder);
 
+errno_t
+sbus_call_ifp_GetObjectsAttrs
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char ** arg_paths,
+     const char ** arg_attrs,
+     DBusMessage **_reply);
+
 errno_t
 sbus_call_ifp_GetUserAttr
     (TALLOC_CTX *mem_ctx,
@@ -193,6 +203,16 @@ sbus_call_ifp_domain_RefreshAccessRules
      const char *busname,
      const char *object_path);
 
+errno_t
+sbus_call_ifp_domain_ServerTuning
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_service_name,
+     uint32_t* _arg_page_size,
+     uint32_t* _arg_pool_size,
+     uint32_t* _arg_page_msecs);
+
 errno_t
 sbus_call_ifp_groups_FindByID
     (TALLOC_CTX *mem_ctx,
@@ -232,6 +252,18 @@ sbus_call_ifp_groups_ListByName
      uint32_t arg_limit,
      const char *** _arg_result);
 
+errno_t
+sbus_call_ifp_groups_ListByNamePaged
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name_filter,
+     const char * arg_cursor,
+     uint32_t arg_page_size,
+     const char ** arg_attrs,
+     DBusMessage **_reply);
+
 errno_t
 sbus_call_ifp_group_UpdateMemberList
     (struct sbus_sync_connection *conn,
@@ -306,12 +338,38 @@ sbus_call_ifp_users_ListByName
      uint32_t arg_limit,
      const char *** _arg_result);
 
+errno_t
+sbus_call_ifp_users_ListByNamePaged
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name_filter,
+     const char * arg_cursor,
+     uint32_t arg_page_size,
+     const char ** arg_attrs,
+     DBusMessage **_reply);
+
 errno_t
 sbus_call_ifp_user_UpdateGroupsList
     (struct sbus_sync_connection *conn,
      const char *busname,
      const char *object_path);
 
+void
+sbus_sync_emit_ifp_groups_GroupsChanged
+    (struct sbus_sync_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_groups);
+
+void
+sbus_sync_emit_ifp_users_UsersChanged
+    (struct sbus_sync_connection *conn,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_users);
+
 errno_t
 sbus_get_ifp_components_debug_level
     (struct sbus_sync_connection *conn,
@@ -119,6 +119,28 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: org.freedesktop.sssd.infopipe.GetObjectsAttrs */
+#define SBUS_METHOD_SYNC_org_freedesktop_sssd_infopipe_GetObjectsAttrs(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char **, const char **, DBusMessageIter *); \
+    sbus_method_sync("GetObjectsAttrs", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_GetObjectsAttrs, \
+        NULL, \
+        _sbus_ifp_invoke_in_aoas_out_raw_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_org_freedesktop_sssd_infopipe_GetObjectsAttrs(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char **, const char **, DBusMessageIter *); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("GetObjectsAttrs", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_GetObjectsAttrs, \
+        NULL, \
+        _sbus_ifp_invoke_in_aoas_out_raw_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Method: org.freedesktop.sssd.infopipe.GetUserAttr */
 #define SBUS_METHOD_SYNC_org_freedesktop_sssd_infopipe_GetUserAttr(handler, data) ({ \
     SBUS_CHECK_SYNC((handler), (data), const char *, const char **, DBusMessageIter *); \
@@ -1166,6 +1188,28 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: org.freedesktop.sssd.infopipe.Domains.Domain.ServerTuning */
+#define SBUS_METHOD_SYNC_org_freedesktop_sssd_infopipe_Domains_Domain_ServerTuning(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, uint32_t*, uint32_t*, uint32_t*); \
+    sbus_method_sync("ServerTuning", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_Domains_Domain_ServerTuning, \
+        NULL, \
+        _sbus_ifp_invoke_in_s_out_uuu_send, \
+        _sbus_ifp_key_s_0, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_org_freedesktop_sssd_infopipe_Domains_Domain_ServerTuning(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *); \
+    SBUS_CHECK_RECV((handler_recv), uint32_t*, uint32_t*, uint32_t*); \
+    sbus_method_async("ServerTuning", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_Domains_Domain_ServerTuning, \
+        NULL, \
+        _sbus_ifp_invoke_in_s_out_uuu_send, \
+        _sbus_ifp_key_s_0, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: org.freedesktop.sssd.infopipe.Groups */
 #define SBUS_IFACE_org_freedesktop_sssd_infopipe_Groups(methods, signals, properties) ({ \
     sbus_interface("org.freedesktop.sssd.infopipe.Groups", NULL, \
@@ -1260,6 +1304,52 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: org.freedesktop.sssd.infopipe.Groups.ListByNamePaged */
+#define SBUS_METHOD_SYNC_org_freedesktop_sssd_infopipe_Groups_ListByNamePaged(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, const char *, uint32_t, const char **, DBusMessageIter *); \
+    sbus_method_sync("ListByNamePaged", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_ListByNamePaged, \
+        NULL, \
+        _sbus_ifp_invoke_in_ssuas_out_raw_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_org_freedesktop_sssd_infopipe_Groups_ListByNamePaged(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *, const char *, uint32_t, const char **, DBusMessageIter *); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("ListByNamePaged", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_ListByNamePaged, \
+        NULL, \
+        _sbus_ifp_invoke_in_ssuas_out_raw_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Signal: org.freedesktop.sssd.infopipe.Groups.GroupsChanged */
+#define SBUS_SIGNAL_EMITS_org_freedesktop_sssd_infopipe_Groups_GroupsChanged() ({ \
+    sbus_signal("GroupsChanged", \
+        _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_GroupsChanged, \
+        NULL); \
+})
+
+#define SBUS_SIGNAL_SYNC_org_freedesktop_sssd_infopipe_Groups_GroupsChanged(path, handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, const char **); \
+    sbus_listener_sync("org.freedesktop.sssd.infopipe.Groups", "GroupsChanged", (path), \
+        _sbus_ifp_invoke_in_oao_out__send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_SIGNAL_ASYNC_org_freedesktop_sssd_infopipe_Groups_GroupsChanged(path, handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *, const char **); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_listener_async("org.freedesktop.sssd.infopipe.Groups", "GroupsChanged", (path), \
+        _sbus_ifp_invoke_in_oao_out__send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: org.freedesktop.sssd.infopipe.Groups.Group */
 #define SBUS_IFACE_org_freedesktop_sssd_infopipe_Groups_Group(methods, signals, properties) ({ \
     sbus_interface("org.freedesktop.sssd.infopipe.Groups.Group", NULL, \
@@ -1623,6 +1713,52 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: org.freedesktop.sssd.infopipe.Users.ListByNamePaged */
+#define SBUS_METHOD_SYNC_org_freedesktop_sssd_infopipe_Users_ListByNamePaged(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, const char *, uint32_t, const char **, DBusMessageIter *); \
+    sbus_method_sync("ListByNamePaged", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_ListByNamePaged, \
+        NULL, \
+        _sbus_ifp_invoke_in_ssuas_out_raw_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_org_freedesktop_sssd_infopipe_Users_ListByNamePaged(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *, const char *, uint32_t, const char **, DBusMessageIter *); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("ListByNamePaged", \
+        &_sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_ListByNamePaged, \
+        NULL, \
+        _sbus_ifp_invoke_in_ssuas_out_raw_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Signal: org.freedesktop.sssd.infopipe.Users.UsersChanged */
+#define SBUS_SIGNAL_EMITS_org_freedesktop_sssd_infopipe_Users_UsersChanged() ({ \
+    sbus_signal("UsersChanged", \
+        _sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_UsersChanged, \
+        NULL); \
+})
+
+#define SBUS_SIGNAL_SYNC_org_freedesktop_sssd_infopipe_Users_UsersChanged(path, handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, const char **); \
+    sbus_listener_sync("org.freedesktop.sssd.infopipe.Users", "UsersChanged", (path), \
+        _sbus_ifp_invoke_in_oao_out__send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_SIGNAL_ASYNC_org_freedesktop_sssd_infopipe_Users_UsersChanged(path, handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *, const char **); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_listener_async("org.freedesktop.sssd.infopipe.Users", "UsersChanged", (path), \
+        _sbus_ifp_invoke_in_oao_out__send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: org.freedesktop.sssd.infopipe.Users.User */
 #define SBUS_IFACE_org_freedesktop_sssd_infopipe_Users_User(methods, signals, properties) ({ \
     sbus_interface("org.freedesktop.sssd.infopipe.Users.User", NULL, \
@@ -1382,6 +1382,352 @@ static void _sbus_ifp_invoke_in__out_u_done(struct tevent_req *subreq)
     return;
 }
 
+struct _sbus_ifp_invoke_in_aoas_out_raw_state {
+    struct _sbus_ifp_invoker_args_aoas *in;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char **, const char **, DBusMessageIter *);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char **, const char **, DBusMessageIter *);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_ifp_invoke_in_aoas_out_raw_step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_ifp_invoke_in_aoas_out_raw_done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_ifp_invoke_in_aoas_out_raw_send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_ifp_invoke_in_aoas_out_raw_state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_aoas_out_raw_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_ifp_invoker_args_aoas);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_ifp_invoker_read_aoas(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_aoas_out_raw_step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_ifp_invoke_in_aoas_out_raw_step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_ifp_invoke_in_aoas_out_raw_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_aoas_out_raw_state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->write_iterator);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->write_iterator);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_aoas_out_raw_done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_ifp_invoke_in_aoas_out_raw_done(struct tevent_req *subreq)
+{
+    struct _sbus_ifp_invoke_in_aoas_out_raw_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_aoas_out_raw_state);
+
+    ret = state->handler.recv(state, subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+struct _sbus_ifp_invoke_in_oao_out__state {
+    struct _sbus_ifp_invoker_args_oao *in;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char **);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *, const char **);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_ifp_invoke_in_oao_out__step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_ifp_invoke_in_oao_out__done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_ifp_invoke_in_oao_out__send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_ifp_invoke_in_oao_out__state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_oao_out__state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_ifp_invoker_args_oao);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_ifp_invoker_read_oao(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_oao_out__step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_ifp_invoke_in_oao_out__step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_ifp_invoke_in_oao_out__state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_oao_out__state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_oao_out__done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_ifp_invoke_in_oao_out__done(struct tevent_req *subreq)
+{
+    struct _sbus_ifp_invoke_in_oao_out__state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_oao_out__state);
+
+    ret = state->handler.recv(state, subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
 struct _sbus_ifp_invoke_in_s_out_ao_state {
     struct _sbus_ifp_invoker_args_s *in;
     struct _sbus_ifp_invoker_args_ao out;
@@ -1522,7 +1868,188 @@ static void _sbus_ifp_invoke_in_s_out_ao_step
             goto done;
         }
 
-        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_ao_done, req);
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_ao_done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_ifp_invoke_in_s_out_ao_done(struct tevent_req *subreq)
+{
+    struct _sbus_ifp_invoke_in_s_out_ao_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_ao_state);
+
+    ret = state->handler.recv(state, subreq, &state->out.arg0);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = _sbus_ifp_invoker_write_ao(state->write_iterator, &state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+struct _sbus_ifp_invoke_in_s_out_as_state {
+    struct _sbus_ifp_invoker_args_s *in;
+    struct _sbus_ifp_invoker_args_as out;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char ***);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *, const char ***);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_ifp_invoke_in_s_out_as_step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_ifp_invoke_in_s_out_as_done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_ifp_invoke_in_s_out_as_send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_ifp_invoke_in_s_out_as_state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_s_out_as_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_ifp_invoker_args_s);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_ifp_invoker_read_s(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_s_out_as_step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_ifp_invoke_in_s_out_as_step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_ifp_invoke_in_s_out_as_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_as_state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, &state->out.arg0);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = _sbus_ifp_invoker_write_as(state->write_iterator, &state->out);
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_as_done, req);
         ret = EAGAIN;
         goto done;
     }
@@ -1537,14 +2064,14 @@ done:
     }
 }
 
-static void _sbus_ifp_invoke_in_s_out_ao_done(struct tevent_req *subreq)
+static void _sbus_ifp_invoke_in_s_out_as_done(struct tevent_req *subreq)
 {
-    struct _sbus_ifp_invoke_in_s_out_ao_state *state;
+    struct _sbus_ifp_invoke_in_s_out_as_state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_ao_state);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_as_state);
 
     ret = state->handler.recv(state, subreq, &state->out.arg0);
     talloc_zfree(subreq);
@@ -1553,7 +2080,7 @@ static void _sbus_ifp_invoke_in_s_out_ao_done(struct tevent_req *subreq)
         return;
     }
 
-    ret = _sbus_ifp_invoker_write_ao(state->write_iterator, &state->out);
+    ret = _sbus_ifp_invoker_write_as(state->write_iterator, &state->out);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
@@ -1563,15 +2090,15 @@ static void _sbus_ifp_invoke_in_s_out_ao_done(struct tevent_req *subreq)
     return;
 }
 
-struct _sbus_ifp_invoke_in_s_out_as_state {
+struct _sbus_ifp_invoke_in_s_out_o_state {
     struct _sbus_ifp_invoker_args_s *in;
-    struct _sbus_ifp_invoker_args_as out;
+    struct _sbus_ifp_invoker_args_o out;
     struct {
         enum sbus_handler_type type;
         void *data;
-        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char ***);
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char **);
         struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *);
-        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *, const char ***);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *, const char **);
     } handler;
 
     struct sbus_request *sbus_req;
@@ -1580,18 +2107,18 @@ struct _sbus_ifp_invoke_in_s_out_as_state {
 };
 
 static void
-_sbus_ifp_invoke_in_s_out_as_step
+_sbus_ifp_invoke_in_s_out_o_step
     (struct tevent_context *ev,
      struct tevent_timer *te,
      struct timeval tv,
      void *private_data);
 
 static void
-_sbus_ifp_invoke_in_s_out_as_done
+_sbus_ifp_invoke_in_s_out_o_done
    (struct tevent_req *subreq);
 
 struct tevent_req *
-_sbus_ifp_invoke_in_s_out_as_send
+_sbus_ifp_invoke_in_s_out_o_send
    (TALLOC_CTX *mem_ctx,
     struct tevent_context *ev,
     struct sbus_request *sbus_req,
@@ -1601,12 +2128,12 @@ _sbus_ifp_invoke_in_s_out_as_send
     DBusMessageIter *write_iterator,
     const char **_key)
 {
-    struct _sbus_ifp_invoke_in_s_out_as_state *state;
+    struct _sbus_ifp_invoke_in_s_out_o_state *state;
     struct tevent_req *req;
     const char *key;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_s_out_as_state);
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_s_out_o_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -1635,7 +2162,7 @@ _sbus_ifp_invoke_in_s_out_as_send
         goto done;
     }
 
-    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_s_out_as_step, req);
+    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_s_out_o_step, req);
     if (ret != EOK) {
         goto done;
     }
@@ -1660,19 +2187,19 @@ done:
     return req;
 }
 
-static void _sbus_ifp_invoke_in_s_out_as_step
+static void _sbus_ifp_invoke_in_s_out_o_step
    (struct tevent_context *ev,
     struct tevent_timer *te,
     struct timeval tv,
     void *private_data)
 {
-    struct _sbus_ifp_invoke_in_s_out_as_state *state;
+    struct _sbus_ifp_invoke_in_s_out_o_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
     req = talloc_get_type(private_data, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_as_state);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_o_state);
 
     switch (state->handler.type) {
     case SBUS_HANDLER_SYNC:
@@ -1687,7 +2214,7 @@ static void _sbus_ifp_invoke_in_s_out_as_step
             goto done;
         }
 
-        ret = _sbus_ifp_invoker_write_as(state->write_iterator, &state->out);
+        ret = _sbus_ifp_invoker_write_o(state->write_iterator, &state->out);
         goto done;
     case SBUS_HANDLER_ASYNC:
         if (state->handler.send == NULL || state->handler.recv == NULL) {
@@ -1703,7 +2230,7 @@ static void _sbus_ifp_invoke_in_s_out_as_step
             goto done;
         }
 
-        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_as_done, req);
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_o_done, req);
         ret = EAGAIN;
         goto done;
     }
@@ -1718,14 +2245,14 @@ done:
     }
 }
 
-static void _sbus_ifp_invoke_in_s_out_as_done(struct tevent_req *subreq)
+static void _sbus_ifp_invoke_in_s_out_o_done(struct tevent_req *subreq)
 {
-    struct _sbus_ifp_invoke_in_s_out_as_state *state;
+    struct _sbus_ifp_invoke_in_s_out_o_state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_as_state);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_o_state);
 
     ret = state->handler.recv(state, subreq, &state->out.arg0);
     talloc_zfree(subreq);
@@ -1734,7 +2261,7 @@ static void _sbus_ifp_invoke_in_s_out_as_done(struct tevent_req *subreq)
         return;
     }
 
-    ret = _sbus_ifp_invoker_write_as(state->write_iterator, &state->out);
+    ret = _sbus_ifp_invoker_write_o(state->write_iterator, &state->out);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
@@ -1744,9 +2271,9 @@ static void _sbus_ifp_invoke_in_s_out_as_done(struct tevent_req *subreq)
     return;
 }
 
-struct _sbus_ifp_invoke_in_s_out_o_state {
+struct _sbus_ifp_invoke_in_s_out_s_state {
     struct _sbus_ifp_invoker_args_s *in;
-    struct _sbus_ifp_invoker_args_o out;
+    struct _sbus_ifp_invoker_args_s out;
     struct {
         enum sbus_handler_type type;
         void *data;
@@ -1761,18 +2288,18 @@ struct _sbus_ifp_invoke_in_s_out_o_state {
 };
 
 static void
-_sbus_ifp_invoke_in_s_out_o_step
+_sbus_ifp_invoke_in_s_out_s_step
     (struct tevent_context *ev,
      struct tevent_timer *te,
      struct timeval tv,
      void *private_data);
 
 static void
-_sbus_ifp_invoke_in_s_out_o_done
+_sbus_ifp_invoke_in_s_out_s_done
    (struct tevent_req *subreq);
 
 struct tevent_req *
-_sbus_ifp_invoke_in_s_out_o_send
+_sbus_ifp_invoke_in_s_out_s_send
    (TALLOC_CTX *mem_ctx,
     struct tevent_context *ev,
     struct sbus_request *sbus_req,
@@ -1782,12 +2309,12 @@ _sbus_ifp_invoke_in_s_out_o_send
     DBusMessageIter *write_iterator,
     const char **_key)
 {
-    struct _sbus_ifp_invoke_in_s_out_o_state *state;
+    struct _sbus_ifp_invoke_in_s_out_s_state *state;
     struct tevent_req *req;
     const char *key;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_s_out_o_state);
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_s_out_s_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -1816,7 +2343,7 @@ _sbus_ifp_invoke_in_s_out_o_send
         goto done;
     }
 
-    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_s_out_o_step, req);
+    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_s_out_s_step, req);
     if (ret != EOK) {
         goto done;
     }
@@ -1841,19 +2368,19 @@ done:
     return req;
 }
 
-static void _sbus_ifp_invoke_in_s_out_o_step
+static void _sbus_ifp_invoke_in_s_out_s_step
    (struct tevent_context *ev,
     struct tevent_timer *te,
     struct timeval tv,
     void *private_data)
 {
-    struct _sbus_ifp_invoke_in_s_out_o_state *state;
+    struct _sbus_ifp_invoke_in_s_out_s_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
     req = talloc_get_type(private_data, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_o_state);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_s_state);
 
     switch (state->handler.type) {
     case SBUS_HANDLER_SYNC:
@@ -1868,7 +2395,7 @@ static void _sbus_ifp_invoke_in_s_out_o_step
             goto done;
         }
 
-        ret = _sbus_ifp_invoker_write_o(state->write_iterator, &state->out);
+        ret = _sbus_ifp_invoker_write_s(state->write_iterator, &state->out);
         goto done;
     case SBUS_HANDLER_ASYNC:
         if (state->handler.send == NULL || state->handler.recv == NULL) {
@@ -1884,7 +2411,7 @@ static void _sbus_ifp_invoke_in_s_out_o_step
             goto done;
         }
 
-        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_o_done, req);
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_s_done, req);
         ret = EAGAIN;
         goto done;
     }
@@ -1899,14 +2426,14 @@ done:
     }
 }
 
-static void _sbus_ifp_invoke_in_s_out_o_done(struct tevent_req *subreq)
+static void _sbus_ifp_invoke_in_s_out_s_done(struct tevent_req *subreq)
 {
-    struct _sbus_ifp_invoke_in_s_out_o_state *state;
+    struct _sbus_ifp_invoke_in_s_out_s_state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_o_state);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_s_state);
 
     ret = state->handler.recv(state, subreq, &state->out.arg0);
     talloc_zfree(subreq);
@@ -1915,7 +2442,7 @@ static void _sbus_ifp_invoke_in_s_out_o_done(struct tevent_req *subreq)
         return;
     }
 
-    ret = _sbus_ifp_invoker_write_o(state->write_iterator, &state->out);
+    ret = _sbus_ifp_invoker_write_s(state->write_iterator, &state->out);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
@@ -1925,15 +2452,15 @@ static void _sbus_ifp_invoke_in_s_out_o_done(struct tevent_req *subreq)
     return;
 }
 
-struct _sbus_ifp_invoke_in_s_out_s_state {
+struct _sbus_ifp_invoke_in_s_out_uuu_state {
     struct _sbus_ifp_invoker_args_s *in;
-    struct _sbus_ifp_invoker_args_s out;
+    struct _sbus_ifp_invoker_args_uuu out;
     struct {
         enum sbus_handler_type type;
         void *data;
-        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char **);
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, uint32_t*, uint32_t*, uint32_t*);
         struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *);
-        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *, const char **);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *, uint32_t*, uint32_t*, uint32_t*);
     } handler;
 
     struct sbus_request *sbus_req;
@@ -1942,18 +2469,18 @@ struct _sbus_ifp_invoke_in_s_out_s_state {
 };
 
 static void
-_sbus_ifp_invoke_in_s_out_s_step
+_sbus_ifp_invoke_in_s_out_uuu_step
     (struct tevent_context *ev,
      struct tevent_timer *te,
      struct timeval tv,
      void *private_data);
 
 static void
-_sbus_ifp_invoke_in_s_out_s_done
+_sbus_ifp_invoke_in_s_out_uuu_done
    (struct tevent_req *subreq);
 
 struct tevent_req *
-_sbus_ifp_invoke_in_s_out_s_send
+_sbus_ifp_invoke_in_s_out_uuu_send
    (TALLOC_CTX *mem_ctx,
     struct tevent_context *ev,
     struct sbus_request *sbus_req,
@@ -1963,12 +2490,12 @@ _sbus_ifp_invoke_in_s_out_s_send
     DBusMessageIter *write_iterator,
     const char **_key)
 {
-    struct _sbus_ifp_invoke_in_s_out_s_state *state;
+    struct _sbus_ifp_invoke_in_s_out_uuu_state *state;
     struct tevent_req *req;
     const char *key;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_s_out_s_state);
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_s_out_uuu_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -1997,7 +2524,7 @@ _sbus_ifp_invoke_in_s_out_s_send
         goto done;
     }
 
-    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_s_out_s_step, req);
+    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_s_out_uuu_step, req);
     if (ret != EOK) {
         goto done;
     }
@@ -2022,19 +2549,19 @@ done:
     return req;
 }
 
-static void _sbus_ifp_invoke_in_s_out_s_step
+static void _sbus_ifp_invoke_in_s_out_uuu_step
    (struct tevent_context *ev,
     struct tevent_timer *te,
     struct timeval tv,
     void *private_data)
 {
-    struct _sbus_ifp_invoke_in_s_out_s_state *state;
+    struct _sbus_ifp_invoke_in_s_out_uuu_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
     req = talloc_get_type(private_data, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_s_state);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_uuu_state);
 
     switch (state->handler.type) {
     case SBUS_HANDLER_SYNC:
@@ -2044,12 +2571,12 @@ static void _sbus_ifp_invoke_in_s_out_s_step
             goto done;
         }
 
-        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, &state->out.arg0);
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, &state->out.arg0, &state->out.arg1, &state->out.arg2);
         if (ret != EOK) {
             goto done;
         }
 
-        ret = _sbus_ifp_invoker_write_s(state->write_iterator, &state->out);
+        ret = _sbus_ifp_invoker_write_uuu(state->write_iterator, &state->out);
         goto done;
     case SBUS_HANDLER_ASYNC:
         if (state->handler.send == NULL || state->handler.recv == NULL) {
@@ -2065,7 +2592,7 @@ static void _sbus_ifp_invoke_in_s_out_s_step
             goto done;
         }
 
-        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_s_done, req);
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_s_out_uuu_done, req);
         ret = EAGAIN;
         goto done;
     }
@@ -2080,23 +2607,23 @@ done:
     }
 }
 
-static void _sbus_ifp_invoke_in_s_out_s_done(struct tevent_req *subreq)
+static void _sbus_ifp_invoke_in_s_out_uuu_done(struct tevent_req *subreq)
 {
-    struct _sbus_ifp_invoke_in_s_out_s_state *state;
+    struct _sbus_ifp_invoke_in_s_out_uuu_state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_s_state);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_s_out_uuu_state);
 
-    ret = state->handler.recv(state, subreq, &state->out.arg0);
+    ret = state->handler.recv(state, subreq, &state->out.arg0, &state->out.arg1, &state->out.arg2);
     talloc_zfree(subreq);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
     }
 
-    ret = _sbus_ifp_invoker_write_s(state->write_iterator, &state->out);
+    ret = _sbus_ifp_invoker_write_uuu(state->write_iterator, &state->out);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
@@ -2641,6 +3168,179 @@ static void _sbus_ifp_invoke_in_ssu_out_ao_done(struct tevent_req *subreq)
     return;
 }
 
+struct _sbus_ifp_invoke_in_ssuas_out_raw_state {
+    struct _sbus_ifp_invoker_args_ssuas *in;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char *, uint32_t, const char **, DBusMessageIter *);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *, const char *, uint32_t, const char **, DBusMessageIter *);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_ifp_invoke_in_ssuas_out_raw_step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_ifp_invoke_in_ssuas_out_raw_done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_ifp_invoke_in_ssuas_out_raw_send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_ifp_invoke_in_ssuas_out_raw_state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_ifp_invoke_in_ssuas_out_raw_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_ifp_invoker_args_ssuas);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_ifp_invoker_read_ssuas(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_ifp_invoke_in_ssuas_out_raw_step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_ifp_invoke_in_ssuas_out_raw_step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_ifp_invoke_in_ssuas_out_raw_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_ssuas_out_raw_state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->in->arg2, state->in->arg3, state->write_iterator);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->in->arg2, state->in->arg3, state->write_iterator);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_ifp_invoke_in_ssuas_out_raw_done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_ifp_invoke_in_ssuas_out_raw_done(struct tevent_req *subreq)
+{
+    struct _sbus_ifp_invoke_in_ssuas_out_raw_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_ifp_invoke_in_ssuas_out_raw_state);
+
+    ret = state->handler.recv(state, subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
 struct _sbus_ifp_invoke_in_su_out_ao_state {
     struct _sbus_ifp_invoker_args_su *in;
     struct _sbus_ifp_invoker_args_ao out;
@@ -47,13 +47,17 @@ _sbus_ifp_declare_invoker(, ifp_extra);
 _sbus_ifp_declare_invoker(, o);
 _sbus_ifp_declare_invoker(, s);
 _sbus_ifp_declare_invoker(, u);
+_sbus_ifp_declare_invoker(aoas, raw);
+_sbus_ifp_declare_invoker(oao, );
 _sbus_ifp_declare_invoker(s, ao);
 _sbus_ifp_declare_invoker(s, as);
 _sbus_ifp_declare_invoker(s, o);
 _sbus_ifp_declare_invoker(s, s);
+_sbus_ifp_declare_invoker(s, uuu);
 _sbus_ifp_declare_invoker(sas, raw);
 _sbus_ifp_declare_invoker(ss, o);
 _sbus_ifp_declare_invoker(ssu, ao);
+_sbus_ifp_declare_invoker(ssuas, raw);
 _sbus_ifp_declare_invoker(su, ao);
 _sbus_ifp_declare_invoker(u, o);
 
@@ -67,6 +67,19 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_FindResponderByName = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_GetObjectsAttrs = {
+    .input = (const struct sbus_argument[]){
+        {.type = "ao", .name = "paths"},
+        {.type = "as", .name = "attrs"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "a{oa{sv}}", .name = "result"},
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_GetUserAttr = {
     .input = (const struct sbus_argument[]){
@@ -249,6 +262,20 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_Domains_Domain_RefreshAccessRules =
     }
 };
 
+const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Domains_Domain_ServerTuning = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "service_name"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "u", .name = "page_size"},
+        {.type = "u", .name = "pool_size"},
+        {.type = "u", .name = "page_msecs"},
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_FindByID = {
     .input = (const struct sbus_argument[]){
@@ -300,6 +327,29 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_ListByName = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_ListByNamePaged = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "name_filter"},
+        {.type = "s", .name = "cursor"},
+        {.type = "u", .name = "page_size"},
+        {.type = "as", .name = "attrs"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "s", .name = "next_cursor"},
+        {.type = "a{oa{sv}}", .name = "result"},
+        {NULL}
+    }
+};
+
+const struct sbus_argument
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_GroupsChanged[] = {
+    {.type = "o", .name = "domain"},
+    {.type = "ao", .name = "groups"},
+    {NULL}
+};
+
 const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_Group_UpdateMemberList = {
     .input = (const struct sbus_argument[]){
@@ -399,6 +449,29 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_ListByName = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_ListByNamePaged = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "name_filter"},
+        {.type = "s", .name = "cursor"},
+        {.type = "u", .name = "page_size"},
+        {.type = "as", .name = "attrs"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "s", .name = "next_cursor"},
+        {.type = "a{oa{sv}}", .name = "result"},
+        {NULL}
+    }
+};
+
+const struct sbus_argument
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_UsersChanged[] = {
+    {.type = "o", .name = "domain"},
+    {.type = "ao", .name = "users"},
+    {NULL}
+};
+
 const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_User_UpdateGroupsList = {
     .input = (const struct sbus_argument[]){
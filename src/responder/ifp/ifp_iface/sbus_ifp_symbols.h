@@ -34,6 +34,9 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_FindMonitor;
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_FindResponderByName;
 
+extern const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_GetObjectsAttrs;
+
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_GetUserAttr;
 
@@ -82,6 +85,9 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_Domains_Domain_ListServices;
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Domains_Domain_RefreshAccessRules;
 
+extern const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Domains_Domain_ServerTuning;
+
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_FindByID;
 
@@ -94,6 +100,12 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_ListByDomainAndName;
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_ListByName;
 
+extern const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_ListByNamePaged;
+
+extern const struct sbus_argument
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_GroupsChanged[];
+
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Groups_Group_UpdateMemberList;
 
@@ -118,6 +130,12 @@ _sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_ListByDomainAndName;
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_ListByName;
 
+extern const struct sbus_method_arguments
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_ListByNamePaged;
+
+extern const struct sbus_argument
+_sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_UsersChanged[];
+
 extern const struct sbus_method_arguments
 _sbus_ifp_args_org_freedesktop_sssd_infopipe_Users_User_UpdateGroupsList;
 
@@ -31,6 +31,7 @@
 
 #include "util/util.h"
 #include "confdb/confdb.h"
+#include "db/sysdb.h"
 #include "responder/common/responder.h"
 #include "responder/common/negcache.h"
 #include "responder/ifp/ifp_iface/ifp_iface_async.h"
@@ -54,6 +55,10 @@ errno_t ifp_register_sbus_interface(struct sbus_connection *conn,
 errno_t
 ifp_register_nodes(struct ifp_ctx *ctx, struct sbus_connection *conn);
 
+errno_t
+ifp_register_backend_iface(struct sbus_connection *conn,
+                           struct ifp_ctx *ifp_ctx);
+
 errno_t
 ifp_ping(TALLOC_CTX *mem_ctx,
          struct sbus_request *sbus_req,
@@ -85,6 +90,18 @@ ifp_user_get_groups_recv(TALLOC_CTX *mem_ctx,
                          struct tevent_req *req,
                          const char ***_groupnames);
 
+struct tevent_req *
+ifp_get_objects_attrs_send(TALLOC_CTX *mem_ctx,
+                           struct tevent_context *ev,
+                           struct sbus_request *sbus_req,
+                           struct ifp_ctx *ctx,
+                           const char **paths,
+                           const char **attrs,
+                           DBusMessageIter *write_iter);
+
+errno_t
+ifp_get_objects_attrs_recv(TALLOC_CTX *mem_ctx, struct tevent_req *req);
+
 /* == Utility functions == */
 
 errno_t ifp_add_value_to_dict(DBusMessageIter *iter_dict,
@@ -124,6 +141,48 @@ errno_t ifp_list_ctx_remaining_capacity(struct ifp_list_ctx *list_ctx,
                                         size_t entries,
                                         size_t *_capacity);
 
+/* Writes a dict entry that maps path to the attrs of msg as a{sv} */
+errno_t ifp_add_object_to_dict(DBusMessageIter *iter,
+                               struct resp_ctx *rctx,
+                               const char *path,
+                               struct sss_domain_info *dom,
+                               struct ldb_message *msg,
+                               const char **attrs);
+
+/* Filters req_attrs through whitelist. _search_attrs also contains the
+ * attributes needed to build the object path. */
+errno_t ifp_get_object_attrs(TALLOC_CTX *mem_ctx,
+                             const char **whitelist,
+                             const char **req_attrs,
+                             const char ***_attrs,
+                             const char ***_search_attrs);
+
+/* Used for paged list calls */
+typedef errno_t (*ifp_list_page_search_fn)(struct sss_domain_info *domain,
+                                           const char *sub_filter,
+                                           const char **attrs,
+                                           sysdb_stream_fn fn,
+                                           void *pvt);
+
+typedef char *(*ifp_list_page_path_fn)(TALLOC_CTX *mem_ctx,
+                                       struct sss_domain_info *domain,
+                                       struct ldb_message *msg);
+
+/* Writes the next_cursor and a{oa{sv}} arguments of a ListByNamePaged
+ * reply. Entries are read from the cache with search_fn and ordered by
+ * domain and then by name; cursor is the name of the last entry of the
+ * previous page and an empty next_cursor means that there are no more
+ * entries. Only the attributes in whitelist are returned. */
+errno_t ifp_list_page_write_reply(struct ifp_ctx *ctx,
+                                  ifp_list_page_search_fn search_fn,
+                                  ifp_list_page_path_fn path_fn,
+                                  const char **whitelist,
+                                  const char *filter,
+                                  const char *cursor,
+                                  uint32_t page_size,
+                                  const char **req_attrs,
+                                  DBusMessageIter *iter);
+
 errno_t ifp_ldb_el_output_name(struct resp_ctx *rctx,
                                struct ldb_message *msg,
                                const char *el_name,
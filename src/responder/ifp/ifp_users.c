@@ -224,6 +224,8 @@ ifp_users_find_by_id_send(TALLOC_CTX *mem_ctx,
     struct ifp_users_find_by_id_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
+    /* Only the object path is returned */
+    const char *attrs[] = { SYSDB_UIDNUM, NULL };
     errno_t ret;
 
     req = tevent_req_create(mem_ctx, &state, struct ifp_users_find_by_id_state);
@@ -232,8 +234,9 @@ ifp_users_find_by_id_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    subreq = cache_req_user_by_id_send(state, ctx->rctx->ev, ctx->rctx,
-                                       ctx->rctx->ncache, 0, NULL, id);
+    subreq = cache_req_user_by_id_attrs_send(state, ctx->rctx->ev, ctx->rctx,
+                                             ctx->rctx->ncache, 0, NULL, id,
+                                             attrs);
     if (subreq == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
         ret = ENOMEM;
@@ -263,7 +266,7 @@ static void ifp_users_find_by_id_done(struct tevent_req *subreq)
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct ifp_users_find_by_id_state);
 
-    ret = cache_req_user_by_id_recv(state, subreq, &result);
+    ret = cache_req_user_by_id_attrs_recv(state, subreq, &result);
     talloc_zfree(subreq);
     if (ret != EOK) {
         DEBUG(SSSDBG_MINOR_FAILURE, "Unable to find user [%d]: %s\n",
@@ -1029,6 +1032,53 @@ ifp_users_list_by_domain_and_name_recv(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+struct tevent_req *
+ifp_users_list_by_name_paged_send(TALLOC_CTX *mem_ctx,
+                                  struct tevent_context *ev,
+                                  struct sbus_request *sbus_req,
+                                  struct ifp_ctx *ctx,
+                                  const char *filter,
+                                  const char *cursor,
+                                  uint32_t page_size,
+                                  const char **attrs,
+                                  DBusMessageIter *write_iter)
+{
+    struct tevent_req *req;
+    void *state;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, void *);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    /* Only the cache is searched so the whole page is built at once */
+    ret = ifp_list_page_write_reply(ctx, sysdb_search_users_stream,
+                                    ifp_users_build_path_from_msg,
+                                    ctx->user_whitelist, filter, cursor,
+                                    page_size, attrs, write_iter);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to list users [%d]: %s\n",
+              ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+    } else {
+        tevent_req_done(req);
+    }
+    tevent_req_post(req, ev);
+
+    return req;
+}
+
+errno_t
+ifp_users_list_by_name_paged_recv(TALLOC_CTX *mem_ctx,
+                                  struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
 static errno_t
 ifp_users_get_from_cache(TALLOC_CTX *mem_ctx,
                          struct sss_domain_info *domain,
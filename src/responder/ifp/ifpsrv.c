@@ -162,6 +162,7 @@ int ifp_process_init(TALLOC_CTX *mem_ctx,
     struct resp_ctx *rctx;
     struct sss_cmd_table *ifp_cmds;
     struct ifp_ctx *ifp_ctx;
+    struct be_conn *iter;
     int ret;
     char *uid_str;
     char *attr_list_str;
@@ -190,6 +191,13 @@ int ifp_process_init(TALLOC_CTX *mem_ctx,
     ifp_ctx->rctx = rctx;
     ifp_ctx->rctx->pvt_ctx = ifp_ctx;
 
+    for (iter = rctx->be_conns; iter; iter = iter->next) {
+        ret = ifp_register_backend_iface(iter->conn, ifp_ctx);
+        if (ret != EOK) {
+            goto fail;
+        }
+    }
+
     ret = sss_names_init_from_args(ifp_ctx,
                                    "(?P<name>[^@]+)@?(?P<domain>[^@]*$)",
                                    "%1$s@%2$s", &ifp_ctx->snctx);
@@ -21,8 +21,10 @@
 */
 
 #include "db/sysdb.h"
+#include "util/strtonum.h"
 
 #include "responder/ifp/ifp_private.h"
+#include "responder/ifp/ifp_groups.h"
 #include "responder/common/cache_req/cache_req.h"
 #include "responder/ifp/ifp_iface/ifp_iface_async.h"
 
@@ -602,6 +604,373 @@ ifp_user_get_groups_recv(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+/* Number of objects looked up by a single cache search */
+#define IFP_OBJECTS_BATCH_SIZE 100
+
+enum ifp_object_type {
+    IFP_OBJECT_USER,
+    IFP_OBJECT_GROUP
+};
+
+struct ifp_object_ref {
+    const char *path;
+    enum ifp_object_type type;
+    struct sss_domain_info *dom;
+    const char *key;
+
+    bool searched;
+    struct ldb_message *msg;
+};
+
+static errno_t
+ifp_object_ref_parse(TALLOC_CTX *mem_ctx,
+                     struct sss_domain_info *domains,
+                     const char *path,
+                     struct ifp_object_ref *ref)
+{
+    char **parts = NULL;
+    errno_t ret;
+
+    ref->path = path;
+
+    ret = sbus_opath_decompose_expected(NULL, path, IFP_PATH_USERS, 2, &parts);
+    if (ret == EOK) {
+        ref->type = IFP_OBJECT_USER;
+    } else {
+        ret = sbus_opath_decompose_expected(NULL, path, IFP_PATH_GROUPS, 2,
+                                            &parts);
+        if (ret != EOK) {
+            return ret;
+        }
+        ref->type = IFP_OBJECT_GROUP;
+    }
+
+    ref->dom = find_domain_by_name(domains, parts[0], false);
+    if (ref->dom == NULL) {
+        ret = ERR_DOMAIN_NOT_FOUND;
+        goto done;
+    }
+
+    if (ref->dom->type == DOM_TYPE_POSIX) {
+        strtouint32(parts[1], NULL, 10);
+        ret = errno;
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ref->key = talloc_steal(mem_ctx, parts[1]);
+    ret = EOK;
+
+done:
+    talloc_free(parts);
+    return ret;
+}
+
+static const char *
+ifp_object_ref_key_attr(struct ifp_object_ref *ref)
+{
+    if (ref->dom->type == DOM_TYPE_APPLICATION) {
+        return SYSDB_NAME;
+    }
+
+    return ref->type == IFP_OBJECT_USER ? SYSDB_UIDNUM : SYSDB_GIDNUM;
+}
+
+/* Domains with views have to go through the override aware lookups that
+ * the object properties use, one object at a time. */
+static errno_t
+ifp_object_ref_lookup_with_views(TALLOC_CTX *mem_ctx,
+                                 struct ifp_object_ref *ref)
+{
+    struct ldb_result *res = NULL;
+    uint32_t id;
+    errno_t ret;
+
+    id = strtouint32(ref->key, NULL, 10);
+
+    switch (ref->type) {
+    case IFP_OBJECT_USER:
+        if (ref->dom->type == DOM_TYPE_POSIX) {
+            ret = sysdb_getpwuid_with_views(mem_ctx, ref->dom, id, &res);
+        } else {
+            ret = sysdb_getpwnam_with_views(mem_ctx, ref->dom, ref->key, &res);
+        }
+        break;
+    case IFP_OBJECT_GROUP:
+        if (ref->dom->type == DOM_TYPE_POSIX) {
+            ret = sysdb_getgrgid_with_views(mem_ctx, ref->dom, id, &res);
+        } else {
+            ret = sysdb_getgrnam_with_views(mem_ctx, ref->dom, ref->key, &res);
+        }
+        break;
+    default:
+        ret = EINVAL;
+        break;
+    }
+
+    if (ret == EOK && res->count == 1) {
+        ref->msg = talloc_steal(mem_ctx, res->msgs[0]);
+    } else if (ret == ENOENT) {
+        ret = EOK;
+    }
+
+    talloc_free(res);
+    return ret;
+}
+
+/* Looks up refs[first] together with the following objects of the same
+ * type and domain with a single cache search. */
+static errno_t
+ifp_object_refs_lookup_batch(TALLOC_CTX *mem_ctx,
+                             struct ifp_object_ref *refs,
+                             size_t num_refs,
+                             size_t first,
+                             const char **attrs)
+{
+    struct ifp_object_ref *ref = &refs[first];
+    struct ifp_object_ref **batch;
+    struct ldb_message **msgs = NULL;
+    TALLOC_CTX *tmp_ctx;
+    const char *key_attr;
+    const char *value;
+    char *sanitized;
+    char *filter;
+    size_t num_batch = 0;
+    size_t count = 0;
+    size_t i;
+    size_t j;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    batch = talloc_array(tmp_ctx, struct ifp_object_ref *,
+                         IFP_OBJECTS_BATCH_SIZE);
+    filter = talloc_strdup(tmp_ctx, "(|");
+    if (batch == NULL || filter == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    key_attr = ifp_object_ref_key_attr(ref);
+    for (i = first; i < num_refs && num_batch < IFP_OBJECTS_BATCH_SIZE; i++) {
+        if (refs[i].searched || refs[i].dom != ref->dom
+                || refs[i].type != ref->type) {
+            continue;
+        }
+
+        ret = sss_filter_sanitize(tmp_ctx, refs[i].key, &sanitized);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        filter = talloc_asprintf_append(filter, "(%s=%s)", key_attr,
+                                        sanitized);
+        if (filter == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        refs[i].searched = true;
+        batch[num_batch++] = &refs[i];
+    }
+
+    filter = talloc_asprintf_append(filter, ")");
+    if (filter == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (ref->type == IFP_OBJECT_USER) {
+        ret = sysdb_search_users(tmp_ctx, ref->dom, filter, attrs,
+                                 &count, &msgs);
+    } else {
+        ret = sysdb_search_groups(tmp_ctx, ref->dom, filter, attrs,
+                                  &count, &msgs);
+    }
+    if (ret == ENOENT) {
+        ret = EOK;
+        goto done;
+    } else if (ret != EOK) {
+        goto done;
+    }
+
+    for (i = 0; i < count; i++) {
+        value = ldb_msg_find_attr_as_string(msgs[i], key_attr, NULL);
+        if (value == NULL) {
+            continue;
+        }
+
+        for (j = 0; j < num_batch; j++) {
+            if (batch[j]->msg == NULL && strcmp(batch[j]->key, value) == 0) {
+                batch[j]->msg = talloc_steal(mem_ctx, msgs[i]);
+                break;
+            }
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t
+ifp_get_objects_attrs_write_reply(TALLOC_CTX *mem_ctx,
+                                  struct ifp_ctx *ctx,
+                                  const char **paths,
+                                  const char **req_attrs,
+                                  DBusMessageIter *iter)
+{
+    static const char *group_whitelist[] = IFP_GROUPS_ALLOWED_ATTRS;
+    const char **search_attrs[2];
+    const char **attrs[2];
+    struct ifp_object_ref *refs;
+    DBusMessageIter iter_array;
+    dbus_bool_t dbret;
+    size_t num_paths;
+    size_t num_refs = 0;
+    size_t i;
+    errno_t ret;
+
+    ret = ifp_get_object_attrs(mem_ctx, ctx->user_whitelist, req_attrs,
+                               &attrs[IFP_OBJECT_USER],
+                               &search_attrs[IFP_OBJECT_USER]);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = ifp_get_object_attrs(mem_ctx, group_whitelist, req_attrs,
+                               &attrs[IFP_OBJECT_GROUP],
+                               &search_attrs[IFP_OBJECT_GROUP]);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (num_paths = 0; paths != NULL && paths[num_paths] != NULL;
+         num_paths++);
+
+    refs = talloc_zero_array(mem_ctx, struct ifp_object_ref, num_paths);
+    if (refs == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_paths; i++) {
+        ret = ifp_object_ref_parse(refs, ctx->rctx->domains, paths[i],
+                                   &refs[num_refs]);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Skipping invalid object path "
+                  "[%s] [%d]: %s\n", paths[i], ret, sss_strerror(ret));
+            continue;
+        }
+        num_refs++;
+    }
+
+    for (i = 0; i < num_refs; i++) {
+        if (refs[i].searched) {
+            continue;
+        }
+
+        if (DOM_HAS_VIEWS(refs[i].dom)) {
+            refs[i].searched = true;
+            ret = ifp_object_ref_lookup_with_views(refs, &refs[i]);
+        } else {
+            ret = ifp_object_refs_lookup_batch(refs, refs, num_refs, i,
+                                               search_attrs[refs[i].type]);
+        }
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to look up %s [%d]: %s\n",
+                  refs[i].path, ret, sss_strerror(ret));
+            return ret;
+        }
+    }
+
+    dbret = dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+                                      DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                      DBUS_TYPE_OBJECT_PATH_AS_STRING
+                                      DBUS_TYPE_ARRAY_AS_STRING
+                                      DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                      DBUS_TYPE_STRING_AS_STRING
+                                      DBUS_TYPE_VARIANT_AS_STRING
+                                      DBUS_DICT_ENTRY_END_CHAR_AS_STRING
+                                      DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+                                      &iter_array);
+    if (!dbret) {
+        return EIO;
+    }
+
+    /* Objects that are not cached are left out of the reply */
+    for (i = 0; i < num_refs; i++) {
+        if (refs[i].msg == NULL) {
+            continue;
+        }
+
+        ret = ifp_add_object_to_dict(&iter_array, ctx->rctx, refs[i].path,
+                                     refs[i].dom, refs[i].msg,
+                                     attrs[refs[i].type]);
+        if (ret != EOK) {
+            dbus_message_iter_abandon_container(iter, &iter_array);
+            return ret;
+        }
+    }
+
+    dbret = dbus_message_iter_close_container(iter, &iter_array);
+    if (!dbret) {
+        return EIO;
+    }
+
+    return EOK;
+}
+
+struct tevent_req *
+ifp_get_objects_attrs_send(TALLOC_CTX *mem_ctx,
+                           struct tevent_context *ev,
+                           struct sbus_request *sbus_req,
+                           struct ifp_ctx *ctx,
+                           const char **paths,
+                           const char **attrs,
+                           DBusMessageIter *write_iter)
+{
+    struct tevent_req *req;
+    void *state;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, void *);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    DEBUG(SSSDBG_FUNC_DATA, "Looking up attributes of multiple objects on "
+          "behalf of %"PRIi64"\n", sbus_req->sender->uid);
+
+    /* Like the object properties this is answered from the cache only */
+    ret = ifp_get_objects_attrs_write_reply(state, ctx, paths, attrs,
+                                            write_iter);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to construct reply [%d]: %s\n",
+              ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+    } else {
+        tevent_req_done(req);
+    }
+    tevent_req_post(req, ev);
+
+    return req;
+}
+
+errno_t
+ifp_get_objects_attrs_recv(TALLOC_CTX *mem_ctx, struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
 struct cli_protocol_version *register_cli_protocol_version(void)
 {
     static struct cli_protocol_version ssh_cli_protocol_version[] = {
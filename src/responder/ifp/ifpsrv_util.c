@@ -26,6 +26,9 @@
 #include "db/sysdb.h"
 #include "responder/ifp/ifp_private.h"
 
+#define IFP_LIST_PAGE_SIZE_DEFAULT 1000
+#define IFP_LIST_PAGE_ALLOC_MIN 64
+
 #define IFP_USER_DEFAULT_ATTRS {SYSDB_NAME, SYSDB_UIDNUM,   \
                                 SYSDB_GIDNUM, SYSDB_GECOS,  \
                                 SYSDB_HOMEDIR, SYSDB_SHELL, \
@@ -451,3 +454,454 @@ done:
     talloc_free(tmp_ctx);
     return ret_name;
 }
+
+errno_t ifp_add_object_to_dict(DBusMessageIter *iter,
+                               struct resp_ctx *rctx,
+                               const char *path,
+                               struct sss_domain_info *dom,
+                               struct ldb_message *msg,
+                               const char **attrs)
+{
+    struct ldb_message_element *el;
+    DBusMessageIter iter_entry;
+    DBusMessageIter iter_dict;
+    dbus_bool_t dbret;
+    errno_t ret;
+    int ai;
+
+    dbret = dbus_message_iter_open_container(iter, DBUS_TYPE_DICT_ENTRY,
+                                             NULL, &iter_entry);
+    if (!dbret) {
+        return EIO;
+    }
+
+    dbret = dbus_message_iter_append_basic(&iter_entry, DBUS_TYPE_OBJECT_PATH,
+                                           &path);
+    if (!dbret) {
+        dbus_message_iter_abandon_container(iter, &iter_entry);
+        return EIO;
+    }
+
+    dbret = dbus_message_iter_open_container(&iter_entry, DBUS_TYPE_ARRAY,
+                                      DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                      DBUS_TYPE_STRING_AS_STRING
+                                      DBUS_TYPE_VARIANT_AS_STRING
+                                      DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+                                      &iter_dict);
+    if (!dbret) {
+        dbus_message_iter_abandon_container(iter, &iter_entry);
+        return EIO;
+    }
+
+    ret = ifp_ldb_el_output_name(rctx, msg, SYSDB_NAME, dom);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Cannot convert SYSDB_NAME to output format [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    ret = ifp_ldb_el_output_name(rctx, msg, SYSDB_NAME_ALIAS,
+                                 dom);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Cannot convert SYSDB_NAME_ALIAS to output format [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    for (ai = 0; attrs[ai] != NULL; ai++) {
+        if (strcmp(attrs[ai], "domainname") == 0) {
+            ret = ifp_add_value_to_dict(&iter_dict, "domainname",
+                                        dom->name);
+            if (ret != EOK) {
+                goto fail;
+            }
+            continue;
+        }
+
+        el = sss_view_ldb_msg_find_element(dom, msg, attrs[ai]);
+        if (el == NULL || el->num_values == 0) {
+            continue;
+        }
+
+        ret = ifp_add_ldb_el_to_dict(&iter_dict, el);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot add attribute %s to message\n", attrs[ai]);
+            goto fail;
+        }
+    }
+
+    dbret = dbus_message_iter_close_container(&iter_entry, &iter_dict);
+    if (!dbret) {
+        dbus_message_iter_abandon_container(iter, &iter_entry);
+        return EIO;
+    }
+
+    dbret = dbus_message_iter_close_container(iter, &iter_entry);
+    if (!dbret) {
+        return EIO;
+    }
+
+    return EOK;
+
+fail:
+    dbus_message_iter_abandon_container(&iter_entry, &iter_dict);
+    dbus_message_iter_abandon_container(iter, &iter_entry);
+    return ret;
+}
+
+errno_t ifp_get_object_attrs(TALLOC_CTX *mem_ctx,
+                             const char **whitelist,
+                             const char **req_attrs,
+                             const char ***_attrs,
+                             const char ***_search_attrs)
+{
+    const char **attrs;
+    const char **search_attrs;
+    size_t num_attrs;
+    size_t na = 0;
+    size_t ns = 0;
+    size_t i;
+
+    for (num_attrs = 0; req_attrs != NULL && req_attrs[num_attrs] != NULL;
+         num_attrs++);
+
+    attrs = talloc_zero_array(mem_ctx, const char *, num_attrs + 1);
+    if (attrs == NULL) {
+        return ENOMEM;
+    }
+
+    search_attrs = talloc_zero_array(mem_ctx, const char *, num_attrs + 5);
+    if (search_attrs == NULL) {
+        talloc_free(attrs);
+        return ENOMEM;
+    }
+
+    /* Needed to build the object path and the output names */
+    search_attrs[ns++] = SYSDB_NAME;
+    search_attrs[ns++] = SYSDB_NAME_ALIAS;
+    search_attrs[ns++] = SYSDB_UIDNUM;
+    search_attrs[ns++] = SYSDB_GIDNUM;
+    for (i = 0; i < num_attrs; i++) {
+        if (strcmp(req_attrs[i], "domainname") != 0
+                && !ifp_attr_allowed(whitelist, req_attrs[i])) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Attribute %s is not allowed, skipping\n", req_attrs[i]);
+            continue;
+        }
+
+        attrs[na++] = req_attrs[i];
+        search_attrs[ns++] = req_attrs[i];
+    }
+
+    *_attrs = attrs;
+    *_search_attrs = search_attrs;
+    return EOK;
+}
+
+struct ifp_list_page_entry {
+    struct sss_domain_info *dom;
+    struct ldb_message *msg;
+    const char *name;
+};
+
+struct ifp_list_page {
+    struct sss_domain_info *dom;
+    const char *cursor;
+
+    /* Sorted by name, entries below @first belong to previous domains */
+    struct ifp_list_page_entry *entries;
+    size_t first;
+    size_t count;
+    size_t max;
+    /* entries grows up to max, the page size may be huge */
+    size_t allocated;
+
+    /* Set if an entry did not fit into the page */
+    bool more;
+};
+
+/* Keeps the page_size entries with the lowest names after the cursor, so
+ * only a page worth of messages is held in memory however large the
+ * domain is. */
+static errno_t ifp_list_page_add(struct ldb_message *msg, void *pvt)
+{
+    struct ifp_list_page *page = pvt;
+    struct ifp_list_page_entry *entries;
+    const char *name;
+    size_t allocated;
+    size_t lo;
+    size_t hi;
+    size_t mid;
+
+    name = ldb_msg_find_attr_as_string(msg, SYSDB_NAME, NULL);
+    if (name == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Entry %s has no name, skipping\n",
+              ldb_dn_get_linearized(msg->dn));
+        return EOK;
+    }
+
+    if (page->cursor != NULL && strcmp(name, page->cursor) <= 0) {
+        return EOK;
+    }
+
+    if (page->count == page->max) {
+        page->more = true;
+        if (strcmp(name, page->entries[page->count - 1].name) >= 0) {
+            return EOK;
+        }
+
+        page->count--;
+        talloc_free(page->entries[page->count].msg);
+    }
+
+    if (page->count == page->allocated) {
+        allocated = MIN(page->max, MAX(IFP_LIST_PAGE_ALLOC_MIN,
+                                       2 * page->allocated));
+        entries = talloc_realloc(page, page->entries,
+                                 struct ifp_list_page_entry, allocated);
+        if (entries == NULL) {
+            return ENOMEM;
+        }
+        page->entries = entries;
+        page->allocated = allocated;
+    }
+
+    lo = page->first;
+    hi = page->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (strcmp(page->entries[mid].name, name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    memmove(&page->entries[lo + 1], &page->entries[lo],
+            (page->count - lo) * sizeof(struct ifp_list_page_entry));
+    page->entries[lo].dom = page->dom;
+    page->entries[lo].msg = talloc_steal(page->entries, msg);
+    page->entries[lo].name = name;
+    page->count++;
+
+    return EOK;
+}
+
+static errno_t ifp_list_page_search(struct ifp_ctx *ctx,
+                                    ifp_list_page_search_fn search_fn,
+                                    struct ifp_list_page *page,
+                                    const char *filter,
+                                    const char **attrs)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char *name;
+    char *sanitized;
+    char *sub_filter;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    name = sss_get_cased_name(tmp_ctx, filter, page->dom->case_sensitive);
+    if (name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    name = sss_reverse_replace_space(tmp_ctx, name, ctx->rctx->override_space);
+    if (name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sss_filter_sanitize_ex(tmp_ctx, name, &sanitized, "*");
+    if (ret != EOK) {
+        goto done;
+    }
+
+    sub_filter = talloc_asprintf(tmp_ctx, "(%s=%s)", SYSDB_NAME, sanitized);
+    if (sub_filter == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = search_fn(page->dom, sub_filter, attrs, ifp_list_page_add, page);
+    if (ret == ENOENT) {
+        ret = EOK;
+    }
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t ifp_list_page_collect(struct ifp_ctx *ctx,
+                                     ifp_list_page_search_fn search_fn,
+                                     struct ifp_list_page *page,
+                                     const char *filter,
+                                     const char *cursor,
+                                     const char **attrs)
+{
+    char *domname;
+    errno_t ret;
+
+    page->dom = ctx->rctx->domains;
+    page->cursor = NULL;
+
+    if (cursor != NULL && cursor[0] != '\0') {
+        ret = sss_parse_internal_fqname(page, cursor, NULL, &domname);
+        if (ret != EOK || domname == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "Invalid cursor [%s]\n", cursor);
+            return EINVAL;
+        }
+
+        page->dom = find_domain_by_name(ctx->rctx->domains, domname, true);
+        if (page->dom == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unknown domain in cursor [%s]\n",
+                  cursor);
+            return ERR_DOMAIN_NOT_FOUND;
+        }
+        page->cursor = cursor;
+    }
+
+    for (; page->dom != NULL;
+           page->dom = get_next_domain(page->dom, SSS_GND_DESCEND)) {
+        if (page->count == page->max) {
+            /* The next page starts in this domain */
+            page->more = true;
+            break;
+        }
+
+        page->first = page->count;
+        ret = ifp_list_page_search(ctx, search_fn, page, filter, attrs);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to list entries of %s [%d]: %s\n",
+                  page->dom->name, ret, sss_strerror(ret));
+            return ret;
+        }
+
+        if (page->more) {
+            break;
+        }
+        page->cursor = NULL;
+    }
+
+    return EOK;
+}
+
+errno_t ifp_list_page_write_reply(struct ifp_ctx *ctx,
+                                  ifp_list_page_search_fn search_fn,
+                                  ifp_list_page_path_fn path_fn,
+                                  const char **whitelist,
+                                  const char *filter,
+                                  const char *cursor,
+                                  uint32_t page_size,
+                                  const char **req_attrs,
+                                  DBusMessageIter *iter)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ifp_list_page *page;
+    DBusMessageIter iter_array;
+    const char *next_cursor;
+    const char **attrs;
+    const char **search_attrs;
+    dbus_bool_t dbret;
+    const char *path;
+    size_t i;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = ifp_get_object_attrs(tmp_ctx, whitelist, req_attrs, &attrs,
+                               &search_attrs);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    page = talloc_zero(tmp_ctx, struct ifp_list_page);
+    if (page == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    page->max = ifp_list_limit(ctx, page_size);
+    if (page->max == 0) {
+        page->max = IFP_LIST_PAGE_SIZE_DEFAULT;
+    }
+
+    ret = ifp_list_page_collect(ctx, search_fn, page, filter, cursor,
+                                search_attrs);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* The names are rewritten to the output format below */
+    next_cursor = "";
+    if (page->more && page->count > 0) {
+        next_cursor = talloc_strdup(tmp_ctx,
+                                    page->entries[page->count - 1].name);
+        if (next_cursor == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    dbret = dbus_message_iter_append_basic(iter, DBUS_TYPE_STRING,
+                                           &next_cursor);
+    if (!dbret) {
+        ret = EIO;
+        goto done;
+    }
+
+    dbret = dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+                                      DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                      DBUS_TYPE_OBJECT_PATH_AS_STRING
+                                      DBUS_TYPE_ARRAY_AS_STRING
+                                      DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                      DBUS_TYPE_STRING_AS_STRING
+                                      DBUS_TYPE_VARIANT_AS_STRING
+                                      DBUS_DICT_ENTRY_END_CHAR_AS_STRING
+                                      DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+                                      &iter_array);
+    if (!dbret) {
+        ret = EIO;
+        goto done;
+    }
+
+    for (i = 0; i < page->count; i++) {
+        path = path_fn(tmp_ctx, page->entries[i].dom, page->entries[i].msg);
+        if (path == NULL) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to build object path of %s\n",
+                  page->entries[i].name);
+            continue;
+        }
+
+        ret = ifp_add_object_to_dict(&iter_array, ctx->rctx, path,
+                                     page->entries[i].dom,
+                                     page->entries[i].msg, attrs);
+        if (ret != EOK) {
+            dbus_message_iter_abandon_container(iter, &iter_array);
+            goto done;
+        }
+    }
+
+    dbret = dbus_message_iter_close_container(iter, &iter_array);
+    if (!dbret) {
+        ret = EIO;
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
@@ -94,4 +94,14 @@ typedef enum kcm_opcode {
     KCM_OP_SENTINEL,            /* SSSD addition, not in the MIT header */
 } kcm_opcode;
 
+/* MIT extensions. MIT krb5 clients use these if they are available and
+ * fall back to the previous opcodes when the server replies with
+ * KRB5_CC_IO or KRB5_FCC_INTERNAL, as it does for unknown opcodes. */
+typedef enum kcm_mit_opcode {
+    KCM_MIT_OP_BASE = 13000,
+    KCM_MIT_OP_GET_CRED_LIST,   /*         (name) -> (count, count*{len, cred}) */
+
+    KCM_MIT_OP_SENTINEL,        /* SSSD addition, not in the MIT header */
+} kcm_mit_opcode;
+
 #endif /* KCM_H */
@@ -124,6 +124,63 @@ struct kcm_ccache *kcm_cc_dup(TALLOC_CTX *mem_ctx,
     return dup;
 }
 
+struct kcm_ccache *kcm_cc_copy(TALLOC_CTX *mem_ctx,
+                               const struct kcm_ccache *cc)
+{
+    struct kcm_ccache *copy;
+    struct kcm_cred *crd_copy;
+    struct kcm_cred *crd;
+    struct sss_iobuf *blob;
+    krb5_error_code kret;
+
+    copy = talloc_zero(mem_ctx, struct kcm_ccache);
+    if (copy == NULL) {
+        return NULL;
+    }
+    talloc_set_destructor(copy, kcm_cc_destructor);
+
+    copy->name = talloc_strdup(copy, cc->name);
+    if (copy->name == NULL) {
+        talloc_free(copy);
+        return NULL;
+    }
+
+    copy->owner = cc->owner;
+    uuid_copy(copy->uuid, cc->uuid);
+    copy->kdc_offset = cc->kdc_offset;
+
+    if (cc->client != NULL) {
+        kret = krb5_copy_principal(NULL, cc->client, &copy->client);
+        if (kret != 0) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "krb5_copy_principal failed: [%d]\n", kret);
+            talloc_free(copy);
+            return NULL;
+        }
+    }
+
+    DLIST_FOR_EACH(crd, cc->creds) {
+        blob = sss_iobuf_init_readonly(copy,
+                                       sss_iobuf_get_data(crd->cred_blob),
+                                       sss_iobuf_get_size(crd->cred_blob));
+        if (blob == NULL) {
+            talloc_free(copy);
+            return NULL;
+        }
+
+        crd_copy = kcm_cred_new(copy, crd->uuid, blob);
+        if (crd_copy == NULL) {
+            talloc_free(copy);
+            return NULL;
+        }
+
+        /* Keep the order of the credentials */
+        DLIST_ADD_END(copy->creds, crd_copy, struct kcm_cred *);
+    }
+
+    return copy;
+}
+
 const char *kcm_cc_get_name(struct kcm_ccache *cc)
 {
     return cc ? cc->name : NULL;
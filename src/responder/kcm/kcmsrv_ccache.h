@@ -79,6 +79,13 @@ errno_t kcm_cc_new(TALLOC_CTX *mem_ctx,
 struct kcm_ccache *kcm_cc_dup(TALLOC_CTX *mem_ctx,
                               const struct kcm_ccache *cc);
 
+/*
+ * Copy the ccache including the principal and the credentials, so that
+ * the copy does not share any data with the original.
+ */
+struct kcm_ccache *kcm_cc_copy(TALLOC_CTX *mem_ctx,
+                               const struct kcm_ccache *cc);
+
 /*
  * Returns true if a client can access a ccache.
  *
@@ -376,4 +383,18 @@ errno_t kcm_ccache_to_sec_input_binary(TALLOC_CTX *mem_ctx,
                                        struct kcm_ccache *cc,
                                        struct sss_iobuf **_payload);
 
+/* Convert a single credential to its binary representation, it is used
+ * to store the credential without rewriting the whole ccache. */
+errno_t kcm_cred_to_sec_input_binary(TALLOC_CTX *mem_ctx,
+                                     struct kcm_cred *crd,
+                                     struct sss_iobuf **_payload);
+
+/*
+ * sec_value is the binary representation of a single credential as
+ * created by kcm_cred_to_sec_input_binary().
+ */
+errno_t sec_value_to_cred_binary(TALLOC_CTX *mem_ctx,
+                                 struct sss_iobuf *sec_value,
+                                 struct kcm_cred **_crd);
+
 #endif /* _KCMSRV_CCACHE_H_ */
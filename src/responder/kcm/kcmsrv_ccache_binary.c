@@ -28,6 +28,35 @@
 #include "util/crypto/sss_crypto.h"
 #include "responder/kcm/kcmsrv_ccache_pvt.h"
 
+/* The sizes of the binary representations, the output buffer is allocated
+ * at once instead of being grown while a large ccache is written into it */
+static size_t krb_data_bin_size(krb5_data *data)
+{
+    return sizeof(uint32_t) + data->length;
+}
+
+static size_t princ_bin_size(krb5_principal princ)
+{
+    size_t size = sizeof(uint8_t);
+
+    if (princ == NULL) {
+        return size;
+    }
+
+    size += krb_data_bin_size(&princ->realm) + 2 * sizeof(int32_t);
+    for (krb5_int32 i = 0; i < princ->length; i++) {
+        size += krb_data_bin_size(&princ->data[i]);
+    }
+
+    return size;
+}
+
+static size_t cred_bin_size(struct kcm_cred *crd)
+{
+    return sizeof(uuid_t) + sizeof(uint32_t)
+           + sss_iobuf_get_size(crd->cred_blob);
+}
+
 static errno_t krb_data_to_bin(krb5_data *data, struct sss_iobuf *buf)
 {
     return sss_iobuf_write_varlen(buf, (uint8_t *)data->data, data->length);
@@ -107,9 +136,16 @@ errno_t kcm_ccache_to_sec_input_binary(TALLOC_CTX *mem_ctx,
                                        struct sss_iobuf **_payload)
 {
     struct sss_iobuf *buf;
+    struct kcm_cred *crd;
+    size_t size;
     errno_t ret;
 
-    buf = sss_iobuf_init_empty(mem_ctx, sizeof(krb5_principal_data), 0);
+    size = sizeof(int32_t) + princ_bin_size(cc->client) + sizeof(uint32_t);
+    DLIST_FOR_EACH(crd, cc->creds) {
+        size += cred_bin_size(crd);
+    }
+
+    buf = sss_iobuf_init_empty(mem_ctx, size, 0);
     if (buf == NULL) {
         return ENOMEM;
     }
@@ -141,6 +177,40 @@ done:
     return ret;
 }
 
+errno_t kcm_cred_to_sec_input_binary(TALLOC_CTX *mem_ctx,
+                                     struct kcm_cred *crd,
+                                     struct sss_iobuf **_payload)
+{
+    struct sss_iobuf *buf;
+    errno_t ret;
+
+    buf = sss_iobuf_init_empty(mem_ctx, cred_bin_size(crd), 0);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sss_iobuf_write_len(buf, (uint8_t *)crd->uuid, sizeof(uuid_t));
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sss_iobuf_write_iobuf(buf, crd->cred_blob);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_payload = buf;
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(buf);
+    }
+
+    return ret;
+}
+
 static errno_t bin_to_krb_data(TALLOC_CTX *mem_ctx,
                                struct sss_iobuf *buf,
                                krb5_data *out)
@@ -259,6 +329,36 @@ static errno_t bin_to_creds(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+errno_t sec_value_to_cred_binary(TALLOC_CTX *mem_ctx,
+                                 struct sss_iobuf *sec_value,
+                                 struct kcm_cred **_crd)
+{
+    struct kcm_cred *crd;
+    struct sss_iobuf *cred_blob;
+    uuid_t uuid;
+    errno_t ret;
+
+    ret = sss_iobuf_read_len(sec_value, sizeof(uuid_t), (uint8_t*)uuid);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sss_iobuf_read_iobuf(NULL, sec_value, &cred_blob);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    crd = kcm_cred_new(mem_ctx, uuid, cred_blob);
+    if (crd == NULL) {
+        talloc_free(cred_blob);
+        return ENOMEM;
+    }
+
+    *_crd = crd;
+
+    return EOK;
+}
+
 errno_t sec_kv_to_ccache_binary(TALLOC_CTX *mem_ctx,
                                 const char *sec_key,
                                 struct sss_iobuf *sec_value,
@@ -25,6 +25,7 @@
 #include <stdio.h>
 
 #include "util/util.h"
+#include "util/strtonum.h"
 #include "util/secrets/secrets.h"
 #include "util/crypto/sss_crypto.h"
 #include "responder/kcm/kcmsrv_ccache_pvt.h"
@@ -34,6 +35,14 @@
 #define KCM_SECDB_BASE_FMT    KCM_SECDB_URL"/%"SPRIuid"/"
 #define KCM_SECDB_CCACHE_FMT  KCM_SECDB_BASE_FMT"ccache/"
 #define KCM_SECDB_DFL_FMT     KCM_SECDB_BASE_FMT"default"
+#define KCM_SECDB_CREDLOG_FMT KCM_SECDB_BASE_FMT"credlog/"
+
+/* Number of users whose ccaches are kept in memory */
+#define KCM_SECDB_CACHE_MAX_UIDS 128
+
+/* Number of credentials that are stored as separate records before they
+ * are merged into the record of their ccache */
+#define KCM_SECDB_CREDLOG_MAX 8
 
 static errno_t sec_get(TALLOC_CTX *mem_ctx,
                        struct sss_sec_req *req,
@@ -146,9 +155,61 @@ static const char *secdb_dfl_url_create(TALLOC_CTX *mem_ctx,
                            cli_creds_get_uid(client));
 }
 
+static const char *secdb_log_container_url_create(TALLOC_CTX *mem_ctx,
+                                                  struct cli_creds *client)
+{
+    return talloc_asprintf(mem_ctx,
+                           KCM_SECDB_CREDLOG_FMT,
+                           cli_creds_get_uid(client));
+}
+
+/* The key of an appended credential is the UUID of its ccache followed
+ * by a sequence number, so that the records can be replayed in order */
+static const char *secdb_log_url_create(TALLOC_CTX *mem_ctx,
+                                        struct cli_creds *client,
+                                        const char *secdb_key,
+                                        uint32_t seq)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char *seq_str;
+    const char *log_key;
+    const char *url = NULL;
+    uuid_t uuid;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return NULL;
+    }
+
+    ret = sec_key_get_uuid(secdb_key, uuid);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    seq_str = talloc_asprintf(tmp_ctx, "%"PRIu32, seq);
+    if (seq_str == NULL) {
+        goto done;
+    }
+
+    log_key = sec_key_create(tmp_ctx, seq_str, uuid);
+    if (log_key == NULL) {
+        goto done;
+    }
+
+    url = talloc_asprintf(mem_ctx,
+                          KCM_SECDB_CREDLOG_FMT"%s",
+                          cli_creds_get_uid(client),
+                          log_key);
+done:
+    talloc_free(tmp_ctx);
+    return url;
+}
+
 static errno_t kcm_ccache_to_secdb_kv(TALLOC_CTX *mem_ctx,
                                       struct kcm_ccache *cc,
                                       struct cli_creds *client,
+                                      const char **_key,
                                       const char **_url,
                                       struct sss_iobuf **_payload)
 {
@@ -186,6 +247,7 @@ static errno_t kcm_ccache_to_secdb_kv(TALLOC_CTX *mem_ctx,
 
     ret = EOK;
     DEBUG(SSSDBG_TRACE_INTERNAL, "Created URL %s\n", url);
+    *_key = talloc_steal(mem_ctx, key);
     *_url = talloc_steal(mem_ctx, url);
     *_payload = talloc_steal(mem_ctx, payload);
 done:
@@ -193,8 +255,44 @@ done:
     return ret;
 }
 
+/* A ccache of the user, it is loaded from the database on first use */
+struct ccdb_secdb_cc {
+    struct ccdb_secdb_cc *prev;
+    struct ccdb_secdb_cc *next;
+
+    const char *key;
+    struct kcm_ccache *cc;
+
+    /* Sequence numbers of the credentials that were stored since the
+     * ccache record was written, in the order they were stored */
+    uint32_t *log_seqs;
+    size_t num_log;
+    uint32_t next_seq;
+};
+
+/* The keys, the ccaches and the default ccache of one user. The database
+ * is only written by this process, so the cached data are kept until
+ * they are changed, which is done in the database first. */
+struct ccdb_secdb_uid {
+    struct ccdb_secdb_uid *prev;
+    struct ccdb_secdb_uid *next;
+
+    uid_t uid;
+    bool has_container;
+    bool has_log_container;
+    struct ccdb_secdb_cc *ccs;
+    size_t num_ccs;
+
+    bool dfl_loaded;
+    uuid_t dfl_uuid;
+};
+
 struct ccdb_secdb {
     struct sss_sec_ctx *sctx;
+
+    /* Most recently used first */
+    struct ccdb_secdb_uid *uids;
+    size_t num_uids;
 };
 
 /* Since with the synchronous database, the database operations are just
@@ -336,163 +434,719 @@ done:
     return ret;
 }
 
-static errno_t key_by_uuid(TALLOC_CTX *mem_ctx,
-                           struct sss_sec_ctx *sctx,
-                           struct cli_creds *client,
-                           uuid_t uuid,
-                           char **_key)
+static errno_t secdb_get_cc(TALLOC_CTX *mem_ctx,
+                            struct sss_sec_ctx *sctx,
+                            const char *secdb_key,
+                            struct cli_creds *client,
+                            struct kcm_ccache **_cc)
 {
-    TALLOC_CTX *tmp_ctx;
     errno_t ret;
-    char *key_match = NULL;
+    TALLOC_CTX *tmp_ctx = NULL;
+    struct kcm_ccache *cc = NULL;
+    struct sss_sec_req *sreq = NULL;
+    struct sss_iobuf *ccbuf;
+    char *datatype;
+
+    tmp_ctx = talloc_new(mem_ctx);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = secdb_cc_key_req(tmp_ctx, sctx, client, secdb_key, &sreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot create secdb request [%d][%s]\n", ret, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = sec_get(tmp_ctx, sreq, &ccbuf, &datatype);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get the secret [%d][%s]\n", ret, sss_strerror(ret));
+        goto done;
+    }
+
+    if (strcmp(datatype, "binary") == 0) {
+        ret = sec_kv_to_ccache_binary(tmp_ctx, secdb_key, ccbuf, client, &cc);
+    } else {
+        ret = sec_kv_to_ccache_json(tmp_ctx, secdb_key,
+                                    (const char *)sss_iobuf_get_data(ccbuf),
+                                    client, &cc);
+    }
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Cannot convert %s data to ccache "
+              "[%d]: %s\n", datatype, ret, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = EOK;
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Fetched the ccache\n");
+    *_cc = talloc_steal(mem_ctx, cc);
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t secdb_uid_add_cc(struct ccdb_secdb_uid *ucache,
+                                const char *key,
+                                struct kcm_ccache *cc)
+{
+    struct ccdb_secdb_cc *entry;
+
+    entry = talloc_zero(ucache, struct ccdb_secdb_cc);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+
+    entry->key = talloc_strdup(entry, key);
+    if (entry->key == NULL) {
+        talloc_free(entry);
+        return ENOMEM;
+    }
+
+    entry->cc = talloc_steal(entry, cc);
+
+    DLIST_ADD_END(ucache->ccs, entry, struct ccdb_secdb_cc *);
+    ucache->num_ccs++;
+    return EOK;
+}
+
+static void secdb_uid_remove_cc(struct ccdb_secdb_uid *ucache,
+                                struct ccdb_secdb_cc *entry)
+{
+    DLIST_REMOVE(ucache->ccs, entry);
+    ucache->num_ccs--;
+    talloc_free(entry);
+}
+
+static struct ccdb_secdb_cc *secdb_uid_cc_by_uuid(struct ccdb_secdb_uid *ucache,
+                                                  uuid_t uuid)
+{
+    struct ccdb_secdb_cc *entry;
+
+    DLIST_FOR_EACH(entry, ucache->ccs) {
+        if (sec_key_match_uuid(entry->key, uuid)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static struct ccdb_secdb_cc *secdb_uid_cc_by_name(struct ccdb_secdb_uid *ucache,
+                                                  const char *name)
+{
+    struct ccdb_secdb_cc *entry;
+
+    DLIST_FOR_EACH(entry, ucache->ccs) {
+        if (sec_key_match_name(entry->key, name)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static int secdb_seq_cmp(const void *a, const void *b)
+{
+    uint32_t seq_a = *(const uint32_t *)a;
+    uint32_t seq_b = *(const uint32_t *)b;
+
+    if (seq_a < seq_b) {
+        return -1;
+    }
+
+    return seq_a > seq_b ? 1 : 0;
+}
+
+/* Assigns the appended credentials to the cached ccaches. Records of
+ * ccaches that no longer exist are left over from an interrupted delete
+ * and are removed. */
+static errno_t secdb_uid_load_log(TALLOC_CTX *mem_ctx,
+                                  struct ccdb_secdb *secdb,
+                                  struct cli_creds *client,
+                                  struct ccdb_secdb_uid *ucache)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ccdb_secdb_cc *entry;
+    struct sss_sec_req *sreq = NULL;
+    const char *container_url;
+    const char *url;
+    const char *seq_str;
+    char *endptr;
     char **keys = NULL;
     size_t nkeys;
-    struct sss_sec_req *sreq = NULL;
+    uint32_t *seqs;
+    uint32_t seq;
+    uuid_t uuid;
+    errno_t ret;
 
     tmp_ctx = talloc_new(mem_ctx);
     if (tmp_ctx == NULL) {
         return ENOMEM;
     }
 
-    ret = secdb_container_url_req(tmp_ctx, sctx, client, &sreq);
+    container_url = secdb_log_container_url_create(tmp_ctx, client);
+    if (container_url == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = secdb_cc_url_req(tmp_ctx, secdb->sctx, client, container_url,
+                           &sreq);
     if (ret != EOK) {
         goto done;
     }
 
     ret = sss_sec_list(tmp_ctx, sreq, &keys, &nkeys);
     if (ret == ENOENT) {
-        DEBUG(SSSDBG_MINOR_FAILURE, "The container was not found\n");
+        ret = EOK;
         goto done;
     } else if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot list appended credentials [%d]: %s\n",
+              ret, sss_strerror(ret));
         goto done;
     }
+    ucache->has_log_container = true;
 
     for (size_t i = 0; i < nkeys; i++) {
-        if (sec_key_match_uuid(keys[i], uuid)) {
-            key_match = keys[i];
-            break;
+        seq_str = sec_key_get_name(keys[i]);
+        if (seq_str == NULL
+                || sec_key_get_uuid(keys[i], uuid) != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Malformed credential key %s, skipping\n", keys[i]);
+            continue;
+        }
+
+        seq = strtouint32(seq_str, &endptr, 10);
+        if (errno != 0 || *endptr != '\0' || endptr == seq_str) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Malformed credential key %s, skipping\n", keys[i]);
+            continue;
+        }
+
+        entry = secdb_uid_cc_by_uuid(ucache, uuid);
+        if (entry == NULL) {
+            DEBUG(SSSDBG_TRACE_FUNC,
+                  "Removing credential %s of a deleted ccache\n", keys[i]);
+            url = talloc_asprintf(tmp_ctx, "%s%s", container_url, keys[i]);
+            if (url == NULL
+                    || secdb_cc_url_req(tmp_ctx, secdb->sctx, client,
+                                        url, &sreq) != EOK
+                    || sss_sec_delete(sreq) != EOK) {
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "Cannot remove credential %s\n", keys[i]);
+            }
+            continue;
+        }
+
+        seqs = talloc_realloc(entry, entry->log_seqs, uint32_t,
+                              entry->num_log + 1);
+        if (seqs == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        seqs[entry->num_log] = seq;
+        entry->log_seqs = seqs;
+        entry->num_log++;
+
+        if (seq >= entry->next_seq) {
+            entry->next_seq = seq + 1;
+        }
+    }
+
+    DLIST_FOR_EACH(entry, ucache->ccs) {
+        if (entry->num_log > 1) {
+            qsort(entry->log_seqs, entry->num_log, sizeof(uint32_t),
+                  secdb_seq_cmp);
+        }
+    }
+
+    ret = EOK;
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t secdb_uid_load(struct ccdb_secdb *secdb,
+                              struct cli_creds *client,
+                              struct ccdb_secdb_uid **_ucache)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ccdb_secdb_uid *ucache;
+    struct sss_sec_req *sreq = NULL;
+    char **keys = NULL;
+    size_t nkeys;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ucache = talloc_zero(tmp_ctx, struct ccdb_secdb_uid);
+    if (ucache == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    ucache->uid = cli_creds_get_uid(client);
+
+    ret = secdb_container_url_req(tmp_ctx, secdb->sctx, client, &sreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sss_sec_list(tmp_ctx, sreq, &keys, &nkeys);
+    if (ret == ENOENT) {
+        nkeys = 0;
+    } else if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot list keys [%d]: %s\n", ret, sss_strerror(ret));
+        goto done;
+    } else {
+        ucache->has_container = true;
+    }
+
+    for (size_t i = 0; i < nkeys; i++) {
+        ret = secdb_uid_add_cc(ucache, keys[i], NULL);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = secdb_uid_load_log(tmp_ctx, secdb, client, ucache);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Cached %zu ccache keys of %"SPRIuid"\n",
+          nkeys, ucache->uid);
+    *_ucache = talloc_steal(secdb, ucache);
+    ret = EOK;
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static struct ccdb_secdb_uid *secdb_uid_find(struct ccdb_secdb *secdb,
+                                             struct cli_creds *client)
+{
+    struct ccdb_secdb_uid *ucache;
+    uid_t uid = cli_creds_get_uid(client);
+
+    DLIST_FOR_EACH(ucache, secdb->uids) {
+        if (ucache->uid == uid) {
+            return ucache;
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns the cached data of the client's uid, reading the keys from the
+ * database if the uid is not cached yet. */
+static errno_t secdb_uid_get(struct ccdb_secdb *secdb,
+                             struct cli_creds *client,
+                             struct ccdb_secdb_uid **_ucache)
+{
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_uid *last;
+    errno_t ret;
+
+    ucache = secdb_uid_find(secdb, client);
+    if (ucache != NULL) {
+        DLIST_PROMOTE(secdb->uids, ucache);
+        *_ucache = ucache;
+        return EOK;
+    }
+
+    ret = secdb_uid_load(secdb, client, &ucache);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    DLIST_ADD(secdb->uids, ucache);
+    secdb->num_uids++;
+
+    if (secdb->num_uids > KCM_SECDB_CACHE_MAX_UIDS) {
+        for (last = secdb->uids; last->next != NULL; last = last->next) {
+            /* no op */
+        }
+
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Dropping ccaches of %"SPRIuid" "
+              "from memory\n", last->uid);
+        DLIST_REMOVE(secdb->uids, last);
+        secdb->num_uids--;
+        talloc_free(last);
+    }
+
+    *_ucache = ucache;
+    return EOK;
+}
+
+/* Forget the cached data of the uid, they are read from the database
+ * again next time. This is used when a write fails, so that the cache
+ * does not have to guess what the database contains. */
+static void secdb_uid_drop(struct ccdb_secdb *secdb,
+                           struct cli_creds *client)
+{
+    struct ccdb_secdb_uid *ucache;
+
+    ucache = secdb_uid_find(secdb, client);
+    if (ucache == NULL) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Dropping ccaches of %"SPRIuid" "
+          "from memory\n", ucache->uid);
+    DLIST_REMOVE(secdb->uids, ucache);
+    secdb->num_uids--;
+    talloc_free(ucache);
+}
+
+static bool secdb_cc_has_cred(struct kcm_ccache *cc, uuid_t uuid)
+{
+    struct kcm_cred *crd;
+
+    DLIST_FOR_EACH(crd, cc->creds) {
+        if (uuid_compare(crd->uuid, uuid) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Adds the appended credentials to the ccache read from its record. A
+ * credential is already there if the records were not removed after
+ * the ccache was written. */
+static errno_t secdb_cc_replay_log(struct ccdb_secdb *secdb,
+                                   struct cli_creds *client,
+                                   struct ccdb_secdb_cc *entry,
+                                   struct kcm_ccache *cc)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sss_sec_req *sreq;
+    struct sss_iobuf *buf;
+    struct kcm_cred *crd;
+    const char *url;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    for (size_t i = 0; i < entry->num_log; i++) {
+        url = secdb_log_url_create(tmp_ctx, client, entry->key,
+                                   entry->log_seqs[i]);
+        if (url == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = secdb_cc_url_req(tmp_ctx, secdb->sctx, client, url, &sreq);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = sec_get(tmp_ctx, sreq, &buf, NULL);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = sec_value_to_cred_binary(tmp_ctx, buf, &crd);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Cannot convert binary data to "
+                  "credential [%d]: %s\n", ret, sss_strerror(ret));
+            goto done;
+        }
+
+        if (secdb_cc_has_cred(cc, crd->uuid)) {
+            continue;
+        }
+
+        ret = kcm_cc_store_creds(cc, crd);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = EOK;
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t secdb_uid_load_cc(struct ccdb_secdb *secdb,
+                                 struct cli_creds *client,
+                                 struct ccdb_secdb_cc *entry)
+{
+    struct kcm_ccache *cc;
+    errno_t ret;
+
+    if (entry->cc != NULL) {
+        return EOK;
+    }
+
+    ret = secdb_get_cc(entry, secdb->sctx, entry->key, client, &cc);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = secdb_cc_replay_log(secdb, client, entry, cc);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot read the appended credentials [%d]: %s\n",
+              ret, sss_strerror(ret));
+        talloc_free(cc);
+        return ret;
+    }
+
+    entry->cc = cc;
+    return EOK;
+}
+
+/* Removes the records of the appended credentials of the ccache */
+static errno_t secdb_cc_delete_log(struct ccdb_secdb *secdb,
+                                   struct cli_creds *client,
+                                   struct ccdb_secdb_cc *entry)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sss_sec_req *sreq;
+    const char *url;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    while (entry->num_log > 0) {
+        url = secdb_log_url_create(tmp_ctx, client, entry->key,
+                                   entry->log_seqs[entry->num_log - 1]);
+        if (url == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = secdb_cc_url_req(tmp_ctx, secdb->sctx, client, url, &sreq);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = sss_sec_delete(sreq);
+        if (ret != EOK && ret != ENOENT) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Cannot remove appended credential [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            goto done;
         }
-    }
 
-    if (key_match == NULL) {
-        DEBUG(SSSDBG_TRACE_INTERNAL, "No key matched\n");
-        ret = ENOENT;
-        goto done;
+        entry->num_log--;
     }
 
+    talloc_zfree(entry->log_seqs);
+    entry->next_seq = 0;
     ret = EOK;
-    DEBUG(SSSDBG_TRACE_INTERNAL, "Found key %s\n", key_match);
-    *_key = talloc_steal(mem_ctx, key_match);
 done:
     talloc_free(tmp_ctx);
     return ret;
 }
 
-static errno_t key_by_name(TALLOC_CTX *mem_ctx,
-                           struct sss_sec_ctx *sctx,
-                           struct cli_creds *client,
-                           const char *name,
-                           char **_key)
+/* Writes the whole ccache to its record. The appended credentials are
+ * part of the record then, so their own records are removed. */
+static errno_t secdb_cc_write(struct ccdb_secdb *secdb,
+                              struct cli_creds *client,
+                              struct ccdb_secdb_cc *entry,
+                              struct kcm_ccache *cc)
 {
     TALLOC_CTX *tmp_ctx;
+    struct sss_iobuf *payload;
+    struct sss_sec_req *sreq;
     errno_t ret;
-    char *key_match = NULL;
-    char **keys = NULL;
-    size_t nkeys;
-    struct sss_sec_req *sreq = NULL;
 
-    tmp_ctx = talloc_new(mem_ctx);
+    tmp_ctx = talloc_new(NULL);
     if (tmp_ctx == NULL) {
         return ENOMEM;
     }
 
-    ret = secdb_container_url_req(tmp_ctx, sctx, client, &sreq);
+    ret = kcm_ccache_to_sec_input_binary(tmp_ctx, cc, &payload);
     if (ret != EOK) {
         goto done;
     }
 
-    ret = sss_sec_list(tmp_ctx, sreq, &keys, &nkeys);
-    if (ret == ENOENT) {
-        DEBUG(SSSDBG_MINOR_FAILURE, "The container was not found\n");
-        goto done;
-    } else if (ret != EOK) {
+    ret = secdb_cc_key_req(tmp_ctx, secdb->sctx, client, entry->key, &sreq);
+    if (ret != EOK) {
         goto done;
     }
 
-    for (size_t i = 0; i < nkeys; i++) {
-        if (sec_key_match_name(keys[i], name)) {
-            key_match = keys[i];
-            break;
-        }
+    ret = sec_update(tmp_ctx, sreq, payload);
+    if (ret != EOK) {
+        goto done;
     }
 
-    if (key_match == NULL) {
-        DEBUG(SSSDBG_TRACE_INTERNAL, "No key matched\n");
-        ret = ENOENT;
-        goto done;
+    ret = secdb_cc_delete_log(secdb, client, entry);
+    if (ret != EOK) {
+        /* The ccache record is written. The records that are left are
+         * still tracked and removed by the next write, until then their
+         * credentials are skipped when they are replayed. */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot remove appended credentials [%d]: %s\n",
+              ret, sss_strerror(ret));
     }
 
     ret = EOK;
-    DEBUG(SSSDBG_TRACE_INTERNAL, "Found key %s\n", key_match);
-    *_key = talloc_steal(mem_ctx, key_match);
 done:
     talloc_free(tmp_ctx);
     return ret;
 }
 
-static errno_t secdb_get_cc(TALLOC_CTX *mem_ctx,
-                            struct sss_sec_ctx *sctx,
-                            const char *secdb_key,
-                            struct cli_creds *client,
-                            struct kcm_ccache **_cc)
+/* The records of the appended credentials count toward the per-UID quota,
+ * they are merged into their ccaches when the quota is reached */
+static errno_t secdb_uid_merge_logs(struct ccdb_secdb *secdb,
+                                    struct cli_creds *client,
+                                    struct ccdb_secdb_uid *ucache,
+                                    size_t *_num_merged)
 {
+    struct ccdb_secdb_cc *entry;
+    size_t num_merged = 0;
     errno_t ret;
-    TALLOC_CTX *tmp_ctx = NULL;
-    struct kcm_ccache *cc = NULL;
-    struct sss_sec_req *sreq = NULL;
-    struct sss_iobuf *ccbuf;
-    char *datatype;
 
-    tmp_ctx = talloc_new(mem_ctx);
+    DLIST_FOR_EACH(entry, ucache->ccs) {
+        if (entry->num_log == 0) {
+            continue;
+        }
+
+        ret = secdb_uid_load_cc(secdb, client, entry);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        num_merged += entry->num_log;
+        ret = secdb_cc_write(secdb, client, entry, entry->cc);
+        if (ret != EOK) {
+            return ret;
+        }
+        num_merged -= entry->num_log;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Merged %zu appended credentials\n",
+          num_merged);
+    *_num_merged = num_merged;
+    return EOK;
+}
+
+/* Stores the credential as a separate record instead of rewriting the
+ * whole ccache */
+static errno_t secdb_cc_append_cred(struct ccdb_secdb *secdb,
+                                    struct cli_creds *client,
+                                    struct ccdb_secdb_uid *ucache,
+                                    struct ccdb_secdb_cc *entry,
+                                    struct kcm_cred *crd)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sss_iobuf *payload;
+    struct sss_sec_req *sreq;
+    const char *url;
+    uint32_t *seqs;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
     if (tmp_ctx == NULL) {
         return ENOMEM;
     }
 
-    ret = secdb_cc_key_req(tmp_ctx, sctx, client, secdb_key, &sreq);
+    ret = kcm_cred_to_sec_input_binary(tmp_ctx, crd, &payload);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Cannot create secdb request [%d][%s]\n", ret, sss_strerror(ret));
         goto done;
     }
 
-    ret = sec_get(tmp_ctx, sreq, &ccbuf, &datatype);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Cannot get the secret [%d][%s]\n", ret, sss_strerror(ret));
+    if (!ucache->has_log_container) {
+        url = secdb_log_container_url_create(tmp_ctx, client);
+        if (url == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = secdb_cc_url_req(tmp_ctx, secdb->sctx, client, url, &sreq);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = sss_sec_create_container(sreq);
+        if (ret != EOK && ret != EEXIST) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Failed to create the credentials container\n");
+            goto done;
+        }
+        ucache->has_log_container = true;
+    }
+
+    /* Allocate first so that a stored record is always accounted for */
+    seqs = talloc_realloc(entry, entry->log_seqs, uint32_t,
+                          entry->num_log + 1);
+    if (seqs == NULL) {
+        ret = ENOMEM;
         goto done;
     }
+    entry->log_seqs = seqs;
 
-    if (strcmp(datatype, "binary") == 0) {
-        ret = sec_kv_to_ccache_binary(tmp_ctx, secdb_key, ccbuf, client, &cc);
-    } else {
-        ret = sec_kv_to_ccache_json(tmp_ctx, secdb_key,
-                                    (const char *)sss_iobuf_get_data(ccbuf),
-                                    client, &cc);
+    url = secdb_log_url_create(tmp_ctx, client, entry->key, entry->next_seq);
+    if (url == NULL) {
+        ret = ENOMEM;
+        goto done;
     }
+
+    ret = secdb_cc_url_req(tmp_ctx, secdb->sctx, client, url, &sreq);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "Cannot convert %s data to ccache "
-              "[%d]: %s\n", datatype, ret, sss_strerror(ret));
         goto done;
     }
 
+    ret = sec_put(tmp_ctx, sreq, payload);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    entry->log_seqs[entry->num_log] = entry->next_seq;
+    entry->num_log++;
+    entry->next_seq++;
+
     ret = EOK;
-    DEBUG(SSSDBG_TRACE_INTERNAL, "Fetched the ccache\n");
-    *_cc = talloc_steal(mem_ctx, cc);
 done:
     talloc_free(tmp_ctx);
     return ret;
 }
 
+/* Returns a copy of the cached ccache that is owned by the client, as
+ * if the ccache was read from the database. */
+static errno_t secdb_uid_copy_cc(TALLOC_CTX *mem_ctx,
+                                 struct ccdb_secdb *secdb,
+                                 struct cli_creds *client,
+                                 struct ccdb_secdb_cc *entry,
+                                 struct kcm_ccache **_cc)
+{
+    struct kcm_ccache *cc;
+    errno_t ret;
+
+    ret = secdb_uid_load_cc(secdb, client, entry);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    cc = kcm_cc_copy(mem_ctx, entry->cc);
+    if (cc == NULL) {
+        return ENOMEM;
+    }
+
+    cc->owner.uid = cli_creds_get_uid(client);
+    cc->owner.gid = cli_creds_get_gid(client);
+
+    *_cc = cc;
+    return EOK;
+}
+
 static errno_t ccdb_secdb_init(struct kcm_ccdb *db,
                                struct confdb_ctx *cdb,
                                const char *confdb_service_path)
@@ -581,17 +1235,6 @@ struct ccdb_secdb_nextid_state {
     unsigned int nextid;
 };
 
-static bool is_in_use(char **keys, size_t nkeys, const char *nextid_name)
-{
-    for (size_t i = 0; i < nkeys; i++) {
-        if (sec_key_match_name(keys[i], nextid_name) == true) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
 static struct tevent_req *ccdb_secdb_nextid_send(TALLOC_CTX *mem_ctx,
                                                struct tevent_context *ev,
                                                struct kcm_ccdb *db,
@@ -600,12 +1243,10 @@ static struct tevent_req *ccdb_secdb_nextid_send(TALLOC_CTX *mem_ctx,
     struct tevent_req *req = NULL;
     struct ccdb_secdb_nextid_state *state = NULL;
     struct ccdb_secdb *secdb = NULL;
+    struct ccdb_secdb_uid *ucache;
     const int maxtries = 3;
     int numtry;
     errno_t ret;
-    struct sss_sec_req *sreq = NULL;
-    char **keys = NULL;
-    size_t nkeys;
     char *nextid_name = NULL;
 
     DEBUG(SSSDBG_TRACE_LIBS, "Generating a new ID\n");
@@ -621,22 +1262,11 @@ static struct tevent_req *ccdb_secdb_nextid_send(TALLOC_CTX *mem_ctx,
         goto immediate;
     }
 
-    ret = secdb_container_url_req(state, secdb->sctx, client, &sreq);
+    ret = secdb_uid_get(secdb, client, &ucache);
     if (ret != EOK) {
         goto immediate;
     }
 
-    ret = sss_sec_list(state, sreq, &keys, &nkeys);
-    if (ret == ENOENT) {
-        keys = NULL;
-        nkeys = 0;
-    } else if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Cannot list keys [%d]: %s\n",
-              ret, sss_strerror(ret));
-        goto immediate;
-    }
-
     for (numtry = 0; numtry  < maxtries; numtry++) {
         state->nextid = sss_rand() % MAX_CC_NUM;
         nextid_name = talloc_asprintf(state, "%"SPRIuid":%u",
@@ -647,7 +1277,7 @@ static struct tevent_req *ccdb_secdb_nextid_send(TALLOC_CTX *mem_ctx,
             goto immediate;
         }
 
-        if (!is_in_use(keys, nkeys, nextid_name)) {
+        if (secdb_uid_cc_by_name(ucache, nextid_name) == NULL) {
             break;
         }
     }
@@ -691,6 +1321,7 @@ static struct tevent_req *ccdb_secdb_set_default_send(TALLOC_CTX *mem_ctx,
     struct tevent_req *req = NULL;
     struct ccdb_secdb_state *state = NULL;
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
+    struct ccdb_secdb_uid *ucache;
     errno_t ret;
     char uuid_str[UUID_STR_SIZE];
     struct sss_sec_req *sreq = NULL;
@@ -727,9 +1358,16 @@ static struct tevent_req *ccdb_secdb_set_default_send(TALLOC_CTX *mem_ctx,
     }
 
     if (ret != EOK) {
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
 
+    ucache = secdb_uid_find(secdb, client);
+    if (ucache != NULL) {
+        uuid_copy(ucache->dfl_uuid, uuid);
+        ucache->dfl_loaded = true;
+    }
+
     ret = EOK;
     DEBUG(SSSDBG_TRACE_INTERNAL, "Set the default ccache\n");
 immediate:
@@ -760,6 +1398,7 @@ static struct tevent_req *ccdb_secdb_get_default_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_get_default_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
     errno_t ret;
     struct sss_sec_req *sreq = NULL;
     struct sss_iobuf *dfl_iobuf = NULL;
@@ -772,6 +1411,18 @@ static struct tevent_req *ccdb_secdb_get_default_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
+        goto immediate;
+    }
+
+    if (ucache->dfl_loaded) {
+        uuid_copy(state->uuid, ucache->dfl_uuid);
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Got the cached default ccache\n");
+        ret = EOK;
+        goto immediate;
+    }
+
     ret = secdb_dfl_url_req(state, secdb->sctx, client, &sreq);
     if (ret != EOK) {
         goto immediate;
@@ -781,7 +1432,7 @@ static struct tevent_req *ccdb_secdb_get_default_send(TALLOC_CTX *mem_ctx,
     if (ret == ENOENT) {
         uuid_clear(state->uuid);
         ret = EOK;
-        goto immediate;
+        goto cache;
     } else if (ret != EOK) {
         goto immediate;
     }
@@ -796,6 +1447,9 @@ static struct tevent_req *ccdb_secdb_get_default_send(TALLOC_CTX *mem_ctx,
     uuid_parse((const char *) sss_iobuf_get_data(dfl_iobuf), state->uuid);
     DEBUG(SSSDBG_TRACE_INTERNAL, "Got the default ccache\n");
     ret = EOK;
+cache:
+    uuid_copy(ucache->dfl_uuid, state->uuid);
+    ucache->dfl_loaded = true;
 immediate:
     if (ret == EOK) {
         tevent_req_done(req);
@@ -830,10 +1484,10 @@ static struct tevent_req *ccdb_secdb_list_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_list_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     errno_t ret;
-    char **keys = NULL;
-    size_t nkeys;
-    struct sss_sec_req *sreq = NULL;
+    size_t i;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Listing all ccaches\n");
 
@@ -842,35 +1496,29 @@ static struct tevent_req *ccdb_secdb_list_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = secdb_container_url_req(state, secdb->sctx, client, &sreq);
+    ret = secdb_uid_get(secdb, client, &ucache);
     if (ret != EOK) {
         goto immediate;
     }
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Found %zu ccaches\n", ucache->num_ccs);
 
-    ret = sss_sec_list(state, sreq, &keys, &nkeys);
-    if (ret == ENOENT) {
-        nkeys = 0;
-        /* Fall through and return an empty list */
-    } else if (ret != EOK) {
-        goto immediate;
-    }
-    DEBUG(SSSDBG_TRACE_INTERNAL, "Found %zu ccaches\n", nkeys);
-
-    state->uuid_list = talloc_array(state, uuid_t, nkeys + 1);
+    state->uuid_list = talloc_array(state, uuid_t, ucache->num_ccs + 1);
     if (state->uuid_list == NULL) {
         ret = ENOMEM;
         goto immediate;
     }
 
-    for (size_t i = 0; i < nkeys; i++) {
-        ret = sec_key_get_uuid(keys[i],
+    i = 0;
+    DLIST_FOR_EACH(entry, ucache->ccs) {
+        ret = sec_key_get_uuid(entry->key,
                                state->uuid_list[i]);
         if (ret != EOK) {
             goto immediate;
         }
+        i++;
     }
     /* Sentinel */
-    uuid_clear(state->uuid_list[nkeys]);
+    uuid_clear(state->uuid_list[i]);
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Listing all caches done\n");
     ret = EOK;
@@ -909,8 +1557,9 @@ static struct tevent_req *ccdb_secdb_getbyuuid_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_getbyuuid_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     errno_t ret;
-    char *secdb_key = NULL;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Getting ccache by UUID\n");
 
@@ -919,16 +1568,20 @@ static struct tevent_req *ccdb_secdb_getbyuuid_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = key_by_uuid(state, secdb->sctx, client, uuid, &secdb_key);
-    if (ret == ENOENT) {
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
+        goto immediate;
+    }
+
+    entry = secdb_uid_cc_by_uuid(ucache, uuid);
+    if (entry == NULL) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "No key matched\n");
         state->cc = NULL;
         ret = EOK;
         goto immediate;
-    } else if (ret != EOK) {
-        goto immediate;
     }
 
-    ret = secdb_get_cc(state, secdb->sctx, secdb_key, client, &state->cc);
+    ret = secdb_uid_copy_cc(state, secdb, client, entry, &state->cc);
     if (ret != EOK) {
         goto immediate;
     }
@@ -970,8 +1623,9 @@ static struct tevent_req *ccdb_secdb_getbyname_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_getbyname_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     errno_t ret;
-    char *secdb_key = NULL;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Getting ccache by name\n");
 
@@ -980,16 +1634,20 @@ static struct tevent_req *ccdb_secdb_getbyname_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = key_by_name(state, secdb->sctx, client, name, &secdb_key);
-    if (ret == ENOENT) {
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
+        goto immediate;
+    }
+
+    entry = secdb_uid_cc_by_name(ucache, name);
+    if (entry == NULL) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "No key matched\n");
         state->cc = NULL;
         ret = EOK;
         goto immediate;
-    } else if (ret != EOK) {
-        goto immediate;
     }
 
-    ret = secdb_get_cc(state, secdb->sctx, secdb_key, client, &state->cc);
+    ret = secdb_uid_copy_cc(state, secdb, client, entry, &state->cc);
     if (ret != EOK) {
         goto immediate;
     }
@@ -1032,8 +1690,9 @@ struct tevent_req *ccdb_secdb_name_by_uuid_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_name_by_uuid_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     errno_t ret;
-    char *key;
     const char *name;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Translating UUID to name\n");
@@ -1043,18 +1702,22 @@ struct tevent_req *ccdb_secdb_name_by_uuid_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = key_by_uuid(state, secdb->sctx, client, uuid, &key);
-    if (ret == ENOENT) {
-        ret = ERR_NO_CREDS;
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
         goto immediate;
-    } else if (ret != EOK) {
+    }
+
+    entry = secdb_uid_cc_by_uuid(ucache, uuid);
+    if (entry == NULL) {
+        ret = ERR_NO_CREDS;
         goto immediate;
     }
 
-    name = sec_key_get_name(key);
-    if (ret != EOK) {
+    name = sec_key_get_name(entry->key);
+    if (name == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Malformed key, cannot get name\n");
+        ret = EINVAL;
         goto immediate;
     }
 
@@ -1100,8 +1763,9 @@ struct tevent_req *ccdb_secdb_uuid_by_name_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_uuid_by_name_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     errno_t ret;
-    char *key;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Translating name to UUID\n");
 
@@ -1110,15 +1774,18 @@ struct tevent_req *ccdb_secdb_uuid_by_name_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = key_by_name(state, secdb->sctx, client, name, &key);
-    if (ret == ENOENT) {
-        ret = ERR_NO_CREDS;
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
         goto immediate;
-    } else if (ret != EOK) {
+    }
+
+    entry = secdb_uid_cc_by_name(ucache, name);
+    if (entry == NULL) {
+        ret = ERR_NO_CREDS;
         goto immediate;
     }
 
-    ret = sec_key_get_uuid(key, state->uuid);
+    ret = sec_key_get_uuid(entry->key, state->uuid);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
                 "Malformed key, cannot get UUID\n");
@@ -1158,11 +1825,15 @@ static struct tevent_req *ccdb_secdb_create_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct kcm_ccache *cc_copy;
     errno_t ret;
     struct sss_sec_req *container_req = NULL;
     struct sss_sec_req *ccache_req = NULL;
+    const char *key;
     const char *url;
     struct sss_iobuf *ccache_payload;
+    size_t num_merged;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Creating ccache storage for %s\n", cc->name);
 
@@ -1171,9 +1842,15 @@ static struct tevent_req *ccdb_secdb_create_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
+        goto immediate;
+    }
+
     /* Do the encoding asap so that if we fail, we don't even attempt any
      * writes */
-    ret = kcm_ccache_to_secdb_kv(state, cc, client, &url, &ccache_payload);
+    ret = kcm_ccache_to_secdb_kv(state, cc, client, &key, &url,
+                                 &ccache_payload);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Cannot convert cache %s to JSON [%d]: %s\n",
@@ -1192,8 +1869,10 @@ static struct tevent_req *ccdb_secdb_create_send(TALLOC_CTX *mem_ctx,
         DEBUG(SSSDBG_TRACE_INTERNAL, "Container already exists, ignoring\n");
     } else if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "Failed to create the ccache container\n");
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
+    ucache->has_container = true;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "ccache container created\n");
     DEBUG(SSSDBG_TRACE_INTERNAL, "creating empty ccache payload\n");
@@ -1204,11 +1883,29 @@ static struct tevent_req *ccdb_secdb_create_send(TALLOC_CTX *mem_ctx,
     }
 
     ret = sec_put(state, ccache_req, ccache_payload);
+    if (ret == ERR_SEC_INVALID_TOO_MANY_SECRETS) {
+        ret = secdb_uid_merge_logs(secdb, client, ucache, &num_merged);
+        if (ret == EOK && num_merged > 0) {
+            ret = sec_put(state, ccache_req, ccache_payload);
+        } else if (ret == EOK) {
+            ret = ERR_SEC_INVALID_TOO_MANY_SECRETS;
+        }
+    }
     if (ret != EOK) {
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "payload created\n");
+
+    cc_copy = kcm_cc_copy(ucache, cc);
+    if (cc_copy == NULL
+            || secdb_uid_add_cc(ucache, key, cc_copy) != EOK) {
+        /* The ccache is stored, it is just not cached */
+        talloc_free(cc_copy);
+        secdb_uid_drop(secdb, client);
+    }
+
     ret = EOK;
 immediate:
     if (ret == EOK) {
@@ -1236,11 +1933,10 @@ static struct tevent_req *ccdb_secdb_mod_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_state *state = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     errno_t ret;
-    char *secdb_key = NULL;
     struct kcm_ccache *cc = NULL;
-    struct sss_iobuf *payload = NULL;
-    struct sss_sec_req *sreq = NULL;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Modifying ccache\n");
 
@@ -1249,15 +1945,20 @@ static struct tevent_req *ccdb_secdb_mod_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = key_by_uuid(state, secdb->sctx, client, uuid, &secdb_key);
-    if (ret == ENOENT) {
-        ret = ERR_NO_CREDS;
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
         goto immediate;
-    } else if (ret != EOK) {
+    }
+
+    entry = secdb_uid_cc_by_uuid(ucache, uuid);
+    if (entry == NULL) {
+        ret = ERR_NO_CREDS;
         goto immediate;
     }
 
-    ret = secdb_get_cc(state, secdb->sctx, secdb_key, client, &cc);
+    /* Modify a copy, the cached ccache is replaced once the database
+     * is updated */
+    ret = secdb_uid_copy_cc(state, secdb, client, entry, &cc);
     if (ret != EOK) {
         goto immediate;
     }
@@ -1270,20 +1971,14 @@ static struct tevent_req *ccdb_secdb_mod_send(TALLOC_CTX *mem_ctx,
         goto immediate;
     }
 
-    ret = kcm_ccache_to_sec_input_binary(state, cc, &payload);
-    if (ret != EOK) {
-        goto immediate;
-    }
-
-    ret = secdb_cc_key_req(state, secdb->sctx, client, secdb_key, &sreq);
+    ret = secdb_cc_write(secdb, client, entry, cc);
     if (ret != EOK) {
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
 
-    ret = sec_update(state, sreq, payload);
-    if (ret != EOK) {
-        goto immediate;
-    }
+    talloc_free(entry->cc);
+    entry->cc = talloc_steal(entry, cc);
 
     ret = EOK;
 immediate:
@@ -1312,10 +2007,11 @@ static struct tevent_req *ccdb_secdb_store_cred_send(TALLOC_CTX *mem_ctx,
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
     struct tevent_req *req = NULL;
     struct ccdb_secdb_state *state = NULL;
-    char *secdb_key = NULL;
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     struct kcm_ccache *cc = NULL;
-    struct sss_iobuf *payload = NULL;
-    struct sss_sec_req *sreq = NULL;
+    struct kcm_cred *crd;
+    uuid_t cred_uuid;
     errno_t ret;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Storing creds in ccache\n");
@@ -1325,42 +2021,59 @@ static struct tevent_req *ccdb_secdb_store_cred_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = key_by_uuid(state, secdb->sctx, client, uuid, &secdb_key);
-    if (ret == ENOENT) {
-        ret = ERR_NO_CREDS;
-        goto immediate;
-    } else if (ret != EOK) {
+    ret = secdb_uid_get(secdb, client, &ucache);
+    if (ret != EOK) {
         goto immediate;
     }
 
-    ret = secdb_get_cc(state, secdb->sctx, secdb_key, client, &cc);
-    if (ret != EOK) {
+    entry = secdb_uid_cc_by_uuid(ucache, uuid);
+    if (entry == NULL) {
+        ret = ERR_NO_CREDS;
         goto immediate;
     }
 
-    ret = kcm_cc_store_cred_blob(cc, cred_blob);
+    ret = secdb_uid_copy_cc(state, secdb, client, entry, &cc);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Cannot store credentials to ccache [%d]: %s\n",
-              ret, sss_strerror(ret));
         goto immediate;
     }
 
-    ret = kcm_ccache_to_sec_input_binary(state, cc, &payload);
-    if (ret != EOK) {
+    uuid_generate(cred_uuid);
+    crd = kcm_cred_new(cc, cred_uuid, cred_blob);
+    if (crd == NULL) {
+        ret = ENOMEM;
         goto immediate;
     }
 
-    ret = secdb_cc_key_req(state, secdb->sctx, client, secdb_key, &sreq);
+    ret = kcm_cc_store_creds(cc, crd);
     if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot store credentials to ccache [%d]: %s\n",
+              ret, sss_strerror(ret));
         goto immediate;
     }
 
-    ret = sec_update(state, sreq, payload);
+    /* Only the new credential is written unless there are enough of
+     * them to merge them into the ccache record */
+    if (entry->num_log < KCM_SECDB_CREDLOG_MAX) {
+        ret = secdb_cc_append_cred(secdb, client, ucache, entry, crd);
+        if (ret == ERR_SEC_INVALID_TOO_MANY_SECRETS) {
+            DEBUG(SSSDBG_TRACE_FUNC, "No room for another credential "
+                  "record, rewriting the ccache\n");
+            ret = secdb_cc_write(secdb, client, entry, cc);
+        }
+    } else {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "Merging %zu appended credentials "
+              "into the ccache\n", entry->num_log);
+        ret = secdb_cc_write(secdb, client, entry, cc);
+    }
     if (ret != EOK) {
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
 
+    talloc_free(entry->cc);
+    entry->cc = talloc_steal(entry, cc);
+
     ret = EOK;
 immediate:
     if (ret == EOK) {
@@ -1387,11 +2100,11 @@ static struct tevent_req *ccdb_secdb_delete_send(TALLOC_CTX *mem_ctx,
     struct tevent_req *req = NULL;
     struct ccdb_secdb_state *state = NULL;
     struct ccdb_secdb *secdb = talloc_get_type(db->db_handle, struct ccdb_secdb);
+    struct ccdb_secdb_uid *ucache;
+    struct ccdb_secdb_cc *entry;
     struct sss_sec_req *container_req = NULL;
     struct sss_sec_req *sreq = NULL;
-    char *secdb_key = NULL;
-    char **keys = NULL;
-    size_t nkeys;
+    const char *url;
     errno_t ret;
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Deleting ccache\n");
@@ -1401,52 +2114,89 @@ static struct tevent_req *ccdb_secdb_delete_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    ret = secdb_container_url_req(state, secdb->sctx, client, &container_req);
+    ret = secdb_uid_get(secdb, client, &ucache);
     if (ret != EOK) {
         goto immediate;
     }
 
-    ret = sss_sec_list(state, container_req, &keys, &nkeys);
-    if (ret != EOK) {
+    if (!ucache->has_container) {
         DEBUG(SSSDBG_MINOR_FAILURE, "No ccaches to delete\n");
+        ret = ENOENT;
         goto immediate;
     }
-    DEBUG(SSSDBG_TRACE_INTERNAL, "Found %zu ccaches\n", nkeys);
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Found %zu ccaches\n", ucache->num_ccs);
 
-    if (nkeys == 0) {
+    if (ucache->num_ccs == 0) {
         ret = EOK;
         goto immediate;
     }
 
-    ret = key_by_uuid(state, secdb->sctx, client, uuid, &secdb_key);
-    if (ret == ENOENT) {
+    entry = secdb_uid_cc_by_uuid(ucache, uuid);
+    if (entry == NULL) {
         ret = ERR_NO_CREDS;
         goto immediate;
-    } else if (ret != EOK) {
+    }
+
+    ret = secdb_cc_delete_log(secdb, client, entry);
+    if (ret != EOK) {
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
 
-    ret = secdb_cc_key_req(state, secdb->sctx, client, secdb_key, &sreq);
+    ret = secdb_cc_key_req(state, secdb->sctx, client, entry->key, &sreq);
     if (ret != EOK) {
         goto immediate;
     }
 
     ret = sss_sec_delete(sreq);
     if (ret != EOK) {
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
 
-    if (nkeys > 1) {
+    secdb_uid_remove_cc(ucache, entry);
+
+    if (ucache->num_ccs > 0) {
         DEBUG(SSSDBG_TRACE_INTERNAL, "There are other ccaches, done\n");
         ret = EOK;
         goto immediate;
     }
     DEBUG(SSSDBG_TRACE_INTERNAL, "Removing ccache container\n");
 
+    ret = secdb_container_url_req(state, secdb->sctx, client, &container_req);
+    if (ret != EOK) {
+        goto immediate;
+    }
+
     ret = sss_sec_delete(container_req);
     if (ret != EOK) {
+        secdb_uid_drop(secdb, client);
         goto immediate;
     }
+    ucache->has_container = false;
+
+    if (ucache->has_log_container) {
+        url = secdb_log_container_url_create(state, client);
+        if (url == NULL) {
+            ret = ENOMEM;
+            goto immediate;
+        }
+
+        ret = secdb_cc_url_req(state, secdb->sctx, client, url,
+                               &container_req);
+        if (ret != EOK) {
+            goto immediate;
+        }
+
+        ret = sss_sec_delete(container_req);
+        if (ret != EOK && ret != ENOENT) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot remove the credentials container [%d]: %s\n",
+                  ret, sss_strerror(ret));
+        } else {
+            ucache->has_log_container = false;
+        }
+    }
 
     ret = EOK;
 immediate:
@@ -35,6 +35,9 @@
 /* The return code is 32bits */
 #define KCM_RETCODE_SIZE 4
 
+/* Length, return code, return code of the operation and its output */
+#define KCM_REPLY_IOVECS 4
+
 /* The maximum length of a request or reply as defined by the RPC
  * protocol. This is the same constant size as MIT KRB5 uses
  */
@@ -44,6 +47,7 @@
 struct kcm_op_io {
     struct kcm_op *op;
     struct kcm_data request;
+    krb5_error_code kerr;
     struct sss_iobuf *reply;
 };
 
@@ -101,9 +105,60 @@ static errno_t kcm_read_iovec(int fd, struct kcm_iovec *kiov)
     return kcm_iovec_op(fd, kiov, true);
 }
 
-static errno_t kcm_write_iovec(int fd, struct kcm_iovec *kiov)
+/* Writes as much of the iovectors as possible with a single writev() call,
+ * returns EAGAIN until all of them were written */
+static errno_t kcm_write_iovecs(int fd, struct kcm_iovec **kiovs,
+                                size_t count)
 {
-    return kcm_iovec_op(fd, kiov, false);
+    struct iovec iov[KCM_REPLY_IOVECS];
+    size_t niov = 0;
+    ssize_t len;
+    size_t n;
+    size_t i;
+
+    if (count > KCM_REPLY_IOVECS) {
+        return EINVAL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (kiovs[i]->nprocessed < kiovs[i]->kiov_len) {
+            iov[niov].iov_base = kiovs[i]->kiov_base + kiovs[i]->nprocessed;
+            iov[niov].iov_len = kiovs[i]->kiov_len - kiovs[i]->nprocessed;
+            niov++;
+        }
+    }
+
+    if (niov == 0) {
+        return EOK;
+    }
+
+    len = writev(fd, iov, niov);
+    if (len == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return EAGAIN;
+        } else {
+            return errno;
+        }
+    }
+
+    if (len == 0) {
+        return ENODATA;
+    }
+
+    /* The bytes were written in the order of the iovectors */
+    for (i = 0; i < count && len > 0; i++) {
+        n = MIN((size_t)len, kiovs[i]->kiov_len - kiovs[i]->nprocessed);
+        kiovs[i]->nprocessed += n;
+        len -= n;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (kiovs[i]->nprocessed < kiovs[i]->kiov_len) {
+            return EAGAIN;
+        }
+    }
+
+    return EOK;
 }
 
 /**
@@ -229,6 +284,10 @@ static errno_t kcm_input_parse(struct kcm_reqbuf *reqbuf,
  *  The client always reads the length and return code iovectors. However, the
  *  client reads the reply iovec only if retcode is 0 in the return code iovector
  *  (see kcmio_unix_socket_read() in the MIT tree)
+ *
+ *  The server keeps the return code of the operation and the rest of the
+ *  message in two separate iovectors and sends all of them with writev(), so
+ *  the reply buffer of the operation is sent without copying it.
  */
 struct kcm_repbuf {
     uint8_t lenbuf[KCM_MSG_LEN_SIZE];
@@ -237,6 +296,9 @@ struct kcm_repbuf {
     uint8_t rcbuf[KCM_RETCODE_SIZE];
     struct kcm_iovec v_rc;
 
+    uint8_t opbuf[KCM_RETCODE_SIZE];
+    struct kcm_iovec v_op;
+
     struct kcm_iovec v_msg;
 };
 
@@ -250,6 +312,10 @@ static errno_t kcm_failbuf_construct(errno_t ret,
     c = 0;
     SAFEALIGN_SETMEM_UINT32(repbuf->rcbuf, htobe32(ret), &c);
 
+    /* the client does not read the message on failure */
+    repbuf->v_op.kiov_len = 0;
+    repbuf->v_msg.kiov_len = 0;
+
     DEBUG(SSSDBG_TRACE_LIBS, "Sent reply with error %d\n", ret);
     return EOK;
 }
@@ -257,15 +323,14 @@ static errno_t kcm_failbuf_construct(errno_t ret,
 /* retcode is 0 if the operation at least ran, non-zero if there
  * was some kind of internal KCM error, like input couldn't be parsed
  */
-static errno_t kcm_output_construct(TALLOC_CTX *mem_ctx,
-                                    struct kcm_op_io *op_io,
+static errno_t kcm_output_construct(struct kcm_op_io *op_io,
                                     struct kcm_repbuf *repbuf)
 {
-    uint8_t *rep;
     size_t replen;
     size_t c;
 
-    replen = sss_iobuf_get_len(op_io->reply);
+    /* the return code of the operation and its output */
+    replen = KCM_RETCODE_SIZE + sss_iobuf_get_len(op_io->reply);
     if (replen > KCM_PACKET_MAX_SIZE) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Reply exceeds the KCM protocol limit, aborting\n");
@@ -280,25 +345,13 @@ static errno_t kcm_output_construct(TALLOC_CTX *mem_ctx,
     c = 0;
     SAFEALIGN_SETMEM_UINT32(repbuf->rcbuf, 0, &c);
 
-    if (replen > 0) {
-        rep = talloc_zero_array(mem_ctx, uint8_t, replen);
-        if (rep == NULL) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Failed to allocate memory for the message\n");
-            return ENOMEM;
-        }
+    c = 0;
+    SAFEALIGN_SETMEM_UINT32(repbuf->opbuf, htobe32(op_io->kerr), &c);
+    repbuf->v_op.kiov_len = KCM_RETCODE_SIZE;
 
-        c = 0;
-        SAFEALIGN_MEMCPY_CHECK(rep,
-                               sss_iobuf_get_data(op_io->reply),
-                               replen,
-                               replen,
-                               &c);
-
-        /* Set the buffer and its length to send to KCM client */
-        repbuf->v_msg.kiov_base = rep;
-        repbuf->v_msg.kiov_len = replen;
-    }
+    /* The reply buffer is owned by the request and sent in place */
+    repbuf->v_msg.kiov_base = sss_iobuf_get_data(op_io->reply);
+    repbuf->v_msg.kiov_len = sss_iobuf_get_len(op_io->reply);
 
     return EOK;
 }
@@ -355,7 +408,7 @@ static void kcm_send_reply(struct kcm_req_ctx *req_ctx)
 
     cctx = req_ctx->cctx;
 
-    ret = kcm_output_construct(cctx, &req_ctx->op_io, &req_ctx->repbuf);
+    ret = kcm_output_construct(&req_ctx->op_io, &req_ctx->repbuf);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Cannot construct the reply buffer, terminating client\n");
@@ -403,6 +456,7 @@ static void kcm_cmd_request_done(struct tevent_req *req)
     req_ctx = tevent_req_callback_data(req, struct kcm_req_ctx);
 
     ret = kcm_cmd_recv(req_ctx, req,
+                       &req_ctx->op_io.kerr,
                        &req_ctx->op_io.reply);
     talloc_free(req);
     if (ret != EOK) {
@@ -482,6 +536,8 @@ static struct kcm_req_ctx *kcm_new_req(struct cli_ctx *cctx,
     req->repbuf.v_rc.kiov_base = req->repbuf.rcbuf;
     req->repbuf.v_rc.kiov_len = KCM_RETCODE_SIZE;
 
+    req->repbuf.v_op.kiov_base = req->repbuf.opbuf;
+
     req->cctx = cctx;
     req->kctx = kctx;
 
@@ -569,35 +625,24 @@ fail:
 static int kcm_send_data(struct cli_ctx *cctx)
 {
     struct kcm_req_ctx *req;
+    struct kcm_iovec *kiovs[KCM_REPLY_IOVECS];
     errno_t ret;
 
     req = talloc_get_type(cctx->protocol_ctx, struct kcm_req_ctx);
 
-    ret = kcm_write_iovec(cctx->cfd, &req->repbuf.v_len);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Failed to write the length iovec [%d]: %s\n",
-              ret, sss_strerror(ret));
-        return ret;
-    }
+    kiovs[0] = &req->repbuf.v_len;
+    kiovs[1] = &req->repbuf.v_rc;
+    kiovs[2] = &req->repbuf.v_op;
+    kiovs[3] = &req->repbuf.v_msg;
 
-    ret = kcm_write_iovec(cctx->cfd, &req->repbuf.v_rc);
-    if (ret != EOK) {
+    ret = kcm_write_iovecs(cctx->cfd, kiovs, KCM_REPLY_IOVECS);
+    if (ret != EOK && ret != EAGAIN) {
         DEBUG(SSSDBG_CRIT_FAILURE,
-              "Failed to write the retcode iovec [%d]: %s\n",
+              "Failed to write the reply [%d]: %s\n",
               ret, sss_strerror(ret));
-        return ret;
     }
 
-    ret = kcm_write_iovec(cctx->cfd, &req->repbuf.v_msg);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Failed to write the msg iovec [%d]: %s\n",
-              ret, sss_strerror(ret));
-        return ret;
-    }
-
-    return EOK;
+    return ret;
 }
 
 static void kcm_send(struct cli_ctx *cctx)
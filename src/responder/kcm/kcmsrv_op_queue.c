@@ -28,6 +28,12 @@ struct kcm_ops_queue_entry {
 
     struct kcm_ops_queue *queue;
 
+    /* Read-only requests run together, a request that modifies the
+     * ccaches runs alone */
+    bool readonly;
+    bool running;
+    struct timeval enqueued;
+
     struct kcm_ops_queue_entry *next;
     struct kcm_ops_queue_entry *prev;
 };
@@ -54,6 +60,11 @@ struct kcm_ops_queue_ctx {
  * hash table entry is kcm_ops_queue structure which in turn contains a
  * linked list of kcm_ops_queue_entry structures * which primarily hold the
  * tevent request being queued.
+ *
+ * The requests run in the order they were queued. The running requests are
+ * always at the start of the list, they are either a single request that
+ * modifies the ccaches or any number of read-only requests. A read-only
+ * request does not pass a waiting writer, so writers are not starved.
  */
 struct kcm_ops_queue_ctx *kcm_ops_queue_create(TALLOC_CTX *mem_ctx,
                                                struct kcm_ctx *kctx)
@@ -116,9 +127,38 @@ void queue_removal_cb(struct tevent_context *ctx,
     talloc_free(kq);
 }
 
+/* Runs the waiting requests that may run now that the running ones
+ * changed. The callbacks are deferred to the next tevent tick because
+ * they might free other entries of the queue. */
+static void kcm_op_queue_run_next(struct kcm_ops_queue *kq)
+{
+    struct kcm_ops_queue_entry *entry;
+
+    DLIST_FOR_EACH(entry, kq->head) {
+        if (entry->running) {
+            if (!entry->readonly) {
+                return;
+            }
+            continue;
+        }
+
+        if (!entry->readonly && entry != kq->head) {
+            /* A writer waits until the readers ahead of it are done */
+            return;
+        }
+
+        entry->running = true;
+        tevent_req_defer_callback(entry->req, kq->ev);
+        tevent_req_done(entry->req);
+
+        if (!entry->readonly) {
+            return;
+        }
+    }
+}
+
 static int kcm_op_queue_entry_destructor(struct kcm_ops_queue_entry *entry)
 {
-    struct kcm_ops_queue_entry *next_entry;
     struct tevent_immediate *imm;
 
     if (entry == NULL) {
@@ -128,13 +168,10 @@ static int kcm_op_queue_entry_destructor(struct kcm_ops_queue_entry *entry)
         return 0;
     }
 
-    /* Take the next entry from the queue */
-    next_entry = entry->next;
-
     /* Remove the current entry from the queue */
     DLIST_REMOVE(entry->queue->head, entry);
 
-    if (next_entry == NULL) {
+    if (entry->queue->head == NULL) {
         /* If there was no other entry, schedule removal of the queue. Do it
          * in another tevent tick to avoid issues with callbacks invoking
          * the destructor while another request is touching the queue
@@ -148,8 +185,8 @@ static int kcm_op_queue_entry_destructor(struct kcm_ops_queue_entry *entry)
         return 0;
     }
 
-    /* Otherwise, mark the current head as done to run the next request */
-    tevent_req_done(next_entry->req);
+    /* Otherwise, run the requests that no longer have to wait */
+    kcm_op_queue_run_next(entry->queue);
     return 0;
 }
 
@@ -220,22 +257,25 @@ struct kcm_op_queue_state {
 };
 
 static errno_t kcm_op_queue_add_req(struct kcm_ops_queue *kq,
-                                    struct tevent_req *req);
+                                    struct tevent_req *req,
+                                    bool readonly);
 
 /*
  * Enqueue a request.
  *
- * If the request queue /for the given ID/ is empty, that is, if this
- * request is the first one in the queue, run the request immediately.
+ * If the request queue /for the given ID/ is empty, or if this request is
+ * read-only and only read-only requests are running, run the request
+ * immediately.
  *
- * Otherwise just add it to the queue and wait until the previous request
- * finishes and only at that point mark the current request as done, which
+ * Otherwise just add it to the queue and wait until the previous requests
+ * finish and only at that point mark the current request as done, which
  * will trigger calling the recv function and allow the request to continue.
  */
 struct tevent_req *kcm_op_queue_send(TALLOC_CTX *mem_ctx,
                                      struct tevent_context *ev,
                                      struct kcm_ops_queue_ctx *qctx,
-                                     struct cli_creds *client)
+                                     struct cli_creds *client,
+                                     bool readonly)
 {
     errno_t ret;
     struct tevent_req *req;
@@ -251,7 +291,8 @@ struct tevent_req *kcm_op_queue_send(TALLOC_CTX *mem_ctx,
     }
 
     DEBUG(SSSDBG_FUNC_DATA,
-          "Adding request by %"SPRIuid" to the wait queue\n", uid);
+          "Adding %s request by %"SPRIuid" to the wait queue\n",
+          readonly ? "read-only" : "write", uid);
 
     kq = kcm_op_queue_get(qctx, ev, uid);
     if (kq == NULL) {
@@ -261,10 +302,10 @@ struct tevent_req *kcm_op_queue_send(TALLOC_CTX *mem_ctx,
         goto immediate;
     }
 
-    ret = kcm_op_queue_add_req(kq, req);
+    ret = kcm_op_queue_add_req(kq, req, readonly);
     if (ret == EOK) {
         DEBUG(SSSDBG_TRACE_LIBS,
-              "Queue was empty, running the request immediately\n");
+              "No conflicting request, running the request immediately\n");
         goto immediate;
     } else if (ret != EAGAIN) {
         DEBUG(SSSDBG_OP_FAILURE,
@@ -286,9 +327,11 @@ immediate:
 }
 
 static errno_t kcm_op_queue_add_req(struct kcm_ops_queue *kq,
-                                    struct tevent_req *req)
+                                    struct tevent_req *req,
+                                    bool readonly)
 {
     errno_t ret;
+    struct kcm_ops_queue_entry *entry;
     struct kcm_op_queue_state *state = tevent_req_data(req,
                                                 struct kcm_op_queue_state);
 
@@ -298,16 +341,23 @@ static errno_t kcm_op_queue_add_req(struct kcm_ops_queue *kq,
     }
     state->entry->req = req;
     state->entry->queue = kq;
+    state->entry->readonly = readonly;
+    state->entry->enqueued = tevent_timeval_current();
     talloc_set_destructor(state->entry, kcm_op_queue_entry_destructor);
 
-    if (kq->head == NULL) {
-        /* First entry, will run callback at once */
-        ret = EOK;
-    } else {
-        /* Will wait for the previous callbacks to finish */
-        ret = EAGAIN;
+    /* First entry, will run callback at once. A read-only entry also runs
+     * at once if only read-only entries are queued, since they are all
+     * running. */
+    ret = EOK;
+    DLIST_FOR_EACH(entry, kq->head) {
+        if (!readonly || !entry->readonly) {
+            /* Will wait for the previous callbacks to finish */
+            ret = EAGAIN;
+            break;
+        }
     }
 
+    state->entry->running = (ret == EOK);
     DLIST_ADD_END(kq->head, state->entry, struct kcm_ops_queue_entry *);
     return ret;
 }
@@ -317,16 +367,27 @@ static errno_t kcm_op_queue_add_req(struct kcm_ops_queue *kq,
  * entry should be allocated on the same memory context as the enqueued request
  * to trigger freeing the kcm_ops_queue_entry structure destructor when the
  * parent request is done and its tevent_req freed. This would in turn unblock
- * the next request in the queue
+ * the next request in the queue. The time the request waited in the queue
+ * is returned in _wait_usec if it is not NULL.
  */
 errno_t kcm_op_queue_recv(struct tevent_req *req,
                           TALLOC_CTX *mem_ctx,
-                          struct kcm_ops_queue_entry **_entry)
+                          struct kcm_ops_queue_entry **_entry,
+                          uint64_t *_wait_usec)
 {
     struct kcm_op_queue_state *state = tevent_req_data(req,
                                                 struct kcm_op_queue_state);
+    struct timeval now;
+    struct timeval wait;
 
     TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    if (_wait_usec != NULL) {
+        now = tevent_timeval_current();
+        wait = tevent_timeval_until(&state->entry->enqueued, &now);
+        *_wait_usec = (uint64_t)wait.tv_sec * 1000000 + wait.tv_usec;
+    }
+
     *_entry = talloc_steal(mem_ctx, state->entry);
     return EOK;
 }
@@ -38,6 +38,9 @@
  */
 #define KCM_REPLY_MAX 10*1024*1024
 
+/* Most replies are small, the reply buffer grows when needed */
+#define KCM_REPLY_INITIAL_SIZE 1024
+
 struct kcm_op_ctx {
     struct kcm_resp_ctx *kcm_data;
     struct kcm_conn_data *conn_data;
@@ -69,6 +72,9 @@ struct kcm_op {
     const char *name;
     kcm_srv_send_method fn_send;
     kcm_srv_recv_method fn_recv;
+    /* The operation does not modify any ccache, so it can run at the same
+     * time as other read-only operations of the same user */
+    bool readonly;
 };
 
 struct kcm_cmd_state {
@@ -77,7 +83,6 @@ struct kcm_cmd_state {
 
     struct kcm_ops_queue_entry *queue_entry;
     struct kcm_op_ctx *op_ctx;
-    struct sss_iobuf *reply;
 
     uint32_t op_ret;
 };
@@ -114,14 +119,6 @@ struct tevent_req *kcm_cmd_send(TALLOC_CTX *mem_ctx,
     DEBUG(SSSDBG_TRACE_FUNC, "KCM operation %s\n", op->name);
     DEBUG(SSSDBG_TRACE_LIBS, "%zu bytes on KCM input\n", input->length);
 
-    state->reply = sss_iobuf_init_empty(state,
-                                        KCM_REPLY_MAX,
-                                        KCM_REPLY_MAX);
-    if (state->reply == NULL) {
-        ret = ENOMEM;
-        goto immediate;
-    }
-
     if (op->fn_send == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "KCM op %s has no handler\n", kcm_opt_name(op));
@@ -142,9 +139,11 @@ struct tevent_req *kcm_cmd_send(TALLOC_CTX *mem_ctx,
     state->op_ctx->conn_data = conn_data;
     state->op_ctx->client = client;
 
-    state->op_ctx->input = sss_iobuf_init_readonly(state->op_ctx,
-                                                   input->data,
-                                                   input->length);
+    /* The request buffer belongs to the caller and outlives the
+     * operation, there is no need to copy it */
+    state->op_ctx->input = sss_iobuf_init_view(state->op_ctx,
+                                               input->data,
+                                               input->length);
     if (state->op_ctx->input == NULL) {
         ret = ENOMEM;
         goto immediate;
@@ -153,21 +152,20 @@ struct tevent_req *kcm_cmd_send(TALLOC_CTX *mem_ctx,
     /*
      * The internal operation returns the opcode and the buffer separately.
      * The KCM server reply to the client also always contains zero if the
-     * operation ran to completion, both are uint32_t.
-     * FIXME:
-     * Alternatively, we could extend iobuf API so that we can just pass
-     * the reply's buffer+sizeof(2*uint32_t) and avoid the useless allocations
+     * operation ran to completion, both are uint32_t. The caller sends them
+     * together with the buffer using scatter writes, so the buffer is
+     * never copied into a larger one.
      */
     state->op_ctx->reply = sss_iobuf_init_empty(
                                         state,
-                                        KCM_REPLY_MAX - 2*sizeof(uint32_t),
+                                        KCM_REPLY_INITIAL_SIZE,
                                         KCM_REPLY_MAX - 2*sizeof(uint32_t));
-    if (state->reply == NULL) {
+    if (state->op_ctx->reply == NULL) {
         ret = ENOMEM;
         goto immediate;
     }
 
-    subreq = kcm_op_queue_send(state, ev, qctx, client);
+    subreq = kcm_op_queue_send(state, ev, qctx, client, op->readonly);
     if (subreq == NULL) {
         ret = ENOMEM;
         goto immediate;
@@ -185,12 +183,13 @@ static void kcm_cmd_queue_done(struct tevent_req *subreq)
 {
     struct tevent_req *req = tevent_req_callback_data(subreq, struct tevent_req);
     struct kcm_cmd_state *state = tevent_req_data(req, struct kcm_cmd_state);
+    uint64_t wait_usec;
     errno_t ret;
 
     /* When this request finishes, it frees the queue_entry which unblocks
      * other requests by the same UID
      */
-    ret = kcm_op_queue_recv(subreq, state, &state->queue_entry);
+    ret = kcm_op_queue_recv(subreq, state, &state->queue_entry, &wait_usec);
     talloc_zfree(subreq);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Cannot acquire queue slot\n");
@@ -198,6 +197,10 @@ static void kcm_cmd_queue_done(struct tevent_req *subreq)
         return;
     }
 
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "KCM operation %s waited %"PRIu64" us in the queue\n",
+          kcm_opt_name(state->op), wait_usec);
+
     subreq = state->op->fn_send(state, state->ev, state->op_ctx);
     if (subreq == NULL) {
         tevent_req_error(req, ENOMEM);
@@ -211,7 +214,6 @@ static void kcm_cmd_done(struct tevent_req *subreq)
     struct tevent_req *req = tevent_req_callback_data(subreq, struct tevent_req);
     struct kcm_cmd_state *state = tevent_req_data(req, struct kcm_cmd_state);
     errno_t ret;
-    krb5_error_code kerr;
 
     ret = state->op->fn_recv(subreq, &state->op_ret);
     talloc_free(subreq);
@@ -227,28 +229,12 @@ static void kcm_cmd_done(struct tevent_req *subreq)
           "KCM operation %s returned [%d]: %s\n",
           kcm_opt_name(state->op), state->op_ret, sss_strerror(state->op_ret));
 
-    kerr = sss2krb5_error(state->op_ret);
-
-    /* The first four bytes of the reply is the operation status code */
-    ret = sss_iobuf_write_uint32(state->reply, htobe32(kerr));
-    if (ret != EOK) {
-        tevent_req_error(req, ret);
-        return;
-    }
-
-    ret = sss_iobuf_write_len(state->reply,
-                              sss_iobuf_get_data(state->op_ctx->reply),
-                              sss_iobuf_get_len(state->op_ctx->reply));
-    if (ret != EOK) {
-        tevent_req_error(req, ret);
-        return;
-    }
-
     tevent_req_done(req);
 }
 
 errno_t kcm_cmd_recv(TALLOC_CTX *mem_ctx,
                      struct tevent_req *req,
+                     krb5_error_code *_kerr,
                      struct sss_iobuf **_reply)
 {
     struct kcm_cmd_state *state = NULL;
@@ -257,7 +243,8 @@ errno_t kcm_cmd_recv(TALLOC_CTX *mem_ctx,
 
     state = tevent_req_data(req, struct kcm_cmd_state);
 
-    *_reply = talloc_steal(mem_ctx, state->reply);
+    *_kerr = sss2krb5_error(state->op_ret);
+    *_reply = talloc_steal(mem_ctx, state->op_ctx->reply);
     return EOK;
 }
 
@@ -1420,6 +1407,122 @@ static errno_t kcm_op_get_cred_by_uuid_recv(struct tevent_req *req,
     return EOK;
 }
 
+/* (name) -> (count, count*{len, cred}) */
+static void kcm_op_get_cred_list_getbyname_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+kcm_op_get_cred_list_send(TALLOC_CTX *mem_ctx,
+                          struct tevent_context *ev,
+                          struct kcm_op_ctx *op_ctx)
+{
+    struct tevent_req *req = NULL;
+    struct tevent_req *subreq = NULL;
+    struct kcm_op_common_state *state = NULL;
+    errno_t ret;
+    const char *name;
+
+    req = tevent_req_create(mem_ctx, &state, struct kcm_op_common_state);
+    if (req == NULL) {
+        return NULL;
+    }
+    state->op_ctx = op_ctx;
+
+    ret = sss_iobuf_read_stringz(op_ctx->input, &name);
+    if (ret != EOK) {
+        goto immediate;
+    }
+
+    DEBUG(SSSDBG_TRACE_LIBS, "Returning credentials for %s\n", name);
+
+    subreq = kcm_ccdb_getbyname_send(state, ev,
+                                     op_ctx->kcm_data->db,
+                                     op_ctx->client,
+                                     name);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto immediate;
+    }
+    tevent_req_set_callback(subreq, kcm_op_get_cred_list_getbyname_done, req);
+    return req;
+
+immediate:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static void kcm_op_get_cred_list_getbyname_done(struct tevent_req *subreq)
+{
+    errno_t ret;
+    struct kcm_ccache *cc;
+    struct kcm_cred *crd;
+    struct sss_iobuf *cred_blob;
+    uint32_t num_creds = 0;
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct kcm_op_common_state *state = tevent_req_data(req,
+                                                struct kcm_op_common_state);
+
+    ret = kcm_ccdb_getbyname_recv(subreq, state, &cc);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get ccache by name [%d]: %s\n",
+              ret, sss_strerror(ret));
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    if (cc == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "No ccache by that name\n");
+        state->op_ret = ERR_NO_CREDS;
+        tevent_req_done(req);
+        return;
+    }
+
+    for (crd = kcm_cc_get_cred(cc);
+         crd != NULL;
+         crd = kcm_cc_next_cred(crd)) {
+        if (kcm_cred_get_creds(crd) != NULL) {
+            num_creds++;
+        }
+    }
+
+    ret = sss_iobuf_write_uint32(state->op_ctx->reply, htobe32(num_creds));
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    for (crd = kcm_cc_get_cred(cc);
+         crd != NULL;
+         crd = kcm_cc_next_cred(crd)) {
+        cred_blob = kcm_cred_get_creds(crd);
+        if (cred_blob == NULL) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Credentials lack the creds blob, skipping\n");
+            continue;
+        }
+
+        ret = sss_iobuf_write_uint32(state->op_ctx->reply,
+                                     htobe32(sss_iobuf_get_size(cred_blob)));
+        if (ret != EOK) {
+            tevent_req_error(req, ret);
+            return;
+        }
+
+        ret = kcm_op_get_cred_by_uuid_reply(crd, state->op_ctx->reply);
+        if (ret != EOK) {
+            tevent_req_error(req, ret);
+            return;
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_LIBS, "Returned %"PRIu32" credentials\n", num_creds);
+    state->op_ret = EOK;
+    tevent_req_done(req);
+}
+
 /* (name, flags, credtag) -> () */
 /* FIXME */
 static struct tevent_req *
@@ -2265,37 +2368,45 @@ static errno_t kcm_op_set_kdc_offset_recv(struct tevent_req *req,
 }
 
 static struct kcm_op kcm_optable[] = {
-    { "NOOP",                NULL, NULL },
-    { "GET_NAME",            NULL, NULL },
-    { "RESOLVE",             NULL, NULL },
-    { "GEN_NEW",             kcm_op_gen_new_send, NULL },
-    { "INITIALIZE",          kcm_op_initialize_send, kcm_op_initialize_recv },
-    { "DESTROY",             kcm_op_destroy_send, NULL },
-    { "STORE",               kcm_op_store_send, kcm_op_store_recv },
-    { "RETRIEVE",            NULL, NULL },
-    { "GET_PRINCIPAL",       kcm_op_get_principal_send, NULL },
-    { "GET_CRED_UUID_LIST",  kcm_op_get_cred_uuid_list_send, NULL },
-    { "GET_CRED_BY_UUID",    kcm_op_get_cred_by_uuid_send, kcm_op_get_cred_by_uuid_recv },
-    { "REMOVE_CRED",         kcm_op_remove_cred_send, NULL },
-    { "SET_FLAGS",           NULL, NULL },
-    { "CHOWN",               NULL, NULL },
-    { "CHMOD",               NULL, NULL },
-    { "GET_INITIAL_TICKET",  NULL, NULL },
-    { "GET_TICKET",          NULL, NULL },
-    { "MOVE_CACHE",          NULL, NULL },
-    { "GET_CACHE_UUID_LIST", kcm_op_get_cache_uuid_list_send, NULL },
-    { "GET_CACHE_BY_UUID",   kcm_op_get_cache_by_uuid_send, NULL },
-    { "GET_DEFAULT_CACHE",   kcm_op_get_default_ccache_send, kcm_op_get_default_ccache_recv },
-    { "SET_DEFAULT_CACHE",   kcm_op_set_default_ccache_send, kcm_op_set_default_ccache_recv },
-    { "GET_KDC_OFFSET",      kcm_op_get_kdc_offset_send, NULL },
-    { "SET_KDC_OFFSET",      kcm_op_set_kdc_offset_send, kcm_op_set_kdc_offset_recv },
-    { "ADD_NTLM_CRED",       NULL, NULL },
-    { "HAVE_NTLM_CRED",      NULL, NULL },
-    { "DEL_NTLM_CRED",       NULL, NULL },
-    { "DO_NTLM_AUTH",        NULL, NULL },
-    { "GET_NTLM_USER_LIST",  NULL, NULL },
-
-    { NULL, NULL, NULL }
+    { "NOOP",                NULL, NULL, false },
+    { "GET_NAME",            NULL, NULL, false },
+    { "RESOLVE",             NULL, NULL, false },
+    { "GEN_NEW",             kcm_op_gen_new_send, NULL, false },
+    { "INITIALIZE",          kcm_op_initialize_send, kcm_op_initialize_recv, false },
+    { "DESTROY",             kcm_op_destroy_send, NULL, false },
+    { "STORE",               kcm_op_store_send, kcm_op_store_recv, false },
+    { "RETRIEVE",            NULL, NULL, false },
+    { "GET_PRINCIPAL",       kcm_op_get_principal_send, NULL, true },
+    { "GET_CRED_UUID_LIST",  kcm_op_get_cred_uuid_list_send, NULL, true },
+    { "GET_CRED_BY_UUID",    kcm_op_get_cred_by_uuid_send, kcm_op_get_cred_by_uuid_recv, true },
+    { "REMOVE_CRED",         kcm_op_remove_cred_send, NULL, false },
+    { "SET_FLAGS",           NULL, NULL, false },
+    { "CHOWN",               NULL, NULL, false },
+    { "CHMOD",               NULL, NULL, false },
+    { "GET_INITIAL_TICKET",  NULL, NULL, false },
+    { "GET_TICKET",          NULL, NULL, false },
+    { "MOVE_CACHE",          NULL, NULL, false },
+    { "GET_CACHE_UUID_LIST", kcm_op_get_cache_uuid_list_send, NULL, true },
+    { "GET_CACHE_BY_UUID",   kcm_op_get_cache_by_uuid_send, NULL, true },
+    { "GET_DEFAULT_CACHE",   kcm_op_get_default_ccache_send, kcm_op_get_default_ccache_recv, true },
+    { "SET_DEFAULT_CACHE",   kcm_op_set_default_ccache_send, kcm_op_set_default_ccache_recv, false },
+    { "GET_KDC_OFFSET",      kcm_op_get_kdc_offset_send, NULL, true },
+    { "SET_KDC_OFFSET",      kcm_op_set_kdc_offset_send, kcm_op_set_kdc_offset_recv, false },
+    { "ADD_NTLM_CRED",       NULL, NULL, false },
+    { "HAVE_NTLM_CRED",      NULL, NULL, false },
+    { "DEL_NTLM_CRED",       NULL, NULL, false },
+    { "DO_NTLM_AUTH",        NULL, NULL, false },
+    { "GET_NTLM_USER_LIST",  NULL, NULL, false },
+
+    { NULL, NULL, NULL, false }
+};
+
+/* MIT EXTENSIONS, see private header src/include/kcm.h in krb5 sources */
+static struct kcm_op kcm_mit_optable[] = {
+    { "MIT_EXTENSION_BASE",  NULL, NULL, false },
+    { "GET_CRED_LIST",       kcm_op_get_cred_list_send, NULL, true },
+
+    { NULL, NULL, NULL, false }
 };
 
 struct kcm_op *kcm_get_opt(uint16_t opcode)
@@ -2305,11 +2416,14 @@ struct kcm_op *kcm_get_opt(uint16_t opcode)
     DEBUG(SSSDBG_TRACE_INTERNAL,
           "The client requested operation %"PRIu16"\n", opcode);
 
-    if (opcode >= KCM_OP_SENTINEL) {
+    if (opcode >= KCM_MIT_OP_BASE && opcode < KCM_MIT_OP_SENTINEL) {
+        op = &kcm_mit_optable[opcode - KCM_MIT_OP_BASE];
+    } else if (opcode < KCM_OP_SENTINEL) {
+        op = &kcm_optable[opcode];
+    } else {
         return NULL;
     }
 
-    op = &kcm_optable[opcode];
     if (op->fn_recv == NULL) {
         op->fn_recv = kcm_op_common_recv;
     }
@@ -47,8 +47,11 @@ struct tevent_req *kcm_cmd_send(TALLOC_CTX *mem_ctx,
                                 struct cli_creds *client,
                                 struct kcm_data *input,
                                 struct kcm_op *op);
+/* The status code of the operation is returned in _kerr, it has to be sent
+ * to the client before the reply buffer */
 errno_t kcm_cmd_recv(TALLOC_CTX *mem_ctx,
                      struct tevent_req *req,
+                     krb5_error_code *_kerr,
                      struct sss_iobuf **_reply);
 
 #endif /* __KCMSRV_OPS_H__ */
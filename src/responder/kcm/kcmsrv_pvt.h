@@ -82,9 +82,9 @@ int kcm_connection_setup(struct cli_ctx *cctx);
 krb5_error_code sss2krb5_error(errno_t err);
 
 /* We enqueue all requests by the same UID to avoid concurrency issues
- * especially when performing multiple round-trips to sssd-secrets. In
- * future, we should relax the queue to allow multiple read-only operations
- * if no write operations are in progress.
+ * especially when performing multiple round-trips to sssd-secrets.
+ * Read-only operations run concurrently as long as no write operation is
+ * running or queued before them, write operations run alone.
  */
 struct kcm_ops_queue_entry;
 
@@ -94,10 +94,12 @@ struct kcm_ops_queue_ctx *kcm_ops_queue_create(TALLOC_CTX *mem_ctx,
 struct tevent_req *kcm_op_queue_send(TALLOC_CTX *mem_ctx,
                                      struct tevent_context *ev,
                                      struct kcm_ops_queue_ctx *qctx,
-                                     struct cli_creds *client);
+                                     struct cli_creds *client,
+                                     bool readonly);
 
 errno_t kcm_op_queue_recv(struct tevent_req *req,
                           TALLOC_CTX *mem_ctx,
-                          struct kcm_ops_queue_entry **_entry);
+                          struct kcm_ops_queue_entry **_entry,
+                          uint64_t *_wait_usec);
 
 #endif /* __KCMSRV_PVT_H__ */
@@ -53,10 +53,17 @@ nss_cmd_ctx_create(TALLOC_CTX *mem_ctx,
 static errno_t eval_flags(struct nss_cmd_ctx *cmd_ctx,
                           struct cache_req_data *data)
 {
-    if ((cmd_ctx->flags & SSS_NSS_EX_FLAG_NO_CACHE) != 0
-            && (cmd_ctx->flags & SSS_NSS_EX_FLAG_INVALIDATE_CACHE) != 0) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Flags SSS_NSS_EX_FLAG_NO_CACHE and "
-                                   "SSS_NSS_EX_FLAG_INVALIDATE_CACHE are "
+    uint32_t cache_flags;
+
+    cache_flags = cmd_ctx->flags & (SSS_NSS_EX_FLAG_NO_CACHE
+                                    | SSS_NSS_EX_FLAG_INVALIDATE_CACHE
+                                    | SSS_NSS_EX_FLAG_CACHE_ONLY
+                                    | SSS_NSS_EX_FLAG_ALLOW_STALE);
+    if ((cache_flags & (cache_flags - 1)) != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Flags SSS_NSS_EX_FLAG_NO_CACHE, "
+                                   "SSS_NSS_EX_FLAG_INVALIDATE_CACHE, "
+                                   "SSS_NSS_EX_FLAG_CACHE_ONLY and "
+                                   "SSS_NSS_EX_FLAG_ALLOW_STALE are "
                                    "mutually exclusive.\n");
         return EINVAL;
     }
@@ -65,6 +72,11 @@ static errno_t eval_flags(struct nss_cmd_ctx *cmd_ctx,
         cache_req_data_set_bypass_cache(data, true);
     } else if ((cmd_ctx->flags & SSS_NSS_EX_FLAG_INVALIDATE_CACHE) != 0) {
         cache_req_data_set_bypass_dp(data, true);
+    } else if ((cmd_ctx->flags & SSS_NSS_EX_FLAG_CACHE_ONLY) != 0) {
+        cache_req_data_set_bypass_dp(data, true);
+        cache_req_data_set_allow_stale(data, true);
+    } else if ((cmd_ctx->flags & SSS_NSS_EX_FLAG_ALLOW_STALE) != 0) {
+        cache_req_data_set_allow_stale(data, true);
     }
 
     return EOK;
@@ -86,7 +98,8 @@ static errno_t nss_getby_name(struct cli_ctx *cli_ctx,
     const char *rawname;
     errno_t ret;
 
-    cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, fill_fn);
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
         goto done;
@@ -152,7 +165,8 @@ static errno_t nss_getby_id(struct cli_ctx *cli_ctx,
     uint32_t id;
     errno_t ret;
 
-    cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, fill_fn);
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
         goto done;
@@ -205,6 +219,263 @@ done:
     return EOK;
 }
 
+/* Maximum number of lookups of one multi request running at once. */
+#define NSS_MULTI_MAX_PENDING 32
+
+struct nss_multi_ctx;
+
+struct nss_multi_item {
+    struct nss_multi_ctx *multi_ctx;
+    uint32_t index;
+};
+
+struct nss_multi_ctx {
+    struct nss_cmd_ctx *cmd_ctx;
+    enum sss_mc_type memcache;
+    const char **attrs;
+    /* The replies of the SID requests do not contain the key of the entry,
+     * each entry is prefixed with the index of its ID or SID instead. */
+    bool with_index;
+
+    /* Either IDs, optionally with the type of each ID, SIDs or names. */
+    uint32_t *ids;
+    uint32_t *id_types;
+    const char **sids;
+    const char **names;
+    uint32_t count;
+    uint32_t next;
+    uint32_t pending;
+
+    struct nss_multi_item *items;
+    struct cache_req_result **results;
+};
+
+static void nss_getby_id_multi_done(struct tevent_req *subreq);
+
+/* An ID of a SSS_NSS_GETSIDBYID_MULTI request may be restricted to users or
+ * groups like with SSS_NSS_GETSIDBYUID and SSS_NSS_GETSIDBYGID. */
+static enum cache_req_type nss_multi_id_type(struct nss_multi_ctx *multi_ctx,
+                                             uint32_t i)
+{
+    if (multi_ctx->id_types == NULL) {
+        return multi_ctx->cmd_ctx->type;
+    }
+
+    switch (multi_ctx->id_types[i]) {
+    case SSS_ID_TYPE_UID:
+        return CACHE_REQ_USER_BY_ID;
+    case SSS_ID_TYPE_GID:
+        return CACHE_REQ_GROUP_BY_ID;
+    default:
+        return CACHE_REQ_OBJECT_BY_ID;
+    }
+}
+
+static errno_t nss_getby_id_multi_send_next(struct nss_multi_ctx *multi_ctx)
+{
+    struct nss_cmd_ctx *cmd_ctx = multi_ctx->cmd_ctx;
+    struct cache_req_data *data;
+    struct tevent_req *subreq;
+    enum cache_req_type type;
+    const char *name = NULL;
+    uint32_t id = 0;
+    uint32_t i;
+
+    while (multi_ctx->pending < NSS_MULTI_MAX_PENDING
+            && multi_ctx->next < multi_ctx->count) {
+        i = multi_ctx->next;
+
+        if (multi_ctx->sids != NULL) {
+            data = cache_req_data_sid(multi_ctx, cmd_ctx->type,
+                                      multi_ctx->sids[i], multi_ctx->attrs);
+        } else if (multi_ctx->names != NULL) {
+            name = multi_ctx->names[i];
+            data = cache_req_data_name_attrs(multi_ctx, cmd_ctx->type, name,
+                                             multi_ctx->attrs);
+        } else {
+            id = multi_ctx->ids[i];
+            type = nss_multi_id_type(multi_ctx, i);
+            data = cache_req_data_id_attrs(multi_ctx, type, id,
+                                           multi_ctx->attrs);
+        }
+        if (data == NULL) {
+            return ENOMEM;
+        }
+
+        subreq = nss_get_object_send(multi_ctx, cmd_ctx->cli_ctx->ev,
+                                     cmd_ctx->cli_ctx, data,
+                                     multi_ctx->memcache, name, id);
+        if (subreq == NULL) {
+            return ENOMEM;
+        }
+        talloc_steal(subreq, data);
+
+        multi_ctx->items[i].multi_ctx = multi_ctx;
+        multi_ctx->items[i].index = i;
+        tevent_req_set_callback(subreq, nss_getby_id_multi_done,
+                                &multi_ctx->items[i]);
+
+        multi_ctx->next++;
+        multi_ctx->pending++;
+    }
+
+    return EOK;
+}
+
+enum nss_multi_input {
+    NSS_MULTI_IDS,
+    NSS_MULTI_TYPED_IDS,
+    NSS_MULTI_SIDS,
+    NSS_MULTI_NAMES
+};
+
+static errno_t nss_getby_id_multi(struct cli_ctx *cli_ctx,
+                                  enum nss_multi_input input,
+                                  enum cache_req_type type,
+                                  const char **attrs,
+                                  enum sss_mc_type memcache,
+                                  nss_protocol_fill_packet_fn fill_fn)
+{
+    struct nss_multi_ctx *multi_ctx;
+    struct nss_cmd_ctx *cmd_ctx;
+    errno_t ret;
+
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
+    if (cmd_ctx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    multi_ctx = talloc_zero(cmd_ctx, struct nss_multi_ctx);
+    if (multi_ctx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    multi_ctx->cmd_ctx = cmd_ctx;
+    multi_ctx->memcache = memcache;
+    multi_ctx->attrs = attrs;
+
+    switch (input) {
+    case NSS_MULTI_IDS:
+        ret = nss_protocol_parse_id_multi(multi_ctx, cli_ctx, &multi_ctx->ids,
+                                          &multi_ctx->count);
+        break;
+    case NSS_MULTI_TYPED_IDS:
+        multi_ctx->with_index = true;
+        ret = nss_protocol_parse_id_type_multi(multi_ctx, cli_ctx,
+                                               &multi_ctx->ids,
+                                               &multi_ctx->id_types,
+                                               &multi_ctx->count);
+        break;
+    case NSS_MULTI_SIDS:
+        multi_ctx->with_index = true;
+        /* It will be detected when constructing output packet. */
+        cmd_ctx->sid_id_type = SSS_ID_TYPE_NOT_SPECIFIED;
+        ret = nss_protocol_parse_sid_multi(multi_ctx, cli_ctx,
+                                           &multi_ctx->sids,
+                                           &multi_ctx->count);
+        break;
+    case NSS_MULTI_NAMES:
+        multi_ctx->with_index = true;
+        ret = nss_protocol_parse_name_multi(multi_ctx, cli_ctx,
+                                            &multi_ctx->names,
+                                            &multi_ctx->count);
+        break;
+    default:
+        ret = EINVAL;
+        break;
+    }
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Invalid request message!\n");
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Looking up %u %s\n", multi_ctx->count,
+          input == NSS_MULTI_SIDS ? "SIDs"
+                                  : input == NSS_MULTI_NAMES ? "names" : "IDs");
+
+    multi_ctx->items = talloc_zero_array(multi_ctx, struct nss_multi_item,
+                                         multi_ctx->count);
+    multi_ctx->results = talloc_zero_array(multi_ctx,
+                                           struct cache_req_result *,
+                                           multi_ctx->count);
+    if (multi_ctx->items == NULL || multi_ctx->results == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = nss_getby_id_multi_send_next(multi_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "nss_get_object_send() failed\n");
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(cmd_ctx);
+        return nss_protocol_done(cli_ctx, ret);
+    }
+
+    return EOK;
+}
+
+static void nss_getby_id_multi_done(struct tevent_req *subreq)
+{
+    struct nss_multi_item *item;
+    struct nss_multi_ctx *multi_ctx;
+    struct nss_cmd_ctx *cmd_ctx;
+    errno_t ret;
+
+    item = tevent_req_callback_data(subreq, struct nss_multi_item);
+    multi_ctx = item->multi_ctx;
+    cmd_ctx = multi_ctx->cmd_ctx;
+
+    ret = nss_get_object_recv(multi_ctx, subreq,
+                              &multi_ctx->results[item->index], NULL);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        /* Missing and failed entries are just left out of the reply. */
+        if (ret != ENOENT && multi_ctx->sids != NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to look up SID %s [%d]: %s\n",
+                  multi_ctx->sids[item->index], ret, sss_strerror(ret));
+        } else if (ret != ENOENT && multi_ctx->names != NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to look up name %s [%d]: %s\n",
+                  multi_ctx->names[item->index], ret, sss_strerror(ret));
+        } else if (ret != ENOENT) {
+            DEBUG(SSSDBG_OP_FAILURE, "Unable to look up ID %u [%d]: %s\n",
+                  multi_ctx->ids[item->index], ret, sss_strerror(ret));
+        }
+        multi_ctx->results[item->index] = NULL;
+    }
+
+    multi_ctx->pending--;
+
+    ret = nss_getby_id_multi_send_next(multi_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "nss_get_object_send() failed\n");
+        if (multi_ctx->pending == 0) {
+            nss_protocol_done(cmd_ctx->cli_ctx, ret);
+            talloc_free(cmd_ctx);
+        } else {
+            /* Wait for the running lookups and reply with what we have. */
+            multi_ctx->count = multi_ctx->next;
+        }
+        return;
+    }
+
+    if (multi_ctx->pending > 0) {
+        return;
+    }
+
+    nss_protocol_reply_multi(cmd_ctx->cli_ctx, cmd_ctx->nss_ctx, cmd_ctx,
+                             multi_ctx->results, multi_ctx->count,
+                             multi_ctx->with_index, cmd_ctx->fill_fn);
+    talloc_free(cmd_ctx);
+}
+
 static errno_t nss_getby_svc(struct cli_ctx *cli_ctx,
                              enum cache_req_type type,
                              const char *protocol,
@@ -217,7 +488,8 @@ static errno_t nss_getby_svc(struct cli_ctx *cli_ctx,
     struct tevent_req *subreq;
     errno_t ret;
 
-    cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, fill_fn);
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
         goto done;
@@ -265,7 +537,8 @@ static errno_t nss_getlistby_cert(struct cli_ctx *cli_ctx,
     const char *cert;
     errno_t ret;
 
-    cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, NULL);
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 NULL);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
         goto done;
@@ -350,7 +623,8 @@ static errno_t nss_getby_cert(struct cli_ctx *cli_ctx,
     const char *cert;
     errno_t ret;
 
-    cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, fill_fn);
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
         goto done;
@@ -404,7 +678,8 @@ static errno_t nss_getby_sid(struct cli_ctx *cli_ctx,
     const char *sid;
     errno_t ret;
 
-    cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, fill_fn);
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
         goto done;
@@ -464,7 +739,8 @@ static errno_t nss_getby_addr(struct cli_ctx *cli_ctx,
     uint32_t af;
     errno_t ret;
 
-    cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, fill_fn);
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
         goto done;
@@ -598,6 +874,23 @@ static errno_t invalidate_cache(struct nss_cmd_ctx *cmd_ctx,
     return EOK;
 }
 
+/* Most host lookups are misses when sss is listed early for hosts in
+ * nsswitch.conf. The miss is kept in the hosts memory cache as long as in
+ * the negative cache, so the clients do not have to ask again. */
+static void nss_getby_notfound(struct nss_cmd_ctx *cmd_ctx)
+{
+    uint32_t ttl;
+
+    if (cmd_ctx->type != CACHE_REQ_IP_HOST_BY_NAME
+            && cmd_ctx->type != CACHE_REQ_IP_HOST_BY_ADDR) {
+        return;
+    }
+
+    ttl = sss_ncache_get_resolver_timeout(cmd_ctx->cli_ctx->rctx->ncache);
+    nss_protocol_mc_store_notfound(cmd_ctx->cli_ctx,
+                                   &cmd_ctx->nss_ctx->host_mc_ctx, ttl);
+}
+
 static void nss_getby_done(struct tevent_req *subreq)
 {
     struct cache_req_result *result;
@@ -608,6 +901,9 @@ static void nss_getby_done(struct tevent_req *subreq)
 
     ret = nss_get_object_recv(cmd_ctx, subreq, &result, &cmd_ctx->rawname);
     talloc_zfree(subreq);
+    if (ret == ENOENT) {
+        nss_getby_notfound(cmd_ctx);
+    }
     if (ret != EOK) {
         nss_protocol_done(cmd_ctx->cli_ctx, ret);
         goto done;
@@ -630,6 +926,163 @@ done:
     talloc_free(cmd_ctx);
 }
 
+/* The user entry and the groups of a user are looked up with one request,
+ * mostly by login services which ask for both right after each other. The
+ * initgroups lookup refreshes the whole user if any part of it is expired,
+ * so the user entry is then taken from the cache without asking the
+ * backend again. */
+struct nss_getpw_initgr_ctx {
+    struct nss_cmd_ctx *cmd_ctx;
+    struct cache_req_result *initgr_result;
+};
+
+static void nss_getpw_initgr_initgr_done(struct tevent_req *subreq);
+static void nss_getpw_initgr_pw_done(struct tevent_req *subreq);
+
+static errno_t nss_getpw_initgr(struct cli_ctx *cli_ctx)
+{
+    struct nss_getpw_initgr_ctx *ctx;
+    struct cache_req_data *data;
+    struct tevent_req *subreq;
+    const char *rawname;
+    errno_t ret;
+
+    ctx = talloc_zero(sss_cmd_mem_ctx(cli_ctx), struct nss_getpw_initgr_ctx);
+    if (ctx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ctx->cmd_ctx = nss_cmd_ctx_create(ctx, cli_ctx, CACHE_REQ_INITGROUPS,
+                                      nss_protocol_fill_initgr);
+    if (ctx->cmd_ctx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = nss_protocol_parse_name_ex(cli_ctx, &rawname, &ctx->cmd_ctx->flags);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Invalid request message!\n");
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Input name: %s\n", rawname);
+
+    data = cache_req_data_name(ctx, CACHE_REQ_INITGROUPS, rawname);
+    if (data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to set cache request data!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = eval_flags(ctx->cmd_ctx, data);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "eval_flags failed.\n");
+        goto done;
+    }
+    cache_req_data_set_entry_expiration(data, true);
+
+    subreq = nss_get_object_send(ctx, cli_ctx->ev, cli_ctx, data,
+                                 SSS_MC_INITGROUPS, rawname, 0);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "nss_get_object_send() failed\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, nss_getpw_initgr_initgr_done, ctx);
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(ctx);
+        return nss_protocol_done(cli_ctx, ret);
+    }
+
+    return EOK;
+}
+
+static void nss_getpw_initgr_initgr_done(struct tevent_req *subreq)
+{
+    struct nss_getpw_initgr_ctx *ctx;
+    struct nss_cmd_ctx *cmd_ctx;
+    struct cache_req_data *data;
+    errno_t ret;
+
+    ctx = tevent_req_callback_data(subreq, struct nss_getpw_initgr_ctx);
+    cmd_ctx = ctx->cmd_ctx;
+
+    ret = nss_get_object_recv(ctx, subreq, &ctx->initgr_result,
+                              &cmd_ctx->rawname);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if ((cmd_ctx->flags & SSS_NSS_EX_FLAG_INVALIDATE_CACHE) != 0) {
+        ret = invalidate_cache(cmd_ctx, ctx->initgr_result);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "Failed to invalidate cache for [%s].\n",
+                                     cmd_ctx->rawname);
+            goto done;
+        }
+    }
+
+    data = cache_req_data_name(ctx, CACHE_REQ_USER_BY_NAME, cmd_ctx->rawname);
+    if (data == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* The user was just refreshed together with its groups if needed */
+    cache_req_data_set_bypass_dp(data, true);
+    cache_req_data_set_allow_stale(data, true);
+
+    subreq = cache_req_send(ctx, cmd_ctx->cli_ctx->ev, cmd_ctx->cli_ctx->rctx,
+                            cmd_ctx->cli_ctx->rctx->ncache,
+                            cmd_ctx->nss_ctx->cache_refresh_percent,
+                            CACHE_REQ_POSIX_DOM,
+                            ctx->initgr_result->domain->name, data);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, nss_getpw_initgr_pw_done, ctx);
+    return;
+
+done:
+    nss_protocol_done(cmd_ctx->cli_ctx, ret);
+    talloc_free(ctx);
+}
+
+static void nss_getpw_initgr_pw_done(struct tevent_req *subreq)
+{
+    struct nss_getpw_initgr_ctx *ctx;
+    struct cache_req_result *pw_result;
+    struct nss_cmd_ctx *cmd_ctx;
+    errno_t ret;
+
+    ctx = tevent_req_callback_data(subreq, struct nss_getpw_initgr_ctx);
+    cmd_ctx = ctx->cmd_ctx;
+
+    ret = cache_req_single_domain_recv(ctx, subreq, &pw_result);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "User [%s] is not in the cache [%d]: %s\n",
+              cmd_ctx->rawname, ret, sss_strerror(ret));
+        nss_protocol_done(cmd_ctx->cli_ctx, ret);
+        goto done;
+    }
+
+    nss_protocol_reply_pw_initgr(cmd_ctx->cli_ctx, cmd_ctx->nss_ctx, cmd_ctx,
+                                 pw_result, ctx->initgr_result);
+
+done:
+    talloc_free(ctx);
+}
+
 static void nss_setent_done(struct tevent_req *subreq);
 
 static errno_t nss_setent(struct cli_ctx *cli_ctx,
@@ -679,6 +1132,8 @@ static errno_t nss_getent(struct cli_ctx *cli_ctx,
     struct tevent_req *subreq;
     errno_t ret;
 
+    /* Enumerations are shared by the clients and their results are kept
+     * in enum_ctx, they do not use the request pool. */
     cmd_ctx = nss_cmd_ctx_create(cli_ctx, cli_ctx, type, fill_fn);
     if (cmd_ctx == NULL) {
         ret = ENOMEM;
@@ -754,6 +1209,19 @@ static void nss_getent_done(struct tevent_req *subreq)
         goto done;
     }
 
+    if (cmd_ctx->enum_ctx->keys != NULL) {
+        ret = nss_enum_keys_read(cmd_ctx, cmd_ctx->enum_ctx,
+                                 cmd_ctx->enum_index, cmd_ctx->enum_limit,
+                                 &result);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        nss_protocol_reply(cmd_ctx->cli_ctx, cmd_ctx->nss_ctx, cmd_ctx,
+                           result, cmd_ctx->fill_fn);
+        goto done;
+    }
+
     result = nss_getent_get_result(cmd_ctx->enum_ctx, cmd_ctx->enum_index);
     if (result == NULL) {
         /* No more records to return. */
@@ -770,11 +1238,11 @@ static void nss_getent_done(struct tevent_req *subreq)
         goto done;
     }
 
-    cmd_ctx->enum_index->result += result->count;
+    cmd_ctx->enum_index->result += limited->count;
 
     /* Reply with limited result. */
     nss_protocol_reply(cmd_ctx->cli_ctx, cmd_ctx->nss_ctx, cmd_ctx,
-                       result, cmd_ctx->fill_fn);
+                       limited, cmd_ctx->fill_fn);
 
     ret = EOK;
 
@@ -959,6 +1427,329 @@ done:
     talloc_free(cmd_ctx);
 }
 
+/* innetgr() is answered here instead of making the client walk the
+ * netgroup and every netgroup nested in it with setnetgrent() and
+ * getnetgrent(). The triples of all nested netgroups are collected once
+ * and kept with the netgroup until its enumeration object expires. */
+struct nss_innetgr_ctx {
+    struct nss_cmd_ctx *cmd_ctx;
+    const char *netgroup;
+    const char *host;
+    const char *user;
+    const char *domain;
+
+    /* Netgroups which still have to be read and all netgroups seen */
+    const char **pending;
+    size_t num_pending;
+    const char **seen;
+    size_t num_seen;
+    const char *current;
+
+    struct sysdb_netgroup_ctx **triples;
+    size_t num_triples;
+};
+
+static errno_t nss_innetgr_next(struct nss_innetgr_ctx *ictx);
+static void nss_innetgr_done(struct tevent_req *subreq);
+
+static bool nss_innetgr_match(struct sysdb_netgroup_ctx **triples,
+                              size_t num_triples,
+                              const char *host,
+                              const char *user,
+                              const char *domain)
+{
+    struct sysdb_netgroup_ctx *t;
+    size_t i;
+
+    /* Same rules as innetgr() of glibc, a missing value on either side
+     * matches anything, hosts and domains are compared case-insensitively */
+    for (i = 0; i < num_triples; i++) {
+        t = triples[i];
+
+        if (host != NULL && t->value.triple.hostname != NULL
+                && strcasecmp(host, t->value.triple.hostname) != 0) {
+            continue;
+        }
+
+        if (user != NULL && t->value.triple.username != NULL
+                && strcmp(user, t->value.triple.username) != 0) {
+            continue;
+        }
+
+        if (domain != NULL && t->value.triple.domainname != NULL
+                && strcasecmp(domain, t->value.triple.domainname) != 0) {
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static errno_t nss_innetgr_push(struct nss_innetgr_ctx *ictx,
+                                const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < ictx->num_seen; i++) {
+        if (strcmp(ictx->seen[i], name) == 0) {
+            return EOK;
+        }
+    }
+
+    ictx->seen = talloc_realloc(ictx, ictx->seen, const char *,
+                                ictx->num_seen + 1);
+    ictx->pending = talloc_realloc(ictx, ictx->pending, const char *,
+                                   ictx->num_pending + 1);
+    if (ictx->seen == NULL || ictx->pending == NULL) {
+        return ENOMEM;
+    }
+
+    ictx->seen[ictx->num_seen] = talloc_strdup(ictx->seen, name);
+    if (ictx->seen[ictx->num_seen] == NULL) {
+        return ENOMEM;
+    }
+
+    ictx->pending[ictx->num_pending] = ictx->seen[ictx->num_seen];
+    ictx->num_seen++;
+    ictx->num_pending++;
+
+    return EOK;
+}
+
+static errno_t nss_innetgr_add(struct nss_innetgr_ctx *ictx,
+                               struct nss_enum_ctx *enum_ctx)
+{
+    struct sysdb_netgroup_ctx *entry;
+    struct sysdb_netgroup_ctx *t;
+    size_t i;
+    errno_t ret;
+
+    ictx->triples = talloc_realloc(ictx, ictx->triples,
+                                   struct sysdb_netgroup_ctx *,
+                                   ictx->num_triples
+                                        + enum_ctx->netgroup_count + 1);
+    if (ictx->triples == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < enum_ctx->netgroup_count; i++) {
+        entry = enum_ctx->netgroup[i];
+
+        if (entry->type == SYSDB_NETGROUP_GROUP_VAL) {
+            if (entry->value.groupname == NULL
+                    || entry->value.groupname[0] == '\0') {
+                continue;
+            }
+
+            ret = nss_innetgr_push(ictx, entry->value.groupname);
+            if (ret != EOK) {
+                return ret;
+            }
+            continue;
+        }
+
+        /* The nested netgroups may expire before this one, copy them. */
+        t = talloc_zero(ictx->triples, struct sysdb_netgroup_ctx);
+        if (t == NULL) {
+            return ENOMEM;
+        }
+
+        t->type = SYSDB_NETGROUP_TRIPLE_VAL;
+        t->value.triple.hostname = talloc_strdup(t,
+                                            entry->value.triple.hostname);
+        t->value.triple.username = talloc_strdup(t,
+                                            entry->value.triple.username);
+        t->value.triple.domainname = talloc_strdup(t,
+                                            entry->value.triple.domainname);
+        if ((entry->value.triple.hostname != NULL
+                    && t->value.triple.hostname == NULL)
+                || (entry->value.triple.username != NULL
+                    && t->value.triple.username == NULL)
+                || (entry->value.triple.domainname != NULL
+                    && t->value.triple.domainname == NULL)) {
+            return ENOMEM;
+        }
+
+        ictx->triples[ictx->num_triples] = t;
+        ictx->num_triples++;
+    }
+
+    ictx->triples[ictx->num_triples] = NULL;
+
+    return EOK;
+}
+
+static void nss_innetgr_reply(struct nss_innetgr_ctx *ictx,
+                              struct sysdb_netgroup_ctx **triples,
+                              size_t num_triples)
+{
+    struct nss_cmd_ctx *cmd_ctx = ictx->cmd_ctx;
+
+    if (nss_innetgr_match(triples, num_triples,
+                          ictx->host, ictx->user, ictx->domain)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Triple is in netgroup %s\n",
+              ictx->netgroup);
+        nss_protocol_reply(cmd_ctx->cli_ctx, cmd_ctx->nss_ctx, cmd_ctx,
+                           NULL, cmd_ctx->fill_fn);
+    } else {
+        DEBUG(SSSDBG_TRACE_FUNC, "Triple is not in netgroup %s\n",
+              ictx->netgroup);
+        nss_protocol_done(cmd_ctx->cli_ctx, ENOENT);
+    }
+}
+
+static errno_t nss_innetgr(struct cli_ctx *cli_ctx,
+                           enum cache_req_type type,
+                           nss_protocol_fill_packet_fn fill_fn)
+{
+    struct nss_innetgr_ctx *ictx;
+    struct nss_enum_ctx *enum_ctx;
+    struct nss_cmd_ctx *cmd_ctx;
+    const char *netgroup;
+    const char *host;
+    const char *user;
+    const char *domain;
+    errno_t ret;
+
+    cmd_ctx = nss_cmd_ctx_create(sss_cmd_mem_ctx(cli_ctx), cli_ctx, type,
+                                 fill_fn);
+    if (cmd_ctx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ictx = talloc_zero(cmd_ctx, struct nss_innetgr_ctx);
+    if (ictx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    ictx->cmd_ctx = cmd_ctx;
+
+    ret = nss_protocol_parse_innetgr(cli_ctx, &netgroup, &host, &user,
+                                     &domain);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Invalid request message!\n");
+        goto done;
+    }
+
+    ictx->netgroup = talloc_strdup(ictx, netgroup);
+    ictx->host = host == NULL ? NULL : talloc_strdup(ictx, host);
+    ictx->user = user == NULL ? NULL : talloc_strdup(ictx, user);
+    ictx->domain = domain == NULL ? NULL : talloc_strdup(ictx, domain);
+    if (ictx->netgroup == NULL || (host != NULL && ictx->host == NULL)
+            || (user != NULL && ictx->user == NULL)
+            || (domain != NULL && ictx->domain == NULL)) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Checking (%s,%s,%s) in netgroup %s\n",
+          host == NULL ? "" : host, user == NULL ? "" : user,
+          domain == NULL ? "" : domain, netgroup);
+
+    enum_ctx = sss_ptr_hash_lookup(cmd_ctx->nss_ctx->netgrent,
+                                   ictx->netgroup, struct nss_enum_ctx);
+    if (enum_ctx != NULL && enum_ctx->is_ready && enum_ctx->triples != NULL) {
+        nss_innetgr_reply(ictx, enum_ctx->triples, enum_ctx->triples_count);
+        talloc_free(cmd_ctx);
+        return EOK;
+    }
+
+    ret = nss_innetgr_push(ictx, ictx->netgroup);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = nss_innetgr_next(ictx);
+
+done:
+    if (ret != EOK) {
+        talloc_free(cmd_ctx);
+        return nss_protocol_done(cli_ctx, ret);
+    }
+
+    return EOK;
+}
+
+static errno_t nss_innetgr_next(struct nss_innetgr_ctx *ictx)
+{
+    struct nss_cmd_ctx *cmd_ctx = ictx->cmd_ctx;
+    struct tevent_req *subreq;
+
+    ictx->num_pending--;
+    ictx->current = ictx->pending[ictx->num_pending];
+
+    subreq = nss_setnetgrent_send(ictx, cmd_ctx->cli_ctx->ev,
+                                  cmd_ctx->cli_ctx, cmd_ctx->type,
+                                  cmd_ctx->nss_ctx->netgrent, ictx->current);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "nss_setnetgrent_send() failed\n");
+        return ENOMEM;
+    }
+
+    tevent_req_set_callback(subreq, nss_innetgr_done, ictx);
+
+    return EOK;
+}
+
+static void nss_innetgr_done(struct tevent_req *subreq)
+{
+    struct nss_innetgr_ctx *ictx;
+    struct nss_enum_ctx *enum_ctx;
+    struct nss_cmd_ctx *cmd_ctx;
+    bool top;
+    errno_t ret;
+
+    ictx = tevent_req_callback_data(subreq, struct nss_innetgr_ctx);
+    cmd_ctx = ictx->cmd_ctx;
+    top = strcmp(ictx->current, ictx->netgroup) == 0;
+
+    ret = nss_setnetgrent_recv(subreq);
+    talloc_zfree(subreq);
+    if (ret == EOK) {
+        enum_ctx = sss_ptr_hash_lookup(cmd_ctx->nss_ctx->netgrent,
+                                       ictx->current, struct nss_enum_ctx);
+        ret = enum_ctx == NULL ? ENOENT : nss_innetgr_add(ictx, enum_ctx);
+    }
+
+    if (ret == ENOENT && !top) {
+        /* A missing nested netgroup has no members. */
+        DEBUG(SSSDBG_TRACE_FUNC, "Nested netgroup %s does not exist\n",
+              ictx->current);
+        ret = EOK;
+    }
+
+    if (ret != EOK) {
+        nss_protocol_done(cmd_ctx->cli_ctx, ret);
+        goto done;
+    }
+
+    if (ictx->num_pending > 0) {
+        ret = nss_innetgr_next(ictx);
+        if (ret != EOK) {
+            nss_protocol_done(cmd_ctx->cli_ctx, ret);
+            goto done;
+        }
+        return;
+    }
+
+    /* Keep the flattened netgroup for the next requests. */
+    enum_ctx = sss_ptr_hash_lookup(cmd_ctx->nss_ctx->netgrent, ictx->netgroup,
+                                   struct nss_enum_ctx);
+    if (enum_ctx != NULL && enum_ctx->is_ready && ictx->triples != NULL) {
+        talloc_zfree(enum_ctx->triples);
+        enum_ctx->triples = talloc_steal(enum_ctx, ictx->triples);
+        enum_ctx->triples_count = ictx->num_triples;
+    }
+
+    nss_innetgr_reply(ictx, ictx->triples, ictx->num_triples);
+
+done:
+    talloc_free(cmd_ctx);
+}
+
 static errno_t nss_endent(struct cli_ctx *cli_ctx,
                           struct nss_enum_index *idx)
 {
@@ -966,6 +1757,7 @@ static errno_t nss_endent(struct cli_ctx *cli_ctx,
 
     idx->domain = 0;
     idx->result = 0;
+    idx->offset = 0;
 
     nss_protocol_done(cli_ctx, EOK);
 
@@ -996,6 +1788,12 @@ static errno_t nss_cmd_getpwuid_ex(struct cli_ctx *cli_ctx)
                         SSS_MC_PASSWD, nss_protocol_fill_pwent);
 }
 
+static errno_t nss_cmd_getpwuid_multi(struct cli_ctx *cli_ctx)
+{
+    return nss_getby_id_multi(cli_ctx, NSS_MULTI_IDS, CACHE_REQ_USER_BY_ID,
+                              NULL, SSS_MC_PASSWD, nss_protocol_fill_pwent);
+}
+
 static errno_t nss_cmd_setpwent(struct cli_ctx *cli_ctx)
 {
     struct nss_ctx *nss_ctx;
@@ -1051,6 +1849,12 @@ static errno_t nss_cmd_getgrgid_ex(struct cli_ctx *cli_ctx)
                         SSS_MC_GROUP, nss_protocol_fill_grent);
 }
 
+static errno_t nss_cmd_getgrgid_multi(struct cli_ctx *cli_ctx)
+{
+    return nss_getby_id_multi(cli_ctx, NSS_MULTI_IDS, CACHE_REQ_GROUP_BY_ID,
+                              NULL, SSS_MC_GROUP, nss_protocol_fill_grent);
+}
+
 
 static errno_t nss_cmd_setgrent(struct cli_ctx *cli_ctx)
 {
@@ -1095,6 +1899,11 @@ static errno_t nss_cmd_initgroups_ex(struct cli_ctx *cli_ctx)
                           SSS_MC_INITGROUPS, nss_protocol_fill_initgr);
 }
 
+static errno_t nss_cmd_getpwnam_initgr(struct cli_ctx *cli_ctx)
+{
+    return nss_getpw_initgr(cli_ctx);
+}
+
 static errno_t nss_cmd_setnetgrent(struct cli_ctx *cli_ctx)
 {
     return sss_nss_setnetgrent(cli_ctx, CACHE_REQ_NETGROUP_BY_NAME,
@@ -1107,6 +1916,12 @@ static errno_t nss_cmd_getnetgrent(struct cli_ctx *cli_ctx)
                            nss_protocol_fill_netgrent);
 }
 
+static errno_t nss_cmd_innetgr(struct cli_ctx *cli_ctx)
+{
+    return nss_innetgr(cli_ctx, CACHE_REQ_NETGROUP_BY_NAME,
+                       nss_protocol_fill_innetgr);
+}
+
 static errno_t nss_cmd_endnetgrent(struct cli_ctx *cli_ctx)
 {
     struct nss_state_ctx *state_ctx;
@@ -1183,7 +1998,16 @@ static errno_t nss_cmd_getsidbyname(struct cli_ctx *cli_ctx)
     const char *attrs[] = { SYSDB_SID_STR, NULL };
 
     return nss_getby_name(cli_ctx, false, CACHE_REQ_OBJECT_BY_NAME, attrs,
-                          SSS_MC_NONE, nss_protocol_fill_sid);
+                          SSS_MC_SID, nss_protocol_fill_sid);
+}
+
+static errno_t nss_cmd_getsidbyname_multi(struct cli_ctx *cli_ctx)
+{
+    static const char *attrs[] = { SYSDB_SID_STR, NULL };
+
+    return nss_getby_id_multi(cli_ctx, NSS_MULTI_NAMES,
+                              CACHE_REQ_OBJECT_BY_NAME, attrs, SSS_MC_SID,
+                              nss_protocol_fill_sid);
 }
 
 static errno_t nss_cmd_getsidbyid(struct cli_ctx *cli_ctx)
@@ -1210,18 +2034,41 @@ static errno_t nss_cmd_getsidbygid(struct cli_ctx *cli_ctx)
                         SSS_MC_NONE, nss_protocol_fill_sid);
 }
 
+static errno_t nss_cmd_getsidbyid_multi(struct cli_ctx *cli_ctx)
+{
+    static const char *attrs[] = { SYSDB_SID_STR, NULL };
+
+    return nss_getby_id_multi(cli_ctx, NSS_MULTI_TYPED_IDS,
+                              CACHE_REQ_OBJECT_BY_ID, attrs, SSS_MC_NONE,
+                              nss_protocol_fill_sid);
+}
+
 static errno_t nss_cmd_getnamebysid(struct cli_ctx *cli_ctx)
 {
     return nss_getby_sid(cli_ctx, CACHE_REQ_OBJECT_BY_SID,
                          nss_protocol_fill_name);
 }
 
+static errno_t nss_cmd_getnamebysid_multi(struct cli_ctx *cli_ctx)
+{
+    return nss_getby_id_multi(cli_ctx, NSS_MULTI_SIDS,
+                              CACHE_REQ_OBJECT_BY_SID, NULL, SSS_MC_NONE,
+                              nss_protocol_fill_name);
+}
+
 static errno_t nss_cmd_getidbysid(struct cli_ctx *cli_ctx)
 {
     return nss_getby_sid(cli_ctx, CACHE_REQ_OBJECT_BY_SID,
                          nss_protocol_fill_id);
 }
 
+static errno_t nss_cmd_getidbysid_multi(struct cli_ctx *cli_ctx)
+{
+    return nss_getby_id_multi(cli_ctx, NSS_MULTI_SIDS,
+                              CACHE_REQ_OBJECT_BY_SID, NULL, SSS_MC_NONE,
+                              nss_protocol_fill_id);
+}
+
 static errno_t nss_cmd_getorigbyname(struct cli_ctx *cli_ctx)
 {
     errno_t ret;
@@ -1381,6 +2228,7 @@ struct sss_cmd_table *get_nss_cmds(void)
         { SSS_NSS_SETNETGRENT, nss_cmd_setnetgrent },
         { SSS_NSS_GETNETGRENT, nss_cmd_getnetgrent },
         { SSS_NSS_ENDNETGRENT, nss_cmd_endnetgrent },
+        { SSS_NSS_INNETGR, nss_cmd_innetgr },
         { SSS_NSS_GETSERVBYNAME, nss_cmd_getservbyname },
         { SSS_NSS_GETSERVBYPORT, nss_cmd_getservbyport },
         { SSS_NSS_SETSERVENT, nss_cmd_setservent },
@@ -1392,6 +2240,10 @@ struct sss_cmd_table *get_nss_cmds(void)
         { SSS_NSS_GETSIDBYGID, nss_cmd_getsidbygid },
         { SSS_NSS_GETNAMEBYSID, nss_cmd_getnamebysid },
         { SSS_NSS_GETIDBYSID, nss_cmd_getidbysid },
+        { SSS_NSS_GETSIDBYID_MULTI, nss_cmd_getsidbyid_multi },
+        { SSS_NSS_GETIDBYSID_MULTI, nss_cmd_getidbysid_multi },
+        { SSS_NSS_GETSIDBYNAME_MULTI, nss_cmd_getsidbyname_multi },
+        { SSS_NSS_GETNAMEBYSID_MULTI, nss_cmd_getnamebysid_multi },
         { SSS_NSS_GETORIGBYNAME, nss_cmd_getorigbyname },
         { SSS_NSS_GETNAMEBYCERT, nss_cmd_getnamebycert },
         { SSS_NSS_GETLISTBYCERT, nss_cmd_getlistbycert },
@@ -1400,6 +2252,9 @@ struct sss_cmd_table *get_nss_cmds(void)
         { SSS_NSS_GETGRNAM_EX, nss_cmd_getgrnam_ex },
         { SSS_NSS_GETGRGID_EX, nss_cmd_getgrgid_ex },
         { SSS_NSS_INITGR_EX, nss_cmd_initgroups_ex },
+        { SSS_NSS_GETPWNAM_INITGR, nss_cmd_getpwnam_initgr },
+        { SSS_NSS_GETPWUID_MULTI, nss_cmd_getpwuid_multi },
+        { SSS_NSS_GETGRGID_MULTI, nss_cmd_getgrgid_multi },
         { SSS_NSS_GETHOSTBYNAME, nss_cmd_gethostbyname },
         { SSS_NSS_GETHOSTBYNAME2, nss_cmd_gethostbyname },
         { SSS_NSS_GETHOSTBYADDR, nss_cmd_gethostbyaddr },
@@ -35,8 +35,12 @@ struct nss_setent_internal_state {
     struct nss_enum_ctx *enum_ctx;
     nss_setent_set_timeout_fn timeout_handler;
     enum cache_req_type type;
+    bool keys;
 };
 
+/* Upper limit of the entries read for one getent request */
+#define NSS_ENUM_BATCH_MAX 512
+
 static void nss_setent_internal_done(struct tevent_req *subreq);
 
 /* Cache request data is stealed on internal state. */
@@ -47,7 +51,8 @@ nss_setent_internal_send(TALLOC_CTX *mem_ctx,
                          struct cache_req_data *data,
                          enum cache_req_type type,
                          struct nss_enum_ctx *enum_ctx,
-                         nss_setent_set_timeout_fn timeout_handler)
+                         nss_setent_set_timeout_fn timeout_handler,
+                         bool keys)
 {
     struct nss_setent_internal_state *state;
     struct tevent_req *subreq;
@@ -67,6 +72,7 @@ nss_setent_internal_send(TALLOC_CTX *mem_ctx,
     state->enum_ctx = enum_ctx;
     state->type = type;
     state->timeout_handler = timeout_handler;
+    state->keys = keys;
 
     if (state->enum_ctx->is_ready) {
         /* Object is already constructed, just return here. */
@@ -118,6 +124,64 @@ done:
     return req;
 }
 
+static errno_t
+nss_enum_keys_create(TALLOC_CTX *mem_ctx,
+                     struct cache_req_result **result,
+                     bool group,
+                     struct nss_enum_keys ***_keys)
+{
+    struct nss_enum_keys **keys;
+    struct nss_enum_keys *k;
+    const char *dn;
+    size_t num_results;
+    size_t len;
+    size_t i;
+    size_t j;
+
+    for (num_results = 0; result[num_results] != NULL; num_results++);
+
+    keys = talloc_zero_array(mem_ctx, struct nss_enum_keys *,
+                             num_results + 1);
+    if (keys == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_results; i++) {
+        k = talloc_zero(keys, struct nss_enum_keys);
+        if (k == NULL) {
+            goto fail;
+        }
+        keys[i] = k;
+
+        k->domain = result[i]->domain;
+        k->group = group;
+
+        for (j = 0; j < result[i]->count; j++) {
+            k->size += strlen(ldb_dn_get_linearized(result[i]->msgs[j]->dn))
+                       + 1;
+        }
+
+        k->dns = talloc_size(k, k->size);
+        if (k->dns == NULL) {
+            goto fail;
+        }
+
+        len = 0;
+        for (j = 0; j < result[i]->count; j++) {
+            dn = ldb_dn_get_linearized(result[i]->msgs[j]->dn);
+            memcpy(k->dns + len, dn, strlen(dn) + 1);
+            len += strlen(dn) + 1;
+        }
+    }
+
+    *_keys = keys;
+    return EOK;
+
+fail:
+    talloc_free(keys);
+    return ENOMEM;
+}
+
 static void nss_setent_internal_done(struct tevent_req *subreq)
 {
     struct cache_req_result **result;
@@ -139,9 +203,24 @@ static void nss_setent_internal_done(struct tevent_req *subreq)
     switch (ret) {
     case EOK:
         talloc_zfree(state->enum_ctx->result);
+        talloc_zfree(state->enum_ctx->keys);
+
+        if (state->keys) {
+            ret = nss_enum_keys_create(state->enum_ctx, result,
+                                       state->type == CACHE_REQ_ENUM_GROUPS,
+                                       &state->enum_ctx->keys);
+            talloc_free(result);
+            if (ret != EOK) {
+                goto done;
+            }
+            break;
+        }
+
         state->enum_ctx->result = talloc_steal(state->enum_ctx, result);
 
         if (state->type == CACHE_REQ_NETGROUP_BY_NAME) {
+            talloc_zfree(state->enum_ctx->triples);
+
             /* We need to expand the netgroup into triples and members. */
             ret = sysdb_netgr_to_entries(state->enum_ctx,
                                          result[0]->ldb_result,
@@ -155,7 +234,9 @@ static void nss_setent_internal_done(struct tevent_req *subreq)
     case ENOENT:
         /* Reset the result but build it again next time setent is called. */
         talloc_zfree(state->enum_ctx->result);
+        talloc_zfree(state->enum_ctx->keys);
         talloc_zfree(state->enum_ctx->netgroup);
+        talloc_zfree(state->enum_ctx->triples);
         goto done;
     default:
         /* In case of an error, we do not touch the enumeration context. */
@@ -212,6 +293,7 @@ nss_setent_timeout(struct tevent_context *ev,
 
     /* Reset enumeration context. */
     talloc_zfree(enum_ctx->result);
+    talloc_zfree(enum_ctx->keys);
     enum_ctx->is_ready = false;
 }
 
@@ -242,6 +324,7 @@ nss_setent_send(TALLOC_CTX *mem_ctx,
                 struct nss_enum_ctx *enum_ctx)
 {
     struct cache_req_data *data;
+    bool keys;
 
     data = cache_req_data_enum(mem_ctx, type);
     if (data == NULL) {
@@ -249,8 +332,14 @@ nss_setent_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
+    /* Session recording adds attributes to the enumerated users, those
+     * are only available in the complete result. */
+    keys = (type == CACHE_REQ_ENUM_USERS || type == CACHE_REQ_ENUM_GROUPS)
+            && cli_ctx->rctx->sr_conf.scope == SESSION_RECORDING_SCOPE_NONE;
+    cache_req_data_set_enum_keys(data, keys);
+
     return nss_setent_internal_send(mem_ctx, ev, cli_ctx, data, type, enum_ctx,
-                                    nss_setent_set_timeout);
+                                    nss_setent_set_timeout, keys);
 }
 
 errno_t nss_setent_recv(struct tevent_req *req)
@@ -258,6 +347,130 @@ errno_t nss_setent_recv(struct tevent_req *req)
     return nss_setent_internal_recv(req);
 }
 
+static errno_t
+nss_enum_keys_read_domain(TALLOC_CTX *mem_ctx,
+                          struct nss_enum_keys *keys,
+                          struct nss_enum_index *idx,
+                          uint32_t limit,
+                          struct cache_req_result **_result)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_context *ldb;
+    struct ldb_result *ldb_result;
+    struct cache_req_result *result;
+    struct ldb_dn *dn;
+    const char *dnstr;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ldb_result = talloc_zero(tmp_ctx, struct ldb_result);
+    if (ldb_result == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ldb_result->msgs = talloc_zero_array(ldb_result, struct ldb_message *,
+                                         limit + 1);
+    if (ldb_result->msgs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* The keys may have been rebuilt since the last call, continue with
+     * the next complete DN. */
+    while (idx->offset > 0 && idx->offset < keys->size
+            && keys->dns[idx->offset - 1] != '\0') {
+        idx->offset++;
+    }
+
+    ldb = sysdb_ctx_get_ldb(keys->domain->sysdb);
+    while (ldb_result->count < limit && idx->offset < keys->size) {
+        dnstr = keys->dns + idx->offset;
+        idx->offset += strlen(dnstr) + 1;
+
+        dn = ldb_dn_new(tmp_ctx, ldb, dnstr);
+        if (dn == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = sysdb_enum_entry_with_views(ldb_result->msgs, keys->domain,
+                                          keys->group, dn,
+                                          &ldb_result->msgs[ldb_result->count]);
+        talloc_free(dn);
+        if (ret == ENOENT) {
+            /* Removed from the cache in the meantime */
+            continue;
+        } else if (ret != EOK) {
+            goto done;
+        }
+
+        ldb_result->count++;
+    }
+
+    if (ldb_result->count == 0) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    result = talloc_zero(mem_ctx, struct cache_req_result);
+    if (result == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    result->domain = keys->domain;
+    result->ldb_result = talloc_steal(result, ldb_result);
+    result->count = ldb_result->count;
+    result->msgs = ldb_result->msgs;
+
+    *_result = result;
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Reads the next batch of at most limit objects of the enumeration. The
+ * objects of one domain are returned at a time. Returns ENOENT if there
+ * are no more objects. */
+errno_t
+nss_enum_keys_read(TALLOC_CTX *mem_ctx,
+                   struct nss_enum_ctx *enum_ctx,
+                   struct nss_enum_index *idx,
+                   uint32_t limit,
+                   struct cache_req_result **_result)
+{
+    struct nss_enum_keys *keys;
+    errno_t ret;
+
+    if (enum_ctx->keys == NULL) {
+        return ENOENT;
+    }
+
+    if (limit > NSS_ENUM_BATCH_MAX) {
+        limit = NSS_ENUM_BATCH_MAX;
+    }
+
+    for (; idx->domain < talloc_array_length(enum_ctx->keys)
+            && enum_ctx->keys[idx->domain] != NULL;
+            idx->domain++, idx->offset = 0) {
+        keys = enum_ctx->keys[idx->domain];
+
+        ret = nss_enum_keys_read_domain(mem_ctx, keys, idx, limit, _result);
+        if (ret != ENOENT) {
+            return ret;
+        }
+    }
+
+    return ENOENT;
+}
+
 static void
 nss_setnetgrent_timeout(struct tevent_context *ev,
                         struct tevent_timer *te,
@@ -357,7 +570,7 @@ nss_setnetgrent_send(TALLOC_CTX *mem_ctx,
     }
 
     return nss_setent_internal_send(mem_ctx, ev, cli_ctx, data, type, enum_ctx,
-                                    nss_setnetgrent_set_timeout);
+                                    nss_setnetgrent_set_timeout, false);
 }
 
 errno_t nss_setnetgrent_recv(struct tevent_req *req)
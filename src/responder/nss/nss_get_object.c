@@ -42,6 +42,9 @@ memcache_delete_entry_by_name(struct nss_ctx *nss_ctx,
     case SSS_MC_INITGROUPS:
         ret = sss_mmap_cache_initgr_invalidate(nss_ctx->initgr_mc_ctx, name);
         break;
+    case SSS_MC_SID:
+        ret = sss_mmap_cache_sid_invalidate(nss_ctx->sid_mc_ctx, name);
+        break;
     default:
         return EINVAL;
     }
@@ -85,6 +85,13 @@ nss_update_initgr_memcache(struct nss_ctx *nctx,
                   ret, strerror(ret));
         }
 
+        ret = sss_mmap_cache_sid_invalidate(nctx->sid_mc_ctx, delete_name);
+        if (ret != EOK && ret != ENOENT) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Internal failure in memory cache code: %d [%s]\n",
+                  ret, strerror(ret));
+        }
+
         /* Also invalidate his groups */
         changed = true;
     } else {
@@ -154,6 +161,10 @@ nss_memorycache_invalidate_users(TALLOC_CTX *mem_ctx,
 {
     DEBUG(SSSDBG_TRACE_LIBS, "Invalidating all users in memory cache\n");
     sss_mmap_cache_reset(nctx->pwd_mc_ctx);
+    sss_mmap_cache_reset(nctx->sid_mc_ctx);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
 
     return EOK;
 }
@@ -165,6 +176,11 @@ nss_memorycache_invalidate_groups(TALLOC_CTX *mem_ctx,
 {
     DEBUG(SSSDBG_TRACE_LIBS, "Invalidating all groups in memory cache\n");
     sss_mmap_cache_reset(nctx->grp_mc_ctx);
+    sss_mmap_cache_reset(nctx->sid_mc_ctx);
+    nss_grent_replies_flush(nctx);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
 
     return EOK;
 }
@@ -177,6 +193,9 @@ nss_memorycache_invalidate_initgroups(TALLOC_CTX *mem_ctx,
     DEBUG(SSSDBG_TRACE_LIBS,
           "Invalidating all initgroup records in memory cache\n");
     sss_mmap_cache_reset(nctx->initgr_mc_ctx);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
 
     return EOK;
 }
@@ -194,6 +213,9 @@ nss_memorycache_update_initgroups(TALLOC_CTX *mem_ctx,
 
     nss_update_initgr_memcache(nctx, user, domain,
                                talloc_array_length(groups), groups);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
 
     return EOK;
 }
@@ -209,6 +231,49 @@ nss_memorycache_invalidate_group_by_id(TALLOC_CTX *mem_ctx,
           "Invalidating group %u from memory cache\n", gid);
 
     sss_mmap_cache_gr_invalidate_gid(nctx->grp_mc_ctx, gid);
+    nss_grent_replies_flush(nctx);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
+
+    return EOK;
+}
+
+static errno_t
+nss_memorycache_invalidate_user_by_id(TALLOC_CTX *mem_ctx,
+                                     struct sbus_request *sbus_req,
+                                     struct nss_ctx *nctx,
+                                     uint32_t uid)
+{
+
+    DEBUG(SSSDBG_TRACE_LIBS,
+          "Invalidating user %u from memory cache\n", uid);
+
+    sss_mmap_cache_pw_invalidate_uid(nctx->pwd_mc_ctx, uid);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
+
+    return EOK;
+}
+
+static errno_t
+nss_memorycache_invalidate_domain(TALLOC_CTX *mem_ctx,
+                                  struct sbus_request *sbus_req,
+                                  struct nss_ctx *nctx,
+                                  const char *domain)
+{
+    DEBUG(SSSDBG_TRACE_LIBS,
+          "Invalidating records of domain [%s] in memory cache\n", domain);
+
+    sss_mmap_cache_invalidate_domain(nctx->pwd_mc_ctx, domain);
+    sss_mmap_cache_invalidate_domain(nctx->grp_mc_ctx, domain);
+    sss_mmap_cache_invalidate_domain(nctx->initgr_mc_ctx, domain);
+    sss_mmap_cache_invalidate_domain(nctx->sid_mc_ctx, domain);
+    nss_grent_replies_flush(nctx);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
 
     return EOK;
 }
@@ -226,7 +291,9 @@ nss_register_backend_iface(struct sbus_connection *conn,
             SBUS_SYNC(METHOD, sssd_nss_MemoryCache, InvalidateAllUsers, nss_memorycache_invalidate_users, nss_ctx),
             SBUS_SYNC(METHOD, sssd_nss_MemoryCache, InvalidateAllGroups, nss_memorycache_invalidate_groups, nss_ctx),
             SBUS_SYNC(METHOD, sssd_nss_MemoryCache, InvalidateAllInitgroups, nss_memorycache_invalidate_initgroups, nss_ctx),
-            SBUS_SYNC(METHOD, sssd_nss_MemoryCache, InvalidateGroupById, nss_memorycache_invalidate_group_by_id, nss_ctx)
+            SBUS_SYNC(METHOD, sssd_nss_MemoryCache, InvalidateGroupById, nss_memorycache_invalidate_group_by_id, nss_ctx),
+            SBUS_SYNC(METHOD, sssd_nss_MemoryCache, InvalidateUserById, nss_memorycache_invalidate_user_by_id, nss_ctx),
+            SBUS_SYNC(METHOD, sssd_nss_MemoryCache, InvalidateDomain, nss_memorycache_invalidate_domain, nss_ctx)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(SBUS_NO_PROPERTIES)
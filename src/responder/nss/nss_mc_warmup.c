@@ -0,0 +1,438 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <tevent.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "db/sysdb.h"
+#include "responder/nss/nss_private.h"
+#include "responder/nss/nss_protocol.h"
+#include "responder/common/cache_req/cache_req.h"
+
+/* Number of lookups done before giving control back to the main loop. */
+#define NSS_MC_WARMUP_BATCH 50
+/* Pause between two batches in microseconds. */
+#define NSS_MC_WARMUP_DELAY 100000
+
+struct nss_mc_warmup_entry {
+    struct sss_domain_info *domain;
+    const char *name;
+    uint64_t last_update;
+    bool is_user;
+};
+
+struct nss_mc_warmup_ctx {
+    struct nss_ctx *nss_ctx;
+    struct tevent_context *ev;
+    int max_entries;
+
+    struct nss_mc_warmup_entry *entries;
+    size_t count;
+
+    /* Index of the next entry and of the next lookup for this entry. */
+    size_t next;
+    int step;
+    int batch;
+};
+
+static void nss_mc_warmup_next(struct nss_mc_warmup_ctx *wctx);
+
+/* Most recently updated entries first. */
+static int nss_mc_warmup_cmp(const void *a, const void *b)
+{
+    const struct nss_mc_warmup_entry *ea = a;
+    const struct nss_mc_warmup_entry *eb = b;
+
+    if (ea->last_update == eb->last_update) {
+        return 0;
+    }
+
+    return ea->last_update > eb->last_update ? -1 : 1;
+}
+
+static errno_t
+nss_mc_warmup_add_domain(struct nss_mc_warmup_ctx *wctx,
+                         struct sss_domain_info *domain,
+                         bool is_user,
+                         time_t now)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char *attrs[] = { SYSDB_NAME, SYSDB_LAST_UPDATE, NULL };
+    struct nss_mc_warmup_entry *entries;
+    struct ldb_message **msgs;
+    const char *ts_filter;
+    const char *name;
+    size_t count;
+    size_t i;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ts_filter = talloc_asprintf(tmp_ctx, "(%s>=%ld)",
+                                SYSDB_CACHE_EXPIRE, (long)now);
+    if (ts_filter == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (is_user) {
+        ret = sysdb_search_users_by_timestamp(tmp_ctx, domain,
+                                              "("SYSDB_NAME"=*)", ts_filter,
+                                              attrs, &count, &msgs);
+    } else {
+        ret = sysdb_search_groups_by_timestamp(tmp_ctx, domain,
+                                               "("SYSDB_NAME"=*)", ts_filter,
+                                               attrs, &count, &msgs);
+    }
+    if (ret == ENOENT || (ret == EOK && count == 0)) {
+        ret = EOK;
+        goto done;
+    } else if (ret != EOK) {
+        goto done;
+    }
+
+    entries = talloc_realloc(wctx, wctx->entries, struct nss_mc_warmup_entry,
+                             wctx->count + count);
+    if (entries == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    wctx->entries = entries;
+
+    for (i = 0; i < count; i++) {
+        name = ldb_msg_find_attr_as_string(msgs[i], SYSDB_NAME, NULL);
+        if (name == NULL) {
+            continue;
+        }
+
+        entries[wctx->count].domain = domain;
+        entries[wctx->count].is_user = is_user;
+        entries[wctx->count].last_update =
+            ldb_msg_find_attr_as_uint64(msgs[i], SYSDB_LAST_UPDATE, 0);
+        entries[wctx->count].name = talloc_strdup(entries, name);
+        if (entries[wctx->count].name == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        wctx->count++;
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Selects up to max_entries users and max_entries groups that are still
+ * valid in the cache, the most recently updated ones first. */
+static errno_t nss_mc_warmup_select(struct nss_mc_warmup_ctx *wctx)
+{
+    struct sss_domain_info *dom;
+    size_t num_users;
+    size_t num_groups;
+    time_t now;
+    errno_t ret;
+
+    now = time(NULL);
+
+    for (dom = wctx->nss_ctx->rctx->domains;
+         dom != NULL;
+         dom = get_next_domain(dom, SSS_GND_DESCEND)) {
+        ret = nss_mc_warmup_add_domain(wctx, dom, true, now);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Unable to search users in domain %s [%d]: %s\n",
+                  dom->name, ret, sss_strerror(ret));
+        }
+    }
+
+    if (wctx->count > 0) {
+        qsort(wctx->entries, wctx->count, sizeof(struct nss_mc_warmup_entry),
+              nss_mc_warmup_cmp);
+        wctx->count = MIN(wctx->count, wctx->max_entries);
+    }
+    num_users = wctx->count;
+
+    for (dom = wctx->nss_ctx->rctx->domains;
+         dom != NULL;
+         dom = get_next_domain(dom, SSS_GND_DESCEND)) {
+        ret = nss_mc_warmup_add_domain(wctx, dom, false, now);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Unable to search groups in domain %s [%d]: %s\n",
+                  dom->name, ret, sss_strerror(ret));
+        }
+    }
+
+    num_groups = wctx->count - num_users;
+    if (num_groups > 0) {
+        qsort(&wctx->entries[num_users], num_groups,
+              sizeof(struct nss_mc_warmup_entry), nss_mc_warmup_cmp);
+        wctx->count = num_users + MIN(num_groups, wctx->max_entries);
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Warming up memory cache with %zu users "
+          "and %zu groups\n", num_users, wctx->count - num_users);
+
+    return EOK;
+}
+
+/* Users get a passwd and an initgroups record, groups a group record. */
+static enum cache_req_type
+nss_mc_warmup_type(struct nss_mc_warmup_ctx *wctx,
+                   struct nss_mc_warmup_entry *entry)
+{
+    if (!entry->is_user) {
+        return CACHE_REQ_GROUP_BY_NAME;
+    }
+
+    return wctx->step == 0 ? CACHE_REQ_USER_BY_NAME : CACHE_REQ_INITGROUPS;
+}
+
+static errno_t
+nss_mc_warmup_store(struct nss_mc_warmup_ctx *wctx,
+                    enum cache_req_type type,
+                    struct cache_req_result *result)
+{
+    struct nss_ctx *nss_ctx = wctx->nss_ctx;
+    struct nss_cmd_ctx *cmd_ctx;
+    struct sss_packet *packet;
+    struct sized_string *sized;
+    enum sss_cli_command cmd;
+    nss_protocol_fill_packet_fn fill_fn;
+    errno_t ret;
+
+    switch (type) {
+    case CACHE_REQ_USER_BY_NAME:
+        cmd = SSS_NSS_GETPWNAM;
+        fill_fn = nss_protocol_fill_pwent;
+        break;
+    case CACHE_REQ_GROUP_BY_NAME:
+        cmd = SSS_NSS_GETGRNAM;
+        fill_fn = nss_protocol_fill_grent;
+        break;
+    case CACHE_REQ_INITGROUPS:
+        cmd = SSS_NSS_INITGR;
+        fill_fn = nss_protocol_fill_initgr;
+        break;
+    default:
+        return EINVAL;
+    }
+
+    cmd_ctx = talloc_zero(NULL, struct nss_cmd_ctx);
+    if (cmd_ctx == NULL) {
+        return ENOMEM;
+    }
+    cmd_ctx->nss_ctx = nss_ctx;
+    cmd_ctx->type = type;
+    cmd_ctx->fill_fn = fill_fn;
+
+    if (type == CACHE_REQ_INITGROUPS) {
+        /* Clients look up initgroups by the name they got from getpwnam. */
+        ret = sized_output_name(cmd_ctx, nss_ctx->rctx,
+                                nss_get_name_from_msg(result->domain,
+                                                      result->msgs[0]),
+                                result->domain, &sized);
+        if (ret != EOK) {
+            goto done;
+        }
+        cmd_ctx->rawname = sized->str;
+    }
+
+    /* The packet is never sent, the fill function stores the records
+     * in the memory cache as a side effect. */
+    ret = sss_packet_new(cmd_ctx, 0, cmd, &packet);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = fill_fn(nss_ctx, cmd_ctx, packet, result);
+
+done:
+    talloc_free(cmd_ctx);
+    return ret;
+}
+
+static void nss_mc_warmup_done(struct tevent_req *subreq)
+{
+    struct nss_mc_warmup_ctx *wctx;
+    struct nss_mc_warmup_entry *entry;
+    struct cache_req_result *result;
+    enum cache_req_type type;
+    errno_t ret;
+
+    wctx = tevent_req_callback_data(subreq, struct nss_mc_warmup_ctx);
+    entry = &wctx->entries[wctx->next];
+    type = nss_mc_warmup_type(wctx, entry);
+
+    ret = cache_req_single_domain_recv(wctx, subreq, &result);
+    talloc_zfree(subreq);
+    if (ret == EOK) {
+        ret = nss_mc_warmup_store(wctx, type, result);
+        talloc_free(result);
+    }
+    if (ret != EOK && ret != ENOENT) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to warm up memory cache for %s [%d]: %s\n",
+              entry->name, ret, sss_strerror(ret));
+    }
+
+    if (entry->is_user && wctx->step == 0) {
+        wctx->step = 1;
+    } else {
+        wctx->step = 0;
+        wctx->next++;
+    }
+
+    wctx->batch++;
+    nss_mc_warmup_next(wctx);
+}
+
+static void nss_mc_warmup_batch(struct tevent_context *ev,
+                                struct tevent_timer *te,
+                                struct timeval current_time,
+                                void *pvt)
+{
+    struct nss_mc_warmup_ctx *wctx;
+
+    wctx = talloc_get_type(pvt, struct nss_mc_warmup_ctx);
+    wctx->batch = 0;
+    nss_mc_warmup_next(wctx);
+}
+
+static void nss_mc_warmup_next(struct nss_mc_warmup_ctx *wctx)
+{
+    struct nss_mc_warmup_entry *entry;
+    struct cache_req_data *data;
+    struct tevent_req *subreq;
+    struct tevent_timer *te;
+    enum cache_req_type type;
+    char *shortname;
+    errno_t ret;
+
+    while (wctx->next < wctx->count) {
+        if (wctx->batch >= NSS_MC_WARMUP_BATCH) {
+            /* Let the clients in before going on. */
+            te = tevent_add_timer(wctx->ev, wctx,
+                                  tevent_timeval_current_ofs(
+                                      0, NSS_MC_WARMUP_DELAY),
+                                  nss_mc_warmup_batch, wctx);
+            if (te == NULL) {
+                DEBUG(SSSDBG_OP_FAILURE, "Unable to schedule next batch\n");
+                break;
+            }
+            return;
+        }
+
+        entry = &wctx->entries[wctx->next];
+        type = nss_mc_warmup_type(wctx, entry);
+
+        ret = sss_parse_internal_fqname(wctx, entry->name, &shortname, NULL);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to parse name %s\n",
+                  entry->name);
+            wctx->step = 0;
+            wctx->next++;
+            continue;
+        }
+
+        data = cache_req_data_name(wctx, type, shortname);
+        talloc_free(shortname);
+        if (data == NULL) {
+            break;
+        }
+
+        /* Only what is already cached is used, never contact the backend. */
+        cache_req_data_set_bypass_dp(data, true);
+
+        subreq = cache_req_send(wctx, wctx->ev, wctx->nss_ctx->rctx,
+                                wctx->nss_ctx->rctx->ncache, 0,
+                                CACHE_REQ_POSIX_DOM, entry->domain->name,
+                                data);
+        if (subreq == NULL) {
+            talloc_free(data);
+            break;
+        }
+        talloc_steal(subreq, data);
+
+        tevent_req_set_callback(subreq, nss_mc_warmup_done, wctx);
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Memory cache warm-up finished\n");
+    talloc_free(wctx);
+}
+
+static void nss_mc_warmup_run(struct tevent_context *ev,
+                              struct tevent_timer *te,
+                              struct timeval current_time,
+                              void *pvt)
+{
+    struct nss_mc_warmup_ctx *wctx;
+    errno_t ret;
+
+    wctx = talloc_get_type(pvt, struct nss_mc_warmup_ctx);
+
+    ret = nss_mc_warmup_select(wctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to select warm-up entries [%d]: %s\n",
+              ret, sss_strerror(ret));
+        talloc_free(wctx);
+        return;
+    }
+
+    nss_mc_warmup_next(wctx);
+}
+
+errno_t nss_mc_warmup_start(struct nss_ctx *nss_ctx, int max_entries)
+{
+    struct nss_mc_warmup_ctx *wctx;
+    struct tevent_timer *te;
+
+    if (max_entries <= 0) {
+        return EOK;
+    }
+
+    if (nss_ctx->pwd_mc_ctx == NULL && nss_ctx->grp_mc_ctx == NULL
+            && nss_ctx->initgr_mc_ctx == NULL) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Memory cache is disabled, skipping warm-up\n");
+        return EOK;
+    }
+
+    wctx = talloc_zero(nss_ctx, struct nss_mc_warmup_ctx);
+    if (wctx == NULL) {
+        return ENOMEM;
+    }
+    wctx->nss_ctx = nss_ctx;
+    wctx->ev = nss_ctx->rctx->ev;
+    wctx->max_entries = max_entries;
+
+    /* Run from the main loop so the socket is served from the start. */
+    te = tevent_add_timer(wctx->ev, wctx, tevent_timeval_current(),
+                          nss_mc_warmup_run, wctx);
+    if (te == NULL) {
+        talloc_free(wctx);
+        return ENOMEM;
+    }
+
+    return EOK;
+}
@@ -36,13 +36,33 @@
 struct nss_enum_index {
     unsigned int domain;
     unsigned int result;
+    /* Position in the keys of the domain if they are read in batches */
+    size_t offset;
+};
+
+/* Users and groups are enumerated in batches. Only the DNs of the objects
+ * are kept, each getent call reads the next entries from the cache. */
+struct nss_enum_keys {
+    struct sss_domain_info *domain;
+    bool group;
+
+    /* NUL separated DNs */
+    char *dns;
+    size_t size;
 };
 
 struct nss_enum_ctx {
     struct cache_req_result **result;
+    /* Set instead of result if the objects are read in batches */
+    struct nss_enum_keys **keys;
     struct sysdb_netgroup_ctx **netgroup;
     size_t netgroup_count;
 
+    /* Triples of the netgroup and of all netgroups nested in it, built by
+     * the first innetgr request for the netgroup. */
+    struct sysdb_netgroup_ctx **triples;
+    size_t triples_count;
+
     /* Ongoing cache request that is constructing enumeration result. */
     struct tevent_req *ongoing;
 
@@ -87,12 +107,25 @@ struct nss_ctx {
     struct nss_enum_ctx *netent;
     hash_table_t *netgrent;
 
+    /* Encoded entries of large groups. */
+    hash_table_t *grent_replies;
+
     /* Memory cache. */
     struct sss_mc_ctx *pwd_mc_ctx;
     struct sss_mc_ctx *grp_mc_ctx;
     struct sss_mc_ctx *initgr_mc_ctx;
+    struct sss_mc_ctx *sid_mc_ctx;
+    struct sss_mc_ctx *svc_mc_ctx;
+    struct sss_mc_ctx *host_mc_ctx;
+    struct sss_mc_ctx *netgr_mc_ctx;
     uid_t mc_uid;
     gid_t mc_gid;
+    time_t mc_timeout;
+    time_t mc_max_timeout;
+
+    /* Worker processes, 0 is the primary process. */
+    int worker_index;
+    struct nss_workers_ctx *workers;
 };
 
 struct sss_cmd_table *get_nss_cmds(void);
@@ -132,6 +165,13 @@ nss_setent_send(TALLOC_CTX *mem_ctx,
 errno_t
 nss_setent_recv(struct tevent_req *req);
 
+errno_t
+nss_enum_keys_read(TALLOC_CTX *mem_ctx,
+                   struct nss_enum_ctx *enum_ctx,
+                   struct nss_enum_index *idx,
+                   uint32_t limit,
+                   struct cache_req_result **_result);
+
 struct tevent_req *
 nss_setnetgrent_send(TALLOC_CTX *mem_ctx,
                      struct tevent_context *ev,
@@ -143,6 +183,20 @@ nss_setnetgrent_send(TALLOC_CTX *mem_ctx,
 errno_t
 nss_setnetgrent_recv(struct tevent_req *req);
 
+errno_t nss_mc_warmup_start(struct nss_ctx *nss_ctx, int max_entries);
+
+errno_t nss_workers_start(struct nss_ctx *nss_ctx,
+                          const char **argv,
+                          int num_workers);
+
+void nss_workers_signal(struct nss_ctx *nss_ctx, int signum);
+
+void nss_workers_flush(struct nss_ctx *nss_ctx);
+
+errno_t nss_worker_flush_setup(struct nss_ctx *nss_ctx);
+
+void nss_grent_replies_flush(struct nss_ctx *nss_ctx);
+
 /* Utils. */
 
 const char *
@@ -153,4 +207,9 @@ const char *
 nss_get_pwfield(struct nss_ctx *nctx,
                 struct sss_domain_info *dom);
 
+time_t
+nss_get_mc_ttl(struct nss_ctx *nctx,
+               struct ldb_message *msg,
+               const char *expire_attr);
+
 #endif /* _NSS_PRIVATE_H_ */
@@ -20,6 +20,7 @@
 
 #include "util/util.h"
 #include "util/cert.h"
+#include "util/mmap_cache.h"
 #include "lib/idmap/sss_idmap.h"
 #include "responder/nss/nss_protocol.h"
 #include <arpa/inet.h>
@@ -99,6 +100,229 @@ done:
     nss_protocol_done(cli_ctx, ret);
 }
 
+void nss_protocol_reply_multi(struct cli_ctx *cli_ctx,
+                              struct nss_ctx *nss_ctx,
+                              struct nss_cmd_ctx *cmd_ctx,
+                              struct cache_req_result **results,
+                              uint32_t num_results,
+                              bool with_index,
+                              nss_protocol_fill_packet_fn fill_fn)
+{
+    struct cli_protocol *pctx;
+    struct sss_packet *packet;
+    uint32_t num_entries;
+    uint32_t total = 0;
+    uint8_t *entries;
+    size_t entries_len;
+    uint8_t *body;
+    size_t body_len;
+    size_t rp;
+    uint32_t i;
+    errno_t ret;
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+
+    ret = sss_packet_new(pctx->creq, 2 * sizeof(uint32_t),
+                         sss_packet_get_cmd(pctx->creq->in),
+                         &pctx->creq->out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* Each result is filled into its own packet, the entries are then
+     * appended to the reply after the common header. */
+    for (i = 0; i < num_results; i++) {
+        if (results[i] == NULL) {
+            continue;
+        }
+
+        ret = sss_packet_new(NULL, 0, sss_packet_get_cmd(pctx->creq->in),
+                             &packet);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = fill_fn(nss_ctx, cmd_ctx, packet, results[i]);
+        if (ret == ENOMEM) {
+            talloc_free(packet);
+            goto done;
+        } else if (ret != EOK) {
+            /* e.g. a well known SID which has no POSIX ID, the other
+             * results are still returned */
+            if (ret != ENOENT) {
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "Unable to fill result %u [%d]: %s\n",
+                      i, ret, sss_strerror(ret));
+            }
+            talloc_free(packet);
+            continue;
+        }
+
+        sss_packet_get_body(packet, &entries, &entries_len);
+        if (entries_len <= 2 * sizeof(uint32_t)) {
+            talloc_free(packet);
+            continue;
+        }
+        SAFEALIGN_COPY_UINT32(&num_entries, entries, NULL);
+        entries += 2 * sizeof(uint32_t);
+        entries_len -= 2 * sizeof(uint32_t);
+
+        sss_packet_get_body(pctx->creq->out, &body, &rp);
+        ret = sss_packet_grow(pctx->creq->out, entries_len
+                              + (with_index ? sizeof(uint32_t) : 0));
+        if (ret != EOK) {
+            talloc_free(packet);
+            goto done;
+        }
+
+        sss_packet_get_body(pctx->creq->out, &body, &body_len);
+        if (with_index) {
+            SAFEALIGN_SET_UINT32(body + rp, i, &rp);
+        }
+        memcpy(body + rp, entries, entries_len);
+        talloc_free(packet);
+
+        total += num_entries;
+    }
+
+    sss_packet_get_body(pctx->creq->out, &body, &body_len);
+    SAFEALIGN_COPY_UINT32(body, &total, NULL);
+    SAFEALIGN_SETMEM_UINT32(body + sizeof(uint32_t), 0, NULL); /* reserved */
+
+    sss_packet_set_error(pctx->creq->out, EOK);
+    ret = EOK;
+
+done:
+    nss_protocol_done(cli_ctx, ret);
+}
+
+void nss_protocol_reply_pw_initgr(struct cli_ctx *cli_ctx,
+                                  struct nss_ctx *nss_ctx,
+                                  struct nss_cmd_ctx *cmd_ctx,
+                                  struct cache_req_result *pw_result,
+                                  struct cache_req_result *initgr_result)
+{
+    struct cli_protocol *pctx;
+    struct sss_packet *packets[2] = { NULL, NULL };
+    nss_protocol_fill_packet_fn fill_fns[2] = { nss_protocol_fill_pwent,
+                                                nss_protocol_fill_initgr };
+    struct cache_req_result *results[2] = { pw_result, initgr_result };
+    uint8_t *parts[2];
+    size_t part_lens[2];
+    uint32_t pw_len;
+    uint8_t *body;
+    size_t body_len;
+    size_t rp;
+    int i;
+    errno_t ret;
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+
+    /* Both parts are filled as the replies to SSS_NSS_GETPWNAM_EX and
+     * SSS_NSS_INITGR_EX, which also stores them in the memory caches. */
+    for (i = 0; i < 2; i++) {
+        ret = sss_packet_new(NULL, 0, sss_packet_get_cmd(pctx->creq->in),
+                             &packets[i]);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = fill_fns[i](nss_ctx, cmd_ctx, packets[i], results[i]);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        sss_packet_get_body(packets[i], &parts[i], &part_lens[i]);
+    }
+
+    ret = sss_packet_new(pctx->creq,
+                         sizeof(uint32_t) + part_lens[0] + part_lens[1],
+                         sss_packet_get_cmd(pctx->creq->in),
+                         &pctx->creq->out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    sss_packet_get_body(pctx->creq->out, &body, &body_len);
+    rp = 0;
+    pw_len = part_lens[0];
+    SAFEALIGN_SET_UINT32(&body[rp], pw_len, &rp);
+    memcpy(&body[rp], parts[0], part_lens[0]);
+    rp += part_lens[0];
+    memcpy(&body[rp], parts[1], part_lens[1]);
+
+    sss_packet_set_error(pctx->creq->out, EOK);
+
+done:
+    talloc_free(packets[0]);
+    talloc_free(packets[1]);
+    nss_protocol_done(cli_ctx, ret);
+}
+
+static void nss_protocol_mc_store(struct cli_ctx *cli_ctx,
+                                  struct sss_mc_ctx **_mcc,
+                                  uint8_t *reply,
+                                  size_t reply_len,
+                                  time_t ttl)
+{
+    struct cli_protocol *pctx;
+    struct sized_string key;
+    uint8_t *req;
+    size_t req_len;
+    char *keystr;
+    errno_t ret;
+
+    if (*_mcc == NULL) {
+        return;
+    }
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+    sss_packet_get_body(pctx->creq->in, &req, &req_len);
+    if (req_len == 0 || req_len > MC_REPLY_MAX_REQ_LEN) {
+        return;
+    }
+
+    keystr = talloc_size(NULL, MC_REPLY_KEY_SIZE(req_len));
+    if (keystr == NULL) {
+        return;
+    }
+
+    sss_mc_reply_key(sss_packet_get_cmd(pctx->creq->in), req, req_len,
+                     keystr);
+    to_sized_string(&key, keystr);
+
+    ret = sss_mmap_cache_reply_store(_mcc, &key, reply, reply_len, ttl);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Failed to store reply in memory cache [%d]: %s\n",
+              ret, sss_strerror(ret));
+    }
+
+    talloc_free(keystr);
+}
+
+void nss_protocol_mc_store_reply(struct cli_ctx *cli_ctx,
+                                 struct sss_mc_ctx **_mcc,
+                                 uint8_t *reply,
+                                 size_t reply_len)
+{
+    nss_protocol_mc_store(cli_ctx, _mcc, reply, reply_len, 0);
+}
+
+void nss_protocol_mc_store_notfound(struct cli_ctx *cli_ctx,
+                                    struct sss_mc_ctx **_mcc,
+                                    time_t ttl)
+{
+    /* the body of sss_cmd_send_empty(): no results and the reserved field */
+    uint8_t reply[2 * sizeof(uint32_t)] = { 0 };
+
+    if (ttl == 0) {
+        return;
+    }
+
+    nss_protocol_mc_store(cli_ctx, _mcc, reply, sizeof(reply), ttl);
+}
+
 errno_t
 nss_protocol_parse_name(struct cli_ctx *cli_ctx, const char **_rawname)
 {
@@ -245,12 +469,163 @@ nss_protocol_parse_id_ex(struct cli_ctx *cli_ctx, uint32_t *_id,
     return EOK;
 }
 
+errno_t
+nss_protocol_parse_id_multi(TALLOC_CTX *mem_ctx,
+                            struct cli_ctx *cli_ctx,
+                            uint32_t **_ids,
+                            uint32_t *_count)
+{
+    struct cli_protocol *pctx;
+    uint8_t *body;
+    size_t blen;
+    size_t rp;
+    uint32_t count;
+    uint32_t *ids;
+    uint32_t i;
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+
+    sss_packet_get_body(pctx->creq->in, &body, &blen);
+
+    /* count, then count IDs */
+    if (blen < sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    rp = 0;
+    SAFEALIGN_COPY_UINT32(&count, body, &rp);
+    if (count == 0 || count > SSS_NSS_MULTI_MAX_IDS
+            || blen != (count + 1) * sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    ids = talloc_array(mem_ctx, uint32_t, count);
+    if (ids == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        SAFEALIGN_COPY_UINT32(&ids[i], body + rp, &rp);
+    }
+
+    *_ids = ids;
+    *_count = count;
+
+    return EOK;
+}
+
+errno_t
+nss_protocol_parse_id_type_multi(TALLOC_CTX *mem_ctx,
+                                 struct cli_ctx *cli_ctx,
+                                 uint32_t **_ids,
+                                 uint32_t **_types,
+                                 uint32_t *_count)
+{
+    struct cli_protocol *pctx;
+    uint8_t *body;
+    size_t blen;
+    size_t rp;
+    uint32_t count;
+    uint32_t *ids;
+    uint32_t *types;
+    uint32_t i;
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+
+    sss_packet_get_body(pctx->creq->in, &body, &blen);
+
+    /* count, then count pairs of ID and ID type */
+    if (blen < sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    rp = 0;
+    SAFEALIGN_COPY_UINT32(&count, body, &rp);
+    if (count == 0 || count > SSS_NSS_MULTI_MAX_IDS
+            || blen != (2 * count + 1) * sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    ids = talloc_array(mem_ctx, uint32_t, count);
+    types = talloc_array(mem_ctx, uint32_t, count);
+    if (ids == NULL || types == NULL) {
+        talloc_free(ids);
+        talloc_free(types);
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        SAFEALIGN_COPY_UINT32(&ids[i], body + rp, &rp);
+        SAFEALIGN_COPY_UINT32(&types[i], body + rp, &rp);
+    }
+
+    *_ids = ids;
+    *_types = types;
+    *_count = count;
+
+    return EOK;
+}
+
 errno_t
 nss_protocol_parse_limit(struct cli_ctx *cli_ctx, uint32_t *_limit)
 {
     return nss_protocol_parse_id(cli_ctx, _limit);
 }
 
+errno_t
+nss_protocol_parse_innetgr(struct cli_ctx *cli_ctx,
+                           const char **_netgroup,
+                           const char **_host,
+                           const char **_user,
+                           const char **_domain)
+{
+    struct cli_protocol *pctx;
+    const char *fields[4];
+    size_t len;
+    size_t ofs;
+    uint8_t *body;
+    size_t blen;
+    int i;
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+
+    sss_packet_get_body(pctx->creq->in, &body, &blen);
+
+    /* If not terminated fail. */
+    if (blen == 0 || body[blen - 1] != '\0') {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Body is not null terminated\n");
+        return EINVAL;
+    }
+
+    /* Netgroup, host, user and domain, an empty string is no value. */
+    for (i = 0, ofs = 0; i < 4; i++) {
+        if (ofs >= blen) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Missing innetgr field\n");
+            return EINVAL;
+        }
+
+        len = strlen((const char *)body + ofs);
+        if (!sss_utf8_check(body + ofs, len)) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Field is not UTF-8 string\n");
+            return EINVAL;
+        }
+
+        fields[i] = len == 0 ? NULL : (const char *)body + ofs;
+        ofs += len + 1;
+    }
+
+    if (fields[0] == NULL) {
+        return EINVAL;
+    }
+
+    *_netgroup = fields[0];
+    *_host = fields[1];
+    *_user = fields[2];
+    *_domain = fields[3];
+
+    return EOK;
+}
+
 errno_t
 nss_protocol_parse_svc_name(struct cli_ctx *cli_ctx,
                             const char **_name,
@@ -441,6 +816,151 @@ nss_protocol_parse_sid(struct cli_ctx *cli_ctx,
     return EOK;
 }
 
+errno_t
+nss_protocol_parse_sid_multi(TALLOC_CTX *mem_ctx,
+                             struct cli_ctx *cli_ctx,
+                             const char ***_sids,
+                             uint32_t *_count)
+{
+    struct cli_protocol *pctx;
+    struct nss_ctx *nss_ctx;
+    const char **sids;
+    uint8_t *bin_sid;
+    size_t bin_len;
+    uint8_t *body;
+    uint8_t *end;
+    size_t blen;
+    size_t rp;
+    uint32_t count;
+    uint32_t i;
+    enum idmap_error_code err;
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+    nss_ctx = talloc_get_type(cli_ctx->rctx->pvt_ctx, struct nss_ctx);
+
+    sss_packet_get_body(pctx->creq->in, &body, &blen);
+
+    /* count, then count zero terminated SIDs */
+    if (blen < sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    rp = 0;
+    SAFEALIGN_COPY_UINT32(&count, body, &rp);
+    if (count == 0 || count > SSS_NSS_MULTI_MAX_IDS) {
+        return EINVAL;
+    }
+
+    sids = talloc_array(mem_ctx, const char *, count);
+    if (sids == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        end = rp < blen ? memchr(body + rp, '\0', blen - rp) : NULL;
+        if (end == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "SID %u is not null terminated\n", i);
+            goto fail;
+        }
+        sids[i] = (const char *)(body + rp);
+        rp = end - body + 1;
+
+        err = sss_idmap_sid_to_bin_sid(nss_ctx->idmap_ctx, sids[i], &bin_sid,
+                                       &bin_len);
+        if (err != IDMAP_SUCCESS) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Unable to convert SID to binary [%s].\n", sids[i]);
+            goto fail;
+        }
+        sss_idmap_free_bin_sid(nss_ctx->idmap_ctx, bin_sid);
+    }
+
+    if (rp != blen) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unexpected data after the SIDs\n");
+        goto fail;
+    }
+
+    *_sids = sids;
+    *_count = count;
+
+    return EOK;
+
+fail:
+    talloc_free(sids);
+    return EINVAL;
+}
+
+errno_t
+nss_protocol_parse_name_multi(TALLOC_CTX *mem_ctx,
+                              struct cli_ctx *cli_ctx,
+                              const char ***_names,
+                              uint32_t *_count)
+{
+    struct cli_protocol *pctx;
+    const char **names;
+    uint8_t *body;
+    uint8_t *end;
+    size_t blen;
+    size_t rp;
+    uint32_t count;
+    uint32_t i;
+
+    pctx = talloc_get_type(cli_ctx->protocol_ctx, struct cli_protocol);
+
+    sss_packet_get_body(pctx->creq->in, &body, &blen);
+
+    /* count, then count zero terminated names */
+    if (blen < sizeof(uint32_t)) {
+        return EINVAL;
+    }
+
+    rp = 0;
+    SAFEALIGN_COPY_UINT32(&count, body, &rp);
+    if (count == 0 || count > SSS_NSS_MULTI_MAX_IDS) {
+        return EINVAL;
+    }
+
+    names = talloc_array(mem_ctx, const char *, count);
+    if (names == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        end = rp < blen ? memchr(body + rp, '\0', blen - rp) : NULL;
+        if (end == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Name %u is not null terminated\n", i);
+            goto fail;
+        }
+
+        if (end == body + rp) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Name %u is empty\n", i);
+            goto fail;
+        }
+
+        if (!sss_utf8_check(body + rp, end - (body + rp))) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Name %u is not UTF-8 string\n", i);
+            goto fail;
+        }
+
+        names[i] = (const char *)(body + rp);
+        rp = end - body + 1;
+    }
+
+    if (rp != blen) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unexpected data after the names\n");
+        goto fail;
+    }
+
+    *_names = names;
+    *_count = count;
+
+    return EOK;
+
+fail:
+    talloc_free(names);
+    return EINVAL;
+}
+
 errno_t
 nss_protocol_parse_addr(struct cli_ctx *cli_ctx,
                         uint32_t *_af,
@@ -84,6 +84,47 @@ void nss_protocol_reply(struct cli_ctx *cli_ctx,
                         struct cache_req_result *result,
                         nss_protocol_fill_packet_fn fill_fn);
 
+/**
+ * Create and send one response packet with the entries of all results,
+ * results that are NULL or cannot be filled are skipped. If with_index is
+ * true each entry is prefixed with the index of its result.
+ */
+void nss_protocol_reply_multi(struct cli_ctx *cli_ctx,
+                              struct nss_ctx *nss_ctx,
+                              struct nss_cmd_ctx *cmd_ctx,
+                              struct cache_req_result **results,
+                              uint32_t num_results,
+                              bool with_index,
+                              nss_protocol_fill_packet_fn fill_fn);
+
+/**
+ * Create and send the reply to SSS_NSS_GETPWNAM_INITGR, the user entry
+ * prefixed with its length followed by the groups of the user.
+ */
+void nss_protocol_reply_pw_initgr(struct cli_ctx *cli_ctx,
+                                  struct nss_ctx *nss_ctx,
+                                  struct nss_cmd_ctx *cmd_ctx,
+                                  struct cache_req_result *pw_result,
+                                  struct cache_req_result *initgr_result);
+
+/**
+ * Store a reply to the current request in a reply memory cache, keyed by
+ * the request command and body.
+ */
+void nss_protocol_mc_store_reply(struct cli_ctx *cli_ctx,
+                                 struct sss_mc_ctx **_mcc,
+                                 uint8_t *reply,
+                                 size_t reply_len);
+
+/**
+ * Store the reply that the object of the current request was not found in
+ * a reply memory cache for ttl seconds. The clients answer the request
+ * from the cache without asking the responder until the record expires.
+ */
+void nss_protocol_mc_store_notfound(struct cli_ctx *cli_ctx,
+                                    struct sss_mc_ctx **_mcc,
+                                    time_t ttl);
+
 /* Parse input packet. */
 
 errno_t
@@ -100,9 +141,29 @@ errno_t
 nss_protocol_parse_id_ex(struct cli_ctx *cli_ctx, uint32_t *_id,
                          uint32_t *_flags);
 
+errno_t
+nss_protocol_parse_id_multi(TALLOC_CTX *mem_ctx,
+                            struct cli_ctx *cli_ctx,
+                            uint32_t **_ids,
+                            uint32_t *_count);
+
+errno_t
+nss_protocol_parse_id_type_multi(TALLOC_CTX *mem_ctx,
+                                 struct cli_ctx *cli_ctx,
+                                 uint32_t **_ids,
+                                 uint32_t **_types,
+                                 uint32_t *_count);
+
 errno_t
 nss_protocol_parse_limit(struct cli_ctx *cli_ctx, uint32_t *_limit);
 
+errno_t
+nss_protocol_parse_innetgr(struct cli_ctx *cli_ctx,
+                           const char **_netgroup,
+                           const char **_host,
+                           const char **_user,
+                           const char **_domain);
+
 errno_t
 nss_protocol_parse_svc_name(struct cli_ctx *cli_ctx,
                             const char **_name,
@@ -121,6 +182,18 @@ errno_t
 nss_protocol_parse_sid(struct cli_ctx *cli_ctx,
                        const char **_sid);
 
+errno_t
+nss_protocol_parse_sid_multi(TALLOC_CTX *mem_ctx,
+                             struct cli_ctx *cli_ctx,
+                             const char ***_sids,
+                             uint32_t *_count);
+
+errno_t
+nss_protocol_parse_name_multi(TALLOC_CTX *mem_ctx,
+                              struct cli_ctx *cli_ctx,
+                              const char ***_names,
+                              uint32_t *_count);
+
 errno_t
 nss_protocol_parse_addr(struct cli_ctx *cli_ctx,
                         uint32_t *_af,
@@ -159,6 +232,12 @@ nss_protocol_fill_setnetgrent(struct nss_ctx *nss_ctx,
                               struct sss_packet *packet,
                               struct cache_req_result *result);
 
+errno_t
+nss_protocol_fill_innetgr(struct nss_ctx *nss_ctx,
+                          struct nss_cmd_ctx *cmd_ctx,
+                          struct sss_packet *packet,
+                          struct cache_req_result *result);
+
 errno_t
 nss_protocol_fill_svcent(struct nss_ctx *nss_ctx,
                          struct nss_cmd_ctx *cmd_ctx,
@@ -18,8 +18,32 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "util/sss_ptr_hash.h"
+#include "shared/murmurhash3.h"
 #include "responder/nss/nss_protocol.h"
 
+/* Building the reply of a group with thousands of members formats the name
+ * of every member, which is most of the time of a getgrnam() of such a
+ * group. Such groups are often too large for the memory cache, so the
+ * clients ask the responder again and again. The encoded entries of large
+ * groups are kept and copied into the next replies as long as the cached
+ * group did not change.
+ *
+ * Members filtered by the negative cache are decided when the entry is
+ * built, so the entries live no longer than the negative cache entries. */
+#define NSS_GRENT_REPLY_MIN_MEMBERS 1000
+#define NSS_GRENT_REPLY_MAX_ENTRIES 64
+
+struct nss_grent_reply {
+    uint32_t state;
+    uint32_t num_members;
+    time_t expire;
+
+    /* gid, number of members, name, password and members as in the reply */
+    uint8_t *data;
+    size_t len;
+};
+
 static errno_t
 nss_get_grent(TALLOC_CTX *mem_ctx,
               struct nss_ctx *nss_ctx,
@@ -195,6 +219,9 @@ nss_protocol_fill_members(struct sss_packet *packet,
             sss_packet_get_body(packet, &body, &body_len);
             SAFEALIGN_SET_STRING(&body[*_rp], name->str, name->len, _rp);
 
+            /* Do not keep a copy of every member of a large group */
+            talloc_free(name);
+
             num_members++;
         }
     }
@@ -208,6 +235,184 @@ done:
     return ret;
 }
 
+static uint32_t
+nss_grent_reply_hash_el(struct ldb_message_element *el, uint32_t state)
+{
+    unsigned int i;
+
+    if (el == NULL) {
+        return state;
+    }
+
+    for (i = 0; i < el->num_values; i++) {
+        state = murmurhash3((const char *)el->values[i].data,
+                            el->values[i].length + 1, state);
+    }
+
+    return state;
+}
+
+/* Returns false if the group is too small to keep its reply, otherwise
+ * _state is set to a value which changes with every change of the group
+ * that changes its reply. */
+static bool
+nss_grent_reply_state(struct sss_domain_info *domain,
+                      struct ldb_message *msg,
+                      struct sized_string *name,
+                      struct sized_string *pwfield,
+                      uint32_t gid,
+                      uint32_t *_state)
+{
+    struct ldb_message_element *members;
+    struct ldb_message_element *ghosts;
+    unsigned int num_values = 0;
+    uint32_t state;
+
+    members = nss_get_group_members(domain, msg);
+    ghosts = nss_get_group_ghosts(domain, msg, name->str);
+    if (members != NULL) {
+        num_values += members->num_values;
+    }
+    if (ghosts != NULL) {
+        num_values += ghosts->num_values;
+    }
+
+    if (num_values < NSS_GRENT_REPLY_MIN_MEMBERS) {
+        return false;
+    }
+
+    state = murmurhash3(name->str, name->len, gid);
+    state = murmurhash3(pwfield->str, pwfield->len, state);
+    state = murmurhash3((const char *)&num_values, sizeof(num_values), state);
+    state = nss_grent_reply_hash_el(members, state);
+    state = nss_grent_reply_hash_el(ghosts, state);
+
+    *_state = state;
+    return true;
+}
+
+static struct nss_grent_reply *
+nss_grent_reply_lookup(struct nss_ctx *nss_ctx,
+                       struct ldb_message *msg,
+                       uint32_t state)
+{
+    struct nss_grent_reply *reply;
+    const char *key;
+
+    if (nss_ctx->grent_replies == NULL) {
+        return NULL;
+    }
+
+    key = ldb_dn_get_linearized(msg->dn);
+    reply = sss_ptr_hash_lookup(nss_ctx->grent_replies, key,
+                                struct nss_grent_reply);
+    if (reply == NULL) {
+        return NULL;
+    }
+
+    if (reply->state != state || reply->expire <= time(NULL)) {
+        talloc_free(reply);
+        return NULL;
+    }
+
+    return reply;
+}
+
+static void
+nss_grent_reply_purge(struct nss_ctx *nss_ctx)
+{
+    struct nss_grent_reply *reply;
+    hash_value_t *values;
+    unsigned long count;
+    unsigned long i;
+    time_t now;
+    int hret;
+
+    hret = hash_values(nss_ctx->grent_replies, &count, &values);
+    if (hret != HASH_SUCCESS) {
+        return;
+    }
+
+    now = time(NULL);
+    for (i = 0; i < count; i++) {
+        reply = sss_ptr_get_value(&values[i], struct nss_grent_reply);
+        if (reply != NULL && reply->expire <= now) {
+            talloc_free(reply);
+        }
+    }
+
+    talloc_free(values);
+}
+
+static void
+nss_grent_reply_add(struct nss_ctx *nss_ctx,
+                    struct ldb_message *msg,
+                    uint32_t state,
+                    uint32_t num_members,
+                    uint8_t *data,
+                    size_t len)
+{
+    struct nss_grent_reply *reply;
+    const char *key;
+    errno_t ret;
+
+    if (nss_ctx->grent_replies == NULL) {
+        nss_ctx->grent_replies = sss_ptr_hash_create(nss_ctx, NULL, NULL);
+        if (nss_ctx->grent_replies == NULL) {
+            return;
+        }
+    }
+
+    key = ldb_dn_get_linearized(msg->dn);
+    talloc_free(sss_ptr_hash_lookup(nss_ctx->grent_replies, key,
+                                    struct nss_grent_reply));
+
+    if (hash_count(nss_ctx->grent_replies) >= NSS_GRENT_REPLY_MAX_ENTRIES) {
+        nss_grent_reply_purge(nss_ctx);
+        if (hash_count(nss_ctx->grent_replies)
+                >= NSS_GRENT_REPLY_MAX_ENTRIES) {
+            return;
+        }
+    }
+
+    reply = talloc_zero(nss_ctx->grent_replies, struct nss_grent_reply);
+    if (reply == NULL) {
+        return;
+    }
+    reply->state = state;
+    reply->num_members = num_members;
+    reply->expire = time(NULL) + sss_ncache_get_timeout(nss_ctx->rctx->ncache);
+    reply->len = len;
+
+    reply->data = talloc_memdup(reply, data, len);
+    if (reply->data == NULL) {
+        talloc_free(reply);
+        return;
+    }
+
+    ret = sss_ptr_hash_add(nss_ctx->grent_replies, key, reply,
+                           struct nss_grent_reply);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to keep the reply of group [%s] [%d]: %s\n",
+              key, ret, sss_strerror(ret));
+        talloc_free(reply);
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "Keeping the reply of group [%s] with "
+          "%u members\n", key, num_members);
+}
+
+void nss_grent_replies_flush(struct nss_ctx *nss_ctx)
+{
+    if (nss_ctx->grent_replies == NULL) {
+        return;
+    }
+
+    sss_ptr_hash_delete_all(nss_ctx->grent_replies, true);
+}
+
 errno_t
 nss_protocol_fill_grent(struct nss_ctx *nss_ctx,
                         struct nss_cmd_ctx *cmd_ctx,
@@ -218,12 +423,16 @@ nss_protocol_fill_grent(struct nss_ctx *nss_ctx,
     struct ldb_message *msg;
     struct sized_string *name;
     struct sized_string pwfield;
+    struct nss_grent_reply *reply;
     uint32_t gid;
     uint32_t num_results;
     uint32_t num_members;
+    uint32_t reply_state;
+    bool keep_reply;
     char *members;
     size_t members_size;
     size_t rp;
+    size_t rp_entry;
     size_t rp_members;
     size_t rp_num_members;
     size_t body_len;
@@ -258,6 +467,29 @@ nss_protocol_fill_grent(struct nss_ctx *nss_ctx,
             continue;
         }
 
+        rp_entry = rp;
+        rp_members = rp + 2 * sizeof(uint32_t) + name->len + pwfield.len;
+
+        keep_reply = nss_grent_reply_state(result->domain, msg, name,
+                                           &pwfield, gid, &reply_state);
+        reply = NULL;
+        if (keep_reply) {
+            reply = nss_grent_reply_lookup(nss_ctx, msg, reply_state);
+        }
+
+        if (reply != NULL) {
+            ret = sss_packet_grow(packet, reply->len);
+            if (ret != EOK) {
+                goto done;
+            }
+
+            sss_packet_get_body(packet, &body, &body_len);
+            memcpy(&body[rp], reply->data, reply->len);
+            rp += reply->len;
+            num_members = reply->num_members;
+            goto stored;
+        }
+
         /* Adjust packet size: gid, num_members + string fields. */
 
         ret = sss_packet_grow(packet, 2 * sizeof(uint32_t)
@@ -277,7 +509,6 @@ nss_protocol_fill_grent(struct nss_ctx *nss_ctx,
         SAFEALIGN_SET_UINT32(&body[rp], 0, &rp);
         SAFEALIGN_SET_STRING(&body[rp], name->str, name->len, &rp);
         SAFEALIGN_SET_STRING(&body[rp], pwfield.str, pwfield.len, &rp);
-        rp_members = rp;
 
         /* Fill members. */
         ret = nss_protocol_fill_members(packet, nss_ctx, result->domain, msg,
@@ -289,18 +520,28 @@ nss_protocol_fill_grent(struct nss_ctx *nss_ctx,
         sss_packet_get_body(packet, &body, &body_len);
         SAFEALIGN_SET_UINT32(&body[rp_num_members], num_members, NULL);
 
+        if (keep_reply) {
+            nss_grent_reply_add(nss_ctx, msg, reply_state, num_members,
+                                &body[rp_entry], rp - rp_entry);
+        }
+
+stored:
         num_results++;
 
         /* Do not store entry in memory cache during enumeration or when
-         * requested or if cache explicitly disabled. */
+         * requested, if it may be stale or if cache explicitly disabled. */
         if (!cmd_ctx->enumeration
-                && ((cmd_ctx->flags & SSS_NSS_EX_FLAG_INVALIDATE_CACHE) == 0)
+                && ((cmd_ctx->flags & (SSS_NSS_EX_FLAG_INVALIDATE_CACHE
+                                        | SSS_NSS_EX_FLAG_CACHE_ONLY
+                                        | SSS_NSS_EX_FLAG_ALLOW_STALE)) == 0)
                 && (nss_ctx->grp_mc_ctx != NULL)) {
             members = (char *)&body[rp_members];
             members_size = body_len - rp_members;
             ret = sss_mmap_cache_gr_store(&nss_ctx->grp_mc_ctx, name, &pwfield,
                                           gid, num_members, members,
-                                          members_size);
+                                          members_size, result->domain->name,
+                                          nss_get_mc_ttl(nss_ctx, msg,
+                                                         SYSDB_CACHE_EXPIRE));
             if (ret != EOK) {
                 DEBUG(SSSDBG_OP_FAILURE,
                       "Failed to store group %s (%s) in mem-cache [%d]: %s!\n",
@@ -459,14 +700,24 @@ nss_protocol_fill_initgr(struct nss_ctx *nss_ctx,
     }
 
     if (nss_ctx->initgr_mc_ctx
-                && ((cmd_ctx->flags & SSS_NSS_EX_FLAG_INVALIDATE_CACHE) == 0)
+                && ((cmd_ctx->flags & (SSS_NSS_EX_FLAG_INVALIDATE_CACHE
+                                        | SSS_NSS_EX_FLAG_CACHE_ONLY
+                                        | SSS_NSS_EX_FLAG_ALLOW_STALE)) == 0)
                 && (nss_ctx->initgr_mc_ctx != NULL)) {
         to_sized_string(&rawname, cmd_ctx->rawname);
         to_sized_string(&unique_name, result->lookup_name);
 
         ret = sss_mmap_cache_initgr_store(&nss_ctx->initgr_mc_ctx, &rawname,
-                                          &unique_name, num_results,
-                                          body + 2 * sizeof(uint32_t));
+                                          &unique_name,
+                                          sss_view_ldb_msg_find_attr_as_uint64(
+                                                    domain, user,
+                                                    SYSDB_UIDNUM, 0),
+                                          num_results,
+                                          body + 2 * sizeof(uint32_t),
+                                          domain->name,
+                                          nss_get_mc_ttl(nss_ctx,
+                                                         result->msgs[0],
+                                                         SYSDB_INITGR_EXPIRE));
         if (ret != EOK) {
             DEBUG(SSSDBG_OP_FAILURE,
                   "Failed to store initgroups %s (%s) in mem-cache [%d]: %s!\n",
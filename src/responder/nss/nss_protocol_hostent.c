@@ -295,5 +295,10 @@ done:
     SAFEALIGN_COPY_UINT32(body, &num_results, NULL);
     SAFEALIGN_SETMEM_UINT32(body + sizeof(uint32_t), 0, NULL); /* reserved */
 
+    if (!cmd_ctx->enumeration && num_results == 1) {
+        nss_protocol_mc_store_reply(cmd_ctx->cli_ctx, &nss_ctx->host_mc_ctx,
+                                    body, body_len);
+    }
+
     return EOK;
 }
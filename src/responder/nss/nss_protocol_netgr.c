@@ -20,6 +20,7 @@
 
 #include "db/sysdb.h"
 #include "db/sysdb_services.h"
+#include "util/sss_ptr_hash.h"
 #include "responder/nss/nss_protocol.h"
 
 static errno_t
@@ -186,6 +187,80 @@ done:
     return EOK;
 }
 
+/* Store the complete netgroup in the memory cache in the format of a
+ * GETNETGRENT reply, keyed by the SETNETGRENT request. */
+static void
+nss_protocol_mc_store_netgr(struct nss_ctx *nss_ctx,
+                            struct nss_cmd_ctx *cmd_ctx)
+{
+    struct sysdb_netgroup_ctx **entries;
+    struct nss_enum_ctx *enum_ctx;
+    struct sss_packet *packet;
+    uint32_t num_results;
+    size_t rp;
+    size_t body_len;
+    uint8_t *body;
+    errno_t ret;
+    int i;
+
+    if (nss_ctx->netgr_mc_ctx == NULL || cmd_ctx->state_ctx->netgroup == NULL) {
+        return;
+    }
+
+    enum_ctx = sss_ptr_hash_lookup(nss_ctx->netgrent,
+                                   cmd_ctx->state_ctx->netgroup,
+                                   struct nss_enum_ctx);
+    if (enum_ctx == NULL || enum_ctx->netgroup == NULL
+            || enum_ctx->netgroup_count == 0) {
+        return;
+    }
+
+    entries = enum_ctx->netgroup;
+
+    ret = sss_packet_new(NULL, 0, SSS_NSS_GETNETGRENT, &packet);
+    if (ret != EOK) {
+        return;
+    }
+
+    ret = sss_packet_grow(packet, 2 * sizeof(uint32_t));
+    if (ret != EOK) {
+        goto done;
+    }
+
+    rp = 2 * sizeof(uint32_t);
+
+    num_results = 0;
+    for (i = 0; entries[i] != NULL; i++) {
+        switch (entries[i]->type) {
+        case SYSDB_NETGROUP_TRIPLE_VAL:
+            ret = nss_protocol_fill_netgr_triple(packet, entries[i], &rp);
+            break;
+        case SYSDB_NETGROUP_GROUP_VAL:
+            ret = nss_protocol_fill_netgr_member(packet, entries[i], &rp);
+            break;
+        default:
+            ret = ERR_INTERNAL;
+            break;
+        }
+
+        if (ret != EOK) {
+            goto done;
+        }
+
+        num_results++;
+    }
+
+    sss_packet_get_body(packet, &body, &body_len);
+    SAFEALIGN_COPY_UINT32(body, &num_results, NULL);
+    SAFEALIGN_SETMEM_UINT32(body + sizeof(uint32_t), 0, NULL); /* reserved */
+
+    nss_protocol_mc_store_reply(cmd_ctx->cli_ctx, &nss_ctx->netgr_mc_ctx,
+                                body, body_len);
+
+done:
+    talloc_free(packet);
+}
+
 errno_t
 nss_protocol_fill_setnetgrent(struct nss_ctx *nss_ctx,
                               struct nss_cmd_ctx *cmd_ctx,
@@ -206,5 +281,30 @@ nss_protocol_fill_setnetgrent(struct nss_ctx *nss_ctx,
     SAFEALIGN_SET_UINT32(body, 1, NULL); /* Netgroup was found. */
     SAFEALIGN_SETMEM_UINT32(body + sizeof(uint32_t), 0, NULL); /* reserved */
 
+    nss_protocol_mc_store_netgr(nss_ctx, cmd_ctx);
+
+    return EOK;
+}
+
+errno_t
+nss_protocol_fill_innetgr(struct nss_ctx *nss_ctx,
+                          struct nss_cmd_ctx *cmd_ctx,
+                          struct sss_packet *packet,
+                          struct cache_req_result *result)
+{
+    size_t body_len;
+    uint8_t *body;
+    errno_t ret;
+
+    /* Two fields (length and reserved). */
+    ret = sss_packet_grow(packet, 2 * sizeof(uint32_t));
+    if (ret != EOK) {
+        return ret;
+    }
+
+    sss_packet_get_body(packet, &body, &body_len);
+    SAFEALIGN_SET_UINT32(body, 1, NULL); /* The triple was found. */
+    SAFEALIGN_SETMEM_UINT32(body + sizeof(uint32_t), 0, NULL); /* reserved */
+
     return EOK;
 }
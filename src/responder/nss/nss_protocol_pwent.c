@@ -298,12 +298,17 @@ nss_protocol_fill_pwent(struct nss_ctx *nss_ctx,
         num_results++;
 
         /* Do not store entry in memory cache during enumeration or when
-         * requested or if cache explicitly disabled. */
+         * requested, if it may be stale or if cache explicitly disabled. */
         if (!cmd_ctx->enumeration
-                && ((cmd_ctx->flags & SSS_NSS_EX_FLAG_INVALIDATE_CACHE) == 0)
+                && ((cmd_ctx->flags & (SSS_NSS_EX_FLAG_INVALIDATE_CACHE
+                                        | SSS_NSS_EX_FLAG_CACHE_ONLY
+                                        | SSS_NSS_EX_FLAG_ALLOW_STALE)) == 0)
                 && (nss_ctx->pwd_mc_ctx != NULL)) {
             ret = sss_mmap_cache_pw_store(&nss_ctx->pwd_mc_ctx, name, &pwfield,
-                                          uid, gid, &gecos, &homedir, &shell);
+                                          uid, gid, &gecos, &homedir, &shell,
+                                          result->domain->name,
+                                          nss_get_mc_ttl(nss_ctx, msg,
+                                                         SYSDB_CACHE_EXPIRE));
             if (ret != EOK) {
                 DEBUG(SSSDBG_OP_FAILURE,
                       "Failed to store user %s (%s) in mmap cache [%d]: %s!\n",
@@ -20,6 +20,13 @@
 
 #include "util/crypto/sss_crypto.h"
 #include "responder/nss/nss_protocol.h"
+#include "responder/nss/nsssrv_mmap_cache.h"
+
+static void
+nss_sid_mc_store(struct nss_ctx *nss_ctx,
+                 struct nss_cmd_ctx *cmd_ctx,
+                 struct cache_req_result *result,
+                 enum sss_id_type id_type);
 
 static errno_t
 find_sss_id_type(struct ldb_message *msg,
@@ -128,6 +135,8 @@ nss_protocol_fill_sid(struct nss_ctx *nss_ctx,
     SAFEALIGN_SET_UINT32(&body[rp], id_type, &rp);
     SAFEALIGN_SET_STRING(&body[rp], sz_sid.str, sz_sid.len, &rp);
 
+    nss_sid_mc_store(nss_ctx, cmd_ctx, result, id_type);
+
     return EOK;
 }
 
@@ -390,6 +399,50 @@ nss_get_ad_name(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+static void
+nss_sid_mc_store(struct nss_ctx *nss_ctx,
+                 struct nss_cmd_ctx *cmd_ctx,
+                 struct cache_req_result *result,
+                 enum sss_id_type id_type)
+{
+    struct sized_string *sz_name;
+    struct sized_string sz_sid;
+    const char *sid;
+    errno_t ret;
+
+    /* Well known objects do not belong to a domain and can't be
+     * invalidated. The ID type is only the one of the object if it was
+     * not forced by the request. */
+    if (nss_ctx->sid_mc_ctx == NULL
+            || result->well_known_object
+            || cmd_ctx->sid_id_type != SSS_ID_TYPE_NOT_SPECIFIED) {
+        return;
+    }
+
+    sid = ldb_msg_find_attr_as_string(result->msgs[0], SYSDB_SID_STR, NULL);
+    if (sid == NULL) {
+        return;
+    }
+    to_sized_string(&sz_sid, sid);
+
+    ret = nss_get_ad_name(cmd_ctx, nss_ctx->rctx, result, &sz_name);
+    if (ret != EOK) {
+        return;
+    }
+
+    ret = sss_mmap_cache_sid_store(&nss_ctx->sid_mc_ctx, sz_name, &sz_sid,
+                                   id_type, result->domain->name,
+                                   nss_get_mc_ttl(nss_ctx, result->msgs[0],
+                                                  SYSDB_CACHE_EXPIRE));
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Failed to store SID %s (%s) in mmap cache [%d]: %s!\n",
+              sid, sz_name->str, ret, sss_strerror(ret));
+    }
+
+    talloc_free(sz_name);
+}
+
 errno_t
 nss_protocol_fill_single_name(struct nss_ctx *nss_ctx,
                               struct nss_cmd_ctx *cmd_ctx,
@@ -444,6 +497,8 @@ nss_protocol_fill_name(struct nss_ctx *nss_ctx,
 
     talloc_free(sz_name);
 
+    nss_sid_mc_store(nss_ctx, cmd_ctx, result, id_type);
+
     return EOK;
 }
 
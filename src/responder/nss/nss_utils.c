@@ -36,3 +36,28 @@ nss_get_pwfield(struct nss_ctx *nctx,
 
     return nctx->pwfield;
 }
+
+/* Returns how long the memory cache record of the object is valid, 0 for
+ * the default memcache_timeout. An object which will not expire in the
+ * cache for a longer time keeps its record for up to memcache_max_timeout
+ * seconds. */
+time_t
+nss_get_mc_ttl(struct nss_ctx *nctx,
+               struct ldb_message *msg,
+               const char *expire_attr)
+{
+    time_t expire;
+    time_t now;
+
+    if (nctx->mc_max_timeout <= nctx->mc_timeout || msg == NULL) {
+        return 0;
+    }
+
+    expire = ldb_msg_find_attr_as_uint64(msg, expire_attr, 0);
+    now = time(NULL);
+    if (expire <= now + nctx->mc_timeout) {
+        return 0;
+    }
+
+    return MIN(expire - now, nctx->mc_max_timeout);
+}
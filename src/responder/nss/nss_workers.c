@@ -0,0 +1,336 @@
+/*
+    SSSD
+
+    NSS Responder - worker processes sharing the client socket
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The primary NSS process creates the client socket and starts the
+ * additional workers with the listening descriptor inherited, so that the
+ * kernel spreads incoming connections between all processes that wait in
+ * accept(). Each worker has its own responder context, data provider
+ * connections and sysdb handle.
+ *
+ * Only the primary process is known to the monitor and owns the memory
+ * cache, the workers never write to it. Invalidation requests from the
+ * backends are addressed to the primary, which forwards them to the
+ * workers as NSS_WORKER_FLUSH_SIGNAL, the same way as it forwards log
+ * rotation. A signal carries no argument, so a worker drops its whole
+ * object and negative caches and the netgroup and enumeration replies,
+ * whatever was invalidated.
+ */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util.h"
+#include "util/child_common.h"
+#include "util/sss_ptr_hash.h"
+#include "responder/common/negcache.h"
+#include "responder/nss/nss_private.h"
+
+/* Delay before a worker that exited is started again */
+#define NSS_WORKER_RESTART_DELAY 1
+
+/* Sent by the primary process to make the workers drop their caches.
+ * It is blocked in all SSSD processes, so that a worker that has not set
+ * up its handler yet gets it later instead of being killed. */
+#define NSS_WORKER_FLUSH_SIGNAL SIGUSR2
+
+struct nss_worker {
+    struct nss_workers_ctx *wctx;
+    int index;
+    pid_t pid;
+    struct sss_child_ctx *child_ctx;
+};
+
+struct nss_workers_ctx {
+    struct nss_ctx *nss_ctx;
+    struct sss_sigchild_ctx *sigchld_ctx;
+    const char **argv;
+    int num_workers;
+    struct nss_worker *workers;
+};
+
+static void nss_worker_exited(int pid, int wait_status, void *pvt);
+
+static errno_t nss_worker_spawn(struct nss_worker *worker)
+{
+    struct nss_workers_ctx *wctx = worker->wctx;
+    struct resp_ctx *rctx = wctx->nss_ctx->rctx;
+    const char **args;
+    int flags;
+    int argc;
+    errno_t ret;
+
+    for (argc = 0; wctx->argv[argc] != NULL; argc++);
+
+    /* Original arguments, the worker options and the terminating NULL */
+    args = talloc_zero_array(NULL, const char *, argc + 3);
+    if (args == NULL) {
+        return ENOMEM;
+    }
+    memcpy(args, wctx->argv, argc * sizeof(const char *));
+
+    args[argc] = talloc_asprintf(args, "--nss-worker=%d", worker->index);
+    args[argc + 1] = talloc_asprintf(args, "--nss-listen-fd=%d", rctx->lfd);
+    if (args[argc] == NULL || args[argc + 1] == NULL) {
+        talloc_free(args);
+        return ENOMEM;
+    }
+
+    worker->pid = fork();
+    if (worker->pid == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to fork NSS worker %d [%d]: %s\n",
+              worker->index, ret, sss_strerror(ret));
+        worker->pid = 0;
+        talloc_free(args);
+        return ret;
+    }
+
+    if (worker->pid == 0) {
+        /* child, keep the listening socket open across exec() */
+        flags = fcntl(rctx->lfd, F_GETFD, 0);
+        if (flags == -1 || fcntl(rctx->lfd, F_SETFD, flags & ~FD_CLOEXEC)) {
+            _exit(1);
+        }
+
+        execvp(args[0], discard_const(args));
+
+        /* If we are here, exec() has failed */
+        ret = errno;
+        DEBUG(SSSDBG_FATAL_FAILURE, "Could not exec %s [%d]: %s\n",
+              args[0], ret, sss_strerror(ret));
+        _exit(1);
+    }
+
+    talloc_free(args);
+
+    ret = sss_child_register(wctx->workers, wctx->sigchld_ctx, worker->pid,
+                             nss_worker_exited, worker, &worker->child_ctx);
+    if (ret != EOK) {
+        /* The worker still serves requests, it is just not restarted. */
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to watch NSS worker %d [%d]: %s\n",
+              worker->index, ret, sss_strerror(ret));
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Started NSS worker %d [%d]\n",
+          worker->index, worker->pid);
+
+    return EOK;
+}
+
+static void nss_worker_restart(struct tevent_context *ev,
+                               struct tevent_timer *te,
+                               struct timeval tv,
+                               void *pvt)
+{
+    struct nss_worker *worker = pvt;
+    errno_t ret;
+
+    if (worker->wctx->nss_ctx->rctx->shutting_down) {
+        return;
+    }
+
+    ret = nss_worker_spawn(worker);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "NSS worker %d was not restarted\n",
+              worker->index);
+    }
+}
+
+static void nss_worker_exited(int pid, int wait_status, void *pvt)
+{
+    struct nss_worker *worker = pvt;
+    struct resp_ctx *rctx;
+    struct tevent_timer *te;
+    struct timeval tv;
+
+    rctx = worker->wctx->nss_ctx->rctx;
+
+    if (WIFEXITED(wait_status)) {
+        DEBUG(SSSDBG_OP_FAILURE, "NSS worker %d [%d] exited with code [%d]\n",
+              worker->index, pid, WEXITSTATUS(wait_status));
+    } else if (WIFSIGNALED(wait_status)) {
+        DEBUG(SSSDBG_OP_FAILURE, "NSS worker %d [%d] terminated with "
+              "signal [%d]\n", worker->index, pid, WTERMSIG(wait_status));
+    }
+
+    worker->pid = 0;
+    talloc_zfree(worker->child_ctx);
+
+    if (rctx->shutting_down) {
+        return;
+    }
+
+    tv = tevent_timeval_current_ofs(NSS_WORKER_RESTART_DELAY, 0);
+    te = tevent_add_timer(rctx->ev, worker->wctx->workers, tv,
+                          nss_worker_restart, worker);
+    if (te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "NSS worker %d will not be restarted\n",
+              worker->index);
+    }
+}
+
+static void nss_workers_caches_reset(struct resp_ctx *rctx)
+{
+    nss_workers_flush(talloc_get_type(rctx->pvt_ctx, struct nss_ctx));
+}
+
+static int nss_workers_destructor(struct nss_workers_ctx *wctx)
+{
+    /* The workers would also go away once they notice that their parent
+     * died, do not make them wait for it. */
+    nss_workers_signal(wctx->nss_ctx, SIGTERM);
+    wctx->nss_ctx->rctx->caches_reset_cb = NULL;
+
+    return 0;
+}
+
+errno_t nss_workers_start(struct nss_ctx *nss_ctx,
+                          const char **argv,
+                          int num_workers)
+{
+    struct nss_workers_ctx *wctx;
+    errno_t ret;
+    int i;
+
+    if (num_workers <= 1) {
+        return EOK;
+    }
+
+    if (nss_ctx->rctx->lfd == -1) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "NSS socket is not open\n");
+        return EINVAL;
+    }
+
+    wctx = talloc_zero(nss_ctx, struct nss_workers_ctx);
+    if (wctx == NULL) {
+        return ENOMEM;
+    }
+
+    wctx->nss_ctx = nss_ctx;
+    wctx->argv = argv;
+    /* The primary process is worker 0 */
+    wctx->num_workers = num_workers - 1;
+
+    wctx->workers = talloc_zero_array(wctx, struct nss_worker,
+                                      wctx->num_workers);
+    if (wctx->workers == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sss_sigchld_init(wctx, nss_ctx->rctx->ev, &wctx->sigchld_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to set up SIGCHLD handling "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        goto done;
+    }
+
+    nss_ctx->workers = wctx;
+    nss_ctx->rctx->caches_reset_cb = nss_workers_caches_reset;
+    talloc_set_destructor(wctx, nss_workers_destructor);
+
+    for (i = 0; i < wctx->num_workers; i++) {
+        wctx->workers[i].wctx = wctx;
+        wctx->workers[i].index = i + 1;
+
+        ret = nss_worker_spawn(&wctx->workers[i]);
+        if (ret != EOK) {
+            /* The workers that started are kept, the load is spread
+             * between fewer processes. */
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to start NSS worker %d\n",
+                  i + 1);
+        }
+    }
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Serving NSS requests with %d processes\n",
+          num_workers);
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(wctx);
+    }
+
+    return ret;
+}
+
+void nss_workers_signal(struct nss_ctx *nss_ctx, int signum)
+{
+    struct nss_workers_ctx *wctx = nss_ctx->workers;
+    int i;
+
+    if (wctx == NULL) {
+        return;
+    }
+
+    for (i = 0; i < wctx->num_workers; i++) {
+        if (wctx->workers[i].pid > 0) {
+            kill(wctx->workers[i].pid, signum);
+        }
+    }
+}
+
+void nss_workers_flush(struct nss_ctx *nss_ctx)
+{
+    nss_workers_signal(nss_ctx, NSS_WORKER_FLUSH_SIGNAL);
+}
+
+static void nss_worker_flush_handler(struct tevent_context *ev,
+                                     struct tevent_signal *se,
+                                     int signum,
+                                     int count,
+                                     void *siginfo,
+                                     void *pvt)
+{
+    struct nss_ctx *nss_ctx = talloc_get_type(pvt, struct nss_ctx);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Dropping the caches of NSS worker %d\n",
+          nss_ctx->worker_index);
+
+    sss_ncache_reset_users(nss_ctx->rctx->ncache);
+    sss_ncache_reset_groups(nss_ctx->rctx->ncache);
+    cache_req_hot_flush(nss_ctx->rctx);
+    nss_grent_replies_flush(nss_ctx);
+    sss_ptr_hash_delete_all(nss_ctx->netgrent, false);
+}
+
+errno_t nss_worker_flush_setup(struct nss_ctx *nss_ctx)
+{
+    struct tevent_signal *tes;
+
+    tes = tevent_add_signal(nss_ctx->rctx->ev, nss_ctx,
+                            NSS_WORKER_FLUSH_SIGNAL, 0,
+                            nss_worker_flush_handler, nss_ctx);
+    if (tes == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to set up the cache flush "
+              "signal handler\n");
+        return EIO;
+    }
+
+    BlockSignals(false, NSS_WORKER_FLUSH_SIGNAL);
+
+    return EOK;
+}
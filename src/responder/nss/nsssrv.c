@@ -29,6 +29,7 @@
 #include <string.h>
 #include <sys/time.h>
 #include <errno.h>
+#include <signal.h>
 #include <popt.h>
 #include <dbus/dbus.h>
 
@@ -55,6 +56,7 @@ nss_clear_memcache(TALLOC_CTX *mem_ctx,
                    struct sbus_request *sbus_req,
                    struct nss_ctx *nctx)
 {
+    struct sss_domain_info *dom;
     int memcache_timeout;
     errno_t ret;
 
@@ -85,6 +87,18 @@ nss_clear_memcache(TALLOC_CTX *mem_ctx,
     }
 
     DEBUG(SSSDBG_TRACE_FUNC, "Clearing memory caches.\n");
+    nss_grent_replies_flush(nctx);
+    cache_req_hot_flush(nctx->rctx);
+    cache_req_shared_invalidate(nctx->rctx);
+    nss_workers_flush(nctx);
+
+    /* sss_cache may have invalidated all users or groups, read it now
+     * so that the old entries do not get into the new memory caches */
+    for (dom = nctx->rctx->domains; dom != NULL;
+            dom = get_next_domain(dom, SSS_GND_ALL_DOMAINS)) {
+        dom->invalidated_read = 0;
+    }
+
     ret = sss_mmap_cache_reinit(nctx, nctx->mc_uid, nctx->mc_gid,
                                 -1, /* keep current size */
                                 (time_t) memcache_timeout,
@@ -115,6 +129,46 @@ nss_clear_memcache(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = sss_mmap_cache_reinit(nctx, nctx->mc_uid, nctx->mc_gid,
+                                -1, /* keep current size */
+                                (time_t)memcache_timeout,
+                                &nctx->sid_mc_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "SID mmap cache invalidation failed\n");
+        goto done;
+    }
+
+    ret = sss_mmap_cache_reinit(nctx, nctx->mc_uid, nctx->mc_gid,
+                                -1, /* keep current size */
+                                (time_t)memcache_timeout,
+                                &nctx->svc_mc_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "services mmap cache invalidation failed\n");
+        goto done;
+    }
+
+    ret = sss_mmap_cache_reinit(nctx, nctx->mc_uid, nctx->mc_gid,
+                                -1, /* keep current size */
+                                (time_t)memcache_timeout,
+                                &nctx->host_mc_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "hosts mmap cache invalidation failed\n");
+        goto done;
+    }
+
+    ret = sss_mmap_cache_reinit(nctx, nctx->mc_uid, nctx->mc_gid,
+                                -1, /* keep current size */
+                                (time_t)memcache_timeout,
+                                &nctx->netgr_mc_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "netgroups mmap cache invalidation failed\n");
+        goto done;
+    }
+
 done:
     if (unlink(SSS_NSS_MCACHE_DIR"/"CLEAR_MC_FLAG) != 0) {
         if (errno != ENOENT)
@@ -132,6 +186,8 @@ nss_clear_netgroup_hash_table(TALLOC_CTX *mem_ctx,
     DEBUG(SSSDBG_TRACE_FUNC, "Invalidating netgroup hash table\n");
 
     sss_ptr_hash_delete_all(nss_ctx->netgrent, false);
+    sss_mmap_cache_reset(nss_ctx->netgr_mc_ctx);
+    nss_workers_flush(nss_ctx);
 
     return EOK;
 }
@@ -140,6 +196,7 @@ static int nss_get_config(struct nss_ctx *nctx,
                           struct confdb_ctx *cdb)
 {
     int ret;
+    int tmp_value;
     char *tmp_str;
 
     ret = confdb_get_int(cdb, CONFDB_NSS_CONF_ENTRY,
@@ -164,6 +221,21 @@ static int nss_get_config(struct nss_ctx *nctx,
         nctx->cache_refresh_percent = 0;
     }
 
+    /* hosts and networks default to entry_negative_timeout */
+    ret = confdb_get_int(cdb, CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_RESOLVER_NEG_TIMEOUT,
+                         sss_ncache_get_timeout(nctx->rctx->ncache),
+                         &tmp_value);
+    if (ret != EOK) goto done;
+    if (tmp_value < 0) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Configuration error: resolver_negative_timeout is "
+                 "invalid.\n");
+        ret = EINVAL;
+        goto done;
+    }
+    sss_ncache_set_resolver_timeout(nctx->rctx->ncache, tmp_value);
+
     ret = sss_ncache_prepopulate(nctx->rctx->ncache, cdb, nctx->rctx);
     if (ret != EOK) {
         goto done;
@@ -221,12 +293,23 @@ static int setup_memcaches(struct nss_ctx *nctx)
     static const size_t SSS_MC_CACHE_PASSWD_SIZE    =  8;
     static const size_t SSS_MC_CACHE_GROUP_SIZE     =  6;
     static const size_t SSS_MC_CACHE_INITGROUP_SIZE = 10;
+    static const size_t SSS_MC_CACHE_SID_SIZE       =  6;
+    static const size_t SSS_MC_CACHE_SERVICES_SIZE  =  1;
+    static const size_t SSS_MC_CACHE_HOSTS_SIZE     =  2;
+    static const size_t SSS_MC_CACHE_NETGROUPS_SIZE =  4;
 
     int ret;
     int memcache_timeout;
+    int memcache_max_timeout;
     int mc_size_passwd;
     int mc_size_group;
     int mc_size_initgroups;
+    int mc_size_sid;
+    int mc_size_services;
+    int mc_size_hosts;
+    int mc_size_netgroups;
+    uint32_t mc_hash_alg;
+    char *mc_hash;
 
     /* Remove the CLEAR_MC_FLAG file if exists. */
     ret = unlink(SSS_NSS_MCACHE_DIR"/"CLEAR_MC_FLAG);
@@ -247,8 +330,22 @@ static int setup_memcaches(struct nss_ctx *nctx)
               "Failed to get 'memcache_timeout' option from confdb.\n");
         return ret;
     }
+    nctx->mc_timeout = memcache_timeout;
+
+    ret = confdb_get_int(nctx->rctx->cdb,
+                         CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_MEMCACHE_MAX_TIMEOUT,
+                         0, &memcache_max_timeout);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_MEMCACHE_MAX_TIMEOUT
+              "' option from confdb.\n");
+        return ret;
+    }
+    nctx->mc_max_timeout = memcache_max_timeout;
 
-    /* Get all memcache sizes from confdb (pwd, grp, initgr) */
+    /* Get all memcache sizes from confdb (pwd, grp, initgr, sid,
+     * services, hosts, netgroups) */
 
     ret = confdb_get_int(nctx->rctx->cdb,
                          CONFDB_NSS_CONF_ENTRY,
@@ -286,13 +383,85 @@ static int setup_memcaches(struct nss_ctx *nctx)
         return ret;
     }
 
+    ret = confdb_get_int(nctx->rctx->cdb,
+                         CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_MEMCACHE_SIZE_SID,
+                         SSS_MC_CACHE_SID_SIZE,
+                         &mc_size_sid);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_MEMCACHE_SIZE_SID
+              "' option from confdb.\n");
+        return ret;
+    }
+
+    ret = confdb_get_int(nctx->rctx->cdb,
+                         CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_MEMCACHE_SIZE_SERVICES,
+                         SSS_MC_CACHE_SERVICES_SIZE,
+                         &mc_size_services);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_MEMCACHE_SIZE_SERVICES
+              "' option from confdb.\n");
+        return ret;
+    }
+
+    ret = confdb_get_int(nctx->rctx->cdb,
+                         CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_MEMCACHE_SIZE_HOSTS,
+                         SSS_MC_CACHE_HOSTS_SIZE,
+                         &mc_size_hosts);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_MEMCACHE_SIZE_HOSTS
+              "' option from confdb.\n");
+        return ret;
+    }
+
+    ret = confdb_get_int(nctx->rctx->cdb,
+                         CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_MEMCACHE_SIZE_NETGROUPS,
+                         SSS_MC_CACHE_NETGROUPS_SIZE,
+                         &mc_size_netgroups);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_MEMCACHE_SIZE_NETGROUPS
+              "' option from confdb.\n");
+        return ret;
+    }
+
+    ret = confdb_get_string(nctx->rctx->cdb, nctx,
+                            CONFDB_NSS_CONF_ENTRY,
+                            CONFDB_NSS_MEMCACHE_HASH,
+                            "murmur3", &mc_hash);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_MEMCACHE_HASH
+              "' option from confdb.\n");
+        return ret;
+    }
+
+    if (strcasecmp(mc_hash, "wyhash") == 0) {
+        mc_hash_alg = SSS_MC_HASH_WYHASH;
+    } else if (strcasecmp(mc_hash, "murmur3") == 0) {
+        mc_hash_alg = SSS_MC_HASH_MURMUR3;
+    } else {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Unknown value '%s' of '"CONFDB_NSS_MEMCACHE_HASH"'\n",
+              mc_hash);
+        talloc_free(mc_hash);
+        return EINVAL;
+    }
+    talloc_free(mc_hash);
+
     /* Initialize the fast in-memory caches if they were not disabled */
 
     ret = sss_mmap_cache_init(nctx, "passwd",
                               nctx->mc_uid, nctx->mc_gid,
                               SSS_MC_PASSWD,
                               mc_size_passwd * SSS_MC_CACHE_SLOTS_PER_MB,
-                              (time_t)memcache_timeout,
+                              (time_t)memcache_timeout, mc_hash_alg,
                               &nctx->pwd_mc_ctx);
     if (ret) {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -304,7 +473,7 @@ static int setup_memcaches(struct nss_ctx *nctx)
                               nctx->mc_uid, nctx->mc_gid,
                               SSS_MC_GROUP,
                               mc_size_group * SSS_MC_CACHE_SLOTS_PER_MB,
-                              (time_t)memcache_timeout,
+                              (time_t)memcache_timeout, mc_hash_alg,
                               &nctx->grp_mc_ctx);
     if (ret) {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -316,7 +485,7 @@ static int setup_memcaches(struct nss_ctx *nctx)
                               nctx->mc_uid, nctx->mc_gid,
                               SSS_MC_INITGROUPS,
                               mc_size_initgroups * SSS_MC_CACHE_SLOTS_PER_MB,
-                              (time_t)memcache_timeout,
+                              (time_t)memcache_timeout, mc_hash_alg,
                               &nctx->initgr_mc_ctx);
     if (ret) {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -324,9 +493,69 @@ static int setup_memcaches(struct nss_ctx *nctx)
               sss_strerror(ret));
     }
 
+    ret = sss_mmap_cache_init(nctx, "sid",
+                              nctx->mc_uid, nctx->mc_gid,
+                              SSS_MC_SID,
+                              mc_size_sid * SSS_MC_CACHE_SLOTS_PER_MB,
+                              (time_t)memcache_timeout, mc_hash_alg,
+                              &nctx->sid_mc_ctx);
+    if (ret) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to initialize SID mmap cache: '%s'\n",
+              sss_strerror(ret));
+    }
+
+    ret = sss_mmap_cache_init(nctx, "services",
+                              nctx->mc_uid, nctx->mc_gid,
+                              SSS_MC_SERVICES,
+                              mc_size_services * SSS_MC_CACHE_SLOTS_PER_MB,
+                              (time_t)memcache_timeout, mc_hash_alg,
+                              &nctx->svc_mc_ctx);
+    if (ret) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to initialize services mmap cache: '%s'\n",
+              sss_strerror(ret));
+    }
+
+    ret = sss_mmap_cache_init(nctx, "hosts",
+                              nctx->mc_uid, nctx->mc_gid,
+                              SSS_MC_HOSTS,
+                              mc_size_hosts * SSS_MC_CACHE_SLOTS_PER_MB,
+                              (time_t)memcache_timeout, mc_hash_alg,
+                              &nctx->host_mc_ctx);
+    if (ret) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to initialize hosts mmap cache: '%s'\n",
+              sss_strerror(ret));
+    }
+
+    ret = sss_mmap_cache_init(nctx, "netgroups",
+                              nctx->mc_uid, nctx->mc_gid,
+                              SSS_MC_NETGROUPS,
+                              mc_size_netgroups * SSS_MC_CACHE_SLOTS_PER_MB,
+                              (time_t)memcache_timeout, mc_hash_alg,
+                              &nctx->netgr_mc_ctx);
+    if (ret) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to initialize netgroups mmap cache: '%s'\n",
+              sss_strerror(ret));
+    }
+
     return EOK;
 }
 
+static errno_t
+nss_rotate_logs(TALLOC_CTX *mem_ctx,
+                struct sbus_request *sbus_req,
+                struct nss_ctx *nss_ctx)
+{
+    /* The workers are not known to the monitor, they reopen their log
+     * files on SIGHUP. */
+    nss_workers_signal(nss_ctx, SIGHUP);
+
+    return responder_logrotate(mem_ctx, sbus_req, nss_ctx->rctx);
+}
+
 static errno_t
 nss_register_service_iface(struct nss_ctx *nss_ctx,
                            struct resp_ctx *rctx)
@@ -337,7 +566,7 @@ nss_register_service_iface(struct nss_ctx *nss_ctx,
         sssd_service,
         SBUS_METHODS(
             SBUS_SYNC(METHOD, sssd_service, resInit, monitor_common_res_init, NULL),
-            SBUS_SYNC(METHOD, sssd_service, rotateLogs, responder_logrotate, rctx),
+            SBUS_SYNC(METHOD, sssd_service, rotateLogs, nss_rotate_logs, nss_ctx),
             SBUS_SYNC(METHOD, sssd_service, clearEnumCache, nss_clear_netgroup_hash_table, nss_ctx),
             SBUS_SYNC(METHOD, sssd_service, clearMemcache, nss_clear_memcache, nss_ctx)
         ),
@@ -349,9 +578,10 @@ nss_register_service_iface(struct nss_ctx *nss_ctx,
     if (ret != EOK) {
         DEBUG(SSSDBG_FATAL_FAILURE, "Unable to register service interface"
               "[%d]: %s\n", ret, sss_strerror(ret));
+        return ret;
     }
 
-    return ret;
+    return sss_resp_register_stats_iface(rctx);
 }
 
 static int sssd_supplementary_group(struct nss_ctx *nss_ctx)
@@ -429,23 +659,50 @@ done:
 
 int nss_process_init(TALLOC_CTX *mem_ctx,
                      struct tevent_context *ev,
-                     struct confdb_ctx *cdb)
+                     struct confdb_ctx *cdb,
+                     int worker_index,
+                     int listen_fd,
+                     const char **argv)
 {
     struct resp_ctx *rctx;
     struct sss_cmd_table *nss_cmds;
     struct be_conn *iter;
     struct nss_ctx *nctx;
+    const char *conn_name;
     int ret;
     enum idmap_error_code err;
     int fd_limit;
+    int warmup_entries;
+    int num_workers;
 
     nss_cmds = get_nss_cmds();
 
+    if (worker_index == 0) {
+        conn_name = SSS_BUS_NSS;
+    } else {
+        /* The well known name belongs to the primary process, which is
+         * the one the backends talk to. */
+        conn_name = talloc_asprintf(mem_ctx, "%s.worker%d",
+                                    SSS_BUS_NSS, worker_index);
+        if (conn_name == NULL) {
+            return ENOMEM;
+        }
+
+        /* Do not pass the inherited socket on to our own children */
+        ret = fcntl(listen_fd, F_GETFD, 0);
+        if (ret == -1 || fcntl(listen_fd, F_SETFD, ret | FD_CLOEXEC) == -1) {
+            ret = errno;
+            DEBUG(SSSDBG_FATAL_FAILURE, "Invalid listening socket %d "
+                  "[%d]: %s\n", listen_fd, ret, sss_strerror(ret));
+            return ret;
+        }
+    }
+
     ret = sss_process_init(mem_ctx, ev, cdb,
                            nss_cmds,
-                           SSS_NSS_SOCKET_NAME, -1, NULL, -1,
+                           SSS_NSS_SOCKET_NAME, listen_fd, NULL, -1,
                            CONFDB_NSS_CONF_ENTRY,
-                           SSS_BUS_NSS, NSS_SBUS_SERVICE_NAME,
+                           conn_name, NSS_SBUS_SERVICE_NAME,
                            nss_connection_setup,
                            &rctx);
     if (ret != EOK) {
@@ -462,6 +719,7 @@ int nss_process_init(TALLOC_CTX *mem_ctx,
 
     nctx->rctx = rctx;
     nctx->rctx->pvt_ctx = nctx;
+    nctx->worker_index = worker_index;
 
     ret = nss_get_config(nctx, cdb);
     if (ret != EOK) {
@@ -539,9 +797,12 @@ int nss_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
-    ret = setup_memcaches(nctx);
-    if (ret != EOK) {
-        goto fail;
+    /* Only the primary process writes to the memory cache */
+    if (worker_index == 0) {
+        ret = setup_memcaches(nctx);
+        if (ret != EOK) {
+            goto fail;
+        }
     }
 
     /* Set up file descriptor limits */
@@ -563,6 +824,18 @@ int nss_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
+    if (worker_index != 0) {
+        /* Workers are driven by the primary process, not by the monitor */
+        ret = nss_worker_flush_setup(nctx);
+        if (ret != EOK) {
+            goto fail;
+        }
+
+        DEBUG(SSSDBG_TRACE_FUNC, "NSS worker %d initialization complete\n",
+              worker_index);
+        return EOK;
+    }
+
     /* The responder is initialized. Now tell it to the monitor. */
     ret = sss_monitor_service_init(rctx, rctx->ev, SSS_BUS_NSS,
                                    NSS_SBUS_SERVICE_NAME,
@@ -578,6 +851,49 @@ int nss_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
+    ret = confdb_get_int(nctx->rctx->cdb,
+                         CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_MEMCACHE_WARMUP,
+                         0, &warmup_entries);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_MEMCACHE_WARMUP
+              "' option from confdb.\n");
+        goto fail;
+    }
+
+    ret = nss_mc_warmup_start(nctx, warmup_entries);
+    if (ret != EOK) {
+        /* Not fatal, the memory cache is filled by the lookups as usual. */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to start memory cache warm-up [%d]: %s\n",
+              ret, sss_strerror(ret));
+    }
+
+    ret = confdb_get_int(nctx->rctx->cdb,
+                         CONFDB_NSS_CONF_ENTRY,
+                         CONFDB_NSS_WORKERS,
+                         1, &num_workers);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get '"CONFDB_NSS_WORKERS"' option from confdb.\n");
+        goto fail;
+    }
+
+    if (num_workers > 1
+            && (rctx->socket_activated || rctx->dbus_activated)) {
+        DEBUG(SSSDBG_CONF_SETTINGS, "Worker processes are not used when "
+              "the responder is activated on demand\n");
+    } else if (num_workers > 1) {
+        ret = nss_workers_start(nctx, argv, num_workers);
+        if (ret != EOK) {
+            /* Not fatal, this process serves all requests alone. */
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Unable to start NSS worker processes [%d]: %s\n",
+                  ret, sss_strerror(ret));
+        }
+    }
+
     DEBUG(SSSDBG_TRACE_FUNC, "NSS Initialization complete\n");
 
     return EOK;
@@ -596,6 +912,9 @@ int main(int argc, const char *argv[])
     int ret;
     uid_t uid;
     gid_t gid;
+    int worker_index = 0;
+    int listen_fd = -1;
+    char *log_name;
 
     struct poptOption long_options[] = {
         POPT_AUTOHELP
@@ -603,6 +922,11 @@ int main(int argc, const char *argv[])
         SSSD_LOGGER_OPTS
         SSSD_SERVER_OPTS(uid, gid)
         SSSD_RESPONDER_OPTS
+        { "nss-worker", 0, POPT_ARG_INT | POPT_ARGFLAG_DOC_HIDDEN,
+          &worker_index, 0, _("Index of the NSS worker process"), NULL },
+        { "nss-listen-fd", 0, POPT_ARG_INT | POPT_ARGFLAG_DOC_HIDDEN,
+          &listen_fd, 0, _("Listening socket inherited from the primary "
+                           "NSS process"), NULL },
         POPT_TABLEEND
     };
 
@@ -624,10 +948,21 @@ int main(int argc, const char *argv[])
 
     poptFreeContext(pc);
 
+    if (worker_index < 0 || (worker_index > 0 && listen_fd < 0)) {
+        fprintf(stderr, "\nInvalid NSS worker options\n\n");
+        return 1;
+    }
+
     DEBUG_INIT(debug_level);
 
     /* set up things like debug, signals, daemonization, etc. */
-    debug_log_file = "sssd_nss";
+    if (worker_index == 0) {
+        debug_log_file = "sssd_nss";
+    } else {
+        log_name = talloc_asprintf(NULL, "sssd_nss_worker%d", worker_index);
+        if (log_name == NULL) return 2;
+        debug_log_file = log_name;
+    }
 
     sss_set_logger(opt_logger);
 
@@ -644,7 +979,8 @@ int main(int argc, const char *argv[])
 
     ret = nss_process_init(main_ctx,
                            main_ctx->event_ctx,
-                           main_ctx->confdb_ctx);
+                           main_ctx->confdb_ctx,
+                           worker_index, listen_fd, argv);
     if (ret != EOK) return 3;
 
     /* loop on main */
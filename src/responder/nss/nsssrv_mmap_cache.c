@@ -20,6 +20,7 @@
 */
 
 #include "util/util.h"
+#include "util/probes.h"
 #include "util/crypto/sss_crypto.h"
 #include "confdb/confdb.h"
 #include <sys/mman.h>
@@ -45,6 +46,15 @@
     __sync_synchronize(); \
 } while (0)
 
+/* The cache is grown when at least 1/MC_GROW_EVICTION_RATIO of its slots
+ * had to be reclaimed from valid records within MC_GROW_WINDOW seconds.
+ * Each growth doubles the size, up to MC_GROW_MAX_FACTOR times the
+ * configured size. */
+#define MC_GROW_WINDOW 60
+#define MC_GROW_EVICTION_RATIO 2
+#define MC_GROW_FACTOR 2
+#define MC_GROW_MAX_FACTOR 4
+
 struct sss_mc_ctx {
     char *name;             /* mmap cache name */
     enum sss_mc_type type;  /* mmap cache type */
@@ -55,13 +65,15 @@ struct sss_mc_ctx {
     gid_t gid;              /* Group ID of owner */
 
     uint32_t seed;          /* pseudo-random seed to avoid collision attacks */
+    uint32_t hash_alg;      /* hash function of the keys, SSS_MC_HASH_* */
     time_t valid_time_slot; /* maximum time the entry is valid in seconds */
 
     void *mmap_base;        /* base address of mmap */
     size_t mmap_size;       /* total size of mmap */
 
-    uint32_t *hash_table;   /* hash table address (in mmap) */
+    struct sss_mc_bucket *hash_table; /* hash table address (in mmap) */
     uint32_t ht_size;       /* size of hash table */
+    uint32_t ht_used;       /* hash table entries not empty */
 
     uint8_t *free_table;    /* free list bitmaps */
     uint32_t ft_size;       /* size of free table */
@@ -69,8 +81,26 @@ struct sss_mc_ctx {
 
     uint8_t *data_table;    /* data table address (in mmap) */
     uint32_t dt_size;       /* size of data table */
+
+    size_t max_slots;       /* upper bound for online growth */
+    time_t evict_window_start; /* start of the current eviction window */
+    uint32_t evict_window_slots; /* valid slots reclaimed in the window */
+
+    uint8_t *access_table;  /* bitmap of recently refreshed records, indexed
+                             * by the first slot of the record; private to
+                             * the responder */
+    uint32_t *domain_table; /* hash of the domain name of each record,
+                             * indexed like access_table, 0 if the record
+                             * belongs to no domain; private to the
+                             * responder */
+    struct sss_mc_stats stats; /* allocator counters */
+    struct sss_mc_counters *counters; /* usage counters shared with sssctl,
+                                       * NULL if they are not available */
 };
 
+static void sss_mc_check_growth(struct sss_mc_ctx **_mcc);
+static const char *sss_mc_rec_str(struct sss_mc_rec *rec, rel_ptr_t ptr);
+
 #define MC_FIND_BIT(base, num) \
     uint32_t n = (num); \
     uint8_t *b = (base) + n / 8; \
@@ -92,34 +122,6 @@ struct sss_mc_ctx {
     else used = false; \
 } while (0)
 
-static inline
-uint32_t sss_mc_next_slot_with_hash(struct sss_mc_rec *rec,
-                                    uint32_t hash)
-{
-    if (rec->hash1 == hash) {
-        return rec->next1;
-    } else if (rec->hash2 == hash) {
-        return rec->next2;
-    } else {
-        /* it should never happen. */
-        return MC_INVALID_VAL;
-    }
-}
-
-static inline
-void sss_mc_chain_slot_to_record_with_hash(struct sss_mc_rec *rec,
-                                           uint32_t hash,
-                                           uint32_t slot)
-{
-    /* changing a single uint32_t is atomic, so there is no
-     * need to use barriers in this case */
-    if (rec->hash1 == hash) {
-        rec->next1 = slot;
-    } else if (rec->hash2 == hash) {
-        rec->next2 = slot;
-    }
-}
-
 /* This function will store corrupted memcache to disk for later
  * analysis. */
 static void  sss_mc_save_corrupted(struct sss_mc_ctx *mc_ctx)
@@ -194,81 +196,110 @@ done:
 static uint32_t sss_mc_hash(struct sss_mc_ctx *mcc,
                             const char *key, size_t len)
 {
-    return murmurhash3(key, len, mcc->seed) % MC_HT_ELEMS(mcc->ht_size);
+    return sss_mc_hash_key(mcc->hash_alg, mcc->seed, key, len);
+}
+
+/* Records are tagged with a hash of their domain so that the records of
+ * one domain can be invalidated without resetting the whole cache. A
+ * collision only invalidates some records of another domain too. */
+static uint32_t sss_mc_domain_tag(const char *domain)
+{
+    uint32_t tag;
+
+    if (domain == NULL) {
+        return 0;
+    }
+
+    /* not seeded, the tags are copied as they are when the cache grows */
+    tag = murmurhash3(domain, strlen(domain), 0);
+    return tag == 0 ? 1 : tag;
+}
+
+static inline uint32_t sss_mc_probe(struct sss_mc_ctx *mcc,
+                                    struct sss_mc_probe *probe)
+{
+    return sss_mc_probe_next(probe, mcc->hash_table, mcc->ht_size);
+}
+
+static bool sss_mc_index_has(struct sss_mc_ctx *mcc,
+                             uint32_t hash, uint32_t slot)
+{
+    struct sss_mc_probe probe;
+    uint32_t cur;
+
+    sss_mc_probe_init(&probe, hash, mcc->ht_size);
+    while ((cur = sss_mc_probe(mcc, &probe)) != MC_INVALID_VAL) {
+        if (cur == slot) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
-static void sss_mc_add_rec_to_chain(struct sss_mc_ctx *mcc,
+static void sss_mc_add_rec_to_index(struct sss_mc_ctx *mcc,
                                     struct sss_mc_rec *rec,
                                     uint32_t hash)
 {
-    struct sss_mc_rec *cur;
+    struct sss_mc_bucket *b;
+    uint32_t buckets = MC_HT_BUCKETS(mcc->ht_size);
+    uint32_t bucket;
     uint32_t slot;
+    uint32_t n;
+    int i;
 
-    if (hash > MC_HT_ELEMS(mcc->ht_size)) {
-        /* Invalid hash. This should never happen, but better
-         * return than trying to access out of bounds memory */
+    slot = MC_PTR_TO_SLOT(mcc->data_table, rec);
+    if (sss_mc_index_has(mcc, hash, slot)) {
+        /* rec already stored, e.g. both keys hash the same */
         return;
     }
 
-    slot = mcc->hash_table[hash];
-    if (slot == MC_INVALID_VAL) {
-        /* no previous record/collision, just add to hash table */
-        mcc->hash_table[hash] = MC_PTR_TO_SLOT(mcc->data_table, rec);
-        return;
-    }
+    bucket = sss_mc_hash_to_bucket(hash, mcc->ht_size);
+    for (n = 0; n < buckets; n++) {
+        b = &mcc->hash_table[bucket];
+        for (i = 0; i < MC_BUCKET_ENTRIES; i++) {
+            if (b->fp[i] != MC_FP_EMPTY && b->fp[i] != MC_FP_TOMBSTONE) {
+                continue;
+            }
+            if (b->fp[i] == MC_FP_EMPTY) {
+                mcc->ht_used++;
+            }
+            /* readers look at the fingerprint first, so publish it last */
+            b->slot[i] = slot;
+            __sync_synchronize();
+            b->fp[i] = MC_HASH_TO_FP(hash);
 
-    do {
-        cur = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
-        if (cur == rec) {
-            /* rec already stored in hash chain */
             return;
         }
-        slot = sss_mc_next_slot_with_hash(cur, hash);
-    } while (slot != MC_INVALID_VAL);
-    /* end of chain, append our record here */
+        bucket = (bucket + 1) % buckets;
+    }
 
-    slot = MC_PTR_TO_SLOT(mcc->data_table, rec);
-    sss_mc_chain_slot_to_record_with_hash(cur, hash, slot);
+    /* the table is sized so that it cannot fill up with live entries */
+    DEBUG(SSSDBG_CRIT_FAILURE, "mmap cache hash table is full\n");
 }
 
-static void sss_mc_rm_rec_from_chain(struct sss_mc_ctx *mcc,
+static void sss_mc_rm_rec_from_index(struct sss_mc_ctx *mcc,
                                      struct sss_mc_rec *rec,
                                      uint32_t hash)
 {
-    struct sss_mc_rec *prev = NULL;
-    struct sss_mc_rec *cur = NULL;
+    struct sss_mc_probe probe;
     uint32_t slot;
+    uint32_t cur;
+    int i;
 
-    if (hash > MC_HT_ELEMS(mcc->ht_size)) {
-        /* It can happen if rec->hash1 and rec->hash2 was the same.
-         * or it is invalid hash. It is better to return
-         * than trying to access out of bounds memory
-         */
-        return;
-    }
+    slot = MC_PTR_TO_SLOT(mcc->data_table, rec);
 
-    slot = mcc->hash_table[hash];
-    if (slot == MC_INVALID_VAL) {
-        /* record has already been removed. It may happen if rec->hash1 and
-         * rec->has2 are the same. (It is not very likely).
-         */
-        return;
-    }
-    cur = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
-    if (cur == rec) {
-        mcc->hash_table[hash] = sss_mc_next_slot_with_hash(rec, hash);
-    } else {
-        slot = sss_mc_next_slot_with_hash(cur, hash);
-        while (slot != MC_INVALID_VAL) {
-            prev = cur;
-            cur = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
-            if (cur == rec) {
-                slot = sss_mc_next_slot_with_hash(cur, hash);
-
-                sss_mc_chain_slot_to_record_with_hash(prev, hash, slot);
-                slot = MC_INVALID_VAL;
-            } else {
-                slot = sss_mc_next_slot_with_hash(cur, hash);
+    sss_mc_probe_init(&probe, hash, mcc->ht_size);
+    while ((cur = sss_mc_probe(mcc, &probe)) != MC_INVALID_VAL) {
+        if (cur != slot) {
+            continue;
+        }
+        /* the slot is left in place, readers which already matched the
+         * fingerprint will find an invalidated record there */
+        for (i = 0; i < MC_BUCKET_ENTRIES; i++) {
+            if (mcc->hash_table[probe.bucket].slot[i] == slot
+                    && mcc->hash_table[probe.bucket].fp[i] == probe.fp) {
+                mcc->hash_table[probe.bucket].fp[i] = MC_FP_TOMBSTONE;
             }
         }
     }
@@ -295,11 +326,17 @@ static void sss_mc_invalidate_rec(struct sss_mc_ctx *mcc,
         return;
     }
 
-    /* Remove from hash chains */
-    /* hash chain 1 */
-    sss_mc_rm_rec_from_chain(mcc, rec, rec->hash1);
-    /* hash chain 2 */
-    sss_mc_rm_rec_from_chain(mcc, rec, rec->hash2);
+    MC_CLEAR_BIT(mcc->access_table, MC_PTR_TO_SLOT(mcc->data_table, rec));
+    mcc->domain_table[MC_PTR_TO_SLOT(mcc->data_table, rec)] = 0;
+
+    /* Remove from hash table */
+    sss_mc_rm_rec_from_index(mcc, rec, rec->hash1);
+    if (rec->hash2 != rec->hash1) {
+        sss_mc_rm_rec_from_index(mcc, rec, rec->hash2);
+    }
+    if (rec->hash3 != MC_INVALID_VAL32) {
+        sss_mc_rm_rec_from_index(mcc, rec, rec->hash3);
+    }
 
     /* Clear from free_table */
     sss_mc_free_slots(mcc, rec);
@@ -314,12 +351,12 @@ static void sss_mc_invalidate_rec(struct sss_mc_ctx *mcc,
     rec->next2 = MC_INVALID_VAL32;
     rec->hash1 = MC_INVALID_VAL32;
     rec->hash2 = MC_INVALID_VAL32;
+    rec->hash3 = MC_INVALID_VAL32;
     MC_LOWER_BARRIER(rec);
 }
 
 static bool sss_mc_is_valid_rec(struct sss_mc_ctx *mcc, struct sss_mc_rec *rec)
 {
-    struct sss_mc_rec *self;
     uint32_t slot;
 
     if (((uint8_t *)rec < mcc->data_table) ||
@@ -340,31 +377,21 @@ static bool sss_mc_is_valid_rec(struct sss_mc_ctx *mcc, struct sss_mc_rec *rec)
         return false;
     }
 
-    /* next record can be invalid if there are no next records */
+    /* all keys must be in the hash table and refer to the record */
+    slot = MC_PTR_TO_SLOT(mcc->data_table, rec);
 
     if (rec->hash1 == MC_INVALID_VAL32) {
         return false;
-    } else {
-        self = NULL;
-        slot = mcc->hash_table[rec->hash1];
-        while (slot != MC_INVALID_VAL32 && self != rec) {
-            self = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
-            slot = sss_mc_next_slot_with_hash(self, rec->hash1);
-        }
-        if (self != rec) {
-            return false;
-        }
+    } else if (!sss_mc_index_has(mcc, rec->hash1, slot)) {
+        return false;
     }
-    if (rec->hash2 != MC_INVALID_VAL32) {
-        self = NULL;
-        slot = mcc->hash_table[rec->hash2];
-        while (slot != MC_INVALID_VAL32 && self != rec) {
-            self = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
-            slot = sss_mc_next_slot_with_hash(self, rec->hash2);
-        }
-        if (self != rec) {
-            return false;
-        }
+    if (rec->hash2 != MC_INVALID_VAL32
+            && !sss_mc_index_has(mcc, rec->hash2, slot)) {
+        return false;
+    }
+    if (rec->hash3 != MC_INVALID_VAL32
+            && !sss_mc_index_has(mcc, rec->hash3, slot)) {
+        return false;
     }
 
     /* all tests passed */
@@ -380,14 +407,88 @@ static const char *mc_type_to_str(enum sss_mc_type type)
         return "GROUP";
     case SSS_MC_INITGROUPS:
         return "INITGROUPS";
+    case SSS_MC_SID:
+        return "SID";
+    case SSS_MC_SERVICES:
+        return "SERVICES";
+    case SSS_MC_HOSTS:
+        return "HOSTS";
+    case SSS_MC_NETGROUPS:
+        return "NETGROUPS";
     default:
         return "-UNKNOWN-";
     }
 }
 
-/* FIXME: This is a very simplistic, inefficient, memory allocator,
- * it will just free the oldest entries regardless of expiration if it
- * cycled the whole free bits map and found no empty slot */
+/* Moves the eviction cursor past records which were refreshed since the
+ * cursor last passed them (second-chance/CLOCK). Their access bit is
+ * cleared, so after at most one full sweep a victim is always found.
+ * Expired records never get a second chance. */
+static errno_t sss_mc_skip_referenced(struct sss_mc_ctx *mcc,
+                                      int num_slots, uint32_t *_cur)
+{
+    struct sss_mc_rec *rec;
+    uint32_t tot_slots;
+    uint32_t swept = 0;
+    uint32_t cur = *_cur;
+    uint32_t rec_slots;
+    uint32_t i;
+    bool referenced;
+    bool used;
+    time_t now;
+
+    tot_slots = mcc->ft_size * 8;
+    now = time(NULL);
+
+    while (swept < tot_slots) {
+        if ((cur + num_slots) > tot_slots) {
+            swept += tot_slots - cur;
+            cur = 0;
+        }
+
+        referenced = false;
+        for (i = 0; i < num_slots; i++) {
+            MC_PROBE_BIT(mcc->free_table, cur + i, used);
+            if (!used) {
+                continue;
+            }
+
+            rec = MC_SLOT_TO_PTR(mcc->data_table, cur + i, struct sss_mc_rec);
+            if (!sss_mc_is_valid_rec(mcc, rec)) {
+                return EFAULT;
+            }
+            rec_slots = MC_SIZE_TO_SLOTS(rec->len);
+
+            MC_PROBE_BIT(mcc->access_table, cur + i, referenced);
+            if (referenced && rec->expire >= now) {
+                MC_CLEAR_BIT(mcc->access_table, cur + i);
+                mcc->stats.second_chances++;
+                /* restart right after the referenced record */
+                i += rec_slots;
+                break;
+            }
+            referenced = false;
+            i += rec_slots - 1;
+        }
+
+        if (!referenced) {
+            break;
+        }
+        swept += i;
+        cur += i;
+    }
+
+    if ((cur + num_slots) > tot_slots) {
+        cur = 0;
+    }
+
+    *_cur = cur;
+    return EOK;
+}
+
+/* Allocates num_slots consecutive slots, preferring free ones. If there
+ * are none, records are evicted at the position of a CLOCK cursor,
+ * giving recently refreshed records a second chance. */
 static errno_t sss_mc_find_free_slots(struct sss_mc_ctx *mcc,
                                       int num_slots, uint32_t *free_slot)
 {
@@ -397,6 +498,7 @@ static errno_t sss_mc_find_free_slots(struct sss_mc_ctx *mcc,
     uint32_t i;
     uint32_t t;
     bool used;
+    errno_t ret;
 
     tot_slots = mcc->ft_size * 8;
 
@@ -462,7 +564,18 @@ static errno_t sss_mc_find_free_slots(struct sss_mc_ctx *mcc,
         sss_log(SSS_LOG_NOTICE, "mmap cache of type '%s' is full, if you see "
                 "this message often then please consider increase of cache size",
                 mc_type_to_str(mcc->type));
+        DEBUG(SSSDBG_CONF_SETTINGS,
+              "mmap cache of type '%s': %"PRIu64" records (%"PRIu64" slots) "
+              "evicted, %"PRIu64" second chances given\n",
+              mc_type_to_str(mcc->type), mcc->stats.evicted_records,
+              mcc->stats.evicted_slots, mcc->stats.second_chances);
+    }
+
+    ret = sss_mc_skip_referenced(mcc, num_slots, &cur);
+    if (ret != EOK) {
+        return ret;
     }
+
     for (i = 0; i < num_slots; i++) {
         MC_PROBE_BIT(mcc->free_table, cur + i, used);
         if (used) {
@@ -476,6 +589,10 @@ static errno_t sss_mc_find_free_slots(struct sss_mc_ctx *mcc,
             }
             /* next loop skip the whole record */
             i += MC_SIZE_TO_SLOTS(rec->len) - 1;
+            mcc->evict_window_slots += MC_SIZE_TO_SLOTS(rec->len);
+            mcc->stats.evicted_slots += MC_SIZE_TO_SLOTS(rec->len);
+            mcc->stats.evicted_records++;
+            MC_STATS_INC(mcc->counters, evictions);
 
             /* finally invalidate record completely */
             sss_mc_invalidate_rec(mcc, rec);
@@ -500,6 +617,14 @@ static errno_t sss_mc_get_strs_offset(struct sss_mc_ctx *mcc,
     case SSS_MC_INITGROUPS:
         *_offset = offsetof(struct sss_mc_initgr_data, gids);
         return EOK;
+    case SSS_MC_SID:
+        *_offset = offsetof(struct sss_mc_sid_data, strs);
+        return EOK;
+    case SSS_MC_SERVICES:
+    case SSS_MC_HOSTS:
+    case SSS_MC_NETGROUPS:
+        *_offset = offsetof(struct sss_mc_reply_data, strs);
+        return EOK;
     default:
         DEBUG(SSSDBG_FATAL_FAILURE, "Unknown memory cache type.\n");
         return EINVAL;
@@ -520,6 +645,14 @@ static errno_t sss_mc_get_strs_len(struct sss_mc_ctx *mcc,
     case SSS_MC_INITGROUPS:
         *_len = ((struct sss_mc_initgr_data *)&rec->data)->data_len;
         return EOK;
+    case SSS_MC_SID:
+        *_len = ((struct sss_mc_sid_data *)&rec->data)->strs_len;
+        return EOK;
+    case SSS_MC_SERVICES:
+    case SSS_MC_HOSTS:
+    case SSS_MC_NETGROUPS:
+        *_len = ((struct sss_mc_reply_data *)&rec->data)->strs_len;
+        return EOK;
     default:
         DEBUG(SSSDBG_FATAL_FAILURE, "Unknown memory cache type.\n");
         return EINVAL;
@@ -530,6 +663,7 @@ static struct sss_mc_rec *sss_mc_find_record(struct sss_mc_ctx *mcc,
                                              struct sized_string *key)
 {
     struct sss_mc_rec *rec;
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     rel_ptr_t name_ptr;
@@ -541,7 +675,8 @@ static struct sss_mc_rec *sss_mc_find_record(struct sss_mc_ctx *mcc,
 
     hash = sss_mc_hash(mcc, key->str, key->len);
 
-    slot = mcc->hash_table[hash];
+    sss_mc_probe_init(&probe, hash, mcc->ht_size);
+    slot = sss_mc_probe(mcc, &probe);
     if (!MC_SLOT_WITHIN_BOUNDS(slot, mcc->dt_size)) {
         return NULL;
     }
@@ -571,7 +706,7 @@ static struct sss_mc_rec *sss_mc_find_record(struct sss_mc_ctx *mcc,
 
         if (key->len > strs_len) {
             /* The string cannot be in current record */
-            slot = sss_mc_next_slot_with_hash(rec, hash);
+            slot = sss_mc_probe(mcc, &probe);
             continue;
         }
 
@@ -599,7 +734,7 @@ static struct sss_mc_rec *sss_mc_find_record(struct sss_mc_ctx *mcc,
             break;
         }
 
-        slot = sss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_mc_probe(mcc, &probe);
     }
 
     if (slot == MC_INVALID_VAL) {
@@ -623,6 +758,11 @@ static errno_t sss_mc_get_record(struct sss_mc_ctx **_mcc,
     errno_t ret;
     int i;
 
+    /* grow the cache first if it is evicting valid records too often,
+     * callers must re-read *_mcc afterwards */
+    sss_mc_check_growth(_mcc);
+    mcc = *_mcc;
+
     num_slots = MC_SIZE_TO_SLOTS(rec_len);
 
     old_rec = sss_mc_find_record(mcc, key);
@@ -630,6 +770,9 @@ static errno_t sss_mc_get_record(struct sss_mc_ctx **_mcc,
         old_slots = MC_SIZE_TO_SLOTS(old_rec->len);
 
         if (old_slots == num_slots) {
+            /* the entry is being refreshed, so it is still in use */
+            MC_SET_BIT(mcc->access_table,
+                       MC_PTR_TO_SLOT(mcc->data_table, old_rec));
             *_rec = old_rec;
             return EOK;
         }
@@ -659,13 +802,16 @@ static errno_t sss_mc_get_record(struct sss_mc_ctx **_mcc,
     rec->len = rec_len;
     rec->next1 = MC_INVALID_VAL;
     rec->next2 = MC_INVALID_VAL;
-    rec->padding = MC_INVALID_VAL;
+    rec->hash3 = MC_INVALID_VAL;
     MC_LOWER_BARRIER(rec);
 
     /* and now mark slots as used */
     for (i = 0; i < num_slots; i++) {
         MC_SET_BIT(mcc->free_table, base_slot + i);
     }
+    if (old_rec) {
+        MC_SET_BIT(mcc->access_table, base_slot);
+    }
 
     *_rec = rec;
     return EOK;
@@ -674,22 +820,86 @@ static errno_t sss_mc_get_record(struct sss_mc_ctx **_mcc,
 static inline void sss_mmap_set_rec_header(struct sss_mc_ctx *mcc,
                                            struct sss_mc_rec *rec,
                                            size_t len, int ttl,
+                                           const char *domain,
                                            const char *key1, size_t key1_len,
                                            const char *key2, size_t key2_len)
 {
+    if (ttl == 0) {
+        ttl = mcc->valid_time_slot;
+    }
+
     rec->len = len;
     rec->expire = time(NULL) + ttl;
     rec->hash1 = sss_mc_hash(mcc, key1, key1_len);
     rec->hash2 = sss_mc_hash(mcc, key2, key2_len);
+    rec->hash3 = MC_INVALID_VAL32;
+    mcc->domain_table[MC_PTR_TO_SLOT(mcc->data_table, rec)] =
+                                            sss_mc_domain_tag(domain);
+
+    MC_STATS_INC(mcc->counters, stores);
+    PROBE(MMAP_CACHE_STORE, mcc->name, key1, ttl);
+}
+
+/* Clears the hash table and adds all valid records again, this drops the
+ * tombstones left behind by removed entries */
+static void sss_mc_index_rebuild(struct sss_mc_ctx *mcc)
+{
+    struct sss_mc_rec *rec;
+    uint32_t tot_slots;
+    uint32_t slot;
+    bool used;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Rebuilding '%s' mmap cache hash table\n",
+          mc_type_to_str(mcc->type));
+
+    memset(mcc->hash_table, 0xff, mcc->ht_size);
+    mcc->ht_used = 0;
+
+    tot_slots = mcc->ft_size * 8;
+    for (slot = 0; slot < tot_slots; slot++) {
+        MC_PROBE_BIT(mcc->free_table, slot, used);
+        if (!used) {
+            continue;
+        }
+
+        rec = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
+        if (rec->b1 == MC_INVALID_VAL || rec->b1 != rec->b2
+                || !MC_CHECK_RECORD_LENGTH(mcc, rec)) {
+            DEBUG(SSSDBG_FATAL_FAILURE,
+                  "Corrupted memcache entry at slot %u.\n", slot);
+            sss_mc_save_corrupted(mcc);
+            sss_mmap_cache_reset(mcc);
+            return;
+        }
+
+        sss_mc_add_rec_to_index(mcc, rec, rec->hash1);
+        sss_mc_add_rec_to_index(mcc, rec, rec->hash2);
+        if (rec->hash3 != MC_INVALID_VAL32) {
+            sss_mc_add_rec_to_index(mcc, rec, rec->hash3);
+        }
+
+        slot += MC_SIZE_TO_SLOTS(rec->len) - 1;
+    }
 }
 
 static inline void sss_mmap_chain_in_rec(struct sss_mc_ctx *mcc,
                                          struct sss_mc_rec *rec)
 {
     /* name first */
-    sss_mc_add_rec_to_chain(mcc, rec, rec->hash1);
+    sss_mc_add_rec_to_index(mcc, rec, rec->hash1);
     /* then uid/gid */
-    sss_mc_add_rec_to_chain(mcc, rec, rec->hash2);
+    sss_mc_add_rec_to_index(mcc, rec, rec->hash2);
+    /* and the uid of initgroups records */
+    if (rec->hash3 != MC_INVALID_VAL32) {
+        sss_mc_add_rec_to_index(mcc, rec, rec->hash3);
+    }
+
+    /* too many tombstones make lookups of missing keys scan far, keep
+     * at least a tenth of the entries empty */
+    if (mcc->ht_used > MC_HT_BUCKETS(mcc->ht_size) * MC_BUCKET_ENTRIES
+                       / 10 * 9) {
+        sss_mc_index_rebuild(mcc);
+    }
 }
 
 /***************************************************************************
@@ -712,7 +922,9 @@ static errno_t sss_mmap_cache_invalidate(struct sss_mc_ctx *mcc,
         return ENOENT;
     }
 
+    PROBE(MMAP_CACHE_INVALIDATE, mcc->name, key->str);
     sss_mc_invalidate_rec(mcc, rec);
+    MC_STATS_INC(mcc->counters, invalidations);
 
     return EOK;
 }
@@ -727,7 +939,9 @@ errno_t sss_mmap_cache_pw_store(struct sss_mc_ctx **_mcc,
                                 uid_t uid, gid_t gid,
                                 struct sized_string *gecos,
                                 struct sized_string *homedir,
-                                struct sized_string *shell)
+                                struct sized_string *shell,
+                                const char *domain,
+                                time_t ttl)
 {
     struct sss_mc_ctx *mcc = *_mcc;
     struct sss_mc_rec *rec;
@@ -762,6 +976,7 @@ errno_t sss_mmap_cache_pw_store(struct sss_mc_ctx **_mcc,
     if (ret != EOK) {
         return ret;
     }
+    mcc = *_mcc;
 
     data = (struct sss_mc_pwd_data *)rec->data;
     pos = 0;
@@ -769,7 +984,7 @@ errno_t sss_mmap_cache_pw_store(struct sss_mc_ctx **_mcc,
     MC_RAISE_BARRIER(rec);
 
     /* header */
-    sss_mmap_set_rec_header(mcc, rec, rec_len, mcc->valid_time_slot,
+    sss_mmap_set_rec_header(mcc, rec, rec_len, ttl, domain,
                             name->str, name->len, uidkey.str, uidkey.len);
 
     /* passwd struct */
@@ -805,6 +1020,7 @@ errno_t sss_mmap_cache_pw_invalidate_uid(struct sss_mc_ctx *mcc, uid_t uid)
 {
     struct sss_mc_rec *rec;
     struct sss_mc_pwd_data *data;
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     char *uidstr;
@@ -822,7 +1038,8 @@ errno_t sss_mmap_cache_pw_invalidate_uid(struct sss_mc_ctx *mcc, uid_t uid)
 
     hash = sss_mc_hash(mcc, uidstr, strlen(uidstr) + 1);
 
-    slot = mcc->hash_table[hash];
+    sss_mc_probe_init(&probe, hash, mcc->ht_size);
+    slot = sss_mc_probe(mcc, &probe);
     if (!MC_SLOT_WITHIN_BOUNDS(slot, mcc->dt_size)) {
         ret = ENOENT;
         goto done;
@@ -844,7 +1061,7 @@ errno_t sss_mmap_cache_pw_invalidate_uid(struct sss_mc_ctx *mcc, uid_t uid)
             break;
         }
 
-        slot = sss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_mc_probe(mcc, &probe);
     }
 
     if (slot == MC_INVALID_VAL) {
@@ -852,7 +1069,9 @@ errno_t sss_mmap_cache_pw_invalidate_uid(struct sss_mc_ctx *mcc, uid_t uid)
         goto done;
     }
 
+    PROBE(MMAP_CACHE_INVALIDATE, mcc->name, uidstr);
     sss_mc_invalidate_rec(mcc, rec);
+    MC_STATS_INC(mcc->counters, invalidations);
 
     ret = EOK;
 
@@ -869,7 +1088,9 @@ int sss_mmap_cache_gr_store(struct sss_mc_ctx **_mcc,
                             struct sized_string *name,
                             struct sized_string *pw,
                             gid_t gid, size_t memnum,
-                            char *membuf, size_t memsize)
+                            char *membuf, size_t memsize,
+                            const char *domain,
+                            time_t ttl)
 {
     struct sss_mc_ctx *mcc = *_mcc;
     struct sss_mc_rec *rec;
@@ -904,6 +1125,7 @@ int sss_mmap_cache_gr_store(struct sss_mc_ctx **_mcc,
     if (ret != EOK) {
         return ret;
     }
+    mcc = *_mcc;
 
     data = (struct sss_mc_grp_data *)rec->data;
     pos = 0;
@@ -911,7 +1133,7 @@ int sss_mmap_cache_gr_store(struct sss_mc_ctx **_mcc,
     MC_RAISE_BARRIER(rec);
 
     /* header */
-    sss_mmap_set_rec_header(mcc, rec, rec_len, mcc->valid_time_slot,
+    sss_mmap_set_rec_header(mcc, rec, rec_len, ttl, domain,
                             name->str, name->len, gidkey.str, gidkey.len);
 
     /* group struct */
@@ -943,6 +1165,7 @@ errno_t sss_mmap_cache_gr_invalidate_gid(struct sss_mc_ctx *mcc, gid_t gid)
 {
     struct sss_mc_rec *rec;
     struct sss_mc_grp_data *data;
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     char *gidstr;
@@ -960,7 +1183,8 @@ errno_t sss_mmap_cache_gr_invalidate_gid(struct sss_mc_ctx *mcc, gid_t gid)
 
     hash = sss_mc_hash(mcc, gidstr, strlen(gidstr) + 1);
 
-    slot = mcc->hash_table[hash];
+    sss_mc_probe_init(&probe, hash, mcc->ht_size);
+    slot = sss_mc_probe(mcc, &probe);
     if (!MC_SLOT_WITHIN_BOUNDS(slot, mcc->dt_size)) {
         ret = ENOENT;
         goto done;
@@ -982,7 +1206,7 @@ errno_t sss_mmap_cache_gr_invalidate_gid(struct sss_mc_ctx *mcc, gid_t gid)
             break;
         }
 
-        slot = sss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_mc_probe(mcc, &probe);
     }
 
     if (slot == MC_INVALID_VAL) {
@@ -990,7 +1214,9 @@ errno_t sss_mmap_cache_gr_invalidate_gid(struct sss_mc_ctx *mcc, gid_t gid)
         goto done;
     }
 
+    PROBE(MMAP_CACHE_INVALIDATE, mcc->name, gidstr);
     sss_mc_invalidate_rec(mcc, rec);
+    MC_STATS_INC(mcc->counters, invalidations);
 
     ret = EOK;
 
@@ -1002,12 +1228,17 @@ done:
 errno_t sss_mmap_cache_initgr_store(struct sss_mc_ctx **_mcc,
                                     struct sized_string *name,
                                     struct sized_string *unique_name,
+                                    uint32_t uid,
                                     uint32_t num_groups,
-                                    uint8_t *gids_buf)
+                                    uint8_t *gids_buf,
+                                    const char *domain,
+                                    time_t ttl)
 {
     struct sss_mc_ctx *mcc = *_mcc;
     struct sss_mc_rec *rec;
     struct sss_mc_initgr_data *data;
+    char uidstr[11];
+    size_t uidstr_len = 0;
     size_t data_len;
     size_t rec_len;
     size_t pos;
@@ -1018,8 +1249,19 @@ errno_t sss_mmap_cache_initgr_store(struct sss_mc_ctx **_mcc,
         return EINVAL;
     }
 
-    /* array of gids + name + unique_name */
-    data_len = num_groups * sizeof(uint32_t) + name->len + unique_name->len;
+    /* the record can also be found by the uid of the user, the client
+     * then does not need the exact name initgroups() was called with */
+    if (uid != 0) {
+        ret = snprintf(uidstr, sizeof(uidstr), "%lu", (unsigned long)uid);
+        if (ret < 0 || (size_t)ret >= sizeof(uidstr)) {
+            return EINVAL;
+        }
+        uidstr_len = ret + 1;
+    }
+
+    /* array of gids + name + unique_name + uid */
+    data_len = num_groups * sizeof(uint32_t) + name->len + unique_name->len
+               + uidstr_len;
     rec_len = sizeof(struct sss_mc_rec) + sizeof(struct sss_mc_initgr_data)
               + data_len;
     if (rec_len > mcc->dt_size) {
@@ -1031,6 +1273,7 @@ errno_t sss_mmap_cache_initgr_store(struct sss_mc_ctx **_mcc,
     if (ret != EOK) {
         return ret;
     }
+    mcc = *_mcc;
 
     data = (struct sss_mc_initgr_data *)rec->data;
     pos = 0;
@@ -1040,12 +1283,15 @@ errno_t sss_mmap_cache_initgr_store(struct sss_mc_ctx **_mcc,
     /* We cannot use two keys for searching in initgroups cache.
      * Use the first key twice.
      */
-    sss_mmap_set_rec_header(mcc, rec, rec_len, mcc->valid_time_slot,
+    sss_mmap_set_rec_header(mcc, rec, rec_len, ttl, domain,
                             name->str, name->len,
                             unique_name->str, unique_name->len);
+    if (uidstr_len != 0) {
+        rec->hash3 = sss_mc_hash(mcc, uidstr, uidstr_len);
+    }
 
     /* initgroups struct */
-    data->strs_len = name->len + unique_name->len;
+    data->strs_len = name->len + unique_name->len + uidstr_len;
     data->data_len = data_len;
     data->num_groups = num_groups;
     memcpy((char *)data->gids + pos, gids_buf, num_groups * sizeof(uint32_t));
@@ -1057,6 +1303,11 @@ errno_t sss_mmap_cache_initgr_store(struct sss_mc_ctx **_mcc,
 
     memcpy((char *)data->gids + pos, name->str, name->len);
     data->name = MC_PTR_DIFF((char *)data->gids + pos, data);
+    pos += name->len;
+
+    if (uidstr_len != 0) {
+        memcpy((char *)data->gids + pos, uidstr, uidstr_len);
+    }
 
     MC_LOWER_BARRIER(rec);
 
@@ -1073,107 +1324,315 @@ errno_t sss_mmap_cache_initgr_invalidate(struct sss_mc_ctx *mcc,
 }
 
 /***************************************************************************
- * initialization
+ * SID map
  ***************************************************************************/
 
-/* Copy of sss_mc_set_recycled is present in the src/tools/tools_mc_util.c.
- * If you modify this function, you should modify the duplicated function
- * too. */
-static errno_t sss_mc_set_recycled(int fd)
+static struct sss_mc_rec *sss_mc_find_sid_record(struct sss_mc_ctx *mcc,
+                                                 struct sized_string *sid)
 {
-    uint32_t w = SSS_MC_HEADER_RECYCLED;
-    off_t offset;
-    off_t pos;
-    ssize_t written;
+    struct sss_mc_rec *rec;
+    struct sss_mc_sid_data *data;
+    struct sss_mc_probe probe;
+    const char *rec_sid;
+    uint32_t hash;
+    uint32_t slot;
 
-    offset = offsetof(struct sss_mc_header, status);
+    hash = sss_mc_hash(mcc, sid->str, sid->len);
 
-    pos = lseek(fd, offset, SEEK_SET);
-    if (pos == -1) {
-        /* What do we do now? */
-        return errno;
-    }
+    sss_mc_probe_init(&probe, hash, mcc->ht_size);
+    slot = sss_mc_probe(mcc, &probe);
+    while (slot != MC_INVALID_VAL) {
+        if (!MC_SLOT_WITHIN_BOUNDS(slot, mcc->dt_size)) {
+            DEBUG(SSSDBG_FATAL_FAILURE, "Corrupted memcache.\n");
+            sss_mc_save_corrupted(mcc);
+            sss_mmap_cache_reset(mcc);
+            return NULL;
+        }
 
-    errno = 0;
-    written = sss_atomic_write_s(fd, (uint8_t *)&w, sizeof(w));
-    if (written == -1) {
-        return errno;
-    }
+        rec = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
+        data = (struct sss_mc_sid_data *)(&rec->data);
 
-    if (written != sizeof(w)) {
-        /* Write error */
-        return EIO;
+        if (rec->hash2 == hash && MC_CHECK_RECORD_LENGTH(mcc, rec)) {
+            rec_sid = sss_mc_rec_str(rec, data->sid);
+            if (rec_sid != NULL && strcmp(sid->str, rec_sid) == 0) {
+                return rec;
+            }
+        }
+
+        slot = sss_mc_probe(mcc, &probe);
     }
 
-    return EOK;
+    return NULL;
 }
 
-static void sss_mc_destroy_file(const char *filename)
+errno_t sss_mmap_cache_sid_store(struct sss_mc_ctx **_mcc,
+                                 struct sized_string *name,
+                                 struct sized_string *sid,
+                                 uint32_t id_type,
+                                 const char *domain,
+                                 time_t ttl)
 {
-    const useconds_t t = 50000;
-    const int retries = 3;
-    int ofd;
+    struct sss_mc_ctx *mcc = *_mcc;
+    struct sss_mc_rec *rec;
+    struct sss_mc_sid_data *data;
+    const char *rec_name;
+    size_t data_len;
+    size_t rec_len;
+    size_t pos;
     int ret;
 
-    ofd = open(filename, O_RDWR);
-    if (ofd != -1) {
-        ret = sss_br_lock_file(ofd, 0, 1, retries, t);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_FATAL_FAILURE, "Failed to lock file %s.\n", filename);
-        }
-        ret = sss_mc_set_recycled(ofd);
-        if (ret) {
-            DEBUG(SSSDBG_FATAL_FAILURE, "Failed to mark mmap file %s as"
-                                         " recycled: %d (%s)\n",
-                                         filename, ret, strerror(ret));
-        }
-        close(ofd);
-    } else if (errno != ENOENT) {
-        ret = errno;
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Failed to open old memory cache file %s: %d (%s)\n",
-               filename, ret, strerror(ret));
+    if (mcc == NULL) {
+        /* cache not initialized? */
+        return EINVAL;
     }
 
-    errno = 0;
-    ret = unlink(filename);
-    if (ret == -1 && errno != ENOENT) {
-        ret = errno;
-        DEBUG(SSSDBG_TRACE_FUNC, "Failed to delete mmap file %s: %d (%s)\n",
-                                  filename, ret, strerror(ret));
+    data_len = sid->len + name->len;
+    rec_len = sizeof(struct sss_mc_rec) + sizeof(struct sss_mc_sid_data)
+              + data_len;
+    if (rec_len > mcc->dt_size) {
+        return ENOMEM;
     }
-}
-
-static errno_t sss_mc_create_file(struct sss_mc_ctx *mc_ctx)
-{
-    const useconds_t t = 50000;
-    const int retries = 3;
-    mode_t old_mask;
-    int ret, uret;
 
-    /* temporarily relax umask as we need the file to be readable
-     * by everyone for now */
-    old_mask = umask(0022);
+    /* the object might have been renamed, drop the record cached under
+     * the old name so the SID does not resolve to it anymore */
+    rec = sss_mc_find_sid_record(mcc, sid);
+    if (rec != NULL) {
+        data = (struct sss_mc_sid_data *)rec->data;
+        rec_name = sss_mc_rec_str(rec, data->name);
+        if (rec_name == NULL || strcmp(name->str, rec_name) != 0) {
+            PROBE(MMAP_CACHE_INVALIDATE, mcc->name, sid->str);
+            sss_mc_invalidate_rec(mcc, rec);
+            MC_STATS_INC(mcc->counters, invalidations);
+        }
+    }
 
-    errno = 0;
-    mc_ctx->fd = open(mc_ctx->file, O_CREAT | O_EXCL | O_RDWR, 0644);
-    umask(old_mask);
-    if (mc_ctx->fd == -1) {
-        ret = errno;
-        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to open mmap file %s: %d(%s)\n",
-                                    mc_ctx->file, ret, strerror(ret));
+    ret = sss_mc_get_record(_mcc, rec_len, name, &rec);
+    if (ret != EOK) {
         return ret;
     }
+    mcc = *_mcc;
 
-    /* Make sure that the memory cache files are chowned to sssd.sssd even
-     * if the nss responder runs as root. This is because the specfile
-     * has the ownership recorded as sssd.sssd
-     */
-    ret = fchown(mc_ctx->fd, mc_ctx->uid, mc_ctx->gid);
-    if (ret != 0) {
-        ret = errno;
-        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to chown mmap file %s: %d(%s)\n",
-                                   mc_ctx->file, ret, strerror(ret));
+    data = (struct sss_mc_sid_data *)rec->data;
+    pos = 0;
+
+    MC_RAISE_BARRIER(rec);
+
+    /* header */
+    sss_mmap_set_rec_header(mcc, rec, rec_len, ttl, domain,
+                            name->str, name->len, sid->str, sid->len);
+
+    /* sid struct */
+    data->id_type = id_type;
+    data->strs_len = data_len;
+    memcpy(&data->strs[pos], sid->str, sid->len);
+    data->sid = MC_PTR_DIFF(&data->strs[pos], data);
+    pos += sid->len;
+    memcpy(&data->strs[pos], name->str, name->len);
+    data->name = MC_PTR_DIFF(&data->strs[pos], data);
+
+    MC_LOWER_BARRIER(rec);
+
+    /* finally chain the rec in the hash table */
+    sss_mmap_chain_in_rec(mcc, rec);
+
+    return EOK;
+}
+
+errno_t sss_mmap_cache_sid_invalidate(struct sss_mc_ctx *mcc,
+                                      struct sized_string *name)
+{
+    return sss_mmap_cache_invalidate(mcc, name);
+}
+
+errno_t sss_mmap_cache_sid_invalidate_sid(struct sss_mc_ctx *mcc,
+                                          struct sized_string *sid)
+{
+    struct sss_mc_rec *rec;
+
+    if (mcc == NULL) {
+        /* cache not initialized? */
+        return EINVAL;
+    }
+
+    rec = sss_mc_find_sid_record(mcc, sid);
+    if (rec == NULL) {
+        /* nothing to invalidate */
+        return ENOENT;
+    }
+
+    PROBE(MMAP_CACHE_INVALIDATE, mcc->name, sid->str);
+    sss_mc_invalidate_rec(mcc, rec);
+    MC_STATS_INC(mcc->counters, invalidations);
+
+    return EOK;
+}
+
+/***************************************************************************
+ * services, hosts and netgroups maps
+ ***************************************************************************/
+
+errno_t sss_mmap_cache_reply_store(struct sss_mc_ctx **_mcc,
+                                   struct sized_string *key,
+                                   uint8_t *reply, size_t reply_len,
+                                   time_t ttl)
+{
+    struct sss_mc_ctx *mcc = *_mcc;
+    struct sss_mc_rec *rec;
+    struct sss_mc_reply_data *data;
+    size_t data_len;
+    size_t rec_len;
+    int ret;
+
+    if (mcc == NULL) {
+        /* cache not initialized? */
+        return EINVAL;
+    }
+
+    data_len = key->len + reply_len;
+    rec_len = sizeof(struct sss_mc_rec) + sizeof(struct sss_mc_reply_data)
+              + data_len;
+    if (rec_len > mcc->dt_size) {
+        return ENOMEM;
+    }
+
+    ret = sss_mc_get_record(_mcc, rec_len, key, &rec);
+    if (ret != EOK) {
+        return ret;
+    }
+    mcc = *_mcc;
+
+    data = (struct sss_mc_reply_data *)rec->data;
+
+    MC_RAISE_BARRIER(rec);
+
+    /* There is a single key, use it twice */
+    sss_mmap_set_rec_header(mcc, rec, rec_len, ttl, NULL,
+                            key->str, key->len, key->str, key->len);
+
+    /* reply struct */
+    data->strs_len = data_len;
+    data->reply_len = reply_len;
+    memcpy(data->strs, key->str, key->len);
+    data->key = MC_PTR_DIFF(data->strs, data);
+    memcpy(&data->strs[key->len], reply, reply_len);
+    data->reply = MC_PTR_DIFF(&data->strs[key->len], data);
+
+    MC_LOWER_BARRIER(rec);
+
+    /* finally chain the rec in the hash table */
+    sss_mmap_chain_in_rec(mcc, rec);
+
+    return EOK;
+}
+
+errno_t sss_mmap_cache_reply_invalidate(struct sss_mc_ctx *mcc,
+                                        struct sized_string *key)
+{
+    return sss_mmap_cache_invalidate(mcc, key);
+}
+
+/***************************************************************************
+ * initialization
+ ***************************************************************************/
+
+/* Copy of sss_mc_set_recycled is present in the src/tools/tools_mc_util.c.
+ * If you modify this function, you should modify the duplicated function
+ * too. */
+static errno_t sss_mc_set_recycled(int fd)
+{
+    uint32_t w = SSS_MC_HEADER_RECYCLED;
+    off_t offset;
+    off_t pos;
+    ssize_t written;
+
+    offset = offsetof(struct sss_mc_header, status);
+
+    pos = lseek(fd, offset, SEEK_SET);
+    if (pos == -1) {
+        /* What do we do now? */
+        return errno;
+    }
+
+    errno = 0;
+    written = sss_atomic_write_s(fd, (uint8_t *)&w, sizeof(w));
+    if (written == -1) {
+        return errno;
+    }
+
+    if (written != sizeof(w)) {
+        /* Write error */
+        return EIO;
+    }
+
+    return EOK;
+}
+
+static void sss_mc_destroy_file(const char *filename)
+{
+    const useconds_t t = 50000;
+    const int retries = 3;
+    int ofd;
+    int ret;
+
+    ofd = open(filename, O_RDWR);
+    if (ofd != -1) {
+        ret = sss_br_lock_file(ofd, 0, 1, retries, t);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_FATAL_FAILURE, "Failed to lock file %s.\n", filename);
+        }
+        ret = sss_mc_set_recycled(ofd);
+        if (ret) {
+            DEBUG(SSSDBG_FATAL_FAILURE, "Failed to mark mmap file %s as"
+                                         " recycled: %d (%s)\n",
+                                         filename, ret, strerror(ret));
+        }
+        close(ofd);
+    } else if (errno != ENOENT) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to open old memory cache file %s: %d (%s)\n",
+               filename, ret, strerror(ret));
+    }
+
+    errno = 0;
+    ret = unlink(filename);
+    if (ret == -1 && errno != ENOENT) {
+        ret = errno;
+        DEBUG(SSSDBG_TRACE_FUNC, "Failed to delete mmap file %s: %d (%s)\n",
+                                  filename, ret, strerror(ret));
+    }
+}
+
+static errno_t sss_mc_create_file(struct sss_mc_ctx *mc_ctx)
+{
+    const useconds_t t = 50000;
+    const int retries = 3;
+    mode_t old_mask;
+    int ret, uret;
+
+    /* temporarily relax umask as we need the file to be readable
+     * by everyone for now */
+    old_mask = umask(0022);
+
+    errno = 0;
+    mc_ctx->fd = open(mc_ctx->file, O_CREAT | O_EXCL | O_RDWR, 0644);
+    umask(old_mask);
+    if (mc_ctx->fd == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to open mmap file %s: %d(%s)\n",
+                                    mc_ctx->file, ret, strerror(ret));
+        return ret;
+    }
+
+    /* Make sure that the memory cache files are chowned to sssd.sssd even
+     * if the nss responder runs as root. This is because the specfile
+     * has the ownership recorded as sssd.sssd
+     */
+    ret = fchown(mc_ctx->fd, mc_ctx->uid, mc_ctx->gid);
+    if (ret != 0) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to chown mmap file %s: %d(%s)\n",
+                                   mc_ctx->file, ret, strerror(ret));
         return ret;
     }
 
@@ -1228,8 +1687,9 @@ static void sss_mc_header_update(struct sss_mc_ctx *mc_ctx, int status)
         h->major_vno = SSS_MC_MAJOR_VNO;
         h->minor_vno = SSS_MC_MINOR_VNO;
         h->seed = mc_ctx->seed;
-        h->reserved = 0;
+        h->hash_alg = mc_ctx->hash_alg;
     }
+    h->generation++;
     h->status = status;
     MC_LOWER_BARRIER(h);
 }
@@ -1241,6 +1701,10 @@ static int mc_ctx_destructor(struct sss_mc_ctx *mc_ctx)
     /* Print debug message to logs if munmap() or close()
      * fail but always return 0 */
 
+    if (mc_ctx->counters != NULL) {
+        munmap(mc_ctx->counters, sizeof(struct sss_mc_counters));
+    }
+
     if (mc_ctx->mmap_base != NULL) {
         ret = munmap(mc_ctx->mmap_base, mc_ctx->mmap_size);
         if (ret == -1) {
@@ -1264,12 +1728,100 @@ static int mc_ctx_destructor(struct sss_mc_ctx *mc_ctx)
     return 0;
 }
 
+/* Maps the usage counters of the responder's user for the cache, see
+ * struct sss_mc_counters. The stats directory is world writable with the
+ * sticky bit set, so every client can create a file of its own there but
+ * cannot touch the files of others. Failures are not fatal, the cache just
+ * does not count. */
+static void sss_mc_open_counters(struct sss_mc_ctx *mc_ctx)
+{
+    struct sss_mc_counters *counters;
+    struct stat fdstat;
+    char *file;
+    uid_t euid;
+    int fd;
+    int ret;
+
+    ret = mkdir(SSS_NSS_MCACHE_STATS_DIR, 0755);
+    if (ret == 0) {
+        ret = chmod(SSS_NSS_MCACHE_STATS_DIR, S_IRWXU | S_IRWXG | S_IRWXO
+                                              | S_ISVTX);
+        if (ret == -1) {
+            ret = errno;
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Failed to chmod %s: %d(%s)\n",
+                  SSS_NSS_MCACHE_STATS_DIR, ret, strerror(ret));
+            return;
+        }
+    } else if (errno != EEXIST) {
+        ret = errno;
+        DEBUG(SSSDBG_MINOR_FAILURE, "Failed to create %s: %d(%s)\n",
+              SSS_NSS_MCACHE_STATS_DIR, ret, strerror(ret));
+        return;
+    }
+
+    euid = geteuid();
+    file = talloc_asprintf(mc_ctx, "%s/%s.%lu", SSS_NSS_MCACHE_STATS_DIR,
+                           mc_ctx->name, (unsigned long)euid);
+    if (file == NULL) {
+        return;
+    }
+
+    fd = open(file, O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_MINOR_FAILURE, "Failed to open %s: %d(%s)\n",
+              file, ret, strerror(ret));
+        goto done;
+    }
+
+    ret = fstat(fd, &fdstat);
+    if (ret == -1 || !S_ISREG(fdstat.st_mode) || fdstat.st_uid != euid) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Ignoring unexpected file %s\n", file);
+        goto done;
+    }
+
+    if (fdstat.st_size < sizeof(struct sss_mc_counters)) {
+        ret = ftruncate(fd, sizeof(struct sss_mc_counters));
+        if (ret == -1) {
+            ret = errno;
+            DEBUG(SSSDBG_MINOR_FAILURE, "Failed to resize %s: %d(%s)\n",
+                  file, ret, strerror(ret));
+            goto done;
+        }
+    }
+
+    counters = mmap(NULL, sizeof(struct sss_mc_counters),
+                    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (counters == MAP_FAILED) {
+        ret = errno;
+        DEBUG(SSSDBG_MINOR_FAILURE, "Failed to mmap %s: %d(%s)\n",
+              file, ret, strerror(ret));
+        goto done;
+    }
+
+    if (counters->version != SSS_MC_STATS_VNO) {
+        memset(counters, 0, sizeof(struct sss_mc_counters));
+        counters->version = SSS_MC_STATS_VNO;
+    }
+
+    mc_ctx->counters = counters;
+
+done:
+    if (fd != -1) {
+        close(fd);
+    }
+    talloc_free(file);
+}
+
 #define POSIX_FALLOCATE_ATTEMPTS 3
 
-errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
-                            uid_t uid, gid_t gid,
-                            enum sss_mc_type type, size_t n_elem,
-                            time_t timeout, struct sss_mc_ctx **mcc)
+/* Creates and maps a new, empty cache file. The filename is stolen. */
+static errno_t sss_mc_init_ctx(TALLOC_CTX *mem_ctx, const char *name,
+                               char *filename, uid_t uid, gid_t gid,
+                               enum sss_mc_type type, size_t n_elem,
+                               time_t timeout, uint32_t hash_alg,
+                               struct sss_mc_ctx **mcc)
 {
     /* sss_mc_header alone occupies whole slot,
      * so each entry takes 2 slots at the very least
@@ -1278,28 +1830,6 @@ errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
 
     struct sss_mc_ctx *mc_ctx = NULL;
     int ret, dret;
-    char *filename;
-
-    filename = talloc_asprintf(mem_ctx, "%s/%s", SSS_NSS_MCACHE_DIR, name);
-    if (!filename) {
-        return ENOMEM;
-    }
-    /*
-     * First of all mark the current file as recycled
-     * and unlink so active clients will abandon its use ASAP
-     */
-    sss_mc_destroy_file(filename);
-
-    if ((timeout == 0) || (n_elem == 0)) {
-        DEBUG(SSSDBG_IMPORTANT_INFO,
-              "Fast '%s' mmap cache is explicitly DISABLED\n",
-              mc_type_to_str(type));
-        *mcc = NULL;
-        return EOK;
-    }
-    DEBUG(SSSDBG_CONF_SETTINGS,
-          "Fast '%s' mmap cache: timeout = %d, slots = %zu\n",
-          mc_type_to_str(type), (int)timeout, n_elem);
 
     mc_ctx = talloc_zero(mem_ctx, struct sss_mc_ctx);
     if (!mc_ctx) {
@@ -1321,6 +1851,7 @@ errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
     mc_ctx->type = type;
 
     mc_ctx->valid_time_slot = timeout;
+    mc_ctx->hash_alg = hash_alg;
 
     mc_ctx->file = talloc_steal(mc_ctx, filename);
 
@@ -1328,10 +1859,14 @@ errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
      * so we increase by the necessary amount if they are not a multiple */
     /* We can use MC_ALIGN64 for this */
     n_elem = MC_ALIGN64(n_elem);
-
-    /* hash table is double the size because it will store both forward and
-     * reverse keys (name/uid, name/gid, ..) */
-    mc_ctx->ht_size = MC_HT_SIZE(2 * n_elem / PAYLOAD_FACTOR);
+    mc_ctx->max_slots = n_elem * MC_GROW_MAX_FACTOR;
+    mc_ctx->evict_window_start = time(NULL);
+
+    /* hash table has twice as many entries as there can be records because
+     * it stores both forward and reverse keys (name/uid, name/gid, ..),
+     * doubled again to keep the open addressing table at most half full */
+    mc_ctx->ht_size = MC_HT_SIZE(MAX(1, 4 * n_elem / PAYLOAD_FACTOR
+                                        / MC_BUCKET_ENTRIES));
     mc_ctx->dt_size = n_elem * MC_SLOT_SIZE;
     mc_ctx->ft_size = n_elem / 8; /* 1 bit per slot */
     mc_ctx->mmap_size = MC_HEADER_SIZE +
@@ -1378,6 +1913,19 @@ errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
     memset(mc_ctx->free_table, 0x00, mc_ctx->ft_size);
     memset(mc_ctx->hash_table, 0xff, mc_ctx->ht_size);
 
+    mc_ctx->access_table = talloc_zero_size(mc_ctx, mc_ctx->ft_size);
+    if (mc_ctx->access_table == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    mc_ctx->domain_table = talloc_zero_array(mc_ctx, uint32_t,
+                                             mc_ctx->ft_size * 8);
+    if (mc_ctx->domain_table == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
     /* generate a pseudo-random seed.
      * Needed to fend off dictionary based collision attacks */
     ret = sss_generate_csprng_buffer((uint8_t *)&mc_ctx->seed, sizeof(mc_ctx->seed));
@@ -1385,6 +1933,8 @@ errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
         goto done;
     }
 
+    sss_mc_open_counters(mc_ctx);
+
     sss_mc_header_update(mc_ctx, SSS_MC_HEADER_ALIVE);
 
     ret = EOK;
@@ -1410,6 +1960,39 @@ done:
     return ret;
 }
 
+errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
+                            uid_t uid, gid_t gid,
+                            enum sss_mc_type type, size_t n_elem,
+                            time_t timeout, uint32_t hash_alg,
+                            struct sss_mc_ctx **mcc)
+{
+    char *filename;
+
+    filename = talloc_asprintf(mem_ctx, "%s/%s", SSS_NSS_MCACHE_DIR, name);
+    if (!filename) {
+        return ENOMEM;
+    }
+    /*
+     * First of all mark the current file as recycled
+     * and unlink so active clients will abandon its use ASAP
+     */
+    sss_mc_destroy_file(filename);
+
+    if ((timeout == 0) || (n_elem == 0)) {
+        DEBUG(SSSDBG_IMPORTANT_INFO,
+              "Fast '%s' mmap cache is explicitly DISABLED\n",
+              mc_type_to_str(type));
+        *mcc = NULL;
+        return EOK;
+    }
+    DEBUG(SSSDBG_CONF_SETTINGS,
+          "Fast '%s' mmap cache: timeout = %d, slots = %zu\n",
+          mc_type_to_str(type), (int)timeout, n_elem);
+
+    return sss_mc_init_ctx(mem_ctx, name, filename, uid, gid, type,
+                           n_elem, timeout, hash_alg, mcc);
+}
+
 errno_t sss_mmap_cache_reinit(TALLOC_CTX *mem_ctx,
                               uid_t uid, gid_t gid,
                               size_t n_elem,
@@ -1419,6 +2002,8 @@ errno_t sss_mmap_cache_reinit(TALLOC_CTX *mem_ctx,
     TALLOC_CTX* tmp_ctx = NULL;
     char *name;
     enum sss_mc_type type;
+    uint32_t hash_alg;
+    size_t max_slots;
 
     if (mc_ctx == NULL || (*mc_ctx) == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -1440,6 +2025,8 @@ errno_t sss_mmap_cache_reinit(TALLOC_CTX *mem_ctx,
     }
 
     type = (*mc_ctx)->type;
+    max_slots = (*mc_ctx)->max_slots;
+    hash_alg = (*mc_ctx)->hash_alg;
 
     if (n_elem == (size_t)-1) {
         n_elem = (*mc_ctx)->ft_size * 8;
@@ -1468,12 +2055,19 @@ errno_t sss_mmap_cache_reinit(TALLOC_CTX *mem_ctx,
                               type,
                               n_elem,
                               timeout,
+                              hash_alg,
                               mc_ctx);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Failed to re-initialize mmap cache.\n");
         goto done;
     }
 
+    /* a cache that was grown online must not grow past the bound that
+     * was derived from the configured size */
+    if (*mc_ctx != NULL && max_slots < (*mc_ctx)->max_slots) {
+        (*mc_ctx)->max_slots = MAX(max_slots, (*mc_ctx)->ft_size * 8);
+    }
+
 done:
     talloc_free(tmp_ctx);
     return ret;
@@ -1495,6 +2089,364 @@ void sss_mmap_cache_reset(struct sss_mc_ctx *mc_ctx)
     memset(mc_ctx->data_table, 0xff, mc_ctx->dt_size);
     memset(mc_ctx->free_table, 0x00, mc_ctx->ft_size);
     memset(mc_ctx->hash_table, 0xff, mc_ctx->ht_size);
+    mc_ctx->ht_used = 0;
+    memset(mc_ctx->access_table, 0x00, mc_ctx->ft_size);
+    memset(mc_ctx->domain_table, 0x00,
+           mc_ctx->ft_size * 8 * sizeof(uint32_t));
 
     sss_mc_header_update(mc_ctx, SSS_MC_HEADER_ALIVE);
 }
+
+errno_t sss_mmap_cache_invalidate_domain(struct sss_mc_ctx *mcc,
+                                         const char *domain)
+{
+    struct sss_mc_rec *rec;
+    uint32_t tot_slots;
+    uint32_t slot;
+    uint32_t tag;
+    size_t count = 0;
+    bool used;
+
+    if (mcc == NULL || domain == NULL) {
+        return EINVAL;
+    }
+
+    tag = sss_mc_domain_tag(domain);
+
+    tot_slots = mcc->ft_size * 8;
+    for (slot = 0; slot < tot_slots; slot++) {
+        MC_PROBE_BIT(mcc->free_table, slot, used);
+        if (!used) {
+            continue;
+        }
+
+        rec = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
+        if (!MC_CHECK_RECORD_LENGTH(mcc, rec)) {
+            DEBUG(SSSDBG_FATAL_FAILURE,
+                  "Corrupted memcache entry at slot %u.\n", slot);
+            sss_mc_save_corrupted(mcc);
+            sss_mmap_cache_reset(mcc);
+            return EFAULT;
+        }
+
+        /* the record is invalidated, skip its slots first */
+        slot += MC_SIZE_TO_SLOTS(rec->len) - 1;
+
+        if (mcc->domain_table[MC_PTR_TO_SLOT(mcc->data_table, rec)] == tag) {
+            sss_mc_invalidate_rec(mcc, rec);
+            MC_STATS_INC(mcc->counters, invalidations);
+            count++;
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Invalidated %zu records of domain [%s] in '%s' mmap cache\n",
+          count, domain, mc_type_to_str(mcc->type));
+
+    return EOK;
+}
+
+errno_t sss_mmap_cache_get_stats(struct sss_mc_ctx *mcc,
+                                 struct sss_mc_stats *stats)
+{
+    if (mcc == NULL) {
+        return EINVAL;
+    }
+
+    *stats = mcc->stats;
+    return EOK;
+}
+
+/***************************************************************************
+ * online growth
+ ***************************************************************************/
+
+/* Returns the string stored at a pointer relative to the record data,
+ * making sure it is zero-terminated within the record */
+static const char *sss_mc_rec_str(struct sss_mc_rec *rec, rel_ptr_t ptr)
+{
+    size_t data_len = rec->len - sizeof(struct sss_mc_rec);
+
+    if (ptr >= data_len
+            || memchr(rec->data + ptr, '\0', data_len - ptr) == NULL) {
+        return NULL;
+    }
+
+    return rec->data + ptr;
+}
+
+/* Retrieves the two keys a record was hashed with */
+static errno_t sss_mc_get_rec_keys(struct sss_mc_ctx *mcc,
+                                   struct sss_mc_rec *rec,
+                                   char *idstr, size_t idstr_len,
+                                   const char **_key1, const char **_key2)
+{
+    struct sss_mc_pwd_data *pwd_data;
+    struct sss_mc_grp_data *grp_data;
+    struct sss_mc_initgr_data *initgr_data;
+    struct sss_mc_sid_data *sid_data;
+    struct sss_mc_reply_data *reply_data;
+    int ret;
+
+    switch (mcc->type) {
+    case SSS_MC_PASSWD:
+        pwd_data = (struct sss_mc_pwd_data *)rec->data;
+        ret = snprintf(idstr, idstr_len, "%ld", (long)pwd_data->uid);
+        *_key1 = sss_mc_rec_str(rec, pwd_data->name);
+        *_key2 = idstr;
+        break;
+    case SSS_MC_GROUP:
+        grp_data = (struct sss_mc_grp_data *)rec->data;
+        ret = snprintf(idstr, idstr_len, "%ld", (long)grp_data->gid);
+        *_key1 = sss_mc_rec_str(rec, grp_data->name);
+        *_key2 = idstr;
+        break;
+    case SSS_MC_INITGROUPS:
+        initgr_data = (struct sss_mc_initgr_data *)rec->data;
+        ret = 0;
+        *_key1 = sss_mc_rec_str(rec, initgr_data->name);
+        *_key2 = sss_mc_rec_str(rec, initgr_data->unique_name);
+        break;
+    case SSS_MC_SID:
+        sid_data = (struct sss_mc_sid_data *)rec->data;
+        ret = 0;
+        *_key1 = sss_mc_rec_str(rec, sid_data->name);
+        *_key2 = sss_mc_rec_str(rec, sid_data->sid);
+        break;
+    case SSS_MC_SERVICES:
+    case SSS_MC_HOSTS:
+    case SSS_MC_NETGROUPS:
+        reply_data = (struct sss_mc_reply_data *)rec->data;
+        ret = 0;
+        *_key1 = sss_mc_rec_str(rec, reply_data->key);
+        *_key2 = *_key1;
+        break;
+    default:
+        return EINVAL;
+    }
+
+    if (ret < 0 || (size_t)ret >= idstr_len || *_key1 == NULL || *_key2 == NULL) {
+        return EFAULT;
+    }
+
+    return EOK;
+}
+
+/* Returns the uid string stored behind the name of an initgroups record */
+static const char *sss_mc_initgr_uid_str(struct sss_mc_rec *rec)
+{
+    struct sss_mc_initgr_data *data;
+    const char *name;
+
+    data = (struct sss_mc_initgr_data *)rec->data;
+    name = sss_mc_rec_str(rec, data->name);
+    if (name == NULL) {
+        return NULL;
+    }
+
+    return sss_mc_rec_str(rec, data->name + strlen(name) + 1);
+}
+
+/* Copies a valid record into a freshly created cache, rehashing it with
+ * the keys of the new cache */
+static errno_t sss_mc_copy_rec(struct sss_mc_ctx *src,
+                               struct sss_mc_rec *rec,
+                               struct sss_mc_ctx *dst)
+{
+    struct sss_mc_rec *new_rec;
+    const char *key1;
+    const char *key2;
+    const char *key3 = NULL;
+    char idstr[11];
+    uint32_t base_slot;
+    int num_slots;
+    bool referenced;
+    errno_t ret;
+    int i;
+
+    ret = sss_mc_get_rec_keys(src, rec, idstr, sizeof(idstr), &key1, &key2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (rec->hash3 != MC_INVALID_VAL32) {
+        key3 = sss_mc_initgr_uid_str(rec);
+        if (key3 == NULL) {
+            return EFAULT;
+        }
+    }
+
+    num_slots = MC_SIZE_TO_SLOTS(rec->len);
+    ret = sss_mc_find_free_slots(dst, num_slots, &base_slot);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    /* the new file is not published yet, no barriers needed */
+    new_rec = MC_SLOT_TO_PTR(dst->data_table, base_slot, struct sss_mc_rec);
+    memcpy(new_rec, rec, rec->len);
+    new_rec->next1 = MC_INVALID_VAL;
+    new_rec->next2 = MC_INVALID_VAL;
+    new_rec->hash1 = sss_mc_hash(dst, key1, strlen(key1) + 1);
+    new_rec->hash2 = sss_mc_hash(dst, key2, strlen(key2) + 1);
+    if (key3 != NULL) {
+        new_rec->hash3 = sss_mc_hash(dst, key3, strlen(key3) + 1);
+    }
+
+    for (i = 0; i < num_slots; i++) {
+        MC_SET_BIT(dst->free_table, base_slot + i);
+    }
+    MC_PROBE_BIT(src->access_table, MC_PTR_TO_SLOT(src->data_table, rec),
+                 referenced);
+    if (referenced) {
+        MC_SET_BIT(dst->access_table, base_slot);
+    }
+    dst->domain_table[base_slot] =
+                    src->domain_table[MC_PTR_TO_SLOT(src->data_table, rec)];
+
+    sss_mmap_chain_in_rec(dst, new_rec);
+
+    return EOK;
+}
+
+/* Builds a larger cache file next to the current one, copies all live
+ * records into it and atomically replaces the current file. Clients still
+ * using the old file see it marked as recycled and reopen the new one, so
+ * they never fall back to an empty cache. */
+static errno_t sss_mc_grow(struct sss_mc_ctx **_mcc)
+{
+    struct sss_mc_ctx *mcc = *_mcc;
+    struct sss_mc_ctx *new_mcc = NULL;
+    struct sss_mc_rec *rec;
+    TALLOC_CTX *tmp_ctx;
+    char *tmpfile;
+    char *file;
+    size_t n_elem;
+    uint32_t tot_slots;
+    uint32_t slot;
+    bool used;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    tot_slots = mcc->ft_size * 8;
+    n_elem = MIN(tot_slots * MC_GROW_FACTOR, mcc->max_slots);
+
+    file = talloc_strdup(tmp_ctx, mcc->file);
+    tmpfile = talloc_asprintf(tmp_ctx, "%s.grow", mcc->file);
+    if (file == NULL || tmpfile == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* remove leftovers of an interrupted growth */
+    ret = unlink(tmpfile);
+    if (ret == -1 && errno != ENOENT) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to remove %s: %d(%s)\n",
+              tmpfile, ret, strerror(ret));
+        goto done;
+    }
+
+    ret = sss_mc_init_ctx(talloc_parent(mcc), mcc->name,
+                          talloc_steal(NULL, tmpfile), mcc->uid, mcc->gid,
+                          mcc->type, n_elem, mcc->valid_time_slot,
+                          mcc->hash_alg, &new_mcc);
+    if (ret != EOK) {
+        goto done;
+    }
+    new_mcc->max_slots = mcc->max_slots;
+    new_mcc->stats = mcc->stats;
+
+    for (slot = 0; slot < tot_slots; slot++) {
+        MC_PROBE_BIT(mcc->free_table, slot, used);
+        if (!used) {
+            continue;
+        }
+
+        rec = MC_SLOT_TO_PTR(mcc->data_table, slot, struct sss_mc_rec);
+        if (!sss_mc_is_valid_rec(mcc, rec)) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Invalid record at slot %u, not growing cache\n", slot);
+            ret = EFAULT;
+            goto done;
+        }
+
+        ret = sss_mc_copy_rec(mcc, rec, new_mcc);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        slot += MC_SIZE_TO_SLOTS(rec->len) - 1;
+    }
+
+    ret = rename(new_mcc->file, file);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to rename %s to %s: %d(%s)\n",
+              new_mcc->file, file, ret, strerror(ret));
+        goto done;
+    }
+    talloc_free(new_mcc->file);
+    new_mcc->file = talloc_steal(new_mcc, file);
+
+    /* the old file is already unlinked by rename(), tell clients */
+    sss_mc_header_update(mcc, SSS_MC_HEADER_RECYCLED);
+
+    DEBUG(SSSDBG_IMPORTANT_INFO,
+          "Fast '%s' mmap cache grown from %u to %zu slots\n",
+          mc_type_to_str(mcc->type), tot_slots, n_elem);
+
+    talloc_free(mcc);
+    *_mcc = new_mcc;
+    new_mcc = NULL;
+    ret = EOK;
+
+done:
+    if (new_mcc != NULL) {
+        if (unlink(new_mcc->file) == -1 && errno != ENOENT) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Failed to remove %s\n",
+                  new_mcc->file);
+        }
+        talloc_free(new_mcc);
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static void sss_mc_check_growth(struct sss_mc_ctx **_mcc)
+{
+    struct sss_mc_ctx *mcc = *_mcc;
+    uint32_t tot_slots;
+    time_t now;
+    errno_t ret;
+
+    tot_slots = mcc->ft_size * 8;
+    if (tot_slots >= mcc->max_slots) {
+        return;
+    }
+
+    now = time(NULL);
+    if (now - mcc->evict_window_start > MC_GROW_WINDOW) {
+        mcc->evict_window_start = now;
+        mcc->evict_window_slots = 0;
+        return;
+    }
+
+    if (mcc->evict_window_slots < tot_slots / MC_GROW_EVICTION_RATIO) {
+        return;
+    }
+
+    ret = sss_mc_grow(_mcc);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Failed to grow '%s' mmap cache [%d]: %s\n",
+              mc_type_to_str(mcc->type), ret, sss_strerror(ret));
+        /* do not retry until the next window */
+        mcc->evict_window_start = now;
+        mcc->evict_window_slots = 0;
+    }
+}
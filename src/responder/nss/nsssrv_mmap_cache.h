@@ -29,32 +29,69 @@ enum sss_mc_type {
     SSS_MC_PASSWD,
     SSS_MC_GROUP,
     SSS_MC_INITGROUPS,
+    SSS_MC_SID,
+    SSS_MC_SERVICES,
+    SSS_MC_HOSTS,
+    SSS_MC_NETGROUPS,
+};
+
+/* Counters of the slot allocator, useful to size the caches */
+struct sss_mc_stats {
+    uint64_t evicted_records;   /* valid records overwritten */
+    uint64_t evicted_slots;     /* slots those records occupied */
+    uint64_t second_chances;    /* records spared because they were in use */
 };
 
 errno_t sss_mmap_cache_init(TALLOC_CTX *mem_ctx, const char *name,
                             uid_t uid, gid_t gid,
                             enum sss_mc_type type, size_t n_elem,
-                            time_t valid_time, struct sss_mc_ctx **mcc);
+                            time_t valid_time, uint32_t hash_alg,
+                            struct sss_mc_ctx **mcc);
 
+/* The records of the passwd, group, initgroups and SID maps are tagged
+ * with their domain, see sss_mmap_cache_invalidate_domain(). They are valid
+ * for ttl seconds, or for the timeout of the cache if ttl is 0. */
 errno_t sss_mmap_cache_pw_store(struct sss_mc_ctx **_mcc,
                                 struct sized_string *name,
                                 struct sized_string *pw,
                                 uid_t uid, gid_t gid,
                                 struct sized_string *gecos,
                                 struct sized_string *homedir,
-                                struct sized_string *shell);
+                                struct sized_string *shell,
+                                const char *domain,
+                                time_t ttl);
 
 errno_t sss_mmap_cache_gr_store(struct sss_mc_ctx **_mcc,
                                 struct sized_string *name,
                                 struct sized_string *pw,
                                 gid_t gid, size_t memnum,
-                                char *membuf, size_t memsize);
+                                char *membuf, size_t memsize,
+                                const char *domain,
+                                time_t ttl);
 
 errno_t sss_mmap_cache_initgr_store(struct sss_mc_ctx **_mcc,
                                     struct sized_string *name,
                                     struct sized_string *unique_name,
+                                    uint32_t uid,
                                     uint32_t num_groups,
-                                    uint8_t *gids_buf);
+                                    uint8_t *gids_buf,
+                                    const char *domain,
+                                    time_t ttl);
+
+errno_t sss_mmap_cache_sid_store(struct sss_mc_ctx **_mcc,
+                                 struct sized_string *name,
+                                 struct sized_string *sid,
+                                 uint32_t id_type,
+                                 const char *domain,
+                                 time_t ttl);
+
+/* Stores a whole reply, used by the services, hosts and netgroups caches.
+ * The key is built with sss_mc_reply_key(). The record is valid for ttl
+ * seconds, or for the timeout of the cache if ttl is 0. */
+errno_t sss_mmap_cache_reply_store(struct sss_mc_ctx **_mcc,
+                                   struct sized_string *key,
+                                   uint8_t *reply, size_t reply_len,
+                                   time_t ttl);
 
 errno_t sss_mmap_cache_pw_invalidate(struct sss_mc_ctx *mcc,
                                      struct sized_string *name);
@@ -69,6 +106,15 @@ errno_t sss_mmap_cache_gr_invalidate_gid(struct sss_mc_ctx *mcc, gid_t gid);
 errno_t sss_mmap_cache_initgr_invalidate(struct sss_mc_ctx *mcc,
                                          struct sized_string *name);
 
+errno_t sss_mmap_cache_sid_invalidate(struct sss_mc_ctx *mcc,
+                                      struct sized_string *name);
+
+errno_t sss_mmap_cache_sid_invalidate_sid(struct sss_mc_ctx *mcc,
+                                          struct sized_string *sid);
+
+errno_t sss_mmap_cache_reply_invalidate(struct sss_mc_ctx *mcc,
+                                        struct sized_string *key);
+
 errno_t sss_mmap_cache_reinit(TALLOC_CTX *mem_ctx,
                               uid_t uid, gid_t gid,
                               size_t n_elem,
@@ -76,4 +122,12 @@ errno_t sss_mmap_cache_reinit(TALLOC_CTX *mem_ctx,
 
 void sss_mmap_cache_reset(struct sss_mc_ctx *mc_ctx);
 
+/* Invalidates all records of the domain, the records of the other domains
+ * stay valid */
+errno_t sss_mmap_cache_invalidate_domain(struct sss_mc_ctx *mcc,
+                                         const char *domain);
+
+errno_t sss_mmap_cache_get_stats(struct sss_mc_ctx *mcc,
+                                 struct sss_mc_stats *stats);
+
 #endif /* _NSSSRV_MMAP_CACHE_H_ */
@@ -56,6 +56,7 @@ int pac_process_init(TALLOC_CTX *mem_ctx,
     int ret;
     enum idmap_error_code err;
     int fd_limit;
+    int cache_timeout;
     char *uid_str;
 
     pac_cmds = get_pac_cmds();
@@ -129,6 +130,30 @@ int pac_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
+    ret = confdb_get_int(pac_ctx->rctx->cdb, CONFDB_PAC_CONF_ENTRY,
+                         CONFDB_PAC_CACHE_TIMEOUT, 60,
+                         &cache_timeout);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Failed to get the PAC cache timeout.\n");
+        goto fail;
+    }
+
+    /* A cached PAC is not stored again, it must not outlive its copy in
+     * the cache of the user */
+    if (cache_timeout > pac_ctx->pac_lifetime) {
+        cache_timeout = pac_ctx->pac_lifetime;
+    }
+
+    if (cache_timeout > 0) {
+        ret = pac_cache_init(pac_ctx, rctx->ev, cache_timeout,
+                             &pac_ctx->pac_cache);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_FATAL_FAILURE, "pac_cache_init failed.\n");
+            goto fail;
+        }
+    }
+
     ret = schedule_get_domains_task(rctx, rctx->ev, rctx, NULL);
     if (ret != EOK) {
         DEBUG(SSSDBG_FATAL_FAILURE, "schedule_get_domains_tasks failed.\n");
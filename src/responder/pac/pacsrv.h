@@ -29,14 +29,35 @@
 #include "responder/common/responder_sbus.h"
 #include "lib/idmap/sss_idmap.h"
 
+struct pac_cache;
+
 struct pac_ctx {
     struct resp_ctx *rctx;
     struct sss_idmap_ctx *idmap_ctx;
     struct dom_sid *my_dom_sid;
     struct local_mapping_ranges *range_map;
     int pac_lifetime;
+    struct pac_cache *pac_cache;
 };
 
 struct sss_cmd_table *get_pac_cmds(void);
 
+errno_t pac_cache_init(TALLOC_CTX *mem_ctx,
+                       struct tevent_context *ev,
+                       time_t timeout,
+                       struct pac_cache **_cache);
+
+/* Returns EOK if the same PAC was stored less than the timeout ago
+ * Returns ENOENT otherwise
+ */
+errno_t pac_cache_check(struct pac_cache *cache,
+                        const uint8_t *blob,
+                        size_t blen);
+
+/* Remembers a PAC that was stored in the cache of its user */
+errno_t pac_cache_add(struct pac_cache *cache,
+                      const uint8_t *blob,
+                      size_t blen,
+                      const char *user_sid);
+
 #endif /* __PACSRV_H__ */
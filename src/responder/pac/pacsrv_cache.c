@@ -0,0 +1,281 @@
+/*
+   SSSD
+
+   PAC Responder - cache of stored PACs
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "util/util.h"
+#include "util/sss_ptr_hash.h"
+#include "responder/pac/pacsrv.h"
+
+/* A client like a Samba or NFS server sends the PAC of every service ticket
+ * it accepts, so the same PAC of a user arrives again and again. The cache
+ * remembers the PACs that were recently decoded and stored in the cache of
+ * their user, a repeated PAC is then acknowledged without doing either
+ * again.
+ *
+ * The entries are keyed by the server and KDC checksums of the PAC, which
+ * are read from the PAC header without decoding the NDR data. The checksums
+ * are not verified, so a hit is only accepted if the whole PAC is identical
+ * to the stored one, including the SID of its user. */
+
+/* PAC_TYPE_SRV_CHECKSUM and PAC_TYPE_KDC_CHECKSUM of MS-PAC */
+#define PAC_CACHE_SRV_CHECKSUM  6
+#define PAC_CACHE_KDC_CHECKSUM  7
+
+/* PACTYPE header and PAC_INFO_BUFFER sizes */
+#define PAC_CACHE_HEADER_LEN    8
+#define PAC_CACHE_BUFFER_LEN    16
+
+#define PAC_CACHE_MAX_ENTRIES   4096
+
+struct pac_cache {
+    struct tevent_context *ev;
+    hash_table_t *table;
+    time_t timeout;
+};
+
+struct pac_cache_entry {
+    uint8_t *blob;
+    size_t blen;
+    char *user_sid;
+    time_t expire;
+};
+
+static uint32_t pac_cache_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8
+           | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static char *pac_cache_hex_append(char *key, const uint8_t *data, size_t len)
+{
+    size_t c;
+
+    for (c = 0; c < len && key != NULL; c++) {
+        key = talloc_asprintf_append_buffer(key, "%02x", data[c]);
+    }
+
+    return key;
+}
+
+/* Returns the checksums as "<server>:<kdc>" in hex or NULL if the PAC is
+ * malformed or does not contain both of them */
+static char *pac_cache_key(TALLOC_CTX *mem_ctx,
+                           const uint8_t *blob, size_t blen)
+{
+    const uint8_t *srv = NULL;
+    const uint8_t *kdc = NULL;
+    uint32_t srv_len = 0;
+    uint32_t kdc_len = 0;
+    const uint8_t *buf;
+    uint32_t num_buffers;
+    uint32_t type;
+    uint32_t size;
+    uint32_t offset;
+    uint32_t i;
+    char *key;
+
+    if (blob == NULL || blen < PAC_CACHE_HEADER_LEN) {
+        return NULL;
+    }
+
+    num_buffers = pac_cache_le32(blob);
+    if (num_buffers > (blen - PAC_CACHE_HEADER_LEN) / PAC_CACHE_BUFFER_LEN) {
+        return NULL;
+    }
+
+    for (i = 0; i < num_buffers; i++) {
+        buf = blob + PAC_CACHE_HEADER_LEN + i * PAC_CACHE_BUFFER_LEN;
+        type = pac_cache_le32(buf);
+        size = pac_cache_le32(buf + 4);
+        offset = pac_cache_le32(buf + 8);
+
+        /* the offset is 64 bits wide, the PAC is never that large */
+        if (pac_cache_le32(buf + 12) != 0
+                || offset > blen || size > blen - offset) {
+            return NULL;
+        }
+
+        if (type == PAC_CACHE_SRV_CHECKSUM) {
+            srv = blob + offset;
+            srv_len = size;
+        } else if (type == PAC_CACHE_KDC_CHECKSUM) {
+            kdc = blob + offset;
+            kdc_len = size;
+        }
+    }
+
+    if (srv == NULL || kdc == NULL || srv_len == 0 || kdc_len == 0) {
+        return NULL;
+    }
+
+    key = talloc_strdup(mem_ctx, "");
+    key = pac_cache_hex_append(key, srv, srv_len);
+    if (key != NULL) {
+        key = talloc_strdup_append_buffer(key, ":");
+    }
+    key = pac_cache_hex_append(key, kdc, kdc_len);
+
+    return key;
+}
+
+errno_t pac_cache_init(TALLOC_CTX *mem_ctx,
+                       struct tevent_context *ev,
+                       time_t timeout,
+                       struct pac_cache **_cache)
+{
+    struct pac_cache *cache;
+
+    cache = talloc_zero(mem_ctx, struct pac_cache);
+    if (cache == NULL) {
+        return ENOMEM;
+    }
+    cache->ev = ev;
+    cache->timeout = timeout;
+
+    cache->table = sss_ptr_hash_create(cache, NULL, NULL);
+    if (cache->table == NULL) {
+        talloc_free(cache);
+        return ENOMEM;
+    }
+
+    *_cache = cache;
+    return EOK;
+}
+
+static void pac_cache_expired(struct tevent_context *ev,
+                              struct tevent_timer *te,
+                              struct timeval tv,
+                              void *pvt)
+{
+    struct pac_cache_entry *entry;
+
+    entry = talloc_get_type(pvt, struct pac_cache_entry);
+
+    /* removes the entry from the table and frees this timer */
+    talloc_free(entry);
+}
+
+errno_t pac_cache_check(struct pac_cache *cache,
+                        const uint8_t *blob,
+                        size_t blen)
+{
+    struct pac_cache_entry *entry;
+    char *key;
+
+    if (cache == NULL) {
+        return ENOENT;
+    }
+
+    key = pac_cache_key(NULL, blob, blen);
+    if (key == NULL) {
+        return ENOENT;
+    }
+
+    entry = sss_ptr_hash_lookup(cache->table, key, struct pac_cache_entry);
+    talloc_free(key);
+    if (entry == NULL) {
+        return ENOENT;
+    }
+
+    if (entry->expire <= time(NULL)) {
+        talloc_free(entry);
+        return ENOENT;
+    }
+
+    if (entry->blen != blen || memcmp(entry->blob, blob, blen) != 0) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "PAC with the checksums of the one of [%s] differs\n",
+              entry->user_sid);
+        return ENOENT;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "PAC of [%s] found in PAC cache.\n",
+          entry->user_sid);
+    return EOK;
+}
+
+errno_t pac_cache_add(struct pac_cache *cache,
+                      const uint8_t *blob,
+                      size_t blen,
+                      const char *user_sid)
+{
+    struct pac_cache_entry *entry;
+    struct tevent_timer *te;
+    char *key;
+    errno_t ret;
+
+    if (cache == NULL) {
+        return EOK;
+    }
+
+    if (hash_count(cache->table) >= PAC_CACHE_MAX_ENTRIES) {
+        DEBUG(SSSDBG_TRACE_INTERNAL, "PAC cache is full.\n");
+        return EOK;
+    }
+
+    entry = talloc_zero(cache, struct pac_cache_entry);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+    entry->blen = blen;
+    entry->expire = time(NULL) + cache->timeout;
+
+    key = pac_cache_key(entry, blob, blen);
+    if (key == NULL) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "PAC of [%s] has no checksums, not caching it.\n", user_sid);
+        ret = EOK;
+        goto done;
+    }
+
+    entry->blob = talloc_memdup(entry, blob, blen);
+    entry->user_sid = talloc_strdup(entry, user_sid);
+    if (entry->blob == NULL || entry->user_sid == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    te = tevent_add_timer(cache->ev, entry,
+                          tevent_timeval_current_ofs(cache->timeout, 0),
+                          pac_cache_expired, entry);
+    if (te == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* replace an older entry with the same checksums */
+    talloc_free(sss_ptr_hash_lookup(cache->table, key,
+                                    struct pac_cache_entry));
+
+    ret = sss_ptr_hash_add(cache->table, key, entry, struct pac_cache_entry);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Could not add the PAC of [%s] to PAC cache [%d]: %s\n",
+              user_sid, ret, sss_strerror(ret));
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "PAC of [%s] added to PAC cache.\n",
+          user_sid);
+    talloc_free(key);
+    return EOK;
+
+done:
+    talloc_free(entry);
+    return ret;
+}
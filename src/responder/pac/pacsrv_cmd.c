@@ -103,6 +103,12 @@ static errno_t pac_add_pac_user(struct cli_ctx *cctx)
         return EINVAL;
     }
 
+    ret = pac_cache_check(pr_ctx->pac_ctx->pac_cache, body, blen);
+    if (ret == EOK) {
+        /* stored recently, there is nothing to decode or update */
+        goto done;
+    }
+
     ret = ad_get_data_from_pac(pr_ctx, body, blen,
                                &pr_ctx->logon_info);
     if (ret != EOK) {
@@ -267,6 +273,14 @@ static void pac_resolve_user_sid_done(struct tevent_req *req)
         goto done;
     }
 
+    ret = pac_cache_add(pr_ctx->pac_ctx->pac_cache, pr_ctx->blob, pr_ctx->blen,
+                        pr_ctx->user_sid_str);
+    if (ret != EOK) {
+        /* not fatal, the PAC is stored */
+        DEBUG(SSSDBG_MINOR_FAILURE, "pac_cache_add failed.\n");
+        ret = EOK;
+    }
+
 done:
     talloc_free(pr_ctx);
     pac_cmd_done(cctx, ret);
@@ -22,6 +22,9 @@
 
 
 #include "src/responder/pam/pam_helpers.h"
+#include "util/crypto/sss_crypto.h"
+
+#define PAM_AUTH_CACHE_KEY_LEN 32
 
 struct pam_initgr_table_ctx {
     hash_table_t *id_table;
@@ -160,3 +163,322 @@ errno_t pam_initgr_check_timeout(hash_table_t *id_table,
     return EOK;
 }
 
+
+struct pam_auth_cache {
+    struct tevent_context *ev;
+    hash_table_t *table;
+    uint8_t key[PAM_AUTH_CACHE_KEY_LEN];
+};
+
+struct pam_auth_cache_entry {
+    struct pam_auth_cache *cache;
+    char *name;
+    uint8_t verifier[SSS_SHA1_LENGTH];
+    time_t expire;
+    time_t exp_date;
+};
+
+static int pam_auth_cache_destructor(struct pam_auth_cache *cache)
+{
+    sss_erase_mem_securely(cache->key, sizeof(cache->key));
+    return 0;
+}
+
+static int pam_auth_cache_entry_destructor(struct pam_auth_cache_entry *entry)
+{
+    sss_erase_mem_securely(entry->verifier, sizeof(entry->verifier));
+    return 0;
+}
+
+errno_t pam_auth_cache_init(TALLOC_CTX *mem_ctx,
+                            struct tevent_context *ev,
+                            struct pam_auth_cache **_cache)
+{
+    struct pam_auth_cache *cache;
+    errno_t ret;
+
+    cache = talloc_zero(mem_ctx, struct pam_auth_cache);
+    if (cache == NULL) {
+        return ENOMEM;
+    }
+    cache->ev = ev;
+
+    ret = sss_hash_create(cache, 0, &cache->table);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sss_generate_csprng_buffer(cache->key, sizeof(cache->key));
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to generate the key of the authentication cache.\n");
+        goto done;
+    }
+    talloc_set_destructor(cache, pam_auth_cache_destructor);
+
+    *_cache = cache;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(cache);
+    }
+    return ret;
+}
+
+static char *pam_auth_cache_name(TALLOC_CTX *mem_ctx,
+                                 struct sss_domain_info *domain,
+                                 const char *user)
+{
+    return talloc_asprintf(mem_ctx, "%s:%s", domain->name, user);
+}
+
+static errno_t pam_auth_cache_verifier(struct pam_auth_cache *cache,
+                                       const char *name,
+                                       const char *password,
+                                       uint8_t *verifier)
+{
+    char *in;
+    size_t name_len;
+    size_t pw_len;
+    int ret;
+
+    /* name and password separated by the terminating NUL of the name */
+    name_len = strlen(name) + 1;
+    pw_len = strlen(password);
+
+    in = talloc_size(NULL, name_len + pw_len);
+    if (in == NULL) {
+        return ENOMEM;
+    }
+    memcpy(in, name, name_len);
+    memcpy(in + name_len, password, pw_len);
+
+    ret = sss_hmac_sha1(cache->key, sizeof(cache->key),
+                        (unsigned char *) in, name_len + pw_len,
+                        verifier);
+
+    sss_erase_mem_securely(in, name_len + pw_len);
+    talloc_free(in);
+
+    return ret;
+}
+
+/* Compares in constant time to not reveal how much of a guess matched */
+static bool pam_auth_cache_verifier_eq(const uint8_t *a, const uint8_t *b)
+{
+    uint8_t diff = 0;
+    size_t c;
+
+    for (c = 0; c < SSS_SHA1_LENGTH; c++) {
+        diff |= a[c] ^ b[c];
+    }
+
+    return diff == 0;
+}
+
+static void pam_auth_cache_delete(struct pam_auth_cache *cache,
+                                  const char *name)
+{
+    hash_key_t key;
+    hash_value_t val;
+    int hret;
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(name);
+
+    hret = hash_lookup(cache->table, &key, &val);
+    if (hret != HASH_SUCCESS) {
+        return;
+    }
+
+    hret = hash_delete(cache->table, &key);
+    if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Could not clear [%s] from the authentication cache: [%s]\n",
+              name, hash_error_string(hret));
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "[%s] removed from PAM authentication cache\n", name);
+    talloc_free(val.ptr);
+}
+
+static void pam_auth_cache_expired(struct tevent_context *ev,
+                                   struct tevent_timer *te,
+                                   struct timeval tv,
+                                   void *pvt)
+{
+    struct pam_auth_cache_entry *entry;
+
+    entry = talloc_get_type(pvt, struct pam_auth_cache_entry);
+
+    /* frees the entry and this timer */
+    pam_auth_cache_delete(entry->cache, entry->name);
+}
+
+errno_t pam_auth_cache_set(struct pam_auth_cache *cache,
+                           struct sss_domain_info *domain,
+                           const char *user,
+                           const char *password,
+                           time_t timeout,
+                           time_t exp_date)
+{
+    struct pam_auth_cache_entry *entry;
+    struct tevent_timer *te;
+    hash_key_t key;
+    hash_value_t val;
+    errno_t ret;
+    int hret;
+
+    if (cache == NULL || timeout <= 0) {
+        return EOK;
+    }
+
+    entry = talloc_zero(cache, struct pam_auth_cache_entry);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+    talloc_set_destructor(entry, pam_auth_cache_entry_destructor);
+    entry->cache = cache;
+    entry->expire = time(NULL) + timeout;
+    entry->exp_date = exp_date;
+
+    entry->name = pam_auth_cache_name(entry, domain, user);
+    if (entry->name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = pam_auth_cache_verifier(cache, entry->name, password,
+                                  entry->verifier);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to compute the verifier.\n");
+        goto done;
+    }
+
+    te = tevent_add_timer(cache->ev, entry,
+                          tevent_timeval_current_ofs(timeout, 0),
+                          pam_auth_cache_expired, entry);
+    if (te == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    pam_auth_cache_delete(cache, entry->name);
+
+    key.type = HASH_KEY_STRING;
+    key.str = entry->name;
+    val.type = HASH_VALUE_PTR;
+    val.ptr = entry;
+
+    hret = hash_enter(cache->table, &key, &val);
+    if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Could not update authentication cache for [%s]: [%s]\n",
+              entry->name, hash_error_string(hret));
+        ret = EIO;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "[%s] added to PAM authentication cache\n", entry->name);
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(entry);
+    }
+    return ret;
+}
+
+errno_t pam_auth_cache_check(struct pam_auth_cache *cache,
+                             struct sss_domain_info *domain,
+                             const char *user,
+                             const char *password,
+                             time_t *_exp_date)
+{
+    uint8_t verifier[SSS_SHA1_LENGTH];
+    struct pam_auth_cache_entry *entry;
+    hash_key_t key;
+    hash_value_t val;
+    char *name;
+    errno_t ret;
+    int hret;
+
+    if (cache == NULL) {
+        return ENOENT;
+    }
+
+    name = pam_auth_cache_name(NULL, domain, user);
+    if (name == NULL) {
+        return ENOMEM;
+    }
+
+    key.type = HASH_KEY_STRING;
+    key.str = name;
+
+    hret = hash_lookup(cache->table, &key, &val);
+    if (hret == HASH_ERROR_KEY_NOT_FOUND) {
+        ret = ENOENT;
+        goto done;
+    } else if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_TRACE_ALL,
+              "Error searching user [%s] in PAM authentication cache.\n",
+              name);
+        ret = EIO;
+        goto done;
+    }
+
+    entry = talloc_get_type(val.ptr, struct pam_auth_cache_entry);
+    if (entry->expire <= time(NULL)) {
+        pam_auth_cache_delete(cache, name);
+        ret = ENOENT;
+        goto done;
+    }
+
+    ret = pam_auth_cache_verifier(cache, name, password, verifier);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to compute the verifier.\n");
+        goto done;
+    }
+
+    if (!pam_auth_cache_verifier_eq(verifier, entry->verifier)) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Password of [%s] does not match the cached verifier.\n", name);
+        pam_auth_cache_delete(cache, name);
+        ret = ERR_AUTH_FAILED;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "[%s] authenticated from PAM authentication cache.\n", name);
+    *_exp_date = entry->exp_date;
+    ret = EOK;
+
+done:
+    sss_erase_mem_securely(verifier, sizeof(verifier));
+    talloc_free(name);
+    return ret;
+}
+
+void pam_auth_cache_remove(struct pam_auth_cache *cache,
+                           struct sss_domain_info *domain,
+                           const char *user)
+{
+    char *name;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    name = pam_auth_cache_name(NULL, domain, user);
+    if (name == NULL) {
+        return;
+    }
+
+    pam_auth_cache_delete(cache, name);
+    talloc_free(name);
+}
@@ -39,4 +39,43 @@ errno_t pam_initgr_cache_set(struct tevent_context *ev,
 errno_t pam_initgr_check_timeout(hash_table_t *id_table,
                                  char *name);
 
+/* Memory-only cache of verifiers of passwords which were successfully
+ * checked against the cached credentials, so that repeated authentications
+ * within cached_auth_timeout can skip sysdb_cache_auth().
+ *
+ * A verifier is a HMAC of the domain, user and password with a random key
+ * that is generated when the PAM responder starts and never leaves its
+ * memory. Neither the verifiers nor the key are written to disk, every
+ * restart of the responder discards them. An entry expires after the given
+ * timeout and is removed as soon as a different password is tried or the
+ * user authenticates against the backend. */
+struct pam_auth_cache;
+
+errno_t pam_auth_cache_init(TALLOC_CTX *mem_ctx,
+                            struct tevent_context *ev,
+                            struct pam_auth_cache **_cache);
+
+errno_t pam_auth_cache_set(struct pam_auth_cache *cache,
+                           struct sss_domain_info *domain,
+                           const char *user,
+                           const char *password,
+                           time_t timeout,
+                           time_t exp_date);
+
+/* Returns EOK and the expiration date returned by sysdb_cache_auth() if the
+ * password matches the cached verifier
+ * Returns ENOENT if the user is not cached or the entry expired
+ * Returns ERR_AUTH_FAILED if the password does not match, the entry is
+ * removed in that case
+ */
+errno_t pam_auth_cache_check(struct pam_auth_cache *cache,
+                             struct sss_domain_info *domain,
+                             const char *user,
+                             const char *password,
+                             time_t *_exp_date);
+
+void pam_auth_cache_remove(struct pam_auth_cache *cache,
+                           struct sss_domain_info *domain,
+                           const char *user);
+
 #endif /* PAM_HELPERS_H_ */
@@ -40,6 +40,7 @@
 #include "responder/common/responder_packet.h"
 #include "providers/data_provider.h"
 #include "responder/pam/pamsrv.h"
+#include "responder/pam/pam_helpers.h"
 #include "responder/common/negcache.h"
 #include "sss_iface/sss_iface_async.h"
 
@@ -49,6 +50,7 @@
 #define NO_DOMAINS_ARE_PUBLIC "none"
 #define DEFAULT_ALLOWED_UIDS ALL_UIDS_ALLOWED
 #define DEFAULT_PAM_CERT_AUTH false
+#define DEFAULT_PAM_P11_CHILD_SERVICE false
 #define DEFAULT_PAM_CERT_DB_PATH SYSCONFDIR"/sssd/pki/sssd_auth_ca_db.pem"
 #define DEFAULT_PAM_INITGROUPS_SCHEME "no_session"
 
@@ -166,6 +168,7 @@ static int pam_process_init(TALLOC_CTX *mem_ctx,
     int id_timeout;
     int fd_limit;
     char *tmpstr = NULL;
+    bool p11_child_service;
 
     pam_cmds = get_pam_cmds();
     ret = sss_process_init(mem_ctx, ev, cdb,
@@ -233,6 +236,14 @@ static int pam_process_init(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = pam_auth_cache_init(pctx, pctx->rctx->ev, &pctx->auth_cache);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Could not create the authentication cache: [%s]\n",
+              sss_strerror(ret));
+        goto done;
+    }
+
     /* Set up file descriptor limits */
     ret = confdb_get_int(pctx->rctx->cdb,
                          CONFDB_PAM_CONF_ENTRY,
@@ -292,6 +303,26 @@ static int pam_process_init(TALLOC_CTX *mem_ctx,
             goto done;
         }
 
+        ret = confdb_get_bool(pctx->rctx->cdb,
+                              CONFDB_PAM_CONF_ENTRY,
+                              CONFDB_PAM_P11_CHILD_SERVICE,
+                              DEFAULT_PAM_P11_CHILD_SERVICE,
+                              &p11_child_service);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_FATAL_FAILURE,
+                  "Failed to read '"CONFDB_PAM_P11_CHILD_SERVICE"'.\n");
+            goto done;
+        }
+
+        if (p11_child_service) {
+            ret = p11_child_service_init(pctx, pctx->rctx->ev,
+                                         &pctx->p11_service);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_FATAL_FAILURE,
+                      "p11_child_service_init failed.\n");
+                goto done;
+            }
+        }
     }
 
     if (pctx->cert_auth || pctx->num_prompting_config_sections != 0) {
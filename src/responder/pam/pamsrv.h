@@ -39,6 +39,9 @@ enum pam_initgroups_scheme {
     PAM_INITGR_INVALID
 };
 
+struct pam_auth_cache;
+struct p11_child_service;
+
 struct pam_ctx {
     struct resp_ctx *rctx;
     time_t id_timeout;
@@ -57,6 +60,8 @@ struct pam_ctx {
     char *ca_db;
     struct sss_certmap_ctx *sss_certmap_ctx;
     char **smartcard_services;
+    /* Only set if p11_child_service is enabled */
+    struct p11_child_service *p11_service;
 
     char **prompting_config_sections;
     int num_prompting_config_sections;
@@ -66,6 +71,11 @@ struct pam_ctx {
     /* List of PAM services that are allowed to authenticate with GSSAPI. */
     char **gssapi_services;
     bool gssapi_check_upn;
+    /* Acceptor credentials of each keytab and target, see pamsrv_gssapi.c */
+    struct pam_gssapi_creds *gssapi_creds;
+
+    /* Verifiers of recent cached authentications, see pam_helpers.h */
+    struct pam_auth_cache *auth_cache;
 };
 
 struct pam_auth_req {
@@ -89,6 +99,20 @@ struct pam_auth_req {
     bool cert_auth_local;
 };
 
+/* State of a client connection, which pam_sss keeps open for all the
+ * requests of its PAM handle. */
+struct gssapi_state;
+struct pam_conn_user;
+
+struct pam_conn_state {
+    /* GSSAPI security context, see pamsrv_gssapi.c */
+    struct gssapi_state *gssapi;
+    /* User found by the previous request, see pamsrv_cmd.c */
+    struct pam_conn_user *user;
+};
+
+struct pam_conn_state *pam_get_conn_state(struct cli_ctx *cctx);
+
 struct sss_cmd_table *get_pam_cmds(void);
 
 errno_t
@@ -98,6 +122,10 @@ int LOCAL_pam_handler(struct pam_auth_req *preq);
 
 errno_t p11_child_init(struct pam_ctx *pctx);
 
+errno_t p11_child_service_init(TALLOC_CTX *mem_ctx,
+                               struct tevent_context *ev,
+                               struct p11_child_service **_svc);
+
 struct cert_auth_info;
 const char *sss_cai_get_cert(struct cert_auth_info *i);
 const char *sss_cai_get_token_name(struct cert_auth_info *i);
@@ -113,6 +141,7 @@ void sss_cai_check_users(struct cert_auth_info **list, size_t *_cert_count,
 
 struct tevent_req *pam_check_cert_send(TALLOC_CTX *mem_ctx,
                                        struct tevent_context *ev,
+                                       struct p11_child_service *p11_service,
                                        const char *ca_db,
                                        time_t timeout,
                                        const char *verify_opts,
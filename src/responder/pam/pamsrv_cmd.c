@@ -903,10 +903,33 @@ static void pam_reply(struct pam_auth_req *preq)
                     goto done;
                 }
 
+                if (use_cached_auth) {
+                    ret = pam_auth_cache_check(pctx->auth_cache, preq->domain,
+                                               pd->user, password, &exp_date);
+                    if (ret == EOK) {
+                        pam_handle_cached_login(preq, EOK, exp_date, 0,
+                                                use_cached_auth);
+                        return;
+                    }
+                }
+
                 ret = sysdb_cache_auth(preq->domain,
                                        pd->user, password,
                                        pctx->rctx->cdb, false,
                                        &exp_date, &delay_until);
+                if (ret == EOK && use_cached_auth) {
+                    ret = pam_auth_cache_set(pctx->auth_cache, preq->domain,
+                                             pd->user, password,
+                                             preq->domain->cached_auth_timeout,
+                                             exp_date);
+                    if (ret != EOK) {
+                        /* non-critical */
+                        DEBUG(SSSDBG_MINOR_FAILURE,
+                              "pam_auth_cache_set failed: %s:[%d]\n",
+                              sss_strerror(ret), ret);
+                    }
+                    ret = EOK;
+                }
 
                 pam_handle_cached_login(preq, ret, exp_date, delay_until,
                                         use_cached_auth);
@@ -1402,7 +1425,7 @@ static errno_t check_cert(TALLOC_CTX *mctx,
         return ret;
     }
 
-    req = pam_check_cert_send(mctx, ev,
+    req = pam_check_cert_send(mctx, ev, pctx->p11_service,
                               pctx->ca_db, p11_child_timeout,
                               cert_verification_opts, pctx->sss_certmap_ctx,
                               uri, pd);
@@ -1882,6 +1905,141 @@ done:
     pam_check_user_done(preq, ret);
 }
 
+struct pam_conn_state *pam_get_conn_state(struct cli_ctx *cctx)
+{
+    struct pam_conn_state *conn;
+
+    conn = talloc_get_type(cctx->state_ctx, struct pam_conn_state);
+    if (conn != NULL) {
+        return conn;
+    }
+
+    conn = talloc_zero(cctx, struct pam_conn_state);
+    if (conn == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero() failed\n");
+        return NULL;
+    }
+
+    cctx->state_ctx = conn;
+    return conn;
+}
+
+/* pam_sss sends the requests of all PAM phases (authenticate, account,
+ * open_session, ...) of a PAM handle over the same connection. The user
+ * found by one of them is kept with the connection for the lifetime of the
+ * PAM initgr cache entry, so the following phases do not look it up in the
+ * cache again. */
+struct pam_conn_user {
+    char *logon_name;
+    char **requested_domains;
+    enum cache_req_dom_type req_dom_type;
+    struct sss_domain_info *domain;
+    struct ldb_message *user_obj;
+    time_t expire;
+};
+
+static bool pam_conn_same_domains(char **a, char **b)
+{
+    size_t c;
+
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+
+    for (c = 0; a[c] != NULL && b[c] != NULL; c++) {
+        if (strcmp(a[c], b[c]) != 0) {
+            return false;
+        }
+    }
+
+    return a[c] == NULL && b[c] == NULL;
+}
+
+static struct pam_conn_user *pam_conn_user_get(struct pam_auth_req *preq)
+{
+    struct pam_conn_state *conn;
+    struct pam_conn_user *user;
+
+    conn = talloc_get_type(preq->cctx->state_ctx, struct pam_conn_state);
+    if (conn == NULL || conn->user == NULL) {
+        return NULL;
+    }
+    user = conn->user;
+
+    if (user->expire <= time(NULL)
+            || sss_domain_get_state(user->domain) == DOM_DISABLED) {
+        talloc_zfree(conn->user);
+        return NULL;
+    }
+
+    if (preq->pd->logon_name == NULL
+            || strcmp(user->logon_name, preq->pd->logon_name) != 0
+            || user->req_dom_type != preq->req_dom_type
+            || !pam_conn_same_domains(user->requested_domains,
+                                      preq->pd->requested_domains)) {
+        return NULL;
+    }
+
+    return user;
+}
+
+static void pam_conn_user_set(struct pam_auth_req *preq,
+                              struct pam_ctx *pctx)
+{
+    struct pam_conn_state *conn;
+    struct pam_conn_user *user;
+    size_t c;
+
+    if (pctx->id_timeout <= 0 || preq->pd->logon_name == NULL) {
+        return;
+    }
+
+    conn = pam_get_conn_state(preq->cctx);
+    if (conn == NULL) {
+        return;
+    }
+    talloc_zfree(conn->user);
+
+    user = talloc_zero(conn, struct pam_conn_user);
+    if (user == NULL) {
+        return;
+    }
+
+    user->logon_name = talloc_strdup(user, preq->pd->logon_name);
+    user->user_obj = ldb_msg_copy(user, preq->user_obj);
+    if (user->logon_name == NULL || user->user_obj == NULL) {
+        goto fail;
+    }
+
+    if (preq->pd->requested_domains != NULL) {
+        for (c = 0; preq->pd->requested_domains[c] != NULL; c++);
+
+        user->requested_domains = talloc_zero_array(user, char *, c + 1);
+        if (user->requested_domains == NULL) {
+            goto fail;
+        }
+
+        for (c = 0; preq->pd->requested_domains[c] != NULL; c++) {
+            user->requested_domains[c] = talloc_strdup(user->requested_domains,
+                                               preq->pd->requested_domains[c]);
+            if (user->requested_domains[c] == NULL) {
+                goto fail;
+            }
+        }
+    }
+
+    user->req_dom_type = preq->req_dom_type;
+    user->domain = preq->domain;
+    user->expire = time(NULL) + pctx->id_timeout;
+
+    conn->user = user;
+    return;
+
+fail:
+    DEBUG(SSSDBG_MINOR_FAILURE, "Could not keep the user of the connection.\n");
+    talloc_free(user);
+}
+
 static void pam_check_user_search_next(struct tevent_req *req);
 static void pam_check_user_search_lookup(struct tevent_req *req);
 static void pam_check_user_search_done(struct pam_auth_req *preq, int ret,
@@ -1893,6 +2051,27 @@ static int pam_check_user_search(struct pam_auth_req *preq)
 {
     struct tevent_req *dpreq;
     struct cache_req_data *data;
+    struct pam_conn_user *user;
+
+    user = pam_conn_user_get(preq);
+    if (user != NULL) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Using [%s] found by the previous request of the client.\n",
+              preq->pd->logon_name);
+
+        preq->user_obj = ldb_msg_copy(preq, user->user_obj);
+        if (preq->user_obj == NULL) {
+            return ENOMEM;
+        }
+        pd_set_primary_name(preq->user_obj, preq->pd);
+        preq->domain = user->domain;
+
+        pam_dom_forwarder(preq);
+
+        /* the request is continued or already answered by
+         * pam_dom_forwarder() */
+        return EAGAIN;
+    }
 
     data = cache_req_data_name(preq,
                                CACHE_REQ_INITGROUPS,
@@ -2012,6 +2191,9 @@ static void pam_check_user_search_next(struct tevent_req *req)
     }
     cache_req_data_set_bypass_cache(data, true);
     cache_req_data_set_bypass_dp(data, false);
+    /* The backend does not repeat a lookup that another responder just
+     * did */
+    cache_req_data_set_refresh(data, true);
     cache_req_data_set_requested_domains(data, preq->pd->requested_domains);
 
     dpreq = cache_req_send(preq,
@@ -2074,6 +2256,8 @@ static void pam_check_user_search_done(struct pam_auth_req *preq, int ret,
                   "Proceeding with PAM actions\n");
         }
 
+        pam_conn_user_set(preq, pctx);
+
         pam_dom_forwarder(preq);
     }
 
@@ -2236,6 +2420,13 @@ static void pam_dom_forwarder(struct pam_auth_req *preq)
         return;
     }
 
+    /* The backend might accept a different password than the one that was
+     * cached, do not answer from the old verifier afterwards. */
+    if (preq->pd->cmd == SSS_PAM_AUTHENTICATE
+            || preq->pd->cmd == SSS_PAM_CHAUTHTOK) {
+        pam_auth_cache_remove(pctx->auth_cache, preq->domain, preq->pd->user);
+    }
+
     if (may_do_cert_auth(pctx, preq->pd) && preq->cert_list != NULL) {
         /* Check if user matches certificate user */
         found = false;
@@ -408,14 +408,19 @@ static struct gssapi_state *gssapi_get_state(struct cli_ctx *cli_ctx,
                                              const char *username,
                                              struct sss_domain_info *domain)
 {
+    struct pam_conn_state *conn;
     struct gssapi_state *state;
 
-    state = talloc_get_type(cli_ctx->state_ctx, struct gssapi_state);
-    if (state != NULL) {
-        return state;
+    conn = pam_get_conn_state(cli_ctx);
+    if (conn == NULL) {
+        return NULL;
+    }
+
+    if (conn->gssapi != NULL) {
+        return conn->gssapi;
     }
 
-    state = talloc_zero(cli_ctx, struct gssapi_state);
+    state = talloc_zero(conn, struct gssapi_state);
     if (state == NULL) {
         return NULL;
     }
@@ -431,7 +436,7 @@ static struct gssapi_state *gssapi_get_state(struct cli_ctx *cli_ctx,
     state->ctx = GSS_C_NO_CONTEXT;
     talloc_set_destructor(state, gssapi_state_destructor);
 
-    cli_ctx->state_ctx = state;
+    conn->gssapi = state;
 
     return state;
 }
@@ -494,9 +499,210 @@ done:
     return ret;
 }
 
+/* Acquiring the acceptor credentials reads the keytab, which is the same
+ * for every authentication of a domain. The credentials are therefore kept
+ * for each keytab and target and acquired again once the keytab changed on
+ * disk. Keeping the credentials also keeps the replay cache of the acceptor
+ * open between the authentications. Keytabs which are not files, and the
+ * default keytab, can only be reloaded after PAM_GSSAPI_CREDS_MAX_AGE. */
+#define PAM_GSSAPI_CREDS_MAX_AGE 300
+
+struct pam_gssapi_creds {
+    struct pam_gssapi_creds *prev;
+    struct pam_gssapi_creds *next;
+
+    const char *keytab;
+    const char *target;
+    gss_cred_id_t creds;
+
+    time_t acquired;
+    /* the keytab file when the credentials were acquired */
+    bool has_stat;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+};
+
+static int pam_gssapi_creds_destructor(struct pam_gssapi_creds *entry)
+{
+    OM_uint32 minor;
+
+    gss_release_cred(&minor, &entry->creds);
+    return 0;
+}
+
+static bool pam_gssapi_str_equal(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+
+    return strcmp(a, b) == 0;
+}
+
+/* Returns the path of a FILE keytab or NULL */
+static const char *pam_gssapi_keytab_path(const char *keytab)
+{
+    if (keytab == NULL) {
+        return NULL;
+    }
+
+    if (strncmp(keytab, "FILE:", 5) == 0) {
+        return keytab + 5;
+    }
+
+    if (strncmp(keytab, "WRFILE:", 7) == 0) {
+        return keytab + 7;
+    }
+
+    /* a residual without a type is a file name */
+    if (keytab[0] == '/') {
+        return keytab;
+    }
+
+    return NULL;
+}
+
+static void pam_gssapi_creds_stat(struct pam_gssapi_creds *entry)
+{
+    const char *path;
+    struct stat st;
+
+    entry->has_stat = false;
+
+    path = pam_gssapi_keytab_path(entry->keytab);
+    if (path == NULL || stat(path, &st) != 0) {
+        return;
+    }
+
+    entry->has_stat = true;
+    entry->dev = st.st_dev;
+    entry->ino = st.st_ino;
+    entry->size = st.st_size;
+    entry->mtime = st.st_mtim;
+}
+
+static bool pam_gssapi_creds_current(struct pam_gssapi_creds *entry)
+{
+    const char *path;
+    struct stat st;
+
+    if (entry->acquired + PAM_GSSAPI_CREDS_MAX_AGE <= time(NULL)) {
+        return false;
+    }
+
+    path = pam_gssapi_keytab_path(entry->keytab);
+    if (path == NULL) {
+        return true;
+    }
+
+    if (stat(path, &st) != 0 || !entry->has_stat) {
+        return false;
+    }
+
+    return st.st_dev == entry->dev
+           && st.st_ino == entry->ino
+           && st.st_size == entry->size
+           && st.st_mtim.tv_sec == entry->mtime.tv_sec
+           && st.st_mtim.tv_nsec == entry->mtime.tv_nsec;
+}
+
+/* The credentials are owned by the cache, the caller must not release them */
+static errno_t pam_gssapi_get_creds(struct pam_ctx *pam_ctx,
+                                    const char *keytab,
+                                    const char *target,
+                                    gss_cred_id_t *_creds)
+{
+    struct pam_gssapi_creds *entry;
+    errno_t ret;
+
+    DLIST_FOR_EACH(entry, pam_ctx->gssapi_creds) {
+        if (pam_gssapi_str_equal(entry->keytab, keytab)
+                && pam_gssapi_str_equal(entry->target, target)) {
+            break;
+        }
+    }
+
+    if (entry != NULL) {
+        if (pam_gssapi_creds_current(entry)) {
+            DEBUG(SSSDBG_TRACE_INTERNAL, "Using cached credentials of [%s]\n",
+                  keytab != NULL ? keytab : "default");
+            *_creds = entry->creds;
+            return EOK;
+        }
+
+        DEBUG(SSSDBG_TRACE_FUNC, "Keytab [%s] changed, acquiring the "
+              "credentials again\n", keytab != NULL ? keytab : "default");
+        DLIST_REMOVE(pam_ctx->gssapi_creds, entry);
+        talloc_free(entry);
+    }
+
+    entry = talloc_zero(pam_ctx, struct pam_gssapi_creds);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+    entry->creds = GSS_C_NO_CREDENTIAL;
+    talloc_set_destructor(entry, pam_gssapi_creds_destructor);
+
+    if (keytab != NULL) {
+        entry->keytab = talloc_strdup(entry, keytab);
+        if (entry->keytab == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    if (target != NULL) {
+        entry->target = talloc_strdup(entry, target);
+        if (entry->target == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    /* Before the keytab is read, so that a keytab which is changed in the
+     * meantime is read again the next time */
+    entry->acquired = time(NULL);
+    pam_gssapi_creds_stat(entry);
+
+    ret = gssapi_get_creds(keytab, target, &entry->creds);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    DLIST_ADD(pam_ctx->gssapi_creds, entry);
+    *_creds = entry->creds;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(entry);
+    }
+
+    return ret;
+}
+
+/* Drops the credentials after a failed handshake, the keytab might have been
+ * replaced without changing the file metadata */
+static void pam_gssapi_drop_creds(struct pam_ctx *pam_ctx,
+                                  gss_cred_id_t creds)
+{
+    struct pam_gssapi_creds *entry;
+
+    DLIST_FOR_EACH(entry, pam_ctx->gssapi_creds) {
+        if (entry->creds == creds) {
+            DLIST_REMOVE(pam_ctx->gssapi_creds, entry);
+            talloc_free(entry);
+            return;
+        }
+    }
+}
+
 static errno_t
 gssapi_handshake(struct gssapi_state *state,
                  struct cli_protocol *pctx,
+                 struct pam_ctx *pam_ctx,
                  const char *keytab,
                  const char *target,
                  uint8_t *gss_data,
@@ -516,7 +722,7 @@ gssapi_handshake(struct gssapi_state *state,
     input.value = gss_data;
     input.length = gss_data_len;
 
-    ret = gssapi_get_creds(keytab, target, &creds);
+    ret = pam_gssapi_get_creds(pam_ctx, keytab, target, &creds);
     if (ret != EOK) {
         return ret;
     }
@@ -536,6 +742,7 @@ gssapi_handshake(struct gssapi_state *state,
               "[maj:0x%x, min:0x%x]\n", major, minor);
 
         gssapi_log_error(major, minor);
+        pam_gssapi_drop_creds(pam_ctx, creds);
         ret = EIO;
         goto done;
     }
@@ -572,7 +779,6 @@ gssapi_handshake(struct gssapi_state *state,
     ret = EOK;
 
 done:
-    gss_release_cred(&minor, &creds);
     gss_release_buffer(&minor, &output);
 
     return ret;
@@ -693,8 +899,8 @@ pam_cmd_gssapi_sec_ctx(struct cli_ctx *cli_ctx)
         goto done;
     }
 
-    ret = gssapi_handshake(state, pctx, domain->krb5_keytab, target, gss_data,
-                           gss_data_len);
+    ret = gssapi_handshake(state, pctx, pam_ctx, domain->krb5_keytab, target,
+                           gss_data, gss_data_len);
     if (ret != EOK || !state->established) {
         goto done;
     }
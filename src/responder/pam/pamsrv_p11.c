@@ -20,8 +20,10 @@
 */
 
 #include <time.h>
+#include <fcntl.h>
 
 #include "util/util.h"
+#include "util/probes.h"
 #include "providers/data_provider.h"
 #include "util/child_common.h"
 #include "util/strtonum.h"
@@ -685,6 +687,477 @@ done:
     return ret;
 }
 
+/* Upper limit for the certificate list returned by the p11_child service */
+#define P11_CHILD_SERVICE_MAX_REPLY (1024 * 1024)
+
+/* A p11_child started with --service, which keeps the PKCS#11 modules, the
+ * CA certificates and OCSP results loaded, handles the requests of the
+ * responder one after the other. It is started with the first request and
+ * again after it exited or had to be killed. */
+struct p11_child_service {
+    struct tevent_context *ev;
+    struct tevent_queue *queue;
+    pid_t pid;
+    struct sss_child_ctx_old *child_ctx;
+    int write_to_child_fd;
+    int read_from_child_fd;
+    bool busy;
+};
+
+static void p11_child_service_stop(struct p11_child_service *svc)
+{
+    if (svc->child_ctx != NULL) {
+        child_handler_destroy(svc->child_ctx);
+        svc->child_ctx = NULL;
+    }
+    svc->pid = 0;
+
+    PIPE_FD_CLOSE(svc->write_to_child_fd);
+    PIPE_FD_CLOSE(svc->read_from_child_fd);
+}
+
+static int p11_child_service_destructor(struct p11_child_service *svc)
+{
+    p11_child_service_stop(svc);
+
+    return 0;
+}
+
+static void p11_child_service_exited(int child_status,
+                                     struct tevent_signal *sige,
+                                     void *pvt)
+{
+    struct p11_child_service *svc = talloc_get_type(pvt,
+                                                    struct p11_child_service);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "p11_child service [%d] exited.\n", svc->pid);
+
+    /* The signal handler frees the child context */
+    svc->child_ctx = NULL;
+
+    /* A running request will see EOF and stop the service itself */
+    if (!svc->busy) {
+        p11_child_service_stop(svc);
+    }
+}
+
+errno_t p11_child_service_init(TALLOC_CTX *mem_ctx,
+                               struct tevent_context *ev,
+                               struct p11_child_service **_svc)
+{
+    struct p11_child_service *svc;
+
+    svc = talloc_zero(mem_ctx, struct p11_child_service);
+    if (svc == NULL) {
+        return ENOMEM;
+    }
+
+    svc->ev = ev;
+    svc->write_to_child_fd = -1;
+    svc->read_from_child_fd = -1;
+
+    svc->queue = tevent_queue_create(svc, "p11_child_service");
+    if (svc->queue == NULL) {
+        talloc_free(svc);
+        return ENOMEM;
+    }
+
+    talloc_set_destructor(svc, p11_child_service_destructor);
+
+    *_svc = svc;
+
+    return EOK;
+}
+
+static errno_t p11_child_service_start(struct p11_child_service *svc)
+{
+    int pipefd_to_child[2] = PIPE_INIT;
+    int pipefd_from_child[2] = PIPE_INIT;
+    const char *extra_args[] = { "--service", NULL };
+    pid_t child_pid;
+    errno_t ret;
+
+    if (svc->child_ctx != NULL) {
+        return EOK;
+    }
+
+    /* Clean up after a service which has exited */
+    p11_child_service_stop(svc);
+
+    /* The pipes must not leak into other children of the responder */
+    ret = pipe2(pipefd_from_child, O_CLOEXEC);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "pipe failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+    ret = pipe2(pipefd_to_child, O_CLOEXEC);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "pipe failed [%d][%s].\n", ret, strerror(ret));
+        goto done;
+    }
+
+    ret = sss_child_spawn(svc, pipefd_to_child, pipefd_from_child,
+                          P11_CHILD_PATH, P11_CHILD_LOG_FILE, extra_args, false,
+                          STDIN_FILENO, STDOUT_FILENO, &child_pid);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not start p11 child [%d][%s].\n",
+                                   ret, sss_strerror(ret));
+        goto done;
+    }
+
+    svc->pid = child_pid;
+    PROBE(P11_CHILD_SPAWN, child_pid, 1);
+
+    svc->read_from_child_fd = pipefd_from_child[0];
+    PIPE_FD_CLOSE(pipefd_from_child[1]);
+    sss_fd_nonblocking(svc->read_from_child_fd);
+
+    svc->write_to_child_fd = pipefd_to_child[1];
+    PIPE_FD_CLOSE(pipefd_to_child[0]);
+    sss_fd_nonblocking(svc->write_to_child_fd);
+
+    ret = child_handler_setup(svc->ev, child_pid, p11_child_service_exited,
+                              svc, &svc->child_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Could not set up child handlers [%d]: %s\n",
+              ret, sss_strerror(ret));
+        kill(child_pid, SIGKILL);
+        p11_child_service_stop(svc);
+        return ERR_P11_CHILD;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Started p11_child service [%d].\n", child_pid);
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        PIPE_CLOSE(pipefd_from_child);
+        PIPE_CLOSE(pipefd_to_child);
+    }
+
+    return ret;
+}
+
+struct p11_child_service_state {
+    struct tevent_context *ev;
+    struct p11_child_service *svc;
+    time_t timeout;
+
+    struct tevent_req *queue_req;
+    struct tevent_timer *timeout_handler;
+    struct tevent_fd *fde;
+    bool in_flight;
+
+    uint8_t *frame;
+    size_t frame_len;
+
+    uint32_t hdr[2];
+    size_t hdr_read;
+    uint8_t *buf;
+    size_t buf_read;
+};
+
+static int p11_child_service_state_destructor(
+                                        struct p11_child_service_state *state)
+{
+    /* A request which was cancelled while the service is working on it
+     * leaves an unread reply in the pipe, start from scratch. */
+    if (state->in_flight) {
+        state->svc->busy = false;
+        p11_child_service_stop(state->svc);
+    }
+
+    return 0;
+}
+
+static void p11_child_service_queue_done(struct tevent_req *subreq);
+static void p11_child_service_write_done(struct tevent_req *subreq);
+static void p11_child_service_read(struct tevent_context *ev,
+                                   struct tevent_fd *fde,
+                                   uint16_t flags, void *pvt);
+static void p11_child_service_timeout(struct tevent_context *ev,
+                                      struct tevent_timer *te,
+                                      struct timeval tv, void *pvt);
+
+/* Sends the arguments, in reverse order as used by exec_child_ex(), and the
+ * data which would be written to the stdin of a single p11_child. */
+static struct tevent_req *
+p11_child_service_send(TALLOC_CTX *mem_ctx,
+                       struct tevent_context *ev,
+                       struct p11_child_service *svc,
+                       const char **extra_args, size_t arg_c,
+                       uint8_t *write_buf, size_t write_buf_len,
+                       time_t timeout)
+{
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+    struct p11_child_service_state *state;
+    uint32_t hdr[3];
+    size_t args_len = 0;
+    size_t c;
+    size_t p;
+    size_t l;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct p11_child_service_state);
+    if (req == NULL) {
+        return NULL;
+    }
+    talloc_set_destructor(state, p11_child_service_state_destructor);
+
+    state->ev = ev;
+    state->svc = svc;
+    state->timeout = timeout;
+
+    for (c = 0; c < arg_c; c++) {
+        args_len += strlen(extra_args[c]) + 1;
+    }
+
+    hdr[0] = arg_c;
+    hdr[1] = args_len;
+    hdr[2] = write_buf_len;
+
+    state->frame_len = sizeof(hdr) + args_len + write_buf_len;
+    state->frame = talloc_size(state, state->frame_len);
+    if (state->frame == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    /* The frame might contain the PIN */
+    talloc_set_destructor((void *) state->frame,
+                          sss_erase_talloc_mem_securely);
+
+    p = 0;
+    safealign_memcpy(state->frame, hdr, sizeof(hdr), &p);
+    for (c = arg_c; c > 0; c--) {
+        l = strlen(extra_args[c - 1]) + 1;
+        safealign_memcpy(state->frame + p, extra_args[c - 1], l, &p);
+    }
+    if (write_buf_len != 0) {
+        safealign_memcpy(state->frame + p, write_buf, write_buf_len, &p);
+    }
+
+    subreq = tevent_queue_wait_send(state, ev, svc->queue);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    tevent_req_set_callback(subreq, p11_child_service_queue_done, req);
+    state->queue_req = subreq;
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void p11_child_service_failed(struct tevent_req *req, errno_t ret)
+{
+    struct p11_child_service_state *state =
+                          tevent_req_data(req, struct p11_child_service_state);
+
+    talloc_zfree(state->fde);
+    talloc_zfree(state->timeout_handler);
+    if (state->in_flight) {
+        state->in_flight = false;
+        state->svc->busy = false;
+        p11_child_service_stop(state->svc);
+    }
+    talloc_zfree(state->queue_req);
+
+    tevent_req_error(req, ret);
+}
+
+static void p11_child_service_queue_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct p11_child_service_state *state =
+                          tevent_req_data(req, struct p11_child_service_state);
+    struct timeval tv;
+    errno_t ret;
+
+    /* The queue entry is kept until the request is finished */
+    if (!tevent_queue_wait_recv(subreq)) {
+        p11_child_service_failed(req, ERR_P11_CHILD);
+        return;
+    }
+
+    ret = p11_child_service_start(state->svc);
+    if (ret != EOK) {
+        p11_child_service_failed(req, ERR_P11_CHILD);
+        return;
+    }
+
+    tv = tevent_timeval_current_ofs(state->timeout, 0);
+    state->timeout_handler = tevent_add_timer(state->ev, state, tv,
+                                              p11_child_service_timeout, req);
+    if (state->timeout_handler == NULL) {
+        p11_child_service_failed(req, ENOMEM);
+        return;
+    }
+
+    state->in_flight = true;
+    state->svc->busy = true;
+
+    subreq = write_pipe_send(state, state->ev, state->frame, state->frame_len,
+                             state->svc->write_to_child_fd);
+    if (subreq == NULL) {
+        p11_child_service_failed(req, ENOMEM);
+        return;
+    }
+    tevent_req_set_callback(subreq, p11_child_service_write_done, req);
+}
+
+static void p11_child_service_write_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct p11_child_service_state *state =
+                          tevent_req_data(req, struct p11_child_service_state);
+    errno_t ret;
+
+    ret = write_pipe_recv(subreq);
+    talloc_zfree(subreq);
+    talloc_zfree(state->frame);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Sending request to p11_child service "
+              "failed [%d]: %s.\n", ret, sss_strerror(ret));
+        p11_child_service_failed(req, ERR_P11_CHILD);
+        return;
+    }
+
+    state->fde = tevent_add_fd(state->ev, state,
+                               state->svc->read_from_child_fd, TEVENT_FD_READ,
+                               p11_child_service_read, req);
+    if (state->fde == NULL) {
+        p11_child_service_failed(req, ENOMEM);
+        return;
+    }
+}
+
+static void p11_child_service_read(struct tevent_context *ev,
+                                   struct tevent_fd *fde,
+                                   uint16_t flags, void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    struct p11_child_service_state *state =
+                          tevent_req_data(req, struct p11_child_service_state);
+    uint8_t *dest;
+    size_t len;
+    ssize_t got;
+
+    if (state->hdr_read < sizeof(state->hdr)) {
+        dest = (uint8_t *) state->hdr + state->hdr_read;
+        len = sizeof(state->hdr) - state->hdr_read;
+    } else {
+        dest = state->buf + state->buf_read;
+        len = state->hdr[1] - state->buf_read;
+    }
+
+    errno = 0;
+    got = read(state->svc->read_from_child_fd, dest, len);
+    if (got == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return;
+        }
+        DEBUG(SSSDBG_OP_FAILURE, "read failed [%d][%s].\n",
+                                 errno, strerror(errno));
+        p11_child_service_failed(req, ERR_P11_CHILD);
+        return;
+    } else if (got == 0) {
+        DEBUG(SSSDBG_OP_FAILURE, "p11_child service closed the pipe.\n");
+        p11_child_service_failed(req, ERR_P11_CHILD);
+        return;
+    }
+
+    if (state->hdr_read < sizeof(state->hdr)) {
+        state->hdr_read += got;
+        if (state->hdr_read < sizeof(state->hdr)) {
+            return;
+        }
+
+        if (state->hdr[1] > P11_CHILD_SERVICE_MAX_REPLY) {
+            DEBUG(SSSDBG_OP_FAILURE, "Reply of p11_child service is too "
+                  "large.\n");
+            p11_child_service_failed(req, ERR_P11_CHILD);
+            return;
+        }
+
+        state->buf = talloc_size(state, state->hdr[1] + 1);
+        if (state->buf == NULL) {
+            p11_child_service_failed(req, ENOMEM);
+            return;
+        }
+    } else {
+        state->buf_read += got;
+    }
+
+    if (state->buf_read < state->hdr[1]) {
+        return;
+    }
+
+    talloc_zfree(state->fde);
+    talloc_zfree(state->timeout_handler);
+    state->in_flight = false;
+    state->svc->busy = false;
+    talloc_zfree(state->queue_req);
+
+    if (state->svc->child_ctx == NULL) {
+        /* The service exited right after sending the reply */
+        p11_child_service_stop(state->svc);
+    }
+
+    if (state->hdr[0] != 0) {
+        DEBUG(SSSDBG_OP_FAILURE, "p11_child service request failed [%u].\n",
+                                 state->hdr[0]);
+    }
+
+    tevent_req_done(req);
+}
+
+static void p11_child_service_timeout(struct tevent_context *ev,
+                                      struct tevent_timer *te,
+                                      struct timeval tv, void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    struct p11_child_service_state *state =
+                          tevent_req_data(req, struct p11_child_service_state);
+
+    DEBUG(SSSDBG_CRIT_FAILURE,
+          "Timeout reached for p11_child service, "
+          "consider increasing p11_child_timeout.\n");
+    state->timeout_handler = NULL;
+    p11_child_service_failed(req, ERR_P11_CHILD_TIMEOUT);
+}
+
+/* Like the output of a failed p11_child the output is empty if the service
+ * could not handle the request. */
+static errno_t p11_child_service_recv(struct tevent_req *req,
+                                      TALLOC_CTX *mem_ctx,
+                                      uint8_t **_buf, ssize_t *_buf_len)
+{
+    struct p11_child_service_state *state =
+                          tevent_req_data(req, struct p11_child_service_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_buf_len = (state->hdr[0] == 0) ? state->hdr[1] : 0;
+    *_buf = talloc_steal(mem_ctx, state->buf);
+
+    return EOK;
+}
+
 struct pam_check_cert_state {
     int child_status;
     struct sss_child_ctx_old *child_ctx;
@@ -699,12 +1172,14 @@ struct pam_check_cert_state {
 
 static void p11_child_write_done(struct tevent_req *subreq);
 static void p11_child_done(struct tevent_req *subreq);
+static void p11_child_service_done(struct tevent_req *subreq);
 static void p11_child_timeout(struct tevent_context *ev,
                               struct tevent_timer *te,
                               struct timeval tv, void *pvt);
 
 struct tevent_req *pam_check_cert_send(TALLOC_CTX *mem_ctx,
                                        struct tevent_context *ev,
+                                       struct p11_child_service *p11_service,
                                        const char *ca_db,
                                        time_t timeout,
                                        const char *verify_opts,
@@ -728,6 +1203,7 @@ struct tevent_req *pam_check_cert_send(TALLOC_CTX *mem_ctx,
     const char *token_name = NULL;
     const char *key_id = NULL;
     const char *label = NULL;
+    bool wait_for_card = false;
 
     req = tevent_req_create(mem_ctx, &state, struct pam_check_cert_state);
     if (req == NULL) {
@@ -756,6 +1232,7 @@ struct tevent_req *pam_check_cert_send(TALLOC_CTX *mem_ctx,
 
     if ((pd->cli_flags & PAM_CLI_FLAGS_REQUIRE_CERT_AUTH) && pd->priv == 1) {
         extra_args[arg_c++] = "--wait_for_card";
+        wait_for_card = true;
     }
     extra_args[arg_c++] = ca_db;
     extra_args[arg_c++] = "--ca_db";
@@ -828,6 +1305,34 @@ struct tevent_req *pam_check_cert_send(TALLOC_CTX *mem_ctx,
     state->io->read_from_child_fd = -1;
     talloc_set_destructor((void *) state->io, child_io_destructor);
 
+    /* Waiting for a card would block the service for all other requests */
+    if (p11_service != NULL && !wait_for_card) {
+        if (pd->cmd == SSS_PAM_AUTHENTICATE) {
+            ret = get_p11_child_write_buffer(state, pd, &write_buf,
+                                             &write_buf_len);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_OP_FAILURE,
+                      "get_p11_child_write_buffer failed.\n");
+                goto done;
+            }
+        }
+
+        subreq = p11_child_service_send(state, ev, p11_service, extra_args,
+                                        arg_c, write_buf, write_buf_len,
+                                        timeout);
+        sss_erase_talloc_mem_securely(write_buf);
+        talloc_free(write_buf);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "p11_child_service_send failed.\n");
+            ret = ENOMEM;
+            goto done;
+        }
+        tevent_req_set_callback(subreq, p11_child_service_done, req);
+
+        ret = EOK;
+        goto done;
+    }
+
     ret = pipe(pipefd_from_child);
     if (ret == -1) {
         ret = errno;
@@ -843,81 +1348,76 @@ struct tevent_req *pam_check_cert_send(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    child_pid = fork();
-    if (child_pid == 0) { /* child */
-        exec_child_ex(state, pipefd_to_child, pipefd_from_child,
-                      P11_CHILD_PATH, P11_CHILD_LOG_FILE, extra_args, false,
-                      STDIN_FILENO, STDOUT_FILENO);
+    ret = sss_child_spawn(state, pipefd_to_child, pipefd_from_child,
+                          P11_CHILD_PATH, P11_CHILD_LOG_FILE, extra_args, false,
+                          STDIN_FILENO, STDOUT_FILENO, &child_pid);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not start p11 child [%d][%s].\n",
+                                   ret, sss_strerror(ret));
+        goto done;
+    }
 
-        /* We should never get here */
-        DEBUG(SSSDBG_CRIT_FAILURE, "BUG: Could not exec p11 child\n");
-    } else if (child_pid > 0) { /* parent */
+    PROBE(P11_CHILD_SPAWN, child_pid, 0);
 
-        state->io->read_from_child_fd = pipefd_from_child[0];
-        PIPE_FD_CLOSE(pipefd_from_child[1]);
-        sss_fd_nonblocking(state->io->read_from_child_fd);
+    state->io->read_from_child_fd = pipefd_from_child[0];
+    PIPE_FD_CLOSE(pipefd_from_child[1]);
+    sss_fd_nonblocking(state->io->read_from_child_fd);
+
+    state->io->write_to_child_fd = pipefd_to_child[1];
+    PIPE_FD_CLOSE(pipefd_to_child[0]);
+    sss_fd_nonblocking(state->io->write_to_child_fd);
+
+    /* Set up SIGCHLD handler */
+    ret = child_handler_setup(ev, child_pid, NULL, NULL, &state->child_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Could not set up child handlers [%d]: %s\n",
+            ret, sss_strerror(ret));
+        ret = ERR_P11_CHILD;
+        goto done;
+    }
 
-        state->io->write_to_child_fd = pipefd_to_child[1];
-        PIPE_FD_CLOSE(pipefd_to_child[0]);
-        sss_fd_nonblocking(state->io->write_to_child_fd);
+    /* Set up timeout handler */
+    tv = tevent_timeval_current_ofs(timeout, 0);
+    state->timeout_handler = tevent_add_timer(ev, req, tv,
+                                              p11_child_timeout, req);
+    if(state->timeout_handler == NULL) {
+        ret = ERR_P11_CHILD;
+        goto done;
+    }
 
-        /* Set up SIGCHLD handler */
-        ret = child_handler_setup(ev, child_pid, NULL, NULL, &state->child_ctx);
+    if (pd->cmd == SSS_PAM_AUTHENTICATE) {
+        ret = get_p11_child_write_buffer(state, pd, &write_buf,
+                                         &write_buf_len);
         if (ret != EOK) {
-            DEBUG(SSSDBG_OP_FAILURE, "Could not set up child handlers [%d]: %s\n",
-                ret, sss_strerror(ret));
-            ret = ERR_P11_CHILD;
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "get_p11_child_write_buffer failed.\n");
             goto done;
         }
+    }
 
-        /* Set up timeout handler */
-        tv = tevent_timeval_current_ofs(timeout, 0);
-        state->timeout_handler = tevent_add_timer(ev, req, tv,
-                                                  p11_child_timeout, req);
-        if(state->timeout_handler == NULL) {
+    if (write_buf_len != 0) {
+        subreq = write_pipe_send(state, ev, write_buf, write_buf_len,
+                                 state->io->write_to_child_fd);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "write_pipe_send failed.\n");
             ret = ERR_P11_CHILD;
             goto done;
         }
-
-        if (pd->cmd == SSS_PAM_AUTHENTICATE) {
-            ret = get_p11_child_write_buffer(state, pd, &write_buf,
-                                             &write_buf_len);
-            if (ret != EOK) {
-                DEBUG(SSSDBG_OP_FAILURE,
-                      "get_p11_child_write_buffer failed.\n");
-                goto done;
-            }
-        }
-
-        if (write_buf_len != 0) {
-            subreq = write_pipe_send(state, ev, write_buf, write_buf_len,
-                                     state->io->write_to_child_fd);
-            if (subreq == NULL) {
-                DEBUG(SSSDBG_OP_FAILURE, "write_pipe_send failed.\n");
-                ret = ERR_P11_CHILD;
-                goto done;
-            }
-            tevent_req_set_callback(subreq, p11_child_write_done, req);
-        } else {
-            subreq = read_pipe_send(state, ev, state->io->read_from_child_fd);
-            if (subreq == NULL) {
-                DEBUG(SSSDBG_OP_FAILURE, "read_pipe_send failed.\n");
-                ret = ERR_P11_CHILD;
-                goto done;
-            }
-            tevent_req_set_callback(subreq, p11_child_done, req);
+        tevent_req_set_callback(subreq, p11_child_write_done, req);
+    } else {
+        subreq = read_pipe_send(state, ev, state->io->read_from_child_fd);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "read_pipe_send failed.\n");
+            ret = ERR_P11_CHILD;
+            goto done;
         }
-
-        /* Now either wait for the timeout to fire or the child
-         * to finish
-         */
-    } else { /* error */
-        ret = errno;
-        DEBUG(SSSDBG_CRIT_FAILURE, "fork failed [%d][%s].\n",
-                                   ret, sss_strerror(ret));
-        goto done;
+        tevent_req_set_callback(subreq, p11_child_done, req);
     }
 
+    /* Now either wait for the timeout to fire or the child
+     * to finish
+     */
+
     ret = EOK;
 
 done:
@@ -988,6 +1488,34 @@ static void p11_child_done(struct tevent_req *subreq)
     return;
 }
 
+static void p11_child_service_done(struct tevent_req *subreq)
+{
+    uint8_t *buf;
+    ssize_t buf_len;
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct pam_check_cert_state *state = tevent_req_data(req,
+                                                   struct pam_check_cert_state);
+    int ret;
+
+    ret = p11_child_service_recv(subreq, state, &buf, &buf_len);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = parse_p11_child_response(state, buf, buf_len, state->sss_certmap_ctx,
+                                   &state->cert_list);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "parse_p11_child_response failed.\n");
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+}
+
 static void p11_child_timeout(struct tevent_context *ev,
                               struct tevent_timer *te,
                               struct timeval tv, void *pvt)
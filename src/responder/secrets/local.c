@@ -28,12 +28,63 @@
 #include "responder/secrets/secsrv_private.h"
 #include "util/crypto/sss_crypto.h"
 #include "util/secrets/secrets.h"
+#include "util/strtonum.h"
 
 struct local_secret_state {
     struct tevent_context *ev;
     struct sec_req_ctx *secreq;
 };
 
+/* Besides type=simple, which all secrets are, the query of a list may
+ * contain limit=<n> to return at most n keys and after=<key> to return the
+ * keys following key, the last one of the previous page. */
+static int local_parse_query(TALLOC_CTX *mem_ctx,
+                             const char *query,
+                             const char **_after,
+                             size_t *_limit)
+{
+    char **params;
+    char *endptr;
+    int num_params;
+    int ret;
+
+    *_after = NULL;
+    *_limit = 0;
+
+    if (query == NULL) {
+        return EOK;
+    }
+
+    ret = split_on_separator(mem_ctx, query, '&', false, false,
+                             &params, &num_params);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (int i = 0; i < num_params; i++) {
+        if (strcmp(params[i], "type=simple") == 0) {
+            continue;
+        } else if (strncmp(params[i], "after=", 6) == 0
+                       && params[i][6] != '\0') {
+            *_after = params[i] + 6;
+        } else if (strncmp(params[i], "limit=", 6) == 0) {
+            errno = 0;
+            *_limit = strtouint32(params[i] + 6, &endptr, 10);
+            if (errno != 0 || *endptr != '\0' || params[i][6] == '\0') {
+                goto fail;
+            }
+        } else {
+            goto fail;
+        }
+    }
+
+    return EOK;
+
+fail:
+    DEBUG(SSSDBG_CRIT_FAILURE, "Invalid URI query: [%s]\n", query);
+    return EINVAL;
+}
+
 static struct tevent_req *local_secret_req(TALLOC_CTX *mem_ctx,
                                            struct tevent_context *ev,
                                            void *provider_ctx,
@@ -46,9 +97,11 @@ static struct tevent_req *local_secret_req(TALLOC_CTX *mem_ctx,
     const char *content_type;
     bool body_is_json;
     struct sss_sec_req *ssec_req;
+    const char *after;
     char *secret;
     char **keys;
     size_t nkeys;
+    size_t limit;
     int ret;
 
     req = tevent_req_create(mem_ctx, &state, struct local_secret_state);
@@ -97,16 +150,9 @@ static struct tevent_req *local_secret_req(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    /* only type simple for now */
-    if (secreq->parsed_url.query != NULL) {
-        ret = strcmp(secreq->parsed_url.query, "type=simple");
-        if (ret != 0) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Invalid URI query: [%s]\n",
-                  secreq->parsed_url.query);
-            ret = EINVAL;
-            goto done;
-        }
+    ret = local_parse_query(state, secreq->parsed_url.query, &after, &limit);
+    if (ret != EOK) {
+        goto done;
     }
 
     ret = sss_sec_new_req(state,
@@ -124,7 +170,8 @@ static struct tevent_req *local_secret_req(TALLOC_CTX *mem_ctx,
     case HTTP_GET:
         DEBUG(SSSDBG_TRACE_LIBS, "Processing HTTP GET\n"); /* todo: make sure the library prints the path */
         if (sss_sec_req_is_list(ssec_req)) {
-            ret = sss_sec_list(state, ssec_req, &keys, &nkeys);
+            ret = sss_sec_list_page(state, ssec_req, after, limit,
+                                    &keys, &nkeys);
             if (ret) goto done;
 
             ret = sec_array_to_json(state, keys, nkeys, &body.data);
@@ -27,6 +27,10 @@
 #include "util/tev_curl.h"
 
 #define SEC_PROXY_TIMEOUT 5
+/* Requests above these limits wait for a connection in the pool, HTTP/2
+ * connections carry any number of concurrent requests */
+#define SEC_PROXY_MAX_HOST_CONNECTIONS 4
+#define SEC_PROXY_MAX_CONNECTIONS 16
 
 struct proxy_context {
     struct confdb_ctx *cdb;
@@ -460,6 +464,7 @@ done:
 
 struct proxy_secret_state {
     struct tevent_context *ev;
+    struct proxy_context *pctx;
     struct sec_req_ctx *secreq;
     struct proxy_cfg *pcfg;
 };
@@ -488,6 +493,7 @@ struct tevent_req *proxy_secret_req(TALLOC_CTX *mem_ctx,
         ret = EIO;
         goto done;
     }
+    state->pctx = pctx;
 
     ret = proxy_sec_get_cfg(pctx, state, state->secreq, &state->pcfg);
     if (ret) {
@@ -541,6 +547,7 @@ static void proxy_secret_req_done(struct tevent_req *subreq)
     struct tevent_req *req;
     struct proxy_secret_state *state;
     struct sss_iobuf *response;
+    struct tcurl_stats stats;
     int http_code;
     int ret;
 
@@ -550,6 +557,15 @@ static void proxy_secret_req_done(struct tevent_req *subreq)
     ret = tcurl_request_recv(state, subreq, &response, &http_code);
     talloc_zfree(subreq);
 
+    tcurl_get_stats(state->pctx->tcurl, &stats);
+    if (stats.requests > 0) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Proxied %"PRIu64" requests (%"PRIu64" failed) over %"PRIu64" "
+              "connections, average latency %"PRIu64" usecs, maximum "
+              "%"PRIu64" usecs\n", stats.requests, stats.failures,
+              stats.connects, stats.usecs / stats.requests, stats.max_usecs);
+    }
+
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "proxy_http request failed [%d]: %s\n",
               ret, sss_strerror(ret));
@@ -574,6 +590,7 @@ int proxy_secrets_provider_handle(struct sec_ctx *sctx,
 {
     struct provider_handle *handle;
     struct proxy_context *pctx;
+    errno_t ret;
 
     handle = talloc_zero(sctx, struct provider_handle);
     if (!handle) return ENOMEM;
@@ -591,6 +608,18 @@ int proxy_secrets_provider_handle(struct sec_ctx *sctx,
         return ENOMEM;
     }
 
+    /* The connections stay open in the pool of the tcurl context, the
+     * limits keep a burst of requests from opening one for each */
+    ret = tcurl_set_max_connections(pctx->tcurl,
+                                    SEC_PROXY_MAX_HOST_CONNECTIONS,
+                                    SEC_PROXY_MAX_CONNECTIONS);
+    if (ret != EOK) {
+        /* not fatal, the connections are still reused */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot limit the proxy connections [%d]: %s\n",
+              ret, sss_strerror(ret));
+    }
+
     handle->context = pctx;
 
     *out_handle = handle;
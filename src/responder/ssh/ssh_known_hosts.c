@@ -20,9 +20,11 @@
 
 #include "config.h"
 
+#include <sys/stat.h>
 #include <talloc.h>
 
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
 #include "util/crypto/sss_crypto.h"
 #include "util/sss_ssh.h"
 #include "db/sysdb.h"
@@ -166,21 +168,96 @@ done:
     return result;
 }
 
+/* The formatted lines of one host. The hashed lines use a random salt, so
+ * they are kept as long as the plain lines, which depend only on the names
+ * and the keys of the host, do not change. */
+struct ssh_known_host {
+    char *plain;
+    char *lines;
+};
+
 static errno_t
-ssh_write_known_hosts(struct sss_domain_info *domains,
-                      bool hash_known_hosts,
+ssh_format_known_host(struct ssh_ctx *ssh_ctx,
+                      hash_table_t *old_hosts,
+                      hash_table_t *new_hosts,
+                      struct sss_domain_info *dom,
+                      struct sss_ssh_ent *ent,
+                      const char **_lines)
+{
+    struct ssh_known_host *cached = NULL;
+    struct ssh_known_host *host;
+    char *key;
+    errno_t ret;
+
+    key = talloc_asprintf(ent, "%s:%s", dom->name, ent->name);
+    if (key == NULL) {
+        return ENOMEM;
+    }
+
+    host = talloc_zero(new_hosts, struct ssh_known_host);
+    if (host == NULL) {
+        return ENOMEM;
+    }
+
+    host->plain = ssh_host_pubkeys_format_known_host_plain(host, ent);
+    if (host->plain == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (!ssh_ctx->hash_known_hosts) {
+        host->lines = host->plain;
+    } else {
+        if (old_hosts != NULL) {
+            cached = sss_ptr_hash_lookup(old_hosts, key,
+                                         struct ssh_known_host);
+        }
+
+        if (cached != NULL && strcmp(cached->plain, host->plain) == 0) {
+            host->lines = talloc_strdup(host, cached->lines);
+        } else {
+            host->lines = ssh_host_pubkeys_format_known_host_hashed(host, ent);
+        }
+        if (host->lines == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    ret = sss_ptr_hash_add_or_override(new_hosts, key, host,
+                                       struct ssh_known_host);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_lines = host->lines;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(host);
+    }
+    talloc_free(key);
+    return ret;
+}
+
+static errno_t
+ssh_build_known_hosts(TALLOC_CTX *mem_ctx,
+                      struct ssh_ctx *ssh_ctx,
                       time_t now,
-                      int fd)
+                      hash_table_t **_hosts,
+                      char **_image)
 {
     TALLOC_CTX *tmp_ctx;
     struct sss_domain_info *dom;
     struct ldb_message **hosts;
     struct sysdb_ctx *sysdb;
     struct sss_ssh_ent *ent;
-    char *entstr;
+    hash_table_t *new_hosts;
+    const char *lines;
+    char *image;
     size_t num_hosts;
     size_t i;
-    ssize_t wret;
     errno_t ret;
 
     static const char *attrs[] = {
@@ -196,7 +273,16 @@ ssh_write_known_hosts(struct sss_domain_info *domains,
         return ENOMEM;
     }
 
-    for (dom = domains; dom != NULL; dom = get_next_domain(dom, false)) {
+    new_hosts = sss_ptr_hash_create(tmp_ctx, NULL, NULL);
+    image = talloc_strdup(tmp_ctx, "");
+    if (new_hosts == NULL || image == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (dom = ssh_ctx->rctx->domains;
+         dom != NULL;
+         dom = get_next_domain(dom, false)) {
         sysdb = dom->sysdb;
         if (sysdb == NULL) {
             DEBUG(SSSDBG_FATAL_FAILURE,
@@ -223,21 +309,18 @@ ssh_write_known_hosts(struct sss_domain_info *domains,
                 continue;
             }
 
-            if (hash_known_hosts) {
-                entstr = ssh_host_pubkeys_format_known_host_hashed(ent, ent);
-            } else {
-                entstr = ssh_host_pubkeys_format_known_host_plain(ent, ent);
-            }
-
-            if (entstr == NULL) {
+            ret = ssh_format_known_host(ssh_ctx, ssh_ctx->known_hosts,
+                                        new_hosts, dom, ent, &lines);
+            if (ret != EOK) {
                 DEBUG(SSSDBG_OP_FAILURE, "Failed to format known_hosts data "
                       "for [%s]\n", ent->name);
+                talloc_free(ent);
                 continue;
             }
 
-            wret = sss_atomic_write_s(fd, entstr, strlen(entstr));
-            if (wret == -1) {
-                ret = errno;
+            image = talloc_strdup_append_buffer(image, lines);
+            if (image == NULL) {
+                ret = ENOMEM;
                 goto done;
             }
 
@@ -247,6 +330,8 @@ ssh_write_known_hosts(struct sss_domain_info *domains,
         talloc_free(hosts);
     }
 
+    *_hosts = talloc_steal(mem_ctx, new_hosts);
+    *_image = talloc_steal(mem_ctx, image);
     ret = EOK;
 
 done:
@@ -255,17 +340,13 @@ done:
     return ret;
 }
 
-errno_t
-ssh_update_known_hosts_file(struct sss_domain_info *domains,
-                            struct sss_domain_info *domain,
-                            const char *name,
-                            bool hash_known_hosts,
-                            int known_hosts_timeout)
+static errno_t
+ssh_write_known_hosts_file(const char *image)
 {
     TALLOC_CTX *tmp_ctx;
     char *filename;
+    ssize_t wret;
     errno_t ret;
-    time_t now;
     int fd = -1;
 
     tmp_ctx = talloc_new(NULL);
@@ -274,17 +355,6 @@ ssh_update_known_hosts_file(struct sss_domain_info *domains,
         return ENOMEM;
     }
 
-    now = time(NULL);
-
-    /* Update host's expiration time. */
-    if (domain != NULL) {
-        ret = sysdb_update_ssh_known_host_expire(domain, name, now,
-                                                 known_hosts_timeout);
-        if (ret != EOK && ret != ENOENT) {
-            goto done;
-        }
-    }
-
     /* Create temporary known hosts file. */
     filename = talloc_strdup(tmp_ctx, SSS_SSH_KNOWN_HOSTS_TEMP_TMPL);
     if (filename == NULL) {
@@ -299,14 +369,14 @@ ssh_update_known_hosts_file(struct sss_domain_info *domains,
     }
 
     /* Write contents. */
-    ret = ssh_write_known_hosts(domains, hash_known_hosts, now, fd);
-    if (ret != EOK) {
+    wret = sss_atomic_write_s(fd, discard_const(image), strlen(image));
+    if (wret == -1) {
+        ret = errno;
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to write known hosts file "
               "[%d]: %s\n", ret, sss_strerror(ret));
         goto done;
     }
 
-
     /* Rename to SSH known hosts file. */
     ret = fchmod(fd, 0644);
     if (ret == -1) {
@@ -331,3 +401,60 @@ done:
 
     return ret;
 }
+
+errno_t
+ssh_update_known_hosts_file(struct ssh_ctx *ssh_ctx,
+                            struct sss_domain_info *domain,
+                            const char *name)
+{
+    hash_table_t *hosts = NULL;
+    char *image = NULL;
+    struct stat st;
+    errno_t ret;
+    time_t now;
+
+    now = time(NULL);
+
+    /* Update host's expiration time. */
+    if (domain != NULL) {
+        ret = sysdb_update_ssh_known_host_expire(domain, name, now,
+                                                 ssh_ctx->known_hosts_timeout);
+        if (ret != EOK && ret != ENOENT) {
+            return ret;
+        }
+    }
+
+    ret = ssh_build_known_hosts(ssh_ctx, ssh_ctx, now, &hosts, &image);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to build known hosts data "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        return ret;
+    }
+
+    /* Most lookups do not change anything, do not rewrite the file then. */
+    if (ssh_ctx->known_hosts_image != NULL
+            && strcmp(ssh_ctx->known_hosts_image, image) == 0
+            && stat(SSS_SSH_KNOWN_HOSTS_PATH, &st) == 0) {
+        DEBUG(SSSDBG_TRACE_ALL, "Known hosts file is up to date\n");
+        ret = EOK;
+        goto done;
+    }
+
+    ret = ssh_write_known_hosts_file(image);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    talloc_free(ssh_ctx->known_hosts_image);
+    ssh_ctx->known_hosts_image = talloc_steal(ssh_ctx, image);
+    image = NULL;
+    ret = EOK;
+
+done:
+    /* the lines of the old table are not needed any more */
+    talloc_free(ssh_ctx->known_hosts);
+    ssh_ctx->known_hosts = hosts;
+    talloc_free(image);
+
+    return ret;
+}
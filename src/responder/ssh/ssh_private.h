@@ -33,9 +33,17 @@ struct ssh_ctx {
 
     bool hash_known_hosts;
     int known_hosts_timeout;
+    /* formatted lines of each host and the content of the file written
+     * last, see ssh_update_known_hosts_file() */
+    hash_table_t *known_hosts;
+    char *known_hosts_image;
     char *ca_db;
     bool use_cert_keys;
 
+    /* keys derived from certificates, see ssh_get_output_keys_send() */
+    int cert_keys_cache_timeout;
+    hash_table_t *cert_keys;
+
     time_t certmap_last_read;
     struct sss_certmap_ctx *sss_certmap_ctx;
     char **cert_rules;
@@ -79,12 +87,11 @@ ssh_protocol_build_reply(struct sss_packet *packet,
                          struct ldb_message_element **elements,
                          uint32_t num_keys);
 
+/* Rewrites the known hosts file only if its content changed. */
 errno_t
-ssh_update_known_hosts_file(struct sss_domain_info *domains,
+ssh_update_known_hosts_file(struct ssh_ctx *ssh_ctx,
                             struct sss_domain_info *domain,
-                            const char *name,
-                            bool hash_known_hosts,
-                            int known_hosts_timeout);
+                            const char *name);
 
 struct tevent_req *cert_to_ssh_key_send(TALLOC_CTX *mem_ctx,
                                         struct tevent_context *ev,
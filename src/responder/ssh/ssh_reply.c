@@ -25,6 +25,7 @@
 
 #include "db/sysdb.h"
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
 #include "util/crypto/sss_crypto.h"
 #include "util/sss_ssh.h"
 #include "util/cert.h"
@@ -123,7 +124,153 @@ struct ssh_get_output_keys_state {
     size_t iter;
 };
 
+/* The key derived from one certificate, empty if none could be derived */
+struct ssh_cert_key {
+    struct ldb_val key;
+    time_t expire;
+};
+
+static char *ssh_cert_key_name(TALLOC_CTX *mem_ctx, struct ldb_val *cert)
+{
+    return sss_base64_encode(mem_ctx, cert->data, cert->length);
+}
+
+/* Returns ENOENT unless the keys of all 'certs' are cached. */
+static errno_t ssh_cert_keys_lookup(TALLOC_CTX *mem_ctx,
+                                    struct ssh_ctx *ssh_ctx,
+                                    struct ldb_message_element *certs,
+                                    struct ldb_val **_keys,
+                                    size_t *_valid_keys)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ssh_cert_key *cached;
+    struct ldb_val *keys;
+    size_t valid_keys = 0;
+    time_t now;
+    char *name;
+    errno_t ret;
+    size_t i;
+
+    if (ssh_ctx->cert_keys == NULL) {
+        return ENOENT;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    keys = talloc_zero_array(tmp_ctx, struct ldb_val, certs->num_values);
+    if (keys == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    now = time(NULL);
+    for (i = 0; i < certs->num_values; i++) {
+        name = ssh_cert_key_name(tmp_ctx, &certs->values[i]);
+        if (name == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        cached = sss_ptr_hash_lookup(ssh_ctx->cert_keys, name,
+                                     struct ssh_cert_key);
+        if (cached == NULL) {
+            ret = ENOENT;
+            goto done;
+        }
+
+        if (cached->expire <= now) {
+            /* removes it from the table as well */
+            talloc_free(cached);
+            ret = ENOENT;
+            goto done;
+        }
+
+        if (cached->key.length == 0) {
+            continue;
+        }
+
+        keys[i].data = talloc_memdup(keys, cached->key.data,
+                                     cached->key.length);
+        if (keys[i].data == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        keys[i].length = cached->key.length;
+        valid_keys++;
+    }
+
+    *_keys = talloc_steal(mem_ctx, keys);
+    *_valid_keys = valid_keys;
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static void ssh_cert_keys_store(struct ssh_ctx *ssh_ctx,
+                                struct ldb_message_element *certs,
+                                struct ldb_val *keys)
+{
+    struct ssh_cert_key *entry;
+    time_t expire;
+    char *name;
+    errno_t ret;
+    size_t i;
+
+    if (ssh_ctx->cert_keys_cache_timeout <= 0) {
+        return;
+    }
+
+    if (ssh_ctx->cert_keys == NULL) {
+        ssh_ctx->cert_keys = sss_ptr_hash_create(ssh_ctx, NULL, NULL);
+        if (ssh_ctx->cert_keys == NULL) {
+            return;
+        }
+    }
+
+    expire = time(NULL) + ssh_ctx->cert_keys_cache_timeout;
+    for (i = 0; i < certs->num_values; i++) {
+        entry = talloc_zero(ssh_ctx->cert_keys, struct ssh_cert_key);
+        if (entry == NULL) {
+            return;
+        }
+        entry->expire = expire;
+
+        if (keys[i].length != 0) {
+            entry->key.data = talloc_memdup(entry, keys[i].data,
+                                            keys[i].length);
+            if (entry->key.data == NULL) {
+                talloc_free(entry);
+                return;
+            }
+            entry->key.length = keys[i].length;
+        }
+
+        name = ssh_cert_key_name(entry, &certs->values[i]);
+        if (name == NULL) {
+            talloc_free(entry);
+            return;
+        }
+
+        ret = sss_ptr_hash_add_or_override(ssh_ctx->cert_keys, name, entry,
+                                           struct ssh_cert_key);
+        talloc_free(name);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Unable to cache ssh key of certificate [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            talloc_free(entry);
+            return;
+        }
+    }
+}
+
 void ssh_get_output_keys_done(struct tevent_req *subreq);
+static errno_t ssh_get_output_keys_convert(struct tevent_req *req);
 
 struct tevent_req *ssh_get_output_keys_send(TALLOC_CTX *mem_ctx,
                                             struct tevent_context *ev,
@@ -132,7 +279,6 @@ struct tevent_req *ssh_get_output_keys_send(TALLOC_CTX *mem_ctx,
                                             struct ldb_message *msg)
 {
     struct tevent_req *req;
-    struct tevent_req *subreq;
     errno_t ret;
     struct ssh_get_output_keys_state *state;
 
@@ -248,22 +394,7 @@ struct tevent_req *ssh_get_output_keys_send(TALLOC_CTX *mem_ctx,
     state->current_cert = state->user_cert != NULL ? state->user_cert
                                                    : state->user_cert_override;
 
-    subreq = cert_to_ssh_key_send(state, state->ev,
-                                  P11_CHILD_LOG_FILE,
-                                  state->p11_child_timeout,
-                                  state->ssh_ctx->ca_db,
-                                  state->ssh_ctx->sss_certmap_ctx,
-                                  state->current_cert->num_values,
-                                  state->current_cert->values,
-                                  state->cert_verification_opts);
-    if (subreq == NULL) {
-        DEBUG(SSSDBG_OP_FAILURE, "cert_to_ssh_key_send failed.\n");
-        ret = ENOMEM;
-        goto done;
-    }
-    tevent_req_set_callback(subreq, ssh_get_output_keys_done, req);
-
-    ret = EAGAIN;
+    ret = ssh_get_output_keys_convert(req);
 
 done:
     if (ret != EAGAIN) {
@@ -278,39 +409,15 @@ done:
     return req;
 }
 
-void ssh_get_output_keys_done(struct tevent_req *subreq)
+static errno_t ssh_get_output_keys_add(struct ssh_get_output_keys_state *state,
+                                       struct ldb_val *keys,
+                                       size_t valid_keys)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
-    struct ssh_get_output_keys_state *state = tevent_req_data(req,
-                                              struct ssh_get_output_keys_state);
-    int ret;
-    struct ldb_val *keys;
-    size_t valid_keys;
-
-    ret = cert_to_ssh_key_recv(subreq, state, &keys, &valid_keys);
-    talloc_zfree(subreq);
-    if (ret != EOK) {
-        if (ret == ERR_P11_CHILD_TIMEOUT) {
-            DEBUG(SSSDBG_MINOR_FAILURE,
-                  "cert_to_ssh_key request timeout, "
-                  "consider increasing p11_child_timeout.\n");
-        } else {
-            DEBUG(SSSDBG_MINOR_FAILURE,
-                  "cert_to_ssh_key request failed, ssh keys derived "
-                  "from certificates will be skipped.\n");
-        }
-        /* Ignore ssh keys from certificates and return what we already have */
-        tevent_req_done(req);
-        return;
-    }
-
     state->elements[state->iter] = talloc_zero(state->elements,
                                                 struct ldb_message_element);
     if (state->elements[state->iter] == NULL) {
         DEBUG(SSSDBG_OP_FAILURE, "talloc_zero failed.\n");
-        ret = ENOMEM;
-        goto done;
+        return ENOMEM;
     }
     state->elements[state->iter]->values = talloc_steal(
                                                    state->elements[state->iter],
@@ -318,6 +425,7 @@ void ssh_get_output_keys_done(struct tevent_req *subreq)
     state->elements[state->iter]->num_values = state->current_cert->num_values;
     state->elements[state->iter]->flags |= SSS_EL_FLAG_BIN_DATA;
     state->num_keys += valid_keys;
+    state->iter++;
 
     if (state->current_cert == state->user_cert) {
         state->current_cert = state->user_cert_override;
@@ -325,17 +433,46 @@ void ssh_get_output_keys_done(struct tevent_req *subreq)
         state->current_cert = NULL;
     } else {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unexpected certificate pointer.\n");
-        tevent_req_error(req, EINVAL);
-        return;
+        return EINVAL;
+    }
+
+    return EOK;
+}
+
+/* Converts the remaining certificates, returns EAGAIN if p11_child has to
+ * validate some of them. */
+static errno_t ssh_get_output_keys_convert(struct tevent_req *req)
+{
+    struct ssh_get_output_keys_state *state = tevent_req_data(req,
+                                              struct ssh_get_output_keys_state);
+    struct tevent_req *subreq;
+    struct ldb_val *keys;
+    size_t valid_keys;
+    errno_t ret;
+
+    while (state->current_cert != NULL) {
+        ret = ssh_cert_keys_lookup(state, state->ssh_ctx, state->current_cert,
+                                   &keys, &valid_keys);
+        if (ret == ENOENT) {
+            break;
+        } else if (ret != EOK) {
+            return ret;
+        }
+
+        DEBUG(SSSDBG_TRACE_ALL, "Using cached keys of certificates.\n");
+        ret = ssh_get_output_keys_add(state, keys, valid_keys);
+        if (ret != EOK) {
+            return ret;
+        }
     }
 
     if (state->current_cert == NULL) {
-        /* done */
-        ret = EOK;
-        goto done;
+        return EOK;
     }
 
-    subreq = cert_to_ssh_key_send(state, state->ev, NULL,
+    subreq = cert_to_ssh_key_send(state, state->ev,
+                                  state->current_cert == state->user_cert
+                                        ? P11_CHILD_LOG_FILE : NULL,
                                   state->p11_child_timeout,
                                   state->ssh_ctx->ca_db,
                                   state->ssh_ctx->sss_certmap_ctx,
@@ -344,19 +481,54 @@ void ssh_get_output_keys_done(struct tevent_req *subreq)
                                   state->cert_verification_opts);
     if (subreq == NULL) {
         DEBUG(SSSDBG_OP_FAILURE, "cert_to_ssh_key_send failed.\n");
-        ret = ENOMEM;
-        goto done;
+        return ENOMEM;
     }
     tevent_req_set_callback(subreq, ssh_get_output_keys_done, req);
-    return;
-done:
+
+    return EAGAIN;
+}
+
+void ssh_get_output_keys_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req = tevent_req_callback_data(subreq,
+                                                      struct tevent_req);
+    struct ssh_get_output_keys_state *state = tevent_req_data(req,
+                                              struct ssh_get_output_keys_state);
+    int ret;
+    struct ldb_val *keys;
+    size_t valid_keys;
+
+    ret = cert_to_ssh_key_recv(subreq, state, &keys, &valid_keys);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        if (ret == ERR_P11_CHILD_TIMEOUT) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "cert_to_ssh_key request timeout, "
+                  "consider increasing p11_child_timeout.\n");
+        } else {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "cert_to_ssh_key request failed, ssh keys derived "
+                  "from certificates will be skipped.\n");
+        }
+        /* Ignore ssh keys from certificates and return what we already have */
+        tevent_req_done(req);
+        return;
+    }
+
+    ssh_cert_keys_store(state->ssh_ctx, state->current_cert, keys);
+
+    ret = ssh_get_output_keys_add(state, keys, valid_keys);
     if (ret == EOK) {
+        ret = ssh_get_output_keys_convert(req);
+    }
+
+    if (ret == EAGAIN) {
+        return;
+    } else if (ret == EOK) {
         tevent_req_done(req);
     } else {
         tevent_req_error(req, ret);
     }
-
-    return;
 }
 
 errno_t ssh_get_output_keys_recv(struct tevent_req *req, TALLOC_CTX *mem_ctx,
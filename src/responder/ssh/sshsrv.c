@@ -113,6 +113,18 @@ int ssh_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
+    ret = confdb_get_int(ssh_ctx->rctx->cdb, CONFDB_SSH_CONF_ENTRY,
+                         CONFDB_SSH_CERT_KEYS_CACHE_TIMEOUT,
+                         CONFDB_DEFAULT_SSH_CERT_KEYS_CACHE_TIMEOUT,
+                         &ssh_ctx->cert_keys_cache_timeout);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Error reading option "
+                                    CONFDB_SSH_CERT_KEYS_CACHE_TIMEOUT
+                                    " from confdb (%d) [%s]\n",
+                                    ret, sss_strerror(ret));
+        goto fail;
+    }
+
     ret = confdb_get_string_as_list(ssh_ctx->rctx->cdb, ssh_ctx,
                                     CONFDB_SSH_CONF_ENTRY,
                                     CONFDB_SSH_USE_CERT_RULES,
@@ -27,6 +27,60 @@
 #include "providers/data_provider.h"
 #include "responder/common/negcache.h"
 #include "sss_iface/sss_iface_async.h"
+#include "util/sss_ptr_hash.h"
+
+static errno_t
+sudo_clean_rules_cache(TALLOC_CTX *mem_ctx,
+                       struct sbus_request *sbus_req,
+                       struct sudo_ctx *sudo_ctx)
+{
+    sudosrv_rules_cache_flush(sudo_ctx);
+
+    return EOK;
+}
+
+static void
+sudo_rules_cache_delete_cb(hash_entry_t *item,
+                           hash_destroy_enum deltype,
+                           void *pvt)
+{
+    struct sudo_ctx *sudo_ctx;
+    struct sudo_rules_cache_entry *entry;
+
+    sudo_ctx = talloc_get_type(pvt, struct sudo_ctx);
+    entry = talloc_get_type(item->value.ptr, struct sudo_rules_cache_entry);
+
+    /* The entry may still be referenced by a request that is being
+     * answered, make sure its timer does not fire on a new entry. */
+    talloc_zfree(entry->te);
+    talloc_unlink(sudo_ctx->rules_cache, entry);
+}
+
+static errno_t
+sudo_register_service_iface(struct sudo_ctx *sudo_ctx,
+                            struct resp_ctx *rctx)
+{
+    errno_t ret;
+
+    SBUS_INTERFACE(iface_svc,
+        sssd_service,
+        SBUS_METHODS(
+            SBUS_SYNC(METHOD, sssd_service, resInit, monitor_common_res_init, NULL),
+            SBUS_SYNC(METHOD, sssd_service, rotateLogs, responder_logrotate, rctx),
+            SBUS_SYNC(METHOD, sssd_service, clearEnumCache, sudo_clean_rules_cache, sudo_ctx)
+        ),
+        SBUS_SIGNALS(SBUS_NO_SIGNALS),
+        SBUS_PROPERTIES(SBUS_NO_PROPERTIES)
+    );
+
+    ret = sbus_connection_add_path(rctx->mon_conn, SSS_BUS_PATH, &iface_svc);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to register service interface"
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
+    return ret;
+}
 
 int sudo_process_init(TALLOC_CTX *mem_ctx,
                       struct tevent_context *ev,
@@ -102,6 +156,29 @@ int sudo_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
+    /* Get sudo_rules_cache_timeout option */
+    ret = confdb_get_int(sudo_ctx->rctx->cdb,
+                         CONFDB_SUDO_CONF_ENTRY,
+                         CONFDB_SUDO_RULES_CACHE_TIMEOUT,
+                         CONFDB_DEFAULT_SUDO_RULES_CACHE_TIMEOUT,
+                         &sudo_ctx->rules_cache_timeout);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Error reading from confdb (%d) [%s]\n",
+              ret, strerror(ret));
+        goto fail;
+    }
+
+    /* Create the lookup table for the rules of recently seen users */
+    sudo_ctx->rules_cache = sss_ptr_hash_create(sudo_ctx,
+                                                sudo_rules_cache_delete_cb,
+                                                sudo_ctx);
+    if (sudo_ctx->rules_cache == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to initialize sudo rules hash table\n");
+        ret = ENOMEM;
+        goto fail;
+    }
+
     ret = schedule_get_domains_task(rctx, rctx->ev, rctx, NULL);
     if (ret != EOK) {
         DEBUG(SSSDBG_FATAL_FAILURE, "schedule_get_domains_tasks failed.\n");
@@ -119,7 +196,12 @@ int sudo_process_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
-    ret = sss_resp_register_service_iface(rctx);
+    ret = sudo_register_service_iface(sudo_ctx, rctx);
+    if (ret != EOK) {
+        goto fail;
+    }
+
+    ret = sss_resp_register_stats_iface(rctx);
     if (ret != EOK) {
         goto fail;
     }
@@ -128,9 +128,15 @@ errno_t sudosrv_cmd_reply(struct sudo_cmd_ctx *cmd_ctx, int ret)
         }
 
         /* send result */
-        ret = sudosrv_build_response(cmd_ctx, SSS_SUDO_ERROR_OK,
-                                     num_rules, rules,
-                                     &response_body, &response_len);
+        if (cmd_ctx->binary) {
+            ret = sudosrv_build_response_bin(cmd_ctx, SSS_SUDO_ERROR_OK,
+                                             num_rules, rules,
+                                             &response_body, &response_len);
+        } else {
+            ret = sudosrv_build_response(cmd_ctx, SSS_SUDO_ERROR_OK,
+                                         num_rules, rules,
+                                         &response_body, &response_len);
+        }
         if (ret != EOK) {
             return EFAULT;
         }
@@ -169,7 +175,8 @@ errno_t sudosrv_cmd_reply(struct sudo_cmd_ctx *cmd_ctx, int ret)
 
 static void sudosrv_cmd_done(struct tevent_req *req);
 
-static int sudosrv_cmd(enum sss_sudo_type type, struct cli_ctx *cli_ctx)
+static int sudosrv_cmd(enum sss_sudo_type type, bool binary,
+                       struct cli_ctx *cli_ctx)
 {
     struct tevent_req *req = NULL;
     struct sudo_cmd_ctx *cmd_ctx = NULL;
@@ -190,6 +197,7 @@ static int sudosrv_cmd(enum sss_sudo_type type, struct cli_ctx *cli_ctx)
 
     cmd_ctx->cli_ctx = cli_ctx;
     cmd_ctx->type = type;
+    cmd_ctx->binary = binary;
     cmd_ctx->sudo_ctx = talloc_get_type(cli_ctx->rctx->pvt_ctx, struct sudo_ctx);
     if (cmd_ctx->sudo_ctx == NULL) {
         DEBUG(SSSDBG_FATAL_FAILURE, "sudo_ctx not set, killing connection!\n");
@@ -272,12 +280,22 @@ done:
 
 static int sudosrv_cmd_get_sudorules(struct cli_ctx *cli_ctx)
 {
-    return sudosrv_cmd(SSS_SUDO_USER, cli_ctx);
+    return sudosrv_cmd(SSS_SUDO_USER, false, cli_ctx);
 }
 
 static int sudosrv_cmd_get_defaults(struct cli_ctx *cli_ctx)
 {
-    return sudosrv_cmd(SSS_SUDO_DEFAULTS, cli_ctx);
+    return sudosrv_cmd(SSS_SUDO_DEFAULTS, false, cli_ctx);
+}
+
+static int sudosrv_cmd_get_sudorules_bin(struct cli_ctx *cli_ctx)
+{
+    return sudosrv_cmd(SSS_SUDO_USER, true, cli_ctx);
+}
+
+static int sudosrv_cmd_get_defaults_bin(struct cli_ctx *cli_ctx)
+{
+    return sudosrv_cmd(SSS_SUDO_DEFAULTS, true, cli_ctx);
 }
 
 struct cli_protocol_version *register_cli_protocol_version(void)
@@ -295,6 +313,8 @@ struct sss_cmd_table *get_sudo_cmds(void) {
         {SSS_GET_VERSION, sss_cmd_get_version},
         {SSS_SUDO_GET_SUDORULES, sudosrv_cmd_get_sudorules},
         {SSS_SUDO_GET_DEFAULTS, sudosrv_cmd_get_defaults},
+        {SSS_SUDO_GET_SUDORULES_BIN, sudosrv_cmd_get_sudorules_bin},
+        {SSS_SUDO_GET_DEFAULTS_BIN, sudosrv_cmd_get_defaults_bin},
         {SSS_CLI_NULL, NULL}
     };
 
@@ -31,6 +31,7 @@
 #include "responder/common/cache_req/cache_req.h"
 #include "responder/sudo/sudosrv_private.h"
 #include "providers/data_provider.h"
+#include "util/sss_ptr_hash.h"
 
 static int
 sudo_order_cmp(const void *a, const void *b, bool lower_wins)
@@ -265,7 +266,13 @@ static errno_t sudosrv_expired_rules(TALLOC_CTX *mem_ctx,
                                      struct sysdb_attrs ***_rules,
                                      uint32_t *_num_rules)
 {
-    const char *attrs[] = { SYSDB_NAME, NULL };
+    const char *attrs[] = { SYSDB_NAME, SYSDB_CACHE_EXPIRE, NULL };
+    struct sysdb_attrs **rules;
+    uint32_t num_rules;
+    uint32_t count = 0;
+    uint32_t i;
+    uint32_t expire;
+    time_t now;
     char *filter;
     errno_t ret;
 
@@ -275,10 +282,30 @@ static errno_t sudosrv_expired_rules(TALLOC_CTX *mem_ctx,
     }
 
     ret = sudosrv_query_cache(mem_ctx, domain, attrs, filter,
-                              _rules, _num_rules);
+                              &rules, &num_rules);
     talloc_free(filter);
+    if (ret != EOK) {
+        return ret;
+    }
 
-    return ret;
+    /* The filter matches the expiration time in the persistent cache, rules
+     * that did not change are only refreshed in the timestamp cache. */
+    now = time(NULL);
+    for (i = 0; i < num_rules; i++) {
+        ret = sysdb_attrs_get_uint32_t(rules[i], SYSDB_CACHE_EXPIRE, &expire);
+        if (ret == EOK && expire > now) {
+            talloc_free(rules[i]);
+            continue;
+        }
+
+        rules[count] = rules[i];
+        count++;
+    }
+
+    *_rules = rules;
+    *_num_rules = count;
+
+    return EOK;
 }
 
 static errno_t sudosrv_cached_rules_by_user(TALLOC_CTX *mem_ctx,
@@ -563,14 +590,210 @@ static errno_t sudosrv_fetch_rules(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+void sudosrv_rules_cache_flush(struct sudo_ctx *sudo_ctx)
+{
+    DEBUG(SSSDBG_TRACE_FUNC, "Flushing in-memory sudo rules\n");
+
+    /* It will automatically decrease the refcount of the entries through
+     * delete callback. */
+    sss_ptr_hash_delete_all(sudo_ctx->rules_cache, false);
+}
+
+static char *sudosrv_rules_cache_key(TALLOC_CTX *mem_ctx,
+                                     enum sss_sudo_type type,
+                                     struct sss_domain_info *domain,
+                                     uid_t cli_uid,
+                                     const char *username)
+{
+    /* The client uid is part of the key since it is added to the
+     * returned rules as sudoUser: #uid. */
+    return talloc_asprintf(mem_ctx, "%d:%"SPRIuid":%s@%s", type, cli_uid,
+                           username, domain->name);
+}
+
+static bool sudosrv_groups_equal(char **a, char **b)
+{
+    size_t i;
+
+    if (a == NULL || b == NULL) {
+        return (a == NULL || a[0] == NULL) && (b == NULL || b[0] == NULL);
+    }
+
+    for (i = 0; a[i] != NULL && b[i] != NULL; i++) {
+        if (strcmp(a[i], b[i]) != 0) {
+            return false;
+        }
+    }
+
+    return a[i] == NULL && b[i] == NULL;
+}
+
+static void
+sudosrv_rules_cache_timeout(struct tevent_context *ev,
+                            struct tevent_timer *te,
+                            struct timeval current_time,
+                            void *pvt)
+{
+    struct sudo_rules_cache_entry *entry;
+
+    entry = talloc_get_type(pvt, struct sudo_rules_cache_entry);
+    entry->te = NULL;
+
+    /* Remove it from the table. It will automatically decrease the
+     * refcount. */
+    sss_ptr_hash_delete(entry->table, entry->key, false);
+}
+
+/* Returns a shallow copy of the cached rules. The array holds a reference
+ * to the cache entry so the rules remain valid even if the entry is
+ * removed from the table meanwhile. */
+static errno_t sudosrv_rules_cache_get(TALLOC_CTX *mem_ctx,
+                                       struct sudo_ctx *sudo_ctx,
+                                       const char *key,
+                                       char **groups,
+                                       struct sysdb_attrs ***_rules,
+                                       uint32_t *_num_rules)
+{
+    struct sudo_rules_cache_entry *entry;
+    struct sysdb_attrs **rules;
+
+    if (sudo_ctx->rules_cache_timeout <= 0) {
+        return ENOENT;
+    }
+
+    entry = sss_ptr_hash_lookup(sudo_ctx->rules_cache, key,
+                                struct sudo_rules_cache_entry);
+    if (entry == NULL) {
+        return ENOENT;
+    }
+
+    if (!sudosrv_groups_equal(entry->groups, groups)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Group membership changed, dropping "
+              "in-memory rules [%s]\n", key);
+        sss_ptr_hash_delete(sudo_ctx->rules_cache, key, false);
+        return ENOENT;
+    }
+
+    rules = talloc_array(mem_ctx, struct sysdb_attrs *,
+                         entry->num_rules + 1);
+    if (rules == NULL) {
+        return ENOMEM;
+    }
+
+    if (talloc_reference(rules, entry) == NULL) {
+        talloc_free(rules);
+        return ENOMEM;
+    }
+
+    memcpy(rules, entry->rules,
+           entry->num_rules * sizeof(struct sysdb_attrs *));
+    rules[entry->num_rules] = NULL;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Returning %u in-memory rules [%s]\n",
+          entry->num_rules, key);
+
+    *_rules = rules;
+    *_num_rules = entry->num_rules;
+
+    return EOK;
+}
+
+/* Moves the rules into a new cache entry and returns them through the
+ * same shallow copy sudosrv_rules_cache_get() gives. Failing to cache
+ * the rules is not fatal, they are returned as they are then. */
+static void sudosrv_rules_cache_set(TALLOC_CTX *mem_ctx,
+                                    struct sudo_ctx *sudo_ctx,
+                                    const char *key,
+                                    char **groups,
+                                    struct sysdb_attrs ***_rules,
+                                    uint32_t *_num_rules)
+{
+    struct sudo_rules_cache_entry *entry;
+    struct timeval tv;
+    size_t i;
+    errno_t ret;
+
+    if (sudo_ctx->rules_cache_timeout <= 0) {
+        return;
+    }
+
+    entry = talloc_zero(sudo_ctx->rules_cache, struct sudo_rules_cache_entry);
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->table = sudo_ctx->rules_cache;
+    entry->key = talloc_strdup(entry, key);
+    if (entry->key == NULL) {
+        goto fail;
+    }
+
+    for (i = 0; groups != NULL && groups[i] != NULL; i++) {
+        /* count */
+    }
+
+    entry->groups = talloc_zero_array(entry, char *, i + 1);
+    if (entry->groups == NULL) {
+        goto fail;
+    }
+
+    for (i = 0; groups != NULL && groups[i] != NULL; i++) {
+        entry->groups[i] = talloc_strdup(entry->groups, groups[i]);
+        if (entry->groups[i] == NULL) {
+            goto fail;
+        }
+    }
+
+    tv = tevent_timeval_current_ofs(sudo_ctx->rules_cache_timeout, 0);
+    entry->te = tevent_add_timer(sudo_ctx->rctx->ev, entry, tv,
+                                 sudosrv_rules_cache_timeout, entry);
+    if (entry->te == NULL) {
+        goto fail;
+    }
+
+    ret = sss_ptr_hash_add_or_override(sudo_ctx->rules_cache, key, entry,
+                                       struct sudo_rules_cache_entry);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to keep rules in memory "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        goto fail;
+    }
+
+    entry->rules = talloc_steal(entry, *_rules);
+    entry->num_rules = *_num_rules;
+
+    ret = sudosrv_rules_cache_get(mem_ctx, sudo_ctx, key, groups,
+                                  _rules, _num_rules);
+    if (ret == EOK) {
+        return;
+    }
+
+    /* Take the rules back before dropping the entry. */
+    *_rules = talloc_steal(mem_ctx, entry->rules);
+    entry->rules = NULL;
+    entry->num_rules = 0;
+    sss_ptr_hash_delete(sudo_ctx->rules_cache, key, false);
+    return;
+
+fail:
+    talloc_free(entry);
+}
+
 static void
 sudosrv_dp_oob_req_done(struct tevent_req *req)
 {
+    struct sudo_ctx *sudo_ctx;
+
+    sudo_ctx = tevent_req_callback_data(req, struct sudo_ctx);
+
     DEBUG(SSSDBG_TRACE_FUNC, "Out of band refresh finished\n");
     talloc_free(req);
+
+    sudosrv_rules_cache_flush(sudo_ctx);
 }
 
 struct sudosrv_refresh_rules_state {
+    struct sudo_ctx *sudo_ctx;
     struct resp_ctx *rctx;
     struct sss_domain_info *domain;
     const char *username;
@@ -581,9 +804,8 @@ static void sudosrv_refresh_rules_done(struct tevent_req *subreq);
 static struct tevent_req *
 sudosrv_refresh_rules_send(TALLOC_CTX *mem_ctx,
                            struct tevent_context *ev,
-                           struct resp_ctx *rctx,
+                           struct sudo_ctx *sudo_ctx,
                            struct sss_domain_info *domain,
-                           int threshold,
                            uid_t uid,
                            const char *username,
                            char **groups)
@@ -602,7 +824,8 @@ sudosrv_refresh_rules_send(TALLOC_CTX *mem_ctx,
         return NULL;
     }
 
-    state->rctx = rctx;
+    state->sudo_ctx = sudo_ctx;
+    state->rctx = sudo_ctx->rctx;
     state->domain = domain;
     state->username = username;
 
@@ -625,16 +848,16 @@ sudosrv_refresh_rules_send(TALLOC_CTX *mem_ctx,
     DEBUG(SSSDBG_TRACE_INTERNAL, "Refreshing %d expired rules of [%s@%s]\n",
           num_rules, username, domain->name);
 
-    if (num_rules > threshold) {
+    if (num_rules > sudo_ctx->threshold) {
         DEBUG(SSSDBG_TRACE_INTERNAL,
               "Rules threshold [%d] is reached, performing full refresh "
-              "instead.\n", threshold);
+              "instead.\n", sudo_ctx->threshold);
 
-        subreq = sss_dp_get_sudoers_send(state, rctx, domain, false,
+        subreq = sss_dp_get_sudoers_send(state, state->rctx, domain, false,
                                          SSS_DP_SUDO_FULL_REFRESH,
                                          username, 0, NULL);
     } else {
-        subreq = sss_dp_get_sudoers_send(state, rctx, domain, false,
+        subreq = sss_dp_get_sudoers_send(state, state->rctx, domain, false,
                                          SSS_DP_SUDO_REFRESH_RULES,
                                          username, num_rules, rules);
     }
@@ -686,6 +909,9 @@ static void sudosrv_refresh_rules_done(struct tevent_req *subreq)
         goto done;
     }
 
+    /* The cached rules changed, all users may be affected. */
+    sudosrv_rules_cache_flush(state->sudo_ctx);
+
     if (err_min == ENOENT) {
         DEBUG(SSSDBG_TRACE_INTERNAL,
               "Some expired rules were removed from the server, scheduling "
@@ -700,7 +926,8 @@ static void sudosrv_refresh_rules_done(struct tevent_req *subreq)
             goto done;
         }
 
-        tevent_req_set_callback(subreq, sudosrv_dp_oob_req_done, NULL);
+        tevent_req_set_callback(subreq, sudosrv_dp_oob_req_done,
+                                state->sudo_ctx);
     }
 
     ret = EOK;
@@ -723,6 +950,7 @@ static errno_t sudosrv_refresh_rules_recv(struct tevent_req *req)
 
 struct sudosrv_get_rules_state {
     struct tevent_context *ev;
+    struct sudo_ctx *sudo_ctx;
     struct resp_ctx *rctx;
     enum sss_sudo_type type;
     uid_t cli_uid;
@@ -730,7 +958,7 @@ struct sudosrv_get_rules_state {
     struct sss_domain_info *domain;
     char **groups;
     bool inverse_order;
-    int threshold;
+    char *cache_key;
 
     uid_t orig_uid;
     const char *orig_username;
@@ -761,11 +989,11 @@ struct tevent_req *sudosrv_get_rules_send(TALLOC_CTX *mem_ctx,
     }
 
     state->ev = ev;
+    state->sudo_ctx = sudo_ctx;
     state->rctx = sudo_ctx->rctx;
     state->type = type;
     state->cli_uid = cli_uid;
     state->inverse_order = sudo_ctx->inverse_order;
-    state->threshold = sudo_ctx->threshold;
 
     DEBUG(SSSDBG_TRACE_FUNC, "Running initgroups for [%s]\n", username);
 
@@ -823,8 +1051,27 @@ static void sudosrv_get_rules_initgr_done(struct tevent_req *subreq)
         goto done;
     }
 
-    subreq = sudosrv_refresh_rules_send(state, state->ev, state->rctx,
-                                        state->domain, state->threshold,
+    state->cache_key = sudosrv_rules_cache_key(state, state->type,
+                                               state->domain, state->cli_uid,
+                                               state->orig_username);
+    if (state->cache_key == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* Rules of this user were read very recently, neither the expired
+     * rules nor the reply need to be searched for again. */
+    ret = sudosrv_rules_cache_get(state, state->sudo_ctx, state->cache_key,
+                                  state->groups, &state->rules,
+                                  &state->num_rules);
+    if (ret == EOK) {
+        goto done;
+    } else if (ret != ENOENT) {
+        goto done;
+    }
+
+    subreq = sudosrv_refresh_rules_send(state, state->ev, state->sudo_ctx,
+                                        state->domain,
                                         state->orig_uid,
                                         state->orig_username,
                                         state->groups);
@@ -876,6 +1123,9 @@ static void sudosrv_get_rules_done(struct tevent_req *subreq)
         return;
     }
 
+    sudosrv_rules_cache_set(state, state->sudo_ctx, state->cache_key,
+                            state->groups, &state->rules, &state->num_rules);
+
     tevent_req_done(req);
 }
 
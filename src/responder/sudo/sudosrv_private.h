@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <talloc.h>
 #include <sys/types.h>
+#include <dhash.h>
 
 #include "src/db/sysdb.h"
 #include "responder/common/responder.h"
@@ -49,12 +50,29 @@ struct sudo_ctx {
     bool timed;
     bool inverse_order;
     int threshold;
+    int rules_cache_timeout;
+
+    /* sorted and formatted rules of recently seen users */
+    hash_table_t *rules_cache;
+};
+
+struct sudo_rules_cache_entry {
+    hash_table_t *table;
+    char *key;
+    struct tevent_timer *te;
+
+    /* groups of the user at the time the rules were read */
+    char **groups;
+
+    struct sysdb_attrs **rules;
+    uint32_t num_rules;
 };
 
 struct sudo_cmd_ctx {
     struct cli_ctx *cli_ctx;
     struct sudo_ctx *sudo_ctx;
     enum sss_sudo_type type;
+    bool binary;
 
     /* input data */
     uid_t uid;
@@ -67,6 +85,8 @@ struct sudo_cmd_ctx {
 
 struct sss_cmd_table *get_sudo_cmds(void);
 
+void sudosrv_rules_cache_flush(struct sudo_ctx *sudo_ctx);
+
 struct tevent_req *sudosrv_get_rules_send(TALLOC_CTX *mem_ctx,
                                           struct tevent_context *ev,
                                           struct sudo_ctx *sudo_ctx,
@@ -79,6 +99,13 @@ errno_t sudosrv_get_rules_recv(TALLOC_CTX *mem_ctx,
                                struct sysdb_attrs ***_rules,
                                uint32_t *_num_rules);
 
+errno_t sudosrv_build_response_bin(TALLOC_CTX *mem_ctx,
+                                   uint32_t error,
+                                   uint32_t rules_num,
+                                   struct sysdb_attrs **rules,
+                                   uint8_t **_response_body,
+                                   size_t *_response_len);
+
 errno_t sudosrv_parse_query(TALLOC_CTX *mem_ctx,
                             uint8_t *query_body,
                             size_t query_len,
@@ -258,6 +258,230 @@ fail:
     return ret;
 }
 
+struct sudosrv_bin_response {
+    /* string -> offset in strings */
+    hash_table_t *offsets;
+
+    uint8_t *strings;
+    size_t strings_len;
+
+    uint8_t *rules;
+    size_t rules_len;
+};
+
+static errno_t sudosrv_bin_append_string(TALLOC_CTX *mem_ctx,
+                                         struct sudosrv_bin_response *bin,
+                                         const char *str,
+                                         size_t str_len)
+{
+    hash_key_t key;
+    hash_value_t value;
+    size_t offset;
+    errno_t ret;
+    int hret;
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(str);
+
+    hret = hash_lookup(bin->offsets, &key, &value);
+    if (hret == HASH_SUCCESS) {
+        return sudosrv_response_append_uint32(mem_ctx, value.ul,
+                                              &bin->rules, &bin->rules_len);
+    } else if (hret != HASH_ERROR_KEY_NOT_FOUND) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "hash_lookup() failed [%d]: %s\n",
+              hret, hash_error_string(hret));
+        return EIO;
+    }
+
+    offset = bin->strings_len;
+    if (offset + str_len + 1 > UINT32_MAX) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Too many strings in the response\n");
+        return ERANGE;
+    }
+
+    ret = sudosrv_response_append_string(mem_ctx, str, str_len + 1,
+                                         &bin->strings, &bin->strings_len);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    value.type = HASH_VALUE_ULONG;
+    value.ul = offset;
+
+    hret = hash_enter(bin->offsets, &key, &value);
+    if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "hash_enter() failed [%d]: %s\n",
+              hret, hash_error_string(hret));
+        return EIO;
+    }
+
+    return sudosrv_response_append_uint32(mem_ctx, offset,
+                                          &bin->rules, &bin->rules_len);
+}
+
+static errno_t sudosrv_bin_append_rule(TALLOC_CTX *mem_ctx,
+                                       struct sudosrv_bin_response *bin,
+                                       int attrs_num,
+                                       struct ldb_message_element *attrs)
+{
+    const char *strval;
+    unsigned int j;
+    errno_t ret;
+    int i;
+
+    /* attrs count */
+    ret = sudosrv_response_append_uint32(mem_ctx, attrs_num,
+                                         &bin->rules, &bin->rules_len);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (i = 0; i < attrs_num; i++) {
+        /* attr name */
+        ret = sudosrv_bin_append_string(mem_ctx, bin, attrs[i].name,
+                                        strlen(attrs[i].name));
+        if (ret != EOK) {
+            return ret;
+        }
+
+        /* values count */
+        ret = sudosrv_response_append_uint32(mem_ctx, attrs[i].num_values,
+                                             &bin->rules, &bin->rules_len);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        /* values */
+        for (j = 0; j < attrs[i].num_values; j++) {
+            strval = (const char *)attrs[i].values[j].data;
+
+            if (strlen(strval) != attrs[i].values[j].length) {
+                DEBUG(SSSDBG_CRIT_FAILURE, "value is not a string\n");
+                return EINVAL;
+            }
+
+            ret = sudosrv_bin_append_string(mem_ctx, bin, strval,
+                                            attrs[i].values[j].length);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
+    }
+
+    return EOK;
+}
+
+/*
+ * Binary response format:
+ * <error_code(uint32_t)><version(uint32_t)><strings_len(uint32_t)><strings>
+ * <num_entries(uint32_t)><rule1><rule2>...
+ * <ruleN> = <num_attrs(uint32_t)><attr1><attr2>...
+ * <attrN>  = <name(uint32_t)><num_values(uint32_t)><value1(uint32_t)>...
+ *
+ * <strings> is a table of zero terminated strings. Every distinct attribute
+ * name and value is sent only once and referenced by its offset in the
+ * table.
+ *
+ * if <error_code> is not SSS_SUDO_ERROR_OK, the rest of the data is skipped.
+ */
+errno_t sudosrv_build_response_bin(TALLOC_CTX *mem_ctx,
+                                   uint32_t error,
+                                   uint32_t rules_num,
+                                   struct sysdb_attrs **rules,
+                                   uint8_t **_response_body,
+                                   size_t *_response_len)
+{
+    struct sudosrv_bin_response bin = { 0 };
+    uint8_t *response_body = NULL;
+    size_t response_len = 0;
+    TALLOC_CTX *tmp_ctx = NULL;
+    uint32_t i = 0;
+    errno_t ret = EOK;
+
+    if (error != SSS_SUDO_ERROR_OK) {
+        /* the same as the legacy format */
+        return sudosrv_build_response(mem_ctx, error, 0, NULL,
+                                      _response_body, _response_len);
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_new() failed\n");
+        return ENOMEM;
+    }
+
+    ret = sss_hash_create(tmp_ctx, 0, &bin.offsets);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* rules count */
+    ret = sudosrv_response_append_uint32(tmp_ctx, rules_num,
+                                         &bin.rules, &bin.rules_len);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* rules */
+    for (i = 0; i < rules_num; i++) {
+        ret = sudosrv_bin_append_rule(tmp_ctx, &bin, rules[i]->num,
+                                      rules[i]->a);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    /* header */
+    ret = sudosrv_response_append_uint32(tmp_ctx, error,
+                                         &response_body, &response_len);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sudosrv_response_append_uint32(tmp_ctx,
+                                         SSS_SUDO_BIN_RESPONSE_VERSION,
+                                         &response_body, &response_len);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sudosrv_response_append_uint32(tmp_ctx, bin.strings_len,
+                                         &response_body, &response_len);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    /* strings and rules */
+    response_body = talloc_realloc(tmp_ctx, response_body, uint8_t,
+                                   response_len + bin.strings_len
+                                   + bin.rules_len);
+    if (response_body == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (bin.strings_len > 0) {
+        memcpy(response_body + response_len, bin.strings, bin.strings_len);
+        response_len += bin.strings_len;
+    }
+
+    memcpy(response_body + response_len, bin.rules, bin.rules_len);
+    response_len += bin.rules_len;
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "rules_num: [%"PRIu32"], strings: [%zu] "
+          "bytes, total: [%zu] bytes\n", rules_num, bin.strings_len,
+          response_len);
+
+    *_response_body = talloc_steal(mem_ctx, response_body);
+    *_response_len = response_len;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 errno_t sudosrv_parse_query(TALLOC_CTX *mem_ctx,
                             uint8_t *query_body,
                             size_t query_len,
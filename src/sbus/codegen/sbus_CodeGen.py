@@ -42,6 +42,15 @@ class CodeGen:
           - boolean, default is false
           - handler parses its output parameters manually
 
+        * Annotations on method and signal arguments:
+        - codegen.LargeArgument
+          - boolean, default is false
+          - "ay" argument is passed as struct sbus_blob in a sealed memfd
+        - codegen.Borrowed
+          - boolean, default is false
+          - "s" or "o" input argument points into the D-Bus message instead
+            of being copied, it is valid only until the request is finished
+
         * Annotations on interfaces, methods or properties:
         - codegen.Name
           - string, default is not set
@@ -235,8 +244,10 @@ def InitializeDataTypes():
     # String types
     DataType.Create("s", "const char *", "s", DBusType="s", RequireTalloc=True)
     DataType.Create("S", "char *",       "s", DBusType="s", RequireTalloc=True)
+    DataType.Create("R", "const char *", "s", DBusType="s")
     DataType.Create("o", "const char *", "s", DBusType="o", RequireTalloc=True)
     DataType.Create("O", "char *",       "s", DBusType="o", RequireTalloc=True)
+    DataType.Create("P", "const char *", "s", DBusType="o")
 
     # Array types
     DataType.Create("ay", "uint8_t *", RequireTalloc=True)
@@ -262,6 +273,8 @@ def InitializeDataTypes():
                     DBusType="uua(uay)", RequireTalloc=True)
     DataType.Create("ifp_extra", "hash_table_t *",
                     DBusType="a{sas}", RequireTalloc=True)
+    DataType.Create("blob", "struct sbus_blob *",
+                    DBusType="h", RequireTalloc=True)
 
 
 def main():
@@ -260,6 +260,23 @@ class SBus:
             self.direction = self.getAttr("direction", "in")
             self.key = self.getAttr("key", None)
 
+            # Large byte arrays are passed in a sealed memfd
+            if SBus.Annotation.FindBool(self.annotations,
+                                        "codegen.LargeArgument"):
+                if self.signature != "ay":
+                    raise ValueError('codegen.LargeArgument is supported '
+                                     'only on "ay" arguments: %s' % self.name)
+                self.signature = "blob"
+
+            # Strings that are only read during the request are not copied
+            if SBus.Annotation.FindBool(self.annotations, "codegen.Borrowed"):
+                borrowed = {"s": "R", "o": "P"}
+                if self.signature not in borrowed or not self.isInput():
+                    raise ValueError('codegen.Borrowed is supported only on '
+                                     '"s" and "o" input arguments: %s'
+                                     % self.name)
+                self.signature = borrowed[self.signature]
+
         def isInput(self):
             return self.direction == "in"
 
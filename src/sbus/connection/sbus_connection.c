@@ -399,6 +399,18 @@ void *_sbus_connection_get_data(struct sbus_connection *conn)
     return conn->data;
 }
 
+void sbus_connection_get_dispatch_stats(struct sbus_connection *conn,
+                                        struct sbus_dispatch_stats *_stats)
+{
+    if (conn == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Bug: connection is NULL\n");
+        memset(_stats, 0, sizeof(struct sbus_dispatch_stats));
+        return;
+    }
+
+    *_stats = conn->dispatch_stats;
+}
+
 errno_t
 sbus_check_access(struct sbus_connection *conn,
                  struct sbus_request *sbus_req)
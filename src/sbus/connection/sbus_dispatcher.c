@@ -29,6 +29,11 @@
 #include "util/dlinklist.h"
 #include "sbus/sbus_private.h"
 
+/* Maximum number of messages dispatched on one connection during a single
+ * wakeup. Other connections and tevent events get their turn before the
+ * rest of the queue is processed. */
+#define SBUS_DISPATCH_BATCH 32
+
 static void
 sbus_dispatch_schedule(struct sbus_connection *conn, uint32_t usecs);
 
@@ -72,6 +77,7 @@ sbus_dispatch(struct tevent_context *ev,
 {
     DBusDispatchStatus status;
     struct sbus_connection *conn;
+    uint32_t count;
     bool connected;
 
     conn = talloc_get_type(data, struct sbus_connection);
@@ -95,16 +101,37 @@ sbus_dispatch(struct tevent_context *ev,
         return;
     }
 
-    /* Dispatch only once to avoid starving other tevent requests. */
+    /* Dispatch a limited batch to avoid starving other tevent requests. */
     status = dbus_connection_get_dispatch_status(conn->connection);
-    if (status != DBUS_DISPATCH_COMPLETE) {
+    for (count = 0; count < SBUS_DISPATCH_BATCH; count++) {
+        if (status == DBUS_DISPATCH_COMPLETE) {
+            break;
+        }
+
         DEBUG(SSSDBG_TRACE_ALL, "Dispatching.\n");
-        dbus_connection_dispatch(conn->connection);
+        status = dbus_connection_dispatch(conn->connection);
+
+        /* A handler may have decided to terminate the connection. */
+        if (conn->disconnecting) {
+            return;
+        }
     }
 
-    /* If other dispatches are waiting, schedule next dispatch. */
-    status = dbus_connection_get_dispatch_status(conn->connection);
+    conn->dispatch_stats.wakeups++;
+    conn->dispatch_stats.messages += count;
+    conn->dispatch_stats.last_batch = count;
+    if (count > conn->dispatch_stats.max_batch) {
+        conn->dispatch_stats.max_batch = count;
+    }
+
+    /* If other dispatches are waiting, schedule next dispatch. The timer is
+     * queued behind timers of other connections that are already waiting. */
     if (status != DBUS_DISPATCH_COMPLETE) {
+        if (count == SBUS_DISPATCH_BATCH) {
+            conn->dispatch_stats.deferred++;
+            DEBUG(SSSDBG_TRACE_INTERNAL, "Batch limit reached, deferring "
+                  "the rest of the queue.\n");
+        }
         sbus_dispatch_schedule(conn, 0);
     }
 }
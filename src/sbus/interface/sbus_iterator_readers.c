@@ -19,6 +19,10 @@
 */
 
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <dbus/dbus.h>
 
 #include "util/util.h"
@@ -296,6 +300,37 @@ errno_t sbus_iterator_read_O(TALLOC_CTX *mem_ctx,
     return sbus_iterator_read_basic(mem_ctx, iterator, DBUS_TYPE_OBJECT_PATH, _value);
 }
 
+static errno_t
+sbus_iterator_read_borrowed(DBusMessageIter *iterator,
+                            int dbus_type,
+                            const char **_value)
+{
+    int arg_type;
+
+    arg_type = dbus_message_iter_get_arg_type(iterator);
+    if (arg_type != dbus_type) {
+        return ERR_SBUS_INVALID_TYPE;
+    }
+
+    /* The string is owned by the message, do not copy it. */
+    dbus_message_iter_get_basic(iterator, _value);
+    dbus_message_iter_next(iterator);
+
+    return EOK;
+}
+
+errno_t sbus_iterator_read_R(DBusMessageIter *iterator,
+                             const char **_value)
+{
+    return sbus_iterator_read_borrowed(iterator, DBUS_TYPE_STRING, _value);
+}
+
+errno_t sbus_iterator_read_P(DBusMessageIter *iterator,
+                             const char **_value)
+{
+    return sbus_iterator_read_borrowed(iterator, DBUS_TYPE_OBJECT_PATH, _value);
+}
+
 errno_t sbus_iterator_read_ay(TALLOC_CTX *mem_ctx,
                               DBusMessageIter *iterator,
                               uint8_t **_value)
@@ -412,3 +447,84 @@ errno_t sbus_iterator_read_aO(TALLOC_CTX *mem_ctx,
                                           DBUS_TYPE_OBJECT_PATH,
                                           char *, _value);
 }
+
+struct sbus_blob_mapping {
+    struct sbus_blob blob;
+    void *addr;
+};
+
+static int sbus_blob_mapping_destructor(struct sbus_blob_mapping *mapping)
+{
+    if (mapping->addr != NULL) {
+        munmap(mapping->addr, mapping->blob.length);
+    }
+
+    return 0;
+}
+
+errno_t sbus_iterator_read_blob(TALLOC_CTX *mem_ctx,
+                                DBusMessageIter *iterator,
+                                struct sbus_blob **_value)
+{
+#ifdef F_GET_SEALS
+    const int required = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+    struct sbus_blob_mapping *mapping;
+    struct stat st;
+    int seals;
+    int fd = -1;
+    errno_t ret;
+
+    if (dbus_message_iter_get_arg_type(iterator) != DBUS_TYPE_UNIX_FD) {
+        return ERR_SBUS_INVALID_TYPE;
+    }
+
+    /* libdbus returns a new descriptor that we own */
+    dbus_message_iter_get_basic(iterator, &fd);
+    dbus_message_iter_next(iterator);
+
+    /* The sender must not be able to change the data while we use it */
+    seals = fcntl(fd, F_GET_SEALS);
+    if (seals == -1 || (seals & required) != required) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Large argument is not sealed\n");
+        ret = EPERM;
+        goto done;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        ret = errno;
+        goto done;
+    }
+
+    mapping = talloc_zero(mem_ctx, struct sbus_blob_mapping);
+    if (mapping == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (st.st_size > 0) {
+        mapping->addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping->addr == MAP_FAILED) {
+            ret = errno;
+            mapping->addr = NULL;
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to map large argument "
+                  "[%d]: %s\n", ret, sss_strerror(ret));
+            talloc_free(mapping);
+            goto done;
+        }
+        mapping->blob.data = mapping->addr;
+        mapping->blob.length = st.st_size;
+    }
+
+    talloc_set_destructor(mapping, sbus_blob_mapping_destructor);
+
+    /* blob is the first member so it can be freed as the whole mapping */
+    *_value = &mapping->blob;
+    ret = EOK;
+
+done:
+    close(fd);
+    return ret;
+#else
+    return ENOTSUP;
+#endif
+}
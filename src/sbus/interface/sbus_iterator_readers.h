@@ -27,6 +27,7 @@
 #include <dbus/dbus.h>
 
 #include "util/util.h"
+#include "sbus/sbus_blob.h"
 
 errno_t sbus_iterator_read_y(DBusMessageIter *iterator,
                              uint8_t *_value);
@@ -71,6 +72,13 @@ errno_t sbus_iterator_read_O(TALLOC_CTX *mem_ctx,
                              DBusMessageIter *iterator,
                              char **_value);
 
+/* Borrowed strings point into the D-Bus message, they are not copied. */
+errno_t sbus_iterator_read_R(DBusMessageIter *iterator,
+                             const char **_value);
+
+errno_t sbus_iterator_read_P(DBusMessageIter *iterator,
+                             const char **_value);
+
 errno_t sbus_iterator_read_ay(TALLOC_CTX *mem_ctx,
                               DBusMessageIter *iterator,
                               uint8_t **_value);
@@ -123,4 +131,9 @@ errno_t sbus_iterator_read_aO(TALLOC_CTX *mem_ctx,
                               DBusMessageIter *iterator,
                               char ***_value);
 
+/* Maps the memfd of a codegen.LargeArgument argument read-only. */
+errno_t sbus_iterator_read_blob(TALLOC_CTX *mem_ctx,
+                                DBusMessageIter *iterator,
+                                struct sbus_blob **_value);
+
 #endif /* _SBUS_ITERATOR_READERS_H_ */
@@ -20,6 +20,9 @@
 
 #include <errno.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <stdint.h>
 #include <talloc.h>
 #include <dbus/dbus.h>
@@ -273,6 +276,19 @@ errno_t sbus_iterator_write_O(DBusMessageIter *iterator,
                                       value, "/");
 }
 
+errno_t sbus_iterator_write_R(DBusMessageIter *iterator,
+                              const char *value)
+{
+    return sbus_iterator_write_string(iterator, DBUS_TYPE_STRING, value, "");
+}
+
+errno_t sbus_iterator_write_P(DBusMessageIter *iterator,
+                              const char *value)
+{
+    return sbus_iterator_write_string(iterator, DBUS_TYPE_OBJECT_PATH,
+                                      value, "/");
+}
+
 errno_t sbus_iterator_write_ay(DBusMessageIter *iterator,
                                uint8_t *value)
 {
@@ -363,3 +379,65 @@ errno_t sbus_iterator_write_aO(DBusMessageIter *iterator,
     return sbus_iterator_write_basic_array(iterator, DBUS_TYPE_OBJECT_PATH,
                                            char *, value);
 }
+
+errno_t sbus_iterator_write_blob(DBusMessageIter *iterator,
+                                 struct sbus_blob *value)
+{
+#if defined(HAVE_MEMFD_CREATE) && defined(F_ADD_SEALS)
+    const int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+    dbus_bool_t dbret;
+    void *addr;
+    errno_t ret;
+    int fd;
+
+    if (value == NULL) {
+        return EINVAL;
+    }
+
+    fd = memfd_create("sbus_blob", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "memfd_create() failed [%d]: %s\n",
+              ret, sss_strerror(ret));
+        return ret;
+    }
+
+    if (value->length > 0) {
+        if (ftruncate(fd, value->length) != 0) {
+            ret = errno;
+            goto done;
+        }
+
+        addr = mmap(NULL, value->length, PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            ret = errno;
+            goto done;
+        }
+
+        memcpy(addr, value->data, value->length);
+
+        /* F_SEAL_WRITE fails while there is a writable mapping */
+        munmap(addr, value->length);
+    }
+
+    if (fcntl(fd, F_ADD_SEALS, seals) != 0) {
+        ret = errno;
+        goto done;
+    }
+
+    /* libdbus duplicates the descriptor */
+    dbret = dbus_message_iter_append_basic(iterator, DBUS_TYPE_UNIX_FD, &fd);
+    ret = dbret ? EOK : EIO;
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to write large argument "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+    }
+
+    close(fd);
+    return ret;
+#else
+    return ENOTSUP;
+#endif
+}
@@ -25,6 +25,7 @@
 #include <dbus/dbus.h>
 
 #include "util/util.h"
+#include "sbus/sbus_blob.h"
 
 /* Generic writers to be used in custom type handlers. */
 
@@ -84,6 +85,12 @@ errno_t sbus_iterator_write_o(DBusMessageIter *iterator,
 errno_t sbus_iterator_write_O(DBusMessageIter *iterator,
                               char *value);
 
+errno_t sbus_iterator_write_R(DBusMessageIter *iterator,
+                              const char *value);
+
+errno_t sbus_iterator_write_P(DBusMessageIter *iterator,
+                              const char *value);
+
 errno_t sbus_iterator_write_ay(DBusMessageIter *iterator,
                                uint8_t *value);
 
@@ -123,4 +130,9 @@ errno_t sbus_iterator_write_ao(DBusMessageIter *iterator,
 errno_t sbus_iterator_write_aO(DBusMessageIter *iterator,
                                char **value);
 
+/* Passes the payload of a codegen.LargeArgument argument in a sealed
+ * memfd. Returns ENOTSUP if memfd is not available. */
+errno_t sbus_iterator_write_blob(DBusMessageIter *iterator,
+                                 struct sbus_blob *value);
+
 #endif /* _SBUS_ITERATOR_WRITERS_H_ */
@@ -63,6 +63,9 @@ sbus_router_add_path(struct sbus_router *router,
         return ret;
     }
 
+    /* The new path may change how already resolved methods resolve. */
+    sbus_router_methods_flush(router->methods);
+
     return EOK;
 }
 
@@ -286,6 +289,11 @@ sbus_router_init(TALLOC_CTX *mem_ctx,
         goto fail;
     }
 
+    router->methods = sbus_router_methods_init(router);
+    if (router->methods == NULL) {
+        goto fail;
+    }
+
     /* Register standard interfaces. */
     ret = sbus_router_register_std(router);
     if (ret != EOK) {
@@ -181,8 +181,9 @@ sbus_method_handler(struct sbus_connection *conn,
     /* Mark this connection as active. */
     sbus_connection_mark_active(conn);
 
-    iface = sbus_router_paths_lookup(router->paths, meta->path,
-                                     meta->interface);
+    method = sbus_router_methods_lookup(router->methods, router->paths,
+                                        meta->path, meta->interface,
+                                        meta->member, &iface);
     if (iface == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unknown interface!\n");
         sbus_reply_error(conn, message, DBUS_ERROR_UNKNOWN_INTERFACE,
@@ -190,7 +191,6 @@ sbus_method_handler(struct sbus_connection *conn,
         return DBUS_HANDLER_RESULT_HANDLED;
     }
 
-    method = sbus_interface_find_method(iface, meta->member);
     if (method == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unknown method!\n");
         sbus_reply_error(conn, message, DBUS_ERROR_UNKNOWN_METHOD,
@@ -205,6 +205,89 @@ done:
     return iface;
 }
 
+/* Upper bound of cached methods. The table is flushed when it is reached
+ * so object paths that contain object identifiers can not grow it
+ * without limit. */
+#define SBUS_ROUTER_METHODS_MAX 1024
+
+struct sbus_router_method {
+    struct sbus_interface *iface;
+    const struct sbus_method *method;
+};
+
+hash_table_t *
+sbus_router_methods_init(TALLOC_CTX *mem_ctx)
+{
+    return sss_ptr_hash_create(mem_ctx, NULL, NULL);
+}
+
+void
+sbus_router_methods_flush(hash_table_t *methods)
+{
+    sss_ptr_hash_delete_all(methods, true);
+}
+
+const struct sbus_method *
+sbus_router_methods_lookup(hash_table_t *methods,
+                           hash_table_t *paths,
+                           const char *path,
+                           const char *iface_name,
+                           const char *method_name,
+                           struct sbus_interface **_iface)
+{
+    struct sbus_router_method *entry;
+    const struct sbus_method *method;
+    struct sbus_interface *iface;
+    char *key;
+    errno_t ret;
+
+    key = talloc_asprintf(NULL, "%s:%s.%s", path, iface_name, method_name);
+    if (key == NULL) {
+        return NULL;
+    }
+
+    entry = sss_ptr_hash_lookup(methods, key, struct sbus_router_method);
+    if (entry != NULL) {
+        *_iface = entry->iface;
+        method = entry->method;
+        goto done;
+    }
+
+    iface = sbus_router_paths_lookup(paths, path, iface_name);
+    *_iface = iface;
+    if (iface == NULL) {
+        method = NULL;
+        goto done;
+    }
+
+    method = sbus_interface_find_method(iface, method_name);
+    if (method == NULL) {
+        goto done;
+    }
+
+    if (hash_count(methods) >= SBUS_ROUTER_METHODS_MAX) {
+        sbus_router_methods_flush(methods);
+    }
+
+    /* Failure to cache the method is not fatal. */
+    entry = talloc_zero(methods, struct sbus_router_method);
+    if (entry == NULL) {
+        goto done;
+    }
+
+    entry->iface = iface;
+    entry->method = method;
+
+    ret = sss_ptr_hash_add(methods, key, entry, struct sbus_router_method);
+    if (ret != EOK) {
+        talloc_free(entry);
+    }
+
+done:
+    talloc_free(key);
+    return method;
+}
+
 /**
  * Acquire list of all interfaces that are supported on given object path.
  */
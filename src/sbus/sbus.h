@@ -32,6 +32,7 @@
 #include "sbus/sbus_interface.h"
 #include "sbus/sbus_request.h"
 #include "sbus/sbus_errors.h"
+#include "sbus/sbus_blob.h"
 
 struct sbus_listener;
 struct sbus_connection;
@@ -301,6 +302,42 @@ void sbus_connection_set_data(struct sbus_connection *conn,
 #define sbus_connection_get_data(conn, type) \
     talloc_get_type(_sbus_connection_get_data(conn), type)
 
+/**
+ * Dispatcher statistics of an sbus connection.
+ */
+struct sbus_dispatch_stats {
+    /* Number of dispatcher wakeups. */
+    uint64_t wakeups;
+
+    /* Number of dispatched messages. */
+    uint64_t messages;
+
+    /* Number of wakeups that left messages in the incoming queue because
+     * the batch limit was reached. */
+    uint64_t deferred;
+
+    /* Number of messages dispatched during the last wakeup. */
+    uint32_t last_batch;
+
+    /* Largest number of messages dispatched during one wakeup. */
+    uint32_t max_batch;
+};
+
+/**
+ * Retrieve dispatcher statistics of an sbus connection.
+ *
+ * Large or often deferred batches mean that messages queue up faster
+ * than they are processed.
+ *
+ * Responders export these through sssd.Responder.Stats.Dispatcher, which
+ * is printed by sssctl responder-stats.
+ *
+ * @param conn          An sbus connection.
+ * @param _stats        Output statistics.
+ */
+void sbus_connection_get_dispatch_stats(struct sbus_connection *conn,
+                                        struct sbus_dispatch_stats *_stats);
+
 /**
  * Reconnection status that is pass to a reconnection callback.
  */
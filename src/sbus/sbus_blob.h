@@ -0,0 +1,43 @@
+/*
+    SSSD
+
+    sbus - large arguments passed in sealed memory files
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SBUS_BLOB_H_
+#define _SBUS_BLOB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Opaque payload of an "ay" argument annotated with codegen.LargeArgument.
+ *
+ * Instead of being marshalled into the D-Bus message, the payload is
+ * written into a sealed memfd and only the file descriptor is sent. The
+ * receiver maps the file read-only, so the data is neither copied nor
+ * validated by libdbus. The mapping lives as long as the blob talloc
+ * context.
+ *
+ * The connection must support passing file descriptors, which is the case
+ * for all sbus connections over unix sockets.
+ */
+struct sbus_blob {
+    const uint8_t *data;
+    size_t length;
+};
+
+#endif /* _SBUS_BLOB_H_ */
@@ -108,6 +108,9 @@ struct sbus_connection {
     /* Pointer to a caller's last activity variable. The time is updated
      * each time the bus is active (when a method arrives). */
     time_t *last_activity;
+
+    /* Dispatcher statistics. */
+    struct sbus_dispatch_stats dispatch_stats;
 };
 
 struct sbus_server {
@@ -306,6 +309,13 @@ struct sbus_router {
      * sbus signal listeners.
      */
     hash_table_t *listeners;
+
+    /**
+     * Table of <object-path:interface.method, method> pair. Caches resolved
+     * methods so the object path hierarchy is not searched for every
+     * message. It is flushed when a new path is registered.
+     */
+    hash_table_t *methods;
 };
 
 /* Initialize router structure. */
@@ -317,6 +327,25 @@ sbus_router_init(TALLOC_CTX *mem_ctx,
 errno_t
 sbus_router_reset(struct sbus_connection *conn);
 
+/* Initialize resolved methods hash table. */
+hash_table_t *
+sbus_router_methods_init(TALLOC_CTX *mem_ctx);
+
+/* Lookup method for given object path, interface and method name. If the
+ * interface is found but it does not implement the method, NULL is returned
+ * and @_iface is set. */
+const struct sbus_method *
+sbus_router_methods_lookup(hash_table_t *methods,
+                           hash_table_t *paths,
+                           const char *path,
+                           const char *iface_name,
+                           const char *method_name,
+                           struct sbus_interface **_iface);
+
+/* Remove all resolved methods. */
+void
+sbus_router_methods_flush(hash_table_t *methods);
+
 /* Initialize object paths hash table. */
 hash_table_t *
 sbus_router_paths_init(TALLOC_CTX *mem_ctx);
@@ -0,0 +1,21 @@
+/* This file is based on the public domain wyhash from Wang Yi:
+ * https://github.com/wangyi-fudan/wyhash
+ *
+ * The 64 bit result is folded to 32 bits and the 128 bit multiplication has
+ * a fallback for compilers without a 128 bit integer type, so 32 and 64 bit
+ * clients always compute the same hash.
+ */
+
+#ifndef _SHARED_WYHASH_H_
+#define _SHARED_WYHASH_H_
+
+/* CAUTION:
+ * This file is also used in sss_client (pam, nss). Therefore it have to be
+ * minimalist and cannot include DEBUG macros or header file util.h.
+ */
+
+#include <stdint.h>
+
+uint32_t wyhash32(const char *key, int len, uint32_t seed);
+
+#endif /* _SHARED_WYHASH_H_ */
@@ -30,6 +30,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <stdlib.h>
@@ -63,20 +64,177 @@
 #define SSS_DEFAULT_WRITE_FLAGS 0
 #endif
 
+#ifndef discard_const
+#define discard_const(ptr) ((void *)((uintptr_t)(ptr)))
+#endif
+
+/* Size of the buffer the body of a reply is read into together with the
+ * header, larger replies need a second read */
+#define SSS_CLI_RECV_PREALLOC 2048
+
 /* common functions */
 
-static int sss_cli_sd = -1; /* the sss client socket descriptor */
-static struct stat sss_cli_sb; /* the sss client stat buffer */
+struct sss_cli_sock {
+    int sd;             /* the sss client socket descriptor */
+    struct stat sb;     /* the sss client stat buffer */
+    pid_t pid;          /* the process the socket was checked in */
+};
+
+/* the socket shared by all threads, used with the module lock held */
+static struct sss_cli_sock sss_cli_shared = { .sd = -1 };
+static uint32_t sss_cli_tag; /* tag of the last request */
+
+uint32_t sss_cli_next_tag(void)
+{
+    uint32_t tag;
+
+    /* 0 means an untagged request */
+    do {
+        tag = __sync_add_and_fetch(&sss_cli_tag, 1);
+    } while (tag == 0);
+
+    return tag;
+}
+
+static void sss_cli_close_sock(struct sss_cli_sock *sock)
+{
+    if (sock->sd != -1) {
+        close(sock->sd);
+        sock->sd = -1;
+    }
+}
+
+#if HAVE_PTHREAD
+/* With SSS_NSS_THREAD_SOCKETS set to "YES" every thread looks up users and
+ * their group memberships over its own socket, without the NSS lock. The
+ * socket is kept in thread specific data and closed when the thread exits.
+ * Group lookups keep the lock, they share the cache of ERANGE replies. */
+static pthread_once_t sss_cli_thread_once = PTHREAD_ONCE_INIT;
+static pthread_key_t sss_cli_thread_key;
+static bool sss_cli_thread_sockets;
+
+/* Used by the threads which cannot open a socket of their own because the
+ * descriptor limit is reached. It has its own lock since the NSS lock may
+ * already be held by the caller. */
+static struct sss_cli_sock sss_cli_fallback = { .sd = -1 };
+static pthread_mutex_t sss_cli_fallback_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static void sss_cli_thread_sock_free(void *ptr)
+{
+    struct sss_cli_sock *sock = ptr;
+
+    sss_cli_close_sock(sock);
+    free(sock);
+}
+
+static void sss_cli_thread_init(void)
+{
+    char *envval;
+
+    envval = getenv("SSS_NSS_THREAD_SOCKETS");
+    if (envval == NULL || strcasecmp(envval, "YES") != 0) {
+        return;
+    }
+
+    if (pthread_key_create(&sss_cli_thread_key,
+                           sss_cli_thread_sock_free) != 0) {
+        return;
+    }
+
+    sss_cli_thread_sockets = true;
+}
+
+static bool sss_cli_use_thread_sockets(void)
+{
+    pthread_once(&sss_cli_thread_once, sss_cli_thread_init);
+    return sss_cli_thread_sockets;
+}
+
+/* True for the commands sent by the lookups which do not take the NSS
+ * lock, these must never use the shared socket. */
+static bool sss_cli_lockless_cmd(enum sss_cli_command cmd)
+{
+    switch (cmd) {
+    case SSS_NSS_GETPWNAM:
+    case SSS_NSS_GETPWUID:
+    case SSS_NSS_INITGR:
+        return sss_cli_use_thread_sockets();
+    default:
+        return false;
+    }
+}
+
+/* Returns the socket of the calling thread, NULL if it cannot be
+ * allocated. */
+static struct sss_cli_sock *sss_cli_thread_sock(void)
+{
+    struct sss_cli_sock *sock;
+
+    sock = pthread_getspecific(sss_cli_thread_key);
+    if (sock != NULL) {
+        return sock;
+    }
+
+    sock = calloc(1, sizeof(struct sss_cli_sock));
+    if (sock == NULL) {
+        return NULL;
+    }
+    sock->sd = -1;
+
+    if (pthread_setspecific(sss_cli_thread_key, sock) != 0) {
+        free(sock);
+        return NULL;
+    }
+
+    return sock;
+}
+
+static void sss_cli_fallback_lock(void)
+{
+    pthread_mutex_lock(&sss_cli_fallback_mtx);
+}
+
+static void sss_cli_fallback_unlock(void)
+{
+    pthread_mutex_unlock(&sss_cli_fallback_mtx);
+}
+#else
+static struct sss_cli_sock sss_cli_fallback = { .sd = -1 };
+static void sss_cli_fallback_lock(void) { return; }
+static void sss_cli_fallback_unlock(void) { return; }
+static bool sss_cli_lockless_cmd(enum sss_cli_command cmd)
+{
+    return false;
+}
+static struct sss_cli_sock *sss_cli_thread_sock(void)
+{
+    return NULL;
+}
+#endif
 
 #if HAVE_FUNCTION_ATTRIBUTE_DESTRUCTOR
 __attribute__((destructor))
 #endif
 static void sss_cli_close_socket(void)
 {
-    if (sss_cli_sd != -1) {
-        close(sss_cli_sd);
-        sss_cli_sd = -1;
+#if HAVE_PTHREAD
+    struct sss_cli_sock *sock;
+
+    /* The key must not outlive the library, a thread exiting after it is
+     * unloaded would call a destructor which is not mapped anymore. */
+    if (sss_cli_thread_sockets) {
+        sss_cli_thread_sockets = false;
+        sock = pthread_getspecific(sss_cli_thread_key);
+        if (sock != NULL) {
+            pthread_setspecific(sss_cli_thread_key, NULL);
+            sss_cli_thread_sock_free(sock);
+        }
+        pthread_key_delete(sss_cli_thread_key);
     }
+#endif
+
+    sss_cli_close_sock(&sss_cli_shared);
+    sss_cli_close_sock(&sss_cli_fallback);
 }
 
 /* Requests:
@@ -84,11 +242,17 @@ static void sss_cli_close_socket(void)
  * byte 0-3: 32bit unsigned with length (the complete packet length: 0 to X)
  * byte 4-7: 32bit unsigned with command code
  * byte 8-11: 32bit unsigned (reserved)
- * byte 12-15: 32bit unsigned (reserved)
+ * byte 12-15: 32bit unsigned with the request tag (0 if not used)
  * byte 16-X: (optional) request structure associated to the command code used
+ *
+ * A tagged request tells the server that the client may send other
+ * requests before it reads the reply, the server keeps the order of the
+ * replies and copies the tag of the request into the reply.
  */
-static enum sss_status sss_cli_send_req(enum sss_cli_command cmd,
+static enum sss_status sss_cli_send_req(struct sss_cli_sock *sock,
+                                        enum sss_cli_command cmd,
                                         struct sss_cli_req_data *rd,
+                                        uint32_t tag,
                                         int timeout,
                                         int *errnop)
 {
@@ -98,17 +262,59 @@ static enum sss_status sss_cli_send_req(enum sss_cli_command cmd,
     header[0] = SSS_NSS_HEADER_SIZE + (rd?rd->len:0);
     header[1] = cmd;
     header[2] = 0;
-    header[3] = 0;
+    header[3] = tag;
 
     datasent = 0;
 
     while (datasent < header[0]) {
         struct pollfd pfd;
+        struct iovec iov[2];
+        struct msghdr msg;
+        int iovcnt;
         int rdsent;
         int res, error;
 
+        /* Header and body are sent with a single call. The socket does not
+         * block, so only wait if a previous call could not send anything. */
+        if (datasent < SSS_NSS_HEADER_SIZE) {
+            iov[0].iov_base = (char *)header + datasent;
+            iov[0].iov_len = SSS_NSS_HEADER_SIZE - datasent;
+            iov[1].iov_base = rd ? discard_const(rd->data) : NULL;
+            iov[1].iov_len = rd ? rd->len : 0;
+            iovcnt = iov[1].iov_len > 0 ? 2 : 1;
+        } else {
+            rdsent = datasent - SSS_NSS_HEADER_SIZE;
+            iov[0].iov_base = (char *)discard_const(rd->data) + rdsent;
+            iov[0].iov_len = rd->len - rdsent;
+            iovcnt = 1;
+        }
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+
         *errnop = 0;
-        pfd.fd = sss_cli_sd;
+        errno = 0;
+        res = sendmsg(sock->sd, &msg, SSS_DEFAULT_WRITE_FLAGS);
+        error = errno;
+
+        if (res > 0) {
+            datasent += res;
+            continue;
+        }
+
+        if (res == -1 && error == EINTR) {
+            continue;
+        }
+
+        if (res == 0 || error != EAGAIN) {
+            /* Write failed */
+            sss_cli_close_sock(sock);
+            *errnop = res == 0 ? EIO : error;
+            return SSS_STATUS_UNAVAIL;
+        }
+
+        pfd.fd = sock->sd;
         pfd.events = POLLOUT;
 
         do {
@@ -142,40 +348,9 @@ static enum sss_status sss_cli_send_req(enum sss_cli_command cmd,
             break;
         }
         if (*errnop) {
-            sss_cli_close_socket();
+            sss_cli_close_sock(sock);
             return SSS_STATUS_UNAVAIL;
         }
-
-        errno = 0;
-        if (datasent < SSS_NSS_HEADER_SIZE) {
-            res = send(sss_cli_sd,
-                       (char *)header + datasent,
-                       SSS_NSS_HEADER_SIZE - datasent,
-                       SSS_DEFAULT_WRITE_FLAGS);
-        } else {
-            rdsent = datasent - SSS_NSS_HEADER_SIZE;
-            res = send(sss_cli_sd,
-                       (const char *)rd->data + rdsent,
-                       rd->len - rdsent,
-                       SSS_DEFAULT_WRITE_FLAGS);
-        }
-        error = errno;
-
-        if ((res == -1) || (res == 0)) {
-            if ((error == EINTR) || error == EAGAIN) {
-                /* If the write was interrupted, go back through
-                 * the loop and try again
-                 */
-                continue;
-            }
-
-            /* Write failed */
-            sss_cli_close_socket();
-            *errnop = error;
-            return SSS_STATUS_UNAVAIL;
-        }
-
-        datasent += res;
     }
 
     return SSS_STATUS_SUCCESS;
@@ -186,11 +361,13 @@ static enum sss_status sss_cli_send_req(enum sss_cli_command cmd,
  * byte 0-3: 32bit unsigned with length (the complete packet length: 0 to X)
  * byte 4-7: 32bit unsigned with command code
  * byte 8-11: 32bit unsigned with the request status (server errno)
- * byte 12-15: 32bit unsigned (reserved)
+ * byte 12-15: 32bit unsigned with the request tag (0 from older servers)
  * byte 16-X: (optional) reply structure associated to the command code used
  */
 
-static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
+static enum sss_status sss_cli_recv_rep(struct sss_cli_sock *sock,
+                                        enum sss_cli_command cmd,
+                                        uint32_t tag,
                                         int timeout,
                                         uint8_t **_buf, int *_len,
                                         int *errnop)
@@ -198,6 +375,7 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
     uint32_t header[4];
     size_t datarecv;
     uint8_t *buf = NULL;
+    size_t bufsize;
     bool pollhup = false;
     int len;
     int ret;
@@ -208,16 +386,24 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
     header[3] = 0;
 
     datarecv = 0;
-    buf = NULL;
     len = 0;
     *errnop = 0;
 
+    /* Most replies fit, so header and body are read at once. */
+    bufsize = SSS_CLI_RECV_PREALLOC;
+    buf = malloc(bufsize);
+    if (buf == NULL) {
+        *errnop = ENOMEM;
+        return SSS_STATUS_UNAVAIL;
+    }
+
     while (datarecv < header[0]) {
         struct pollfd pfd;
+        struct iovec iov[2];
         int bufrecv;
         int res, error;
 
-        pfd.fd = sss_cli_sd;
+        pfd.fd = sock->sd;
         pfd.events = POLLIN;
 
         do {
@@ -254,19 +440,21 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
             break;
         }
         if (*errnop) {
-            sss_cli_close_socket();
+            sss_cli_close_sock(sock);
             ret = SSS_STATUS_UNAVAIL;
             goto failed;
         }
 
         errno = 0;
         if (datarecv < SSS_NSS_HEADER_SIZE) {
-            res = read(sss_cli_sd,
-                       (char *)header + datarecv,
-                       SSS_NSS_HEADER_SIZE - datarecv);
+            iov[0].iov_base = (char *)header + datarecv;
+            iov[0].iov_len = SSS_NSS_HEADER_SIZE - datarecv;
+            iov[1].iov_base = buf;
+            iov[1].iov_len = bufsize;
+            res = readv(sock->sd, iov, 2);
         } else {
             bufrecv = datarecv - SSS_NSS_HEADER_SIZE;
-            res = read(sss_cli_sd,
+            res = read(sock->sd,
                        (char *) buf + bufrecv,
                        header[0] - datarecv);
         }
@@ -285,7 +473,7 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
              * since the transaction has failed half way
              * through. */
 
-            sss_cli_close_socket();
+            sss_cli_close_sock(sock);
             *errnop = error;
             ret = SSS_STATUS_UNAVAIL;
             goto failed;
@@ -293,13 +481,13 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
 
         datarecv += res;
 
-        if (datarecv == SSS_NSS_HEADER_SIZE && len == 0) {
+        if (datarecv >= SSS_NSS_HEADER_SIZE && len == 0) {
             /* at this point recv buf is not yet
              * allocated and the header has just
              * been read, do checks and proceed */
             if (header[2] != 0) {
                 /* server side error */
-                sss_cli_close_socket();
+                sss_cli_close_sock(sock);
                 *errnop = header[2];
                 if (*errnop == EAGAIN) {
                     ret = SSS_STATUS_TRYAGAIN;
@@ -309,28 +497,45 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
                     goto failed;
                 }
             }
-            if (header[1] != cmd) {
-                /* wrong command id */
-                sss_cli_close_socket();
+            if (header[1] != cmd
+                    || (header[3] != 0 && header[3] != tag)) {
+                /* wrong command id or reply to another request */
+                sss_cli_close_sock(sock);
+                *errnop = EBADMSG;
+                ret = SSS_STATUS_UNAVAIL;
+                goto failed;
+            }
+            if (datarecv > header[0]) {
+                /* the server never sends more than one reply */
+                sss_cli_close_sock(sock);
                 *errnop = EBADMSG;
                 ret = SSS_STATUS_UNAVAIL;
                 goto failed;
             }
             if (header[0] > SSS_NSS_HEADER_SIZE) {
                 len = header[0] - SSS_NSS_HEADER_SIZE;
-                buf = malloc(len);
-                if (!buf) {
-                    sss_cli_close_socket();
-                    *errnop = ENOMEM;
-                    ret = SSS_STATUS_UNAVAIL;
-                    goto failed;
+                if (len > bufsize) {
+                    uint8_t *newbuf;
+
+                    newbuf = realloc(buf, len);
+                    if (!newbuf) {
+                        sss_cli_close_sock(sock);
+                        *errnop = ENOMEM;
+                        ret = SSS_STATUS_UNAVAIL;
+                        goto failed;
+                    }
+                    buf = newbuf;
+                    bufsize = len;
                 }
+            } else {
+                free(buf);
+                buf = NULL;
             }
         }
     }
 
     if (pollhup) {
-        sss_cli_close_socket();
+        sss_cli_close_sock(sock);
     }
 
     *_len = len;
@@ -346,6 +551,7 @@ failed:
 /* this function will check command codes match and returned length is ok */
 /* repbuf and replen report only the data section not the header */
 static enum sss_status sss_cli_make_request_nochecks(
+                                       struct sss_cli_sock *sock,
                                        enum sss_cli_command cmd,
                                        struct sss_cli_req_data *rd,
                                        int timeout,
@@ -354,16 +560,21 @@ static enum sss_status sss_cli_make_request_nochecks(
 {
     enum sss_status ret;
     uint8_t *buf = NULL;
+    /* The callers wait for the reply before they send anything else, so
+     * the request is not tagged and the server does not read from the
+     * socket while it executes it. Only the asynchronous requests, which
+     * send more than one request at once, are tagged. */
+    uint32_t tag = 0;
     int len = 0;
 
     /* send data */
-    ret = sss_cli_send_req(cmd, rd, timeout, errnop);
+    ret = sss_cli_send_req(sock, cmd, rd, tag, timeout, errnop);
     if (ret != SSS_STATUS_SUCCESS) {
         return ret;
     }
 
     /* data sent, now get reply */
-    ret = sss_cli_recv_rep(cmd, timeout, &buf, &len, errnop);
+    ret = sss_cli_recv_rep(sock, cmd, tag, timeout, &buf, &len, errnop);
     if (ret != SSS_STATUS_SUCCESS) {
         return ret;
     }
@@ -389,7 +600,8 @@ static enum sss_status sss_cli_make_request_nochecks(
  * 0-3: 32bit unsigned version number
  */
 
-static bool sss_cli_check_version(const char *socket_name, int timeout)
+static bool sss_cli_check_version(struct sss_cli_sock *sock,
+                                  const char *socket_name, int timeout)
 {
     uint8_t *repbuf = NULL;
     size_t replen;
@@ -419,7 +631,7 @@ static bool sss_cli_check_version(const char *socket_name, int timeout)
     req.len = sizeof(expected_version);
     req.data = &expected_version;
 
-    nret = sss_cli_make_request_nochecks(SSS_GET_VERSION, &req, timeout,
+    nret = sss_cli_make_request_nochecks(sock, SSS_GET_VERSION, &req, timeout,
                                          &repbuf, &replen, &errnop);
     if (nret != SSS_STATUS_SUCCESS) {
         return false;
@@ -530,7 +742,8 @@ static int make_safe_fd(int fd)
     return new_fd;
 }
 
-static int sss_cli_open_socket(int *errnop, const char *socket_name, int timeout)
+static int sss_cli_open_socket(struct sss_cli_sock *sock, int *errnop,
+                               const char *socket_name, int timeout)
 {
     struct sockaddr_un nssaddr;
     bool inprogress = true;
@@ -625,7 +838,7 @@ static int sss_cli_open_socket(int *errnop, const char *socket_name, int timeout
         return -1;
     }
 
-    ret = fstat(sd, &sss_cli_sb);
+    ret = fstat(sd, &sock->sb);
     if (ret != 0) {
         close(sd);
         return -1;
@@ -634,35 +847,80 @@ static int sss_cli_open_socket(int *errnop, const char *socket_name, int timeout
     return sd;
 }
 
-static enum sss_status sss_cli_check_socket(int *errnop,
+int sss_cli_open_socket_nb(const char *socket_name, int *errnop)
+{
+    struct sockaddr_un nssaddr;
+    int ret;
+    int sd;
+
+    if (sizeof(nssaddr.sun_path) < strlen(socket_name) + 1) {
+        *errnop = EINVAL;
+        return -1;
+    }
+
+    memset(&nssaddr, 0, sizeof(struct sockaddr_un));
+    nssaddr.sun_family = AF_UNIX;
+    strcpy(nssaddr.sun_path, socket_name); /* safe due to above check */
+
+    sd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sd == -1) {
+        *errnop = errno;
+        return -1;
+    }
+
+    /* set as non-blocking, close on exec, and make sure standard
+     * descriptors are not used */
+    sd = make_safe_fd(sd);
+    if (sd == -1) {
+        *errnop = errno;
+        return -1;
+    }
+
+    ret = connect(sd, (struct sockaddr *)&nssaddr, sizeof(nssaddr));
+    if (ret == 0) {
+        *errnop = 0;
+        return sd;
+    }
+
+    if (errno == EINPROGRESS) {
+        *errnop = EINPROGRESS;
+        return sd;
+    }
+
+    *errnop = errno;
+    close(sd);
+    return -1;
+}
+
+static enum sss_status sss_cli_check_socket(struct sss_cli_sock *sock,
+                                            int *errnop,
                                             const char *socket_name,
                                             int timeout)
 {
-    static pid_t mypid;
     struct stat mysb;
     int mysd;
     int ret;
 
-    if (getpid() != mypid) {
-        ret = fstat(sss_cli_sd, &mysb);
+    if (getpid() != sock->pid) {
+        ret = fstat(sock->sd, &mysb);
         if (ret == 0) {
             if (S_ISSOCK(mysb.st_mode) &&
-                mysb.st_dev == sss_cli_sb.st_dev &&
-                mysb.st_ino == sss_cli_sb.st_ino) {
-                sss_cli_close_socket();
+                mysb.st_dev == sock->sb.st_dev &&
+                mysb.st_ino == sock->sb.st_ino) {
+                sss_cli_close_sock(sock);
             }
         }
-        sss_cli_sd = -1;
-        mypid = getpid();
+        sock->sd = -1;
+        sock->pid = getpid();
     }
 
     /* check if the socket has been closed on the other side */
-    if (sss_cli_sd != -1) {
+    if (sock->sd != -1) {
         struct pollfd pfd;
         int res, error;
 
         *errnop = 0;
-        pfd.fd = sss_cli_sd;
+        pfd.fd = sock->sd;
         pfd.events = POLLIN | POLLOUT;
 
         do {
@@ -699,25 +957,58 @@ static enum sss_status sss_cli_check_socket(int *errnop,
             return SSS_STATUS_SUCCESS;
         }
 
-        sss_cli_close_socket();
+        sss_cli_close_sock(sock);
     }
 
-    mysd = sss_cli_open_socket(errnop, socket_name, timeout);
+    mysd = sss_cli_open_socket(sock, errnop, socket_name, timeout);
     if (mysd == -1) {
         return SSS_STATUS_UNAVAIL;
     }
 
-    sss_cli_sd = mysd;
+    sock->sd = mysd;
 
-    if (sss_cli_check_version(socket_name, timeout)) {
+    if (sss_cli_check_version(sock, socket_name, timeout)) {
         return SSS_STATUS_SUCCESS;
     }
 
-    sss_cli_close_socket();
+    sss_cli_close_sock(sock);
     *errnop = EFAULT;
     return SSS_STATUS_UNAVAIL;
 }
 
+static enum sss_status sss_nss_make_request_sock(struct sss_cli_sock *sock,
+                                                enum sss_cli_command cmd,
+                                                struct sss_cli_req_data *rd,
+                                                int timeout,
+                                                uint8_t **repbuf,
+                                                size_t *replen,
+                                                int *errnop)
+{
+    enum sss_status ret;
+
+    ret = sss_cli_check_socket(sock, errnop, SSS_NSS_SOCKET_NAME, timeout);
+    if (ret != SSS_STATUS_SUCCESS) {
+        return SSS_STATUS_UNAVAIL;
+    }
+
+    ret = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                        repbuf, replen, errnop);
+    if (ret == SSS_STATUS_UNAVAIL && *errnop == EPIPE) {
+        /* try reopen socket */
+        ret = sss_cli_check_socket(sock, errnop, SSS_NSS_SOCKET_NAME,
+                                   timeout);
+        if (ret != SSS_STATUS_SUCCESS) {
+            return SSS_STATUS_UNAVAIL;
+        }
+
+        /* and make request one more time */
+        ret = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                            repbuf, replen, errnop);
+    }
+
+    return ret;
+}
+
 /* this function will check command codes match and returned length is ok */
 /* repbuf and replen report only the data section not the header */
 enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
@@ -726,7 +1017,8 @@ enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
                                              uint8_t **repbuf, size_t *replen,
                                              int *errnop)
 {
-    enum sss_status ret;
+    struct sss_cli_sock *sock;
+    enum sss_status ret = SSS_STATUS_UNAVAIL;
     char *envval;
 
     /* avoid looping in the nss daemon */
@@ -735,36 +1027,27 @@ enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
         return NSS_STATUS_NOTFOUND;
     }
 
-    ret = sss_cli_check_socket(errnop, SSS_NSS_SOCKET_NAME, timeout);
-    if (ret != SSS_STATUS_SUCCESS) {
-#ifdef NONSTANDARD_SSS_NSS_BEHAVIOUR
-        *errnop = 0;
-        errno = 0;
-        return NSS_STATUS_NOTFOUND;
-#else
-        return NSS_STATUS_UNAVAIL;
-#endif
-    }
-
-    ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                        errnop);
-    if (ret == SSS_STATUS_UNAVAIL && *errnop == EPIPE) {
-        /* try reopen socket */
-        ret = sss_cli_check_socket(errnop, SSS_NSS_SOCKET_NAME, timeout);
-        if (ret != SSS_STATUS_SUCCESS) {
-#ifdef NONSTANDARD_SSS_NSS_BEHAVIOUR
-            *errnop = 0;
-            errno = 0;
-            return NSS_STATUS_NOTFOUND;
-#else
-            return NSS_STATUS_UNAVAIL;
-#endif
+    if (sss_cli_lockless_cmd(cmd)) {
+        /* The caller does not hold the NSS lock, if the thread has no
+         * socket of its own or is out of descriptors it shares the fallback
+         * socket with the other threads, under its own lock. */
+        sock = sss_cli_thread_sock();
+        if (sock != NULL) {
+            ret = sss_nss_make_request_sock(sock, cmd, rd, timeout,
+                                            repbuf, replen, errnop);
         }
-
-        /* and make request one more time */
-        ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                            errnop);
+        if (sock == NULL || (ret == SSS_STATUS_UNAVAIL
+                             && (*errnop == EMFILE || *errnop == ENFILE))) {
+            sss_cli_fallback_lock();
+            ret = sss_nss_make_request_sock(&sss_cli_fallback, cmd, rd,
+                                            timeout, repbuf, replen, errnop);
+            sss_cli_fallback_unlock();
+        }
+    } else {
+        ret = sss_nss_make_request_sock(&sss_cli_shared, cmd, rd, timeout,
+                                        repbuf, replen, errnop);
     }
+
     switch (ret) {
     case SSS_STATUS_TRYAGAIN:
         return NSS_STATUS_TRYAGAIN;
@@ -793,10 +1076,11 @@ enum nss_status sss_nss_make_request(enum sss_cli_command cmd,
 
 int sss_pac_check_and_open(void)
 {
+    struct sss_cli_sock *sock = &sss_cli_shared;
     enum sss_status ret;
     int errnop;
 
-    ret = sss_cli_check_socket(&errnop, SSS_PAC_SOCKET_NAME,
+    ret = sss_cli_check_socket(sock, &errnop, SSS_PAC_SOCKET_NAME,
                                SSS_CLI_SOCKET_TIMEOUT);
     if (ret != SSS_STATUS_SUCCESS) {
         return EIO;
@@ -810,6 +1094,7 @@ int sss_pac_make_request(enum sss_cli_command cmd,
                          uint8_t **repbuf, size_t *replen,
                          int *errnop)
 {
+    struct sss_cli_sock *sock = &sss_cli_shared;
     enum sss_status ret;
     char *envval;
     int timeout = SSS_CLI_SOCKET_TIMEOUT;
@@ -820,23 +1105,24 @@ int sss_pac_make_request(enum sss_cli_command cmd,
         return NSS_STATUS_NOTFOUND;
     }
 
-    ret = sss_cli_check_socket(errnop, SSS_PAC_SOCKET_NAME, timeout);
+    ret = sss_cli_check_socket(sock, errnop, SSS_PAC_SOCKET_NAME, timeout);
     if (ret != SSS_STATUS_SUCCESS) {
         return NSS_STATUS_UNAVAIL;
     }
 
-    ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                        errnop);
+    ret = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                        repbuf, replen, errnop);
     if (ret == SSS_STATUS_UNAVAIL && *errnop == EPIPE) {
         /* try reopen socket */
-        ret = sss_cli_check_socket(errnop, SSS_PAC_SOCKET_NAME, timeout);
+        ret = sss_cli_check_socket(sock, errnop, SSS_PAC_SOCKET_NAME,
+                                   timeout);
         if (ret != SSS_STATUS_SUCCESS) {
             return NSS_STATUS_UNAVAIL;
         }
 
         /* and make request one more time */
-        ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                            errnop);
+        ret = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                            repbuf, replen, errnop);
     }
     switch (ret) {
     case SSS_STATUS_TRYAGAIN:
@@ -894,6 +1180,7 @@ int sss_pam_make_request(enum sss_cli_command cmd,
                       uint8_t **repbuf, size_t *replen,
                       int *errnop)
 {
+    struct sss_cli_sock *sock = &sss_cli_shared;
     int ret, statret;
     errno_t error;
     enum sss_status status;
@@ -956,33 +1243,33 @@ int sss_pam_make_request(enum sss_cli_command cmd,
         }
     }
 
-    status = sss_cli_check_socket(errnop, socket_name, timeout);
+    status = sss_cli_check_socket(sock, errnop, socket_name, timeout);
     if (status != SSS_STATUS_SUCCESS) {
         ret = PAM_SERVICE_ERR;
         goto out;
     }
 
-    error = check_server_cred(sss_cli_sd);
+    error = check_server_cred(sock->sd);
     if (error != 0) {
-        sss_cli_close_socket();
+        sss_cli_close_sock(sock);
         *errnop = error;
         ret = PAM_SERVICE_ERR;
         goto out;
     }
 
-    status = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                           errnop);
+    status = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                           repbuf, replen, errnop);
     if (status == SSS_STATUS_UNAVAIL && *errnop == EPIPE) {
         /* try reopen socket */
-        status = sss_cli_check_socket(errnop, socket_name, timeout);
+        status = sss_cli_check_socket(sock, errnop, socket_name, timeout);
         if (status != SSS_STATUS_SUCCESS) {
             ret = PAM_SERVICE_ERR;
             goto out;
         }
 
         /* and make request one more time */
-        status = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                               errnop);
+        status = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                               repbuf, replen, errnop);
     }
 
     if (status == SSS_STATUS_SUCCESS) {
@@ -1000,10 +1287,7 @@ void sss_pam_close_fd(void)
 {
     sss_pam_lock();
 
-    if (sss_cli_sd != -1) {
-        close(sss_cli_sd);
-        sss_cli_sd = -1;
-    }
+    sss_cli_close_sock(&sss_cli_shared);
 
     sss_pam_unlock();
 }
@@ -1016,25 +1300,26 @@ sss_cli_make_request_with_checks(enum sss_cli_command cmd,
                                  int *errnop,
                                  const char *socket_name)
 {
+    struct sss_cli_sock *sock = &sss_cli_shared;
     enum sss_status ret = SSS_STATUS_UNAVAIL;
 
-    ret = sss_cli_check_socket(errnop, socket_name, timeout);
+    ret = sss_cli_check_socket(sock, errnop, socket_name, timeout);
     if (ret != SSS_STATUS_SUCCESS) {
         return SSS_STATUS_UNAVAIL;
     }
 
-    ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                        errnop);
+    ret = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                        repbuf, replen, errnop);
     if (ret == SSS_STATUS_UNAVAIL && *errnop == EPIPE) {
         /* try reopen socket */
-        ret = sss_cli_check_socket(errnop, socket_name, timeout);
+        ret = sss_cli_check_socket(sock, errnop, socket_name, timeout);
         if (ret != SSS_STATUS_SUCCESS) {
             return SSS_STATUS_UNAVAIL;
         }
 
         /* and make request one more time */
-        ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                            errnop);
+        ret = sss_cli_make_request_nochecks(sock, cmd, rd, timeout,
+                                            repbuf, replen, errnop);
     }
 
     return ret;
@@ -1176,6 +1461,20 @@ void sss_nss_unlock(void)
     sss_mt_unlock(&sss_nss_mtx);
 }
 
+/* Lookups do not need the lock if each thread has its own socket */
+void sss_nss_lookup_lock(void)
+{
+    if (!sss_cli_use_thread_sockets()) {
+        sss_mt_lock(&sss_nss_mtx);
+    }
+}
+void sss_nss_lookup_unlock(void)
+{
+    if (!sss_cli_use_thread_sockets()) {
+        sss_mt_unlock(&sss_nss_mtx);
+    }
+}
+
 /* NSS mutex wrappers */
 void sss_pam_lock(void)
 {
@@ -1211,6 +1510,8 @@ void sss_pac_unlock(void)
 /* sorry no mutexes available */
 void sss_nss_lock(void) { return; }
 void sss_nss_unlock(void) { return; }
+void sss_nss_lookup_lock(void) { return; }
+void sss_nss_lookup_unlock(void) { return; }
 void sss_pam_lock(void) { return; }
 void sss_pam_unlock(void) { return; }
 void sss_nss_mc_lock(void) { return; }
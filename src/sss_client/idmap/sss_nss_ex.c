@@ -23,6 +23,9 @@
 */
 #include <stdlib.h>
 #include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
 
 #include <sys/param.h> /* for MIN() */
 
@@ -109,11 +112,16 @@ static int check_flags(struct nss_input *inp, uint32_t flags,
                        bool *skip_mc, bool *skip_data)
 {
     bool no_data = false;
+    uint32_t cache_flags;
 
-    /* SSS_NSS_EX_FLAG_NO_CACHE and SSS_NSS_EX_FLAG_INVALIDATE_CACHE are
+    /* SSS_NSS_EX_FLAG_NO_CACHE, SSS_NSS_EX_FLAG_INVALIDATE_CACHE,
+     * SSS_NSS_EX_FLAG_CACHE_ONLY and SSS_NSS_EX_FLAG_ALLOW_STALE are
      * mutually exclusive */
-    if ((flags & SSS_NSS_EX_FLAG_NO_CACHE) != 0
-            && (flags & SSS_NSS_EX_FLAG_INVALIDATE_CACHE) != 0) {
+    cache_flags = flags & (SSS_NSS_EX_FLAG_NO_CACHE
+                           | SSS_NSS_EX_FLAG_INVALIDATE_CACHE
+                           | SSS_NSS_EX_FLAG_CACHE_ONLY
+                           | SSS_NSS_EX_FLAG_ALLOW_STALE);
+    if ((cache_flags & (cache_flags - 1)) != 0) {
         return EINVAL;
     }
 
@@ -166,75 +174,19 @@ static int check_flags(struct nss_input *inp, uint32_t flags,
     return 0;
 }
 
-int sss_get_ex(struct nss_input *inp, uint32_t flags, unsigned int timeout)
+/* Reads the reply to the request into the result buffers of inp */
+static int sss_nss_ex_read_reply(struct nss_input *inp, bool skip_data,
+                                 uint8_t *repbuf, size_t replen)
 {
-    uint8_t *repbuf = NULL;
-    size_t replen;
     size_t len;
     uint32_t num_results;
-    int ret;
-    int time_left;
-    int errnop;
     size_t c;
     gid_t *new_groups;
     size_t idx;
-    bool skip_mc = false;
-    bool skip_data = false;
-
-    ret = check_flags(inp, flags, &skip_mc, &skip_data);
-    if (ret != 0) {
-        return ret;
-    }
-
-    if (!skip_mc && !skip_data) {
-        ret = sss_nss_mc_get(inp);
-        switch (ret) {
-        case 0:
-            return 0;
-        case ERANGE:
-            return ERANGE;
-        case ENOENT:
-            /* fall through, we need to actively ask the parent
-             * if no entry is found */
-            break;
-        default:
-            /* if using the mmapped cache failed,
-             * fall back to socket based comms */
-            break;
-        }
-    }
-
-    ret = sss_nss_timedlock(timeout, &time_left);
-    if (ret != 0) {
-        return ret;
-    }
-
-    if (!skip_mc && !skip_data) {
-        /* previous thread might already initialize entry in mmap cache */
-        ret = sss_nss_mc_get(inp);
-        switch (ret) {
-        case 0:
-            ret = 0;
-            goto out;
-        case ERANGE:
-            ret = ERANGE;
-            goto out;
-        case ENOENT:
-            /* fall through, we need to actively ask the parent
-             * if no entry is found */
-            break;
-        default:
-            /* if using the mmapped cache failed,
-             * fall back to socket based comms */
-            break;
-        }
-    }
+    int ret;
 
-    ret = sss_nss_make_request_timeout(inp->cmd, &inp->rd, time_left,
-                                       &repbuf, &replen, &errnop);
-    if (ret != NSS_STATUS_SUCCESS) {
-        ret = errnop != 0 ? errnop : EIO;
-        goto out;
+    if (repbuf == NULL || replen < 2 * sizeof(uint32_t)) {
+        return EBADMSG;
     }
 
     /* Get number of results from repbuf. */
@@ -242,14 +194,12 @@ int sss_get_ex(struct nss_input *inp, uint32_t flags, unsigned int timeout)
 
     /* no results if not found */
     if (num_results == 0) {
-        ret = ENOENT;
-        goto out;
+        return ENOENT;
     }
 
     if (skip_data) {
         /* No data requested, just return the return code */
-        ret = 0;
-        goto out;
+        return 0;
     }
 
     if (inp->cmd == SSS_NSS_INITGR || inp->cmd == SSS_NSS_INITGR_EX) {
@@ -259,8 +209,7 @@ int sss_get_ex(struct nss_input *inp, uint32_t flags, unsigned int timeout)
                                  (num_results + *(inp->result.initgrrep.start))
                                     * sizeof(gid_t));
             if (new_groups == NULL) {
-                ret = ENOMEM;
-                goto out;
+                return ENOMEM;
             }
 
             inp->result.initgrrep.groups = new_groups;
@@ -276,14 +225,12 @@ int sss_get_ex(struct nss_input *inp, uint32_t flags, unsigned int timeout)
             *(inp->result.initgrrep.start) += 1;
         }
 
-        ret = 0;
-        goto out;
+        return 0;
     }
 
     /* only 1 result is accepted for this function */
     if (num_results != 1) {
-        ret = EBADMSG;
-        goto out;
+        return EBADMSG;
     }
 
     len = replen - 8;
@@ -304,16 +251,78 @@ int sss_get_ex(struct nss_input *inp, uint32_t flags, unsigned int timeout)
     default:
         ret = EINVAL;
     }
+
+    return ret;
+}
+
+int sss_get_ex(struct nss_input *inp, uint32_t flags, unsigned int timeout)
+{
+    uint8_t *repbuf = NULL;
+    size_t replen;
+    int ret;
+    int time_left;
+    int errnop;
+    bool skip_mc = false;
+    bool skip_data = false;
+
+    ret = check_flags(inp, flags, &skip_mc, &skip_data);
     if (ret != 0) {
-        goto out;
+        return ret;
     }
 
-    if (len == 0) {
-        /* no extra data */
-        ret = 0;
+    if (!skip_mc && !skip_data) {
+        ret = sss_nss_mc_get(inp);
+        switch (ret) {
+        case 0:
+            return 0;
+        case ERANGE:
+            return ERANGE;
+        case ENOENT:
+            /* fall through, we need to actively ask the parent
+             * if no entry is found */
+            break;
+        default:
+            /* if using the mmapped cache failed,
+             * fall back to socket based comms */
+            break;
+        }
+    }
+
+    ret = sss_nss_timedlock(timeout, &time_left);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (!skip_mc && !skip_data) {
+        /* previous thread might already initialize entry in mmap cache */
+        ret = sss_nss_mc_get(inp);
+        switch (ret) {
+        case 0:
+            ret = 0;
+            goto out;
+        case ERANGE:
+            ret = ERANGE;
+            goto out;
+        case ENOENT:
+            /* fall through, we need to actively ask the parent
+             * if no entry is found */
+            break;
+        default:
+            /* if using the mmapped cache failed,
+             * fall back to socket based comms */
+            break;
+        }
+    }
+
+    ret = sss_nss_make_request_timeout(inp->cmd, &inp->rd, time_left,
+                                       &repbuf, &replen, &errnop);
+    if (ret != NSS_STATUS_SUCCESS) {
+        ret = errnop != 0 ? errnop : EIO;
         goto out;
     }
 
+    ret = sss_nss_ex_read_reply(inp, skip_data, repbuf, replen);
+
 out:
     free(repbuf);
 
@@ -529,3 +538,1514 @@ int sss_nss_getgrouplist_timeout(const char *name, gid_t group,
 
     return ret;
 }
+
+/* Reads the reply to SSS_NSS_GETPWNAM_INITGR, the SSS_NSS_GETPWNAM_EX reply
+ * prefixed with its length followed by the SSS_NSS_INITGR_EX reply */
+static int sss_nss_pw_initgr_read_reply(struct nss_input *pw_inp,
+                                        struct nss_input *gr_inp,
+                                        bool skip_data,
+                                        uint8_t *repbuf, size_t replen)
+{
+    uint32_t pw_len;
+    int ret;
+
+    if (repbuf == NULL || replen < sizeof(uint32_t)) {
+        return EBADMSG;
+    }
+
+    SAFEALIGN_COPY_UINT32(&pw_len, repbuf, NULL);
+    if (pw_len == 0) {
+        /* empty reply, the user was not found */
+        return ENOENT;
+    }
+
+    if (pw_len > replen - sizeof(uint32_t)) {
+        return EBADMSG;
+    }
+
+    ret = sss_nss_ex_read_reply(pw_inp, skip_data, repbuf + sizeof(uint32_t),
+                                pw_len);
+    if (ret != 0 || skip_data) {
+        return ret;
+    }
+
+    return sss_nss_ex_read_reply(gr_inp, false,
+                                 repbuf + sizeof(uint32_t) + pw_len,
+                                 replen - sizeof(uint32_t) - pw_len);
+}
+
+static int sss_nss_pw_initgr_mc_get(struct nss_input *pw_inp,
+                                    struct nss_input *gr_inp)
+{
+    long int start;
+    int ret;
+
+    ret = sss_nss_mc_get(pw_inp);
+    if (ret != 0) {
+        return ret;
+    }
+
+    start = *(gr_inp->result.initgrrep.start);
+    ret = sss_nss_mc_get(gr_inp);
+    if (ret != 0) {
+        /* a partial result is overwritten by the reply of SSSD */
+        *(gr_inp->result.initgrrep.start) = start;
+    }
+
+    return ret;
+}
+
+static int sss_nss_pw_initgr_get(struct nss_input *pw_inp,
+                                 struct nss_input *gr_inp,
+                                 uint32_t flags, unsigned int timeout)
+{
+    uint8_t *repbuf = NULL;
+    size_t replen;
+    int ret;
+    int time_left;
+    int errnop;
+    bool skip_mc = false;
+    bool skip_data = false;
+    bool skip_gr_data = false;
+
+    ret = check_flags(pw_inp, flags, &skip_mc, &skip_data);
+    if (ret == 0) {
+        ret = check_flags(gr_inp, flags, &skip_mc, &skip_gr_data);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (!skip_mc && !skip_data) {
+        ret = sss_nss_pw_initgr_mc_get(pw_inp, gr_inp);
+        if (ret == 0 || ret == ERANGE) {
+            return ret;
+        }
+        /* otherwise ask SSSD */
+    }
+
+    ret = sss_nss_timedlock(timeout, &time_left);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (!skip_mc && !skip_data) {
+        /* previous thread might already initialize entries in mmap cache */
+        ret = sss_nss_pw_initgr_mc_get(pw_inp, gr_inp);
+        if (ret == 0 || ret == ERANGE) {
+            goto out;
+        }
+    }
+
+    ret = sss_nss_make_request_timeout(SSS_NSS_GETPWNAM_INITGR, &pw_inp->rd,
+                                       time_left, &repbuf, &replen, &errnop);
+    if (ret != NSS_STATUS_SUCCESS) {
+        ret = errnop != 0 ? errnop : EIO;
+        goto out;
+    }
+
+    ret = sss_nss_pw_initgr_read_reply(pw_inp, gr_inp, skip_data,
+                                       repbuf, replen);
+
+out:
+    free(repbuf);
+
+    sss_nss_unlock();
+    return ret;
+}
+
+int sss_nss_getpwnam_grouplist_timeout(const char *name, struct passwd *pwd,
+                                       char *buffer, size_t buflen,
+                                       struct passwd **result,
+                                       gid_t *groups, int *ngroups,
+                                       uint32_t flags, unsigned int timeout)
+{
+    int ret;
+    long int new_ngroups;
+    long int start = 1;
+    struct nss_input pw_inp = {
+        .input.name = name,
+        .cmd = SSS_NSS_GETPWNAM_EX,
+        .result.pwrep.result = pwd,
+        .result.pwrep.buffer = buffer,
+        .result.pwrep.buflen = buflen};
+    struct nss_input gr_inp = {
+        .input.name = name,
+        .cmd = SSS_NSS_INITGR_EX};
+
+    if (result != NULL) {
+        *result = NULL;
+    }
+
+    if (ngroups == NULL || (*ngroups > 0 && groups == NULL)) {
+        return EINVAL;
+    }
+
+    ret = make_name_flag_req_data(name, flags, &pw_inp.rd);
+    if (ret != 0) {
+        return ret;
+    }
+
+    new_ngroups = MAX(1, *ngroups);
+    gr_inp.result.initgrrep.groups = malloc(new_ngroups * sizeof(gid_t));
+    if (gr_inp.result.initgrrep.groups == NULL) {
+        free(discard_const(pw_inp.rd.data));
+        return ENOMEM;
+    }
+    gr_inp.result.initgrrep.ngroups = &new_ngroups;
+    gr_inp.result.initgrrep.start = &start;
+
+    /* gr_inp.result.initgrrep.groups, gr_inp.result.initgrrep.ngroups and
+     * gr_inp.result.initgrrep.start might be modified */
+    ret = sss_nss_pw_initgr_get(&pw_inp, &gr_inp, flags, timeout);
+    free(discard_const(pw_inp.rd.data));
+    if (ret != 0) {
+        free(gr_inp.result.initgrrep.groups);
+        return ret;
+    }
+
+    if (buffer == NULL || buflen == 0) {
+        /* only allowed with SSS_NSS_EX_FLAG_INVALIDATE_CACHE, no data */
+        free(gr_inp.result.initgrrep.groups);
+        *ngroups = 0;
+        return 0;
+    }
+
+    if (result != NULL) {
+        *result = pw_inp.result.pwrep.result;
+    }
+
+    /* the primary group comes first as with getgrouplist(3) */
+    gr_inp.result.initgrrep.groups[0] = pwd->pw_gid;
+    memcpy(groups, gr_inp.result.initgrrep.groups,
+           MIN(*ngroups, start) * sizeof(gid_t));
+    free(gr_inp.result.initgrrep.groups);
+
+    if (start > *ngroups) {
+        ret = ERANGE;
+    } else {
+        ret = 0;
+    }
+    *ngroups = start;
+
+    return ret;
+}
+
+#define MULTI_MC_BUFLEN 4096
+
+/* Returns the name of the user or group in a record of a
+ * SSS_NSS_GETPWENT or SSS_NSS_GETGRENT reply and moves the offset to the
+ * next record */
+static int sss_nss_multi_next_record(enum sss_cli_command cmd,
+                                     uint8_t *buf, size_t len, size_t *_ofs,
+                                     uint32_t *_id, const char **_name)
+{
+    size_t ofs = *_ofs;
+    uint32_t num_strings;
+    uint32_t num_members;
+    const char *name = NULL;
+    uint8_t *end;
+    uint32_t id;
+    uint32_t c;
+
+    if (len - ofs < 2 * sizeof(uint32_t)) {
+        return EBADMSG;
+    }
+
+    SAFEALIGN_COPY_UINT32(&id, buf + ofs, &ofs);
+    if (cmd == SSS_NSS_GETPWUID_MULTI) {
+        /* gid, then name, passwd, gecos, dir and shell */
+        ofs += sizeof(uint32_t);
+        num_strings = 5;
+    } else {
+        /* number of members, then name, passwd and the members */
+        SAFEALIGN_COPY_UINT32(&num_members, buf + ofs, &ofs);
+        if (num_members > len) {
+            return EBADMSG;
+        }
+        num_strings = 2 + num_members;
+    }
+
+    for (c = 0; c < num_strings; c++) {
+        end = memchr(buf + ofs, '\0', len - ofs);
+        if (end == NULL) {
+            return EBADMSG;
+        }
+        if (c == 0) {
+            name = (const char *)(buf + ofs);
+        }
+        ofs = end - buf + 1;
+    }
+
+    *_ofs = ofs;
+    *_id = id;
+    *_name = name;
+    return 0;
+}
+
+static int sss_nss_get_multi_mc(enum sss_cli_command cmd, uint32_t id,
+                                char *buffer, char **_name)
+{
+    struct passwd pwd;
+    struct group grp;
+    const char *name;
+    int ret;
+
+    if (cmd == SSS_NSS_GETPWUID_MULTI) {
+        ret = sss_nss_mc_getpwuid(id, &pwd, buffer, MULTI_MC_BUFLEN);
+        name = pwd.pw_name;
+    } else {
+        ret = sss_nss_mc_getgrgid(id, &grp, buffer, MULTI_MC_BUFLEN);
+        name = grp.gr_name;
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    *_name = strdup(name);
+    if (*_name == NULL) {
+        return ENOMEM;
+    }
+
+    return 0;
+}
+
+/* Sends the IDs which were not found in the memory cache, at most
+ * SSS_NSS_MULTI_MAX_IDS at once, and stores the names of the results.
+ * The IDs start at the second element of req_buf, the first one is
+ * set to their number. */
+static int sss_nss_get_multi_request(enum sss_cli_command cmd,
+                                     const uint32_t *ids, size_t count,
+                                     uint32_t *req_buf, size_t num_req_ids,
+                                     int timeout, char **names)
+{
+    struct sss_cli_req_data rd;
+    uint8_t *repbuf = NULL;
+    size_t replen;
+    uint32_t num_results;
+    const char *name;
+    uint32_t id;
+    size_t ofs;
+    size_t c;
+    size_t i;
+    int errnop;
+    int ret;
+
+    req_buf[0] = num_req_ids;
+    rd.len = (num_req_ids + 1) * sizeof(uint32_t);
+    rd.data = req_buf;
+
+    ret = sss_nss_make_request_timeout(cmd, &rd, timeout,
+                                       &repbuf, &replen, &errnop);
+    if (ret != NSS_STATUS_SUCCESS) {
+        return errnop != 0 ? errnop : EIO;
+    }
+
+    if (repbuf == NULL || replen < 2 * sizeof(uint32_t)) {
+        ret = EBADMSG;
+        goto done;
+    }
+
+    SAFEALIGN_COPY_UINT32(&num_results, repbuf, NULL);
+    ofs = 2 * sizeof(uint32_t);
+
+    for (c = 0; c < num_results; c++) {
+        ret = sss_nss_multi_next_record(cmd, repbuf, replen, &ofs,
+                                        &id, &name);
+        if (ret != 0) {
+            goto done;
+        }
+
+        /* the same ID may be requested more than once */
+        for (i = 0; i < count; i++) {
+            if (ids[i] != id || names[i] != NULL) {
+                continue;
+            }
+
+            names[i] = strdup(name);
+            if (names[i] == NULL) {
+                ret = ENOMEM;
+                goto done;
+            }
+        }
+    }
+
+    ret = 0;
+
+done:
+    free(repbuf);
+    return ret;
+}
+
+static int sss_nss_get_multi(enum sss_cli_command cmd,
+                             const uint32_t *ids, size_t count,
+                             unsigned int timeout, char ***_names)
+{
+    char **names;
+    char *buffer;
+    uint32_t *req_buf;
+    uint32_t *req_ids;
+    size_t num_req_ids;
+    size_t i;
+    size_t j;
+    int time_left;
+    int ret;
+
+    if (ids == NULL || count == 0 || _names == NULL) {
+        return EINVAL;
+    }
+
+    names = calloc(count, sizeof(char *));
+    buffer = malloc(MULTI_MC_BUFLEN);
+    /* room for the count in front of the IDs */
+    req_buf = malloc((SSS_NSS_MULTI_MAX_IDS + 1) * sizeof(uint32_t));
+    if (names == NULL || buffer == NULL || req_buf == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    req_ids = req_buf + 1;
+
+    /* Entries found in the memory cache need no request. */
+    for (i = 0; i < count; i++) {
+        ret = sss_nss_get_multi_mc(cmd, ids[i], buffer, &names[i]);
+        if (ret == ENOMEM) {
+            goto done;
+        }
+    }
+
+    ret = sss_nss_timedlock(timeout, &time_left);
+    if (ret != 0) {
+        goto done;
+    }
+
+    num_req_ids = 0;
+    for (i = 0; i < count; i++) {
+        if (names[i] != NULL) {
+            continue;
+        }
+
+        for (j = 0; j < num_req_ids; j++) {
+            if (req_ids[j] == ids[i]) {
+                break;
+            }
+        }
+        if (j < num_req_ids) {
+            continue;
+        }
+
+        req_ids[num_req_ids++] = ids[i];
+        if (num_req_ids == SSS_NSS_MULTI_MAX_IDS) {
+            ret = sss_nss_get_multi_request(cmd, ids, count, req_buf,
+                                            num_req_ids, time_left, names);
+            if (ret != 0) {
+                break;
+            }
+            num_req_ids = 0;
+        }
+    }
+
+    if (ret == 0 && num_req_ids > 0) {
+        ret = sss_nss_get_multi_request(cmd, ids, count, req_buf,
+                                        num_req_ids, time_left, names);
+    }
+
+    sss_nss_unlock();
+
+done:
+    free(buffer);
+    free(req_buf);
+
+    if (ret != 0) {
+        if (names != NULL) {
+            for (i = 0; i < count; i++) {
+                free(names[i]);
+            }
+            free(names);
+        }
+        return ret;
+    }
+
+    *_names = names;
+    return 0;
+}
+
+int sss_nss_getnamebyuid_multi_timeout(const uint32_t *uids, size_t count,
+                                       unsigned int timeout, char ***names)
+{
+    return sss_nss_get_multi(SSS_NSS_GETPWUID_MULTI, uids, count, timeout,
+                             names);
+}
+
+int sss_nss_getnamebygid_multi_timeout(const uint32_t *gids, size_t count,
+                                       unsigned int timeout, char ***names)
+{
+    return sss_nss_get_multi(SSS_NSS_GETGRGID_MULTI, gids, count, timeout,
+                             names);
+}
+
+/* The SID memory cache maps names to SIDs, an ID is found in it if the name
+ * of its user or group is in the passwd or group memory cache. Users are
+ * tried first like SSSD does for SSS_NSS_GETSIDBYID. */
+static int sss_nss_sid_multi_mc_by_id(uint32_t id, enum sss_id_type id_type,
+                                      char *buffer, char **_sid,
+                                      enum sss_id_type *_type)
+{
+    struct passwd pwd;
+    struct group grp;
+    uint32_t mc_type;
+    int ret = ENOENT;
+
+    if (id_type != SSS_ID_TYPE_GID) {
+        ret = sss_nss_mc_getpwuid(id, &pwd, buffer, MULTI_MC_BUFLEN);
+        if (ret == 0) {
+            ret = sss_nss_mc_getsidbyname(pwd.pw_name, strlen(pwd.pw_name),
+                                          _sid, &mc_type);
+            if (ret == 0) {
+                *_type = mc_type;
+                return 0;
+            }
+            /* SSSD would return the SID of the user, not of a group */
+            return ret;
+        }
+    }
+
+    if (id_type != SSS_ID_TYPE_UID) {
+        ret = sss_nss_mc_getgrgid(id, &grp, buffer, MULTI_MC_BUFLEN);
+        if (ret == 0) {
+            ret = sss_nss_mc_getsidbyname(grp.gr_name, strlen(grp.gr_name),
+                                          _sid, &mc_type);
+            if (ret == 0) {
+                *_type = mc_type;
+                return 0;
+            }
+        }
+    }
+
+    return ret;
+}
+
+static int sss_nss_sid_multi_mc_by_sid(const char *sid, char *buffer,
+                                       uint32_t *_id, enum sss_id_type *_type)
+{
+    struct passwd pwd;
+    struct group grp;
+    uint32_t mc_type;
+    char *name;
+    int ret;
+
+    ret = sss_nss_mc_getnamebysid(sid, strlen(sid), &name, &mc_type);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (mc_type == SSS_ID_TYPE_GID) {
+        ret = sss_nss_mc_getgrnam(name, strlen(name), &grp, buffer,
+                                  MULTI_MC_BUFLEN);
+        if (ret == 0) {
+            *_id = grp.gr_gid;
+        }
+    } else {
+        ret = sss_nss_mc_getpwnam(name, strlen(name), &pwd, buffer,
+                                  MULTI_MC_BUFLEN);
+        if (ret == 0) {
+            *_id = pwd.pw_uid;
+        }
+    }
+    free(name);
+    if (ret != 0) {
+        return ret;
+    }
+
+    *_type = mc_type;
+    return 0;
+}
+
+/* Sends one SSS_NSS_GETSIDBYID_MULTI, SSS_NSS_GETIDBYSID_MULTI,
+ * SSS_NSS_GETSIDBYNAME_MULTI or SSS_NSS_GETNAMEBYSID_MULTI request, its body
+ * starts with room for the count of the num_req entries. Entry j of the
+ * request belongs to element req_idx[j] of the results. The results are
+ * strings, i.e. SIDs or names, except for SSS_NSS_GETIDBYSID_MULTI. */
+static int sss_nss_sid_multi_request(enum sss_cli_command cmd,
+                                     uint8_t *req_buf, size_t req_len,
+                                     const size_t *req_idx, uint32_t num_req,
+                                     int timeout, char **strs, uint32_t *ids,
+                                     enum sss_id_type *types)
+{
+    struct sss_cli_req_data rd;
+    uint8_t *repbuf = NULL;
+    size_t replen;
+    uint32_t num_results;
+    uint32_t index;
+    uint32_t type;
+    uint32_t id;
+    uint8_t *end;
+    size_t ofs;
+    size_t c;
+    size_t i;
+    int errnop;
+    int ret;
+
+    SAFEALIGN_COPY_UINT32(req_buf, &num_req, NULL);
+    rd.len = req_len;
+    rd.data = req_buf;
+
+    ret = sss_nss_make_request_timeout(cmd, &rd, timeout,
+                                       &repbuf, &replen, &errnop);
+    if (ret != NSS_STATUS_SUCCESS) {
+        return errnop != 0 ? errnop : EIO;
+    }
+
+    if (repbuf == NULL || replen < 2 * sizeof(uint32_t)) {
+        ret = EBADMSG;
+        goto done;
+    }
+
+    SAFEALIGN_COPY_UINT32(&num_results, repbuf, NULL);
+    ofs = 2 * sizeof(uint32_t);
+
+    /* index and type, then the string or the ID */
+    for (c = 0; c < num_results; c++) {
+        if (replen - ofs < 3 * sizeof(uint32_t)) {
+            ret = EBADMSG;
+            goto done;
+        }
+
+        SAFEALIGN_COPY_UINT32(&index, repbuf + ofs, &ofs);
+        SAFEALIGN_COPY_UINT32(&type, repbuf + ofs, &ofs);
+        if (index >= num_req) {
+            ret = EBADMSG;
+            goto done;
+        }
+        i = req_idx[index];
+
+        if (cmd != SSS_NSS_GETIDBYSID_MULTI) {
+            end = memchr(repbuf + ofs, '\0', replen - ofs);
+            if (end == NULL) {
+                ret = EBADMSG;
+                goto done;
+            }
+
+            free(strs[i]);
+            strs[i] = strdup((const char *)(repbuf + ofs));
+            if (strs[i] == NULL) {
+                ret = ENOMEM;
+                goto done;
+            }
+            ofs = end - repbuf + 1;
+        } else {
+            SAFEALIGN_COPY_UINT32(&id, repbuf + ofs, &ofs);
+            ids[i] = id;
+        }
+        types[i] = type;
+    }
+
+    ret = 0;
+
+done:
+    free(repbuf);
+    return ret;
+}
+
+/* Sends the keys, i.e. SIDs or names, which are not resolved yet in as few
+ * requests as possible. A key is resolved if it has a string result or, if
+ * the results are IDs, a type. The caller must hold the lock. */
+static int sss_nss_str_multi_requests(enum sss_cli_command cmd,
+                                      const char * const *keys, size_t count,
+                                      int time_left, char **strs,
+                                      uint32_t *ids, enum sss_id_type *types)
+{
+    uint8_t *req_buf;
+    size_t req_idx[SSS_NSS_MULTI_MAX_IDS];
+    uint32_t num_req;
+    size_t req_len;
+    size_t len;
+    size_t ofs;
+    size_t i;
+    size_t j;
+    int ret = 0;
+
+    i = 0;
+    while (i < count) {
+        /* the count, then the zero terminated keys */
+        num_req = 0;
+        req_len = sizeof(uint32_t);
+        for (j = i; j < count && num_req < SSS_NSS_MULTI_MAX_IDS; j++) {
+            if (strs != NULL ? strs[j] != NULL
+                             : types[j] != SSS_ID_TYPE_NOT_SPECIFIED) {
+                continue;
+            }
+            req_len += strlen(keys[j]) + 1;
+            req_idx[num_req++] = j;
+        }
+        i = j;
+
+        if (num_req == 0) {
+            break;
+        }
+
+        req_buf = malloc(req_len);
+        if (req_buf == NULL) {
+            return ENOMEM;
+        }
+
+        ofs = sizeof(uint32_t);
+        for (j = 0; j < num_req; j++) {
+            len = strlen(keys[req_idx[j]]) + 1;
+            memcpy(req_buf + ofs, keys[req_idx[j]], len);
+            ofs += len;
+        }
+
+        ret = sss_nss_sid_multi_request(cmd, req_buf, req_len, req_idx,
+                                        num_req, time_left, strs, ids, types);
+        free(req_buf);
+        if (ret != 0) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+int sss_nss_getsidbyid_multi_timeout(const uint32_t *ids,
+                                     const enum sss_id_type *id_types,
+                                     size_t count, unsigned int timeout,
+                                     char ***_sids,
+                                     enum sss_id_type **_types)
+{
+    enum sss_id_type *types;
+    char **sids;
+    char *buffer;
+    uint8_t *req_buf;
+    size_t *req_idx;
+    uint32_t num_req;
+    uint32_t id_type;
+    size_t ofs;
+    size_t i;
+    int time_left;
+    int ret;
+
+    if (ids == NULL || count == 0 || _sids == NULL || _types == NULL) {
+        return EINVAL;
+    }
+
+    sids = calloc(count, sizeof(char *));
+    types = calloc(count, sizeof(enum sss_id_type));
+    buffer = malloc(MULTI_MC_BUFLEN);
+    /* the count, then pairs of ID and ID type */
+    req_buf = malloc((2 * SSS_NSS_MULTI_MAX_IDS + 1) * sizeof(uint32_t));
+    req_idx = malloc(SSS_NSS_MULTI_MAX_IDS * sizeof(size_t));
+    if (sids == NULL || types == NULL || buffer == NULL || req_buf == NULL
+            || req_idx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* Entries found in the memory caches need no request. */
+    for (i = 0; i < count; i++) {
+        ret = sss_nss_sid_multi_mc_by_id(ids[i],
+                                         id_types != NULL ? id_types[i]
+                                                  : SSS_ID_TYPE_NOT_SPECIFIED,
+                                         buffer, &sids[i], &types[i]);
+        if (ret == ENOMEM) {
+            goto done;
+        }
+    }
+
+    if (timeout == NO_TIMEOUT) {
+        sss_nss_lock();
+        time_left = SSS_CLI_SOCKET_TIMEOUT;
+    } else {
+        ret = sss_nss_timedlock(timeout, &time_left);
+        if (ret != 0) {
+            goto done;
+        }
+    }
+
+    num_req = 0;
+    ofs = sizeof(uint32_t);
+    for (i = 0; i < count; i++) {
+        if (sids[i] != NULL) {
+            continue;
+        }
+
+        id_type = id_types != NULL ? id_types[i] : SSS_ID_TYPE_NOT_SPECIFIED;
+        SAFEALIGN_COPY_UINT32(req_buf + ofs, &ids[i], &ofs);
+        SAFEALIGN_COPY_UINT32(req_buf + ofs, &id_type, &ofs);
+        req_idx[num_req++] = i;
+
+        if (num_req == SSS_NSS_MULTI_MAX_IDS) {
+            ret = sss_nss_sid_multi_request(SSS_NSS_GETSIDBYID_MULTI,
+                                            req_buf, ofs, req_idx, num_req,
+                                            time_left, sids, NULL, types);
+            if (ret != 0) {
+                break;
+            }
+            num_req = 0;
+            ofs = sizeof(uint32_t);
+        }
+    }
+
+    if (ret == 0 && num_req > 0) {
+        ret = sss_nss_sid_multi_request(SSS_NSS_GETSIDBYID_MULTI,
+                                        req_buf, ofs, req_idx, num_req,
+                                        time_left, sids, NULL, types);
+    }
+
+    sss_nss_unlock();
+
+done:
+    free(buffer);
+    free(req_buf);
+    free(req_idx);
+
+    if (ret != 0) {
+        if (sids != NULL) {
+            for (i = 0; i < count; i++) {
+                free(sids[i]);
+            }
+            free(sids);
+        }
+        free(types);
+        return ret;
+    }
+
+    *_sids = sids;
+    *_types = types;
+    return 0;
+}
+
+int sss_nss_getidbysid_multi_timeout(const char * const *sids, size_t count,
+                                     unsigned int timeout, uint32_t **_ids,
+                                     enum sss_id_type **_types)
+{
+    enum sss_id_type *types;
+    uint32_t *ids;
+    char *buffer;
+    size_t i;
+    int time_left;
+    int ret;
+
+    if (sids == NULL || count == 0 || _ids == NULL || _types == NULL) {
+        return EINVAL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (sids[i] == NULL || *sids[i] == '\0') {
+            return EINVAL;
+        }
+    }
+
+    ids = calloc(count, sizeof(uint32_t));
+    types = calloc(count, sizeof(enum sss_id_type));
+    buffer = malloc(MULTI_MC_BUFLEN);
+    if (ids == NULL || types == NULL || buffer == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* Entries found in the memory caches need no request, SSSD never
+     * returns SSS_ID_TYPE_NOT_SPECIFIED for a found object. */
+    for (i = 0; i < count; i++) {
+        ret = sss_nss_sid_multi_mc_by_sid(sids[i], buffer, &ids[i],
+                                          &types[i]);
+        if (ret == ENOMEM) {
+            goto done;
+        }
+    }
+
+    if (timeout == NO_TIMEOUT) {
+        sss_nss_lock();
+        time_left = SSS_CLI_SOCKET_TIMEOUT;
+    } else {
+        ret = sss_nss_timedlock(timeout, &time_left);
+        if (ret != 0) {
+            goto done;
+        }
+    }
+
+    ret = sss_nss_str_multi_requests(SSS_NSS_GETIDBYSID_MULTI, sids, count,
+                                     time_left, NULL, ids, types);
+
+    sss_nss_unlock();
+
+done:
+    free(buffer);
+
+    if (ret != 0) {
+        free(ids);
+        free(types);
+        return ret;
+    }
+
+    *_ids = ids;
+    *_types = types;
+    return 0;
+}
+
+/* The SID memory cache maps names to SIDs and back, so both directions are
+ * served from it directly. */
+static int sss_nss_str_multi(enum sss_cli_command cmd,
+                             const char * const *keys, size_t count,
+                             unsigned int timeout, char ***_strs,
+                             enum sss_id_type **_types)
+{
+    enum sss_id_type *types;
+    uint32_t mc_type;
+    char **strs;
+    size_t i;
+    int time_left;
+    int ret;
+
+    if (keys == NULL || count == 0 || _strs == NULL || _types == NULL) {
+        return EINVAL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (keys[i] == NULL || *keys[i] == '\0') {
+            return EINVAL;
+        }
+    }
+
+    strs = calloc(count, sizeof(char *));
+    types = calloc(count, sizeof(enum sss_id_type));
+    if (strs == NULL || types == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* Entries found in the memory cache need no request. */
+    for (i = 0; i < count; i++) {
+        if (cmd == SSS_NSS_GETSIDBYNAME_MULTI) {
+            ret = sss_nss_mc_getsidbyname(keys[i], strlen(keys[i]), &strs[i],
+                                          &mc_type);
+        } else {
+            ret = sss_nss_mc_getnamebysid(keys[i], strlen(keys[i]), &strs[i],
+                                          &mc_type);
+        }
+        if (ret == 0) {
+            types[i] = mc_type;
+        } else if (ret == ENOMEM) {
+            goto done;
+        }
+    }
+
+    if (timeout == NO_TIMEOUT) {
+        sss_nss_lock();
+        time_left = SSS_CLI_SOCKET_TIMEOUT;
+    } else {
+        ret = sss_nss_timedlock(timeout, &time_left);
+        if (ret != 0) {
+            goto done;
+        }
+    }
+
+    ret = sss_nss_str_multi_requests(cmd, keys, count, time_left, strs, NULL,
+                                     types);
+
+    sss_nss_unlock();
+
+done:
+    if (ret != 0) {
+        if (strs != NULL) {
+            for (i = 0; i < count; i++) {
+                free(strs[i]);
+            }
+            free(strs);
+        }
+        free(types);
+        return ret;
+    }
+
+    *_strs = strs;
+    *_types = types;
+    return 0;
+}
+
+int sss_nss_getsidbyname_multi_timeout(const char * const *fq_names,
+                                       size_t count, unsigned int timeout,
+                                       char ***sids, enum sss_id_type **types)
+{
+    return sss_nss_str_multi(SSS_NSS_GETSIDBYNAME_MULTI, fq_names, count,
+                             timeout, sids, types);
+}
+
+int sss_nss_getnamebysid_multi_timeout(const char * const *sids,
+                                       size_t count, unsigned int timeout,
+                                       char ***fq_names,
+                                       enum sss_id_type **types)
+{
+    return sss_nss_str_multi(SSS_NSS_GETNAMEBYSID_MULTI, sids, count,
+                             timeout, fq_names, types);
+}
+
+int sss_nss_getsidbyname_multi(const char * const *fq_names, size_t count,
+                               char ***sids, enum sss_id_type **types)
+{
+    return sss_nss_getsidbyname_multi_timeout(fq_names, count, NO_TIMEOUT,
+                                              sids, types);
+}
+
+int sss_nss_getnamebysid_multi(const char * const *sids, size_t count,
+                               char ***fq_names, enum sss_id_type **types)
+{
+    return sss_nss_getnamebysid_multi_timeout(sids, count, NO_TIMEOUT,
+                                              fq_names, types);
+}
+
+int sss_nss_getsidbyid_multi(const uint32_t *ids,
+                             const enum sss_id_type *id_types,
+                             size_t count, char ***sids,
+                             enum sss_id_type **types)
+{
+    return sss_nss_getsidbyid_multi_timeout(ids, id_types, count, NO_TIMEOUT,
+                                            sids, types);
+}
+
+int sss_nss_getidbysid_multi(const char * const *sids, size_t count,
+                             uint32_t **ids, enum sss_id_type **types)
+{
+    return sss_nss_getidbysid_multi_timeout(sids, count, NO_TIMEOUT, ids,
+                                            types);
+}
+
+int sss_nss_innetgr_timeout(const char *netgroup, const char *host,
+                            const char *user, const char *domain,
+                            unsigned int timeout, int *result)
+{
+    const char *fields[4] = { netgroup, host, user, domain };
+    struct sss_cli_req_data rd;
+    uint8_t *repbuf = NULL;
+    size_t replen;
+    uint32_t num_results;
+    char *req_buf;
+    size_t lens[4];
+    size_t len;
+    size_t ofs;
+    size_t i;
+    int time_left;
+    int errnop;
+    int ret;
+
+    if (netgroup == NULL || *netgroup == '\0' || result == NULL) {
+        return EINVAL;
+    }
+
+    /* All four values as NUL terminated strings, missing ones are empty. */
+    len = 0;
+    for (i = 0; i < 4; i++) {
+        lens[i] = fields[i] == NULL ? 0 : strlen(fields[i]);
+        len += lens[i] + 1;
+    }
+
+    req_buf = malloc(len);
+    if (req_buf == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0, ofs = 0; i < 4; i++) {
+        if (lens[i] > 0) {
+            memcpy(req_buf + ofs, fields[i], lens[i]);
+        }
+        req_buf[ofs + lens[i]] = '\0';
+        ofs += lens[i] + 1;
+    }
+
+    rd.len = len;
+    rd.data = req_buf;
+
+    ret = sss_nss_timedlock(timeout, &time_left);
+    if (ret != 0) {
+        goto done;
+    }
+
+    ret = sss_nss_make_request_timeout(SSS_NSS_INNETGR, &rd, time_left,
+                                       &repbuf, &replen, &errnop);
+    sss_nss_unlock();
+    if (ret != NSS_STATUS_SUCCESS) {
+        ret = errnop != 0 ? errnop : EIO;
+        goto done;
+    }
+
+    if (repbuf == NULL || replen < 2 * sizeof(uint32_t)) {
+        ret = EBADMSG;
+        goto done;
+    }
+
+    SAFEALIGN_COPY_UINT32(&num_results, repbuf, NULL);
+    *result = num_results > 0 ? 1 : 0;
+    ret = 0;
+
+done:
+    free(req_buf);
+    free(repbuf);
+    return ret;
+}
+
+enum sss_nss_async_state {
+    SSS_NSS_ASYNC_CONNECTING,
+    SSS_NSS_ASYNC_SENDING,
+    SSS_NSS_ASYNC_RECEIVING,
+    SSS_NSS_ASYNC_DONE,
+};
+
+struct sss_nss_async_req {
+    struct nss_input inp;
+    uint32_t id_req[2];
+    bool skip_data;
+
+    enum sss_nss_async_state state;
+    int fd;
+    int result;
+
+    /* the version check and the lookup are sent at once */
+    uint8_t *out;
+    size_t out_len;
+    size_t out_pos;
+    uint32_t version_tag;
+    uint32_t tag;
+    bool version_checked;
+
+    /* the reply that is currently received */
+    uint32_t header[4];
+    uint8_t *in;
+    size_t in_pos;
+};
+
+static void sss_nss_async_finish(struct sss_nss_async_req *req, int result)
+{
+    if (req->fd != -1) {
+        close(req->fd);
+        req->fd = -1;
+    }
+
+    free(req->out);
+    req->out = NULL;
+    free(req->in);
+    req->in = NULL;
+
+    req->result = result;
+    req->state = SSS_NSS_ASYNC_DONE;
+}
+
+static void sss_nss_async_add_packet(uint8_t *out, size_t *_ofs,
+                                     enum sss_cli_command cmd, uint32_t tag,
+                                     const void *data, size_t len)
+{
+    uint32_t header[4];
+
+    header[0] = SSS_NSS_HEADER_SIZE + len;
+    header[1] = cmd;
+    header[2] = 0;
+    header[3] = tag;
+
+    memcpy(out + *_ofs, header, SSS_NSS_HEADER_SIZE);
+    memcpy(out + *_ofs + SSS_NSS_HEADER_SIZE, data, len);
+    *_ofs += SSS_NSS_HEADER_SIZE + len;
+}
+
+static int sss_nss_async_send_data(struct sss_nss_async_req *req)
+{
+    ssize_t res;
+
+    while (req->out_pos < req->out_len) {
+        errno = 0;
+        res = send(req->fd, req->out + req->out_pos,
+                   req->out_len - req->out_pos, MSG_NOSIGNAL);
+        if (res == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EWOULDBLOCK ? EAGAIN : errno;
+        }
+
+        req->out_pos += res;
+    }
+
+    return 0;
+}
+
+/* Handles a complete reply, returns EAGAIN while more are expected */
+static int sss_nss_async_handle_reply(struct sss_nss_async_req *req)
+{
+    size_t len = req->header[0] - SSS_NSS_HEADER_SIZE;
+    uint32_t version;
+
+    if (req->header[2] != 0) {
+        /* server side error */
+        return req->header[2];
+    }
+
+    if (!req->version_checked) {
+        if (req->header[1] != SSS_GET_VERSION
+                || req->header[3] != req->version_tag
+                || len != sizeof(uint32_t)) {
+            return EBADMSG;
+        }
+
+        SAFEALIGN_COPY_UINT32(&version, req->in, NULL);
+        if (version != SSS_NSS_PROTOCOL_VERSION) {
+            return EFAULT;
+        }
+
+        req->version_checked = true;
+        return EAGAIN;
+    }
+
+    if (req->header[1] != req->inp.cmd || req->header[3] != req->tag) {
+        return EBADMSG;
+    }
+
+    return sss_nss_ex_read_reply(&req->inp, req->skip_data, req->in, len);
+}
+
+static int sss_nss_async_recv_data(struct sss_nss_async_req *req)
+{
+    size_t len;
+    ssize_t res;
+    int ret;
+
+    while (true) {
+        if (req->in_pos < SSS_NSS_HEADER_SIZE) {
+            len = SSS_NSS_HEADER_SIZE - req->in_pos;
+            res = read(req->fd, (uint8_t *)req->header + req->in_pos, len);
+        } else {
+            len = req->header[0] - req->in_pos;
+            res = read(req->fd, req->in + req->in_pos - SSS_NSS_HEADER_SIZE,
+                       len);
+        }
+
+        if (res == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EWOULDBLOCK ? EAGAIN : errno;
+        }
+        if (res == 0) {
+            return EPIPE;
+        }
+
+        req->in_pos += res;
+
+        if (req->in_pos == SSS_NSS_HEADER_SIZE && req->in == NULL) {
+            if (req->header[0] < SSS_NSS_HEADER_SIZE) {
+                return EBADMSG;
+            }
+
+            /* a zero sized body still needs a valid pointer */
+            req->in = malloc(req->header[0] - SSS_NSS_HEADER_SIZE + 1);
+            if (req->in == NULL) {
+                return ENOMEM;
+            }
+        }
+
+        if (req->in_pos < SSS_NSS_HEADER_SIZE
+                || req->in_pos < req->header[0]) {
+            continue;
+        }
+
+        ret = sss_nss_async_handle_reply(req);
+        if (ret != EAGAIN) {
+            return ret;
+        }
+
+        /* wait for the next reply */
+        free(req->in);
+        req->in = NULL;
+        req->in_pos = 0;
+    }
+}
+
+int sss_nss_async_process(struct sss_nss_async_req *req)
+{
+    socklen_t errnosize;
+    int error;
+    int ret;
+
+    if (req == NULL) {
+        return EINVAL;
+    }
+
+    switch (req->state) {
+    case SSS_NSS_ASYNC_CONNECTING:
+        error = 0;
+        errnosize = sizeof(error);
+        ret = getsockopt(req->fd, SOL_SOCKET, SO_ERROR, &error, &errnosize);
+        if (ret != 0 || error != 0) {
+            sss_nss_async_finish(req, ret != 0 ? errno : error);
+            return 0;
+        }
+
+        req->state = SSS_NSS_ASYNC_SENDING;
+        /* fall through */
+    case SSS_NSS_ASYNC_SENDING:
+        ret = sss_nss_async_send_data(req);
+        if (ret == EAGAIN) {
+            return EAGAIN;
+        } else if (ret != 0) {
+            sss_nss_async_finish(req, ret);
+            return 0;
+        }
+
+        req->state = SSS_NSS_ASYNC_RECEIVING;
+        /* the replies take a while, wait until the socket is readable */
+        return EAGAIN;
+    case SSS_NSS_ASYNC_RECEIVING:
+        ret = sss_nss_async_recv_data(req);
+        if (ret == EAGAIN) {
+            return EAGAIN;
+        }
+
+        sss_nss_async_finish(req, ret);
+        return 0;
+    case SSS_NSS_ASYNC_DONE:
+        return 0;
+    }
+
+    return EINVAL;
+}
+
+int sss_nss_async_get_fd(struct sss_nss_async_req *req, short *_events)
+{
+    if (req == NULL) {
+        return -1;
+    }
+
+    switch (req->state) {
+    case SSS_NSS_ASYNC_CONNECTING:
+    case SSS_NSS_ASYNC_SENDING:
+        *_events = POLLOUT;
+        return req->fd;
+    case SSS_NSS_ASYNC_RECEIVING:
+        *_events = POLLIN;
+        return req->fd;
+    case SSS_NSS_ASYNC_DONE:
+        break;
+    }
+
+    *_events = 0;
+    return -1;
+}
+
+void sss_nss_async_free(struct sss_nss_async_req *req)
+{
+    if (req == NULL) {
+        return;
+    }
+
+    sss_nss_async_finish(req, ECANCELED);
+    if (req->inp.rd.data != req->id_req) {
+        free(discard_const(req->inp.rd.data));
+    }
+    free(req);
+}
+
+int sss_nss_async_recv(struct sss_nss_async_req *req)
+{
+    int ret;
+
+    if (req == NULL) {
+        return EINVAL;
+    }
+
+    if (req->state != SSS_NSS_ASYNC_DONE) {
+        return EAGAIN;
+    }
+
+    ret = req->result;
+    sss_nss_async_free(req);
+
+    return ret;
+}
+
+/* Takes ownership of the request data in req->inp. The memory cache is
+ * checked first, a connection to the responder is only opened on a miss. */
+static int sss_nss_async_start(struct sss_nss_async_req *req, uint32_t flags,
+                               struct sss_nss_async_req **_req)
+{
+    uint32_t version = SSS_NSS_PROTOCOL_VERSION;
+    bool skip_mc = false;
+    char *envval;
+    size_t ofs;
+    int errnop;
+    int ret;
+
+    req->fd = -1;
+
+    ret = check_flags(&req->inp, flags, &skip_mc, &req->skip_data);
+    if (ret != 0) {
+        sss_nss_async_free(req);
+        return ret;
+    }
+
+    if (!skip_mc && !req->skip_data) {
+        ret = sss_nss_mc_get(&req->inp);
+        if (ret == 0 || ret == ERANGE) {
+            sss_nss_async_finish(req, ret);
+            *_req = req;
+            return 0;
+        }
+    }
+
+    /* avoid looping in the nss daemon */
+    envval = getenv("_SSS_LOOPS");
+    if (envval && strcmp(envval, "NO") == 0) {
+        sss_nss_async_finish(req, ENOENT);
+        *_req = req;
+        return 0;
+    }
+
+    req->out_len = 2 * SSS_NSS_HEADER_SIZE + sizeof(version) + req->inp.rd.len;
+    req->out = malloc(req->out_len);
+    if (req->out == NULL) {
+        sss_nss_async_free(req);
+        return ENOMEM;
+    }
+
+    req->version_tag = sss_cli_next_tag();
+    req->tag = sss_cli_next_tag();
+
+    ofs = 0;
+    sss_nss_async_add_packet(req->out, &ofs, SSS_GET_VERSION,
+                             req->version_tag, &version, sizeof(version));
+    sss_nss_async_add_packet(req->out, &ofs, req->inp.cmd, req->tag,
+                             req->inp.rd.data, req->inp.rd.len);
+
+    req->fd = sss_cli_open_socket_nb(SSS_NSS_SOCKET_NAME, &errnop);
+    if (req->fd == -1) {
+        sss_nss_async_free(req);
+        return errnop;
+    }
+
+    if (errnop == EINPROGRESS) {
+        req->state = SSS_NSS_ASYNC_CONNECTING;
+        *_req = req;
+        return 0;
+    }
+
+    /* connected already, no need to wait before sending */
+    req->state = SSS_NSS_ASYNC_SENDING;
+    sss_nss_async_process(req);
+
+    *_req = req;
+    return 0;
+}
+
+int sss_nss_getpwnam_send(const char *name, struct passwd *pwd,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **_req)
+{
+    struct sss_nss_async_req *req;
+    int ret;
+
+    if (_req == NULL) {
+        return EINVAL;
+    }
+
+    req = calloc(1, sizeof(struct sss_nss_async_req));
+    if (req == NULL) {
+        return ENOMEM;
+    }
+
+    req->inp.input.name = name;
+    req->inp.cmd = SSS_NSS_GETPWNAM_EX;
+    req->inp.result.pwrep.result = pwd;
+    req->inp.result.pwrep.buffer = buffer;
+    req->inp.result.pwrep.buflen = buflen;
+
+    ret = make_name_flag_req_data(name, flags, &req->inp.rd);
+    if (ret != 0) {
+        free(req);
+        return ret;
+    }
+
+    return sss_nss_async_start(req, flags, _req);
+}
+
+int sss_nss_getpwuid_send(uid_t uid, struct passwd *pwd,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **_req)
+{
+    struct sss_nss_async_req *req;
+
+    if (_req == NULL) {
+        return EINVAL;
+    }
+
+    req = calloc(1, sizeof(struct sss_nss_async_req));
+    if (req == NULL) {
+        return ENOMEM;
+    }
+
+    req->inp.input.uid = uid;
+    req->inp.cmd = SSS_NSS_GETPWUID_EX;
+    req->inp.result.pwrep.result = pwd;
+    req->inp.result.pwrep.buffer = buffer;
+    req->inp.result.pwrep.buflen = buflen;
+
+    SAFEALIGN_COPY_UINT32(&req->id_req[0], &uid, NULL);
+    SAFEALIGN_COPY_UINT32(&req->id_req[1], &flags, NULL);
+    req->inp.rd.len = 2 * sizeof(uint32_t);
+    req->inp.rd.data = req->id_req;
+
+    return sss_nss_async_start(req, flags, _req);
+}
+
+int sss_nss_getgrnam_send(const char *name, struct group *grp,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **_req)
+{
+    struct sss_nss_async_req *req;
+    int ret;
+
+    if (_req == NULL) {
+        return EINVAL;
+    }
+
+    req = calloc(1, sizeof(struct sss_nss_async_req));
+    if (req == NULL) {
+        return ENOMEM;
+    }
+
+    req->inp.input.name = name;
+    req->inp.cmd = SSS_NSS_GETGRNAM_EX;
+    req->inp.result.grrep.result = grp;
+    req->inp.result.grrep.buffer = buffer;
+    req->inp.result.grrep.buflen = buflen;
+
+    ret = make_name_flag_req_data(name, flags, &req->inp.rd);
+    if (ret != 0) {
+        free(req);
+        return ret;
+    }
+
+    return sss_nss_async_start(req, flags, _req);
+}
+
+int sss_nss_getgrgid_send(gid_t gid, struct group *grp,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **_req)
+{
+    struct sss_nss_async_req *req;
+
+    if (_req == NULL) {
+        return EINVAL;
+    }
+
+    req = calloc(1, sizeof(struct sss_nss_async_req));
+    if (req == NULL) {
+        return ENOMEM;
+    }
+
+    req->inp.input.gid = gid;
+    req->inp.cmd = SSS_NSS_GETGRGID_EX;
+    req->inp.result.grrep.result = grp;
+    req->inp.result.grrep.buffer = buffer;
+    req->inp.result.grrep.buflen = buflen;
+
+    SAFEALIGN_COPY_UINT32(&req->id_req[0], &gid, NULL);
+    SAFEALIGN_COPY_UINT32(&req->id_req[1], &flags, NULL);
+    req->inp.rd.len = 2 * sizeof(uint32_t);
+    req->inp.rd.data = req->id_req;
+
+    return sss_nss_async_start(req, flags, _req);
+}
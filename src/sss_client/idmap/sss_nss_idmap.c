@@ -27,13 +27,13 @@
 #include <nss.h>
 
 #include "sss_client/sss_cli.h"
+#include "sss_client/nss_mc.h"
 #include "sss_client/idmap/sss_nss_idmap.h"
 #include "sss_client/idmap/sss_nss_idmap_private.h"
 #include "util/strtonum.h"
 
 #define DATA_START (3 * sizeof(uint32_t))
 #define LIST_START (2 * sizeof(uint32_t))
-#define NO_TIMEOUT ((unsigned int) -1)
 
 union input {
     const char *str;
@@ -370,11 +370,18 @@ int sss_nss_getsidbyname_timeout(const char *fq_name, unsigned int timeout,
     int ret;
     union input inp;
     struct output out;
+    uint32_t mc_type;
 
     if (sid == NULL || fq_name == NULL || *fq_name == '\0') {
         return EINVAL;
     }
 
+    ret = sss_nss_mc_getsidbyname(fq_name, strlen(fq_name), sid, &mc_type);
+    if (ret == 0) {
+        *type = mc_type;
+        return EOK;
+    }
+
     inp.str = fq_name;
 
     ret = sss_nss_getyyybyxxx(inp, SSS_NSS_GETSIDBYNAME, timeout, &out);
@@ -479,11 +486,18 @@ int sss_nss_getnamebysid_timeout(const char *sid, unsigned int timeout,
     int ret;
     union input inp;
     struct output out;
+    uint32_t mc_type;
 
     if (fq_name == NULL || sid == NULL || *sid == '\0') {
         return EINVAL;
     }
 
+    ret = sss_nss_mc_getnamebysid(sid, strlen(sid), fq_name, &mc_type);
+    if (ret == 0) {
+        *type = mc_type;
+        return EOK;
+    }
+
     inp.str = sid;
 
     ret = sss_nss_getyyybyxxx(inp, SSS_NSS_GETNAMEBYSID, timeout, &out);
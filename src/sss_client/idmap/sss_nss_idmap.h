@@ -131,6 +131,97 @@ int sss_nss_getnamebysid(const char *sid, char **fq_name,
 int sss_nss_getidbysid(const char *sid, uint32_t *id,
                        enum sss_id_type *id_type);
 
+/**
+ * @brief Find the SIDs of many objects by their POSIX IDs with one request
+ *
+ * IDs of users and groups which are in the memory caches are resolved
+ * without contacting SSSD, all others are looked up with as few requests
+ * to SSSD as possible.
+ *
+ * @param[in]  ids        array of POSIX IDs
+ * @param[in]  id_types   array of count ID types, SSS_ID_TYPE_UID or
+ *                        SSS_ID_TYPE_GID only look up a user or a group
+ *                        like #sss_nss_getsidbyuid and #sss_nss_getsidbygid,
+ *                        any other type or a NULL array like
+ *                        #sss_nss_getsidbyid
+ * @param[in]  count      number of elements in ids
+ * @param[out] sids       array of count zero terminated string
+ *                        representations of SIDs, the SID at index i belongs
+ *                        to ids[i] and is NULL if no object was found. The
+ *                        SIDs and the array must be freed by the caller with
+ *                        free().
+ * @param[out] types      array of count types of the found objects, must be
+ *                        freed by the caller with free()
+ *
+ * @return
+ *  - 0:         success
+ *  - EINVAL:    invalid input
+ *  - ENOMEM:    memory allocation failed
+ *  - EBADMSG:   the reply of SSSD is invalid
+ *  - other errors of the request to SSSD
+ */
+int sss_nss_getsidbyid_multi(const uint32_t *ids,
+                             const enum sss_id_type *id_types,
+                             size_t count, char ***sids,
+                             enum sss_id_type **types);
+
+/**
+ * @brief Find the POSIX IDs of many objects by their SIDs with one request
+ *
+ * @param[in]  sids       array of zero terminated string representations of
+ *                        SIDs
+ * @param[in]  count      number of elements in sids
+ * @param[out] ids        array of count POSIX IDs, the ID at index i belongs
+ *                        to sids[i], must be freed by the caller with free()
+ * @param[out] types      array of count types of the found objects, the type
+ *                        is SSS_ID_TYPE_NOT_SPECIFIED and the ID 0 if no
+ *                        object was found for a SID. Must be freed by the
+ *                        caller with free().
+ *
+ * @return
+ *  - see #sss_nss_getsidbyid_multi
+ */
+int sss_nss_getidbysid_multi(const char * const *sids, size_t count,
+                             uint32_t **ids, enum sss_id_type **types);
+
+/**
+ * @brief Find the SIDs of many objects by their names with one request
+ *
+ * @param[in]  fq_names   array of fully qualified names of users or groups
+ * @param[in]  count      number of elements in fq_names
+ * @param[out] sids       array of count zero terminated string
+ *                        representations of SIDs, the SID at index i belongs
+ *                        to fq_names[i] and is NULL if no object was found.
+ *                        The SIDs and the array must be freed by the caller
+ *                        with free().
+ * @param[out] types      array of count types of the found objects, must be
+ *                        freed by the caller with free()
+ *
+ * @return
+ *  - see #sss_nss_getsidbyid_multi
+ */
+int sss_nss_getsidbyname_multi(const char * const *fq_names, size_t count,
+                               char ***sids, enum sss_id_type **types);
+
+/**
+ * @brief Find the names of many objects by their SIDs with one request
+ *
+ * @param[in]  sids       array of zero terminated string representations of
+ *                        SIDs
+ * @param[in]  count      number of elements in sids
+ * @param[out] fq_names   array of count fully qualified names, the name at
+ *                        index i belongs to sids[i] and is NULL if no object
+ *                        was found. The names and the array must be freed by
+ *                        the caller with free().
+ * @param[out] types      array of count types of the found objects, must be
+ *                        freed by the caller with free()
+ *
+ * @return
+ *  - see #sss_nss_getsidbyid_multi
+ */
+int sss_nss_getnamebysid_multi(const char * const *sids, size_t count,
+                               char ***fq_names, enum sss_id_type **types);
+
 /**
  * @brief Find original data by fully qualified name
  *
@@ -205,6 +296,18 @@ void sss_nss_free_kv(struct sss_nss_kv *kv_list);
  *  This flag cannot be used together with SSS_NSS_EX_FLAG_NO_CACHE */
 #define SSS_NSS_EX_FLAG_INVALIDATE_CACHE (1 << 1)
 
+/** Return the cached data even if it is expired and never wait for the
+ *  server side, an entry which is not cached is not found. This flag cannot
+ *  be used together with SSS_NSS_EX_FLAG_NO_CACHE or
+ *  SSS_NSS_EX_FLAG_INVALIDATE_CACHE */
+#define SSS_NSS_EX_FLAG_CACHE_ONLY (1 << 2)
+
+/** Like SSS_NSS_EX_FLAG_CACHE_ONLY, but expired data is refreshed in the
+ *  background and an entry which is not cached is looked up as usual. This
+ *  flag cannot be used together with SSS_NSS_EX_FLAG_NO_CACHE,
+ *  SSS_NSS_EX_FLAG_INVALIDATE_CACHE or SSS_NSS_EX_FLAG_CACHE_ONLY */
+#define SSS_NSS_EX_FLAG_ALLOW_STALE (1 << 3)
+
 #ifdef IPA_389DS_PLUGIN_HELPER_CALLS
 
 /**
@@ -329,6 +432,277 @@ int sss_nss_getgrgid_timeout(gid_t gid, struct group *grp,
 int sss_nss_getgrouplist_timeout(const char *name, gid_t group,
                                  gid_t *groups, int *ngroups,
                                  uint32_t flags, unsigned int timeout);
+
+/**
+ * @brief Return the user information and the groups of a user by name
+ *
+ * The same as #sss_nss_getpwnam_timeout followed by
+ * #sss_nss_getgrouplist_timeout with the primary group of the user but with
+ * a single request to SSSD, which refreshes the user only once if it is
+ * expired. Both results are added to the memory cache.
+ *
+ * @param[in]      name       name of the user
+ * @param[in]      pwd        same as for getpwnam_r(3)
+ * @param[in]      buffer     same as for getpwnam_r(3)
+ * @param[in]      buflen     same as for getpwnam_r(3)
+ * @param[out]     result     same as for getpwnam_r(3)
+ * @param[in]      groups     array of gid_t of size ngroups, will be filled
+ *                            with the primary GID of the user followed by
+ *                            the GIDs of the other groups the user belongs to
+ * @param[in,out]  ngroups    see #sss_nss_getgrouplist_timeout
+ * @param[in]      flags      flags to control the behavior and the results
+ *                            of the call
+ * @param[in]      timeout    timeout in milliseconds
+ *
+ * @return
+ *  - 0:         success
+ *  - ENOENT:    no user with the given name found
+ *  - ERANGE:    Insufficient buffer space supplied, the user information
+ *               is valid if only the groups array was too small
+ *  - ETIME:     request timed out but was send to SSSD
+ *  - ETIMEDOUT: request timed out but was not send to SSSD
+ */
+int sss_nss_getpwnam_grouplist_timeout(const char *name, struct passwd *pwd,
+                                       char *buffer, size_t buflen,
+                                       struct passwd **result,
+                                       gid_t *groups, int *ngroups,
+                                       uint32_t flags, unsigned int timeout);
+
+/**
+ * @brief Find the names of many users by their POSIX UIDs with one request
+ *
+ * Entries in the memory cache are used directly, all others are looked up
+ * with as few requests to SSSD as possible. As a side effect the found users
+ * are added to the memory cache so later getpwuid(3) calls do not have to
+ * contact SSSD.
+ *
+ * @param[in]  uids       array of POSIX UIDs
+ * @param[in]  count      number of elements in uids
+ * @param[in]  timeout    timeout in milliseconds
+ * @param[out] names      array of count user names, the name at index i
+ *                        belongs to uids[i] and is NULL if the user was not
+ *                        found. The names and the array must be freed by the
+ *                        caller with free().
+ *
+ * @return
+ *  - 0:         success
+ *  - EINVAL:    invalid input
+ *  - ETIME:     request timed out but was send to SSSD
+ *  - ETIMEDOUT: request timed out but was not send to SSSD
+ */
+int sss_nss_getnamebyuid_multi_timeout(const uint32_t *uids, size_t count,
+                                       unsigned int timeout, char ***names);
+
+/**
+ * @brief Find the names of many groups by their POSIX GIDs with one request
+ *
+ * @param[in]  gids       array of POSIX GIDs
+ * @param[in]  count      number of elements in gids
+ * @param[in]  timeout    timeout in milliseconds
+ * @param[out] names      array of count group names, see
+ *                        #sss_nss_getnamebyuid_multi_timeout
+ *
+ * @return
+ *  - see #sss_nss_getnamebyuid_multi_timeout
+ */
+int sss_nss_getnamebygid_multi_timeout(const uint32_t *gids, size_t count,
+                                       unsigned int timeout, char ***names);
+
+/**
+ * @brief Find the SIDs of many objects by their POSIX IDs with one request,
+ * see #sss_nss_getsidbyid_multi
+ *
+ * @param[in]  timeout    timeout in milliseconds
+ *
+ * @return
+ *  - see #sss_nss_getsidbyid_multi
+ *  - ETIME:     request timed out but was send to SSSD
+ *  - ETIMEDOUT: request timed out but was not send to SSSD
+ */
+int sss_nss_getsidbyid_multi_timeout(const uint32_t *ids,
+                                     const enum sss_id_type *id_types,
+                                     size_t count, unsigned int timeout,
+                                     char ***sids, enum sss_id_type **types);
+
+/**
+ * @brief Find the POSIX IDs of many objects by their SIDs with one request,
+ * see #sss_nss_getidbysid_multi
+ *
+ * @param[in]  timeout    timeout in milliseconds
+ *
+ * @return
+ *  - see #sss_nss_getsidbyid_multi_timeout
+ */
+int sss_nss_getidbysid_multi_timeout(const char * const *sids, size_t count,
+                                     unsigned int timeout, uint32_t **ids,
+                                     enum sss_id_type **types);
+
+/**
+ * @brief Find the SIDs of many objects by their names with one request,
+ * see #sss_nss_getsidbyname_multi
+ *
+ * @param[in]  timeout    timeout in milliseconds
+ *
+ * @return
+ *  - see #sss_nss_getsidbyid_multi_timeout
+ */
+int sss_nss_getsidbyname_multi_timeout(const char * const *fq_names,
+                                       size_t count, unsigned int timeout,
+                                       char ***sids, enum sss_id_type **types);
+
+/**
+ * @brief Find the names of many objects by their SIDs with one request,
+ * see #sss_nss_getnamebysid_multi
+ *
+ * @param[in]  timeout    timeout in milliseconds
+ *
+ * @return
+ *  - see #sss_nss_getsidbyid_multi_timeout
+ */
+int sss_nss_getnamebysid_multi_timeout(const char * const *sids,
+                                       size_t count, unsigned int timeout,
+                                       char ***fq_names,
+                                       enum sss_id_type **types);
+
+/**
+ * @brief Check if a triple is a member of a netgroup
+ *
+ * Unlike innetgr(3) the netgroup and all netgroups nested in it are
+ * checked by SSSD with one request instead of being read entry by entry.
+ *
+ * @param[in]  netgroup   name of the netgroup
+ * @param[in]  host       host name, NULL matches any host
+ * @param[in]  user       user name, NULL matches any user
+ * @param[in]  domain     domain name, NULL matches any domain
+ * @param[in]  timeout    timeout in milliseconds
+ * @param[out] result     1 if the triple is in the netgroup, 0 if it is not
+ *                        or if the netgroup does not exist
+ *
+ * @return
+ *  - 0:         success
+ *  - EINVAL:    invalid input
+ *  - ETIME:     request timed out but was send to SSSD
+ *  - ETIMEDOUT: request timed out but was not send to SSSD
+ */
+int sss_nss_innetgr_timeout(const char *netgroup, const char *host,
+                            const char *user, const char *domain,
+                            unsigned int timeout, int *result);
+
+/**
+ * Opaque type of a lookup started with one of the sss_nss_*_send() calls
+ */
+struct sss_nss_async_req;
+
+/**
+ * @brief Start looking up a user by name without blocking
+ *
+ * The memory cache is checked first. Only if the user is not found there a
+ * connection to SSSD is opened. The caller then waits with poll(2), epoll(7)
+ * or its event library for the events returned by #sss_nss_async_get_fd and
+ * calls #sss_nss_async_process whenever they happen, until the lookup is
+ * finished. The result is collected with #sss_nss_async_recv.
+ *
+ * The library does not enforce a timeout, the caller cancels a lookup that
+ * took too long with #sss_nss_async_free.
+ *
+ * @param[in]  name    name of the user
+ * @param[in]  pwd     user data, must be valid until the lookup is finished
+ * @param[in]  buffer  buffer for the strings of pwd, must be valid until the
+ *                     lookup is finished
+ * @param[in]  buflen  size of buffer
+ * @param[in]  flags   see #sss_nss_getpwnam_timeout
+ * @param[out] req     the lookup
+ *
+ * @return
+ *  - 0:      the lookup was started, it might already be finished
+ *  - EINVAL: invalid input
+ *  - ENOMEM: memory allocation failed
+ *  - other:  SSSD cannot be contacted
+ */
+int sss_nss_getpwnam_send(const char *name, struct passwd *pwd,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **req);
+
+/**
+ * @brief Start looking up a user by POSIX UID without blocking
+ *
+ * @param[in]  uid     POSIX UID of the user
+ *
+ * See #sss_nss_getpwnam_send for the other parameters.
+ */
+int sss_nss_getpwuid_send(uid_t uid, struct passwd *pwd,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **req);
+
+/**
+ * @brief Start looking up a group by name without blocking
+ *
+ * @param[in]  name    name of the group
+ * @param[in]  grp     group data, must be valid until the lookup is finished
+ *
+ * See #sss_nss_getpwnam_send for the other parameters.
+ */
+int sss_nss_getgrnam_send(const char *name, struct group *grp,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **req);
+
+/**
+ * @brief Start looking up a group by POSIX GID without blocking
+ *
+ * @param[in]  gid     POSIX GID of the group
+ * @param[in]  grp     group data, must be valid until the lookup is finished
+ *
+ * See #sss_nss_getpwnam_send for the other parameters.
+ */
+int sss_nss_getgrgid_send(gid_t gid, struct group *grp,
+                          char *buffer, size_t buflen, uint32_t flags,
+                          struct sss_nss_async_req **req);
+
+/**
+ * @brief Get the file descriptor a lookup waits for
+ *
+ * @param[in]  req     the lookup
+ * @param[out] events  POLLIN or POLLOUT
+ *
+ * @return the file descriptor, -1 if the lookup is finished
+ */
+int sss_nss_async_get_fd(struct sss_nss_async_req *req, short *events);
+
+/**
+ * @brief Continue a lookup after the events of its file descriptor happened
+ *
+ * The descriptor and the events may change after each call.
+ *
+ * @param[in] req  the lookup
+ *
+ * @return
+ *  - 0:      the lookup is finished
+ *  - EAGAIN: wait for the events again
+ *  - EINVAL: invalid input
+ */
+int sss_nss_async_process(struct sss_nss_async_req *req);
+
+/**
+ * @brief Get the result of a finished lookup and free it
+ *
+ * @param[in] req  the lookup
+ *
+ * @return
+ *  - 0:      the result is in the data passed to the send call
+ *  - EAGAIN: the lookup is not finished, it is not freed
+ *  - ENOENT: the user or group does not exist
+ *  - ERANGE: the buffer is too small
+ *  - other:  the lookup failed
+ */
+int sss_nss_async_recv(struct sss_nss_async_req *req);
+
+/**
+ * @brief Cancel a lookup and free it
+ *
+ * @param[in] req  the lookup
+ */
+void sss_nss_async_free(struct sss_nss_async_req *req);
+
 /**
  * @brief Find SID by fully qualified name with timeout
  *
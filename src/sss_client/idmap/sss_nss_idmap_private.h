@@ -25,6 +25,10 @@
 #ifndef SSS_NSS_IDMAP_PRIVATE_H_
 #define SSS_NSS_IDMAP_PRIVATE_H_
 
+/* Wait for the lock without a timeout, which the calls without a timeout
+ * argument use */
+#define NO_TIMEOUT ((unsigned int) -1)
+
 int sss_nss_timedlock(unsigned int timeout_ms, int *time_left_ms);
 
 #endif /* SSS_NSS_IDMAP_PRIVATE_H_ */
@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "sss_cli.h"
+#include "nss_mc.h"
 
 static struct sss_nss_gethostent_data {
     size_t len;
@@ -247,8 +248,15 @@ internal_gethostbyname2_r(const char *name, int af,
 
     sss_nss_lock();
 
-    nret = sss_nss_make_request(SSS_NSS_GETHOSTBYNAME2, &rd,
-                                &repbuf, &replen, errnop);
+    ret = sss_nss_mc_get_reply(SSS_NSS_GETHOSTBYNAME2, rd.data, rd.len,
+                               &repbuf, &replen);
+    if (ret == 0) {
+        nret = NSS_STATUS_SUCCESS;
+    } else {
+        /* not in the memory cache, ask the responder */
+        nret = sss_nss_make_request(SSS_NSS_GETHOSTBYNAME2, &rd,
+                                    &repbuf, &replen, errnop);
+    }
     if (nret != NSS_STATUS_SUCCESS) {
         *h_errnop = NETDB_INTERNAL;
         goto out;
@@ -376,8 +384,15 @@ _nss_sss_gethostbyaddr_r(const void *addr, socklen_t addrlen,
 
     sss_nss_lock();
 
-    nret = sss_nss_make_request(SSS_NSS_GETHOSTBYADDR, &rd,
-                                &repbuf, &replen, errnop);
+    ret = sss_nss_mc_get_reply(SSS_NSS_GETHOSTBYADDR, rd.data, rd.len,
+                               &repbuf, &replen);
+    if (ret == 0) {
+        nret = NSS_STATUS_SUCCESS;
+    } else {
+        /* not in the memory cache, ask the responder */
+        nret = sss_nss_make_request(SSS_NSS_GETHOSTBYADDR, &rd,
+                                    &repbuf, &replen, errnop);
+    }
     free(data);
     if (nret != NSS_STATUS_SUCCESS) {
         *h_errnop = NETDB_INTERNAL;
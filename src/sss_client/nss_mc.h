@@ -45,6 +45,8 @@ struct sss_cli_mc_ctx {
     int fd;
 
     uint32_t seed;          /* seed from the tables header */
+    uint32_t hash_alg;      /* hash function from the tables header */
+    uint32_t generation;    /* header generation last validated */
 
     void *mmap_base;        /* base address of mmap */
     size_t mmap_size;       /* total size of mmap */
@@ -52,22 +54,26 @@ struct sss_cli_mc_ctx {
     uint8_t *data_table;    /* data table address (in mmap) */
     uint32_t dt_size;       /* size of data table */
 
-    uint32_t *hash_table;   /* hash table address (in mmap) */
+    struct sss_mc_bucket *hash_table; /* hash table address (in mmap) */
     uint32_t ht_size;       /* size of hash table */
 
     uint32_t active_threads; /* count of threads which use memory cache */
+
+    struct sss_mc_counters *stats; /* usage counters of this process' user,
+                                    * NULL if they are not available */
 };
 
 errno_t sss_nss_mc_get_ctx(const char *name, struct sss_cli_mc_ctx *ctx);
 errno_t sss_nss_check_header(struct sss_cli_mc_ctx *ctx);
 uint32_t sss_nss_mc_hash(struct sss_cli_mc_ctx *ctx,
                          const char *key, size_t len);
+void sss_nss_mc_count_lookup(struct sss_cli_mc_ctx *ctx, errno_t ret);
 errno_t sss_nss_mc_get_record(struct sss_cli_mc_ctx *ctx,
                               uint32_t slot, struct sss_mc_rec **_rec);
 errno_t sss_nss_str_ptr_from_buffer(char **str, void **cookie,
                                     char *buf, size_t len);
-uint32_t sss_nss_mc_next_slot_with_hash(struct sss_mc_rec *rec,
-                                        uint32_t hash);
+uint32_t sss_nss_mc_probe_next(struct sss_cli_mc_ctx *ctx,
+                               struct sss_mc_probe *probe);
 
 /* passwd db */
 errno_t sss_nss_mc_getpwnam(const char *name, size_t name_len,
@@ -76,6 +82,8 @@ errno_t sss_nss_mc_getpwnam(const char *name, size_t name_len,
 errno_t sss_nss_mc_getpwuid(uid_t uid,
                             struct passwd *result,
                             char *buffer, size_t buflen);
+errno_t sss_nss_mc_getuidbyname(const char *name, size_t name_len,
+                                uid_t *uid);
 
 /* group db */
 errno_t sss_nss_mc_getgrnam(const char *name, size_t name_len,
@@ -90,4 +98,15 @@ errno_t sss_nss_mc_initgroups_dyn(const char *name, size_t name_len,
                                   gid_t group, long int *start, long int *size,
                                   gid_t **groups, long int limit);
 
+/* SID db, type is an enum sss_id_type, the result must be freed */
+errno_t sss_nss_mc_getsidbyname(const char *name, size_t name_len,
+                                char **sid, uint32_t *type);
+errno_t sss_nss_mc_getnamebysid(const char *sid, size_t sid_len,
+                                char **name, uint32_t *type);
+
+/* services, hosts and netgroups replies, the result must be freed */
+errno_t sss_nss_mc_get_reply(uint32_t cmd,
+                             const void *req, size_t req_len,
+                             uint8_t **_repbuf, size_t *_replen);
+
 #endif /* _NSS_MC_H_ */
@@ -46,15 +46,44 @@ do { \
     res = false; \
     _b1 = (src)->b1; \
     if (MC_VALID_BARRIER(_b1)) { \
-        __sync_synchronize(); \
+        MC_READ_BARRIER(); \
         memcpy(dest, src, len); \
-        __sync_synchronize(); \
+        MC_READ_BARRIER(); \
         if ((src)->b2 == _b1) { \
             res = true; \
         } \
     } \
 } while(0)
 
+/* Checks whether the header is still the one that was fully validated last
+ * time. Only the barriers, the status and the generation counter are read,
+ * so concurrent readers do not need to copy the whole header. */
+static bool sss_nss_mc_header_unchanged(struct sss_cli_mc_ctx *ctx)
+{
+    struct sss_mc_header *h = (struct sss_mc_header *)ctx->mmap_base;
+    uint32_t b1;
+    uint32_t status;
+    uint32_t generation;
+
+    if (ctx->data_table == NULL) {
+        return false;
+    }
+
+    b1 = h->b1;
+    if (!MC_VALID_BARRIER(b1)) {
+        return false;
+    }
+    MC_READ_BARRIER();
+    status = h->status;
+    generation = h->generation;
+    MC_READ_BARRIER();
+    if (h->b2 != b1) {
+        return false;
+    }
+
+    return status == SSS_MC_HEADER_ALIVE && generation == ctx->generation;
+}
+
 errno_t sss_nss_check_header(struct sss_cli_mc_ctx *ctx)
 {
     struct sss_mc_header h;
@@ -63,6 +92,10 @@ errno_t sss_nss_check_header(struct sss_cli_mc_ctx *ctx)
     int ret;
     struct stat fdstat;
 
+    if (sss_nss_mc_header_unchanged(ctx)) {
+        goto check_file;
+    }
+
     /* retry barrier protected reading max 5 times then give up */
     for (count = 5; count > 0; count--) {
         MEMCPY_WITH_BARRIERS(copy_ok, &h,
@@ -72,6 +105,7 @@ errno_t sss_nss_check_header(struct sss_cli_mc_ctx *ctx)
             /* record is consistent so we can proceed */
             break;
         }
+        MC_STATS_INC(ctx->stats, barrier_retries);
     }
     if (count == 0) {
         /* couldn't successfully read header we have to give up */
@@ -80,19 +114,28 @@ errno_t sss_nss_check_header(struct sss_cli_mc_ctx *ctx)
 
     if (h.major_vno != SSS_MC_MAJOR_VNO ||
         h.minor_vno != SSS_MC_MINOR_VNO ||
+        h.hash_alg > SSS_MC_HASH_MAX ||
         h.status == SSS_MC_HEADER_RECYCLED) {
         return EINVAL;
     }
 
+    if (h.ht_size < MC_HT_SIZE(1) ||
+        h.hash_table > ctx->mmap_size ||
+        h.ht_size > ctx->mmap_size - h.hash_table) {
+        return EINVAL;
+    }
+
     /* first time we check the header, let's fill our own struct */
     if (ctx->data_table == NULL) {
         ctx->seed = h.seed;
+        ctx->hash_alg = h.hash_alg;
         ctx->data_table = MC_PTR_ADD(ctx->mmap_base, h.data_table);
         ctx->hash_table = MC_PTR_ADD(ctx->mmap_base, h.hash_table);
         ctx->dt_size = h.dt_size;
         ctx->ht_size = h.ht_size;
     } else {
         if (ctx->seed != h.seed ||
+            ctx->hash_alg != h.hash_alg ||
             ctx->data_table != MC_PTR_ADD(ctx->mmap_base, h.data_table) ||
             ctx->hash_table != MC_PTR_ADD(ctx->mmap_base, h.hash_table) ||
             ctx->dt_size != h.dt_size ||
@@ -101,6 +144,11 @@ errno_t sss_nss_check_header(struct sss_cli_mc_ctx *ctx)
         }
     }
 
+    if (h.status == SSS_MC_HEADER_ALIVE) {
+        ctx->generation = h.generation;
+    }
+
+check_file:
     ret = fstat(ctx->fd, &fdstat);
     if (ret == -1) {
         return EIO;
@@ -114,10 +162,72 @@ errno_t sss_nss_check_header(struct sss_cli_mc_ctx *ctx)
     return 0;
 }
 
+/* Maps the usage counters of the effective user for the cache. This is
+ * best effort, lookups just are not counted if it fails. */
+static struct sss_mc_counters *sss_nss_mc_open_stats(const char *name)
+{
+    struct sss_mc_counters *stats = NULL;
+    struct stat fdstat;
+    char *file = NULL;
+    uid_t euid;
+    int fd = -1;
+    int ret;
+
+    euid = geteuid();
+    ret = asprintf(&file, "%s/%s.%lu", SSS_NSS_MCACHE_STATS_DIR, name,
+                   (unsigned long)euid);
+    if (ret == -1) {
+        return NULL;
+    }
+
+    fd = open(file, O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        goto done;
+    }
+
+    /* the directory is world writable, make sure nobody else
+     * planted the file for us */
+    ret = fstat(fd, &fdstat);
+    if (ret == -1 || !S_ISREG(fdstat.st_mode)
+            || fdstat.st_uid != euid || fdstat.st_nlink != 1) {
+        goto done;
+    }
+
+    if (fdstat.st_size < sizeof(struct sss_mc_counters)) {
+        ret = ftruncate(fd, sizeof(struct sss_mc_counters));
+        if (ret == -1) {
+            goto done;
+        }
+    }
+
+    stats = mmap(NULL, sizeof(struct sss_mc_counters),
+                 PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (stats == MAP_FAILED) {
+        stats = NULL;
+        goto done;
+    }
+
+    if (stats->version != SSS_MC_STATS_VNO) {
+        memset(stats, 0, sizeof(struct sss_mc_counters));
+        stats->version = SSS_MC_STATS_VNO;
+    }
+
+done:
+    if (fd != -1) {
+        close(fd);
+    }
+    free(file);
+    return stats;
+}
+
 static void sss_nss_mc_destroy_ctx(struct sss_cli_mc_ctx *ctx)
 {
     uint32_t active_threads = ctx->active_threads;
 
+    if (ctx->stats != NULL) {
+        munmap(ctx->stats, sizeof(struct sss_mc_counters));
+    }
+
     if ((ctx->mmap_base != NULL) && (ctx->mmap_size != 0)) {
         munmap(ctx->mmap_base, ctx->mmap_size);
     }
@@ -180,6 +290,8 @@ static errno_t sss_nss_mc_init_ctx(const char *name,
         goto done;
     }
 
+    ctx->stats = sss_nss_mc_open_stats(name);
+
     ctx->initialized = INITIALIZED;
 
     ret = 0;
@@ -251,7 +363,27 @@ errno_t sss_nss_mc_get_ctx(const char *name, struct sss_cli_mc_ctx *ctx)
 uint32_t sss_nss_mc_hash(struct sss_cli_mc_ctx *ctx,
                          const char *key, size_t len)
 {
-    return murmurhash3(key, len, ctx->seed) % MC_HT_ELEMS(ctx->ht_size);
+    return sss_mc_hash_key(ctx->hash_alg, ctx->seed, key, len);
+}
+
+/* Counts a finished lookup, stale hits are counted where the expiration
+ * is checked */
+void sss_nss_mc_count_lookup(struct sss_cli_mc_ctx *ctx, errno_t ret)
+{
+    MC_STATS_INC(ctx->stats, lookups);
+
+    switch (ret) {
+    case 0:
+    case ERANGE:
+        /* ERANGE: found, but the caller's buffer is too small */
+        MC_STATS_INC(ctx->stats, hits);
+        break;
+    case ENOENT:
+        MC_STATS_INC(ctx->stats, misses);
+        break;
+    default:
+        break;
+    }
 }
 
 errno_t sss_nss_mc_get_record(struct sss_cli_mc_ctx *ctx,
@@ -273,12 +405,13 @@ errno_t sss_nss_mc_get_record(struct sss_cli_mc_ctx *ctx,
 
         /* fetch record length */
         b1 = rec->b1;
-        __sync_synchronize();
+        MC_READ_BARRIER();
         rec_len = rec->len;
-        __sync_synchronize();
+        MC_READ_BARRIER();
         b2 = rec->b2;
         if (!MC_VALID_BARRIER(b1) || b1 != b2) {
             /* record is inconsistent, retry */
+            MC_STATS_INC(ctx->stats, barrier_retries);
             continue;
         }
 
@@ -306,6 +439,7 @@ errno_t sss_nss_mc_get_record(struct sss_cli_mc_ctx *ctx,
             /* record is consistent, use it */
             break;
         }
+        MC_STATS_INC(ctx->stats, barrier_retries);
     }
     if (count == 0) {
         /* couldn't successfully read header we have to give up */
@@ -368,16 +502,8 @@ errno_t sss_nss_str_ptr_from_buffer(char **str, void **cookie,
     return 0;
 }
 
-uint32_t sss_nss_mc_next_slot_with_hash(struct sss_mc_rec *rec,
-                                        uint32_t hash)
+uint32_t sss_nss_mc_probe_next(struct sss_cli_mc_ctx *ctx,
+                               struct sss_mc_probe *probe)
 {
-    if (rec->hash1 == hash) {
-        return rec->next1;
-    } else if (rec->hash2 == hash) {
-        return rec->next2;
-    } else {
-        /* it should never happen. */
-        return MC_INVALID_VAL;
-    }
-
+    return sss_mc_probe_next(probe, ctx->hash_table, ctx->ht_size);
 }
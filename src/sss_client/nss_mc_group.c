@@ -29,8 +29,8 @@
 #include "nss_mc.h"
 #include "shared/safealign.h"
 
-static struct sss_cli_mc_ctx gr_mc_ctx = { UNINITIALIZED, -1, 0, NULL, 0, NULL, 0,
-                                           NULL, 0, 0 };
+static struct sss_cli_mc_ctx gr_mc_ctx = { .initialized = UNINITIALIZED,
+                                           .fd = -1 };
 
 static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
                                        struct group *result,
@@ -48,6 +48,7 @@ static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
     expire = rec->expire;
     if (expire < time(NULL)) {
         /* entry is now invalid */
+        MC_STATS_INC(gr_mc_ctx.stats, stale_hits);
         return EINVAL;
     }
 
@@ -109,6 +110,7 @@ errno_t sss_nss_mc_getgrnam(const char *name, size_t name_len,
     struct sss_mc_rec *rec = NULL;
     struct sss_mc_grp_data *data;
     char *rec_name;
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     int ret;
@@ -125,7 +127,8 @@ errno_t sss_nss_mc_getgrnam(const char *name, size_t name_len,
 
     /* hashes are calculated including the NULL terminator */
     hash = sss_nss_mc_hash(&gr_mc_ctx, name, name_len + 1);
-    slot = gr_mc_ctx.hash_table[hash];
+    sss_mc_probe_init(&probe, hash, gr_mc_ctx.ht_size);
+    slot = sss_nss_mc_probe_next(&gr_mc_ctx, &probe);
 
     /* If slot is not within the bounds of mmapped region and
      * it's value is not MC_INVALID_VAL, then the cache is
@@ -143,7 +146,7 @@ errno_t sss_nss_mc_getgrnam(const char *name, size_t name_len,
         /* check record matches what we are searching for */
         if (hash != rec->hash1) {
             /* if name hash does not match we can skip this immediately */
-            slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+            slot = sss_nss_mc_probe_next(&gr_mc_ctx, &probe);
             continue;
         }
 
@@ -164,7 +167,7 @@ errno_t sss_nss_mc_getgrnam(const char *name, size_t name_len,
             break;
         }
 
-        slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_nss_mc_probe_next(&gr_mc_ctx, &probe);
     }
 
     if (!MC_SLOT_WITHIN_BOUNDS(slot, data_size)) {
@@ -176,6 +179,7 @@ errno_t sss_nss_mc_getgrnam(const char *name, size_t name_len,
 
 done:
     free(rec);
+    sss_nss_mc_count_lookup(&gr_mc_ctx, ret);
     __sync_sub_and_fetch(&gr_mc_ctx.active_threads, 1);
     return ret;
 }
@@ -187,6 +191,7 @@ errno_t sss_nss_mc_getgrgid(gid_t gid,
     struct sss_mc_rec *rec = NULL;
     struct sss_mc_grp_data *data;
     char gidstr[11];
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     int len;
@@ -205,7 +210,8 @@ errno_t sss_nss_mc_getgrgid(gid_t gid,
 
     /* hashes are calculated including the NULL terminator */
     hash = sss_nss_mc_hash(&gr_mc_ctx, gidstr, len+1);
-    slot = gr_mc_ctx.hash_table[hash];
+    sss_mc_probe_init(&probe, hash, gr_mc_ctx.ht_size);
+    slot = sss_nss_mc_probe_next(&gr_mc_ctx, &probe);
 
     /* If slot is not within the bounds of mmapped region and
      * it's value is not MC_INVALID_VAL, then the cache is
@@ -223,7 +229,7 @@ errno_t sss_nss_mc_getgrgid(gid_t gid,
         /* check record matches what we are searching for */
         if (hash != rec->hash2) {
             /* if uid hash does not match we can skip this immediately */
-            slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+            slot = sss_nss_mc_probe_next(&gr_mc_ctx, &probe);
             continue;
         }
 
@@ -232,7 +238,7 @@ errno_t sss_nss_mc_getgrgid(gid_t gid,
             break;
         }
 
-        slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_nss_mc_probe_next(&gr_mc_ctx, &probe);
     }
 
     if (!MC_SLOT_WITHIN_BOUNDS(slot, gr_mc_ctx.dt_size)) {
@@ -244,6 +250,7 @@ errno_t sss_nss_mc_getgrgid(gid_t gid,
 
 done:
     free(rec);
+    sss_nss_mc_count_lookup(&gr_mc_ctx, ret);
     __sync_sub_and_fetch(&gr_mc_ctx.active_threads, 1);
     return ret;
 }
@@ -32,8 +32,8 @@
 #include "nss_mc.h"
 #include "shared/safealign.h"
 
-static struct sss_cli_mc_ctx initgr_mc_ctx = { UNINITIALIZED, -1, 0, NULL, 0, NULL, 0,
-                                               NULL, 0, 0 };
+static struct sss_cli_mc_ctx initgr_mc_ctx = { .initialized = UNINITIALIZED,
+                                               .fd = -1 };
 
 static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
                                        long int *start, long int *size,
@@ -49,6 +49,7 @@ static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
     expire = rec->expire;
     if (expire < time(NULL)) {
         /* entry is now invalid */
+        MC_STATS_INC(initgr_mc_ctx.stats, stale_hits);
         return EINVAL;
     }
 
@@ -83,30 +84,47 @@ static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
     return 0;
 }
 
-errno_t sss_nss_mc_initgroups_dyn(const char *name, size_t name_len,
-                                  gid_t group, long int *start, long int *size,
-                                  gid_t **groups, long int limit)
+/* Returns true if the uid string stored behind the name of the record is
+ * uidstr */
+static bool sss_nss_mc_initgr_uid_matches(struct sss_mc_initgr_data *data,
+                                          const char *uidstr, size_t len)
+{
+    const size_t data_offset = offsetof(struct sss_mc_initgr_data, gids);
+    size_t end = data_offset + data->data_len;
+    size_t uid_ptr;
+
+    uid_ptr = data->name + strnlen((char *)data + data->name,
+                                   end - data->name) + 1;
+    if (uid_ptr + len + 1 > end) {
+        return false;
+    }
+
+    return memcmp((char *)data + uid_ptr, uidstr, len + 1) == 0;
+}
+
+/* Returns a copy of the record which must be freed. The record is looked up
+ * by the name it was requested with or, if by_uid is set, by the uid of its
+ * user as decimal string. */
+static errno_t sss_nss_mc_initgr_find(const char *key, size_t key_len,
+                                      bool by_uid, struct sss_mc_rec **_rec)
 {
     struct sss_mc_rec *rec = NULL;
     struct sss_mc_initgr_data *data;
     char *rec_name;
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     int ret;
     const size_t data_offset = offsetof(struct sss_mc_initgr_data, gids);
     size_t data_size;
 
-    ret = sss_nss_mc_get_ctx("initgroups", &initgr_mc_ctx);
-    if (ret) {
-        return ret;
-    }
-
     /* Get max size of data table. */
     data_size = initgr_mc_ctx.dt_size;
 
     /* hashes are calculated including the NULL terminator */
-    hash = sss_nss_mc_hash(&initgr_mc_ctx, name, name_len + 1);
-    slot = initgr_mc_ctx.hash_table[hash];
+    hash = sss_nss_mc_hash(&initgr_mc_ctx, key, key_len + 1);
+    sss_mc_probe_init(&probe, hash, initgr_mc_ctx.ht_size);
+    slot = sss_nss_mc_probe_next(&initgr_mc_ctx, &probe);
 
     /* If slot is not within the bounds of mmapped region and
      * it's value is not MC_INVALID_VAL, then the cache is
@@ -122,9 +140,9 @@ errno_t sss_nss_mc_initgroups_dyn(const char *name, size_t name_len,
         }
 
         /* check record matches what we are searching for */
-        if (hash != rec->hash1) {
-            /* if name hash does not match we can skip this immediately */
-            slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+        if (hash != (by_uid ? rec->hash3 : rec->hash1)) {
+            /* if the hash does not match we can skip this immediately */
+            slot = sss_nss_mc_probe_next(&initgr_mc_ctx, &probe);
             continue;
         }
 
@@ -143,11 +161,15 @@ errno_t sss_nss_mc_initgroups_dyn(const char *name, size_t name_len,
             goto done;
         }
 
-        if (strcmp(name, rec_name) == 0) {
+        if (by_uid) {
+            if (sss_nss_mc_initgr_uid_matches(data, key, key_len)) {
+                break;
+            }
+        } else if (strcmp(key, rec_name) == 0) {
             break;
         }
 
-        slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_nss_mc_probe_next(&initgr_mc_ctx, &probe);
     }
 
     if (!MC_SLOT_WITHIN_BOUNDS(slot, data_size)) {
@@ -155,10 +177,51 @@ errno_t sss_nss_mc_initgroups_dyn(const char *name, size_t name_len,
         goto done;
     }
 
+    *_rec = rec;
+    rec = NULL;
+    ret = 0;
+
+done:
+    free(rec);
+    return ret;
+}
+
+errno_t sss_nss_mc_initgroups_dyn(const char *name, size_t name_len,
+                                  gid_t group, long int *start, long int *size,
+                                  gid_t **groups, long int limit)
+{
+    struct sss_mc_rec *rec = NULL;
+    char uidstr[11];
+    uid_t uid;
+    int len;
+    int ret;
+
+    ret = sss_nss_mc_get_ctx("initgroups", &initgr_mc_ctx);
+    if (ret) {
+        return ret;
+    }
+
+    ret = sss_nss_mc_initgr_find(name, name_len, false, &rec);
+    if (ret == ENOENT) {
+        /* The record might have been stored for another spelling of the
+         * name, e.g. a qualified one or one with different case. If the
+         * passwd cache knows the user, its record is found by the uid. */
+        if (sss_nss_mc_getuidbyname(name, name_len, &uid) == 0 && uid != 0) {
+            len = snprintf(uidstr, sizeof(uidstr), "%lu", (unsigned long)uid);
+            if (len > 0 && len < sizeof(uidstr)) {
+                ret = sss_nss_mc_initgr_find(uidstr, len, true, &rec);
+            }
+        }
+    }
+    if (ret) {
+        goto done;
+    }
+
     ret = sss_nss_mc_parse_result(rec, start, size, groups, limit);
 
 done:
     free(rec);
+    sss_nss_mc_count_lookup(&initgr_mc_ctx, ret);
     __sync_sub_and_fetch(&initgr_mc_ctx.active_threads, 1);
     return ret;
 }
@@ -28,8 +28,8 @@
 #include <time.h>
 #include "nss_mc.h"
 
-static struct sss_cli_mc_ctx pw_mc_ctx = { UNINITIALIZED, -1, 0, NULL, 0, NULL, 0,
-                                           NULL, 0, 0 };
+static struct sss_cli_mc_ctx pw_mc_ctx = { .initialized = UNINITIALIZED,
+                                           .fd = -1 };
 
 static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
                                        struct passwd *result,
@@ -44,6 +44,7 @@ static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
     expire = rec->expire;
     if (expire < time(NULL)) {
         /* entry is now invalid */
+        MC_STATS_INC(pw_mc_ctx.stats, stale_hits);
         return EINVAL;
     }
 
@@ -95,30 +96,28 @@ static errno_t sss_nss_mc_parse_result(struct sss_mc_rec *rec,
     return 0;
 }
 
-errno_t sss_nss_mc_getpwnam(const char *name, size_t name_len,
-                            struct passwd *result,
-                            char *buffer, size_t buflen)
+/* Returns a copy of the record of name which must be freed, the caller
+ * holds a reference to pw_mc_ctx */
+static errno_t sss_nss_mc_pw_find_name(const char *name, size_t name_len,
+                                       struct sss_mc_rec **_rec)
 {
     struct sss_mc_rec *rec = NULL;
     struct sss_mc_pwd_data *data;
     char *rec_name;
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     int ret;
     const size_t strs_offset = offsetof(struct sss_mc_pwd_data, strs);
     size_t data_size;
 
-    ret = sss_nss_mc_get_ctx("passwd", &pw_mc_ctx);
-    if (ret) {
-        return ret;
-    }
-
     /* Get max size of data table. */
     data_size = pw_mc_ctx.dt_size;
 
     /* hashes are calculated including the NULL terminator */
     hash = sss_nss_mc_hash(&pw_mc_ctx, name, name_len + 1);
-    slot = pw_mc_ctx.hash_table[hash];
+    sss_mc_probe_init(&probe, hash, pw_mc_ctx.ht_size);
+    slot = sss_nss_mc_probe_next(&pw_mc_ctx, &probe);
 
     /* If slot is not within the bounds of mmapped region and
      * it's value is not MC_INVALID_VAL, then the cache is
@@ -136,7 +135,7 @@ errno_t sss_nss_mc_getpwnam(const char *name, size_t name_len,
         /* check record matches what we are searching for */
         if (hash != rec->hash1) {
             /* if name hash does not match we can skip this immediately */
-            slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+            slot = sss_nss_mc_probe_next(&pw_mc_ctx, &probe);
             continue;
         }
 
@@ -157,7 +156,7 @@ errno_t sss_nss_mc_getpwnam(const char *name, size_t name_len,
             break;
         }
 
-        slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_nss_mc_probe_next(&pw_mc_ctx, &probe);
     }
 
     if (!MC_SLOT_WITHIN_BOUNDS(slot, data_size)) {
@@ -165,9 +164,65 @@ errno_t sss_nss_mc_getpwnam(const char *name, size_t name_len,
         goto done;
     }
 
+    *_rec = rec;
+    rec = NULL;
+    ret = 0;
+
+done:
+    free(rec);
+    return ret;
+}
+
+errno_t sss_nss_mc_getpwnam(const char *name, size_t name_len,
+                            struct passwd *result,
+                            char *buffer, size_t buflen)
+{
+    struct sss_mc_rec *rec = NULL;
+    int ret;
+
+    ret = sss_nss_mc_get_ctx("passwd", &pw_mc_ctx);
+    if (ret) {
+        return ret;
+    }
+
+    ret = sss_nss_mc_pw_find_name(name, name_len, &rec);
+    if (ret) {
+        goto done;
+    }
+
     ret = sss_nss_mc_parse_result(rec, result, buffer, buflen);
 
 done:
+    free(rec);
+    sss_nss_mc_count_lookup(&pw_mc_ctx, ret);
+    __sync_sub_and_fetch(&pw_mc_ctx.active_threads, 1);
+    return ret;
+}
+
+/* Only used internally to find other records of the user, it is not
+ * counted as a lookup of the passwd cache */
+errno_t sss_nss_mc_getuidbyname(const char *name, size_t name_len,
+                                uid_t *uid)
+{
+    struct sss_mc_rec *rec = NULL;
+    struct sss_mc_pwd_data *data;
+    int ret;
+
+    ret = sss_nss_mc_get_ctx("passwd", &pw_mc_ctx);
+    if (ret) {
+        return ret;
+    }
+
+    ret = sss_nss_mc_pw_find_name(name, name_len, &rec);
+    if (ret == 0) {
+        if (rec->expire < time(NULL)) {
+            ret = EINVAL;
+        } else {
+            data = (struct sss_mc_pwd_data *)rec->data;
+            *uid = data->uid;
+        }
+    }
+
     free(rec);
     __sync_sub_and_fetch(&pw_mc_ctx.active_threads, 1);
     return ret;
@@ -180,6 +235,7 @@ errno_t sss_nss_mc_getpwuid(uid_t uid,
     struct sss_mc_rec *rec = NULL;
     struct sss_mc_pwd_data *data;
     char uidstr[11];
+    struct sss_mc_probe probe;
     uint32_t hash;
     uint32_t slot;
     int len;
@@ -198,7 +254,8 @@ errno_t sss_nss_mc_getpwuid(uid_t uid,
 
     /* hashes are calculated including the NULL terminator */
     hash = sss_nss_mc_hash(&pw_mc_ctx, uidstr, len+1);
-    slot = pw_mc_ctx.hash_table[hash];
+    sss_mc_probe_init(&probe, hash, pw_mc_ctx.ht_size);
+    slot = sss_nss_mc_probe_next(&pw_mc_ctx, &probe);
 
     /* If slot is not within the bounds of mmapped region and
      * it's value is not MC_INVALID_VAL, then the cache is
@@ -216,7 +273,7 @@ errno_t sss_nss_mc_getpwuid(uid_t uid,
         /* check record matches what we are searching for */
         if (hash != rec->hash2) {
             /* if uid hash does not match we can skip this immediately */
-            slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+            slot = sss_nss_mc_probe_next(&pw_mc_ctx, &probe);
             continue;
         }
 
@@ -225,7 +282,7 @@ errno_t sss_nss_mc_getpwuid(uid_t uid,
             break;
         }
 
-        slot = sss_nss_mc_next_slot_with_hash(rec, hash);
+        slot = sss_nss_mc_probe_next(&pw_mc_ctx, &probe);
     }
 
     if (!MC_SLOT_WITHIN_BOUNDS(slot, pw_mc_ctx.dt_size)) {
@@ -237,6 +294,7 @@ errno_t sss_nss_mc_getpwuid(uid_t uid,
 
 done:
     free(rec);
+    sss_nss_mc_count_lookup(&pw_mc_ctx, ret);
     __sync_sub_and_fetch(&pw_mc_ctx.active_threads, 1);
     return ret;
 }
@@ -0,0 +1,199 @@
+/*
+ * System Security Services Daemon. NSS client interface
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Services, hosts and netgroups replies using mmap cache */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <time.h>
+#include "sss_cli.h"
+#include "nss_mc.h"
+
+static struct sss_cli_mc_ctx svc_mc_ctx = { .initialized = UNINITIALIZED,
+                                            .fd = -1 };
+static struct sss_cli_mc_ctx host_mc_ctx = { .initialized = UNINITIALIZED,
+                                             .fd = -1 };
+static struct sss_cli_mc_ctx netgr_mc_ctx = { .initialized = UNINITIALIZED,
+                                              .fd = -1 };
+
+static errno_t sss_nss_mc_reply_ctx(uint32_t cmd,
+                                    struct sss_cli_mc_ctx **_ctx,
+                                    const char **_name)
+{
+    switch (cmd) {
+    case SSS_NSS_GETSERVBYNAME:
+    case SSS_NSS_GETSERVBYPORT:
+        *_ctx = &svc_mc_ctx;
+        *_name = "services";
+        return 0;
+    case SSS_NSS_GETHOSTBYNAME:
+    case SSS_NSS_GETHOSTBYNAME2:
+    case SSS_NSS_GETHOSTBYADDR:
+        *_ctx = &host_mc_ctx;
+        *_name = "hosts";
+        return 0;
+    case SSS_NSS_SETNETGRENT:
+        *_ctx = &netgr_mc_ctx;
+        *_name = "netgroups";
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+/* Checks that ptr + len lies within the strings of the record */
+static bool sss_nss_mc_reply_in_bounds(struct sss_mc_rec *rec,
+                                       rel_ptr_t ptr, size_t len)
+{
+    struct sss_mc_reply_data *data;
+    const size_t strs_offset = offsetof(struct sss_mc_reply_data, strs);
+
+    data = (struct sss_mc_reply_data *)rec->data;
+    if (data->strs_len > rec->len
+            || ptr < strs_offset
+            || ptr > strs_offset + data->strs_len
+            || len > strs_offset + data->strs_len - ptr) {
+        return false;
+    }
+
+    return true;
+}
+
+errno_t sss_nss_mc_get_reply(uint32_t cmd,
+                             const void *req, size_t req_len,
+                             uint8_t **_repbuf, size_t *_replen)
+{
+    struct sss_cli_mc_ctx *ctx;
+    const char *name;
+    struct sss_mc_rec *rec = NULL;
+    struct sss_mc_reply_data *data;
+    struct sss_mc_probe probe;
+    const char *rec_key;
+    char *key;
+    size_t key_len;
+    uint8_t *repbuf;
+    uint32_t hash;
+    uint32_t slot;
+    int ret;
+    size_t data_size;
+
+    if (req_len == 0 || req_len > MC_REPLY_MAX_REQ_LEN) {
+        return EINVAL;
+    }
+
+    ret = sss_nss_mc_reply_ctx(cmd, &ctx, &name);
+    if (ret) {
+        return ret;
+    }
+
+    key = malloc(MC_REPLY_KEY_SIZE(req_len));
+    if (key == NULL) {
+        return ENOMEM;
+    }
+    sss_mc_reply_key(cmd, req, req_len, key);
+    key_len = strlen(key);
+
+    ret = sss_nss_mc_get_ctx(name, ctx);
+    if (ret) {
+        free(key);
+        return ret;
+    }
+
+    /* Get max size of data table. */
+    data_size = ctx->dt_size;
+
+    /* hashes are calculated including the NULL terminator */
+    hash = sss_nss_mc_hash(ctx, key, key_len + 1);
+    sss_mc_probe_init(&probe, hash, ctx->ht_size);
+    slot = sss_nss_mc_probe_next(ctx, &probe);
+
+    /* If slot is not within the bounds of mmapped region and
+     * it's value is not MC_INVALID_VAL, then the cache is
+     * probably corrupted. */
+    while (MC_SLOT_WITHIN_BOUNDS(slot, data_size)) {
+        /* free record from previous iteration */
+        free(rec);
+        rec = NULL;
+
+        ret = sss_nss_mc_get_record(ctx, slot, &rec);
+        if (ret) {
+            goto done;
+        }
+
+        /* check record matches what we are searching for */
+        if (hash != rec->hash1) {
+            /* if key hash does not match we can skip this immediately */
+            slot = sss_nss_mc_probe_next(ctx, &probe);
+            continue;
+        }
+
+        data = (struct sss_mc_reply_data *)rec->data;
+        if (!sss_nss_mc_reply_in_bounds(rec, data->key, key_len + 1)) {
+            ret = ENOENT;
+            goto done;
+        }
+
+        rec_key = (const char *)data + data->key;
+        if (memcmp(key, rec_key, key_len + 1) == 0) {
+            break;
+        }
+
+        slot = sss_nss_mc_probe_next(ctx, &probe);
+    }
+
+    if (!MC_SLOT_WITHIN_BOUNDS(slot, data_size)) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    if (rec->expire < time(NULL)) {
+        /* entry is now invalid */
+        MC_STATS_INC(ctx->stats, stale_hits);
+        ret = EINVAL;
+        goto done;
+    }
+
+    data = (struct sss_mc_reply_data *)rec->data;
+    if (data->reply_len == 0
+            || !sss_nss_mc_reply_in_bounds(rec, data->reply,
+                                           data->reply_len)) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    repbuf = malloc(data->reply_len);
+    if (repbuf == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    memcpy(repbuf, (uint8_t *)data + data->reply, data->reply_len);
+
+    *_repbuf = repbuf;
+    *_replen = data->reply_len;
+    ret = 0;
+
+done:
+    free(rec);
+    free(key);
+    sss_nss_mc_count_lookup(ctx, ret);
+    __sync_sub_and_fetch(&ctx->active_threads, 1);
+    return ret;
+}
@@ -0,0 +1,160 @@
+/*
+ * System Security Services Daemon. NSS client interface
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* SID database interface using mmap cache */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <time.h>
+#include "nss_mc.h"
+
+static struct sss_cli_mc_ctx sid_mc_ctx = { .initialized = UNINITIALIZED,
+                                            .fd = -1 };
+
+/* Returns a copy of the string at ptr if it lies within the strings of
+ * the record and is zero terminated */
+static char *sss_nss_mc_sid_str(struct sss_mc_rec *rec, rel_ptr_t ptr)
+{
+    struct sss_mc_sid_data *data;
+    const size_t strs_offset = offsetof(struct sss_mc_sid_data, strs);
+    const char *str;
+
+    data = (struct sss_mc_sid_data *)rec->data;
+    if (ptr < strs_offset
+            || ptr >= strs_offset + data->strs_len
+            || data->strs_len > rec->len) {
+        return NULL;
+    }
+
+    str = (const char *)data + ptr;
+    if (memchr(str, '\0', strs_offset + data->strs_len - ptr) == NULL) {
+        return NULL;
+    }
+
+    return strdup(str);
+}
+
+/* Looks up a record by name (by_sid == false) or by SID and returns the
+ * other key of the record together with the ID type */
+static errno_t sss_nss_mc_sid_lookup(const char *key, size_t key_len,
+                                     bool by_sid,
+                                     char **_value, uint32_t *_type)
+{
+    struct sss_mc_rec *rec = NULL;
+    struct sss_mc_sid_data *data;
+    struct sss_mc_probe probe;
+    char *rec_key;
+    char *value;
+    uint32_t hash;
+    uint32_t slot;
+    int ret;
+    size_t data_size;
+
+    ret = sss_nss_mc_get_ctx("sid", &sid_mc_ctx);
+    if (ret) {
+        return ret;
+    }
+
+    /* Get max size of data table. */
+    data_size = sid_mc_ctx.dt_size;
+
+    /* hashes are calculated including the NULL terminator */
+    hash = sss_nss_mc_hash(&sid_mc_ctx, key, key_len + 1);
+    sss_mc_probe_init(&probe, hash, sid_mc_ctx.ht_size);
+    slot = sss_nss_mc_probe_next(&sid_mc_ctx, &probe);
+
+    /* If slot is not within the bounds of mmapped region and
+     * it's value is not MC_INVALID_VAL, then the cache is
+     * probably corrupted. */
+    while (MC_SLOT_WITHIN_BOUNDS(slot, data_size)) {
+        /* free record from previous iteration */
+        free(rec);
+        rec = NULL;
+
+        ret = sss_nss_mc_get_record(&sid_mc_ctx, slot, &rec);
+        if (ret) {
+            goto done;
+        }
+
+        /* check record matches what we are searching for */
+        if (hash != (by_sid ? rec->hash2 : rec->hash1)) {
+            /* if key hash does not match we can skip this immediately */
+            slot = sss_nss_mc_probe_next(&sid_mc_ctx, &probe);
+            continue;
+        }
+
+        data = (struct sss_mc_sid_data *)rec->data;
+        rec_key = sss_nss_mc_sid_str(rec, by_sid ? data->sid : data->name);
+        if (rec_key == NULL) {
+            ret = ENOENT;
+            goto done;
+        }
+
+        ret = strcmp(key, rec_key);
+        free(rec_key);
+        if (ret == 0) {
+            break;
+        }
+
+        slot = sss_nss_mc_probe_next(&sid_mc_ctx, &probe);
+    }
+
+    if (!MC_SLOT_WITHIN_BOUNDS(slot, data_size)) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    if (rec->expire < time(NULL)) {
+        /* entry is now invalid */
+        MC_STATS_INC(sid_mc_ctx.stats, stale_hits);
+        ret = EINVAL;
+        goto done;
+    }
+
+    data = (struct sss_mc_sid_data *)rec->data;
+    value = sss_nss_mc_sid_str(rec, by_sid ? data->name : data->sid);
+    if (value == NULL) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    *_value = value;
+    *_type = data->id_type;
+    ret = 0;
+
+done:
+    free(rec);
+    sss_nss_mc_count_lookup(&sid_mc_ctx, ret);
+    __sync_sub_and_fetch(&sid_mc_ctx.active_threads, 1);
+    return ret;
+}
+
+errno_t sss_nss_mc_getsidbyname(const char *name, size_t name_len,
+                                char **sid, uint32_t *type)
+{
+    return sss_nss_mc_sid_lookup(name, name_len, false, sid, type);
+}
+
+errno_t sss_nss_mc_getnamebysid(const char *sid, size_t sid_len,
+                                char **name, uint32_t *type)
+{
+    return sss_nss_mc_sid_lookup(sid, sid_len, true, name, type);
+}
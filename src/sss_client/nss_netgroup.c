@@ -32,6 +32,7 @@
 #include <string.h>
 #include "sss_cli.h"
 #include "nss_compat.h"
+#include "nss_mc.h"
 
 #define CLEAR_NETGRENT_DATA(netgrent) do { \
         free(netgrent->data); \
@@ -53,6 +54,24 @@
  *  ... repeated N times
  */
 #define NETGR_METADATA_COUNT 2 * sizeof(uint32_t)
+
+/* Set in the reserved field of result->data when the data holds the whole
+ * netgroup as read from the memory cache, so there is nothing left to ask
+ * the responder for once it is exhausted. */
+#define NETGR_MC_COMPLETE 0x4d43
+
+static bool sss_nss_netgr_data_complete(struct __netgrent *result)
+{
+    uint32_t reserved;
+
+    if (result->data == NULL || result->data_size < NETGR_METADATA_COUNT) {
+        return false;
+    }
+
+    SAFEALIGN_COPY_UINT32(&reserved, result->data + sizeof(uint32_t), NULL);
+    return reserved == NETGR_MC_COMPLETE;
+}
+
 struct sss_nss_netgr_rep {
     struct __netgrent *result;
     char *buffer;
@@ -191,6 +210,29 @@ enum nss_status _nss_sss_setnetgrent(const char *netgroup,
     rd.data = name;
     rd.len = name_len + 1;
 
+    /* The memory cache holds the complete netgroup in the format of a
+     * GETNETGRENT reply, serve all entries from it. */
+    ret = sss_nss_mc_get_reply(SSS_NSS_SETNETGRENT, rd.data, rd.len,
+                               &repbuf, &replen);
+    if (ret == 0) {
+        free(name);
+        SAFEALIGN_COPY_UINT32(&num_results, repbuf, NULL);
+        if ((num_results == 0) || (replen <= NETGR_METADATA_COUNT)) {
+            free(repbuf);
+            nret = NSS_STATUS_NOTFOUND;
+            goto out;
+        }
+
+        SAFEALIGN_SETMEM_UINT32(repbuf + sizeof(uint32_t),
+                                NETGR_MC_COMPLETE, NULL);
+        result->data = (char *) repbuf;
+        result->data_size = replen;
+        /* skip metadata fields */
+        result->idx.position = NETGR_METADATA_COUNT;
+        nret = NSS_STATUS_SUCCESS;
+        goto out;
+    }
+
     nret = sss_nss_make_request(SSS_NSS_SETNETGRENT, &rd,
                                 &repbuf, &replen, &errnop);
     free(name);
@@ -260,6 +302,12 @@ static enum nss_status internal_getnetgrent_r(struct __netgrent *result,
         return NSS_STATUS_SUCCESS;
     }
 
+    /* All entries were served from the memory cache */
+    if (sss_nss_netgr_data_complete(result)) {
+        CLEAR_NETGRENT_DATA(result);
+        return NSS_STATUS_RETURN;
+    }
+
     /* Release memory, if any */
     CLEAR_NETGRENT_DATA(result);
 
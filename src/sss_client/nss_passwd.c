@@ -171,7 +171,7 @@ enum nss_status _nss_sss_getpwnam_r(const char *name, struct passwd *result,
     rd.len = name_len + 1;
     rd.data = name;
 
-    sss_nss_lock();
+    sss_nss_lookup_lock();
 
     /* previous thread might already initialize entry in mmap cache */
     ret = sss_nss_mc_getpwnam(name, name_len, result, buffer, buflen);
@@ -234,7 +234,7 @@ enum nss_status _nss_sss_getpwnam_r(const char *name, struct passwd *result,
     nret = NSS_STATUS_SUCCESS;
 
 out:
-    sss_nss_unlock();
+    sss_nss_lookup_unlock();
     return nret;
 }
 
@@ -278,7 +278,7 @@ enum nss_status _nss_sss_getpwuid_r(uid_t uid, struct passwd *result,
     rd.len = sizeof(uint32_t);
     rd.data = &user_uid;
 
-    sss_nss_lock();
+    sss_nss_lookup_lock();
 
     /* previous thread might already initialize entry in mmap cache */
     ret = sss_nss_mc_getpwuid(uid, result, buffer, buflen);
@@ -341,7 +341,7 @@ enum nss_status _nss_sss_getpwuid_r(uid_t uid, struct passwd *result,
     nret = NSS_STATUS_SUCCESS;
 
 out:
-    sss_nss_unlock();
+    sss_nss_lookup_unlock();
     return nret;
 }
 
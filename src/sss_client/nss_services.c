@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "sss_cli.h"
+#include "nss_mc.h"
 
 static struct sss_nss_getservent_data {
     size_t len;
@@ -215,8 +216,15 @@ _nss_sss_getservbyname_r(const char *name,
 
     sss_nss_lock();
 
-    nret = sss_nss_make_request(SSS_NSS_GETSERVBYNAME, &rd,
-                                &repbuf, &replen, errnop);
+    ret = sss_nss_mc_get_reply(SSS_NSS_GETSERVBYNAME, rd.data, rd.len,
+                               &repbuf, &replen);
+    if (ret == 0) {
+        nret = NSS_STATUS_SUCCESS;
+    } else {
+        /* not in the memory cache, ask the responder */
+        nret = sss_nss_make_request(SSS_NSS_GETSERVBYNAME, &rd,
+                                    &repbuf, &replen, errnop);
+    }
     free(data);
     if (nret != NSS_STATUS_SUCCESS) {
         goto out;
@@ -317,8 +325,15 @@ _nss_sss_getservbyport_r(int port, const char *protocol,
 
     sss_nss_lock();
 
-    nret = sss_nss_make_request(SSS_NSS_GETSERVBYPORT, &rd,
-                                &repbuf, &replen, errnop);
+    ret = sss_nss_mc_get_reply(SSS_NSS_GETSERVBYPORT, rd.data, rd.len,
+                               &repbuf, &replen);
+    if (ret == 0) {
+        nret = NSS_STATUS_SUCCESS;
+    } else {
+        /* not in the memory cache, ask the responder */
+        nret = sss_nss_make_request(SSS_NSS_GETSERVBYPORT, &rd,
+                                    &repbuf, &replen, errnop);
+    }
     free(data);
     if (nret != NSS_STATUS_SUCCESS) {
         goto out;
@@ -47,6 +47,7 @@ typedef int errno_t;
 #define SSS_NSS_PROTOCOL_VERSION 1
 #define SSS_PAM_PROTOCOL_VERSION 3
 #define SSS_SUDO_PROTOCOL_VERSION 1
+#define SSS_SUDO_BIN_RESPONSE_VERSION 1
 #define SSS_AUTOFS_PROTOCOL_VERSION 1
 #define SSS_SSH_PROTOCOL_VERSION 0
 #define SSS_PAC_PROTOCOL_VERSION 1
@@ -81,6 +82,10 @@ enum sss_cli_command {
 
     SSS_NSS_GETPWNAM_EX    = 0x0019,
     SSS_NSS_GETPWUID_EX    = 0x001A,
+    SSS_NSS_GETPWUID_MULTI = 0x001B, /**< Takes an unsigned 32bit count
+                                          followed by count UIDs and returns
+                                          the found users in the format of
+                                          SSS_NSS_GETPWENT */
 
 /* group */
 
@@ -93,7 +98,18 @@ enum sss_cli_command {
 
     SSS_NSS_GETGRNAM_EX    = 0x0029,
     SSS_NSS_GETGRGID_EX    = 0x002A,
+    SSS_NSS_GETGRGID_MULTI = 0x002B, /**< Takes an unsigned 32bit count
+                                          followed by count GIDs and returns
+                                          the found groups in the format of
+                                          SSS_NSS_GETGRENT */
     SSS_NSS_INITGR_EX      = 0x002E,
+    SSS_NSS_GETPWNAM_INITGR = 0x002F, /**< Takes a name and unsigned 32bit
+                                           flags as SSS_NSS_GETPWNAM_EX and
+                                           returns the length of the
+                                           SSS_NSS_GETPWNAM_EX reply as
+                                           unsigned 32bit integer, the reply
+                                           itself and the SSS_NSS_INITGR_EX
+                                           reply of the same user */
 
 #if 0
 /* aliases */
@@ -127,7 +143,13 @@ enum sss_cli_command {
     SSS_NSS_SETNETGRENT    = 0x0061,
     SSS_NSS_GETNETGRENT    = 0x0062,
     SSS_NSS_ENDNETGRENT    = 0x0063,
-    /* SSS_NSS_INNETGR     = 0x0064, */
+    SSS_NSS_INNETGR        = 0x0064, /**< Takes the netgroup, host, user and
+                                          domain as NUL terminated strings,
+                                          an empty string matches any
+                                          value. Returns one result if the
+                                          triple is in the netgroup or in a
+                                          netgroup nested in it and no
+                                          result otherwise. */
 
 /* networks */
 
@@ -176,6 +198,12 @@ enum sss_cli_command {
 /* SUDO */
     SSS_SUDO_GET_SUDORULES = 0x00C1,
     SSS_SUDO_GET_DEFAULTS  = 0x00C2,
+    SSS_SUDO_GET_SUDORULES_BIN = 0x00C3, /**< same as SSS_SUDO_GET_SUDORULES
+                                          * with the strings of the reply
+                                          * deduplicated in a table */
+    SSS_SUDO_GET_DEFAULTS_BIN  = 0x00C4, /**< same as SSS_SUDO_GET_DEFAULTS
+                                          * with the strings of the reply
+                                          * deduplicated in a table */
 
 /* autofs */
     SSS_AUTOFS_SETAUTOMNTENT    = 0x00D1,
@@ -235,6 +263,9 @@ enum sss_cli_command {
                                         * are available for the given user. */
     SSS_GSSAPI_INIT          = 0x00FA, /**< Initialize GSSAPI authentication. */
     SSS_GSSAPI_SEC_CTX       = 0x00FB, /**< Establish GSSAPI security ctx. */
+    SSS_CMD_FAST_ARMOR       = 0x00FC, /**< Refresh the FAST armor ccache of
+                                        * the backend, only sent by the
+                                        * backend to krb5_child */
 
 /* PAC responder calls */
     SSS_PAC_ADD_PAC_USER     = 0x0101,
@@ -284,6 +315,35 @@ SSS_NSS_GETSIDBYGID   = 0x0119, /**< Takes an unsigned 32bit integer (POSIX GID)
                                      and return the zero terminated string
                                      representation of the SID of the object
                                      with the given UID. */
+SSS_NSS_GETSIDBYID_MULTI = 0x011A, /**< Takes an unsigned 32bit count
+                                        followed by count pairs of an
+                                        unsigned 32bit POSIX ID and its type
+                                        (unknown, user, group) and returns
+                                        for each found object the index of
+                                        its ID in the request, its type and
+                                        the zero terminated string
+                                        representation of its SID. */
+SSS_NSS_GETIDBYSID_MULTI = 0x011B, /**< Takes an unsigned 32bit count
+                                        followed by count zero terminated
+                                        string representations of SIDs and
+                                        returns for each found object the
+                                        index of its SID in the request, its
+                                        type and its POSIX ID as unsigned
+                                        32bit integer values. */
+SSS_NSS_GETSIDBYNAME_MULTI = 0x011C, /**< Takes an unsigned 32bit count
+                                          followed by count zero terminated
+                                          fully qualified names and returns
+                                          for each found object the index of
+                                          its name in the request, its type
+                                          and the zero terminated string
+                                          representation of its SID. */
+SSS_NSS_GETNAMEBYSID_MULTI = 0x011D, /**< Takes an unsigned 32bit count
+                                          followed by count zero terminated
+                                          string representations of SIDs and
+                                          returns for each found object the
+                                          index of its SID in the request, its
+                                          type and its zero terminated fully
+                                          qualified name. */
 };
 
 /**
@@ -386,6 +446,12 @@ enum pam_item_type {
 
 #define SSS_NSS_MAX_ENTRIES 256
 #define SSS_NSS_HEADER_SIZE (sizeof(uint32_t) * 4)
+
+/* Maximum number of IDs, SIDs or names in one SSS_NSS_GETPWUID_MULTI,
+ * SSS_NSS_GETGRGID_MULTI, SSS_NSS_GETSIDBYID_MULTI,
+ * SSS_NSS_GETIDBYSID_MULTI, SSS_NSS_GETSIDBYNAME_MULTI or
+ * SSS_NSS_GETNAMEBYSID_MULTI request */
+#define SSS_NSS_MULTI_MAX_IDS 128
 struct sss_cli_req_data {
     size_t len;
     const void *data;
@@ -636,6 +702,14 @@ enum nss_status sss_nss_make_request(enum sss_cli_command cmd,
                                      uint8_t **repbuf, size_t *replen,
                                      int *errnop);
 
+/* Returns a new tag for a request, never 0 */
+uint32_t sss_cli_next_tag(void);
+
+/* Opens a non-blocking connection to socket_name without waiting. If
+ * *errnop is set to EINPROGRESS the connection completes once the socket
+ * becomes writable. Returns -1 on error. */
+int sss_cli_open_socket_nb(const char *socket_name, int *errnop);
+
 enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
                                              struct sss_cli_req_data *rd,
                                              int timeout,
@@ -709,6 +783,9 @@ errno_t sss_strnlen(const char *str, size_t maxlen, size_t *len);
 
 void sss_nss_lock(void);
 void sss_nss_unlock(void);
+/* Lock for user lookups and initgroups, a no-op with per-thread sockets */
+void sss_nss_lookup_lock(void);
+void sss_nss_lookup_unlock(void);
 void sss_pam_lock(void);
 void sss_pam_unlock(void);
 void sss_nss_mc_lock(void);
@@ -35,13 +35,8 @@ static int sss_sudo_create_query(uid_t uid,
                                  uint8_t **_query,
                                  size_t *_query_len);
 
-static void sss_sudo_free_rules(unsigned int num_rules,
-                                struct sss_sudo_rule *rules);
-
-static void sss_sudo_free_attrs(unsigned int num_attrs,
-                                struct sss_sudo_attr *attrs);
-
 static int sss_sudo_send_recv_generic(enum sss_cli_command command,
+                                      enum sss_cli_command bin_command,
                                       uid_t uid,
                                       const char *username,
                                       uint32_t *_error,
@@ -66,7 +61,29 @@ static int sss_sudo_send_recv_generic(enum sss_cli_command command,
     request.len = query_len;
     request.data = (const void*)query_buf;
 
-    /* send query and receive response */
+    /* send query and receive response, prefer the binary format */
+
+    errnop = 0;
+    ret = sss_sudo_make_request(bin_command, &request,
+                                &reply_buf, &reply_len, &errnop);
+    if (ret == SSS_STATUS_SUCCESS) {
+        if (_domainname != NULL) {
+            *_domainname = NULL;
+        }
+
+        ret = sss_sudo_parse_response_bin((const char*)reply_buf, reply_len,
+                                          _result, _error);
+        goto done;
+    } else if (errnop == ETIME || errnop == ETIMEDOUT) {
+        ret = errnop;
+        goto done;
+    }
+
+    /* Older responders do not know the binary command and close the
+     * connection, ask again with the legacy one. */
+    free(reply_buf);
+    reply_buf = NULL;
+    reply_len = 0;
 
     errnop = 0;
     ret = sss_sudo_make_request(command, &request,
@@ -101,8 +118,9 @@ int sss_sudo_send_recv(uid_t uid,
 
     /* send query and receive response */
 
-    ret = sss_sudo_send_recv_generic(SSS_SUDO_GET_SUDORULES, uid, username,
-                                     _error, NULL, _result);
+    ret = sss_sudo_send_recv_generic(SSS_SUDO_GET_SUDORULES,
+                                     SSS_SUDO_GET_SUDORULES_BIN,
+                                     uid, username, _error, NULL, _result);
     return ret;
 }
 
@@ -116,8 +134,10 @@ int sss_sudo_send_recv_defaults(uid_t uid,
         return EINVAL;
     }
 
-    return sss_sudo_send_recv_generic(SSS_SUDO_GET_DEFAULTS, uid, username,
-                                      _error, _domainname, _result);
+    return sss_sudo_send_recv_generic(SSS_SUDO_GET_DEFAULTS,
+                                      SSS_SUDO_GET_DEFAULTS_BIN,
+                                      uid, username, _error, _domainname,
+                                      _result);
 }
 
 static int sss_sudo_create_query(uid_t uid, const char *username,
@@ -194,58 +214,3 @@ void sss_sudo_free_values(char **values)
 
     free(values);
 }
-
-void sss_sudo_free_result(struct sss_sudo_result *result)
-{
-    if (result == NULL) {
-        return;
-    }
-
-    sss_sudo_free_rules(result->num_rules, result->rules);
-    free(result);
-}
-
-void sss_sudo_free_rules(unsigned int num_rules, struct sss_sudo_rule *rules)
-{
-    struct sss_sudo_rule *rule = NULL;
-    int i;
-
-    if (rules == NULL) {
-        return;
-    }
-
-    for (i = 0; i < num_rules; i++) {
-        rule = rules + i;
-
-        sss_sudo_free_attrs(rule->num_attrs, rule->attrs);
-        rule->attrs = NULL;
-    }
-
-    free(rules);
-}
-
-void sss_sudo_free_attrs(unsigned int num_attrs, struct sss_sudo_attr *attrs)
-{
-    struct sss_sudo_attr *attr = NULL;
-    int i, j;
-
-    if (attrs == NULL) {
-        return;
-    }
-
-    for (i = 0; i < num_attrs; i++) {
-        attr = attrs + i;
-
-        free(attr->name);
-        attr->name = NULL;
-
-        for (j = 0; j < attr->num_values; j++) {
-            free(attr->values[j]);
-            attr->values[j] = NULL;
-        }
-
-        free(attr->values);
-    }
-
-    free(attrs);
-}
@@ -156,6 +156,9 @@ int sss_sudo_send_recv_defaults(uid_t uid,
 /**
  * @brief Free the sss_result structure returned by sss_sudo_send_recv
  *
+ * The result is stored in a single buffer together with all of its rules,
+ * attributes and values, they are all released by this call.
+ *
  * @param[in] result    The sss_result structure to free. The structure was
  *                      previously returned by sss_sudo_get_values().
  */
@@ -181,6 +184,27 @@ int sss_sudo_get_values(struct sss_sudo_rule *e,
                         const char *attrname,
                         char ***values);
 
+/**
+ * @brief Get all values for a given attribute in an sss_rule without
+ * copying them
+ *
+ * @param[in] e           The sss_rule to get values from
+ * @param[in] attrname    The name of the attribute to query from the rule
+ * @param[out] values     A NULL terminated list of values the attribute has
+ *                        in rule. The list points into the result the rule
+ *                        belongs to and remains valid until the result is
+ *                        freed with sss_sudo_free_result(). On failure
+ *                        (including when the attribute is not found), the
+ *                        pointer address is not changed.
+ *
+ * @return 0 on success, ENOENT in case the attribute is not found.
+ *
+ * @note the returned values must not be modified or freed
+ */
+int sss_sudo_get_values_view(struct sss_sudo_rule *e,
+                             const char *attrname,
+                             const char * const **values);
+
 /**
  * @brief Free the values returned by sss_sudo_get_values
  *
@@ -30,4 +30,9 @@ int sss_sudo_parse_response(const char *message,
                             struct sss_sudo_result **_result,
                             uint32_t *_error);
 
+int sss_sudo_parse_response_bin(const char *message,
+                                size_t message_len,
+                                struct sss_sudo_result **_result,
+                                uint32_t *_error);
+
 #endif /* SSS_SUDO_PRIVATE_H_ */
@@ -24,171 +24,392 @@
 #include <errno.h>
 #include <string.h>
 #include <stdint.h>
+#include <strings.h>
 
 #include "sss_client/sss_cli.h"
 #include "sss_client/sudo/sss_sudo.h"
 #include "sss_client/sudo/sss_sudo_private.h"
 
-static int sss_sudo_parse_rule(const char *message,
-                               size_t message_len,
-                               size_t *_cursor,
-                               struct sss_sudo_rule *_rule);
-
-static int sss_sudo_parse_attr(const char *message,
-                               size_t message_len,
-                               size_t *_cursor,
-                               struct sss_sudo_attr *_attr);
+/*
+ * All parts of a result are stored in a single allocation:
+ * <sss_sudo_result><rules><attrs><values><strings>
+ *
+ * Every values array is NULL terminated and points into <strings>, so the
+ * values can be handed out without copying them and the whole result is
+ * released with a single free(). The sizes of all the structures are
+ * multiples of the pointer alignment, the parts stay properly aligned.
+ */
+struct sss_sudo_result_size {
+    size_t num_rules;
+    size_t num_attrs;
+    size_t num_values;
+    size_t strings_len;
+};
+
+struct sss_sudo_result_fill {
+    struct sss_sudo_result *result;
+    struct sss_sudo_attr *attrs;
+    char **values;
+    char *strings;
+};
+
+/* Binary responses reference the strings by their offset in a table,
+ * legacy responses send them inline. */
+struct sss_sudo_strings {
+    const char *table;
+    size_t len;
+};
 
 static int sss_sudo_parse_uint32(const char *message,
                                  size_t message_len,
                                  size_t *_cursor,
                                  uint32_t *_number);
 
-static int sss_sudo_parse_string(const char *message,
+static int sss_sudo_parse_strlen(const char *message,
                                  size_t message_len,
                                  size_t *_cursor,
-                                 char **_str);
+                                 size_t *_len);
 
-int sss_sudo_parse_response(const char *message,
-                            size_t message_len,
-                            char **_domainname,
-                            struct sss_sudo_result **_result,
-                            uint32_t *_error)
+static int sss_sudo_size_add(size_t *_total, size_t count, size_t size)
 {
-    struct sss_sudo_result *result = NULL;
-    char *domainname = NULL;
-    size_t cursor = 0;
-    int ret = EOK;
-    int i = 0;
+    if (size != 0 && count > (SIZE_MAX - *_total) / size) {
+        return EINVAL;
+    }
 
-    /* error code */
-    ret = sss_sudo_parse_uint32(message, message_len, &cursor, _error);
-    if (ret != EOK || *_error != SSS_SUDO_ERROR_OK) {
-        return ret;
+    *_total += count * size;
+
+    return EOK;
+}
+
+static struct sss_sudo_result *
+sss_sudo_result_alloc(struct sss_sudo_result_size *size,
+                      struct sss_sudo_result_fill *_fill)
+{
+    struct sss_sudo_result *result;
+    size_t total = sizeof(struct sss_sudo_result);
+    uint8_t *buf;
+
+    if (sss_sudo_size_add(&total, size->num_rules,
+                          sizeof(struct sss_sudo_rule)) != EOK
+            || sss_sudo_size_add(&total, size->num_attrs,
+                                 sizeof(struct sss_sudo_attr)) != EOK
+            || sss_sudo_size_add(&total, size->num_values,
+                                 sizeof(char *)) != EOK
+            || sss_sudo_size_add(&total, size->strings_len, 1) != EOK) {
+        return NULL;
     }
 
-    /* domain name - deprecated
-     * it won't be used, but we will read it anyway to ease parsing
-     * TODO: when possible change the protocol */
-    ret = sss_sudo_parse_string(message, message_len, &cursor, &domainname);
+    buf = calloc(1, total);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    result = (struct sss_sudo_result *)buf;
+    buf += sizeof(struct sss_sudo_result);
+
+    result->num_rules = size->num_rules;
+    result->rules = (struct sss_sudo_rule *)buf;
+    buf += size->num_rules * sizeof(struct sss_sudo_rule);
+
+    _fill->result = result;
+    _fill->attrs = (struct sss_sudo_attr *)buf;
+    buf += size->num_attrs * sizeof(struct sss_sudo_attr);
+
+    _fill->values = (char **)buf;
+    buf += size->num_values * sizeof(char *);
+
+    _fill->strings = (char *)buf;
+
+    return result;
+}
+
+static int sss_sudo_parse_value(const char *message,
+                                size_t message_len,
+                                size_t *_cursor,
+                                struct sss_sudo_strings *strings,
+                                struct sss_sudo_result_size *size,
+                                struct sss_sudo_result_fill *fill,
+                                char **_value)
+{
+    size_t start = *_cursor;
+    uint32_t offset;
+    size_t len;
+    int ret;
+
+    if (strings != NULL) {
+        ret = sss_sudo_parse_uint32(message, message_len, _cursor, &offset);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        /* the table is zero terminated, any offset gives a valid string */
+        if (offset >= strings->len) {
+            return EINVAL;
+        }
+
+        if (fill != NULL) {
+            *_value = fill->strings + offset;
+        }
+
+        return EOK;
+    }
+
+    ret = sss_sudo_parse_strlen(message, message_len, _cursor, &len);
     if (ret != EOK) {
         return ret;
     }
 
-    free(domainname);
-    if (_domainname != NULL) {
-        *_domainname = NULL;
+    if (fill == NULL) {
+        size->strings_len += len + 1;
+        return EOK;
     }
 
-    /* result */
-    result = malloc(sizeof(struct sss_sudo_result));
-    if (result == NULL) {
-        return ENOMEM;
-    }
+    memcpy(fill->strings, message + start, len + 1);
+    *_value = fill->strings;
+    fill->strings += len + 1;
+
+    return EOK;
+}
 
-    memset(result, 0, sizeof(struct sss_sudo_result));
+/*
+ * <num_entries(uint32_t)><rule1><rule2>...
+ * <ruleN> = <num_attrs(uint32_t)><attr1><attr2>...
+ * <attrN>  = <name><num_values(uint32_t)><value1><value2>...
+ *
+ * Without @fill the rules are only validated and their size is computed,
+ * with @fill the result is filled in.
+ */
+static int sss_sudo_parse_rules(const char *message,
+                                size_t message_len,
+                                size_t cursor,
+                                struct sss_sudo_strings *strings,
+                                struct sss_sudo_result_size *size,
+                                struct sss_sudo_result_fill *fill)
+{
+    struct sss_sudo_rule *rule = NULL;
+    struct sss_sudo_attr *attr = NULL;
+    uint32_t num_rules;
+    uint32_t num_attrs;
+    uint32_t num_values;
+    uint32_t i, j, k;
+    int ret;
 
     /* rules_num */
-    ret = sss_sudo_parse_uint32(message, message_len,
-                                &cursor, &result->num_rules);
+    ret = sss_sudo_parse_uint32(message, message_len, &cursor, &num_rules);
     if (ret != EOK) {
-        goto fail;
-    }
-
-    /* rules */
-    result->rules = calloc(result->num_rules, sizeof(struct sss_sudo_rule));
-    if (result->rules == NULL) {
-        ret = ENOMEM;
-        goto fail;
+        return ret;
     }
 
-    for (i = 0; i < result->num_rules; i++) {
-        ret = sss_sudo_parse_rule(message, message_len,
-                                  &cursor, &result->rules[i]);
+    for (i = 0; i < num_rules; i++) {
+        /* attrs_num */
+        ret = sss_sudo_parse_uint32(message, message_len,
+                                    &cursor, &num_attrs);
         if (ret != EOK) {
-            goto fail;
+            return ret;
+        }
+
+        if (fill != NULL) {
+            rule = &fill->result->rules[i];
+            rule->num_attrs = num_attrs;
+            rule->attrs = fill->attrs;
+            fill->attrs += num_attrs;
+        } else {
+            size->num_attrs += num_attrs;
+        }
+
+        for (j = 0; j < num_attrs; j++) {
+            if (fill != NULL) {
+                attr = &rule->attrs[j];
+            }
+
+            /* name */
+            ret = sss_sudo_parse_value(message, message_len, &cursor,
+                                       strings, size, fill,
+                                       attr != NULL ? &attr->name : NULL);
+            if (ret != EOK) {
+                return ret;
+            }
+
+            /* values_num */
+            ret = sss_sudo_parse_uint32(message, message_len,
+                                        &cursor, &num_values);
+            if (ret != EOK) {
+                return ret;
+            }
+
+            if (fill != NULL) {
+                attr->num_values = num_values;
+                attr->values = fill->values;
+                fill->values += num_values + 1;
+            } else {
+                size->num_values += num_values + 1;
+            }
+
+            /* values */
+            for (k = 0; k < num_values; k++) {
+                ret = sss_sudo_parse_value(message, message_len, &cursor,
+                                           strings, size, fill,
+                                           attr != NULL ? &attr->values[k]
+                                                        : NULL);
+                if (ret != EOK) {
+                    return ret;
+                }
+            }
         }
     }
 
-    *_result = result;
+    if (fill == NULL) {
+        size->num_rules = num_rules;
+    }
 
     return EOK;
-
-fail:
-    sss_sudo_free_result(result);
-    return ret;
 }
 
-int sss_sudo_parse_rule(const char *message,
-                        size_t message_len,
-                        size_t *_cursor,
-                        struct sss_sudo_rule *_rule)
+static int sss_sudo_build_result(const char *message,
+                                 size_t message_len,
+                                 size_t cursor,
+                                 struct sss_sudo_strings *strings,
+                                 struct sss_sudo_result **_result)
 {
-    int ret = EOK;
-    int i = 0;
+    struct sss_sudo_result_size size;
+    struct sss_sudo_result_fill fill;
+    struct sss_sudo_result *result;
+    int ret;
+
+    memset(&size, 0, sizeof(size));
+    if (strings != NULL) {
+        size.strings_len = strings->len;
+    }
 
-    /* attrs_num */
-    ret = sss_sudo_parse_uint32(message, message_len,
-                                _cursor, &_rule->num_attrs);
+    ret = sss_sudo_parse_rules(message, message_len, cursor,
+                               strings, &size, NULL);
     if (ret != EOK) {
-       return ret;
+        return ret;
     }
 
-    /* attrs */
-    _rule->attrs = calloc(_rule->num_attrs, sizeof(struct sss_sudo_attr));
-    if (_rule->attrs == NULL) {
+    result = sss_sudo_result_alloc(&size, &fill);
+    if (result == NULL) {
         return ENOMEM;
     }
 
-    for (i = 0; i < _rule->num_attrs; i++) {
-        ret = sss_sudo_parse_attr(message, message_len,
-                                  _cursor, &_rule->attrs[i]);
-        if (ret != EOK) {
-           return ret;
-        }
+    if (strings != NULL && strings->len > 0) {
+        memcpy(fill.strings, strings->table, strings->len);
     }
 
+    ret = sss_sudo_parse_rules(message, message_len, cursor,
+                               strings, &size, &fill);
+    if (ret != EOK) {
+        free(result);
+        return ret;
+    }
+
+    *_result = result;
+
     return EOK;
 }
 
-int sss_sudo_parse_attr(const char *message,
-                        size_t message_len,
-                        size_t *_cursor,
-                        struct sss_sudo_attr *_attr)
+int sss_sudo_parse_response(const char *message,
+                            size_t message_len,
+                            char **_domainname,
+                            struct sss_sudo_result **_result,
+                            uint32_t *_error)
+{
+    size_t cursor = 0;
+    size_t len;
+    int ret = EOK;
+
+    /* error code */
+    ret = sss_sudo_parse_uint32(message, message_len, &cursor, _error);
+    if (ret != EOK || *_error != SSS_SUDO_ERROR_OK) {
+        return ret;
+    }
+
+    /* domain name - deprecated
+     * it won't be used, but we will read it anyway to ease parsing
+     * TODO: when possible change the protocol */
+    ret = sss_sudo_parse_strlen(message, message_len, &cursor, &len);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (_domainname != NULL) {
+        *_domainname = NULL;
+    }
+
+    return sss_sudo_build_result(message, message_len, cursor, NULL, _result);
+}
+
+int sss_sudo_parse_response_bin(const char *message,
+                                size_t message_len,
+                                struct sss_sudo_result **_result,
+                                uint32_t *_error)
 {
-    char *str = NULL;
+    struct sss_sudo_strings strings;
+    size_t cursor = 0;
+    uint32_t version;
+    uint32_t strings_len;
     int ret = EOK;
-    int i = 0;
 
-    /* name */
-    ret = sss_sudo_parse_string(message, message_len, _cursor, &str);
+    /* error code */
+    ret = sss_sudo_parse_uint32(message, message_len, &cursor, _error);
+    if (ret != EOK || *_error != SSS_SUDO_ERROR_OK) {
+        return ret;
+    }
+
+    /* version */
+    ret = sss_sudo_parse_uint32(message, message_len, &cursor, &version);
     if (ret != EOK) {
         return ret;
     }
-    _attr->name = str;
 
-    /* values_num */
-    ret = sss_sudo_parse_uint32(message, message_len,
-                                _cursor, &_attr->num_values);
+    if (version != SSS_SUDO_BIN_RESPONSE_VERSION) {
+        return EINVAL;
+    }
+
+    /* strings table */
+    ret = sss_sudo_parse_uint32(message, message_len, &cursor, &strings_len);
     if (ret != EOK) {
         return ret;
     }
 
-    /* values */
-    _attr->values = calloc(_attr->num_values, sizeof(const char*));
-    if (_attr->values == NULL) {
-        return ENOMEM;
+    if (strings_len > message_len - cursor) {
+        return EINVAL;
     }
 
-    for (i = 0; i < _attr->num_values; i++) {
-        ret = sss_sudo_parse_string(message, message_len, _cursor, &str);
-        if (ret != EOK) {
-            return ret;
+    if (strings_len > 0 && message[cursor + strings_len - 1] != '\0') {
+        return EINVAL;
+    }
+
+    strings.table = message + cursor;
+    strings.len = strings_len;
+    cursor += strings_len;
+
+    return sss_sudo_build_result(message, message_len, cursor,
+                                 &strings, _result);
+}
+
+int sss_sudo_get_values_view(struct sss_sudo_rule *e,
+                             const char *attrname,
+                             const char * const **_values)
+{
+    struct sss_sudo_attr *attr = NULL;
+    unsigned int i;
+
+    for (i = 0; i < e->num_attrs; i++) {
+        attr = e->attrs + i;
+        if (strcasecmp(attr->name, attrname) == 0) {
+            *_values = (const char * const *)attr->values;
+            return EOK;
         }
-        _attr->values[i] = str;
     }
 
-    return EOK;
+    return ENOENT;
+}
+
+void sss_sudo_free_result(struct sss_sudo_result *result)
+{
+    /* the result is allocated together with all of its content */
+    free(result);
 }
 
 int sss_sudo_parse_uint32(const char *message,
@@ -215,13 +436,12 @@ int sss_sudo_parse_uint32(const char *message,
     return EOK;
 }
 
-int sss_sudo_parse_string(const char *message,
+int sss_sudo_parse_strlen(const char *message,
                           size_t message_len,
                           size_t *_cursor,
-                          char **_str)
+                          size_t *_len)
 {
     const char *current = NULL;
-    char *str = NULL;
     size_t start_pos = 0;
     size_t len = 0;
     size_t maxlen = 0;
@@ -231,12 +451,12 @@ int sss_sudo_parse_string(const char *message,
     }
 
     start_pos = *_cursor;
-    maxlen = message_len - start_pos;
 
     if (start_pos >= message_len ) {
         return EINVAL;
     }
 
+    maxlen = message_len - start_pos;
     current = message + start_pos;
     len = strnlen(current, maxlen);
     if (len == maxlen) {
@@ -244,14 +464,9 @@ int sss_sudo_parse_string(const char *message,
         return EINVAL;
     }
 
-    str = strndup(current, len);
-    if (str == NULL) {
-        return ENOMEM;
-    }
-
     /* go after \0 */
     *_cursor = start_pos + len + 1;
-    *_str = str;
+    *_len = len;
 
     return EOK;
 }
@@ -56,6 +56,75 @@ errno_t _sbus_sss_invoker_write_as
     return EOK;
 }
 
+errno_t _sbus_sss_invoker_read_asatatatau
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatau *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_as(mem_ctx, iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_au(mem_ctx, iter, &args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_asatatatau
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatau *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_as(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_au(iter, args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
 errno_t _sbus_sss_invoker_read_b
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
@@ -279,6 +348,45 @@ errno_t _sbus_sss_invoker_write_s
     return EOK;
 }
 
+errno_t _sbus_sss_invoker_read_sas
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_sas *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_as(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_sas
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_sas *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_s(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_as(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
 errno_t _sbus_sss_invoker_read_sqq
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
@@ -416,14 +524,39 @@ errno_t _sbus_sss_invoker_write_ssau
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_read_u
+errno_t _sbus_sss_invoker_read_tauatatatat
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_u *args)
+    struct _sbus_sss_invoker_args_tauatatatat *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_read_u(iter, &args->arg0);
+    ret = sbus_iterator_read_t(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_au(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg5);
     if (ret != EOK) {
         return ret;
     }
@@ -431,13 +564,38 @@ errno_t _sbus_sss_invoker_read_u
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_write_u
+errno_t _sbus_sss_invoker_write_tauatatatat
    (DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_u *args)
+    struct _sbus_sss_invoker_args_tauatatatat *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_write_u(iter, args->arg0);
+    ret = sbus_iterator_write_t(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_au(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg5);
     if (ret != EOK) {
         return ret;
     }
@@ -445,19 +603,19 @@ errno_t _sbus_sss_invoker_write_u
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_read_us
+errno_t _sbus_sss_invoker_read_tt
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_us *args)
+    struct _sbus_sss_invoker_args_tt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_read_u(iter, &args->arg0);
+    ret = sbus_iterator_read_t(iter, &args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg1);
+    ret = sbus_iterator_read_t(iter, &args->arg1);
     if (ret != EOK) {
         return ret;
     }
@@ -465,18 +623,18 @@ errno_t _sbus_sss_invoker_read_us
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_write_us
+errno_t _sbus_sss_invoker_write_tt
    (DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_us *args)
+    struct _sbus_sss_invoker_args_tt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_write_u(iter, args->arg0);
+    ret = sbus_iterator_write_t(iter, args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg1);
+    ret = sbus_iterator_write_t(iter, args->arg1);
     if (ret != EOK) {
         return ret;
     }
@@ -484,24 +642,39 @@ errno_t _sbus_sss_invoker_write_us
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_read_usq
+errno_t _sbus_sss_invoker_read_ttauatatat
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_usq *args)
+    struct _sbus_sss_invoker_args_ttauatatat *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_read_u(iter, &args->arg0);
+    ret = sbus_iterator_read_t(iter, &args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg1);
+    ret = sbus_iterator_read_t(iter, &args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_q(iter, &args->arg2);
+    ret = sbus_iterator_read_au(mem_ctx, iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg5);
     if (ret != EOK) {
         return ret;
     }
@@ -509,23 +682,38 @@ errno_t _sbus_sss_invoker_read_usq
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_write_usq
+errno_t _sbus_sss_invoker_write_ttauatatat
    (DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_usq *args)
+    struct _sbus_sss_invoker_args_ttauatatat *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_write_u(iter, args->arg0);
+    ret = sbus_iterator_write_t(iter, args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg1);
+    ret = sbus_iterator_write_t(iter, args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_q(iter, args->arg2);
+    ret = sbus_iterator_write_au(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg5);
     if (ret != EOK) {
         return ret;
     }
@@ -533,24 +721,24 @@ errno_t _sbus_sss_invoker_write_usq
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_read_uss
+errno_t _sbus_sss_invoker_read_ttt
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uss *args)
+    struct _sbus_sss_invoker_args_ttt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_read_u(iter, &args->arg0);
+    ret = sbus_iterator_read_t(iter, &args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg1);
+    ret = sbus_iterator_read_t(iter, &args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg2);
+    ret = sbus_iterator_read_t(iter, &args->arg2);
     if (ret != EOK) {
         return ret;
     }
@@ -558,23 +746,23 @@ errno_t _sbus_sss_invoker_read_uss
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_write_uss
+errno_t _sbus_sss_invoker_write_ttt
    (DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uss *args)
+    struct _sbus_sss_invoker_args_ttt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_write_u(iter, args->arg0);
+    ret = sbus_iterator_write_t(iter, args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg1);
+    ret = sbus_iterator_write_t(iter, args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg2);
+    ret = sbus_iterator_write_t(iter, args->arg2);
     if (ret != EOK) {
         return ret;
     }
@@ -582,24 +770,29 @@ errno_t _sbus_sss_invoker_write_uss
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_read_uus
+errno_t _sbus_sss_invoker_read_tttt
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uus *args)
+    struct _sbus_sss_invoker_args_tttt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_read_u(iter, &args->arg0);
+    ret = sbus_iterator_read_t(iter, &args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_u(iter, &args->arg1);
+    ret = sbus_iterator_read_t(iter, &args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg2);
+    ret = sbus_iterator_read_t(iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg3);
     if (ret != EOK) {
         return ret;
     }
@@ -607,23 +800,28 @@ errno_t _sbus_sss_invoker_read_uus
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_write_uus
+errno_t _sbus_sss_invoker_write_tttt
    (DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uus *args)
+    struct _sbus_sss_invoker_args_tttt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_write_u(iter, args->arg0);
+    ret = sbus_iterator_write_t(iter, args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_u(iter, args->arg1);
+    ret = sbus_iterator_write_t(iter, args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg2);
+    ret = sbus_iterator_write_t(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg3);
     if (ret != EOK) {
         return ret;
     }
@@ -631,34 +829,44 @@ errno_t _sbus_sss_invoker_write_uus
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_read_uusss
+errno_t _sbus_sss_invoker_read_ttttttt
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uusss *args)
+    struct _sbus_sss_invoker_args_ttttttt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_read_u(iter, &args->arg0);
+    ret = sbus_iterator_read_t(iter, &args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_u(iter, &args->arg1);
+    ret = sbus_iterator_read_t(iter, &args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg2);
+    ret = sbus_iterator_read_t(iter, &args->arg2);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg3);
+    ret = sbus_iterator_read_t(iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg4);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg4);
+    ret = sbus_iterator_read_t(iter, &args->arg5);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg6);
     if (ret != EOK) {
         return ret;
     }
@@ -666,33 +874,524 @@ errno_t _sbus_sss_invoker_read_uusss
     return EOK;
 }
 
-errno_t _sbus_sss_invoker_write_uusss
+errno_t _sbus_sss_invoker_write_ttttttt
    (DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uusss *args)
+    struct _sbus_sss_invoker_args_ttttttt *args)
 {
     errno_t ret;
 
-    ret = sbus_iterator_write_u(iter, args->arg0);
+    ret = sbus_iterator_write_t(iter, args->arg0);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_u(iter, args->arg1);
+    ret = sbus_iterator_write_t(iter, args->arg1);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg2);
+    ret = sbus_iterator_write_t(iter, args->arg2);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg3);
+    ret = sbus_iterator_write_t(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg5);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg6);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_tttttttt
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tttttttt *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_t(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg2);
     if (ret != EOK) {
         return ret;
     }
 
-    ret = sbus_iterator_write_s(iter, args->arg4);
+    ret = sbus_iterator_read_t(iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg5);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg6);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg7);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_tttttttt
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tttttttt *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_t(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg5);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg6);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg7);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_u
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_u *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_u
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_u *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_us
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_us *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_us
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_us *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_s(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_usq
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_usq *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_q(iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_usq
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_usq *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_s(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_q(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_uss
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uss *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_uss
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uss *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_s(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_s(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_ut
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ut *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_t(iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_ut
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ut *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_t(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_uuRRRu
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uuRRRu *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_u(iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_R(iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_R(iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_R(iter, &args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_u(iter, &args->arg5);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_uuRRRu
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uuRRRu *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_u(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_R(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_R(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_R(iter, args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_u(iter, args->arg5);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_uus
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uus *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_u(iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_s(mem_ctx, iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_uus
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uus *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_u(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_s(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_uuu
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uuu *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_u(iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_u(iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_uuu
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uuu *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_u(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_u(iter, args->arg2);
     if (ret != EOK) {
         return ret;
     }
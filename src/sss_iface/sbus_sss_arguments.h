@@ -43,6 +43,25 @@ _sbus_sss_invoker_write_as
    (DBusMessageIter *iter,
     struct _sbus_sss_invoker_args_as *args);
 
+struct _sbus_sss_invoker_args_asatatatau {
+    const char ** arg0;
+    uint64_t * arg1;
+    uint64_t * arg2;
+    uint64_t * arg3;
+    uint32_t * arg4;
+};
+
+errno_t
+_sbus_sss_invoker_read_asatatatau
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatau *args);
+
+errno_t
+_sbus_sss_invoker_write_asatatatau
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatau *args);
+
 struct _sbus_sss_invoker_args_b {
     bool arg0;
 };
@@ -150,6 +169,22 @@ _sbus_sss_invoker_write_s
    (DBusMessageIter *iter,
     struct _sbus_sss_invoker_args_s *args);
 
+struct _sbus_sss_invoker_args_sas {
+    const char * arg0;
+    const char ** arg1;
+};
+
+errno_t
+_sbus_sss_invoker_read_sas
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_sas *args);
+
+errno_t
+_sbus_sss_invoker_write_sas
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_sas *args);
+
 struct _sbus_sss_invoker_args_sqq {
     const char * arg0;
     uint16_t arg1;
@@ -200,6 +235,140 @@ _sbus_sss_invoker_write_ssau
    (DBusMessageIter *iter,
     struct _sbus_sss_invoker_args_ssau *args);
 
+struct _sbus_sss_invoker_args_tauatatatat {
+    uint64_t arg0;
+    uint32_t * arg1;
+    uint64_t * arg2;
+    uint64_t * arg3;
+    uint64_t * arg4;
+    uint64_t * arg5;
+};
+
+errno_t
+_sbus_sss_invoker_read_tauatatatat
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tauatatatat *args);
+
+errno_t
+_sbus_sss_invoker_write_tauatatatat
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tauatatatat *args);
+
+struct _sbus_sss_invoker_args_tt {
+    uint64_t arg0;
+    uint64_t arg1;
+};
+
+errno_t
+_sbus_sss_invoker_read_tt
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tt *args);
+
+errno_t
+_sbus_sss_invoker_write_tt
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tt *args);
+
+struct _sbus_sss_invoker_args_ttauatatat {
+    uint64_t arg0;
+    uint64_t arg1;
+    uint32_t * arg2;
+    uint64_t * arg3;
+    uint64_t * arg4;
+    uint64_t * arg5;
+};
+
+errno_t
+_sbus_sss_invoker_read_ttauatatat
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ttauatatat *args);
+
+errno_t
+_sbus_sss_invoker_write_ttauatatat
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ttauatatat *args);
+
+struct _sbus_sss_invoker_args_ttt {
+    uint64_t arg0;
+    uint64_t arg1;
+    uint64_t arg2;
+};
+
+errno_t
+_sbus_sss_invoker_read_ttt
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ttt *args);
+
+errno_t
+_sbus_sss_invoker_write_ttt
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ttt *args);
+
+struct _sbus_sss_invoker_args_tttt {
+    uint64_t arg0;
+    uint64_t arg1;
+    uint64_t arg2;
+    uint64_t arg3;
+};
+
+errno_t
+_sbus_sss_invoker_read_tttt
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tttt *args);
+
+errno_t
+_sbus_sss_invoker_write_tttt
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tttt *args);
+
+struct _sbus_sss_invoker_args_ttttttt {
+    uint64_t arg0;
+    uint64_t arg1;
+    uint64_t arg2;
+    uint64_t arg3;
+    uint64_t arg4;
+    uint64_t arg5;
+    uint64_t arg6;
+};
+
+errno_t
+_sbus_sss_invoker_read_ttttttt
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ttttttt *args);
+
+errno_t
+_sbus_sss_invoker_write_ttttttt
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ttttttt *args);
+
+struct _sbus_sss_invoker_args_tttttttt {
+    uint64_t arg0;
+    uint64_t arg1;
+    uint64_t arg2;
+    uint64_t arg3;
+    uint64_t arg4;
+    uint64_t arg5;
+    uint64_t arg6;
+    uint64_t arg7;
+};
+
+errno_t
+_sbus_sss_invoker_read_tttttttt
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tttttttt *args);
+
+errno_t
+_sbus_sss_invoker_write_tttttttt
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_tttttttt *args);
+
 struct _sbus_sss_invoker_args_u {
     uint32_t arg0;
 };
@@ -265,6 +434,42 @@ _sbus_sss_invoker_write_uss
    (DBusMessageIter *iter,
     struct _sbus_sss_invoker_args_uss *args);
 
+struct _sbus_sss_invoker_args_ut {
+    uint32_t arg0;
+    uint64_t arg1;
+};
+
+errno_t
+_sbus_sss_invoker_read_ut
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ut *args);
+
+errno_t
+_sbus_sss_invoker_write_ut
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_ut *args);
+
+struct _sbus_sss_invoker_args_uuRRRu {
+    uint32_t arg0;
+    uint32_t arg1;
+    const char * arg2;
+    const char * arg3;
+    const char * arg4;
+    uint32_t arg5;
+};
+
+errno_t
+_sbus_sss_invoker_read_uuRRRu
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uuRRRu *args);
+
+errno_t
+_sbus_sss_invoker_write_uuRRRu
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uuRRRu *args);
+
 struct _sbus_sss_invoker_args_uus {
     uint32_t arg0;
     uint32_t arg1;
@@ -282,24 +487,22 @@ _sbus_sss_invoker_write_uus
    (DBusMessageIter *iter,
     struct _sbus_sss_invoker_args_uus *args);
 
-struct _sbus_sss_invoker_args_uusss {
+struct _sbus_sss_invoker_args_uuu {
     uint32_t arg0;
     uint32_t arg1;
-    const char * arg2;
-    const char * arg3;
-    const char * arg4;
+    uint32_t arg2;
 };
 
 errno_t
-_sbus_sss_invoker_read_uusss
+_sbus_sss_invoker_read_uuu
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uusss *args);
+    struct _sbus_sss_invoker_args_uuu *args);
 
 errno_t
-_sbus_sss_invoker_write_uusss
+_sbus_sss_invoker_write_uuu
    (DBusMessageIter *iter,
-    struct _sbus_sss_invoker_args_uusss *args);
+    struct _sbus_sss_invoker_args_uuu *args);
 
 struct _sbus_sss_invoker_args_uuus {
     uint32_t arg0;
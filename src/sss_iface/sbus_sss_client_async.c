@@ -108,6 +108,968 @@ sbus_method_in__out__recv
     return EOK;
 }
 
+struct sbus_method_in__out_asatatatau_state {
+    struct _sbus_sss_invoker_args_asatatatau *out;
+};
+
+static void sbus_method_in__out_asatatatau_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_asatatatau_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_asatatatau_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_asatatatau_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_asatatatau);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_asatatatau_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_asatatatau_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_asatatatau_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_asatatatau_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_asatatatau, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_asatatatau_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     const char *** _arg0,
+     uint64_t ** _arg1,
+     uint64_t ** _arg2,
+     uint64_t ** _arg3,
+     uint32_t ** _arg4)
+{
+    struct sbus_method_in__out_asatatatau_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_asatatatau_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = talloc_steal(mem_ctx, state->out->arg0);
+    *_arg1 = talloc_steal(mem_ctx, state->out->arg1);
+    *_arg2 = talloc_steal(mem_ctx, state->out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, state->out->arg3);
+    *_arg4 = talloc_steal(mem_ctx, state->out->arg4);
+
+    return EOK;
+}
+
+struct sbus_method_in__out_tauatatatat_state {
+    struct _sbus_sss_invoker_args_tauatatatat *out;
+};
+
+static void sbus_method_in__out_tauatatatat_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_tauatatatat_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_tauatatatat_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_tauatatatat_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_tauatatatat);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_tauatatatat_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_tauatatatat_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_tauatatatat_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_tauatatatat_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_tauatatatat, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_tauatatatat_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     uint64_t* _arg0,
+     uint32_t ** _arg1,
+     uint64_t ** _arg2,
+     uint64_t ** _arg3,
+     uint64_t ** _arg4,
+     uint64_t ** _arg5)
+{
+    struct sbus_method_in__out_tauatatatat_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_tauatatatat_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = talloc_steal(mem_ctx, state->out->arg1);
+    *_arg2 = talloc_steal(mem_ctx, state->out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, state->out->arg3);
+    *_arg4 = talloc_steal(mem_ctx, state->out->arg4);
+    *_arg5 = talloc_steal(mem_ctx, state->out->arg5);
+
+    return EOK;
+}
+
+struct sbus_method_in__out_tt_state {
+    struct _sbus_sss_invoker_args_tt *out;
+};
+
+static void sbus_method_in__out_tt_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_tt_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_tt_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_tt_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_tt);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_tt_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_tt_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_tt_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_tt_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_tt, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_tt_recv
+    (struct tevent_req *req,
+     uint64_t* _arg0,
+     uint64_t* _arg1)
+{
+    struct sbus_method_in__out_tt_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_tt_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+
+    return EOK;
+}
+
+struct sbus_method_in__out_ttauatatat_state {
+    struct _sbus_sss_invoker_args_ttauatatat *out;
+};
+
+static void sbus_method_in__out_ttauatatat_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_ttauatatat_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_ttauatatat_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_ttauatatat_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_ttauatatat);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_ttauatatat_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_ttauatatat_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_ttauatatat_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_ttauatatat_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_ttauatatat, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_ttauatatat_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint32_t ** _arg2,
+     uint64_t ** _arg3,
+     uint64_t ** _arg4,
+     uint64_t ** _arg5)
+{
+    struct sbus_method_in__out_ttauatatat_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_ttauatatat_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+    *_arg2 = talloc_steal(mem_ctx, state->out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, state->out->arg3);
+    *_arg4 = talloc_steal(mem_ctx, state->out->arg4);
+    *_arg5 = talloc_steal(mem_ctx, state->out->arg5);
+
+    return EOK;
+}
+
+struct sbus_method_in__out_ttt_state {
+    struct _sbus_sss_invoker_args_ttt *out;
+};
+
+static void sbus_method_in__out_ttt_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_ttt_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_ttt_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_ttt_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_ttt);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_ttt_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_ttt_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_ttt_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_ttt_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_ttt, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_ttt_recv
+    (struct tevent_req *req,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint64_t* _arg2)
+{
+    struct sbus_method_in__out_ttt_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_ttt_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+    *_arg2 = state->out->arg2;
+
+    return EOK;
+}
+
+struct sbus_method_in__out_tttt_state {
+    struct _sbus_sss_invoker_args_tttt *out;
+};
+
+static void sbus_method_in__out_tttt_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_tttt_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_tttt_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_tttt_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_tttt);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_tttt_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_tttt_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_tttt_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_tttt_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_tttt, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_tttt_recv
+    (struct tevent_req *req,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint64_t* _arg2,
+     uint64_t* _arg3)
+{
+    struct sbus_method_in__out_tttt_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_tttt_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+    *_arg2 = state->out->arg2;
+    *_arg3 = state->out->arg3;
+
+    return EOK;
+}
+
+struct sbus_method_in__out_ttttttt_state {
+    struct _sbus_sss_invoker_args_ttttttt *out;
+};
+
+static void sbus_method_in__out_ttttttt_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_ttttttt_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_ttttttt_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_ttttttt_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_ttttttt);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_ttttttt_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_ttttttt_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_ttttttt_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_ttttttt_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_ttttttt, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_ttttttt_recv
+    (struct tevent_req *req,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint64_t* _arg2,
+     uint64_t* _arg3,
+     uint64_t* _arg4,
+     uint64_t* _arg5,
+     uint64_t* _arg6)
+{
+    struct sbus_method_in__out_ttttttt_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_ttttttt_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+    *_arg2 = state->out->arg2;
+    *_arg3 = state->out->arg3;
+    *_arg4 = state->out->arg4;
+    *_arg5 = state->out->arg5;
+    *_arg6 = state->out->arg6;
+
+    return EOK;
+}
+
+struct sbus_method_in__out_tttttttt_state {
+    struct _sbus_sss_invoker_args_tttttttt *out;
+};
+
+static void sbus_method_in__out_tttttttt_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_tttttttt_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_tttttttt_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_tttttttt_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_tttttttt);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_tttttttt_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_tttttttt_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_tttttttt_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_tttttttt_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_tttttttt, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_tttttttt_recv
+    (struct tevent_req *req,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint64_t* _arg2,
+     uint64_t* _arg3,
+     uint64_t* _arg4,
+     uint64_t* _arg5,
+     uint64_t* _arg6,
+     uint64_t* _arg7)
+{
+    struct sbus_method_in__out_tttttttt_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_tttttttt_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+    *_arg2 = state->out->arg2;
+    *_arg3 = state->out->arg3;
+    *_arg4 = state->out->arg4;
+    *_arg5 = state->out->arg5;
+    *_arg6 = state->out->arg6;
+    *_arg7 = state->out->arg7;
+
+    return EOK;
+}
+
+struct sbus_method_in__out_ut_state {
+    struct _sbus_sss_invoker_args_ut *out;
+};
+
+static void sbus_method_in__out_ut_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in__out_ut_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method)
+{
+    struct sbus_method_in__out_ut_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in__out_ut_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_ut);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen, NULL,
+                                   bus, path, iface, method, NULL);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in__out_ut_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in__out_ut_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in__out_ut_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in__out_ut_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_ut, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in__out_ut_recv
+    (struct tevent_req *req,
+     uint32_t* _arg0,
+     uint64_t* _arg1)
+{
+    struct sbus_method_in__out_ut_state *state;
+    state = tevent_req_data(req, struct sbus_method_in__out_ut_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+
+    return EOK;
+}
+
 struct sbus_method_in_pam_data_out_pam_response_state {
     struct _sbus_sss_invoker_args_pam_data in;
     struct _sbus_sss_invoker_args_pam_response *out;
@@ -815,6 +1777,197 @@ sbus_method_in_s_out_s_recv
     return EOK;
 }
 
+struct sbus_method_in_s_out_uuu_state {
+    struct _sbus_sss_invoker_args_s in;
+    struct _sbus_sss_invoker_args_uuu *out;
+};
+
+static void sbus_method_in_s_out_uuu_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in_s_out_uuu_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     const char * arg0)
+{
+    struct sbus_method_in_s_out_uuu_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in_s_out_uuu_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->out = talloc_zero(state, struct _sbus_sss_invoker_args_uuu);
+    if (state->out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    state->in.arg0 = arg0;
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen,
+                                   (sbus_invoker_writer_fn)_sbus_sss_invoker_write_s,
+                                   bus, path, iface, method, &state->in);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in_s_out_uuu_done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in_s_out_uuu_done(struct tevent_req *subreq)
+{
+    struct sbus_method_in_s_out_uuu_state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in_s_out_uuu_state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = sbus_read_output(state->out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_uuu, state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in_s_out_uuu_recv
+    (struct tevent_req *req,
+     uint32_t* _arg0,
+     uint32_t* _arg1,
+     uint32_t* _arg2)
+{
+    struct sbus_method_in_s_out_uuu_state *state;
+    state = tevent_req_data(req, struct sbus_method_in_s_out_uuu_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_arg0 = state->out->arg0;
+    *_arg1 = state->out->arg1;
+    *_arg2 = state->out->arg2;
+
+    return EOK;
+}
+
+struct sbus_method_in_sas_out__state {
+    struct _sbus_sss_invoker_args_sas in;
+};
+
+static void sbus_method_in_sas_out__done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sbus_method_in_sas_out__send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     sbus_invoker_keygen keygen,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     const char * arg0,
+     const char ** arg1)
+{
+    struct sbus_method_in_sas_out__state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in_sas_out__state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->in.arg0 = arg0;
+    state->in.arg1 = arg1;
+
+    subreq = sbus_call_method_send(state, conn, NULL, keygen,
+                                   (sbus_invoker_writer_fn)_sbus_sss_invoker_write_sas,
+                                   bus, path, iface, method, &state->in);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    tevent_req_set_callback(subreq, sbus_method_in_sas_out__done, req);
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, conn->ev);
+    }
+
+    return req;
+}
+
+static void sbus_method_in_sas_out__done(struct tevent_req *subreq)
+{
+    struct sbus_method_in_sas_out__state *state;
+    struct tevent_req *req;
+    DBusMessage *reply;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sbus_method_in_sas_out__state);
+
+    ret = sbus_call_method_recv(state, subreq, &reply);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+static errno_t
+sbus_method_in_sas_out__recv
+    (struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
 struct sbus_method_in_sqq_out_q_state {
     struct _sbus_sss_invoker_args_sqq in;
     struct _sbus_sss_invoker_args_q *out;
@@ -1458,15 +2611,15 @@ sbus_method_in_uss_out_qus_recv
     return EOK;
 }
 
-struct sbus_method_in_uus_out_qus_state {
-    struct _sbus_sss_invoker_args_uus in;
+struct sbus_method_in_uuRRRu_out_qus_state {
+    struct _sbus_sss_invoker_args_uuRRRu in;
     struct _sbus_sss_invoker_args_qus *out;
 };
 
-static void sbus_method_in_uus_out_qus_done(struct tevent_req *subreq);
+static void sbus_method_in_uuRRRu_out_qus_done(struct tevent_req *subreq);
 
 static struct tevent_req *
-sbus_method_in_uus_out_qus_send
+sbus_method_in_uuRRRu_out_qus_send
     (TALLOC_CTX *mem_ctx,
      struct sbus_connection *conn,
      sbus_invoker_keygen keygen,
@@ -1476,14 +2629,17 @@ sbus_method_in_uus_out_qus_send
      const char *method,
      uint32_t arg0,
      uint32_t arg1,
-     const char * arg2)
+     const char * arg2,
+     const char * arg3,
+     const char * arg4,
+     uint32_t arg5)
 {
-    struct sbus_method_in_uus_out_qus_state *state;
+    struct sbus_method_in_uuRRRu_out_qus_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in_uus_out_qus_state);
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in_uuRRRu_out_qus_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -1500,9 +2656,12 @@ sbus_method_in_uus_out_qus_send
     state->in.arg0 = arg0;
     state->in.arg1 = arg1;
     state->in.arg2 = arg2;
+    state->in.arg3 = arg3;
+    state->in.arg4 = arg4;
+    state->in.arg5 = arg5;
 
     subreq = sbus_call_method_send(state, conn, NULL, keygen,
-                                   (sbus_invoker_writer_fn)_sbus_sss_invoker_write_uus,
+                                   (sbus_invoker_writer_fn)_sbus_sss_invoker_write_uuRRRu,
                                    bus, path, iface, method, &state->in);
     if (subreq == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
@@ -1510,7 +2669,7 @@ sbus_method_in_uus_out_qus_send
         goto done;
     }
 
-    tevent_req_set_callback(subreq, sbus_method_in_uus_out_qus_done, req);
+    tevent_req_set_callback(subreq, sbus_method_in_uuRRRu_out_qus_done, req);
 
     ret = EAGAIN;
 
@@ -1523,15 +2682,15 @@ done:
     return req;
 }
 
-static void sbus_method_in_uus_out_qus_done(struct tevent_req *subreq)
+static void sbus_method_in_uuRRRu_out_qus_done(struct tevent_req *subreq)
 {
-    struct sbus_method_in_uus_out_qus_state *state;
+    struct sbus_method_in_uuRRRu_out_qus_state *state;
     struct tevent_req *req;
     DBusMessage *reply;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct sbus_method_in_uus_out_qus_state);
+    state = tevent_req_data(req, struct sbus_method_in_uuRRRu_out_qus_state);
 
     ret = sbus_call_method_recv(state, subreq, &reply);
     talloc_zfree(subreq);
@@ -1551,15 +2710,15 @@ static void sbus_method_in_uus_out_qus_done(struct tevent_req *subreq)
 }
 
 static errno_t
-sbus_method_in_uus_out_qus_recv
+sbus_method_in_uuRRRu_out_qus_recv
     (TALLOC_CTX *mem_ctx,
      struct tevent_req *req,
      uint16_t* _arg0,
      uint32_t* _arg1,
      const char ** _arg2)
 {
-    struct sbus_method_in_uus_out_qus_state *state;
-    state = tevent_req_data(req, struct sbus_method_in_uus_out_qus_state);
+    struct sbus_method_in_uuRRRu_out_qus_state *state;
+    state = tevent_req_data(req, struct sbus_method_in_uuRRRu_out_qus_state);
 
     TEVENT_REQ_RETURN_ON_ERROR(req);
 
@@ -1570,15 +2729,15 @@ sbus_method_in_uus_out_qus_recv
     return EOK;
 }
 
-struct sbus_method_in_uusss_out_qus_state {
-    struct _sbus_sss_invoker_args_uusss in;
+struct sbus_method_in_uus_out_qus_state {
+    struct _sbus_sss_invoker_args_uus in;
     struct _sbus_sss_invoker_args_qus *out;
 };
 
-static void sbus_method_in_uusss_out_qus_done(struct tevent_req *subreq);
+static void sbus_method_in_uus_out_qus_done(struct tevent_req *subreq);
 
 static struct tevent_req *
-sbus_method_in_uusss_out_qus_send
+sbus_method_in_uus_out_qus_send
     (TALLOC_CTX *mem_ctx,
      struct sbus_connection *conn,
      sbus_invoker_keygen keygen,
@@ -1588,16 +2747,14 @@ sbus_method_in_uusss_out_qus_send
      const char *method,
      uint32_t arg0,
      uint32_t arg1,
-     const char * arg2,
-     const char * arg3,
-     const char * arg4)
+     const char * arg2)
 {
-    struct sbus_method_in_uusss_out_qus_state *state;
+    struct sbus_method_in_uus_out_qus_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in_uusss_out_qus_state);
+    req = tevent_req_create(mem_ctx, &state, struct sbus_method_in_uus_out_qus_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -1614,11 +2771,9 @@ sbus_method_in_uusss_out_qus_send
     state->in.arg0 = arg0;
     state->in.arg1 = arg1;
     state->in.arg2 = arg2;
-    state->in.arg3 = arg3;
-    state->in.arg4 = arg4;
 
     subreq = sbus_call_method_send(state, conn, NULL, keygen,
-                                   (sbus_invoker_writer_fn)_sbus_sss_invoker_write_uusss,
+                                   (sbus_invoker_writer_fn)_sbus_sss_invoker_write_uus,
                                    bus, path, iface, method, &state->in);
     if (subreq == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
@@ -1626,7 +2781,7 @@ sbus_method_in_uusss_out_qus_send
         goto done;
     }
 
-    tevent_req_set_callback(subreq, sbus_method_in_uusss_out_qus_done, req);
+    tevent_req_set_callback(subreq, sbus_method_in_uus_out_qus_done, req);
 
     ret = EAGAIN;
 
@@ -1639,15 +2794,15 @@ done:
     return req;
 }
 
-static void sbus_method_in_uusss_out_qus_done(struct tevent_req *subreq)
+static void sbus_method_in_uus_out_qus_done(struct tevent_req *subreq)
 {
-    struct sbus_method_in_uusss_out_qus_state *state;
+    struct sbus_method_in_uus_out_qus_state *state;
     struct tevent_req *req;
     DBusMessage *reply;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct sbus_method_in_uusss_out_qus_state);
+    state = tevent_req_data(req, struct sbus_method_in_uus_out_qus_state);
 
     ret = sbus_call_method_recv(state, subreq, &reply);
     talloc_zfree(subreq);
@@ -1667,15 +2822,15 @@ static void sbus_method_in_uusss_out_qus_done(struct tevent_req *subreq)
 }
 
 static errno_t
-sbus_method_in_uusss_out_qus_recv
+sbus_method_in_uus_out_qus_recv
     (TALLOC_CTX *mem_ctx,
      struct tevent_req *req,
      uint16_t* _arg0,
      uint32_t* _arg1,
      const char ** _arg2)
 {
-    struct sbus_method_in_uusss_out_qus_state *state;
-    state = tevent_req_data(req, struct sbus_method_in_uusss_out_qus_state);
+    struct sbus_method_in_uus_out_qus_state *state;
+    state = tevent_req_data(req, struct sbus_method_in_uus_out_qus_state);
 
     TEVENT_REQ_RETURN_ON_ERROR(req);
 
@@ -1920,6 +3075,48 @@ sbus_call_dp_backend_IsOnline_recv
     return sbus_method_in_s_out_b_recv(req, _status);
 }
 
+struct tevent_req *
+sbus_call_dp_backend_PerfStats_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_tttt_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.DataProvider.Backend", "PerfStats");
+}
+
+errno_t
+sbus_call_dp_backend_PerfStats_recv
+    (struct tevent_req *req,
+     uint64_t* _server_ops,
+     uint64_t* _server_usecs,
+     uint64_t* _sysdb_transactions,
+     uint64_t* _sysdb_usecs)
+{
+    return sbus_method_in__out_tttt_recv(req, _server_ops, _server_usecs, _sysdb_transactions, _sysdb_usecs);
+}
+
+struct tevent_req *
+sbus_call_dp_backend_RequestStats_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_ut_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.DataProvider.Backend", "RequestStats");
+}
+
+errno_t
+sbus_call_dp_backend_RequestStats_recv
+    (struct tevent_req *req,
+     uint32_t* _active,
+     uint64_t* _coalesced)
+{
+    return sbus_method_in__out_ut_recv(req, _active, _coalesced);
+}
+
 struct tevent_req *
 sbus_call_dp_client_Register_send
     (TALLOC_CTX *mem_ctx,
@@ -2002,6 +3199,28 @@ sbus_call_dp_failover_ListServices_recv
     return sbus_method_in_s_out_as_recv(mem_ctx, req, _services);
 }
 
+struct tevent_req *
+sbus_call_dp_failover_ServerTuning_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_service_name)
+{
+    return sbus_method_in_s_out_uuu_send(mem_ctx, conn, _sbus_sss_key_s_0,
+        busname, object_path, "sssd.DataProvider.Failover", "ServerTuning", arg_service_name);
+}
+
+errno_t
+sbus_call_dp_failover_ServerTuning_recv
+    (struct tevent_req *req,
+     uint32_t* _page_size,
+     uint32_t* _pool_size,
+     uint32_t* _page_msecs)
+{
+    return sbus_method_in_s_out_uuu_recv(req, _page_size, _pool_size, _page_msecs);
+}
+
 struct tevent_req *
 sbus_call_proxy_auth_PAM_send
     (TALLOC_CTX *mem_ctx,
@@ -2042,6 +3261,25 @@ sbus_call_proxy_client_Register_recv
     return sbus_method_in_u_out__recv(req);
 }
 
+struct tevent_req *
+sbus_call_resp_domain_ClearDegraded_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name)
+{
+    return sbus_method_in_s_out__send(mem_ctx, conn, _sbus_sss_key_s_0,
+        busname, object_path, "sssd.Responder.Domain", "ClearDegraded", arg_name);
+}
+
+errno_t
+sbus_call_resp_domain_ClearDegraded_recv
+    (struct tevent_req *req)
+{
+    return sbus_method_in_s_out__recv(req);
+}
+
 struct tevent_req *
 sbus_call_resp_domain_SetActive_send
     (TALLOC_CTX *mem_ctx,
@@ -2061,6 +3299,25 @@ sbus_call_resp_domain_SetActive_recv
     return sbus_method_in_s_out__recv(req);
 }
 
+struct tevent_req *
+sbus_call_resp_domain_SetDegraded_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name)
+{
+    return sbus_method_in_s_out__send(mem_ctx, conn, _sbus_sss_key_s_0,
+        busname, object_path, "sssd.Responder.Domain", "SetDegraded", arg_name);
+}
+
+errno_t
+sbus_call_resp_domain_SetDegraded_recv
+    (struct tevent_req *req)
+{
+    return sbus_method_in_s_out__recv(req);
+}
+
 struct tevent_req *
 sbus_call_resp_domain_SetInconsistent_send
     (TALLOC_CTX *mem_ctx,
@@ -2116,6 +3373,193 @@ sbus_call_resp_negcache_ResetUsers_recv
     return sbus_method_in__out__recv(req);
 }
 
+struct tevent_req *
+sbus_call_resp_stats_CacheReq_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_tt_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "CacheReq");
+}
+
+errno_t
+sbus_call_resp_stats_CacheReq_recv
+    (struct tevent_req *req,
+     uint64_t* _in_flight,
+     uint64_t* _coalesced)
+{
+    return sbus_method_in__out_tt_recv(req, _in_flight, _coalesced);
+}
+
+struct tevent_req *
+sbus_call_resp_stats_Commands_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_ttauatatat_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "Commands");
+}
+
+errno_t
+sbus_call_resp_stats_Commands_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     uint64_t* _in_flight,
+     uint64_t* _queued,
+     uint32_t ** _commands,
+     uint64_t ** _counts,
+     uint64_t ** _usecs,
+     uint64_t ** _buckets)
+{
+    return sbus_method_in__out_ttauatatat_recv(mem_ctx, req, _in_flight, _queued, _commands, _counts, _usecs, _buckets);
+}
+
+struct tevent_req *
+sbus_call_resp_stats_Dispatcher_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_asatatatau_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "Dispatcher");
+}
+
+errno_t
+sbus_call_resp_stats_Dispatcher_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     const char *** _connections,
+     uint64_t ** _wakeups,
+     uint64_t ** _messages,
+     uint64_t ** _deferred,
+     uint32_t ** _max_batch)
+{
+    return sbus_method_in__out_asatatatau_recv(mem_ctx, req, _connections, _wakeups, _messages, _deferred, _max_batch);
+}
+
+struct tevent_req *
+sbus_call_resp_stats_Memory_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_tauatatatat_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "Memory");
+}
+
+errno_t
+sbus_call_resp_stats_Memory_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     uint64_t* _pool_size,
+     uint32_t ** _commands,
+     uint64_t ** _requests,
+     uint64_t ** _used_sum,
+     uint64_t ** _used_max,
+     uint64_t ** _overflows)
+{
+    return sbus_method_in__out_tauatatatat_recv(mem_ctx, req, _pool_size, _commands, _requests, _used_sum, _used_max, _overflows);
+}
+
+struct tevent_req *
+sbus_call_resp_stats_MemoryUsage_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_tttttttt_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "MemoryUsage");
+}
+
+errno_t
+sbus_call_resp_stats_MemoryUsage_recv
+    (struct tevent_req *req,
+     uint64_t* _total,
+     uint64_t* _clients,
+     uint64_t* _object_cache,
+     uint64_t* _negcache,
+     uint64_t* _prefilter,
+     uint64_t* _packet_pool,
+     uint64_t* _soft_limit,
+     uint64_t* _sheds)
+{
+    return sbus_method_in__out_tttttttt_recv(req, _total, _clients, _object_cache, _negcache, _prefilter, _packet_pool, _soft_limit, _sheds);
+}
+
+struct tevent_req *
+sbus_call_resp_stats_ObjectCache_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_ttt_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "ObjectCache");
+}
+
+errno_t
+sbus_call_resp_stats_ObjectCache_recv
+    (struct tevent_req *req,
+     uint64_t* _entries,
+     uint64_t* _hits,
+     uint64_t* _misses)
+{
+    return sbus_method_in__out_ttt_recv(req, _entries, _hits, _misses);
+}
+
+struct tevent_req *
+sbus_call_resp_stats_PacketPool_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_ttttttt_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "PacketPool");
+}
+
+errno_t
+sbus_call_resp_stats_PacketPool_recv
+    (struct tevent_req *req,
+     uint64_t* _hits,
+     uint64_t* _misses,
+     uint64_t* _discards,
+     uint64_t* _num_used,
+     uint64_t* _used_bytes,
+     uint64_t* _num_free,
+     uint64_t* _free_bytes)
+{
+    return sbus_method_in__out_ttttttt_recv(req, _hits, _misses, _discards, _num_used, _used_bytes, _num_free, _free_bytes);
+}
+
+struct tevent_req *
+sbus_call_resp_stats_Throttle_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path)
+{
+    return sbus_method_in__out_ttt_send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.Responder.Stats", "Throttle");
+}
+
+errno_t
+sbus_call_resp_stats_Throttle_recv
+    (struct tevent_req *req,
+     uint64_t* _deferred,
+     uint64_t* _waiting,
+     uint64_t* _uids)
+{
+    return sbus_method_in__out_ttt_recv(req, _deferred, _waiting, _uids);
+}
+
 struct tevent_req *
 sbus_call_dp_dp_getAccountDomain_send
     (TALLOC_CTX *mem_ctx,
@@ -2151,10 +3595,11 @@ sbus_call_dp_dp_getAccountInfo_send
      uint32_t arg_entry_type,
      const char * arg_filter,
      const char * arg_domain,
-     const char * arg_extra)
+     const char * arg_extra,
+     uint32_t arg_trace_id)
 {
-    return sbus_method_in_uusss_out_qus_send(mem_ctx, conn, _sbus_sss_key_uusss_0_1_2_3_4,
-        busname, object_path, "sssd.dataprovider", "getAccountInfo", arg_dp_flags, arg_entry_type, arg_filter, arg_domain, arg_extra);
+    return sbus_method_in_uuRRRu_out_qus_send(mem_ctx, conn, _sbus_sss_key_uuRRRu_0_1_2_3_4,
+        busname, object_path, "sssd.dataprovider", "getAccountInfo", arg_dp_flags, arg_entry_type, arg_filter, arg_domain, arg_extra, arg_trace_id);
 }
 
 errno_t
@@ -2165,7 +3610,7 @@ sbus_call_dp_dp_getAccountInfo_recv
      uint32_t* _error,
      const char ** _error_message)
 {
-    return sbus_method_in_uusss_out_qus_recv(mem_ctx, req, _dp_error, _error, _error_message);
+    return sbus_method_in_uuRRRu_out_qus_recv(mem_ctx, req, _dp_error, _error, _error_message);
 }
 
 struct tevent_req *
@@ -2283,6 +3728,46 @@ sbus_call_dp_dp_sudoHandler_recv
     return sbus_method_in_raw_out_qus_recv(mem_ctx, req, _dp_error, _error, _error_message);
 }
 
+struct tevent_req *
+sbus_call_ifp_changes_GroupsChanged_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_names)
+{
+    return sbus_method_in_sas_out__send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.ifp.Changes", "GroupsChanged", arg_domain, arg_names);
+}
+
+errno_t
+sbus_call_ifp_changes_GroupsChanged_recv
+    (struct tevent_req *req)
+{
+    return sbus_method_in_sas_out__recv(req);
+}
+
+struct tevent_req *
+sbus_call_ifp_changes_UsersChanged_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_names)
+{
+    return sbus_method_in_sas_out__send(mem_ctx, conn, NULL,
+        busname, object_path, "sssd.ifp.Changes", "UsersChanged", arg_domain, arg_names);
+}
+
+errno_t
+sbus_call_ifp_changes_UsersChanged_recv
+    (struct tevent_req *req)
+{
+    return sbus_method_in_sas_out__recv(req);
+}
+
 struct tevent_req *
 sbus_call_monitor_RegisterService_send
     (TALLOC_CTX *mem_ctx,
@@ -2359,6 +3844,25 @@ sbus_call_nss_memcache_InvalidateAllUsers_recv
     return sbus_method_in__out__recv(req);
 }
 
+struct tevent_req *
+sbus_call_nss_memcache_InvalidateDomain_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_domain)
+{
+    return sbus_method_in_s_out__send(mem_ctx, conn, _sbus_sss_key_s_0,
+        busname, object_path, "sssd.nss.MemoryCache", "InvalidateDomain", arg_domain);
+}
+
+errno_t
+sbus_call_nss_memcache_InvalidateDomain_recv
+    (struct tevent_req *req)
+{
+    return sbus_method_in_s_out__recv(req);
+}
+
 struct tevent_req *
 sbus_call_nss_memcache_InvalidateGroupById_send
     (TALLOC_CTX *mem_ctx,
@@ -2378,6 +3882,25 @@ sbus_call_nss_memcache_InvalidateGroupById_recv
     return sbus_method_in_u_out__recv(req);
 }
 
+struct tevent_req *
+sbus_call_nss_memcache_InvalidateUserById_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_uid)
+{
+    return sbus_method_in_u_out__send(mem_ctx, conn, _sbus_sss_key_u_0,
+        busname, object_path, "sssd.nss.MemoryCache", "InvalidateUserById", arg_uid);
+}
+
+errno_t
+sbus_call_nss_memcache_InvalidateUserById_recv
+    (struct tevent_req *req)
+{
+    return sbus_method_in_u_out__recv(req);
+}
+
 struct tevent_req *
 sbus_call_nss_memcache_UpdateInitgroups_send
     (TALLOC_CTX *mem_ctx,
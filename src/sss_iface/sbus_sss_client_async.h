@@ -106,6 +106,34 @@ sbus_call_dp_backend_IsOnline_recv
     (struct tevent_req *req,
      bool* _status);
 
+struct tevent_req *
+sbus_call_dp_backend_PerfStats_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_dp_backend_PerfStats_recv
+    (struct tevent_req *req,
+     uint64_t* _server_ops,
+     uint64_t* _server_usecs,
+     uint64_t* _sysdb_transactions,
+     uint64_t* _sysdb_usecs);
+
+struct tevent_req *
+sbus_call_dp_backend_RequestStats_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_dp_backend_RequestStats_recv
+    (struct tevent_req *req,
+     uint32_t* _active,
+     uint64_t* _coalesced);
+
 struct tevent_req *
 sbus_call_dp_client_Register_send
     (TALLOC_CTX *mem_ctx,
@@ -160,6 +188,21 @@ sbus_call_dp_failover_ListServices_recv
      struct tevent_req *req,
      const char *** _services);
 
+struct tevent_req *
+sbus_call_dp_failover_ServerTuning_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_service_name);
+
+errno_t
+sbus_call_dp_failover_ServerTuning_recv
+    (struct tevent_req *req,
+     uint32_t* _page_size,
+     uint32_t* _pool_size,
+     uint32_t* _page_msecs);
+
 struct tevent_req *
 sbus_call_proxy_auth_PAM_send
     (TALLOC_CTX *mem_ctx,
@@ -186,6 +229,18 @@ errno_t
 sbus_call_proxy_client_Register_recv
     (struct tevent_req *req);
 
+struct tevent_req *
+sbus_call_resp_domain_ClearDegraded_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name);
+
+errno_t
+sbus_call_resp_domain_ClearDegraded_recv
+    (struct tevent_req *req);
+
 struct tevent_req *
 sbus_call_resp_domain_SetActive_send
     (TALLOC_CTX *mem_ctx,
@@ -198,6 +253,18 @@ errno_t
 sbus_call_resp_domain_SetActive_recv
     (struct tevent_req *req);
 
+struct tevent_req *
+sbus_call_resp_domain_SetDegraded_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_name);
+
+errno_t
+sbus_call_resp_domain_SetDegraded_recv
+    (struct tevent_req *req);
+
 struct tevent_req *
 sbus_call_resp_domain_SetInconsistent_send
     (TALLOC_CTX *mem_ctx,
@@ -232,6 +299,137 @@ errno_t
 sbus_call_resp_negcache_ResetUsers_recv
     (struct tevent_req *req);
 
+struct tevent_req *
+sbus_call_resp_stats_CacheReq_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_CacheReq_recv
+    (struct tevent_req *req,
+     uint64_t* _in_flight,
+     uint64_t* _coalesced);
+
+struct tevent_req *
+sbus_call_resp_stats_Commands_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_Commands_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     uint64_t* _in_flight,
+     uint64_t* _queued,
+     uint32_t ** _commands,
+     uint64_t ** _counts,
+     uint64_t ** _usecs,
+     uint64_t ** _buckets);
+
+struct tevent_req *
+sbus_call_resp_stats_Dispatcher_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_Dispatcher_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     const char *** _connections,
+     uint64_t ** _wakeups,
+     uint64_t ** _messages,
+     uint64_t ** _deferred,
+     uint32_t ** _max_batch);
+
+struct tevent_req *
+sbus_call_resp_stats_Memory_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_Memory_recv
+    (TALLOC_CTX *mem_ctx,
+     struct tevent_req *req,
+     uint64_t* _pool_size,
+     uint32_t ** _commands,
+     uint64_t ** _requests,
+     uint64_t ** _used_sum,
+     uint64_t ** _used_max,
+     uint64_t ** _overflows);
+
+struct tevent_req *
+sbus_call_resp_stats_MemoryUsage_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_MemoryUsage_recv
+    (struct tevent_req *req,
+     uint64_t* _total,
+     uint64_t* _clients,
+     uint64_t* _object_cache,
+     uint64_t* _negcache,
+     uint64_t* _prefilter,
+     uint64_t* _packet_pool,
+     uint64_t* _soft_limit,
+     uint64_t* _sheds);
+
+struct tevent_req *
+sbus_call_resp_stats_ObjectCache_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_ObjectCache_recv
+    (struct tevent_req *req,
+     uint64_t* _entries,
+     uint64_t* _hits,
+     uint64_t* _misses);
+
+struct tevent_req *
+sbus_call_resp_stats_PacketPool_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_PacketPool_recv
+    (struct tevent_req *req,
+     uint64_t* _hits,
+     uint64_t* _misses,
+     uint64_t* _discards,
+     uint64_t* _num_used,
+     uint64_t* _used_bytes,
+     uint64_t* _num_free,
+     uint64_t* _free_bytes);
+
+struct tevent_req *
+sbus_call_resp_stats_Throttle_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path);
+
+errno_t
+sbus_call_resp_stats_Throttle_recv
+    (struct tevent_req *req,
+     uint64_t* _deferred,
+     uint64_t* _waiting,
+     uint64_t* _uids);
+
 struct tevent_req *
 sbus_call_dp_dp_getAccountDomain_send
     (TALLOC_CTX *mem_ctx,
@@ -260,7 +458,8 @@ sbus_call_dp_dp_getAccountInfo_send
      uint32_t arg_entry_type,
      const char * arg_filter,
      const char * arg_domain,
-     const char * arg_extra);
+     const char * arg_extra,
+     uint32_t arg_trace_id);
 
 errno_t
 sbus_call_dp_dp_getAccountInfo_recv
@@ -351,6 +550,32 @@ sbus_call_dp_dp_sudoHandler_recv
      uint32_t* _error,
      const char ** _error_message);
 
+struct tevent_req *
+sbus_call_ifp_changes_GroupsChanged_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_names);
+
+errno_t
+sbus_call_ifp_changes_GroupsChanged_recv
+    (struct tevent_req *req);
+
+struct tevent_req *
+sbus_call_ifp_changes_UsersChanged_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_domain,
+     const char ** arg_names);
+
+errno_t
+sbus_call_ifp_changes_UsersChanged_recv
+    (struct tevent_req *req);
+
 struct tevent_req *
 sbus_call_monitor_RegisterService_send
     (TALLOC_CTX *mem_ctx,
@@ -399,6 +624,18 @@ errno_t
 sbus_call_nss_memcache_InvalidateAllUsers_recv
     (struct tevent_req *req);
 
+struct tevent_req *
+sbus_call_nss_memcache_InvalidateDomain_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char * arg_domain);
+
+errno_t
+sbus_call_nss_memcache_InvalidateDomain_recv
+    (struct tevent_req *req);
+
 struct tevent_req *
 sbus_call_nss_memcache_InvalidateGroupById_send
     (TALLOC_CTX *mem_ctx,
@@ -411,6 +648,18 @@ errno_t
 sbus_call_nss_memcache_InvalidateGroupById_recv
     (struct tevent_req *req);
 
+struct tevent_req *
+sbus_call_nss_memcache_InvalidateUserById_send
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_uid);
+
+errno_t
+sbus_call_nss_memcache_InvalidateUserById_recv
+    (struct tevent_req *req);
+
 struct tevent_req *
 sbus_call_nss_memcache_UpdateInitgroups_send
     (TALLOC_CTX *mem_ctx,
@@ -29,6 +29,419 @@
 #include "sss_iface/sbus_sss_arguments.h"
 #include "sss_iface/sbus_sss_client_properties.h"
 
+static errno_t
+sbus_method_in__out_asatatatau
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     const char *** _arg0,
+     uint64_t ** _arg1,
+     uint64_t ** _arg2,
+     uint64_t ** _arg3,
+     uint32_t ** _arg4)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_asatatatau *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_asatatatau);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL, NULL,
+                                bus, path, iface, method, NULL, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_asatatatau, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = talloc_steal(mem_ctx, out->arg0);
+    *_arg1 = talloc_steal(mem_ctx, out->arg1);
+    *_arg2 = talloc_steal(mem_ctx, out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, out->arg3);
+    *_arg4 = talloc_steal(mem_ctx, out->arg4);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in__out_tauatatatat
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint64_t* _arg0,
+     uint32_t ** _arg1,
+     uint64_t ** _arg2,
+     uint64_t ** _arg3,
+     uint64_t ** _arg4,
+     uint64_t ** _arg5)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_tauatatatat *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_tauatatatat);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL, NULL,
+                                bus, path, iface, method, NULL, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_tauatatatat, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = out->arg0;
+    *_arg1 = talloc_steal(mem_ctx, out->arg1);
+    *_arg2 = talloc_steal(mem_ctx, out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, out->arg3);
+    *_arg4 = talloc_steal(mem_ctx, out->arg4);
+    *_arg5 = talloc_steal(mem_ctx, out->arg5);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in__out_tt
+    (struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint64_t* _arg0,
+     uint64_t* _arg1)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_tt *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_tt);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL, NULL,
+                                bus, path, iface, method, NULL, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_tt, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = out->arg0;
+    *_arg1 = out->arg1;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in__out_ttauatatat
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint32_t ** _arg2,
+     uint64_t ** _arg3,
+     uint64_t ** _arg4,
+     uint64_t ** _arg5)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_ttauatatat *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_ttauatatat);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL, NULL,
+                                bus, path, iface, method, NULL, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_ttauatatat, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = out->arg0;
+    *_arg1 = out->arg1;
+    *_arg2 = talloc_steal(mem_ctx, out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, out->arg3);
+    *_arg4 = talloc_steal(mem_ctx, out->arg4);
+    *_arg5 = talloc_steal(mem_ctx, out->arg5);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in__out_ttt
+    (struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint64_t* _arg2)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_ttt *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_ttt);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL, NULL,
+                                bus, path, iface, method, NULL, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_ttt, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = out->arg0;
+    *_arg1 = out->arg1;
+    *_arg2 = out->arg2;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in__out_ttttttt
+    (struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint64_t* _arg2,
+     uint64_t* _arg3,
+     uint64_t* _arg4,
+     uint64_t* _arg5,
+     uint64_t* _arg6)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_ttttttt *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_ttttttt);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL, NULL,
+                                bus, path, iface, method, NULL, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_ttttttt, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = out->arg0;
+    *_arg1 = out->arg1;
+    *_arg2 = out->arg2;
+    *_arg3 = out->arg3;
+    *_arg4 = out->arg4;
+    *_arg5 = out->arg5;
+    *_arg6 = out->arg6;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in__out_tttttttt
+    (struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint64_t* _arg0,
+     uint64_t* _arg1,
+     uint64_t* _arg2,
+     uint64_t* _arg3,
+     uint64_t* _arg4,
+     uint64_t* _arg5,
+     uint64_t* _arg6,
+     uint64_t* _arg7)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_tttttttt *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_tttttttt);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL, NULL,
+                                bus, path, iface, method, NULL, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_tttttttt, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = out->arg0;
+    *_arg1 = out->arg1;
+    *_arg2 = out->arg2;
+    *_arg3 = out->arg3;
+    *_arg4 = out->arg4;
+    *_arg5 = out->arg5;
+    *_arg6 = out->arg6;
+    *_arg7 = out->arg7;
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
 static errno_t
 sbus_method_in_ss_out_o
     (TALLOC_CTX *mem_ctx,
@@ -131,3 +544,166 @@ sbus_call_systemd_StopUnit
           _arg_job);
 }
 
+errno_t
+sbus_call_resp_stats_CacheReq
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_in_flight,
+     uint64_t* _arg_coalesced)
+{
+     return sbus_method_in__out_tt(conn,
+          busname, object_path, "sssd.Responder.Stats", "CacheReq",
+          _arg_in_flight,
+          _arg_coalesced);
+}
+
+errno_t
+sbus_call_resp_stats_Commands
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_in_flight,
+     uint64_t* _arg_queued,
+     uint32_t ** _arg_commands,
+     uint64_t ** _arg_counts,
+     uint64_t ** _arg_usecs,
+     uint64_t ** _arg_buckets)
+{
+     return sbus_method_in__out_ttauatatat(mem_ctx, conn,
+          busname, object_path, "sssd.Responder.Stats", "Commands",
+          _arg_in_flight,
+          _arg_queued,
+          _arg_commands,
+          _arg_counts,
+          _arg_usecs,
+          _arg_buckets);
+}
+
+errno_t
+sbus_call_resp_stats_Dispatcher
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char *** _arg_connections,
+     uint64_t ** _arg_wakeups,
+     uint64_t ** _arg_messages,
+     uint64_t ** _arg_deferred,
+     uint32_t ** _arg_max_batch)
+{
+     return sbus_method_in__out_asatatatau(mem_ctx, conn,
+          busname, object_path, "sssd.Responder.Stats", "Dispatcher",
+          _arg_connections,
+          _arg_wakeups,
+          _arg_messages,
+          _arg_deferred,
+          _arg_max_batch);
+}
+
+errno_t
+sbus_call_resp_stats_Memory
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_pool_size,
+     uint32_t ** _arg_commands,
+     uint64_t ** _arg_requests,
+     uint64_t ** _arg_used_sum,
+     uint64_t ** _arg_used_max,
+     uint64_t ** _arg_overflows)
+{
+     return sbus_method_in__out_tauatatatat(mem_ctx, conn,
+          busname, object_path, "sssd.Responder.Stats", "Memory",
+          _arg_pool_size,
+          _arg_commands,
+          _arg_requests,
+          _arg_used_sum,
+          _arg_used_max,
+          _arg_overflows);
+}
+
+errno_t
+sbus_call_resp_stats_MemoryUsage
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_total,
+     uint64_t* _arg_clients,
+     uint64_t* _arg_object_cache,
+     uint64_t* _arg_negcache,
+     uint64_t* _arg_prefilter,
+     uint64_t* _arg_packet_pool,
+     uint64_t* _arg_soft_limit,
+     uint64_t* _arg_sheds)
+{
+     return sbus_method_in__out_tttttttt(conn,
+          busname, object_path, "sssd.Responder.Stats", "MemoryUsage",
+          _arg_total,
+          _arg_clients,
+          _arg_object_cache,
+          _arg_negcache,
+          _arg_prefilter,
+          _arg_packet_pool,
+          _arg_soft_limit,
+          _arg_sheds);
+}
+
+errno_t
+sbus_call_resp_stats_ObjectCache
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_entries,
+     uint64_t* _arg_hits,
+     uint64_t* _arg_misses)
+{
+     return sbus_method_in__out_ttt(conn,
+          busname, object_path, "sssd.Responder.Stats", "ObjectCache",
+          _arg_entries,
+          _arg_hits,
+          _arg_misses);
+}
+
+errno_t
+sbus_call_resp_stats_PacketPool
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_hits,
+     uint64_t* _arg_misses,
+     uint64_t* _arg_discards,
+     uint64_t* _arg_num_used,
+     uint64_t* _arg_used_bytes,
+     uint64_t* _arg_num_free,
+     uint64_t* _arg_free_bytes)
+{
+     return sbus_method_in__out_ttttttt(conn,
+          busname, object_path, "sssd.Responder.Stats", "PacketPool",
+          _arg_hits,
+          _arg_misses,
+          _arg_discards,
+          _arg_num_used,
+          _arg_used_bytes,
+          _arg_num_free,
+          _arg_free_bytes);
+}
+
+errno_t
+sbus_call_resp_stats_Throttle
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_deferred,
+     uint64_t* _arg_waiting,
+     uint64_t* _arg_uids)
+{
+     return sbus_method_in__out_ttt(conn,
+          busname, object_path, "sssd.Responder.Stats", "Throttle",
+          _arg_deferred,
+          _arg_waiting,
+          _arg_uids);
+}
+
@@ -58,4 +58,95 @@ sbus_call_systemd_StopUnit
      const char * arg_mode,
      const char ** _arg_job);
 
+errno_t
+sbus_call_resp_stats_CacheReq
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_in_flight,
+     uint64_t* _arg_coalesced);
+
+errno_t
+sbus_call_resp_stats_Commands
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_in_flight,
+     uint64_t* _arg_queued,
+     uint32_t ** _arg_commands,
+     uint64_t ** _arg_counts,
+     uint64_t ** _arg_usecs,
+     uint64_t ** _arg_buckets);
+
+errno_t
+sbus_call_resp_stats_Dispatcher
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     const char *** _arg_connections,
+     uint64_t ** _arg_wakeups,
+     uint64_t ** _arg_messages,
+     uint64_t ** _arg_deferred,
+     uint32_t ** _arg_max_batch);
+
+errno_t
+sbus_call_resp_stats_Memory
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_pool_size,
+     uint32_t ** _arg_commands,
+     uint64_t ** _arg_requests,
+     uint64_t ** _arg_used_sum,
+     uint64_t ** _arg_used_max,
+     uint64_t ** _arg_overflows);
+
+errno_t
+sbus_call_resp_stats_MemoryUsage
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_total,
+     uint64_t* _arg_clients,
+     uint64_t* _arg_object_cache,
+     uint64_t* _arg_negcache,
+     uint64_t* _arg_prefilter,
+     uint64_t* _arg_packet_pool,
+     uint64_t* _arg_soft_limit,
+     uint64_t* _arg_sheds);
+
+errno_t
+sbus_call_resp_stats_ObjectCache
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_entries,
+     uint64_t* _arg_hits,
+     uint64_t* _arg_misses);
+
+errno_t
+sbus_call_resp_stats_PacketPool
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_hits,
+     uint64_t* _arg_misses,
+     uint64_t* _arg_discards,
+     uint64_t* _arg_num_used,
+     uint64_t* _arg_used_bytes,
+     uint64_t* _arg_num_free,
+     uint64_t* _arg_free_bytes);
+
+errno_t
+sbus_call_resp_stats_Throttle
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint64_t* _arg_deferred,
+     uint64_t* _arg_waiting,
+     uint64_t* _arg_uids);
+
 #endif /* _SBUS_SSS_CLIENT_SYNC_H_ */
@@ -253,6 +253,50 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: sssd.DataProvider.Backend.PerfStats */
+#define SBUS_METHOD_SYNC_sssd_DataProvider_Backend_PerfStats(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_sync("PerfStats", \
+        &_sbus_sss_args_sssd_DataProvider_Backend_PerfStats, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tttt_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_DataProvider_Backend_PerfStats(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_async("PerfStats", \
+        &_sbus_sss_args_sssd_DataProvider_Backend_PerfStats, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tttt_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.DataProvider.Backend.RequestStats */
+#define SBUS_METHOD_SYNC_sssd_DataProvider_Backend_RequestStats(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint32_t*, uint64_t*); \
+    sbus_method_sync("RequestStats", \
+        &_sbus_sss_args_sssd_DataProvider_Backend_RequestStats, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ut_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_DataProvider_Backend_RequestStats(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint32_t*, uint64_t*); \
+    sbus_method_async("RequestStats", \
+        &_sbus_sss_args_sssd_DataProvider_Backend_RequestStats, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ut_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: sssd.DataProvider.Client */
 #define SBUS_IFACE_sssd_DataProvider_Client(methods, signals, properties) ({ \
     sbus_interface("sssd.DataProvider.Client", NULL, \
@@ -353,6 +397,28 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: sssd.DataProvider.Failover.ServerTuning */
+#define SBUS_METHOD_SYNC_sssd_DataProvider_Failover_ServerTuning(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, uint32_t*, uint32_t*, uint32_t*); \
+    sbus_method_sync("ServerTuning", \
+        &_sbus_sss_args_sssd_DataProvider_Failover_ServerTuning, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out_uuu_send, \
+        _sbus_sss_key_s_0, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_DataProvider_Failover_ServerTuning(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *); \
+    SBUS_CHECK_RECV((handler_recv), uint32_t*, uint32_t*, uint32_t*); \
+    sbus_method_async("ServerTuning", \
+        &_sbus_sss_args_sssd_DataProvider_Failover_ServerTuning, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out_uuu_send, \
+        _sbus_sss_key_s_0, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: sssd.ProxyChild.Auth */
 #define SBUS_IFACE_sssd_ProxyChild_Auth(methods, signals, properties) ({ \
     sbus_interface("sssd.ProxyChild.Auth", NULL, \
@@ -415,6 +481,28 @@
         (methods), (signals), (properties)); \
 })
 
+/* Method: sssd.Responder.Domain.ClearDegraded */
+#define SBUS_METHOD_SYNC_sssd_Responder_Domain_ClearDegraded(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *); \
+    sbus_method_sync("ClearDegraded", \
+        &_sbus_sss_args_sssd_Responder_Domain_ClearDegraded, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out__send, \
+        _sbus_sss_key_s_0, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Domain_ClearDegraded(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("ClearDegraded", \
+        &_sbus_sss_args_sssd_Responder_Domain_ClearDegraded, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out__send, \
+        _sbus_sss_key_s_0, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Method: sssd.Responder.Domain.SetActive */
 #define SBUS_METHOD_SYNC_sssd_Responder_Domain_SetActive(handler, data) ({ \
     SBUS_CHECK_SYNC((handler), (data), const char *); \
@@ -437,6 +525,28 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: sssd.Responder.Domain.SetDegraded */
+#define SBUS_METHOD_SYNC_sssd_Responder_Domain_SetDegraded(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *); \
+    sbus_method_sync("SetDegraded", \
+        &_sbus_sss_args_sssd_Responder_Domain_SetDegraded, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out__send, \
+        _sbus_sss_key_s_0, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Domain_SetDegraded(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("SetDegraded", \
+        &_sbus_sss_args_sssd_Responder_Domain_SetDegraded, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out__send, \
+        _sbus_sss_key_s_0, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Method: sssd.Responder.Domain.SetInconsistent */
 #define SBUS_METHOD_SYNC_sssd_Responder_Domain_SetInconsistent(handler, data) ({ \
     SBUS_CHECK_SYNC((handler), (data), const char *); \
@@ -509,6 +619,188 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Interface: sssd.Responder.Stats */
+#define SBUS_IFACE_sssd_Responder_Stats(methods, signals, properties) ({ \
+    sbus_interface("sssd.Responder.Stats", NULL, \
+        (methods), (signals), (properties)); \
+})
+
+/* Method: sssd.Responder.Stats.CacheReq */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_CacheReq(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint64_t*); \
+    sbus_method_sync("CacheReq", \
+        &_sbus_sss_args_sssd_Responder_Stats_CacheReq, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tt_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_CacheReq(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint64_t*); \
+    sbus_method_async("CacheReq", \
+        &_sbus_sss_args_sssd_Responder_Stats_CacheReq, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tt_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.Responder.Stats.Commands */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_Commands(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint64_t*, uint32_t **, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_sync("Commands", \
+        &_sbus_sss_args_sssd_Responder_Stats_Commands, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttauatatat_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_Commands(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint64_t*, uint32_t **, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_async("Commands", \
+        &_sbus_sss_args_sssd_Responder_Stats_Commands, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttauatatat_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.Responder.Stats.Dispatcher */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_Dispatcher(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char ***, uint64_t **, uint64_t **, uint64_t **, uint32_t **); \
+    sbus_method_sync("Dispatcher", \
+        &_sbus_sss_args_sssd_Responder_Stats_Dispatcher, \
+        NULL, \
+        _sbus_sss_invoke_in__out_asatatatau_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_Dispatcher(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), const char ***, uint64_t **, uint64_t **, uint64_t **, uint32_t **); \
+    sbus_method_async("Dispatcher", \
+        &_sbus_sss_args_sssd_Responder_Stats_Dispatcher, \
+        NULL, \
+        _sbus_sss_invoke_in__out_asatatatau_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.Responder.Stats.Memory */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_Memory(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint32_t **, uint64_t **, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_sync("Memory", \
+        &_sbus_sss_args_sssd_Responder_Stats_Memory, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tauatatatat_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_Memory(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint32_t **, uint64_t **, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_async("Memory", \
+        &_sbus_sss_args_sssd_Responder_Stats_Memory, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tauatatatat_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.Responder.Stats.MemoryUsage */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_MemoryUsage(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_sync("MemoryUsage", \
+        &_sbus_sss_args_sssd_Responder_Stats_MemoryUsage, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tttttttt_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_MemoryUsage(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_async("MemoryUsage", \
+        &_sbus_sss_args_sssd_Responder_Stats_MemoryUsage, \
+        NULL, \
+        _sbus_sss_invoke_in__out_tttttttt_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.Responder.Stats.ObjectCache */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_ObjectCache(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_sync("ObjectCache", \
+        &_sbus_sss_args_sssd_Responder_Stats_ObjectCache, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttt_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_ObjectCache(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_async("ObjectCache", \
+        &_sbus_sss_args_sssd_Responder_Stats_ObjectCache, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttt_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.Responder.Stats.PacketPool */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_PacketPool(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_sync("PacketPool", \
+        &_sbus_sss_args_sssd_Responder_Stats_PacketPool, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttttttt_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_PacketPool(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_async("PacketPool", \
+        &_sbus_sss_args_sssd_Responder_Stats_PacketPool, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttttttt_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.Responder.Stats.Throttle */
+#define SBUS_METHOD_SYNC_sssd_Responder_Stats_Throttle(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_sync("Throttle", \
+        &_sbus_sss_args_sssd_Responder_Stats_Throttle, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttt_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_Responder_Stats_Throttle(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data)); \
+    SBUS_CHECK_RECV((handler_recv), uint64_t*, uint64_t*, uint64_t*); \
+    sbus_method_async("Throttle", \
+        &_sbus_sss_args_sssd_Responder_Stats_Throttle, \
+        NULL, \
+        _sbus_sss_invoke_in__out_ttt_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: sssd.dataprovider */
 #define SBUS_IFACE_sssd_dataprovider(methods, signals, properties) ({ \
     sbus_interface("sssd.dataprovider", NULL, \
@@ -539,23 +831,23 @@
 
 /* Method: sssd.dataprovider.getAccountInfo */
 #define SBUS_METHOD_SYNC_sssd_dataprovider_getAccountInfo(handler, data) ({ \
-    SBUS_CHECK_SYNC((handler), (data), uint32_t, uint32_t, const char *, const char *, const char *, uint16_t*, uint32_t*, const char **); \
+    SBUS_CHECK_SYNC((handler), (data), uint32_t, uint32_t, const char *, const char *, const char *, uint32_t, uint16_t*, uint32_t*, const char **); \
     sbus_method_sync("getAccountInfo", \
         &_sbus_sss_args_sssd_dataprovider_getAccountInfo, \
         NULL, \
-        _sbus_sss_invoke_in_uusss_out_qus_send, \
-        _sbus_sss_key_uusss_0_1_2_3_4, \
+        _sbus_sss_invoke_in_uuRRRu_out_qus_send, \
+        _sbus_sss_key_uuRRRu_0_1_2_3_4, \
         (handler), (data)); \
 })
 
 #define SBUS_METHOD_ASYNC_sssd_dataprovider_getAccountInfo(handler_send, handler_recv, data) ({ \
-    SBUS_CHECK_SEND((handler_send), (data), uint32_t, uint32_t, const char *, const char *, const char *); \
+    SBUS_CHECK_SEND((handler_send), (data), uint32_t, uint32_t, const char *, const char *, const char *, uint32_t); \
     SBUS_CHECK_RECV((handler_recv), uint16_t*, uint32_t*, const char **); \
     sbus_method_async("getAccountInfo", \
         &_sbus_sss_args_sssd_dataprovider_getAccountInfo, \
         NULL, \
-        _sbus_sss_invoke_in_uusss_out_qus_send, \
-        _sbus_sss_key_uusss_0_1_2_3_4, \
+        _sbus_sss_invoke_in_uuRRRu_out_qus_send, \
+        _sbus_sss_key_uuRRRu_0_1_2_3_4, \
         (handler_send), (handler_recv), (data)); \
 })
 
@@ -669,6 +961,56 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Interface: sssd.ifp.Changes */
+#define SBUS_IFACE_sssd_ifp_Changes(methods, signals, properties) ({ \
+    sbus_interface("sssd.ifp.Changes", NULL, \
+        (methods), (signals), (properties)); \
+})
+
+/* Method: sssd.ifp.Changes.GroupsChanged */
+#define SBUS_METHOD_SYNC_sssd_ifp_Changes_GroupsChanged(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, const char **); \
+    sbus_method_sync("GroupsChanged", \
+        &_sbus_sss_args_sssd_ifp_Changes_GroupsChanged, \
+        NULL, \
+        _sbus_sss_invoke_in_sas_out__send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_ifp_Changes_GroupsChanged(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *, const char **); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("GroupsChanged", \
+        &_sbus_sss_args_sssd_ifp_Changes_GroupsChanged, \
+        NULL, \
+        _sbus_sss_invoke_in_sas_out__send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.ifp.Changes.UsersChanged */
+#define SBUS_METHOD_SYNC_sssd_ifp_Changes_UsersChanged(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, const char **); \
+    sbus_method_sync("UsersChanged", \
+        &_sbus_sss_args_sssd_ifp_Changes_UsersChanged, \
+        NULL, \
+        _sbus_sss_invoke_in_sas_out__send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_ifp_Changes_UsersChanged(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *, const char **); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("UsersChanged", \
+        &_sbus_sss_args_sssd_ifp_Changes_UsersChanged, \
+        NULL, \
+        _sbus_sss_invoke_in_sas_out__send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: sssd.monitor */
 #define SBUS_IFACE_sssd_monitor(methods, signals, properties) ({ \
     sbus_interface("sssd.monitor", NULL, \
@@ -769,6 +1111,28 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: sssd.nss.MemoryCache.InvalidateDomain */
+#define SBUS_METHOD_SYNC_sssd_nss_MemoryCache_InvalidateDomain(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *); \
+    sbus_method_sync("InvalidateDomain", \
+        &_sbus_sss_args_sssd_nss_MemoryCache_InvalidateDomain, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out__send, \
+        _sbus_sss_key_s_0, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_nss_MemoryCache_InvalidateDomain(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("InvalidateDomain", \
+        &_sbus_sss_args_sssd_nss_MemoryCache_InvalidateDomain, \
+        NULL, \
+        _sbus_sss_invoke_in_s_out__send, \
+        _sbus_sss_key_s_0, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Method: sssd.nss.MemoryCache.InvalidateGroupById */
 #define SBUS_METHOD_SYNC_sssd_nss_MemoryCache_InvalidateGroupById(handler, data) ({ \
     SBUS_CHECK_SYNC((handler), (data), uint32_t); \
@@ -791,6 +1155,28 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: sssd.nss.MemoryCache.InvalidateUserById */
+#define SBUS_METHOD_SYNC_sssd_nss_MemoryCache_InvalidateUserById(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint32_t); \
+    sbus_method_sync("InvalidateUserById", \
+        &_sbus_sss_args_sssd_nss_MemoryCache_InvalidateUserById, \
+        NULL, \
+        _sbus_sss_invoke_in_u_out__send, \
+        _sbus_sss_key_u_0, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_nss_MemoryCache_InvalidateUserById(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), uint32_t); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("InvalidateUserById", \
+        &_sbus_sss_args_sssd_nss_MemoryCache_InvalidateUserById, \
+        NULL, \
+        _sbus_sss_invoke_in_u_out__send, \
+        _sbus_sss_key_u_0, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Method: sssd.nss.MemoryCache.UpdateInitgroups */
 #define SBUS_METHOD_SYNC_sssd_nss_MemoryCache_UpdateInitgroups(handler, data) ({ \
     SBUS_CHECK_SYNC((handler), (data), const char *, const char *, uint32_t *); \
@@ -40,6 +40,15 @@
          const char **_key)
 
 _sbus_sss_declare_invoker(, );
+_sbus_sss_declare_invoker(, asatatatau);
+_sbus_sss_declare_invoker(, tauatatatat);
+_sbus_sss_declare_invoker(, tt);
+_sbus_sss_declare_invoker(, ttauatatat);
+_sbus_sss_declare_invoker(, ttt);
+_sbus_sss_declare_invoker(, tttt);
+_sbus_sss_declare_invoker(, ttttttt);
+_sbus_sss_declare_invoker(, tttttttt);
+_sbus_sss_declare_invoker(, ut);
 _sbus_sss_declare_invoker(pam_data, pam_response);
 _sbus_sss_declare_invoker(raw, qus);
 _sbus_sss_declare_invoker(s, );
@@ -47,6 +56,8 @@ _sbus_sss_declare_invoker(s, as);
 _sbus_sss_declare_invoker(s, b);
 _sbus_sss_declare_invoker(s, qus);
 _sbus_sss_declare_invoker(s, s);
+_sbus_sss_declare_invoker(s, uuu);
+_sbus_sss_declare_invoker(sas, );
 _sbus_sss_declare_invoker(sqq, q);
 _sbus_sss_declare_invoker(ss, o);
 _sbus_sss_declare_invoker(ssau, );
@@ -55,8 +66,8 @@ _sbus_sss_declare_invoker(us, );
 _sbus_sss_declare_invoker(usq, );
 _sbus_sss_declare_invoker(uss, );
 _sbus_sss_declare_invoker(uss, qus);
+_sbus_sss_declare_invoker(uuRRRu, qus);
 _sbus_sss_declare_invoker(uus, qus);
-_sbus_sss_declare_invoker(uusss, qus);
 _sbus_sss_declare_invoker(uuus, qus);
 
 #endif /* _SBUS_SSS_INVOKERS_H_ */
@@ -61,16 +61,16 @@ _sbus_sss_key_uss_0_1_2
     struct _sbus_sss_invoker_args_uss *args);
 
 const char *
-_sbus_sss_key_uus_0_1_2
+_sbus_sss_key_uuRRRu_0_1_2_3_4
    (TALLOC_CTX *mem_ctx,
     struct sbus_request *sbus_req,
-    struct _sbus_sss_invoker_args_uus *args);
+    struct _sbus_sss_invoker_args_uuRRRu *args);
 
 const char *
-_sbus_sss_key_uusss_0_1_2_3_4
+_sbus_sss_key_uus_0_1_2
    (TALLOC_CTX *mem_ctx,
     struct sbus_request *sbus_req,
-    struct _sbus_sss_invoker_args_uusss *args);
+    struct _sbus_sss_invoker_args_uus *args);
 
 const char *
 _sbus_sss_key_uuus_0_1_2_3
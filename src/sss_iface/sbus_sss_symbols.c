@@ -131,6 +131,32 @@ _sbus_sss_args_sssd_DataProvider_Backend_IsOnline = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_DataProvider_Backend_PerfStats = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "server_ops"},
+        {.type = "t", .name = "server_usecs"},
+        {.type = "t", .name = "sysdb_transactions"},
+        {.type = "t", .name = "sysdb_usecs"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_DataProvider_Backend_RequestStats = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "u", .name = "active"},
+        {.type = "t", .name = "coalesced"},
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_DataProvider_Client_Register = {
     .input = (const struct sbus_argument[]){
@@ -178,6 +204,20 @@ _sbus_sss_args_sssd_DataProvider_Failover_ListServices = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_DataProvider_Failover_ServerTuning = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "service_name"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "u", .name = "page_size"},
+        {.type = "u", .name = "pool_size"},
+        {.type = "u", .name = "page_msecs"},
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_ProxyChild_Auth_PAM = {
     .input = (const struct sbus_argument[]){
@@ -201,6 +241,17 @@ _sbus_sss_args_sssd_ProxyChild_Client_Register = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Domain_ClearDegraded = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "name"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_Responder_Domain_SetActive = {
     .input = (const struct sbus_argument[]){
@@ -212,6 +263,17 @@ _sbus_sss_args_sssd_Responder_Domain_SetActive = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Domain_SetDegraded = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "name"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_Responder_Domain_SetInconsistent = {
     .input = (const struct sbus_argument[]){
@@ -243,6 +305,126 @@ _sbus_sss_args_sssd_Responder_NegativeCache_ResetUsers = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_CacheReq = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "in_flight"},
+        {.type = "t", .name = "coalesced"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Commands = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "in_flight"},
+        {.type = "t", .name = "queued"},
+        {.type = "au", .name = "commands"},
+        {.type = "at", .name = "counts"},
+        {.type = "at", .name = "usecs"},
+        {.type = "at", .name = "buckets"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Dispatcher = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "as", .name = "connections"},
+        {.type = "at", .name = "wakeups"},
+        {.type = "at", .name = "messages"},
+        {.type = "at", .name = "deferred"},
+        {.type = "au", .name = "max_batch"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Memory = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "pool_size"},
+        {.type = "au", .name = "commands"},
+        {.type = "at", .name = "requests"},
+        {.type = "at", .name = "used_sum"},
+        {.type = "at", .name = "used_max"},
+        {.type = "at", .name = "overflows"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_MemoryUsage = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "total"},
+        {.type = "t", .name = "clients"},
+        {.type = "t", .name = "object_cache"},
+        {.type = "t", .name = "negcache"},
+        {.type = "t", .name = "prefilter"},
+        {.type = "t", .name = "packet_pool"},
+        {.type = "t", .name = "soft_limit"},
+        {.type = "t", .name = "sheds"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_ObjectCache = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "entries"},
+        {.type = "t", .name = "hits"},
+        {.type = "t", .name = "misses"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_PacketPool = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "hits"},
+        {.type = "t", .name = "misses"},
+        {.type = "t", .name = "discards"},
+        {.type = "t", .name = "num_used"},
+        {.type = "t", .name = "used_bytes"},
+        {.type = "t", .name = "num_free"},
+        {.type = "t", .name = "free_bytes"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Throttle = {
+    .input = (const struct sbus_argument[]){
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "t", .name = "deferred"},
+        {.type = "t", .name = "waiting"},
+        {.type = "t", .name = "uids"},
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_dataprovider_getAccountDomain = {
     .input = (const struct sbus_argument[]){
@@ -267,6 +449,7 @@ _sbus_sss_args_sssd_dataprovider_getAccountInfo = {
         {.type = "s", .name = "filter"},
         {.type = "s", .name = "domain"},
         {.type = "s", .name = "extra"},
+        {.type = "u", .name = "trace_id"},
         {NULL}
     },
     .output = (const struct sbus_argument[]){
@@ -349,6 +532,30 @@ _sbus_sss_args_sssd_dataprovider_sudoHandler = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_ifp_Changes_GroupsChanged = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "domain"},
+        {.type = "as", .name = "names"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_ifp_Changes_UsersChanged = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "domain"},
+        {.type = "as", .name = "names"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_monitor_RegisterService = {
     .input = (const struct sbus_argument[]){
@@ -393,6 +600,17 @@ _sbus_sss_args_sssd_nss_MemoryCache_InvalidateAllUsers = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateDomain = {
+    .input = (const struct sbus_argument[]){
+        {.type = "s", .name = "domain"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_nss_MemoryCache_InvalidateGroupById = {
     .input = (const struct sbus_argument[]){
@@ -404,6 +622,17 @@ _sbus_sss_args_sssd_nss_MemoryCache_InvalidateGroupById = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateUserById = {
+    .input = (const struct sbus_argument[]){
+        {.type = "u", .name = "uid"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_nss_MemoryCache_UpdateInitgroups = {
     .input = (const struct sbus_argument[]){
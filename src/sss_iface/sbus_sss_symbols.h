@@ -49,6 +49,12 @@ _sbus_sss_args_sssd_DataProvider_Autofs_GetMap;
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_DataProvider_Backend_IsOnline;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_DataProvider_Backend_PerfStats;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_DataProvider_Backend_RequestStats;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_DataProvider_Client_Register;
 
@@ -61,15 +67,24 @@ _sbus_sss_args_sssd_DataProvider_Failover_ListServers;
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_DataProvider_Failover_ListServices;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_DataProvider_Failover_ServerTuning;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_ProxyChild_Auth_PAM;
 
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_ProxyChild_Client_Register;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Domain_ClearDegraded;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_Responder_Domain_SetActive;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Domain_SetDegraded;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_Responder_Domain_SetInconsistent;
 
@@ -79,6 +94,30 @@ _sbus_sss_args_sssd_Responder_NegativeCache_ResetGroups;
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_Responder_NegativeCache_ResetUsers;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_CacheReq;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Commands;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Dispatcher;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Memory;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_MemoryUsage;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_ObjectCache;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_PacketPool;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_Responder_Stats_Throttle;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_dataprovider_getAccountDomain;
 
@@ -100,6 +139,12 @@ _sbus_sss_args_sssd_dataprovider_resolverHandler;
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_dataprovider_sudoHandler;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_ifp_Changes_GroupsChanged;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_ifp_Changes_UsersChanged;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_monitor_RegisterService;
 
@@ -112,9 +157,15 @@ _sbus_sss_args_sssd_nss_MemoryCache_InvalidateAllInitgroups;
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_nss_MemoryCache_InvalidateAllUsers;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateDomain;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_nss_MemoryCache_InvalidateGroupById;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateUserById;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_nss_MemoryCache_UpdateInitgroups;
 
@@ -0,0 +1,65 @@
+/*
+   SSSD
+
+   Common helpers of the microbenchmarks
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __BENCH_COMMON_H__
+#define __BENCH_COMMON_H__
+
+#include <stdio.h>
+#include <time.h>
+
+/* Every result is printed as one JSON object per line so that the output
+ * of "make bench" can be collected and compared between builds:
+ * {"bench": "negcache", "case": "uid hit", "iterations": 1000000,
+ *  "ns_per_op": 41.2} */
+
+struct bench_timer {
+    struct timespec start;
+    struct timespec end;
+};
+
+static inline void bench_timer_start(struct bench_timer *timer)
+{
+    clock_gettime(CLOCK_MONOTONIC, &timer->start);
+}
+
+static inline void bench_timer_stop(struct bench_timer *timer)
+{
+    clock_gettime(CLOCK_MONOTONIC, &timer->end);
+}
+
+static inline double bench_timer_ns_per_op(struct bench_timer *timer,
+                                           long ops)
+{
+    double ns;
+
+    ns = (timer->end.tv_sec - timer->start.tv_sec) * 1e9
+         + (timer->end.tv_nsec - timer->start.tv_nsec);
+
+    return ops > 0 ? ns / ops : 0;
+}
+
+static inline void bench_report(const char *bench, const char *name,
+                                long ops, double ns_per_op)
+{
+    printf("{\"bench\": \"%s\", \"case\": \"%s\", \"iterations\": %ld, "
+           "\"ns_per_op\": %.1f}\n", bench, name, ops, ns_per_op);
+    fflush(stdout);
+}
+
+#endif /* __BENCH_COMMON_H__ */
@@ -249,6 +249,74 @@ static void test_confdb_get_enabled_domain_list(void **state)
 
     TALLOC_FREE(tmp_ctx);
 }
+static void test_confdb_snapshot(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type(*state, struct test_ctx);
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    const char *val[2] = { NULL, NULL };
+    char **values;
+    char *str;
+    int ret;
+
+    ret = confdb_snapshot_load(test_ctx->confdb);
+    assert_int_equal(ret, EOK);
+    assert_non_null(test_ctx->confdb->snapshot);
+
+    ret = confdb_get_string(test_ctx->confdb, tmp_ctx,
+                            "config/domain/" TEST_DOMAIN_ENABLED_2,
+                            "enabled", NULL, &str);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(str, "true");
+
+    /* sections are found regardless of case */
+    ret = confdb_get_param(test_ctx->confdb, tmp_ctx,
+                           "config/SSSD", "config_file_version", &values);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(values[0], "2");
+    assert_null(values[1]);
+
+    /* missing options and sections */
+    ret = confdb_get_param(test_ctx->confdb, tmp_ctx,
+                           "config/sssd", "no_such_option", &values);
+    assert_int_equal(ret, EOK);
+    assert_null(values[0]);
+
+    ret = confdb_get_param(test_ctx->confdb, tmp_ctx,
+                           "config/no_such_section", "enabled", &values);
+    assert_int_equal(ret, EOK);
+    assert_null(values[0]);
+
+    ret = confdb_get_domain_section(tmp_ctx, test_ctx->confdb,
+                                    CONFDB_DOMAIN_BASEDN,
+                                    TEST_DOMAIN_ENABLED_3, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_string_equal(ldb_msg_find_attr_as_string(res->msgs[0],
+                                                    "id_provider", NULL),
+                        "local");
+
+    ret = confdb_get_domain_section(tmp_ctx, test_ctx->confdb,
+                                    CONFDB_DOMAIN_BASEDN,
+                                    "no_such_domain", &res);
+    assert_int_equal(ret, ENOENT);
+
+    /* a write drops the snapshot, so the new value is read */
+    val[0] = "false";
+    ret = confdb_add_param(test_ctx->confdb, true,
+                           "config/domain/" TEST_DOMAIN_ENABLED_2, "enabled",
+                           val);
+    assert_int_equal(ret, EOK);
+    assert_null(test_ctx->confdb->snapshot);
+
+    ret = confdb_get_string(test_ctx->confdb, tmp_ctx,
+                            "config/domain/" TEST_DOMAIN_ENABLED_2,
+                            "enabled", NULL, &str);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(str, "false");
+
+    talloc_free(tmp_ctx);
+}
 
 
 int main(int argc, const char *argv[])
@@ -272,6 +340,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_confdb_get_enabled_domain_list,
                                         confdb_test_setup,
                                         confdb_test_teardown),
+        cmocka_unit_test_setup_teardown(test_confdb_snapshot,
+                                        confdb_test_setup,
+                                        confdb_test_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
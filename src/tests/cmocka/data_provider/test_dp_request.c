@@ -23,6 +23,7 @@
 #include "providers/backend.h"
 #include "providers/data_provider/dp_private.h"
 #include "providers/data_provider/dp.h"
+#include "db/sysdb_private.h"
 #include "tests/cmocka/common_mock.h"
 #include "tests/common.h"
 #include "tests/cmocka/common_mock_be.h"
@@ -83,6 +84,14 @@ bool __wrap_be_is_offline(struct be_ctx *ctx)
     return is_be_offline_opt;
 }
 
+/* The responders are not connected in this test. */
+void dp_sbus_domain_degraded(struct data_provider *provider,
+                             struct sss_domain_info *dom,
+                             bool degraded)
+{
+    return;
+}
+
 #define UID       100001
 #define UID2      100002
 #define UID_FAIL  100003
@@ -408,6 +417,497 @@ static void test_fast_reply(void **state)
     talloc_free(md);
 }
 
+static struct tevent_req *
+get_reply_std_send(TALLOC_CTX *mem_ctx,
+                   struct method_data *md,
+                   struct req_data *req_data,
+                   struct dp_req_params *params)
+{
+    struct tevent_req *req;
+    struct test_state *state;
+    struct tevent_timer *tt;
+    struct timeval tv;
+
+    req = tevent_req_create(mem_ctx, &state, struct test_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    state->uid = req_data->uid;
+
+    /* Mock lookup */
+    tv = tevent_timeval_current_ofs(1, 0);
+    tt = tevent_add_timer(params->ev, req, tv, get_name_by_uid_done, req);
+    if (tt == NULL) {
+        return NULL;
+    }
+
+    md->foo++;
+
+    return req;
+}
+
+static errno_t
+get_reply_std_recv(TALLOC_CTX *mem_ctx,
+                   struct tevent_req *req,
+                   struct dp_reply_std *reply)
+{
+    struct test_state *state;
+
+    state = tevent_req_data(req, struct test_state);
+
+    reply->dp_error = DP_ERR_OK;
+    reply->error = state->name == NULL ? ENOENT : EOK;
+    reply->message = talloc_strdup(reply, state->name ?: "not found");
+
+    return EOK;
+}
+
+static void test_coalesce(void **state)
+{
+    errno_t ret;
+    struct test_ctx *test_ctx;
+    const char *req_name;
+    struct tevent_req *req;
+    struct tevent_req *req2;
+    struct tevent_req *req3;
+    struct method_data *md;
+    struct req_data *req_data;
+    struct dp_reply_std *reply;
+
+    test_ctx = talloc_get_type(*state, struct test_ctx);
+
+    md = talloc_zero(test_ctx, struct method_data);
+    assert_non_null(md);
+
+    dp_set_method(test_ctx->dp_methods,
+                  DPM_ACCOUNT_HANDLER,
+                  get_reply_std_send, get_reply_std_recv,
+                  md,
+                  struct method_data, struct req_data, struct dp_reply_std);
+
+    /* Send request #1 */
+    req_data = talloc_zero(test_ctx, struct req_data);
+    assert_non_null(req_data);
+    req_data->uid = UID;
+
+    req = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL, REQ_NAME,
+                            "uid=100001", DPT_ID, DPM_ACCOUNT_HANDLER, 0,
+                            req_data, &req_name);
+    assert_non_null(req);
+    assert_string_equal(req_name, REQ_NAME" #0");
+    talloc_zfree(req_name);
+
+    /* Request #2 has different flags but it is attached to #1 */
+    req_data = talloc_zero(test_ctx, struct req_data);
+    assert_non_null(req_data);
+    req_data->uid = UID;
+
+    req2 = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL, REQ_NAME,
+                             "uid=100001", DPT_ID, DPM_ACCOUNT_HANDLER,
+                             DP_FAST_REPLY, req_data, &req_name);
+    assert_non_null(req2);
+    assert_string_equal(req_name, REQ_NAME" #0");
+    talloc_zfree(req_name);
+
+    /* Request #3 has a different key */
+    req_data = talloc_zero(test_ctx, struct req_data);
+    assert_non_null(req_data);
+    req_data->uid = UID2;
+
+    req3 = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL, REQ_NAME,
+                             "uid=100002", DPT_ID, DPM_ACCOUNT_HANDLER, 0,
+                             req_data, &req_name);
+    assert_non_null(req3);
+    assert_string_equal(req_name, REQ_NAME" #1");
+    talloc_zfree(req_name);
+
+    tevent_loop_wait(test_ctx->tctx->ev);
+
+    assert_int_equal(md->foo, 2);
+    assert_int_equal(test_ctx->provider->requests.num_coalesced, 1);
+
+    ret = dp_req_recv_ptr(test_ctx, req, struct dp_reply_std, &reply);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(reply->error, EOK);
+    assert_string_equal(reply->message, NAME);
+    talloc_free(reply);
+
+    ret = dp_req_recv_ptr(test_ctx, req2, struct dp_reply_std, &reply);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(reply->error, EOK);
+    assert_string_equal(reply->message, NAME);
+    talloc_free(reply);
+
+    ret = dp_req_recv_ptr(test_ctx, req3, struct dp_reply_std, &reply);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(reply->error, EOK);
+    assert_string_equal(reply->message, NAME2);
+    talloc_free(reply);
+
+    talloc_free(req);
+    talloc_free(req2);
+    talloc_free(req3);
+    talloc_free(md);
+}
+
+static void test_coalesce_leader_freed(void **state)
+{
+    errno_t ret;
+    struct test_ctx *test_ctx;
+    struct tevent_req *req[3];
+    struct method_data *md;
+    struct req_data *req_data;
+    struct dp_reply_std *reply;
+    int i;
+
+    test_ctx = talloc_get_type(*state, struct test_ctx);
+
+    md = talloc_zero(test_ctx, struct method_data);
+    assert_non_null(md);
+
+    dp_set_method(test_ctx->dp_methods,
+                  DPM_ACCOUNT_HANDLER,
+                  get_reply_std_send, get_reply_std_recv,
+                  md,
+                  struct method_data, struct req_data, struct dp_reply_std);
+
+    for (i = 0; i < 3; i++) {
+        req_data = talloc_zero(test_ctx, struct req_data);
+        assert_non_null(req_data);
+        req_data->uid = UID;
+
+        req[i] = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL,
+                                   REQ_NAME, "uid=100001", DPT_ID,
+                                   DPM_ACCOUNT_HANDLER, 0, req_data, NULL);
+        assert_non_null(req[i]);
+    }
+
+    /* The caller of the running request goes away, the attached ones get
+     * the result of the same lookup */
+    talloc_free(req[0]);
+    assert_int_equal(test_ctx->provider->requests.num_active, 1);
+
+    tevent_loop_wait(test_ctx->tctx->ev);
+
+    assert_int_equal(md->foo, 1);
+    assert_int_equal(test_ctx->provider->requests.num_active, 0);
+
+    for (i = 1; i < 3; i++) {
+        ret = dp_req_recv_ptr(test_ctx, req[i], struct dp_reply_std, &reply);
+        assert_int_equal(ret, EOK);
+        assert_int_equal(reply->error, EOK);
+        assert_string_equal(reply->message, NAME);
+        talloc_free(reply);
+    }
+
+    /* Without anyone attached the request is terminated */
+    req_data = talloc_zero(test_ctx, struct req_data);
+    assert_non_null(req_data);
+    req_data->uid = UID;
+    req[0] = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL,
+                               REQ_NAME, "uid=100001", DPT_ID,
+                               DPM_ACCOUNT_HANDLER, 0, req_data, NULL);
+    assert_non_null(req[0]);
+    talloc_free(req[0]);
+    assert_int_equal(test_ctx->provider->requests.num_active, 0);
+
+    talloc_free(req[1]);
+    talloc_free(req[2]);
+    talloc_free(md);
+}
+
+static void test_background(void **state)
+{
+    errno_t ret;
+    struct test_ctx *test_ctx;
+    struct tevent_req *req[7];
+    struct method_data *md;
+    struct req_data *req_data;
+    struct dp_reply_std *reply;
+    int i;
+
+    test_ctx = talloc_get_type(*state, struct test_ctx);
+
+    md = talloc_zero(test_ctx, struct method_data);
+    assert_non_null(md);
+
+    dp_set_method(test_ctx->dp_methods,
+                  DPM_ACCOUNT_HANDLER,
+                  get_reply_std_send, get_reply_std_recv,
+                  md,
+                  struct method_data, struct req_data, struct dp_reply_std);
+
+    /* Only some of the background requests are run at once */
+    for (i = 0; i < 6; i++) {
+        req_data = talloc_zero(test_ctx, struct req_data);
+        assert_non_null(req_data);
+        req_data->uid = UID;
+
+        req[i] = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL,
+                                   REQ_NAME, i == 5 ? "uid=100001" : NULL,
+                                   DPT_ID, DPM_ACCOUNT_HANDLER, DP_BACKGROUND,
+                                   req_data, NULL);
+        assert_non_null(req[i]);
+    }
+
+    assert_int_equal(md->foo, 4);
+    assert_int_equal(test_ctx->provider->requests.num_background, 4);
+    assert_int_equal(test_ctx->provider->requests.num_queued, 2);
+
+    /* Interactive request attached to a queued one starts it immediately */
+    req_data = talloc_zero(test_ctx, struct req_data);
+    assert_non_null(req_data);
+    req_data->uid = UID;
+
+    req[6] = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL, REQ_NAME,
+                               "uid=100001", DPT_ID, DPM_ACCOUNT_HANDLER, 0,
+                               req_data, NULL);
+    assert_non_null(req[6]);
+
+    assert_int_equal(md->foo, 5);
+    assert_int_equal(test_ctx->provider->requests.num_interactive, 1);
+    assert_int_equal(test_ctx->provider->requests.num_queued, 1);
+
+    tevent_loop_wait(test_ctx->tctx->ev);
+
+    assert_int_equal(md->foo, 6);
+    assert_int_equal(test_ctx->provider->requests.num_interactive, 0);
+    assert_int_equal(test_ctx->provider->requests.num_background, 0);
+    assert_int_equal(test_ctx->provider->requests.num_queued, 0);
+
+    for (i = 0; i < 7; i++) {
+        ret = dp_req_recv_ptr(test_ctx, req[i], struct dp_reply_std, &reply);
+        assert_int_equal(ret, EOK);
+        assert_int_equal(reply->error, EOK);
+        assert_string_equal(reply->message, NAME);
+        talloc_free(reply);
+        talloc_free(req[i]);
+    }
+
+    talloc_free(md);
+}
+
+static void test_recent(void **state)
+{
+    errno_t ret;
+    struct test_ctx *test_ctx;
+    struct tevent_req *req[4];
+    struct method_data *md;
+    struct req_data *req_data;
+    struct dp_reply_std *reply;
+    const char *keys[] = { "uid=100001", "uid=100001",
+                           "uid=100001", "uid=100002" };
+    uint32_t flags[] = { 0, DP_BACKGROUND, 0, DP_REFRESH };
+    int i;
+
+    test_ctx = talloc_get_type(*state, struct test_ctx);
+    test_ctx->provider->requests.recent_timeout = 60;
+
+    md = talloc_zero(test_ctx, struct method_data);
+    assert_non_null(md);
+
+    dp_set_method(test_ctx->dp_methods,
+                  DPM_ACCOUNT_HANDLER,
+                  get_reply_std_send, get_reply_std_recv,
+                  md,
+                  struct method_data, struct req_data, struct dp_reply_std);
+
+    /* #1 is run, the refresh #2 that follows it is answered at once,
+     * #3 is not a refresh and #4 refreshes another entry, both are run */
+    for (i = 0; i < 4; i++) {
+        req_data = talloc_zero(test_ctx, struct req_data);
+        assert_non_null(req_data);
+        req_data->uid = i == 3 ? UID2 : UID;
+
+        req[i] = dp_req_keyed_send(test_ctx, test_ctx->provider, NULL,
+                                   REQ_NAME, keys[i], DPT_ID,
+                                   DPM_ACCOUNT_HANDLER, flags[i],
+                                   req_data, NULL);
+        assert_non_null(req[i]);
+
+        tevent_loop_wait(test_ctx->tctx->ev);
+
+        ret = dp_req_recv_ptr(test_ctx, req[i], struct dp_reply_std, &reply);
+        assert_int_equal(ret, EOK);
+        assert_int_equal(reply->dp_error, DP_ERR_OK);
+        assert_int_equal(reply->error, EOK);
+        if (i == 1) {
+            assert_int_equal(md->foo, 1);
+        } else {
+            assert_string_equal(reply->message, i == 3 ? NAME2 : NAME);
+        }
+        talloc_free(reply);
+        talloc_free(req[i]);
+    }
+
+    assert_int_equal(md->foo, 3);
+    assert_int_equal(test_ctx->provider->requests.num_coalesced, 1);
+
+    talloc_zfree(test_ctx->provider->requests.recent);
+    talloc_free(md);
+}
+
+#define TS_UID           100010
+#define TS_NAME          "ts_user"
+#define TS_CACHE_TIMEOUT 100
+
+static uint64_t get_raw_ts_expire(struct sss_domain_info *dom,
+                                  const char *name)
+{
+    const char *attrs[] = { SYSDB_CACHE_EXPIRE, NULL };
+    struct ldb_result *res;
+    struct ldb_dn *dn;
+    uint64_t expire;
+    int ret;
+
+    dn = sysdb_user_dn(NULL, dom, name);
+    assert_non_null(dn);
+
+    ret = ldb_search(dom->sysdb->ldb_ts, dn, &res, dn, LDB_SCOPE_BASE,
+                     attrs, NULL);
+    assert_int_equal(ret, LDB_SUCCESS);
+    assert_int_equal(res->count, 1);
+
+    expire = ldb_msg_find_attr_as_uint64(res->msgs[0], SYSDB_CACHE_EXPIRE, 0);
+    talloc_free(dn);
+    return expire;
+}
+
+struct store_user_state {
+    time_t now;
+};
+
+/* Refreshes an unchanged user, so its timestamps are buffered */
+static struct tevent_req *
+store_user_send(TALLOC_CTX *mem_ctx,
+                struct method_data *md,
+                struct req_data *req_data,
+                struct dp_req_params *params)
+{
+    struct store_user_state *state;
+    struct tevent_req *req;
+    char *name;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct store_user_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    name = sss_create_internal_fqname(state, TS_NAME, params->domain->name);
+    assert_non_null(name);
+    state->now = time(NULL);
+
+    ret = sysdb_store_user(params->domain, name, NULL, req_data->uid,
+                           req_data->uid, NULL, "/home/"TS_NAME, "/bin/sh",
+                           NULL, NULL, NULL, TS_CACHE_TIMEOUT, state->now);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_user(params->domain, name, NULL, req_data->uid,
+                           req_data->uid, NULL, "/home/"TS_NAME, "/bin/sh",
+                           NULL, NULL, NULL, TS_CACHE_TIMEOUT,
+                           state->now + 10);
+    assert_int_equal(ret, EOK);
+
+    /* The second update is not on the disk yet */
+    assert_int_equal(get_raw_ts_expire(params->domain, name),
+                     state->now + TS_CACHE_TIMEOUT);
+    /* The expiration the responder must find */
+    md->foo = state->now + 10 + TS_CACHE_TIMEOUT;
+
+    talloc_free(name);
+    tevent_req_done(req);
+    tevent_req_post(req, params->ev);
+    return req;
+}
+
+static errno_t
+store_user_recv(TALLOC_CTX *mem_ctx,
+                struct tevent_req *req,
+                struct recv_data *recv_data)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+struct check_ts_data {
+    struct test_ctx *test_ctx;
+    struct method_data *md;
+    bool done;
+};
+
+static void check_ts_done(struct tevent_req *req)
+{
+    struct check_ts_data *data;
+    struct sss_domain_info *dom;
+    char *name;
+
+    data = tevent_req_callback_data(req, struct check_ts_data);
+    dom = data->test_ctx->tctx->dom;
+
+    /* This is when a responder reads the cache */
+    name = sss_create_internal_fqname(data, TS_NAME, dom->name);
+    assert_non_null(name);
+    assert_int_equal(get_raw_ts_expire(dom, name), data->md->foo);
+    talloc_free(name);
+
+    data->done = true;
+}
+
+static void test_ts_flushed_before_reply(void **state)
+{
+    errno_t ret;
+    struct test_ctx *test_ctx;
+    struct tevent_req *req;
+    struct method_data *md;
+    struct req_data *req_data;
+    struct recv_data *recv_data;
+    struct check_ts_data data;
+
+    test_ctx = talloc_get_type(*state, struct test_ctx);
+
+    ret = sysdb_ts_buffer_enable(test_ctx->tctx->sysdb, 100, 3600);
+    assert_int_equal(ret, EOK);
+
+    md = talloc_zero(test_ctx, struct method_data);
+    assert_non_null(md);
+
+    dp_set_method(test_ctx->dp_methods,
+                  DPM_ACCOUNT_HANDLER,
+                  store_user_send, store_user_recv,
+                  md,
+                  struct method_data, struct req_data, struct recv_data);
+
+    req_data = talloc_zero(test_ctx, struct req_data);
+    assert_non_null(req_data);
+    req_data->uid = TS_UID;
+
+    req = dp_req_send(test_ctx, test_ctx->provider, NULL, REQ_NAME,
+                      DPT_ID, DPM_ACCOUNT_HANDLER, 0, req_data, NULL);
+    assert_non_null(req);
+
+    data.test_ctx = test_ctx;
+    data.md = md;
+    data.done = false;
+    tevent_req_set_callback(req, check_ts_done, &data);
+
+    tevent_loop_wait(test_ctx->tctx->ev);
+    assert_true(data.done);
+
+    ret = dp_req_recv_ptr(test_ctx, req, struct recv_data, &recv_data);
+    assert_int_equal(ret, EOK);
+    talloc_free(recv_data);
+
+    talloc_free(req);
+    talloc_free(req_data);
+    talloc_free(md);
+
+    ret = sysdb_ts_buffer_enable(test_ctx->tctx->sysdb, 0, 0);
+    assert_int_equal(ret, EOK);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -435,6 +935,21 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_nonexist_dom,
                                         test_setup,
                                         test_teardown),
+        cmocka_unit_test_setup_teardown(test_coalesce,
+                                        test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_coalesce_leader_freed,
+                                        test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_recent,
+                                        test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_ts_flushed_before_reply,
+                                        test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_background,
+                                        test_setup,
+                                        test_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -0,0 +1,217 @@
+/*
+    SSSD
+
+    sbus - large argument tests
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <talloc.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <popt.h>
+
+#include "util/util.h"
+#include "sbus/interface/sbus_iterator_readers.h"
+#include "sbus/interface/sbus_iterator_writers.h"
+#include "tests/cmocka/common_mock.h"
+#include "tests/common.h"
+
+#define BLOB_SIZE (1024 * 1024 + 7)
+
+struct test_ctx {
+    DBusMessage *msg;
+};
+
+static int test_setup(void **state)
+{
+    struct test_ctx *test_ctx;
+
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context, struct test_ctx);
+    assert_non_null(test_ctx);
+
+    test_ctx->msg = dbus_message_new_method_call("bus.test", "/",
+                                                 "iface.test", "method");
+    assert_non_null(test_ctx->msg);
+
+    check_leaks_push(test_ctx);
+    *state = test_ctx;
+
+    return 0;
+}
+
+static int test_teardown(void **state)
+{
+    struct test_ctx *test_ctx;
+
+    test_ctx = talloc_get_type_abort(*state, struct test_ctx);
+
+    assert_true(check_leaks_pop(test_ctx));
+    dbus_message_unref(test_ctx->msg);
+    talloc_zfree(test_ctx);
+    assert_true(leak_check_teardown());
+
+    return 0;
+}
+
+static void test_sbus_blob__roundtrip(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type_abort(*state, struct test_ctx);
+    struct sbus_blob input;
+    struct sbus_blob *output;
+    DBusMessageIter iter;
+    uint8_t *data;
+    errno_t ret;
+    size_t i;
+
+    data = talloc_size(test_ctx, BLOB_SIZE);
+    assert_non_null(data);
+    for (i = 0; i < BLOB_SIZE; i++) {
+        data[i] = i % 251;
+    }
+
+    input.data = data;
+    input.length = BLOB_SIZE;
+
+    dbus_message_iter_init_append(test_ctx->msg, &iter);
+    ret = sbus_iterator_write_blob(&iter, &input);
+    if (ret == ENOTSUP) {
+        talloc_free(data);
+        skip();
+    }
+    assert_int_equal(ret, EOK);
+
+    assert_true(dbus_message_iter_init(test_ctx->msg, &iter));
+    ret = sbus_iterator_read_blob(test_ctx, &iter, &output);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(output->length, BLOB_SIZE);
+    assert_memory_equal(output->data, data, BLOB_SIZE);
+
+    talloc_free(output);
+    talloc_free(data);
+}
+
+static void test_sbus_blob__empty(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type_abort(*state, struct test_ctx);
+    struct sbus_blob input = { NULL, 0 };
+    struct sbus_blob *output;
+    DBusMessageIter iter;
+    errno_t ret;
+
+    dbus_message_iter_init_append(test_ctx->msg, &iter);
+    ret = sbus_iterator_write_blob(&iter, &input);
+    if (ret == ENOTSUP) {
+        skip();
+    }
+    assert_int_equal(ret, EOK);
+
+    assert_true(dbus_message_iter_init(test_ctx->msg, &iter));
+    ret = sbus_iterator_read_blob(test_ctx, &iter, &output);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(output->length, 0);
+
+    talloc_free(output);
+}
+
+static void test_sbus_blob__unsealed(void **state)
+{
+#ifdef HAVE_MEMFD_CREATE
+    struct test_ctx *test_ctx = talloc_get_type_abort(*state, struct test_ctx);
+    struct sbus_blob *output = NULL;
+    DBusMessageIter iter;
+    errno_t ret;
+    int fd;
+
+    fd = memfd_create("test_sbus_blob", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    assert_true(fd >= 0);
+    assert_int_equal(ftruncate(fd, 16), 0);
+
+    dbus_message_iter_init_append(test_ctx->msg, &iter);
+    assert_true(dbus_message_iter_append_basic(&iter, DBUS_TYPE_UNIX_FD, &fd));
+    close(fd);
+
+    assert_true(dbus_message_iter_init(test_ctx->msg, &iter));
+    ret = sbus_iterator_read_blob(test_ctx, &iter, &output);
+    assert_int_equal(ret, EPERM);
+    assert_null(output);
+#else
+    skip();
+#endif
+}
+
+static void test_sbus_blob__wrong_type(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type_abort(*state, struct test_ctx);
+    struct sbus_blob *output = NULL;
+    DBusMessageIter iter;
+    uint32_t value = 42;
+    errno_t ret;
+
+    dbus_message_iter_init_append(test_ctx->msg, &iter);
+    assert_true(dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT32,
+                                               &value));
+
+    assert_true(dbus_message_iter_init(test_ctx->msg, &iter));
+    ret = sbus_iterator_read_blob(test_ctx, &iter, &output);
+    assert_int_equal(ret, ERR_SBUS_INVALID_TYPE);
+    assert_null(output);
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_sbus_blob__roundtrip,
+                                        test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_sbus_blob__empty,
+                                        test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_sbus_blob__unsealed,
+                                        test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_sbus_blob__wrong_type,
+                                        test_setup, test_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
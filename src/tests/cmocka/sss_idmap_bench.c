@@ -0,0 +1,239 @@
+/*
+   SSSD
+
+   ID-mapping library benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Times SID to ID and ID to SID mappings for a growing number of domains,
+ * each of them with the given number of slices, as autorid-style setups
+ * have them. The time of a single mapping should not grow with the number
+ * of domains. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <popt.h>
+
+#include "lib/idmap/sss_idmap.h"
+
+#define DEFAULT_MIN_DOMAINS 8
+#define DEFAULT_MAX_DOMAINS 1024
+#define DEFAULT_SLICES 4
+#define DEFAULT_LOOKUPS 100000
+#define BENCH_RANGE_SIZE 200000
+#define BENCH_MIN_ID 200000
+#define BENCH_SID_LEN 64
+
+static double timespec_diff(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec)
+           + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static enum idmap_error_code bench_add_domains(struct sss_idmap_ctx *ctx,
+                                               int num_domains,
+                                               int num_slices)
+{
+    struct sss_idmap_range range;
+    enum idmap_error_code err;
+    char name[64];
+    char sid[64];
+    int i;
+    int j;
+
+    for (i = 0; i < num_domains; i++) {
+        snprintf(name, sizeof(name), "dom%d.bench", i);
+        snprintf(sid, sizeof(sid), "S-1-5-21-%d-%d-%d", i, 2 * i, 3 * i);
+
+        for (j = 0; j < num_slices; j++) {
+            range.min = BENCH_MIN_ID
+                        + (i * num_slices + j) * BENCH_RANGE_SIZE;
+            range.max = range.min + BENCH_RANGE_SIZE - 1;
+
+            err = sss_idmap_add_domain_ex(ctx, name, sid, &range, NULL,
+                                          j * BENCH_RANGE_SIZE, false);
+            if (err != IDMAP_SUCCESS) {
+                return err;
+            }
+        }
+    }
+
+    return IDMAP_SUCCESS;
+}
+
+static int bench_run(int num_domains, int num_slices, int num_lookups)
+{
+    struct sss_idmap_ctx *ctx;
+    enum idmap_error_code err;
+    enum idmap_error_code *errs;
+    struct timespec start;
+    struct timespec end;
+    char **sids;
+    uint32_t *ids;
+    char *sid;
+    int ret = 1;
+    int d;
+    int i;
+
+    err = sss_idmap_init(NULL, NULL, NULL, &ctx);
+    if (err != IDMAP_SUCCESS) {
+        return 1;
+    }
+
+    sids = calloc(num_lookups, sizeof(char *));
+    ids = calloc(num_lookups, sizeof(uint32_t));
+    errs = calloc(num_lookups, sizeof(enum idmap_error_code));
+    if (sids == NULL || ids == NULL || errs == NULL) {
+        goto done;
+    }
+
+    err = bench_add_domains(ctx, num_domains, num_slices);
+    if (err != IDMAP_SUCCESS) {
+        fprintf(stderr, "Unable to add domains: %s\n",
+                idmap_error_string(err));
+        goto done;
+    }
+
+    for (i = 0; i < num_lookups; i++) {
+        d = rand() % num_domains;
+        sids[i] = malloc(BENCH_SID_LEN);
+        if (sids[i] == NULL) {
+            goto done;
+        }
+        snprintf(sids[i], BENCH_SID_LEN, "S-1-5-21-%d-%d-%d-%d", d, 2 * d,
+                 3 * d, rand() % (num_slices * BENCH_RANGE_SIZE));
+    }
+
+    printf("%8d", num_domains);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < num_lookups; i++) {
+        err = sss_idmap_sid_to_unix(ctx, sids[i], &ids[i]);
+        if (err != IDMAP_SUCCESS) {
+            fprintf(stderr, "\nUnable to map %s: %s\n", sids[i],
+                    idmap_error_string(err));
+            goto done;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf(" %10.1f", timespec_diff(&start, &end) * 1e9 / num_lookups);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    err = sss_idmap_sids_to_unix(ctx, (const char **)sids, num_lookups,
+                                 ids, errs);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (err != IDMAP_SUCCESS) {
+        fprintf(stderr, "\nUnable to map the SIDs: %s\n",
+                idmap_error_string(err));
+        goto done;
+    }
+    printf(" %10.1f", timespec_diff(&start, &end) * 1e9 / num_lookups);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < num_lookups; i++) {
+        err = sss_idmap_unix_to_sid(ctx, ids[i], &sid);
+        if (err != IDMAP_SUCCESS) {
+            fprintf(stderr, "\nUnable to map %u: %s\n", ids[i],
+                    idmap_error_string(err));
+            goto done;
+        }
+        sss_idmap_free_sid(ctx, sid);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf(" %10.1f\n", timespec_diff(&start, &end) * 1e9 / num_lookups);
+
+    ret = 0;
+
+done:
+    if (sids != NULL) {
+        for (i = 0; i < num_lookups; i++) {
+            free(sids[i]);
+        }
+    }
+    free(sids);
+    free(ids);
+    free(errs);
+    sss_idmap_free(ctx);
+    return ret;
+}
+
+int main(int argc, const char *argv[])
+{
+    int pc_min_domains = DEFAULT_MIN_DOMAINS;
+    int pc_max_domains = DEFAULT_MAX_DOMAINS;
+    int pc_slices = DEFAULT_SLICES;
+    int pc_lookups = DEFAULT_LOOKUPS;
+    poptContext pc;
+    int domains;
+    int opt;
+    int ret;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "min-domains", 'm', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                         &pc_min_domains, 0,
+                         "Smallest number of domains", NULL },
+        { "max-domains", 'M', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                         &pc_max_domains, 0,
+                         "Largest number of domains", NULL },
+        { "slices", 's', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                         &pc_slices, 0,
+                         "Slices of each domain", NULL },
+        { "lookups", 'l', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                         &pc_lookups, 0,
+                         "Mappings in each direction", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_min_domains < 1 || pc_max_domains < pc_min_domains
+            || pc_slices < 1 || pc_lookups < 1
+            || (uint64_t)pc_max_domains * pc_slices * BENCH_RANGE_SIZE
+                   > UINT32_MAX - BENCH_MIN_ID) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    printf("%8s %10s %10s %10s\n", "domains", "sid ns", "batch ns",
+           "id ns");
+
+    /* scale from pc_min_domains to pc_max_domains, doubling each round */
+    for (domains = pc_min_domains; ; domains *= 2) {
+        if (domains > pc_max_domains) {
+            domains = pc_max_domains;
+        }
+        ret = bench_run(domains, pc_slices, pc_lookups);
+        if (ret != 0) {
+            return 2;
+        }
+        if (domains == pc_max_domains) {
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -24,12 +24,16 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
 #include <cmocka.h>
 
 
 #include "util/util.h"
 #include "util/sss_endian.h"
 
+#define IPA_389DS_PLUGIN_HELPER_CALLS 1
 #include "sss_client/idmap/sss_nss_idmap.h"
 #include "tests/cmocka/common_mock.h"
 
@@ -85,6 +89,45 @@ enum nss_status __wrap_sss_nss_make_request_timeout(enum sss_cli_command cmd,
     return d->nss_status;
 }
 
+/* The test plays the NSS responder on the other end of a socket pair. */
+int __wrap_sss_cli_open_socket_nb(const char *socket_name, int *errnop)
+{
+    *errnop = sss_mock_type(int);
+    return sss_mock_type(int);
+}
+
+/* Set to the entry that is in the memory cache, the real function is used
+ * otherwise. */
+static const struct passwd *test_mc_pwd;
+
+errno_t __real_sss_nss_mc_getpwnam(const char *name, size_t name_len,
+                                   struct passwd *result,
+                                   char *buffer, size_t buflen);
+
+errno_t __wrap_sss_nss_mc_getpwnam(const char *name, size_t name_len,
+                                   struct passwd *result,
+                                   char *buffer, size_t buflen)
+{
+    if (test_mc_pwd == NULL) {
+        return __real_sss_nss_mc_getpwnam(name, name_len, result, buffer,
+                                          buflen);
+    }
+
+    if (strcmp(name, test_mc_pwd->pw_name) != 0) {
+        return ENOENT;
+    }
+
+    if (buflen < strlen(test_mc_pwd->pw_name) + 1) {
+        return ERANGE;
+    }
+
+    *result = *test_mc_pwd;
+    strcpy(buffer, test_mc_pwd->pw_name);
+    result->pw_name = buffer;
+
+    return 0;
+}
+
 void test_getsidbyname(void **state)
 {
     int ret;
@@ -148,12 +191,583 @@ void test_getorigbyname(void **state)
     sss_nss_free_kv(kv_list);
 }
 
+void test_getnamebyuid_multi(void **state)
+{
+    int ret;
+    char **names = NULL;
+    uint32_t uids[] = { 1000, 1001, 1000 };
+    uint32_t hdr[] = { 1, 0, 1000, 1000 };
+    const char strs[] = "test\0x\0Test User\0/home/test\0/bin/sh";
+    uint8_t repbuf[sizeof(hdr) + sizeof(strs)];
+    struct sss_nss_make_request_test_data d = {repbuf, sizeof(repbuf), 0,
+                                               NSS_STATUS_SUCCESS};
+    size_t c;
+
+    memcpy(repbuf, hdr, sizeof(hdr));
+    memcpy(repbuf + sizeof(hdr), strs, sizeof(strs));
+
+    ret = sss_nss_getnamebyuid_multi_timeout(NULL, 0, 0, &names);
+    assert_int_equal(ret, EINVAL);
+
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getnamebyuid_multi_timeout(uids, 3, 0, &names);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(names[0], "test");
+    assert_null(names[1]);
+    assert_string_equal(names[2], "test");
+
+    for (c = 0; c < 3; c++) {
+        free(names[c]);
+    }
+    free(names);
+
+    /* the record is truncated */
+    d.replen = sizeof(repbuf) - 5;
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getnamebyuid_multi_timeout(uids, 3, 0, &names);
+    assert_int_equal(ret, EBADMSG);
+}
+
+#define TEST_SID_1000 "S-1-5-21-3623811015-3361044348-30300820-1000"
+#define TEST_SID_1002 "S-1-5-21-3623811015-3361044348-30300820-1002"
+
+void test_getsidbyid_multi(void **state)
+{
+    int ret;
+    char **sids = NULL;
+    enum sss_id_type *types = NULL;
+    uint32_t ids[] = { 1000, 1001, 1002 };
+    enum sss_id_type id_types[] = { SSS_ID_TYPE_UID,
+                                    SSS_ID_TYPE_NOT_SPECIFIED,
+                                    SSS_ID_TYPE_GID };
+    uint32_t hdr[] = { 2, 0 };
+    uint32_t rec1[] = { 0, SSS_ID_TYPE_UID };
+    uint32_t rec2[] = { 2, SSS_ID_TYPE_GID };
+    uint8_t repbuf[sizeof(hdr) + sizeof(rec1) + sizeof(TEST_SID_1000)
+                   + sizeof(rec2) + sizeof(TEST_SID_1002)];
+    struct sss_nss_make_request_test_data d = {repbuf, sizeof(repbuf), 0,
+                                               NSS_STATUS_SUCCESS};
+    size_t ofs = 0;
+    size_t c;
+
+    memcpy(repbuf + ofs, hdr, sizeof(hdr));
+    ofs += sizeof(hdr);
+    memcpy(repbuf + ofs, rec1, sizeof(rec1));
+    ofs += sizeof(rec1);
+    memcpy(repbuf + ofs, TEST_SID_1000, sizeof(TEST_SID_1000));
+    ofs += sizeof(TEST_SID_1000);
+    memcpy(repbuf + ofs, rec2, sizeof(rec2));
+    ofs += sizeof(rec2);
+    memcpy(repbuf + ofs, TEST_SID_1002, sizeof(TEST_SID_1002));
+
+    ret = sss_nss_getsidbyid_multi_timeout(NULL, NULL, 0, 0, &sids, &types);
+    assert_int_equal(ret, EINVAL);
+
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getsidbyid_multi_timeout(ids, id_types, 3, 0, &sids,
+                                           &types);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(sids[0], TEST_SID_1000);
+    assert_int_equal(types[0], SSS_ID_TYPE_UID);
+    assert_null(sids[1]);
+    assert_string_equal(sids[2], TEST_SID_1002);
+    assert_int_equal(types[2], SSS_ID_TYPE_GID);
+
+    for (c = 0; c < 3; c++) {
+        free(sids[c]);
+    }
+    free(sids);
+    free(types);
+
+    /* the index of the second record is not in the request */
+    rec2[0] = 3;
+    memcpy(repbuf + sizeof(hdr) + sizeof(rec1) + sizeof(TEST_SID_1000),
+           rec2, sizeof(rec2));
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getsidbyid_multi_timeout(ids, NULL, 3, 0, &sids, &types);
+    assert_int_equal(ret, EBADMSG);
+}
+
+void test_getidbysid_multi(void **state)
+{
+    int ret;
+    uint32_t *ids = NULL;
+    enum sss_id_type *types = NULL;
+    const char *sids[] = { TEST_SID_1000, TEST_SID_1002 };
+    const char *bad_sids[] = { TEST_SID_1000, "" };
+    uint32_t rep[] = { 1, 0, 1, SSS_ID_TYPE_GID, 1002 };
+    struct sss_nss_make_request_test_data d = {(uint8_t *) rep, sizeof(rep),
+                                               0, NSS_STATUS_SUCCESS};
+
+    ret = sss_nss_getidbysid_multi_timeout(bad_sids, 2, 0, &ids, &types);
+    assert_int_equal(ret, EINVAL);
+
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getidbysid_multi_timeout(sids, 2, 0, &ids, &types);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(types[0], SSS_ID_TYPE_NOT_SPECIFIED);
+    assert_int_equal(ids[1], 1002);
+    assert_int_equal(types[1], SSS_ID_TYPE_GID);
+    free(ids);
+    free(types);
+
+    /* the ID is missing */
+    d.replen = sizeof(rep) - sizeof(uint32_t);
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getidbysid_multi_timeout(sids, 2, 0, &ids, &types);
+    assert_int_equal(ret, EBADMSG);
+}
+
+#define TEST_NAME_1000 "user1000@test"
+
+void test_getsidbyname_multi(void **state)
+{
+    int ret;
+    char **sids = NULL;
+    enum sss_id_type *types = NULL;
+    const char *names[] = { TEST_NAME_1000, "missing@test" };
+    const char *bad_names[] = { TEST_NAME_1000, NULL };
+    uint32_t hdr[] = { 1, 0 };
+    uint32_t rec[] = { 0, SSS_ID_TYPE_UID };
+    uint8_t repbuf[sizeof(hdr) + sizeof(rec) + sizeof(TEST_SID_1000)];
+    struct sss_nss_make_request_test_data d = {repbuf, sizeof(repbuf), 0,
+                                               NSS_STATUS_SUCCESS};
+
+    memcpy(repbuf, hdr, sizeof(hdr));
+    memcpy(repbuf + sizeof(hdr), rec, sizeof(rec));
+    memcpy(repbuf + sizeof(hdr) + sizeof(rec), TEST_SID_1000,
+           sizeof(TEST_SID_1000));
+
+    ret = sss_nss_getsidbyname_multi_timeout(bad_names, 2, 0, &sids, &types);
+    assert_int_equal(ret, EINVAL);
+
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getsidbyname_multi_timeout(names, 2, 0, &sids, &types);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(sids[0], TEST_SID_1000);
+    assert_int_equal(types[0], SSS_ID_TYPE_UID);
+    assert_null(sids[1]);
+    free(sids[0]);
+    free(sids);
+    free(types);
+
+    /* the SID is not terminated */
+    d.replen = sizeof(repbuf) - 1;
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getsidbyname_multi_timeout(names, 2, 0, &sids, &types);
+    assert_int_equal(ret, EBADMSG);
+}
+
+void test_getnamebysid_multi(void **state)
+{
+    int ret;
+    char **names = NULL;
+    enum sss_id_type *types = NULL;
+    const char *sids[] = { TEST_SID_1000, TEST_SID_1002 };
+    uint32_t hdr[] = { 1, 0 };
+    uint32_t rec[] = { 1, SSS_ID_TYPE_GID };
+    uint8_t repbuf[sizeof(hdr) + sizeof(rec) + sizeof(TEST_NAME_1000)];
+    struct sss_nss_make_request_test_data d = {repbuf, sizeof(repbuf), 0,
+                                               NSS_STATUS_SUCCESS};
+
+    memcpy(repbuf, hdr, sizeof(hdr));
+    memcpy(repbuf + sizeof(hdr), rec, sizeof(rec));
+    memcpy(repbuf + sizeof(hdr) + sizeof(rec), TEST_NAME_1000,
+           sizeof(TEST_NAME_1000));
+
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getnamebysid_multi_timeout(sids, 2, 0, &names, &types);
+    assert_int_equal(ret, EOK);
+    assert_null(names[0]);
+    assert_string_equal(names[1], TEST_NAME_1000);
+    assert_int_equal(types[1], SSS_ID_TYPE_GID);
+    free(names[1]);
+    free(names);
+    free(types);
+}
+
+void test_getpwnam_async_loops(void **state)
+{
+    int ret;
+    int fd;
+    short events;
+    struct passwd pwd;
+    char buffer[1024];
+    struct sss_nss_async_req *req = NULL;
+
+    ret = sss_nss_getpwnam_send(NULL, &pwd, buffer, sizeof(buffer), 0, &req);
+    assert_int_equal(ret, EINVAL);
+    assert_null(req);
+
+    /* the lookup finishes right away if the daemon itself calls us */
+    setenv("_SSS_LOOPS", "NO", 1);
+    setenv("SSS_NSS_USE_MEMCACHE", "NO", 1);
+
+    ret = sss_nss_getpwnam_send("test", &pwd, buffer, sizeof(buffer), 0,
+                                &req);
+    assert_int_equal(ret, EOK);
+    assert_non_null(req);
+
+    fd = sss_nss_async_get_fd(req, &events);
+    assert_int_equal(fd, -1);
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EOK);
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, ENOENT);
+
+    unsetenv("_SSS_LOOPS");
+    unsetenv("SSS_NSS_USE_MEMCACHE");
+}
+
+void test_getpwnam_async_mc(void **state)
+{
+    int ret;
+    int fd;
+    short events;
+    struct passwd pwd;
+    struct passwd mc_pwd = { .pw_name = discard_const("test"),
+                             .pw_uid = 1000, .pw_gid = 1001 };
+    char buffer[1024];
+    struct sss_nss_async_req *req = NULL;
+
+    /* A hit in the memory cache finishes the lookup without opening a
+     * connection, __wrap_sss_cli_open_socket_nb() has no values to
+     * return */
+    test_mc_pwd = &mc_pwd;
+
+    ret = sss_nss_getpwnam_send("test", &pwd, buffer, sizeof(buffer), 0,
+                                &req);
+    assert_int_equal(ret, EOK);
+
+    fd = sss_nss_async_get_fd(req, &events);
+    assert_int_equal(fd, -1);
+    assert_int_equal(events, 0);
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(pwd.pw_name, "test");
+    assert_int_equal(pwd.pw_uid, 1000);
+    assert_int_equal(pwd.pw_gid, 1001);
+
+    /* so does a buffer which is too small for the cached entry */
+    ret = sss_nss_getpwnam_send("test", &pwd, buffer, 2, 0, &req);
+    assert_int_equal(ret, EOK);
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, ERANGE);
+
+    test_mc_pwd = NULL;
+}
+
+/* Starts a lookup of "test" which misses the memory cache, fds[1] is the
+ * responder end of the connection. */
+static struct sss_nss_async_req *test_async_start(int fds[2],
+                                                  struct passwd *pwd,
+                                                  char *buffer, size_t buflen)
+{
+    struct sss_nss_async_req *req = NULL;
+    int ret;
+
+    ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert_int_equal(ret, 0);
+    ret = fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    assert_int_equal(ret, 0);
+
+    will_return(__wrap_sss_cli_open_socket_nb, 0);
+    will_return(__wrap_sss_cli_open_socket_nb, fds[0]);
+
+    ret = sss_nss_getpwnam_send("test", pwd, buffer, buflen, 0, &req);
+    assert_int_equal(ret, EOK);
+    assert_non_null(req);
+
+    return req;
+}
+
+static void test_read_fd(int fd, void *buf, size_t len)
+{
+    ssize_t res;
+    size_t pos = 0;
+
+    while (pos < len) {
+        res = read(fd, (uint8_t *)buf + pos, len - pos);
+        assert_true(res > 0);
+        pos += res;
+    }
+}
+
+/* Reads a request and returns its tag */
+static uint32_t test_read_request(int fd, uint32_t cmd,
+                                  const void *body, size_t body_len)
+{
+    uint32_t header[4];
+    uint8_t data[64];
+
+    test_read_fd(fd, header, sizeof(header));
+    assert_int_equal(header[0], SSS_NSS_HEADER_SIZE + body_len);
+    assert_int_equal(header[1], cmd);
+    assert_int_equal(header[2], 0);
+    assert_int_not_equal(header[3], 0);
+
+    assert_true(body_len <= sizeof(data));
+    test_read_fd(fd, data, body_len);
+    assert_memory_equal(data, body, body_len);
+
+    return header[3];
+}
+
+static void test_write_reply(int fd, uint32_t cmd, uint32_t tag,
+                             const void *body, size_t body_len)
+{
+    uint32_t header[4];
+    ssize_t res;
+
+    header[0] = SSS_NSS_HEADER_SIZE + body_len;
+    header[1] = cmd;
+    header[2] = 0;
+    header[3] = tag;
+
+    res = write(fd, header, sizeof(header));
+    assert_int_equal(res, sizeof(header));
+    res = write(fd, body, body_len);
+    assert_int_equal(res, body_len);
+}
+
+static const uint8_t test_pwnam_req[] = { 't', 'e', 's', 't', 0x00,
+                                          0x00, 0x00, 0x00, 0x00 };
+
+void test_getpwnam_async_lookup(void **state)
+{
+    int ret;
+    int fd;
+    int fds[2];
+    short events;
+    struct passwd pwd;
+    char buffer[1024];
+    struct sss_nss_async_req *req;
+    uint32_t version = SSS_NSS_PROTOCOL_VERSION;
+    uint32_t version_tag;
+    uint32_t tag;
+    uint32_t header[4];
+    uint32_t pw_hdr[] = { 1, 0, 1000, 1001 };
+    const char strs[] = "test\0x\0Test User\0/home/test\0/bin/sh";
+    uint8_t repbuf[sizeof(pw_hdr) + sizeof(strs)];
+    ssize_t res;
+    char c;
+
+    memcpy(repbuf, pw_hdr, sizeof(pw_hdr));
+    memcpy(repbuf + sizeof(pw_hdr), strs, sizeof(strs));
+
+    setenv("SSS_NSS_USE_MEMCACHE", "NO", 1);
+
+    req = test_async_start(fds, &pwd, buffer, sizeof(buffer));
+
+    /* The version check and the lookup were sent at once, the lookup now
+     * waits for the replies */
+    fd = sss_nss_async_get_fd(req, &events);
+    assert_int_equal(fd, fds[0]);
+    assert_int_equal(events, POLLIN);
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EAGAIN);
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, EAGAIN);
+
+    version_tag = test_read_request(fds[1], SSS_GET_VERSION,
+                                    &version, sizeof(version));
+    tag = test_read_request(fds[1], SSS_NSS_GETPWNAM_EX,
+                            test_pwnam_req, sizeof(test_pwnam_req));
+    assert_int_not_equal(version_tag, tag);
+
+    /* A reply which arrives in pieces is assembled */
+    header[0] = SSS_NSS_HEADER_SIZE + sizeof(version);
+    header[1] = SSS_GET_VERSION;
+    header[2] = 0;
+    header[3] = version_tag;
+    res = write(fds[1], header, 6);
+    assert_int_equal(res, 6);
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EAGAIN);
+
+    res = write(fds[1], (uint8_t *)header + 6, sizeof(header) - 6);
+    assert_int_equal(res, sizeof(header) - 6);
+    res = write(fds[1], &version, sizeof(version));
+    assert_int_equal(res, sizeof(version));
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EAGAIN);
+
+    test_write_reply(fds[1], SSS_NSS_GETPWNAM_EX, tag,
+                     repbuf, sizeof(repbuf));
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EOK);
+
+    /* The connection is closed once the lookup is done */
+    fd = sss_nss_async_get_fd(req, &events);
+    assert_int_equal(fd, -1);
+    res = read(fds[1], &c, 1);
+    assert_int_equal(res, 0);
+
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(pwd.pw_name, "test");
+    assert_int_equal(pwd.pw_uid, 1000);
+    assert_int_equal(pwd.pw_gid, 1001);
+    assert_string_equal(pwd.pw_gecos, "Test User");
+    assert_string_equal(pwd.pw_dir, "/home/test");
+    assert_string_equal(pwd.pw_shell, "/bin/sh");
+
+    close(fds[1]);
+    unsetenv("SSS_NSS_USE_MEMCACHE");
+}
+
+void test_getpwnam_async_errors(void **state)
+{
+    int ret;
+    int fds[2];
+    struct passwd pwd;
+    char buffer[1024];
+    struct sss_nss_async_req *req;
+    uint32_t version = SSS_NSS_PROTOCOL_VERSION;
+    uint32_t version_tag;
+    uint32_t tag;
+    uint32_t empty[] = { 0, 0 };
+    ssize_t res;
+    char c;
+
+    setenv("SSS_NSS_USE_MEMCACHE", "NO", 1);
+
+    /* A reply to another request */
+    req = test_async_start(fds, &pwd, buffer, sizeof(buffer));
+    version_tag = test_read_request(fds[1], SSS_GET_VERSION,
+                                    &version, sizeof(version));
+    test_write_reply(fds[1], SSS_GET_VERSION, version_tag + 100,
+                     &version, sizeof(version));
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EOK);
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, EBADMSG);
+    close(fds[1]);
+
+    /* The user does not exist */
+    req = test_async_start(fds, &pwd, buffer, sizeof(buffer));
+    version_tag = test_read_request(fds[1], SSS_GET_VERSION,
+                                    &version, sizeof(version));
+    tag = test_read_request(fds[1], SSS_NSS_GETPWNAM_EX,
+                            test_pwnam_req, sizeof(test_pwnam_req));
+    test_write_reply(fds[1], SSS_GET_VERSION, version_tag,
+                     &version, sizeof(version));
+    test_write_reply(fds[1], SSS_NSS_GETPWNAM_EX, tag, empty, sizeof(empty));
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EOK);
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, ENOENT);
+    close(fds[1]);
+
+    /* The responder closed the connection */
+    req = test_async_start(fds, &pwd, buffer, sizeof(buffer));
+    test_read_request(fds[1], SSS_GET_VERSION, &version, sizeof(version));
+    test_read_request(fds[1], SSS_NSS_GETPWNAM_EX,
+                      test_pwnam_req, sizeof(test_pwnam_req));
+    close(fds[1]);
+    ret = sss_nss_async_process(req);
+    assert_int_equal(ret, EOK);
+    ret = sss_nss_async_recv(req);
+    assert_int_equal(ret, EPIPE);
+
+    /* A cancelled lookup closes its connection */
+    req = test_async_start(fds, &pwd, buffer, sizeof(buffer));
+    test_read_request(fds[1], SSS_GET_VERSION, &version, sizeof(version));
+    test_read_request(fds[1], SSS_NSS_GETPWNAM_EX,
+                      test_pwnam_req, sizeof(test_pwnam_req));
+    sss_nss_async_free(req);
+    res = read(fds[1], &c, 1);
+    assert_int_equal(res, 0);
+    close(fds[1]);
+
+    unsetenv("SSS_NSS_USE_MEMCACHE");
+}
+
+void test_getpwnam_grouplist(void **state)
+{
+    int ret;
+    struct passwd pwd;
+    struct passwd *result;
+    char buffer[1024];
+    gid_t groups[3];
+    int ngroups;
+    uint32_t pw_hdr[] = { 0, 1, 0, 1000, 1000 };
+    const char strs[] = "test\0x\0Test User\0/home/test\0/bin/sh";
+    uint32_t gr[] = { 2, 0, 2000, 2001 };
+    uint8_t repbuf[sizeof(pw_hdr) + sizeof(strs) + sizeof(gr)];
+    struct sss_nss_make_request_test_data d = {repbuf, sizeof(repbuf), 0,
+                                               NSS_STATUS_SUCCESS};
+    uint32_t empty[] = { 0, 0 };
+    struct sss_nss_make_request_test_data d_empty = {(uint8_t *) empty,
+                                                     sizeof(empty), 0,
+                                                     NSS_STATUS_SUCCESS};
+
+    pw_hdr[0] = sizeof(pw_hdr) - sizeof(uint32_t) + sizeof(strs);
+    memcpy(repbuf, pw_hdr, sizeof(pw_hdr));
+    memcpy(repbuf + sizeof(pw_hdr), strs, sizeof(strs));
+    memcpy(repbuf + sizeof(pw_hdr) + sizeof(strs), gr, sizeof(gr));
+
+    setenv("SSS_NSS_USE_MEMCACHE", "NO", 1);
+
+    ngroups = 3;
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getpwnam_grouplist_timeout("test", &pwd, buffer,
+                                             sizeof(buffer), &result,
+                                             groups, &ngroups, 0, 0);
+    assert_int_equal(ret, EOK);
+    assert_ptr_equal(result, &pwd);
+    assert_string_equal(pwd.pw_name, "test");
+    assert_int_equal(pwd.pw_uid, 1000);
+    assert_string_equal(pwd.pw_dir, "/home/test");
+    assert_int_equal(ngroups, 3);
+    assert_int_equal(groups[0], 1000);
+    assert_int_equal(groups[1], 2000);
+    assert_int_equal(groups[2], 2001);
+
+    /* the user is returned even if the groups do not fit */
+    ngroups = 2;
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getpwnam_grouplist_timeout("test", &pwd, buffer,
+                                             sizeof(buffer), &result,
+                                             groups, &ngroups, 0, 0);
+    assert_int_equal(ret, ERANGE);
+    assert_ptr_equal(result, &pwd);
+    assert_int_equal(ngroups, 3);
+
+    will_return(__wrap_sss_nss_make_request_timeout, &d_empty);
+    ret = sss_nss_getpwnam_grouplist_timeout("test", &pwd, buffer,
+                                             sizeof(buffer), &result,
+                                             groups, &ngroups, 0, 0);
+    assert_int_equal(ret, ENOENT);
+    assert_null(result);
+
+    /* the user entry is longer than the reply */
+    d.replen = sizeof(pw_hdr) + 4;
+    will_return(__wrap_sss_nss_make_request_timeout, &d);
+    ret = sss_nss_getpwnam_grouplist_timeout("test", &pwd, buffer,
+                                             sizeof(buffer), &result,
+                                             groups, &ngroups, 0, 0);
+    assert_int_equal(ret, EBADMSG);
+
+    unsetenv("SSS_NSS_USE_MEMCACHE");
+}
+
 int main(int argc, const char *argv[])
 {
 
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_getsidbyname),
         cmocka_unit_test(test_getorigbyname),
+        cmocka_unit_test(test_getnamebyuid_multi),
+        cmocka_unit_test(test_getsidbyid_multi),
+        cmocka_unit_test(test_getidbysid_multi),
+        cmocka_unit_test(test_getsidbyname_multi),
+        cmocka_unit_test(test_getnamebysid_multi),
+        cmocka_unit_test(test_getpwnam_async_loops),
+        cmocka_unit_test(test_getpwnam_async_mc),
+        cmocka_unit_test(test_getpwnam_async_lookup),
+        cmocka_unit_test(test_getpwnam_async_errors),
+        cmocka_unit_test(test_getpwnam_grouplist),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
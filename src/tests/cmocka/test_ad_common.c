@@ -463,6 +463,90 @@ static void test_ad_get_pac_data_from_user_entry(void **state)
     sss_idmap_free(idmap_ctx);
 }
 
+static void test_ad_get_cached_pac_data(void **state)
+{
+    int ret;
+    struct ldb_message *user_msg;
+    struct ldb_val val;
+    struct ad_common_test_ctx *test_ctx = talloc_get_type(*state,
+                                                  struct ad_common_test_ctx);
+    struct tevent_context *ev;
+    struct ad_options *ad_options;
+    struct sss_idmap_ctx *idmap_ctx;
+    enum idmap_error_code err;
+    TALLOC_CTX *req_ctx;
+    char *username;
+    size_t num_sids;
+    char **sid_list;
+    char **first_sid_list;
+    char *stolen_sid;
+    char *first_sid;
+    bool parsed;
+
+    ev = tevent_context_init(test_ctx);
+    assert_non_null(ev);
+
+    ad_options = talloc_zero(test_ctx, struct ad_options);
+    assert_non_null(ad_options);
+
+    err = sss_idmap_init(sss_idmap_talloc, test_ctx, sss_idmap_talloc_free,
+                         &idmap_ctx);
+    assert_int_equal(err, IDMAP_SUCCESS);
+
+    user_msg = ldb_msg_new(test_ctx);
+    assert_non_null(user_msg);
+    user_msg->dn = ldb_dn_new(user_msg, NULL, "name=username,cn=users");
+    assert_non_null(user_msg->dn);
+
+    ret = ldb_msg_add_string(user_msg, SYSDB_NAME, "username");
+    assert_int_equal(ret, EOK);
+    ret = ldb_msg_add_fmt(user_msg, SYSDB_PAC_BLOB_EXPIRE, "%llu",
+                          (unsigned long long) time(NULL) + 60);
+    assert_int_equal(ret, EOK);
+    val.data = sss_base64_decode(test_ctx, TEST_PAC_BASE64, &val.length);
+    ret = ldb_msg_add_value(user_msg, SYSDB_PAC_BLOB, &val, NULL);
+    assert_int_equal(ret, EOK);
+
+    /* The first lookup parses the PAC */
+    req_ctx = talloc_new(test_ctx);
+    assert_non_null(req_ctx);
+    ret = ad_get_cached_pac_data(req_ctx, ev, ad_options, user_msg, idmap_ctx,
+                                 &username, &num_sids, &sid_list, &parsed);
+    assert_int_equal(ret, EOK);
+    assert_true(parsed);
+    assert_string_equal(username, "username");
+    assert_int_equal(num_sids, 6);
+    first_sid_list = sid_list;
+    first_sid = talloc_strdup(test_ctx, sid_list[0]);
+    assert_non_null(first_sid);
+
+    /* Do to the result what the tokengroups code does to it */
+    stolen_sid = talloc_steal(test_ctx, sid_list[0]);
+    talloc_free(req_ctx);
+    talloc_free(stolen_sid);
+
+    /* The second lookup uses the cache and must not be affected */
+    req_ctx = talloc_new(test_ctx);
+    assert_non_null(req_ctx);
+    ret = ad_get_cached_pac_data(req_ctx, ev, ad_options, user_msg, idmap_ctx,
+                                 &username, &num_sids, &sid_list, &parsed);
+    assert_int_equal(ret, EOK);
+    assert_false(parsed);
+    assert_string_equal(username, "username");
+    assert_int_equal(num_sids, 6);
+    assert_true(sid_list != first_sid_list);
+    assert_string_equal(sid_list[0], first_sid);
+    assert_null(sid_list[num_sids]);
+    talloc_free(req_ctx);
+
+    talloc_free(first_sid);
+    talloc_free(val.data);
+    talloc_free(user_msg);
+    talloc_free(ad_options);
+    sss_idmap_free(idmap_ctx);
+    talloc_free(ev);
+}
+
 krb5_error_code __wrap_krb5_kt_default(krb5_context context, krb5_keytab *id)
 {
     return krb5_kt_resolve(context, KEYTAB_PATH, id);
@@ -1007,6 +1091,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_ad_get_pac_data_from_user_entry,
                                         test_ad_common_setup,
                                         test_ad_common_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_get_cached_pac_data,
+                                        test_ad_common_setup,
+                                        test_ad_common_teardown),
         cmocka_unit_test_setup_teardown(test_netlogon_get_domain_info,
                                         test_ad_common_setup,
                                         test_ad_common_teardown),
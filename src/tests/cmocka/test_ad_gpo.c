@@ -401,6 +401,78 @@ void test_ad_gpo_parse_sd(void **state)
     talloc_free(sd);
 }
 
+#define TEST_GPO_GUID "{31B2F340-016D-11D2-945F-00C04FB984F9}"
+#define TEST_POLICY_FILE "test_ad_gpo_GptTmpl.inf"
+
+static void write_policy_file(const char *content)
+{
+    FILE *f;
+
+    f = fopen(TEST_POLICY_FILE, "w");
+    assert_non_null(f);
+    assert_true(fputs(content, f) >= 0);
+    assert_int_equal(fclose(f), 0);
+}
+
+void test_ad_gpo_get_policy_settings(void **state)
+{
+    struct ad_access_ctx *access_ctx;
+    struct ad_gpo_policy *policy;
+    struct ad_gpo_policy *cached;
+    errno_t ret;
+
+    access_ctx = talloc_zero(test_ctx, struct ad_access_ctx);
+    assert_non_null(access_ctx);
+
+    write_policy_file("[Unicode]\n"
+                      "Unicode=yes\n"
+                      "[Privilege Rights]\n"
+                      "SeRemoteInteractiveLogonRight = *S-1-5-32-544\n"
+                      "SeDenyRemoteInteractiveLogonRight =\n"
+                      "[Version]\n"
+                      "Revision=1\n");
+
+    ret = ad_gpo_get_policy_settings(access_ctx, TEST_GPO_GUID, 1,
+                                     TEST_POLICY_FILE, &policy);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(policy->gpt_version, 1);
+    assert_int_equal(policy->num_settings, 2);
+    assert_string_equal(policy->keys[0], ALLOW_LOGON_REMOTE_INTERACTIVE);
+    assert_string_equal(policy->values[0], "*S-1-5-32-544");
+    assert_string_equal(policy->keys[1], DENY_LOGON_REMOTE_INTERACTIVE);
+    assert_string_equal(policy->values[1], "NO_SID");
+
+    /* The same version is not read from the file again. */
+    unlink(TEST_POLICY_FILE);
+    ret = ad_gpo_get_policy_settings(access_ctx, TEST_GPO_GUID, 1,
+                                     TEST_POLICY_FILE, &cached);
+    assert_int_equal(ret, EOK);
+    assert_ptr_equal(cached, policy);
+
+    /* A new version is. */
+    ret = ad_gpo_get_policy_settings(access_ctx, TEST_GPO_GUID, 2,
+                                     TEST_POLICY_FILE, &cached);
+    assert_int_not_equal(ret, EOK);
+
+    write_policy_file("[Privilege Rights]\n"
+                      "SeInteractiveLogonRight = *S-1-5-32-545\n");
+
+    ret = ad_gpo_get_policy_settings(access_ctx, TEST_GPO_GUID, 2,
+                                     TEST_POLICY_FILE, &policy);
+    unlink(TEST_POLICY_FILE);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(policy->gpt_version, 2);
+    assert_int_equal(policy->num_settings, 1);
+    assert_string_equal(policy->keys[0], ALLOW_LOGON_INTERACTIVE);
+    assert_string_equal(policy->values[0], "*S-1-5-32-545");
+
+    /* The old version was replaced. */
+    assert_ptr_equal(access_ctx->gpo_policies, policy);
+    assert_null(policy->next);
+
+    talloc_free(access_ctx);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -442,6 +514,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_ad_gpo_parse_sd,
                                         ad_gpo_test_setup,
                                         ad_gpo_test_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_gpo_get_policy_settings,
+                                        ad_gpo_test_setup,
+                                        ad_gpo_test_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -0,0 +1,410 @@
+/*
+    SSSD
+
+    Unit tests for the cache of the AD site and DC discovery
+
+    Copyright (C) 2026 Red Hat
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <talloc.h>
+#include <tevent.h>
+#include <errno.h>
+#include <popt.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "providers/backend.h"
+
+#include "providers/ad/ad_srv.c"
+
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB "test_ad_srv_conf.ldb"
+#define TEST_DOM_NAME "ad_srv_test"
+#define TEST_ID_PROVIDER "ad"
+
+#define TEST_AD_DOMAIN "ad.example.com"
+#define TEST_SITE "Default-First-Site-Name"
+#define TEST_FOREST "example.com"
+#define TEST_TTL 600
+#define TEST_CACHE_TIMEOUT 3600
+
+struct ad_srv_test_ctx {
+    struct sss_test_ctx *tctx;
+    struct ad_srv_plugin_ctx *srv_ctx;
+    const char *key;
+};
+
+static struct fo_server_info test_primary[] = {
+    { "dc1.ad.example.com", 389, 0 },
+    { "dc2.ad.example.com", 3268, 10 },
+};
+
+static struct fo_server_info test_backup[] = {
+    { "dc3.ad.example.com", 389, 0 },
+};
+
+static int test_ad_srv_setup(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct be_ctx *be_ctx;
+
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context, struct ad_srv_test_ctx);
+    assert_non_null(test_ctx);
+
+    test_dom_suite_setup(TESTS_PATH);
+
+    test_ctx->tctx = create_dom_test_ctx(test_ctx, TESTS_PATH, TEST_CONF_DB,
+                                         TEST_DOM_NAME, TEST_ID_PROVIDER,
+                                         NULL);
+    assert_non_null(test_ctx->tctx);
+
+    be_ctx = talloc_zero(test_ctx, struct be_ctx);
+    assert_non_null(be_ctx);
+    be_ctx->ev = test_ctx->tctx->ev;
+    be_ctx->domain = test_ctx->tctx->dom;
+
+    /* ad_srv_plugin_ctx_init() would register the offline callback, the
+     * tests call ad_srv_mark_renew_site() themselves. */
+    test_ctx->srv_ctx = talloc_zero(test_ctx, struct ad_srv_plugin_ctx);
+    assert_non_null(test_ctx->srv_ctx);
+    test_ctx->srv_ctx->be_ctx = be_ctx;
+    test_ctx->srv_ctx->ad_domain = TEST_AD_DOMAIN;
+    test_ctx->srv_ctx->cache_timeout = TEST_CACHE_TIMEOUT;
+    test_ctx->srv_ctx->use_cache = true;
+
+    test_ctx->key = ad_srv_cache_key(test_ctx, "ldap", "tcp", TEST_AD_DOMAIN);
+    assert_non_null(test_ctx->key);
+
+    *state = test_ctx;
+    return 0;
+}
+
+static int test_ad_srv_teardown(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    /* frees the validation timer as well */
+    talloc_free(test_ctx);
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    assert_true(leak_check_teardown());
+    return 0;
+}
+
+static void test_store(struct ad_srv_test_ctx *test_ctx,
+                       const char *site,
+                       size_t num_backup)
+{
+    errno_t ret;
+
+    ret = ad_srv_cache_store(test_ctx->srv_ctx, test_ctx->key, site,
+                             TEST_FOREST, TEST_AD_DOMAIN, TEST_TTL,
+                             test_primary, N_ELEMENTS(test_primary),
+                             test_backup, num_backup);
+    assert_int_equal(ret, EOK);
+}
+
+static errno_t test_lookup(struct ad_srv_test_ctx *test_ctx,
+                           struct ad_srv_plugin_state **_state)
+{
+    struct ad_srv_plugin_state *state;
+
+    state = talloc_zero(test_ctx, struct ad_srv_plugin_state);
+    assert_non_null(state);
+    state->ctx = test_ctx->srv_ctx;
+    state->cache_key = test_ctx->key;
+
+    *_state = state;
+    return ad_srv_cache_lookup(state);
+}
+
+static void assert_servers(struct fo_server_info *servers, size_t num_servers,
+                           struct fo_server_info *exp, size_t num_exp)
+{
+    size_t i;
+
+    assert_int_equal(num_servers, num_exp);
+    for (i = 0; i < num_exp; i++) {
+        assert_string_equal(servers[i].host, exp[i].host);
+        assert_int_equal(servers[i].port, exp[i].port);
+        assert_int_equal(servers[i].priority, exp[i].priority);
+    }
+}
+
+static void test_ad_srv_done(struct tevent_req *req)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct fo_server_info *primary;
+    struct fo_server_info *backup;
+    size_t num_primary;
+    size_t num_backup;
+    char *dns_domain;
+    uint32_t ttl;
+    errno_t ret;
+
+    test_ctx = tevent_req_callback_data(req, struct ad_srv_test_ctx);
+
+    ret = ad_srv_plugin_recv(test_ctx, req, &dns_domain, &ttl,
+                             &primary, &num_primary, &backup, &num_backup);
+    talloc_zfree(req);
+    assert_int_equal(ret, EOK);
+
+    assert_string_equal(dns_domain, TEST_AD_DOMAIN);
+    assert_int_equal(ttl, TEST_TTL);
+    assert_servers(primary, num_primary,
+                   test_primary, N_ELEMENTS(test_primary));
+    assert_servers(backup, num_backup, test_backup, N_ELEMENTS(test_backup));
+
+    talloc_free(dns_domain);
+    talloc_free(primary);
+    talloc_free(backup);
+
+    test_ev_done(test_ctx->tctx, EOK);
+}
+
+static void test_ad_srv_cache_served_once(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct ad_srv_plugin_state *lookup;
+    struct tevent_req *req;
+    const char *site;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    test_store(test_ctx, TEST_SITE, N_ELEMENTS(test_backup));
+
+    /* The stored servers are returned without any discovery */
+    req = ad_srv_plugin_send(test_ctx, test_ctx->tctx->ev, "ldap", "tcp",
+                             NULL, test_ctx->srv_ctx);
+    assert_non_null(req);
+    tevent_req_set_callback(req, test_ad_srv_done, test_ctx);
+
+    ret = test_ev_loop(test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    /* and so is the site they belong to */
+    assert_string_equal(test_ctx->srv_ctx->current_site, TEST_SITE);
+    assert_string_equal(test_ctx->srv_ctx->current_forest, TEST_FOREST);
+
+    ret = sysdb_get_site(test_ctx, test_ctx->tctx->dom, &site);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(site, TEST_SITE);
+    talloc_free(discard_const(site));
+
+    /* The next lookup of the same query has to do the discovery */
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, ENOENT);
+    talloc_free(lookup);
+}
+
+static void test_ad_srv_cache_replace(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct ad_srv_plugin_state *lookup;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    test_store(test_ctx, TEST_SITE, N_ELEMENTS(test_backup));
+
+    /* A new discovery result does not keep the old backup servers */
+    test_store(test_ctx, TEST_SITE, 0);
+
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, EOK);
+    assert_servers(lookup->primary_servers, lookup->num_primary_servers,
+                   test_primary, N_ELEMENTS(test_primary));
+    assert_int_equal(lookup->num_backup_servers, 0);
+    assert_string_equal(lookup->site, TEST_SITE);
+    assert_string_equal(lookup->forest, TEST_FOREST);
+    talloc_free(lookup);
+}
+
+static void test_ad_srv_cache_missing(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct ad_srv_plugin_state *lookup;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, ENOENT);
+    assert_null(test_ctx->srv_ctx->current_site);
+    talloc_free(lookup);
+}
+
+static void test_ad_srv_cache_expired(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct ad_srv_plugin_state *lookup;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    test_ctx->srv_ctx->cache_timeout = -10;
+    test_store(test_ctx, TEST_SITE, N_ELEMENTS(test_backup));
+
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, ENOENT);
+    assert_null(test_ctx->srv_ctx->current_site);
+    talloc_free(lookup);
+}
+
+static void test_ad_srv_cache_site_override(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct ad_srv_plugin_state *lookup;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    test_store(test_ctx, TEST_SITE, N_ELEMENTS(test_backup));
+
+    /* Servers of another site than the configured one are not used */
+    test_ctx->srv_ctx->ad_site_override = "Other-Site";
+
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, ENOENT);
+    assert_null(test_ctx->srv_ctx->current_site);
+    talloc_free(lookup);
+}
+
+static void test_ad_srv_cache_offline(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct ad_srv_plugin_state *lookup;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    test_store(test_ctx, TEST_SITE, N_ELEMENTS(test_backup));
+
+    /* Going offline stops using the cache, the cached servers might be
+     * the reason */
+    ad_srv_mark_renew_site(test_ctx->srv_ctx);
+    assert_true(test_ctx->srv_ctx->renew_site);
+    assert_false(test_ctx->srv_ctx->use_cache);
+
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, ENOENT);
+    talloc_free(lookup);
+
+    /* The entry is still there for the next start */
+    test_ctx->srv_ctx->use_cache = true;
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, EOK);
+    talloc_free(lookup);
+}
+
+static void test_ad_srv_cache_malformed(void **state)
+{
+    struct ad_srv_test_ctx *test_ctx;
+    struct ad_srv_plugin_state *lookup;
+    struct sysdb_attrs *attrs;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ad_srv_test_ctx);
+
+    attrs = sysdb_new_attrs(test_ctx);
+    assert_non_null(attrs);
+    ret = sysdb_attrs_add_string(attrs, AD_SRV_CACHE_DNS_DOMAIN,
+                                 TEST_AD_DOMAIN);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_CACHE_EXPIRE,
+                                 time(NULL) + TEST_CACHE_TIMEOUT);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_string(attrs, AD_SRV_CACHE_PRIMARY, "389 dc1");
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_custom(test_ctx->tctx->dom, test_ctx->key,
+                             AD_SRV_CACHE_SUBDIR, attrs);
+    assert_int_equal(ret, EOK);
+    talloc_free(attrs);
+
+    ret = test_lookup(test_ctx, &lookup);
+    assert_int_equal(ret, EINVAL);
+    assert_null(lookup->primary_servers);
+    talloc_free(lookup);
+}
+
+int main(int argc, const char *argv[])
+{
+    int rv;
+    int no_cleanup = 0;
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        {"no-cleanup", 'n', POPT_ARG_NONE, &no_cleanup, 0,
+         _("Do not delete the test database after a test run"), NULL },
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_ad_srv_cache_served_once,
+                                        test_ad_srv_setup,
+                                        test_ad_srv_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_srv_cache_replace,
+                                        test_ad_srv_setup,
+                                        test_ad_srv_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_srv_cache_missing,
+                                        test_ad_srv_setup,
+                                        test_ad_srv_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_srv_cache_expired,
+                                        test_ad_srv_setup,
+                                        test_ad_srv_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_srv_cache_site_override,
+                                        test_ad_srv_setup,
+                                        test_ad_srv_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_srv_cache_offline,
+                                        test_ad_srv_setup,
+                                        test_ad_srv_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_srv_cache_malformed,
+                                        test_ad_srv_setup,
+                                        test_ad_srv_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    tests_set_cwd();
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    rv = cmocka_run_group_tests(tests, NULL, NULL);
+
+    if (rv == 0 && no_cleanup == 0) {
+        test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    }
+    return rv;
+}
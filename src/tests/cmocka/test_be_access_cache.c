@@ -0,0 +1,221 @@
+/*
+    SSSD
+
+    test_be_access_cache - Tests of the cache of access decisions
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <popt.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "db/sysdb.h"
+#include "providers/be_access_cache.h"
+
+#define TEST_USER "testuser@testdomain"
+#define TEST_RULES "(memberOf=cn=admins,dc=example,dc=com)"
+
+struct be_access_cache_test_ctx {
+    struct be_access_cache *cache;
+    struct ldb_message *user_entry;
+};
+
+static int be_access_cache_test_setup(void **state)
+{
+    struct be_access_cache_test_ctx *test_ctx;
+    errno_t ret;
+
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context,
+                           struct be_access_cache_test_ctx);
+    assert_non_null(test_ctx);
+
+    test_ctx->user_entry = ldb_msg_new(test_ctx);
+    assert_non_null(test_ctx->user_entry);
+
+    ret = ldb_msg_add_string(test_ctx->user_entry, SYSDB_ORIG_MODSTAMP,
+                             "20200101000000Z");
+    assert_int_equal(ret, LDB_SUCCESS);
+
+    ret = ldb_msg_add_string(test_ctx->user_entry, SYSDB_MEMBEROF,
+                             "name=group1@testdomain,cn=groups,"
+                             "cn=testdomain,cn=sysdb");
+    assert_int_equal(ret, LDB_SUCCESS);
+
+    check_leaks_push(test_ctx);
+
+    ret = be_access_cache_init(test_ctx, 100, &test_ctx->cache);
+    assert_int_equal(ret, EOK);
+    assert_non_null(test_ctx->cache);
+
+    *state = test_ctx;
+    return 0;
+}
+
+static int be_access_cache_test_teardown(void **state)
+{
+    struct be_access_cache_test_ctx *test_ctx;
+
+    test_ctx = talloc_get_type_abort(*state, struct be_access_cache_test_ctx);
+
+    talloc_free(test_ctx->cache);
+    assert_true(check_leaks_pop(test_ctx));
+    talloc_free(test_ctx);
+    assert_true(leak_check_teardown());
+    return 0;
+}
+
+static void test_be_access_cache_hit(void **state)
+{
+    struct be_access_cache_test_ctx *test_ctx;
+    uint32_t user_state;
+    bool allowed;
+    bool refresh;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct be_access_cache_test_ctx);
+    user_state = be_access_cache_user_state(test_ctx->user_entry, TEST_RULES);
+
+    ret = be_access_cache_check(test_ctx->cache, TEST_USER, user_state,
+                                &allowed, &refresh);
+    assert_int_equal(ret, ENOENT);
+
+    ret = be_access_cache_add(test_ctx->cache, TEST_USER, user_state, true);
+    assert_int_equal(ret, EOK);
+
+    ret = be_access_cache_check(test_ctx->cache, TEST_USER, user_state,
+                                &allowed, &refresh);
+    assert_int_equal(ret, EOK);
+    assert_true(allowed);
+    assert_false(refresh);
+
+    /* the previous decision is replaced */
+    ret = be_access_cache_add(test_ctx->cache, TEST_USER, user_state, false);
+    assert_int_equal(ret, EOK);
+
+    ret = be_access_cache_check(test_ctx->cache, TEST_USER, user_state,
+                                &allowed, &refresh);
+    assert_int_equal(ret, EOK);
+    assert_false(allowed);
+
+    ret = be_access_cache_check(test_ctx->cache, "otheruser@testdomain",
+                                user_state, &allowed, &refresh);
+    assert_int_equal(ret, ENOENT);
+}
+
+static void test_be_access_cache_changed(void **state)
+{
+    struct be_access_cache_test_ctx *test_ctx;
+    uint32_t user_state;
+    uint32_t new_state;
+    bool allowed;
+    bool refresh;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct be_access_cache_test_ctx);
+    user_state = be_access_cache_user_state(test_ctx->user_entry, TEST_RULES);
+
+    /* other rules */
+    new_state = be_access_cache_user_state(test_ctx->user_entry,
+                                           "(uid=testuser)");
+    assert_int_not_equal(user_state, new_state);
+
+    ret = be_access_cache_add(test_ctx->cache, TEST_USER, user_state, true);
+    assert_int_equal(ret, EOK);
+
+    /* a decision for another state is removed */
+    ret = be_access_cache_check(test_ctx->cache, TEST_USER, new_state,
+                                &allowed, &refresh);
+    assert_int_equal(ret, ENOENT);
+    ret = be_access_cache_check(test_ctx->cache, TEST_USER, user_state,
+                                &allowed, &refresh);
+    assert_int_equal(ret, ENOENT);
+
+    /* a new group membership */
+    ret = ldb_msg_add_string(test_ctx->user_entry, SYSDB_MEMBEROF,
+                             "name=group2@testdomain,cn=groups,"
+                             "cn=testdomain,cn=sysdb");
+    assert_int_equal(ret, LDB_SUCCESS);
+    new_state = be_access_cache_user_state(test_ctx->user_entry, TEST_RULES);
+    assert_int_not_equal(user_state, new_state);
+    ldb_msg_remove_attr(test_ctx->user_entry, SYSDB_MEMBEROF);
+
+    /* an updated entry on the server */
+    ldb_msg_remove_attr(test_ctx->user_entry, SYSDB_ORIG_MODSTAMP);
+    new_state = be_access_cache_user_state(test_ctx->user_entry, TEST_RULES);
+    assert_int_not_equal(user_state, new_state);
+}
+
+static void test_be_access_cache_disabled(void **state)
+{
+    struct be_access_cache *cache;
+    bool allowed;
+    bool refresh;
+    errno_t ret;
+
+    ret = be_access_cache_init(NULL, 0, &cache);
+    assert_int_equal(ret, EOK);
+    assert_null(cache);
+
+    ret = be_access_cache_add(cache, TEST_USER, 1, true);
+    assert_int_equal(ret, EOK);
+
+    ret = be_access_cache_check(cache, TEST_USER, 1, &allowed, &refresh);
+    assert_int_equal(ret, ENOENT);
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_be_access_cache_hit,
+                                        be_access_cache_test_setup,
+                                        be_access_cache_test_teardown),
+        cmocka_unit_test_setup_teardown(test_be_access_cache_changed,
+                                        be_access_cache_test_setup,
+                                        be_access_cache_test_teardown),
+        cmocka_unit_test(test_be_access_cache_disabled),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        switch (opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -222,6 +222,18 @@ errno_t test_be_ptask_error_recv(struct tevent_req *req)
     return ERR_INTERNAL;
 }
 
+errno_t test_be_ptask_busy_recv(struct tevent_req *req)
+{
+    struct test_be_ptask_state *state = NULL;
+
+    state = tevent_req_data(req, struct test_be_ptask_state);
+    assert_non_null(state);
+
+    state->test_ctx->done = true;
+
+    return EBUSY;
+}
+
 errno_t test_be_ptask_sync(TALLOC_CTX *mem_ctx,
                            struct tevent_context *ev,
                            struct be_ctx *be_ctx,
@@ -873,6 +885,98 @@ void test_be_ptask_reschedule_backoff(void **state)
     assert_null(ptask);
 }
 
+void test_be_ptask_reschedule_overload(void **state)
+{
+    struct test_ctx *test_ctx = (struct test_ctx *)(*state);
+    struct be_ptask *ptask = NULL;
+    const struct be_ptask_stats *stats;
+    time_t now = 0;
+    errno_t ret;
+
+    ret = be_ptask_create(test_ctx, test_ctx->be_ctx, PERIOD, 0, 0, 0, 0,
+                          0, test_be_ptask_send,
+                          test_be_ptask_busy_recv, test_ctx, "Test ptask",
+                          BE_PTASK_OFFLINE_SKIP | BE_PTASK_SCHEDULE_FROM_LAST,
+                          &ptask);
+    assert_int_equal(ret, ERR_OK);
+    assert_non_null(ptask);
+    assert_non_null(ptask->timer);
+
+    while (!test_ctx->done) {
+        now = get_current_time();
+        tevent_loop_once(test_ctx->be_ctx->ev);
+    }
+
+    stats = be_ptask_get_stats(ptask);
+    assert_int_equal(stats->runs, 1);
+    assert_int_equal(stats->failures, 1);
+    assert_int_equal(stats->overload, 1);
+
+    /* the period is doubled until the server answers again */
+    assert_true(now + PERIOD * 2 <= ptask->next_execution);
+    assert_int_equal(PERIOD, ptask->period);
+    assert_non_null(ptask->timer);
+
+    be_ptask_destroy(&ptask);
+    assert_null(ptask);
+}
+
+void test_be_ptask_bulk_limit(void **state)
+{
+    struct test_ctx *test_ctx = (struct test_ctx *)(*state);
+    struct be_ptask *ptask[BE_PTASK_BULK_MAX_RUNNING + 1] = { NULL };
+    int executed;
+    errno_t ret;
+    int i;
+
+    for (i = 0; i < BE_PTASK_BULK_MAX_RUNNING + 1; i++) {
+        ret = be_ptask_create(test_ctx, test_ctx->be_ctx, PERIOD, 0, 0, 0, 0,
+                              0, test_be_ptask_timeout_send,
+                              test_be_ptask_recv, test_ctx, "Test ptask",
+                              BE_PTASK_OFFLINE_SKIP
+                              | BE_PTASK_SCHEDULE_FROM_LAST
+                              | BE_PTASK_BULK,
+                              &ptask[i]);
+        assert_int_equal(ret, ERR_OK);
+        assert_non_null(ptask[i]);
+    }
+
+    do {
+        tevent_loop_once(test_ctx->be_ctx->ev);
+
+        executed = 0;
+        for (i = 0; i < BE_PTASK_BULK_MAX_RUNNING + 1; i++) {
+            if (ptask[i]->req != NULL || ptask[i]->bulk_waiting) {
+                executed++;
+            }
+        }
+    } while (executed < BE_PTASK_BULK_MAX_RUNNING + 1);
+
+    /* the last task waits for one of the others */
+    assert_int_equal(test_ctx->be_ctx->ptask_bulk_running,
+                     BE_PTASK_BULK_MAX_RUNNING);
+    assert_true(ptask[BE_PTASK_BULK_MAX_RUNNING]->bulk_waiting);
+    assert_null(ptask[BE_PTASK_BULK_MAX_RUNNING]->req);
+    assert_int_equal(be_ptask_get_stats(ptask[BE_PTASK_BULK_MAX_RUNNING])->deferred,
+                     1);
+
+    be_ptask_destroy(&ptask[0]);
+
+    while (ptask[BE_PTASK_BULK_MAX_RUNNING]->req == NULL) {
+        tevent_loop_once(test_ctx->be_ctx->ev);
+    }
+
+    assert_false(ptask[BE_PTASK_BULK_MAX_RUNNING]->bulk_waiting);
+    assert_int_equal(test_ctx->be_ctx->ptask_bulk_running,
+                     BE_PTASK_BULK_MAX_RUNNING);
+
+    for (i = 1; i < BE_PTASK_BULK_MAX_RUNNING + 1; i++) {
+        be_ptask_destroy(&ptask[i]);
+    }
+
+    assert_int_equal(test_ctx->be_ctx->ptask_bulk_running, 0);
+}
+
 void test_be_ptask_get_period(void **state)
 {
     struct test_ctx *test_ctx = (struct test_ctx *)(*state);
@@ -1116,6 +1220,8 @@ int main(int argc, const char *argv[])
         new_test(be_ptask_reschedule_error),
         new_test(be_ptask_reschedule_timeout),
         new_test(be_ptask_reschedule_backoff),
+        new_test(be_ptask_reschedule_overload),
+        new_test(be_ptask_bulk_limit),
         new_test(be_ptask_get_period),
         new_test(be_ptask_get_timeout),
         new_test(be_ptask_no_periodic),
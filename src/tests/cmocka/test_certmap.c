@@ -1140,6 +1140,73 @@ static void test_sss_certmap_match_cert(void **state)
     }
 }
 
+static void test_sss_certmap_compiled_rules_and_cache(void **state)
+{
+    struct sss_certmap_ctx *ctx;
+    uint8_t *der_copy;
+    char *filter;
+    char **domains;
+    size_t num_cached;
+    size_t c;
+    int ret;
+
+    ret = sss_certmap_init(NULL, ext_debug, NULL, &ctx);
+    assert_int_equal(ret, EOK);
+    assert_non_null(ctx);
+
+    /* cRLSign is not set in the certificate, the rule is skipped early */
+    ret = sss_certmap_add_rule(ctx, 0, "KRB5:<KU>cRLSign<ISSUER>.*",
+                               NULL, NULL);
+    assert_int_equal(ret, EOK);
+
+    ret = sss_certmap_add_rule(ctx, 1,
+                            "KRB5:<ISSUER>CN=Certificate Authority,O=IPA.DEVEL",
+                            NULL, NULL);
+    assert_int_equal(ret, EOK);
+
+    ret = sss_certmap_match_cert(ctx, discard_const(test_cert_der),
+                                 sizeof(test_cert_der));
+    assert_int_equal(ret, 0);
+    assert_int_equal(ctx->num_compiled_rules, 2);
+    assert_int_equal(ctx->compiled_rules[0].required_ku, SSS_KU_CRL_SIGN);
+    assert_int_equal(ctx->compiled_rules[1].required_ku, 0);
+
+    /* The same certificate in a different buffer is taken from the cache */
+    der_copy = talloc_memdup(ctx, test_cert_der, sizeof(test_cert_der));
+    assert_non_null(der_copy);
+
+    ret = sss_certmap_get_search_filter(ctx, der_copy, sizeof(test_cert_der),
+                                        &filter, &domains);
+    assert_int_equal(ret, 0);
+    assert_non_null(filter);
+    assert_null(domains);
+    sss_certmap_free_filter_and_domains(filter, domains);
+
+    ret = sss_certmap_match_cert(ctx, discard_const(test_cert2_der),
+                                 sizeof(test_cert2_der));
+    assert_int_equal(ret, ENOENT);
+
+    num_cached = 0;
+    for (c = 0; c < CERT_CONTENT_CACHE_SIZE; c++) {
+        if (ctx->content_cache[c].content != NULL) {
+            num_cached++;
+        }
+    }
+    assert_int_equal(num_cached, 2);
+
+    /* A new rule invalidates the compiled rules */
+    ret = sss_certmap_add_rule(ctx, 2, "KRB5:<SAN>tu1", NULL, NULL);
+    assert_int_equal(ret, EOK);
+    assert_null(ctx->compiled_rules);
+
+    ret = sss_certmap_match_cert(ctx, discard_const(test_cert2_der),
+                                 sizeof(test_cert2_der));
+    assert_int_equal(ret, 0);
+    assert_int_equal(ctx->num_compiled_rules, 3);
+
+    sss_certmap_free_ctx(ctx);
+}
+
 static void test_sss_certmap_add_mapping_rule(void **state)
 {
     struct sss_certmap_ctx *ctx;
@@ -1709,6 +1776,7 @@ int main(int argc, const char *argv[])
         cmocka_unit_test(test_sss_cert_get_content_test_cert_0004),
 #endif
         cmocka_unit_test(test_sss_certmap_match_cert),
+        cmocka_unit_test(test_sss_certmap_compiled_rules_and_cache),
         cmocka_unit_test(test_sss_certmap_add_mapping_rule),
         cmocka_unit_test(test_sss_certmap_get_search_filter),
     };
@@ -367,6 +367,70 @@ void test_exec_child_echo(void **state)
     assert_int_equal(ret, EOK);
 }
 
+/* Like test_exec_child_echo, but the child is started with
+ * sss_child_spawn() */
+void test_sss_child_spawn_echo(void **state)
+{
+    errno_t ret;
+    pid_t child_pid;
+    struct child_test_ctx *child_tctx = talloc_get_type(*state,
+                                                        struct child_test_ctx);
+    struct tevent_req *req;
+    struct child_io_fds *io_fds;
+
+    setenv("TEST_CHILD_ACTION", "echo", 1);
+
+    io_fds = talloc(child_tctx, struct child_io_fds);
+    assert_non_null(io_fds);
+    io_fds->read_from_child_fd = -1;
+    io_fds->write_to_child_fd = -1;
+    talloc_set_destructor((void *) io_fds, child_io_destructor);
+
+    ret = sss_child_spawn(child_tctx,
+                          child_tctx->pipefd_to_child,
+                          child_tctx->pipefd_from_child,
+                          CHILD_DIR"/"TEST_BIN, NULL, NULL, false,
+                          STDIN_FILENO, 3, &child_pid);
+    assert_int_equal(ret, EOK);
+
+    DEBUG(SSSDBG_FUNC_DATA, "Spawned %d\n", child_pid);
+
+    io_fds->read_from_child_fd = child_tctx->pipefd_from_child[0];
+    close(child_tctx->pipefd_from_child[1]);
+    io_fds->write_to_child_fd = child_tctx->pipefd_to_child[1];
+    close(child_tctx->pipefd_to_child[0]);
+
+    sss_fd_nonblocking(io_fds->write_to_child_fd);
+    sss_fd_nonblocking(io_fds->read_from_child_fd);
+
+    ret = child_handler_setup(child_tctx->test_ctx->ev, child_pid,
+                              NULL, NULL, NULL);
+    assert_int_equal(ret, EOK);
+
+    req = echo_child_write_send(child_tctx, child_tctx, io_fds, ECHO_STR);
+    assert_non_null(req);
+
+    ret = test_ev_loop(child_tctx->test_ctx);
+    talloc_free(io_fds);
+    assert_int_equal(ret, EOK);
+}
+
+/* A binary which cannot be started is reported to the caller */
+void test_sss_child_spawn_missing(void **state)
+{
+    errno_t ret;
+    pid_t child_pid;
+    struct child_test_ctx *child_tctx = talloc_get_type(*state,
+                                                        struct child_test_ctx);
+
+    ret = sss_child_spawn(child_tctx,
+                          child_tctx->pipefd_to_child,
+                          child_tctx->pipefd_from_child,
+                          CHILD_DIR"/does-not-exist", NULL, NULL, false,
+                          STDIN_FILENO, STDOUT_FILENO, &child_pid);
+    assert_int_equal(ret, ENOENT);
+}
+
 struct test_exec_echo_state {
     struct child_io_fds *io_fds;
     struct io_buffer buf;
@@ -524,6 +588,12 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_exec_child_handler,
                                         child_test_setup,
                                         child_test_teardown),
+        cmocka_unit_test_setup_teardown(test_sss_child_spawn_echo,
+                                        child_test_setup,
+                                        child_test_teardown),
+        cmocka_unit_test_setup_teardown(test_sss_child_spawn_missing,
+                                        child_test_setup,
+                                        child_test_teardown),
         cmocka_unit_test_setup_teardown(test_exec_child_echo,
                                         child_test_setup,
                                         child_test_teardown),
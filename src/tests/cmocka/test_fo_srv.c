@@ -29,6 +29,7 @@
 #include <sys/types.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "providers/fail_over_srv.h"
 #include "tests/cmocka/common_mock.h"
@@ -38,6 +39,8 @@
 #define TEST_FO_TIMEOUT     3000
 #define TEST_SRV_TTL        500
 #define TEST_SRV_SHORT_TTL  2
+#define TEST_DNS_STALE      60
+#define TEST_SRV_CACHE      "test_fo_srv.cache"
 
 static TALLOC_CTX *global_mock_context = NULL;
 
@@ -212,7 +215,20 @@ int test_fo_srv_data_cmp(void *ud1, void *ud2)
     return strcasecmp((char*) ud1, (char*) ud2);
 }
 
-static int test_fo_setup(void **state)
+static void test_fo_init_opts(struct fo_options *fopts,
+                              time_t dns_stale_timeout,
+                              const char *srv_cache_path)
+{
+    memset(fopts, 0, sizeof(struct fo_options));
+    fopts->retry_timeout = TEST_FO_TIMEOUT;
+    fopts->family_order  = IPV4_FIRST;
+    fopts->dns_stale_timeout = dns_stale_timeout;
+    fopts->srv_cache_path = srv_cache_path;
+}
+
+static int test_fo_setup_opts(void **state,
+                              time_t dns_stale_timeout,
+                              const char *srv_cache_path)
 {
     struct test_fo_ctx *test_ctx;
     errno_t ret;
@@ -233,9 +249,7 @@ static int test_fo_setup(void **state)
                       TEST_RESOLV_TIMEOUT, 2000, &test_ctx->resolv);
     assert_non_null(test_ctx->resolv);
 
-    memset(&fopts, 0, sizeof(fopts));
-    fopts.retry_timeout = TEST_FO_TIMEOUT;
-    fopts.family_order  = IPV4_FIRST;
+    test_fo_init_opts(&fopts, dns_stale_timeout, srv_cache_path);
 
     test_ctx->fo_ctx = fo_context_init(test_ctx, &fopts);
     assert_non_null(test_ctx->fo_ctx);
@@ -249,6 +263,11 @@ static int test_fo_setup(void **state)
     return 0;
 }
 
+static int test_fo_setup(void **state)
+{
+    return test_fo_setup_opts(state, 0, NULL);
+}
+
 static int test_fo_teardown(void **state)
 {
     struct test_fo_ctx *test_ctx =
@@ -260,12 +279,15 @@ static int test_fo_teardown(void **state)
     return 0;
 }
 
-static int test_fo_srv_setup(void **state)
+static int test_fo_srv_setup_opts(void **state,
+                                  time_t dns_stale_timeout,
+                                  const char *srv_cache_path,
+                                  bool persistent)
 {
     struct test_fo_ctx *test_ctx;
     bool ok;
 
-    test_fo_setup(state);
+    test_fo_setup_opts(state, dns_stale_timeout, srv_cache_path);
     test_ctx = *state;
 
     test_ctx->srv_ctx = fo_resolve_srv_dns_ctx_init(test_ctx, test_ctx->resolv,
@@ -276,19 +298,46 @@ static int test_fo_srv_setup(void **state)
     ok = fo_set_srv_lookup_plugin(test_ctx->fo_ctx,
                                   fo_resolve_srv_dns_send,
                                   fo_resolve_srv_dns_recv,
-                                  test_ctx->srv_ctx);
+                                  test_ctx->srv_ctx,
+                                  persistent);
     assert_true(ok);
 
     *state = test_ctx;
     return 0;
 }
 
+static int test_fo_srv_setup(void **state)
+{
+    return test_fo_srv_setup_opts(state, 0, NULL, false);
+}
+
 static int test_fo_srv_teardown(void **state)
 {
     test_fo_teardown(state);
     return 0;
 }
 
+static int test_fo_srv_stale_setup(void **state)
+{
+    unlink(TEST_SRV_CACHE);
+    return test_fo_srv_setup_opts(state, TEST_DNS_STALE, TEST_SRV_CACHE,
+                                  false);
+}
+
+/* like an SRV lookup plugin that keeps its results by itself */
+static int test_fo_srv_persistent_setup(void **state)
+{
+    unlink(TEST_SRV_CACHE);
+    return test_fo_srv_setup_opts(state, TEST_DNS_STALE, TEST_SRV_CACHE,
+                                  true);
+}
+
+static int test_fo_srv_stale_teardown(void **state)
+{
+    unlink(TEST_SRV_CACHE);
+    return test_fo_srv_teardown(state);
+}
+
 /* reply_list and dns_domain must be a talloc context so it can be used as
  * talloc_steal argument later
  */
@@ -754,6 +803,306 @@ static void test_fo_srv_dup_done(struct tevent_req *req)
     }
 }
 
+/* Only ldap3.sssd.com is left in the DNS */
+static void test_fo_srv_mock_dns_changed(struct test_fo_ctx *test_ctx)
+{
+    struct ares_srv_reply *s1;
+    char *dns_domain;
+
+    s1 = mock_ares_reply(test_ctx, "ldap3.sssd.com", 100, 1, 389);
+    assert_non_null(s1);
+
+    dns_domain = talloc_strdup(test_ctx, "sssd.com");
+    assert_non_null(dns_domain);
+
+    mock_srv_results(s1, TEST_SRV_TTL, dns_domain);
+}
+
+static void test_fo_srv_resolve(struct test_fo_ctx *test_ctx,
+                                tevent_req_fn fn)
+{
+    struct tevent_req *req;
+
+    req = fo_resolve_service_send(test_ctx, test_ctx->ctx->ev,
+                                  test_ctx->resolv, test_ctx->fo_ctx,
+                                  test_ctx->fo_svc);
+    assert_non_null(req);
+    tevent_req_set_callback(req, fn, test_ctx);
+}
+
+static void test_fo_srv_refreshed(struct tevent_req *req)
+{
+    struct test_fo_ctx *test_ctx = \
+        tevent_req_callback_data(req, struct test_fo_ctx);
+    struct fo_server *srv;
+    errno_t ret;
+
+    ret = fo_resolve_service_recv(req, req, &srv);
+    talloc_zfree(req);
+    assert_int_equal(ret, ERR_OK);
+
+    /* The background refresh replaced the servers */
+    check_server(test_ctx, srv, 389, "ldap3.sssd.com");
+
+    test_ctx->ctx->error = ERR_OK;
+    test_ctx->ctx->done = true;
+}
+
+static void test_fo_srv_refresh_wait(struct tevent_context *ev,
+                                     struct tevent_timer *te,
+                                     struct timeval tv, void *pvt)
+{
+    struct test_fo_ctx *test_ctx = talloc_get_type(pvt, struct test_fo_ctx);
+
+    test_fo_srv_resolve(test_ctx, test_fo_srv_refreshed);
+}
+
+static void test_fo_srv_served(struct tevent_req *req)
+{
+    struct test_fo_ctx *test_ctx = \
+        tevent_req_callback_data(req, struct test_fo_ctx);
+    struct tevent_timer *te;
+    struct fo_server *srv;
+    errno_t ret;
+
+    ret = fo_resolve_service_recv(req, req, &srv);
+    talloc_zfree(req);
+    assert_int_equal(ret, ERR_OK);
+
+    /* The known server is returned without waiting for the DNS */
+    check_server(test_ctx, srv, 389, "ldap1.sssd.com");
+
+    te = tevent_add_timer(test_ctx->ctx->ev, test_ctx,
+                          tevent_timeval_current_ofs(0, 100000),
+                          test_fo_srv_refresh_wait, test_ctx);
+    assert_non_null(te);
+}
+
+static void test_fo_srv_stale_first(struct tevent_req *req)
+{
+    struct test_fo_ctx *test_ctx = \
+        tevent_req_callback_data(req, struct test_fo_ctx);
+    errno_t ret;
+
+    ret = fo_resolve_service_recv(req, test_ctx, &test_ctx->srv);
+    talloc_zfree(req);
+    assert_int_equal(ret, ERR_OK);
+
+    check_server(test_ctx, test_ctx->srv, 389, "ldap1.sssd.com");
+    fo_set_port_status(test_ctx->srv, PORT_WORKING);
+
+    test_fo_srv_mock_dns_changed(test_ctx);
+    sleep(test_ctx->ttl + 1);
+
+    test_fo_srv_resolve(test_ctx, test_fo_srv_served);
+}
+
+/* Test that expired SRV results are served while they are refreshed in
+ * the background */
+void test_fo_srv_stale(void **state)
+{
+    errno_t ret;
+    struct test_fo_ctx *test_ctx =
+        talloc_get_type(*state, struct test_fo_ctx);
+
+    test_ctx->ttl = TEST_SRV_SHORT_TTL;
+    test_fo_srv_mock_dns(test_ctx, test_ctx->ttl);
+
+    ret = fo_add_srv_server(test_ctx->fo_svc, "_ldap", "sssd.com",
+                            "sssd.local", "tcp", test_ctx);
+    assert_int_equal(ret, ERR_OK);
+
+    test_fo_srv_resolve(test_ctx, test_fo_srv_stale_first);
+
+    ret = test_ev_loop(test_ctx->ctx);
+    assert_int_equal(ret, ERR_OK);
+}
+
+static void test_fo_srv_cache_first(struct tevent_req *req)
+{
+    struct test_fo_ctx *test_ctx = \
+        tevent_req_callback_data(req, struct test_fo_ctx);
+    struct fo_options fopts;
+    errno_t ret;
+    bool ok;
+
+    ret = fo_resolve_service_recv(req, test_ctx, &test_ctx->srv);
+    talloc_zfree(req);
+    assert_int_equal(ret, ERR_OK);
+
+    check_server(test_ctx, test_ctx->srv, 389, "ldap1.sssd.com");
+
+    /* Simulate a restart, the new fail over context reads the cache file
+     * and refreshes it in the background */
+    test_fo_init_opts(&fopts, TEST_DNS_STALE, TEST_SRV_CACHE);
+    test_ctx->fo_ctx = fo_context_init(test_ctx, &fopts);
+    assert_non_null(test_ctx->fo_ctx);
+
+    ret = fo_new_service(test_ctx->fo_ctx, "ldap",
+                         test_fo_srv_data_cmp,
+                         &test_ctx->fo_svc);
+    assert_int_equal(ret, ERR_OK);
+
+    ok = fo_set_srv_lookup_plugin(test_ctx->fo_ctx,
+                                  fo_resolve_srv_dns_send,
+                                  fo_resolve_srv_dns_recv,
+                                  test_ctx->srv_ctx,
+                                  false);
+    assert_true(ok);
+
+    ret = fo_add_srv_server(test_ctx->fo_svc, "_ldap", "sssd.com",
+                            "sssd.local", "tcp", test_ctx);
+    assert_int_equal(ret, ERR_OK);
+
+    test_fo_srv_mock_dns_changed(test_ctx);
+    test_fo_srv_resolve(test_ctx, test_fo_srv_served);
+}
+
+/* Test that resolved SRV results survive a restart */
+void test_fo_srv_cache(void **state)
+{
+    errno_t ret;
+    struct test_fo_ctx *test_ctx =
+        talloc_get_type(*state, struct test_fo_ctx);
+
+    test_fo_srv_mock_dns(test_ctx, TEST_SRV_TTL);
+
+    ret = fo_add_srv_server(test_ctx->fo_svc, "_ldap", "sssd.com",
+                            "sssd.local", "tcp", test_ctx);
+    assert_int_equal(ret, ERR_OK);
+
+    test_fo_srv_resolve(test_ctx, test_fo_srv_cache_first);
+
+    ret = test_ev_loop(test_ctx->ctx);
+    assert_int_equal(ret, ERR_OK);
+}
+
+/* The SRV lookup of the tests expires at expire and lists ldap9.sssd.com,
+ * which the mocked DNS does not know */
+static void test_fo_srv_write_cache(time_t expire, const char *servers)
+{
+    FILE *f;
+
+    f = fopen(TEST_SRV_CACHE, "w");
+    assert_non_null(f);
+    assert_true(fprintf(f, "srv\tldap\t_ldap\ttcp\tsssd.com\tsssd.com\t%lld\n"
+                        "%s", (long long) expire, servers) > 0);
+    assert_int_equal(fclose(f), 0);
+}
+
+static void test_fo_srv_check_cache(const char *server, bool present)
+{
+    char buf[4096];
+    size_t len;
+    FILE *f;
+
+    f = fopen(TEST_SRV_CACHE, "r");
+    assert_non_null(f);
+    len = fread(buf, 1, sizeof(buf) - 1, f);
+    assert_int_equal(fclose(f), 0);
+    buf[len] = '\0';
+
+    assert_int_equal(strstr(buf, server) != NULL, present);
+}
+
+static void test_fo_srv_dns_used(struct tevent_req *req)
+{
+    struct test_fo_ctx *test_ctx = \
+        tevent_req_callback_data(req, struct test_fo_ctx);
+    struct fo_server *srv;
+    errno_t ret;
+
+    ret = fo_resolve_service_recv(req, req, &srv);
+    talloc_zfree(req);
+    assert_int_equal(ret, ERR_OK);
+
+    /* not ldap9.sssd.com from the cache file */
+    check_server(test_ctx, srv, 389, "ldap1.sssd.com");
+
+    test_ctx->ctx->error = ERR_OK;
+    test_ctx->ctx->done = true;
+}
+
+static void test_fo_srv_cache_dns_used(struct test_fo_ctx *test_ctx)
+{
+    errno_t ret;
+
+    /* the mocked DNS answer must be consumed */
+    test_fo_srv_mock_dns(test_ctx, TEST_SRV_TTL);
+
+    ret = fo_add_srv_server(test_ctx->fo_svc, "_ldap", "sssd.com",
+                            "sssd.local", "tcp", test_ctx);
+    assert_int_equal(ret, ERR_OK);
+
+    test_fo_srv_resolve(test_ctx, test_fo_srv_dns_used);
+
+    ret = test_ev_loop(test_ctx->ctx);
+    assert_int_equal(ret, ERR_OK);
+}
+
+/* Test that a corrupted cache file is ignored and replaced */
+void test_fo_srv_cache_corrupt(void **state)
+{
+    struct test_fo_ctx *test_ctx =
+        talloc_get_type(*state, struct test_fo_ctx);
+
+    test_fo_srv_write_cache(time(NULL) + TEST_SRV_TTL,
+                            "server\tldap9.sssd.com\tnot-a-port\t1\t1\n");
+
+    test_fo_srv_cache_dns_used(test_ctx);
+
+    test_fo_srv_check_cache("server\tldap1.sssd.com\t389\t", true);
+    test_fo_srv_check_cache("ldap9.sssd.com", false);
+}
+
+/* Test that a cache file cut off in the middle of a line is ignored */
+void test_fo_srv_cache_truncated(void **state)
+{
+    struct test_fo_ctx *test_ctx =
+        talloc_get_type(*state, struct test_fo_ctx);
+
+    test_fo_srv_write_cache(time(NULL) + TEST_SRV_TTL,
+                            "server\tldap9.sssd.com\t389\t1\t1\n"
+                            "addr\t192.168.");
+
+    test_fo_srv_cache_dns_used(test_ctx);
+
+    test_fo_srv_check_cache("server\tldap1.sssd.com\t389\t", true);
+    test_fo_srv_check_cache("ldap9.sssd.com", false);
+}
+
+/* Test that servers expired for longer than dns_stale_timeout are not
+ * used after a restart */
+void test_fo_srv_cache_stale(void **state)
+{
+    struct test_fo_ctx *test_ctx =
+        talloc_get_type(*state, struct test_fo_ctx);
+
+    test_fo_srv_write_cache(time(NULL) - TEST_DNS_STALE - 1,
+                            "server\tldap9.sssd.com\t389\t1\t1\n");
+
+    test_fo_srv_cache_dns_used(test_ctx);
+
+    test_fo_srv_check_cache("server\tldap1.sssd.com\t389\t", true);
+    test_fo_srv_check_cache("ldap9.sssd.com", false);
+}
+
+/* Test that the cache file is neither read nor written for a plugin
+ * that keeps its results by itself */
+void test_fo_srv_cache_persistent(void **state)
+{
+    struct test_fo_ctx *test_ctx =
+        talloc_get_type(*state, struct test_fo_ctx);
+
+    test_fo_srv_write_cache(time(NULL) + TEST_SRV_TTL,
+                            "server\tldap9.sssd.com\t389\t1\t1\n");
+
+    test_fo_srv_cache_dns_used(test_ctx);
+
+    test_fo_srv_check_cache("server\tldap9.sssd.com\t389\t", true);
+    test_fo_srv_check_cache("ldap1.sssd.com", false);
+}
+
 int main(int argc, const char *argv[])
 {
     int rv;
@@ -781,6 +1130,24 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_fo_srv_duplicates,
                                         test_fo_srv_setup,
                                         test_fo_srv_teardown),
+        cmocka_unit_test_setup_teardown(test_fo_srv_stale,
+                                        test_fo_srv_stale_setup,
+                                        test_fo_srv_stale_teardown),
+        cmocka_unit_test_setup_teardown(test_fo_srv_cache,
+                                        test_fo_srv_stale_setup,
+                                        test_fo_srv_stale_teardown),
+        cmocka_unit_test_setup_teardown(test_fo_srv_cache_corrupt,
+                                        test_fo_srv_stale_setup,
+                                        test_fo_srv_stale_teardown),
+        cmocka_unit_test_setup_teardown(test_fo_srv_cache_truncated,
+                                        test_fo_srv_stale_setup,
+                                        test_fo_srv_stale_teardown),
+        cmocka_unit_test_setup_teardown(test_fo_srv_cache_stale,
+                                        test_fo_srv_stale_setup,
+                                        test_fo_srv_stale_teardown),
+        cmocka_unit_test_setup_teardown(test_fo_srv_cache_persistent,
+                                        test_fo_srv_persistent_setup,
+                                        test_fo_srv_stale_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -462,6 +462,90 @@ void sss_parse_name_fail(void **state)
     sss_parse_name_check(test_ctx, NAME"\\", ERR_REGEX_NOMATCH, NULL, NULL);
 }
 
+static void parse_name_fast_check(struct sss_names_ctx *fast,
+                                  struct sss_names_ctx *regex,
+                                  const char *input)
+{
+    TALLOC_CTX *tmp_ctx;
+    char *fast_domain = NULL;
+    char *fast_name = NULL;
+    char *re_domain = NULL;
+    char *re_name = NULL;
+    errno_t fast_ret;
+    errno_t re_ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    fast_ret = sss_parse_name(tmp_ctx, fast, input, &fast_domain, &fast_name);
+    re_ret = sss_parse_name(tmp_ctx, regex, input, &re_domain, &re_name);
+    assert_int_equal(fast_ret, re_ret);
+
+    if (re_ret == EOK) {
+        assert_string_equal(fast_name, re_name);
+        if (re_domain == NULL) {
+            assert_null(fast_domain);
+        } else {
+            assert_non_null(fast_domain);
+            assert_string_equal(fast_domain, re_domain);
+        }
+    }
+
+    talloc_free(tmp_ctx);
+}
+
+void parse_name_fast_path(void **state)
+{
+    struct fqdn_test_ctx *test_ctx = talloc_get_type(*state,
+                                                     struct fqdn_test_ctx);
+    const char *inputs[] = { NAME, NAME"@"DOMNAME, DOMNAME"\\"NAME,
+                             SPECIALNAME, SPECIALNAME"@"DOMNAME,
+                             DOMNAME"\\"NAME"@"DOMNAME2,
+                             NAME"@"DOMNAME"\\"NAME,
+                             NAME"@"DOMNAME"@"DOMNAME2,
+                             DOMNAME"\\"DOMNAME2"\\"NAME,
+                             "first last@"DOMNAME,
+                             "", "@", "\\", "@"NAME, NAME"@", "\\"NAME,
+                             NAME"\\", "@@", NAME"\n", "m\xc3\xbcller@"DOMNAME,
+                             NULL };
+    const char *patterns[] = {
+        "(?P<name>[^@]+)@?(?P<domain>[^@]*$)",
+        "(((?P<domain>[^\\\\]+)\\\\(?P<name>.+$))|"
+        "((?P<name>[^@]+)@(?P<domain>.+$))|"
+        "(^(?P<name>[^@\\\\]+)$))",
+        NULL
+    };
+    struct sss_names_ctx *fast;
+    struct sss_names_ctx *regex;
+    char *pattern;
+    errno_t ret;
+    int i;
+    int j;
+
+    for (i = 0; patterns[i] != NULL; i++) {
+        ret = sss_names_init_from_args(test_ctx, patterns[i], "%1$s@%2$s",
+                                       &fast);
+        assert_int_equal(ret, EOK);
+        assert_int_not_equal(fast->re_format, SSS_NAMES_RE_OTHER);
+
+        /* The same expression in a group is matched by the regex engine */
+        pattern = talloc_asprintf(test_ctx, "(?:%s)", patterns[i]);
+        assert_non_null(pattern);
+        ret = sss_names_init_from_args(test_ctx, pattern, "%1$s@%2$s",
+                                       &regex);
+        assert_int_equal(ret, EOK);
+        assert_int_equal(regex->re_format, SSS_NAMES_RE_OTHER);
+
+        for (j = 0; inputs[j] != NULL; j++) {
+            parse_name_fast_check(fast, regex, inputs[j]);
+        }
+
+        talloc_free(fast);
+        talloc_free(regex);
+        talloc_free(pattern);
+    }
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -499,6 +583,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(parse_name_default,
                                         parse_name_test_setup,
                                         parse_name_test_teardown),
+        cmocka_unit_test_setup_teardown(parse_name_fast_path,
+                                        fqdn_test_setup,
+                                        fqdn_test_teardown),
         cmocka_unit_test_setup_teardown(sss_parse_name_fail,
                                         parse_name_test_setup,
                                         parse_name_test_teardown),
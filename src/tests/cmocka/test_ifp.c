@@ -33,6 +33,15 @@
 #undef DBUS_TYPE_OBJECT_PATH
 #define DBUS_TYPE_OBJECT_PATH ((int) 's')
 
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB "test_ifp_conf.ldb"
+#define TEST_ID_PROVIDER "ldap"
+
+#define TEST_DOM_A "ifp_list_a"
+#define TEST_DOM_B "ifp_list_b"
+
+const char *domains[] = { TEST_DOM_A, TEST_DOM_B, NULL };
+
 void test_el_to_dict(void **state)
 {
     TALLOC_CTX *tmp_ctx;
@@ -264,6 +273,336 @@ void test_attr_allowed(void **state)
     assert_false(ifp_attr_allowed(NULL, "name"));
 }
 
+struct ifp_list_page_test_ctx {
+    struct sss_test_ctx *tctx;
+    struct ifp_ctx *ifp_ctx;
+    struct sss_domain_info *dom_a;
+    struct sss_domain_info *dom_b;
+};
+
+/* The object path only carries the UID, e.g. /test/1003 */
+static char *test_list_page_path(TALLOC_CTX *mem_ctx,
+                                 struct sss_domain_info *domain,
+                                 struct ldb_message *msg)
+{
+    return talloc_asprintf(mem_ctx, "/test/%"PRIu64,
+                           ldb_msg_find_attr_as_uint64(msg, SYSDB_UIDNUM, 0));
+}
+
+static void test_list_page_add_user(struct sss_domain_info *dom,
+                                    const char *shortname, uid_t uid)
+{
+    char *fqname;
+    errno_t ret;
+
+    fqname = sss_create_internal_fqname(dom, shortname, dom->name);
+    assert_non_null(fqname);
+
+    ret = sysdb_add_user(dom, fqname, uid, uid, NULL, NULL, NULL, NULL, NULL,
+                         300, 0);
+    assert_int_equal(ret, EOK);
+    talloc_free(fqname);
+}
+
+static void test_list_page_del_user(struct sss_domain_info *dom,
+                                    const char *shortname, uid_t uid)
+{
+    char *fqname;
+    errno_t ret;
+
+    fqname = sss_create_internal_fqname(dom, shortname, dom->name);
+    assert_non_null(fqname);
+
+    ret = sysdb_delete_user(dom, fqname, uid);
+    assert_int_equal(ret, EOK);
+    talloc_free(fqname);
+}
+
+static int test_list_page_setup(void **state)
+{
+    struct ifp_list_page_test_ctx *test_ctx;
+
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context,
+                           struct ifp_list_page_test_ctx);
+    assert_non_null(test_ctx);
+
+    test_dom_suite_setup(TESTS_PATH);
+
+    test_ctx->tctx = create_multidom_test_ctx(test_ctx, TESTS_PATH,
+                                              TEST_CONF_DB, domains,
+                                              TEST_ID_PROVIDER, NULL);
+    assert_non_null(test_ctx->tctx);
+
+    test_ctx->dom_a = test_ctx->tctx->dom;
+    test_ctx->dom_b = test_ctx->dom_a->next;
+    assert_non_null(test_ctx->dom_b);
+    assert_string_equal(test_ctx->dom_b->name, TEST_DOM_B);
+
+    test_ctx->ifp_ctx = talloc_zero(test_ctx, struct ifp_ctx);
+    assert_non_null(test_ctx->ifp_ctx);
+
+    test_ctx->ifp_ctx->rctx = mock_rctx(test_ctx->ifp_ctx,
+                                        test_ctx->tctx->ev,
+                                        test_ctx->tctx->dom, NULL);
+    assert_non_null(test_ctx->ifp_ctx->rctx);
+
+    test_list_page_add_user(test_ctx->dom_a, "user1", 1001);
+    test_list_page_add_user(test_ctx->dom_a, "user2", 1002);
+    test_list_page_add_user(test_ctx->dom_a, "user3", 1003);
+    test_list_page_add_user(test_ctx->dom_b, "user4", 1004);
+    test_list_page_add_user(test_ctx->dom_b, "user5", 1005);
+
+    check_leaks_push(test_ctx);
+    *state = test_ctx;
+    return 0;
+}
+
+static int test_list_page_teardown(void **state)
+{
+    struct ifp_list_page_test_ctx *test_ctx;
+
+    test_ctx = talloc_get_type_abort(*state, struct ifp_list_page_test_ctx);
+
+    assert_true(check_leaks_pop(test_ctx));
+    talloc_free(test_ctx);
+    test_multidom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, domains);
+    assert_true(leak_check_teardown());
+    return 0;
+}
+
+/* Returns the UIDs of the page in _uids, terminated by 0. */
+static errno_t test_list_page(struct ifp_list_page_test_ctx *test_ctx,
+                              TALLOC_CTX *mem_ctx,
+                              const char *cursor,
+                              uint32_t page_size,
+                              char **_next_cursor,
+                              uint32_t **_uids)
+{
+    const char *whitelist[] = { "name", NULL };
+    const char *req_attrs[] = { NULL };
+    DBusMessage *message;
+    DBusMessageIter iter;
+    DBusMessageIter iter_array;
+    DBusMessageIter iter_entry;
+    const char *next_cursor;
+    const char *path;
+    uint32_t *uids;
+    size_t num = 0;
+    errno_t ret;
+
+    message = dbus_message_new(DBUS_MESSAGE_TYPE_METHOD_CALL);
+    assert_non_null(message);
+
+    dbus_message_iter_init_append(message, &iter);
+    ret = ifp_list_page_write_reply(test_ctx->ifp_ctx,
+                                    sysdb_search_users_stream,
+                                    test_list_page_path, whitelist, "*",
+                                    cursor, page_size, req_attrs, &iter);
+    if (ret != EOK) {
+        dbus_message_unref(message);
+        return ret;
+    }
+
+    uids = talloc_zero_array(mem_ctx, uint32_t, 1);
+    assert_non_null(uids);
+
+    dbus_message_iter_init(message, &iter);
+    assert_int_equal(dbus_message_iter_get_arg_type(&iter), DBUS_TYPE_STRING);
+    dbus_message_iter_get_basic(&iter, &next_cursor);
+    *_next_cursor = talloc_strdup(mem_ctx, next_cursor);
+    assert_non_null(*_next_cursor);
+
+    assert_true(dbus_message_iter_next(&iter));
+    assert_int_equal(dbus_message_iter_get_arg_type(&iter), DBUS_TYPE_ARRAY);
+    dbus_message_iter_recurse(&iter, &iter_array);
+    while (dbus_message_iter_get_arg_type(&iter_array)
+               == DBUS_TYPE_DICT_ENTRY) {
+        dbus_message_iter_recurse(&iter_array, &iter_entry);
+        dbus_message_iter_get_basic(&iter_entry, &path);
+
+        uids = talloc_realloc(mem_ctx, uids, uint32_t, num + 2);
+        assert_non_null(uids);
+        assert_int_equal(sscanf(path, "/test/%"SCNu32, &uids[num]), 1);
+        uids[++num] = 0;
+
+        dbus_message_iter_next(&iter_array);
+    }
+
+    dbus_message_unref(message);
+    *_uids = uids;
+    return EOK;
+}
+
+static void assert_uids_equal(uint32_t *uids, uint32_t *expected)
+{
+    size_t i;
+
+    for (i = 0; expected[i] != 0; i++) {
+        assert_int_equal(uids[i], expected[i]);
+    }
+    assert_int_equal(uids[i], 0);
+}
+
+/* Walks all pages and checks that each entry is listed exactly once, in
+ * domain and then name order, whatever the page size. */
+void test_list_page_boundary(void **state)
+{
+    struct ifp_list_page_test_ctx *test_ctx;
+    uint32_t expected[] = { 1001, 1002, 1003, 1004, 1005, 0 };
+    uint32_t all[6];
+    uint32_t *uids;
+    char *cursor;
+    char *next_cursor;
+    uint32_t page_size;
+    size_t num;
+    size_t num_pages;
+    size_t i;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ifp_list_page_test_ctx);
+
+    for (page_size = 1; page_size <= 6; page_size++) {
+        num = 0;
+        num_pages = 0;
+        cursor = NULL;
+        do {
+            ret = test_list_page(test_ctx, test_ctx, cursor, page_size,
+                                 &next_cursor, &uids);
+            assert_int_equal(ret, EOK);
+            talloc_free(cursor);
+            cursor = next_cursor;
+            num_pages++;
+            assert_true(num_pages <= 5);
+
+            for (i = 0; uids[i] != 0; i++) {
+                assert_true(i < page_size);
+                assert_true(num < 5);
+                all[num++] = uids[i];
+            }
+            all[num] = 0;
+            talloc_free(uids);
+
+            /* a page that is not full is the last one */
+            if (i < page_size && i != 0) {
+                assert_string_equal(cursor, "");
+            }
+        } while (cursor[0] != '\0');
+        talloc_free(cursor);
+
+        assert_uids_equal(all, expected);
+    }
+
+    /* the cursor is the internal name of the last entry */
+    ret = test_list_page(test_ctx, test_ctx, NULL, 3, &cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(cursor, "user3@"TEST_DOM_A);
+    talloc_free(cursor);
+    talloc_free(uids);
+}
+
+/* The cursor does not have to exist anymore, the next page starts after
+ * its name. */
+void test_list_page_cache_change(void **state)
+{
+    struct ifp_list_page_test_ctx *test_ctx;
+    uint32_t first[] = { 1001, 1002, 0 };
+    uint32_t second[] = { 1010, 1003, 0 };
+    uint32_t third[] = { 1004, 0 };
+    uint32_t *uids;
+    char *cursor;
+    char *next_cursor;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ifp_list_page_test_ctx);
+
+    ret = test_list_page(test_ctx, test_ctx, NULL, 2, &cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_uids_equal(uids, first);
+    assert_string_equal(cursor, "user2@"TEST_DOM_A);
+    talloc_free(uids);
+
+    /* The cursor entry and one before it are removed, an entry before the
+     * cursor and one after it are added. */
+    test_list_page_del_user(test_ctx->dom_a, "user2", 1002);
+    test_list_page_del_user(test_ctx->dom_a, "user1", 1001);
+    test_list_page_add_user(test_ctx->dom_a, "user0", 1000);
+    test_list_page_add_user(test_ctx->dom_a, "user2b", 1010);
+
+    ret = test_list_page(test_ctx, test_ctx, cursor, 2, &next_cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_uids_equal(uids, second);
+    talloc_free(uids);
+    talloc_free(cursor);
+    cursor = next_cursor;
+
+    /* user5 is removed before its page is read */
+    test_list_page_del_user(test_ctx->dom_b, "user5", 1005);
+
+    ret = test_list_page(test_ctx, test_ctx, cursor, 2, &next_cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_uids_equal(uids, third);
+    assert_string_equal(next_cursor, "");
+    talloc_free(uids);
+    talloc_free(cursor);
+    talloc_free(next_cursor);
+
+    /* a cursor that is not an internal name or of an unknown domain */
+    ret = test_list_page(test_ctx, test_ctx, "user1", 2, &cursor, &uids);
+    assert_int_equal(ret, EINVAL);
+    ret = test_list_page(test_ctx, test_ctx, "user1@unknown", 2,
+                         &cursor, &uids);
+    assert_int_equal(ret, ERR_DOMAIN_NOT_FOUND);
+}
+
+void test_list_page_limits(void **state)
+{
+    struct ifp_list_page_test_ctx *test_ctx;
+    uint32_t all[] = { 1001, 1002, 1003, 1004, 1005, 0 };
+    uint32_t two[] = { 1001, 1002, 0 };
+    uint32_t three[] = { 1001, 1002, 1003, 0 };
+    uint32_t *uids;
+    char *cursor;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ifp_list_page_test_ctx);
+
+    /* no limit at all, the default page size applies */
+    test_ctx->ifp_ctx->wildcard_limit = 0;
+    ret = test_list_page(test_ctx, test_ctx, NULL, 0, &cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_uids_equal(uids, all);
+    assert_string_equal(cursor, "");
+    talloc_free(uids);
+    talloc_free(cursor);
+
+    /* the page size is not allocated up front */
+    ret = test_list_page(test_ctx, test_ctx, NULL, UINT32_MAX, &cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_uids_equal(uids, all);
+    assert_string_equal(cursor, "");
+    talloc_free(uids);
+    talloc_free(cursor);
+
+    /* wildcard_limit is used for a zero page size and caps larger ones */
+    test_ctx->ifp_ctx->wildcard_limit = 2;
+    ret = test_list_page(test_ctx, test_ctx, NULL, 0, &cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_uids_equal(uids, two);
+    assert_string_equal(cursor, "user2@"TEST_DOM_A);
+    talloc_free(uids);
+    talloc_free(cursor);
+
+    test_ctx->ifp_ctx->wildcard_limit = 3;
+    ret = test_list_page(test_ctx, test_ctx, NULL, UINT32_MAX, &cursor, &uids);
+    assert_int_equal(ret, EOK);
+    assert_uids_equal(uids, three);
+    assert_string_equal(cursor, "user3@"TEST_DOM_A);
+    talloc_free(uids);
+    talloc_free(cursor);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -279,6 +618,15 @@ int main(int argc, const char *argv[])
         cmocka_unit_test(test_attr_acl),
         cmocka_unit_test(test_attr_acl_ex),
         cmocka_unit_test(test_attr_allowed),
+        cmocka_unit_test_setup_teardown(test_list_page_boundary,
+                                        test_list_page_setup,
+                                        test_list_page_teardown),
+        cmocka_unit_test_setup_teardown(test_list_page_cache_change,
+                                        test_list_page_setup,
+                                        test_list_page_teardown),
+        cmocka_unit_test_setup_teardown(test_list_page_limits,
+                                        test_list_page_setup,
+                                        test_list_page_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -301,6 +649,7 @@ int main(int argc, const char *argv[])
     /* Even though normally the tests should clean up after themselves
      * they might not after a failed run. Remove the old DB to be sure */
     tests_set_cwd();
+    test_multidom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, domains);
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -36,6 +36,7 @@ struct inotify_test_ctx {
     char *dirname;
 
     int ncb;
+    int npending;
     int threshold;
     /* if the cb receives flags not in this set, test fails */
     uint32_t exp_flags;
@@ -533,6 +534,99 @@ static void test_inotify_delay(void **state)
     assert_int_equal(ret, EOK);
 }
 
+static int inotify_pending_cb(const char *filename,
+                              uint32_t flags,
+                              void *pvt)
+{
+    struct inotify_test_ctx *test_ctx = talloc_get_type_abort(pvt,
+                                                struct inotify_test_ctx);
+
+    assert_string_equal(filename, test_ctx->filename);
+    test_ctx->npending++;
+    return EOK;
+}
+
+static int inotify_group_cb(const char **filenames,
+                            uint32_t flags,
+                            void *pvt)
+{
+    struct inotify_test_ctx *test_ctx = talloc_get_type_abort(pvt,
+                                                struct inotify_test_ctx);
+
+    assert_non_null(filenames);
+    assert_string_equal(filenames[0], test_ctx->filename);
+    assert_null(filenames[1]);
+
+    check_and_set_threshold(test_ctx, flags);
+    return EOK;
+}
+
+static void check_group_cb(struct tevent_context *ev,
+                           struct tevent_timer *te,
+                           struct timeval t,
+                           void *ptr)
+{
+    struct inotify_test_ctx *test_ctx = talloc_get_type_abort(ptr,
+                                                struct inotify_test_ctx);
+
+    /* the three writes were caught as one burst */
+    if (test_ctx->ncb == test_ctx->threshold && test_ctx->npending == 1) {
+        test_ctx->tctx->done = true;
+        return;
+    }
+
+    fail();
+}
+
+static void test_inotify_group(void **state)
+{
+    struct inotify_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct inotify_test_ctx);
+    struct snotify_group *group;
+    struct timeval tv;
+    struct tevent_timer *te;
+    errno_t ret;
+    struct timeval quiet = { .tv_sec = 0, .tv_usec = 300000 };
+    struct timeval max_wait = { .tv_sec = 3, .tv_usec = 0 };
+    int i;
+
+    test_ctx->threshold = 1;
+    test_ctx->exp_flags = IN_CREATE | IN_CLOSE_WRITE;
+
+    group = snotify_group_create(test_ctx, test_ctx->tctx->ev,
+                                 &quiet, &max_wait, inotify_pending_cb,
+                                 inotify_group_cb, test_ctx);
+    assert_non_null(group);
+
+    ret = snotify_group_add(group, SNOTIFY_WATCH_DIR, test_ctx->filename,
+                            IN_CREATE | IN_CLOSE_WRITE);
+    assert_int_equal(ret, EOK);
+
+    /* writes closer to each other than the quiet period */
+    for (i = 1; i <= 3; i++) {
+        tv = tevent_timeval_current_ofs(0, i * 100000);
+        te = tevent_add_timer(test_ctx->tctx->ev, test_ctx,
+                              tv, file_mod_op, test_ctx);
+        if (te == NULL) {
+            DEBUG(SSSDBG_FATAL_FAILURE, "Unable to queue file update!\n");
+            return;
+        }
+    }
+
+    tv = tevent_timeval_current_ofs(2, 0);
+    te = tevent_add_timer(test_ctx->tctx->ev, test_ctx,
+                          tv, check_group_cb, test_ctx);
+    if (te == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to queue file update!\n");
+        return;
+    }
+
+    ret = test_ev_loop(test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    talloc_free(group);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -559,6 +653,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_inotify_delay,
                                         inotify_test_dir_setup,
                                         inotify_test_dir_teardown),
+        cmocka_unit_test_setup_teardown(test_inotify_group,
+                                        inotify_test_dir_setup,
+                                        inotify_test_dir_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -184,11 +184,109 @@ static void test_sss_iobuf_write(void **state)
     talloc_zfree(rb);
 }
 
+static void test_sss_iobuf_view(void **state)
+{
+    uint8_t buffer[] = { 0, 0, 0, 0, 'a', 'b', 'c', 0, 'x', 'y', 0 };
+    struct sss_iobuf *view;
+    struct sss_iobuf *blob;
+    const uint8_t *data;
+    const char *str;
+    uint32_t len = 4;
+    size_t c = 0;
+    size_t dlen;
+    errno_t ret;
+
+    SAFEALIGN_SETMEM_UINT32(buffer, len, &c);
+
+    view = sss_iobuf_init_view(NULL, buffer, sizeof(buffer));
+    assert_non_null(view);
+    /* The data is not copied */
+    assert_ptr_equal(sss_iobuf_get_data(view), buffer);
+
+    ret = sss_iobuf_read_varlen_view(view, &data, &dlen);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(dlen, 4);
+    assert_ptr_equal(data, buffer + sizeof(uint32_t));
+    assert_string_equal((const char *) data, "abc");
+
+    ret = sss_iobuf_read_stringz(view, &str);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(str, "xy");
+
+    /* Views cannot be written into */
+    ret = sss_iobuf_write_uint8(view, 1);
+    assert_int_equal(ret, EROFS);
+    ret = sss_iobuf_write_stringz(view, "x");
+    assert_int_equal(ret, EROFS);
+
+    /* A blob longer than the rest of the buffer */
+    sss_iobuf_cursor_reset(view);
+    len = 100;
+    c = 0;
+    SAFEALIGN_SETMEM_UINT32(buffer, len, &c);
+    ret = sss_iobuf_read_varlen_view(view, &data, &dlen);
+    assert_int_equal(ret, ENOBUFS);
+
+    /* An iobuf view of a blob */
+    sss_iobuf_cursor_reset(view);
+    len = 4;
+    c = 0;
+    SAFEALIGN_SETMEM_UINT32(buffer, len, &c);
+    ret = sss_iobuf_read_iobuf_view(NULL, view, &blob);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(sss_iobuf_get_size(blob), 4);
+    assert_ptr_equal(sss_iobuf_get_data(blob), buffer + sizeof(uint32_t));
+
+    ret = sss_iobuf_read_stringz(blob, &str);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(str, "abc");
+
+    talloc_free(blob);
+    talloc_free(view);
+}
+
+static void test_sss_iobuf_stringz(void **state)
+{
+    uint8_t buffer[] = { 'a', 0, 'b', 'c' };
+    struct sss_iobuf *rb;
+    struct sss_iobuf *wb;
+    const char *str;
+    errno_t ret;
+
+    rb = sss_iobuf_init_readonly(NULL, buffer, sizeof(buffer));
+    assert_non_null(rb);
+
+    ret = sss_iobuf_read_stringz(rb, &str);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(str, "a");
+
+    /* The rest is not terminated within the buffer */
+    ret = sss_iobuf_read_stringz(rb, &str);
+    assert_int_equal(ret, EINVAL);
+    talloc_free(rb);
+
+    /* Strings grow the buffer like any other write */
+    wb = sss_iobuf_init_empty(NULL, 0, 16);
+    assert_non_null(wb);
+
+    ret = sss_iobuf_write_stringz(wb, "Hello");
+    assert_int_equal(ret, EOK);
+    ret = sss_iobuf_write_stringz(wb, "world");
+    assert_int_equal(ret, EOK);
+    assert_int_equal(sss_iobuf_get_len(wb), 12);
+    ret = sss_iobuf_write_stringz(wb, "!!!!");
+    assert_int_equal(ret, ENOBUFS);
+
+    talloc_free(wb);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_sss_iobuf_read),
         cmocka_unit_test(test_sss_iobuf_write),
+        cmocka_unit_test(test_sss_iobuf_view),
+        cmocka_unit_test(test_sss_iobuf_stringz),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
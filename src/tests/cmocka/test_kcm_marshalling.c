@@ -357,6 +357,113 @@ static void test_kcm_ccache_no_princ_binary(void **state)
     assert_cc_equal(cc, cc2);
 }
 
+static void test_kcm_ccache_copy(void **state)
+{
+    struct kcm_marshalling_test_ctx *test_ctx = talloc_get_type(*state,
+                                        struct kcm_marshalling_test_ctx);
+    const char *creds[] = { TEST_CREDS"1", TEST_CREDS"2", NULL };
+    errno_t ret;
+    struct cli_creds owner;
+    struct kcm_ccache *cc;
+    struct kcm_ccache *copy;
+    struct kcm_cred *crd;
+    struct sss_iobuf *blob;
+    const char *name;
+    int i;
+
+    owner.ucred.uid = getuid();
+    owner.ucred.gid = getuid();
+
+    name = talloc_asprintf(test_ctx, "%"SPRIuid, getuid());
+    assert_non_null(name);
+
+    ret = kcm_cc_new(test_ctx,
+                     test_ctx->kctx,
+                     &owner,
+                     name,
+                     test_ctx->princ,
+                     &cc);
+    assert_int_equal(ret, EOK);
+
+    for (i = 0; creds[i] != NULL; i++) {
+        blob = sss_iobuf_init_readonly(cc, (const uint8_t *) creds[i],
+                                       strlen(creds[i]) + 1);
+        assert_non_null(blob);
+
+        ret = kcm_cc_store_cred_blob(cc, blob);
+        assert_int_equal(ret, EOK);
+    }
+
+    copy = kcm_cc_copy(test_ctx, cc);
+    assert_non_null(copy);
+    assert_cc_equal(cc, copy);
+
+    /* The copy must not share any data with the original */
+    assert_ptr_not_equal(kcm_cc_get_client_principal(cc),
+                         kcm_cc_get_client_principal(copy));
+    talloc_free(cc);
+
+    assert_string_equal(kcm_cc_get_name(copy), name);
+    assert_non_null(kcm_cc_get_client_principal(copy));
+
+    /* The credentials are copied in the same order */
+    crd = kcm_cc_get_cred(copy);
+    for (i = 1; i >= 0; i--) {
+        assert_non_null(crd);
+        blob = kcm_cred_get_creds(crd);
+        assert_string_equal((const char *) sss_iobuf_get_data(blob),
+                            creds[i]);
+        crd = kcm_cc_next_cred(crd);
+    }
+    assert_null(crd);
+
+    talloc_free(copy);
+}
+
+static void test_kcm_cred_marshall_unmarshall_binary(void **state)
+{
+    struct kcm_marshalling_test_ctx *test_ctx = talloc_get_type(*state,
+                                        struct kcm_marshalling_test_ctx);
+    errno_t ret;
+    struct kcm_cred *crd;
+    struct kcm_cred *crd2;
+    struct sss_iobuf *blob;
+    struct sss_iobuf *payload;
+    uuid_t uuid;
+    uuid_t uuid2;
+
+    blob = sss_iobuf_init_readonly(test_ctx, (const uint8_t *) TEST_CREDS,
+                                   sizeof(TEST_CREDS));
+    assert_non_null(blob);
+
+    uuid_generate(uuid);
+    crd = kcm_cred_new(test_ctx, uuid, blob);
+    assert_non_null(crd);
+
+    ret = kcm_cred_to_sec_input_binary(test_ctx, crd, &payload);
+    assert_int_equal(ret, EOK);
+
+    sss_iobuf_cursor_reset(payload);
+    ret = sec_value_to_cred_binary(test_ctx, payload, &crd2);
+    assert_int_equal(ret, EOK);
+
+    ret = kcm_cred_get_uuid(crd2, uuid2);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(uuid_compare(uuid, uuid2), 0);
+
+    blob = kcm_cred_get_creds(crd2);
+    assert_non_null(blob);
+    assert_int_equal(sss_iobuf_get_size(blob), sizeof(TEST_CREDS));
+    assert_string_equal((const char *) sss_iobuf_get_data(blob), TEST_CREDS);
+
+    /* A truncated record is rejected */
+    payload = sss_iobuf_init_readonly(test_ctx, (const uint8_t *) uuid,
+                                      sizeof(uuid_t) - 1);
+    assert_non_null(payload);
+    ret = sec_value_to_cred_binary(test_ctx, payload, &crd2);
+    assert_int_not_equal(ret, EOK);
+}
+
 void test_sec_key_get_uuid(void **state)
 {
     errno_t ret;
@@ -439,6 +546,12 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_kcm_ccache_no_princ_json,
                                         setup_kcm_marshalling,
                                         teardown_kcm_marshalling),
+        cmocka_unit_test_setup_teardown(test_kcm_cred_marshall_unmarshall_binary,
+                                        setup_kcm_marshalling,
+                                        teardown_kcm_marshalling),
+        cmocka_unit_test_setup_teardown(test_kcm_ccache_copy,
+                                        setup_kcm_marshalling,
+                                        teardown_kcm_marshalling),
         cmocka_unit_test(test_sec_key_get_uuid),
         cmocka_unit_test(test_sec_key_get_name),
         cmocka_unit_test(test_sec_key_match_name),
@@ -31,6 +31,7 @@
 #define INVALID_ID      -1
 #define FAST_REQ_ID     0
 #define SLOW_REQ_ID     1
+#define LAST_REQ_ID     2
 
 #define FAST_REQ_DELAY  1
 #define SLOW_REQ_DELAY  2
@@ -70,7 +71,8 @@ static struct tevent_req *timed_request_send(TALLOC_CTX *mem_ctx,
                                              struct kcm_ops_queue_ctx *qctx,
                                              struct cli_creds *client,
                                              int delay,
-                                             int req_id)
+                                             int req_id,
+                                             bool readonly)
 {
     struct tevent_req *req;
     struct tevent_req *subreq;
@@ -89,7 +91,7 @@ static struct tevent_req *timed_request_send(TALLOC_CTX *mem_ctx,
 
     DEBUG(SSSDBG_TRACE_ALL, "Request %p with delay %d\n", req, delay);
 
-    subreq = kcm_op_queue_send(state, ev, qctx, client);
+    subreq = kcm_op_queue_send(state, ev, qctx, client, readonly);
     if (subreq == NULL) {
         return NULL;
     }
@@ -108,7 +110,7 @@ static void timed_request_start(struct tevent_req *subreq)
                                                 struct timed_request_state);
     errno_t ret;
 
-    ret = kcm_op_queue_recv(subreq, state, &state->queue_entry);
+    ret = kcm_op_queue_recv(subreq, state, &state->queue_entry, NULL);
     talloc_zfree(subreq);
     if (ret != EOK) {
         tevent_req_error(req, ret);
@@ -252,7 +254,7 @@ static void test_kcm_queue_single(void **state)
                              test_ctx->ev,
                              test_ctx->rctx,
                              test_ctx->qctx,
-                             &client, 1, 0);
+                             &client, 1, 0, false);
     assert_non_null(req);
     tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
 
@@ -287,7 +289,8 @@ static void test_kcm_queue_multi_same_id(void **state)
                              test_ctx->qctx,
                              &client,
                              SLOW_REQ_DELAY,
-                             SLOW_REQ_ID);
+                             SLOW_REQ_ID,
+                             false);
     assert_non_null(req);
     tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
 
@@ -297,7 +300,8 @@ static void test_kcm_queue_multi_same_id(void **state)
                              test_ctx->qctx,
                              &client,
                              FAST_REQ_DELAY,
-                             FAST_REQ_ID);
+                             FAST_REQ_ID,
+                             false);
     assert_non_null(req);
     tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
 
@@ -334,7 +338,8 @@ static void test_kcm_queue_multi_different_id(void **state)
                              test_ctx->qctx,
                              &client,
                              SLOW_REQ_DELAY,
-                             SLOW_REQ_ID);
+                             SLOW_REQ_ID,
+                             false);
     assert_non_null(req);
     tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
 
@@ -347,7 +352,8 @@ static void test_kcm_queue_multi_different_id(void **state)
                              test_ctx->qctx,
                              &client,
                              FAST_REQ_DELAY,
-                             FAST_REQ_ID);
+                             FAST_REQ_ID,
+                             false);
     assert_non_null(req);
     tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
 
@@ -360,6 +366,109 @@ static void test_kcm_queue_multi_different_id(void **state)
     assert_int_equal(test_ctx->error, EOK);
 }
 
+/*
+ * Test that read-only requests from the same ID run concurrently
+ */
+static void test_kcm_queue_multi_readers(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type(*state, struct test_ctx);
+    struct tevent_req *req;
+    struct cli_creds client;
+    /* Both requests only read, so the fast one does not wait for the
+     * slow one
+     */
+    static int req_ids[] = { FAST_REQ_ID, SLOW_REQ_ID };
+
+    client.ucred.uid = getuid();
+    client.ucred.gid = getgid();
+
+    req = timed_request_send(test_ctx,
+                             test_ctx->ev,
+                             test_ctx->rctx,
+                             test_ctx->qctx,
+                             &client,
+                             SLOW_REQ_DELAY,
+                             SLOW_REQ_ID,
+                             true);
+    assert_non_null(req);
+    tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
+
+    req = timed_request_send(test_ctx,
+                             test_ctx->ev,
+                             test_ctx->rctx,
+                             test_ctx->qctx,
+                             &client,
+                             FAST_REQ_DELAY,
+                             FAST_REQ_ID,
+                             true);
+    assert_non_null(req);
+    tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
+
+    test_ctx->num_requests = 2;
+    test_ctx->req_ids = req_ids;
+
+    while (test_ctx->done == false) {
+        tevent_loop_once(test_ctx->ev);
+    }
+    assert_int_equal(test_ctx->error, EOK);
+}
+
+/*
+ * Test that a write request waits for the running readers and that
+ * a reader queued after the writer does not pass it
+ */
+static void test_kcm_queue_writer_between_readers(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type(*state, struct test_ctx);
+    struct tevent_req *req;
+    struct cli_creds client;
+    static int req_ids[] = { SLOW_REQ_ID, FAST_REQ_ID, LAST_REQ_ID };
+
+    client.ucred.uid = getuid();
+    client.ucred.gid = getgid();
+
+    req = timed_request_send(test_ctx,
+                             test_ctx->ev,
+                             test_ctx->rctx,
+                             test_ctx->qctx,
+                             &client,
+                             SLOW_REQ_DELAY,
+                             SLOW_REQ_ID,
+                             true);
+    assert_non_null(req);
+    tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
+
+    req = timed_request_send(test_ctx,
+                             test_ctx->ev,
+                             test_ctx->rctx,
+                             test_ctx->qctx,
+                             &client,
+                             FAST_REQ_DELAY,
+                             FAST_REQ_ID,
+                             false);
+    assert_non_null(req);
+    tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
+
+    req = timed_request_send(test_ctx,
+                             test_ctx->ev,
+                             test_ctx->rctx,
+                             test_ctx->qctx,
+                             &client,
+                             FAST_REQ_DELAY,
+                             LAST_REQ_ID,
+                             true);
+    assert_non_null(req);
+    tevent_req_set_callback(req, test_kcm_queue_done, test_ctx);
+
+    test_ctx->num_requests = 3;
+    test_ctx->req_ids = req_ids;
+
+    while (test_ctx->done == false) {
+        tevent_loop_once(test_ctx->ev);
+    }
+    assert_int_equal(test_ctx->error, EOK);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -381,6 +490,12 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_kcm_queue_multi_different_id,
                                         setup_kcm_queue,
                                         teardown_kcm_queue),
+        cmocka_unit_test_setup_teardown(test_kcm_queue_multi_readers,
+                                        setup_kcm_queue,
+                                        teardown_kcm_queue),
+        cmocka_unit_test_setup_teardown(test_kcm_queue_writer_between_readers,
+                                        setup_kcm_queue,
+                                        teardown_kcm_queue),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
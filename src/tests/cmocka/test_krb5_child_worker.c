@@ -0,0 +1,438 @@
+/*
+    Copyright (C) 2026 Red Hat
+
+    SSSD tests: krb5_child workers
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <talloc.h>
+#include <tevent.h>
+#include <errno.h>
+#include <popt.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <utime.h>
+#include <sys/socket.h>
+
+#include "util/util.h"
+#include "providers/krb5/krb5_common.h"
+#include "providers/krb5/krb5_opts.h"
+#include "providers/krb5/krb5_child_worker.h"
+#include "tests/cmocka/common_mock.h"
+
+/* KRB5_CHILD_DIR is set for this test and krb5_child_handler.c, the fake
+ * krb5_child there records its pid and waits to be killed. */
+#define TEST_WORKER_PIDS KRB5_CHILD_DIR"/workers"
+#define TEST_CONFIG KRB5_CHILD_DIR"/krb5.conf"
+#define TEST_REALM "WORKER.REALM"
+
+#define TEST_WAIT_STEP_US 10000
+#define TEST_WAIT_STEPS 500
+
+struct test_worker_ctx {
+    struct tevent_context *ev;
+    struct krb5_ctx *krb5_ctx;
+    int pipefd[2];
+};
+
+static void write_file(const char *path, const char *content, mode_t mode)
+{
+    FILE *f;
+
+    f = fopen(path, "w");
+    assert_non_null(f);
+    assert_int_equal(fputs(content, f) >= 0, true);
+    assert_int_equal(fclose(f), 0);
+    assert_int_equal(chmod(path, mode), 0);
+}
+
+static int read_worker_pids(pid_t *pids, int max_pids)
+{
+    FILE *f;
+    int num = 0;
+    int pid;
+
+    f = fopen(TEST_WORKER_PIDS, "r");
+    if (f == NULL) {
+        return 0;
+    }
+
+    while (num < max_pids && fscanf(f, "%d", &pid) == 1) {
+        pids[num++] = pid;
+    }
+    fclose(f);
+
+    return num;
+}
+
+/* The workers are started asynchronously, wait until num of them wrote
+ * their pid and return the last one. */
+static pid_t wait_for_workers(int num)
+{
+    pid_t pids[16];
+    int c;
+
+    for (c = 0; c < TEST_WAIT_STEPS; c++) {
+        if (read_worker_pids(pids, 16) >= num) {
+            return pids[num - 1];
+        }
+        usleep(TEST_WAIT_STEP_US);
+    }
+
+    fail_msg("Only [%d] of [%d] workers started.\n",
+             read_worker_pids(pids, 16), num);
+    return -1;
+}
+
+static int test_worker_setup(void **state)
+{
+    struct test_worker_ctx *test_ctx;
+    errno_t ret;
+
+    assert_true(leak_check_setup());
+
+    ret = mkdir(KRB5_CHILD_DIR, 0700);
+    assert_true(ret == 0 || errno == EEXIST);
+    unlink(TEST_WORKER_PIDS);
+    write_file(KRB5_CHILD_DIR"/krb5_child",
+               "#!/bin/sh\n"
+               "echo $$ >> "TEST_WORKER_PIDS"\n"
+               "exec sleep 60\n",
+               0700);
+
+    test_ctx = talloc_zero(global_talloc_context, struct test_worker_ctx);
+    assert_non_null(test_ctx);
+
+    test_ctx->ev = tevent_context_init(test_ctx);
+    assert_non_null(test_ctx->ev);
+
+    test_ctx->krb5_ctx = talloc_zero(test_ctx, struct krb5_ctx);
+    assert_non_null(test_ctx->krb5_ctx);
+
+    ret = dp_copy_defaults(test_ctx->krb5_ctx, default_krb5_opts, KRB5_OPTS,
+                           &test_ctx->krb5_ctx->opts);
+    assert_int_equal(ret, EOK);
+
+    ret = dp_opt_set_int(test_ctx->krb5_ctx->opts, KRB5_CHILD_POOL_SIZE, 1);
+    assert_int_equal(ret, EOK);
+    ret = dp_opt_set_int(test_ctx->krb5_ctx->opts,
+                         KRB5_CHILD_POOL_MAX_REQUESTS, 0);
+    assert_int_equal(ret, EOK);
+
+    ret = pipe(test_ctx->pipefd);
+    assert_int_equal(ret, 0);
+
+    *state = test_ctx;
+    return 0;
+}
+
+static int test_worker_teardown(void **state)
+{
+    struct test_worker_ctx *test_ctx = talloc_get_type(*state,
+                                                      struct test_worker_ctx);
+    pid_t pids[16];
+    int num;
+    int c;
+
+    num = read_worker_pids(pids, 16);
+    for (c = 0; c < num; c++) {
+        kill(pids[c], SIGKILL);
+    }
+
+    PIPE_CLOSE(test_ctx->pipefd);
+    talloc_free(test_ctx);
+
+    unlink(TEST_WORKER_PIDS);
+    unlink(KRB5_CHILD_DIR"/krb5_child");
+    rmdir(KRB5_CHILD_DIR);
+
+    assert_true(leak_check_teardown());
+    return 0;
+}
+
+static void pass_request(struct test_worker_ctx *test_ctx)
+{
+    errno_t ret;
+
+    ret = krb5_child_pool_pass_fds(test_ctx->krb5_ctx, test_ctx->ev,
+                                   test_ctx->pipefd[0], test_ctx->pipefd[1]);
+    assert_int_equal(ret, EOK);
+}
+
+void test_fd_passing(void **state)
+{
+    int sv[2];
+    int pipe_in[2];
+    int pipe_out[2];
+    int in_fd = -1;
+    int out_fd = -1;
+    char c;
+    errno_t ret;
+
+    ret = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert_int_equal(ret, 0);
+    ret = pipe(pipe_in);
+    assert_int_equal(ret, 0);
+    ret = pipe(pipe_out);
+    assert_int_equal(ret, 0);
+
+    ret = krb5_child_worker_send_fds(sv[0], pipe_in[0], pipe_out[1]);
+    assert_int_equal(ret, EOK);
+    PIPE_FD_CLOSE(pipe_in[0]);
+    PIPE_FD_CLOSE(pipe_out[1]);
+
+    ret = krb5_child_worker_recv_fds(sv[1], &in_fd, &out_fd);
+    assert_int_equal(ret, EOK);
+
+    /* the request processes must not pass them on */
+    assert_true(fcntl(in_fd, F_GETFD) & FD_CLOEXEC);
+    assert_true(fcntl(out_fd, F_GETFD) & FD_CLOEXEC);
+
+    /* the received descriptors are the ends of the pipes */
+    assert_int_equal(write(pipe_in[1], "i", 1), 1);
+    assert_int_equal(read(in_fd, &c, 1), 1);
+    assert_int_equal(c, 'i');
+
+    assert_int_equal(write(out_fd, "o", 1), 1);
+    assert_int_equal(read(pipe_out[0], &c, 1), 1);
+    assert_int_equal(c, 'o');
+
+    /* a closed socket retires the worker */
+    close(sv[0]);
+    ret = krb5_child_worker_recv_fds(sv[1], &in_fd, &out_fd);
+    assert_int_equal(ret, ENOTCONN);
+
+    close(sv[1]);
+    close(in_fd);
+    close(out_fd);
+    PIPE_FD_CLOSE(pipe_in[1]);
+    PIPE_FD_CLOSE(pipe_out[0]);
+}
+
+void test_request_state_reset(void **state)
+{
+    krb5_context ctx;
+    krb5_error_code kerr;
+    char **env;
+    char *realm;
+    errno_t ret;
+
+    ret = mkdir(KRB5_CHILD_DIR, 0700);
+    assert_true(ret == 0 || errno == EEXIST);
+    write_file(TEST_CONFIG,
+               "[libdefaults]\n"
+               "  default_realm = "TEST_REALM"\n",
+               0600);
+
+    assert_int_equal(setenv("KRB5_CONFIG", TEST_CONFIG, 1), 0);
+    assert_int_equal(setenv("TEST_WORKER_VAR", "worker", 1), 0);
+    assert_int_equal(unsetenv("KRB5CCNAME"), 0);
+
+    ret = krb5_child_worker_save_env(global_talloc_context, &env);
+    assert_int_equal(ret, EOK);
+
+    kerr = krb5_init_context(&ctx);
+    assert_int_equal(kerr, 0);
+
+    /* what an earlier request might have left behind */
+    assert_int_equal(setenv("TEST_WORKER_VAR", "request", 1), 0);
+    assert_int_equal(setenv("TEST_REQUEST_VAR", "request", 1), 0);
+    assert_int_equal(setenv("KRB5CCNAME", "FILE:/tmp/request", 1), 0);
+    kerr = krb5_cc_set_default_name(ctx, "FILE:/tmp/previous");
+    assert_int_equal(kerr, 0);
+    kerr = krb5_set_default_realm(ctx, "PREVIOUS.REALM");
+    assert_int_equal(kerr, 0);
+
+    ret = krb5_child_worker_reset_request(ctx, env);
+    assert_int_equal(ret, EOK);
+
+    assert_string_equal(getenv("TEST_WORKER_VAR"), "worker");
+    assert_null(getenv("TEST_REQUEST_VAR"));
+    assert_null(getenv("KRB5CCNAME"));
+    assert_string_not_equal(krb5_cc_default_name(ctx), "FILE:/tmp/previous");
+
+    kerr = krb5_get_default_realm(ctx, &realm);
+    assert_int_equal(kerr, 0);
+    assert_string_equal(realm, TEST_REALM);
+    krb5_free_default_realm(ctx, realm);
+
+    krb5_free_context(ctx);
+    /* env is the environment now */
+    unsetenv("TEST_WORKER_VAR");
+    unsetenv("KRB5_CONFIG");
+    unlink(TEST_CONFIG);
+    rmdir(KRB5_CHILD_DIR);
+}
+
+void test_config_mtime(void **state)
+{
+    struct utimbuf times;
+    time_t mtime;
+    errno_t ret;
+
+    ret = mkdir(KRB5_CHILD_DIR, 0700);
+    assert_true(ret == 0 || errno == EEXIST);
+    assert_int_equal(setenv("KRB5_CONFIG", TEST_CONFIG, 1), 0);
+
+    /* no configuration at all */
+    unlink(TEST_CONFIG);
+    ret = krb5_child_worker_config_mtime(&mtime);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(mtime, 0);
+
+    write_file(TEST_CONFIG, "[libdefaults]\n", 0600);
+    times.actime = 1000;
+    times.modtime = 1000;
+    assert_int_equal(utime(TEST_CONFIG, &times), 0);
+
+    ret = krb5_child_worker_config_mtime(&mtime);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(mtime, 1000);
+
+    /* e.g. the domain mappings were written */
+    times.modtime = 2000;
+    assert_int_equal(utime(TEST_CONFIG, &times), 0);
+
+    ret = krb5_child_worker_config_mtime(&mtime);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(mtime, 2000);
+
+    unsetenv("KRB5_CONFIG");
+    unlink(TEST_CONFIG);
+    rmdir(KRB5_CHILD_DIR);
+}
+
+void test_pool_respawn(void **state)
+{
+    struct test_worker_ctx *test_ctx = talloc_get_type(*state,
+                                                      struct test_worker_ctx);
+    pid_t first;
+    pid_t second;
+    int c;
+
+    pass_request(test_ctx);
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 1);
+    first = wait_for_workers(1);
+
+    /* the pool is full, the same worker serves the next request */
+    pass_request(test_ctx);
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 1);
+
+    /* the worker crashes */
+    assert_int_equal(kill(first, SIGKILL), 0);
+    for (c = 0; c < TEST_WAIT_STEPS
+            && krb5_child_pool_num_workers(test_ctx->krb5_ctx) > 0; c++) {
+        tevent_loop_once(test_ctx->ev);
+    }
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 0);
+
+    /* and is replaced with the next request */
+    pass_request(test_ctx);
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 1);
+    second = wait_for_workers(2);
+    assert_int_not_equal(first, second);
+}
+
+void test_pool_max_requests(void **state)
+{
+    struct test_worker_ctx *test_ctx = talloc_get_type(*state,
+                                                      struct test_worker_ctx);
+    pid_t pids[16];
+    errno_t ret;
+
+    ret = dp_opt_set_int(test_ctx->krb5_ctx->opts,
+                         KRB5_CHILD_POOL_MAX_REQUESTS, 2);
+    assert_int_equal(ret, EOK);
+
+    pass_request(test_ctx);
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 1);
+    pass_request(test_ctx);
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 0);
+    wait_for_workers(1);
+
+    pass_request(test_ctx);
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 1);
+    wait_for_workers(2);
+    assert_int_equal(read_worker_pids(pids, 16), 2);
+}
+
+void test_pool_config_change(void **state)
+{
+    struct test_worker_ctx *test_ctx = talloc_get_type(*state,
+                                                      struct test_worker_ctx);
+    pid_t pids[16];
+
+    pass_request(test_ctx);
+    pass_request(test_ctx);
+    wait_for_workers(1);
+
+    test_ctx->krb5_ctx->realm = discard_const(TEST_REALM);
+
+    pass_request(test_ctx);
+    assert_int_equal(krb5_child_pool_num_workers(test_ctx->krb5_ctx), 1);
+    wait_for_workers(2);
+
+    /* the new worker keeps serving while the options stay the same */
+    pass_request(test_ctx);
+    assert_int_equal(read_worker_pids(pids, 16), 2);
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_fd_passing),
+        cmocka_unit_test(test_request_state_reset),
+        cmocka_unit_test(test_config_mtime),
+        cmocka_unit_test_setup_teardown(test_pool_respawn,
+                                        test_worker_setup,
+                                        test_worker_teardown),
+        cmocka_unit_test_setup_teardown(test_pool_max_requests,
+                                        test_worker_setup,
+                                        test_worker_teardown),
+        cmocka_unit_test_setup_teardown(test_pool_config_change,
+                                        test_worker_setup,
+                                        test_worker_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    tests_set_cwd();
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
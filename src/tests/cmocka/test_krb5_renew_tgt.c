@@ -0,0 +1,384 @@
+/*
+    SSSD
+
+    Unit tests for the scheduling of the TGT renewals
+
+    Copyright (C) 2026 Red Hat
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <talloc.h>
+#include <tevent.h>
+#include <errno.h>
+#include <popt.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "providers/backend.h"
+
+#include "providers/krb5/krb5_renew_tgt.c"
+
+#define TEST_RENEW_INTERVAL 300
+
+struct renew_test_ctx {
+    struct tevent_context *ev;
+    struct be_ctx *be_ctx;
+    struct renew_tgt_ctx *renew_tgt_ctx;
+    size_t calls;
+};
+
+static struct renew_test_ctx *global_test_ctx;
+
+/* The renewals fail, so that they are put back for another attempt. */
+struct tevent_req *__wrap_krb5_auth_queue_send(TALLOC_CTX *mem_ctx,
+                                               struct tevent_context *ev,
+                                               struct be_ctx *be_ctx,
+                                               struct pam_data *pd,
+                                               struct krb5_ctx *krb5_ctx)
+{
+    struct tevent_req *req;
+    const char *user = pd->user;
+    void *state;
+
+    check_expected(user);
+    global_test_ctx->calls++;
+
+    req = tevent_req_create(mem_ctx, &state, void *);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    tevent_req_error(req, EIO);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+int __wrap_krb5_auth_queue_recv(struct tevent_req *req,
+                                int *_pam_status,
+                                int *_dp_err)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+    return EOK;
+}
+
+static int test_renew_setup(void **state)
+{
+    struct renew_test_ctx *test_ctx;
+
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context, struct renew_test_ctx);
+    assert_non_null(test_ctx);
+
+    test_ctx->ev = tevent_context_init(test_ctx);
+    assert_non_null(test_ctx->ev);
+
+    test_ctx->be_ctx = talloc_zero(test_ctx, struct be_ctx);
+    assert_non_null(test_ctx->be_ctx);
+    test_ctx->be_ctx->ev = test_ctx->ev;
+
+    test_ctx->renew_tgt_ctx = talloc_zero(test_ctx, struct renew_tgt_ctx);
+    assert_non_null(test_ctx->renew_tgt_ctx);
+    talloc_set_destructor(test_ctx->renew_tgt_ctx, renew_tgt_ctx_destructor);
+    test_ctx->renew_tgt_ctx->be_ctx = test_ctx->be_ctx;
+    test_ctx->renew_tgt_ctx->ev = test_ctx->ev;
+    test_ctx->renew_tgt_ctx->timer_interval = TEST_RENEW_INTERVAL;
+
+    global_test_ctx = test_ctx;
+    *state = test_ctx;
+    return 0;
+}
+
+static int test_renew_teardown(void **state)
+{
+    struct renew_test_ctx *test_ctx;
+
+    test_ctx = talloc_get_type_abort(*state, struct renew_test_ctx);
+
+    global_test_ctx = NULL;
+    talloc_free(test_ctx);
+    assert_true(leak_check_teardown());
+    return 0;
+}
+
+static struct renew_data *test_item(struct renew_tgt_ctx *renew_tgt_ctx,
+                                    size_t num, time_t start_renew_at)
+{
+    struct renew_data *renew_data;
+
+    renew_data = talloc_zero(renew_tgt_ctx, struct renew_data);
+    assert_non_null(renew_data);
+    renew_data->renew_tgt_ctx = renew_tgt_ctx;
+    renew_data->heap_idx = RENEW_HEAP_NONE;
+    talloc_set_destructor(renew_data, renew_data_destructor);
+
+    renew_data->upn = talloc_asprintf(renew_data, "user%zu@EXAMPLE.COM", num);
+    assert_non_null(renew_data->upn);
+    renew_data->ccfile = talloc_asprintf(renew_data, "FILE:/tmp/krb5cc_%zu",
+                                         num);
+    assert_non_null(renew_data->ccfile);
+    renew_data->start_renew_at = start_renew_at;
+
+    renew_data->pd = talloc_zero(renew_data, struct pam_data);
+    assert_non_null(renew_data->pd);
+    renew_data->pd->user = talloc_asprintf(renew_data->pd, "user%zu", num);
+    assert_non_null(renew_data->pd->user);
+
+    return renew_data;
+}
+
+/* Checks the heap order and the back references of the items. */
+static void assert_heap(struct renew_tgt_ctx *renew_tgt_ctx)
+{
+    size_t c;
+
+    for (c = 0; c < renew_tgt_ctx->heap_len; c++) {
+        assert_int_equal(renew_tgt_ctx->heap[c]->heap_idx, c);
+        if (c > 0) {
+            assert_true(renew_tgt_ctx->heap[(c - 1) / 2]->start_renew_at
+                            <= renew_tgt_ctx->heap[c]->start_renew_at);
+        }
+    }
+}
+
+static int cmp_time(const void *a, const void *b)
+{
+    time_t ta = *(const time_t *)a;
+    time_t tb = *(const time_t *)b;
+
+    return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+/* Pops all items and checks that they come in the order of the sorted
+ * times. */
+static void assert_pop_order(struct renew_tgt_ctx *renew_tgt_ctx,
+                             time_t *times, size_t num_times)
+{
+    struct renew_data *renew_data;
+    size_t c;
+
+    qsort(times, num_times, sizeof(time_t), cmp_time);
+
+    assert_int_equal(renew_tgt_ctx->heap_len, num_times);
+    for (c = 0; c < num_times; c++) {
+        renew_data = renew_tgt_ctx->heap[0];
+        assert_int_equal(renew_data->start_renew_at, times[c]);
+
+        renew_heap_remove(renew_tgt_ctx, renew_data);
+        assert_int_equal(renew_data->heap_idx, RENEW_HEAP_NONE);
+        assert_heap(renew_tgt_ctx);
+        talloc_free(renew_data);
+    }
+    assert_int_equal(renew_tgt_ctx->heap_len, 0);
+}
+
+static void test_renew_heap_insert(void **state)
+{
+    struct renew_test_ctx *test_ctx;
+    struct renew_tgt_ctx *renew_tgt_ctx;
+    struct renew_data *renew_data;
+    /* more than the initial size of the heap */
+    time_t times[150];
+    time_t min = 0;
+    size_t c;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct renew_test_ctx);
+    renew_tgt_ctx = test_ctx->renew_tgt_ctx;
+
+    for (c = 0; c < N_ELEMENTS(times); c++) {
+        /* not sorted and with duplicates */
+        times[c] = 1000 + (c * 37) % 101;
+
+        renew_data = test_item(renew_tgt_ctx, c, times[c]);
+        ret = renew_heap_insert(renew_tgt_ctx, renew_data);
+        assert_int_equal(ret, EOK);
+
+        if (c == 0 || times[c] < min) {
+            min = times[c];
+        }
+        assert_int_equal(renew_tgt_ctx->heap_len, c + 1);
+        assert_int_equal(renew_tgt_ctx->heap[0]->start_renew_at, min);
+        assert_heap(renew_tgt_ctx);
+    }
+    assert_true(renew_tgt_ctx->heap_size >= N_ELEMENTS(times));
+
+    assert_pop_order(renew_tgt_ctx, times, N_ELEMENTS(times));
+}
+
+static void test_renew_heap_remove(void **state)
+{
+    struct renew_test_ctx *test_ctx;
+    struct renew_tgt_ctx *renew_tgt_ctx;
+    struct renew_data *items[40];
+    time_t times[N_ELEMENTS(items)];
+    size_t num_times = 0;
+    size_t c;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct renew_test_ctx);
+    renew_tgt_ctx = test_ctx->renew_tgt_ctx;
+
+    for (c = 0; c < N_ELEMENTS(items); c++) {
+        items[c] = test_item(renew_tgt_ctx, c, 5000 - (c * 13) % 41);
+        ret = renew_heap_insert(renew_tgt_ctx, items[c]);
+        assert_int_equal(ret, EOK);
+    }
+
+    /* Items are removed from the middle of the heap when they are freed,
+     * e.g. when a new TGT of the user replaces them in the table */
+    for (c = 0; c < N_ELEMENTS(items); c++) {
+        if (c % 3 == 0) {
+            talloc_free(items[c]);
+            assert_heap(renew_tgt_ctx);
+        } else {
+            times[num_times++] = items[c]->start_renew_at;
+        }
+    }
+
+    /* Removing an item which is not in the heap does nothing */
+    renew_heap_remove(renew_tgt_ctx, items[1]);
+    renew_heap_remove(renew_tgt_ctx, items[1]);
+    assert_int_equal(renew_tgt_ctx->heap_len, num_times - 1);
+    assert_heap(renew_tgt_ctx);
+
+    ret = renew_heap_insert(renew_tgt_ctx, items[1]);
+    assert_int_equal(ret, EOK);
+    assert_heap(renew_tgt_ctx);
+
+    assert_pop_order(renew_tgt_ctx, times, num_times);
+}
+
+static void test_renew_reschedule(void **state)
+{
+    struct renew_test_ctx *test_ctx;
+    struct renew_tgt_ctx *renew_tgt_ctx;
+    struct renew_data *renew_data;
+    /* RENEW_MAX_RUNNING + 2 due and 3 later renewals */
+    const size_t num_due = RENEW_MAX_RUNNING + 2;
+    const size_t num_later = 3;
+    char user[32];
+    time_t now;
+    size_t c;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct renew_test_ctx);
+    renew_tgt_ctx = test_ctx->renew_tgt_ctx;
+    now = time(NULL);
+
+    /* user<n> is due n seconds after user0, they are inserted backwards */
+    for (c = num_due + num_later; c > 0; c--) {
+        if (c - 1 < num_due) {
+            renew_data = test_item(renew_tgt_ctx, c - 1,
+                                   now - 100 + (c - 1));
+        } else {
+            renew_data = test_item(renew_tgt_ctx, c - 1,
+                                   now + 10 * TEST_RENEW_INTERVAL);
+        }
+        ret = renew_heap_insert(renew_tgt_ctx, renew_data);
+        assert_int_equal(ret, EOK);
+    }
+
+    /* No timer while offline */
+    test_ctx->be_ctx->offline = true;
+    renew_tgt_schedule(renew_tgt_ctx);
+    assert_null(renew_tgt_ctx->te);
+
+    test_ctx->be_ctx->offline = false;
+    renew_tgt_schedule(renew_tgt_ctx);
+    assert_non_null(renew_tgt_ctx->te);
+
+    /* The earliest renewals are started first, RENEW_MAX_RUNNING at most */
+    for (c = 0; c < num_due; c++) {
+        snprintf(user, sizeof(user), "user%zu", c);
+        expect_string(__wrap_krb5_auth_queue_send, user, user);
+    }
+
+    tevent_loop_once(test_ctx->ev);
+    assert_int_equal(test_ctx->calls, RENEW_MAX_RUNNING);
+    assert_int_equal(renew_tgt_ctx->running, RENEW_MAX_RUNNING);
+    assert_int_equal(renew_tgt_ctx->heap_len,
+                     num_due + num_later - RENEW_MAX_RUNNING);
+    assert_string_equal(renew_tgt_ctx->heap[0]->upn, "user10@EXAMPLE.COM");
+    /* rescheduled once a running renewal is finished */
+    assert_null(renew_tgt_ctx->te);
+
+    /* The remaining due renewals start when the running ones finish */
+    for (c = 0; c < 100; c++) {
+        if (test_ctx->calls == num_due && renew_tgt_ctx->running == 0) {
+            break;
+        }
+        tevent_loop_once(test_ctx->ev);
+    }
+    assert_int_equal(test_ctx->calls, num_due);
+    assert_int_equal(renew_tgt_ctx->running, 0);
+
+    /* The failed renewals are retried after the renew interval, before the
+     * later ones */
+    assert_int_equal(renew_tgt_ctx->heap_len, num_due + num_later);
+    assert_heap(renew_tgt_ctx);
+    for (c = 0; c < renew_tgt_ctx->heap_len; c++) {
+        renew_data = renew_tgt_ctx->heap[c];
+        assert_non_null(renew_data->pd);
+        if (renew_data->start_renew_at < now + 10 * TEST_RENEW_INTERVAL) {
+            assert_true(renew_data->start_renew_at
+                            >= now + TEST_RENEW_INTERVAL);
+        }
+    }
+    assert_true(renew_tgt_ctx->heap[0]->start_renew_at
+                    < now + 10 * TEST_RENEW_INTERVAL);
+    assert_non_null(renew_tgt_ctx->te);
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_renew_heap_insert,
+                                        test_renew_setup,
+                                        test_renew_teardown),
+        cmocka_unit_test_setup_teardown(test_renew_heap_remove,
+                                        test_renew_setup,
+                                        test_renew_teardown),
+        cmocka_unit_test_setup_teardown(test_renew_reschedule,
+                                        test_renew_setup,
+                                        test_renew_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
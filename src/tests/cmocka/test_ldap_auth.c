@@ -29,6 +29,8 @@
 #include <cmocka.h>
 
 #include "tests/common_check.h"
+#include "providers/ldap/ldap_common.h"
+#include "providers/ldap/ldap_opts.h"
 #include "providers/ldap/ldap_auth.h"
 #include "tests/cmocka/test_expire_common.h"
 
@@ -90,12 +92,80 @@ static void test_pwexpire_krb(void **state)
     assert_int_equal(ret, ERR_PASSWORD_EXPIRED);
 }
 
+static struct sdap_handle *test_conn(TALLOC_CTX *mem_ctx, time_t expire_time)
+{
+    struct sdap_handle *sh;
+
+    sh = talloc_zero(mem_ctx, struct sdap_handle);
+    assert_non_null(sh);
+    sh->connected = true;
+    sh->expire_time = expire_time;
+
+    return sh;
+}
+
+static void test_auth_conn_pool(void **state)
+{
+    struct sdap_auth_ctx *ctx;
+    struct sdap_handle *sh1;
+    struct sdap_handle *sh2;
+    struct sdap_handle *sh3;
+    struct sdap_handle *sh;
+    time_t later = time(NULL) + 600;
+    errno_t ret;
+
+    ctx = talloc_zero(NULL, struct sdap_auth_ctx);
+    assert_non_null(ctx);
+    ctx->opts = talloc_zero(ctx, struct sdap_options);
+    assert_non_null(ctx->opts);
+
+    ret = dp_copy_defaults(ctx->opts, default_basic_opts, SDAP_OPTS_BASIC,
+                           &ctx->opts->basic);
+    assert_int_equal(ret, EOK);
+
+    /* nothing is kept by default */
+    sdap_auth_conn_put(ctx, test_conn(ctx, later));
+    assert_int_equal(ctx->num_idle_conns, 0);
+    assert_null(sdap_auth_conn_get(ctx, ctx));
+
+    ret = dp_opt_set_int(ctx->opts->basic, SDAP_AUTH_CONN_POOL_SIZE, 2);
+    assert_int_equal(ret, EOK);
+
+    sh1 = test_conn(ctx, later);
+    sh2 = test_conn(ctx, later);
+    sh3 = test_conn(ctx, later);
+    sdap_auth_conn_put(ctx, sh1);
+    sdap_auth_conn_put(ctx, sh2);
+    /* the pool is full */
+    sdap_auth_conn_put(ctx, sh3);
+    assert_int_equal(ctx->num_idle_conns, 2);
+
+    /* the most recently used connection comes first */
+    sh = sdap_auth_conn_get(ctx, ctx);
+    assert_ptr_equal(sh, sh2);
+    assert_int_equal(ctx->num_idle_conns, 1);
+
+    /* connections which were closed or expired are dropped */
+    sh1->connected = false;
+    sdap_auth_conn_put(ctx, test_conn(ctx, time(NULL) - 1));
+    assert_int_equal(ctx->num_idle_conns, 1);
+    assert_null(sdap_auth_conn_get(ctx, ctx));
+    assert_int_equal(ctx->num_idle_conns, 0);
+
+    sdap_auth_conn_put(ctx, sh);
+    assert_int_equal(ctx->num_idle_conns, 1);
+    assert_ptr_equal(sdap_auth_conn_get(ctx, ctx), sh);
+
+    talloc_free(ctx);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_pwexpire_krb,
                                         expire_test_setup,
                                         expire_test_teardown),
+        cmocka_unit_test(test_auth_conn_pool),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -300,6 +300,70 @@ static void test_id_cleanup_exp_group(void **state)
     assert_int_equal(ret, ENOENT);
 }
 
+static void test_id_cleanup_chunks_done(struct tevent_req *req)
+{
+    errno_t *_ret = tevent_req_callback_data(req, errno_t);
+
+    *_ret = ldap_id_cleanup_recv(req);
+    talloc_free(req);
+}
+
+/* More expired groups than fit into one transaction of the cleanup */
+static void test_id_cleanup_chunks(void **state)
+{
+    errno_t ret;
+    errno_t cleanup_ret = EAGAIN;
+    struct ldb_message *msg;
+    struct sdap_domain sdom;
+    struct tevent_req *req;
+    char *name;
+    int i;
+    const int num_groups = 120;
+    const uint64_t CACHE_TIMEOUT = 30;
+    struct sysdb_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                            struct sysdb_test_ctx);
+
+    for (i = 0; i < num_groups; i++) {
+        name = talloc_asprintf(test_ctx, "chunk_grp%d@%s", i,
+                               test_ctx->domain->name);
+        assert_non_null(name);
+
+        ret = sysdb_store_group(test_ctx->domain, name,
+                                20000 + i, NULL, CACHE_TIMEOUT, 0);
+        assert_int_equal(ret, EOK);
+
+        /* every other group stays valid */
+        if (i % 2 == 0) {
+            ret = invalidate_group(test_ctx, test_ctx->domain, name);
+            assert_int_equal(ret, EOK);
+        }
+        talloc_free(name);
+    }
+
+    sdom.dom = test_ctx->domain;
+
+    req = ldap_id_cleanup_send(test_ctx, test_ctx->ev, test_ctx->id_ctx,
+                               &sdom);
+    assert_non_null(req);
+    tevent_req_set_callback(req, test_id_cleanup_chunks_done, &cleanup_ret);
+
+    while (cleanup_ret == EAGAIN) {
+        assert_int_equal(tevent_loop_once(test_ctx->ev), 0);
+    }
+    assert_int_equal(cleanup_ret, EOK);
+
+    for (i = 0; i < num_groups; i++) {
+        name = talloc_asprintf(test_ctx, "chunk_grp%d@%s", i,
+                               test_ctx->domain->name);
+        assert_non_null(name);
+
+        ret = sysdb_search_group_by_name(test_ctx, test_ctx->domain,
+                                         name, NULL, &msg);
+        assert_int_equal(ret, i % 2 == 0 ? ENOENT : EOK);
+        talloc_free(name);
+    }
+}
+
 int main(int argc, const char *argv[])
 {
     int rv;
@@ -317,6 +381,8 @@ int main(int argc, const char *argv[])
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_id_cleanup_exp_group,
                                         test_sysdb_setup, test_sysdb_teardown),
+        cmocka_unit_test_setup_teardown(test_id_cleanup_chunks,
+                                        test_sysdb_setup, test_sysdb_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
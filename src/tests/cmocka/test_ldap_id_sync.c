@@ -0,0 +1,407 @@
+/*
+    SSSD
+
+    Tests of the LDAP Content Synchronization
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <talloc.h>
+#include <tevent.h>
+#include <errno.h>
+#include <popt.h>
+#include <lber.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "providers/backend.h"
+
+#include "providers/ldap/ldap_id_sync.c"
+
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB "test_ldap_id_sync_conf.ldb"
+#define TEST_DOM_NAME "ldap_id_sync_test"
+#define TEST_ID_PROVIDER "ldap"
+
+#define TEST_USER_NAME "sync_user"
+#define TEST_USER_UID 2001
+#define TEST_USER_DN "uid=sync_user,ou=people,dc=example,dc=com"
+#define TEST_GROUP_NAME "sync_group"
+#define TEST_GROUP_GID 3001
+#define TEST_GROUP_DN "cn=sync_group,ou=groups,dc=example,dc=com"
+
+#define TEST_COOKIE "rid=001,csn=20260101000000.000000Z#000000#000#000000"
+
+struct ldap_id_sync_test_ctx {
+    struct sss_test_ctx *tctx;
+    struct sdap_id_ctx *id_ctx;
+};
+
+void __wrap_dp_sbus_invalidate_user_memcache(struct data_provider *provider,
+                                             uid_t uid)
+{
+    check_expected(uid);
+}
+
+void __wrap_dp_sbus_invalidate_group_memcache(struct data_provider *provider,
+                                              gid_t gid)
+{
+    check_expected(gid);
+}
+
+static struct berval *test_ber_flatten(BerElement *ber)
+{
+    struct berval *bv;
+    int ret;
+
+    ret = ber_flatten(ber, &bv);
+    assert_int_equal(ret, 0);
+    ber_free(ber, 1);
+
+    return bv;
+}
+
+static struct berval *test_sync_state(int entry_state, const char *cookie)
+{
+    struct berval uuid = { 16, discard_const("0123456789abcdef") };
+    struct berval value;
+    BerElement *ber;
+    int ret;
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    assert_non_null(ber);
+
+    ret = ber_printf(ber, "{eO", entry_state, &uuid);
+    assert_int_not_equal(ret, -1);
+    if (cookie != NULL) {
+        value.bv_val = discard_const(cookie);
+        value.bv_len = strlen(cookie);
+        ret = ber_printf(ber, "O", &value);
+        assert_int_not_equal(ret, -1);
+    }
+    ret = ber_printf(ber, "N}");
+    assert_int_not_equal(ret, -1);
+
+    return test_ber_flatten(ber);
+}
+
+static struct berval *test_sync_info(ber_tag_t tag, const char *cookie,
+                                     int refresh_done)
+{
+    struct berval value;
+    BerElement *ber;
+    int ret;
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    assert_non_null(ber);
+
+    value.bv_val = discard_const(cookie);
+    value.bv_len = cookie == NULL ? 0 : strlen(cookie);
+
+    if (tag == LDAP_TAG_SYNC_NEW_COOKIE) {
+        ret = ber_printf(ber, "tO", tag, &value);
+        assert_int_not_equal(ret, -1);
+        return test_ber_flatten(ber);
+    }
+
+    ret = ber_printf(ber, "t{", tag);
+    assert_int_not_equal(ret, -1);
+    if (cookie != NULL) {
+        ret = ber_printf(ber, "O", &value);
+        assert_int_not_equal(ret, -1);
+    }
+    /* refreshDone defaults to TRUE and is left out then */
+    if (refresh_done >= 0) {
+        ret = ber_printf(ber, "b", (ber_int_t)refresh_done);
+        assert_int_not_equal(ret, -1);
+    }
+    ret = ber_printf(ber, "N}");
+    assert_int_not_equal(ret, -1);
+
+    return test_ber_flatten(ber);
+}
+
+static void assert_cookie(struct berval *cookie, const char *exp)
+{
+    if (exp == NULL) {
+        assert_null(cookie->bv_val);
+        assert_int_equal(cookie->bv_len, 0);
+        return;
+    }
+
+    assert_non_null(cookie->bv_val);
+    assert_int_equal(cookie->bv_len, strlen(exp));
+    assert_memory_equal(cookie->bv_val, exp, cookie->bv_len);
+}
+
+static int test_ldap_id_sync_setup(void **state)
+{
+    struct ldap_id_sync_test_ctx *test_ctx;
+
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context,
+                           struct ldap_id_sync_test_ctx);
+    assert_non_null(test_ctx);
+
+    test_dom_suite_setup(TESTS_PATH);
+
+    test_ctx->tctx = create_dom_test_ctx(test_ctx, TESTS_PATH, TEST_CONF_DB,
+                                         TEST_DOM_NAME, TEST_ID_PROVIDER,
+                                         NULL);
+    assert_non_null(test_ctx->tctx);
+
+    test_ctx->id_ctx = talloc_zero(test_ctx, struct sdap_id_ctx);
+    assert_non_null(test_ctx->id_ctx);
+    test_ctx->id_ctx->be = talloc_zero(test_ctx->id_ctx, struct be_ctx);
+    assert_non_null(test_ctx->id_ctx->be);
+
+    *state = test_ctx;
+    return 0;
+}
+
+static int test_ldap_id_sync_teardown(void **state)
+{
+    struct ldap_id_sync_test_ctx *test_ctx;
+
+    test_ctx = talloc_get_type_abort(*state, struct ldap_id_sync_test_ctx);
+
+    talloc_free(test_ctx);
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    assert_true(leak_check_teardown());
+    return 0;
+}
+
+static void test_ldap_sync_parse_state(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct berval cookie;
+    struct berval *value;
+    struct berval garbage = { 3, discard_const("abc") };
+    int entry_state;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    value = test_sync_state(LDAP_SYNC_MODIFY, TEST_COOKIE);
+    ret = ldap_sync_parse_state(tmp_ctx, value, &entry_state, &cookie);
+    ber_bvfree(value);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(entry_state, LDAP_SYNC_MODIFY);
+    assert_cookie(&cookie, TEST_COOKIE);
+
+    /* The cookie is optional */
+    value = test_sync_state(LDAP_SYNC_DELETE, NULL);
+    ret = ldap_sync_parse_state(tmp_ctx, value, &entry_state, &cookie);
+    ber_bvfree(value);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(entry_state, LDAP_SYNC_DELETE);
+    assert_cookie(&cookie, NULL);
+
+    ret = ldap_sync_parse_state(tmp_ctx, &garbage, &entry_state, &cookie);
+    assert_int_equal(ret, EIO);
+
+    talloc_free(tmp_ctx);
+}
+
+static void test_ldap_sync_parse_info(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct berval cookie;
+    struct berval *data;
+    bool refresh_done;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    data = test_sync_info(LDAP_TAG_SYNC_NEW_COOKIE, TEST_COOKIE, -1);
+    ret = ldap_sync_parse_info(tmp_ctx, data, &refresh_done, &cookie);
+    ber_bvfree(data);
+    assert_int_equal(ret, EOK);
+    assert_false(refresh_done);
+    assert_cookie(&cookie, TEST_COOKIE);
+
+    /* The refresh phase ends with refreshDone, which defaults to TRUE */
+    data = test_sync_info(LDAP_TAG_SYNC_REFRESH_PRESENT, TEST_COOKIE, -1);
+    ret = ldap_sync_parse_info(tmp_ctx, data, &refresh_done, &cookie);
+    ber_bvfree(data);
+    assert_int_equal(ret, EOK);
+    assert_true(refresh_done);
+    assert_cookie(&cookie, TEST_COOKIE);
+
+    data = test_sync_info(LDAP_TAG_SYNC_REFRESH_DELETE, NULL, 0);
+    ret = ldap_sync_parse_info(tmp_ctx, data, &refresh_done, &cookie);
+    ber_bvfree(data);
+    assert_int_equal(ret, EOK);
+    assert_false(refresh_done);
+    assert_cookie(&cookie, NULL);
+
+    /* Only the cookie of a syncIdSet is used */
+    data = test_sync_info(LDAP_TAG_SYNC_ID_SET, TEST_COOKIE, -1);
+    ret = ldap_sync_parse_info(tmp_ctx, data, &refresh_done, &cookie);
+    ber_bvfree(data);
+    assert_int_equal(ret, EOK);
+    assert_false(refresh_done);
+    assert_cookie(&cookie, TEST_COOKIE);
+
+    talloc_free(tmp_ctx);
+}
+
+static void test_ldap_sync_entry_changed(void **state)
+{
+    /* The initial refresh without a cookie returns the whole content */
+    assert_false(ldap_sync_entry_changed(false, false, LDAP_SYNC_ADD));
+    assert_false(ldap_sync_entry_changed(false, false, LDAP_SYNC_MODIFY));
+
+    /* Resuming from a cookie only returns changes */
+    assert_true(ldap_sync_entry_changed(true, false, LDAP_SYNC_ADD));
+    assert_true(ldap_sync_entry_changed(true, false, LDAP_SYNC_DELETE));
+
+    /* So does the persist phase */
+    assert_true(ldap_sync_entry_changed(false, true, LDAP_SYNC_MODIFY));
+    assert_true(ldap_sync_entry_changed(false, true, LDAP_SYNC_DELETE));
+    assert_false(ldap_sync_entry_changed(false, true, LDAP_SYNC_PRESENT));
+}
+
+static uint64_t get_expire(struct ldap_id_sync_test_ctx *test_ctx,
+                           const char *name, bool is_user)
+{
+    const char *attrs[] = { SYSDB_CACHE_EXPIRE, NULL };
+    struct ldb_message *msg;
+    uint64_t expire;
+    char *fqname;
+    errno_t ret;
+
+    fqname = sss_create_internal_fqname(test_ctx, name,
+                                        test_ctx->tctx->dom->name);
+    assert_non_null(fqname);
+
+    if (is_user) {
+        ret = sysdb_search_user_by_name(test_ctx, test_ctx->tctx->dom,
+                                        fqname, attrs, &msg);
+    } else {
+        ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                         fqname, attrs, &msg);
+    }
+    talloc_free(fqname);
+    assert_int_equal(ret, EOK);
+
+    expire = ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0);
+    talloc_free(msg);
+
+    return expire;
+}
+
+static void test_ldap_sync_invalidate(void **state)
+{
+    struct ldap_id_sync_test_ctx *test_ctx;
+    struct sss_domain_info *dom;
+    struct sysdb_attrs *attrs;
+    char *fqname;
+    time_t now;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct ldap_id_sync_test_ctx);
+    dom = test_ctx->tctx->dom;
+    now = time(NULL);
+
+    fqname = sss_create_internal_fqname(test_ctx, TEST_USER_NAME, dom->name);
+    assert_non_null(fqname);
+    ret = sysdb_store_user(dom, fqname, NULL, TEST_USER_UID, TEST_GROUP_GID,
+                           NULL, "/home/" TEST_USER_NAME, "/bin/sh",
+                           TEST_USER_DN, NULL, NULL, 1000, now);
+    talloc_free(fqname);
+    assert_int_equal(ret, EOK);
+
+    attrs = sysdb_new_attrs(test_ctx);
+    assert_non_null(attrs);
+    ret = sysdb_attrs_add_string(attrs, SYSDB_ORIG_DN, TEST_GROUP_DN);
+    assert_int_equal(ret, EOK);
+    fqname = sss_create_internal_fqname(test_ctx, TEST_GROUP_NAME, dom->name);
+    assert_non_null(fqname);
+    ret = sysdb_store_group(dom, fqname, TEST_GROUP_GID, attrs, 1000, now);
+    talloc_free(fqname);
+    talloc_free(attrs);
+    assert_int_equal(ret, EOK);
+
+    /* Entries that are not cached are ignored */
+    ldap_sync_invalidate(test_ctx->id_ctx, dom,
+                         "uid=other,ou=people,dc=example,dc=com");
+    assert_true(get_expire(test_ctx, TEST_USER_NAME, true) > now);
+    assert_true(get_expire(test_ctx, TEST_GROUP_NAME, false) > now);
+
+    /* A changed user is expired in the cache and the memory cache */
+    expect_value(__wrap_dp_sbus_invalidate_user_memcache,
+                 uid, TEST_USER_UID);
+    ldap_sync_invalidate(test_ctx->id_ctx, dom, TEST_USER_DN);
+    assert_true(get_expire(test_ctx, TEST_USER_NAME, true) <= now);
+    assert_true(get_expire(test_ctx, TEST_GROUP_NAME, false) > now);
+
+    /* So is a changed group */
+    expect_value(__wrap_dp_sbus_invalidate_group_memcache,
+                 gid, TEST_GROUP_GID);
+    ldap_sync_invalidate(test_ctx->id_ctx, dom, TEST_GROUP_DN);
+    assert_true(get_expire(test_ctx, TEST_GROUP_NAME, false) <= now);
+}
+
+int main(int argc, const char *argv[])
+{
+    int rv;
+    int no_cleanup = 0;
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        {"no-cleanup", 'n', POPT_ARG_NONE, &no_cleanup, 0,
+         _("Do not delete the test database after a test run"), NULL },
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ldap_sync_parse_state),
+        cmocka_unit_test(test_ldap_sync_parse_info),
+        cmocka_unit_test(test_ldap_sync_entry_changed),
+        cmocka_unit_test_setup_teardown(test_ldap_sync_invalidate,
+                                        test_ldap_id_sync_setup,
+                                        test_ldap_id_sync_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    tests_set_cwd();
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    rv = cmocka_run_group_tests(tests, NULL, NULL);
+
+    if (rv == 0 && no_cleanup == 0) {
+        test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    }
+    return rv;
+}
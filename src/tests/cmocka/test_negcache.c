@@ -538,6 +538,54 @@ static void test_sss_ncache_service_port(void **state)
     assert_int_equal(ret, EEXIST);
 }
 
+/* @test_sss_ncache_resolver : test following functions
+ * sss_ncache_check_host, sss_ncache_set_host
+ * sss_ncache_check_host_addr, sss_ncache_set_host_addr
+ * sss_ncache_check_network, sss_ncache_set_network
+ * sss_ncache_set_resolver_timeout
+ */
+static void test_sss_ncache_resolver(void **state)
+{
+    int ret;
+    struct test_state *ts;
+    struct sss_domain_info *dom;
+
+    ts = talloc_get_type_abort(*state, struct test_state);
+    dom = talloc(ts, struct sss_domain_info);
+    dom->name = discard_const_p(char, TEST_DOM_NAME);
+
+    ret = sss_ncache_check_host(ts->ctx, dom, "host.example.com");
+    assert_int_equal(ret, ENOENT);
+
+    ret = sss_ncache_set_host(ts->ctx, false, dom, "host.example.com");
+    assert_int_equal(ret, EOK);
+
+    ret = sss_ncache_check_host(ts->ctx, dom, "host.example.com");
+    assert_int_equal(ret, EEXIST);
+
+    /* names and addresses do not share entries */
+    ret = sss_ncache_set_host_addr(ts->ctx, false, dom, "192.0.2.1");
+    assert_int_equal(ret, EOK);
+
+    ret = sss_ncache_check_host_addr(ts->ctx, dom, "192.0.2.1");
+    assert_int_equal(ret, EEXIST);
+
+    ret = sss_ncache_check_host(ts->ctx, dom, "192.0.2.1");
+    assert_int_equal(ret, ENOENT);
+
+    ret = sss_ncache_check_network(ts->ctx, dom, "host.example.com");
+    assert_int_equal(ret, ENOENT);
+
+    /* a timeout of 0 disables the negative cache of hosts and networks */
+    sss_ncache_set_resolver_timeout(ts->ctx, 0);
+    assert_int_equal(sss_ncache_get_resolver_timeout(ts->ctx), 0);
+
+    ret = sss_ncache_set_network(ts->ctx, false, dom, "loopback");
+    assert_int_equal(ret, EOK);
+
+    ret = sss_ncache_check_network(ts->ctx, dom, "loopback");
+    assert_int_equal(ret, ENOENT);
+}
 
 static void test_sss_ncache_reset_permanent(void **state)
 {
@@ -1256,6 +1304,168 @@ static void test_sss_ncache_reset(void **state)
     assert_int_equal(ret, ENOENT);
 }
 
+/* Enough entries to make the table grow several times */
+#define NCACHE_MANY_ENTRIES 10000
+
+static void test_sss_ncache_many_entries(void **state)
+{
+    errno_t ret;
+    struct test_state *ts;
+    struct sss_nc_ctx *ctx;
+    uid_t id;
+
+    ts = talloc_get_type_abort(*state, struct test_state);
+
+    /* The entries must not expire while the test runs */
+    ret = sss_ncache_init(ts, 3600, 0, &ctx);
+    assert_int_equal(ret, EOK);
+
+    for (id = 1; id <= NCACHE_MANY_ENTRIES; id++) {
+        ret = sss_ncache_set_uid(ctx, id % 2 == 0, NULL, id);
+        assert_int_equal(ret, EOK);
+        ret = sss_ncache_set_gid(ctx, false, NULL, id);
+        assert_int_equal(ret, EOK);
+    }
+
+    for (id = 1; id <= NCACHE_MANY_ENTRIES; id++) {
+        ret = sss_ncache_check_uid(ctx, NULL, id);
+        assert_int_equal(ret, EEXIST);
+        ret = sss_ncache_check_gid(ctx, NULL, id);
+        assert_int_equal(ret, EEXIST);
+    }
+
+    ret = sss_ncache_check_uid(ctx, NULL, NCACHE_MANY_ENTRIES + 1);
+    assert_int_equal(ret, ENOENT);
+
+    /* Only the permanent users survive the reset */
+    ret = sss_ncache_reset_users(ctx);
+    assert_int_equal(ret, EOK);
+
+    for (id = 1; id <= NCACHE_MANY_ENTRIES; id++) {
+        ret = sss_ncache_check_uid(ctx, NULL, id);
+        assert_int_equal(ret, id % 2 == 0 ? EEXIST : ENOENT);
+        ret = sss_ncache_check_gid(ctx, NULL, id);
+        assert_int_equal(ret, EEXIST);
+    }
+
+    /* Entries removed by the reset can be added again */
+    ret = sss_ncache_set_uid(ctx, false, NULL, 1);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_check_uid(ctx, NULL, 1);
+    assert_int_equal(ret, EEXIST);
+
+    ret = sss_ncache_reset_permanent(ctx);
+    assert_int_equal(ret, EOK);
+
+    ret = sss_ncache_check_uid(ctx, NULL, 2);
+    assert_int_equal(ret, ENOENT);
+    ret = sss_ncache_check_uid(ctx, NULL, 1);
+    assert_int_equal(ret, EEXIST);
+
+    talloc_free(ctx);
+}
+
+static void test_sss_ncache_shrink(void **state)
+{
+    errno_t ret;
+    struct test_state *ts;
+    struct sss_nc_ctx *ctx;
+    size_t full_size;
+    uid_t id;
+
+    ts = talloc_get_type_abort(*state, struct test_state);
+
+    ret = sss_ncache_init(ts, 3600, 0, &ctx);
+    assert_int_equal(ret, EOK);
+
+    for (id = 1; id <= NCACHE_MANY_ENTRIES; id++) {
+        ret = sss_ncache_set_uid(ctx, id % 100 == 0, NULL, id);
+        assert_int_equal(ret, EOK);
+    }
+    full_size = talloc_total_size(ctx);
+
+    /* Only the permanent entries are kept and the table gets smaller */
+    ret = sss_ncache_shrink(ctx);
+    assert_int_equal(ret, EOK);
+    assert_true(talloc_total_size(ctx) < full_size / 10);
+
+    for (id = 1; id <= NCACHE_MANY_ENTRIES; id++) {
+        ret = sss_ncache_check_uid(ctx, NULL, id);
+        assert_int_equal(ret, id % 100 == 0 ? EEXIST : ENOENT);
+    }
+
+    /* The cache keeps working */
+    ret = sss_ncache_set_uid(ctx, false, NULL, 1);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_check_uid(ctx, NULL, 1);
+    assert_int_equal(ret, EEXIST);
+
+    talloc_free(ctx);
+}
+
+struct ncache_copy {
+    struct sss_nc_ctx *dest;
+    int count;
+};
+
+static errno_t ncache_copy_entry(const char *key, time_t expire, void *pvt)
+{
+    struct ncache_copy *copy = pvt;
+
+    copy->count++;
+    return sss_ncache_restore(copy->dest, key, expire);
+}
+
+static void test_sss_ncache_foreach_restore(void **state)
+{
+    errno_t ret;
+    struct test_state *ts;
+    struct sss_nc_ctx *ctx;
+    struct ncache_copy copy;
+
+    ts = talloc_get_type_abort(*state, struct test_state);
+
+    ret = sss_ncache_init(ts, 3600, 0, &ctx);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_init(ts, 3600, 0, &copy.dest);
+    assert_int_equal(ret, EOK);
+    copy.count = 0;
+
+    ret = sss_ncache_set_uid(ctx, false, NULL, 1);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_set_gid(ctx, false, NULL, 2);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_set_uid(ctx, true, NULL, 3);
+    assert_int_equal(ret, EOK);
+    /* reset, so not listed */
+    ret = sss_ncache_set_gid(ctx, false, NULL, 4);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_reset_groups(ctx);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_set_gid(ctx, false, NULL, 2);
+    assert_int_equal(ret, EOK);
+
+    /* Only the valid entries that expire are listed */
+    ret = sss_ncache_foreach(ctx, ncache_copy_entry, &copy);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(copy.count, 2);
+
+    assert_int_equal(sss_ncache_check_uid(copy.dest, NULL, 1), EEXIST);
+    assert_int_equal(sss_ncache_check_gid(copy.dest, NULL, 2), EEXIST);
+    assert_int_equal(sss_ncache_check_uid(copy.dest, NULL, 3), ENOENT);
+    assert_int_equal(sss_ncache_check_gid(copy.dest, NULL, 4), ENOENT);
+
+    /* Expired entries and unknown keys are not restored */
+    ret = sss_ncache_restore(copy.dest, "NCE/UID/5", time(NULL) - 1);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(sss_ncache_check_uid(copy.dest, NULL, 5), ENOENT);
+    ret = sss_ncache_restore(copy.dest, "garbage", time(NULL) + 60);
+    assert_int_equal(ret, EINVAL);
+
+    talloc_free(copy.dest);
+    talloc_free(ctx);
+}
+
 static void test_sss_ncache_locate_uid_gid(void **state)
 {
     uid_t uid;
@@ -1343,6 +1553,8 @@ int main(void)
                                         teardown),
         cmocka_unit_test_setup_teardown(test_sss_ncache_service_port,
                                         setup, teardown),
+        cmocka_unit_test_setup_teardown(test_sss_ncache_resolver,
+                                        setup, teardown),
         cmocka_unit_test_setup_teardown(test_sss_ncache_reset_permanent, setup,
                                         teardown),
         cmocka_unit_test_setup_teardown(test_sss_ncache_prepopulate,
@@ -1357,6 +1569,12 @@ int main(void)
                                         setup, teardown),
         cmocka_unit_test_setup_teardown(test_sss_ncache_reset,
                                         setup, teardown),
+        cmocka_unit_test_setup_teardown(test_sss_ncache_many_entries,
+                                        setup, teardown),
+        cmocka_unit_test_setup_teardown(test_sss_ncache_shrink,
+                                        setup, teardown),
+        cmocka_unit_test_setup_teardown(test_sss_ncache_foreach_restore,
+                                        setup, teardown),
         cmocka_unit_test_setup_teardown(test_sss_ncache_locate_uid_gid,
                                         setup, teardown),
         cmocka_unit_test_setup_teardown(test_sss_ncache_domain_locate_type,
@@ -237,6 +237,79 @@ static void nested_groups_test_one_group_unique_members(void **state)
                                        expected, N_ELEMENTS(expected));
 }
 
+static void nested_groups_test_one_group_batched_members(void **state)
+{
+    struct nested_groups_test_ctx *test_ctx = NULL;
+    struct sysdb_attrs *rootgroup = NULL;
+    struct tevent_req *req = NULL;
+    TALLOC_CTX *req_mem_ctx = NULL;
+    errno_t ret;
+    const char *users[] = { "cn=user1,"USER_BASE_DN,
+                            "cn=user2,"USER_BASE_DN,
+                            "cn=user3,"USER_BASE_DN,
+                            NULL };
+    const struct sysdb_attrs *batch_reply[4] = { NULL };
+    const struct sysdb_attrs *user3_reply[2] = { NULL };
+    const char * expected[] = { "user1",
+                                "user2",
+                                "user3" };
+
+    test_ctx = talloc_get_type_abort(*state, struct nested_groups_test_ctx);
+
+    /* two members fit into one batch, the last one is looked up alone */
+    ret = dp_opt_set_int(test_ctx->sdap_opts->basic,
+                         SDAP_GROUP_MEMBER_BATCH_SIZE, 2);
+    assert_int_equal(ret, EOK);
+
+    /* mock return values */
+    rootgroup = mock_sysdb_group_rfc2307bis(test_ctx, GROUP_BASE_DN, 1000,
+                                            "rootgroup", users);
+
+    /* the batch filter may match entries that are not members */
+    batch_reply[0] = mock_sysdb_user(test_ctx, USER_BASE_DN, 2002, "user2");
+    assert_non_null(batch_reply[0]);
+    batch_reply[1] = mock_sysdb_user(test_ctx, USER_BASE_DN, 2009, "user9");
+    assert_non_null(batch_reply[1]);
+    batch_reply[2] = mock_sysdb_user(test_ctx, USER_BASE_DN, 2001, "user1");
+    assert_non_null(batch_reply[2]);
+    will_return(sdap_get_generic_recv, 3);
+    will_return(sdap_get_generic_recv, batch_reply);
+    will_return(sdap_get_generic_recv, ERR_OK);
+
+    user3_reply[0] = mock_sysdb_user(test_ctx, USER_BASE_DN, 2003, "user3");
+    assert_non_null(user3_reply[0]);
+    will_return(sdap_get_generic_recv, 1);
+    will_return(sdap_get_generic_recv, user3_reply);
+    will_return(sdap_get_generic_recv, ERR_OK);
+
+    sss_will_return_always(sdap_has_deref_support, false);
+
+    /* run test, check for memory leaks */
+    req_mem_ctx = talloc_new(global_talloc_context);
+    assert_non_null(req_mem_ctx);
+    check_leaks_push(req_mem_ctx);
+
+    req = sdap_nested_group_send(req_mem_ctx, test_ctx->tctx->ev,
+                                 test_ctx->sdap_domain, test_ctx->sdap_opts,
+                                 test_ctx->sdap_handle, rootgroup);
+    assert_non_null(req);
+    tevent_req_set_callback(req, nested_groups_test_done, test_ctx);
+
+    ret = test_ev_loop(test_ctx->tctx);
+    assert_true(check_leaks_pop(req_mem_ctx) == true);
+    talloc_zfree(req_mem_ctx);
+
+    /* check return code */
+    assert_int_equal(ret, ERR_OK);
+
+    /* Check the users */
+    assert_int_equal(test_ctx->num_users, N_ELEMENTS(expected));
+    assert_int_equal(test_ctx->num_groups, 1);
+
+    compare_sysdb_string_array_noorder(test_ctx->users,
+                                       expected, N_ELEMENTS(expected));
+}
+
 static void nested_groups_test_one_group_dup_users(void **state)
 {
     struct nested_groups_test_ctx *test_ctx = NULL;
@@ -520,6 +593,102 @@ static void nested_groups_test_nested_chain(void **state)
                                        N_ELEMENTS(expected_users));
 }
 
+static void nested_groups_test_nested_parallel(void **state)
+{
+    struct nested_groups_test_ctx *test_ctx = NULL;
+    struct tevent_req *req = NULL;
+    TALLOC_CTX *req_mem_ctx = NULL;
+    errno_t ret;
+    const char *rootgroup_members[] = { "cn=group1,"GROUP_BASE_DN,
+                                        "cn=group2,"GROUP_BASE_DN,
+                                        NULL };
+    const char *group1_members[] = { "cn=user1,"USER_BASE_DN,
+                                     NULL };
+    const char *group2_members[] = { "cn=user2,"USER_BASE_DN,
+                                     NULL };
+    struct sysdb_attrs *rootgroup;
+    const struct sysdb_attrs *group1_reply[2] = { NULL };
+    const struct sysdb_attrs *group2_reply[2] = { NULL };
+    const struct sysdb_attrs *user1_reply[2] = { NULL };
+    const struct sysdb_attrs *user2_reply[2] = { NULL };
+    const char *expected_groups[] = { "rootgroup", "group1", "group2" };
+    const char *expected_users[] = { "user1", "user2" };
+
+    test_ctx = talloc_get_type_abort(*state, struct nested_groups_test_ctx);
+
+    ret = dp_opt_set_int(test_ctx->sdap_opts->basic,
+                         SDAP_GROUP_MEMBER_BATCH_SIZE, 1);
+    assert_int_equal(ret, EOK);
+    ret = dp_opt_set_int(test_ctx->sdap_opts->basic,
+                         SDAP_NESTED_GROUP_PARALLEL, 2);
+    assert_int_equal(ret, EOK);
+
+    /* mock return values */
+    rootgroup = mock_sysdb_group_rfc2307bis(test_ctx, GROUP_BASE_DN, 1000,
+                                            "rootgroup", rootgroup_members);
+    assert_non_null(rootgroup);
+
+    group1_reply[0] = mock_sysdb_group_rfc2307bis(test_ctx, GROUP_BASE_DN,
+                                                  1001, "group1",
+                                                  group1_members);
+    assert_non_null(group1_reply[0]);
+    will_return(sdap_get_generic_recv, 1);
+    will_return(sdap_get_generic_recv, group1_reply);
+    will_return(sdap_get_generic_recv, ERR_OK);
+
+    group2_reply[0] = mock_sysdb_group_rfc2307bis(test_ctx, GROUP_BASE_DN,
+                                                  1002, "group2",
+                                                  group2_members);
+    assert_non_null(group2_reply[0]);
+    will_return(sdap_get_generic_recv, 1);
+    will_return(sdap_get_generic_recv, group2_reply);
+    will_return(sdap_get_generic_recv, ERR_OK);
+
+    /* the members of both nested groups are looked up at the same time,
+     * in the order the groups were found */
+    user1_reply[0] = mock_sysdb_user(test_ctx, USER_BASE_DN, 2001, "user1");
+    assert_non_null(user1_reply[0]);
+    will_return(sdap_get_generic_recv, 1);
+    will_return(sdap_get_generic_recv, user1_reply);
+    will_return(sdap_get_generic_recv, ERR_OK);
+
+    user2_reply[0] = mock_sysdb_user(test_ctx, USER_BASE_DN, 2002, "user2");
+    assert_non_null(user2_reply[0]);
+    will_return(sdap_get_generic_recv, 1);
+    will_return(sdap_get_generic_recv, user2_reply);
+    will_return(sdap_get_generic_recv, ERR_OK);
+
+    sss_will_return_always(sdap_has_deref_support, false);
+
+    /* run test, check for memory leaks */
+    req_mem_ctx = talloc_new(global_talloc_context);
+    assert_non_null(req_mem_ctx);
+    check_leaks_push(req_mem_ctx);
+
+    req = sdap_nested_group_send(req_mem_ctx, test_ctx->tctx->ev,
+                                 test_ctx->sdap_domain, test_ctx->sdap_opts,
+                                 test_ctx->sdap_handle, rootgroup);
+    assert_non_null(req);
+    tevent_req_set_callback(req, nested_groups_test_done, test_ctx);
+
+    ret = test_ev_loop(test_ctx->tctx);
+    assert_true(check_leaks_pop(req_mem_ctx) == true);
+    talloc_zfree(req_mem_ctx);
+
+    /* check return code */
+    assert_int_equal(ret, ERR_OK);
+
+    assert_int_equal(test_ctx->num_users, N_ELEMENTS(expected_users));
+    assert_int_equal(test_ctx->num_groups, N_ELEMENTS(expected_groups));
+
+    compare_sysdb_string_array_noorder(test_ctx->groups,
+                                       expected_groups,
+                                       N_ELEMENTS(expected_groups));
+    compare_sysdb_string_array_noorder(test_ctx->users,
+                                       expected_users,
+                                       N_ELEMENTS(expected_users));
+}
+
 static void nested_groups_test_nested_chain_with_error(void **state)
 {
     struct nested_groups_test_ctx *test_ctx = NULL;
@@ -617,6 +786,11 @@ static int nested_groups_test_setup(void **state)
     assert_non_null(test_ctx->sdap_opts);
     test_ctx->sdap_domain = test_ctx->sdap_opts->sdom;
     test_ctx->sdap_handle = mock_sdap_handle(test_ctx);
+
+    /* look up members individually unless the test enables batches */
+    ret = dp_opt_set_int(test_ctx->sdap_opts->basic,
+                         SDAP_GROUP_MEMBER_BATCH_SIZE, 1);
+    assert_int_equal(ret, EOK);
     assert_non_null(test_ctx->sdap_handle);
 
     test_ctx->be_ctx = mock_be_ctx(test_ctx, test_ctx->tctx);
@@ -1293,10 +1467,12 @@ int main(int argc, const char *argv[])
     const struct CMUnitTest tests[] = {
         new_test(one_group_no_members),
         new_test(one_group_unique_members),
+        new_test(one_group_batched_members),
         new_test(one_group_dup_users),
         new_test(one_group_unique_group_members),
         new_test(one_group_dup_group_members),
         new_test(nested_chain),
+        new_test(nested_parallel),
         new_test(nested_chain_with_error),
         cmocka_unit_test_setup_teardown(nested_group_external_member_test,
                                         nested_group_external_member_setup,
@@ -1610,6 +1610,125 @@ void test_nss_getgrnam_members(void **state)
     assert_int_equal(ret, EOK);
 }
 
+#define TEST_LARGE_GROUP_MEMBERS 1000
+
+static struct ldb_message *large_group_msg(TALLOC_CTX *mem_ctx,
+                                           struct sss_domain_info *dom,
+                                           unsigned int num_members)
+{
+    struct ldb_message *msg;
+    char *fqname;
+    unsigned int i;
+    int ret;
+
+    msg = ldb_msg_new(mem_ctx);
+    assert_non_null(msg);
+
+    fqname = sss_create_internal_fqname(msg, "testlargegroup", dom->name);
+    assert_non_null(fqname);
+
+    msg->dn = sysdb_group_dn(msg, dom, fqname);
+    assert_non_null(msg->dn);
+
+    ret = ldb_msg_add_string(msg, SYSDB_OBJECTCATEGORY, SYSDB_GROUP_CLASS);
+    assert_int_equal(ret, LDB_SUCCESS);
+    ret = ldb_msg_add_string(msg, SYSDB_NAME, fqname);
+    assert_int_equal(ret, LDB_SUCCESS);
+    ret = ldb_msg_add_fmt(msg, SYSDB_GIDNUM, "%u", 1125);
+    assert_int_equal(ret, LDB_SUCCESS);
+
+    for (i = 0; i < num_members; i++) {
+        ret = ldb_msg_add_fmt(msg, SYSDB_GHOST, "largemember%u@%s",
+                              i, dom->name);
+        assert_int_equal(ret, LDB_SUCCESS);
+    }
+
+    return msg;
+}
+
+static void fill_large_group(struct cache_req_result *result,
+                             uint8_t **_body, size_t *_blen,
+                             uint32_t *_nmem)
+{
+    struct nss_cmd_ctx *cmd_ctx;
+    struct sss_packet *packet;
+    struct group gr;
+    errno_t ret;
+
+    cmd_ctx = talloc_zero(result, struct nss_cmd_ctx);
+    assert_non_null(cmd_ctx);
+
+    ret = sss_packet_new(result, 0, SSS_NSS_GETGRNAM, &packet);
+    assert_int_equal(ret, EOK);
+
+    ret = nss_protocol_fill_grent(nss_test_ctx->nctx, cmd_ctx, packet, result);
+    assert_int_equal(ret, EOK);
+
+    sss_packet_get_body(packet, _body, _blen);
+    ret = parse_group_packet(*_body, *_blen, &gr, _nmem);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(gr.gr_name, "testlargegroup");
+    assert_int_equal(gr.gr_gid, 1125);
+}
+
+/* Test that the reply of a large group is built once and reused until the
+ * group changes
+ */
+void test_nss_getgrnam_large_group_reply(void **state)
+{
+    struct cache_req_result *result;
+    struct ldb_message *msg;
+    uint8_t *body1;
+    uint8_t *body2;
+    size_t blen1;
+    size_t blen2;
+    uint32_t nmem;
+    int ret;
+
+    will_return_always(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    result = talloc_zero(nss_test_ctx, struct cache_req_result);
+    assert_non_null(result);
+    result->domain = nss_test_ctx->tctx->dom;
+    result->count = 1;
+    result->msgs = talloc_array(result, struct ldb_message *, 1);
+    assert_non_null(result->msgs);
+
+    /* small groups are not kept */
+    msg = large_group_msg(result, nss_test_ctx->tctx->dom, 10);
+    result->msgs[0] = msg;
+    fill_large_group(result, &body1, &blen1, &nmem);
+    assert_int_equal(nmem, 10);
+    assert_null(nss_test_ctx->nctx->grent_replies);
+
+    msg = large_group_msg(result, nss_test_ctx->tctx->dom,
+                          TEST_LARGE_GROUP_MEMBERS);
+    result->msgs[0] = msg;
+    fill_large_group(result, &body1, &blen1, &nmem);
+    assert_int_equal(nmem, TEST_LARGE_GROUP_MEMBERS);
+    assert_non_null(nss_test_ctx->nctx->grent_replies);
+    assert_int_equal(hash_count(nss_test_ctx->nctx->grent_replies), 1);
+
+    fill_large_group(result, &body2, &blen2, &nmem);
+    assert_int_equal(nmem, TEST_LARGE_GROUP_MEMBERS);
+    assert_int_equal(blen1, blen2);
+    assert_memory_equal(body1, body2, blen1);
+
+    /* a new member replaces the kept reply */
+    ret = ldb_msg_add_fmt(msg, SYSDB_GHOST, "largemember%u@%s",
+                          TEST_LARGE_GROUP_MEMBERS,
+                          nss_test_ctx->tctx->dom->name);
+    assert_int_equal(ret, LDB_SUCCESS);
+    fill_large_group(result, &body2, &blen2, &nmem);
+    assert_int_equal(nmem, TEST_LARGE_GROUP_MEMBERS + 1);
+    assert_int_equal(hash_count(nss_test_ctx->nctx->grent_replies), 1);
+
+    nss_grent_replies_flush(nss_test_ctx->nctx);
+    assert_int_equal(hash_count(nss_test_ctx->nctx->grent_replies), 0);
+
+    talloc_free(result);
+}
+
 static int test_nss_getgrnam_members_check_fqdn(uint32_t status,
                                                 uint8_t *body, size_t blen)
 {
@@ -4667,6 +4786,86 @@ void test_nss_getpwuid_ex(void **state)
     assert_int_equal(ret, EOK);
 }
 
+struct passwd getpwuid_stale = {
+    .pw_name = discard_const("exampleuser_stale"),
+    .pw_uid = 110,
+    .pw_gid = 11000,
+    .pw_dir = discard_const("/home/exampleuser"),
+    .pw_gecos = discard_const("example user"),
+    .pw_shell = discard_const("/bin/sh"),
+    .pw_passwd = discard_const("*"),
+};
+
+static int test_nss_getpwuid_stale_check(uint32_t status,
+                                         uint8_t *body, size_t blen)
+{
+    struct passwd pwd;
+    errno_t ret;
+
+    assert_int_equal(status, EOK);
+
+    ret = parse_user_packet(body, blen, &pwd);
+    assert_int_equal(ret, EOK);
+
+    assert_users_equal(&pwd, &getpwuid_stale);
+    return EOK;
+}
+
+void test_nss_getpwuid_ex_cache_only(void **state)
+{
+    errno_t ret;
+
+    /* Prime the cache with a valid but expired user */
+    ret = store_user(nss_test_ctx, nss_test_ctx->tctx->dom,
+                     &getpwuid_stale, NULL, 1);
+    assert_int_equal(ret, EOK);
+
+    /* Use flag SSS_NSS_EX_FLAG_CACHE_ONLY, the expired user is returned
+     * without a backend lookup */
+    mock_input_id_ex(nss_test_ctx, getpwuid_stale.pw_uid,
+                     SSS_NSS_EX_FLAG_CACHE_ONLY);
+    will_return(__wrap_sss_packet_get_cmd, SSS_NSS_GETPWUID_EX);
+    mock_fill_user();
+
+    set_cmd_cb(test_nss_getpwuid_stale_check);
+    ret = sss_cmd_execute(nss_test_ctx->cctx, SSS_NSS_GETPWUID_EX,
+                          nss_test_ctx->nss_cmds);
+    assert_int_equal(ret, EOK);
+
+    /* Wait until the test finishes with EOK */
+    ret = test_ev_loop(nss_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+    RESET_TCTX;
+
+    /* An id which is not cached is not looked up either */
+    mock_input_id_ex(nss_test_ctx, getpwuid_stale.pw_uid + 1,
+                     SSS_NSS_EX_FLAG_CACHE_ONLY);
+
+    set_cmd_cb(NULL);
+    ret = sss_cmd_execute(nss_test_ctx->cctx, SSS_NSS_GETPWUID_EX,
+                          nss_test_ctx->nss_cmds);
+    assert_int_equal(ret, EOK);
+
+    /* Wait until the test finishes with ENOENT */
+    ret = test_ev_loop(nss_test_ctx->tctx);
+    assert_int_equal(ret, ENOENT);
+    RESET_TCTX;
+
+    /* Use unsupported flag combination, expect EINVAL */
+    mock_input_id_ex(nss_test_ctx, getpwuid_stale.pw_uid,
+                     SSS_NSS_EX_FLAG_CACHE_ONLY|SSS_NSS_EX_FLAG_ALLOW_STALE);
+    will_return(__wrap_sss_packet_get_cmd, SSS_NSS_GETPWUID_EX);
+
+    set_cmd_cb(test_nss_EINVAL_check);
+    ret = sss_cmd_execute(nss_test_ctx->cctx, SSS_NSS_GETPWUID_EX,
+                          nss_test_ctx->nss_cmds);
+    assert_int_equal(ret, EOK);
+
+    /* Wait until the test finishes with EOK */
+    ret = test_ev_loop(nss_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+}
+
 void test_nss_getgrnam_ex_no_members(void **state)
 {
     errno_t ret;
@@ -5574,6 +5773,8 @@ int main(int argc, const char *argv[])
                                         nss_test_setup, nss_test_teardown),
         cmocka_unit_test_setup_teardown(test_nss_getgrnam_members,
                                         nss_test_setup, nss_test_teardown),
+        cmocka_unit_test_setup_teardown(test_nss_getgrnam_large_group_reply,
+                                        nss_test_setup, nss_test_teardown),
         cmocka_unit_test_setup_teardown(test_nss_getgrnam_members_fqdn,
                                         nss_fqdn_test_setup, nss_test_teardown),
         cmocka_unit_test_setup_teardown(test_nss_getgrnam_members_subdom,
@@ -5689,6 +5890,8 @@ int main(int argc, const char *argv[])
                                         nss_test_setup, nss_test_teardown),
         cmocka_unit_test_setup_teardown(test_nss_getpwuid_ex,
                                         nss_test_setup, nss_test_teardown),
+        cmocka_unit_test_setup_teardown(test_nss_getpwuid_ex_cache_only,
+                                        nss_test_setup, nss_test_teardown),
         cmocka_unit_test_setup_teardown(test_nss_getgrnam_ex_no_members,
                                         nss_test_setup, nss_test_teardown),
         cmocka_unit_test_setup_teardown(test_nss_getgrgid_ex_no_members,
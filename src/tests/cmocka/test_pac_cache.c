@@ -0,0 +1,254 @@
+/*
+    SSSD
+
+    test_pac_cache - Tests of the cache of the PAC responder
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <popt.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "responder/pac/pacsrv.h"
+
+#define TEST_USER_SID "S-1-5-21-3623811015-3361044348-30300820-1013"
+
+/* PACTYPE header with three buffers: logon info, server and KDC checksum,
+ * each with 8 bytes of data behind the header */
+static const uint8_t test_pac[] = {
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x07, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* logon info */
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    /* server checksum */
+    0x10, 0x00, 0x00, 0x00, 0xaa, 0xbb, 0xcc, 0xdd,
+    /* KDC checksum */
+    0x10, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04,
+};
+
+#define TEST_LOGON_INFO_OFFSET 0x38
+#define TEST_SRV_CHECKSUM_OFFSET 0x40
+
+struct pac_cache_test_ctx {
+    struct tevent_context *ev;
+    struct pac_cache *cache;
+};
+
+static int pac_cache_test_setup(void **state)
+{
+    struct pac_cache_test_ctx *test_ctx;
+    errno_t ret;
+
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context, struct pac_cache_test_ctx);
+    assert_non_null(test_ctx);
+
+    test_ctx->ev = tevent_context_init(test_ctx);
+    assert_non_null(test_ctx->ev);
+
+    check_leaks_push(test_ctx);
+
+    ret = pac_cache_init(test_ctx, test_ctx->ev, 1, &test_ctx->cache);
+    assert_int_equal(ret, EOK);
+    *state = test_ctx;
+    return 0;
+}
+
+static int pac_cache_test_teardown(void **state)
+{
+    struct pac_cache_test_ctx *test_ctx;
+
+    test_ctx = talloc_get_type_abort(*state, struct pac_cache_test_ctx);
+
+    talloc_free(test_ctx->cache);
+    assert_true(check_leaks_pop(test_ctx));
+    talloc_free(test_ctx);
+    assert_true(leak_check_teardown());
+    return 0;
+}
+
+static void test_pac_cache_hit(void **state)
+{
+    struct pac_cache_test_ctx *test_ctx;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct pac_cache_test_ctx);
+
+    ret = pac_cache_check(test_ctx->cache, test_pac, sizeof(test_pac));
+    assert_int_equal(ret, ENOENT);
+
+    ret = pac_cache_add(test_ctx->cache, test_pac, sizeof(test_pac),
+                        TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+
+    ret = pac_cache_check(test_ctx->cache, test_pac, sizeof(test_pac));
+    assert_int_equal(ret, EOK);
+
+    /* a truncated PAC */
+    ret = pac_cache_check(test_ctx->cache, test_pac, sizeof(test_pac) - 1);
+    assert_int_equal(ret, ENOENT);
+
+    /* the same entry is replaced */
+    ret = pac_cache_add(test_ctx->cache, test_pac, sizeof(test_pac),
+                        TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+
+    ret = pac_cache_check(test_ctx->cache, test_pac, sizeof(test_pac));
+    assert_int_equal(ret, EOK);
+}
+
+static void test_pac_cache_changed(void **state)
+{
+    struct pac_cache_test_ctx *test_ctx;
+    uint8_t pac[sizeof(test_pac)];
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct pac_cache_test_ctx);
+
+    ret = pac_cache_add(test_ctx->cache, test_pac, sizeof(test_pac),
+                        TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+
+    /* a PAC of another user with the same checksums is not a hit */
+    memcpy(pac, test_pac, sizeof(pac));
+    pac[TEST_LOGON_INFO_OFFSET] = 0x22;
+    ret = pac_cache_check(test_ctx->cache, pac, sizeof(pac));
+    assert_int_equal(ret, ENOENT);
+
+    /* and a PAC with other checksums is not found */
+    memcpy(pac, test_pac, sizeof(pac));
+    pac[TEST_SRV_CHECKSUM_OFFSET + 4] = 0x00;
+    ret = pac_cache_check(test_ctx->cache, pac, sizeof(pac));
+    assert_int_equal(ret, ENOENT);
+
+    ret = pac_cache_add(test_ctx->cache, pac, sizeof(pac), TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+
+    ret = pac_cache_check(test_ctx->cache, pac, sizeof(pac));
+    assert_int_equal(ret, EOK);
+
+    ret = pac_cache_check(test_ctx->cache, test_pac, sizeof(test_pac));
+    assert_int_equal(ret, EOK);
+}
+
+static void test_pac_cache_invalid(void **state)
+{
+    struct pac_cache_test_ctx *test_ctx;
+    uint8_t pac[sizeof(test_pac)];
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct pac_cache_test_ctx);
+
+    /* without the KDC checksum the PAC is not cached */
+    memcpy(pac, test_pac, sizeof(pac));
+    pac[0] = 0x02;
+    ret = pac_cache_add(test_ctx->cache, pac, sizeof(pac), TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+    ret = pac_cache_check(test_ctx->cache, pac, sizeof(pac));
+    assert_int_equal(ret, ENOENT);
+
+    /* more buffers than fit into the PAC */
+    pac[0] = 0x10;
+    ret = pac_cache_add(test_ctx->cache, pac, sizeof(pac), TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+    ret = pac_cache_check(test_ctx->cache, pac, sizeof(pac));
+    assert_int_equal(ret, ENOENT);
+
+    /* a buffer that ends behind the PAC */
+    memcpy(pac, test_pac, sizeof(pac));
+    pac[0x2c] = 0x4c;
+    ret = pac_cache_add(test_ctx->cache, pac, sizeof(pac), TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+    ret = pac_cache_check(test_ctx->cache, pac, sizeof(pac));
+    assert_int_equal(ret, ENOENT);
+
+    ret = pac_cache_check(test_ctx->cache, pac, 4);
+    assert_int_equal(ret, ENOENT);
+
+    ret = pac_cache_check(NULL, test_pac, sizeof(test_pac));
+    assert_int_equal(ret, ENOENT);
+}
+
+static void test_pac_cache_expired(void **state)
+{
+    struct pac_cache_test_ctx *test_ctx;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct pac_cache_test_ctx);
+
+    ret = pac_cache_add(test_ctx->cache, test_pac, sizeof(test_pac),
+                        TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+
+    /* the timer of the entry removes it after a second */
+    tevent_loop_once(test_ctx->ev);
+
+    ret = pac_cache_check(test_ctx->cache, test_pac, sizeof(test_pac));
+    assert_int_equal(ret, ENOENT);
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_pac_cache_hit,
+                                        pac_cache_test_setup,
+                                        pac_cache_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pac_cache_changed,
+                                        pac_cache_test_setup,
+                                        pac_cache_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pac_cache_invalid,
+                                        pac_cache_test_setup,
+                                        pac_cache_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pac_cache_expired,
+                                        pac_cache_test_setup,
+                                        pac_cache_test_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        switch (opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -191,6 +191,10 @@ void test_pam_setup(struct sss_test_conf_param dom_params[],
     pam_test_ctx->rctx->cdb = pam_test_ctx->tctx->confdb;
     pam_test_ctx->pctx->rctx = pam_test_ctx->rctx;
 
+    ret = pam_auth_cache_init(pam_test_ctx->pctx, pam_test_ctx->rctx->ev,
+                              &pam_test_ctx->pctx->auth_cache);
+    assert_int_equal(ret, EOK);
+
     ret = add_pam_params(pam_params, pam_test_ctx->rctx->cdb);
     assert_int_equal(ret, EOK);
 
@@ -1217,6 +1221,54 @@ void test_pam_close_session(void **state)
     assert_int_equal(ret, EOK);
 }
 
+void test_pam_session_same_connection(void **state)
+{
+    int ret;
+
+    mock_input_pam(pam_test_ctx, "pamuser", NULL, NULL);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_OPEN_SESSION);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    pam_test_ctx->exp_pam_status = _PAM_RETURN_VALUES;
+    set_cmd_cb(test_pam_simple_check);
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_OPEN_SESSION,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    /* The user found by the first request of the connection is used by the
+     * next one, it is not looked up in the cache again */
+    ret = sysdb_delete_user(pam_test_ctx->tctx->dom,
+                            pam_test_ctx->pam_user_fqdn, 0);
+    assert_int_equal(ret, EOK);
+
+    pam_test_ctx->tctx->done = false;
+
+    mock_input_pam(pam_test_ctx, "pamuser", NULL, NULL);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_CLOSE_SESSION);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    pam_test_ctx->exp_pam_status = PAM_SUCCESS;
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_CLOSE_SESSION,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    /* restore the user for pam_test_teardown() */
+    ret = sysdb_add_user(pam_test_ctx->tctx->dom,
+                         pam_test_ctx->pam_user_fqdn,
+                         123, 456, "pam user",
+                         "/home/pamuser", "/bin/sh", NULL,
+                         NULL, 300, time(NULL));
+    assert_int_equal(ret, EOK);
+}
+
 void test_pam_chauthtok(void **state)
 {
     int ret;
@@ -1342,6 +1394,47 @@ void test_pam_cached_auth_wrong_pw(void **state)
     assert_true(pam_test_ctx->provider_contacted);
 }
 
+void test_pam_cached_auth_memory(void **state)
+{
+    time_t exp_date;
+    int ret;
+
+    ret = sysdb_cache_password(pam_test_ctx->tctx->dom,
+                               pam_test_ctx->pam_user_fqdn,
+                               "12345");
+    assert_int_equal(ret, EOK);
+
+    ret = pam_set_last_online_auth_with_curr_token(pam_test_ctx->tctx->dom,
+                                                   pam_test_ctx->pam_user_fqdn,
+                                                   time(NULL));
+    assert_int_equal(ret, EOK);
+
+    common_test_pam_cached_auth("12345");
+
+    /* Back end should not be contacted */
+    assert_false(pam_test_ctx->provider_contacted);
+
+    /* The verifier of the password is kept in memory */
+    ret = pam_auth_cache_check(pam_test_ctx->pctx->auth_cache,
+                               pam_test_ctx->tctx->dom,
+                               pam_test_ctx->pam_user_fqdn,
+                               "12345", &exp_date);
+    assert_int_equal(ret, EOK);
+
+    /* and removed once a different password is tried */
+    ret = pam_auth_cache_check(pam_test_ctx->pctx->auth_cache,
+                               pam_test_ctx->tctx->dom,
+                               pam_test_ctx->pam_user_fqdn,
+                               "11111", &exp_date);
+    assert_int_equal(ret, ERR_AUTH_FAILED);
+
+    ret = pam_auth_cache_check(pam_test_ctx->pctx->auth_cache,
+                               pam_test_ctx->tctx->dom,
+                               pam_test_ctx->pam_user_fqdn,
+                               "12345", &exp_date);
+    assert_int_equal(ret, ENOENT);
+}
+
 /* test cached_auth_timeout option */
 void test_pam_cached_auth_opt_timeout(void **state)
 {
@@ -2062,6 +2155,36 @@ void test_pam_preauth_cert_match(void **state)
     assert_int_equal(ret, EOK);
 }
 
+/* Same as test_pam_preauth_cert_match but with a p11_child running as
+ * service */
+void test_pam_preauth_cert_match_service(void **state)
+{
+    int ret;
+
+    set_cert_auth_param(pam_test_ctx->pctx, CA_DB);
+
+    ret = p11_child_service_init(pam_test_ctx->pctx, pam_test_ctx->tctx->ev,
+                                 &pam_test_ctx->pctx->p11_service);
+    assert_int_equal(ret, EOK);
+
+    mock_input_pam_cert(pam_test_ctx, "pamuser", NULL, NULL, NULL, NULL, NULL,
+                        NULL, test_lookup_by_cert_cb, SSSD_TEST_CERT_0001);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_PREAUTH);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    set_cmd_cb(test_pam_cert_check);
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_PREAUTH,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    /* Wait until the test finishes with EOK */
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    talloc_zfree(pam_test_ctx->pctx->p11_service);
+}
+
 /* Test if PKCS11_LOGIN_TOKEN_NAME is added for the gdm-smartcard service */
 void test_pam_preauth_cert_match_gdm_smartcard(void **state)
 {
@@ -3182,6 +3305,8 @@ int main(int argc, const char *argv[])
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_close_session,
                                         pam_test_setup, pam_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pam_session_same_connection,
+                                        pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_chauthtok,
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_chauthtok_prelim,
@@ -3235,6 +3360,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_pam_cached_auth_wrong_pw,
                                         pam_cached_test_setup,
                                         pam_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pam_cached_auth_memory,
+                                        pam_cached_test_setup,
+                                        pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_cached_auth_opt_timeout,
                                         pam_cached_test_setup,
                                         pam_test_teardown),
@@ -3254,6 +3382,8 @@ int main(int argc, const char *argv[])
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match,
                                         pam_test_setup, pam_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match_service,
+                                        pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match_gdm_smartcard,
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match_wrong_user,
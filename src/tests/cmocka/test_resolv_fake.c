@@ -39,6 +39,9 @@
 #define TEST_BUFSIZE         1024
 #define TEST_DEFAULT_TIMEOUT 5
 #define TEST_SRV_QUERY "_ldap._tcp.sssd.com"
+#define TEST_HOST "ldap.sssd.com"
+#define TEST_HOST_ADDR "192.168.1.10"
+#define TEST_HOST_TTL 600
 
 static TALLOC_CTX *global_mock_context = NULL;
 
@@ -189,6 +192,122 @@ unsigned char *create_srv_buffer(TALLOC_CTX *mem_ctx,
     return buf_head;
 }
 
+static ssize_t add_a_rr(const char *question, const char *address,
+                        uint32_t ttl, uint8_t *answer, size_t anslen)
+{
+    uint8_t *a = answer;
+    ssize_t resp_size;
+    int ret;
+
+    resp_size = add_rr_common(ns_t_a, ttl, sizeof(struct in_addr),
+                              question, anslen, &a);
+
+    ret = inet_pton(AF_INET, address, a);
+    assert_int_equal(ret, 1);
+
+    return resp_size;
+}
+
+static ssize_t add_soa_rr(const char *zone, uint32_t ttl, uint32_t minimum,
+                          uint8_t *answer, size_t anslen)
+{
+    uint8_t *a = answer;
+    ssize_t resp_size;
+    unsigned char mname[MAXDNAME];
+    unsigned char rname[MAXDNAME];
+    ssize_t mname_len;
+    ssize_t rname_len;
+
+    mname_len = ns_name_compress("ns.sssd.com", mname, MAXDNAME, NULL, NULL);
+    assert_int_not_equal(mname_len, -1);
+    rname_len = ns_name_compress("hostmaster.sssd.com", rname, MAXDNAME,
+                                 NULL, NULL);
+    assert_int_not_equal(rname_len, -1);
+
+    resp_size = add_rr_common(ns_t_soa, ttl,
+                              mname_len + rname_len + 5 * sizeof(uint32_t),
+                              zone, anslen, &a);
+
+    memcpy(a, mname, mname_len);
+    a += mname_len;
+    memcpy(a, rname, rname_len);
+    a += rname_len;
+    NS_PUT32(1, a);         /* serial */
+    NS_PUT32(3600, a);      /* refresh */
+    NS_PUT32(600, a);       /* retry */
+    NS_PUT32(86400, a);     /* expire */
+    NS_PUT32(minimum, a);
+
+    return resp_size;
+}
+
+static unsigned char *create_a_buffer(TALLOC_CTX *mem_ctx,
+                                      const char *question,
+                                      const char *address,
+                                      uint32_t ttl,
+                                      size_t *_buflen)
+{
+    unsigned char *buf;
+    unsigned char *buf_head;
+    ssize_t len;
+    ssize_t total = 0;
+
+    buf = talloc_zero_array(mem_ctx, unsigned char, TEST_BUFSIZE);
+    assert_non_null(buf);
+    buf_head = buf;
+
+    len = dns_header(&buf, 1);
+    assert_true(len > 0);
+    total += len;
+
+    len = dns_question(question, ns_t_a, &buf, TEST_BUFSIZE - total);
+    assert_true(len > 0);
+    total += len;
+
+    len = add_a_rr(question, address, ttl, buf, TEST_BUFSIZE - total);
+    assert_true(len > 0);
+    total += len;
+
+    *_buflen = total;
+    return buf_head;
+}
+
+/* A NXDOMAIN answer with the SOA record of the zone in the authority
+ * section */
+static unsigned char *create_nxdomain_buffer(TALLOC_CTX *mem_ctx,
+                                             const char *question,
+                                             uint32_t soa_ttl,
+                                             uint32_t soa_minimum,
+                                             size_t *_buflen)
+{
+    unsigned char *buf;
+    unsigned char *buf_head;
+    ssize_t len;
+    ssize_t total = 0;
+
+    buf = talloc_zero_array(mem_ctx, unsigned char, TEST_BUFSIZE);
+    assert_non_null(buf);
+    buf_head = buf;
+
+    len = dns_header(&buf, 0);
+    assert_true(len > 0);
+    total += len;
+    /* one record in the authority section */
+    buf_head[9] = 1;
+
+    len = dns_question(question, ns_t_a, &buf, TEST_BUFSIZE - total);
+    assert_true(len > 0);
+    total += len;
+
+    len = add_soa_rr("sssd.com", soa_ttl, soa_minimum, buf,
+                     TEST_BUFSIZE - total);
+    assert_true(len > 0);
+    total += len;
+
+    *_buflen = total;
+    return buf_head;
+}
+
 struct fake_ares_query {
     int status;
     int timeouts;
@@ -217,12 +336,39 @@ void __wrap_ares_query(ares_channel channel, const char *name, int dnsclass,
     callback(arg, query.status, query.timeouts, query.abuf, query.alen);
 }
 
+void mock_ares_search(int status, int timeouts, unsigned char *abuf,
+                      int alen)
+{
+    will_return(__wrap_ares_search, status);
+    will_return(__wrap_ares_search, timeouts);
+    will_return(__wrap_ares_search, abuf);
+    will_return(__wrap_ares_search, alen);
+}
+
+void __wrap_ares_search(ares_channel channel, const char *name, int dnsclass,
+                        int type, ares_callback callback, void *arg)
+{
+    struct fake_ares_query query;
+
+    query.status = sss_mock_type(int);
+    query.timeouts = sss_mock_type(int);
+    query.abuf = sss_mock_ptr_type(unsigned char *);
+    query.alen = sss_mock_type(int);
+
+    callback(arg, query.status, query.timeouts, query.abuf, query.alen);
+}
+
 /* The unit test */
 struct resolv_fake_ctx {
     struct resolv_ctx *resolv;
     struct sss_test_ctx *ctx;
+
+    int pending;
+    errno_t expected;
 };
 
+static enum host_database test_dns_only[] = { DB_DNS, DB_SENTINEL };
+
 static int test_resolv_fake_setup(void **state)
 {
     struct resolv_fake_ctx *test_ctx;
@@ -334,6 +480,143 @@ void test_resolv_fake_srv(void **state)
     assert_int_equal(ret, ERR_OK);
 }
 
+static void test_resolv_fake_cache_done(struct tevent_req *req)
+{
+    struct resolv_fake_ctx *test_ctx =
+        tevent_req_callback_data(req, struct resolv_fake_ctx);
+    struct resolv_hostent *rhostent = NULL;
+    char *address;
+    errno_t ret;
+    int status;
+
+    ret = resolv_gethostbyname_recv(req, test_ctx, &status, NULL, &rhostent);
+    talloc_zfree(req);
+    assert_int_equal(ret, test_ctx->expected);
+
+    if (ret == EOK) {
+        assert_non_null(rhostent);
+        assert_int_equal(rhostent->family, AF_INET);
+        address = resolv_get_string_address(test_ctx, rhostent);
+        assert_non_null(address);
+        assert_string_equal(address, TEST_HOST_ADDR);
+        assert_true(rhostent->addr_list[0]->ttl <= TEST_HOST_TTL);
+        assert_true(rhostent->addr_list[0]->ttl >= TEST_HOST_TTL - 5);
+        talloc_free(address);
+        talloc_free(rhostent);
+    }
+
+    test_ctx->pending--;
+    if (test_ctx->pending == 0) {
+        test_ev_done(test_ctx->ctx, EOK);
+    }
+}
+
+static void test_resolv_fake_cache_lookup(struct resolv_fake_ctx *test_ctx,
+                                          const char *name, int count,
+                                          errno_t expected)
+{
+    struct tevent_req *req;
+    errno_t ret;
+    int i;
+
+    test_ctx->ctx->done = false;
+    test_ctx->pending = count;
+    test_ctx->expected = expected;
+
+    for (i = 0; i < count; i++) {
+        req = resolv_gethostbyname_send(test_ctx, test_ctx->ctx->ev,
+                                        test_ctx->resolv, name,
+                                        IPV4_ONLY, test_dns_only);
+        assert_non_null(req);
+        tevent_req_set_callback(req, test_resolv_fake_cache_done, test_ctx);
+    }
+
+    ret = test_ev_loop(test_ctx->ctx);
+    assert_int_equal(ret, EOK);
+}
+
+void test_resolv_fake_cache(void **state)
+{
+    struct resolv_fake_ctx *test_ctx =
+        talloc_get_type(*state, struct resolv_fake_ctx);
+    struct resolv_cache_stats stats;
+    unsigned char *buf;
+    size_t buflen;
+    errno_t ret;
+
+    ret = resolv_cache_init(test_ctx->resolv, 16);
+    assert_int_equal(ret, EOK);
+
+    /* Two concurrent lookups share a single query */
+    buf = create_a_buffer(test_ctx, TEST_HOST, TEST_HOST_ADDR,
+                          TEST_HOST_TTL, &buflen);
+    mock_ares_search(ARES_SUCCESS, 0, buf, buflen);
+    test_resolv_fake_cache_lookup(test_ctx, TEST_HOST, 2, EOK);
+
+    /* The next one is answered from the cache without any query */
+    test_resolv_fake_cache_lookup(test_ctx, TEST_HOST, 1, EOK);
+
+    resolv_cache_get_stats(test_ctx->resolv, &stats);
+    assert_int_equal(stats.lookups, 3);
+    assert_int_equal(stats.misses, 1);
+    assert_int_equal(stats.coalesced, 1);
+    assert_int_equal(stats.hits, 1);
+    assert_int_equal(stats.negative_hits, 0);
+
+    /* Flushing the cache forces a new query */
+    resolv_cache_flush(test_ctx->resolv);
+    mock_ares_search(ARES_SUCCESS, 0, buf, buflen);
+    test_resolv_fake_cache_lookup(test_ctx, TEST_HOST, 1, EOK);
+
+    resolv_cache_get_stats(test_ctx->resolv, &stats);
+    assert_int_equal(stats.misses, 2);
+}
+
+void test_resolv_fake_cache_negative(void **state)
+{
+    struct resolv_fake_ctx *test_ctx =
+        talloc_get_type(*state, struct resolv_fake_ctx);
+    struct resolv_cache_stats stats;
+    unsigned char *buf;
+    size_t buflen;
+    errno_t ret;
+
+    ret = resolv_cache_init(test_ctx->resolv, 16);
+    assert_int_equal(ret, EOK);
+
+    /* A name that does not exist is cached for the negative TTL */
+    buf = create_nxdomain_buffer(test_ctx, "missing.sssd.com", 3600, 60,
+                                 &buflen);
+    mock_ares_search(ARES_ENOTFOUND, 0, buf, buflen);
+    test_resolv_fake_cache_lookup(test_ctx, "missing.sssd.com", 1, ENOENT);
+    test_resolv_fake_cache_lookup(test_ctx, "missing.sssd.com", 1, ENOENT);
+
+    resolv_cache_get_stats(test_ctx->resolv, &stats);
+    assert_int_equal(stats.misses, 1);
+    assert_int_equal(stats.negative_hits, 1);
+
+    /* Even without the SOA record */
+    mock_ares_search(ARES_ENOTFOUND, 0, NULL, 0);
+    test_resolv_fake_cache_lookup(test_ctx, "nosoa.sssd.com", 1, ENOENT);
+    test_resolv_fake_cache_lookup(test_ctx, "nosoa.sssd.com", 1, ENOENT);
+
+    resolv_cache_get_stats(test_ctx->resolv, &stats);
+    assert_int_equal(stats.misses, 2);
+    assert_int_equal(stats.negative_hits, 2);
+
+    /* A zone that forbids negative caching is asked every time */
+    buf = create_nxdomain_buffer(test_ctx, "nocache.sssd.com", 3600, 0,
+                                 &buflen);
+    mock_ares_search(ARES_ENOTFOUND, 0, buf, buflen);
+    test_resolv_fake_cache_lookup(test_ctx, "nocache.sssd.com", 1, ENOENT);
+    mock_ares_search(ARES_ENOTFOUND, 0, buf, buflen);
+    test_resolv_fake_cache_lookup(test_ctx, "nocache.sssd.com", 1, ENOENT);
+
+    resolv_cache_get_stats(test_ctx->resolv, &stats);
+    assert_int_equal(stats.misses, 4);
+    assert_int_equal(stats.negative_hits, 2);
+}
+
 void test_resolv_is_address(void **state)
 {
     bool ret;
@@ -372,6 +655,12 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_resolv_fake_srv,
                                         test_resolv_fake_setup,
                                         test_resolv_fake_teardown),
+        cmocka_unit_test_setup_teardown(test_resolv_fake_cache,
+                                        test_resolv_fake_setup,
+                                        test_resolv_fake_teardown),
+        cmocka_unit_test_setup_teardown(test_resolv_fake_cache_negative,
+                                        test_resolv_fake_setup,
+                                        test_resolv_fake_teardown),
         cmocka_unit_test(test_resolv_is_address),
     };
 
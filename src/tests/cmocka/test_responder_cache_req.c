@@ -30,6 +30,7 @@
 
 #define TESTS_PATH "tp_" BASE_FILE_STEM
 #define TEST_CONF_DB "test_responder_cache_req_conf.ldb"
+#define TEST_SHARED_CACHE TESTS_PATH "/object_cache.mcache"
 #define TEST_DOM_NAME "responder_cache_req_test"
 #define TEST_ID_PROVIDER "ldap"
 
@@ -124,6 +125,7 @@ struct cache_req_test_ctx {
 
     struct cache_req_result *result;
     bool dp_called;
+    int num_done;
 
     /* NOTE: Please, instead of adding new create_[user|group] bool,
      * use bitshift. */
@@ -133,6 +135,9 @@ struct cache_req_test_ctx {
     bool create_group2;
     bool create_subgroup1;
     bool create_subuser1;
+
+    /* Bit n stores user1 in domains[n] when that domain is asked */
+    uint32_t create_user1_in;
 };
 
 const char *domains[] = {"responder_cache_req_test_a",
@@ -164,6 +169,22 @@ static void cache_req_user_by_name_test_done(struct tevent_req *req)
     ctx->tctx->done = true;
 }
 
+static void cache_req_user_by_name_coalesced_done(struct tevent_req *req)
+{
+    struct cache_req_test_ctx *ctx = NULL;
+
+    ctx = tevent_req_callback_data(req, struct cache_req_test_ctx);
+
+    talloc_zfree(ctx->result);
+    ctx->tctx->error = cache_req_user_by_name_recv(ctx, req, &ctx->result);
+    talloc_zfree(req);
+
+    ctx->num_done++;
+    if (ctx->num_done == 2 || ctx->tctx->error != EOK) {
+        ctx->tctx->done = true;
+    }
+}
+
 static void cache_req_user_by_id_test_done(struct tevent_req *req)
 {
     struct cache_req_test_ctx *ctx = NULL;
@@ -520,10 +541,18 @@ __wrap_sss_dp_get_account_send(TALLOC_CTX *mem_ctx,
                                const char *extra)
 {
     struct cache_req_test_ctx *ctx = NULL;
+    size_t i;
 
     ctx = sss_mock_ptr_type(struct cache_req_test_ctx*);
     ctx->dp_called = true;
 
+    for (i = 0; domains[i] != NULL; i++) {
+        if ((ctx->create_user1_in & (1 << i)) != 0
+                && strcmp(dom->name, domains[i]) == 0) {
+            prepare_user(dom, &users[0], 1000, time(NULL));
+        }
+    }
+
     if (ctx->create_user1) {
         prepare_user(ctx->tctx->dom, &users[0], 1000, time(NULL));
     }
@@ -782,6 +811,126 @@ void test_user_by_name_multiple_domains_found(void **state)
     check_user(test_ctx, &users[0], domain);
 }
 
+void test_user_by_name_multiple_domains_parallel(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+    struct sss_domain_info *domain = NULL;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+    test_ctx->rctx->cache_first = true;
+    test_ctx->rctx->parallel_domain_lookup = true;
+
+    domain = find_domain_by_name(test_ctx->tctx->dom,
+                                 "responder_cache_req_test_b", true);
+    assert_non_null(domain);
+
+    /* The second and the last domain have the user. Searching one domain
+     * after another would stop at the second one, in parallel all four
+     * domains are asked at once. */
+    test_ctx->create_user1_in = (1 << 1) | (1 << 3);
+    will_return_count(__wrap_sss_dp_get_account_send, test_ctx, 4);
+    will_return_always(sss_dp_get_account_recv, 0);
+    mock_parse_inp(users[0].short_name, NULL, ERR_OK);
+
+    /* The result is still the one of the first domain in the resolution
+     * order that has the user. */
+    run_user_by_name(test_ctx, NULL, 0, ERR_OK);
+    assert_true(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], domain);
+
+    /* The next lookup is answered from the cache */
+    test_ctx->dp_called = false;
+    mock_parse_inp(users[0].short_name, NULL, ERR_OK);
+
+    run_user_by_name(test_ctx, NULL, 0, ERR_OK);
+    assert_false(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], domain);
+}
+
+void test_user_by_name_multiple_domains_parallel_expired(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+    struct sss_domain_info *domain = NULL;
+    uint64_t expire;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+    test_ctx->rctx->cache_first = true;
+    test_ctx->rctx->parallel_domain_lookup = true;
+
+    domain = find_domain_by_name(test_ctx->tctx->dom,
+                                 "responder_cache_req_test_c", true);
+    assert_non_null(domain);
+
+    /* The cached user of the third domain has expired, the cache only
+     * pass skips it and the parallel pass refreshes it. */
+    prepare_user(domain, &users[0], 1000, time(NULL) - 2000);
+
+    test_ctx->create_user1_in = 1 << 2;
+    will_return_count(__wrap_sss_dp_get_account_send, test_ctx, 4);
+    will_return_always(sss_dp_get_account_recv, 0);
+    mock_parse_inp(users[0].short_name, NULL, ERR_OK);
+
+    run_user_by_name(test_ctx, NULL, 0, ERR_OK);
+    assert_true(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], domain);
+
+    expire = ldb_msg_find_attr_as_uint64(test_ctx->result->msgs[0],
+                                         SYSDB_CACHE_EXPIRE, 0);
+    assert_true(expire > time(NULL));
+}
+
+static void build_prefilter(struct cache_req_test_ctx *test_ctx)
+{
+    struct sss_domain_info *dom;
+    errno_t ret;
+
+    ret = cache_req_prefilter_init(test_ctx->rctx, 60);
+    assert_int_equal(ret, EOK);
+
+    /* One domain is rebuilt per event and one more event finishes the
+     * round, the next one only comes after the interval. */
+    for (dom = test_ctx->rctx->domains; dom != NULL;
+            dom = get_next_domain(dom, SSS_GND_DESCEND)) {
+        assert_int_equal(tevent_loop_once(test_ctx->tctx->ev), 0);
+    }
+    assert_int_equal(tevent_loop_once(test_ctx->tctx->ev), 0);
+}
+
+void test_user_by_name_multiple_domains_prefilter(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+    struct sss_domain_info *domain = NULL;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+    test_ctx->rctx->cache_first = true;
+
+    domain = find_domain_by_name(test_ctx->tctx->dom,
+                                 "responder_cache_req_test_d", true);
+    assert_non_null(domain);
+
+    /* The user is cached after the filters were built, the cache only
+     * pass skips it and the data provider pass finds it. */
+    build_prefilter(test_ctx);
+    prepare_user(domain, &users[0], 1000, time(NULL));
+
+    will_return_always(__wrap_sss_dp_get_account_send, test_ctx);
+    will_return_always(sss_dp_get_account_recv, 0);
+    mock_parse_inp(users[0].short_name, NULL, ERR_OK);
+
+    run_user_by_name(test_ctx, NULL, 0, ERR_OK);
+    assert_true(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], domain);
+
+    /* Once the filters know the user, it is returned from the cache. */
+    build_prefilter(test_ctx);
+    test_ctx->dp_called = false;
+    mock_parse_inp(users[0].short_name, NULL, ERR_OK);
+
+    run_user_by_name(test_ctx, NULL, 0, ERR_OK);
+    assert_false(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], domain);
+}
+
 void test_user_by_name_multiple_domains_notfound(void **state)
 {
     struct cache_req_test_ctx *test_ctx = NULL;
@@ -902,6 +1051,28 @@ void test_user_by_name_cache_expired(void **state)
     check_user(test_ctx, &users[0], test_ctx->tctx->dom);
 }
 
+void test_user_by_name_cache_expired_degraded(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+
+    /* Setup user. */
+    prepare_user(test_ctx->tctx->dom, &users[0], -1000, time(NULL));
+    test_ctx->tctx->dom->degraded = true;
+
+    /* Mock values. */
+    /* DP should be contacted without callback */
+    will_return(__wrap_sss_dp_get_account_send, test_ctx);
+
+    /* Test. */
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    assert_true(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], test_ctx->tctx->dom);
+
+    test_ctx->tctx->dom->degraded = false;
+}
+
 void test_user_by_name_cache_midpoint(void **state)
 {
     struct cache_req_test_ctx *test_ctx = NULL;
@@ -978,6 +1149,250 @@ void test_user_by_name_missing_notfound(void **state)
     assert_true(test_ctx->dp_called);
 }
 
+static int create_user1_cb(void *pvt)
+{
+    struct cache_req_test_ctx *ctx;
+
+    ctx = talloc_get_type_abort(pvt, struct cache_req_test_ctx);
+    prepare_user(ctx->tctx->dom, &users[0], 1000, time(NULL));
+
+    return EOK;
+}
+
+void test_user_by_name_missing_coalesced(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+    TALLOC_CTX *req_mem_ctx;
+    struct tevent_req *req;
+    errno_t ret;
+    int i;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+
+    /* Mock values. The user is stored when the only data provider
+     * request finishes, so both requests miss the cache first. */
+    will_return(__wrap_sss_dp_get_account_send, test_ctx);
+    mock_account_recv(0, 0, NULL, create_user1_cb, test_ctx);
+
+    /* Test. */
+    req_mem_ctx = talloc_new(global_talloc_context);
+    check_leaks_push(req_mem_ctx);
+
+    for (i = 0; i < 2; i++) {
+        req = cache_req_user_by_name_send(req_mem_ctx, test_ctx->tctx->ev,
+                                          test_ctx->rctx, test_ctx->ncache, 0,
+                                          CACHE_REQ_POSIX_DOM,
+                                          test_ctx->tctx->dom->name,
+                                          users[0].short_name);
+        assert_non_null(req);
+        tevent_req_set_callback(req, cache_req_user_by_name_coalesced_done,
+                                test_ctx);
+    }
+
+    ret = test_ev_loop(test_ctx->tctx);
+    assert_int_equal(ret, ERR_OK);
+    assert_int_equal(test_ctx->num_done, 2);
+    assert_true(check_leaks_pop(req_mem_ctx));
+    talloc_free(req_mem_ctx);
+
+    assert_true(test_ctx->dp_called);
+    assert_int_equal(test_ctx->rctx->cache_req_coalesced, 1);
+    check_user(test_ctx, &users[0], test_ctx->tctx->dom);
+}
+
+void test_user_by_name_object_cache(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+    uint64_t entries;
+    uint64_t hits;
+    uint64_t misses;
+    char *fqname;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+
+    ret = cache_req_hot_init(test_ctx->rctx, 1024 * 1024, 60);
+    assert_int_equal(ret, EOK);
+
+    /* Setup user. */
+    prepare_user(test_ctx->tctx->dom, &users[0], 1000, time(NULL));
+
+    /* The first lookup reads the cache and keeps a copy of the user. */
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    check_user(test_ctx, &users[0], test_ctx->tctx->dom);
+
+    /* The copy is returned even when the user is gone from the cache. */
+    fqname = sss_create_internal_fqname(test_ctx, users[0].short_name,
+                                        test_ctx->tctx->dom->name);
+    assert_non_null(fqname);
+    ret = sysdb_delete_user(test_ctx->tctx->dom, fqname, 0);
+    talloc_free(fqname);
+    assert_int_equal(ret, EOK);
+
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    assert_false(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], test_ctx->tctx->dom);
+
+    cache_req_hot_stats(test_ctx->rctx, &entries, &hits, &misses);
+    assert_int_equal(entries, 1);
+    assert_int_equal(hits, 1);
+    assert_int_equal(misses, 1);
+
+    /* After a flush the lookup goes to the cache and data provider. */
+    cache_req_hot_flush(test_ctx->rctx);
+
+    will_return(__wrap_sss_dp_get_account_send, test_ctx);
+    mock_account_recv_simple();
+
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ENOENT);
+    assert_true(test_ctx->dp_called);
+}
+
+static uint64_t get_user_expire(struct cache_req_test_ctx *test_ctx,
+                                struct test_user *user)
+{
+    struct ldb_result *res;
+    uint64_t expire;
+    char *fqname;
+    errno_t ret;
+
+    fqname = sss_create_internal_fqname(test_ctx, user->short_name,
+                                        test_ctx->tctx->dom->name);
+    assert_non_null(fqname);
+
+    ret = sysdb_getpwnam(test_ctx, test_ctx->tctx->dom, fqname, &res);
+    talloc_free(fqname);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+
+    expire = ldb_msg_find_attr_as_uint64(res->msgs[0],
+                                         SYSDB_CACHE_EXPIRE, 0);
+    talloc_free(res);
+
+    return expire;
+}
+
+static void run_prefetch(struct cache_req_test_ctx *test_ctx)
+{
+    uint64_t tracked;
+    uint64_t pending;
+
+    cache_req_prefetch_check(test_ctx->rctx);
+
+    do {
+        cache_req_prefetch_stats(test_ctx->rctx, &tracked, &pending);
+        if (pending > 0) {
+            assert_int_equal(tevent_loop_once(test_ctx->tctx->ev), 0);
+        }
+    } while (pending > 0);
+}
+
+void test_user_by_name_prefetch(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+    uint64_t tracked;
+    uint64_t pending;
+    time_t now;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+
+    ret = cache_req_prefetch_init(test_ctx->rctx, 2);
+    assert_int_equal(ret, EOK);
+
+    /* Both users expire within the next minute, the group does not. */
+    now = time(NULL);
+    prepare_user(test_ctx->tctx->dom, &users[0], 30, now);
+    prepare_user(test_ctx->tctx->dom, &users[1], 30, now);
+    prepare_group(test_ctx->tctx->dom, &groups[0], 1000, now);
+
+    /* The first user is looked up often enough to be refreshed. */
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    run_cache_req_domtype(test_ctx, cache_req_user_by_name_send,
+                          cache_req_user_by_name_test_done,
+                          test_ctx->tctx->dom, 0, CACHE_REQ_POSIX_DOM,
+                          users[1].short_name, ERR_OK);
+    run_group_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    assert_false(test_ctx->dp_called);
+
+    cache_req_prefetch_stats(test_ctx->rctx, &tracked, &pending);
+    assert_int_equal(tracked, 3);
+    assert_int_equal(pending, 0);
+
+    /* Only the first user is refreshed, a second refresh would fail on
+     * the missing mock values. */
+    test_ctx->create_user1 = true;
+    will_return(__wrap_sss_dp_get_account_send, test_ctx);
+    mock_account_recv_simple();
+
+    run_prefetch(test_ctx);
+    assert_true(test_ctx->dp_called);
+    assert_true(get_user_expire(test_ctx, &users[0]) > now + 60);
+    assert_true(get_user_expire(test_ctx, &users[1]) <= now + 30);
+
+    /* Both users are forgotten, the group is still tracked. */
+    cache_req_prefetch_stats(test_ctx->rctx, &tracked, &pending);
+    assert_int_equal(tracked, 1);
+    assert_int_equal(pending, 0);
+
+    /* Nothing expires soon anymore, so nothing is refreshed. */
+    test_ctx->dp_called = false;
+    run_prefetch(test_ctx);
+    assert_false(test_ctx->dp_called);
+
+    talloc_zfree(test_ctx->rctx->cache_req_prefetch);
+}
+
+void test_user_by_name_shared_object_cache(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+    char *fqname;
+    errno_t ret;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+
+    ret = cache_req_shared_init(test_ctx->rctx, TEST_SHARED_CACHE, 60);
+    assert_int_equal(ret, EOK);
+
+    /* Setup user. */
+    prepare_user(test_ctx->tctx->dom, &users[0], 1000, time(NULL));
+
+    /* The first lookup reads the cache and stores the user in the file. */
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    check_user(test_ctx, &users[0], test_ctx->tctx->dom);
+
+    fqname = sss_create_internal_fqname(test_ctx, users[0].short_name,
+                                        test_ctx->tctx->dom->name);
+    assert_non_null(fqname);
+    ret = sysdb_delete_user(test_ctx->tctx->dom, fqname, 0);
+    talloc_free(fqname);
+    assert_int_equal(ret, EOK);
+
+    /* Another mapping of the file, as in another responder, finds the
+     * user although it is gone from the cache. */
+    ret = cache_req_shared_init(test_ctx->rctx, TEST_SHARED_CACHE, 60);
+    assert_int_equal(ret, EOK);
+
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ERR_OK);
+    assert_false(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], test_ctx->tctx->dom);
+
+    /* After the invalidation the lookup goes to the cache and data
+     * provider. */
+    cache_req_shared_invalidate(test_ctx->rctx);
+
+    will_return(__wrap_sss_dp_get_account_send, test_ctx);
+    mock_account_recv_simple();
+
+    run_user_by_name(test_ctx, test_ctx->tctx->dom, 0, ENOENT);
+    assert_true(test_ctx->dp_called);
+
+    talloc_zfree(test_ctx->rctx->cache_req_shared);
+    ret = unlink(TEST_SHARED_CACHE);
+    assert_int_equal(ret, 0);
+}
+
 void test_user_by_name_multiple_domains_requested_domains_found(void **state)
 {
     struct cache_req_test_ctx *test_ctx = NULL;
@@ -1190,6 +1605,27 @@ void test_user_by_upn_missing_notfound(void **state)
     assert_true(test_ctx->dp_called);
 }
 
+void test_user_by_upn_qualified_parallel(void **state)
+{
+    struct cache_req_test_ctx *test_ctx = NULL;
+
+    test_ctx = talloc_get_type_abort(*state, struct cache_req_test_ctx);
+    test_ctx->rctx->parallel_domain_lookup = true;
+
+    /* The UPN is parsed as a name of the domain. The name and the UPN
+     * are both looked up in the data provider, the name is not found. */
+    will_return_always(__wrap_sss_dp_get_account_send, test_ctx);
+    will_return_always(sss_dp_get_account_recv, 0);
+    mock_parse_inp("upn1", test_ctx->tctx->dom->name, ERR_OK);
+
+    test_ctx->create_user1 = true;
+
+    /* Test. */
+    run_user_by_upn(test_ctx, NULL, 0, ERR_OK);
+    assert_true(test_ctx->dp_called);
+    check_user(test_ctx, &users[0], test_ctx->tctx->dom);
+}
+
 void test_user_by_id_multiple_domains_found(void **state)
 {
     struct cache_req_test_ctx *test_ctx = NULL;
@@ -4215,12 +4651,20 @@ int main(int argc, const char *argv[])
     const struct CMUnitTest tests[] = {
         new_single_domain_test(user_by_name_cache_valid),
         new_single_domain_test(user_by_name_cache_expired),
+        new_single_domain_test(user_by_name_cache_expired_degraded),
         new_single_domain_test(user_by_name_cache_midpoint),
         new_single_domain_test(user_by_name_ncache),
         new_single_domain_test(user_by_name_missing_found),
         new_single_domain_test(user_by_name_missing_notfound),
+        new_single_domain_test(user_by_name_missing_coalesced),
+        new_single_domain_test(user_by_name_object_cache),
+        new_single_domain_test(user_by_name_shared_object_cache),
+        new_single_domain_test(user_by_name_prefetch),
         new_multi_domain_test(user_by_name_multiple_domains_found),
         new_multi_domain_test(user_by_name_multiple_domains_notfound),
+        new_multi_domain_test(user_by_name_multiple_domains_parallel),
+        new_multi_domain_test(user_by_name_multiple_domains_parallel_expired),
+        new_multi_domain_test(user_by_name_multiple_domains_prefilter),
         new_multi_domain_test(user_by_name_multiple_domains_parse),
         new_multi_domain_test(user_by_name_multiple_domains_requested_domains_found),
         new_multi_domain_test(user_by_name_multiple_domains_requested_domains_notfound),
@@ -4231,6 +4675,7 @@ int main(int argc, const char *argv[])
         new_single_domain_test(user_by_upn_ncache),
         new_single_domain_test(user_by_upn_missing_found),
         new_single_domain_test(user_by_upn_missing_notfound),
+        new_single_domain_test(user_by_upn_qualified_parallel),
         new_multi_domain_test(user_by_upn_multiple_domains_found),
         new_multi_domain_test(user_by_upn_multiple_domains_notfound),
 
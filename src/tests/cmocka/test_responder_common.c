@@ -24,9 +24,12 @@
 #include <tevent.h>
 #include <errno.h>
 #include <popt.h>
+#include <sys/socket.h>
 
 #include "tests/cmocka/common_mock.h"
 #include "tests/cmocka/common_mock_resp.h"
+#include "responder/common/responder_packet.h"
+#include "util/util_creds.h"
 
 #define TESTS_PATH "tp_" BASE_FILE_STEM
 #define TEST_CONF_DB "test_responder_conf.ldb"
@@ -288,8 +291,714 @@ void test_sss_output_fqname(void **state)
     assert_int_equal(6, res->len);
 
     talloc_zfree(res);
+
+    /* The second time the name comes from the cache of the domain */
+    assert_non_null(parse_inp_ctx->tctx->dom->output_names);
+    ret = sized_output_name(parse_inp_ctx, parse_inp_ctx->rctx, "dummy",
+                            parse_inp_ctx->tctx->dom, &res);
+    assert_int_equal(ret, EOK);
+    assert_non_null(res);
+    assert_string_equal("dummy", res->str);
+    assert_int_equal(6, res->len);
+    talloc_zfree(res);
+
+    /* The cached names are dropped when the output format changes */
+    sss_domain_info_set_output_fqnames(parse_inp_ctx->tctx->dom, true);
+    ret = sized_output_name(parse_inp_ctx, parse_inp_ctx->rctx,
+                            "dummy@" TEST_DOM_NAME,
+                            parse_inp_ctx->tctx->dom, &res);
+    assert_int_equal(ret, EOK);
+    assert_string_equal("dummy@" TEST_DOM_NAME, res->str);
+    talloc_zfree(res);
+
+    ret = sized_domain_name(parse_inp_ctx, parse_inp_ctx->rctx,
+                            "dummy@" TEST_DOM_NAME, &res);
+    assert_int_equal(ret, EOK);
+    assert_string_equal("dummy@" TEST_DOM_NAME, res->str);
+    talloc_zfree(res);
+
+    ret = sized_domain_name(parse_inp_ctx, parse_inp_ctx->rctx, "dummy", &res);
+    assert_int_equal(ret, ERR_WRONG_NAME_FORMAT);
+    ret = sized_domain_name(parse_inp_ctx, parse_inp_ctx->rctx,
+                            "dummy@unknown.domain", &res);
+    assert_int_equal(ret, ERR_DOMAIN_NOT_FOUND);
+
+    sss_domain_info_set_output_fqnames(parse_inp_ctx->tctx->dom, false);
+    talloc_zfree(parse_inp_ctx->tctx->dom->output_names);
+}
+
+static void write_request(int fd, uint32_t cmd, uint32_t tag,
+                          const char *body)
+{
+    uint32_t header[4];
+    ssize_t len;
+
+    header[0] = SSS_NSS_HEADER_SIZE + strlen(body) + 1;
+    header[1] = cmd;
+    header[2] = 0;
+    header[3] = tag;
+
+    len = write(fd, header, sizeof(header));
+    assert_int_equal(len, sizeof(header));
+    len = write(fd, body, strlen(body) + 1);
+    assert_int_equal(len, strlen(body) + 1);
+}
+
+void test_sss_packet_recv_pipelined(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sss_packet *first;
+    struct sss_packet *second;
+    struct sss_packet *third;
+    uint8_t *body;
+    size_t blen;
+    int fds[2];
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert_int_equal(ret, 0);
+
+    write_request(fds[0], SSS_NSS_GETPWNAM, 1, "first");
+    write_request(fds[0], SSS_NSS_GETGRNAM, 2, "second");
+
+    ret = sss_packet_new(tmp_ctx, SSS_PACKET_MAX_RECV_SIZE, 0, &first);
+    assert_int_equal(ret, EOK);
+    ret = sss_packet_new(tmp_ctx, SSS_PACKET_MAX_RECV_SIZE, 0, &second);
+    assert_int_equal(ret, EOK);
+    ret = sss_packet_new(tmp_ctx, SSS_PACKET_MAX_RECV_SIZE, 0, &third);
+    assert_int_equal(ret, EOK);
+
+    /* Both requests are read at once, the second one must not be lost. */
+    ret = sss_packet_recv(first, fds[1]);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(sss_packet_get_cmd(first), SSS_NSS_GETPWNAM);
+    assert_int_equal(sss_packet_get_tag(first), 1);
+    sss_packet_get_body(first, &body, &blen);
+    assert_int_equal(blen, sizeof("first"));
+    assert_string_equal((char *)body, "first");
+
+    ret = sss_packet_recv_surplus(first, second);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(sss_packet_get_cmd(second), SSS_NSS_GETGRNAM);
+    assert_int_equal(sss_packet_get_tag(second), 2);
+    sss_packet_get_body(second, &body, &blen);
+    assert_int_equal(blen, sizeof("second"));
+    assert_string_equal((char *)body, "second");
+
+    /* Nothing more was sent. */
+    ret = sss_packet_recv_surplus(first, third);
+    assert_int_equal(ret, ENOENT);
+    ret = sss_packet_recv_surplus(second, third);
+    assert_int_equal(ret, ENOENT);
+
+    close(fds[0]);
+    close(fds[1]);
+    talloc_free(tmp_ctx);
+}
+
+void test_sss_packet_pool(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    TALLOC_CTX *pool_ctx;
+    struct sss_packet_pool_stats stats;
+    struct sss_packet *packet;
+    uint8_t *body;
+    size_t blen;
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+    pool_ctx = talloc_new(tmp_ctx);
+    assert_non_null(pool_ctx);
+
+    ret = sss_packet_pool_init(pool_ctx);
+    assert_int_equal(ret, EOK);
+
+    ret = sss_packet_new(tmp_ctx, 0, SSS_NSS_GETPWNAM, &packet);
+    assert_int_equal(ret, EOK);
+    talloc_free(packet);
+
+    /* the freed buffer is reused */
+    ret = sss_packet_new(tmp_ctx, 0, SSS_NSS_GETPWNAM, &packet);
+    assert_int_equal(ret, EOK);
+    sss_packet_pool_get_stats(&stats);
+    assert_int_equal(stats.hits, 1);
+    assert_int_equal(stats.misses, 1);
+    assert_int_equal(stats.num_used, 1);
+    assert_int_equal(stats.num_free, 0);
+
+    /* growing moves the content to a buffer of a larger size class */
+    ret = sss_packet_set_body(packet, (uint8_t *)"test", sizeof("test"));
+    assert_int_equal(ret, EOK);
+    ret = sss_packet_grow(packet, 2000);
+    assert_int_equal(ret, EOK);
+    sss_packet_get_body(packet, &body, &blen);
+    assert_int_equal(blen, sizeof("test") + 2000);
+    assert_string_equal((char *)body, "test");
+    assert_int_equal(sss_packet_get_cmd(packet), SSS_NSS_GETPWNAM);
+
+    sss_packet_pool_get_stats(&stats);
+    assert_int_equal(stats.misses, 2);
+    assert_int_equal(stats.num_used, 1);
+    assert_int_equal(stats.num_free, 1);
+
+    /* too large for the pool */
+    ret = sss_packet_grow(packet, 1024 * 1024);
+    assert_int_equal(ret, EOK);
+    sss_packet_get_body(packet, &body, &blen);
+    assert_string_equal((char *)body, "test");
+
+    sss_packet_pool_get_stats(&stats);
+    assert_int_equal(stats.num_used, 0);
+    assert_int_equal(stats.num_free, 2);
+    assert_int_equal(stats.used_bytes, 0);
+
+    /* packets may outlive the pool */
+    talloc_free(pool_ctx);
+    sss_packet_pool_get_stats(&stats);
+    assert_int_equal(stats.num_free, 0);
+
+    talloc_free(tmp_ctx);
+}
+
+static size_t test_cmd_pool_request(struct cli_ctx *cctx, size_t size)
+{
+    struct cli_protocol *pctx;
+    struct cli_request *creq;
+    size_t used;
+    void *data;
+    int ret;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    creq = talloc_zero(cctx, struct cli_request);
+    assert_non_null(creq);
+    ret = sss_packet_new(creq, 0, SSS_NSS_GETPWNAM, &creq->in);
+    assert_int_equal(ret, EOK);
+
+    pctx->creq = creq;
+    sss_cmd_stats_start(cctx->rctx, creq);
+    assert_non_null(creq->pool);
+    assert_ptr_equal(sss_cmd_mem_ctx(cctx), creq->pool);
+
+    data = talloc_size(sss_cmd_mem_ctx(cctx), size);
+    assert_non_null(data);
+    assert_ptr_equal(talloc_find_parent_bytype(data, struct cli_ctx), cctx);
+
+    sss_cmd_done(cctx, data);
+    used = creq->pool_used;
+
+    talloc_free(creq);
+    pctx->creq = NULL;
+
+    return used;
 }
 
+void test_sss_cmd_pool(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct resp_ctx *rctx = parse_inp_ctx->rctx;
+    struct sss_cmd_table cmds[] = {
+        { SSS_NSS_GETPWNAM, NULL },
+        { SSS_CLI_NULL, NULL }
+    };
+    struct cli_ctx *cctx;
+    errno_t ret;
+
+    rctx->sss_cmds = cmds;
+    rctx->request_pool_size = 1024;
+    ret = sss_cmd_stats_init(rctx);
+    assert_int_equal(ret, EOK);
+
+    cctx = talloc_zero(parse_inp_ctx, struct cli_ctx);
+    assert_non_null(cctx);
+    cctx->rctx = rctx;
+    cctx->protocol_ctx = talloc_zero(cctx, struct cli_protocol);
+    assert_non_null(cctx->protocol_ctx);
+
+    /* Without a request being executed the client context is used */
+    assert_ptr_equal(sss_cmd_mem_ctx(cctx), cctx);
+
+    assert_int_equal(test_cmd_pool_request(cctx, 100), 100);
+    assert_int_equal(test_cmd_pool_request(cctx, 300), 300);
+    assert_int_equal(test_cmd_pool_request(cctx, 2000), 2000);
+
+    assert_int_equal(rctx->cmd_stats[0].pool_requests, 3);
+    assert_int_equal(rctx->cmd_stats[0].pool_used_sum, 2400);
+    assert_int_equal(rctx->cmd_stats[0].pool_used_max, 2000);
+    assert_int_equal(rctx->cmd_stats[0].pool_overflows, 1);
+
+    talloc_free(cctx);
+    talloc_zfree(rctx->cmd_stats);
+    rctx->sss_cmds = NULL;
+    rctx->request_pool_size = 0;
+}
+
+static void test_cmd_stats_request(struct cli_ctx *cctx,
+                                   enum sss_cli_command cmd,
+                                   bool dp, int err, bool replied)
+{
+    struct resp_ctx *rctx = cctx->rctx;
+    struct cli_protocol *pctx;
+    struct cli_request *creq;
+    void *lookup;
+    int ret;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    creq = talloc_zero(cctx, struct cli_request);
+    assert_non_null(creq);
+    ret = sss_packet_new(creq, 0, cmd, &creq->in);
+    assert_int_equal(ret, EOK);
+    pctx->creq = creq;
+
+    sss_cmd_stats_queue(rctx, creq);
+    assert_int_equal(rctx->cmd_queued, 1);
+    assert_int_equal(rctx->cmd_in_flight, 0);
+
+    sss_cmd_stats_start(rctx, creq);
+    assert_int_equal(rctx->cmd_queued, 0);
+    assert_int_equal(rctx->cmd_in_flight, 1);
+
+    /* A lookup done on behalf of the client, like a cache request */
+    if (dp) {
+        lookup = talloc_new(cctx);
+        assert_non_null(lookup);
+        sss_cmd_stats_mark_dp(lookup);
+        talloc_free(lookup);
+    }
+
+    ret = sss_packet_new(creq, 0, cmd, &creq->out);
+    assert_int_equal(ret, EOK);
+    sss_packet_set_error(creq->out, err);
+    creq->replied = replied;
+
+    talloc_free(creq);
+    pctx->creq = NULL;
+    assert_int_equal(rctx->cmd_in_flight, 0);
+}
+
+static uint64_t test_cmd_stats_bucket_sum(struct sss_cmd_stats *stats,
+                                          enum sss_cmd_stats_result result)
+{
+    uint64_t sum = 0;
+    int i;
+
+    for (i = 0; i < SSS_CMD_STATS_BUCKETS; i++) {
+        sum += stats->buckets[result][i];
+    }
+
+    return sum;
+}
+
+void test_sss_cmd_stats(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct resp_ctx *rctx = parse_inp_ctx->rctx;
+    struct sss_cmd_table cmds[] = {
+        { SSS_NSS_GETPWNAM, NULL },
+        { SSS_NSS_GETGRNAM, NULL },
+        { SSS_CLI_NULL, NULL }
+    };
+    struct sss_cmd_stats *pw;
+    struct sss_cmd_stats *gr;
+    struct cli_request *creq;
+    struct cli_ctx *cctx;
+    void *other;
+    int r;
+    errno_t ret;
+
+    rctx->sss_cmds = cmds;
+    ret = sss_cmd_stats_init(rctx);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(talloc_array_length(rctx->cmd_stats), 2);
+    pw = &rctx->cmd_stats[0];
+    gr = &rctx->cmd_stats[1];
+
+    cctx = talloc_zero(parse_inp_ctx, struct cli_ctx);
+    assert_non_null(cctx);
+    cctx->rctx = rctx;
+    cctx->protocol_ctx = talloc_zero(cctx, struct cli_protocol);
+    assert_non_null(cctx->protocol_ctx);
+
+    test_cmd_stats_request(cctx, SSS_NSS_GETPWNAM, false, EOK, true);
+    test_cmd_stats_request(cctx, SSS_NSS_GETPWNAM, false, EOK, true);
+    test_cmd_stats_request(cctx, SSS_NSS_GETPWNAM, true, EOK, true);
+    test_cmd_stats_request(cctx, SSS_NSS_GETPWNAM, true, ENOENT, true);
+    /* The client went away before the reply was sent */
+    test_cmd_stats_request(cctx, SSS_NSS_GETGRNAM, false, EOK, false);
+    /* Commands missing in the table are not counted */
+    test_cmd_stats_request(cctx, SSS_NSS_GETPWUID, false, EOK, true);
+
+    assert_int_equal(pw->count[SSS_CMD_STATS_CACHE], 2);
+    assert_int_equal(pw->count[SSS_CMD_STATS_DP], 1);
+    assert_int_equal(pw->count[SSS_CMD_STATS_ERROR], 1);
+    assert_int_equal(gr->count[SSS_CMD_STATS_CACHE], 0);
+    assert_int_equal(gr->count[SSS_CMD_STATS_DP], 0);
+    assert_int_equal(gr->count[SSS_CMD_STATS_ERROR], 1);
+
+    /* Each request is in exactly one bucket of its result class */
+    for (r = 0; r < SSS_CMD_STATS_RESULTS; r++) {
+        assert_int_equal(test_cmd_stats_bucket_sum(pw, r), pw->count[r]);
+        assert_int_equal(test_cmd_stats_bucket_sum(gr, r), gr->count[r]);
+    }
+
+    /* A request that is dropped while waiting is not counted */
+    creq = talloc_zero(cctx, struct cli_request);
+    assert_non_null(creq);
+    sss_cmd_stats_queue(rctx, creq);
+    assert_int_equal(rctx->cmd_queued, 1);
+    talloc_free(creq);
+    assert_int_equal(rctx->cmd_queued, 0);
+    assert_int_equal(gr->count[SSS_CMD_STATS_ERROR], 1);
+
+    /* Lookups that are not done for a client are ignored */
+    other = talloc_new(parse_inp_ctx);
+    assert_non_null(other);
+    sss_cmd_stats_mark_dp(other);
+    talloc_free(other);
+
+    talloc_free(cctx);
+    talloc_zfree(rctx->cmd_stats);
+    rctx->sss_cmds = NULL;
+}
+
+void test_sss_client_reply(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct resp_ctx *rctx = parse_inp_ctx->rctx;
+    struct cli_protocol *pctx;
+    struct cli_request *creq;
+    struct cli_ctx *cctx;
+    uint8_t reply[SSS_NSS_HEADER_SIZE];
+    uint32_t len;
+    int fds[2];
+    int ret;
+
+    ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert_int_equal(ret, 0);
+
+    cctx = talloc_zero(parse_inp_ctx, struct cli_ctx);
+    assert_non_null(cctx);
+    cctx->rctx = rctx;
+    cctx->ev = rctx->ev;
+    cctx->cfd = fds[0];
+    ret = sss_connection_setup(cctx);
+    assert_int_equal(ret, EOK);
+    cctx->cfde = tevent_add_fd(cctx->ev, cctx, cctx->cfd, TEVENT_FD_READ,
+                               cctx->cfd_handler, cctx);
+    assert_non_null(cctx->cfde);
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    creq = talloc_zero(cctx, struct cli_request);
+    assert_non_null(creq);
+    ret = sss_packet_new(creq, 0, SSS_NSS_GETPWNAM, &creq->in);
+    assert_int_equal(ret, EOK);
+    ret = sss_packet_new(creq, 0, SSS_NSS_GETPWNAM, &creq->out);
+    assert_int_equal(ret, EOK);
+    pctx->creq = creq;
+
+    /* The reply is sent on the next loop iteration without waiting for
+     * the socket to be reported writeable */
+    sss_cmd_done(cctx, NULL);
+    assert_int_equal(tevent_fd_get_flags(cctx->cfde) & TEVENT_FD_WRITE, 0);
+
+    ret = tevent_loop_once(cctx->ev);
+    assert_int_equal(ret, 0);
+    assert_null(pctx->creq);
+    assert_int_equal(tevent_fd_get_flags(cctx->cfde), TEVENT_FD_READ);
+
+    ret = sss_atomic_read_s(fds[1], reply, sizeof(reply));
+    assert_int_equal(ret, sizeof(reply));
+    memcpy(&len, reply, sizeof(len));
+    assert_int_equal(len, SSS_NSS_HEADER_SIZE);
+
+    talloc_free(cctx);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static int test_client_free_destructor(bool **freed)
+{
+    **freed = true;
+    return 0;
+}
+
+static struct cli_ctx *running_request_client(TALLOC_CTX *mem_ctx,
+                                              struct resp_ctx *rctx,
+                                              int fd, bool *freed)
+{
+    struct cli_protocol *pctx;
+    struct cli_request *creq;
+    struct cli_ctx *cctx;
+    bool **marker;
+    int ret;
+
+    cctx = talloc_zero(mem_ctx, struct cli_ctx);
+    assert_non_null(cctx);
+    cctx->rctx = rctx;
+    cctx->ev = rctx->ev;
+    cctx->cfd = fd;
+    ret = sss_connection_setup(cctx);
+    assert_int_equal(ret, EOK);
+    cctx->cfde = tevent_add_fd(cctx->ev, cctx, cctx->cfd, TEVENT_FD_READ,
+                               cctx->cfd_handler, cctx);
+    assert_non_null(cctx->cfde);
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    creq = talloc_zero(cctx, struct cli_request);
+    assert_non_null(creq);
+    ret = sss_packet_new(creq, 0, SSS_NSS_GETPWNAM, &creq->in);
+    assert_int_equal(ret, EOK);
+    ret = sss_packet_new(creq, 0, SSS_NSS_GETPWNAM, &creq->out);
+    assert_int_equal(ret, EOK);
+    sss_packet_set_tag(creq->in, 1);
+    pctx->creq = creq;
+
+    /* Tells when the client context is freed */
+    *freed = false;
+    marker = talloc(cctx, bool *);
+    assert_non_null(marker);
+    *marker = freed;
+    talloc_set_destructor(marker, test_client_free_destructor);
+
+    return cctx;
+}
+
+void test_client_free_running_request(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct resp_ctx *rctx = parse_inp_ctx->rctx;
+    struct cli_protocol *pctx;
+    struct cli_ctx *cctx;
+    uint8_t reply[SSS_NSS_HEADER_SIZE];
+    int client_idle_timeout;
+    bool freed;
+    int fds[2];
+    int ret;
+
+    client_idle_timeout = rctx->client_idle_timeout;
+
+    /* The client goes away while its request is running */
+    ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert_int_equal(ret, 0);
+    cctx = running_request_client(parse_inp_ctx, rctx, fds[0], &freed);
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+
+    ret = shutdown(fds[1], SHUT_WR);
+    assert_int_equal(ret, 0);
+    ret = tevent_loop_once(rctx->ev);
+    assert_int_equal(ret, 0);
+    assert_false(freed);
+    assert_non_null(pctx->creq);
+    assert_int_equal(tevent_fd_get_flags(cctx->cfde) & TEVENT_FD_READ, 0);
+
+    /* The reply is still sent, then the end of the connection frees it */
+    sss_cmd_done(cctx, NULL);
+    while (!freed) {
+        ret = tevent_loop_once(rctx->ev);
+        assert_int_equal(ret, 0);
+    }
+    ret = sss_atomic_read_s(fds[1], reply, sizeof(reply));
+    assert_int_equal(ret, sizeof(reply));
+    close(fds[0]);
+    close(fds[1]);
+
+    /* The client is idle for too long while its request is running */
+    ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert_int_equal(ret, 0);
+    cctx = running_request_client(parse_inp_ctx, rctx, fds[0], &freed);
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+
+    rctx->client_idle_timeout = 0;
+    cctx->last_request_time = time(NULL) - 10;
+    ret = setup_client_idle_timer(cctx);
+    assert_int_equal(ret, EOK);
+
+    ret = tevent_loop_once(rctx->ev);
+    assert_int_equal(ret, 0);
+    assert_false(freed);
+    assert_non_null(pctx->creq);
+    assert_non_null(cctx->idle);
+
+    /* Once the reply was sent the idle client is terminated */
+    sss_cmd_done(cctx, NULL);
+    while (pctx->creq != NULL) {
+        ret = tevent_loop_once(rctx->ev);
+        assert_int_equal(ret, 0);
+    }
+    cctx->last_request_time = time(NULL) - 10;
+    while (!freed) {
+        ret = tevent_loop_once(rctx->ev);
+        assert_int_equal(ret, 0);
+    }
+    ret = sss_atomic_read_s(fds[1], reply, sizeof(reply));
+    assert_int_equal(ret, sizeof(reply));
+    close(fds[0]);
+    close(fds[1]);
+
+    rctx->client_idle_timeout = client_idle_timeout;
+}
+
+void test_sss_mem_usage(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct resp_ctx *rctx = parse_inp_ctx->rctx;
+    struct sss_mem_usage usage;
+    struct cli_ctx *cctx;
+    uint64_t soft_limit;
+    uint64_t sheds;
+    errno_t ret;
+
+    sss_mem_usage_get(rctx, &usage);
+    assert_int_equal(usage.clients, 0);
+    assert_true(usage.total >= usage.negcache);
+
+    cctx = talloc_zero(rctx, struct cli_ctx);
+    assert_non_null(cctx);
+    cctx->rctx = rctx;
+    DLIST_ADD(rctx->clients, cctx);
+    assert_non_null(talloc_size(cctx, 10000));
+
+    /* The memory of the clients is part of the total */
+    sss_mem_usage_get(rctx, &usage);
+    assert_true(usage.clients >= 10000);
+    assert_true(usage.total >= usage.clients + usage.negcache);
+
+    DLIST_REMOVE(rctx->clients, cctx);
+    talloc_free(cctx);
+
+    sss_mem_limit_stats(rctx, &soft_limit, &sheds);
+    assert_int_equal(soft_limit, 0);
+
+    ret = sss_mem_limit_init(rctx, 1024 * 1024);
+    assert_int_equal(ret, EOK);
+    sss_mem_limit_stats(rctx, &soft_limit, &sheds);
+    assert_int_equal(soft_limit, 1024 * 1024);
+    assert_int_equal(sheds, 0);
+
+    ret = sss_mem_limit_init(rctx, 0);
+    assert_int_equal(ret, EOK);
+    assert_null(rctx->mem_limit);
+}
+
+void test_sss_resp_state(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct resp_ctx *rctx = parse_inp_ctx->rctx;
+    struct sss_domain_info *dom = parse_inp_ctx->tctx->dom;
+    const char *path = TESTS_PATH "/test_responder.state";
+    errno_t ret;
+
+    ret = sss_ncache_set_user(rctx->ncache, false, dom, "nosuchuser");
+    assert_int_equal(ret, EOK);
+    rctx->domains_fingerprint = 0x1234abcd5678ef;
+    rctx->domains_fingerprint_valid = true;
+
+    ret = sss_resp_state_save(rctx, path);
+    assert_int_equal(ret, EOK);
+
+    ret = sss_ncache_shrink(rctx->ncache);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_check_user(rctx->ncache, dom, "nosuchuser");
+    assert_int_equal(ret, ENOENT);
+
+    /* The next instance gets the entries and the domain list back */
+    ret = sss_resp_state_load(rctx, path);
+    assert_int_equal(ret, EOK);
+    ret = sss_ncache_check_user(rctx->ncache, dom, "nosuchuser");
+    assert_int_equal(ret, EEXIST);
+    assert_int_equal(rctx->saved_domains_time,
+                     rctx->get_domains_last_call.tv_sec);
+    assert_true(rctx->saved_domains_fingerprint == 0x1234abcd5678ef);
+
+    /* but only once */
+    ret = sss_resp_state_load(rctx, path);
+    assert_int_equal(ret, ENOENT);
+
+    rctx->saved_domains_time = 0;
+    ret = sss_ncache_shrink(rctx->ncache);
+    assert_int_equal(ret, EOK);
+}
+
+#ifdef HAVE_UCRED
+static struct cli_ctx *throttle_client(TALLOC_CTX *mem_ctx,
+                                       struct resp_ctx *rctx,
+                                       uid_t uid)
+{
+    struct cli_ctx *cctx;
+    errno_t ret;
+
+    cctx = talloc_zero(mem_ctx, struct cli_ctx);
+    assert_non_null(cctx);
+    cctx->rctx = rctx;
+    cctx->creds = talloc_zero(cctx, struct cli_creds);
+    assert_non_null(cctx->creds);
+    cctx->creds->ucred.uid = uid;
+
+    ret = sss_client_throttle_attach(cctx);
+    assert_int_equal(ret, EOK);
+
+    return cctx;
+}
+
+void test_client_throttle(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct resp_ctx *rctx = parse_inp_ctx->rctx;
+    struct cli_ctx *busy1;
+    struct cli_ctx *busy2;
+    struct cli_ctx *other;
+    uint64_t deferred;
+    uint64_t waiting;
+    uint64_t uids;
+    errno_t ret;
+
+    ret = sss_client_throttle_init(rctx, 2);
+    assert_int_equal(ret, EOK);
+
+    busy1 = throttle_client(parse_inp_ctx, rctx, 1000);
+    busy2 = throttle_client(parse_inp_ctx, rctx, 1000);
+    other = throttle_client(parse_inp_ctx, rctx, 1001);
+
+    /* The clients of one uid share the budget */
+    assert_true(sss_client_throttle_admit(busy1));
+    assert_true(sss_client_throttle_admit(busy2));
+    assert_false(sss_client_throttle_admit(busy1));
+    assert_false(sss_client_throttle_admit(busy2));
+
+    /* A deferred client does not wait twice */
+    assert_false(sss_client_throttle_admit(busy1));
+
+    /* Other users are not affected */
+    assert_true(sss_client_throttle_admit(other));
+
+    sss_client_throttle_stats(rctx, &deferred, &waiting, &uids);
+    assert_int_equal(deferred, 2);
+    assert_int_equal(waiting, 2);
+    assert_int_equal(uids, 2);
+
+    talloc_free(busy1);
+    sss_client_throttle_stats(rctx, &deferred, &waiting, &uids);
+    assert_int_equal(waiting, 1);
+
+    talloc_free(busy2);
+    talloc_free(other);
+
+    ret = sss_client_throttle_init(rctx, 0);
+    assert_int_equal(ret, EOK);
+    assert_null(rctx->client_throttle);
+}
+#endif /* HAVE_UCRED */
+
 int main(int argc, const char *argv[])
 {
     int rv;
@@ -325,6 +1034,31 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sss_output_fqname,
                                         parse_inp_test_setup,
                                         parse_inp_test_teardown),
+        cmocka_unit_test(test_sss_packet_recv_pipelined),
+        cmocka_unit_test(test_sss_packet_pool),
+        cmocka_unit_test_setup_teardown(test_sss_cmd_pool,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
+        cmocka_unit_test_setup_teardown(test_sss_cmd_stats,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
+        cmocka_unit_test_setup_teardown(test_sss_client_reply,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
+        cmocka_unit_test_setup_teardown(test_client_free_running_request,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
+        cmocka_unit_test_setup_teardown(test_sss_mem_usage,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
+        cmocka_unit_test_setup_teardown(test_sss_resp_state,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
+#ifdef HAVE_UCRED
+        cmocka_unit_test_setup_teardown(test_client_throttle,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
+#endif
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
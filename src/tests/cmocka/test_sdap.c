@@ -26,6 +26,7 @@
 #include "tests/cmocka/common_mock.h"
 #include "providers/ldap/ldap_opts.h"
 #include "providers/ipa/ipa_opts.h"
+#include "providers/ldap/sdap_range.h"
 #include "util/crypto/sss_crypto.h"
 
 /* mock an LDAP entry */
@@ -387,6 +388,91 @@ void test_parse_no_map(void **state)
     talloc_free(attrs);
 }
 
+/* The first range of member is returned, the rest has to be read */
+void test_parse_ranges(void **state)
+{
+    int ret;
+    struct sysdb_attrs *attrs;
+    struct parse_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                      struct parse_test_ctx);
+    struct mock_ldap_entry test_group;
+    struct sdap_range_pending *pending;
+    struct ldb_message_element *el;
+    size_t num_pending;
+
+    const char *member_values[] = { "cn=u1,dc=example,dc=com",
+                                    "cn=u2,dc=example,dc=com", NULL };
+    const char *member_of_values[] = { "cn=g1,dc=example,dc=com", NULL };
+    struct mock_ldap_attr test_group_attrs[] = {
+        { .name = "member;range=0-1", .values = member_values },
+        { .name = "memberOf;range=0-*", .values = member_of_values },
+        { NULL, NULL }
+    };
+
+    test_group.dn = "cn=testgroup,dc=example,dc=com";
+    test_group.attrs = test_group_attrs;
+    set_entry_parse(&test_group);
+
+    ret = sdap_parse_entry_ranges(test_ctx, &test_ctx->sh, &test_ctx->sm,
+                                  NULL, 0, &attrs, false,
+                                  &pending, &num_pending);
+    assert_int_equal(ret, ERR_OK);
+
+    ret = sysdb_attrs_get_el_ext(attrs, "member", false, &el);
+    assert_int_equal(ret, ERR_OK);
+    assert_int_equal(el->num_values, 2);
+    assert_entry_has_attr(attrs, "memberOf", "cn=g1,dc=example,dc=com");
+
+    /* only member is continued, memberOf was complete */
+    assert_int_equal(num_pending, 1);
+    assert_ptr_equal(pending[0].attrs, attrs);
+    assert_string_equal(pending[0].dn, "cn=testgroup,dc=example,dc=com");
+    assert_string_equal(pending[0].base_attr, "member");
+    assert_string_equal(pending[0].sys_names[0], "member");
+    assert_null(pending[0].sys_names[1]);
+    assert_int_equal(pending[0].offset, 2);
+    assert_int_equal(pending[0].step, 2);
+
+    talloc_free(pending);
+    talloc_free(attrs);
+}
+
+static void test_parse_range_bounds(void **state)
+{
+    uint32_t start;
+    uint32_t end;
+    bool last;
+    errno_t ret;
+
+    ret = sdap_parse_range_bounds("member;range=1500-2999", "member",
+                                  &start, &end, &last);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(start, 1500);
+    assert_int_equal(end, 2999);
+    assert_false(last);
+
+    ret = sdap_parse_range_bounds("Member;Range=3000-*", "member",
+                                  &start, &end, &last);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(start, 3000);
+    assert_true(last);
+
+    ret = sdap_parse_range_bounds("memberOf;range=0-10", "member",
+                                  &start, &end, &last);
+    assert_int_equal(ret, ENOENT);
+
+    ret = sdap_parse_range_bounds("member", "member", &start, &end, &last);
+    assert_int_equal(ret, ENOENT);
+
+    ret = sdap_parse_range_bounds("member;range=10-5", "member",
+                                  &start, &end, &last);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sdap_parse_range_bounds("member;range=x-5", "member",
+                                  &start, &end, &last);
+    assert_int_equal(ret, EINVAL);
+}
+
 /* Only DN and OC, no real attributes */
 void test_parse_no_attrs(void **state)
 {
@@ -475,6 +561,61 @@ void test_parse_dups(void **state)
     talloc_free(attrs);
 }
 
+/* The map grows after its index was built */
+void test_parse_extended_map(void **state)
+{
+    int ret;
+    struct sysdb_attrs *attrs;
+    struct parse_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                      struct parse_test_ctx);
+    struct mock_ldap_entry test_ipa_user;
+    struct sdap_attr_map *map;
+    struct ldb_message_element *el;
+    size_t num_entries;
+    char *extra_attrs[] = { discard_const("myextra:Extra"), NULL };
+
+    const char *oc_values[] = { "posixAccount", NULL };
+    const char *uid_values[] = { "tuser1", NULL };
+    const char *extra_values[] = { "extra1", "extra2", NULL };
+    struct mock_ldap_attr test_ipa_user_attrs[] = {
+        { .name = "objectClass", .values = oc_values },
+        { .name = "UID", .values = uid_values },
+        { .name = "extra", .values = extra_values },
+        { NULL, NULL }
+    };
+
+    test_ipa_user.dn = "cn=testuser,dc=example,dc=com";
+    test_ipa_user.attrs = test_ipa_user_attrs;
+    set_entry_parse(&test_ipa_user);
+
+    ret = sdap_copy_map(test_ctx, ipa_user_map, SDAP_OPTS_USER, &map);
+    assert_int_equal(ret, ERR_OK);
+
+    ret = sdap_extend_map(test_ctx, map, SDAP_OPTS_USER, extra_attrs,
+                          &map, &num_entries);
+    assert_int_equal(ret, ERR_OK);
+    assert_int_equal(num_entries, SDAP_OPTS_USER + 1);
+
+    ret = sdap_parse_entry(test_ctx, &test_ctx->sh, &test_ctx->sm,
+                           map, num_entries,
+                           &attrs, false);
+    assert_int_equal(ret, ERR_OK);
+
+    assert_int_equal(attrs->num, 3);
+    /* Attribute names are matched case-insensitively */
+    assert_entry_has_attr(attrs, SYSDB_NAME, "tuser1");
+
+    /* The extra attribute keeps all its values */
+    ret = sysdb_attrs_get_el_ext(attrs, "myextra", false, &el);
+    assert_int_equal(ret, ERR_OK);
+    assert_int_equal(el->num_values, 2);
+    assert_string_equal((const char *) el->values[0].data, "extra1");
+    assert_string_equal((const char *) el->values[1].data, "extra2");
+
+    talloc_free(map);
+    talloc_free(attrs);
+}
+
 void test_parse_deref(void **state)
 {
     errno_t ret;
@@ -1119,6 +1260,108 @@ static void test_sdap_copy_objects_in_dom_nofilter(void **state)
                      test_ctx->dom_objects);
 }
 
+static void test_sdap_server_tuning_fixed(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sdap_options *opts;
+    struct sdap_service *service;
+    struct sdap_server_tuning *tuning;
+
+    assert_true(leak_check_setup());
+    tmp_ctx = talloc_new(global_talloc_context);
+    assert_non_null(tmp_ctx);
+
+    opts = mock_sdap_opts(tmp_ctx);
+    service = talloc_zero(tmp_ctx, struct sdap_service);
+    assert_non_null(service);
+
+    tuning = sdap_server_tuning_get(service, opts, "ldap://a.example.com");
+    assert_non_null(tuning);
+    assert_int_equal(tuning->page_size, 1000);
+
+    /* ldap_page_size_max is not set, nothing changes */
+    assert_false(sdap_server_tuning_update(tuning, 1000, 1000, 1000));
+    assert_false(sdap_server_tuning_update(tuning, 1000, 1000, 60000000));
+    assert_int_equal(tuning->page_size, 1000);
+
+    /* the same server gets the same tuning, another one a new one */
+    assert_ptr_equal(sdap_server_tuning_get(service, opts,
+                                            "ldap://a.example.com"),
+                     tuning);
+    assert_ptr_not_equal(sdap_server_tuning_get(service, opts,
+                                                "ldap://b.example.com"),
+                         tuning);
+
+    talloc_free(tmp_ctx);
+    assert_true(leak_check_teardown());
+}
+
+static void test_sdap_server_tuning_adaptive(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sdap_options *opts;
+    struct sdap_service *service;
+    struct sdap_server_tuning *tuning;
+    errno_t ret;
+
+    assert_true(leak_check_setup());
+    tmp_ctx = talloc_new(global_talloc_context);
+    assert_non_null(tmp_ctx);
+
+    opts = mock_sdap_opts(tmp_ctx);
+    ret = dp_opt_set_int(opts->basic, SDAP_PAGE_SIZE_MAX, 4000);
+    assert_int_equal(ret, EOK);
+    ret = dp_opt_set_int(opts->basic, SDAP_PAGE_SIZE_MIN, 300);
+    assert_int_equal(ret, EOK);
+    ret = dp_opt_set_int(opts->basic, SDAP_CONNECTION_POOL_SIZE, 3);
+    assert_int_equal(ret, EOK);
+    ret = dp_opt_set_int(opts->basic, SDAP_SEARCH_TIMEOUT, 6);
+    assert_int_equal(ret, EOK);
+    service = talloc_zero(tmp_ctx, struct sdap_service);
+    assert_non_null(service);
+
+    tuning = sdap_server_tuning_get(service, opts, "ldap://a.example.com");
+    assert_non_null(tuning);
+    assert_int_equal(tuning->page_size, 1000);
+    assert_int_equal(tuning->pool_size, 3);
+
+    /* a fast page that was not full does not say anything */
+    assert_false(sdap_server_tuning_update(tuning, 1000, 10, 1000));
+    assert_int_equal(tuning->page_size, 1000);
+
+    /* fast full pages grow up to the maximum */
+    assert_true(sdap_server_tuning_update(tuning, 1000, 1000, 1000));
+    assert_int_equal(tuning->page_size, 2000);
+    assert_true(sdap_server_tuning_update(tuning, 2000, 2000, 1000));
+    assert_int_equal(tuning->page_size, 4000);
+    assert_false(sdap_server_tuning_update(tuning, 4000, 4000, 1000));
+    assert_int_equal(tuning->page_size, 4000);
+    assert_int_equal(tuning->pool_size, 3);
+
+    /* slow pages shrink down to the minimum */
+    assert_true(sdap_server_tuning_update(tuning, 4000, 4000, 30000000));
+    assert_int_equal(tuning->page_size, 2000);
+    assert_int_equal(tuning->pool_size, 2);
+    assert_true(sdap_server_tuning_update(tuning, 2000, 2000, 30000000));
+    assert_int_equal(tuning->page_size, 1000);
+    assert_int_equal(tuning->pool_size, 1);
+    assert_true(sdap_server_tuning_update(tuning, 1000, 1000, 30000000));
+    assert_int_equal(tuning->page_size, 500);
+    assert_true(sdap_server_tuning_update(tuning, 500, 500, 30000000));
+    assert_int_equal(tuning->page_size, 300);
+    assert_false(sdap_server_tuning_update(tuning, 300, 300, 30000000));
+    assert_int_equal(tuning->page_size, 300);
+    assert_int_equal(tuning->pool_size, 1);
+
+    /* the pool size is taken from the last connected server */
+    assert_int_equal(sdap_service_pool_size(service, opts), 3);
+    service->tuning = tuning;
+    assert_int_equal(sdap_service_pool_size(service, opts), 1);
+
+    talloc_free(tmp_ctx);
+    assert_true(leak_check_teardown());
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -1136,12 +1379,19 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_parse_no_map,
                                         parse_entry_test_setup,
                                         parse_entry_test_teardown),
+        cmocka_unit_test_setup_teardown(test_parse_ranges,
+                                        parse_entry_test_setup,
+                                        parse_entry_test_teardown),
+        cmocka_unit_test(test_parse_range_bounds),
         cmocka_unit_test_setup_teardown(test_parse_no_attrs,
                                         parse_entry_test_setup,
                                         parse_entry_test_teardown),
         cmocka_unit_test_setup_teardown(test_parse_dups,
                                         parse_entry_test_setup,
                                         parse_entry_test_teardown),
+        cmocka_unit_test_setup_teardown(test_parse_extended_map,
+                                        parse_entry_test_setup,
+                                        parse_entry_test_teardown),
         cmocka_unit_test_setup_teardown(test_parse_deref,
                                         parse_entry_test_setup,
                                         parse_entry_test_teardown),
@@ -1194,6 +1444,10 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sdap_copy_objects_in_dom_nofilter,
                                         sdap_copy_objects_in_dom_setup,
                                         sdap_copy_objects_in_dom_teardown),
+
+        /* Paged search tuning tests */
+        cmocka_unit_test(test_sdap_server_tuning_fixed),
+        cmocka_unit_test(test_sdap_server_tuning_adaptive),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
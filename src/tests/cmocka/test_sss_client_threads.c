@@ -0,0 +1,425 @@
+/*
+    Copyright (C) 2026 Red Hat
+
+    SSSD tests: NSS client sockets used from several threads
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+
+/* Makes the allocation of the socket of the calling thread fail. */
+static __thread bool fail_calloc;
+
+static void *test_calloc(size_t nmemb, size_t size)
+{
+    if (fail_calloc) {
+        return NULL;
+    }
+
+    return calloc(nmemb, size);
+}
+
+/* The client code is included to talk to the fake responder below and to
+ * look at the sockets it keeps. */
+#undef SSS_NSS_SOCKET_NAME
+#define SSS_NSS_SOCKET_NAME TESTS_PATH"/nss"
+#define calloc test_calloc
+#include "sss_client/common.c"
+#undef calloc
+
+#define NUM_THREADS 8
+#define NUM_REQUESTS 20
+
+static int listen_sd = -1;
+static pthread_mutex_t conn_mtx = PTHREAD_MUTEX_INITIALIZER;
+static int num_conns;
+
+static int get_num_conns(void)
+{
+    int num;
+
+    pthread_mutex_lock(&conn_mtx);
+    num = num_conns;
+    pthread_mutex_unlock(&conn_mtx);
+
+    return num;
+}
+
+static void reset_num_conns(void)
+{
+    pthread_mutex_lock(&conn_mtx);
+    num_conns = 0;
+    pthread_mutex_unlock(&conn_mtx);
+}
+
+static bool read_all(int fd, void *buf, size_t len)
+{
+    size_t pos = 0;
+    ssize_t ret;
+
+    while (pos < len) {
+        ret = read(fd, (uint8_t *)buf + pos, len - pos);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        pos += ret;
+    }
+
+    return true;
+}
+
+static bool write_all(int fd, const void *buf, size_t len)
+{
+    size_t pos = 0;
+    ssize_t ret;
+
+    while (pos < len) {
+        ret = write(fd, (const uint8_t *)buf + pos, len - pos);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        pos += ret;
+    }
+
+    return true;
+}
+
+/* Answers every request of a connection, the version check with the NSS
+ * protocol version and everything else with an empty result. */
+static void *conn_thread(void *ptr)
+{
+    int fd = (int)(intptr_t)ptr;
+    uint32_t header[4];
+    uint32_t reply[5];
+    uint8_t body[256];
+    size_t len;
+
+    while (read_all(fd, header, sizeof(header))) {
+        if (header[0] < SSS_NSS_HEADER_SIZE
+                || header[0] - SSS_NSS_HEADER_SIZE > sizeof(body)) {
+            break;
+        }
+        len = header[0] - SSS_NSS_HEADER_SIZE;
+        if (len > 0 && !read_all(fd, body, len)) {
+            break;
+        }
+
+        reply[0] = sizeof(reply);
+        reply[1] = header[1];
+        reply[2] = 0;
+        reply[3] = header[3];
+        reply[4] = header[1] == SSS_GET_VERSION ? SSS_NSS_PROTOCOL_VERSION
+                                                : 0;
+        if (!write_all(fd, reply, sizeof(reply))) {
+            break;
+        }
+    }
+
+    close(fd);
+    return NULL;
+}
+
+static void *server_thread(void *ptr)
+{
+    pthread_t tid;
+    int fd;
+
+    while ((fd = accept(listen_sd, NULL, NULL)) != -1) {
+        pthread_mutex_lock(&conn_mtx);
+        num_conns++;
+        pthread_mutex_unlock(&conn_mtx);
+
+        if (pthread_create(&tid, NULL, conn_thread,
+                           (void *)(intptr_t)fd) != 0) {
+            close(fd);
+            continue;
+        }
+        pthread_detach(tid);
+    }
+
+    return NULL;
+}
+
+static int test_threads_setup(void **state)
+{
+    struct sockaddr_un addr;
+    pthread_t tid;
+    int ret;
+
+    ret = mkdir(TESTS_PATH, 0775);
+    if (ret != 0 && errno != EEXIST) {
+        return 1;
+    }
+    unlink(SSS_NSS_SOCKET_NAME);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, SSS_NSS_SOCKET_NAME, sizeof(addr.sun_path) - 1);
+
+    listen_sd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_sd == -1) {
+        return 1;
+    }
+
+    if (bind(listen_sd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+            || listen(listen_sd, NUM_THREADS * 2) != 0) {
+        return 1;
+    }
+
+    if (pthread_create(&tid, NULL, server_thread, NULL) != 0) {
+        return 1;
+    }
+    pthread_detach(tid);
+
+    return 0;
+}
+
+static int test_threads_teardown(void **state)
+{
+    shutdown(listen_sd, SHUT_RDWR);
+    close(listen_sd);
+    unlink(SSS_NSS_SOCKET_NAME);
+    rmdir(TESTS_PATH);
+
+    return 0;
+}
+
+struct lookup_thread_ctx {
+    enum sss_cli_command cmd;
+    bool take_lock;
+    bool no_memory;
+    int num_success;
+    int thread_sd;
+};
+
+static void *lookup_thread(void *ptr)
+{
+    struct lookup_thread_ctx *ctx = ptr;
+    struct sss_cli_req_data rd;
+    struct sss_cli_sock *sock;
+    uint8_t *repbuf;
+    size_t replen;
+    int errnop;
+    enum nss_status status;
+    int i;
+
+    rd.data = "user";
+    rd.len = sizeof("user");
+    fail_calloc = ctx->no_memory;
+
+    for (i = 0; i < NUM_REQUESTS; i++) {
+        repbuf = NULL;
+        errnop = 0;
+
+        if (ctx->take_lock) {
+            sss_nss_lock();
+        }
+        status = sss_nss_make_request(ctx->cmd, &rd, &repbuf, &replen,
+                                      &errnop);
+        if (ctx->take_lock) {
+            sss_nss_unlock();
+        }
+
+        if (status == NSS_STATUS_SUCCESS && replen == sizeof(uint32_t)) {
+            ctx->num_success++;
+        }
+        free(repbuf);
+    }
+
+    sock = sss_cli_thread_sockets ? pthread_getspecific(sss_cli_thread_key)
+                                  : NULL;
+    ctx->thread_sd = sock == NULL ? -1 : sock->sd;
+
+    return NULL;
+}
+
+static void run_lookup_threads(enum sss_cli_command cmd, bool take_lock,
+                               bool no_memory, struct lookup_thread_ctx *ctx)
+{
+    pthread_t tids[NUM_THREADS];
+    int ret;
+    int i;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        ctx[i].cmd = cmd;
+        ctx[i].take_lock = take_lock;
+        ctx[i].no_memory = no_memory;
+        ctx[i].num_success = 0;
+        ctx[i].thread_sd = -1;
+
+        ret = pthread_create(&tids[i], NULL, lookup_thread, &ctx[i]);
+        assert_int_equal(ret, 0);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        ret = pthread_join(tids[i], NULL);
+        assert_int_equal(ret, 0);
+    }
+}
+
+/* Each thread has a socket of its own and the shared one is not used. */
+static void test_thread_sockets(void **state)
+{
+    struct lookup_thread_ctx ctx[NUM_THREADS];
+    int i;
+
+    reset_num_conns();
+    run_lookup_threads(SSS_NSS_GETPWNAM, false, false, ctx);
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert_int_equal(ctx[i].num_success, NUM_REQUESTS);
+        assert_int_not_equal(ctx[i].thread_sd, -1);
+    }
+    assert_int_equal(get_num_conns(), NUM_THREADS);
+    assert_int_equal(sss_cli_shared.sd, -1);
+}
+
+/* Threads which cannot open a socket share the fallback one, never the
+ * shared socket which is protected by the NSS lock. */
+static void test_thread_sockets_fallback(void **state)
+{
+    struct lookup_thread_ctx ctx[NUM_THREADS];
+    struct sss_cli_req_data rd;
+    struct rlimit old_limit;
+    struct rlimit limit;
+    uint8_t *repbuf = NULL;
+    size_t replen;
+    int errnop;
+    enum sss_status ret;
+    int fd;
+    int i;
+
+    rd.data = "user";
+    rd.len = sizeof("user");
+
+    sss_cli_fallback_lock();
+    ret = sss_nss_make_request_sock(&sss_cli_fallback, SSS_NSS_GETPWNAM, &rd,
+                                    SSS_CLI_SOCKET_TIMEOUT, &repbuf, &replen,
+                                    &errnop);
+    sss_cli_fallback_unlock();
+    assert_int_equal(ret, SSS_STATUS_SUCCESS);
+    free(repbuf);
+
+    /* no new descriptor can be opened */
+    fd = open("/dev/null", O_RDONLY);
+    assert_int_not_equal(fd, -1);
+    close(fd);
+
+    assert_int_equal(getrlimit(RLIMIT_NOFILE, &old_limit), 0);
+    limit = old_limit;
+    limit.rlim_cur = fd;
+    assert_int_equal(setrlimit(RLIMIT_NOFILE, &limit), 0);
+
+    reset_num_conns();
+    run_lookup_threads(SSS_NSS_INITGR, false, false, ctx);
+
+    assert_int_equal(setrlimit(RLIMIT_NOFILE, &old_limit), 0);
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert_int_equal(ctx[i].num_success, NUM_REQUESTS);
+        assert_int_equal(ctx[i].thread_sd, -1);
+    }
+    assert_int_equal(get_num_conns(), 0);
+    assert_int_not_equal(sss_cli_fallback.sd, -1);
+    assert_int_equal(sss_cli_shared.sd, -1);
+}
+
+/* Threads without a socket of their own use the fallback socket as well. */
+static void test_thread_sockets_no_memory(void **state)
+{
+    struct lookup_thread_ctx ctx[NUM_THREADS];
+    int i;
+
+    reset_num_conns();
+    run_lookup_threads(SSS_NSS_GETPWUID, false, true, ctx);
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert_int_equal(ctx[i].num_success, NUM_REQUESTS);
+        assert_int_equal(ctx[i].thread_sd, -1);
+    }
+    assert_int_equal(get_num_conns(), 0);
+    assert_int_equal(sss_cli_shared.sd, -1);
+}
+
+/* The other commands keep using the shared socket under the NSS lock. */
+static void test_shared_socket_locked(void **state)
+{
+    struct lookup_thread_ctx ctx[NUM_THREADS];
+    int i;
+
+    reset_num_conns();
+    run_lookup_threads(SSS_NSS_GETGRNAM, true, false, ctx);
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert_int_equal(ctx[i].num_success, NUM_REQUESTS);
+        assert_int_equal(ctx[i].thread_sd, -1);
+    }
+    assert_int_equal(get_num_conns(), 1);
+    assert_int_not_equal(sss_cli_shared.sd, -1);
+}
+
+/* Once the library is unloaded the key is gone and the lookups fall back
+ * to the shared socket and the NSS lock. */
+static void test_close_socket(void **state)
+{
+    struct lookup_thread_ctx ctx[NUM_THREADS];
+    int i;
+
+    sss_cli_close_socket();
+
+    assert_false(sss_cli_thread_sockets);
+    assert_false(sss_cli_lockless_cmd(SSS_NSS_GETPWNAM));
+    assert_int_equal(sss_cli_shared.sd, -1);
+    assert_int_equal(sss_cli_fallback.sd, -1);
+
+    reset_num_conns();
+    run_lookup_threads(SSS_NSS_GETPWNAM, true, false, ctx);
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        assert_int_equal(ctx[i].num_success, NUM_REQUESTS);
+    }
+    assert_int_equal(get_num_conns(), 1);
+}
+
+int main(int argc, const char *argv[])
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_thread_sockets),
+        cmocka_unit_test(test_thread_sockets_fallback),
+        cmocka_unit_test(test_thread_sockets_no_memory),
+        cmocka_unit_test(test_shared_socket_locked),
+        cmocka_unit_test(test_close_socket),
+    };
+
+    /* read once, on the first lookup */
+    setenv("SSS_NSS_THREAD_SOCKETS", "YES", 1);
+
+    return cmocka_run_group_tests(tests, test_threads_setup,
+                                  test_threads_teardown);
+}
@@ -442,6 +442,105 @@ void test_map_id_sec_slices(void **state)
     sss_idmap_free_sid(test_ctx->idmap_ctx, sid);
 }
 
+void test_map_ids(void **state)
+{
+    struct test_ctx *test_ctx;
+    enum idmap_error_code err;
+    const char *sids[] = { TEST_DOM_SID"-0",
+                           TEST_DOM_SID"-400000",
+                           TEST_DOM_SID"1-1",
+                           "S-1-5-32-544",
+                           TEST_DOM_SID"-"TEST_OFFSET_STR };
+    uint32_t ids[5];
+    enum idmap_error_code errs[5];
+
+    test_ctx = talloc_get_type(*state, struct test_ctx);
+
+    assert_non_null(test_ctx);
+
+    err = sss_idmap_sids_to_unix(test_ctx->idmap_ctx, sids, 5, NULL, errs);
+    assert_int_equal(err, IDMAP_ERROR);
+
+    err = sss_idmap_sids_to_unix(test_ctx->idmap_ctx, sids, 5, ids, errs);
+    assert_int_equal(err, IDMAP_SUCCESS);
+
+    assert_int_equal(errs[0], IDMAP_SUCCESS);
+    assert_int_equal(ids[0], TEST_RANGE_MIN);
+    assert_int_equal(errs[1], IDMAP_NO_RANGE);
+    assert_int_equal(errs[2], IDMAP_NO_DOMAIN);
+    assert_int_equal(errs[3], IDMAP_BUILTIN_SID);
+    assert_int_equal(errs[4], IDMAP_SUCCESS);
+    assert_int_equal(ids[4], TEST_RANGE_MIN + TEST_OFFSET);
+}
+
+void test_map_id_many_domains(void **state)
+{
+    struct test_ctx *test_ctx;
+    struct sss_idmap_range range;
+    enum idmap_error_code err;
+    char name[64];
+    char dom_sid[64];
+    char sid[64];
+    char *out_sid;
+    uint32_t id;
+    int i;
+
+    test_ctx = talloc_get_type(*state, struct test_ctx);
+
+    assert_non_null(test_ctx);
+
+    /* look up between the additions so that the index is rebuilt */
+    for (i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "dom%d.test", i);
+        snprintf(dom_sid, sizeof(dom_sid), "S-1-5-21-%d-%d-%d", i, i, i);
+        range.min = TEST_RANGE_MIN + i * 400000;
+        range.max = range.min + 199999;
+
+        err = sss_idmap_add_domain_ex(test_ctx->idmap_ctx, name, dom_sid,
+                                      &range, NULL, 0, false);
+        assert_int_equal(err, IDMAP_SUCCESS);
+
+        /* every domain gets a second slice right after the first one */
+        range.min += 200000;
+        range.max += 200000;
+        err = sss_idmap_add_domain_ex(test_ctx->idmap_ctx, name, dom_sid,
+                                      &range, NULL, 200000, false);
+        assert_int_equal(err, IDMAP_SUCCESS);
+
+        snprintf(sid, sizeof(sid), "%s-%d", dom_sid, 250000);
+        err = sss_idmap_sid_to_unix(test_ctx->idmap_ctx, sid, &id);
+        assert_int_equal(err, IDMAP_SUCCESS);
+        assert_int_equal(id, TEST_RANGE_MIN + i * 400000 + 250000);
+    }
+
+    for (i = 0; i < 100; i++) {
+        snprintf(dom_sid, sizeof(dom_sid), "S-1-5-21-%d-%d-%d", i, i, i);
+
+        snprintf(sid, sizeof(sid), "%s-%d", dom_sid, 10);
+        err = sss_idmap_sid_to_unix(test_ctx->idmap_ctx, sid, &id);
+        assert_int_equal(err, IDMAP_SUCCESS);
+        assert_int_equal(id, TEST_RANGE_MIN + i * 400000 + 10);
+
+        err = sss_idmap_unix_to_sid(test_ctx->idmap_ctx, id, &out_sid);
+        assert_int_equal(err, IDMAP_SUCCESS);
+        assert_string_equal(out_sid, sid);
+        sss_idmap_free_sid(test_ctx->idmap_ctx, out_sid);
+
+        snprintf(sid, sizeof(sid), "%s-%d", dom_sid, 400000);
+        err = sss_idmap_sid_to_unix(test_ctx->idmap_ctx, sid, &id);
+        assert_int_equal(err, IDMAP_NO_RANGE);
+
+        /* the domain SID is followed by more than a RID */
+        snprintf(sid, sizeof(sid), "%s-1-%d", dom_sid, 10);
+        err = sss_idmap_sid_to_unix(test_ctx->idmap_ctx, sid, &id);
+        assert_int_equal(err, IDMAP_SID_INVALID);
+    }
+
+    err = sss_idmap_unix_to_sid(test_ctx->idmap_ctx,
+                                TEST_RANGE_MIN + 100 * 400000, &out_sid);
+    assert_int_equal(err, IDMAP_NO_DOMAIN);
+}
+
 void test_map_id_external(void **state)
 {
     struct test_ctx *test_ctx;
@@ -736,6 +835,12 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_map_id_sec_slices,
                                         test_sss_idmap_setup_with_domains_sec_slices,
                                         test_sss_idmap_teardown),
+        cmocka_unit_test_setup_teardown(test_map_ids,
+                                        test_sss_idmap_setup_with_domains,
+                                        test_sss_idmap_teardown),
+        cmocka_unit_test_setup_teardown(test_map_id_many_domains,
+                                        test_sss_idmap_setup,
+                                        test_sss_idmap_teardown),
         cmocka_unit_test_setup_teardown(test_map_id_external,
                                         test_sss_idmap_setup_with_external_mappings,
                                         test_sss_idmap_teardown),
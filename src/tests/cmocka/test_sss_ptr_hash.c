@@ -15,10 +15,13 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <time.h>
+
 #include "tests/cmocka/common_mock.h"
 #include "util/sss_ptr_hash.h"
 
 static const int MAX_ENTRIES_AMOUNT = 5;
+static const int BENCH_ENTRIES_AMOUNT = 50000;
 
 static void populate_table(hash_table_t *table, int **payloads)
 {
@@ -230,3 +233,116 @@ void test_sss_ptr_hash_without_cb(void **state)
 
     talloc_free(table);
 }
+
+/* The value overridden in a table without callback must not stay attached
+ * to its payload, freeing the old payload would remove the new entry. */
+void test_sss_ptr_hash_override_without_cb(void **state)
+{
+    hash_table_t *table;
+    int *payload1;
+    int *payload2;
+    int *value;
+    errno_t ret;
+
+    table = sss_ptr_hash_create(global_talloc_context, NULL, NULL);
+    assert_non_null(table);
+
+    payload1 = talloc_zero(global_talloc_context, int);
+    assert_non_null(payload1);
+    payload2 = talloc_zero(global_talloc_context, int);
+    assert_non_null(payload2);
+
+    ret = sss_ptr_hash_add(table, "test", payload1, int);
+    assert_int_equal(ret, EOK);
+    ret = sss_ptr_hash_add(table, "test", payload2, int);
+    assert_int_equal(ret, EEXIST);
+    ret = sss_ptr_hash_add_or_override(table, "test", payload2, int);
+    assert_int_equal(ret, EOK);
+    assert_int_equal((int)hash_count(table), 1);
+
+    talloc_free(payload1);
+    value = sss_ptr_hash_lookup(table, "test", int);
+    assert_ptr_equal(value, payload2);
+
+    talloc_free(payload2);
+    assert_int_equal((int)hash_count(table), 0);
+
+    talloc_free(table);
+}
+
+static uint64_t bench_elapsed_ns(struct timespec *start)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000000000ULL
+           + end.tv_nsec - start->tv_nsec;
+}
+
+/* Adds, looks up and removes many entries, keys as long as the sbus
+ * request keys. The time of each operation is printed with -d 0x4000. */
+void test_sss_ptr_hash_bench(void **state)
+{
+    hash_table_t *table;
+    struct timespec start;
+    int **payloads;
+    char key[64];
+    int *value;
+    int i;
+
+    payloads = talloc_zero_array(global_talloc_context, int *,
+                                 BENCH_ENTRIES_AMOUNT);
+    assert_non_null(payloads);
+
+    table = sss_ptr_hash_create(global_talloc_context, NULL, NULL);
+    assert_non_null(table);
+
+    for (i = 0; i < BENCH_ENTRIES_AMOUNT; i++) {
+        payloads[i] = talloc_zero(payloads, int);
+        assert_non_null(payloads[i]);
+        *payloads[i] = i;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_ENTRIES_AMOUNT; i++) {
+        snprintf(key, sizeof(key), ":1.%d:org.freedesktop.sssd.bench.%d",
+                 i % 97, i);
+        assert_int_equal(sss_ptr_hash_add(table, key, payloads[i], int), EOK);
+    }
+    DEBUG(SSSDBG_TRACE_ALL, "add: %lu ns per entry\n",
+          (unsigned long)(bench_elapsed_ns(&start) / BENCH_ENTRIES_AMOUNT));
+    assert_int_equal((int)hash_count(table), BENCH_ENTRIES_AMOUNT);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_ENTRIES_AMOUNT; i++) {
+        snprintf(key, sizeof(key), ":1.%d:org.freedesktop.sssd.bench.%d",
+                 i % 97, i);
+        value = sss_ptr_hash_lookup(table, key, int);
+        assert_non_null(value);
+        assert_int_equal(*value, i);
+    }
+    DEBUG(SSSDBG_TRACE_ALL, "lookup: %lu ns per entry\n",
+          (unsigned long)(bench_elapsed_ns(&start) / BENCH_ENTRIES_AMOUNT));
+
+    /* half of the entries go away with their payloads */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_ENTRIES_AMOUNT; i += 2) {
+        talloc_zfree(payloads[i]);
+    }
+    DEBUG(SSSDBG_TRACE_ALL, "free: %lu ns per entry\n",
+          (unsigned long)(bench_elapsed_ns(&start) * 2 / BENCH_ENTRIES_AMOUNT));
+    assert_int_equal((int)hash_count(table), BENCH_ENTRIES_AMOUNT / 2);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 1; i < BENCH_ENTRIES_AMOUNT; i += 2) {
+        snprintf(key, sizeof(key), ":1.%d:org.freedesktop.sssd.bench.%d",
+                 i % 97, i);
+        sss_ptr_hash_delete(table, key, false);
+    }
+    DEBUG(SSSDBG_TRACE_ALL, "delete: %lu ns per entry\n",
+          (unsigned long)(bench_elapsed_ns(&start) * 2 / BENCH_ENTRIES_AMOUNT));
+    assert_int_equal((int)hash_count(table), 0);
+
+    talloc_free(table);
+    talloc_free(payloads);
+}
@@ -52,6 +52,44 @@ __wrap_dbus_connection_send_with_reply_and_block(DBusConnection *connection,
     return sss_mock_ptr_type(DBusMessage *);
 }
 
+/* Replies of pending calls are taken from the same queue as the ones of
+ * blocking calls, in the order the calls are sent. */
+static int test_pending_calls;
+
+dbus_bool_t
+__wrap_dbus_connection_send_with_reply(DBusConnection *connection,
+                                       DBusMessage *message,
+                                       DBusPendingCall **pending_return,
+                                       int timeout_milliseconds)
+{
+    if (message == NULL || pending_return == NULL) {
+        return FALSE;
+    }
+
+    test_pending_calls++;
+    *pending_return = sss_mock_ptr_type(DBusPendingCall *);
+    return TRUE;
+}
+
+void
+__wrap_dbus_pending_call_block(DBusPendingCall *pending)
+{
+    return;
+}
+
+DBusMessage *
+__wrap_dbus_pending_call_steal_reply(DBusPendingCall *pending)
+{
+    /* the pending call is the reply itself */
+    return (DBusMessage *)pending;
+}
+
+void
+__wrap_dbus_pending_call_unref(DBusPendingCall *pending)
+{
+    test_pending_calls--;
+}
+
 static void reply_variant_basic(DBusMessage *reply,
                                 const char *type,
                                 const void *val)
@@ -1824,6 +1862,278 @@ void test_sss_sifp_fetch_object(void **state)
     assert_null(object);
 }
 
+void test_sss_sifp_fetch_objects_attrs(void **state)
+{
+    sss_sifp_ctx *ctx = test_ctx.dbus_ctx;
+    DBusMessage *reply = test_ctx.reply;
+    DBusMessageIter iter;
+    DBusMessageIter array_iter;
+    DBusMessageIter object_iter;
+    DBusMessageIter attrs_iter;
+    DBusMessageIter dict_iter;
+    DBusMessageIter var_iter;
+    DBusMessageIter values_iter;
+    dbus_bool_t bret;
+    sss_sifp_error ret;
+    sss_sifp_object **objects = NULL;
+    const char *paths[] = {IFP_PATH_USERS "/test/1001",
+                           IFP_PATH_GROUPS "/test/2001",
+                           NULL};
+    const char *attrs[] = {"name", "gidNumber", NULL};
+    struct {
+        const char *path;
+        const char *iface;
+        const char *name;
+        const char *gid;
+    } data[] = {{paths[0], "org.freedesktop.sssd.infopipe.Users.User",
+                 "user1", "2001"},
+                {paths[1], "org.freedesktop.sssd.infopipe.Groups.Group",
+                 "group1", "2001"},
+                {NULL, NULL, NULL, NULL}};
+    const char *values[2];
+    const char * const *out;
+    unsigned int num_out;
+    int i;
+    int j;
+
+    /* prepare message */
+    dbus_message_iter_init_append(reply, &iter);
+
+    bret = dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+                                            DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                            DBUS_TYPE_OBJECT_PATH_AS_STRING
+                                            DBUS_TYPE_ARRAY_AS_STRING
+                                            DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                            DBUS_TYPE_STRING_AS_STRING
+                                            DBUS_TYPE_VARIANT_AS_STRING
+                                            DBUS_DICT_ENTRY_END_CHAR_AS_STRING
+                                            DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+                                            &array_iter);
+    assert_true(bret);
+
+    for (i = 0; data[i].path != NULL; i++) {
+        bret = dbus_message_iter_open_container(&array_iter,
+                                                DBUS_TYPE_DICT_ENTRY,
+                                                NULL, &object_iter);
+        assert_true(bret);
+
+        bret = dbus_message_iter_append_basic(&object_iter,
+                                              DBUS_TYPE_OBJECT_PATH,
+                                              &data[i].path);
+        assert_true(bret);
+
+        bret = dbus_message_iter_open_container(&object_iter, DBUS_TYPE_ARRAY,
+                                            DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                            DBUS_TYPE_STRING_AS_STRING
+                                            DBUS_TYPE_VARIANT_AS_STRING
+                                            DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+                                            &attrs_iter);
+        assert_true(bret);
+
+        values[0] = data[i].name;
+        values[1] = data[i].gid;
+        for (j = 0; attrs[j] != NULL; j++) {
+            bret = dbus_message_iter_open_container(&attrs_iter,
+                                                    DBUS_TYPE_DICT_ENTRY,
+                                                    NULL, &dict_iter);
+            assert_true(bret);
+
+            bret = dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_STRING,
+                                                  &attrs[j]);
+            assert_true(bret);
+
+            bret = dbus_message_iter_open_container(&dict_iter,
+                                                    DBUS_TYPE_VARIANT,
+                                                    DBUS_TYPE_ARRAY_AS_STRING
+                                                    DBUS_TYPE_STRING_AS_STRING,
+                                                    &var_iter);
+            assert_true(bret);
+
+            bret = dbus_message_iter_open_container(&var_iter, DBUS_TYPE_ARRAY,
+                                                    DBUS_TYPE_STRING_AS_STRING,
+                                                    &values_iter);
+            assert_true(bret);
+
+            bret = dbus_message_iter_append_basic(&values_iter,
+                                                  DBUS_TYPE_STRING,
+                                                  &values[j]);
+            assert_true(bret);
+
+            bret = dbus_message_iter_close_container(&var_iter, &values_iter);
+            assert_true(bret);
+
+            bret = dbus_message_iter_close_container(&dict_iter, &var_iter);
+            assert_true(bret);
+
+            bret = dbus_message_iter_close_container(&attrs_iter, &dict_iter);
+            assert_true(bret);
+        }
+
+        bret = dbus_message_iter_close_container(&object_iter, &attrs_iter);
+        assert_true(bret);
+
+        bret = dbus_message_iter_close_container(&array_iter, &object_iter);
+        assert_true(bret);
+    }
+
+    bret = dbus_message_iter_close_container(&iter, &array_iter);
+    assert_true(bret);
+    will_return(__wrap_dbus_connection_send_with_reply_and_block, reply);
+
+    ret = sss_sifp_fetch_objects_attrs(ctx, paths, attrs, &objects);
+    assert_int_equal(ret, SSS_SIFP_OK);
+    assert_non_null(objects);
+
+    for (i = 0; data[i].path != NULL; i++) {
+        assert_non_null(objects[i]);
+        assert_string_equal(objects[i]->object_path, data[i].path);
+        assert_string_equal(objects[i]->interface, data[i].iface);
+        assert_string_equal(objects[i]->name, data[i].name);
+
+        ret = sss_sifp_find_attr_as_string_array(objects[i]->attrs,
+                                                 "gidNumber", &num_out, &out);
+        assert_int_equal(ret, SSS_SIFP_OK);
+        assert_int_equal(num_out, 1);
+        assert_string_equal(out[0], data[i].gid);
+    }
+
+    assert_null(objects[i]);
+
+    sss_sifp_free_objects(ctx, &objects);
+    assert_null(objects);
+}
+
+void test_sss_sifp_fetch_users_by_name(void **state)
+{
+    sss_sifp_ctx *ctx = test_ctx.dbus_ctx;
+    DBusMessage *reply = test_ctx.reply;
+    DBusMessage *msg_paths[3];
+    DBusMessageIter iter;
+    DBusMessageIter array_iter;
+    DBusMessageIter object_iter;
+    DBusMessageIter attrs_iter;
+    dbus_bool_t bret;
+    sss_sifp_error ret;
+    sss_sifp_object **users = NULL;
+    const char *names[] = {"user1", "missing", "user2", NULL};
+    const char *paths[] = {IFP_PATH_USERS "/test/1001",
+                           IFP_PATH_USERS "/test/1002"};
+    const char *attrs[] = {"name", NULL};
+    int i;
+
+    /* FindByName of each user, the second one does not exist */
+    msg_paths[0] = dbus_message_new(DBUS_MESSAGE_TYPE_METHOD_RETURN);
+    msg_paths[1] = dbus_message_new(DBUS_MESSAGE_TYPE_ERROR);
+    msg_paths[2] = dbus_message_new(DBUS_MESSAGE_TYPE_METHOD_RETURN);
+    assert_non_null(msg_paths[0]);
+    assert_non_null(msg_paths[1]);
+    assert_non_null(msg_paths[2]);
+
+    bret = dbus_message_append_args(msg_paths[0], DBUS_TYPE_OBJECT_PATH,
+                                    &paths[0], DBUS_TYPE_INVALID);
+    assert_true(bret);
+    bret = dbus_message_set_error_name(msg_paths[1], "sbus.Error.NotFound");
+    assert_true(bret);
+    bret = dbus_message_append_args(msg_paths[2], DBUS_TYPE_OBJECT_PATH,
+                                    &paths[1], DBUS_TYPE_INVALID);
+    assert_true(bret);
+
+    /* GetObjectsAttrs of the users that were found, without attributes */
+    dbus_message_iter_init_append(reply, &iter);
+    bret = dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+                                            DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                            DBUS_TYPE_OBJECT_PATH_AS_STRING
+                                            DBUS_TYPE_ARRAY_AS_STRING
+                                            DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                            DBUS_TYPE_STRING_AS_STRING
+                                            DBUS_TYPE_VARIANT_AS_STRING
+                                            DBUS_DICT_ENTRY_END_CHAR_AS_STRING
+                                            DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+                                            &array_iter);
+    assert_true(bret);
+
+    for (i = 0; i < 2; i++) {
+        bret = dbus_message_iter_open_container(&array_iter,
+                                                DBUS_TYPE_DICT_ENTRY,
+                                                NULL, &object_iter);
+        assert_true(bret);
+
+        bret = dbus_message_iter_append_basic(&object_iter,
+                                              DBUS_TYPE_OBJECT_PATH,
+                                              &paths[i]);
+        assert_true(bret);
+
+        bret = dbus_message_iter_open_container(&object_iter, DBUS_TYPE_ARRAY,
+                                            DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                                            DBUS_TYPE_STRING_AS_STRING
+                                            DBUS_TYPE_VARIANT_AS_STRING
+                                            DBUS_DICT_ENTRY_END_CHAR_AS_STRING,
+                                            &attrs_iter);
+        assert_true(bret);
+
+        bret = dbus_message_iter_close_container(&object_iter, &attrs_iter);
+        assert_true(bret);
+
+        bret = dbus_message_iter_close_container(&array_iter, &object_iter);
+        assert_true(bret);
+    }
+
+    bret = dbus_message_iter_close_container(&iter, &array_iter);
+    assert_true(bret);
+
+    for (i = 0; i < 3; i++) {
+        will_return(__wrap_dbus_connection_send_with_reply, msg_paths[i]);
+    }
+    will_return(__wrap_dbus_connection_send_with_reply_and_block, reply);
+
+    ret = sss_sifp_fetch_users_by_name(ctx, names, attrs, &users);
+    assert_int_equal(ret, SSS_SIFP_OK);
+    assert_int_equal(test_pending_calls, 0);
+    assert_non_null(users);
+
+    for (i = 0; i < 2; i++) {
+        assert_non_null(users[i]);
+        assert_string_equal(users[i]->object_path, paths[i]);
+        assert_string_equal(users[i]->interface,
+                            "org.freedesktop.sssd.infopipe.Users.User");
+    }
+    assert_null(users[i]);
+
+    sss_sifp_free_objects(ctx, &users);
+    assert_null(users);
+}
+
+void test_sss_sifp_fetch_users_by_name_none(void **state)
+{
+    sss_sifp_ctx *ctx = test_ctx.dbus_ctx;
+    DBusMessage *reply = test_ctx.reply;
+    DBusMessage *msg_error;
+    dbus_bool_t bret;
+    sss_sifp_error ret;
+    sss_sifp_object **users = NULL;
+    const char *names[] = {"missing", NULL};
+    const char *attrs[] = {"name", NULL};
+
+    msg_error = dbus_message_new(DBUS_MESSAGE_TYPE_ERROR);
+    assert_non_null(msg_error);
+    bret = dbus_message_set_error_name(msg_error, "sbus.Error.NotFound");
+    assert_true(bret);
+
+    /* GetObjectsAttrs is not called at all */
+    will_return(__wrap_dbus_connection_send_with_reply, msg_error);
+
+    ret = sss_sifp_fetch_users_by_name(ctx, names, attrs, &users);
+    assert_int_equal(ret, SSS_SIFP_OK);
+    assert_int_equal(test_pending_calls, 0);
+    assert_non_null(users);
+    assert_null(users[0]);
+
+    sss_sifp_free_objects(ctx, &users);
+    assert_null(users);
+
+    dbus_message_unref(reply);
+}
+
 void test_sss_sifp_invoke_list_zeroargs(void **state)
 {
     sss_sifp_ctx *ctx = test_ctx.dbus_ctx;
@@ -2213,6 +2523,12 @@ int main(int argc, const char *argv[])
                                         test_setup, test_teardown_api),
         cmocka_unit_test_setup_teardown(test_sss_sifp_fetch_object,
                                         test_setup, test_teardown_api),
+        cmocka_unit_test_setup_teardown(test_sss_sifp_fetch_users_by_name,
+                                        test_setup, test_teardown_api),
+        cmocka_unit_test_setup_teardown(test_sss_sifp_fetch_users_by_name_none,
+                                        test_setup, test_teardown_api),
+        cmocka_unit_test_setup_teardown(test_sss_sifp_fetch_objects_attrs,
+                                        test_setup, test_teardown_api),
         cmocka_unit_test_setup_teardown(test_sss_sifp_invoke_list_zeroargs,
                                         test_setup, test_teardown_api),
         cmocka_unit_test_setup_teardown(test_sss_sifp_invoke_list_withargs,
@@ -0,0 +1,255 @@
+/*
+    SSSD
+
+    sudo responder - response encoding and client parsing tests
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "db/sysdb_sudo.h"
+#include "responder/sudo/sudosrv_private.h"
+#include "sss_client/sudo/sss_sudo.h"
+#include "sss_client/sudo/sss_sudo_private.h"
+
+#define TEST_NUM_RULES 3
+
+static struct sysdb_attrs **create_rules(TALLOC_CTX *mem_ctx)
+{
+    struct sysdb_attrs **rules;
+    char name[16];
+    int ret;
+    int i;
+
+    rules = talloc_array(mem_ctx, struct sysdb_attrs *, TEST_NUM_RULES);
+    assert_non_null(rules);
+
+    for (i = 0; i < TEST_NUM_RULES; i++) {
+        rules[i] = sysdb_new_attrs(rules);
+        assert_non_null(rules[i]);
+
+        snprintf(name, sizeof(name), "rule%d", i);
+        ret = sysdb_attrs_add_string(rules[i], SYSDB_SUDO_CACHE_AT_CN, name);
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_attrs_add_string(rules[i], SYSDB_SUDO_CACHE_AT_HOST,
+                                     "ALL");
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_attrs_add_string(rules[i], SYSDB_SUDO_CACHE_AT_COMMAND,
+                                     "/bin/ls");
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_attrs_add_string(rules[i], SYSDB_SUDO_CACHE_AT_COMMAND,
+                                     "ALL");
+        assert_int_equal(ret, EOK);
+    }
+
+    return rules;
+}
+
+static void check_result(struct sss_sudo_result *result)
+{
+    const char * const *values;
+    char **copies;
+    char name[16];
+    unsigned int i;
+    int ret;
+
+    assert_int_equal(result->num_rules, TEST_NUM_RULES);
+
+    for (i = 0; i < TEST_NUM_RULES; i++) {
+        assert_int_equal(result->rules[i].num_attrs, 3);
+
+        snprintf(name, sizeof(name), "rule%u", i);
+        ret = sss_sudo_get_values_view(&result->rules[i],
+                                       SYSDB_SUDO_CACHE_AT_CN, &values);
+        assert_int_equal(ret, EOK);
+        assert_string_equal(values[0], name);
+        assert_null(values[1]);
+
+        ret = sss_sudo_get_values_view(&result->rules[i],
+                                       SYSDB_SUDO_CACHE_AT_COMMAND, &values);
+        assert_int_equal(ret, EOK);
+        assert_string_equal(values[0], "/bin/ls");
+        assert_string_equal(values[1], "ALL");
+        assert_null(values[2]);
+
+        ret = sss_sudo_get_values_view(&result->rules[i],
+                                       SYSDB_SUDO_CACHE_AT_RUNASUSER,
+                                       &values);
+        assert_int_equal(ret, ENOENT);
+    }
+
+    /* the copying interface keeps working */
+    ret = sss_sudo_get_values(&result->rules[0], SYSDB_SUDO_CACHE_AT_HOST,
+                              &copies);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(copies[0], "ALL");
+    assert_null(copies[1]);
+    sss_sudo_free_values(copies);
+}
+
+static void test_sudo_response_legacy(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sysdb_attrs **rules;
+    struct sss_sudo_result *result = NULL;
+    uint8_t *body;
+    size_t len;
+    uint32_t error;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    rules = create_rules(tmp_ctx);
+
+    ret = sudosrv_build_response(tmp_ctx, SSS_SUDO_ERROR_OK, TEST_NUM_RULES,
+                                 rules, &body, &len);
+    assert_int_equal(ret, EOK);
+
+    ret = sss_sudo_parse_response((const char *)body, len, NULL,
+                                  &result, &error);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(error, SSS_SUDO_ERROR_OK);
+
+    check_result(result);
+    sss_sudo_free_result(result);
+
+    /* truncated response */
+    ret = sss_sudo_parse_response((const char *)body, len - 1, NULL,
+                                  &result, &error);
+    assert_int_equal(ret, EINVAL);
+
+    talloc_free(tmp_ctx);
+}
+
+static void test_sudo_response_bin(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sysdb_attrs **rules;
+    struct sss_sudo_result *result = NULL;
+    uint8_t *legacy_body;
+    size_t legacy_len;
+    uint8_t *body;
+    size_t len;
+    uint32_t error;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    rules = create_rules(tmp_ctx);
+
+    ret = sudosrv_build_response_bin(tmp_ctx, SSS_SUDO_ERROR_OK,
+                                     TEST_NUM_RULES, rules, &body, &len);
+    assert_int_equal(ret, EOK);
+
+    ret = sudosrv_build_response(tmp_ctx, SSS_SUDO_ERROR_OK, TEST_NUM_RULES,
+                                 rules, &legacy_body, &legacy_len);
+    assert_int_equal(ret, EOK);
+
+    /* repeated names and values are sent only once */
+    assert_true(len < legacy_len);
+
+    ret = sss_sudo_parse_response_bin((const char *)body, len,
+                                      &result, &error);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(error, SSS_SUDO_ERROR_OK);
+
+    check_result(result);
+    sss_sudo_free_result(result);
+
+    /* truncated response */
+    ret = sss_sudo_parse_response_bin((const char *)body, len - 1,
+                                      &result, &error);
+    assert_int_equal(ret, EINVAL);
+
+    /* unknown version */
+    body[sizeof(uint32_t)] = SSS_SUDO_BIN_RESPONSE_VERSION + 1;
+    ret = sss_sudo_parse_response_bin((const char *)body, len,
+                                      &result, &error);
+    assert_int_equal(ret, EINVAL);
+
+    talloc_free(tmp_ctx);
+}
+
+static void test_sudo_response_bin_error(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sss_sudo_result *result = NULL;
+    uint8_t *body;
+    size_t len;
+    uint32_t error;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    ret = sudosrv_build_response_bin(tmp_ctx, ENOENT, 0, NULL, &body, &len);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(len, sizeof(uint32_t));
+
+    ret = sss_sudo_parse_response_bin((const char *)body, len,
+                                      &result, &error);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(error, ENOENT);
+    assert_null(result);
+
+    talloc_free(tmp_ctx);
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_sudo_response_legacy),
+        cmocka_unit_test(test_sudo_response_bin),
+        cmocka_unit_test(test_sudo_response_bin_error),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        switch (opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
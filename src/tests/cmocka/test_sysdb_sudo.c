@@ -459,6 +459,39 @@ void test_sudo_purge_by_filter(void **state)
     talloc_zfree(delete_filter);
 }
 
+void test_sudo_purge_by_filter_keep(void **state)
+{
+    errno_t ret;
+    struct sysdb_attrs *rule;
+    char *delete_filter;
+    struct sysdb_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                         struct sysdb_test_ctx);
+
+    rule = sysdb_new_attrs(test_ctx);
+    assert_non_null(rule);
+    create_rule_attrs(rule, 0);
+
+    ret = sysdb_sudo_store(test_ctx->tctx->dom, &rule, 1);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(get_stored_rules_count(test_ctx), 1);
+
+    delete_filter = sysdb_sudo_filter_user(test_ctx, users[0].name, NULL, 0);
+    assert_non_null(delete_filter);
+
+    /* The rule is downloaded again so it must not be purged */
+    ret = sysdb_sudo_purge(test_ctx->tctx->dom, delete_filter, &rule, 1);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(get_stored_rules_count(test_ctx), 1);
+
+    /* Storing it again unchanged keeps the rule */
+    ret = sysdb_sudo_store(test_ctx->tctx->dom, &rule, 1);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(get_stored_rules_count(test_ctx), 1);
+
+    talloc_zfree(rule);
+    talloc_zfree(delete_filter);
+}
+
 void test_sudo_purge_by_rules(void **state)
 {
     errno_t ret;
@@ -857,6 +890,57 @@ void test_search_sudo_rules(void **state)
     talloc_zfree(msgs);
 }
 
+void test_search_sudo_rules_netgroups(void **state)
+{
+    errno_t ret;
+    char *filter;
+    const char *attrs[] = { SYSDB_NAME, SYSDB_SUDO_CACHE_AT_USER_INDEX, NULL };
+    struct ldb_message **msgs = NULL;
+    size_t msgs_count;
+    struct sysdb_attrs *tmp_rules[2];
+    const char *value;
+    struct sysdb_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                         struct sysdb_test_ctx);
+
+    tmp_rules[0] = sysdb_new_attrs(test_ctx);
+    assert_non_null(tmp_rules[0]);
+    create_rule_attrs(tmp_rules[0], 0);
+
+    tmp_rules[1] = sysdb_new_attrs(test_ctx);
+    assert_non_null(tmp_rules[1]);
+    ret = sysdb_attrs_add_string_safe(tmp_rules[1], SYSDB_SUDO_CACHE_AT_CN,
+                                      rules[1].name);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_string_safe(tmp_rules[1], SYSDB_SUDO_CACHE_AT_USER,
+                                      "+test_netgroup");
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_sudo_store(test_ctx->tctx->dom, tmp_rules, 2);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(get_stored_rules_count(test_ctx), 2);
+
+    filter = sysdb_sudo_filter_netgroups(test_ctx, users[0].name, NULL,
+                                         users[0].uid);
+    assert_non_null(filter);
+
+    ret = sysdb_search_sudo_rules(test_ctx, test_ctx->tctx->dom, filter,
+                                  attrs, &msgs_count, &msgs);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(msgs_count, 1);
+
+    value = ldb_msg_find_attr_as_string(msgs[0], SYSDB_NAME, NULL);
+    assert_string_equal(value, rules[1].name);
+
+    value = ldb_msg_find_attr_as_string(msgs[0],
+                                        SYSDB_SUDO_CACHE_AT_USER_INDEX, NULL);
+    assert_string_equal(value, SYSDB_SUDO_USER_INDEX_NETGROUP);
+
+    talloc_zfree(tmp_rules[0]);
+    talloc_zfree(tmp_rules[1]);
+    talloc_zfree(filter);
+    talloc_zfree(msgs);
+}
+
 void test_filter_rules_by_time(void **state)
 {
     errno_t ret;
@@ -977,6 +1061,9 @@ int main(int argc, const char *argv[])
                                         test_sysdb_setup,
                                         test_sysdb_teardown),
 
+        cmocka_unit_test_setup_teardown(test_sudo_purge_by_filter_keep,
+                                        test_sysdb_setup,
+                                        test_sysdb_teardown),
         cmocka_unit_test_setup_teardown(test_sudo_purge_by_rules,
                                         test_sysdb_setup,
                                         test_sysdb_teardown),
@@ -1024,6 +1111,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_search_sudo_rules,
                                         test_sysdb_setup,
                                         test_sysdb_teardown),
+        cmocka_unit_test_setup_teardown(test_search_sudo_rules_netgroups,
+                                        test_sysdb_setup,
+                                        test_sysdb_teardown),
 
         /* sysdb_sudo_filter_rules_by_time() */
         cmocka_unit_test_setup_teardown(test_filter_rules_by_time,
@@ -27,6 +27,9 @@
 
 #include "tests/cmocka/common_mock.h"
 #include "db/sysdb_private.h"
+#include "db/sysdb_services.h"
+#include "db/sysdb_iphosts.h"
+#include "db/sysdb_sudo.h"
 
 #define TESTS_PATH "tp_" BASE_FILE_STEM
 #define TEST_CONF_DB "tests_conf.ldb"
@@ -49,6 +52,12 @@
 #define TEST_USER_SID           "S-1-5-21-123-456-789-222"
 #define TEST_USER_UPN           "test_user@TEST_REALM"
 
+#define TEST_SERVICE_NAME       "test_service"
+#define TEST_SERVICE_PORT       4242
+#define TEST_HOST_NAME          "test_host.example.com"
+#define TEST_HOST_ADDRESS       "192.168.10.1"
+#define TEST_SUDO_RULE_NAME     "test_rule"
+
 #define TEST_MODSTAMP_1   "20160408132553Z"
 #define TEST_MODSTAMP_2   "20160408142553Z"
 #define TEST_MODSTAMP_3   "20160408152553Z"
@@ -496,6 +505,128 @@ static void test_sysdb_group_update(void **state)
     talloc_free(group_attrs);
 }
 
+static uint64_t get_gr_raw_ts_cache_timestamp(struct sysdb_ts_test_ctx *test_ctx,
+                                              const char *name)
+{
+    struct ldb_result *res;
+    struct ldb_dn *dn;
+    uint64_t cache_expire_ts;
+    const char *attrs[] = { SYSDB_CACHE_EXPIRE,
+                            NULL,
+    };
+    int ret;
+
+    dn = sysdb_group_dn(test_ctx, test_ctx->tctx->dom, name);
+    if (dn == NULL) {
+        return 0;
+    }
+
+    /* Bypass the buffered updates */
+    ret = ldb_search(test_ctx->tctx->sysdb->ldb_ts, test_ctx, &res,
+                     dn, LDB_SCOPE_BASE, attrs, NULL);
+    talloc_free(dn);
+    if (ret != EOK || res == NULL || res->count != 1) {
+        return 0;
+    }
+
+    cache_expire_ts = ldb_msg_find_attr_as_uint64(res->msgs[0],
+                                                  SYSDB_CACHE_EXPIRE, 0);
+    talloc_free(res);
+    return cache_expire_ts;
+}
+
+static void test_sysdb_group_update_buffered(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    struct ldb_result *res = NULL;
+    struct sysdb_attrs *group_attrs = NULL;
+    struct ldb_message *msg;
+    uint64_t cache_expire_ts;
+
+    ret = sysdb_ts_buffer_enable(test_ctx->tctx->sysdb, 100, 3600);
+    assert_int_equal(ret, EOK);
+
+    group_attrs = create_modstamp_attrs(test_ctx, TEST_MODSTAMP_1);
+    assert_non_null(group_attrs);
+
+    /* A new group is written right away */
+    ret = sysdb_store_group(test_ctx->tctx->dom,
+                            TEST_GROUP_NAME,
+                            TEST_GROUP_GID,
+                            group_attrs,
+                            TEST_CACHE_TIMEOUT,
+                            TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    cache_expire_ts = get_gr_raw_ts_cache_timestamp(test_ctx, TEST_GROUP_NAME);
+    assert_int_equal(cache_expire_ts, TEST_CACHE_TIMEOUT + TEST_NOW_1);
+
+    /* The timestamps of an unchanged group are buffered, but lookups
+     * already see them */
+    ret = sysdb_store_group(test_ctx->tctx->dom,
+                            TEST_GROUP_NAME,
+                            TEST_GROUP_GID,
+                            group_attrs,
+                            TEST_CACHE_TIMEOUT,
+                            TEST_NOW_2);
+    assert_int_equal(ret, EOK);
+
+    cache_expire_ts = get_gr_raw_ts_cache_timestamp(test_ctx, TEST_GROUP_NAME);
+    assert_int_equal(cache_expire_ts, TEST_CACHE_TIMEOUT + TEST_NOW_1);
+    cache_expire_ts = get_gr_ts_cache_timestamp(test_ctx, TEST_GROUP_NAME);
+    assert_int_equal(cache_expire_ts, TEST_CACHE_TIMEOUT + TEST_NOW_2);
+
+    res = sysdb_getgrnam_res(test_ctx, test_ctx->tctx->dom, TEST_GROUP_NAME);
+    assert_int_equal(res->count, 1);
+    assert_int_equal(ldb_msg_find_attr_as_uint64(res->msgs[0],
+                                                 SYSDB_CACHE_EXPIRE, 0),
+                     TEST_CACHE_TIMEOUT + TEST_NOW_2);
+    talloc_free(res);
+
+    ret = sysdb_ts_buffer_flush(test_ctx->tctx->sysdb);
+    assert_int_equal(ret, EOK);
+
+    cache_expire_ts = get_gr_raw_ts_cache_timestamp(test_ctx, TEST_GROUP_NAME);
+    assert_int_equal(cache_expire_ts, TEST_CACHE_TIMEOUT + TEST_NOW_2);
+
+    /* Expire the group behind the buffer's back like sss_cache does, the
+     * buffered update must not override it */
+    ret = sysdb_store_group(test_ctx->tctx->dom,
+                            TEST_GROUP_NAME,
+                            TEST_GROUP_GID,
+                            group_attrs,
+                            TEST_CACHE_TIMEOUT,
+                            TEST_NOW_3);
+    assert_int_equal(ret, EOK);
+
+    msg = ldb_msg_new(test_ctx);
+    assert_non_null(msg);
+    msg->dn = sysdb_group_dn(msg, test_ctx->tctx->dom, TEST_GROUP_NAME);
+    assert_non_null(msg->dn);
+    ret = ldb_msg_add_empty(msg, SYSDB_CACHE_EXPIRE, LDB_FLAG_MOD_REPLACE,
+                            NULL);
+    assert_int_equal(ret, LDB_SUCCESS);
+    ret = ldb_msg_add_string(msg, SYSDB_CACHE_EXPIRE, "1");
+    assert_int_equal(ret, LDB_SUCCESS);
+    ret = ldb_modify(test_ctx->tctx->sysdb->ldb_ts, msg);
+    assert_int_equal(ret, LDB_SUCCESS);
+    talloc_free(msg);
+
+    ret = sysdb_ts_buffer_flush(test_ctx->tctx->sysdb);
+    assert_int_equal(ret, EOK);
+
+    cache_expire_ts = get_gr_raw_ts_cache_timestamp(test_ctx, TEST_GROUP_NAME);
+    assert_int_equal(cache_expire_ts, 1);
+    cache_expire_ts = get_gr_ts_cache_timestamp(test_ctx, TEST_GROUP_NAME);
+    assert_int_equal(cache_expire_ts, 1);
+
+    ret = sysdb_ts_buffer_enable(test_ctx->tctx->sysdb, 0, 0);
+    assert_int_equal(ret, EOK);
+    talloc_free(group_attrs);
+}
+
 static void test_sysdb_group_delete(void **state)
 {
     int ret;
@@ -851,6 +982,62 @@ static void test_merge_ldb_results(void **state)
     talloc_free(res2);
 }
 
+static struct ldb_result *merge_test_result(TALLOC_CTX *mem_ctx,
+                                            struct ldb_context *ldb,
+                                            unsigned int first,
+                                            unsigned int count)
+{
+    struct ldb_result *res;
+    unsigned int i;
+
+    res = talloc_zero(mem_ctx, struct ldb_result);
+    assert_non_null(res);
+
+    res->msgs = talloc_zero_array(res, struct ldb_message *, count + 1);
+    assert_non_null(res->msgs);
+
+    for (i = 0; i < count; i++) {
+        res->msgs[i] = ldb_msg_new(res->msgs);
+        assert_non_null(res->msgs[i]);
+
+        res->msgs[i]->dn = ldb_dn_new_fmt(res->msgs[i], ldb,
+                                          "name=user%u,cn=users,cn=test",
+                                          first + i);
+        assert_non_null(res->msgs[i]->dn);
+    }
+    res->count = count;
+
+    return res;
+}
+
+static void test_merge_ldb_results_large(void **state)
+{
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    struct ldb_context *ldb = test_ctx->tctx->sysdb->ldb;
+    struct ldb_message *ts_msg;
+    struct ldb_result *res;
+    struct ldb_result *res1;
+    struct ldb_result *res2;
+
+    /* large enough for the DNs to be looked up in a hash table */
+    res1 = merge_test_result(test_ctx, ldb, 0, 100);
+    res2 = merge_test_result(test_ctx, ldb, 50, 100);
+    ts_msg = res2->msgs[0];
+
+    res = sss_merge_ldb_results(res1, res2);
+    assert_non_null(res);
+    assert_int_equal(res->count, 150);
+
+    /* the entry of the timestamp cache replaces the one of the cache */
+    assert_ptr_equal(res->msgs[50], ts_msg);
+    assert_string_equal(ldb_dn_get_linearized(res->msgs[100]->dn),
+                        "name=user100,cn=users,cn=test");
+
+    talloc_free(res1);
+    talloc_free(res2);
+}
+
 static void test_group_bysid(void **state)
 {
     int ret;
@@ -1095,6 +1282,21 @@ static void test_sysdb_user_delete(void **state)
     talloc_free(ts_res);
 }
 
+static errno_t test_stream_ts_attrs_cb(struct ldb_message *msg, void *pvt)
+{
+    size_t *count = pvt;
+
+    assert_ts_attrs_msg(msg, TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    (*count)++;
+
+    return EOK;
+}
+
+static errno_t test_stream_stop_cb(struct ldb_message *msg, void *pvt)
+{
+    return EINTR;
+}
+
 static void test_sysdb_getpw_merges(void **state)
 {
     int ret;
@@ -1158,6 +1360,27 @@ static void test_sysdb_getpw_merges(void **state)
                               TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
     talloc_free(msgs);
 
+    /* The streaming search must merge the timestamps as well */
+    msgs_count = 0;
+    ret = sysdb_search_users_stream(test_ctx->tctx->dom,
+                                    "("SYSDB_NAME"="TEST_USER_NAME")",
+                                    pw_fetch_attrs,
+                                    test_stream_ts_attrs_cb, &msgs_count);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(msgs_count, 1);
+
+    ret = sysdb_search_users_stream(test_ctx->tctx->dom,
+                                    "("SYSDB_NAME"="TEST_USER_NAME")",
+                                    pw_fetch_attrs,
+                                    test_stream_stop_cb, NULL);
+    assert_int_equal(ret, EINTR);
+
+    ret = sysdb_search_users_stream(test_ctx->tctx->dom,
+                                    "("SYSDB_NAME"=no_such_user)",
+                                    pw_fetch_attrs,
+                                    test_stream_stop_cb, NULL);
+    assert_int_equal(ret, ENOENT);
+
     /* set_user_attrs must bump the ts cache */
     user_attrs = create_ts_attrs(test_ctx, TEST_NOW_3 + TEST_CACHE_TIMEOUT, TEST_NOW_3);
     assert_non_null(user_attrs);
@@ -1331,6 +1554,75 @@ static void test_user_byupn(void **state)
     talloc_free(res);
 }
 
+static void test_sysdb_initgr_index(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    struct ldb_result *res;
+    const char *name;
+
+    ret = sysdb_store_user(test_ctx->tctx->dom, TEST_USER_NAME, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_NAME,
+                           "/home/"TEST_USER_NAME, "/bin/bash", NULL,
+                           NULL, NULL, TEST_CACHE_TIMEOUT,
+                           TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                            TEST_GROUP_GID, NULL, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME_2,
+                            TEST_GROUP_GID_2, NULL, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_add_group_member(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                                 TEST_USER_NAME, SYSDB_MEMBER_USER, false);
+    assert_int_equal(ret, EOK);
+
+    /* The first lookup resolves the groups, the second one reuses them */
+    ret = sysdb_initgroups_with_views(test_ctx, test_ctx->tctx->dom,
+                                      TEST_USER_NAME, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 2);
+    talloc_free(res);
+
+    ret = sysdb_initgroups_with_views(test_ctx, test_ctx->tctx->dom,
+                                      TEST_USER_NAME, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 2);
+    name = ldb_msg_find_attr_as_string(res->msgs[1], SYSDB_NAME, NULL);
+    assert_string_equal(name, TEST_GROUP_NAME);
+    talloc_free(res);
+
+    /* A new membership invalidates the remembered groups */
+    ret = sysdb_add_group_member(test_ctx->tctx->dom, TEST_GROUP_NAME_2,
+                                 TEST_USER_NAME, SYSDB_MEMBER_USER, false);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_initgroups_with_views(test_ctx, test_ctx->tctx->dom,
+                                      TEST_USER_NAME, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 3);
+    talloc_free(res);
+
+    /* And so does a removed one */
+    ret = sysdb_remove_group_member(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                                    TEST_USER_NAME, SYSDB_MEMBER_USER, false);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_initgroups_with_views(test_ctx, test_ctx->tctx->dom,
+                                      TEST_USER_NAME, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 2);
+    name = ldb_msg_find_attr_as_string(res->msgs[1], SYSDB_NAME, NULL);
+    assert_string_equal(name, TEST_GROUP_NAME_2);
+    talloc_free(res);
+}
+
 static void test_sysdb_zero_now(void **state)
 {
     int ret;
@@ -1655,6 +1947,212 @@ static void test_sysdb_user_missing_ts(void **state)
     talloc_zfree(userdn);
 }
 
+static void test_sysdb_user_access(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                               struct sysdb_ts_test_ctx);
+    struct ldb_result *res = NULL;
+    struct sysdb_attrs *attrs = NULL;
+    struct ldb_dn *userdn;
+    const char *access_attrs[] = { SYSDB_LAST_ACCESS, NULL };
+
+    attrs = create_modstamp_attrs(test_ctx, TEST_MODSTAMP_1);
+    assert_non_null(attrs);
+    ret = sysdb_store_user(test_ctx->tctx->dom, TEST_USER_NAME, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_NAME,
+                           "/home/"TEST_USER_NAME, "/bin/bash", NULL,
+                           attrs, NULL, TEST_CACHE_TIMEOUT,
+                           TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(attrs);
+
+    userdn = sysdb_user_dn(test_ctx, test_ctx->tctx->dom, TEST_USER_NAME);
+    assert_non_null(userdn);
+
+    ret = sysdb_set_entry_access(test_ctx->tctx->dom, userdn, TEST_NOW_3);
+    assert_int_equal(ret, EOK);
+
+    /* The access time is merged into the lookups */
+    res = sysdb_getpwnam_res(test_ctx, test_ctx->tctx->dom, TEST_USER_NAME);
+    assert_int_equal(res->count, 1);
+    assert_int_equal(ldb_msg_find_attr_as_uint64(res->msgs[0],
+                                                 SYSDB_LAST_ACCESS, 0),
+                     TEST_NOW_3);
+    talloc_zfree(res);
+
+    /* but it is not written to the persistent cache */
+    SSS_LDB_SEARCH(ret, test_ctx->tctx->dom->sysdb->ldb, test_ctx, &res,
+                   userdn, LDB_SCOPE_BASE, access_attrs, NULL);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_null(ldb_msg_find_element(res->msgs[0], SYSDB_LAST_ACCESS));
+    talloc_zfree(res);
+
+    /* Entries without timestamps are left alone */
+    ret = ldb_delete(test_ctx->tctx->dom->sysdb->ldb_ts, userdn);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_set_entry_access(test_ctx->tctx->dom, userdn, TEST_NOW_4);
+    assert_int_equal(ret, EOK);
+
+    SSS_LDB_SEARCH(ret, test_ctx->tctx->dom->sysdb->ldb_ts, test_ctx, &res,
+                   userdn, LDB_SCOPE_BASE, NULL, NULL);
+    assert_int_equal(ret, ENOENT);
+    talloc_zfree(res);
+    talloc_zfree(userdn);
+}
+
+static void test_sysdb_invalidate_type(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                               struct sysdb_ts_test_ctx);
+    struct ldb_result *res = NULL;
+    struct sysdb_attrs *attrs = NULL;
+    time_t now;
+
+    attrs = create_modstamp_attrs(test_ctx, TEST_MODSTAMP_1);
+    assert_non_null(attrs);
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                            TEST_GROUP_GID, attrs, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(attrs);
+
+    attrs = create_modstamp_attrs(test_ctx, TEST_MODSTAMP_1);
+    assert_non_null(attrs);
+    ret = sysdb_store_user(test_ctx->tctx->dom, TEST_USER_NAME, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_NAME,
+                           "/home/"TEST_USER_NAME, "/bin/bash", NULL,
+                           attrs, NULL, TEST_CACHE_TIMEOUT,
+                           TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(attrs);
+
+    res = sysdb_getgrnam_res(test_ctx, test_ctx->tctx->dom, TEST_GROUP_NAME);
+    assert_int_equal(res->count, 1);
+    assert_false(sysdb_entry_invalidated(test_ctx->tctx->dom, res->msgs[0]));
+    talloc_zfree(res);
+
+    ret = sysdb_invalidate_type(test_ctx->tctx->dom, SYSDB_MEMBER_GROUP);
+    assert_int_equal(ret, EOK);
+
+    /* All groups stored before the invalidation are expired */
+    res = sysdb_getgrnam_res(test_ctx, test_ctx->tctx->dom, TEST_GROUP_NAME);
+    assert_int_equal(res->count, 1);
+    assert_true(sysdb_entry_invalidated(test_ctx->tctx->dom, res->msgs[0]));
+    talloc_zfree(res);
+
+    /* but the users are not */
+    res = sysdb_getpwnam_res(test_ctx, test_ctx->tctx->dom, TEST_USER_NAME);
+    assert_int_equal(res->count, 1);
+    assert_false(sysdb_entry_invalidated(test_ctx->tctx->dom, res->msgs[0]));
+    talloc_zfree(res);
+
+    /* A group refreshed after the invalidation is valid again */
+    now = time(NULL) + 10;
+    attrs = create_modstamp_attrs(test_ctx, TEST_MODSTAMP_2);
+    assert_non_null(attrs);
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                            TEST_GROUP_GID, attrs, TEST_CACHE_TIMEOUT, now);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(attrs);
+
+    res = sysdb_getgrnam_res(test_ctx, test_ctx->tctx->dom, TEST_GROUP_NAME);
+    assert_int_equal(res->count, 1);
+    assert_false(sysdb_entry_invalidated(test_ctx->tctx->dom, res->msgs[0]));
+    talloc_zfree(res);
+
+    ret = sysdb_invalidate_type(test_ctx->tctx->dom, SYSDB_MEMBER_NETGROUP);
+    assert_int_equal(ret, EINVAL);
+}
+
+struct test_change_ctx {
+    int users;
+    int groups;
+    const char *domain;
+    const char *name;
+};
+
+static void test_change_cb(const char *domain,
+                           enum sysdb_member_type type,
+                           const char *name,
+                           void *pvt)
+{
+    struct test_change_ctx *changes = pvt;
+
+    if (type == SYSDB_MEMBER_USER) {
+        changes->users++;
+    } else if (type == SYSDB_MEMBER_GROUP) {
+        changes->groups++;
+    }
+
+    talloc_free(discard_const(changes->domain));
+    talloc_free(discard_const(changes->name));
+    changes->domain = talloc_strdup(changes, domain);
+    changes->name = talloc_strdup(changes, name);
+}
+
+static void test_sysdb_change_cb(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                               struct sysdb_ts_test_ctx);
+    struct sysdb_attrs *attrs = NULL;
+    struct test_change_ctx *changes;
+
+    changes = talloc_zero(test_ctx, struct test_change_ctx);
+    assert_non_null(changes);
+    sysdb_set_change_cb(test_ctx->tctx->sysdb, test_change_cb, changes);
+
+    attrs = create_modstamp_attrs(test_ctx, TEST_MODSTAMP_1);
+    assert_non_null(attrs);
+    ret = sysdb_store_user(test_ctx->tctx->dom, TEST_USER_NAME, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_NAME,
+                           "/home/"TEST_USER_NAME, "/bin/bash", NULL,
+                           attrs, NULL, TEST_CACHE_TIMEOUT,
+                           TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+    assert_true(changes->users > 0);
+    assert_int_equal(changes->groups, 0);
+    assert_string_equal(changes->domain, TEST_DOM1_NAME);
+    assert_string_equal(changes->name, TEST_USER_NAME);
+
+    /* Only the timestamps change, the entry does not */
+    changes->users = 0;
+    ret = sysdb_store_user(test_ctx->tctx->dom, TEST_USER_NAME, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_NAME,
+                           "/home/"TEST_USER_NAME, "/bin/bash", NULL,
+                           attrs, NULL, TEST_CACHE_TIMEOUT,
+                           TEST_NOW_2);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(changes->users, 0);
+    talloc_zfree(attrs);
+
+    attrs = create_modstamp_attrs(test_ctx, TEST_MODSTAMP_1);
+    assert_non_null(attrs);
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                            TEST_GROUP_GID, attrs, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+    assert_true(changes->groups > 0);
+    assert_string_equal(changes->name, TEST_GROUP_NAME);
+    talloc_zfree(attrs);
+
+    ret = sysdb_delete_user(test_ctx->tctx->dom, TEST_USER_NAME, 0);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(changes->users, 1);
+    assert_string_equal(changes->name, TEST_USER_NAME);
+
+    sysdb_set_change_cb(test_ctx->tctx->sysdb, NULL, NULL);
+    ret = sysdb_delete_group(test_ctx->tctx->dom, TEST_GROUP_NAME, 0);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(changes->name, TEST_USER_NAME);
+
+    talloc_free(changes);
+}
+
 static void test_sysdb_group_missing_ts(void **state)
 {
     int ret;
@@ -1707,6 +2205,309 @@ static void test_sysdb_group_missing_ts(void **state)
     talloc_zfree(groupdn);
 }
 
+static void test_sysdb_service_merges(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    const char *protocols[] = { "tcp", NULL };
+    struct ldb_result *res = NULL;
+    struct ldb_dn *dn;
+
+    ret = sysdb_store_service(test_ctx->tctx->dom, TEST_SERVICE_NAME,
+                              TEST_SERVICE_PORT, NULL, protocols,
+                              NULL, NULL, TEST_CACHE_TIMEOUT, TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    /* Only the timestamps differ, so the main cache is not written */
+    ret = sysdb_store_service(test_ctx->tctx->dom, TEST_SERVICE_NAME,
+                              TEST_SERVICE_PORT, NULL, protocols,
+                              NULL, NULL, TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    assert_int_equal(ret, EOK);
+
+    dn = sysdb_svc_dn(test_ctx->tctx->sysdb, test_ctx,
+                      test_ctx->tctx->dom->name, TEST_SERVICE_NAME);
+    assert_non_null(dn);
+    assert_int_equal(get_dn_cache_timestamp(test_ctx, dn),
+                     TEST_NOW_1 + TEST_CACHE_TIMEOUT);
+    talloc_free(dn);
+
+    ret = sysdb_getservbyname(test_ctx, test_ctx->tctx->dom,
+                              TEST_SERVICE_NAME, NULL, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_ts_attrs_res(res, TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    talloc_free(res);
+
+    ret = sysdb_getservbyport(test_ctx, test_ctx->tctx->dom,
+                              TEST_SERVICE_PORT, NULL, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_ts_attrs_res(res, TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    talloc_free(res);
+
+    ret = sysdb_enumservent(test_ctx, test_ctx->tctx->dom, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_ts_attrs_res(res, TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    talloc_free(res);
+}
+
+static void test_sysdb_host_merges(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    const char *addresses[] = { TEST_HOST_ADDRESS, NULL };
+    struct ldb_result *res = NULL;
+    struct ldb_dn *dn;
+
+    ret = sysdb_store_host(test_ctx->tctx->dom, TEST_HOST_NAME, NULL,
+                           addresses, NULL, NULL,
+                           TEST_CACHE_TIMEOUT, TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    /* Only the timestamps differ, so the main cache is not written */
+    ret = sysdb_store_host(test_ctx->tctx->dom, TEST_HOST_NAME, NULL,
+                           addresses, NULL, NULL,
+                           TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    assert_int_equal(ret, EOK);
+
+    dn = sysdb_host_dn(test_ctx, test_ctx->tctx->dom, TEST_HOST_NAME);
+    assert_non_null(dn);
+    assert_int_equal(get_dn_cache_timestamp(test_ctx, dn),
+                     TEST_NOW_1 + TEST_CACHE_TIMEOUT);
+    talloc_free(dn);
+
+    ret = sysdb_gethostbyname(test_ctx, test_ctx->tctx->dom,
+                              TEST_HOST_NAME, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_ts_attrs_res(res, TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    talloc_free(res);
+
+    ret = sysdb_gethostbyaddr(test_ctx, test_ctx->tctx->dom,
+                              TEST_HOST_ADDRESS, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_ts_attrs_res(res, TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    talloc_free(res);
+
+    ret = sysdb_enumhostent(test_ctx, test_ctx->tctx->dom, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_ts_attrs_res(res, TEST_NOW_2 + TEST_CACHE_TIMEOUT, TEST_NOW_2);
+    talloc_free(res);
+}
+
+static void test_sysdb_sudo_rule_merges(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    const char *attrs[] = { SYSDB_SUDO_CACHE_AT_CN, SYSDB_DEFAULT_ATTRS, NULL };
+    struct sysdb_attrs *rule;
+    struct sysdb_attrs *ts_attrs;
+    struct ldb_message **msgs = NULL;
+    size_t msgs_count;
+    uint64_t cache_expire_sysdb;
+    struct ldb_dn *dn;
+
+    rule = sysdb_new_attrs(test_ctx);
+    assert_non_null(rule);
+    ret = sysdb_attrs_add_string(rule, SYSDB_SUDO_CACHE_AT_CN,
+                                 TEST_SUDO_RULE_NAME);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_string(rule, SYSDB_SUDO_CACHE_AT_USER,
+                                 TEST_USER_NAME);
+    assert_int_equal(ret, EOK);
+
+    test_ctx->tctx->dom->sudo_timeout = TEST_CACHE_TIMEOUT;
+    ret = sysdb_sudo_store(test_ctx->tctx->dom, &rule, 1);
+    talloc_free(rule);
+    assert_int_equal(ret, EOK);
+
+    dn = sysdb_custom_dn(test_ctx, test_ctx->tctx->dom,
+                         TEST_SUDO_RULE_NAME, SUDORULE_SUBDIR);
+    assert_non_null(dn);
+    cache_expire_sysdb = get_dn_cache_timestamp(test_ctx, dn);
+    assert_true(cache_expire_sysdb > TEST_NOW_3 + TEST_CACHE_TIMEOUT);
+
+    /* This is what storing an unchanged rule does */
+    ts_attrs = create_ts_attrs(test_ctx, TEST_NOW_3 + TEST_CACHE_TIMEOUT,
+                               TEST_NOW_3);
+    assert_non_null(ts_attrs);
+    ret = sysdb_set_sudo_rule_attr(test_ctx->tctx->dom, TEST_SUDO_RULE_NAME,
+                                   ts_attrs, SYSDB_MOD_REP);
+    talloc_free(ts_attrs);
+    assert_int_equal(ret, EOK);
+
+    /* The main cache still has the old value */
+    assert_int_equal(get_dn_cache_timestamp(test_ctx, dn), cache_expire_sysdb);
+    talloc_free(dn);
+
+    ret = sysdb_search_custom_by_name(test_ctx, test_ctx->tctx->dom,
+                                      TEST_SUDO_RULE_NAME, SUDORULE_SUBDIR,
+                                      attrs, &msgs_count, &msgs);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(msgs_count, 1);
+    assert_ts_attrs_msgs_list(msgs_count, msgs,
+                              TEST_NOW_3 + TEST_CACHE_TIMEOUT, TEST_NOW_3);
+    talloc_free(msgs);
+
+    ret = sysdb_search_sudo_rules(test_ctx, test_ctx->tctx->dom,
+                                  "("SYSDB_SUDO_CACHE_AT_CN"="
+                                  TEST_SUDO_RULE_NAME")",
+                                  attrs, &msgs_count, &msgs);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(msgs_count, 1);
+    assert_ts_attrs_msgs_list(msgs_count, msgs,
+                              TEST_NOW_3 + TEST_CACHE_TIMEOUT, TEST_NOW_3);
+    talloc_free(msgs);
+}
+
+static void test_sysdb_cache_import_fixup(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    struct sysdb_attrs *attrs;
+    struct ldb_message *msg;
+    uint64_t cache_expire_sysdb;
+    uint64_t cache_expire_ts;
+    const char *login_attrs[] = { SYSDB_CACHEDPWD,
+                                  SYSDB_LAST_ONLINE_AUTH,
+                                  SYSDB_FAILED_LOGIN_ATTEMPTS,
+                                  SYSDB_SHELL,
+                                  NULL };
+
+    ret = sysdb_store_user(test_ctx->tctx->dom, TEST_USER_NAME, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_NAME,
+                           "/home/"TEST_USER_NAME, "/bin/bash", NULL,
+                           NULL, NULL, TEST_CACHE_TIMEOUT, TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    /* A group that never expires */
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                            TEST_GROUP_GID, NULL, 0, TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    /* The login state of the exporting host */
+    attrs = sysdb_new_attrs(test_ctx);
+    assert_non_null(attrs);
+    ret = sysdb_attrs_add_string(attrs, SYSDB_CACHEDPWD, "hash");
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_LAST_ONLINE_AUTH, TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_uint32(attrs, SYSDB_FAILED_LOGIN_ATTEMPTS, 2);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_set_user_attr(test_ctx->tctx->dom, TEST_USER_NAME, attrs,
+                              SYSDB_MOD_REP);
+    talloc_free(attrs);
+    assert_int_equal(ret, EOK);
+
+    /* Both caches are shifted, the login state is removed and the rest of
+     * the user is kept */
+    ret = sysdb_cache_import_fixup(test_ctx->tctx->sysdb,
+                                   test_ctx->tctx->dom, TEST_NOW_2);
+    assert_int_equal(ret, EOK);
+
+    get_pw_timestamp_attrs(test_ctx, TEST_USER_NAME,
+                           &cache_expire_sysdb, &cache_expire_ts);
+    assert_int_equal(cache_expire_sysdb,
+                     TEST_CACHE_TIMEOUT + TEST_NOW_1 + TEST_NOW_2);
+    assert_int_equal(cache_expire_ts,
+                     TEST_CACHE_TIMEOUT + TEST_NOW_1 + TEST_NOW_2);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->tctx->dom,
+                                    TEST_USER_NAME, login_attrs, &msg);
+    assert_int_equal(ret, EOK);
+    assert_null(ldb_msg_find_element(msg, SYSDB_CACHEDPWD));
+    assert_null(ldb_msg_find_element(msg, SYSDB_LAST_ONLINE_AUTH));
+    assert_null(ldb_msg_find_element(msg, SYSDB_FAILED_LOGIN_ATTEMPTS));
+    assert_string_equal(ldb_msg_find_attr_as_string(msg, SYSDB_SHELL, NULL),
+                        "/bin/bash");
+    talloc_free(msg);
+
+    get_gr_timestamp_attrs(test_ctx, TEST_GROUP_NAME,
+                           &cache_expire_sysdb, &cache_expire_ts);
+    assert_int_equal(cache_expire_sysdb, 0);
+    assert_int_equal(cache_expire_ts, 0);
+
+    /* Shifting back past the epoch leaves the user expired, not
+     * valid forever */
+    ret = sysdb_cache_import_fixup(test_ctx->tctx->sysdb,
+                                   test_ctx->tctx->dom, -TEST_NOW_6);
+    assert_int_equal(ret, EOK);
+
+    get_pw_timestamp_attrs(test_ctx, TEST_USER_NAME,
+                           &cache_expire_sysdb, &cache_expire_ts);
+    assert_int_equal(cache_expire_sysdb, 1);
+    assert_int_equal(cache_expire_ts, 1);
+}
+
+struct cache_files_locked_ctx {
+    const char *ldb_file;
+    const char *ts_file;
+    int calls;
+    errno_t ret;
+};
+
+static errno_t test_cache_files_locked_cb(const char *ldb_file,
+                                          const char *ts_file,
+                                          void *pvt)
+{
+    struct cache_files_locked_ctx *ctx = pvt;
+
+    assert_string_equal(ldb_file, ctx->ldb_file);
+    assert_non_null(ts_file);
+    assert_string_equal(ts_file, ctx->ts_file);
+    assert_int_equal(access(ldb_file, R_OK), 0);
+    assert_int_equal(access(ts_file, R_OK), 0);
+
+    ctx->calls++;
+    return ctx->ret;
+}
+
+static void test_sysdb_cache_files_locked(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    struct cache_files_locked_ctx ctx = { 0 };
+    char *ldb_file;
+    char *ts_file;
+
+    ret = sysdb_cache_files(test_ctx, test_ctx->tctx->dom, TESTS_PATH,
+                            &ldb_file, &ts_file);
+    assert_int_equal(ret, EOK);
+    assert_non_null(ts_file);
+    ctx.ldb_file = ldb_file;
+    ctx.ts_file = ts_file;
+
+    ret = sysdb_cache_files_locked(test_ctx->tctx->sysdb,
+                                   test_cache_files_locked_cb, &ctx);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(ctx.calls, 1);
+
+    /* The error of the callback is returned */
+    ctx.ret = ERR_INTERNAL;
+    ret = sysdb_cache_files_locked(test_ctx->tctx->sysdb,
+                                   test_cache_files_locked_cb, &ctx);
+    assert_int_equal(ret, ERR_INTERNAL);
+    assert_int_equal(ctx.calls, 2);
+
+    /* Both transactions are gone, the cache can be written again */
+    ret = sysdb_store_user(test_ctx->tctx->dom, TEST_USER_NAME, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_NAME,
+                           "/home/"TEST_USER_NAME, "/bin/bash", NULL,
+                           NULL, NULL, TEST_CACHE_TIMEOUT, TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    talloc_free(ldb_file);
+    talloc_free(ts_file);
+}
+
 int main(int argc, const char *argv[])
 {
     int rv;
@@ -1725,6 +2526,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sysdb_group_update,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_group_update_buffered,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
         cmocka_unit_test_setup_teardown(test_sysdb_group_delete,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
@@ -1740,6 +2544,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_merge_ldb_results,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_merge_ldb_results_large,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
         cmocka_unit_test_setup_teardown(test_sysdb_user_update,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
@@ -1755,6 +2562,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_user_byupn,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_initgr_index,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
         cmocka_unit_test_setup_teardown(test_sysdb_zero_now,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
@@ -1764,9 +2574,33 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sysdb_user_missing_ts,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_user_access,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
         cmocka_unit_test_setup_teardown(test_sysdb_group_missing_ts,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_invalidate_type,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_change_cb,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_service_merges,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_host_merges,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_sudo_rule_merges,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_cache_import_fixup,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_cache_files_locked,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -216,6 +216,102 @@ static void test_sysdb_store_override(void **state)
 
 }
 
+static void test_sysdb_store_override_merged(void **state)
+{
+    int ret;
+    struct ldb_message *msg;
+    struct ldb_result *res;
+    struct ldb_message_element *el;
+    struct sysdb_attrs *attrs;
+    char *name;
+    const char override_dn_str[] = SYSDB_OVERRIDE_ANCHOR_UUID "=" \
+                       TEST_ANCHOR_PREFIX TEST_USER_SID "," TEST_VIEW_CONTAINER;
+
+    struct sysdb_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                         struct sysdb_test_ctx);
+
+    test_ctx->domain->mpg_mode = MPG_DISABLED;
+    name = sss_create_internal_fqname(test_ctx, TEST_USER_NAME,
+                                      test_ctx->domain->name);
+    assert_non_null(name);
+
+    ret = sysdb_store_user(test_ctx->domain, name, NULL,
+                           TEST_USER_UID, TEST_USER_GID, TEST_USER_GECOS,
+                           TEST_USER_HOMEDIR, TEST_USER_SHELL, NULL, NULL, NULL,
+                           0,0);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain, name,
+                                    NULL, &msg);
+    assert_int_equal(ret, EOK);
+
+    attrs = sysdb_new_attrs(test_ctx);
+    assert_non_null(attrs);
+
+    ret = sysdb_attrs_add_string(attrs, SYSDB_OVERRIDE_ANCHOR_UUID,
+                                 TEST_ANCHOR_PREFIX TEST_USER_SID);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_attrs_add_string(attrs, SYSDB_SHELL, "/bin/override");
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_override(test_ctx->domain, TEST_VIEW_NAME,
+                               SYSDB_MEMBER_USER, attrs, msg->dn);
+    assert_int_equal(ret, EOK);
+
+    /* The override values are stored with the original object */
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain, name,
+                                    NULL, &msg);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(override_dn_str,
+                        ldb_msg_find_attr_as_string(msg,
+                                                    SYSDB_MERGED_OVERRIDE_DN,
+                                                    NULL));
+    assert_string_equal("/bin/override",
+                        ldb_msg_find_attr_as_string(msg,
+                                                    OVERRIDE_PREFIX SYSDB_SHELL,
+                                                    NULL));
+
+    /* and returned once by the lookups with views */
+    test_ctx->domain->has_views = true;
+    test_ctx->domain->view_name = TEST_VIEW_NAME;
+
+    ret = sysdb_getpwnam_with_views(test_ctx, test_ctx->domain, name, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    el = ldb_msg_find_element(res->msgs[0], OVERRIDE_PREFIX SYSDB_SHELL);
+    assert_non_null(el);
+    assert_int_equal(el->num_values, 1);
+
+    /* A changed override replaces them */
+    ret = sysdb_attrs_add_string(attrs, SYSDB_GECOS, "Override Gecos");
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_override(test_ctx->domain, TEST_VIEW_NAME,
+                               SYSDB_MEMBER_USER, attrs, msg->dn);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_getpwnam_with_views(test_ctx, test_ctx->domain, name, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+    assert_string_equal("Override Gecos",
+                        ldb_msg_find_attr_as_string(res->msgs[0],
+                                                    OVERRIDE_PREFIX SYSDB_GECOS,
+                                                    NULL));
+
+    /* A removed override removes them */
+    ret = sysdb_store_override(test_ctx->domain, TEST_VIEW_NAME,
+                               SYSDB_MEMBER_USER, NULL, msg->dn);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain, name,
+                                    NULL, &msg);
+    assert_int_equal(ret, EOK);
+    assert_null(ldb_msg_find_element(msg, SYSDB_MERGED_OVERRIDE_DN));
+    assert_null(ldb_msg_find_element(msg, OVERRIDE_PREFIX SYSDB_SHELL));
+    assert_null(ldb_msg_find_element(msg, OVERRIDE_PREFIX SYSDB_GECOS));
+}
+
 void test_sysdb_add_overrides_to_object(void **state)
 {
     int ret;
@@ -715,6 +811,85 @@ static void test_sysdb_enumpwent_views(void **state)
     check_enumpwent(ret, test_ctx->domain, res, true);
 }
 
+static void test_sysdb_enumpwent_keys(void **state)
+{
+    int ret;
+    struct sysdb_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                        struct sysdb_test_ctx);
+    struct ldb_result *keys;
+    struct ldb_result *res;
+    struct ldb_message *msg;
+    char *fqname;
+    size_t c;
+
+    ret = sysdb_enumpwent_keys(test_ctx, test_ctx->domain, &keys);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(keys->count, N_ELEMENTS(users)-1);
+
+    /* Reading the entries one by one gives the same result */
+    res = talloc_zero(test_ctx, struct ldb_result);
+    assert_non_null(res);
+    res->msgs = talloc_zero_array(res, struct ldb_message *, keys->count + 1);
+    assert_non_null(res->msgs);
+
+    for (c = 0; c < keys->count; c++) {
+        ret = sysdb_enum_entry_with_views(res->msgs, test_ctx->domain, false,
+                                          keys->msgs[c]->dn, &res->msgs[c]);
+        assert_int_equal(ret, EOK);
+        res->count++;
+    }
+
+    check_enumpwent(EOK, test_ctx->domain, res, true);
+
+    /* Removed entries are reported as missing */
+    fqname = sss_create_internal_fqname(test_ctx, "alice",
+                                        test_ctx->domain->name);
+    assert_non_null(fqname);
+    ret = sysdb_delete_user(test_ctx->domain, fqname, 0);
+    talloc_free(fqname);
+    assert_int_equal(ret, EOK);
+
+    for (c = 0; c < keys->count; c++) {
+        ret = sysdb_enum_entry_with_views(res, test_ctx->domain, false,
+                                          keys->msgs[c]->dn, &msg);
+        if (strstr(ldb_dn_get_linearized(keys->msgs[c]->dn), "alice")) {
+            assert_int_equal(ret, ENOENT);
+        } else {
+            assert_int_equal(ret, EOK);
+        }
+    }
+
+    talloc_free(keys);
+    talloc_free(res);
+}
+
+static void test_sysdb_get_user_attr_by_uid_views(void **state)
+{
+    int ret;
+    struct sysdb_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                        struct sysdb_test_ctx);
+    const char *attrs[] = { SYSDB_NAME, SYSDB_GECOS, NULL };
+    struct ldb_result *res;
+
+    /* alice */
+    ret = sysdb_get_user_attr_by_uid_with_views(test_ctx, test_ctx->domain,
+                                                1234, attrs, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+
+    /* Only the requested attributes and their overrides are returned */
+    assert_user_attrs(res->msgs[0], test_ctx->domain, "alice", true);
+    assert_null(ldb_msg_find_element(res->msgs[0], SYSDB_SHELL));
+    assert_null(ldb_msg_find_element(res->msgs[0], SYSDB_HOMEDIR));
+    talloc_free(res);
+
+    ret = sysdb_get_user_attr_by_uid_with_views(test_ctx, test_ctx->domain,
+                                                4321, attrs, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 0);
+    talloc_free(res);
+}
+
 static void test_sysdb_enumpwent_filter(void **state)
 {
     int ret;
@@ -1063,6 +1238,8 @@ int main(int argc, const char *argv[])
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_sysdb_store_override,
                                         test_sysdb_setup, test_sysdb_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_store_override_merged,
+                                        test_sysdb_setup, test_sysdb_teardown),
         cmocka_unit_test_setup_teardown(test_sysdb_add_overrides_to_object,
                                         test_sysdb_setup, test_sysdb_teardown),
         cmocka_unit_test_setup_teardown(test_sysdb_add_overrides_to_object_local,
@@ -1081,6 +1258,12 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sysdb_enumpwent_views,
                                         test_enum_users_setup,
                                         test_enum_users_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_enumpwent_keys,
+                                        test_enum_users_setup,
+                                        test_enum_users_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_get_user_attr_by_uid_views,
+                                        test_enum_users_setup,
+                                        test_enum_users_teardown),
         cmocka_unit_test_setup_teardown(test_sysdb_enumpwent_filter,
                                         test_enum_users_setup,
                                         test_enum_users_teardown),
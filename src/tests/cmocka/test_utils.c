@@ -631,6 +631,72 @@ void test_find_domain_by_sid_disabled(void **state)
     }
 }
 
+void test_find_domain_index(void **state)
+{
+    struct dom_list_test_ctx *test_ctx = talloc_get_type(*state,
+                                                      struct dom_list_test_ctx);
+    struct sss_domain_info *dom;
+    struct sss_domain_info *new_dom;
+
+    /* builds the index */
+    dom = find_domain_by_name(test_ctx->dom_list, "NAME_3.DOM", false);
+    assert_non_null(dom);
+    assert_string_equal(dom->name, "name_3.dom");
+
+    dom = find_domain_by_sid(test_ctx->dom_list, "S-1-5-21-1-2-3-1000");
+    assert_non_null(dom);
+    assert_string_equal(dom->name, "name_3.dom");
+
+    assert_null(find_domain_by_sid(test_ctx->dom_list, "S-1-5-21-1-2-30"));
+
+    /* a new domain is found after the index was invalidated */
+    new_dom = talloc_zero(test_ctx, struct sss_domain_info);
+    assert_non_null(new_dom);
+    new_dom->name = talloc_strdup(new_dom, "new.dom");
+    new_dom->flat_name = talloc_strdup(new_dom, "NEW");
+    new_dom->domain_id = talloc_strdup(new_dom, "S-1-5-21-1-2-30");
+    assert_non_null(new_dom->name);
+    assert_non_null(new_dom->flat_name);
+    assert_non_null(new_dom->domain_id);
+    DLIST_ADD_END(test_ctx->dom_list, new_dom, struct sss_domain_info *);
+    sss_domain_index_invalidate();
+
+    assert_ptr_equal(find_domain_by_name(test_ctx->dom_list, "new", true),
+                     new_dom);
+    assert_ptr_equal(find_domain_by_sid(test_ctx->dom_list,
+                                        "S-1-5-21-1-2-30-500"),
+                     new_dom);
+
+    /* the first domain wins if a flat name is not unique */
+    talloc_free(new_dom->flat_name);
+    new_dom->flat_name = talloc_strdup(new_dom, "name_0");
+    assert_non_null(new_dom->flat_name);
+    sss_domain_index_invalidate();
+
+    dom = find_domain_by_name(test_ctx->dom_list, "name_0", true);
+    assert_non_null(dom);
+    assert_string_equal(dom->name, "name_0.dom");
+
+    /* and if the SID of one domain is the prefix of another one */
+    talloc_free(new_dom->domain_id);
+    new_dom->domain_id = talloc_strdup(new_dom, "S-1-5-21-1-2-3-1000");
+    assert_non_null(new_dom->domain_id);
+    sss_domain_index_invalidate();
+
+    dom = find_domain_by_sid(test_ctx->dom_list, "S-1-5-21-1-2-3-1000-500");
+    assert_non_null(dom);
+    assert_string_equal(dom->name, "name_3.dom");
+
+    /* freeing an indexed domain invalidates the index */
+    DLIST_REMOVE(test_ctx->dom_list, new_dom);
+    talloc_free(new_dom);
+
+    assert_null(find_domain_by_name(test_ctx->dom_list, "new.dom", true));
+    dom = find_domain_by_name(test_ctx->dom_list, "name_0", true);
+    assert_non_null(dom);
+    assert_string_equal(dom->name, "name_0.dom");
+}
+
 /*
  * dom1 -> sub1a
  *  |
@@ -2041,6 +2107,44 @@ static void test_sss_filter_sanitize_dn(void **state)
     talloc_free(tmp_ctx);
 }
 
+static void test_sss_parse_cpu_list(void **state)
+{
+    cpu_set_t set;
+    int ret;
+
+    ret = sss_parse_cpu_list("0-3,8, 10-11", &set);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(CPU_COUNT(&set), 7);
+    assert_true(CPU_ISSET(0, &set));
+    assert_true(CPU_ISSET(3, &set));
+    assert_false(CPU_ISSET(4, &set));
+    assert_true(CPU_ISSET(8, &set));
+    assert_true(CPU_ISSET(11, &set));
+
+    ret = sss_parse_cpu_list("5", &set);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(CPU_COUNT(&set), 1);
+    assert_true(CPU_ISSET(5, &set));
+
+    ret = sss_parse_cpu_list("", &set);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sss_parse_cpu_list("3-1", &set);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sss_parse_cpu_list("1,", &set);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sss_parse_cpu_list("1-", &set);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sss_parse_cpu_list("a", &set);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sss_parse_cpu_list("100000", &set);
+    assert_int_equal(ret, ERANGE);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -2073,6 +2177,8 @@ int main(int argc, const char *argv[])
                                         setup_dom_list, teardown_dom_list),
         cmocka_unit_test_setup_teardown(test_find_domain_by_object_name_ex,
                                         setup_dom_list, teardown_dom_list),
+        cmocka_unit_test_setup_teardown(test_find_domain_index,
+                                        setup_dom_list, teardown_dom_list),
 
         cmocka_unit_test_setup_teardown(test_sss_names_init,
                                         confdb_test_setup,
@@ -2153,9 +2259,16 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sss_ptr_hash_without_cb,
                                         setup_leak_tests,
                                         teardown_leak_tests),
+        cmocka_unit_test_setup_teardown(test_sss_ptr_hash_override_without_cb,
+                                        setup_leak_tests,
+                                        teardown_leak_tests),
+        cmocka_unit_test_setup_teardown(test_sss_ptr_hash_bench,
+                                        setup_leak_tests,
+                                        teardown_leak_tests),
         cmocka_unit_test_setup_teardown(test_sss_filter_sanitize_dn,
                                         setup_leak_tests,
                                         teardown_leak_tests),
+        cmocka_unit_test(test_sss_parse_cpu_list),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -38,6 +38,8 @@ void test_sss_ptr_hash_with_free_cb(void **state);
 void test_sss_ptr_hash_overwrite_with_free_cb(void **state);
 void test_sss_ptr_hash_with_lookup_cb(void **state);
 void test_sss_ptr_hash_without_cb(void **state);
+void test_sss_ptr_hash_override_without_cb(void **state);
+void test_sss_ptr_hash_bench(void **state);
 
 
 #endif /* __TESTS__CMOCKA__TEST_UTILS_H__ */
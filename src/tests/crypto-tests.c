@@ -102,6 +102,35 @@ START_TEST(test_hmac_sha1)
 }
 END_TEST
 
+START_TEST(test_sha256)
+{
+    const char *messages[] = {
+        "abc",
+        "test message",
+        NULL };
+    const char *results[] = {
+        "\xba\x78\x16\xbf\x8f\x01\xcf\xea\x41\x41\x40\xde\x5d\xae\x22\x23"
+        "\xb0\x03\x61\xa3\x96\x17\x7a\x9c\xb4\x10\xff\x61\xf2\x00\x15\xad",
+        "\x3f\x0a\x37\x7b\xa0\xa4\xa4\x60\xec\xb6\x16\xf6\x50\x7c\xe0\xd8"
+        "\xcf\xa3\xe7\x04\x02\x5d\x4f\xda\x3e\xd0\xc5\xca\x05\x46\x87\x28",
+        NULL };
+    unsigned char out[SSS_SHA256_LENGTH];
+    int ret;
+    int i;
+
+    for (i = 0; messages[i]; i++) {
+        ret = sss_sha256((const unsigned char *)messages[i],
+                         strlen(messages[i]), out);
+        ck_assert_int_eq(ret, EOK);
+        fail_if(memcmp(out, results[i], SSS_SHA256_LENGTH) != 0,
+                "Unexpected result for index: %d", i);
+    }
+
+    ret = sss_sha256(NULL, 0, out);
+    ck_assert_int_eq(ret, EINVAL);
+}
+END_TEST
+
 START_TEST(test_base64_encode)
 {
     const unsigned char obfbuf[] = "test";
@@ -225,6 +254,7 @@ Suite *crypto_suite(void)
     /* Do some testing */
     tcase_add_test(tc, test_sss_password_encrypt_decrypt);
     tcase_add_test(tc, test_hmac_sha1);
+    tcase_add_test(tc, test_sha256);
     tcase_add_test(tc, test_base64_encode);
     tcase_add_test(tc, test_base64_decode);
     tcase_add_test(tc, test_sss_encrypt_decrypt);
@@ -27,7 +27,12 @@
 #include <talloc.h>
 #include <errno.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
 #include "util/util.h"
+#include "util/sss_prof.h"
 #include "tests/common.h"
 
 #define DEBUG_TEST_ERROR    -1
@@ -642,6 +647,277 @@ START_TEST(test_debug_is_set_false)
 }
 END_TEST
 
+static off_t test_helper_debug_file_size(int fd)
+{
+    struct stat st;
+
+    if (fstat(fd, &st) != 0) {
+        return -1;
+    }
+
+    return st.st_size;
+}
+
+START_TEST(test_debug_buffer)
+{
+    char filename[24] = {'\0'};
+    char content[256];
+    char *large;
+    size_t large_len = 128 * 1024;
+    off_t size;
+    ssize_t len;
+    mode_t old_umask;
+    pid_t pid;
+    int status;
+    int fd;
+    int ret;
+
+    debug_timestamps = 0;
+    debug_microseconds = 0;
+    debug_to_file = 1;
+    debug_prg_name = "sssd";
+    debug_level = SSSDBG_MASK_ALL;
+    sss_set_logger(sss_logger_str[FILES_LOGGER]);
+
+    strncpy(filename, "sssd_debug_tests.XXXXXX", 24);
+    old_umask = umask(SSS_DFL_UMASK);
+    fd = mkstemp(filename);
+    umask(old_umask);
+    fail_if(fd == -1, "mkstemp failed: %s", strerror(errno));
+
+    ret = set_debug_file_from_fd(fd);
+    fail_unless(ret == EOK, "set_debug_file_from_fd failed: %d", ret);
+
+    sss_debug_buffer_enable();
+
+    DEBUG(SSSDBG_TRACE_FUNC, "buffered message\n");
+    fail_unless(test_helper_debug_file_size(fd) == 0,
+                "The message was written before the flush");
+
+    sss_debug_flush();
+    size = test_helper_debug_file_size(fd);
+    fail_unless(size > 0 && size < sizeof(content),
+                "Unexpected size %ld after the flush", (long)size);
+
+    len = pread(fd, content, size, 0);
+    fail_unless(len == size, "pread failed");
+    content[len] = '\0';
+    fail_unless(strstr(content, "buffered message\n") != NULL,
+                "Unexpected content [%s]", content);
+
+    /* fatal failures are written at once */
+    DEBUG(SSSDBG_FATAL_FAILURE, "fatal message\n");
+    fail_unless(test_helper_debug_file_size(fd) > size,
+                "The fatal message was not written");
+    size = test_helper_debug_file_size(fd);
+
+    /* messages larger than the buffer are written as well */
+    large = malloc(large_len + 1);
+    fail_if(large == NULL, "malloc failed");
+    memset(large, 'x', large_len);
+    large[large_len] = '\0';
+
+    DEBUG(SSSDBG_TRACE_FUNC, "%s\n", large);
+    fail_unless(test_helper_debug_file_size(fd) > size + large_len,
+                "The large message was not written");
+    size = test_helper_debug_file_size(fd);
+
+    /* a forked child does not write out the messages of its parent */
+    DEBUG(SSSDBG_TRACE_FUNC, "message of the parent\n");
+    pid = fork();
+    fail_if(pid == -1, "fork failed: %s", strerror(errno));
+    if (pid == 0) {
+        exit(0);
+    }
+    fail_unless(waitpid(pid, &status, 0) == pid, "waitpid failed");
+    fail_unless(test_helper_debug_file_size(fd) == size,
+                "The child wrote the messages of its parent");
+
+    sss_debug_flush();
+    fail_unless(test_helper_debug_file_size(fd) > size,
+                "The message of the parent was not written");
+
+    free(large);
+    unlink(filename);
+}
+END_TEST
+
+START_TEST(test_debug_backtrace)
+{
+    char filename[24] = {'\0'};
+    char content[2048];
+    char *trace;
+    char *error;
+    off_t size;
+    ssize_t len;
+    mode_t old_umask;
+    int fd;
+    int ret;
+
+    debug_timestamps = 0;
+    debug_microseconds = 0;
+    debug_to_file = 1;
+    debug_prg_name = "sssd";
+    debug_level = SSSDBG_DEFAULT;
+    sss_set_logger(sss_logger_str[FILES_LOGGER]);
+
+    strncpy(filename, "sssd_debug_tests.XXXXXX", 24);
+    old_umask = umask(SSS_DFL_UMASK);
+    fd = mkstemp(filename);
+    umask(old_umask);
+    fail_if(fd == -1, "mkstemp failed: %s", strerror(errno));
+
+    ret = set_debug_file_from_fd(fd);
+    fail_unless(ret == EOK, "set_debug_file_from_fd failed: %d", ret);
+
+    sss_debug_backtrace_enable();
+
+    DEBUG(SSSDBG_TRACE_FUNC, "trace message\n");
+    DEBUG(SSSDBG_TRACE_LDB, "ldb message\n");
+    fail_unless(test_helper_debug_file_size(fd) == 0,
+                "A message not enabled by debug_level was written");
+
+    /* an error writes out the backtrace before itself */
+    DEBUG(SSSDBG_OP_FAILURE, "error message\n");
+    size = test_helper_debug_file_size(fd);
+    fail_unless(size > 0 && size < sizeof(content),
+                "Unexpected size %ld after the error", (long)size);
+
+    len = pread(fd, content, size, 0);
+    fail_unless(len == size, "pread failed");
+    content[len] = '\0';
+
+    trace = strstr(content, "[test_debug_backtrace] (0x0400): trace message\n");
+    error = strstr(content, "[test_debug_backtrace] (0x0040): error message\n");
+    fail_unless(trace != NULL && error != NULL && trace < error,
+                "Unexpected content [%s]", content);
+    fail_unless(strstr(content, "ldb message") == NULL,
+                "The ldb traces are not kept [%s]", content);
+
+    /* the backtrace was emptied */
+    DEBUG(SSSDBG_CRIT_FAILURE, "second error\n");
+    sss_debug_backtrace_dump();
+    len = pread(fd, content, sizeof(content) - 1, size);
+    fail_unless(len > 0, "pread failed");
+    content[len] = '\0';
+    fail_unless(strstr(content, "trace message") == NULL,
+                "The backtrace was written twice [%s]", content);
+
+    unlink(filename);
+}
+END_TEST
+
+START_TEST(test_debug_trace_id)
+{
+    char filename[24] = {'\0'};
+    char content[512];
+    ssize_t len;
+    mode_t old_umask;
+    int fd;
+    int ret;
+
+    debug_timestamps = 0;
+    debug_microseconds = 0;
+    debug_to_file = 1;
+    debug_prg_name = "sssd";
+    debug_level = SSSDBG_DEFAULT;
+    sss_set_logger(sss_logger_str[FILES_LOGGER]);
+
+    strncpy(filename, "sssd_debug_tests.XXXXXX", 24);
+    old_umask = umask(SSS_DFL_UMASK);
+    fd = mkstemp(filename);
+    umask(old_umask);
+    fail_if(fd == -1, "mkstemp failed: %s", strerror(errno));
+
+    ret = set_debug_file_from_fd(fd);
+    fail_unless(ret == EOK, "set_debug_file_from_fd failed: %d", ret);
+
+    debug_trace_id = 1234;
+    DEBUG(SSSDBG_OP_FAILURE, "traced message\n");
+    debug_trace_id = 0;
+    DEBUG(SSSDBG_OP_FAILURE, "untraced message\n");
+
+    len = pread(fd, content, sizeof(content) - 1, 0);
+    fail_unless(len > 0, "pread failed");
+    content[len] = '\0';
+
+    fail_unless(strcmp(content,
+                       "[sssd] [test_debug_trace_id] (0x0040): "
+                       "[RID#1234] traced message\n"
+                       "[sssd] [test_debug_trace_id] (0x0040): "
+                       "untraced message\n") == 0,
+                "Unexpected content [%s]", content);
+
+    unlink(filename);
+}
+END_TEST
+
+START_TEST(test_sss_prof)
+{
+    char dir[] = "sssd_prof_tests.XXXXXX";
+    char base[64];
+    char path[64];
+    char content[256];
+    volatile uint64_t spin = 0;
+    clock_t cpu_start;
+    FILE *f;
+    size_t len;
+    errno_t ret;
+
+    debug_prg_name = "sssd";
+
+    fail_unless(mkdtemp(dir) != NULL, "mkdtemp failed: %s", strerror(errno));
+    snprintf(base, sizeof(base), "%s/prof", dir);
+
+    /* not started */
+    sss_prof_record("ignored", 1);
+    ret = sss_prof_stop(base);
+    fail_unless(ret == ENOENT, "Unexpected result %d", ret);
+
+    ret = sss_prof_start();
+    fail_unless(ret == EOK, "sss_prof_start failed: %d", ret);
+    ret = sss_prof_start();
+    fail_unless(ret == EALREADY, "Unexpected result %d", ret);
+
+    /* the inner frame is popped with the outer one */
+    SSS_PROF_PUSH("outer");
+    SSS_PROF_PUSH("inner");
+    cpu_start = clock();
+    while (clock() - cpu_start < CLOCKS_PER_SEC / 2) {
+        spin++;
+    }
+    SSS_PROF_POP("outer");
+
+    sss_prof_record("op;a", 5);
+    sss_prof_record("op;a", 7);
+
+    ret = sss_prof_stop(base);
+    fail_unless(ret == EOK, "sss_prof_stop failed: %d", ret);
+
+    snprintf(path, sizeof(path), "%s.cpu.folded", base);
+    f = fopen(path, "r");
+    fail_unless(f != NULL, "fopen failed: %s", strerror(errno));
+    len = fread(content, 1, sizeof(content) - 1, f);
+    content[len] = '\0';
+    fclose(f);
+    unlink(path);
+    fail_unless(strstr(content, "sssd;outer;inner ") != NULL,
+                "Unexpected samples [%s]", content);
+
+    snprintf(path, sizeof(path), "%s.wall.folded", base);
+    f = fopen(path, "r");
+    fail_unless(f != NULL, "fopen failed: %s", strerror(errno));
+    len = fread(content, 1, sizeof(content) - 1, f);
+    content[len] = '\0';
+    fclose(f);
+    unlink(path);
+    fail_unless(strcmp(content, "sssd;op;a 12\n") == 0,
+                "Unexpected times [%s]", content);
+
+    rmdir(dir);
+}
+END_TEST
+
 Suite *debug_suite(void)
 {
     Suite *s = suite_create("debug");
@@ -658,6 +934,10 @@ Suite *debug_suite(void)
     tcase_add_test(tc_debug, test_debug_is_notset_timestamp_microseconds);
     tcase_add_test(tc_debug, test_debug_is_set_true);
     tcase_add_test(tc_debug, test_debug_is_set_false);
+    tcase_add_test(tc_debug, test_debug_buffer);
+    tcase_add_test(tc_debug, test_debug_backtrace);
+    tcase_add_test(tc_debug, test_debug_trace_id);
+    tcase_add_test(tc_debug, test_sss_prof);
     tcase_set_timeout(tc_debug, 60);
 
     suite_add_tcase(s, tc_debug);
@@ -58,7 +58,7 @@ struct task {
 };
 
 static struct test_ctx *
-setup_test(void)
+setup_test_ex(bool prefer_fastest)
 {
     struct test_ctx *ctx;
     struct fo_options fopts;
@@ -82,6 +82,7 @@ setup_test(void)
     memset(&fopts, 0, sizeof(fopts));
     fopts.retry_timeout = 30;
     fopts.family_order  = IPV4_FIRST;
+    fopts.prefer_fastest = prefer_fastest;
 
     ctx->fo_ctx = fo_context_init(ctx, &fopts);
     if (ctx->fo_ctx == NULL) {
@@ -92,6 +93,12 @@ setup_test(void)
     return ctx;
 }
 
+static struct test_ctx *
+setup_test(void)
+{
+    return setup_test_ex(false);
+}
+
 static void
 test_loop(struct test_ctx *data)
 {
@@ -201,12 +208,15 @@ test_resolve_service_callback(struct tevent_req *req)
 }
 
 #define get_request(a, b, c, d, e, f) \
-       _get_request(a, b, c, d, e, f, __location__)
+       _get_request(a, b, c, d, e, f, false, __location__)
+
+#define get_other_request(a, b, c, d, e, f) \
+       _get_request(a, b, c, d, e, f, true, __location__)
 
 static void
 _get_request(struct test_ctx *test_ctx, struct fo_service *service,
              int expected_recv, int expected_port, int new_port_status,
-             int new_server_status, const char *location)
+             int new_server_status, bool other, const char *location)
 {
     struct tevent_req *req;
     struct task *task;
@@ -223,9 +233,15 @@ _get_request(struct test_ctx *test_ctx, struct fo_service *service,
     task->service = service;
     test_ctx->tasks++;
 
-    req = fo_resolve_service_send(test_ctx, test_ctx->ev,
-                                  test_ctx->resolv,
-                                  test_ctx->fo_ctx, service);
+    if (other) {
+        req = fo_resolve_other_service_send(test_ctx, test_ctx->ev,
+                                            test_ctx->resolv,
+                                            test_ctx->fo_ctx, service);
+    } else {
+        req = fo_resolve_service_send(test_ctx, test_ctx->ev,
+                                      test_ctx->resolv,
+                                      test_ctx->fo_ctx, service);
+    }
     fail_if(req == NULL, "%s: fo_resolve_service_send() failed", location);
 
     tevent_req_set_callback(req, test_resolve_service_callback, task);
@@ -289,6 +305,99 @@ START_TEST(test_fo_resolve_service)
 }
 END_TEST
 
+START_TEST(test_fo_prefer_fastest)
+{
+    struct test_ctx *ctx;
+    struct fo_service *service;
+    struct fo_server *slow;
+    struct fo_server *fast;
+    int ret;
+
+    ctx = setup_test_ex(true);
+    fail_if(ctx == NULL, "Failed to allocate memory");
+
+    ret = fo_new_service(ctx->fo_ctx, "ldap", NULL, &service);
+    fail_if(ret != EOK, "fo_new_service failed with error: %d", ret);
+
+    ret = fo_add_server(service, "127.0.0.1", 389, NULL, true);
+    fail_if(ret != EOK, "fo_add_server failed with error: %d", ret);
+    ret = fo_add_server(service, "127.0.0.1", 636, NULL, true);
+    fail_if(ret != EOK, "fo_add_server failed with error: %d", ret);
+
+    /* Measure both servers. */
+    get_request(ctx, service, EOK, 389, PORT_WORKING, SERVER_WORKING);
+    slow = fo_get_active_server(service);
+    fo_set_server_latency(slow, FO_LATENCY_OPERATION, 11000);
+    fail_if(fo_get_server_latency(slow, FO_LATENCY_OPERATION) != 11000,
+            "Unexpected latency");
+
+    fo_set_port_status(slow, PORT_NOT_WORKING);
+    get_request(ctx, service, EOK, 636, PORT_WORKING, SERVER_WORKING);
+    fast = fo_get_active_server(service);
+    fo_set_server_latency(fast, FO_LATENCY_OPERATION, 10000);
+
+    /* A slightly faster server does not replace the active one. */
+    fo_set_port_status(slow, PORT_WORKING);
+    get_request(ctx, service, EOK, 389, PORT_WORKING, SERVER_WORKING);
+
+    /* A clearly faster one does. */
+    fo_set_server_latency(slow, FO_LATENCY_OPERATION, 51000);
+    fail_if(fo_get_server_latency(slow, FO_LATENCY_OPERATION) != 21000,
+            "Unexpected latency");
+    get_request(ctx, service, EOK, 636, PORT_WORKING, SERVER_WORKING);
+
+    /* Not working servers are never preferred. */
+    fo_set_port_status(fast, PORT_NOT_WORKING);
+    fo_set_port_status(slow, PORT_WORKING);
+    get_request(ctx, service, EOK, 389, PORT_WORKING, SERVER_WORKING);
+
+    talloc_free(ctx);
+}
+END_TEST
+
+START_TEST(test_fo_resolve_other_service)
+{
+    struct test_ctx *ctx;
+    struct fo_service *service;
+    struct fo_server *first;
+    struct fo_server *second;
+    int ret;
+
+    ctx = setup_test();
+    fail_if(ctx == NULL, "Failed to allocate memory");
+
+    ret = fo_new_service(ctx->fo_ctx, "ldap", NULL, &service);
+    fail_if(ret != EOK, "fo_new_service failed with error: %d", ret);
+
+    ret = fo_add_server(service, "127.0.0.1", 389, NULL, true);
+    fail_if(ret != EOK, "fo_add_server failed with error: %d", ret);
+    ret = fo_add_server(service, "127.0.0.1", 636, NULL, false);
+    fail_if(ret != EOK, "fo_add_server failed with error: %d", ret);
+
+    get_request(ctx, service, EOK, 389, PORT_WORKING, SERVER_WORKING);
+    first = fo_get_active_server(service);
+
+    /* A server being connected to is passed over by the other request... */
+    fo_set_server_connecting(first, true);
+    get_other_request(ctx, service, EOK, 636, -1, -1);
+
+    /* ...but not by the usual one. */
+    get_request(ctx, service, EOK, 389, -1, -1);
+
+    /* Nothing is left when all servers are being connected to. */
+    get_other_request(ctx, service, EOK, 636, PORT_WORKING, -1);
+    second = fo_get_active_server(service);
+    fo_set_server_connecting(second, true);
+    get_other_request(ctx, service, ENOENT, 0, -1, -1);
+
+    fo_set_server_connecting(first, false);
+    fo_set_server_connecting(second, false);
+    get_other_request(ctx, service, EOK, 389, -1, -1);
+
+    talloc_free(ctx);
+}
+END_TEST
+
 Suite *
 create_suite(void)
 {
@@ -300,6 +409,8 @@ create_suite(void)
     /* Do some testing */
     tcase_add_test(tc, test_fo_new_service);
     tcase_add_test(tc, test_fo_resolve_service);
+    tcase_add_test(tc, test_fo_prefer_fastest);
+    tcase_add_test(tc, test_fo_resolve_other_service);
     if (use_net_test) {
     }
     /* Add all test cases to the test suite */
@@ -0,0 +1,134 @@
+/*
+   SSSD
+
+   Hash function benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Hashes keys of a growing length with the functions the memory cache can
+ * be configured with. The short keys are the typical user and group names
+ * and ids, the long ones the hex encoded requests of the reply caches. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <popt.h>
+
+#include "shared/murmurhash3.h"
+#include "shared/wyhash.h"
+#include "tests/bench_common.h"
+
+#define DEFAULT_ITERATIONS  10000000
+#define DEFAULT_MAX_LEN     1024
+#define BENCH_SEED          0x12345678
+
+struct bench_hash {
+    const char *name;
+    uint32_t (*fn)(const char *key, int len, uint32_t seed);
+};
+
+static const struct bench_hash hashes[] = {
+    { "murmurhash3", murmurhash3 },
+    { "wyhash32", wyhash32 },
+    { NULL, NULL }
+};
+
+static void bench_run(const struct bench_hash *hash, const char *key,
+                      int len, int iterations)
+{
+    struct bench_timer timer;
+    volatile uint32_t sink;
+    uint32_t h = 0;
+    char name[32];
+    int i;
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; i++) {
+        /* chain the results so the calls cannot be hoisted */
+        h = hash->fn(key, len, BENCH_SEED ^ h);
+    }
+    bench_timer_stop(&timer);
+    sink = h;
+    (void)sink;
+
+    snprintf(name, sizeof(name), "%d bytes", len);
+    bench_report(hash->name, name, iterations,
+                 bench_timer_ns_per_op(&timer, iterations));
+}
+
+int main(int argc, const char *argv[])
+{
+    int pc_iterations = DEFAULT_ITERATIONS;
+    int pc_max_len = DEFAULT_MAX_LEN;
+    poptContext pc;
+    int iterations;
+    char *key;
+    int len;
+    int opt;
+    int i;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_iterations, 0,
+                        "Hashes of the shortest key", NULL },
+        { "max-len", 'l', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                     &pc_max_len, 0,
+                     "Length of the longest key", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_iterations < 1 || pc_max_len < 4) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    key = malloc(pc_max_len);
+    if (key == NULL) {
+        return 2;
+    }
+
+    for (i = 0; i < pc_max_len; i++) {
+        key[i] = 'a' + i % 26;
+    }
+
+    /* the longer keys are hashed less often to keep the run short */
+    for (len = 4; len <= pc_max_len; len *= 2) {
+        iterations = pc_iterations / (len / 4);
+        if (iterations < 1000) {
+            iterations = 1000;
+        }
+
+        for (i = 0; hashes[i].name != NULL; i++) {
+            bench_run(&hashes[i], key, len, iterations);
+        }
+    }
+
+    free(key);
+    return 0;
+}
@@ -0,0 +1,284 @@
+/*
+   SSSD
+
+   HBAC evaluation benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Evaluates an access request against a growing number of rules which
+ * each allow one user group to log in with sshd to all hosts. The user is
+ * only a member of the group of the last rule, so hbac_evaluate() has to
+ * look at every rule, and the result is compared with the rules prepared
+ * by hbac_compile_rules(). */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "lib/ipa_hbac/ipa_hbac.h"
+#include "tests/bench_common.h"
+
+#define DEFAULT_ITERATIONS  100000
+#define DEFAULT_MAX_RULES   10000
+
+static struct hbac_rule_element *bench_element(TALLOC_CTX *mem_ctx,
+                                               const char *name,
+                                               const char *group)
+{
+    struct hbac_rule_element *el;
+
+    el = talloc_zero(mem_ctx, struct hbac_rule_element);
+    if (el == NULL) {
+        return NULL;
+    }
+
+    if (name == NULL && group == NULL) {
+        el->category = HBAC_CATEGORY_ALL;
+        return el;
+    }
+
+    el->names = talloc_zero_array(el, const char *, 2);
+    el->groups = talloc_zero_array(el, const char *, 2);
+    if (el->names == NULL || el->groups == NULL) {
+        talloc_free(el);
+        return NULL;
+    }
+    el->names[0] = name;
+    el->groups[0] = group;
+
+    return el;
+}
+
+static struct hbac_rule **bench_rules(TALLOC_CTX *mem_ctx, int num_rules)
+{
+    struct hbac_rule **rules;
+    struct hbac_rule *rule;
+    int i;
+
+    rules = talloc_zero_array(mem_ctx, struct hbac_rule *, num_rules + 1);
+    if (rules == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < num_rules; i++) {
+        rule = talloc_zero(rules, struct hbac_rule);
+        if (rule == NULL) {
+            goto fail;
+        }
+
+        rule->enabled = true;
+        rule->name = talloc_asprintf(rule, "rule%d", i);
+        rule->services = bench_element(rule, "sshd", NULL);
+        rule->users = bench_element(rule, NULL,
+                                    talloc_asprintf(rule, "group%d", i));
+        rule->targethosts = bench_element(rule, NULL, NULL);
+        rule->srchosts = bench_element(rule, NULL, NULL);
+        if (rule->name == NULL || rule->services == NULL
+                || rule->users == NULL || rule->users->groups[0] == NULL
+                || rule->targethosts == NULL || rule->srchosts == NULL) {
+            goto fail;
+        }
+
+        rules[i] = rule;
+    }
+
+    return rules;
+
+fail:
+    talloc_free(rules);
+    return NULL;
+}
+
+static struct hbac_request_element *bench_request_el(TALLOC_CTX *mem_ctx,
+                                                     const char *name,
+                                                     const char *group)
+{
+    struct hbac_request_element *el;
+
+    el = talloc_zero(mem_ctx, struct hbac_request_element);
+    if (el == NULL) {
+        return NULL;
+    }
+
+    el->name = name;
+    el->groups = talloc_zero_array(el, const char *, 2);
+    if (el->groups == NULL) {
+        talloc_free(el);
+        return NULL;
+    }
+    el->groups[0] = group;
+
+    return el;
+}
+
+static struct hbac_eval_req *bench_request(TALLOC_CTX *mem_ctx,
+                                           int num_rules)
+{
+    struct hbac_eval_req *req;
+
+    req = talloc_zero(mem_ctx, struct hbac_eval_req);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    req->service = bench_request_el(req, "sshd", NULL);
+    req->user = bench_request_el(req, "user",
+                                 talloc_asprintf(req, "group%d",
+                                                 num_rules - 1));
+    req->targethost = bench_request_el(req, "host.example.com", NULL);
+    req->srchost = bench_request_el(req, "client.example.com", NULL);
+    if (req->service == NULL || req->user == NULL
+            || req->user->groups[0] == NULL
+            || req->targethost == NULL || req->srchost == NULL) {
+        talloc_free(req);
+        return NULL;
+    }
+
+    return req;
+}
+
+static errno_t bench_run(TALLOC_CTX *mem_ctx, int num_rules, int iterations)
+{
+    struct hbac_compiled_rules *compiled = NULL;
+    struct hbac_info *info = NULL;
+    struct hbac_eval_req *req;
+    struct hbac_rule **rules;
+    struct bench_timer timer;
+    enum hbac_eval_result result;
+    char *name;
+    errno_t ret;
+    int i;
+
+    rules = bench_rules(mem_ctx, num_rules);
+    req = bench_request(mem_ctx, num_rules);
+    if (rules == NULL || req == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; i++) {
+        result = hbac_evaluate(rules, req, &info);
+        hbac_free_info(info);
+        if (result != HBAC_EVAL_ALLOW) {
+            ret = EINVAL;
+            goto done;
+        }
+    }
+    bench_timer_stop(&timer);
+
+    name = talloc_asprintf(mem_ctx, "%d rules", num_rules);
+    if (name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    bench_report("hbac_evaluate", name, iterations,
+                 bench_timer_ns_per_op(&timer, iterations));
+
+    if (hbac_compile_rules(rules, &compiled) != HBAC_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; i++) {
+        result = hbac_evaluate_compiled(compiled, req, &info);
+        hbac_free_info(info);
+        if (result != HBAC_EVAL_ALLOW) {
+            ret = EINVAL;
+            goto done;
+        }
+    }
+    bench_timer_stop(&timer);
+
+    bench_report("hbac_evaluate_compiled", name, iterations,
+                 bench_timer_ns_per_op(&timer, iterations));
+
+    ret = EOK;
+
+done:
+    hbac_free_compiled_rules(compiled);
+    talloc_free(rules);
+    talloc_free(req);
+    return ret;
+}
+
+int main(int argc, const char *argv[])
+{
+    int pc_iterations = DEFAULT_ITERATIONS;
+    int pc_max_rules = DEFAULT_MAX_RULES;
+    TALLOC_CTX *mem_ctx;
+    poptContext pc;
+    int iterations;
+    int num_rules;
+    int opt;
+    int ret;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_iterations, 0,
+                        "Evaluations of the smallest rule set", NULL },
+        { "max-rules", 'r', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                       &pc_max_rules, 0,
+                       "Size of the largest rule set", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_iterations < 1 || pc_max_rules < 1) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    mem_ctx = talloc_new(NULL);
+    if (mem_ctx == NULL) {
+        return 2;
+    }
+
+    /* the larger rule sets are evaluated less often to keep the run short */
+    for (num_rules = 1; num_rules <= pc_max_rules; num_rules *= 10) {
+        iterations = pc_iterations / num_rules;
+        if (iterations < 100) {
+            iterations = 100;
+        }
+
+        ret = bench_run(mem_ctx, num_rules, iterations);
+        if (ret != EOK) {
+            fprintf(stderr, "Evaluation of %d rules failed: %s\n",
+                    num_rules, sss_strerror(ret));
+            goto done;
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(mem_ctx);
+    return ret == EOK ? 0 : 2;
+}
@@ -14,6 +14,7 @@ PUBCONF_PATH = "pubconfpath"
 PIDFILE_PATH = PID_PATH + "/sssd.pid"
 LOG_PATH = "logpath"
 MCACHE_PATH = "mcpath"
+PIPE_PATH = "pipepath"
 SECDB_PATH = "secdbpath"
 LIBEXEC_PATH = "libexecpath"
 RUNSTATEDIR = "runstatedir"
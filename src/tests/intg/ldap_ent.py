@@ -17,6 +17,7 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #
+import struct
 
 
 def user(base_dn, uid, uidNumber, gidNumber,
@@ -98,6 +99,73 @@ def group_bis(base_dn, cn, gidNumber, member_uids=(), member_gids=()):
     return ("cn=" + cn + ",ou=Groups," + base_dn, attr_list)
 
 
+AD_DOMAIN_SID = (21, 1305200397, 2901131868, 73388776)
+
+
+def ad_sid(rid):
+    """
+    Generate the binary objectSid of an object of the fake AD domain.
+    """
+    subauths = AD_DOMAIN_SID + (rid,)
+    return struct.pack("<BB", 1, len(subauths)) + \
+        struct.pack(">Q", 5)[2:] + \
+        struct.pack("<" + "I" * len(subauths), *subauths)
+
+
+def ad_user(base_dn, name, uidNumber, gidNumber, rid):
+    """
+    Generate a fake AD user with POSIX attributes add-modlist for passing
+    to ldap.add*.
+    """
+    uidNumber = str(uidNumber).encode('utf-8')
+    gidNumber = str(gidNumber).encode('utf-8')
+    return (
+        "cn=" + name + ",ou=Users," + base_dn,
+        [
+            ('objectClass', [b'top', b'person', b'organizationalPerson',
+                             b'user', b'posixAccount']),
+            ('cn', [name.encode('utf-8')]),
+            ('uid', [name.encode('utf-8')]),
+            ('sAMAccountName', [name.encode('utf-8')]),
+            ('objectSid', [ad_sid(rid)]),
+            ('instanceType', [b'4']),
+            ('objectCategory', [("cn=Person,cn=Schema,cn=Configuration," +
+                                 base_dn).encode('utf-8')]),
+            ('uidNumber', [uidNumber]),
+            ('gidNumber', [gidNumber]),
+            ('homeDirectory', [b'/home/' + name.encode('utf-8')]),
+        ]
+    )
+
+
+def ad_group(base_dn, cn, gidNumber, rid, member_uids=(), member_gids=()):
+    """
+    Generate a fake AD group with a gidNumber add-modlist for passing to
+    ldap.add*.
+    """
+    gidNumber = str(gidNumber).encode('utf-8')
+    attr_list = [
+        ('objectClass', [b'top', b'group']),
+        ('cn', [cn.encode('utf-8')]),
+        ('sAMAccountName', [cn.encode('utf-8')]),
+        ('objectSid', [ad_sid(rid)]),
+        ('instanceType', [b'4']),
+        ('groupType', [b'-2147483646']),
+        ('objectCategory', [("cn=Group,cn=Schema,cn=Configuration," +
+                             base_dn).encode('utf-8')]),
+        ('gidNumber', [gidNumber]),
+    ]
+    member_list = []
+    for uid in member_uids:
+        member_list.append("cn=" + uid + ",ou=Users," + base_dn)
+    for gid in member_gids:
+        member_list.append("cn=" + gid + ",ou=Groups," + base_dn)
+    if len(member_list) > 0:
+        mem_list = [member.encode('utf-8') for member in member_list]
+        attr_list.append(('member', mem_list))
+    return ("cn=" + cn + ",ou=Groups," + base_dn, attr_list)
+
+
 def netgroup(base_dn, cn, triples=(), members=()):
     """
     Generate an RFC2307bis netgroup add-modlist for passing to ldap.add*.
@@ -213,6 +281,19 @@ class List(list):
                               cn, gidNumber,
                               member_uids, member_gids))
 
+    def add_ad_user(self, name, uidNumber, gidNumber, rid, base_dn=None):
+        """Add a fake AD user add-modlist."""
+        self.append(ad_user(base_dn or self.base_dn,
+                            name, uidNumber, gidNumber, rid))
+
+    def add_ad_group(self, cn, gidNumber, rid,
+                     member_uids=[], member_gids=[],
+                     base_dn=None):
+        """Add a fake AD group add-modlist."""
+        self.append(ad_group(base_dn or self.base_dn,
+                             cn, gidNumber, rid,
+                             member_uids, member_gids))
+
     def add_netgroup(self, cn, triples=(), members=(), base_dn=None):
         """Add an RFC2307bis netgroup add-modlist."""
         self.append(netgroup(base_dn or self.base_dn,
@@ -110,8 +110,8 @@ class SecretsHttpClient(object):
 
 
 class SecretsLocalClient(SecretsHttpClient):
-    def list_secrets(self):
-        res = self.list()
+    def list_secrets(self, **kwargs):
+        res = self.list(**kwargs)
         res.raise_for_status()
         simple = res.json()
         return simple
@@ -17,8 +17,9 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #
-from ctypes import (cdll, c_int, c_char, c_char_p, c_size_t, c_void_p, c_ulong,
-                    POINTER, Structure, Union, create_string_buffer, get_errno)
+from ctypes import (cdll, c_int, c_uint, c_char, c_char_p, c_size_t, c_void_p,
+                    c_ulong, POINTER, Structure, Union, byref,
+                    create_string_buffer, get_errno)
 import config
 from sssd_nss import NssReturnCode, nss_sss_ctypes_loader
 
@@ -246,3 +247,34 @@ def get_sssd_netgroups(name):
     retriever = NetgroupRetriever(name)
 
     return retriever.get_netgroups()
+
+
+def sssd_innetgr(netgroup, host, user, domain, timeout=5000):
+    """
+    Ask sssd if the triple is a member of the netgroup or one of the
+    netgroups nested in it, with one sss_nss_innetgr_timeout() call of
+    libsss_nss_idmap.
+
+    @param string netgroup name of netgroup
+    @param string host host name or None for any host
+    @param string user user name or None for any user
+    @param string domain domain name or None for any domain
+
+    @return (int, bool) (err, found)
+        err is 0 on success or an errno value, found is True if the
+        triple is in the netgroup.
+    """
+    lib = cdll.LoadLibrary("libsss_nss_idmap.so.0")
+    func = lib.sss_nss_innetgr_timeout
+    func.restype = c_int
+    func.argtypes = [c_char_p, c_char_p, c_char_p, c_char_p, c_uint,
+                     POINTER(c_int)]
+
+    def encode(value):
+        return None if value is None else value.encode('utf-8')
+
+    result = c_int(0)
+    err = func(encode(netgroup), encode(host), encode(user), encode(domain),
+               timeout, byref(result))
+
+    return (int(err), result.value == 1)
@@ -0,0 +1,54 @@
+#
+# Counters of the work done by sssd_be
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+import subprocess
+import time
+import config
+
+
+def backend_stats(domain):
+    """
+    Read the counters of the backend of domain over its private bus: the
+    number of server operations and the microseconds spent waiting for
+    their first reply, and the number of sysdb transactions and the
+    microseconds they were open.
+    """
+    address = "unix:path={0}/private/sbus-dp_{1}".format(config.PIPE_PATH,
+                                                         domain)
+    output = subprocess.check_output(
+        ["dbus-send", "--print-reply", "--address=" + address,
+         "--dest=sssd.domain_" + domain, "/sssd",
+         "sssd.DataProvider.Backend.PerfStats"]).decode('utf-8')
+
+    values = [int(line.split()[1]) for line in output.splitlines()
+              if line.strip().startswith("uint64")]
+    return dict(zip(["ldap_ops", "ldap_usecs",
+                     "sysdb_transactions", "sysdb_usecs"], values))
+
+
+def wait_for_backend(domain):
+    """Wait until the backend of domain answers on its bus"""
+    for _ in range(30):
+        try:
+            return backend_stats(domain)
+        except subprocess.CalledProcessError:
+            time.sleep(1)
+    raise Exception("sssd_be does not answer")
+
+
+def stats_delta(before, after):
+    """Return the counters of after minus the ones of before"""
+    return dict((key, after[key] - before[key]) for key in after)
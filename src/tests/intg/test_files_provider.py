@@ -244,6 +244,25 @@ def proxy_to_files_domain_only(request):
     return None
 
 
+@pytest.fixture
+def proxy_to_files_workers(request):
+    conf = unindent("""\
+        [sssd]
+        domains             = proxy
+        services            = nss
+
+        [domain/proxy]
+        id_provider = proxy
+        proxy_lib_name = files
+        proxy_id_workers = 2
+        auth_provider = none
+        resolver_provider = none
+    """).format(**locals())
+    create_conf_fixture(request, conf)
+    create_sssd_fixture(request)
+    return None
+
+
 @pytest.fixture
 def no_sssd_domain(request):
     conf = unindent("""\
@@ -662,6 +681,22 @@ def test_mod_user_shell(add_user_with_canary, files_domain_only):
     check_user(moduser)
 
 
+def test_mod_user_remove_gecos(add_user_with_canary, files_domain_only):
+    """
+    Test that removing the gecos of a cached user is detected and the
+    attribute is removed from the cached user while the other users
+    are kept
+    """
+    check_user(USER1)
+
+    moduser = dict(USER1)
+    moduser['gecos'] = ''
+    add_user_with_canary.usermod(**moduser)
+
+    check_user(moduser)
+    check_user(CANARY, delay=0)
+
+
 def incomplete_user_setup(pwd_ops, del_field, exp_field):
     adduser = dict(USER1)
     del adduser[del_field]
@@ -834,6 +869,23 @@ def test_mod_group_gid(add_group_with_canary, files_domain_only):
     check_group(modgroup)
 
 
+def test_group_member_user_removed(passwd_ops_setup, add_group_with_canary,
+                                   files_domain_only):
+    """
+    Test that a member of a group is still listed after the user is
+    removed from passwd, only the groups that changed are rewritten
+    """
+    check_group(GROUP1)
+
+    passwd_ops_setup.userdel(USER1["name"])
+    time.sleep(1.0)
+    res, _ = sssd_getpwnam_sync(USER1["name"])
+    assert res == NssReturnCode.NOTFOUND
+
+    check_group(GROUP1)
+    check_group(CANARY_GR, delay=0)
+
+
 @pytest.fixture
 def add_group_nomem_with_canary(passwd_ops_setup, group_ops_setup):
     return setup_gr_with_list(
@@ -1154,6 +1206,67 @@ def test_proxy_to_files_domain_only(add_user_with_canary,
     assert res == NssReturnCode.NOTFOUND
 
 
+@pytest.fixture
+def add_groups_for_workers(passwd_ops_setup, group_ops_setup):
+    return setup_gr_with_list(passwd_ops_setup, group_ops_setup,
+                              [GROUP1, GROUP12, CANARY_GR])
+
+
+def without_passwd(user):
+    """The password field is not passed on by the proxy provider"""
+    return {k: v for k, v in user.items() if k != "passwd"}
+
+
+def test_proxy_to_files_workers(add_groups_for_workers,
+                                proxy_to_files_workers):
+    """
+    Test that user and group lookups are answered when the NSS calls are
+    run by the proxy workers
+    """
+    for user in [USER1, USER2]:
+        res, found_user = call_sssd_getpwnam(user["name"])
+        assert res == NssReturnCode.SUCCESS
+        assert without_passwd(found_user) == without_passwd(user)
+
+        res, found_user = call_sssd_getpwuid(user["uid"])
+        assert res == NssReturnCode.SUCCESS
+        assert without_passwd(found_user) == without_passwd(user)
+
+    for group in [GROUP1, GROUP12]:
+        for res, found_group in [call_sssd_getgrnam(group["name"]),
+                                 call_sssd_getgrgid(group["gid"])]:
+            assert res == NssReturnCode.SUCCESS
+            assert found_group["name"] == group["name"]
+            assert found_group["gid"] == group["gid"]
+            assert sorted(found_group["mem"]) == sorted(group["mem"])
+
+    res, errno, gids = sssd_id.call_sssd_initgroups(USER1["name"],
+                                                    USER1["gid"])
+    assert res == NssReturnCode.SUCCESS, \
+        "initgroups of %s failed with %d" % (USER1["name"], errno)
+    assert sorted(set(gids)) == sorted([USER1["gid"], GROUP1["gid"],
+                                        GROUP12["gid"]])
+
+    res, errno, gids = sssd_id.call_sssd_initgroups(USER2["name"],
+                                                    USER2["gid"])
+    assert res == NssReturnCode.SUCCESS, \
+        "initgroups of %s failed with %d" % (USER2["name"], errno)
+    assert sorted(set(gids)) == sorted([USER2["gid"], GROUP12["gid"]])
+
+    for i in range(4):
+        res, _ = call_sssd_getpwnam("nosuchuser{0}".format(i))
+        assert res == NssReturnCode.NOTFOUND
+
+        res, _ = call_sssd_getpwuid(73000 + i)
+        assert res == NssReturnCode.NOTFOUND
+
+        res, _ = call_sssd_getgrnam("nosuchgroup{0}".format(i))
+        assert res == NssReturnCode.NOTFOUND
+
+        res, _ = call_sssd_getgrgid(73000 + i)
+        assert res == NssReturnCode.NOTFOUND
+
+
 def test_no_files_domain(add_user_with_canary, no_files_domain):
     """
     Test that if no files domain is configured, sssd will add the implicit one
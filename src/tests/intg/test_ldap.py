@@ -201,8 +201,8 @@ def create_sssd_process():
         raise Exception("sssd start failed")
 
 
-def cleanup_sssd_process():
-    """Stop the SSSD process and remove its state"""
+def stop_sssd_process():
+    """Stop the SSSD process and wait for it to exit"""
     try:
         pid_file = open(config.PIDFILE_PATH, "r")
         pid = int(pid_file.read())
@@ -215,6 +215,11 @@ def cleanup_sssd_process():
             time.sleep(1)
     except:
         pass
+
+
+def cleanup_sssd_process():
+    """Stop the SSSD process and remove its state"""
+    stop_sssd_process()
     for path in os.listdir(config.DB_PATH):
         os.unlink(config.DB_PATH + "/" + path)
     for path in os.listdir(config.MCACHE_PATH):
@@ -2107,3 +2112,47 @@ def test_conflicting_mail_addresses(ldap_conn,
     # However resolving the users on their own must work
     ent.assert_passwd_by_name("userx", dict(name="userx", uid=1004, gid=2004))
     ent.assert_passwd_by_name("usery", dict(name="usery", uid=1005, gid=2005))
+
+
+@pytest.fixture
+def nosync_rfc2307(request, ldap_conn):
+    ent_list = ldap_ent.List(ldap_conn.ds_inst.base_dn)
+    ent_list.add_user("user1", 1001, 2001)
+    ent_list.add_group("group1", 2001, ["user1"])
+    create_ldap_fixture(request, ldap_conn, ent_list)
+
+    conf = format_basic_conf(ldap_conn, SCHEMA_RFC2307) + \
+        unindent("""
+            [domain/LDAP]
+            cache_nosync = true
+        """).format(**locals())
+    create_conf_fixture(request, conf)
+    create_sssd_fixture(request)
+    return None
+
+
+def test_cache_nosync(ldap_conn, nosync_rfc2307):
+    """
+    A cache which is not synced is marked while SSSD runs and removed on
+    the next start if it was damaged
+    """
+    ldb_file = config.DB_PATH + "/cache_LDAP.ldb"
+    marker = ldb_file + ".unclean"
+
+    ent.assert_passwd_by_name("user1", dict(name="user1", uid=1001,
+                                            gid=2001))
+    assert os.path.exists(marker)
+
+    stop_sssd_process()
+    assert not os.path.exists(marker)
+
+    # pretend the machine crashed while the cache was written
+    open(marker, "w").close()
+    with open(ldb_file, "r+b") as f:
+        f.seek(0)
+        f.write(b"\0" * 4096)
+
+    create_sssd_process()
+    ent.assert_passwd_by_name("user1", dict(name="user1", uid=1001,
+                                            gid=2001))
+    assert os.path.exists(marker)
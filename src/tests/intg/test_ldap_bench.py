@@ -0,0 +1,292 @@
+#
+# LDAP provider load benchmark
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+"""
+Runs sssd_be against a generated directory and reports, for each workload,
+the wall time, the number of LDAP operations and the time spent waiting
+for their first reply, and the number of sysdb transactions and the time
+they were open. The numbers of the backend come from the PerfStats method
+of its sssd.DataProvider.Backend interface.
+
+The benchmark is skipped unless LDAP_BENCH is set in the environment:
+
+    make intgcheck-installed INTGCHECK_PYTEST_ARGS="-s test_ldap_bench.py" \
+         LDAP_BENCH=1
+
+The size of the directory is set by LDAP_BENCH_USERS, LDAP_BENCH_GROUPS
+(groups on each nesting level), LDAP_BENCH_DEPTH (nesting levels) and
+LDAP_BENCH_GROUP_SIZE (direct user members of the groups of the lowest
+level). One JSON object is printed for each workload and schema, and
+appended to the file named by LDAP_BENCH_OUTPUT if it is set.
+"""
+import os
+import stat
+import json
+import signal
+import subprocess
+import time
+import pwd
+import pytest
+import config
+import ds_openldap
+import ldap_ent
+import sssd_id
+from sssd_perf import backend_stats, wait_for_backend
+from util import unindent
+
+LDAP_BASE_DN = "dc=example,dc=com"
+DOMAIN = "LDAP"
+
+BENCH_USERS = int(os.environ.get("LDAP_BENCH_USERS", "1000"))
+BENCH_GROUPS = int(os.environ.get("LDAP_BENCH_GROUPS", "100"))
+BENCH_DEPTH = int(os.environ.get("LDAP_BENCH_DEPTH", "3"))
+BENCH_GROUP_SIZE = int(os.environ.get("LDAP_BENCH_GROUP_SIZE", "50"))
+# users looked up by the initgroups and refresh workloads
+BENCH_LOOKUPS = min(BENCH_USERS, 200)
+
+BASE_UID = 100000
+BASE_GID = 200000
+BASE_RID = 10000
+
+ENUMERATION_TIMEOUT = 600
+
+pytestmark = pytest.mark.skipif("LDAP_BENCH" not in os.environ,
+                                reason="LDAP_BENCH is not set")
+
+
+def bench_user(i):
+    return "benchuser%d" % i
+
+
+def bench_group(level, i):
+    return "benchgroup%d_%d" % (level, i)
+
+
+def populate_directory(ldap_conn, schema):
+    """
+    Add the users and the groups. The groups of level 0 contain users, each
+    group of a higher level contains the group of the level below with the
+    same index, so the lookup of a user has to walk BENCH_DEPTH levels.
+    """
+    ent_list = ldap_ent.List(ldap_conn.ds_inst.base_dn)
+
+    for i in range(BENCH_USERS):
+        if schema == "ad":
+            ent_list.add_ad_user(bench_user(i), BASE_UID + i, BASE_GID,
+                                 BASE_RID + i)
+        else:
+            ent_list.add_user(bench_user(i), BASE_UID + i, BASE_GID)
+
+    gid = BASE_GID
+    for level in range(BENCH_DEPTH):
+        for i in range(BENCH_GROUPS):
+            if level == 0:
+                members = [bench_user((i * BENCH_GROUP_SIZE + j) % BENCH_USERS)
+                           for j in range(BENCH_GROUP_SIZE)]
+                member_groups = []
+            else:
+                members = []
+                member_groups = [bench_group(level - 1, i)]
+
+            if schema == "ad":
+                ent_list.add_ad_group(bench_group(level, i), gid,
+                                      BASE_RID + BENCH_USERS + gid - BASE_GID,
+                                      members, member_groups)
+            else:
+                ent_list.add_group_bis(bench_group(level, i), gid,
+                                       members, member_groups)
+            gid += 1
+
+    for entry in ent_list:
+        ldap_conn.add_s(entry[0], entry[1])
+
+
+@pytest.fixture(scope="module", params=["rfc2307bis", "ad"])
+def ldap_conn(request):
+    """Populated LDAP server fixture, for both schemas"""
+    if request.param == "ad":
+        ds_class = ds_openldap.FakeAD
+    else:
+        ds_class = ds_openldap.DSOpenLDAP
+
+    ds_inst = ds_class(config.PREFIX, 10389, LDAP_BASE_DN,
+                       "cn=admin", "Secret123")
+    try:
+        ds_inst.setup()
+    except:
+        ds_inst.teardown()
+        raise
+    request.addfinalizer(ds_inst.teardown)
+
+    ldap_conn = ds_inst.bind()
+    ldap_conn.ds_inst = ds_inst
+    ldap_conn.schema = request.param
+    request.addfinalizer(ldap_conn.unbind_s)
+
+    populate_directory(ldap_conn, request.param)
+    return ldap_conn
+
+
+def format_conf(ldap_conn, enumerate):
+    """Format the SSSD configuration of the benchmarked domain"""
+    schema = ldap_conn.schema
+    if schema == "ad":
+        schema_conf = unindent("""\
+            ldap_schema             = ad
+            ldap_id_mapping         = false
+            ldap_referrals          = false
+        """)
+    else:
+        schema_conf = unindent("""\
+            ldap_schema             = rfc2307bis
+            ldap_group_object_class = groupOfNames
+        """)
+
+    return unindent("""\
+        [sssd]
+        domains             = {DOMAIN}
+        services            = nss
+        enable_files_domain = false
+
+        [nss]
+        memcache_timeout    = 0
+
+        [domain/{DOMAIN}]
+        ldap_auth_disable_tls_never_use_in_production = true
+        id_provider         = ldap
+        enumerate           = {enumerate}
+        entry_cache_timeout = 3600
+        ldap_uri            = {ldap_conn.ds_inst.ldap_url}
+        ldap_search_base    = {ldap_conn.ds_inst.base_dn}
+        ldap_default_bind_dn = {ldap_conn.ds_inst.admin_dn}
+        ldap_default_authtok_type = password
+        ldap_default_authtok = {ldap_conn.ds_inst.admin_pw}
+    """).format(DOMAIN=DOMAIN, **locals()) + schema_conf
+
+
+def start_sssd(request, conf):
+    """Write sssd.conf, start SSSD and add teardown for stopping it"""
+    with open(config.CONF_PATH, "w") as conf_file:
+        conf_file.write(conf)
+    os.chmod(config.CONF_PATH, stat.S_IRUSR | stat.S_IWUSR)
+
+    if subprocess.call(["sssd", "-D", "-f"]) != 0:
+        raise Exception("sssd start failed")
+
+    def stop_sssd():
+        try:
+            with open(config.PIDFILE_PATH, "r") as pid_file:
+                pid = int(pid_file.read())
+            os.kill(pid, signal.SIGTERM)
+            while True:
+                try:
+                    os.kill(pid, signal.SIGCONT)
+                except:
+                    break
+                time.sleep(1)
+        except:
+            pass
+        for path in os.listdir(config.DB_PATH):
+            os.unlink(config.DB_PATH + "/" + path)
+        for path in os.listdir(config.MCACHE_PATH):
+            os.unlink(config.MCACHE_PATH + "/" + path)
+        os.unlink(config.CONF_PATH)
+
+    request.addfinalizer(stop_sssd)
+
+
+def run_workload(ldap_conn, name, workload, start=None):
+    """
+    Run workload() and report what it cost. If start is set, the workload
+    started together with sssd_be at that time, so all its counters count.
+    """
+    if start is None:
+        before = wait_for_backend(DOMAIN)
+        start = time.time()
+    else:
+        before = dict.fromkeys(wait_for_backend(DOMAIN), 0)
+    workload()
+    wall = time.time() - start
+    after = backend_stats(DOMAIN)
+
+    result = {
+        "bench": "ldap_provider",
+        "schema": ldap_conn.schema,
+        "case": name,
+        "users": BENCH_USERS,
+        "groups": BENCH_GROUPS * BENCH_DEPTH,
+        "depth": BENCH_DEPTH,
+        "group_size": BENCH_GROUP_SIZE,
+        "wall_ms": int(wall * 1000),
+        "ldap_ops": after["ldap_ops"] - before["ldap_ops"],
+        "ldap_ms": (after["ldap_usecs"] - before["ldap_usecs"]) // 1000,
+        "sysdb_transactions": (after["sysdb_transactions"] -
+                               before["sysdb_transactions"]),
+        "sysdb_ms": (after["sysdb_usecs"] - before["sysdb_usecs"]) // 1000,
+    }
+
+    line = json.dumps(result, sort_keys=True)
+    print(line)
+    if "LDAP_BENCH_OUTPUT" in os.environ:
+        with open(os.environ["LDAP_BENCH_OUTPUT"], "a") as output:
+            output.write(line + "\n")
+
+    return result
+
+
+def initgroups_all():
+    """Look up the groups of BENCH_LOOKUPS users"""
+    for i in range(BENCH_LOOKUPS):
+        res, errno, gids = sssd_id.call_sssd_initgroups(bench_user(i),
+                                                        BASE_GID)
+        assert res == sssd_id.NssReturnCode.SUCCESS, \
+            "initgroups of %s failed with %d" % (bench_user(i), errno)
+        assert len(gids) > 1
+
+
+def test_initgroups(request, ldap_conn):
+    """Initgroups of users that are not cached yet"""
+    start_sssd(request, format_conf(ldap_conn, "false"))
+    result = run_workload(ldap_conn, "initgroups", initgroups_all)
+    assert result["ldap_ops"] > 0
+
+
+def test_refresh(request, ldap_conn):
+    """Initgroups of cached users after their entries were expired"""
+    start_sssd(request, format_conf(ldap_conn, "false"))
+    wait_for_backend(DOMAIN)
+    initgroups_all()
+
+    subprocess.check_call(["sss_cache", "-E"])
+    result = run_workload(ldap_conn, "refresh", initgroups_all)
+    assert result["ldap_ops"] > 0
+
+
+def test_enumeration(request, ldap_conn):
+    """Full enumeration, timed until all users can be listed"""
+    def enumerated():
+        deadline = time.time() + ENUMERATION_TIMEOUT
+        while time.time() < deadline:
+            names = [ent.pw_name for ent in pwd.getpwall()]
+            if bench_user(BENCH_USERS - 1) in names:
+                return
+            time.sleep(0.5)
+        raise Exception("enumeration did not finish")
+
+    start = time.time()
+    start_sssd(request, format_conf(ldap_conn, "true"))
+    result = run_workload(ldap_conn, "enumeration", enumerated, start)
+    assert result["ldap_ops"] > 0
@@ -345,6 +345,34 @@ def zero_timeout_rfc2307(request, ldap_conn):
     return None
 
 
+@pytest.fixture
+def max_timeout_rfc2307(request, ldap_conn):
+    load_data_to_ldap(request, ldap_conn)
+
+    conf = unindent("""\
+        [sssd]
+        domains             = LDAP
+        services            = nss
+
+        [nss]
+        memcache_timeout = 1
+        memcache_max_timeout = 300
+
+        [domain/LDAP]
+        ldap_auth_disable_tls_never_use_in_production = true
+        ldap_schema         = rfc2307
+        id_provider         = ldap
+        auth_provider       = ldap
+        sudo_provider       = ldap
+        entry_cache_timeout = 3600
+        ldap_uri            = {ldap_conn.ds_inst.ldap_url}
+        ldap_search_base    = {ldap_conn.ds_inst.base_dn}
+    """).format(**locals())
+    create_conf_fixture(request, conf)
+    create_sssd_fixture(request)
+    return None
+
+
 def test_getpwnam(ldap_conn, sanity_rfc2307):
     ent.assert_passwd_by_name(
         'user1',
@@ -632,6 +660,21 @@ def test_initgroups_case_insensitive_with_mc3(ldap_conn,
                                   primary_gid, expected_gids)
 
 
+def test_initgroups_by_uid_with_mc(ldap_conn,
+                                   fqname_case_insensitive_rfc2307):
+    primary_gid = 2001
+    expected_gids = [2000, 2001]
+
+    assert_initgroups_equal('User1@LDAP', primary_gid, expected_gids)
+    pw_name = pwd.getpwnam('User1@LDAP').pw_name
+    assert pw_name != 'User1@LDAP'
+    stop_sssd()
+
+    # the record stored for another spelling of the name is found by the
+    # uid of the user in the passwd memory cache
+    assert_initgroups_equal(pw_name, primary_gid, expected_gids)
+
+
 def run_simple_test_with_initgroups():
     ent.assert_passwd_by_name(
         'user1',
@@ -1040,6 +1083,28 @@ def test_mc_zero_timeout(ldap_conn, zero_timeout_rfc2307):
         grp.getgrgid(2001)
 
 
+def test_mc_max_timeout(ldap_conn, max_timeout_rfc2307):
+    """
+    Test that the records of objects which do not expire in the cache
+    outlive memcache_timeout
+    """
+    ent.assert_passwd_by_name(
+        'user1',
+        dict(name='user1', passwd='*', uid=1001, gid=2001,
+             gecos='1001', shell='/bin/bash'))
+    ent.assert_group_by_name("group1", dict(name="group1", gid=2001))
+
+    time.sleep(2)
+    stop_sssd()
+
+    # the records are still valid although memcache_timeout passed
+    ent.assert_passwd_by_name(
+        'user1',
+        dict(name='user1', passwd='*', uid=1001, gid=2001,
+             gecos='1001', shell='/bin/bash'))
+    ent.assert_group_by_name("group1", dict(name="group1", gid=2001))
+
+
 def test_disabled_mc(ldap_conn, disable_memcache_rfc2307):
     ent.assert_passwd_by_name(
         'user1',
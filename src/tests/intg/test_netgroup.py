@@ -32,7 +32,7 @@ import ds_openldap
 import ldap_ent
 from util import unindent
 from sssd_nss import NssReturnCode
-from sssd_netgroup import get_sssd_netgroups
+from sssd_netgroup import get_sssd_netgroups, sssd_innetgr
 
 LDAP_BASE_DN = "dc=example,dc=com"
 
@@ -353,6 +353,34 @@ def test_add_mixed_netgroup(add_mixed_netgroup):
                                         ("host6", "user6", "domain6")])
 
 
+def test_innetgr_mixed_netgroup(add_mixed_netgroup):
+    """
+    Membership of triples checked by the responder, including the triples
+    of nested netgroups.
+    """
+
+    assert sssd_innetgr("mixed_netgroup9", "host6", "user6", "domain6") == \
+        (0, True)
+    assert sssd_innetgr("mixed_netgroup9", "host3", "user3", "domain3") == \
+        (0, True)
+    assert sssd_innetgr("mixed_netgroup9", "HOST1", "user1", None) == \
+        (0, True)
+    assert sssd_innetgr("mixed_netgroup9", None, "user2", None) == (0, True)
+    assert sssd_innetgr("mixed_netgroup9", "host1", "user2", None) == \
+        (0, False)
+    assert sssd_innetgr("mixed_netgroup9", None, "USER1", None) == (0, False)
+
+    # answered from the flattened netgroup kept by the responder
+    assert sssd_innetgr("mixed_netgroup9", "host2", None, "domain2") == \
+        (0, True)
+
+    assert sssd_innetgr("mixed_netgroup2", "host1", "user1", "domain1") == \
+        (0, False)
+    assert sssd_innetgr("mixed_netgroup6", "host5", "user5", "domain5") == \
+        (0, True)
+    assert sssd_innetgr("no_such_netgroup", None, None, None) == (0, False)
+
+
 @pytest.fixture
 def remove_step_by_step(request, ldap_conn):
     ent_list = ldap_ent.List(ldap_conn.ds_inst.base_dn)
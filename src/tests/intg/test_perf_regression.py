@@ -0,0 +1,258 @@
+#
+# Performance regression tests of the LDAP provider
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+"""
+Unlike test_ldap_bench.py these tests run with the rest of the suite and
+fail when a change makes lookups more expensive than they are today. The
+number of LDAP operations and sysdb transactions of a lookup come from the
+PerfStats counters of sssd_be, so the bounds below are exact enough not to
+depend on the speed of the machine. Only the latency test compares times,
+and only ones measured in the same run against each other.
+"""
+import os
+import stat
+import signal
+import subprocess
+import sys
+import time
+import pwd
+import pytest
+import config
+import ds_openldap
+import ldap_ent
+import sssd_id
+from sssd_perf import backend_stats, wait_for_backend, stats_delta
+from util import unindent
+
+LDAP_BASE_DN = "dc=example,dc=com"
+DOMAIN = "LDAP"
+
+USERS = 20
+GROUPS = 5
+GROUP_SIZE = 4
+
+BASE_UID = 100000
+BASE_GID = 200000
+
+# A user lookup is one search, its result is stored in one transaction.
+# One more of each is allowed for the lookup of the primary group.
+MAX_USER_LOOKUP_OPS = 2
+MAX_USER_LOOKUP_TRANSACTIONS = 2
+
+# Initgroups of a user of the nested RFC2307bis groups below: the user, the
+# groups with the user as member and one level of parent groups.
+MAX_INITGROUPS_OPS = 5
+MAX_INITGROUPS_TRANSACTIONS = 4
+
+# Lookups timed by the latency test
+LATENCY_LOOKUPS = 200
+# A lookup answered by the responder from its cache, on a loaded builder
+MAX_CACHED_LOOKUP_MS = 50
+
+LOOKUP_SCRIPT = unindent("""\
+    import pwd, sys, time
+    count = int(sys.argv[2])
+    start = time.time()
+    for _ in range(count):
+        pwd.getpwnam(sys.argv[1])
+    print((time.time() - start) * 1000.0 / count)
+""")
+
+
+def perf_user(i):
+    return "perfuser%d" % i
+
+
+@pytest.fixture(scope="module")
+def ldap_conn(request):
+    """LDAP server with USERS users in two levels of nested groups"""
+    ds_inst = ds_openldap.DSOpenLDAP(config.PREFIX, 10389, LDAP_BASE_DN,
+                                     "cn=admin", "Secret123")
+    try:
+        ds_inst.setup()
+    except:
+        ds_inst.teardown()
+        raise
+    request.addfinalizer(ds_inst.teardown)
+
+    ldap_conn = ds_inst.bind()
+    ldap_conn.ds_inst = ds_inst
+    request.addfinalizer(ldap_conn.unbind_s)
+
+    ent_list = ldap_ent.List(ldap_conn.ds_inst.base_dn)
+    for i in range(USERS):
+        ent_list.add_user(perf_user(i), BASE_UID + i, BASE_GID)
+    for i in range(GROUPS):
+        members = [perf_user((i * GROUP_SIZE + j) % USERS)
+                   for j in range(GROUP_SIZE)]
+        ent_list.add_group_bis("perfgroup%d" % i, BASE_GID + 1 + i, members)
+        ent_list.add_group_bis("perfparent%d" % i, BASE_GID + 1 + GROUPS + i,
+                               [], ["perfgroup%d" % i])
+    for entry in ent_list:
+        ldap_conn.add_s(entry[0], entry[1])
+
+    return ldap_conn
+
+
+def format_conf(ldap_conn, memcache_timeout):
+    """Format the SSSD configuration of the measured domain"""
+    return unindent("""\
+        [sssd]
+        domains             = {DOMAIN}
+        services            = nss
+        enable_files_domain = false
+
+        [nss]
+        memcache_timeout    = {memcache_timeout}
+
+        [domain/{DOMAIN}]
+        ldap_auth_disable_tls_never_use_in_production = true
+        id_provider         = ldap
+        entry_cache_timeout = 3600
+        ldap_schema         = rfc2307bis
+        ldap_group_object_class = groupOfNames
+        ldap_uri            = {ldap_conn.ds_inst.ldap_url}
+        ldap_search_base    = {ldap_conn.ds_inst.base_dn}
+        ldap_default_bind_dn = {ldap_conn.ds_inst.admin_dn}
+        ldap_default_authtok_type = password
+        ldap_default_authtok = {ldap_conn.ds_inst.admin_pw}
+    """).format(DOMAIN=DOMAIN, **locals())
+
+
+def start_sssd(request, conf):
+    """Write sssd.conf, start SSSD and add teardown for stopping it"""
+    with open(config.CONF_PATH, "w") as conf_file:
+        conf_file.write(conf)
+    os.chmod(config.CONF_PATH, stat.S_IRUSR | stat.S_IWUSR)
+
+    if subprocess.call(["sssd", "-D", "-f"]) != 0:
+        raise Exception("sssd start failed")
+
+    def stop_sssd():
+        try:
+            with open(config.PIDFILE_PATH, "r") as pid_file:
+                pid = int(pid_file.read())
+            os.kill(pid, signal.SIGTERM)
+            while True:
+                try:
+                    os.kill(pid, signal.SIGCONT)
+                except:
+                    break
+                time.sleep(1)
+        except:
+            pass
+        for path in os.listdir(config.DB_PATH):
+            os.unlink(config.DB_PATH + "/" + path)
+        for path in os.listdir(config.MCACHE_PATH):
+            os.unlink(config.MCACHE_PATH + "/" + path)
+        os.unlink(config.CONF_PATH)
+
+    request.addfinalizer(stop_sssd)
+    wait_for_backend(DOMAIN)
+
+
+@pytest.fixture
+def sssd_no_mc(request, ldap_conn):
+    """SSSD without the memory cache, every lookup reaches the responder"""
+    start_sssd(request, format_conf(ldap_conn, 0))
+    # connects to the server, so the lookups below do not count the rootDSE
+    pwd.getpwnam(perf_user(USERS - 1))
+
+
+@pytest.fixture
+def sssd_mc(request, ldap_conn):
+    """SSSD with the memory cache"""
+    start_sssd(request, format_conf(ldap_conn, 300))
+
+
+def initgroups(name):
+    res, errno, gids = sssd_id.call_sssd_initgroups(name, BASE_GID)
+    assert res == sssd_id.NssReturnCode.SUCCESS, \
+        "initgroups of %s failed with %d" % (name, errno)
+    return gids
+
+
+def timed_lookups(name, use_memcache):
+    """Return the mean time in ms of LATENCY_LOOKUPS lookups of name"""
+    env = os.environ.copy()
+    if not use_memcache:
+        env["SSS_NSS_USE_MEMCACHE"] = "NO"
+    output = subprocess.check_output(
+        [sys.executable, "-c", LOOKUP_SCRIPT, name, str(LATENCY_LOOKUPS)],
+        env=env)
+    return float(output.decode('utf-8'))
+
+
+def test_user_lookup(ldap_conn, sssd_no_mc):
+    """A user lookup costs a bounded number of LDAP operations"""
+    before = backend_stats(DOMAIN)
+    pwd.getpwnam(perf_user(0))
+    delta = stats_delta(before, backend_stats(DOMAIN))
+    assert 0 < delta["ldap_ops"] <= MAX_USER_LOOKUP_OPS
+    assert delta["sysdb_transactions"] <= MAX_USER_LOOKUP_TRANSACTIONS
+
+    # a valid cache entry is returned without asking the backend
+    before = backend_stats(DOMAIN)
+    pwd.getpwnam(perf_user(0))
+    delta = stats_delta(before, backend_stats(DOMAIN))
+    assert delta["ldap_ops"] == 0
+    assert delta["sysdb_transactions"] == 0
+
+
+def test_negative_lookup(ldap_conn, sssd_no_mc):
+    """A missing user is searched for only once"""
+    with pytest.raises(KeyError):
+        pwd.getpwnam("perfnosuchuser")
+
+    before = backend_stats(DOMAIN)
+    with pytest.raises(KeyError):
+        pwd.getpwnam("perfnosuchuser")
+    delta = stats_delta(before, backend_stats(DOMAIN))
+    assert delta["ldap_ops"] == 0
+    assert delta["sysdb_transactions"] == 0
+
+
+def test_initgroups_refresh(ldap_conn, sssd_no_mc):
+    """Refreshing expired users costs a bounded amount of work per user"""
+    for i in range(USERS):
+        assert len(initgroups(perf_user(i))) > 1
+
+    subprocess.check_call(["sss_cache", "-E"])
+
+    before = backend_stats(DOMAIN)
+    for i in range(USERS):
+        assert len(initgroups(perf_user(i))) > 1
+    delta = stats_delta(before, backend_stats(DOMAIN))
+
+    assert delta["ldap_ops"] > 0
+    assert delta["ldap_ops"] <= MAX_INITGROUPS_OPS * USERS
+    assert delta["sysdb_transactions"] <= MAX_INITGROUPS_TRANSACTIONS * USERS
+
+
+def test_lookup_latency(ldap_conn, sssd_mc):
+    """Cached lookups are fast, and faster yet from the memory cache"""
+    pwd.getpwnam(perf_user(0))
+
+    before = backend_stats(DOMAIN)
+    responder_ms = timed_lookups(perf_user(0), False)
+    memcache_ms = timed_lookups(perf_user(0), True)
+    delta = stats_delta(before, backend_stats(DOMAIN))
+
+    print("lookup latency: responder %.3f ms, memory cache %.3f ms" %
+          (responder_ms, memcache_ms))
+    assert delta["ldap_ops"] == 0
+    assert responder_ms < MAX_CACHED_LOOKUP_MS
+    assert memcache_ms < responder_ms
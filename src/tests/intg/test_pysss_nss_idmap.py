@@ -289,3 +289,42 @@ def test_case_insensitive(ldap_conn, simple_ad):
     output = pysss_nss_idmap.getnamebysid(group_sid)[group_sid]
     assert output[pysss_nss_idmap.TYPE_KEY] == pysss_nss_idmap.ID_GROUP
     assert output[pysss_nss_idmap.NAME_KEY] == group.lower()
+
+
+def test_list_operations(ldap_conn, simple_ad):
+    user = 'user1_dom1-19661'
+    user_id = pwd.getpwnam(user).pw_uid
+    user_sid = 'S-1-5-21-1305200397-2901131868-73388776-82809'
+    group = 'group3_dom1-17775'
+    group_id = grp.getgrnam(group).gr_gid
+    group_sid = 'S-1-5-21-1305200397-2901131868-73388776-82764'
+    missing_sid = 'S-1-5-21-1305200397-2901131868-73388776-99999'
+
+    # a lookup of a list is sent to SSSD as one request, missing and invalid
+    # elements are left out of the result
+    output = pysss_nss_idmap.getsidbyname([user, 'no_such_user', group, 1])
+    assert len(output) == 2
+    assert output[user][pysss_nss_idmap.SID_KEY] == user_sid
+    assert output[user][pysss_nss_idmap.TYPE_KEY] == pysss_nss_idmap.ID_USER
+    assert output[group][pysss_nss_idmap.SID_KEY] == group_sid
+    assert output[group][pysss_nss_idmap.TYPE_KEY] == pysss_nss_idmap.ID_GROUP
+
+    output = pysss_nss_idmap.getnamebysid((user_sid, group_sid, missing_sid))
+    assert len(output) == 2
+    assert output[user_sid][pysss_nss_idmap.NAME_KEY] == user
+    assert output[group_sid][pysss_nss_idmap.NAME_KEY] == group
+
+    output = pysss_nss_idmap.getidbysid([user_sid, group_sid, missing_sid])
+    assert len(output) == 2
+    assert output[user_sid][pysss_nss_idmap.ID_KEY] == user_id
+    assert output[group_sid][pysss_nss_idmap.ID_KEY] == group_id
+
+    output = pysss_nss_idmap.getsidbyid([user_id, str(group_id)])
+    assert output[user_id][pysss_nss_idmap.SID_KEY] == user_sid
+    assert output[str(group_id)][pysss_nss_idmap.SID_KEY] == group_sid
+
+    output = pysss_nss_idmap.getsidbyuid([user_id, group_id])
+    assert list(output.keys()) == [user_id]
+
+    output = pysss_nss_idmap.getsidbygid([user_id, group_id])
+    assert list(output.keys()) == [group_id]
@@ -372,6 +372,38 @@ def test_containers(setup_for_secrets, secrets_cli):
     assert str(err406.value).startswith("406")
 
 
+def test_paged_list(setup_for_secrets, secrets_cli):
+    """
+    Test that a list can be read in pages
+    """
+    cli = secrets_cli
+
+    keys = ["key%02d" % i for i in range(10)]
+    for key in reversed(keys):
+        cli.set_secret(key, "value")
+
+    assert sorted(cli.list_secrets()) == keys
+
+    pages = []
+    params = {"limit": 4}
+    while True:
+        page = cli.list_secrets(params=params)
+        pages.append(page)
+        if len(page) < 4:
+            break
+        params["after"] = page[-1]
+
+    assert pages == [keys[0:4], keys[4:8], keys[8:10]]
+
+    assert cli.list_secrets(params={"after": "key08"}) == ["key09"]
+    assert cli.list_secrets(params={"type": "simple",
+                                    "limit": 1}) == ["key00"]
+
+    with pytest.raises(HTTPError) as err400:
+        cli.list_secrets(params={"limit": "many"})
+    assert str(err400.value).startswith("400")
+
+
 def get_fds(pid):
     procpath = os.path.join("/proc/", str(pid), "fd")
     return os.listdir(procpath)
@@ -557,6 +589,14 @@ def test_per_uid_limit(setup_for_uid_limit, secrets_cli):
         cli.set_secret(str(MAX_UID_SECRETS), sec_value)
     assert str(err507.value).startswith("507")
 
+    # Removing a secret makes room for another one
+    cli.del_secret("0")
+    cli.set_secret(str(MAX_UID_SECRETS), sec_value)
+
+    with pytest.raises(HTTPError) as err507:
+        cli.set_secret(str(MAX_UID_SECRETS + 1), sec_value)
+    assert str(err507.value).startswith("507")
+
     # FIXME - at this point, it would be nice to test that another UID can
     # still store secrets, but sadly socket_wrapper doesn't allow us to fake
     # UIDs yet
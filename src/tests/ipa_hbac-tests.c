@@ -20,6 +20,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -835,6 +836,124 @@ START_TEST(ipa_hbac_test_allow_srchostgroup)
 }
 END_TEST
 
+START_TEST(ipa_hbac_test_compiled)
+{
+    enum hbac_eval_result result;
+    enum hbac_error_code code;
+    TALLOC_CTX *test_ctx;
+    struct hbac_rule **rules;
+    struct hbac_compiled_rules *compiled;
+    struct hbac_eval_req *eval_req;
+    struct hbac_info *info = NULL;
+
+    test_ctx = talloc_new(global_talloc_context);
+
+    /* Create a request */
+    eval_req = talloc_zero(test_ctx, struct hbac_eval_req);
+    fail_if (eval_req == NULL, "Failed to allocate memory");
+
+    get_test_user(eval_req, &eval_req->user);
+    get_test_service(eval_req, &eval_req->service);
+    get_test_srchost(eval_req, &eval_req->srchost);
+    get_test_srchost(eval_req, &eval_req->targethost);
+
+    /* Create the rules to evaluate against */
+    rules = talloc_array(test_ctx, struct hbac_rule *, 5);
+    fail_if (rules == NULL, "Failed to allocate memory");
+
+    /* A disabled rule allowing everything */
+    get_allow_all_rule(rules, &rules[0]);
+    rules[0]->name = "Disabled";
+    rules[0]->enabled = false;
+
+    /* A rule for another user */
+    get_allow_all_rule(rules, &rules[1]);
+    rules[1]->name = "Other user";
+    rules[1]->users->category = HBAC_CATEGORY_NULL;
+    rules[1]->users->names = talloc_array(rules[1], const char *, 2);
+    fail_if(rules[1]->users->names == NULL, "Failed to allocate memory");
+    rules[1]->users->names[0] = HBAC_TEST_INVALID_USER;
+    rules[1]->users->names[1] = NULL;
+
+    /* A rule for a group of the user and a group of the service */
+    get_allow_all_rule(rules, &rules[2]);
+    rules[2]->name = "Groups";
+    rules[2]->users->category = HBAC_CATEGORY_NULL;
+    rules[2]->users->groups = talloc_array(rules[2], const char *, 2);
+    fail_if(rules[2]->users->groups == NULL, "Failed to allocate memory");
+    rules[2]->users->groups[0] = "TestGroup2";
+    rules[2]->users->groups[1] = NULL;
+    rules[2]->services->category = HBAC_CATEGORY_NULL;
+    rules[2]->services->groups = talloc_array(rules[2], const char *, 2);
+    fail_if(rules[2]->services->groups == NULL, "Failed to allocate memory");
+    rules[2]->services->groups[0] = HBAC_TEST_SERVICEGROUP1;
+    rules[2]->services->groups[1] = NULL;
+
+    /* Matches as well, but comes later */
+    get_allow_all_rule(rules, &rules[3]);
+    rules[3]->name = "Allow All";
+
+    rules[4] = NULL;
+
+    code = hbac_compile_rules(rules, &compiled);
+    fail_unless(code == HBAC_SUCCESS, "hbac_compile_rules failed");
+
+    /* Evaluate the rules */
+    result = hbac_evaluate_compiled(compiled, eval_req, &info);
+    fail_unless(result == HBAC_EVAL_ALLOW,
+                "Expected [%s], got [%s]; "
+                "Error: [%s]",
+                hbac_result_string(HBAC_EVAL_ALLOW),
+                hbac_result_string(result),
+                info ? hbac_error_string(info->code):"Unknown");
+    fail_unless(strcmp(info->rule_name, "Groups") == 0,
+                "Expected rule [Groups], got [%s]", info->rule_name);
+    hbac_free_info(info);
+    info = NULL;
+    hbac_free_compiled_rules(compiled);
+
+    /* Negative test */
+    rules[2]->services->groups[0] = HBAC_TEST_INVALID_SERVICEGROUP;
+    rules[3] = NULL;
+
+    code = hbac_compile_rules(rules, &compiled);
+    fail_unless(code == HBAC_SUCCESS, "hbac_compile_rules failed");
+
+    result = hbac_evaluate_compiled(compiled, eval_req, &info);
+    fail_unless(result == HBAC_EVAL_DENY,
+                "Expected [%s], got [%s]; "
+                "Error: [%s]",
+                hbac_result_string(HBAC_EVAL_DENY),
+                hbac_result_string(result),
+                info ? hbac_error_string(info->code):"Unknown");
+    hbac_free_info(info);
+    info = NULL;
+    hbac_free_compiled_rules(compiled);
+
+    /* An incomplete rule is reported like by hbac_evaluate() */
+    talloc_free(rules[1]->targethosts);
+    rules[1]->targethosts = NULL;
+
+    code = hbac_compile_rules(rules, &compiled);
+    fail_unless(code == HBAC_SUCCESS, "hbac_compile_rules failed");
+
+    result = hbac_evaluate_compiled(compiled, eval_req, &info);
+    fail_unless(result == HBAC_EVAL_ERROR,
+                "Expected [%s], got [%s]",
+                hbac_result_string(HBAC_EVAL_ERROR),
+                hbac_result_string(result));
+    fail_unless(info->code == HBAC_ERROR_UNPARSEABLE_RULE,
+                "Expected [%s], got [%s]",
+                hbac_error_string(HBAC_ERROR_UNPARSEABLE_RULE),
+                hbac_error_string(info->code));
+    hbac_free_info(info);
+    info = NULL;
+    hbac_free_compiled_rules(compiled);
+
+    talloc_free(test_ctx);
+}
+END_TEST
+
 START_TEST(ipa_hbac_test_incomplete)
 {
     TALLOC_CTX *test_ctx;
@@ -879,6 +998,7 @@ Suite *hbac_test_suite (void)
     tcase_add_test(tc_hbac, ipa_hbac_test_allow_srchost);
     tcase_add_test(tc_hbac, ipa_hbac_test_allow_srchostgroup);
     tcase_add_test(tc_hbac, ipa_hbac_test_allow_utf8);
+    tcase_add_test(tc_hbac, ipa_hbac_test_compiled);
     tcase_add_test(tc_hbac, ipa_hbac_test_incomplete);
 
     suite_add_tcase(s, tc_hbac);
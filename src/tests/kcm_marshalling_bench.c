@@ -0,0 +1,244 @@
+/*
+   SSSD
+
+   KCM ccache marshalling benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Converts a ccache with a number of credentials to the binary format in
+ * which the secrets database stores it and back, the two operations the
+ * KCM responder does for every access to a stored ccache. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "util/util_creds.h"
+#include "responder/kcm/kcmsrv_ccache.h"
+#include "responder/kcm/kcmsrv_ccache_be.h"
+#include "tests/bench_common.h"
+
+#define DEFAULT_ITERATIONS  100000
+#define DEFAULT_CREDS       10
+#define BENCH_CRED_SIZE     2048
+#define BENCH_REALM         "EXAMPLE.COM"
+
+/* Referenced by kcmsrv_ccache.c, not used by the benchmark */
+const struct kcm_ccdb_ops ccdb_mem_ops;
+const struct kcm_ccdb_ops ccdb_sec_ops;
+const struct kcm_ccdb_ops ccdb_secdb_ops;
+
+static errno_t bench_ccache(TALLOC_CTX *mem_ctx, krb5_context kctx,
+                            struct cli_creds *owner, int num_creds,
+                            struct kcm_ccache **_cc)
+{
+    struct sss_iobuf *blob;
+    struct kcm_ccache *cc;
+    struct kcm_cred *crd;
+    krb5_principal princ;
+    krb5_error_code kerr;
+    uint8_t *data;
+    uuid_t uuid;
+    errno_t ret;
+    int i;
+
+    kerr = krb5_build_principal(kctx, &princ, sizeof(BENCH_REALM) - 1,
+                                BENCH_REALM, "bench_user", NULL);
+    if (kerr != 0) {
+        return EIO;
+    }
+
+    ret = kcm_cc_new(mem_ctx, kctx, owner, "bench", princ, &cc);
+    krb5_free_principal(kctx, princ);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (i = 0; i < num_creds; i++) {
+        data = talloc_size(cc, BENCH_CRED_SIZE);
+        if (data == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        memset(data, i, BENCH_CRED_SIZE);
+
+        blob = sss_iobuf_init_steal(cc, data, BENCH_CRED_SIZE);
+        if (blob == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        uuid_generate(uuid);
+        crd = kcm_cred_new(cc, uuid, blob);
+        if (crd == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = kcm_cc_store_creds(cc, crd);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    *_cc = cc;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(cc);
+    }
+    return ret;
+}
+
+static errno_t bench_run(TALLOC_CTX *mem_ctx, krb5_context kctx,
+                         int num_creds, int iterations)
+{
+    struct sss_iobuf *payload = NULL;
+    struct kcm_ccache *cc2;
+    struct kcm_ccache *cc;
+    struct bench_timer timer;
+    struct cli_creds owner;
+    const char *key;
+    char *name = NULL;
+    uuid_t uuid;
+    errno_t ret;
+    int i;
+
+    memset(&owner, 0, sizeof(owner));
+    owner.ucred.uid = getuid();
+    owner.ucred.gid = getgid();
+
+    ret = bench_ccache(mem_ctx, kctx, &owner, num_creds, &cc);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    name = talloc_asprintf(mem_ctx, "%d creds", num_creds);
+    if (name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; i++) {
+        talloc_zfree(payload);
+        ret = kcm_ccache_to_sec_input_binary(cc, cc, &payload);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+    bench_timer_stop(&timer);
+
+    bench_report("kcm_ccache_to_binary", name, iterations,
+                 bench_timer_ns_per_op(&timer, iterations));
+
+    ret = kcm_cc_get_uuid(cc, uuid);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    key = sec_key_create(cc, "bench", uuid);
+    if (key == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; i++) {
+        sss_iobuf_cursor_reset(payload);
+        ret = sec_kv_to_ccache_binary(cc, key, payload, &owner, &cc2);
+        if (ret != EOK) {
+            goto done;
+        }
+        talloc_free(cc2);
+    }
+    bench_timer_stop(&timer);
+
+    bench_report("kcm_binary_to_ccache", name, iterations,
+                 bench_timer_ns_per_op(&timer, iterations));
+
+    ret = EOK;
+
+done:
+    talloc_free(name);
+    talloc_free(cc);
+    return ret;
+}
+
+int main(int argc, const char *argv[])
+{
+    int pc_iterations = DEFAULT_ITERATIONS;
+    int pc_creds = DEFAULT_CREDS;
+    krb5_context kctx;
+    TALLOC_CTX *mem_ctx;
+    poptContext pc;
+    int opt;
+    int ret;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_iterations, 0,
+                        "Conversions done in each direction", NULL },
+        { "creds", 'c', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                   &pc_creds, 0,
+                   "Credentials in the largest ccache", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_iterations < 1 || pc_creds < 0) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    if (krb5_init_context(&kctx) != 0) {
+        fprintf(stderr, "Unable to initialize Kerberos\n");
+        return 2;
+    }
+
+    mem_ctx = talloc_new(NULL);
+    if (mem_ctx == NULL) {
+        krb5_free_context(kctx);
+        return 2;
+    }
+
+    /* an empty ccache and one with pc_creds credentials */
+    ret = bench_run(mem_ctx, kctx, 0, pc_iterations);
+    if (ret == EOK && pc_creds > 0) {
+        ret = bench_run(mem_ctx, kctx, pc_creds, pc_iterations);
+    }
+    if (ret != EOK) {
+        fprintf(stderr, "Marshalling failed: %s\n", sss_strerror(ret));
+    }
+
+    talloc_free(mem_ctx);
+    krb5_free_context(kctx);
+    return ret == EOK ? 0 : 2;
+}
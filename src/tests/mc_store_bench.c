@@ -0,0 +1,242 @@
+/*
+   SSSD
+
+   Memory cache store and lookup benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Stores users into a passwd memory cache the way sssd_nss does and looks
+ * them up with the client code of the NSS module. The cache is created in
+ * a private directory, SSS_NSS_MCACHE_DIR is redefined for this program,
+ * so no running sssd is needed. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "responder/nss/nsssrv_mmap_cache.h"
+#include "sss_client/nss_mc.h"
+#include "tests/bench_common.h"
+
+#define DEFAULT_ENTRIES     10000
+#define DEFAULT_ITERATIONS  1000000
+#define BENCH_BUFSIZE       4096
+#define BENCH_BASE_ID       10000
+#define BENCH_TIMEOUT       3600
+
+struct bench_ctx {
+    struct sss_mc_ctx *mcc;
+    char **names;
+    int entries;
+    int iterations;
+};
+
+static errno_t bench_store_one(struct bench_ctx *bctx, int i)
+{
+    struct sized_string name;
+    struct sized_string pw;
+    struct sized_string gecos;
+    struct sized_string homedir;
+    struct sized_string shell;
+
+    to_sized_string(&name, bctx->names[i]);
+    to_sized_string(&pw, "*");
+    to_sized_string(&gecos, bctx->names[i]);
+    to_sized_string(&homedir, "/home/bench");
+    to_sized_string(&shell, "/bin/sh");
+
+    return sss_mmap_cache_pw_store(&bctx->mcc, &name, &pw,
+                                   BENCH_BASE_ID + i, BENCH_BASE_ID + i,
+                                   &gecos, &homedir, &shell, NULL, 0);
+}
+
+static long bench_store(struct bench_ctx *bctx)
+{
+    int i;
+
+    for (i = 0; i < bctx->iterations; i++) {
+        if (bench_store_one(bctx, i % bctx->entries) != EOK) {
+            return -1;
+        }
+    }
+
+    return bctx->iterations;
+}
+
+static long bench_lookup_name(struct bench_ctx *bctx)
+{
+    char buf[BENCH_BUFSIZE];
+    struct passwd pwd;
+    const char *name;
+    int i;
+
+    for (i = 0; i < bctx->iterations; i++) {
+        name = bctx->names[i % bctx->entries];
+        if (sss_nss_mc_getpwnam(name, strlen(name), &pwd,
+                                buf, sizeof(buf)) != 0) {
+            return -1;
+        }
+    }
+
+    return bctx->iterations;
+}
+
+static long bench_lookup_uid(struct bench_ctx *bctx)
+{
+    char buf[BENCH_BUFSIZE];
+    struct passwd pwd;
+    int i;
+
+    for (i = 0; i < bctx->iterations; i++) {
+        if (sss_nss_mc_getpwuid(BENCH_BASE_ID + i % bctx->entries, &pwd,
+                                buf, sizeof(buf)) != 0) {
+            return -1;
+        }
+    }
+
+    return bctx->iterations;
+}
+
+static long bench_lookup_miss(struct bench_ctx *bctx)
+{
+    char buf[BENCH_BUFSIZE];
+    struct passwd pwd;
+    int i;
+
+    for (i = 0; i < bctx->iterations; i++) {
+        if (sss_nss_mc_getpwnam("missing", sizeof("missing") - 1, &pwd,
+                                buf, sizeof(buf)) != ENOENT) {
+            return -1;
+        }
+    }
+
+    return bctx->iterations;
+}
+
+int main(int argc, const char *argv[])
+{
+    struct {
+        const char *name;
+        long (*fn)(struct bench_ctx *bctx);
+    } cases[] = {
+        { "pw store", bench_store },
+        { "pw lookup name", bench_lookup_name },
+        { "pw lookup uid", bench_lookup_uid },
+        { "pw lookup miss", bench_lookup_miss },
+        { NULL, NULL }
+    };
+    int pc_entries = DEFAULT_ENTRIES;
+    int pc_iterations = DEFAULT_ITERATIONS;
+    struct bench_timer timer;
+    struct bench_ctx bctx;
+    TALLOC_CTX *mem_ctx;
+    poptContext pc;
+    long ops;
+    int opt;
+    int ret;
+    int i;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "entries", 'e', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                     &pc_entries, 0,
+                     "Number of cached users", NULL },
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_iterations, 0,
+                        "Operations done by each case", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_entries < 1 || pc_iterations < 1) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    if (mkdir(SSS_NSS_MCACHE_DIR, 0755) != 0 && errno != EEXIST) {
+        ret = errno;
+        fprintf(stderr, "Unable to create %s: %s\n", SSS_NSS_MCACHE_DIR,
+                sss_strerror(ret));
+        return 2;
+    }
+
+    mem_ctx = talloc_new(NULL);
+    if (mem_ctx == NULL) {
+        return 2;
+    }
+
+    memset(&bctx, 0, sizeof(bctx));
+    bctx.entries = pc_entries;
+    bctx.iterations = pc_iterations;
+
+    bctx.names = talloc_array(mem_ctx, char *, pc_entries);
+    if (bctx.names == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < pc_entries; i++) {
+        bctx.names[i] = talloc_asprintf(bctx.names, "user%d", i);
+        if (bctx.names[i] == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    /* Twice as many slots as entries, like a well-sized cache */
+    ret = sss_mmap_cache_init(mem_ctx, "passwd", getuid(), getgid(),
+                              SSS_MC_PASSWD, 2 * pc_entries, BENCH_TIMEOUT,
+                              SSS_MC_HASH_MURMUR3, &bctx.mcc);
+    if (ret != EOK) {
+        fprintf(stderr, "Unable to create the cache: %s\n",
+                sss_strerror(ret));
+        goto done;
+    }
+
+    for (i = 0; cases[i].name != NULL; i++) {
+        bench_timer_start(&timer);
+        ops = cases[i].fn(&bctx);
+        bench_timer_stop(&timer);
+
+        if (ops <= 0) {
+            fprintf(stderr, "Case '%s' failed\n", cases[i].name);
+            ret = EIO;
+            goto done;
+        }
+
+        bench_report("mmap_cache", cases[i].name, ops,
+                     bench_timer_ns_per_op(&timer, ops));
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(mem_ctx);
+    return ret == EOK ? 0 : 2;
+}
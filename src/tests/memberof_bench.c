@@ -0,0 +1,358 @@
+/*
+   SSSD
+
+   memberof module benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Times the membership changes the memberof module has to unroll for a
+ * group of growing size: adding all the members at once, nesting the group
+ * into another one, replacing the member list with one member changed,
+ * adding ghost members and deleting the group. The time of each operation
+ * should grow linearly with the number of members. Run it with
+ * LDB_MODULES_PATH pointing to the directory with the memberof module. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "db/sysdb.h"
+#include "tests/common.h"
+
+#define TESTS_PATH          "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB        "tests_conf.ldb"
+#define TEST_DOM_NAME       "memberof_bench"
+#define TEST_ID_PROVIDER    "ldap"
+
+#define DEFAULT_MIN_MEMBERS 1000
+#define DEFAULT_MAX_MEMBERS 64000
+#define BENCH_BASE_ID       10000
+#define BENCH_GROUP_ID      1000000
+
+struct bench_ctx {
+    struct sss_test_ctx *tctx;
+    const char **user_dns;
+    int num_users;
+};
+
+static double timespec_diff(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec)
+           + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static errno_t bench_add_users(struct bench_ctx *bctx, int num_users)
+{
+    struct sss_domain_info *dom = bctx->tctx->dom;
+    struct ldb_dn *dn;
+    char *name;
+    errno_t ret;
+    int i;
+
+    bctx->user_dns = talloc_array(bctx, const char *, num_users);
+    if (bctx->user_dns == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_transaction_start(dom->sysdb);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (i = 0; i < num_users; i++) {
+        name = talloc_asprintf(bctx, "user%d@%s", i, dom->name);
+        if (name == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = sysdb_add_basic_user(dom, name, BENCH_BASE_ID + i,
+                                   BENCH_BASE_ID + i, name, "/", "/bin/sh");
+        if (ret != EOK) {
+            goto done;
+        }
+
+        dn = sysdb_user_dn(bctx->user_dns, dom, name);
+        if (dn == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        bctx->user_dns[i] = ldb_dn_get_linearized(dn);
+        talloc_free(name);
+    }
+    bctx->num_users = num_users;
+
+    ret = sysdb_transaction_commit(dom->sysdb);
+
+done:
+    if (ret != EOK) {
+        sysdb_transaction_cancel(dom->sysdb);
+    }
+    return ret;
+}
+
+static errno_t bench_set_values(struct bench_ctx *bctx,
+                                struct ldb_dn *dn,
+                                const char *attr,
+                                const char **values,
+                                int num_values,
+                                int mod_op)
+{
+    struct sysdb_attrs *attrs;
+    errno_t ret;
+    int i;
+
+    attrs = sysdb_new_attrs(bctx);
+    if (attrs == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_values; i++) {
+        ret = sysdb_attrs_add_string(attrs, attr, values[i]);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = sysdb_set_entry_attr(bctx->tctx->sysdb, dn, attrs, mod_op);
+
+done:
+    talloc_free(attrs);
+    return ret;
+}
+
+struct bench_group {
+    int members;
+    const char *name;
+    const char *parent_name;
+    struct ldb_dn *dn;
+    struct ldb_dn *parent_dn;
+};
+
+static errno_t bench_op_add(struct bench_ctx *bctx, struct bench_group *grp)
+{
+    return bench_set_values(bctx, grp->dn, SYSDB_MEMBER, bctx->user_dns,
+                            grp->members, SYSDB_MOD_ADD);
+}
+
+static errno_t bench_op_nest(struct bench_ctx *bctx, struct bench_group *grp)
+{
+    const char *member = ldb_dn_get_linearized(grp->dn);
+
+    return bench_set_values(bctx, grp->parent_dn, SYSDB_MEMBER, &member, 1,
+                            SYSDB_MOD_ADD);
+}
+
+static errno_t bench_op_replace(struct bench_ctx *bctx,
+                                struct bench_group *grp)
+{
+    /* all but the first member plus one new one */
+    return bench_set_values(bctx, grp->dn, SYSDB_MEMBER, &bctx->user_dns[1],
+                            grp->members, SYSDB_MOD_REP);
+}
+
+static errno_t bench_op_ghosts(struct bench_ctx *bctx,
+                               struct bench_group *grp)
+{
+    const char **ghosts;
+    errno_t ret;
+    int i;
+
+    ghosts = talloc_array(bctx, const char *, grp->members);
+    if (ghosts == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < grp->members; i++) {
+        ghosts[i] = talloc_asprintf(ghosts, "ghost%d@%s", i,
+                                    bctx->tctx->dom->name);
+        if (ghosts[i] == NULL) {
+            talloc_free(ghosts);
+            return ENOMEM;
+        }
+    }
+
+    ret = bench_set_values(bctx, grp->dn, SYSDB_GHOST, ghosts, grp->members,
+                           SYSDB_MOD_ADD);
+    talloc_free(ghosts);
+    return ret;
+}
+
+static errno_t bench_op_delete(struct bench_ctx *bctx,
+                               struct bench_group *grp)
+{
+    return sysdb_delete_entry(bctx->tctx->sysdb, grp->dn, false);
+}
+
+struct bench_op {
+    const char *name;
+    errno_t (*fn)(struct bench_ctx *bctx, struct bench_group *grp);
+};
+
+static errno_t bench_run(struct bench_ctx *bctx,
+                         struct bench_op *ops,
+                         int members)
+{
+    struct sss_domain_info *dom = bctx->tctx->dom;
+    struct bench_group grp;
+    struct timespec start;
+    struct timespec end;
+    errno_t ret;
+    int i;
+
+    grp.members = members;
+    grp.name = talloc_asprintf(bctx, "group%d@%s", members, dom->name);
+    grp.parent_name = talloc_asprintf(bctx, "parent%d@%s", members,
+                                      dom->name);
+    if (grp.name == NULL || grp.parent_name == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_add_basic_group(dom, grp.name, BENCH_GROUP_ID + 2 * members);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sysdb_add_basic_group(dom, grp.parent_name,
+                                BENCH_GROUP_ID + 2 * members + 1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    grp.dn = sysdb_group_dn(bctx, dom, grp.name);
+    grp.parent_dn = sysdb_group_dn(bctx, dom, grp.parent_name);
+    if (grp.dn == NULL || grp.parent_dn == NULL) {
+        return ENOMEM;
+    }
+
+    printf("%8d", members);
+    for (i = 0; ops[i].name != NULL; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ret = ops[i].fn(bctx, &grp);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (ret != EOK) {
+            printf("\n");
+            fprintf(stderr, "%s failed [%d]: %s\n", ops[i].name,
+                    ret, sss_strerror(ret));
+            return ret;
+        }
+
+        printf(" %10.1f", timespec_diff(&start, &end) * 1000);
+        fflush(stdout);
+    }
+    printf("\n");
+
+    return EOK;
+}
+
+int main(int argc, const char *argv[])
+{
+    struct bench_op ops[] = {
+        { "add", bench_op_add },
+        { "nest", bench_op_nest },
+        { "replace", bench_op_replace },
+        { "ghosts", bench_op_ghosts },
+        { "delete", bench_op_delete },
+        { NULL, NULL }
+    };
+    int pc_min_members = DEFAULT_MIN_MEMBERS;
+    int pc_max_members = DEFAULT_MAX_MEMBERS;
+    struct bench_ctx *bctx;
+    poptContext pc;
+    int members;
+    int opt;
+    int ret;
+    int i;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "min-members", 'm', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                         &pc_min_members, 0,
+                         "Members of the smallest group", NULL },
+        { "max-members", 'M', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                         &pc_max_members, 0,
+                         "Members of the largest group", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_min_members < 1 || pc_max_members < pc_min_members) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    test_dom_suite_setup(TESTS_PATH);
+
+    bctx = talloc_zero(NULL, struct bench_ctx);
+    if (bctx == NULL) {
+        return 2;
+    }
+
+    bctx->tctx = create_dom_test_ctx(bctx, TESTS_PATH, TEST_CONF_DB,
+                                     TEST_DOM_NAME, TEST_ID_PROVIDER, NULL);
+    if (bctx->tctx == NULL) {
+        fprintf(stderr, "Unable to set up the cache\n");
+        ret = EIO;
+        goto done;
+    }
+
+    /* the replace operation needs one user more than the largest group */
+    ret = bench_add_users(bctx, pc_max_members + 1);
+    if (ret != EOK) {
+        fprintf(stderr, "Unable to add users [%d]: %s\n",
+                ret, sss_strerror(ret));
+        goto done;
+    }
+
+    printf("%8s", "members");
+    for (i = 0; ops[i].name != NULL; i++) {
+        printf(" %7s ms", ops[i].name);
+    }
+    printf("\n");
+
+    /* scale from pc_min_members to pc_max_members, doubling each round */
+    for (members = pc_min_members; ; members *= 2) {
+        if (members > pc_max_members) {
+            members = pc_max_members;
+        }
+        ret = bench_run(bctx, ops, members);
+        if (ret != EOK) {
+            goto done;
+        }
+        if (members == pc_max_members) {
+            break;
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(bctx);
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    return ret == EOK ? 0 : 2;
+}
@@ -0,0 +1,506 @@
+/*
+   SSSD
+
+   Negative cache benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Runs the scenarios of test_negcache.c: UID and user name misses, hits,
+ * stores and resets. Each one is timed with the negative cache and with a
+ * reference that keeps the entries in a memory-only TDB the way the
+ * negative cache did before it got its own hash table. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <time.h>
+#include <popt.h>
+#include <talloc.h>
+#include <tdb.h>
+
+#include "util/util.h"
+#include "responder/common/negcache.h"
+#include "tests/bench_common.h"
+
+#define DEFAULT_ENTRIES     10000
+#define DEFAULT_ITERATIONS  1000000
+#define BENCH_DOMAIN        "bench.test"
+#define BENCH_TIMEOUT       3600
+
+/* Reference implementation */
+
+struct bench_tdb {
+    struct tdb_context *tdb;
+};
+
+static int bench_tdb_check(struct bench_tdb *ref, char *str)
+{
+    unsigned long long int timestamp;
+    TDB_DATA key;
+    TDB_DATA data;
+    char *ep;
+    int ret;
+
+    key.dptr = (uint8_t *)str;
+    key.dsize = strlen(str) + 1;
+
+    data = tdb_fetch(ref->tdb, key);
+    if (data.dptr == NULL) {
+        return ENOENT;
+    }
+
+    errno = 0;
+    timestamp = strtoull((const char *)data.dptr, &ep, 10);
+    if (errno == 0 && *ep == '\0'
+            && (timestamp == 0 || timestamp >= time(NULL))) {
+        ret = EEXIST;
+    } else {
+        tdb_delete(ref->tdb, key);
+        ret = ENOENT;
+    }
+
+    free(data.dptr);
+    return ret;
+}
+
+static int bench_tdb_set(struct bench_tdb *ref, char *str)
+{
+    TDB_DATA key;
+    TDB_DATA data;
+    char *timest;
+    int ret;
+
+    timest = talloc_asprintf(ref, "%llu",
+                             (unsigned long long int)time(NULL)
+                             + BENCH_TIMEOUT);
+    if (timest == NULL) {
+        return ENOMEM;
+    }
+
+    key.dptr = (uint8_t *)str;
+    key.dsize = strlen(str) + 1;
+    data.dptr = (uint8_t *)timest;
+    data.dsize = strlen(timest) + 1;
+
+    ret = tdb_store(ref->tdb, key, data, TDB_REPLACE);
+    talloc_free(timest);
+
+    return ret == 0 ? EOK : EFAULT;
+}
+
+static int bench_tdb_check_uid(struct bench_tdb *ref, uid_t uid)
+{
+    char *str;
+    int ret;
+
+    str = talloc_asprintf(ref, "NCE/UID/%"SPRIuid, uid);
+    if (str == NULL) {
+        return ENOMEM;
+    }
+
+    ret = bench_tdb_check(ref, str);
+    talloc_free(str);
+    return ret;
+}
+
+static int bench_tdb_set_uid(struct bench_tdb *ref, uid_t uid)
+{
+    char *str;
+    int ret;
+
+    str = talloc_asprintf(ref, "NCE/UID/%"SPRIuid, uid);
+    if (str == NULL) {
+        return ENOMEM;
+    }
+
+    ret = bench_tdb_set(ref, str);
+    talloc_free(str);
+    return ret;
+}
+
+static int bench_tdb_check_user(struct bench_tdb *ref, const char *name)
+{
+    char *str;
+    int ret;
+
+    str = talloc_asprintf(ref, "NCE/USER/%s/%s", BENCH_DOMAIN, name);
+    if (str == NULL) {
+        return ENOMEM;
+    }
+
+    ret = bench_tdb_check(ref, str);
+    talloc_free(str);
+    return ret;
+}
+
+static int bench_tdb_set_user(struct bench_tdb *ref, const char *name)
+{
+    char *str;
+    int ret;
+
+    str = talloc_asprintf(ref, "NCE/USER/%s/%s", BENCH_DOMAIN, name);
+    if (str == NULL) {
+        return ENOMEM;
+    }
+
+    ret = bench_tdb_set(ref, str);
+    talloc_free(str);
+    return ret;
+}
+
+static int bench_tdb_delete_users(struct tdb_context *tdb,
+                                  TDB_DATA key, TDB_DATA data, void *state)
+{
+    if (strncmp((char *)key.dptr, "NCE/USE", 7) != 0
+            && strncmp((char *)key.dptr, "NCE/UI", 6) != 0) {
+        return 0;
+    }
+
+    return tdb_delete(tdb, key);
+}
+
+static int bench_tdb_reset_users(struct bench_tdb *ref)
+{
+    return tdb_traverse(ref->tdb, bench_tdb_delete_users, NULL) < 0
+           ? EIO : EOK;
+}
+
+static int bench_tdb_destructor(struct bench_tdb *ref)
+{
+    tdb_close(ref->tdb);
+    return 0;
+}
+
+static struct bench_tdb *bench_tdb_init(TALLOC_CTX *mem_ctx)
+{
+    struct bench_tdb *ref;
+
+    ref = talloc_zero(mem_ctx, struct bench_tdb);
+    if (ref == NULL) {
+        return NULL;
+    }
+
+    ref->tdb = tdb_open("memcache", 0, TDB_INTERNAL, O_RDWR | O_CREAT, 0);
+    if (ref->tdb == NULL) {
+        talloc_free(ref);
+        return NULL;
+    }
+    talloc_set_destructor(ref, bench_tdb_destructor);
+
+    return ref;
+}
+
+/* Scenarios */
+
+struct bench_ctx {
+    struct sss_nc_ctx *ncache;
+    struct bench_tdb *ref;
+    struct sss_domain_info *dom;
+    char **names;
+    int entries;
+    int iterations;
+};
+
+enum bench_impl {
+    BENCH_NCACHE,
+    BENCH_TDB,
+};
+
+static int bench_check_uid(struct bench_ctx *bctx, enum bench_impl impl,
+                           uid_t uid)
+{
+    if (impl == BENCH_TDB) {
+        return bench_tdb_check_uid(bctx->ref, uid);
+    }
+
+    return sss_ncache_check_uid(bctx->ncache, NULL, uid);
+}
+
+static int bench_check_user(struct bench_ctx *bctx, enum bench_impl impl,
+                            const char *name)
+{
+    if (impl == BENCH_TDB) {
+        return bench_tdb_check_user(bctx->ref, name);
+    }
+
+    return sss_ncache_check_user(bctx->ncache, bctx->dom, name);
+}
+
+static int bench_fill(struct bench_ctx *bctx, enum bench_impl impl)
+{
+    int ret;
+    int i;
+
+    for (i = 0; i < bctx->entries; i++) {
+        if (impl == BENCH_TDB) {
+            ret = bench_tdb_set_uid(bctx->ref, i + 1);
+            if (ret == EOK) {
+                ret = bench_tdb_set_user(bctx->ref, bctx->names[i]);
+            }
+        } else {
+            ret = sss_ncache_set_uid(bctx->ncache, false, NULL, i + 1);
+            if (ret == EOK) {
+                ret = sss_ncache_set_user(bctx->ncache, false, bctx->dom,
+                                          bctx->names[i]);
+            }
+        }
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    return EOK;
+}
+
+static int bench_reset(struct bench_ctx *bctx, enum bench_impl impl)
+{
+    if (impl == BENCH_TDB) {
+        return bench_tdb_reset_users(bctx->ref);
+    }
+
+    return sss_ncache_reset_users(bctx->ncache);
+}
+
+static int bench_uid_miss(struct bench_ctx *bctx, enum bench_impl impl)
+{
+    int i;
+
+    for (i = 0; i < bctx->iterations; i++) {
+        if (bench_check_uid(bctx, impl,
+                            bctx->entries + 1 + i % bctx->entries) != ENOENT) {
+            return -1;
+        }
+    }
+
+    return bctx->iterations;
+}
+
+static int bench_uid_hit(struct bench_ctx *bctx, enum bench_impl impl)
+{
+    int i;
+
+    for (i = 0; i < bctx->iterations; i++) {
+        if (bench_check_uid(bctx, impl, 1 + i % bctx->entries) != EEXIST) {
+            return -1;
+        }
+    }
+
+    return bctx->iterations;
+}
+
+static int bench_user_hit(struct bench_ctx *bctx, enum bench_impl impl)
+{
+    int i;
+
+    for (i = 0; i < bctx->iterations; i++) {
+        if (bench_check_user(bctx, impl,
+                             bctx->names[i % bctx->entries]) != EEXIST) {
+            return -1;
+        }
+    }
+
+    return bctx->iterations;
+}
+
+static int bench_store(struct bench_ctx *bctx, enum bench_impl impl)
+{
+    return bench_fill(bctx, impl) == EOK ? bctx->entries * 2 : -1;
+}
+
+/* Each round fills the cache and resets the users again */
+static int bench_reset_users(struct bench_ctx *bctx, enum bench_impl impl)
+{
+    int rounds = 100;
+    int i;
+
+    for (i = 0; i < rounds; i++) {
+        if (bench_fill(bctx, impl) != EOK || bench_reset(bctx, impl) != EOK) {
+            return -1;
+        }
+    }
+
+    if (bench_check_uid(bctx, impl, 1) != ENOENT) {
+        return -1;
+    }
+
+    return rounds;
+}
+
+/* The scenarios return the number of operations or -1 on failure */
+struct bench_scenario {
+    const char *name;
+    bool prefill;
+    int (*fn)(struct bench_ctx *bctx, enum bench_impl impl);
+};
+
+static double timespec_diff(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec)
+           + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int bench_run(TALLOC_CTX *mem_ctx, struct bench_ctx *bctx,
+                     struct bench_scenario *scenario, enum bench_impl impl,
+                     double *_ns, int *_ops)
+{
+    struct timespec start;
+    struct timespec end;
+    int ops;
+    int ret;
+
+    ret = sss_ncache_init(mem_ctx, BENCH_TIMEOUT, 0, &bctx->ncache);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    bctx->ref = bench_tdb_init(mem_ctx);
+    if (bctx->ref == NULL) {
+        return EIO;
+    }
+
+    if (scenario->prefill) {
+        ret = bench_fill(bctx, impl);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ops = scenario->fn(bctx, impl);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    talloc_zfree(bctx->ncache);
+    talloc_zfree(bctx->ref);
+
+    if (ops <= 0) {
+        return EINVAL;
+    }
+
+    *_ns = timespec_diff(&start, &end) * 1e9 / ops;
+    *_ops = ops;
+    return EOK;
+}
+
+int main(int argc, const char *argv[])
+{
+    struct bench_scenario scenarios[] = {
+        { "uid miss", true, bench_uid_miss },
+        { "uid hit", true, bench_uid_hit },
+        { "user hit", true, bench_user_hit },
+        { "store", false, bench_store },
+        { "reset users", false, bench_reset_users },
+        { NULL, false, NULL }
+    };
+    int pc_entries = DEFAULT_ENTRIES;
+    int pc_iterations = DEFAULT_ITERATIONS;
+    int pc_json = 0;
+    struct bench_ctx bctx;
+    TALLOC_CTX *mem_ctx;
+    poptContext pc;
+    double ncache_ns;
+    double tdb_ns;
+    int ops;
+    int opt;
+    int ret;
+    int i;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "entries", 'e', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                     &pc_entries, 0,
+                     "Number of cached users", NULL },
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_iterations, 0,
+                        "Lookups done by each scenario", NULL },
+        { "json", 'j', POPT_ARG_NONE, &pc_json, 0,
+                  "Print the results as JSON", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_entries < 1 || pc_iterations < 1) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    mem_ctx = talloc_new(NULL);
+    if (mem_ctx == NULL) {
+        return 2;
+    }
+
+    memset(&bctx, 0, sizeof(bctx));
+    bctx.entries = pc_entries;
+    bctx.iterations = pc_iterations;
+
+    bctx.dom = talloc_zero(mem_ctx, struct sss_domain_info);
+    bctx.names = talloc_array(mem_ctx, char *, pc_entries);
+    if (bctx.dom == NULL || bctx.names == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    bctx.dom->name = discard_const(BENCH_DOMAIN);
+    bctx.dom->case_sensitive = true;
+
+    for (i = 0; i < pc_entries; i++) {
+        bctx.names[i] = talloc_asprintf(bctx.names, "user%d", i);
+        if (bctx.names[i] == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    if (!pc_json) {
+        printf("%-12s %14s %14s %8s\n", "scenario", "ncache ns/op",
+               "tdb ns/op", "speedup");
+    }
+    for (i = 0; scenarios[i].name != NULL; i++) {
+        ret = bench_run(mem_ctx, &bctx, &scenarios[i], BENCH_NCACHE,
+                        &ncache_ns, &ops);
+        if (ret == EOK) {
+            ret = bench_run(mem_ctx, &bctx, &scenarios[i], BENCH_TDB,
+                            &tdb_ns, &ops);
+        }
+        if (ret != EOK) {
+            fprintf(stderr, "Scenario '%s' failed: %s\n",
+                    scenarios[i].name, sss_strerror(ret));
+            goto done;
+        }
+
+        if (pc_json) {
+            bench_report("negcache", scenarios[i].name, ops, ncache_ns);
+            bench_report("negcache_tdb", scenarios[i].name, ops, tdb_ns);
+        } else {
+            printf("%-12s %14.1f %14.1f %7.2fx\n", scenarios[i].name,
+                   ncache_ns, tdb_ns, tdb_ns / ncache_ns);
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(mem_ctx);
+    return ret == EOK ? 0 : 2;
+}
@@ -0,0 +1,187 @@
+/*
+   SSSD
+
+   Memory cache client lookup benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Hammers the passwd memory cache from an increasing number of threads and
+ * prints the lookup rate for each thread count. The cache must already be
+ * populated by a running sssd_nss, e.g. by calling 'id $USER' once. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <popt.h>
+
+#include "sss_client/nss_mc.h"
+
+#define DEFAULT_MAX_THREADS 8
+#define DEFAULT_ITERATIONS  1000000
+#define BENCH_BUFSIZE       4096
+
+struct bench_thread {
+    pthread_t tid;
+    const char *name;
+    long uid;
+    int iterations;
+    int failures;
+};
+
+static void *bench_thread_main(void *arg)
+{
+    struct bench_thread *bt = (struct bench_thread *)arg;
+    struct passwd pwd;
+    char buffer[BENCH_BUFSIZE];
+    size_t name_len = 0;
+    errno_t ret;
+    int i;
+
+    if (bt->name != NULL) {
+        name_len = strlen(bt->name);
+    }
+
+    for (i = 0; i < bt->iterations; i++) {
+        if (bt->name != NULL) {
+            ret = sss_nss_mc_getpwnam(bt->name, name_len, &pwd,
+                                      buffer, sizeof(buffer));
+        } else {
+            ret = sss_nss_mc_getpwuid(bt->uid, &pwd, buffer, sizeof(buffer));
+        }
+        if (ret != 0) {
+            bt->failures++;
+        }
+    }
+
+    return NULL;
+}
+
+static double timespec_diff(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec)
+           + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int run_bench(int num_threads, const char *name, long uid,
+                     int iterations)
+{
+    struct bench_thread *threads;
+    struct timespec start;
+    struct timespec end;
+    double elapsed;
+    long total = 0;
+    int failures = 0;
+    int ret;
+    int i;
+
+    threads = calloc(num_threads, sizeof(struct bench_thread));
+    if (threads == NULL) {
+        return ENOMEM;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < num_threads; i++) {
+        threads[i].name = name;
+        threads[i].uid = uid;
+        threads[i].iterations = iterations;
+        ret = pthread_create(&threads[i].tid, NULL,
+                             bench_thread_main, &threads[i]);
+        if (ret != 0) {
+            fprintf(stderr, "pthread_create failed: %s\n", strerror(ret));
+            num_threads = i;
+            break;
+        }
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i].tid, NULL);
+        total += threads[i].iterations;
+        failures += threads[i].failures;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed = timespec_diff(&start, &end);
+    printf("%4d threads: %12.0f lookups/s (%8.0f per thread), %d failures\n",
+           num_threads, total / elapsed, total / elapsed / num_threads,
+           failures);
+
+    free(threads);
+    return failures == total ? ENOENT : 0;
+}
+
+int main(int argc, const char *argv[])
+{
+    int opt;
+    poptContext pc;
+    int pc_max_threads = DEFAULT_MAX_THREADS;
+    int pc_iterations = DEFAULT_ITERATIONS;
+    long pc_uid = -1;
+    char *pc_name = NULL;
+    int threads;
+    int ret;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "name", 'n', POPT_ARG_STRING, &pc_name, 0,
+                  "User name to look up", NULL },
+        { "uid", 'u', POPT_ARG_LONG, &pc_uid, 0,
+                  "User ID to look up", NULL },
+        { "threads", 't', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                     &pc_max_threads, 0,
+                     "Maximum number of threads", NULL },
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_iterations, 0,
+                        "Lookups done by each thread", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if ((pc_name == NULL && pc_uid == -1) || pc_max_threads < 1
+            || pc_iterations < 1) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    /* scale from 1 to pc_max_threads, doubling each round */
+    for (threads = 1; ; threads *= 2) {
+        if (threads > pc_max_threads) {
+            threads = pc_max_threads;
+        }
+        ret = run_bench(threads, pc_name, pc_uid, pc_iterations);
+        if (ret != 0) {
+            fprintf(stderr, "No lookup succeeded, is the memory cache "
+                            "populated?\n");
+            return 2;
+        }
+        if (threads == pc_max_threads) {
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,358 @@
+/*
+   SSSD
+
+   LDAP entry parsing benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Times sdap_parse_entry() with a typical user and with groups of a
+ * growing number of members. The entries do not come from a server, the
+ * libldap calls used by the parser are wrapped like in test_sdap.c and
+ * serve the attributes of a prepared entry, so the results include the
+ * small cost of the wrappers. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "providers/ldap/sdap.h"
+#include "providers/ldap/ldap_opts.h"
+#include "tests/bench_common.h"
+
+#define DEFAULT_ITERATIONS  100000
+#define DEFAULT_MAX_MEMBERS 10000
+#define BENCH_MAX_ATTRS     32
+
+struct bench_attr {
+    const char *name;
+    const char **values;
+};
+
+struct bench_entry {
+    const char *dn;
+    struct bench_attr attrs[BENCH_MAX_ATTRS];
+};
+
+static struct bench_entry *bench_entry;
+static int bench_attr_idx;
+
+/* libldap wrappers */
+int __wrap_ldap_set_option(LDAP *ld, int option, void *invalue)
+{
+    return LDAP_OPT_SUCCESS;
+}
+
+char *__wrap_ldap_get_dn(LDAP *ld, LDAPMessage *entry)
+{
+    return discard_const(bench_entry->dn);
+}
+
+void __wrap_ldap_memfree(void *p)
+{
+    return;
+}
+
+struct berval **__wrap_ldap_get_values_len(LDAP *ld,
+                                           LDAPMessage *entry,
+                                           LDAP_CONST char *target)
+{
+    const char **values = NULL;
+    struct berval **vals;
+    size_t count;
+    size_t i;
+
+    for (i = 0; bench_entry->attrs[i].name != NULL; i++) {
+        if (strcmp(bench_entry->attrs[i].name, target) == 0) {
+            values = bench_entry->attrs[i].values;
+            break;
+        }
+    }
+
+    if (values == NULL) {
+        return NULL;
+    }
+
+    for (count = 0; values[count] != NULL; count++);
+
+    vals = talloc_zero_array(NULL, struct berval *, count + 1);
+    if (vals == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++) {
+        vals[i] = talloc_zero(vals, struct berval);
+        if (vals[i] == NULL) {
+            talloc_free(vals);
+            return NULL;
+        }
+        vals[i]->bv_val = discard_const(values[i]);
+        vals[i]->bv_len = strlen(values[i]);
+    }
+
+    return vals;
+}
+
+void __wrap_ldap_value_free_len(struct berval **vals)
+{
+    talloc_free(vals);
+}
+
+char *__wrap_ldap_first_attribute(LDAP *ld, LDAPMessage *entry,
+                                  BerElement **berout)
+{
+    bench_attr_idx = 1;
+    return discard_const(bench_entry->attrs[0].name);
+}
+
+char *__wrap_ldap_next_attribute(LDAP *ld, LDAPMessage *entry,
+                                 BerElement *ber)
+{
+    const char *name;
+
+    name = bench_entry->attrs[bench_attr_idx].name;
+    if (name != NULL) {
+        bench_attr_idx++;
+    }
+
+    return discard_const(name);
+}
+
+/* The search bases are not needed, do not link their parser */
+errno_t sdap_parse_search_base(TALLOC_CTX *mem_ctx,
+                               struct dp_option *opts, int class,
+                               struct sdap_search_base ***_search_bases)
+{
+    return EOK;
+}
+
+static int bench_parse(TALLOC_CTX *mem_ctx, struct sdap_attr_map *map,
+                       int num_attrs, int iterations, double *_ns)
+{
+    struct bench_timer timer;
+    struct sysdb_attrs *attrs;
+    struct sdap_handle sh;
+    struct sdap_msg sm;
+    int ret;
+    int i;
+
+    memset(&sh, 0, sizeof(sh));
+    memset(&sm, 0, sizeof(sm));
+
+    bench_timer_start(&timer);
+    for (i = 0; i < iterations; i++) {
+        ret = sdap_parse_entry(mem_ctx, &sh, &sm, map, num_attrs,
+                               &attrs, false);
+        if (ret != EOK) {
+            return ret;
+        }
+        talloc_free(attrs);
+    }
+    bench_timer_stop(&timer);
+
+    *_ns = bench_timer_ns_per_op(&timer, iterations);
+    return EOK;
+}
+
+static int bench_user(TALLOC_CTX *mem_ctx, int iterations)
+{
+    const char *oc[] = { "top", "person", "posixAccount", NULL };
+    const char *uid[] = { "bench_user", NULL };
+    const char *uid_number[] = { "10001", NULL };
+    const char *gid_number[] = { "10001", NULL };
+    const char *gecos[] = { "Bench User", NULL };
+    const char *home[] = { "/home/bench_user", NULL };
+    const char *shell[] = { "/bin/bash", NULL };
+    const char *cn[] = { "Bench User", NULL };
+    const char *upn[] = { "bench_user@EXAMPLE.COM", NULL };
+    const char *modstamp[] = { "20240101000000Z", NULL };
+    const char *member_of[] = { "cn=group1,ou=groups,dc=example,dc=com",
+                                "cn=group2,ou=groups,dc=example,dc=com",
+                                "cn=group3,ou=groups,dc=example,dc=com",
+                                NULL };
+    struct bench_entry user = {
+        .dn = "uid=bench_user,ou=people,dc=example,dc=com",
+        .attrs = {
+            { "objectClass", oc },
+            { "uid", uid },
+            { "uidNumber", uid_number },
+            { "gidNumber", gid_number },
+            { "gecos", gecos },
+            { "homeDirectory", home },
+            { "loginShell", shell },
+            { "cn", cn },
+            { "krbPrincipalName", upn },
+            { "modifyTimestamp", modstamp },
+            { "memberOf", member_of },
+            { NULL, NULL }
+        }
+    };
+    struct sdap_attr_map *map;
+    double ns;
+    int ret;
+
+    ret = sdap_copy_map(mem_ctx, rfc2307bis_user_map, SDAP_OPTS_USER, &map);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    bench_entry = &user;
+    ret = bench_parse(mem_ctx, map, SDAP_OPTS_USER, iterations, &ns);
+    bench_entry = NULL;
+    talloc_free(map);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    bench_report("sdap_parse_entry", "user", iterations, ns);
+    return EOK;
+}
+
+static int bench_group(TALLOC_CTX *mem_ctx, int members, int iterations)
+{
+    const char *oc[] = { "top", "groupOfNames", "posixGroup", NULL };
+    const char *cn[] = { "bench_group", NULL };
+    const char *gid_number[] = { "20001", NULL };
+    struct bench_entry group = {
+        .dn = "cn=bench_group,ou=groups,dc=example,dc=com",
+    };
+    struct sdap_attr_map *map;
+    const char **member;
+    char *name;
+    double ns;
+    int ret;
+    int i;
+
+    member = talloc_zero_array(mem_ctx, const char *, members + 1);
+    if (member == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < members; i++) {
+        member[i] = talloc_asprintf(member,
+                                    "uid=user%d,ou=people,dc=example,dc=com",
+                                    i);
+        if (member[i] == NULL) {
+            talloc_free(member);
+            return ENOMEM;
+        }
+    }
+
+    group.attrs[0].name = "objectClass";
+    group.attrs[0].values = oc;
+    group.attrs[1].name = "cn";
+    group.attrs[1].values = cn;
+    group.attrs[2].name = "gidNumber";
+    group.attrs[2].values = gid_number;
+    group.attrs[3].name = "member";
+    group.attrs[3].values = member;
+
+    ret = sdap_copy_map(mem_ctx, rfc2307bis_group_map, SDAP_OPTS_GROUP, &map);
+    if (ret != EOK) {
+        talloc_free(member);
+        return ret;
+    }
+
+    bench_entry = &group;
+    ret = bench_parse(mem_ctx, map, SDAP_OPTS_GROUP, iterations, &ns);
+    bench_entry = NULL;
+    talloc_free(map);
+    talloc_free(member);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    name = talloc_asprintf(mem_ctx, "group %d members", members);
+    if (name == NULL) {
+        return ENOMEM;
+    }
+
+    bench_report("sdap_parse_entry", name, iterations, ns);
+    talloc_free(name);
+    return EOK;
+}
+
+int main(int argc, const char *argv[])
+{
+    int pc_iterations = DEFAULT_ITERATIONS;
+    int pc_max_members = DEFAULT_MAX_MEMBERS;
+    TALLOC_CTX *mem_ctx;
+    poptContext pc;
+    int iterations;
+    int members;
+    int opt;
+    int ret;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_iterations, 0,
+                        "Entries parsed by each case", NULL },
+        { "max-members", 'M', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                         &pc_max_members, 0,
+                         "Members of the largest group", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_iterations < 1 || pc_max_members < 1) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    mem_ctx = talloc_new(NULL);
+    if (mem_ctx == NULL) {
+        return 2;
+    }
+
+    ret = bench_user(mem_ctx, pc_iterations);
+    if (ret != EOK) {
+        fprintf(stderr, "Unable to parse the user: %s\n", sss_strerror(ret));
+        goto done;
+    }
+
+    /* the larger groups are parsed less often to keep the run short */
+    for (members = 10; members <= pc_max_members; members *= 10) {
+        iterations = pc_iterations / members * 10;
+        if (iterations < 1) {
+            iterations = 1;
+        }
+
+        ret = bench_group(mem_ctx, members, iterations);
+        if (ret != EOK) {
+            fprintf(stderr, "Unable to parse the group: %s\n",
+                    sss_strerror(ret));
+            goto done;
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(mem_ctx);
+    return ret == EOK ? 0 : 2;
+}
@@ -724,6 +724,80 @@ START_TEST (test_sysdb_user_new_id)
 }
 END_TEST
 
+START_TEST (test_sysdb_cached_dn_and_filter)
+{
+    struct sysdb_test_ctx *test_ctx;
+    struct ldb_dn *dn;
+    struct ldb_dn *expected;
+    struct ldb_result *res;
+    struct ldb_message *msg;
+    const char *fqname;
+    const char *pattern;
+    char *clean_name;
+    int ret;
+
+    /* Setup */
+    ret = setup_sysdb_tests(&test_ctx);
+    if (ret != EOK) {
+        fail("Could not set up the test");
+        return;
+    }
+
+    /* DNs are built from the cached base DN */
+    fqname = sss_create_internal_fqname(test_ctx, "test(*),user=x",
+                                        test_ctx->domain->name);
+    fail_if(fqname == NULL, "Failed to allocate memory");
+
+    dn = sysdb_user_dn(test_ctx, test_ctx->domain, fqname);
+    fail_if(dn == NULL, "sysdb_user_dn failed");
+    fail_unless(ldb_dn_add_child_fmt(dn, "cn=child"), "OOM");
+
+    dn = sysdb_user_dn(test_ctx, test_ctx->domain, fqname);
+    fail_if(dn == NULL, "sysdb_user_dn failed");
+    ret = sysdb_dn_sanitize(test_ctx, fqname, &clean_name);
+    fail_if(ret != EOK, "sysdb_dn_sanitize failed");
+    expected = ldb_dn_new_fmt(test_ctx, test_ctx->sysdb->ldb,
+                              SYSDB_TMPL_USER, clean_name,
+                              test_ctx->domain->name);
+    fail_if(expected == NULL, "Failed to allocate memory");
+    ck_assert_int_eq(ldb_dn_compare(dn, expected), 0);
+    ck_assert_str_eq(ldb_dn_get_linearized(dn),
+                     ldb_dn_get_linearized(expected));
+
+    /* the filter values are not interpreted */
+    ret = sysdb_add_user(test_ctx->domain, fqname,
+                         1235, 1235, fqname, "/", "/bin/bash",
+                         NULL, NULL, 0, 0);
+    fail_if(ret != EOK, "Could not store user %s", fqname);
+
+    ret = sysdb_getpwnam(test_ctx, test_ctx->domain, fqname, &res);
+    fail_if(ret != EOK, "sysdb_getpwnam failed");
+    ck_assert_int_eq(res->count, 1);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain, fqname,
+                                    NULL, &msg);
+    fail_if(ret != EOK, "Could not retrieve user %s", fqname);
+
+    pattern = sss_create_internal_fqname(test_ctx, "test*",
+                                         test_ctx->domain->name);
+    fail_if(pattern == NULL, "Failed to allocate memory");
+
+    ret = sysdb_getpwnam(test_ctx, test_ctx->domain, pattern, &res);
+    fail_if(ret != EOK, "sysdb_getpwnam failed");
+    ck_assert_int_eq(res->count, 0);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain, pattern,
+                                    NULL, &msg);
+    ck_assert_int_eq(ret, ENOENT);
+
+    ret = sysdb_delete_user(test_ctx->domain, fqname, 0);
+    fail_unless(ret == EOK, "sysdb_delete_user error [%d][%s]",
+                            ret, strerror(ret));
+
+    talloc_free(test_ctx);
+}
+END_TEST
+
 START_TEST (test_sysdb_store_user)
 {
     struct sysdb_test_ctx *test_ctx;
@@ -771,6 +845,209 @@ START_TEST (test_sysdb_store_user_existing)
 }
 END_TEST
 
+#define STORE_USERS_BASE 27500
+#define STORE_USERS_NUM 250
+#define STORE_USERS_EXISTING 120
+
+START_TEST (test_sysdb_store_users)
+{
+    struct sysdb_test_ctx *test_ctx;
+    struct sysdb_store_user_entry *users;
+    struct test_data *data;
+    struct ldb_result *res;
+    const char *shell;
+    int ret;
+    int i;
+
+    /* Setup */
+    ret = setup_sysdb_tests(&test_ctx);
+    if (ret != EOK) {
+        fail("Could not set up the test");
+        return;
+    }
+
+    /* Some of the users are in the cache already */
+    for (i = 0; i < STORE_USERS_EXISTING; i++) {
+        data = test_data_new_user(test_ctx, STORE_USERS_BASE + i);
+        fail_if(data == NULL, "OOM");
+
+        ret = test_store_user(data);
+        fail_if(ret != EOK, "Could not store user %s", data->username);
+    }
+
+    /* The last entry repeats the first one */
+    users = talloc_zero_array(test_ctx, struct sysdb_store_user_entry,
+                              STORE_USERS_NUM + 1);
+    fail_if(users == NULL, "OOM");
+
+    for (i = 0; i <= STORE_USERS_NUM; i++) {
+        data = test_data_new_user(test_ctx,
+                                  STORE_USERS_BASE + i % STORE_USERS_NUM);
+        fail_if(data == NULL, "OOM");
+
+        users[i].domain = test_ctx->domain;
+        users[i].name = data->username;
+        users[i].pwd = "x";
+        users[i].uid = data->uid;
+        users[i].gid = 0;
+        users[i].homedir = "/home/testuser";
+        users[i].shell = i == STORE_USERS_NUM ? "/bin/zsh" : "/bin/ksh";
+        users[i].cache_timeout = -1;
+    }
+
+    ret = sysdb_store_users(test_ctx->sysdb, users, STORE_USERS_NUM + 1, 0);
+    fail_if(ret != EOK, "sysdb_store_users failed [%d]: %s",
+            ret, sss_strerror(ret));
+
+    for (i = 0; i < STORE_USERS_NUM; i++) {
+        fail_if(users[i].ret != EOK, "Could not store user %s [%d]: %s",
+                users[i].name, users[i].ret, sss_strerror(users[i].ret));
+
+        ret = sysdb_getpwuid(test_ctx, test_ctx->domain,
+                             STORE_USERS_BASE + i, &res);
+        fail_if(ret != EOK, "sysdb_getpwuid failed for %s", users[i].name);
+        fail_unless(res->count == 1, "Expected one user %s, got %d",
+                    users[i].name, res->count);
+
+        shell = ldb_msg_find_attr_as_string(res->msgs[0], SYSDB_SHELL, NULL);
+        fail_if(shell == NULL, "User %s has no shell", users[i].name);
+        fail_unless(strcmp(shell, i == 0 ? "/bin/zsh" : "/bin/ksh") == 0,
+                    "Unexpected shell %s of %s", shell, users[i].name);
+        talloc_free(res);
+
+        ret = sysdb_delete_user(test_ctx->domain, users[i].name, 0);
+        fail_unless(ret == EOK, "sysdb_delete_user error [%d][%s]",
+                                ret, strerror(ret));
+    }
+
+    talloc_free(test_ctx);
+}
+END_TEST
+
+#define STORE_USERS_UPDATE_BASE 27800
+#define STORE_USERS_NOW 1700000000
+
+START_TEST (test_sysdb_store_users_update)
+{
+    struct sysdb_test_ctx *test_ctx;
+    struct sysdb_store_user_entry users[3];
+    const char *attrs[] = { SYSDB_NAME, SYSDB_UIDNUM, SYSDB_GECOS,
+                            SYSDB_SHELL, SYSDB_CACHE_EXPIRE,
+                            SYSDB_LAST_UPDATE, NULL };
+    const char *remove_attrs[] = { SYSDB_GECOS, NULL };
+    struct test_data *stale;
+    struct test_data *renamed;
+    struct test_data *added;
+    struct ldb_message *msg;
+    const char *new_name;
+    int ret;
+
+    /* Setup */
+    ret = setup_sysdb_tests(&test_ctx);
+    if (ret != EOK) {
+        fail("Could not set up the test");
+        return;
+    }
+
+    stale = test_data_new_user(test_ctx, STORE_USERS_UPDATE_BASE);
+    renamed = test_data_new_user(test_ctx, STORE_USERS_UPDATE_BASE + 1);
+    added = test_data_new_user(test_ctx, STORE_USERS_UPDATE_BASE + 2);
+    new_name = test_asprintf_fqname(test_ctx, test_ctx->domain,
+                                    "renameduser%d",
+                                    STORE_USERS_UPDATE_BASE + 1);
+    fail_if(stale == NULL || renamed == NULL || added == NULL
+            || new_name == NULL, "OOM");
+
+    /* A cached user which expired long ago */
+    ret = sysdb_store_user(test_ctx->domain, stale->username, "x", stale->uid,
+                           0, "Old gecos", "/home/stale", "/bin/bash",
+                           NULL, NULL, NULL, 1, STORE_USERS_NOW - 1000);
+    fail_if(ret != EOK, "Could not store user %s", stale->username);
+
+    /* A cached user which is renamed on the server */
+    ret = sysdb_store_user(test_ctx->domain, renamed->username, "x",
+                           renamed->uid, 0, NULL, "/home/renamed",
+                           "/bin/bash", NULL, NULL, NULL, 100,
+                           STORE_USERS_NOW - 1000);
+    fail_if(ret != EOK, "Could not store user %s", renamed->username);
+
+    memset(users, 0, sizeof(users));
+
+    users[0].domain = test_ctx->domain;
+    users[0].name = stale->username;
+    users[0].uid = stale->uid;
+    users[0].homedir = "/home/stale";
+    users[0].shell = "/bin/zsh";
+    users[0].remove_attrs = discard_const(remove_attrs);
+    users[0].cache_timeout = 100;
+
+    users[1].domain = test_ctx->domain;
+    users[1].name = new_name;
+    users[1].uid = renamed->uid;
+    users[1].homedir = "/home/renamed";
+    users[1].shell = "/bin/bash";
+    users[1].cache_timeout = 100;
+
+    /* cache_timeout 0 means the entry never expires */
+    users[2].domain = test_ctx->domain;
+    users[2].name = added->username;
+    users[2].uid = added->uid;
+    users[2].homedir = "/home/added";
+    users[2].shell = "/bin/bash";
+    users[2].cache_timeout = 0;
+
+    ret = sysdb_store_users(test_ctx->sysdb, users, 3, STORE_USERS_NOW);
+    fail_if(ret != EOK, "sysdb_store_users failed [%d]: %s",
+            ret, sss_strerror(ret));
+    fail_if(users[0].ret != EOK || users[1].ret != EOK || users[2].ret != EOK,
+            "Could not store the users [%d][%d][%d]",
+            users[0].ret, users[1].ret, users[2].ret);
+
+    /* The stale user is refreshed, the removed attribute is gone */
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain,
+                                    stale->username, attrs, &msg);
+    fail_if(ret != EOK, "Could not find user %s", stale->username);
+    fail_unless(ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0)
+                    == STORE_USERS_NOW + 100,
+                "Unexpected expiration of %s", stale->username);
+    fail_unless(ldb_msg_find_attr_as_uint64(msg, SYSDB_LAST_UPDATE, 0)
+                    == STORE_USERS_NOW,
+                "Unexpected last update of %s", stale->username);
+    fail_unless(strcmp(ldb_msg_find_attr_as_string(msg, SYSDB_SHELL, ""),
+                       "/bin/zsh") == 0,
+                "The shell of %s was not updated", stale->username);
+    fail_unless(ldb_msg_find_attr_as_string(msg, SYSDB_GECOS, NULL) == NULL,
+                "The gecos of %s was not removed", stale->username);
+    talloc_free(msg);
+
+    /* The old name of the renamed user is evicted */
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain,
+                                    renamed->username, attrs, &msg);
+    fail_unless(ret == ENOENT, "User %s was not removed [%d]",
+                renamed->username, ret);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain, new_name,
+                                    attrs, &msg);
+    fail_if(ret != EOK, "Could not find user %s", new_name);
+    fail_unless(ldb_msg_find_attr_as_uint64(msg, SYSDB_UIDNUM, 0)
+                    == renamed->uid,
+                "Unexpected UID of %s", new_name);
+    fail_unless(ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0)
+                    == STORE_USERS_NOW + 100,
+                "Unexpected expiration of %s", new_name);
+    talloc_free(msg);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain,
+                                    added->username, attrs, &msg);
+    fail_if(ret != EOK, "Could not find user %s", added->username);
+    fail_unless(ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 1) == 0,
+                "User %s expires", added->username);
+    talloc_free(msg);
+
+    talloc_free(test_ctx);
+}
+END_TEST
+
 START_TEST (test_sysdb_store_group)
 {
     struct sysdb_test_ctx *test_ctx;
@@ -6225,8 +6502,11 @@ START_TEST(test_sysdb_search_user_by_cert)
     struct ldb_val val;
     struct test_data *data;
     struct test_data *data2;
+    struct ldb_message *msg;
+    const char *hash_attrs[] = { SYSDB_USER_MAPPED_CERT_HASH, NULL };
     const char *name;
     const char *name2;
+    char *hash;
 
     /* Setup */
     ret = setup_sysdb_tests(&test_ctx);
@@ -6263,6 +6543,22 @@ START_TEST(test_sysdb_search_user_by_cert)
                       "expected [%s], got [%s].", data->username,
                       ldb_msg_find_attr_as_string(res->msgs[0],SYSDB_NAME, ""));
 
+    /* The lookup is done by the hash stored with the certificate */
+    ret = sysdb_cert_hash(test_ctx, val.data, val.length, &hash);
+    fail_unless(ret == EOK, "sysdb_cert_hash failed with [%d][%s].",
+                ret, strerror(ret));
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->domain,
+                                    data->username, hash_attrs, &msg);
+    fail_unless(ret == EOK, "sysdb_search_user_by_name failed with [%d][%s].",
+                ret, strerror(ret));
+    fail_unless(strcmp(ldb_msg_find_attr_as_string(msg,
+                                                   SYSDB_USER_MAPPED_CERT_HASH,
+                                                   ""), hash) == 0,
+                "Unexpected certificate hash, expected [%s], got [%s].", hash,
+                ldb_msg_find_attr_as_string(msg, SYSDB_USER_MAPPED_CERT_HASH,
+                                            ""));
+
     /* Add a second user with the same certificate */
     data2 = test_data_new_user(test_ctx, 2345671);
     fail_if(data2 == NULL, "Failed to allocate memory");
@@ -6850,6 +7146,41 @@ START_TEST(test_autofs_get_duplicate_keys)
 }
 END_TEST
 
+START_TEST(test_autofs_get_entry_by_key)
+{
+    struct sysdb_test_ctx *test_ctx;
+    const char *autofsmapname;
+    const char *autofsval;
+    const char *value;
+    struct ldb_message *entry;
+    errno_t ret;
+
+    ret = setup_sysdb_tests(&test_ctx);
+    fail_if(ret != EOK, "Could not set up the test");
+
+    autofsmapname = talloc_asprintf(test_ctx, "testmap%d", _i);
+    fail_if(autofsmapname == NULL, "Out of memory\n");
+
+    autofsval = talloc_asprintf(test_ctx, "testserver:/testval%d", _i);
+    fail_if(autofsval == NULL, "Out of memory\n");
+
+    /* testkey is stored in every map, only the one of this map is found */
+    ret = sysdb_get_autofsentry(test_ctx, test_ctx->domain, autofsmapname,
+                                "testkey", &entry);
+    fail_if(ret != EOK, "Cannot get testkey of map %s\n", autofsmapname);
+
+    value = ldb_msg_find_attr_as_string(entry, SYSDB_AUTOFS_ENTRY_VALUE, NULL);
+    fail_if(value == NULL || strcmp(value, autofsval) != 0,
+            "Expected value %s, got %s\n", autofsval, value);
+
+    ret = sysdb_get_autofsentry(test_ctx, test_ctx->domain, autofsmapname,
+                                "nosuchkey", &entry);
+    fail_if(ret != ENOENT, "Expected ENOENT, got %d\n", ret);
+
+    talloc_free(test_ctx);
+}
+END_TEST
+
 #endif /* BUILD_AUTOFS */
 
 static struct confdb_ctx *test_cdb_domains_prep(TALLOC_CTX *mem_ctx)
@@ -7816,6 +8147,7 @@ Suite *create_sysdb_suite(void)
 
     /* Add a user with an automatic ID */
     tcase_add_test(tc_sysdb, test_sysdb_user_new_id);
+    tcase_add_test(tc_sysdb, test_sysdb_cached_dn_and_filter);
 
     /* Create a new user */
     tcase_add_loop_test(tc_sysdb, test_sysdb_add_user, 27000, 27010);
@@ -7844,6 +8176,10 @@ Suite *create_sysdb_suite(void)
     /* test the change */
     tcase_add_loop_test(tc_sysdb, test_sysdb_get_user_attr, 27000, 27010);
 
+    /* Store new and existing users at once */
+    tcase_add_test(tc_sysdb, test_sysdb_store_users);
+    tcase_add_test(tc_sysdb, test_sysdb_store_users_update);
+
     /* Add and remove users in a group with sysdb_update_members */
     tcase_add_test(tc_sysdb, test_sysdb_update_members);
 
@@ -8230,6 +8566,9 @@ Suite *create_sysdb_suite(void)
 
     tcase_add_test(tc_autofs, test_autofs_get_duplicate_keys);
 
+    tcase_add_loop_test(tc_autofs, test_autofs_get_entry_by_key,
+                        TEST_AUTOFS_MAP_BASE, TEST_AUTOFS_MAP_BASE+10);
+
     suite_add_tcase(s, tc_autofs);
 #endif
 
@@ -0,0 +1,191 @@
+/*
+   SSSD
+
+   sysdb user store benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Times sysdb_store_user() for the three cases a provider runs into: a
+ * user that is not cached yet, a user that is refreshed without changes,
+ * which only touches the timestamp cache, and a user whose attributes
+ * changed. Each store is its own transaction, like outside enumeration. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "db/sysdb.h"
+#include "tests/common.h"
+#include "tests/bench_common.h"
+
+#define TESTS_PATH          "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB        "tests_conf.ldb"
+#define TEST_DOM_NAME       "sysdb_store_bench"
+#define TEST_ID_PROVIDER    "ldap"
+
+#define DEFAULT_USERS       10000
+#define BENCH_BASE_ID       10000
+#define BENCH_TIMEOUT       3600
+
+enum bench_store_case {
+    BENCH_STORE_NEW,
+    BENCH_STORE_UNCHANGED,
+    BENCH_STORE_CHANGED,
+};
+
+struct bench_ctx {
+    struct sss_test_ctx *tctx;
+    char **names;
+    int num_users;
+};
+
+static errno_t bench_store_one(struct bench_ctx *bctx, int i,
+                               enum bench_store_case store_case,
+                               time_t now)
+{
+    struct sss_domain_info *dom = bctx->tctx->dom;
+    struct sysdb_attrs *attrs;
+    const char *gecos;
+    errno_t ret;
+
+    attrs = sysdb_new_attrs(bctx);
+    if (attrs == NULL) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_attrs_add_string(attrs, SYSDB_ORIG_MODSTAMP,
+                                 store_case == BENCH_STORE_CHANGED
+                                        ? "20240102000000Z"
+                                        : "20240101000000Z");
+    if (ret != EOK) {
+        goto done;
+    }
+
+    gecos = store_case == BENCH_STORE_CHANGED ? "Changed" : bctx->names[i];
+
+    ret = sysdb_store_user(dom, bctx->names[i], NULL,
+                           BENCH_BASE_ID + i, BENCH_BASE_ID + i,
+                           gecos, "/home/bench", "/bin/sh", NULL,
+                           attrs, NULL, BENCH_TIMEOUT, now);
+
+done:
+    talloc_free(attrs);
+    return ret;
+}
+
+static errno_t bench_run(struct bench_ctx *bctx, const char *name,
+                         enum bench_store_case store_case)
+{
+    struct bench_timer timer;
+    time_t now = time(NULL);
+    errno_t ret;
+    int i;
+
+    bench_timer_start(&timer);
+    for (i = 0; i < bctx->num_users; i++) {
+        ret = bench_store_one(bctx, i, store_case, now);
+        if (ret != EOK) {
+            fprintf(stderr, "Unable to store %s [%d]: %s\n",
+                    bctx->names[i], ret, sss_strerror(ret));
+            return ret;
+        }
+    }
+    bench_timer_stop(&timer);
+
+    bench_report("sysdb_store_user", name, bctx->num_users,
+                 bench_timer_ns_per_op(&timer, bctx->num_users));
+    return EOK;
+}
+
+int main(int argc, const char *argv[])
+{
+    int pc_users = DEFAULT_USERS;
+    struct bench_ctx *bctx;
+    poptContext pc;
+    int opt;
+    int ret;
+    int i;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "users", 'u', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                   &pc_users, 0,
+                   "Number of stored users", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_users < 1) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    test_dom_suite_setup(TESTS_PATH);
+
+    bctx = talloc_zero(NULL, struct bench_ctx);
+    if (bctx == NULL) {
+        return 2;
+    }
+
+    bctx->tctx = create_dom_test_ctx(bctx, TESTS_PATH, TEST_CONF_DB,
+                                     TEST_DOM_NAME, TEST_ID_PROVIDER, NULL);
+    if (bctx->tctx == NULL) {
+        fprintf(stderr, "Unable to set up the cache\n");
+        ret = EIO;
+        goto done;
+    }
+
+    bctx->names = talloc_array(bctx, char *, pc_users);
+    if (bctx->names == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < pc_users; i++) {
+        bctx->names[i] = talloc_asprintf(bctx->names, "user%d@%s", i,
+                                         bctx->tctx->dom->name);
+        if (bctx->names[i] == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+    bctx->num_users = pc_users;
+
+    ret = bench_run(bctx, "new", BENCH_STORE_NEW);
+    if (ret == EOK) {
+        ret = bench_run(bctx, "unchanged", BENCH_STORE_UNCHANGED);
+    }
+    if (ret == EOK) {
+        ret = bench_run(bctx, "changed", BENCH_STORE_CHANGED);
+    }
+
+done:
+    talloc_free(bctx);
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    return ret == EOK ? 0 : 2;
+}
@@ -244,6 +244,7 @@ run_requests(struct tool_ctx *tool_ctx,
     struct tcurl_ctx *tcurl_ctx;
     struct tevent_context *ev;
     struct tevent_req *req;
+    struct tcurl_stats stats;
     errno_t ret;
     int i;
 
@@ -294,6 +295,16 @@ run_requests(struct tool_ctx *tool_ctx,
         goto done;
     }
 
+    if (tool_ctx->verbose) {
+        tcurl_get_stats(tcurl_ctx, &stats);
+        printf("Requests: %"PRIu64", failed: %"PRIu64", "
+               "new connections: %"PRIu64"\n",
+               stats.requests, stats.failures, stats.connects);
+        printf("Average latency: %"PRIu64" usecs, maximum: %"PRIu64" usecs\n",
+               stats.requests > 0 ? stats.usecs / stats.requests : 0,
+               stats.max_usecs);
+    }
+
     ret = EOK;
 
 done:
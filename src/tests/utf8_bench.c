@@ -0,0 +1,284 @@
+/*
+   SSSD
+
+   UTF-8 case folding benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Times the case-insensitive comparison, case folding and lower casing of
+ * user names, once with ASCII names and once with names that contain a
+ * non-ASCII letter and take the unicode library path. With libunistring
+ * the library calls are timed as well as a reference. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <popt.h>
+#include <talloc.h>
+
+#ifdef HAVE_LIBUNISTRING
+#include <unistr.h>
+#include <unicase.h>
+#endif
+
+#include "util/util.h"
+#include "util/sss_utf8.h"
+
+#define DEFAULT_NAMES       1000
+#define DEFAULT_ITERATIONS  1000000
+#define BENCH_NAME_LEN      64
+
+static double timespec_diff(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec)
+           + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Upper and lower case spellings of the same names, the non-ASCII ones
+ * begin with U+00DC and U+00FC */
+static errno_t bench_names(TALLOC_CTX *mem_ctx, int num_names, bool ascii,
+                           char ***_upper, char ***_lower)
+{
+    char **upper;
+    char **lower;
+    int i;
+
+    upper = talloc_array(mem_ctx, char *, num_names);
+    lower = talloc_array(mem_ctx, char *, num_names);
+    if (upper == NULL || lower == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_names; i++) {
+        upper[i] = talloc_asprintf(upper, "%sSER%d@AD.EXAMPLE.COM",
+                                   ascii ? "U" : "\xc3\x9c", i);
+        lower[i] = talloc_asprintf(lower, "%sser%d@ad.example.com",
+                                   ascii ? "u" : "\xc3\xbc", i);
+        if (upper[i] == NULL || lower[i] == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    *_upper = upper;
+    *_lower = lower;
+    return EOK;
+}
+
+static double bench_case_eq(char **upper, char **lower, int num_names,
+                            int iterations)
+{
+    struct timespec start;
+    struct timespec end;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        if (sss_utf8_case_eq((const uint8_t *)upper[i % num_names],
+                             (const uint8_t *)lower[i % num_names]) != EOK) {
+            fprintf(stderr, "Unexpected mismatch of %s\n",
+                    upper[i % num_names]);
+            return -1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return timespec_diff(&start, &end) * 1e9 / iterations;
+}
+
+static double bench_case_fold(char **upper, int num_names, int iterations)
+{
+    struct timespec start;
+    struct timespec end;
+    uint8_t *folded;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        if (sss_utf8_case_fold((const uint8_t *)upper[i % num_names],
+                               &folded) != EOK) {
+            return -1;
+        }
+        free(folded);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return timespec_diff(&start, &end) * 1e9 / iterations;
+}
+
+static double bench_tolower(char **upper, int num_names, int iterations)
+{
+    struct timespec start;
+    struct timespec end;
+    char *lower;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        lower = sss_tc_utf8_str_tolower(NULL, upper[i % num_names]);
+        if (lower == NULL) {
+            return -1;
+        }
+        talloc_free(lower);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return timespec_diff(&start, &end) * 1e9 / iterations;
+}
+
+#ifdef HAVE_LIBUNISTRING
+/* The library calls the functions made before looking for ASCII */
+static double bench_ref_case_eq(char **upper, char **lower, int num_names,
+                                int iterations)
+{
+    struct timespec start;
+    struct timespec end;
+    const uint8_t *s1;
+    const uint8_t *s2;
+    int result;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        s1 = (const uint8_t *)upper[i % num_names];
+        s2 = (const uint8_t *)lower[i % num_names];
+        if (u8_casecmp(s1, u8_strlen(s1), s2, u8_strlen(s2), NULL, NULL,
+                       &result) < 0 || result != 0) {
+            return -1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return timespec_diff(&start, &end) * 1e9 / iterations;
+}
+
+static double bench_ref_tolower(char **upper, int num_names, int iterations)
+{
+    struct timespec start;
+    struct timespec end;
+    uint8_t *lower;
+    char *copy;
+    size_t len;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        lower = u8_tolower((const uint8_t *)upper[i % num_names],
+                           strlen(upper[i % num_names]) + 1,
+                           NULL, NULL, NULL, &len);
+        if (lower == NULL) {
+            return -1;
+        }
+        copy = talloc_strdup(NULL, (const char *)lower);
+        free(lower);
+        talloc_free(copy);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return timespec_diff(&start, &end) * 1e9 / iterations;
+}
+#endif /* HAVE_LIBUNISTRING */
+
+static int bench_run(int num_names, int iterations, bool ascii)
+{
+    TALLOC_CTX *tmp_ctx;
+    char **upper;
+    char **lower;
+    double t_eq;
+    double t_fold;
+    double t_lower;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return 1;
+    }
+
+    ret = bench_names(tmp_ctx, num_names, ascii, &upper, &lower);
+    if (ret != EOK) {
+        talloc_free(tmp_ctx);
+        return 1;
+    }
+
+    t_eq = bench_case_eq(upper, lower, num_names, iterations);
+    t_fold = bench_case_fold(upper, num_names, iterations);
+    t_lower = bench_tolower(upper, num_names, iterations);
+    if (t_eq < 0 || t_fold < 0 || t_lower < 0) {
+        talloc_free(tmp_ctx);
+        return 1;
+    }
+
+    printf("%-10s %10.1f %10.1f %10.1f\n", ascii ? "ascii" : "non-ascii",
+           t_eq, t_fold, t_lower);
+
+#ifdef HAVE_LIBUNISTRING
+    t_eq = bench_ref_case_eq(upper, lower, num_names, iterations);
+    t_lower = bench_ref_tolower(upper, num_names, iterations);
+    if (t_eq < 0 || t_lower < 0) {
+        talloc_free(tmp_ctx);
+        return 1;
+    }
+
+    printf("%-10s %10.1f %10s %10.1f\n", "  library", t_eq, "-", t_lower);
+#endif
+
+    talloc_free(tmp_ctx);
+    return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+    int pc_names = DEFAULT_NAMES;
+    int pc_iterations = DEFAULT_ITERATIONS;
+    poptContext pc;
+    int opt;
+
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "names", 'n', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                        &pc_names, 0,
+                        "Number of different names", NULL },
+        { "iterations", 'i', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+                             &pc_iterations, 0,
+                             "Calls of each function", NULL },
+        POPT_TABLEEND
+    };
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return 1;
+    }
+
+    if (pc_names < 1 || pc_iterations < 1) {
+        poptPrintUsage(pc, stderr, 0);
+        poptFreeContext(pc);
+        return 1;
+    }
+    poptFreeContext(pc);
+
+    printf("%-10s %10s %10s %10s\n", "names", "eq ns", "fold ns",
+           "lower ns");
+
+    if (bench_run(pc_names, pc_iterations, true) != 0
+            || bench_run(pc_names, pc_iterations, false) != 0) {
+        return 2;
+    }
+
+    return 0;
+}
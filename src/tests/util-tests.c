@@ -35,6 +35,7 @@
 #include "util/util.h"
 #include "util/sss_utf8.h"
 #include "shared/murmurhash3.h"
+#include "shared/wyhash.h"
 #include "tests/common_check.h"
 
 #define FILENAME_TEMPLATE "tests-atomicio-XXXXXX"
@@ -488,6 +489,11 @@ START_TEST(test_utf8_talloc_str_lowercase)
     lcase = sss_tc_utf8_str_tolower(test_ctx, munchen_utf8_upcase);
     fail_if(memcmp(lcase, munchen_utf8_lowcase, strlen(lcase)),
             "Unexpected binary values");
+
+    lcase = sss_tc_utf8_str_tolower(test_ctx, "Domain Users@AD.Example.COM");
+    fail_if(lcase == NULL, "Failed to lower case an ASCII string");
+    fail_unless(strcmp(lcase, "domain users@ad.example.com") == 0,
+                "Unexpected lower case string [%s]", lcase);
     talloc_free(test_ctx);
 }
 END_TEST
@@ -509,6 +515,61 @@ START_TEST(test_utf8_caseeq)
 
     ret = sss_utf8_case_eq(czech_utf8_upcase, czech_utf8_lowcase_neg);
     fail_if(ret == EOK, "Negative test succeeded\n");
+
+    ret = sss_utf8_case_eq((const uint8_t *)"Administrator@EXAMPLE.com",
+                           (const uint8_t *)"administrator@example.COM");
+    fail_unless(ret == EOK, "ASCII comparison failed\n");
+
+    ret = sss_utf8_case_eq((const uint8_t *)"Administrator@EXAMPLE.com",
+                           (const uint8_t *)"administrator@example.COMX");
+    fail_if(ret == EOK, "ASCII negative test succeeded\n");
+
+    /* Only letters are folded, [ and { differ by the case bit too */
+    ret = sss_utf8_case_eq((const uint8_t *)"user[1]@example",
+                           (const uint8_t *)"user{1}@example");
+    fail_if(ret == EOK, "ASCII punctuation test succeeded\n");
+
+    /* Mixed strings are compared by the unicode library */
+    ret = sss_utf8_case_eq((const uint8_t *)"munchen",
+                           munchen_utf8_lowcase);
+    fail_if(ret == EOK, "Mixed negative test succeeded\n");
+}
+END_TEST
+
+START_TEST(test_utf8_ascii)
+{
+    const uint8_t munchen_utf8_upcase[] = { 'M', 0xC3, 0x9C, 'N', 'C', 'H', 'E', 'N', 0x0 };
+    const char *ascii = "@AZ[`az{ Group-Name_01.EXAMPLE.COM";
+    const char *lower = "@az[`az{ group-name_01.example.com";
+    char buf[64];
+    size_t len;
+    size_t i;
+
+    len = strlen(ascii);
+    fail_unless(sss_utf8_is_ascii((const uint8_t *)ascii, len),
+                "ASCII string not detected\n");
+    fail_unless(sss_utf8_is_ascii((const uint8_t *)ascii, 0),
+                "Empty string not detected\n");
+    fail_if(sss_utf8_is_ascii(munchen_utf8_upcase,
+                              sizeof(munchen_utf8_upcase) - 1),
+            "Non-ASCII string detected as ASCII\n");
+
+    /* a high byte is found at any position */
+    for (i = 0; i < len; i++) {
+        memcpy(buf, ascii, len + 1);
+        buf[i] |= 0x80;
+        fail_if(sss_utf8_is_ascii((const uint8_t *)buf, len),
+                "High byte at %zu not detected\n", i);
+    }
+
+    /* all the lengths go through the words and the remaining bytes */
+    for (i = 0; i <= len; i++) {
+        memcpy(buf, ascii, len + 1);
+        sss_utf8_ascii_tolower((uint8_t *)buf, i);
+        fail_unless(strncmp(buf, lower, i) == 0
+                        && strcmp(buf + i, ascii + i) == 0,
+                    "Unexpected lower case string [%s]\n", buf);
+    }
 }
 END_TEST
 
@@ -574,6 +635,53 @@ START_TEST(test_murmurhash3_random)
 }
 END_TEST
 
+START_TEST(test_wyhash32_check)
+{
+    const char *tests[6] = { "1052800007", "1052800008", "1052800000",
+                             "abcdefghijk", "abcdefghili", "abcdefgh000" };
+    uint32_t results[6];
+    int i, j;
+
+    for (i = 0; i< 6; i++) {
+        results[i] = wyhash32(tests[i], strlen(tests[i]), 0xdeadbeef);
+        for (j = 0; j < i; j++) {
+            fail_if(results[i] == results[j],
+                    "Values have to be different. '%"PRIu32"' == '%"PRIu32"'",
+                    results[i], results[j]);
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_wyhash32_values)
+{
+    /* The hashes are stored in the memory cache files, they must not change
+     * between versions or architectures. The keys cover the short, the
+     * medium and the long key paths. */
+    struct {
+        const char *key;
+        uint32_t hash;
+    } tests[] = {
+        { "", 0x29279731 },
+        { "abc", 0xcf22270a },
+        { "1052800007", 0x2fada4a7 },
+        { "abcdefghijklmnopqrstuvwxyz012345", 0xa889a066 },
+        { "The quick brown fox jumps over the lazy dog, "
+          "then the lazy dog sleeps in the sun.", 0xa9a9f0b8 },
+        { NULL, 0 }
+    };
+    uint32_t result;
+    int i;
+
+    for (i = 0; tests[i].key != NULL; i++) {
+        result = wyhash32(tests[i].key, strlen(tests[i].key), 0xdeadbeef);
+        fail_unless(result == tests[i].hash,
+                    "Unexpected hash of '%s': '%"PRIu32"' != '%"PRIu32"'",
+                    tests[i].key, result, tests[i].hash);
+    }
+}
+END_TEST
+
 void setup_atomicio(void)
 {
     int ret;
@@ -1133,12 +1241,17 @@ Suite *util_suite(void)
     tcase_add_test (tc_utf8, test_utf8_talloc_str_lowercase);
     tcase_add_test (tc_utf8, test_utf8_caseeq);
     tcase_add_test (tc_utf8, test_utf8_check);
+    tcase_add_test (tc_utf8, test_utf8_ascii);
 
     tcase_set_timeout(tc_utf8, 60);
 
     TCase *tc_mh3 = tcase_create("murmurhash3");
     tcase_add_test (tc_mh3, test_murmurhash3_check);
     tcase_add_test (tc_mh3, test_murmurhash3_random);
+
+    TCase *tc_wyhash = tcase_create("wyhash");
+    tcase_add_test (tc_wyhash, test_wyhash32_check);
+    tcase_add_test (tc_wyhash, test_wyhash32_values);
     tcase_set_timeout(tc_mh3, 60);
 
     TCase *tc_atomicio = tcase_create("atomicio");
@@ -1164,6 +1277,7 @@ Suite *util_suite(void)
     suite_add_tcase (s, tc_util);
     suite_add_tcase (s, tc_utf8);
     suite_add_tcase (s, tc_mh3);
+    suite_add_tcase (s, tc_wyhash);
     suite_add_tcase (s, tc_atomicio);
     suite_add_tcase (s, tc_convert_time);
     suite_add_tcase (s, tc_sss_strerror);
@@ -447,14 +447,55 @@ static errno_t update_all_filters(struct cache_tool_ctx *tctx,
     return EOK;
 }
 
+struct invalidate_names {
+    const char **names;
+    size_t count;
+    size_t alloc;
+};
+
+static errno_t invalidate_names_add(struct invalidate_names *names,
+                                    const char *name)
+{
+    if (names->count == names->alloc) {
+        names->alloc = MAX(64, names->alloc * 2);
+        names->names = talloc_realloc(names, names->names, const char *,
+                                      names->alloc);
+        if (names->names == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    names->names[names->count++] = name;
+    return EOK;
+}
+
+/* Keeps only the names of the users and groups to invalidate, not the
+ * whole entries */
+static errno_t invalidate_names_collect(struct ldb_message *msg, void *pvt)
+{
+    struct invalidate_names *names = pvt;
+    const char *name;
+
+    name = ldb_msg_find_attr_as_string(msg, SYSDB_NAME, NULL);
+    if (name != NULL) {
+        name = talloc_strdup(names, name);
+        if (name == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    return invalidate_names_add(names, name);
+}
+
 static bool invalidate_entries(TALLOC_CTX *ctx,
                                struct sss_domain_info *dinfo,
                                enum sss_cache_entry entry_type,
                                const char *filter, const char *name)
 {
     const char *attrs[] = {SYSDB_NAME, NULL};
-    size_t msg_count;
-    struct ldb_message **msgs;
+    struct invalidate_names *names;
+    size_t msg_count = 0;
+    struct ldb_message **msgs = NULL;
     const char *type_string = "unknown";
     errno_t ret = EINVAL;
     int i;
@@ -462,16 +503,38 @@ static bool invalidate_entries(TALLOC_CTX *ctx,
     bool iret;
 
     if (!filter) return false;
+
+    /* All users or groups are invalidated without touching the entries */
+    if (name == NULL && (entry_type == TYPE_USER || entry_type == TYPE_GROUP)) {
+        type_string = entry_type == TYPE_USER ? "users" : "groups";
+        ret = sysdb_invalidate_type(dinfo, entry_type == TYPE_USER ?
+                                           SYSDB_MEMBER_USER :
+                                           SYSDB_MEMBER_GROUP);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to invalidate all %s of "
+                  "domain %s [%d]: %s\n", type_string, dinfo->name,
+                  ret, sss_strerror(ret));
+            ERROR("Couldn't invalidate %1$s\n", type_string);
+            return false;
+        }
+        return true;
+    }
+
+    names = talloc_zero(ctx, struct invalidate_names);
+    if (names == NULL) {
+        return false;
+    }
+
     switch (entry_type) {
     case TYPE_USER:
         type_string = "user";
-        ret = sysdb_search_users(ctx, dinfo,
-                                 filter, attrs, &msg_count, &msgs);
+        ret = sysdb_search_users_stream(dinfo, filter, attrs,
+                                        invalidate_names_collect, names);
         break;
     case TYPE_GROUP:
         type_string = "group";
-        ret = sysdb_search_groups(ctx, dinfo,
-                                  filter, attrs, &msg_count, &msgs);
+        ret = sysdb_search_groups_stream(dinfo, filter, attrs,
+                                         invalidate_names_collect, names);
         break;
     case TYPE_NETGROUP:
         type_string = "netgroup";
@@ -511,6 +574,7 @@ static bool invalidate_entries(TALLOC_CTX *ctx,
         if (ret == ENOENT) {
             DEBUG(SSSDBG_TRACE_FUNC, "'%s' %s: Not found in domain '%s'\n",
                   type_string, name ? name : "", dinfo->name);
+            talloc_free(names);
             if (name == NULL) {
                 /* nothing to invalidate in that domain, no reason to fail */
                 return true;
@@ -523,12 +587,25 @@ static bool invalidate_entries(TALLOC_CTX *ctx,
                   "Searching for %s in domain %s with filter %s failed\n",
                    type_string, dinfo->name, filter);
         }
+        talloc_free(names);
         return false;
     }
 
-    iret = true;
     for (i = 0; i < msg_count; i++) {
-        c_name = ldb_msg_find_attr_as_string(msgs[i], SYSDB_NAME, NULL);
+        ret = invalidate_names_add(names,
+                                   ldb_msg_find_attr_as_string(msgs[i],
+                                                               SYSDB_NAME,
+                                                               NULL));
+        if (ret != EOK) {
+            talloc_free(names);
+            talloc_zfree(msgs);
+            return false;
+        }
+    }
+
+    iret = true;
+    for (i = 0; i < names->count; i++) {
+        c_name = names->names[i];
         if (c_name == NULL) {
             DEBUG(SSSDBG_MINOR_FAILURE,
                   "Something bad happened, can't find attribute %s\n",
@@ -546,6 +623,7 @@ static bool invalidate_entries(TALLOC_CTX *ctx,
         }
     }
     talloc_zfree(msgs);
+    talloc_free(names);
     return iret;
 }
 
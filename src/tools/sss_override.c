@@ -25,10 +25,14 @@
 #include "db/sysdb.h"
 #include "tools/common/sss_tools.h"
 #include "tools/common/sss_colondb.h"
+#include "tools/tools_util.h"
 
 #define LOCALVIEW SYSDB_LOCAL_VIEW_NAME
 #define ORIGNAME "originalName"
 
+/* Number of imported overrides stored in one sysdb transaction */
+#define OVERRIDE_IMPORT_BATCH 1000
+
 struct override_user {
     const char *input_name;
     const char *orig_name;
@@ -54,6 +58,19 @@ struct override_group {
     gid_t gid;
 };
 
+/* State of user-import and group-import. The overrides are stored in
+ * batches, each in a single transaction of the sysdb of their domain, and
+ * the view of each sysdb is only checked once. */
+struct override_import {
+    struct sysdb_ctx *sysdb;
+    size_t batch;
+    size_t imported;
+    size_t committed;
+
+    struct sysdb_ctx **prepared;
+    size_t num_prepared;
+};
+
 static errno_t parse_cmdline(struct sss_cmdline *cmdline,
                              struct sss_tool_ctx *tool_ctx,
                              struct poptOption *options,
@@ -769,7 +786,141 @@ static errno_t override_fqn(TALLOC_CTX *mem_ctx,
     return ret;
 }
 
+static errno_t override_import_commit(struct override_import *import)
+{
+    errno_t ret;
+
+    if (import->sysdb == NULL) {
+        return EOK;
+    }
+
+    ret = sysdb_transaction_commit(import->sysdb);
+    import->sysdb = NULL;
+    import->batch = 0;
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to commit transaction\n");
+        return ret;
+    }
+
+    import->committed = import->imported;
+    DEBUG(SSSDBG_TRACE_FUNC, "%zu overrides imported.\n", import->committed);
+    return EOK;
+}
+
+static void override_import_cancel(struct override_import *import)
+{
+    errno_t ret;
+
+    if (import->sysdb == NULL) {
+        return;
+    }
+
+    ret = sysdb_transaction_cancel(import->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not cancel transaction\n");
+    }
+
+    import->sysdb = NULL;
+    import->batch = 0;
+    import->imported = import->committed;
+}
+
+static errno_t override_import_prepare(struct override_import *import,
+                                       struct sss_domain_info *domain)
+{
+    struct sysdb_ctx **prepared;
+    size_t c;
+    errno_t ret;
+
+    for (c = 0; c < import->num_prepared; c++) {
+        if (import->prepared[c] == domain->sysdb) {
+            return EOK;
+        }
+    }
+
+    ret = prepare_view_msg(domain);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    prepared = talloc_realloc(import, import->prepared, struct sysdb_ctx *,
+                              import->num_prepared + 1);
+    if (prepared == NULL) {
+        return ENOMEM;
+    }
+    prepared[import->num_prepared] = domain->sysdb;
+    import->prepared = prepared;
+    import->num_prepared++;
+
+    return EOK;
+}
+
+/* Makes sure a transaction of the sysdb of @domain is open for the next
+ * override */
+static errno_t override_import_begin(struct override_import *import,
+                                     struct sss_domain_info *domain)
+{
+    errno_t ret;
+
+    if (import->sysdb != NULL && (import->sysdb != domain->sysdb
+                                  || import->batch >= OVERRIDE_IMPORT_BATCH)) {
+        ret = override_import_commit(import);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    if (import->sysdb != NULL) {
+        return EOK;
+    }
+
+    /* the view is stored in its own transaction */
+    ret = override_import_prepare(import, domain);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sysdb_transaction_start(domain->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "sysdb_transaction_start() failed.\n");
+        return ret;
+    }
+    import->sysdb = domain->sysdb;
+
+    return EOK;
+}
+
+static errno_t override_import_finish(struct override_import *import,
+                                      errno_t ret)
+{
+    errno_t mc_ret;
+
+    if (ret == EOK) {
+        ret = override_import_commit(import);
+    }
+
+    if (ret != EOK) {
+        override_import_cancel(import);
+        if (import->committed > 0) {
+            ERROR("Only the first %zu overrides were imported.\n",
+                  import->committed);
+        }
+    }
+
+    if (import->committed > 0) {
+        /* once for all the imported objects */
+        mc_ret = sss_memcache_clear_all();
+        if (mc_ret != EOK) {
+            ERROR("Unable to invalidate the memory cache, run "
+                  "'sss_cache -E' to make the overrides visible.\n");
+        }
+    }
+
+    return ret;
+}
+
 static errno_t override_user(struct sss_tool_ctx *tool_ctx,
+                             struct override_import *import,
                              struct override_user *input_user)
 {
     TALLOC_CTX *tmp_ctx;
@@ -791,12 +942,16 @@ static errno_t override_user(struct sss_tool_ctx *tool_ctx,
         goto done;
     }
 
-    ret = prepare_view_msg(user.domain);
+    if (import != NULL) {
+        ret = override_import_begin(import, user.domain);
+    } else {
+        ret = prepare_view_msg(user.domain);
+    }
     if (ret != EOK) {
         goto done;
     }
 
-    attrs = build_user_attrs(tool_ctx, &user);
+    attrs = build_user_attrs(tmp_ctx, &user);
     if (attrs == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to build sysdb attrs.\n");
         ret = ENOMEM;
@@ -810,6 +965,11 @@ static errno_t override_user(struct sss_tool_ctx *tool_ctx,
         goto done;
     }
 
+    if (import != NULL) {
+        import->batch++;
+        import->imported++;
+    }
+
     ret = EOK;
 
 done:
@@ -818,6 +978,7 @@ done:
 }
 
 static errno_t override_group(struct sss_tool_ctx *tool_ctx,
+                              struct override_import *import,
                               struct override_group *input_group)
 {
     TALLOC_CTX *tmp_ctx;
@@ -840,12 +1001,16 @@ static errno_t override_group(struct sss_tool_ctx *tool_ctx,
         goto done;
     }
 
-    ret = prepare_view_msg(group.domain);
+    if (import != NULL) {
+        ret = override_import_begin(import, group.domain);
+    } else {
+        ret = prepare_view_msg(group.domain);
+    }
     if (ret != EOK) {
         goto done;
     }
 
-    attrs = build_group_attrs(tool_ctx, &group);
+    attrs = build_group_attrs(tmp_ctx, &group);
     if (attrs == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to build sysdb attrs.\n");
         ret = ENOMEM;
@@ -859,6 +1024,11 @@ static errno_t override_group(struct sss_tool_ctx *tool_ctx,
         goto done;
     }
 
+    if (import != NULL) {
+        import->batch++;
+        import->imported++;
+    }
+
     ret = EOK;
 
 done:
@@ -938,6 +1108,12 @@ static errno_t override_object_del(struct sss_domain_info *domain,
         goto done;
     }
 
+    ret = sysdb_clear_merged_override(msg);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "sysdb_clear_merged_override() failed\n");
+        goto done;
+    }
+
     ret = ldb_modify(ldb, msg);
     if (ret != LDB_SUCCESS && ret != LDB_ERR_NO_SUCH_ATTRIBUTE) {
         DEBUG(SSSDBG_OP_FAILURE,
@@ -1424,7 +1600,7 @@ static int override_user_add(struct sss_cmdline *cmdline,
         return ret;
     }
 
-    ret = override_user(tool_ctx, &user);
+    ret = override_user(tool_ctx, NULL, &user);
     if (ret != EOK) {
         return ret;
     }
@@ -1566,6 +1742,7 @@ static int override_user_import(struct sss_cmdline *cmdline,
     struct sss_colondb *db;
     const char *filename;
     struct override_user obj = {0};
+    struct override_import *import = NULL;
     int linenum = 1;
     errno_t ret;
 
@@ -1603,10 +1780,16 @@ static int override_user_import(struct sss_cmdline *cmdline,
         goto done;
     }
 
+    import = talloc_zero(NULL, struct override_import);
+    if (import == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
     while ((ret = sss_colondb_readline(tmp_ctx, db, table)) == EOK) {
         linenum++;
 
-        ret = sss_tool_parse_name(tool_ctx, tool_ctx, obj.input_name,
+        ret = sss_tool_parse_name(tmp_ctx, tool_ctx, obj.input_name,
                                   &obj.orig_name, &obj.domain);
         if (ret != EOK) {
             ERROR("Unable to parse name %s.\n", obj.input_name);
@@ -1618,7 +1801,7 @@ static int override_user_import(struct sss_cmdline *cmdline,
             goto done;
         }
 
-        ret = override_user(tool_ctx, &obj);
+        ret = override_user(tool_ctx, import, &obj);
         if (ret != EOK) {
             goto done;
         }
@@ -1635,6 +1818,10 @@ static int override_user_import(struct sss_cmdline *cmdline,
     ret = EOK;
 
 done:
+    if (import != NULL) {
+        ret = override_import_finish(import, ret);
+        talloc_free(import);
+    }
     talloc_free(tmp_ctx);
     return ret;
 }
@@ -1679,7 +1866,7 @@ static int override_group_add(struct sss_cmdline *cmdline,
         return ret;
     }
 
-    ret = override_group(tool_ctx, &group);
+    ret = override_group(tool_ctx, NULL, &group);
     if (ret != EOK) {
         return ret;
     }
@@ -1822,6 +2009,7 @@ static int override_group_import(struct sss_cmdline *cmdline,
     struct sss_colondb *db;
     const char *filename;
     struct override_group obj = {0};
+    struct override_import *import = NULL;
     int linenum = 1;
     errno_t ret;
 
@@ -1854,10 +2042,16 @@ static int override_group_import(struct sss_cmdline *cmdline,
         goto done;
     }
 
+    import = talloc_zero(NULL, struct override_import);
+    if (import == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
     while ((ret = sss_colondb_readline(tmp_ctx, db, table)) == EOK) {
         linenum++;
 
-        ret = sss_tool_parse_name(tool_ctx, tool_ctx, obj.input_name,
+        ret = sss_tool_parse_name(tmp_ctx, tool_ctx, obj.input_name,
                                   &obj.orig_name, &obj.domain);
         if (ret != EOK) {
             ERROR("Unable to parse name %s.\n", obj.input_name);
@@ -1869,7 +2063,7 @@ static int override_group_import(struct sss_cmdline *cmdline,
             goto done;
         }
 
-        ret = override_group(tool_ctx, &obj);
+        ret = override_group(tool_ctx, import, &obj);
         if (ret != EOK) {
             goto done;
         }
@@ -1886,6 +2080,10 @@ static int override_group_import(struct sss_cmdline *cmdline,
     ret = EOK;
 
 done:
+    if (import != NULL) {
+        ret = override_import_finish(import, ret);
+        talloc_free(import);
+    }
     talloc_free(tmp_ctx);
     return ret;
 }
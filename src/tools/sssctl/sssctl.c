@@ -275,10 +275,17 @@ int main(int argc, const char **argv)
         SSS_TOOL_COMMAND("cache-remove", "Backup local data and remove cached content", 0, sssctl_cache_remove),
         SSS_TOOL_COMMAND("cache-upgrade", "Perform cache upgrade", ERR_SYSDB_VERSION_TOO_OLD, sssctl_cache_upgrade),
         SSS_TOOL_COMMAND("cache-expire", "Invalidate cached objects", 0, sssctl_cache_expire),
+        SSS_TOOL_COMMAND("cache-export", "Export the cache of a domain", 0, sssctl_cache_export),
+        SSS_TOOL_COMMAND("cache-import", "Import the cache of a domain", 0, sssctl_cache_import),
+        SSS_TOOL_COMMAND("memcache-stats", "Print memory cache statistics", 0, sssctl_memcache_stats),
+        SSS_TOOL_COMMAND("responder-stats", "Print latency statistics of responder commands", 0, sssctl_responder_stats),
+        SSS_TOOL_COMMAND_FLAGS("perf", "Measure the throughput and latency of lookups", 0, sssctl_perf, SSS_TOOL_FLAG_SKIP_CMD_INIT),
         SSS_TOOL_DELIMITER("Log files tools:"),
         SSS_TOOL_COMMAND("logs-remove", "Remove existing SSSD log files", 0, sssctl_logs_remove),
         SSS_TOOL_COMMAND("logs-fetch", "Archive SSSD log files in tarball", 0, sssctl_logs_fetch),
         SSS_TOOL_COMMAND("debug-level", "Change SSSD debug level", 0, sssctl_debug_level),
+        SSS_TOOL_COMMAND("debug-backtrace", "Write the recent debug messages of SSSD processes to the logs", 0, sssctl_debug_backtrace),
+        SSS_TOOL_COMMAND("debug-profile", "Start or stop profiling SSSD processes", 0, sssctl_debug_profile),
 #ifdef HAVE_LIBINI_CONFIG_V1_3
         SSS_TOOL_DELIMITER("Configuration files tools:"),
         SSS_TOOL_COMMAND_FLAGS("config-check", "Perform static analysis of SSSD configuration", 0, sssctl_config_check, SSS_TOOL_FLAG_SKIP_CMD_INIT),
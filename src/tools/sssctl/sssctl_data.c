@@ -20,6 +20,8 @@
 
 #include <popt.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
 
 #include "util/util.h"
 #include "db/sysdb.h"
@@ -288,6 +290,13 @@ errno_t sssctl_cache_upgrade(struct sss_cmdline *cmdline,
         return ret;
     }
 
+    /* SSSD is not running, the next start does not need to validate the
+     * caches written by the upgrade */
+    ret = sysdb_mark_clean_shutdown(tool_ctx->domains, DB_PATH);
+    if (ret != EOK) {
+        return ret;
+    }
+
     return EOK;
 }
 
@@ -333,3 +342,490 @@ done:
 
     return ret;
 }
+
+/* A cache bundle is a short text header followed by the cache file and the
+ * timestamp cache file of one domain, as they are on disk. */
+#define SSSCTL_BUNDLE_MAGIC "SSSD cache bundle"
+#define SSSCTL_BUNDLE_VERSION 1
+
+struct sssctl_export_ctx {
+    const char *domain;
+    FILE *out;
+};
+
+static errno_t sssctl_file_size(const char *path, uint64_t *_size)
+{
+    struct stat st;
+    errno_t ret;
+
+    if (path == NULL) {
+        *_size = 0;
+        return EOK;
+    }
+
+    ret = stat(path, &st);
+    if (ret != 0) {
+        ret = errno;
+        ERROR("Unable to access %s: %s\n", path, sss_strerror(ret));
+        return ret;
+    }
+
+    *_size = st.st_size;
+    return EOK;
+}
+
+static errno_t sssctl_copy_data(FILE *in, FILE *out, uint64_t size)
+{
+    char buf[64 * 1024];
+    size_t len;
+
+    while (size > 0) {
+        len = size < sizeof(buf) ? size : sizeof(buf);
+        if (fread(buf, 1, len, in) != len) {
+            return ferror(in) ? EIO : EINVAL;
+        }
+
+        if (fwrite(buf, 1, len, out) != len) {
+            return EIO;
+        }
+
+        size -= len;
+    }
+
+    return EOK;
+}
+
+static errno_t sssctl_export_file(const char *path, uint64_t size, FILE *out)
+{
+    FILE *in;
+    errno_t ret;
+
+    if (size == 0) {
+        return EOK;
+    }
+
+    in = fopen(path, "r");
+    if (in == NULL) {
+        ret = errno;
+        ERROR("Unable to open %s: %s\n", path, sss_strerror(ret));
+        return ret;
+    }
+
+    ret = sssctl_copy_data(in, out, size);
+    if (ret != EOK) {
+        ERROR("Unable to copy %s: %s\n", path, sss_strerror(ret));
+    }
+
+    fclose(in);
+    return ret;
+}
+
+static errno_t sssctl_export_files(const char *ldb_file,
+                                   const char *ts_file,
+                                   void *pvt)
+{
+    struct sssctl_export_ctx *ctx = pvt;
+    uint64_t ldb_size;
+    uint64_t ts_size;
+    errno_t ret;
+
+    ret = sssctl_file_size(ldb_file, &ldb_size);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sssctl_file_size(ts_file, &ts_size);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    fprintf(ctx->out, SSSCTL_BUNDLE_MAGIC "\n"
+                      "version: %d\n"
+                      "domain: %s\n"
+                      "exported: %lld\n"
+                      "cache: %"PRIu64"\n"
+                      "timestamps: %"PRIu64"\n"
+                      "\n",
+            SSSCTL_BUNDLE_VERSION, ctx->domain, (long long)time(NULL),
+            ldb_size, ts_size);
+
+    ret = sssctl_export_file(ldb_file, ldb_size, ctx->out);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return sssctl_export_file(ts_file, ts_size, ctx->out);
+}
+
+errno_t sssctl_cache_export(struct sss_cmdline *cmdline,
+                            struct sss_tool_ctx *tool_ctx,
+                            void *pvt)
+{
+    struct sssctl_export_ctx ctx = { 0 };
+    struct sss_domain_info *dom;
+    const char *domain = NULL;
+    const char *file = NULL;
+    errno_t ret;
+    int fd;
+
+    struct poptOption options[] = {
+        {"file", 'f', POPT_ARG_STRING, &file, 0, _("Write the bundle to FILE"), "FILE" },
+        POPT_TABLEEND
+    };
+
+    ret = sss_tool_popt_ex(cmdline, options, SSS_TOOL_OPT_REQUIRED,
+                           NULL, NULL, "DOMAIN", _("Specify domain name."),
+                           &domain, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        return ret;
+    }
+
+    if (file == NULL) {
+        ERROR("The bundle file must be given with --file\n");
+        return EINVAL;
+    }
+
+    dom = find_domain_by_name(tool_ctx->domains, domain, true);
+    if (dom == NULL || dom->sysdb == NULL) {
+        ERROR("Unable to find domain %s\n", domain);
+        return ENOENT;
+    }
+
+    fd = open(file, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        ret = errno;
+        ERROR("Unable to create %s: %s\n", file, sss_strerror(ret));
+        return ret;
+    }
+
+    ctx.domain = dom->name;
+    ctx.out = fdopen(fd, "w");
+    if (ctx.out == NULL) {
+        ret = errno;
+        close(fd);
+        goto done;
+    }
+
+    /* SSSD may keep running, the cache is locked while it is copied */
+    ret = sysdb_cache_files_locked(dom->sysdb, sssctl_export_files, &ctx);
+    if (fclose(ctx.out) != 0 && ret == EOK) {
+        ret = errno;
+    }
+
+done:
+    if (ret != EOK) {
+        ERROR("Unable to export the cache of %s: %s\n", dom->name,
+              sss_strerror(ret));
+        unlink(file);
+        return ret;
+    }
+
+    PRINT("The cache of %s was exported to %s\n", dom->name, file);
+    return EOK;
+}
+
+struct sssctl_bundle {
+    int version;
+    char *domain;
+    time_t exported;
+    uint64_t ldb_size;
+    uint64_t ts_size;
+};
+
+static errno_t sssctl_bundle_read_header(TALLOC_CTX *mem_ctx,
+                                         FILE *in,
+                                         struct sssctl_bundle **_bundle)
+{
+    struct sssctl_bundle *bundle;
+    char line[256];
+    char *value;
+    char *end;
+    size_t len;
+    bool magic = false;
+
+    bundle = talloc_zero(mem_ctx, struct sssctl_bundle);
+    if (bundle == NULL) {
+        return ENOMEM;
+    }
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        len = strlen(line);
+        if (len == 0 || line[len - 1] != '\n') {
+            break;
+        }
+        line[len - 1] = '\0';
+
+        if (!magic) {
+            if (strcmp(line, SSSCTL_BUNDLE_MAGIC) != 0) {
+                break;
+            }
+            magic = true;
+            continue;
+        }
+
+        if (line[0] == '\0') {
+            /* End of the header */
+            if (bundle->version == 0 || bundle->domain == NULL
+                    || bundle->ldb_size == 0) {
+                break;
+            }
+
+            *_bundle = bundle;
+            return EOK;
+        }
+
+        value = strchr(line, ':');
+        if (value == NULL || value[1] != ' ') {
+            break;
+        }
+        *value = '\0';
+        value += 2;
+
+        /* Unknown keys are skipped, newer versions may add some */
+        errno = 0;
+        if (strcmp(line, "version") == 0) {
+            bundle->version = strtol(value, &end, 10);
+        } else if (strcmp(line, "domain") == 0) {
+            bundle->domain = talloc_strdup(bundle, value);
+            if (bundle->domain == NULL) {
+                talloc_free(bundle);
+                return ENOMEM;
+            }
+            continue;
+        } else if (strcmp(line, "exported") == 0) {
+            bundle->exported = strtoll(value, &end, 10);
+        } else if (strcmp(line, "cache") == 0) {
+            bundle->ldb_size = strtoull(value, &end, 10);
+        } else if (strcmp(line, "timestamps") == 0) {
+            bundle->ts_size = strtoull(value, &end, 10);
+        } else {
+            continue;
+        }
+
+        if (errno != 0 || *end != '\0' || end == value) {
+            break;
+        }
+    }
+
+    talloc_free(bundle);
+    return EINVAL;
+}
+
+static errno_t sssctl_import_file(FILE *in,
+                                  uint64_t size,
+                                  const char *path,
+                                  const char *target)
+{
+    struct stat st;
+    FILE *out;
+    errno_t ret;
+    int fd;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        ret = errno;
+        ERROR("Unable to create %s: %s\n", path, sss_strerror(ret));
+        return ret;
+    }
+
+    /* Keep the ownership and permissions of the cache that is replaced */
+    if (stat(target, &st) == 0) {
+        if (fchown(fd, st.st_uid, st.st_gid) != 0
+                || fchmod(fd, st.st_mode & 07777) != 0) {
+            ret = errno;
+            ERROR("Unable to set permissions of %s: %s\n", path,
+                  sss_strerror(ret));
+            close(fd);
+            return ret;
+        }
+    }
+
+    out = fdopen(fd, "w");
+    if (out == NULL) {
+        ret = errno;
+        close(fd);
+        return ret;
+    }
+
+    ret = sssctl_copy_data(in, out, size);
+    if (fclose(out) != 0 && ret == EOK) {
+        ret = errno;
+    }
+
+    if (ret != EOK) {
+        ERROR("Unable to write %s: %s\n", path, sss_strerror(ret));
+    }
+
+    return ret;
+}
+
+static errno_t sssctl_import_bundle(TALLOC_CTX *mem_ctx,
+                                    FILE *in,
+                                    struct sssctl_bundle *bundle,
+                                    struct sss_domain_info *dom,
+                                    const char *tmpdir)
+{
+    struct sss_domain_info *sub;
+    struct sysdb_ctx *sysdb;
+    char *tmp_ldb_file;
+    char *tmp_ts_file;
+    char *ldb_file;
+    char *ts_file;
+    errno_t ret;
+
+    ret = sysdb_cache_files(mem_ctx, dom, tmpdir, &tmp_ldb_file, &tmp_ts_file);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sysdb_cache_files(mem_ctx, dom, DB_PATH, &ldb_file, &ts_file);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if ((ts_file == NULL) != (bundle->ts_size == 0)) {
+        ERROR("The bundle does not match the type of domain %s\n", dom->name);
+        return EINVAL;
+    }
+
+    ret = sssctl_import_file(in, bundle->ldb_size, tmp_ldb_file, ldb_file);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (ts_file != NULL) {
+        ret = sssctl_import_file(in, bundle->ts_size, tmp_ts_file, ts_file);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    /* Checks the version and the database type of the imported cache */
+    ret = sysdb_domain_init(mem_ctx, dom, tmpdir, &sysdb);
+    if (ret != EOK) {
+        SYSDB_VERSION_ERROR(ret);
+        ERROR("The imported cache can not be used: %s\n", sss_strerror(ret));
+        return ret;
+    }
+
+    /* The objects expire as long after the import as after the export */
+    ret = sysdb_cache_import_fixup(sysdb, dom, time(NULL) - bundle->exported);
+    talloc_free(sysdb);
+    if (ret != EOK) {
+        ERROR("Unable to update the imported cache: %s\n", sss_strerror(ret));
+        return ret;
+    }
+
+    /* The files opened by the tool are replaced */
+    for (sub = dom->subdomains; sub != NULL; sub = sub->next) {
+        if (sub->sysdb == dom->sysdb) {
+            sub->sysdb = NULL;
+        }
+    }
+    talloc_zfree(dom->sysdb);
+
+    if (ts_file != NULL && rename(tmp_ts_file, ts_file) != 0) {
+        ret = errno;
+        ERROR("Unable to replace %s: %s\n", ts_file, sss_strerror(ret));
+        return ret;
+    }
+
+    if (rename(tmp_ldb_file, ldb_file) != 0) {
+        ret = errno;
+        ERROR("Unable to replace %s: %s\n", ldb_file, sss_strerror(ret));
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t sssctl_cache_import(struct sss_cmdline *cmdline,
+                            struct sss_tool_ctx *tool_ctx,
+                            void *pvt)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sssctl_bundle *bundle;
+    struct sss_domain_info *dom;
+    const char *file = NULL;
+    char *tmpdir = NULL;
+    FILE *in = NULL;
+    errno_t ret;
+
+    ret = sss_tool_popt_ex(cmdline, NULL, SSS_TOOL_OPT_OPTIONAL,
+                           NULL, NULL, "FILE",
+                           _("Bundle created by cache-export."),
+                           &file, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        return ret;
+    }
+
+    if (sss_daemon_running()) {
+        fprintf(stderr, "Unable to import the cache unless SSSD is stopped.\n");
+        return ERR_SSSD_RUNNING;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    in = fopen(file, "r");
+    if (in == NULL) {
+        ret = errno;
+        ERROR("Unable to open %s: %s\n", file, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = sssctl_bundle_read_header(tmp_ctx, in, &bundle);
+    if (ret != EOK) {
+        ERROR("%s is not a valid cache bundle\n", file);
+        goto done;
+    }
+
+    if (bundle->version != SSSCTL_BUNDLE_VERSION) {
+        ERROR("Unsupported version %d of the cache bundle\n", bundle->version);
+        ret = EINVAL;
+        goto done;
+    }
+
+    dom = find_domain_by_name(tool_ctx->domains, bundle->domain, true);
+    if (dom == NULL || dom->parent != NULL) {
+        ERROR("Domain %s is not configured\n", bundle->domain);
+        ret = ENOENT;
+        goto done;
+    }
+
+    tmpdir = talloc_strdup(tmp_ctx, DB_PATH "/import.XXXXXX");
+    if (tmpdir == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (mkdtemp(tmpdir) == NULL) {
+        ret = errno;
+        ERROR("Unable to create a temporary directory: %s\n",
+              sss_strerror(ret));
+        tmpdir = NULL;
+        goto done;
+    }
+
+    ret = sssctl_import_bundle(tmp_ctx, in, bundle, dom, tmpdir);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    PRINT("The cache of %s was imported from %s\n", dom->name, file);
+    ret = EOK;
+
+done:
+    if (tmpdir != NULL) {
+        sss_remove_tree(tmpdir);
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
@@ -191,6 +191,9 @@ sssctl_domain_status_active_server(struct sbus_sync_connection *conn,
     TALLOC_CTX *tmp_ctx;
     const char *server;
     const char **services;
+    uint32_t page_size;
+    uint32_t pool_size;
+    uint32_t page_msecs;
     errno_t ret;
     int i;
 
@@ -229,6 +232,20 @@ sssctl_domain_status_active_server(struct sbus_sync_connection *conn,
         /* SBUS_REQ_STRING_DEFAULT handles (server == NULL) case gracefully */
         server = SBUS_REQ_STRING_DEFAULT(server, _("not connected"));
         printf("%s: %s\n", proper_service_name(services[i]), server);
+
+        ret = sbus_call_ifp_domain_ServerTuning(conn, IFP_BUS, domain_path,
+                  services[i], &page_size, &pool_size, &page_msecs);
+        if (ret != EOK) {
+            /* not every service has tuning, an older sssd_ifp neither */
+            DEBUG(SSSDBG_TRACE_FUNC, "Unable to get server tuning [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            continue;
+        }
+
+        if (page_size > 0) {
+            PRINT("  page size: %u, connections: %u, page time: %u ms\n",
+                  page_size, pool_size, page_msecs);
+        }
     }
 
     ret = EOK;
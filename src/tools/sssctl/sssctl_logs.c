@@ -33,6 +33,7 @@
 #include <stdio.h>
 
 #include "util/util.h"
+#include "util/sss_prof.h"
 #include "tools/common/sss_process.h"
 #include "tools/sssctl/sssctl.h"
 #include "tools/tools_util.h"
@@ -368,3 +369,52 @@ fini:
     talloc_free(ctx);
     return ret;
 }
+
+errno_t sssctl_debug_backtrace(struct sss_cmdline *cmdline,
+                               struct sss_tool_ctx *tool_ctx,
+                               void *pvt)
+{
+    errno_t ret;
+
+    ret = sss_tool_popt(cmdline, NULL, SSS_TOOL_OPT_OPTIONAL, NULL, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        return ret;
+    }
+
+    /* the monitor forwards the signal to the services */
+    ret = sss_signal(SSS_DEBUG_BACKTRACE_SIGNAL);
+    if (ret != EOK) {
+        ERROR("Could not signal SSSD. Is SSSD running?\n");
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t sssctl_debug_profile(struct sss_cmdline *cmdline,
+                             struct sss_tool_ctx *tool_ctx,
+                             void *pvt)
+{
+    errno_t ret;
+
+    ret = sss_tool_popt(cmdline, NULL, SSS_TOOL_OPT_OPTIONAL, NULL, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        return ret;
+    }
+
+    /* the monitor forwards the signal to the services, each of them starts
+     * its profiler or stops it and writes out the results */
+    ret = sss_signal(SSS_PROF_SIGNAL);
+    if (ret != EOK) {
+        ERROR("Could not signal SSSD. Is SSSD running?\n");
+        return ret;
+    }
+
+    PRINT("The profilers of the SSSD processes were started or stopped. "
+          "On stop the results are written to the *.profile.cpu.folded "
+          "and *.profile.wall.folded files in %s.\n", LOG_PATH);
+
+    return EOK;
+}
@@ -0,0 +1,160 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <talloc.h>
+#include <popt.h>
+
+#include "util/util.h"
+#include "util/mmap_cache.h"
+#include "tools/sssctl/sssctl.h"
+
+static const char *sssctl_memcache_names[] = {
+    "passwd", "group", "initgroups", "sid",
+    "services", "hosts", "netgroups", NULL
+};
+
+/* Returns true if the file name is "<name>.<uid>" */
+static bool sssctl_memcache_stats_file(const char *file, const char *name)
+{
+    size_t len = strlen(name);
+    const char *p;
+
+    if (strncmp(file, name, len) != 0 || file[len] != '.'
+            || file[len + 1] == '\0') {
+        return false;
+    }
+
+    for (p = &file[len + 1]; *p != '\0'; p++) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void sssctl_memcache_stats_add(struct sss_mc_counters *sum,
+                                      struct sss_mc_counters *c)
+{
+    sum->lookups += c->lookups;
+    sum->hits += c->hits;
+    sum->misses += c->misses;
+    sum->stale_hits += c->stale_hits;
+    sum->barrier_retries += c->barrier_retries;
+    sum->stores += c->stores;
+    sum->evictions += c->evictions;
+    sum->invalidations += c->invalidations;
+}
+
+/* Sums the counters of all users for the cache. The files are read, not
+ * mapped, so that a file truncated by its owner cannot crash us. */
+static void sssctl_memcache_stats_sum(DIR *dir, const char *name,
+                                      struct sss_mc_counters *sum)
+{
+    struct sss_mc_counters c;
+    struct dirent *dent;
+    ssize_t len;
+    errno_t ret;
+    int fd;
+
+    memset(sum, 0, sizeof(struct sss_mc_counters));
+
+    rewinddir(dir);
+    while ((dent = readdir(dir)) != NULL) {
+        if (!sssctl_memcache_stats_file(dent->d_name, name)) {
+            continue;
+        }
+
+        fd = openat(dirfd(dir), dent->d_name,
+                    O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1) {
+            ret = errno;
+            DEBUG(SSSDBG_MINOR_FAILURE, "Unable to open %s [%d]: %s\n",
+                  dent->d_name, ret, sss_strerror(ret));
+            continue;
+        }
+
+        len = sss_atomic_read_s(fd, &c, sizeof(c));
+        close(fd);
+        if (len != sizeof(c) || c.version != SSS_MC_STATS_VNO) {
+            continue;
+        }
+
+        sssctl_memcache_stats_add(sum, &c);
+    }
+}
+
+static void sssctl_memcache_stats_print(const char *name,
+                                        struct sss_mc_counters *c)
+{
+    double ratio = 0;
+
+    if (c->lookups > 0) {
+        ratio = 100.0 * c->hits / c->lookups;
+    }
+
+    PRINT("%s:\n", name);
+    PRINT(" - Lookups:         %"PRIu64"\n", c->lookups);
+    PRINT(" - Hits:            %"PRIu64" (%.1f%%)\n", c->hits, ratio);
+    PRINT(" - Misses:          %"PRIu64"\n", c->misses);
+    PRINT(" - Stale hits:      %"PRIu64"\n", c->stale_hits);
+    PRINT(" - Barrier retries: %"PRIu64"\n", c->barrier_retries);
+    PRINT(" - Stores:          %"PRIu64"\n", c->stores);
+    PRINT(" - Evictions:       %"PRIu64"\n", c->evictions);
+    PRINT(" - Invalidations:   %"PRIu64"\n", c->invalidations);
+    PRINT("\n");
+}
+
+errno_t sssctl_memcache_stats(struct sss_cmdline *cmdline,
+                              struct sss_tool_ctx *tool_ctx,
+                              void *pvt)
+{
+    struct sss_mc_counters sum;
+    DIR *dir;
+    errno_t ret;
+    int i;
+
+    ret = sss_tool_popt(cmdline, NULL, SSS_TOOL_OPT_OPTIONAL, NULL, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        return ret;
+    }
+
+    dir = opendir(SSS_NSS_MCACHE_STATS_DIR);
+    if (dir == NULL) {
+        ret = errno;
+        if (ret == ENOENT) {
+            PRINT("No memory cache statistics are available\n");
+            return EOK;
+        }
+        ERROR("Unable to open %s: %s\n", SSS_NSS_MCACHE_STATS_DIR,
+              sss_strerror(ret));
+        return ret;
+    }
+
+    for (i = 0; sssctl_memcache_names[i] != NULL; i++) {
+        sssctl_memcache_stats_sum(dir, sssctl_memcache_names[i], &sum);
+        sssctl_memcache_stats_print(sssctl_memcache_names[i], &sum);
+    }
+
+    closedir(dir);
+    return EOK;
+}
@@ -0,0 +1,830 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Drives a weighted mix of lookups against the running SSSD from several
+ * processes with several threads each and reports the throughput and the
+ * latency percentiles of every kind of lookup as JSON. The lookups go
+ * through the system NSS and PAM stacks like the lookups of any other
+ * application, so the memory cache is used unless --no-memcache is given.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <pwd.h>
+#include <grp.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <security/pam_appl.h>
+#include <talloc.h>
+#include <popt.h>
+
+#include "util/util.h"
+#include "tools/common/sss_tools.h"
+#include "tools/sssctl/sssctl.h"
+
+#ifdef BUILD_SUDO
+#include "sss_client/sudo/sss_sudo.h"
+#endif
+
+#define PERF_DEFAULT_MIX "getpwnam=100"
+#define PERF_DEFAULT_DURATION 10
+#define PERF_DEFAULT_PAM_SERVICE "system-auth"
+#define PERF_BUFSIZE (1024 * 1024)
+#define PERF_MAX_GROUPS 4096
+
+/* Latencies in microseconds are kept in a log-linear histogram, values
+ * below PERF_HIST_LINEAR exactly and larger ones with 64 buckets per power
+ * of two, which bounds the error of the percentiles to about 1.5% */
+#define PERF_HIST_LINEAR 128
+#define PERF_HIST_SUB_BITS 6
+#define PERF_HIST_MAX_EXP 31
+#define PERF_HIST_BUCKETS \
+    (PERF_HIST_LINEAR + (PERF_HIST_MAX_EXP + 1 - 7) * (1 << PERF_HIST_SUB_BITS))
+
+enum sssctl_perf_op {
+    PERF_GETPWNAM,
+    PERF_GETPWUID,
+    PERF_INITGROUPS,
+    PERF_GETGRNAM,
+    PERF_SUDO,
+    PERF_PAM,
+
+    PERF_OP_SENTINEL
+};
+
+static const char *sssctl_perf_op_names[] = {
+    "getpwnam", "getpwuid", "initgroups", "getgrnam", "sudo", "pam", NULL
+};
+
+/* Responders whose CPU time is reported, so runs with different responder
+ * builds or settings can be compared by the work they cost, not only by
+ * the throughput the clients see */
+enum sssctl_perf_responder {
+    PERF_RESP_NSS,
+    PERF_RESP_PAM,
+
+    PERF_RESP_SENTINEL
+};
+
+static const char *sssctl_perf_responder_names[] = {
+    "sssd_nss", "sssd_pam", NULL
+};
+
+struct sssctl_perf_stats {
+    uint64_t requests;
+    uint64_t errors;
+    uint64_t hist[PERF_HIST_BUCKETS];
+};
+
+struct sssctl_perf_user {
+    const char *name;
+    uid_t uid;
+    gid_t gid;
+};
+
+struct sssctl_perf_ctx {
+    struct sssctl_perf_user *users;
+    int num_users;
+    char **groups;
+    int num_groups;
+    unsigned int weights[PERF_OP_SENTINEL];
+    unsigned int total_weight;
+    const char *pam_service;
+    struct timespec deadline;
+};
+
+struct sssctl_perf_worker {
+    struct sssctl_perf_ctx *ctx;
+    unsigned int seed;
+    char *buf;
+    struct sssctl_perf_stats stats[PERF_OP_SENTINEL];
+};
+
+static size_t sssctl_perf_hist_index(uint64_t usec)
+{
+    unsigned int exp;
+
+    if (usec < PERF_HIST_LINEAR) {
+        return usec;
+    }
+
+    if (usec >> PERF_HIST_MAX_EXP) {
+        usec = (1ULL << (PERF_HIST_MAX_EXP + 1)) - 1;
+    }
+
+    exp = 63 - __builtin_clzll(usec);
+    return PERF_HIST_LINEAR
+           + (exp - 7) * (1 << PERF_HIST_SUB_BITS)
+           + ((usec >> (exp - PERF_HIST_SUB_BITS))
+              & ((1 << PERF_HIST_SUB_BITS) - 1));
+}
+
+/* The smallest latency that falls into the bucket */
+static uint64_t sssctl_perf_hist_value(size_t index)
+{
+    unsigned int exp;
+    uint64_t sub;
+
+    if (index < PERF_HIST_LINEAR) {
+        return index;
+    }
+
+    index -= PERF_HIST_LINEAR;
+    exp = 7 + index / (1 << PERF_HIST_SUB_BITS);
+    sub = index % (1 << PERF_HIST_SUB_BITS);
+
+    return ((1 << PERF_HIST_SUB_BITS) + sub) << (exp - PERF_HIST_SUB_BITS);
+}
+
+static uint64_t sssctl_perf_percentile(struct sssctl_perf_stats *stats,
+                                       double quantile)
+{
+    uint64_t target;
+    uint64_t seen = 0;
+    size_t i;
+
+    if (stats->requests == 0) {
+        return 0;
+    }
+
+    target = stats->requests * quantile;
+    if (target < stats->requests * quantile || target == 0) {
+        target++;
+    }
+
+    for (i = 0; i < PERF_HIST_BUCKETS; i++) {
+        seen += stats->hist[i];
+        if (seen >= target) {
+            return sssctl_perf_hist_value(i);
+        }
+    }
+
+    return sssctl_perf_hist_value(PERF_HIST_BUCKETS - 1);
+}
+
+static void sssctl_perf_stats_add(struct sssctl_perf_stats *sum,
+                                  struct sssctl_perf_stats *stats)
+{
+    size_t i;
+
+    sum->requests += stats->requests;
+    sum->errors += stats->errors;
+    for (i = 0; i < PERF_HIST_BUCKETS; i++) {
+        sum->hist[i] += stats->hist[i];
+    }
+}
+
+static uint64_t sssctl_perf_usec(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000000ULL
+           + (end->tv_nsec - start->tv_nsec) / 1000;
+}
+
+static bool sssctl_perf_expired(struct timespec *now,
+                                struct timespec *deadline)
+{
+    return now->tv_sec > deadline->tv_sec
+           || (now->tv_sec == deadline->tv_sec
+               && now->tv_nsec >= deadline->tv_nsec);
+}
+
+/* PAM account checks must not prompt */
+static int sssctl_perf_pam_conv(int num_msg, const struct pam_message **msg,
+                                struct pam_response **resp, void *appdata)
+{
+    return PAM_CONV_ERR;
+}
+
+static bool sssctl_perf_pam(struct sssctl_perf_ctx *ctx, const char *user)
+{
+    struct pam_conv conv = { sssctl_perf_pam_conv, NULL };
+    pam_handle_t *pamh;
+    int ret;
+
+    ret = pam_start(ctx->pam_service, user, &conv, &pamh);
+    if (ret != PAM_SUCCESS) {
+        return false;
+    }
+
+    ret = pam_acct_mgmt(pamh, 0);
+    pam_end(pamh, ret);
+
+    return ret == PAM_SUCCESS;
+}
+
+#ifdef BUILD_SUDO
+static bool sssctl_perf_sudo(struct sssctl_perf_user *user)
+{
+    struct sss_sudo_result *result = NULL;
+    uint32_t error;
+    int ret;
+
+    ret = sss_sudo_send_recv(user->uid, user->name, NULL, &error, &result);
+    sss_sudo_free_result(result);
+
+    /* A user without rules is a successful lookup */
+    return ret == 0 && (error == SSS_SUDO_ERROR_OK || error == ENOENT);
+}
+#endif
+
+static bool sssctl_perf_run_op(struct sssctl_perf_worker *worker,
+                               enum sssctl_perf_op op)
+{
+    struct sssctl_perf_ctx *ctx = worker->ctx;
+    struct sssctl_perf_user *user = NULL;
+    const char *group = NULL;
+    struct passwd pwd;
+    struct passwd *pwd_res;
+    struct group grp;
+    struct group *grp_res;
+    gid_t groups[PERF_MAX_GROUPS];
+    int ngroups;
+    int ret;
+
+    if (ctx->num_users > 0) {
+        user = &ctx->users[rand_r(&worker->seed) % ctx->num_users];
+    }
+    if (ctx->num_groups > 0) {
+        group = ctx->groups[rand_r(&worker->seed) % ctx->num_groups];
+    }
+
+    switch (op) {
+    case PERF_GETPWNAM:
+        ret = getpwnam_r(user->name, &pwd, worker->buf, PERF_BUFSIZE,
+                         &pwd_res);
+        return ret == 0 && pwd_res != NULL;
+    case PERF_GETPWUID:
+        ret = getpwuid_r(user->uid, &pwd, worker->buf, PERF_BUFSIZE,
+                         &pwd_res);
+        return ret == 0 && pwd_res != NULL;
+    case PERF_INITGROUPS:
+        /* A user with more groups than the buffer still counts */
+        ngroups = PERF_MAX_GROUPS;
+        ret = getgrouplist(user->name, user->gid, groups, &ngroups);
+        return ret != -1 || ngroups > PERF_MAX_GROUPS;
+    case PERF_GETGRNAM:
+        ret = getgrnam_r(group, &grp, worker->buf, PERF_BUFSIZE, &grp_res);
+        return ret == 0 && grp_res != NULL;
+    case PERF_SUDO:
+#ifdef BUILD_SUDO
+        return sssctl_perf_sudo(user);
+#else
+        return false;
+#endif
+    case PERF_PAM:
+        return sssctl_perf_pam(ctx, user->name);
+    case PERF_OP_SENTINEL:
+        break;
+    }
+
+    return false;
+}
+
+static enum sssctl_perf_op sssctl_perf_pick_op(struct sssctl_perf_worker *worker)
+{
+    struct sssctl_perf_ctx *ctx = worker->ctx;
+    unsigned int value;
+    int op;
+
+    value = rand_r(&worker->seed) % ctx->total_weight;
+    for (op = 0; op < PERF_OP_SENTINEL - 1; op++) {
+        if (value < ctx->weights[op]) {
+            break;
+        }
+        value -= ctx->weights[op];
+    }
+
+    return op;
+}
+
+static void *sssctl_perf_thread(void *pvt)
+{
+    struct sssctl_perf_worker *worker = pvt;
+    struct sssctl_perf_stats *stats;
+    enum sssctl_perf_op op;
+    struct timespec start;
+    struct timespec end;
+    bool ok;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (!sssctl_perf_expired(&start, &worker->ctx->deadline)) {
+        op = sssctl_perf_pick_op(worker);
+        ok = sssctl_perf_run_op(worker, op);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        stats = &worker->stats[op];
+        stats->requests++;
+        if (!ok) {
+            stats->errors++;
+        }
+        stats->hist[sssctl_perf_hist_index(sssctl_perf_usec(&start, &end))]++;
+
+        start = end;
+    }
+
+    return NULL;
+}
+
+/* Runs in a child process, the statistics of its threads are summed into
+ * the shared memory of the parent */
+static int sssctl_perf_process(struct sssctl_perf_ctx *ctx,
+                               int process, int num_threads,
+                               struct sssctl_perf_stats *result)
+{
+    struct sssctl_perf_worker *workers;
+    pthread_t *threads;
+    int started;
+    int i;
+    int op;
+
+    workers = calloc(num_threads, sizeof(struct sssctl_perf_worker));
+    threads = calloc(num_threads, sizeof(pthread_t));
+    if (workers == NULL || threads == NULL) {
+        return ENOMEM;
+    }
+
+    for (started = 0; started < num_threads; started++) {
+        workers[started].ctx = ctx;
+        workers[started].seed = (process << 16) ^ started ^ getpid();
+        workers[started].buf = malloc(PERF_BUFSIZE);
+        if (workers[started].buf == NULL) {
+            break;
+        }
+
+        if (pthread_create(&threads[started], NULL, sssctl_perf_thread,
+                           &workers[started]) != 0) {
+            free(workers[started].buf);
+            break;
+        }
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        free(workers[i].buf);
+
+        for (op = 0; op < PERF_OP_SENTINEL; op++) {
+            sssctl_perf_stats_add(&result[op], &workers[i].stats[op]);
+        }
+    }
+
+    free(workers);
+    free(threads);
+
+    return started == num_threads ? EOK : EAGAIN;
+}
+
+/* Adds the user and system CPU time in clock ticks of all running
+ * responders, read from /proc/<pid>/stat */
+static void sssctl_perf_responder_cpu(uint64_t cpu[PERF_RESP_SENTINEL])
+{
+    char path[PATH_MAX];
+    char buf[1024];
+    unsigned long utime;
+    unsigned long stime;
+    struct dirent *dent;
+    char *comm;
+    char *end;
+    FILE *f;
+    DIR *dir;
+    int resp;
+    int ret;
+
+    memset(cpu, 0, sizeof(uint64_t) * PERF_RESP_SENTINEL);
+
+    dir = opendir("/proc");
+    if (dir == NULL) {
+        return;
+    }
+
+    while ((dent = readdir(dir)) != NULL) {
+        if (dent->d_name[0] < '0' || dent->d_name[0] > '9') {
+            continue;
+        }
+
+        ret = snprintf(path, sizeof(path), "/proc/%s/stat", dent->d_name);
+        if (ret < 0 || ret >= sizeof(path)) {
+            continue;
+        }
+
+        f = fopen(path, "r");
+        if (f == NULL) {
+            /* the process is gone already */
+            continue;
+        }
+
+        comm = fgets(buf, sizeof(buf), f);
+        fclose(f);
+        if (comm == NULL) {
+            continue;
+        }
+
+        /* pid (comm) state ppid pgrp session tty_nr tpgid flags minflt
+         * cminflt majflt cmajflt utime stime ... */
+        comm = strchr(buf, '(');
+        end = strrchr(buf, ')');
+        if (comm == NULL || end == NULL || end < comm) {
+            continue;
+        }
+        *end = '\0';
+        comm++;
+
+        for (resp = 0; resp < PERF_RESP_SENTINEL; resp++) {
+            if (strcmp(comm, sssctl_perf_responder_names[resp]) == 0) {
+                break;
+            }
+        }
+        if (resp == PERF_RESP_SENTINEL) {
+            continue;
+        }
+
+        ret = sscanf(end + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+                     "%lu %lu", &utime, &stime);
+        if (ret == 2) {
+            cpu[resp] += utime + stime;
+        }
+    }
+
+    closedir(dir);
+}
+
+static void sssctl_perf_print_stats(const char *name,
+                                    struct sssctl_perf_stats *stats,
+                                    int duration, bool last)
+{
+    PRINT("    \"%s\": {\n", name);
+    PRINT("      \"requests\": %"PRIu64",\n", stats->requests);
+    PRINT("      \"errors\": %"PRIu64",\n", stats->errors);
+    PRINT("      \"throughput\": %.1f,\n", (double)stats->requests / duration);
+    PRINT("      \"p50_us\": %"PRIu64",\n", sssctl_perf_percentile(stats, 0.5));
+    PRINT("      \"p99_us\": %"PRIu64",\n",
+          sssctl_perf_percentile(stats, 0.99));
+    PRINT("      \"p999_us\": %"PRIu64"\n",
+          sssctl_perf_percentile(stats, 0.999));
+    PRINT("    }%s\n", last ? "" : ",");
+}
+
+static void sssctl_perf_print(struct sssctl_perf_ctx *ctx,
+                              struct sssctl_perf_stats *sum,
+                              int processes, int threads, int duration,
+                              bool memcache, uint64_t *cpu_before,
+                              uint64_t *cpu_after)
+{
+    struct sssctl_perf_stats *total;
+    long ticks;
+    int last = -1;
+    int resp;
+    int op;
+
+    total = talloc_zero(NULL, struct sssctl_perf_stats);
+    if (total == NULL) {
+        ERROR("Out of memory\n");
+        return;
+    }
+
+    for (op = 0; op < PERF_OP_SENTINEL; op++) {
+        if (ctx->weights[op] > 0) {
+            sssctl_perf_stats_add(total, &sum[op]);
+            last = op;
+        }
+    }
+
+    PRINT("{\n");
+    PRINT("  \"processes\": %d,\n", processes);
+    PRINT("  \"threads\": %d,\n", threads);
+    PRINT("  \"duration\": %d,\n", duration);
+    PRINT("  \"memcache\": %s,\n", memcache ? "true" : "false");
+    ticks = sysconf(_SC_CLK_TCK);
+    PRINT("  \"responders\": {\n");
+    for (resp = 0; resp < PERF_RESP_SENTINEL; resp++) {
+        PRINT("    \"%s\": { \"cpu_ms\": %"PRIu64" }%s\n",
+              sssctl_perf_responder_names[resp],
+              ticks > 0 && cpu_after[resp] >= cpu_before[resp]
+                  ? (cpu_after[resp] - cpu_before[resp]) * 1000 / ticks : 0,
+              resp == PERF_RESP_SENTINEL - 1 ? "" : ",");
+    }
+    PRINT("  },\n");
+    PRINT("  \"operations\": {\n");
+    for (op = 0; op < PERF_OP_SENTINEL; op++) {
+        if (ctx->weights[op] > 0) {
+            sssctl_perf_print_stats(sssctl_perf_op_names[op], &sum[op],
+                                    duration, op == last);
+        }
+    }
+    PRINT("  },\n");
+    PRINT("  \"total\": {\n");
+    PRINT("    \"requests\": %"PRIu64",\n", total->requests);
+    PRINT("    \"errors\": %"PRIu64",\n", total->errors);
+    PRINT("    \"throughput\": %.1f,\n", (double)total->requests / duration);
+    PRINT("    \"p50_us\": %"PRIu64",\n", sssctl_perf_percentile(total, 0.5));
+    PRINT("    \"p99_us\": %"PRIu64",\n", sssctl_perf_percentile(total, 0.99));
+    PRINT("    \"p999_us\": %"PRIu64"\n", sssctl_perf_percentile(total, 0.999));
+    PRINT("  }\n");
+    PRINT("}\n");
+
+    talloc_free(total);
+}
+
+/* The mix is a list of "operation=weight" separated by commas */
+static errno_t sssctl_perf_parse_mix(TALLOC_CTX *mem_ctx,
+                                     const char *mix,
+                                     struct sssctl_perf_ctx *ctx)
+{
+    char **items;
+    char *value;
+    char *endptr;
+    unsigned long weight;
+    int num_items;
+    int op;
+    int i;
+    errno_t ret;
+
+    ret = split_on_separator(mem_ctx, mix, ',', true, true,
+                             &items, &num_items);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (i = 0; i < num_items; i++) {
+        value = strchr(items[i], '=');
+        if (value == NULL) {
+            weight = 1;
+        } else {
+            *value = '\0';
+            errno = 0;
+            weight = strtoul(value + 1, &endptr, 10);
+            if (errno != 0 || *endptr != '\0' || weight > 1000000) {
+                ERROR("Invalid weight of %s\n", items[i]);
+                return EINVAL;
+            }
+        }
+
+        for (op = 0; op < PERF_OP_SENTINEL; op++) {
+            if (strcmp(items[i], sssctl_perf_op_names[op]) == 0) {
+                break;
+            }
+        }
+
+        if (op == PERF_OP_SENTINEL) {
+            ERROR("Unknown operation %s\n", items[i]);
+            return EINVAL;
+        }
+
+#ifndef BUILD_SUDO
+        if (op == PERF_SUDO && weight > 0) {
+            ERROR("SSSD was built without sudo support\n");
+            return EINVAL;
+        }
+#endif
+
+        ctx->weights[op] = weight;
+    }
+
+    ctx->total_weight = 0;
+    for (op = 0; op < PERF_OP_SENTINEL; op++) {
+        ctx->total_weight += ctx->weights[op];
+    }
+
+    if (ctx->total_weight == 0) {
+        ERROR("The mix does not contain any operation\n");
+        return EINVAL;
+    }
+
+    return EOK;
+}
+
+/* The IDs are resolved once, before the measurement, so that getpwuid,
+ * initgroups and sudo can be driven by the names of the users */
+static errno_t sssctl_perf_resolve_users(TALLOC_CTX *mem_ctx,
+                                         const char *users,
+                                         struct sssctl_perf_ctx *ctx)
+{
+    struct passwd *pwd;
+    char **names;
+    int num_names;
+    int i;
+    errno_t ret;
+
+    ret = split_on_separator(mem_ctx, users, ',', true, true,
+                             &names, &num_names);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ctx->users = talloc_zero_array(mem_ctx, struct sssctl_perf_user,
+                                   num_names);
+    if (ctx->users == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_names; i++) {
+        errno = 0;
+        pwd = getpwnam(names[i]);
+        if (pwd == NULL) {
+            ret = errno == 0 ? ENOENT : errno;
+            ERROR("Unable to resolve user %s: %s\n", names[i],
+                  sss_strerror(ret));
+            return ret;
+        }
+
+        ctx->users[i].name = names[i];
+        ctx->users[i].uid = pwd->pw_uid;
+        ctx->users[i].gid = pwd->pw_gid;
+    }
+    ctx->num_users = num_names;
+
+    return EOK;
+}
+
+errno_t sssctl_perf(struct sss_cmdline *cmdline,
+                    struct sss_tool_ctx *tool_ctx,
+                    void *pvt)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sssctl_perf_ctx *ctx;
+    struct sssctl_perf_stats *shared;
+    uint64_t cpu_before[PERF_RESP_SENTINEL];
+    uint64_t cpu_after[PERF_RESP_SENTINEL];
+    size_t shared_size;
+    const char *mix = PERF_DEFAULT_MIX;
+    const char *users = NULL;
+    const char *groups = NULL;
+    const char *pam_service = PERF_DEFAULT_PAM_SERVICE;
+    int processes = 1;
+    int threads = 1;
+    int duration = PERF_DEFAULT_DURATION;
+    int no_memcache = 0;
+    int failed = 0;
+    int status;
+    pid_t pid;
+    int i;
+    int op;
+    errno_t ret;
+
+    struct poptOption options[] = {
+        {"mix", 'm', POPT_ARG_STRING, &mix, 0,
+            _("Operations with their weights, e.g. getpwnam=60,initgroups=40"),
+            NULL },
+        {"users", 'u', POPT_ARG_STRING, &users, 0,
+            _("Comma separated list of users to look up"), NULL },
+        {"groups", 'g', POPT_ARG_STRING, &groups, 0,
+            _("Comma separated list of groups to look up"), NULL },
+        {"processes", 'p', POPT_ARG_INT, &processes, 0,
+            _("Number of processes"), NULL },
+        {"threads", 't', POPT_ARG_INT, &threads, 0,
+            _("Number of threads in each process"), NULL },
+        {"duration", 'd', POPT_ARG_INT, &duration, 0,
+            _("Duration of the measurement in seconds"), NULL },
+        {"no-memcache", 'M', POPT_ARG_NONE, &no_memcache, 0,
+            _("Do not use the memory cache"), NULL },
+        {"pam-service", 's', POPT_ARG_STRING, &pam_service, 0,
+            _("PAM service used for the account checks"), NULL },
+        POPT_TABLEEND
+    };
+
+    ret = sss_tool_popt(cmdline, options, SSS_TOOL_OPT_OPTIONAL, NULL, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        return ret;
+    }
+
+    if (processes < 1 || threads < 1 || duration < 1) {
+        ERROR("The number of processes and threads and the duration "
+              "must be positive\n");
+        return EINVAL;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ctx = talloc_zero(tmp_ctx, struct sssctl_perf_ctx);
+    if (ctx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    ctx->pam_service = pam_service;
+
+    ret = sssctl_perf_parse_mix(ctx, mix, ctx);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (no_memcache) {
+        setenv("SSS_NSS_USE_MEMCACHE", "NO", 1);
+    }
+
+    if (users != NULL) {
+        ret = sssctl_perf_resolve_users(ctx, users, ctx);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    if (groups != NULL) {
+        ret = split_on_separator(ctx, groups, ',', true, true,
+                                 &ctx->groups, &ctx->num_groups);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    for (op = 0; op < PERF_OP_SENTINEL; op++) {
+        if (ctx->weights[op] == 0) {
+            continue;
+        }
+
+        if (op == PERF_GETGRNAM && ctx->num_groups == 0) {
+            ERROR("The %s operation needs --groups\n",
+                  sssctl_perf_op_names[op]);
+            ret = EINVAL;
+            goto done;
+        }
+
+        if (op != PERF_GETGRNAM && ctx->num_users == 0) {
+            ERROR("The %s operation needs --users\n",
+                  sssctl_perf_op_names[op]);
+            ret = EINVAL;
+            goto done;
+        }
+    }
+
+    shared_size = processes * PERF_OP_SENTINEL
+                  * sizeof(struct sssctl_perf_stats);
+    shared = mmap(NULL, shared_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        ret = errno;
+        ERROR("Unable to allocate shared memory: %s\n", sss_strerror(ret));
+        goto done;
+    }
+
+    sssctl_perf_responder_cpu(cpu_before);
+
+    clock_gettime(CLOCK_MONOTONIC, &ctx->deadline);
+    ctx->deadline.tv_sec += duration;
+
+    fflush(stdout);
+    for (i = 0; i < processes; i++) {
+        pid = fork();
+        if (pid == 0) {
+            ret = sssctl_perf_process(ctx, i, threads,
+                                      &shared[i * PERF_OP_SENTINEL]);
+            _exit(ret == EOK ? 0 : 1);
+        } else if (pid == -1) {
+            ret = errno;
+            ERROR("Unable to start a process: %s\n", sss_strerror(ret));
+            failed++;
+        }
+    }
+
+    while ((pid = wait(&status)) != -1) {
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed++;
+        }
+    }
+
+    sssctl_perf_responder_cpu(cpu_after);
+
+    if (failed > 0) {
+        ERROR("%d processes did not run all their threads, "
+              "the results are incomplete\n", failed);
+    }
+
+    /* Sum the processes into the first one */
+    for (i = 1; i < processes; i++) {
+        for (op = 0; op < PERF_OP_SENTINEL; op++) {
+            sssctl_perf_stats_add(&shared[op],
+                                  &shared[i * PERF_OP_SENTINEL + op]);
+        }
+    }
+
+    sssctl_perf_print(ctx, shared, processes, threads, duration,
+                      !no_memcache, cpu_before, cpu_after);
+
+    munmap(shared, shared_size);
+    ret = failed > 0 ? EIO : EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
@@ -0,0 +1,333 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <talloc.h>
+#include <popt.h>
+
+#include "util/util.h"
+#include "util/sss_cli_cmd.h"
+#include "sss_iface/sss_iface_sync.h"
+#include "responder/common/responder.h"
+#include "tools/sssctl/sssctl.h"
+
+static const char *sssctl_stats_results[SSS_CMD_STATS_RESULTS] = {
+    [SSS_CMD_STATS_CACHE] = "cache",
+    [SSS_CMD_STATS_DP] = "data provider",
+    [SSS_CMD_STATS_ERROR] = "error"
+};
+
+/* Returns the upper bound of the bucket that holds the given percentile.
+ * Bucket i holds the requests that took less than 2^(i+1) microseconds. */
+static uint64_t sssctl_stats_percentile(uint64_t *buckets,
+                                        uint64_t count,
+                                        unsigned int percentile)
+{
+    uint64_t limit;
+    uint64_t sum = 0;
+    int i;
+
+    limit = (count * percentile + 99) / 100;
+
+    for (i = 0; i < SSS_CMD_STATS_BUCKETS - 1; i++) {
+        sum += buckets[i];
+        if (sum >= limit) {
+            break;
+        }
+    }
+
+    return UINT64_C(2) << i;
+}
+
+static void sssctl_stats_print_cmd(uint32_t cmd,
+                                   uint64_t *counts,
+                                   uint64_t *usecs,
+                                   uint64_t *buckets)
+{
+    uint64_t total = 0;
+    uint64_t *b;
+    int r;
+
+    for (r = 0; r < SSS_CMD_STATS_RESULTS; r++) {
+        total += counts[r];
+    }
+
+    if (total == 0) {
+        return;
+    }
+
+    PRINT("%s:\n", sss_cmd2str(cmd));
+
+    for (r = 0; r < SSS_CMD_STATS_RESULTS; r++) {
+        if (counts[r] == 0) {
+            continue;
+        }
+
+        b = &buckets[r * SSS_CMD_STATS_BUCKETS];
+        PRINT(" - %-14s %"PRIu64" requests, avg %"PRIu64" us, "
+              "p50 < %"PRIu64" us, p90 < %"PRIu64" us, p99 < %"PRIu64" us\n",
+              sssctl_stats_results[r], counts[r], usecs[r] / counts[r],
+              sssctl_stats_percentile(b, counts[r], 50),
+              sssctl_stats_percentile(b, counts[r], 90),
+              sssctl_stats_percentile(b, counts[r], 99));
+    }
+}
+
+static void sssctl_stats_print_memory(uint64_t pool_size,
+                                      uint32_t *commands,
+                                      uint64_t *requests,
+                                      uint64_t *used_sum,
+                                      uint64_t *used_max,
+                                      uint64_t *overflows)
+{
+    size_t i;
+
+    PRINT("\nRequest pool: %"PRIu64" bytes\n", pool_size);
+
+    for (i = 0; i < talloc_array_length(commands); i++) {
+        if (requests[i] == 0) {
+            continue;
+        }
+
+        PRINT(" - %-20s avg %"PRIu64" bytes, max %"PRIu64" bytes, "
+              "%"PRIu64" of %"PRIu64" requests over the pool\n",
+              sss_cmd2str(commands[i]), used_sum[i] / requests[i],
+              used_max[i], overflows[i], requests[i]);
+    }
+}
+
+static void sssctl_stats_print_usage(const char *name, uint64_t bytes)
+{
+    PRINT(" - %-20s %"PRIu64" KiB\n", name, bytes / 1024);
+}
+
+static void sssctl_stats_print_dispatcher(const char **connections,
+                                          uint64_t *wakeups,
+                                          uint64_t *messages,
+                                          uint64_t *deferred,
+                                          uint32_t *max_batch)
+{
+    size_t i;
+
+    PRINT("\nD-Bus dispatch:\n");
+
+    for (i = 0; connections[i] != NULL; i++) {
+        if (wakeups[i] == 0) {
+            PRINT(" - %-20s idle\n", connections[i]);
+            continue;
+        }
+
+        PRINT(" - %-20s %"PRIu64" messages in %"PRIu64" wakeups, "
+              "avg batch %"PRIu64", max batch %"PRIu32", "
+              "%"PRIu64" times deferred\n",
+              connections[i], messages[i], wakeups[i],
+              messages[i] / wakeups[i], max_batch[i], deferred[i]);
+    }
+}
+
+errno_t sssctl_responder_stats(struct sss_cmdline *cmdline,
+                               struct sss_tool_ctx *tool_ctx,
+                               void *pvt)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sbus_sync_connection *conn;
+    const char *responder = NULL;
+    const char *busname;
+    uint64_t in_flight;
+    uint64_t queued;
+    uint64_t deferred;
+    uint64_t waiting;
+    uint64_t uids;
+    uint32_t *commands;
+    uint64_t *counts;
+    uint64_t *usecs;
+    uint64_t *buckets;
+    uint64_t pool_size;
+    uint32_t *pool_commands;
+    uint64_t *pool_requests;
+    uint64_t *pool_used_sum;
+    uint64_t *pool_used_max;
+    uint64_t *pool_overflows;
+    uint64_t mem_total;
+    uint64_t mem_clients;
+    uint64_t mem_object_cache;
+    uint64_t mem_negcache;
+    uint64_t mem_prefilter;
+    uint64_t mem_packet_pool;
+    uint64_t mem_soft_limit;
+    uint64_t mem_sheds;
+    const char **disp_connections;
+    uint64_t *disp_wakeups;
+    uint64_t *disp_messages;
+    uint64_t *disp_deferred;
+    uint32_t *disp_max_batch;
+    size_t num_conns;
+    size_t num_cmds;
+    size_t i;
+    errno_t ret;
+
+    ret = sss_tool_popt_ex(cmdline, NULL, SSS_TOOL_OPT_OPTIONAL,
+                           NULL, NULL, "RESPONDER",
+                           _("Responder name, nss by default."),
+                           &responder, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        return ret;
+    }
+
+    if (!sssctl_start_sssd(false)) {
+        return ERR_SSSD_NOT_RUNNING;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    busname = talloc_asprintf(tmp_ctx, "sssd.%s",
+                              responder == NULL ? "nss" : responder);
+    if (busname == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    conn = sbus_sync_connect_private(tmp_ctx, SSS_MONITOR_ADDRESS, NULL);
+    if (conn == NULL) {
+        ERROR("Unable to connect to SSSD!\n");
+        ret = EIO;
+        goto done;
+    }
+
+    ret = sbus_call_resp_stats_Commands(tmp_ctx, conn, busname, SSS_BUS_PATH,
+                                        &in_flight, &queued, &commands,
+                                        &counts, &usecs, &buckets);
+    if (ret != EOK) {
+        ERROR("Unable to get statistics of %s: %s\n", busname,
+              sss_strerror(ret));
+        goto done;
+    }
+
+    ret = sbus_call_resp_stats_Throttle(conn, busname, SSS_BUS_PATH,
+                                        &deferred, &waiting, &uids);
+    if (ret != EOK) {
+        ERROR("Unable to get statistics of %s: %s\n", busname,
+              sss_strerror(ret));
+        goto done;
+    }
+
+    ret = sbus_call_resp_stats_Memory(tmp_ctx, conn, busname, SSS_BUS_PATH,
+                                      &pool_size, &pool_commands,
+                                      &pool_requests, &pool_used_sum,
+                                      &pool_used_max, &pool_overflows);
+    if (ret != EOK) {
+        ERROR("Unable to get statistics of %s: %s\n", busname,
+              sss_strerror(ret));
+        goto done;
+    }
+
+    ret = sbus_call_resp_stats_MemoryUsage(conn, busname, SSS_BUS_PATH,
+                                           &mem_total, &mem_clients,
+                                           &mem_object_cache, &mem_negcache,
+                                           &mem_prefilter, &mem_packet_pool,
+                                           &mem_soft_limit, &mem_sheds);
+    if (ret != EOK) {
+        ERROR("Unable to get statistics of %s: %s\n", busname,
+              sss_strerror(ret));
+        goto done;
+    }
+
+    ret = sbus_call_resp_stats_Dispatcher(tmp_ctx, conn, busname,
+                                          SSS_BUS_PATH, &disp_connections,
+                                          &disp_wakeups, &disp_messages,
+                                          &disp_deferred, &disp_max_batch);
+    if (ret != EOK) {
+        ERROR("Unable to get statistics of %s: %s\n", busname,
+              sss_strerror(ret));
+        goto done;
+    }
+
+    num_cmds = talloc_array_length(commands);
+    if (talloc_array_length(counts) != num_cmds * SSS_CMD_STATS_RESULTS
+            || talloc_array_length(usecs) != num_cmds * SSS_CMD_STATS_RESULTS
+            || talloc_array_length(buckets) != num_cmds * SSS_CMD_STATS_RESULTS
+                                               * SSS_CMD_STATS_BUCKETS
+            || talloc_array_length(pool_commands) != num_cmds
+            || talloc_array_length(pool_requests) != num_cmds
+            || talloc_array_length(pool_used_sum) != num_cmds
+            || talloc_array_length(pool_used_max) != num_cmds
+            || talloc_array_length(pool_overflows) != num_cmds) {
+        ERROR("Unexpected statistics format\n");
+        ret = EINVAL;
+        goto done;
+    }
+
+    for (num_conns = 0; disp_connections != NULL
+                        && disp_connections[num_conns] != NULL; num_conns++);
+    if (disp_connections == NULL
+            || talloc_array_length(disp_wakeups) != num_conns
+            || talloc_array_length(disp_messages) != num_conns
+            || talloc_array_length(disp_deferred) != num_conns
+            || talloc_array_length(disp_max_batch) != num_conns) {
+        ERROR("Unexpected statistics format\n");
+        ret = EINVAL;
+        goto done;
+    }
+
+    PRINT("Requests in progress: %"PRIu64"\n", in_flight);
+    PRINT("Requests queued:      %"PRIu64"\n", queued);
+    if (uids > 0) {
+        PRINT("Requests deferred:    %"PRIu64" (%"PRIu64" clients waiting, "
+              "%"PRIu64" users tracked)\n", deferred, waiting, uids);
+    }
+    PRINT("\n");
+
+    for (i = 0; i < num_cmds; i++) {
+        sssctl_stats_print_cmd(commands[i],
+                               &counts[i * SSS_CMD_STATS_RESULTS],
+                               &usecs[i * SSS_CMD_STATS_RESULTS],
+                               &buckets[i * SSS_CMD_STATS_RESULTS
+                                          * SSS_CMD_STATS_BUCKETS]);
+    }
+
+    if (pool_size > 0) {
+        sssctl_stats_print_memory(pool_size, pool_commands, pool_requests,
+                                  pool_used_sum, pool_used_max,
+                                  pool_overflows);
+    }
+
+    PRINT("\nMemory: %"PRIu64" KiB\n", mem_total / 1024);
+    sssctl_stats_print_usage("clients", mem_clients);
+    sssctl_stats_print_usage("object cache", mem_object_cache);
+    sssctl_stats_print_usage("negative cache", mem_negcache);
+    sssctl_stats_print_usage("prefilter", mem_prefilter);
+    sssctl_stats_print_usage("free packets", mem_packet_pool);
+    if (mem_soft_limit > 0) {
+        PRINT("Soft limit: %"PRIu64" KiB, caches dropped %"PRIu64" times\n",
+              mem_soft_limit / 1024, mem_sheds);
+    }
+
+    sssctl_stats_print_dispatcher(disp_connections, disp_wakeups,
+                                  disp_messages, disp_deferred,
+                                  disp_max_batch);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
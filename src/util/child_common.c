@@ -28,8 +28,10 @@
 #include <tevent.h>
 #include <sys/wait.h>
 #include <errno.h>
+#include <spawn.h>
 
 #include "util/util.h"
+#include "util/probes.h"
 #include "util/find_uid.h"
 #include "db/sysdb.h"
 #include "util/child_common.h"
@@ -219,6 +221,10 @@ static void sss_child_handler(struct tevent_context *ev,
             return;
         } else if (pid == 0) continue;
 
+        if (WIFEXITED(wait_status) || WIFSIGNALED(wait_status)) {
+            PROBE(CHILD_EXIT, pid, wait_status);
+        }
+
         key.ul = pid;
         error = hash_lookup(sigchld_ctx->children, &key, &value);
         if (error == HASH_SUCCESS) {
@@ -580,6 +586,8 @@ static void child_sig_handler(struct tevent_context *ev,
             return;
         }
 
+        PROBE(CHILD_EXIT, ret, child_ctx->child_status);
+
         /* Invoke the callback in a tevent_immediate handler
          * so that it is safe to free the tevent_signal *
          */
@@ -778,6 +786,99 @@ void exec_child_ex(TALLOC_CTX *mem_ctx,
     exit(EXIT_FAILURE);
 }
 
+errno_t sss_child_spawn(TALLOC_CTX *mem_ctx,
+                        int *pipefd_to_child, int *pipefd_from_child,
+                        const char *binary, const char *logfile,
+                        const char *extra_argv[], bool extra_args_only,
+                        int child_in_fd, int child_out_fd,
+                        pid_t *_pid)
+{
+    TALLOC_CTX *tmp_ctx;
+    posix_spawn_file_actions_t actions;
+    bool actions_init = false;
+    FILE *debug_filep = NULL;
+    int debug_fd = STDERR_FILENO;
+    char **argv;
+    pid_t pid;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    /* The log file is opened here and inherited by the child. */
+    if (logfile != NULL && sss_logger == FILES_LOGGER) {
+        ret = open_debug_file_ex(logfile, &debug_filep, false);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Error setting up logging (%d) [%s]\n",
+                  ret, sss_strerror(ret));
+            goto done;
+        }
+        debug_fd = fileno(debug_filep);
+    }
+
+    ret = prepare_child_argv(tmp_ctx, debug_fd,
+                             binary, extra_argv, extra_args_only,
+                             &argv);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "prepare_child_argv() failed.\n");
+        goto done;
+    }
+
+    ret = posix_spawn_file_actions_init(&actions);
+    if (ret != 0) {
+        goto done;
+    }
+    actions_init = true;
+
+    /* The same descriptor setup as in exec_child_ex(). The ends of the
+     * pipes may be the same descriptor, e.g. for a socket pair, and must
+     * only be closed once. */
+    ret = posix_spawn_file_actions_addclose(&actions, pipefd_to_child[1]);
+    if (ret == 0) {
+        ret = posix_spawn_file_actions_adddup2(&actions, pipefd_to_child[0],
+                                               child_in_fd);
+    }
+    if (ret == 0 && pipefd_from_child[0] != pipefd_to_child[1]) {
+        ret = posix_spawn_file_actions_addclose(&actions,
+                                                pipefd_from_child[0]);
+    }
+    if (ret == 0) {
+        ret = posix_spawn_file_actions_adddup2(&actions, pipefd_from_child[1],
+                                               child_out_fd);
+    }
+    if (ret != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to set up the descriptors of the child [%d][%s].\n",
+              ret, strerror(ret));
+        goto done;
+    }
+
+    /* posix_spawn() does not copy the page tables of the caller, which is
+     * expensive for a process with large caches mapped. */
+    ret = posix_spawn(&pid, binary, &actions, NULL, argv, environ);
+    if (ret != 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "posix_spawn failed [%d][%s].\n",
+              ret, strerror(ret));
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Started [%s] as [%d].\n", binary, pid);
+    *_pid = pid;
+    ret = EOK;
+
+done:
+    if (actions_init) {
+        posix_spawn_file_actions_destroy(&actions);
+    }
+    if (debug_filep != NULL) {
+        fclose(debug_filep);
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 void exec_child(TALLOC_CTX *mem_ctx,
                 int *pipefd_to_child, int *pipefd_from_child,
                 const char *binary, const char *logfile)
@@ -117,6 +117,17 @@ void exec_child(TALLOC_CTX *mem_ctx,
                 int *pipefd_to_child, int *pipefd_from_child,
                 const char *binary, const char *logfile);
 
+/* Starts binary with the descriptors and arguments exec_child_ex() would
+ * set up in a forked child, without forking the caller. The caller keeps
+ * its ends of the pipes and has to close the ends of the child, like after
+ * fork(). */
+errno_t sss_child_spawn(TALLOC_CTX *mem_ctx,
+                        int *pipefd_to_child, int *pipefd_from_child,
+                        const char *binary, const char *logfile,
+                        const char *extra_argv[], bool extra_args_only,
+                        int child_in_fd, int child_out_fd,
+                        pid_t *_pid);
+
 int child_io_destructor(void *ptr);
 
 #endif /* __CHILD_COMMON_H__ */
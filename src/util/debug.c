@@ -25,6 +25,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <fcntl.h>
+#include <signal.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -45,8 +46,52 @@ int debug_to_file = 0;
 int debug_to_stderr = 0;
 enum sss_logger_t sss_logger;
 const char *debug_log_file = "sssd";
+int debug_backtrace_enabled = 0;
+uint32_t debug_trace_id = 0;
 static FILE *debug_file;
 
+/* Processes running a tevent loop collect their debug messages here and
+ * write them out in one go before the loop waits for the next event, see
+ * sss_debug_buffer_enable(). */
+#define DEBUG_BUFFER_SIZE (64 * 1024)
+/* a new message is only started if this much is left, so that messages are
+ * not split across two writes */
+#define DEBUG_BUFFER_MSG_MIN 1024
+
+static struct {
+    char data[DEBUG_BUFFER_SIZE];
+    size_t len;
+    pid_t pid;
+    bool enabled;
+    bool atexit_set;
+} debug_buffer;
+
+/* The messages not enabled by debug_level, see sss_debug_backtrace_enable().
+ * Only the text is formatted when a message is kept, the rest of the line
+ * is printed when the backtrace is written out. Longer messages are cut. */
+#define DEBUG_BACKTRACE_SLOTS 256
+#define DEBUG_BACKTRACE_MSG_LEN 232
+/* logging a message of these levels writes out the backtrace first */
+#define DEBUG_BACKTRACE_TRIGGER (SSSDBG_FATAL_FAILURE | \
+                                 SSSDBG_CRIT_FAILURE | \
+                                 SSSDBG_OP_FAILURE)
+
+struct debug_backtrace_msg {
+    struct timeval tv;
+    const char *function;
+    int level;
+    uint32_t trace_id;
+    char text[DEBUG_BACKTRACE_MSG_LEN];
+};
+
+static struct {
+    struct debug_backtrace_msg msgs[DEBUG_BACKTRACE_SLOTS];
+    unsigned int next;
+    unsigned int count;
+    pid_t pid;
+    bool dumping;
+} debug_backtrace;
+
 const char *sss_logger_str[] = {
         [STDERR_LOGGER] = "stderr",
         [FILES_LOGGER] = "files",
@@ -100,11 +145,147 @@ void sss_set_logger(const char *logger)
     }
 }
 
+static void debug_buffer_write(const char *data, size_t len)
+{
+    int fd = fileno(debug_file ? debug_file : stderr);
+    ssize_t written;
+
+    while (len > 0) {
+        written = write(fd, data, len);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        data += written;
+        len -= written;
+    }
+}
+
+/* Only calls write() and getpid(), so it may be used from signal handlers.
+ * A child forked without exec that exits or crashes before it logs anything
+ * still holds the messages of its parent, they are dropped. */
+void sss_debug_flush(void)
+{
+    if (debug_buffer.len == 0) {
+        return;
+    }
+
+    if (debug_buffer.pid != getpid()) {
+        debug_buffer.len = 0;
+        return;
+    }
+
+    debug_buffer_write(debug_buffer.data, debug_buffer.len);
+    debug_buffer.len = 0;
+}
+
+static void debug_buffer_fatal_signal(int sig)
+{
+    sss_debug_flush();
+
+    /* the default action was restored by SA_RESETHAND */
+    raise(sig);
+}
+
+void sss_debug_buffer_enable(void)
+{
+    int signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    struct sigaction old_sa;
+    struct sigaction sa;
+    size_t i;
+
+    if (debug_buffer.enabled) {
+        return;
+    }
+
+    fflush(debug_file ? debug_file : stderr);
+
+    debug_buffer.pid = getpid();
+    debug_buffer.len = 0;
+    debug_buffer.enabled = true;
+
+    if (!debug_buffer.atexit_set) {
+        debug_buffer.atexit_set = (atexit(sss_debug_flush) == 0);
+    }
+
+    /* do not lose the messages of a crashing process, handlers installed
+     * by the process itself are kept */
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = debug_buffer_fatal_signal;
+    sa.sa_flags = SA_RESETHAND | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+
+    for (i = 0; i < N_ELEMENTS(signals); i++) {
+        if (sigaction(signals[i], NULL, &old_sa) == 0
+                && old_sa.sa_handler == SIG_DFL) {
+            sigaction(signals[i], &sa, NULL);
+        }
+    }
+}
+
+/* A child forked without exec must neither write out the messages of its
+ * parent nor keep its own ones, nothing flushes them. */
+static bool debug_buffer_active(void)
+{
+    if (!debug_buffer.enabled) {
+        return false;
+    }
+
+    if (debug_buffer.pid != getpid()) {
+        debug_buffer.len = 0;
+        debug_buffer.enabled = false;
+        return false;
+    }
+
+    return true;
+}
+
+static void debug_buffer_vappend(const char *format, va_list ap)
+{
+    size_t left = DEBUG_BUFFER_SIZE - debug_buffer.len;
+    va_list ap_copy;
+    char *msg;
+    int len;
+
+    va_copy(ap_copy, ap);
+
+    len = vsnprintf(debug_buffer.data + debug_buffer.len, left, format, ap);
+    if (len < 0) {
+        goto done;
+    } else if (len < left) {
+        debug_buffer.len += len;
+        goto done;
+    }
+
+    /* did not fit, the truncated output is overwritten */
+    sss_debug_flush();
+
+    if (len < DEBUG_BUFFER_SIZE) {
+        vsnprintf(debug_buffer.data, DEBUG_BUFFER_SIZE, format, ap_copy);
+        debug_buffer.len = len;
+        goto done;
+    }
+
+    len = vasprintf(&msg, format, ap_copy);
+    if (len != -1) {
+        debug_buffer_write(msg, len);
+        free(msg);
+    }
+
+done:
+    va_end(ap_copy);
+}
+
 errno_t set_debug_file_from_fd(const int fd)
 {
     FILE *dummy;
     errno_t ret;
 
+    sss_debug_flush();
+
     errno = 0;
     dummy = fdopen(fd, "a");
     if (dummy == NULL) {
@@ -178,11 +359,20 @@ int debug_convert_old_level(int old_level)
 
 static void debug_fflush(void)
 {
+    if (debug_buffer.enabled) {
+        return;
+    }
+
     fflush(debug_file ? debug_file : stderr);
 }
 
 static void debug_vprintf(const char *format, va_list ap)
 {
+    if (debug_buffer.enabled) {
+        debug_buffer_vappend(format, ap);
+        return;
+    }
+
     vfprintf(debug_file ? debug_file : stderr, format, ap);
 }
 
@@ -200,6 +390,42 @@ static void debug_printf(const char *format, ...)
     va_end(ap);
 }
 
+/* Long enough for "[RID#4294967295] " */
+#define DEBUG_TRACE_PREFIX_LEN 20
+
+static const char *debug_trace_prefix(char *buf, uint32_t trace_id)
+{
+    if (trace_id == 0) {
+        return "";
+    }
+
+    snprintf(buf, DEBUG_TRACE_PREFIX_LEN, "[RID#%u] ", trace_id);
+    return buf;
+}
+
+static void debug_print_header(const struct timeval *tv,
+                               const char *function,
+                               int level,
+                               uint32_t trace_id)
+{
+    char prefix[DEBUG_TRACE_PREFIX_LEN];
+    struct tm *tm;
+
+    if (debug_timestamps) {
+        tm = localtime(&tv->tv_sec);
+        debug_printf("(%d-%02d-%02d %2d:%02d:%02d",
+                     tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
+                     tm->tm_hour, tm->tm_min, tm->tm_sec);
+        if (debug_microseconds) {
+            debug_printf(":%.6ld", tv->tv_usec);
+        }
+        debug_printf("): ");
+    }
+
+    debug_printf("[%s] [%s] (%#.4x): %s", debug_prg_name, function, level,
+                 debug_trace_prefix(prefix, trace_id));
+}
+
 #ifdef WITH_JOURNALD
 static errno_t journal_send(const char *file,
         long line,
@@ -210,6 +436,7 @@ static errno_t journal_send(const char *file,
 {
     errno_t ret;
     int res;
+    char prefix[DEBUG_TRACE_PREFIX_LEN];
     char *message = NULL;
     char *code_file = NULL;
     char *code_line = NULL;
@@ -247,7 +474,8 @@ static errno_t journal_send(const char *file,
      */
     res = sd_journal_send_with_location(
             code_file, code_line, function,
-            "MESSAGE=%s", message,
+            "MESSAGE=%s%s", debug_trace_prefix(prefix, debug_trace_id),
+            message,
             "PRIORITY=%i", LOG_DEBUG,
             "SSSD_DOMAIN=%s", domain,
             "SSSD_PRG_NAME=sssd[%s]", debug_prg_name,
@@ -261,8 +489,134 @@ journal_done:
     free(message);
     return ret;
 }
+
+static errno_t journal_sendf(const char *file,
+                             long line,
+                             const char *function,
+                             int level,
+                             const char *format, ...)
+{
+    va_list ap;
+    errno_t ret;
+
+    va_start(ap, format);
+    ret = journal_send(file, line, function, level, format, ap);
+    va_end(ap);
+
+    return ret;
+}
 #endif /* WiTH_JOURNALD */
 
+/* A child forked without exec starts with an empty backtrace, the messages
+ * in it are the parent's ones. */
+static void debug_backtrace_check_pid(void)
+{
+    pid_t pid = getpid();
+
+    if (debug_backtrace.pid != pid) {
+        debug_backtrace.pid = pid;
+        debug_backtrace.next = 0;
+        debug_backtrace.count = 0;
+    }
+}
+
+static void debug_backtrace_vrecord(const char *function,
+                                    int level,
+                                    const char *format,
+                                    va_list ap)
+{
+    struct debug_backtrace_msg *msg;
+    int len;
+
+    debug_backtrace_check_pid();
+
+    msg = &debug_backtrace.msgs[debug_backtrace.next];
+    gettimeofday(&msg->tv, NULL);
+    msg->function = function;
+    msg->level = level;
+    msg->trace_id = debug_trace_id;
+
+    len = vsnprintf(msg->text, DEBUG_BACKTRACE_MSG_LEN, format, ap);
+    if (len < 0) {
+        msg->text[0] = '\0';
+    } else if (len >= DEBUG_BACKTRACE_MSG_LEN) {
+        memcpy(msg->text + DEBUG_BACKTRACE_MSG_LEN - 5, "...\n", 5);
+    }
+
+    debug_backtrace.next = (debug_backtrace.next + 1) % DEBUG_BACKTRACE_SLOTS;
+    if (debug_backtrace.count < DEBUG_BACKTRACE_SLOTS) {
+        debug_backtrace.count++;
+    }
+}
+
+static void debug_backtrace_write(const char *function,
+                                  int level,
+                                  uint32_t trace_id,
+                                  const struct timeval *tv,
+                                  const char *text)
+{
+    size_t len = strlen(text);
+    const char *lf = (len == 0 || text[len - 1] != '\n') ? "\n" : "";
+#ifdef WITH_JOURNALD
+    uint32_t current_trace_id = debug_trace_id;
+    errno_t ret;
+
+    if (sss_logger == JOURNALD_LOGGER) {
+        debug_trace_id = trace_id;
+        ret = journal_sendf(__FILE__, __LINE__, function, level,
+                            "%s%s", text, lf);
+        debug_trace_id = current_trace_id;
+        if (ret == EOK) {
+            return;
+        }
+    }
+#endif
+
+    debug_print_header(tv, function, level, trace_id);
+    debug_printf("%s%s", text, lf);
+}
+
+void sss_debug_backtrace_enable(void)
+{
+    debug_backtrace_check_pid();
+    debug_backtrace_enabled = 1;
+}
+
+void sss_debug_backtrace_dump(void)
+{
+    struct debug_backtrace_msg *msg;
+    struct timeval tv;
+    unsigned int first;
+    unsigned int i;
+
+    debug_backtrace_check_pid();
+    if (debug_backtrace.count == 0 || debug_backtrace.dumping) {
+        return;
+    }
+    debug_backtrace.dumping = true;
+
+    gettimeofday(&tv, NULL);
+    debug_backtrace_write(__FUNCTION__, SSSDBG_FATAL_FAILURE, 0, &tv,
+                          "=== BEGIN OF BACKTRACE: recent messages not "
+                          "enabled by debug_level ===\n");
+
+    first = debug_backtrace.next + DEBUG_BACKTRACE_SLOTS
+            - debug_backtrace.count;
+    for (i = 0; i < debug_backtrace.count; i++) {
+        msg = &debug_backtrace.msgs[(first + i) % DEBUG_BACKTRACE_SLOTS];
+        debug_backtrace_write(msg->function, msg->level, msg->trace_id,
+                              &msg->tv, msg->text);
+    }
+
+    debug_backtrace_write(__FUNCTION__, SSSDBG_FATAL_FAILURE, 0, &tv,
+                          "=== END OF BACKTRACE ===\n");
+
+    debug_backtrace.next = 0;
+    debug_backtrace.count = 0;
+    debug_backtrace.dumping = false;
+    debug_fflush();
+}
+
 void sss_vdebug_fn(const char *file,
                    long line,
                    const char *function,
@@ -271,13 +625,19 @@ void sss_vdebug_fn(const char *file,
                    const char *format,
                    va_list ap)
 {
-    struct timeval tv;
-    struct tm *tm;
+    struct timeval tv = { 0 };
+    bool buffered;
 
 #ifdef WITH_JOURNALD
     errno_t ret;
     va_list ap_fallback;
+#endif
+
+    if (level & DEBUG_BACKTRACE_TRIGGER) {
+        sss_debug_backtrace_dump();
+    }
 
+#ifdef WITH_JOURNALD
     if (sss_logger == JOURNALD_LOGGER) {
         /* If we are not outputting logs to files, we should be sending them
          * to journald.
@@ -298,24 +658,25 @@ void sss_vdebug_fn(const char *file,
     }
 #endif
 
+    buffered = debug_buffer_active();
+    if (buffered && DEBUG_BUFFER_SIZE - debug_buffer.len < DEBUG_BUFFER_MSG_MIN) {
+        sss_debug_flush();
+    }
+
     if (debug_timestamps) {
         gettimeofday(&tv, NULL);
-        tm = localtime(&tv.tv_sec);
-        debug_printf("(%d-%02d-%02d %2d:%02d:%02d",
-                     tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
-                     tm->tm_hour, tm->tm_min, tm->tm_sec);
-        if (debug_microseconds) {
-            debug_printf(":%.6ld", tv.tv_usec);
-        }
-        debug_printf("): ");
     }
-
-    debug_printf("[%s] [%s] (%#.4x): ", debug_prg_name, function, level);
+    debug_print_header(&tv, function, level, debug_trace_id);
 
     debug_vprintf(format, ap);
     if (flags & APPEND_LINE_FEED) {
         debug_printf("\n");
     }
+
+    if (buffered && (level & SSSDBG_FATAL_FAILURE)) {
+        /* the process is likely to go away */
+        sss_debug_flush();
+    }
     debug_fflush();
 }
 
@@ -328,7 +689,11 @@ void sss_debug_fn(const char *file,
     va_list ap;
 
     va_start(ap, format);
-    sss_vdebug_fn(file, line, function, level, 0, format, ap);
+    if (DEBUG_IS_SET(level)) {
+        sss_vdebug_fn(file, line, function, level, 0, format, ap);
+    } else if (DEBUG_BACKTRACE_IS_SET(level)) {
+        debug_backtrace_vrecord(function, level, format, ap);
+    }
     va_end(ap);
 }
 
@@ -355,6 +720,8 @@ void ldb_debug_messages(void *context, enum ldb_debug_level level,
     if (DEBUG_IS_SET(loglevel)) {
         sss_vdebug_fn(__FILE__, __LINE__, "ldb", loglevel, APPEND_LINE_FEED,
                       fmt, ap);
+    } else if (DEBUG_BACKTRACE_IS_SET(loglevel)) {
+        debug_backtrace_vrecord("ldb", loglevel, fmt, ap);
     }
 }
 
@@ -419,7 +786,10 @@ int open_debug_file_ex(const char *filename, FILE **filep, bool want_cloexec)
         return ENOMEM;
     }
 
-    if (debug_file && !filep) fclose(debug_file);
+    if (debug_file && !filep) {
+        sss_debug_flush();
+        fclose(debug_file);
+    }
 
     old_umask = umask(SSS_DFL_UMASK);
     errno = 0;
@@ -465,6 +835,8 @@ int rotate_debug_files(void)
 
     if (sss_logger != FILES_LOGGER) return EOK;
 
+    sss_debug_flush();
+
     if (debug_file != NULL) {
         do {
             error = 0;
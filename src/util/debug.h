@@ -24,6 +24,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <stdint.h>
 
 #ifdef HAVE_FUNCTION_ATTRIBUTE_FORMAT
 #define SSS_ATTRIBUTE_PRINTF(a1, a2) __attribute__((format (printf, a1, a2)))
@@ -50,6 +51,10 @@ extern int debug_to_file;
 extern int debug_to_stderr;
 extern enum sss_logger_t sss_logger;
 extern const char *debug_log_file;
+extern int debug_backtrace_enabled;
+/* ID of the client request being processed, 0 if none. It is printed in the
+ * debug messages and reset once the current event was handled. */
+extern uint32_t debug_trace_id;
 
 void sss_set_logger(const char *logger);
 
@@ -69,6 +74,21 @@ int debug_convert_old_level(int old_level);
 errno_t set_debug_file_from_fd(const int fd);
 int get_fd_from_debug_file(void);
 
+/* Collect the debug messages in a per-process buffer instead of writing
+ * each of them. The buffer is written out when it is full, after fatal
+ * failures, by sss_debug_flush(), at exit and on crashes. */
+void sss_debug_buffer_enable(void);
+void sss_debug_flush(void);
+
+/* Keep the most recent messages whose level is not set in debug_level in a
+ * small per-process ring. They are written out as a backtrace before the
+ * next error is logged and by sss_debug_backtrace_dump(). */
+void sss_debug_backtrace_enable(void);
+void sss_debug_backtrace_dump(void);
+
+/* asks the SSSD processes to write out their backtraces, needs <signal.h> */
+#define SSS_DEBUG_BACKTRACE_SIGNAL SIGRTMIN
+
 #define SSS_DOM_ENV           "_SSS_DOM"
 
 #define SSSDBG_FATAL_FAILURE  0x0010   /* level 0 */
@@ -94,6 +114,9 @@ int get_fd_from_debug_file(void);
 #define SSSDBG_MASK_ALL  0x1F7F0
 #define SSSDBG_DEFAULT   (SSSDBG_FATAL_FAILURE|SSSDBG_CRIT_FAILURE|SSSDBG_OP_FAILURE)
 
+/* levels kept in the backtrace, the ldb traces would only crowd it */
+#define SSSDBG_BACKTRACE_LEVELS (SSSDBG_MASK_ALL & ~SSSDBG_TRACE_LDB)
+
 #define SSSDBG_TIMESTAMP_UNRESOLVED   -1
 #define SSSDBG_TIMESTAMP_DEFAULT       1
 
@@ -127,7 +150,8 @@ int get_fd_from_debug_file(void);
 */
 #define DEBUG(level, format, ...) do { \
     int __debug_macro_level = level; \
-    if (DEBUG_IS_SET(__debug_macro_level)) { \
+    if (DEBUG_IS_SET(__debug_macro_level) || \
+            DEBUG_BACKTRACE_IS_SET(__debug_macro_level)) { \
         sss_debug_fn(__FILE__, __LINE__, __FUNCTION__, \
                      __debug_macro_level, \
                      format, ##__VA_ARGS__); \
@@ -144,6 +168,14 @@ int get_fd_from_debug_file(void);
                                             (level & (SSSDBG_FATAL_FAILURE | \
                                                       SSSDBG_CRIT_FAILURE))))
 
+/** \def DEBUG_BACKTRACE_IS_SET(level)
+    \brief checks whether messages of level are kept in the backtrace
+
+    \param level the debug level, please use one of the SSSDBG*_ macros
+*/
+#define DEBUG_BACKTRACE_IS_SET(level) (debug_backtrace_enabled && \
+                                       ((level) & SSSDBG_BACKTRACE_LEVELS))
+
 #define DEBUG_INIT(dbg_lvl) do { \
     if (dbg_lvl != SSSDBG_INVALID) { \
         debug_level = debug_convert_old_level(dbg_lvl); \
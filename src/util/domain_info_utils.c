@@ -25,6 +25,337 @@
 #include "db/sysdb.h"
 #include "util/util.h"
 
+/* Lookup tables of the domains reached from a domain with
+ * get_next_domain(SSS_GND_ALL_DOMAINS), used by find_domain_by_name_ex()
+ * and find_domain_by_sid(). The keys are lower case. A table with two
+ * domains under the same key is not used because the result would depend
+ * on the order of the domains.
+ *
+ * The index is not a talloc child of the domain, it is freed by the
+ * destructor of the domain, and freeing any indexed domain invalidates all
+ * indexes. */
+struct sss_domain_index {
+    unsigned int generation;
+
+    hash_table_t *names;
+    hash_table_t *flat_names;
+    hash_table_t *sids;
+
+    bool names_usable;
+    bool flat_names_usable;
+    bool sids_usable;
+};
+
+/* Changed whenever a domain list changes, invalidates all indexes. */
+static unsigned int sss_domain_index_generation;
+
+void sss_domain_index_invalidate(void)
+{
+    sss_domain_index_generation++;
+}
+
+static int sss_domain_index_destructor(struct sss_domain_info *dom)
+{
+    talloc_zfree(dom->index);
+    sss_domain_index_invalidate();
+    return 0;
+}
+
+static char *sss_domain_index_key(TALLOC_CTX *mem_ctx, const char *str)
+{
+    char *key;
+    size_t i;
+
+    key = talloc_strdup(mem_ctx, str);
+    if (key == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; key[i] != '\0'; i++) {
+        key[i] = tolower((unsigned char)key[i]);
+    }
+
+    return key;
+}
+
+static struct sss_domain_info *sss_domain_index_get(hash_table_t *table,
+                                                    char *key)
+{
+    hash_key_t hkey;
+    hash_value_t value;
+    int hret;
+
+    hkey.type = HASH_KEY_STRING;
+    hkey.str = key;
+
+    hret = hash_lookup(table, &hkey, &value);
+    if (hret != HASH_SUCCESS) {
+        return NULL;
+    }
+
+    return value.ptr;
+}
+
+static errno_t sss_domain_index_add(hash_table_t *table,
+                                    const char *str,
+                                    struct sss_domain_info *dom,
+                                    bool *_usable)
+{
+    hash_key_t hkey;
+    hash_value_t value;
+    char *key;
+    errno_t ret;
+    int hret;
+
+    key = sss_domain_index_key(NULL, str);
+    if (key == NULL) {
+        return ENOMEM;
+    }
+
+    if (sss_domain_index_get(table, key) != NULL) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Domain key [%s] is not unique\n", key);
+        *_usable = false;
+        ret = EOK;
+        goto done;
+    }
+
+    hkey.type = HASH_KEY_STRING;
+    hkey.str = key;
+    value.type = HASH_VALUE_PTR;
+    value.ptr = dom;
+
+    hret = hash_enter(table, &hkey, &value);
+    ret = hret == HASH_SUCCESS ? EOK : ENOMEM;
+
+done:
+    talloc_free(key);
+    return ret;
+}
+
+/* A domain SID being a prefix of another one would make the result of
+ * find_domain_by_sid() depend on the order of the domains. */
+static bool sss_domain_index_sids_nested(struct sss_domain_index *index,
+                                         struct sss_domain_info *domain)
+{
+    struct sss_domain_info *dom;
+    char *key;
+    char *p;
+    bool nested = false;
+
+    for (dom = domain; dom != NULL && !nested;
+            dom = get_next_domain(dom, SSS_GND_ALL_DOMAINS)) {
+        if (dom->domain_id == NULL) {
+            continue;
+        }
+
+        key = sss_domain_index_key(NULL, dom->domain_id);
+        if (key == NULL) {
+            return true;
+        }
+
+        while ((p = strrchr(key, '-')) != NULL) {
+            *p = '\0';
+            if (sss_domain_index_get(index->sids, key) != NULL) {
+                nested = true;
+                break;
+            }
+        }
+
+        talloc_free(key);
+    }
+
+    return nested;
+}
+
+static struct sss_domain_index *
+sss_domain_get_index(struct sss_domain_info *domain)
+{
+    struct sss_domain_index *index;
+    struct sss_domain_info *dom;
+    errno_t ret;
+
+    if (domain->index != NULL
+            && domain->index->generation == sss_domain_index_generation) {
+        return domain->index;
+    }
+
+    talloc_zfree(domain->index);
+
+    index = talloc_zero(NULL, struct sss_domain_index);
+    if (index == NULL) {
+        return NULL;
+    }
+
+    index->generation = sss_domain_index_generation;
+
+    ret = sss_hash_create(index, 0, &index->names);
+    if (ret == EOK) {
+        ret = sss_hash_create(index, 0, &index->flat_names);
+    }
+    if (ret == EOK) {
+        ret = sss_hash_create(index, 0, &index->sids);
+    }
+    if (ret != EOK) {
+        goto done;
+    }
+
+    index->names_usable = true;
+    index->flat_names_usable = true;
+    index->sids_usable = true;
+
+    for (dom = domain; dom != NULL;
+            dom = get_next_domain(dom, SSS_GND_ALL_DOMAINS)) {
+        ret = sss_domain_index_add(index->names, dom->name, dom,
+                                   &index->names_usable);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        if (dom->flat_name != NULL) {
+            ret = sss_domain_index_add(index->flat_names, dom->flat_name, dom,
+                                       &index->flat_names_usable);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+
+        if (dom->domain_id != NULL) {
+            ret = sss_domain_index_add(index->sids, dom->domain_id, dom,
+                                       &index->sids_usable);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+
+        talloc_set_destructor(dom, sss_domain_index_destructor);
+    }
+
+    if (index->sids_usable && sss_domain_index_sids_nested(index, domain)) {
+        index->sids_usable = false;
+    }
+
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to index domains [%d]: %s\n",
+              ret, sss_strerror(ret));
+        talloc_free(index);
+        return NULL;
+    }
+
+    domain->index = index;
+    return index;
+}
+
+/* Returns false if the index cannot answer and the domains have to be
+ * searched one by one. */
+static bool sss_domain_index_find_name(struct sss_domain_info *domain,
+                                       const char *name,
+                                       bool match_any,
+                                       uint32_t gnd_flags,
+                                       struct sss_domain_info **_dom)
+{
+    struct sss_domain_index *index;
+    struct sss_domain_info *dom;
+    struct sss_domain_info *flat_dom = NULL;
+    char *key;
+
+    /* Only the traversal the index was built from is supported. */
+    if ((gnd_flags & ~SSS_GND_INCLUDE_DISABLED) != SSS_GND_DESCEND) {
+        return false;
+    }
+
+    index = sss_domain_get_index(domain);
+    if (index == NULL || !index->names_usable
+            || (match_any && !index->flat_names_usable)) {
+        return false;
+    }
+
+    key = sss_domain_index_key(NULL, name);
+    if (key == NULL) {
+        return false;
+    }
+
+    dom = sss_domain_index_get(index->names, key);
+    if (match_any) {
+        flat_dom = sss_domain_index_get(index->flat_names, key);
+    }
+    talloc_free(key);
+
+    if (dom != NULL && flat_dom != NULL && dom != flat_dom) {
+        /* The first one of both in the list wins. */
+        return false;
+    }
+
+    if (dom == NULL) {
+        dom = flat_dom;
+    }
+
+    if (dom != NULL && strcasecmp(dom->name, name) != 0
+            && (dom->flat_name == NULL
+                || strcasecmp(dom->flat_name, name) != 0)) {
+        /* Changed without sss_domain_index_invalidate(). */
+        return false;
+    }
+
+    if (dom != NULL && !(gnd_flags & SSS_GND_INCLUDE_DISABLED)
+            && sss_domain_get_state(dom) == DOM_DISABLED) {
+        dom = NULL;
+    }
+
+    *_dom = dom;
+    return true;
+}
+
+static bool sss_domain_index_find_sid(struct sss_domain_info *domain,
+                                      const char *sid,
+                                      struct sss_domain_info **_dom)
+{
+    struct sss_domain_index *index;
+    struct sss_domain_info *dom = NULL;
+    char *key;
+    char *p;
+
+    index = sss_domain_get_index(domain);
+    if (index == NULL || !index->sids_usable) {
+        return false;
+    }
+
+    key = sss_domain_index_key(NULL, sid);
+    if (key == NULL) {
+        return false;
+    }
+
+    /* The SID itself or the SID of the domain of an object. */
+    do {
+        dom = sss_domain_index_get(index->sids, key);
+        if (dom != NULL) {
+            break;
+        }
+
+        p = strrchr(key, '-');
+        if (p != NULL) {
+            *p = '\0';
+        }
+    } while (p != NULL);
+
+    if (dom != NULL && (dom->domain_id == NULL
+                        || strcasecmp(dom->domain_id, key) != 0)) {
+        /* Changed without sss_domain_index_invalidate(). */
+        talloc_free(key);
+        return false;
+    }
+    talloc_free(key);
+
+    if (dom != NULL && sss_domain_get_state(dom) == DOM_DISABLED) {
+        dom = NULL;
+    }
+
+    *_dom = dom;
+    return true;
+}
+
 struct sss_domain_info *get_domains_head(struct sss_domain_info *domain)
 {
     struct sss_domain_info *dom = NULL;
@@ -108,6 +439,12 @@ struct sss_domain_info *find_domain_by_name_ex(struct sss_domain_info *domain,
         return NULL;
     }
 
+    if (domain != NULL
+            && sss_domain_index_find_name(domain, name, match_any, gnd_flags,
+                                          &dom)) {
+        return dom;
+    }
+
     if (!(gnd_flags & SSS_GND_INCLUDE_DISABLED)) {
         while (dom && sss_domain_get_state(dom) == DOM_DISABLED) {
             dom = get_next_domain(dom, gnd_flags);
@@ -144,6 +481,10 @@ struct sss_domain_info *find_domain_by_sid(struct sss_domain_info *domain,
         return NULL;
     }
 
+    if (domain != NULL && sss_domain_index_find_sid(domain, sid, &dom)) {
+        return dom;
+    }
+
     sid_len = strlen(sid);
 
     while (dom && sss_domain_get_state(dom) == DOM_DISABLED) {
@@ -24,6 +24,7 @@
 
 #include "util/inotify.h"
 #include "util/util.h"
+#include "util/dlinklist.h"
 
 /* For parent directories, we want to know if a file was moved there or
  * created there
@@ -607,3 +608,213 @@ struct snotify_ctx *_snotify_create(TALLOC_CTX *mem_ctx,
 
     return snctx;
 }
+
+/* A file of a snotify group */
+struct snotify_group_entry {
+    struct snotify_group_entry *prev;
+    struct snotify_group_entry *next;
+
+    struct snotify_group *group;
+    /* The name the caller added the file with */
+    const char *filename;
+    /* Whether the file changed in the current burst of events */
+    bool changed;
+};
+
+struct snotify_group {
+    struct tevent_context *ev;
+
+    struct timeval quiet;
+    struct timeval max_wait;
+
+    snotify_cb_fn pending_fn;
+    snotify_group_cb_fn fn;
+    const char *fn_name;
+    void *pvt;
+
+    struct snotify_group_entry *entries;
+
+    /* Set while a burst of events is being collected */
+    struct tevent_timer *te;
+    /* The latest time the callback of the current burst is invoked */
+    struct timeval deadline;
+    uint32_t caught_flags;
+};
+
+static void snotify_group_process(struct tevent_context *ev,
+                                  struct tevent_timer *te,
+                                  struct timeval t,
+                                  void *ptr)
+{
+    struct snotify_group *group;
+    struct snotify_group_entry *entry;
+    const char **filenames;
+    uint32_t caught_flags;
+    size_t count = 0;
+
+    group = talloc_get_type(ptr, struct snotify_group);
+    if (group == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Bad pointer\n");
+        return;
+    }
+    group->te = NULL;
+
+    DLIST_FOR_EACH(entry, group->entries) {
+        if (entry->changed) {
+            count++;
+        }
+    }
+
+    filenames = talloc_zero_array(NULL, const char *, count + 1);
+    if (filenames == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Cannot list the changed files, reporting all of them\n");
+    }
+
+    /* Events caught by the callback start a new burst */
+    count = 0;
+    DLIST_FOR_EACH(entry, group->entries) {
+        if (entry->changed && filenames != NULL) {
+            filenames[count++] = entry->filename;
+        }
+        entry->changed = false;
+    }
+    caught_flags = group->caught_flags;
+    group->caught_flags = 0;
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Calling %s for %zu changed files with combined flags 0x%X\n",
+          group->fn_name, count, caught_flags);
+
+    group->fn(filenames, caught_flags, group->pvt);
+
+    talloc_free(filenames);
+}
+
+static int snotify_group_entry_cb(const char *filename,
+                                  uint32_t caught_flags,
+                                  void *pvt)
+{
+    struct snotify_group_entry *entry;
+    struct snotify_group *group;
+    struct timeval now;
+    struct timeval tv;
+
+    entry = talloc_get_type(pvt, struct snotify_group_entry);
+    if (entry == NULL) {
+        return EINVAL;
+    }
+    group = entry->group;
+
+    now = tevent_timeval_current();
+    if (group->te == NULL) {
+        group->deadline = tevent_timeval_add(&now,
+                                             group->max_wait.tv_sec,
+                                             group->max_wait.tv_usec);
+    }
+
+    group->caught_flags |= caught_flags;
+    if (entry->changed == false) {
+        entry->changed = true;
+        if (group->pending_fn != NULL) {
+            group->pending_fn(entry->filename, caught_flags, group->pvt);
+        }
+    }
+
+    /* Postpone the callback until the files are quiet, but not beyond the
+     * deadline of the burst */
+    tv = tevent_timeval_add(&now, group->quiet.tv_sec, group->quiet.tv_usec);
+    if (tevent_timeval_compare(&tv, &group->deadline) > 0) {
+        tv = group->deadline;
+    }
+
+    talloc_zfree(group->te);
+    group->te = tevent_add_timer(group->ev, group, tv,
+                                 snotify_group_process, group);
+    if (group->te == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Unable to queue file update!\n");
+        /* Rather report the changes early than never */
+        snotify_group_process(group->ev, NULL, now, group);
+        return ENOMEM;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "Event for %s, running %s at %ld.%06ld\n",
+          entry->filename, group->fn_name,
+          (long) tv.tv_sec, (long) tv.tv_usec);
+    return EOK;
+}
+
+struct snotify_group *_snotify_group_create(TALLOC_CTX *mem_ctx,
+                                            struct tevent_context *ev,
+                                            struct timeval *quiet,
+                                            struct timeval *max_wait,
+                                            snotify_cb_fn pending_fn,
+                                            snotify_group_cb_fn fn,
+                                            const char *fn_name,
+                                            void *pvt)
+{
+    struct snotify_group *group;
+
+    group = talloc_zero(mem_ctx, struct snotify_group);
+    if (group == NULL) {
+        return NULL;
+    }
+
+    group->ev = ev;
+    if (quiet != NULL) {
+        group->quiet = *quiet;
+    }
+    group->max_wait = group->quiet;
+    if (max_wait != NULL
+            && tevent_timeval_compare(max_wait, &group->quiet) > 0) {
+        group->max_wait = *max_wait;
+    }
+
+    group->pending_fn = pending_fn;
+    group->fn = fn;
+    group->fn_name = fn_name;
+    group->pvt = pvt;
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Created a watch group using function %s after quiet period "
+          "%ld.%06ld and at most %ld.%06ld\n",
+          fn_name,
+          (long) group->quiet.tv_sec, (long) group->quiet.tv_usec,
+          (long) group->max_wait.tv_sec, (long) group->max_wait.tv_usec);
+
+    return group;
+}
+
+errno_t snotify_group_add(struct snotify_group *group,
+                          uint16_t snotify_flags,
+                          const char *filename,
+                          uint32_t mask)
+{
+    struct snotify_group_entry *entry;
+    struct snotify_ctx *snctx;
+
+    entry = talloc_zero(group, struct snotify_group_entry);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+    entry->group = group;
+
+    entry->filename = talloc_strdup(entry, filename);
+    if (entry->filename == NULL) {
+        talloc_free(entry);
+        return ENOMEM;
+    }
+
+    /* The watch of the file reports its events right away, the group
+     * does the batching */
+    snctx = snotify_create(entry, group->ev, snotify_flags, filename, NULL,
+                           mask, snotify_group_entry_cb, entry);
+    if (snctx == NULL) {
+        talloc_free(entry);
+        return EIO;
+    }
+
+    DLIST_ADD_END(group->entries, entry, struct snotify_group_entry *);
+    return EOK;
+}
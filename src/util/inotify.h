@@ -22,6 +22,8 @@
 #include <tevent.h>
 #include <sys/inotify.h>
 
+#include "util/util_errors.h"
+
 
 typedef int (*snotify_cb_fn)(const char *filename,
                              uint32_t caught_flags,
@@ -58,4 +60,51 @@ struct snotify_ctx *_snotify_create(TALLOC_CTX *mem_ctx,
 #define snotify_create(mem_ctx, ev, snotify_flags, filename, delay, mask, fn, pvt) \
         _snotify_create(mem_ctx, ev, snotify_flags, filename, delay, mask, fn, #fn, pvt);
 
+/* Called once the files of a group were quiet for long enough. The
+ * filenames are the ones passed to snotify_group_add() of the files which
+ * changed, NULL-terminated, and the caught flags of all of them are OR-ed.
+ * If the list cannot be built, filenames is NULL and any of the files of
+ * the group might have changed.
+ */
+typedef int (*snotify_group_cb_fn)(const char **filenames,
+                                   uint32_t caught_flags,
+                                   void *pvt);
+
+struct snotify_group;
+
+/*
+ * Set up a group of watches whose notifications are coalesced. Tools often
+ * rewrite several files in a row, with a number of events for each of
+ * them, so instead of the fixed delay of a single watch the group waits
+ * until none of its files changed for the quiet period. To not starve the
+ * caller of updates while a file keeps changing, the callback is invoked
+ * at the latest max_wait after the first event of the burst. Without
+ * max_wait, the callback is invoked one quiet period after the first event,
+ * like with the delay of a single watch.
+ *
+ * If pending_fn is set, it is invoked as soon as the first event of a burst
+ * is caught for a file, so the caller can tell its consumers that an update
+ * is coming.
+ */
+struct snotify_group *_snotify_group_create(TALLOC_CTX *mem_ctx,
+                                            struct tevent_context *ev,
+                                            struct timeval *quiet,
+                                            struct timeval *max_wait,
+                                            snotify_cb_fn pending_fn,
+                                            snotify_group_cb_fn fn,
+                                            const char *fn_name,
+                                            void *pvt);
+
+#define snotify_group_create(mem_ctx, ev, quiet, max_wait, pending_fn, fn, pvt) \
+        _snotify_group_create(mem_ctx, ev, quiet, max_wait, pending_fn, fn, #fn, pvt)
+
+/*
+ * Add a watch for filename to the group, the parameters are the same as
+ * for snotify_create().
+ */
+errno_t snotify_group_add(struct snotify_group *group,
+                          uint16_t snotify_flags,
+                          const char *filename,
+                          uint32_t mask);
+
 #endif /*  __INOTIFY_H_ */
@@ -22,7 +22,10 @@
 #ifndef _MMAP_CACHE_H_
 #define _MMAP_CACHE_H_
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "shared/murmurhash3.h"
+#include "shared/wyhash.h"
 
 
 /* NOTE: all the code here assumes that writing a uint32_t nto mmapped
@@ -38,8 +41,20 @@ typedef uint32_t rel_ptr_t;
 #define MC_ALIGN64(size) ( ((size) + MC_64 -1) & (~(MC_64 -1)) )
 #define MC_HEADER_SIZE MC_ALIGN64(sizeof(struct sss_mc_header))
 
-#define MC_HT_SIZE(elems) ( (elems) * MC_32 )
-#define MC_HT_ELEMS(size) ( (size) / MC_32 )
+/* The hash table is an open addressing table made of cache line sized
+ * buckets. Each bucket holds MC_BUCKET_ENTRIES fingerprints followed by
+ * the slots of the records they refer to, so a lookup can compare all the
+ * fingerprints of a bucket at once before touching any record. Probing
+ * moves on to the next bucket only if the current one has no empty entry. */
+#define MC_BUCKET_ENTRIES 8
+#define MC_HT_SIZE(buckets) ( (buckets) * sizeof(struct sss_mc_bucket) )
+#define MC_HT_BUCKETS(size) ( (size) / sizeof(struct sss_mc_bucket) )
+
+#define MC_FP_EMPTY      ((uint32_t)-1)  /* entry was never used */
+#define MC_FP_TOMBSTONE  ((uint32_t)-2)  /* entry was used and removed */
+/* fingerprint stored for a full 32 bit hash, avoids the marker values */
+#define MC_HASH_TO_FP(hash) \
+    ((hash) >= MC_FP_TOMBSTONE ? (hash) - 2 : (hash))
 
 #define MC_PTR_ADD(ptr, bytes) (void *)((uint8_t *)(ptr) + (bytes))
 #define MC_PTR_DIFF(ptr, base) ((uint8_t *)(ptr) - (uint8_t *)(base))
@@ -75,9 +90,15 @@ typedef uint32_t rel_ptr_t;
                             - MC_PTR_DIFF(rec, (mc_ctx)->data_table))))
 
 
-#define SSS_MC_MAJOR_VNO    1
+#define SSS_MC_MAJOR_VNO    2
 #define SSS_MC_MINOR_VNO    1
 
+/* Hash functions of the keys. The responder records the one it uses in the
+ * header, so the clients always compute the same hashes. */
+#define SSS_MC_HASH_MURMUR3     0
+#define SSS_MC_HASH_WYHASH      1
+#define SSS_MC_HASH_MAX         SSS_MC_HASH_WYHASH
+
 #define SSS_MC_HEADER_UNINIT    0   /* after ftruncate or before reset */
 #define SSS_MC_HEADER_ALIVE     1   /* current and in use */
 #define SSS_MC_HEADER_RECYCLED  2   /* file was recycled, reopen asap */
@@ -95,21 +116,27 @@ struct sss_mc_header {
     rel_ptr_t data_table;   /* data table pointer relative to mmap base */
     rel_ptr_t free_table;   /* free table pointer relative to mmap base */
     rel_ptr_t hash_table;   /* hash table pointer relative to mmap base */
-    rel_ptr_t reserved;     /* reserved for future changes */
+    uint32_t generation;    /* bumped on every header update, lets readers
+                             * skip re-validating an unchanged header */
+    uint32_t hash_alg;      /* hash function of the keys, SSS_MC_HASH_* */
     uint32_t b2;            /* barrier 2 */
 };
 
+struct sss_mc_bucket {
+    uint32_t fp[MC_BUCKET_ENTRIES];     /* fingerprints, see MC_HASH_TO_FP */
+    rel_ptr_t slot[MC_BUCKET_ENTRIES];  /* slot of the record in data_table */
+};
+
 struct sss_mc_rec {
     uint32_t b1;            /* barrier 1 */
     uint32_t len;           /* total record length including record data */
     uint64_t expire;        /* record expiration time (cast to time_t) */
-    rel_ptr_t next1;        /* ptr of next record rel to data_table */
-                            /* next1 is related to hash1 */
-    rel_ptr_t next2;        /* ptr of next record rel to data_table */
-                            /* next2 is related to hash2 */
-    uint32_t hash1;         /* val of first hash (usually name of record) */
-    uint32_t hash2;         /* val of second hash (usually id of record) */
-    uint32_t padding;       /* padding & reserved for future changes */
+    rel_ptr_t next1;        /* unused since version 2, kept for layout */
+    rel_ptr_t next2;        /* unused since version 2, kept for layout */
+    uint32_t hash1;         /* full first hash (usually name of record) */
+    uint32_t hash2;         /* full second hash (usually id of record) */
+    uint32_t hash3;         /* full third hash (uid of initgroups records),
+                             * MC_INVALID_VAL32 if the record has none */
     uint32_t b2;            /* barrier 2 - 32 bytes mark, fits a slot */
     char data[0];
 };
@@ -143,10 +170,210 @@ struct sss_mc_initgr_data {
     uint32_t num_groups;    /* number of groups */
     uint32_t gids[0];       /* array of all groups
                              * string with name and unique_name is stored
-                             * after gids */
+                             * after gids, followed by the uid as decimal
+                             * string if hash3 is set */
+};
+
+struct sss_mc_sid_data {
+    rel_ptr_t name;         /* ptr to name string, rel. to struct base addr */
+    rel_ptr_t sid;          /* ptr to SID string, rel. to struct base addr */
+    uint32_t id_type;       /* enum sss_id_type of the object */
+    uint32_t strs_len;      /* length of strs */
+    char strs[0];           /* concatenation of all strings, each string is
+                             * zero terminated ordered as follows:
+                             * sid, name */
+};
+
+struct sss_mc_reply_data {
+    rel_ptr_t key;          /* ptr to key string, rel. to struct base addr */
+    rel_ptr_t reply;        /* ptr to reply body, rel. to struct base addr */
+    uint32_t reply_len;     /* length of the reply body */
+    uint32_t strs_len;      /* length of strs */
+    char strs[0];           /* key string followed by the reply body as
+                             * sent by the responder over the socket */
 };
 
 #pragma pack()
 
+/* The services, hosts and netgroups caches store whole replies. Their
+ * records are keyed by the command and the hex encoded request body, so
+ * the client can compute the key from the request it would have sent. */
+#define MC_REPLY_MAX_REQ_LEN 1024
+#define MC_REPLY_KEY_SIZE(req_len) (8 + 1 + 2 * (req_len) + 1)
+
+static inline void sss_mc_reply_key(uint32_t cmd,
+                                    const uint8_t *req, size_t req_len,
+                                    char *key)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t i;
+
+    for (i = 0; i < 8; i++) {
+        key[i] = hex[(cmd >> (28 - 4 * i)) & 0xf];
+    }
+    key[8] = ':';
+    for (i = 0; i < req_len; i++) {
+        key[9 + 2 * i] = hex[req[i] >> 4];
+        key[10 + 2 * i] = hex[req[i] & 0xf];
+    }
+    key[9 + 2 * req_len] = '\0';
+}
+
+/* Usage counters of a memory cache. They are not kept in the cache file,
+ * which clients can only read. Instead every process that uses a cache
+ * counts in a file of its own effective user, "<cache name>.<euid>" in
+ * SSS_NSS_MCACHE_STATS_DIR, so nobody can write to (or truncate) the
+ * counters of another user. sssctl memcache-stats sums the files up. */
+#define SSS_NSS_MCACHE_STATS_DIR SSS_NSS_MCACHE_DIR"/stats"
+#define SSS_MC_STATS_VNO 1
+
+struct sss_mc_counters {
+    uint32_t version;           /* SSS_MC_STATS_VNO */
+    uint32_t reserved;
+    /* updated by clients */
+    uint64_t lookups;           /* all lookups done in the cache */
+    uint64_t hits;              /* lookups answered from the cache */
+    uint64_t misses;            /* lookups that found no record */
+    uint64_t stale_hits;        /* lookups that found an expired record */
+    uint64_t barrier_retries;   /* reads repeated because of a writer */
+    /* updated by the responder */
+    uint64_t stores;            /* records stored or refreshed */
+    uint64_t evictions;         /* valid records overwritten */
+    uint64_t invalidations;     /* records explicitly invalidated */
+};
+
+/* Counters are statistics only, so they are updated with relaxed atomics
+ * which are as cheap as a plain increment on most CPUs */
+#ifdef __ATOMIC_RELAXED
+#define MC_STATS_INC(counters, field) do { \
+    if ((counters) != NULL) { \
+        __atomic_fetch_add(&(counters)->field, 1, __ATOMIC_RELAXED); \
+    } \
+} while (0)
+#else
+#define MC_STATS_INC(counters, field) do { \
+    if ((counters) != NULL) { \
+        __sync_fetch_and_add(&(counters)->field, 1); \
+    } \
+} while (0)
+#endif
+
+static inline uint32_t sss_mc_hash_key(uint32_t hash_alg, uint32_t seed,
+                                       const char *key, size_t len)
+{
+    if (hash_alg == SSS_MC_HASH_WYHASH) {
+        return wyhash32(key, len, seed);
+    }
+
+    return murmurhash3(key, len, seed);
+}
+
+static inline uint32_t sss_mc_hash_to_bucket(uint32_t hash, uint32_t ht_size)
+{
+    return hash % MC_HT_BUCKETS(ht_size);
+}
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Memory cache readers never modify the mmapped area, they only need the
+ * loads between two barrier reads not to be reordered around them, the same
+ * way a seqlock reader does. An acquire fence is enough for that and,
+ * unlike a full barrier, is free on strongly ordered CPUs. */
+#ifdef __ATOMIC_ACQUIRE
+#define MC_READ_BARRIER() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#else
+#define MC_READ_BARRIER() __sync_synchronize()
+#endif
+
+/* Returns a bitmask of the entries in the bucket whose fingerprint is fp */
+static inline uint32_t sss_mc_bucket_match(const struct sss_mc_bucket *b,
+                                           uint32_t fp)
+{
+#if defined(__SSE2__)
+    __m128i key = _mm_set1_epi32((int)fp);
+    __m128i lo = _mm_loadu_si128((const __m128i *)&b->fp[0]);
+    __m128i hi = _mm_loadu_si128((const __m128i *)&b->fp[4]);
+
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, key)))
+           | (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, key))) << 4);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t key = vdupq_n_u32(fp);
+    uint32x4_t mask = vld1q_u32(bits);
+    uint32x4_t lo = vandq_u32(vceqq_u32(vld1q_u32(&b->fp[0]), key), mask);
+    uint32x4_t hi = vandq_u32(vceqq_u32(vld1q_u32(&b->fp[4]), key), mask);
+
+    return vaddvq_u32(lo) | (vaddvq_u32(hi) << 4);
+#else
+    uint32_t mask = 0;
+    int i;
+
+    for (i = 0; i < MC_BUCKET_ENTRIES; i++) {
+        if (b->fp[i] == fp) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/* State of a lookup walking the probe sequence of a hash */
+struct sss_mc_probe {
+    uint32_t fp;            /* fingerprint searched for */
+    uint32_t bucket;        /* current bucket */
+    uint32_t visited;       /* number of buckets visited */
+    uint32_t mask;          /* matches left in the current bucket */
+    bool last;              /* current bucket ends the probe sequence */
+};
+
+static inline void sss_mc_probe_init(struct sss_mc_probe *p,
+                                     uint32_t hash, uint32_t ht_size)
+{
+    p->fp = MC_HASH_TO_FP(hash);
+    p->bucket = sss_mc_hash_to_bucket(hash, ht_size);
+    p->visited = 0;
+    p->mask = 0;
+    p->last = false;
+}
+
+/* Returns the slot of the next entry matching the probed fingerprint or
+ * MC_INVALID_VAL when there are no more candidates. The caller must verify
+ * the record as the fingerprint may collide or the entry may be stale. */
+static inline uint32_t sss_mc_probe_next(struct sss_mc_probe *p,
+                                         const struct sss_mc_bucket *table,
+                                         uint32_t ht_size)
+{
+    const struct sss_mc_bucket *b;
+    uint32_t buckets = MC_HT_BUCKETS(ht_size);
+    uint32_t slot;
+    int i;
+
+    while (p->mask == 0) {
+        if (p->last || p->visited >= buckets) {
+            return MC_INVALID_VAL;
+        }
+        if (p->visited > 0) {
+            p->bucket = (p->bucket + 1) % buckets;
+        }
+        p->visited++;
+
+        b = &table[p->bucket];
+        p->mask = sss_mc_bucket_match(b, p->fp);
+        /* a bucket with an empty entry was never full, so the key cannot
+         * have been pushed to the following buckets */
+        p->last = (sss_mc_bucket_match(b, MC_FP_EMPTY) != 0);
+    }
+
+    i = __builtin_ctz(p->mask);
+    p->mask &= p->mask - 1;
+
+    MC_READ_BARRIER();
+    slot = table[p->bucket].slot[i];
+    return slot;
+}
 
 #endif /* _MMAP_CACHE_H_ */
@@ -18,6 +18,9 @@
 #ifndef __PROBES_H_
 #define __PROBES_H_
 
+/* the profiler of sss_prof.h is hooked up next to some of the probes */
+#include "util/sss_prof.h"
+
 #ifdef HAVE_SYSTEMTAP
 
 #include "stap_generated_probes.h"
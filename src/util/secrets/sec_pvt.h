@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/types.h>
+#include <dhash.h>
 
 #include "util/secrets/secrets.h"
 
@@ -43,6 +44,10 @@ struct sss_sec_ctx {
 
     struct sss_sec_quota *quota_secrets;
     struct sss_sec_quota *quota_kcm;
+
+    /* Number of secrets stored under the hives and the per-UID
+     * containers, keyed by the casefolded DN, see local_db_count() */
+    hash_table_t *counters;
 };
 
 struct sss_sec_req {
@@ -26,6 +26,7 @@
 #include "config.h"
 
 #include "util/util.h"
+#include "util/sss_ptr_hash.h"
 #include "util/crypto/sss_crypto.h"
 #include "util/secrets/sec_pvt.h"
 #include "util/secrets/secrets.h"
@@ -253,29 +254,105 @@ done:
     return ret;
 }
 
-static int local_db_check_number_of_secrets(TALLOC_CTX *mem_ctx,
-                                            struct sss_sec_req *req)
+static struct ldb_dn *per_uid_container(TALLOC_CTX *mem_ctx,
+                                        struct ldb_dn *req_dn)
+{
+    int user_comp;
+    int num_comp;
+    struct ldb_dn *uid_base_dn;
+
+    uid_base_dn = ldb_dn_copy(mem_ctx, req_dn);
+    if (uid_base_dn == NULL) {
+        return NULL;
+    }
+
+    /* Remove all the components up to the per-user base path which consists
+     * of three components:
+     *  cn=<uidnumber>,cn=users,cn=secrets
+     */
+    user_comp = ldb_dn_get_comp_num(uid_base_dn) - 3;
+
+    if (!ldb_dn_remove_child_components(uid_base_dn, user_comp)) {
+        DEBUG(SSSDBG_OP_FAILURE, "Cannot remove child components\n");
+        talloc_free(uid_base_dn);
+        return NULL;
+    }
+
+    num_comp = ldb_dn_get_comp_num(uid_base_dn);
+    if (num_comp != 3) {
+        DEBUG(SSSDBG_OP_FAILURE, "Expected 3 components got %d\n", num_comp);
+        talloc_free(uid_base_dn);
+        return NULL;
+    }
+
+    return uid_base_dn;
+}
+
+/* The quota checks used to count the secrets of the hive and of the client
+ * on every write. The counts are kept in memory now, together with the
+ * sequence number of the database they were read at. Any write to the
+ * database which did not go through this context, such as one made by
+ * another process sharing secrets.ldb, changes the sequence number and makes
+ * the count to be read again. */
+struct sss_sec_counter {
+    uint64_t seq;
+    int count;
+};
+
+static errno_t local_db_seq(struct sss_sec_ctx *sec_ctx, uint64_t *_seq)
+{
+    int ret;
+
+    ret = ldb_sequence_number(sec_ctx->ldb, LDB_SEQ_HIGHEST_SEQ, _seq);
+    if (ret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to read sequence number [%d]: %s\n",
+              ret, ldb_errstring(sec_ctx->ldb));
+        return sss_ldb_error_to_errno(ret);
+    }
+
+    return EOK;
+}
+
+static int local_db_count(struct sss_sec_ctx *sec_ctx,
+                          struct ldb_dn *basedn,
+                          int *_count)
 {
     TALLOC_CTX *tmp_ctx;
     static const char *attrs[] = { NULL };
+    struct sss_sec_counter *counter;
     struct ldb_result *res = NULL;
-    struct ldb_dn *dn;
+    const char *key;
+    uint64_t seq;
     int ret;
 
-    if (req->quota->max_secrets == 0) {
-        return EOK;
+    key = ldb_dn_get_casefold(basedn);
+    if (key == NULL) {
+        return ENOMEM;
     }
 
-    tmp_ctx = talloc_new(mem_ctx);
-    if (!tmp_ctx) return ENOMEM;
+    ret = local_db_seq(sec_ctx, &seq);
+    if (ret != EOK) {
+        return ret;
+    }
 
-    dn = ldb_dn_new(tmp_ctx, req->sctx->ldb, req->basedn);
-    if (!dn) {
-        ret = ENOMEM;
-        goto done;
+    counter = sss_ptr_hash_lookup(sec_ctx->counters, key,
+                                  struct sss_sec_counter);
+    if (counter != NULL && counter->seq == seq) {
+        *_count = counter->count;
+        return EOK;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
     }
 
-    ret = ldb_search(req->sctx->ldb, tmp_ctx, &res, dn, LDB_SCOPE_SUBTREE,
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "Counting [%s] at [%s] with scope=subtree\n",
+          LOCAL_SIMPLE_FILTER, ldb_dn_get_linearized(basedn));
+
+    ret = ldb_search(sec_ctx->ldb, tmp_ctx, &res, basedn, LDB_SCOPE_SUBTREE,
                      attrs, LOCAL_SIMPLE_FILTER);
     if (ret != EOK) {
         DEBUG(SSSDBG_TRACE_LIBS,
@@ -283,14 +360,24 @@ static int local_db_check_number_of_secrets(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    if (res->count >= req->quota->max_secrets) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Cannot store any more secrets as the maximum allowed limit (%d) "
-              "has been reached\n", req->quota->max_secrets);
-        ret = ERR_SEC_INVALID_TOO_MANY_SECRETS;
-        goto done;
+    if (counter == NULL) {
+        counter = talloc_zero(sec_ctx->counters, struct sss_sec_counter);
+        if (counter == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = sss_ptr_hash_add(sec_ctx->counters, key, counter,
+                               struct sss_sec_counter);
+        if (ret != EOK) {
+            talloc_free(counter);
+            goto done;
+        }
     }
 
+    counter->seq = seq;
+    counter->count = res->count;
+    *_count = counter->count;
     ret = EOK;
 
 done:
@@ -298,47 +385,103 @@ done:
     return ret;
 }
 
-static struct ldb_dn *per_uid_container(TALLOC_CTX *mem_ctx,
-                                        struct ldb_dn *req_dn)
+/* Called after an entry was added under basedn (diff > 0) or removed from
+ * it (diff < 0). The counter is only adjusted if the write was the only one
+ * since it was read, otherwise it is read again by the next local_db_count() */
+static void local_db_count_update(struct sss_sec_ctx *sec_ctx,
+                                  struct ldb_dn *basedn,
+                                  int diff)
 {
-    int user_comp;
-    int num_comp;
-    struct ldb_dn *uid_base_dn;
+    struct sss_sec_counter *counter;
+    const char *key;
+    uint64_t seq;
+    errno_t ret;
 
-    uid_base_dn = ldb_dn_copy(mem_ctx, req_dn);
-    if (uid_base_dn == NULL) {
-        return NULL;
+    key = ldb_dn_get_casefold(basedn);
+    if (key == NULL) {
+        return;
     }
 
-    /* Remove all the components up to the per-user base path which consists
-     * of three components:
-     *  cn=<uidnumber>,cn=users,cn=secrets
-     */
-    user_comp = ldb_dn_get_comp_num(uid_base_dn) - 3;
+    counter = sss_ptr_hash_lookup(sec_ctx->counters, key,
+                                  struct sss_sec_counter);
+    if (counter == NULL) {
+        return;
+    }
 
-    if (!ldb_dn_remove_child_components(uid_base_dn, user_comp)) {
-        DEBUG(SSSDBG_OP_FAILURE, "Cannot remove child components\n");
-        talloc_free(uid_base_dn);
-        return NULL;
+    ret = local_db_seq(sec_ctx, &seq);
+    if (ret != EOK || counter->seq + 1 != seq) {
+        sss_ptr_hash_delete(sec_ctx->counters, key, true);
+        return;
     }
 
-    num_comp = ldb_dn_get_comp_num(uid_base_dn);
-    if (num_comp != 3) {
-        DEBUG(SSSDBG_OP_FAILURE, "Expected 3 components got %d\n", num_comp);
-        talloc_free(uid_base_dn);
-        return NULL;
+    counter->seq = seq;
+    counter->count += diff;
+}
+
+static void local_db_counters_update(struct sss_sec_req *req, int diff)
+{
+    struct ldb_dn *dn;
+
+    dn = ldb_dn_new(req, req->sctx->ldb, req->basedn);
+    if (dn != NULL) {
+        local_db_count_update(req->sctx, dn, diff);
+        talloc_free(dn);
     }
 
-    return uid_base_dn;
+    dn = per_uid_container(req, req->req_dn);
+    if (dn != NULL) {
+        local_db_count_update(req->sctx, dn, diff);
+        talloc_free(dn);
+    }
+}
+
+static int local_db_check_number_of_secrets(TALLOC_CTX *mem_ctx,
+                                            struct sss_sec_req *req)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_dn *dn;
+    int count;
+    int ret;
+
+    if (req->quota->max_secrets == 0) {
+        return EOK;
+    }
+
+    tmp_ctx = talloc_new(mem_ctx);
+    if (!tmp_ctx) return ENOMEM;
+
+    dn = ldb_dn_new(tmp_ctx, req->sctx->ldb, req->basedn);
+    if (!dn) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = local_db_count(req->sctx, dn, &count);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (count >= req->quota->max_secrets) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot store any more secrets as the maximum allowed limit (%d) "
+              "has been reached\n", req->quota->max_secrets);
+        ret = ERR_SEC_INVALID_TOO_MANY_SECRETS;
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
 }
 
 static int local_db_check_peruid_number_of_secrets(TALLOC_CTX *mem_ctx,
                                                    struct sss_sec_req *req)
 {
     TALLOC_CTX *tmp_ctx;
-    static const char *attrs[] = { NULL };
-    struct ldb_result *res = NULL;
     struct ldb_dn *cli_basedn = NULL;
+    int count;
     int ret;
 
     if (req->quota->max_uid_secrets == 0) {
@@ -356,15 +499,12 @@ static int local_db_check_peruid_number_of_secrets(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = ldb_search(req->sctx->ldb, tmp_ctx, &res, cli_basedn, LDB_SCOPE_SUBTREE,
-                     attrs, LOCAL_SIMPLE_FILTER);
+    ret = local_db_count(req->sctx, cli_basedn, &count);
     if (ret != EOK) {
-        DEBUG(SSSDBG_TRACE_LIBS,
-              "ldb_search returned %d: %s\n", ret, ldb_strerror(ret));
         goto done;
     }
 
-    if (res->count >= req->quota->max_uid_secrets) {
+    if (count >= req->quota->max_uid_secrets) {
         DEBUG(SSSDBG_OP_FAILURE,
               "Cannot store any more secrets for this client (basedn %s) "
               "as the maximum allowed limit (%d) has been reached\n",
@@ -485,6 +625,7 @@ static int local_db_create(struct sss_sec_req *req)
         goto done;
     }
 
+    local_db_counters_update(req, 0);
     ret = EOK;
 
 done:
@@ -697,6 +838,94 @@ static int set_quotas(struct sss_sec_ctx *sec_ctx,
     return EOK;
 }
 
+/* Existence of a parent container is checked by a base search and only
+ * needs the DN index. The other operations look for the entries of one
+ * container or for the secrets of one type, which ldb can only answer
+ * without reading the whole database with the one-level and the type
+ * index. */
+static int local_db_setup_indexes(struct ldb_context *ldb)
+{
+    TALLOC_CTX *tmp_ctx;
+    static const char *attrs[] = { "@IDXATTR", "@IDXONE", NULL };
+    struct ldb_message_element *el;
+    struct ldb_message *msg;
+    struct ldb_result *res;
+    bool has_type = false;
+    int ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    msg = ldb_msg_new(tmp_ctx);
+    if (msg == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    msg->dn = ldb_dn_new(msg, ldb, "@INDEXLIST");
+    if (msg->dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_search(ldb, tmp_ctx, &res, msg->dn, LDB_SCOPE_BASE, attrs, NULL);
+    if (ret == LDB_SUCCESS && res->count == 1) {
+        el = ldb_msg_find_element(res->msgs[0], "@IDXATTR");
+        for (unsigned i = 0; el != NULL && i < el->num_values; i++) {
+            if (strcasecmp((const char *)el->values[i].data,
+                           SEC_ATTR_TYPE) == 0) {
+                has_type = true;
+            }
+        }
+
+        if (has_type
+                && ldb_msg_find_element(res->msgs[0], "@IDXONE") != NULL) {
+            ret = EOK;
+            goto done;
+        }
+    }
+
+    ret = ldb_msg_add_empty(msg, "@IDXATTR", LDB_FLAG_MOD_REPLACE, NULL);
+    if (ret == LDB_SUCCESS) {
+        ret = ldb_msg_add_string(msg, "@IDXATTR", SEC_ATTR_TYPE);
+    }
+    if (ret == LDB_SUCCESS) {
+        ret = ldb_msg_add_empty(msg, "@IDXONE", LDB_FLAG_MOD_REPLACE, NULL);
+    }
+    if (ret == LDB_SUCCESS) {
+        ret = ldb_msg_add_string(msg, "@IDXONE", "1");
+    }
+    if (ret != LDB_SUCCESS) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = ldb_modify(ldb, msg);
+    if (ret == LDB_ERR_NO_SUCH_OBJECT) {
+        /* a new database, no flags on add */
+        for (unsigned i = 0; i < msg->num_elements; i++) {
+            msg->elements[i].flags = 0;
+        }
+        ret = ldb_add(ldb, msg);
+    }
+    if (ret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to set up the secrets indexes [%d]: %s\n",
+              ret, ldb_errstring(ldb));
+        ret = sss_ldb_error_to_errno(ret);
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Set up the secrets indexes\n");
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 errno_t sss_sec_init(TALLOC_CTX *mem_ctx,
                      struct sss_sec_hive_config **config_list,
                      struct sss_sec_ctx **_sec_ctx)
@@ -743,6 +972,19 @@ errno_t sss_sec_init(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = local_db_setup_indexes(sec_ctx->ldb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Secrets will be looked up without indexes\n");
+        /* Not fatal */
+    }
+
+    sec_ctx->counters = sss_ptr_hash_create(sec_ctx, NULL, NULL);
+    if (sec_ctx->counters == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
     ret = lcl_read_mkey(sec_ctx, &sec_ctx->master_key);
     if (ret != EOK) {
         DEBUG(SSSDBG_OP_FAILURE, "Cannot get the master key\n");
@@ -937,14 +1179,33 @@ static char *local_dn_to_path(TALLOC_CTX *mem_ctx,
     return path;
 }
 
+static int local_key_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
 errno_t sss_sec_list(TALLOC_CTX *mem_ctx,
                      struct sss_sec_req *req,
                      char ***_keys,
                      size_t *_num_keys)
+{
+    return sss_sec_list_page(mem_ctx, req, NULL, 0, _keys, _num_keys);
+}
+
+errno_t sss_sec_list_page(TALLOC_CTX *mem_ctx,
+                          struct sss_sec_req *req,
+                          const char *after,
+                          size_t limit,
+                          char ***_keys,
+                          size_t *_num_keys)
 {
     TALLOC_CTX *tmp_ctx;
-    static const char *attrs[] = { SEC_ATTR_SECRET, NULL };
+    /* only the DNs are needed, not the (possibly large) payloads */
+    static const char *attrs[] = { NULL };
     struct ldb_result *res;
+    bool paged;
+    size_t start;
+    size_t count;
     char **keys;
     int ret;
 
@@ -952,6 +1213,8 @@ errno_t sss_sec_list(TALLOC_CTX *mem_ctx,
         return EINVAL;
     }
 
+    paged = after != NULL || limit > 0;
+
     tmp_ctx = talloc_new(mem_ctx);
     if (!tmp_ctx) return ENOMEM;
 
@@ -976,7 +1239,7 @@ errno_t sss_sec_list(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    keys = talloc_array(mem_ctx, char *, res->count);
+    keys = talloc_array(tmp_ctx, char *, res->count);
     if (!keys) {
         ret = ENOMEM;
         goto done;
@@ -990,9 +1253,31 @@ errno_t sss_sec_list(TALLOC_CTX *mem_ctx,
         }
     }
 
-    *_keys = keys;
-    DEBUG(SSSDBG_TRACE_LIBS, "Returning %d secrets\n", res->count);
-    *_num_keys = res->count;
+    start = 0;
+    count = res->count;
+    if (paged) {
+        /* ldb returns the entries in no particular order, the cursor is
+         * the last key of the previous page in the sorted list */
+        qsort(keys, res->count, sizeof(char *), local_key_cmp);
+
+        if (after != NULL) {
+            while (start < res->count && strcmp(keys[start], after) <= 0) {
+                start++;
+            }
+        }
+
+        count = res->count - start;
+        if (limit > 0 && count > limit) {
+            count = limit;
+        }
+
+        memmove(keys, keys + start, count * sizeof(char *));
+    }
+
+    *_keys = talloc_steal(mem_ctx, keys);
+    DEBUG(SSSDBG_TRACE_LIBS, "Returning %zu of %u secrets\n",
+          count, res->count);
+    *_num_keys = count;
     ret = EOK;
 
 done:
@@ -1205,6 +1490,7 @@ errno_t sss_sec_put(struct sss_sec_req *req,
         goto done;
     }
 
+    local_db_counters_update(req, 1);
     ret = EOK;
 done:
     talloc_free(msg);
@@ -1338,6 +1624,7 @@ errno_t sss_sec_update(struct sss_sec_req *req,
         goto done;
     }
 
+    local_db_counters_update(req, 0);
     ret = EOK;
 done:
     talloc_free(msg);
@@ -1348,7 +1635,9 @@ errno_t sss_sec_delete(struct sss_sec_req *req)
 {
     TALLOC_CTX *tmp_ctx;
     static const char *attrs[] = { NULL };
+    static const char *type_attrs[] = { SEC_ATTR_TYPE, NULL };
     struct ldb_result *res;
+    const char *type = NULL;
     int ret;
 
     if (req == NULL) {
@@ -1361,18 +1650,31 @@ errno_t sss_sec_delete(struct sss_sec_req *req)
     if (!tmp_ctx) return ENOMEM;
 
     DEBUG(SSSDBG_TRACE_INTERNAL,
-          "Searching for [%s] at [%s] with scope=base\n",
-          LOCAL_CONTAINER_FILTER, ldb_dn_get_linearized(req->req_dn));
+          "Searching for [%s] with scope=base\n",
+          ldb_dn_get_linearized(req->req_dn));
 
     ret = ldb_search(req->sctx->ldb, tmp_ctx, &res, req->req_dn, LDB_SCOPE_BASE,
-                     attrs, LOCAL_CONTAINER_FILTER);
-    if (ret != EOK) {
+                     type_attrs, NULL);
+    if (ret == LDB_ERR_NO_SUCH_OBJECT) {
+        ret = ENOENT;
+        goto done;
+    } else if (ret != EOK) {
         DEBUG(SSSDBG_TRACE_LIBS,
               "ldb_search returned %d: %s\n", ret, ldb_strerror(ret));
         goto done;
     }
 
     if (res->count == 1) {
+        type = ldb_msg_find_attr_as_string(res->msgs[0], SEC_ATTR_TYPE, NULL);
+        type = talloc_strdup(tmp_ctx, type == NULL ? "" : type);
+        if (type == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    if (type != NULL && strcmp(type, "container") == 0) {
+        /* answered from the one-level index */
         DEBUG(SSSDBG_TRACE_INTERNAL,
               "Searching for children of [%s]\n", ldb_dn_get_linearized(req->req_dn));
         ret = ldb_search(req->sctx->ldb, tmp_ctx, &res, req->req_dn, LDB_SCOPE_ONELEVEL,
@@ -1405,6 +1707,16 @@ errno_t sss_sec_delete(struct sss_sec_req *req)
               "LDB returned unexpected error: [%s]\n",
                ldb_strerror(ret));
     }
+
+    if (ret == LDB_SUCCESS) {
+        if (type != NULL
+                && (strcmp(type, "simple") == 0
+                    || strcmp(type, "binary") == 0)) {
+            local_db_counters_update(req, -1);
+        } else {
+            local_db_counters_update(req, 0);
+        }
+    }
     ret = sss_ldb_error_to_errno (ret);
 
 done:
@@ -92,6 +92,15 @@ errno_t sss_sec_list(TALLOC_CTX *mem_ctx,
                      char ***_keys,
                      size_t *num_keys);
 
+/* Like sss_sec_list() but returns the keys sorted, only those following
+ * the key after (if not NULL) and at most limit of them (if not 0). */
+errno_t sss_sec_list_page(TALLOC_CTX *mem_ctx,
+                          struct sss_sec_req *req,
+                          const char *after,
+                          size_t limit,
+                          char ***_keys,
+                          size_t *_num_keys);
+
 errno_t sss_sec_get(TALLOC_CTX *mem_ctx,
                     struct sss_sec_req *req,
                     uint8_t **_secret,
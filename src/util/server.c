@@ -32,6 +32,7 @@
 #include <signal.h>
 #include <ldb.h>
 #include "util/util.h"
+#include "util/sss_prof.h"
 #include "confdb/confdb.h"
 
 #ifdef HAVE_PRCTL
@@ -443,6 +444,44 @@ static const char *get_pid_path(void)
 #endif
 }
 
+/* The debug messages of an event are written out together before the loop
+ * waits for the next one. The trace ID set while handling an event does not
+ * apply to the next one. */
+static void server_tevent_trace(enum tevent_trace_point point,
+                                void *private_data)
+{
+    switch (point) {
+    case TEVENT_TRACE_BEFORE_WAIT:
+        sss_debug_flush();
+        break;
+    case TEVENT_TRACE_AFTER_LOOP_ONCE:
+        debug_trace_id = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+static void server_debug_backtrace(struct tevent_context *ev,
+                                   struct tevent_signal *se,
+                                   int signum,
+                                   int count,
+                                   void *siginfo,
+                                   void *private_data)
+{
+    sss_debug_backtrace_dump();
+}
+
+static void server_profile(struct tevent_context *ev,
+                           struct tevent_signal *se,
+                           int signum,
+                           int count,
+                           void *siginfo,
+                           void *private_data)
+{
+    sss_prof_toggle();
+}
+
 int server_setup(const char *name, int flags,
                  uid_t uid, gid_t gid,
                  const char *conf_entry,
@@ -558,6 +597,22 @@ int server_setup(const char *name, int flags,
     ctx->parent_pid = getppid();
     ctx->event_ctx = event_ctx;
 
+    tevent_set_trace_callback(event_ctx, server_tevent_trace, NULL);
+    sss_debug_buffer_enable();
+    sss_debug_backtrace_enable();
+
+    tes = tevent_add_signal(event_ctx, event_ctx, SSS_DEBUG_BACKTRACE_SIGNAL,
+                            0, server_debug_backtrace, NULL);
+    if (tes == NULL) {
+        return EIO;
+    }
+
+    tes = tevent_add_signal(event_ctx, event_ctx, SSS_PROF_SIGNAL,
+                            0, server_profile, NULL);
+    if (tes == NULL) {
+        return EIO;
+    }
+
     /* Set up an event handler for a SIGINT */
     tes = tevent_add_signal(event_ctx, event_ctx, SIGINT, 0,
                             default_quit, ctx);
@@ -585,6 +640,15 @@ int server_setup(const char *name, int flags,
         return ret;
     }
 
+    /* The options are read from memory until the process enters its
+     * main loop, see server_loop() */
+    ret = confdb_snapshot_load(ctx->confdb_ctx);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to load the confdb snapshot "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        /* Non-fatal, continue */
+    }
+
     if (debug_level == SSSDBG_UNRESOLVED) {
         /* set debug level if any in conf_entry */
         ret = confdb_get_int(ctx->confdb_ctx, conf_entry,
@@ -725,6 +789,10 @@ int server_setup(const char *name, int flags,
 
 void server_loop(struct main_context *main_ctx)
 {
+    /* Options read later, e.g. of new subdomains, may have been changed
+     * in the meantime */
+    confdb_snapshot_drop(main_ctx->confdb_ctx);
+
     /* wait for events - this is where the server sits for most of its
        life */
     tevent_loop_wait(main_ctx->event_ctx);
@@ -105,6 +105,8 @@ const char *sss_cmd2str(enum sss_cli_command cmd)
         return "SSS_NSS_GETNETGRENT";
     case SSS_NSS_ENDNETGRENT:
         return "SSS_NSS_ENDNETGRENT";
+    case SSS_NSS_INNETGR:
+        return "SSS_NSS_INNETGR";
     /* SSS_NSS_INNETGR:
         return "SSS_NSS_INNETGR";
         break; */
@@ -178,6 +180,10 @@ const char *sss_cmd2str(enum sss_cli_command cmd)
         return "SSS_SUDO_GET_SUDORULES";
     case SSS_SUDO_GET_DEFAULTS:
         return "SSS_SUDO_GET_DEFAULTS";
+    case SSS_SUDO_GET_SUDORULES_BIN:
+        return "SSS_SUDO_GET_SUDORULES_BIN";
+    case SSS_SUDO_GET_DEFAULTS_BIN:
+        return "SSS_SUDO_GET_DEFAULTS_BIN";
 
     /* autofs */
     case SSS_AUTOFS_SETAUTOMNTENT:
@@ -212,6 +218,8 @@ const char *sss_cmd2str(enum sss_cli_command cmd)
         return "SSS_PAM_CHAUTHTOK_PRELIM";
     case SSS_CMD_RENEW:
         return "SSS_CMD_RENEW";
+    case SSS_CMD_FAST_ARMOR:
+        return "SSS_CMD_FAST_ARMOR";
     case SSS_PAM_PREAUTH:
         return "SSS_PAM_PREAUTH";
 
@@ -230,6 +238,14 @@ const char *sss_cmd2str(enum sss_cli_command cmd)
         return "SSS_NSS_GETIDBYSID";
     case SSS_NSS_GETORIGBYNAME:
         return "SSS_NSS_GETORIGBYNAME";
+    case SSS_NSS_GETSIDBYID_MULTI:
+        return "SSS_NSS_GETSIDBYID_MULTI";
+    case SSS_NSS_GETIDBYSID_MULTI:
+        return "SSS_NSS_GETIDBYSID_MULTI";
+    case SSS_NSS_GETSIDBYNAME_MULTI:
+        return "SSS_NSS_GETSIDBYNAME_MULTI";
+    case SSS_NSS_GETNAMEBYSID_MULTI:
+        return "SSS_NSS_GETNAMEBYSID_MULTI";
     default:
         DEBUG(SSSDBG_MINOR_FAILURE,
               "Translation's string is missing for command [%#x].\n", cmd);
@@ -16,6 +16,8 @@ struct sss_iobuf {
     size_t dp;              /* Data pointer */
     size_t size;            /* Current data buffer size */
     size_t capacity;        /* Maximum capacity */
+    bool borrowed;          /* The data belongs to somebody else and must
+                             * not be written into */
 };
 
 struct sss_iobuf *sss_iobuf_init_empty(TALLOC_CTX *mem_ctx,
@@ -85,6 +87,26 @@ struct sss_iobuf *sss_iobuf_init_steal(TALLOC_CTX *mem_ctx,
     return iobuf;
 }
 
+struct sss_iobuf *sss_iobuf_init_view(TALLOC_CTX *mem_ctx,
+                                      const uint8_t *data,
+                                      size_t size)
+{
+    struct sss_iobuf *iobuf;
+
+    iobuf = talloc_zero(mem_ctx, struct sss_iobuf);
+    if (iobuf == NULL) {
+        return NULL;
+    }
+
+    iobuf->data = discard_const(data);
+    iobuf->size = size;
+    iobuf->capacity = size;
+    iobuf->dp = 0;
+    iobuf->borrowed = true;
+
+    return iobuf;
+}
+
 void sss_iobuf_cursor_reset(struct sss_iobuf *iobuf)
 {
     iobuf->dp = 0;
@@ -146,6 +168,10 @@ static errno_t ensure_bytes(struct sss_iobuf *iobuf,
         return EINVAL;
     }
 
+    if (iobuf->borrowed) {
+        return EROFS;
+    }
+
     wantsize = iobuf->dp + nbytes;
     if (wantsize <= iobuf->size) {
         /* Enough space already */
@@ -159,7 +185,7 @@ static errno_t ensure_bytes(struct sss_iobuf *iobuf,
     }
 
     /* Double the size until we add at least nbytes, but stop if we double past capacity */
-    for (newsize = iobuf->size;
+    for (newsize = MAX(iobuf->size, 1);
          (newsize < wantsize) && (newsize < iobuf->capacity);
          newsize *= 2)
         ;
@@ -290,6 +316,39 @@ errno_t sss_iobuf_read_varlen(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+errno_t sss_iobuf_read_varlen_view(struct sss_iobuf *iobuf,
+                                   const uint8_t **_out,
+                                   size_t *_len)
+{
+    uint32_t len;
+    errno_t ret;
+
+    if (iobuf == NULL || _out == NULL || _len == NULL) {
+        return EINVAL;
+    }
+
+    ret = sss_iobuf_read_uint32(iobuf, &len);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (len == 0) {
+        *_out = NULL;
+        *_len = 0;
+        return EOK;
+    }
+
+    if (len > iobuf_get_len(iobuf)) {
+        return ENOBUFS;
+    }
+
+    *_out = iobuf_ptr(iobuf);
+    *_len = len;
+    iobuf->dp += len;
+
+    return EOK;
+}
+
 errno_t sss_iobuf_write_varlen(struct sss_iobuf *iobuf,
                                uint8_t *data,
                                size_t len)
@@ -336,6 +395,30 @@ errno_t sss_iobuf_read_iobuf(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+errno_t sss_iobuf_read_iobuf_view(TALLOC_CTX *mem_ctx,
+                                  struct sss_iobuf *iobuf,
+                                  struct sss_iobuf **_out)
+{
+    struct sss_iobuf *out;
+    const uint8_t *data;
+    size_t len;
+    errno_t ret;
+
+    ret = sss_iobuf_read_varlen_view(iobuf, &data, &len);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    out = sss_iobuf_init_view(mem_ctx, data, len);
+    if (out == NULL) {
+        return ENOMEM;
+    }
+
+    *_out = out;
+
+    return EOK;
+}
+
 errno_t sss_iobuf_write_iobuf(struct sss_iobuf *iobuf,
                               struct sss_iobuf *data)
 {
@@ -424,15 +507,13 @@ errno_t sss_iobuf_read_stringz(struct sss_iobuf *iobuf,
 
     *_out = NULL;
 
-    end = memchr(iobuf_ptr(iobuf), '\0', sss_iobuf_get_size(iobuf));
+    /* only look at the unread part of the buffer */
+    end = memchr(iobuf_ptr(iobuf), '\0', iobuf_get_len(iobuf));
     if (end == NULL) {
         return EINVAL;
     }
 
     len = end + 1 - iobuf_ptr(iobuf);
-    if (sss_iobuf_get_size(iobuf) < len) {
-        return EINVAL;
-    }
 
     *_out = (const char *) iobuf_ptr(iobuf);
     iobuf->dp += len;
@@ -446,9 +527,5 @@ errno_t sss_iobuf_write_stringz(struct sss_iobuf *iobuf,
         return EINVAL;
     }
 
-    SAFEALIGN_MEMCPY_CHECK(iobuf_ptr(iobuf),
-                           str, strlen(str)+1,
-                           sss_iobuf_get_size(iobuf),
-                           &iobuf->dp);
-    return EOK;
+    return sss_iobuf_write_len(iobuf, discard_const(str), strlen(str) + 1);
 }
@@ -68,6 +68,26 @@ struct sss_iobuf *sss_iobuf_init_steal(TALLOC_CTX *mem_ctx,
                                        uint8_t *data,
                                        size_t size);
 
+/*
+ * @brief Allocate an IO buffer that borrows existing data
+ *
+ * This function is useful for parsing an input buffer without copying it.
+ *
+ * The iobuf neither copies nor assumes ownership of the data buffer, the
+ * caller must keep the data around and unchanged for as long as the iobuf
+ * is used. The iobuf cannot be written into, the write functions return
+ * EROFS.
+ *
+ * @param[in]  mem_ctx      The talloc context that owns the iobuf
+ * @param[in]  data         The data to read from.
+ * @param[in]  size         The size of the data buffer
+ *
+ * @return The newly created buffer on success or NULL on an error.
+ */
+struct sss_iobuf *sss_iobuf_init_view(TALLOC_CTX *mem_ctx,
+                                      const uint8_t *data,
+                                      size_t size);
+
 /*
  * @brief Reset internal cursor of the IO buffer (seek to the start)
  */
@@ -159,6 +179,17 @@ errno_t sss_iobuf_read_varlen(TALLOC_CTX *mem_ctx,
                               uint8_t **_out,
                               size_t *_len);
 
+/*
+ * @brief Read a length-prefixed blob without copying it
+ *
+ * Like sss_iobuf_read_varlen(), but *_out points into the data of the IO
+ * buffer. It stays valid as long as the data of the IO buffer does, that
+ * is until the IO buffer is freed or written into.
+ */
+errno_t sss_iobuf_read_varlen_view(struct sss_iobuf *iobuf,
+                                   const uint8_t **_out,
+                                   size_t *_len);
+
 errno_t sss_iobuf_write_varlen(struct sss_iobuf *iobuf,
                                uint8_t *data,
                                size_t len);
@@ -167,6 +198,17 @@ errno_t sss_iobuf_read_iobuf(TALLOC_CTX *mem_ctx,
                              struct sss_iobuf *iobuf,
                              struct sss_iobuf **_out);
 
+/*
+ * @brief Read a length-prefixed blob into a view of the IO buffer
+ *
+ * Like sss_iobuf_read_iobuf(), but the new IO buffer is created with
+ * sss_iobuf_init_view() and borrows the data of iobuf, see
+ * sss_iobuf_read_varlen_view() for its lifetime.
+ */
+errno_t sss_iobuf_read_iobuf_view(TALLOC_CTX *mem_ctx,
+                                  struct sss_iobuf *iobuf,
+                                  struct sss_iobuf **_out);
+
 errno_t sss_iobuf_write_iobuf(struct sss_iobuf *iobuf,
                               struct sss_iobuf *data);
 
@@ -20,6 +20,8 @@
 #include <ctype.h>
 #include <stdio.h>
 #include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
 #include <talloc.h>
 #include <profile.h>
 
@@ -90,16 +92,189 @@ const char *sss_printable_keytab_name(krb5_context ctx, const char *keytab_name)
     return buff;
 }
 
-errno_t select_principal_from_keytab(TALLOC_CTX *mem_ctx,
-                                     const char *hostname,
-                                     const char *desired_realm,
-                                     const char *keytab_name,
-                                     char **_principal,
-                                     char **_primary,
-                                     char **_realm)
+/* A context shared by the lookups of this process which do not need one of
+ * their own, it is never freed. libkrb5 re-reads krb5.conf by itself when
+ * the file changes, so the context never gets stale. */
+static krb5_context sss_krb5_shared_ctx;
+
+krb5_error_code sss_krb5_get_shared_context(krb5_context *_ctx)
+{
+    krb5_error_code kerr;
+
+    if (sss_krb5_shared_ctx == NULL) {
+        kerr = sss_krb5_init_context(&sss_krb5_shared_ctx);
+        if (kerr != 0) {
+            sss_krb5_shared_ctx = NULL;
+            return kerr;
+        }
+    }
+
+    *_ctx = sss_krb5_shared_ctx;
+    return 0;
+}
+
+/* The principals selected by select_principal_from_keytab(). The machine
+ * account checks and the setup of SASL binds look for the same principal
+ * again and again, each time reading the whole keytab up to six times. An
+ * entry is used as long as its keytab file did not change. */
+#define SSS_KRB5_KEYTAB_CACHE_MAX 16
+
+struct sss_krb5_keytab_cache_entry {
+    char *keytab;
+    char *hostname;
+    char *desired_realm;
+
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+
+    char *principal;
+    char *primary;
+    char *realm;
+
+    struct sss_krb5_keytab_cache_entry *prev;
+    struct sss_krb5_keytab_cache_entry *next;
+};
+
+static struct sss_krb5_keytab_cache_entry *sss_krb5_keytab_cache;
+static size_t sss_krb5_keytab_cache_len;
+
+static int sss_krb5_keytab_cache_entry_destructor(
+                                    struct sss_krb5_keytab_cache_entry *entry)
+{
+    DLIST_REMOVE(sss_krb5_keytab_cache, entry);
+    sss_krb5_keytab_cache_len--;
+    return 0;
+}
+
+/* Only keytabs of the FILE type can be checked for changes, stat() of the
+ * file is filled into @_st for them. */
+static errno_t sss_krb5_keytab_stat(krb5_context ctx,
+                                    const char *keytab_name,
+                                    const char **_name,
+                                    struct stat *_st)
+{
+    char buf[PATH_MAX + sizeof("WRFILE:")];
+    const char *path;
+    int ret;
+
+    if (keytab_name == NULL) {
+        if (krb5_kt_default_name(ctx, buf, sizeof(buf)) != 0) {
+            return ENOENT;
+        }
+        path = buf;
+    } else {
+        path = keytab_name;
+    }
+
+    if (strncmp(path, "FILE:", sizeof("FILE:") - 1) == 0) {
+        path += sizeof("FILE:") - 1;
+    } else if (strncmp(path, "WRFILE:", sizeof("WRFILE:") - 1) == 0) {
+        path += sizeof("WRFILE:") - 1;
+    } else if (path[0] != '/') {
+        return ENOTSUP;
+    }
+
+    ret = stat(path, _st);
+    if (ret != 0) {
+        return errno;
+    }
+
+    *_name = keytab_name == NULL ? "" : keytab_name;
+    return EOK;
+}
+
+static struct sss_krb5_keytab_cache_entry *
+sss_krb5_keytab_cache_find(const char *keytab,
+                           const char *hostname,
+                           const char *desired_realm,
+                           struct stat *st)
+{
+    struct sss_krb5_keytab_cache_entry *entry;
+    struct sss_krb5_keytab_cache_entry *next;
+
+    for (entry = sss_krb5_keytab_cache; entry != NULL; entry = next) {
+        next = entry->next;
+
+        if (strcmp(entry->keytab, keytab) != 0) {
+            continue;
+        }
+
+        if (entry->dev != st->st_dev || entry->ino != st->st_ino
+                || entry->size != st->st_size
+                || entry->mtime.tv_sec != st->st_mtim.tv_sec
+                || entry->mtime.tv_nsec != st->st_mtim.tv_nsec) {
+            DEBUG(SSSDBG_TRACE_INTERNAL,
+                  "Keytab [%s] changed, dropping the principal [%s].\n",
+                  keytab, entry->principal);
+            talloc_free(entry);
+            continue;
+        }
+
+        if (strcmp(entry->hostname, hostname) == 0
+                && strcmp(entry->desired_realm, desired_realm) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void sss_krb5_keytab_cache_add(const char *keytab,
+                                      const char *hostname,
+                                      const char *desired_realm,
+                                      struct stat *st,
+                                      const char *principal,
+                                      const char *primary,
+                                      const char *realm)
+{
+    struct sss_krb5_keytab_cache_entry *entry;
+
+    if (sss_krb5_keytab_cache_len >= SSS_KRB5_KEYTAB_CACHE_MAX) {
+        /* the oldest entry is at the head of the list */
+        talloc_free(sss_krb5_keytab_cache);
+    }
+
+    entry = talloc_zero(NULL, struct sss_krb5_keytab_cache_entry);
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->keytab = talloc_strdup(entry, keytab);
+    entry->hostname = talloc_strdup(entry, hostname);
+    entry->desired_realm = talloc_strdup(entry, desired_realm);
+    entry->principal = talloc_strdup(entry, principal);
+    entry->primary = talloc_strdup(entry, primary);
+    entry->realm = talloc_strdup(entry, realm);
+    if (entry->keytab == NULL || entry->hostname == NULL
+            || entry->desired_realm == NULL || entry->principal == NULL
+            || entry->primary == NULL || entry->realm == NULL) {
+        talloc_free(entry);
+        return;
+    }
+
+    entry->dev = st->st_dev;
+    entry->ino = st->st_ino;
+    entry->size = st->st_size;
+    entry->mtime = st->st_mtim;
+
+    DLIST_ADD_END(sss_krb5_keytab_cache, entry,
+                  struct sss_krb5_keytab_cache_entry *);
+    sss_krb5_keytab_cache_len++;
+    talloc_set_destructor(entry, sss_krb5_keytab_cache_entry_destructor);
+}
+
+static errno_t sss_krb5_scan_keytab(TALLOC_CTX *mem_ctx,
+                                    krb5_context krb_ctx,
+                                    const char *hostname,
+                                    const char *desired_realm,
+                                    const char *keytab_name,
+                                    char **_principal,
+                                    char **_primary,
+                                    char **_realm)
 {
     krb5_error_code kerr = 0;
-    krb5_context krb_ctx = NULL;
     krb5_keytab keytab = NULL;
     krb5_principal client_princ = NULL;
     TALLOC_CTX *tmp_ctx;
@@ -138,13 +313,6 @@ errno_t select_principal_from_keytab(TALLOC_CTX *mem_ctx,
         return ENOMEM;
     }
 
-    kerr = sss_krb5_init_context(&krb_ctx);
-    if (kerr) {
-        error_message = "Failed to init Kerberos context";
-        ret = EFAULT;
-        goto done;
-    }
-
     if (keytab_name != NULL) {
         kerr = krb5_kt_resolve(krb_ctx, keytab_name, &keytab);
     } else {
@@ -279,12 +447,88 @@ done:
                 (error_message ? error_message : sss_strerror(ret)));
     }
     if (keytab) krb5_kt_close(krb_ctx, keytab);
-    if (krb_ctx) krb5_free_context(krb_ctx);
     if (client_princ) krb5_free_principal(krb_ctx, client_princ);
     talloc_free(tmp_ctx);
     return ret;
 }
 
+errno_t select_principal_from_keytab(TALLOC_CTX *mem_ctx,
+                                     const char *hostname,
+                                     const char *desired_realm,
+                                     const char *keytab_name,
+                                     char **_principal,
+                                     char **_primary,
+                                     char **_realm)
+{
+    struct sss_krb5_keytab_cache_entry *entry;
+    krb5_context krb_ctx;
+    krb5_error_code kerr;
+    TALLOC_CTX *tmp_ctx;
+    const char *keytab;
+    char *principal;
+    char *primary;
+    char *realm;
+    struct stat st;
+    errno_t ret;
+
+    kerr = sss_krb5_get_shared_context(&krb_ctx);
+    if (kerr) {
+        return EFAULT;
+    }
+
+    ret = sss_krb5_keytab_stat(krb_ctx, keytab_name, &keytab, &st);
+    if (ret != EOK) {
+        /* not a file we can watch, or it is missing and the scan reports
+         * the error */
+        return sss_krb5_scan_keytab(mem_ctx, krb_ctx, hostname, desired_realm,
+                                    keytab_name,
+                                    _principal, _primary, _realm);
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    entry = sss_krb5_keytab_cache_find(keytab,
+                                       hostname ? hostname : "*",
+                                       desired_realm ? desired_realm : "*",
+                                       &st);
+    if (entry != NULL) {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "Using principal [%s] selected earlier from keytab [%s].\n",
+              entry->principal, sss_printable_keytab_name(krb_ctx,
+                                                          keytab_name));
+        principal = talloc_strdup(tmp_ctx, entry->principal);
+        primary = talloc_strdup(tmp_ctx, entry->primary);
+        realm = talloc_strdup(tmp_ctx, entry->realm);
+        if (principal == NULL || primary == NULL || realm == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    } else {
+        ret = sss_krb5_scan_keytab(tmp_ctx, krb_ctx, hostname, desired_realm,
+                                   keytab_name, &principal, &primary, &realm);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        sss_krb5_keytab_cache_add(keytab,
+                                  hostname ? hostname : "*",
+                                  desired_realm ? desired_realm : "*",
+                                  &st, principal, primary, realm);
+    }
+
+    if (_principal) *_principal = talloc_steal(mem_ctx, principal);
+    if (_primary) *_primary = talloc_steal(mem_ctx, primary);
+    if (_realm) *_realm = talloc_steal(mem_ctx, realm);
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 enum matching_mode {MODE_NORMAL, MODE_PREFIX, MODE_POSTFIX};
 /**
  * We only have primary and instances stored separately, we need to
@@ -1116,9 +1360,9 @@ bool sss_krb5_realm_has_proxy(const char *realm)
         return false;
     }
 
-    kerr = sss_krb5_init_context(&context);
+    kerr = sss_krb5_get_shared_context(&context);
     if (kerr != 0) {
-        DEBUG(SSSDBG_OP_FAILURE, "sss_krb5_init_context failed.\n");
+        DEBUG(SSSDBG_OP_FAILURE, "sss_krb5_get_shared_context failed.\n");
         return false;
     }
 
@@ -1152,7 +1396,6 @@ bool sss_krb5_realm_has_proxy(const char *realm)
 done:
     profile_free_list(list);
     profile_release(profile);
-    krb5_free_context(context);
 
     return res;
 }
@@ -198,4 +198,9 @@ krb5_error_code sss_krb5_unmarshal_princ(TALLOC_CTX *mem_ctx,
 
 krb5_error_code sss_krb5_init_context(krb5_context *context);
 
+/* Returns a context of the process for short lookups like the ones in
+ * krb5.conf. It must not be freed and must not be changed by the caller,
+ * e.g. by krb5_set_default_realm() or krb5_set_trace_callback(). */
+krb5_error_code sss_krb5_get_shared_context(krb5_context *_ctx);
+
 #endif /* __SSS_KRB5_H__ */
@@ -59,6 +59,10 @@ int sss_ldap_get_diagnostic_msg(TALLOC_CTX *mem_ctx,
 #define LDAP_SERVER_SD_OID "1.2.840.113556.1.4.801"
 #endif /* LDAP_SERVER_SD_OID */
 
+#ifndef LDAP_SERVER_FAST_BIND_OID
+#define LDAP_SERVER_FAST_BIND_OID "1.2.840.113556.1.4.1781"
+#endif /* LDAP_SERVER_FAST_BIND_OID */
+
 
 /*
  * The following four flags specify which security descriptor parts to retrieve
@@ -0,0 +1,356 @@
+/*
+    SSSD
+
+    Sampling profiler of the SSSD processes
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include "util/util.h"
+#include "util/sss_prof.h"
+
+/* The samples are counted in static tables by the signal handler, so it
+ * neither allocates nor locks. A stack that does not fit in the tables is
+ * counted as dropped. */
+#define SSS_PROF_MAX_DEPTH 16
+#define SSS_PROF_MAX_STACKS 1024
+#define SSS_PROF_MAX_OPS 64
+#define SSS_PROF_OP_NAME_LEN 128
+
+struct sss_prof_stack {
+    const char *frames[SSS_PROF_MAX_DEPTH];
+    unsigned int depth;
+    uint64_t samples;
+};
+
+struct sss_prof_op {
+    char name[SSS_PROF_OP_NAME_LEN];
+    uint64_t count;
+    uint64_t usecs;
+};
+
+volatile sig_atomic_t sss_prof_active;
+
+static const char *sss_prof_frames[SSS_PROF_MAX_DEPTH];
+static volatile sig_atomic_t sss_prof_depth;
+/* frames pushed above SSS_PROF_MAX_DEPTH */
+static unsigned int sss_prof_overflow;
+
+static struct sss_prof_stack sss_prof_stacks[SSS_PROF_MAX_STACKS];
+static uint64_t sss_prof_dropped;
+
+static struct sss_prof_op sss_prof_ops[SSS_PROF_MAX_OPS];
+static size_t sss_prof_num_ops;
+
+static struct sigaction sss_prof_old_action;
+
+void sss_prof_push(const char *frame)
+{
+    if (sss_prof_depth >= SSS_PROF_MAX_DEPTH) {
+        sss_prof_overflow++;
+        return;
+    }
+
+    /* the frame must be set before the signal handler can see it */
+    sss_prof_frames[sss_prof_depth] = frame;
+    sss_prof_depth++;
+}
+
+void sss_prof_pop(const char *frame)
+{
+    int i;
+
+    if (sss_prof_overflow > 0) {
+        sss_prof_overflow--;
+        return;
+    }
+
+    /* Frames that were not popped, e.g. after an error, are popped with
+     * their parent. A frame pushed before the profiler was started is not
+     * found and ignored. */
+    for (i = sss_prof_depth - 1; i >= 0; i--) {
+        if (sss_prof_frames[i] == frame
+                || strcmp(sss_prof_frames[i], frame) == 0) {
+            sss_prof_depth = i;
+            return;
+        }
+    }
+}
+
+static void sss_prof_sample(int signum)
+{
+    struct sss_prof_stack *stack;
+    unsigned int depth;
+    uintptr_t hash;
+    unsigned int i;
+    unsigned int n;
+
+    depth = sss_prof_depth;
+
+    hash = depth;
+    for (i = 0; i < depth; i++) {
+        hash = hash * 31 + (uintptr_t) sss_prof_frames[i];
+    }
+
+    for (n = 0; n < SSS_PROF_MAX_STACKS; n++) {
+        stack = &sss_prof_stacks[(hash + n) % SSS_PROF_MAX_STACKS];
+
+        if (stack->samples == 0) {
+            for (i = 0; i < depth; i++) {
+                stack->frames[i] = sss_prof_frames[i];
+            }
+            stack->depth = depth;
+            stack->samples = 1;
+            return;
+        }
+
+        if (stack->depth == depth
+                && memcmp(stack->frames, sss_prof_frames,
+                          depth * sizeof(const char *)) == 0) {
+            stack->samples++;
+            return;
+        }
+    }
+
+    sss_prof_dropped++;
+}
+
+static void sss_prof_add(const char *op, uint64_t usecs)
+{
+    size_t i;
+
+    for (i = 0; i < sss_prof_num_ops; i++) {
+        if (strcmp(sss_prof_ops[i].name, op) == 0) {
+            break;
+        }
+    }
+
+    if (i == sss_prof_num_ops) {
+        if (sss_prof_num_ops == SSS_PROF_MAX_OPS) {
+            return;
+        }
+
+        strncpy(sss_prof_ops[i].name, op, SSS_PROF_OP_NAME_LEN - 1);
+        sss_prof_ops[i].name[SSS_PROF_OP_NAME_LEN - 1] = '\0';
+        sss_prof_num_ops++;
+    }
+
+    sss_prof_ops[i].count++;
+    sss_prof_ops[i].usecs += usecs;
+}
+
+void sss_prof_record(const char *op, uint64_t usecs)
+{
+    if (!sss_prof_active || op == NULL) {
+        return;
+    }
+
+    sss_prof_add(op, usecs);
+}
+
+void sss_prof_record_since(const char *op, const struct timeval *start)
+{
+    struct timeval now;
+
+    if (!sss_prof_active || op == NULL) {
+        return;
+    }
+
+    gettimeofday(&now, NULL);
+    sss_prof_add(op, (now.tv_sec - start->tv_sec) * UINT64_C(1000000)
+                     + now.tv_usec - start->tv_usec);
+}
+
+static errno_t sss_prof_set_timer(suseconds_t usecs)
+{
+    struct itimerval timer;
+    int ret;
+
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = usecs;
+    timer.it_value = timer.it_interval;
+
+    ret = setitimer(ITIMER_PROF, &timer, NULL);
+    if (ret != 0) {
+        ret = errno;
+        DEBUG(SSSDBG_OP_FAILURE, "setitimer failed [%d]: %s\n",
+              ret, strerror(ret));
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t sss_prof_start(void)
+{
+    struct sigaction action;
+    errno_t ret;
+
+    if (sss_prof_active) {
+        return EALREADY;
+    }
+
+    memset(sss_prof_stacks, 0, sizeof(sss_prof_stacks));
+    memset(sss_prof_ops, 0, sizeof(sss_prof_ops));
+    sss_prof_num_ops = 0;
+    sss_prof_dropped = 0;
+    sss_prof_depth = 0;
+    sss_prof_overflow = 0;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sss_prof_sample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    ret = sigaction(SIGPROF, &action, &sss_prof_old_action);
+    if (ret != 0) {
+        ret = errno;
+        DEBUG(SSSDBG_OP_FAILURE, "sigaction failed [%d]: %s\n",
+              ret, strerror(ret));
+        return ret;
+    }
+
+    sss_prof_active = 1;
+
+    ret = sss_prof_set_timer(SSS_PROF_INTERVAL_USEC);
+    if (ret != EOK) {
+        sss_prof_active = 0;
+        sigaction(SIGPROF, &sss_prof_old_action, NULL);
+        return ret;
+    }
+
+    DEBUG(SSSDBG_IMPORTANT_INFO, "Profiler started.\n");
+
+    return EOK;
+}
+
+static errno_t sss_prof_write(const char *path, bool samples)
+{
+    const char *root;
+    FILE *f;
+    size_t i;
+    unsigned int j;
+    errno_t ret;
+
+    f = fopen(path, "w");
+    if (f == NULL) {
+        ret = errno;
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to open [%s] [%d]: %s\n",
+              path, ret, strerror(ret));
+        return ret;
+    }
+
+    root = debug_prg_name != NULL ? debug_prg_name : "sssd";
+
+    if (samples) {
+        for (i = 0; i < SSS_PROF_MAX_STACKS; i++) {
+            if (sss_prof_stacks[i].samples == 0) {
+                continue;
+            }
+
+            fputs(root, f);
+            for (j = 0; j < sss_prof_stacks[i].depth; j++) {
+                fprintf(f, ";%s", sss_prof_stacks[i].frames[j]);
+            }
+            fprintf(f, " %"PRIu64"\n", sss_prof_stacks[i].samples);
+        }
+
+        if (sss_prof_dropped > 0) {
+            fprintf(f, "%s;[dropped] %"PRIu64"\n", root, sss_prof_dropped);
+        }
+    } else {
+        for (i = 0; i < sss_prof_num_ops; i++) {
+            fprintf(f, "%s;%s %"PRIu64"\n",
+                    root, sss_prof_ops[i].name, sss_prof_ops[i].usecs);
+        }
+    }
+
+    ret = fclose(f);
+    if (ret != 0) {
+        ret = errno;
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to write [%s] [%d]: %s\n",
+              path, ret, strerror(ret));
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t sss_prof_stop(const char *path_base)
+{
+    char path[PATH_MAX];
+    errno_t ret;
+    errno_t wret;
+    size_t i;
+
+    if (!sss_prof_active) {
+        return ENOENT;
+    }
+
+    /* no samples are taken while the tables are written */
+    sss_prof_set_timer(0);
+    sigaction(SIGPROF, &sss_prof_old_action, NULL);
+    sss_prof_active = 0;
+
+    for (i = 0; i < sss_prof_num_ops; i++) {
+        DEBUG(SSSDBG_IMPORTANT_INFO,
+              "Profiler: %s: %"PRIu64" times, %"PRIu64" usecs\n",
+              sss_prof_ops[i].name, sss_prof_ops[i].count,
+              sss_prof_ops[i].usecs);
+    }
+
+    ret = snprintf(path, sizeof(path), "%s.cpu.folded", path_base);
+    if (ret < 0 || (size_t) ret >= sizeof(path)) {
+        return EINVAL;
+    }
+    ret = sss_prof_write(path, true);
+
+    wret = snprintf(path, sizeof(path), "%s.wall.folded", path_base);
+    if (wret < 0 || (size_t) wret >= sizeof(path)) {
+        return EINVAL;
+    }
+    wret = sss_prof_write(path, false);
+
+    DEBUG(SSSDBG_IMPORTANT_INFO, "Profiler stopped, results are in "
+          "%s.cpu.folded and %s.wall.folded\n", path_base, path_base);
+
+    return ret != EOK ? ret : wret;
+}
+
+void sss_prof_toggle(void)
+{
+    char path_base[PATH_MAX];
+    int ret;
+
+    if (!sss_prof_active) {
+        sss_prof_start();
+        return;
+    }
+
+    ret = snprintf(path_base, sizeof(path_base), "%s/%s.profile", LOG_PATH,
+                   debug_log_file != NULL ? debug_log_file : "sssd");
+    if (ret < 0 || (size_t) ret >= sizeof(path_base)) {
+        return;
+    }
+
+    sss_prof_stop(path_base);
+}
@@ -0,0 +1,74 @@
+/*
+    SSSD
+
+    Sampling profiler of the SSSD processes
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SSS_PROF_H_
+#define _SSS_PROF_H_
+
+#include <stdint.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include "util/util_errors.h"
+
+/* Starts or stops the profiler of the SSSD processes, needs <signal.h> */
+#define SSS_PROF_SIGNAL (SIGRTMIN + 1)
+
+/* Interval of the samples, in microseconds of CPU time */
+#define SSS_PROF_INTERVAL_USEC 10000
+
+extern volatile sig_atomic_t sss_prof_active;
+
+/* While the profiler runs the process is interrupted each
+ * SSS_PROF_INTERVAL_USEC of CPU time it uses and the frames that are pushed
+ * at that moment are counted as one sample. Only synchronous code can push
+ * a frame, as the stack of frames has to be the same when it is popped. A
+ * frame must be a string literal. */
+void sss_prof_push(const char *frame);
+void sss_prof_pop(const char *frame);
+
+#define SSS_PROF_PUSH(frame) do { \
+    if (sss_prof_active) {        \
+        sss_prof_push(frame);     \
+    }                             \
+} while (0)
+
+#define SSS_PROF_POP(frame) do {  \
+    if (sss_prof_active) {        \
+        sss_prof_pop(frame);      \
+    }                             \
+} while (0)
+
+/* Asynchronous operations are timed instead. The time of an operation is
+ * added to the time of all operations with the same name, the parts of a
+ * name are separated by ';' as the frames of a stack. */
+void sss_prof_record(const char *op, uint64_t usecs);
+void sss_prof_record_since(const char *op, const struct timeval *start);
+
+errno_t sss_prof_start(void);
+
+/* Stops the profiler and writes the samples to <path_base>.cpu.folded and
+ * the times of the operations to <path_base>.wall.folded, in the folded
+ * format of flamegraph.pl. */
+errno_t sss_prof_stop(const char *path_base);
+
+/* Starts the profiler or stops it and writes the results next to the debug
+ * log of the process. */
+void sss_prof_toggle(void);
+
+#endif /* _SSS_PROF_H_ */
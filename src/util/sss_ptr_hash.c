@@ -39,6 +39,10 @@ static bool sss_ptr_hash_check_type(void *ptr, const char *type)
     return true;
 }
 
+static struct sss_ptr_hash_value *
+sss_ptr_hash_lookup_internal(hash_table_t *table,
+                             const char *key);
+
 static int sss_ptr_hash_table_destructor(hash_table_t *table)
 {
     sss_ptr_hash_delete_all(table, false);
@@ -50,11 +54,13 @@ struct sss_ptr_hash_delete_data {
     void *pvt;
 };
 
+/* The key is stored right after the structure, so that adding an entry
+ * costs a single allocation besides the ones of dhash. */
 struct sss_ptr_hash_value {
     hash_table_t *table;
-    const char *key;
     void *payload;
     bool delete_in_progress;
+    char key[];
 };
 
 static int
@@ -71,7 +77,7 @@ sss_ptr_hash_value_destructor(struct sss_ptr_hash_value *value)
     }
 
     value->delete_in_progress = true;
-    if (value->table && value->key) {
+    if (value->table) {
         table_key.type = HASH_KEY_STRING;
         table_key.str = discard_const_p(char, value->key);
         if (hash_delete(value->table, &table_key) != HASH_SUCCESS) {
@@ -90,18 +96,18 @@ sss_ptr_hash_value_create(hash_table_t *table,
                           void *talloc_ptr)
 {
     struct sss_ptr_hash_value *value;
+    size_t key_len;
 
-    value = talloc_zero(talloc_ptr, struct sss_ptr_hash_value);
-    if (value == NULL) {
-        return NULL;
-    }
+    key_len = strlen(key);
 
-    value->key = talloc_strdup(value, key);
-    if (value->key == NULL) {
-        talloc_free(value);
+    value = talloc_zero_size(talloc_ptr,
+                             sizeof(struct sss_ptr_hash_value) + key_len + 1);
+    if (value == NULL) {
         return NULL;
     }
+    talloc_set_name_const(value, "struct sss_ptr_hash_value");
 
+    memcpy(value->key, key, key_len + 1);
     value->table = table;
     value->payload = talloc_ptr;
     talloc_set_destructor(value, sss_ptr_hash_value_destructor);
@@ -196,6 +202,7 @@ errno_t _sss_ptr_hash_add(hash_table_t *table,
                           const char *type,
                           bool override)
 {
+    struct sss_ptr_hash_value *old_value;
     struct sss_ptr_hash_value *value;
     hash_value_t table_value;
     hash_key_t table_key;
@@ -213,8 +220,16 @@ errno_t _sss_ptr_hash_add(hash_table_t *table,
     table_key.type = HASH_KEY_STRING;
     table_key.str = discard_const_p(char, key);
 
-    if (override == false && hash_has_key(table, &table_key)) {
-        return EEXIST;
+    old_value = sss_ptr_hash_lookup_internal(table, key);
+    if (old_value != NULL) {
+        if (!override) {
+            return EEXIST;
+        }
+
+        /* Remove the entry through the destructor of its value, letting
+         * dhash overwrite it would keep the old value attached to its
+         * payload when there is no delete callback. */
+        talloc_free(old_value);
     }
 
     value = sss_ptr_hash_value_create(table, key, talloc_ptr);
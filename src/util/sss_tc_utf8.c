@@ -29,6 +29,7 @@
 
 #include <talloc.h>
 #include "util/util.h"
+#include "util/sss_utf8.h"
 
 #ifdef HAVE_LIBUNISTRING
 static void sss_utf8_free(char *ptr)
@@ -66,6 +67,16 @@ char *sss_tc_utf8_str_tolower(TALLOC_CTX *mem_ctx, const char *s)
 {
     char *lower;
     char *ret = NULL;
+    size_t len;
+
+    len = strlen(s);
+    if (sss_utf8_is_ascii((const uint8_t *)s, len)) {
+        ret = talloc_strndup(mem_ctx, s, len);
+        if (ret != NULL) {
+            sss_utf8_ascii_tolower((uint8_t *)ret, len);
+        }
+        return ret;
+    }
 
     lower = sss_utf8_tolower(s);
     if (lower) {
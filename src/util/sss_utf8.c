@@ -54,7 +54,88 @@ bool sss_utf8_check(const uint8_t *s, size_t n)
 #error No unicode library
 #endif
 
+/* Most names are ASCII, they are checked and folded eight bytes at a time.
+ * An ASCII byte is an upper case letter if adding 0x80 - 'A' sets its high
+ * bit and adding 0x7f - 'Z' does not. The sums never carry into the next
+ * byte as long as all the bytes are ASCII. */
+#define SSS_ASCII_ONES UINT64_C(0x0101010101010101)
+#define SSS_ASCII_HIGH UINT64_C(0x8080808080808080)
+
+static inline uint64_t sss_ascii_tolower_word(uint64_t word)
+{
+    uint64_t ge_a;
+    uint64_t gt_z;
+
+    ge_a = word + SSS_ASCII_ONES * (0x80 - 'A');
+    gt_z = word + SSS_ASCII_ONES * (0x7f - 'Z');
+
+    return word | ((ge_a & ~gt_z & SSS_ASCII_HIGH) >> 2);
+}
+
+static inline uint8_t sss_ascii_tolower(uint8_t c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+bool sss_utf8_is_ascii(const uint8_t *s, size_t n)
+{
+    uint64_t high = 0;
+    uint64_t word;
+    size_t i;
+
+    for (i = 0; i + sizeof(word) <= n; i += sizeof(word)) {
+        memcpy(&word, s + i, sizeof(word));
+        high |= word;
+    }
+
+    for (; i < n; i++) {
+        high |= s[i];
+    }
+
+    return (high & SSS_ASCII_HIGH) == 0;
+}
+
+void sss_utf8_ascii_tolower(uint8_t *s, size_t n)
+{
+    uint64_t word;
+    size_t i;
+
+    for (i = 0; i + sizeof(word) <= n; i += sizeof(word)) {
+        memcpy(&word, s + i, sizeof(word));
+        word = sss_ascii_tolower_word(word);
+        memcpy(s + i, &word, sizeof(word));
+    }
+
+    for (; i < n; i++) {
+        s[i] = sss_ascii_tolower(s[i]);
+    }
+}
+
 #ifdef HAVE_LIBUNISTRING
+static bool sss_ascii_case_equal(const uint8_t *s1, const uint8_t *s2,
+                                 size_t n)
+{
+    uint64_t w1;
+    uint64_t w2;
+    size_t i;
+
+    for (i = 0; i + sizeof(w1) <= n; i += sizeof(w1)) {
+        memcpy(&w1, s1 + i, sizeof(w1));
+        memcpy(&w2, s2 + i, sizeof(w2));
+        if (sss_ascii_tolower_word(w1) != sss_ascii_tolower_word(w2)) {
+            return false;
+        }
+    }
+
+    for (; i < n; i++) {
+        if (sss_ascii_tolower(s1[i]) != sss_ascii_tolower(s2[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 errno_t sss_utf8_case_eq(const uint8_t *s1, const uint8_t *s2)
 {
 
@@ -72,6 +153,15 @@ errno_t sss_utf8_case_eq(const uint8_t *s1, const uint8_t *s2)
     n1 = u8_strlen(s1);
     n2 = u8_strlen(s2);
 
+    /* The case folding of ASCII letters does not depend on the rest of the
+     * string, ASCII strings match if they do byte by byte. */
+    if (sss_utf8_is_ascii(s1, n1) && sss_utf8_is_ascii(s2, n2)) {
+        if (n1 == n2 && sss_ascii_case_equal(s1, s2, n1)) {
+            return EOK;
+        }
+        return ENOMATCH;
+    }
+
     ret = u8_casecmp(s1, n1,
                      s2, n2,
                      NULL, NULL,
@@ -87,6 +177,45 @@ errno_t sss_utf8_case_eq(const uint8_t *s1, const uint8_t *s2)
     return ENOMATCH;
 }
 
+errno_t sss_utf8_case_fold(const uint8_t *s, uint8_t **_folded)
+{
+    /* u8_casecmp() compares the case folded strings, so folding with the
+     * same arguments gives equal results for matching strings.
+     */
+    uint8_t *folded;
+    uint8_t *tmp;
+    size_t len;
+    errno = 0;
+
+    len = u8_strlen(s);
+    if (sss_utf8_is_ascii(s, len)) {
+        folded = malloc(len + 1);
+        if (folded == NULL) {
+            return ENOMEM;
+        }
+        memcpy(folded, s, len + 1);
+        sss_utf8_ascii_tolower(folded, len);
+
+        *_folded = folded;
+        return EOK;
+    }
+
+    folded = u8_casefold(s, len, NULL, NULL, NULL, &len);
+    if (folded == NULL) {
+        return errno != 0 ? errno : ENOMEM;
+    }
+
+    tmp = realloc(folded, len + 1);
+    if (tmp == NULL) {
+        free(folded);
+        return ENOMEM;
+    }
+    tmp[len] = '\0';
+
+    *_folded = tmp;
+    return EOK;
+}
+
 #elif defined(HAVE_GLIB2)
 errno_t sss_utf8_case_eq(const uint8_t *s1, const uint8_t *s2)
 {
@@ -122,6 +251,37 @@ errno_t sss_utf8_case_eq(const uint8_t *s1, const uint8_t *s2)
     return ret;
 }
 
+errno_t sss_utf8_case_fold(const uint8_t *s, uint8_t **_folded)
+{
+    /* Fold the same way as sss_utf8_case_eq() does, the collation keys
+     * compare equal exactly when g_utf8_collate() returns 0.
+     */
+    gchar *gs;
+    gchar *key;
+    gssize n;
+
+    n = g_utf8_strlen((const gchar *)s, -1);
+
+    gs = g_utf8_casefold((const gchar *)s, n);
+    if (gs == NULL) {
+        return ENOMEM;
+    }
+
+    key = g_utf8_collate_key(gs, -1);
+    g_free(gs);
+    if (key == NULL) {
+        return ENOMEM;
+    }
+
+    *_folded = (uint8_t *)strdup(key);
+    g_free(key);
+    if (*_folded == NULL) {
+        return ENOMEM;
+    }
+
+    return EOK;
+}
+
 #else
 #error No unicode library
 #endif
@@ -34,11 +34,25 @@
 
 bool sss_utf8_check(const uint8_t *s, size_t n);
 
+/* Returns true if the first n bytes of s are all ASCII */
+bool sss_utf8_is_ascii(const uint8_t *s, size_t n);
+
+/* Lower cases the first n bytes of s in place. They must be ASCII, see
+ * sss_utf8_is_ascii().
+ */
+void sss_utf8_ascii_tolower(uint8_t *s, size_t n);
+
 /* Returns EOK on match, ENOTUNIQ if comparison succeeds but
  * does not match.
  * May return other errno error codes on failure
  */
 errno_t sss_utf8_case_eq(const uint8_t *s1, const uint8_t *s2);
 
+/* Returns a case folded copy of s. The copies of two strings are equal
+ * byte by byte if and only if sss_utf8_case_eq() matches the strings.
+ * The copy must be freed with free().
+ */
+errno_t sss_utf8_case_fold(const uint8_t *s, uint8_t **_folded);
+
 
 #endif /* SSS_UTF8_H_ */
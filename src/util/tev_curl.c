@@ -60,6 +60,14 @@ struct tcurl_ctx {
      * the transfer's private data
      */
     CURLM *multi_handle;
+
+    /* Connections are cached by the multi handle, the share handle adds
+     * the DNS cache and the TLS sessions so a new connection to a known
+     * server can skip the full handshake.
+     */
+    CURLSH *share_handle;
+
+    struct tcurl_stats stats;
 };
 
 /**
@@ -162,6 +170,20 @@ static errno_t tcurl_global_init(void)
     return EOK;
 }
 
+#if LIBCURL_VERSION_NUM >= 0x072f00
+static bool tcurl_http2_available(void)
+{
+    curl_version_info_data *info;
+
+    info = curl_version_info(CURLVERSION_NOW);
+    if (info == NULL) {
+        return false;
+    }
+
+    return (info->features & CURL_VERSION_HTTP2) != 0;
+}
+#endif
+
 static int curl2tev_flags(int curlflags)
 {
     int flags = 0;
@@ -464,9 +486,26 @@ static int tcurl_ctx_destroy(struct tcurl_ctx *ctx)
     }
 
     curl_multi_cleanup(ctx->multi_handle);
+    if (ctx->share_handle != NULL) {
+        curl_share_cleanup(ctx->share_handle);
+    }
     return 0;
 }
 
+static void tcurl_share_data(CURLSH *share_handle,
+                             curl_lock_data data,
+                             const char *name)
+{
+    CURLSHcode shret;
+
+    shret = curl_share_setopt(share_handle, CURLSHOPT_SHARE, data);
+    if (shret != CURLSHE_OK) {
+        /* not fatal, the requests only lose the cache */
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot share %s [%d]: %s\n",
+              name, shret, curl_share_strerror(shret));
+    }
+}
+
 struct tcurl_ctx *tcurl_init(TALLOC_CTX *mem_ctx,
                              struct tevent_context *ev)
 {
@@ -539,6 +578,28 @@ struct tcurl_ctx *tcurl_init(TALLOC_CTX *mem_ctx,
               cmret, curl_multi_strerror(cmret));
     }
 
+#ifdef CURLPIPE_MULTIPLEX
+    /* Run concurrent requests to the same server over a single HTTP/2
+     * connection, HTTP/1.1 connections are still used one request at
+     * a time. */
+    cmret = curl_multi_setopt(tctx->multi_handle,
+                              CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    if (cmret != CURLM_OK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot set CURLMOPT_PIPELINING [%d]: %s\n",
+              cmret, curl_multi_strerror(cmret));
+    }
+#endif
+
+    tctx->share_handle = curl_share_init();
+    if (tctx->share_handle == NULL) {
+        goto fail;
+    }
+
+    tcurl_share_data(tctx->share_handle, CURL_LOCK_DATA_DNS, "DNS cache");
+    tcurl_share_data(tctx->share_handle, CURL_LOCK_DATA_SSL_SESSION,
+                     "TLS sessions");
+
     return tctx;
 
 fail:
@@ -546,6 +607,44 @@ fail:
     return NULL;
 }
 
+errno_t tcurl_set_max_connections(struct tcurl_ctx *tctx,
+                                  long per_host,
+                                  long total)
+{
+#if LIBCURL_VERSION_NUM >= 0x071e00
+    CURLMcode cmret;
+
+    cmret = curl_multi_setopt(tctx->multi_handle,
+                              CURLMOPT_MAX_HOST_CONNECTIONS, per_host);
+    if (cmret != CURLM_OK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot set CURLMOPT_MAX_HOST_CONNECTIONS [%d]: %s\n",
+              cmret, curl_multi_strerror(cmret));
+        return curlm_code2errno(cmret);
+    }
+
+    cmret = curl_multi_setopt(tctx->multi_handle,
+                              CURLMOPT_MAX_TOTAL_CONNECTIONS, total);
+    if (cmret != CURLM_OK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot set CURLMOPT_MAX_TOTAL_CONNECTIONS [%d]: %s\n",
+              cmret, curl_multi_strerror(cmret));
+        return curlm_code2errno(cmret);
+    }
+
+    return EOK;
+#else
+    DEBUG(SSSDBG_MINOR_FAILURE,
+          "libcurl is too old to limit the number of connections\n");
+    return ENOTSUP;
+#endif
+}
+
+void tcurl_get_stats(struct tcurl_ctx *tctx, struct tcurl_stats *_stats)
+{
+    *_stats = tctx->stats;
+}
+
 #define tcurl_set_option(tcurl_req, option, value)                          \
 ({                                                                          \
     CURLcode __curl_code;                                                   \
@@ -634,6 +733,7 @@ struct tcurl_request_state {
     struct tcurl_request *tcurl_req;
     struct sss_iobuf *response;
     int response_code;
+    struct timeval start;
 };
 
 struct tevent_req *
@@ -686,6 +786,11 @@ tcurl_request_send(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    ret = tcurl_set_option(tcurl_req, CURLOPT_SHARE, tcurl_ctx->share_handle);
+    if (ret != EOK) {
+        goto done;
+    }
+
     if (tcurl_req->body != NULL) {
         ret = tcurl_set_option(tcurl_req, CURLOPT_READFUNCTION, tcurl_read_data);
         if (ret != EOK) {
@@ -706,6 +811,7 @@ tcurl_request_send(TALLOC_CTX *mem_ctx,
     }
 
     tcurl_req->tcurl_ctx = tcurl_ctx;
+    state->start = tevent_timeval_current();
 
     ret = EAGAIN;
 
@@ -726,21 +832,51 @@ static void tcurl_request_done(struct tevent_req *req,
                                int response_code)
 {
     struct tcurl_request_state *state;
-
-    DEBUG(SSSDBG_TRACE_FUNC, "TCURL request finished [%d]: %s\n",
-          process_error, sss_strerror(process_error));
+    struct tcurl_stats *stats;
+    struct timeval now;
+    struct timeval took;
+    uint64_t usecs;
+    long connects = 0;
 
     if (req == NULL) {
         /* To handle case where we fail to obtain request from private data. */
+        DEBUG(SSSDBG_TRACE_FUNC, "TCURL request finished [%d]: %s\n",
+              process_error, sss_strerror(process_error));
         DEBUG(SSSDBG_MINOR_FAILURE, "No tevent request provided!\n");
         return;
     }
 
     state = tevent_req_data(req, struct tcurl_request_state);
 
+    now = tevent_timeval_current();
+    took = tevent_timeval_until(&state->start, &now);
+    usecs = (uint64_t)took.tv_sec * 1000000 + took.tv_usec;
+
+    /* Zero unless the request could not reuse a cached connection */
+    curl_easy_getinfo(state->tcurl_req->curl_easy_handle,
+                      CURLINFO_NUM_CONNECTS, &connects);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "TCURL request finished [%d]: %s "
+          "in %"PRIu64" usecs with %ld new connection(s)\n",
+          process_error, sss_strerror(process_error), usecs, connects);
+
+    stats = &state->tcurl_req->tcurl_ctx->stats;
+    stats->requests++;
+    if (process_error != EOK) {
+        stats->failures++;
+    }
+    stats->connects += connects;
+    stats->usecs += usecs;
+    if (usecs > stats->max_usecs) {
+        stats->max_usecs = usecs;
+    }
+
     curl_multi_remove_handle(state->tcurl_req->tcurl_ctx->multi_handle,
                              state->tcurl_req->curl_easy_handle);
 
+    /* The share handle may go away before the easy handle is freed */
+    curl_easy_setopt(state->tcurl_req->curl_easy_handle, CURLOPT_SHARE, NULL);
+
     /* This request is no longer associated with tcurl context. */
     state->tcurl_req->tcurl_ctx = NULL;
 
@@ -834,6 +970,7 @@ tcurl_request_destructor(struct tcurl_request *tcurl_req)
         DEBUG(SSSDBG_MINOR_FAILURE, "Terminating TCURL request...\n");
         curl_multi_remove_handle(tcurl_req->tcurl_ctx->multi_handle,
                                  tcurl_req->curl_easy_handle);
+        curl_easy_setopt(tcurl_req->curl_easy_handle, CURLOPT_SHARE, NULL);
     }
 
     if (tcurl_req->headers != NULL) {
@@ -912,6 +1049,30 @@ tcurl_request_create(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    /* Keep idle connections in the cache alive */
+    ret = tcurl_set_option(tcurl_req, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (ret != EOK) {
+        goto done;
+    }
+
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    if (tcurl_http2_available()) {
+        /* Negotiate HTTP/2 over TLS and rather wait for a connection that
+         * can be multiplexed than open a new one. Plain HTTP, which is
+         * used with UNIX sockets, stays HTTP/1.1. */
+        ret = tcurl_set_option(tcurl_req, CURLOPT_HTTP_VERSION,
+                               (long)CURL_HTTP_VERSION_2TLS);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = tcurl_set_option(tcurl_req, CURLOPT_PIPEWAIT, 1L);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+#endif
+
     if (socket_path != NULL) {
         ret = tcurl_set_option(tcurl_req, CURLOPT_UNIX_SOCKET_PATH, socket_path);
         if (ret != EOK) {
@@ -39,14 +39,50 @@ enum tcurl_http_method {
     TCURL_HTTP_DELETE,
 };
 
+/**
+ * @brief Counters of the requests finished by a tcurl context.
+ */
+struct tcurl_stats {
+    uint64_t requests;      /* finished requests */
+    uint64_t failures;      /* requests that failed before a response */
+    uint64_t connects;      /* new connections the requests had to open */
+    uint64_t usecs;         /* total time from sending to completion */
+    uint64_t max_usecs;     /* longest request */
+};
+
 /**
  * @brief Initialize the tcurl tevent wrapper.
  *
+ * All requests run with the context share its connection cache, DNS cache
+ * and TLS sessions, so connections to the same server are kept open and
+ * reused. HTTP/2 connections are multiplexed if libcurl supports it.
+ *
  * @returns the opaque context or NULL on error
  */
 struct tcurl_ctx *tcurl_init(TALLOC_CTX *mem_ctx,
                              struct tevent_context *ev);
 
+/**
+ * @brief Limit the number of connections the context opens.
+ *
+ * Requests above the limits wait until a connection is free.
+ *
+ * @param[in]  tctx         Use tcurl_init to get this context
+ * @param[in]  per_host     Maximum of connections to a single host, 0 means
+ *                          no limit
+ * @param[in]  total        Maximum of connections in total, 0 means no limit
+ *
+ * @returns EOK on success, an errno code if libcurl does not support limits
+ */
+errno_t tcurl_set_max_connections(struct tcurl_ctx *tctx,
+                                  long per_host,
+                                  long total);
+
+/**
+ * @brief Get the counters of the requests finished by the context.
+ */
+void tcurl_get_stats(struct tcurl_ctx *tctx, struct tcurl_stats *_stats);
+
 /**
  * @brief Run a single asynchronous TCURL request.
  *
@@ -58,6 +58,8 @@ char *get_uppercase_realm(TALLOC_CTX *memctx, const char *name)
                          "((?P<name>[^@]+)@(?P<domain>.+$))|" \
                          "(^(?P<name>[^@\\\\]+)$))"
 
+#define SSS_DEFAULT_RE "(?P<name>[^@]+)@?(?P<domain>[^@]*$)"
+
 static errno_t get_id_provider_default_re(TALLOC_CTX *mem_ctx,
                                           struct confdb_ctx *cdb,
                                           const char *conf_path,
@@ -176,6 +178,12 @@ int sss_names_init_from_args(TALLOC_CTX *mem_ctx, const char *re_pattern,
         goto done;
     }
 
+    if (strcmp(ctx->re_pattern, SSS_DEFAULT_RE) == 0) {
+        ctx->re_format = SSS_NAMES_RE_DEFAULT;
+    } else if (strcmp(ctx->re_pattern, IPA_AD_DEFAULT_RE) == 0) {
+        ctx->re_format = SSS_NAMES_RE_IPA_AD;
+    }
+
     *out = ctx;
     ret = EOK;
 
@@ -230,8 +238,7 @@ int sss_names_init(TALLOC_CTX *mem_ctx, struct confdb_ctx *cdb,
     }
 
     if (!re_pattern) {
-        re_pattern = talloc_strdup(tmpctx,
-                                   "(?P<name>[^@]+)@?(?P<domain>[^@]*$)");
+        re_pattern = talloc_strdup(tmpctx, SSS_DEFAULT_RE);
         if (!re_pattern) {
             ret = ENOMEM;
             goto done;
@@ -284,6 +291,106 @@ int sss_ad_default_names_ctx(TALLOC_CTX *mem_ctx,
                                     _out);
 }
 
+/* Splits the names the default expressions match in an obvious way without
+ * the regex engine. Only printable ASCII names are handled, EAGAIN is
+ * returned for the others and for any corner case. */
+static errno_t sss_parse_name_fast(TALLOC_CTX *memctx,
+                                   struct sss_names_ctx *snctx,
+                                   const char *orig,
+                                   char **_domain,
+                                   char **_name)
+{
+    const char *at = NULL;
+    const char *backslash = NULL;
+    const char *name;
+    const char *domain = NULL;
+    size_t name_len;
+    size_t domain_len = 0;
+    unsigned int num_at = 0;
+    const char *p;
+
+    for (p = orig; *p != '\0'; p++) {
+        if (*p < 0x20 || *p > 0x7e) {
+            return EAGAIN;
+        }
+
+        if (*p == '@') {
+            if (at == NULL) {
+                at = p;
+            }
+            num_at++;
+        } else if (*p == '\\' && backslash == NULL) {
+            backslash = p;
+        }
+    }
+
+    if (p == orig) {
+        return EAGAIN;
+    }
+
+    switch (snctx->re_format) {
+    case SSS_NAMES_RE_DEFAULT:
+        if (num_at == 0) {
+            name = orig;
+            name_len = p - orig;
+        } else if (num_at == 1 && at != orig) {
+            name = orig;
+            name_len = at - orig;
+            domain = at + 1;
+            domain_len = p - domain;
+        } else {
+            return EAGAIN;
+        }
+        break;
+    case SSS_NAMES_RE_IPA_AD:
+        if (backslash != NULL) {
+            if (backslash == orig || backslash[1] == '\0') {
+                return EAGAIN;
+            }
+            domain = orig;
+            domain_len = backslash - orig;
+            name = backslash + 1;
+            name_len = p - name;
+        } else if (at != NULL) {
+            if (at == orig || at[1] == '\0') {
+                return EAGAIN;
+            }
+            name = orig;
+            name_len = at - orig;
+            domain = at + 1;
+            domain_len = p - domain;
+        } else {
+            name = orig;
+            name_len = p - orig;
+        }
+        break;
+    default:
+        return EAGAIN;
+    }
+
+    if (_name != NULL) {
+        *_name = talloc_strndup(memctx, name, name_len);
+        if (*_name == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    if (_domain != NULL) {
+        *_domain = NULL;
+        if (domain_len > 0) {
+            *_domain = talloc_strndup(memctx, domain, domain_len);
+            if (*_domain == NULL) {
+                if (_name != NULL) {
+                    talloc_zfree(*_name);
+                }
+                return ENOMEM;
+            }
+        }
+    }
+
+    return EOK;
+}
+
 int sss_parse_name(TALLOC_CTX *memctx,
                    struct sss_names_ctx *snctx,
                    const char *orig, char **_domain, char **_name)
@@ -292,6 +399,13 @@ int sss_parse_name(TALLOC_CTX *memctx,
     const char *result;
     int ret;
 
+    if (snctx->re_format != SSS_NAMES_RE_OTHER) {
+        ret = sss_parse_name_fast(memctx, snctx, orig, _domain, _name);
+        if (ret != EAGAIN) {
+            return ret;
+        }
+    }
+
     ret = sss_regexp_match(re, orig, 0, SSS_REGEXP_NOTEMPTY);
     if (ret == SSS_REGEXP_ERROR_NOMATCH) {
         return ERR_REGEX_NOMATCH;
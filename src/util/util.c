@@ -760,6 +760,72 @@ errno_t sss_fd_nonblocking(int fd)
     return EOK;
 }
 
+errno_t sss_parse_cpu_list(const char *list, cpu_set_t *set)
+{
+    const char *p = list;
+    unsigned long first;
+    unsigned long last;
+    unsigned long cpu;
+    char *end;
+
+    CPU_ZERO(set);
+
+    if (list == NULL || *list == '\0') {
+        return EINVAL;
+    }
+
+    while (*p != '\0') {
+        if (!isdigit(*p)) {
+            return EINVAL;
+        }
+
+        errno = 0;
+        first = strtoul(p, &end, 10);
+        if (errno != 0) {
+            return ERANGE;
+        }
+        last = first;
+
+        if (*end == '-') {
+            p = end + 1;
+            if (!isdigit(*p)) {
+                return EINVAL;
+            }
+
+            last = strtoul(p, &end, 10);
+            if (errno != 0) {
+                return ERANGE;
+            }
+            if (last < first) {
+                return EINVAL;
+            }
+        }
+
+        if (last >= CPU_SETSIZE) {
+            return ERANGE;
+        }
+
+        for (cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, set);
+        }
+
+        p = end;
+        if (*p == ',') {
+            p++;
+            while (isspace(*p)) {
+                p++;
+            }
+            if (*p == '\0') {
+                return EINVAL;
+            }
+        } else if (*p != '\0') {
+            return EINVAL;
+        }
+    }
+
+    return EOK;
+}
+
 /* Convert GeneralizedTime (http://en.wikipedia.org/wiki/GeneralizedTime)
  * to unix time (seconds since epoch). Use UTC time zone.
  */
@@ -28,6 +28,7 @@
 #include <libintl.h>
 #include <locale.h>
 #include <time.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <netinet/in.h>
@@ -222,11 +223,19 @@ void sss_erase_mem_securely(void *p, size_t size);
 /* from usertools.c */
 char *get_uppercase_realm(TALLOC_CTX *memctx, const char *name);
 
+/* The default expressions are matched without the regex engine */
+enum sss_names_re_format {
+    SSS_NAMES_RE_OTHER = 0,
+    SSS_NAMES_RE_DEFAULT,       /* name@domain or name */
+    SSS_NAMES_RE_IPA_AD,        /* DOMAIN\name, name@domain or name */
+};
+
 struct sss_names_ctx {
     char *re_pattern;
     char *fq_fmt;
 
     sss_regexp_t *re;
+    enum sss_names_re_format re_format;
 };
 
 /* initialize sss_names_ctx directly from arguments */
@@ -443,6 +452,19 @@ errno_t add_strings_lists(TALLOC_CTX *mem_ctx, const char **l1, const char **l2,
  */
 errno_t sss_fd_nonblocking(int fd);
 
+/**
+ * @brief Parse a list of CPUs
+ *
+ * The list is in the format used by taskset(1), e.g. "0-3,8,10-11".
+ *
+ * @param[in] list          The list of CPUs
+ * @param[out] set          The CPUs of the list
+ *
+ * @return                  EOK on success, EINVAL if the list is malformed,
+ *                          ERANGE if a CPU does not fit into cpu_set_t
+ */
+errno_t sss_parse_cpu_list(const char *list, cpu_set_t *set);
+
 /* Copy a NULL-terminated string list
  * Returns NULL on out of memory error or invalid input
  */
@@ -581,6 +603,9 @@ struct sss_domain_info *find_domain_by_name_ex(struct sss_domain_info *domain,
                                                uint32_t gnd_flags);
 struct sss_domain_info *find_domain_by_sid(struct sss_domain_info *domain,
                                            const char *sid);
+/* Must be called when domains are added to or removed from a domain list
+ * or when their name, flat name or SID changes. */
+void sss_domain_index_invalidate(void);
 enum sss_domain_state sss_domain_get_state(struct sss_domain_info *dom);
 void sss_domain_set_state(struct sss_domain_info *dom,
                           enum sss_domain_state state);
@@ -55,6 +55,7 @@ static void watchdog_detect_timeshift(void)
             if (getpid() == getpgrp()) {
                 kill(-getpgrp(), SIGTERM);
             }
+            sss_debug_flush();
             _exit(1);
         }
     }
@@ -75,6 +76,7 @@ static void watchdog_handler(int sig)
         if (getpid() == getpgrp()) {
             kill(-getpgrp(), SIGTERM);
         }
+        sss_debug_flush();
         _exit(SSS_WATCHDOG_EXIT_CODE);
     }
 }
@@ -0,0 +1,145 @@
+/* This file is based on the public domain wyhash from Wang Yi:
+ * https://github.com/wangyi-fudan/wyhash
+ *
+ * The 64 bit result is folded to 32 bits and the 128 bit multiplication has
+ * a fallback for compilers without a 128 bit integer type, so 32 and 64 bit
+ * clients always compute the same hash.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+#include "shared/wyhash.h"
+#include "util/sss_endian.h"
+
+static const uint64_t wyp[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6dbULL, 0x589965cc75374cc3ULL
+};
+
+/* endian neutral and safe on platforms that do only aligned reads */
+__attribute__((always_inline))
+static inline uint64_t wyr4(const uint8_t *p)
+{
+    uint32_t r;
+
+    memcpy(&r, p, sizeof(r));
+
+    return le32toh(r);
+}
+
+__attribute__((always_inline))
+static inline uint64_t wyr8(const uint8_t *p)
+{
+    return (wyr4(p + 4) << 32) | wyr4(p);
+}
+
+__attribute__((always_inline))
+static inline uint64_t wyr3(const uint8_t *p, size_t k)
+{
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+/*
+ * 64x64 -> 128 bit multiplication, the low half is returned in *a and the
+ * high half in *b
+ */
+
+__attribute__((always_inline))
+static inline void wymum(uint64_t *a, uint64_t *b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = *a;
+
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32;
+    uint64_t hb = *b >> 32;
+    uint64_t la = (uint32_t)*a;
+    uint64_t lb = (uint32_t)*b;
+    uint64_t rh = ha * hb;
+    uint64_t rm0 = ha * lb;
+    uint64_t rm1 = hb * la;
+    uint64_t rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+__attribute__((always_inline))
+static inline uint64_t wymix(uint64_t a, uint64_t b)
+{
+    wymum(&a, &b);
+
+    return a ^ b;
+}
+
+uint32_t wyhash32(const char *key, int len, uint32_t seed)
+{
+    const uint8_t *p;
+    uint64_t see1;
+    uint64_t see2;
+    uint64_t s;
+    uint64_t a;
+    uint64_t b;
+    size_t i;
+
+    p = (const uint8_t *)key;
+    i = len;
+    s = seed ^ wymix(seed ^ wyp[0], wyp[1]);
+
+    if (i <= 16) {
+        if (i >= 4) {
+            a = (wyr4(p) << 32) | wyr4(p + ((i >> 3) << 2));
+            b = (wyr4(p + i - 4) << 32) | wyr4(p + i - 4 - ((i >> 3) << 2));
+        } else if (i > 0) {
+            a = wyr3(p, i);
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        /* body, three independent lanes for long keys */
+        if (i > 48) {
+            see1 = s;
+            see2 = s;
+            do {
+                s = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ s);
+                see1 = wymix(wyr8(p + 16) ^ wyp[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ wyp[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            s ^= see1 ^ see2;
+        }
+
+        while (i > 16) {
+            s = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ s);
+            p += 16;
+            i -= 16;
+        }
+
+        /* tail, the last 16 bytes of the key */
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+
+    /* finalization */
+
+    a ^= wyp[1];
+    b ^= s;
+    wymum(&a, &b);
+    s = wymix(a ^ wyp[0] ^ (uint64_t)len, b ^ wyp[1]);
+
+    return (uint32_t)(s ^ (s >> 32));
+}